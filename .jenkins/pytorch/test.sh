@@ -78,6 +78,8 @@ if [[ "${JOB_BASE_NAME}" == *-NO_AVX-* ]]; then
   export ATEN_CPU_CAPABILITY=default
 elif [[ "${JOB_BASE_NAME}" == *-NO_AVX2-* ]]; then
   export ATEN_CPU_CAPABILITY=avx
+elif [[ "${JOB_BASE_NAME}" == *-NO_AVX512-* ]]; then
+  export ATEN_CPU_CAPABILITY=avx2
 fi
 
 test_python_nn() {
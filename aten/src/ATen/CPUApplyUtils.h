@@ -355,7 +355,11 @@ apply_kernel(int64_t numel, int64_t offset, const Op& op, Args... iters) {
 
 template <typename scalar1, typename scalar2, typename Op>
 inline void
-CPU_tensor_parallel_kernel_apply2(Tensor tensor1, Tensor tensor2, const Op op) {
+CPU_tensor_parallel_kernel_apply2(
+    Tensor tensor1,
+    Tensor tensor2,
+    const Op op,
+    int64_t grain_size = 1) {
   if (!_apply_preamble({tensor1, tensor2}))
     return;
   if (tensor1.numel() == 1) {
@@ -366,7 +370,7 @@ CPU_tensor_parallel_kernel_apply2(Tensor tensor1, Tensor tensor2, const Op op) {
     parallel_for(
         0,
         tensor1.numel(),
-        1,
+        grain_size,
         [&tensor1, &tensor2, &op](int64_t begin, int64_t end) {
           apply_kernel(
               end - begin,
@@ -379,7 +383,7 @@ CPU_tensor_parallel_kernel_apply2(Tensor tensor1, Tensor tensor2, const Op op) {
     parallel_for(
         0,
         tensor1.numel(),
-        1,
+        grain_size,
         [&tensor1, &tensor2, &op](int64_t begin, int64_t end) {
           apply_kernel(
               end - begin,
@@ -0,0 +1,133 @@
+#include <ATen/CPUCachingAllocator.h>
+
+#include <TH/THGeneral.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace at {
+
+namespace {
+
+// Every block is prefixed by a header recording its size class. The header is
+// 64 bytes so that the 64-byte alignment THAlloc guarantees for large blocks
+// carries over to the returned pointer.
+constexpr size_t kHeaderSize = 64;
+constexpr int kMinBinShift = 6; // 64 B
+constexpr int kMaxBinShift = 20; // 1 MiB
+constexpr int kNumBins = kMaxBinShift - kMinBinShift + 1;
+constexpr int kNoBin = -1;
+constexpr size_t kMaxCachedBytesPerThread = 32 << 20;
+
+struct BlockHeader {
+  int bin;
+};
+
+int size_to_bin(size_t size) {
+  int shift = kMinBinShift;
+  while (shift <= kMaxBinShift && (static_cast<size_t>(1) << shift) < size) {
+    shift++;
+  }
+  return shift <= kMaxBinShift ? shift - kMinBinShift : kNoBin;
+}
+
+size_t bin_to_size(int bin) {
+  return static_cast<size_t>(1) << (bin + kMinBinShift);
+}
+
+struct ThreadCache {
+  ~ThreadCache();
+
+  void* pop(int bin) {
+    auto& blocks = bins[bin];
+    if (blocks.empty()) {
+      return nullptr;
+    }
+    void* base = blocks.back();
+    blocks.pop_back();
+    cached_bytes -= bin_to_size(bin);
+    return base;
+  }
+
+  bool push(int bin, void* base) {
+    size_t size = bin_to_size(bin);
+    if (cached_bytes + size > kMaxCachedBytesPerThread) {
+      return false;
+    }
+    bins[bin].push_back(base);
+    cached_bytes += size;
+    return true;
+  }
+
+  void clear() {
+    for (auto& blocks : bins) {
+      for (void* base : blocks) {
+        THFree(base);
+      }
+      blocks.clear();
+    }
+    cached_bytes = 0;
+  }
+
+  std::vector<void*> bins[kNumBins];
+  size_t cached_bytes = 0;
+};
+
+// Set once the calling thread's cache has been destroyed, so that tensors
+// freed later during thread teardown bypass it. Being trivially destructible,
+// this flag outlives the cache itself.
+thread_local bool cache_destroyed = false;
+thread_local ThreadCache cache;
+
+ThreadCache::~ThreadCache() {
+  clear();
+  cache_destroyed = true;
+}
+
+void caching_free(void* base) {
+  if (!base) {
+    return;
+  }
+  int bin = static_cast<BlockHeader*>(base)->bin;
+  if (bin == kNoBin || cache_destroyed || !cache.push(bin, base)) {
+    THFree(base);
+  }
+}
+
+struct CPUCachingAllocator final : public at::Allocator {
+  at::DataPtr allocate(size_t size) const override {
+    if (size == 0) {
+      return {nullptr, nullptr, &caching_free, at::DeviceType::CPU};
+    }
+    int bin = size_to_bin(size);
+    void* base = nullptr;
+    if (bin != kNoBin && !cache_destroyed) {
+      base = cache.pop(bin);
+    }
+    if (!base) {
+      size_t alloc_size = bin == kNoBin ? size : bin_to_size(bin);
+      base = THAlloc(kHeaderSize + alloc_size);
+      static_cast<BlockHeader*>(base)->bin = bin;
+    }
+    void* data = static_cast<char*>(base) + kHeaderSize;
+    return {data, base, &caching_free, at::DeviceType::CPU};
+  }
+  // data and context differ, so raw_allocate is not supported and
+  // raw_deleter() keeps the default nullptr.
+};
+
+CPUCachingAllocator cpu_caching_allocator;
+
+} // namespace
+
+Allocator* getCPUCachingAllocator() {
+  return &cpu_caching_allocator;
+}
+
+void emptyCPUCachingAllocatorCache() {
+  if (!cache_destroyed) {
+    cache.clear();
+  }
+}
+
+} // namespace at
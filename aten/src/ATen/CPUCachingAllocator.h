@@ -0,0 +1,26 @@
+#pragma once
+
+#include <ATen/core/ATenGeneral.h>
+#include <ATen/core/Allocator.h>
+
+// A CPU allocator that caches freed blocks instead of returning them to the
+// system allocator. Requests up to 1 MiB are rounded up to a power-of-two size
+// class; freed blocks go into a bin for their size class that is private to
+// the freeing thread, so steady-state allocation in a loop (e.g. the
+// temporaries of an inference request) does not touch malloc or take a lock.
+// Larger requests go straight to THAlloc.
+//
+// Each thread caches at most a fixed number of bytes; anything beyond that is
+// freed immediately. A thread's cache is released when the thread exits.
+//
+// getCPUAllocator() returns this allocator when the environment variable
+// ATEN_CPU_CACHING_ALLOCATOR is set to 1.
+
+namespace at {
+
+CAFFE2_API Allocator* getCPUCachingAllocator();
+
+// Returns all blocks cached by the calling thread to the system allocator.
+CAFFE2_API void emptyCPUCachingAllocatorCache();
+
+} // namespace at
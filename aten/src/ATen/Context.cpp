@@ -4,13 +4,16 @@
 
 #include <ATen/core/TensorOptions.h>
 
+#include <cstdlib>
 #include <thread>
 #include <mutex>
 #include <sstream>
 #include <string>
 #include <stdexcept>
 
+#include "ATen/CPUCachingAllocator.h"
 #include "ATen/CPUGenerator.h"
+#include "ATen/NUMA.h"
 #include "ATen/RegisterCPU.h"
 #include "ATen/Tensor.h"
 #include <ATen/cpu/FlushDenormal.h>
@@ -38,6 +41,10 @@ Context::Context()
   generator_registry[static_cast<int>(DeviceType::CPU)]
     .reset(new CPUGenerator(this));
   register_cpu_types(this);
+
+  if (const char* cache_file = getenv("TORCH_CUDNN_BENCHMARK_CACHE")) {
+    benchmark_cache_file_cudnn = cache_file;
+  }
 }
 
 // TODO: This could be bad juju if someone calls globalContext() in the
@@ -74,6 +81,16 @@ void Context::setBenchmarkCuDNN(bool b) {
   benchmark_cudnn = b;
 }
 
+std::string Context::benchmarkCacheFileCuDNN() const {
+  std::lock_guard<std::mutex> guard(benchmark_cache_file_cudnn_mutex);
+  return benchmark_cache_file_cudnn;
+}
+
+void Context::setBenchmarkCacheFileCuDNN(std::string path) {
+  std::lock_guard<std::mutex> guard(benchmark_cache_file_cudnn_mutex);
+  benchmark_cache_file_cudnn = std::move(path);
+}
+
 bool Context::hasMKL() const {
 #if AT_MKL_ENABLED()
   return true;
@@ -110,7 +127,21 @@ TypeExtendedInterface& getType(const Tensor& t) {
 }
 
 Allocator* getCPUAllocator() {
-  return getTHDefaultAllocator();
+  static Allocator* allocator = []() -> Allocator* {
+    Allocator* base = getTHDefaultAllocator();
+    const char* env = std::getenv("ATEN_CPU_CACHING_ALLOCATOR");
+    if (env && std::string(env) == "1") {
+      base = getCPUCachingAllocator();
+    }
+    static MemoryReportingAllocator reporting_allocator(base);
+    base = &reporting_allocator;
+    if (is_numa_available()) {
+      static NUMAAwareAllocator numa_allocator(base);
+      return &numa_allocator;
+    }
+    return base;
+  }();
+  return allocator;
 }
 
 struct LegacyTypeInit : public LegacyTypeInitInterface {
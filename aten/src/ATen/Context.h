@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <mutex>
+#include <string>
 #include <cstdint>
 
 namespace at {
@@ -110,6 +111,11 @@ class CAFFE2_API Context {
   void setBenchmarkCuDNN(bool);
   bool deterministicCuDNN() const;
   void setDeterministicCuDNN(bool);
+  // File in which the algorithms found by benchmark mode are kept across
+  // processes (see cudnn/Conv.cpp); empty disables it. Defaults to
+  // $TORCH_CUDNN_BENCHMARK_CACHE.
+  std::string benchmarkCacheFileCuDNN() const;
+  void setBenchmarkCacheFileCuDNN(std::string);
   std::unique_ptr<Generator>
     generator_registry[static_cast<int>(DeviceType::COMPILE_TIME_MAX_DEVICE_TYPES)];
 private:
@@ -128,6 +134,8 @@ private:
   bool enabled_cudnn = true;
   bool deterministic_cudnn = false;
   bool benchmark_cudnn = false;
+  mutable std::mutex benchmark_cache_file_cudnn_mutex;
+  std::string benchmark_cache_file_cudnn;
   std::atomic<size_t> next_id;
   std::unique_ptr<THCState, void(*)(THCState*)> thc_state;
   friend struct Type;
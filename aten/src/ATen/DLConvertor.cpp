@@ -68,6 +68,9 @@ static DeviceType getATenDeviceType(const DLContext& ctx) {
   switch (ctx.device_type) {
     case DLDeviceType::kDLCPU:
       return DeviceType::CPU;
+    // Page-locked host memory is imported without a copy, as a CPU tensor
+    case DLDeviceType::kDLCPUPinned:
+      return DeviceType::CPU;
     case DLDeviceType::kDLGPU:
       return DeviceType::CUDA;
     case DLDeviceType::kDLOpenCL:
@@ -171,8 +174,15 @@ Tensor fromDLPack(const DLManagedTensor* src) {
   auto deleter = [src](void * self) {
     src->deleter(const_cast<DLManagedTensor*>(src));
   };
-  return at::from_blob(src->dl_tensor.data,
-      IntList(src->dl_tensor.shape, src->dl_tensor.ndim),
+  void* data = static_cast<char*>(src->dl_tensor.data) +
+      src->dl_tensor.byte_offset;
+  IntList sizes(src->dl_tensor.shape, src->dl_tensor.ndim);
+  // NULL strides mean a compact row-major tensor
+  if (src->dl_tensor.strides == nullptr) {
+    return at::from_blob(
+        data, sizes, deleter, at::device(device_type).dtype(stype));
+  }
+  return at::from_blob(data, sizes,
       IntList(src->dl_tensor.strides, src->dl_tensor.ndim),
       deleter,
       at::device(device_type).dtype(stype));
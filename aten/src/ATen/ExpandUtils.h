@@ -6,6 +6,7 @@
 #include <functional>
 #include <sstream>
 #include <tuple>
+#include <vector>
 
 namespace at {
 
@@ -136,20 +137,28 @@ inline std::vector<Tensor> expand_outplace(TensorList to_expand) {
 
 // Sums `tensor` repeatedly to produce a tensor of shape `shape`.
 // Precondition: is_expandable_to(shape, tensor.sizes()) must be true
+// All broadcast dimensions are reduced by a single sum, so that under
+// create_graph a broadcasting op adds one node to the graph rather than one
+// per reduced dimension.
 static inline Tensor sum_to(Tensor tensor, IntList shape) {
   if (shape.size() == 0) {
     return tensor.sum();
   }
-  Tensor result = tensor;
-  while (result.dim() > (int64_t)shape.size()) {
-    result = result.sum(0, false);
+  const int64_t leading_dims = tensor.dim() - shape.size();
+  std::vector<int64_t> reduce_dims;
+  for (int64_t i = 0; i < leading_dims; ++i) {
+    reduce_dims.push_back(i);
   }
-  for (int64_t i = 0; i < result.dim(); ++i) {
-    if (shape[i] == 1 && result.sizes()[i] > 1) {
-      result = result.sum(i, true);
+  for (int64_t i = leading_dims; i < tensor.dim(); ++i) {
+    if (shape[i - leading_dims] == 1 && tensor.sizes()[i] > 1) {
+      reduce_dims.push_back(i);
     }
   }
-  return result;
+  if (reduce_dims.empty()) {
+    return tensor;
+  }
+  Tensor result = tensor.sum(reduce_dims, /*keepdim=*/true);
+  return leading_dims > 0 ? result.view(shape) : result;
 }
 
 // True if `shape` can be broadcasted to `desired`
@@ -0,0 +1,178 @@
+#include <ATen/NUMA.h>
+
+#include <ATen/Config.h>
+#include <ATen/Parallel.h>
+#include <c10/util/Exception.h>
+
+#if AT_NUMA_ENABLED()
+#include <numa.h>
+#include <numaif.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+
+namespace at {
+namespace {
+
+// Node selected for this thread (by a NUMAGuard or, for intra-op workers, by
+// the thread that started the current parallel region).
+thread_local int current_node_ = -1;
+// Node whose CPUs this thread is currently restricted to.
+thread_local int bound_node_ = -1;
+
+// Binding a buffer smaller than this is not worth a system call; most of it
+// would share pages with neighbouring allocations anyway.
+constexpr size_t kMinNUMABindBytes = 64 * 1024;
+
+#if AT_NUMA_ENABLED()
+void bind_thread(int numa_node_id) {
+  if (!is_numa_available()) {
+    return;
+  }
+  if (numa_run_on_node(numa_node_id) != 0) {
+    AT_WARN("Unable to run on NUMA node ", numa_node_id);
+  }
+}
+
+// Binds the workers of the OpenMP team that the calling thread forks to
+// numa_node_id. OpenMP threads are persistent, so this lasts until the next
+// call.
+void bind_omp_workers(int numa_node_id) {
+#if defined(_OPENMP) && !AT_PARALLEL_NATIVE()
+  if (omp_in_parallel() || !is_numa_available()) {
+    return;
+  }
+#pragma omp parallel
+  internal::numa_bind_worker(numa_node_id);
+#endif
+}
+#endif
+
+} // namespace
+
+#if AT_NUMA_ENABLED()
+
+bool is_numa_available() {
+  static const bool available = numa_available() >= 0;
+  return available;
+}
+
+int get_num_numa_nodes() {
+  if (!is_numa_available()) {
+    return 1;
+  }
+  return numa_num_configured_nodes();
+}
+
+int get_numa_node_of(const void* ptr) {
+  if (!is_numa_available() || ptr == nullptr) {
+    return -1;
+  }
+  int numa_node = -1;
+  if (get_mempolicy(
+          &numa_node,
+          nullptr,
+          0,
+          const_cast<void*>(ptr),
+          MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+    return -1;
+  }
+  return numa_node;
+}
+
+void numa_move(void* ptr, size_t nbytes, int numa_node_id) {
+  if (numa_node_id < 0 || ptr == nullptr || !is_numa_available()) {
+    return;
+  }
+  AT_CHECK(
+      numa_node_id < static_cast<int>(sizeof(unsigned long) * 8),
+      "NUMA node id ",
+      numa_node_id,
+      " is out of range");
+  // Only whole pages: a partial page at either end is shared with whatever
+  // else lives there.
+  const uintptr_t page_size = static_cast<uintptr_t>(getpagesize());
+  const uintptr_t start = reinterpret_cast<uintptr_t>(ptr);
+  const uintptr_t first_page = (start + page_size - 1) & ~(page_size - 1);
+  const uintptr_t last_page = (start + nbytes) & ~(page_size - 1);
+  if (first_page >= last_page) {
+    return;
+  }
+  unsigned long mask = 1UL << numa_node_id;
+  if (mbind(
+          reinterpret_cast<void*>(first_page),
+          last_page - first_page,
+          MPOL_BIND,
+          &mask,
+          sizeof(mask) * 8,
+          MPOL_MF_MOVE) != 0) {
+    AT_WARN("Unable to bind memory to NUMA node ", numa_node_id);
+  }
+}
+
+#else
+
+bool is_numa_available() {
+  return false;
+}
+
+int get_num_numa_nodes() {
+  return 1;
+}
+
+int get_numa_node_of(const void* ptr) {
+  return -1;
+}
+
+void numa_move(void* ptr, size_t nbytes, int numa_node_id) {}
+
+#endif // AT_NUMA_ENABLED()
+
+int get_numa_node() {
+  return current_node_;
+}
+
+DataPtr NUMAAwareAllocator::allocate(size_t nbytes) const {
+  DataPtr data = base_->allocate(nbytes);
+  if (current_node_ >= 0 && nbytes >= kMinNUMABindBytes) {
+    numa_move(data.get(), nbytes, current_node_);
+  }
+  return data;
+}
+
+NUMAGuard::NUMAGuard(int numa_node_id) : prev_node_(current_node_) {
+  AT_CHECK(
+      numa_node_id >= -1 &&
+          (!is_numa_available() || numa_node_id < get_num_numa_nodes()),
+      "NUMA node id ",
+      numa_node_id,
+      " is unavailable");
+  internal::numa_bind_worker(numa_node_id);
+#if AT_NUMA_ENABLED()
+  bind_omp_workers(numa_node_id);
+#endif
+}
+
+NUMAGuard::~NUMAGuard() {
+  internal::numa_bind_worker(prev_node_);
+#if AT_NUMA_ENABLED()
+  bind_omp_workers(prev_node_);
+#endif
+}
+
+namespace internal {
+
+void numa_bind_worker(int numa_node_id) {
+  current_node_ = numa_node_id;
+  if (bound_node_ == numa_node_id) {
+    return;
+  }
+#if AT_NUMA_ENABLED()
+  bind_thread(numa_node_id);
+#endif
+  bound_node_ = numa_node_id;
+}
+
+} // namespace internal
+} // namespace at
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <ATen/core/ATenGeneral.h>
+#include <ATen/core/Allocator.h>
+
+#include <cstddef>
+
+// NUMA placement for CPU tensors and intra-op threads.
+//
+// A NUMAGuard selects a NUMA node for the current thread. While it is alive:
+//  - the calling thread only runs on the CPUs of that node,
+//  - storage allocated through getCPUAllocator() on this thread is bound to
+//    that node's memory,
+//  - intra-op worker threads (OpenMP or the native pool) that run parallel
+//    regions started from this thread are moved to that node.
+//
+// On 2-socket machines this keeps large elementwise and matmul workloads from
+// streaming memory across the socket interconnect.
+//
+// Without NUMA support (non-Linux, no libnuma, or built with USE_NUMA=OFF), or
+// when the machine is not NUMA, all of the functions below are no-ops and
+// get_num_numa_nodes() returns 1.
+
+namespace at {
+
+// Returns true if this build can place memory and threads on NUMA nodes and
+// the machine reports NUMA support.
+CAFFE2_API bool is_numa_available();
+
+CAFFE2_API int get_num_numa_nodes();
+
+// The NUMA node selected for the calling thread by NUMAGuard, or -1.
+CAFFE2_API int get_numa_node();
+
+// Returns the NUMA node holding the page at ptr, or -1 if unknown.
+CAFFE2_API int get_numa_node_of(const void* ptr);
+
+// Binds the pages fully contained in [ptr, ptr + nbytes) to numa_node_id,
+// migrating the ones already touched. A negative node is a no-op.
+CAFFE2_API void numa_move(void* ptr, size_t nbytes, int numa_node_id);
+
+// Wraps an allocator so that allocations made while a NUMAGuard is active on
+// the allocating thread are placed on the guard's node. getCPUAllocator()
+// returns a wrapped allocator when NUMA is available.
+struct CAFFE2_API NUMAAwareAllocator final : public Allocator {
+  explicit NUMAAwareAllocator(Allocator* base) : base_(base) {}
+  DataPtr allocate(size_t nbytes) const override;
+  DeleterFnPtr raw_deleter() const override {
+    return base_->raw_deleter();
+  }
+
+ private:
+  Allocator* base_;
+};
+
+struct CAFFE2_API NUMAGuard {
+  explicit NUMAGuard(int numa_node_id);
+  ~NUMAGuard();
+
+  NUMAGuard(const NUMAGuard&) = delete;
+  NUMAGuard& operator=(const NUMAGuard&) = delete;
+
+ private:
+  int prev_node_;
+};
+
+namespace internal {
+// Makes numa_node_id (-1 for none) the calling thread's node, as seen by
+// get_numa_node(), and moves the thread onto that node's CPUs. Intra-op
+// workers call this with the node of the thread that started a parallel
+// region; it only makes a system call when the node changes.
+CAFFE2_API void numa_bind_worker(int numa_node_id);
+} // namespace internal
+
+} // namespace at
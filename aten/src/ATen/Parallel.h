@@ -1,6 +1,8 @@
 #pragma once
 #include <ATen/ATen.h>
+#include <ATen/Config.h>
 #include <cstddef>
+#include <functional>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -14,6 +16,50 @@ namespace internal {
 // no parallel algorithm (such as parallel_reduce) should split work into
 // smaller than GRAIN_SIZE chunks.
 constexpr int64_t GRAIN_SIZE = 32768;
+
+// Lower bound for grain sizes derived from a cost hint. Below this the
+// fork/join overhead of a parallel region outweighs any per-element work.
+constexpr int64_t MIN_GRAIN_SIZE = 1024;
+
+// Relative per-element cost of a kernel, in multiples of a memory-bound
+// elementwise op such as add. Kernels pass these to grain_size_for_cost so
+// that expensive ops go parallel on smaller inputs than cheap ones.
+namespace cost {
+constexpr int64_t MEMORY_BOUND = 1; // add, mul, abs, neg, floor, ...
+constexpr int64_t ARITHMETIC = 4; // sqrt, rsqrt, reciprocal, integer div
+constexpr int64_t TRANSCENDENTAL = 16; // exp, log, sin, tanh, sigmoid, ...
+constexpr int64_t SPECIAL = 32; // erf, erfc, lgamma, ...
+} // namespace cost
+
+// Returns the grain size for a kernel whose per-element cost is `cost` times
+// that of a memory-bound op (see at::internal::cost).
+constexpr int64_t grain_size_for_cost(int64_t cost) {
+  return cost <= 1 ? GRAIN_SIZE
+                   : (GRAIN_SIZE / cost > MIN_GRAIN_SIZE ? GRAIN_SIZE / cost
+                                                         : MIN_GRAIN_SIZE);
+}
+
+#if AT_PARALLEL_NATIVE()
+// Native intra-op backend (ATEN_THREADING=NATIVE), see ParallelNative.cpp.
+//
+// The range [begin, end) is cut into chunks of at least grain_size elements
+// that the calling thread and the pool workers claim dynamically, so skewed
+// per-chunk costs do not leave threads idle. The calling thread always takes
+// part in the work, which makes nested calls from inside a parallel region
+// safe: they never block waiting for a worker to become free.
+//
+// f is called as f(chunk_begin, chunk_end). The first exception thrown by any
+// chunk is rethrown on the calling thread once all chunks have finished.
+CAFFE2_API void _parallel_run(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const std::function<void(int64_t, int64_t)>& f);
+
+// Returns true if the current thread is executing a chunk of a native
+// parallel region.
+CAFFE2_API bool in_parallel_region();
+#endif
 } // namespace internal
 
 inline int64_t divup(int64_t x, int64_t y) {
@@ -26,7 +72,16 @@ inline void parallel_for(
     const int64_t end,
     const int64_t grain_size,
     const F& f) {
-#ifdef _OPENMP
+#if AT_PARALLEL_NATIVE()
+  if (begin >= end) {
+    return;
+  }
+  if ((end - begin) < grain_size || get_num_threads() == 1) {
+    f(begin, end);
+    return;
+  }
+  internal::_parallel_run(begin, end, grain_size, f);
+#elif defined(_OPENMP)
 #pragma omp parallel if (!omp_in_parallel() && ((end - begin) >= grain_size))
   {
     int64_t num_threads = omp_get_num_threads();
@@ -57,11 +112,23 @@ inline scalar_t parallel_reduce(
     const int64_t num_results = divup((end - begin), grain_size);
     std::vector<scalar_t> results(num_results);
     scalar_t* results_data = results.data();
+#if AT_PARALLEL_NATIVE()
+    // Results are indexed by chunk id rather than by thread, so the
+    // combination order (and hence the result) does not depend on which
+    // thread ran which chunk.
+    parallel_for(0, num_results, 1, [&](int64_t id_begin, int64_t id_end) {
+      for (int64_t id = id_begin; id < id_end; id++) {
+        int64_t i = begin + id * grain_size;
+        results_data[id] = f(i, i + std::min(end - i, grain_size), ident);
+      }
+    });
+#else
 #pragma omp parallel for if ((end - begin) >= grain_size)
     for (int64_t id = 0; id < num_results; id++) {
       int64_t i = begin + id * grain_size;
       results_data[id] = f(i, i + std::min(end - i, grain_size), ident);
     }
+#endif
     return std::accumulate(
         results_data, results_data + results.size(), ident, sf);
   }
@@ -0,0 +1,194 @@
+#include <ATen/Parallel.h>
+#include <ATen/NUMA.h>
+
+#if AT_PARALLEL_NATIVE()
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace at {
+namespace internal {
+namespace {
+
+// Number of chunks each thread should expect to process when the range is
+// large; more chunks than threads lets faster threads pick up the slack of
+// slower ones without the per-chunk overhead dominating.
+constexpr int64_t kChunksPerThread = 4;
+
+thread_local bool in_parallel_region_ = false;
+
+// A fixed-size pool of workers shared by all intra-op parallel regions. The
+// pool only ever runs "helper" tasks: each helper repeatedly claims chunks of
+// a region until none are left, so a helper that starts late simply finds
+// nothing to do.
+class IntraOpThreadPool {
+ public:
+  explicit IntraOpThreadPool(size_t num_workers) : running_(true) {
+    for (size_t i = 0; i < num_workers; ++i) {
+      workers_.emplace_back([this]() { main_loop(); });
+    }
+  }
+
+  ~IntraOpThreadPool() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      running_ = false;
+      condition_.notify_all();
+    }
+    for (auto& t : workers_) {
+      t.join();
+    }
+  }
+
+  size_t size() const {
+    return workers_.size();
+  }
+
+  void run(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+    condition_.notify_one();
+  }
+
+ private:
+  void main_loop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this]() { return !tasks_.empty() || !running_; });
+        if (!running_ && tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool running_;
+};
+
+IntraOpThreadPool& get_pool() {
+  static IntraOpThreadPool pool([]() {
+    int num_threads = at::get_num_threads();
+    if (num_threads <= 0) {
+      num_threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+    }
+    return static_cast<size_t>(num_threads - 1);
+  }());
+  return pool;
+}
+
+struct ParallelRegion {
+  ParallelRegion(
+      int64_t begin,
+      int64_t end,
+      int64_t chunk_size,
+      const std::function<void(int64_t, int64_t)>& f)
+      : begin(begin),
+        end(end),
+        chunk_size(chunk_size),
+        num_chunks(divup(end - begin, chunk_size)),
+        f(f),
+        numa_node(get_numa_node()),
+        next_chunk(0),
+        chunks_done(0) {}
+
+  // Claims and runs chunks until the region is exhausted.
+  void work() {
+    bool prev_in_parallel = in_parallel_region_;
+    in_parallel_region_ = true;
+    // Follow the NUMA node of the thread that started the region; this is a
+    // no-op on the calling thread itself.
+    numa_bind_worker(numa_node);
+    int64_t done = 0;
+    int64_t chunk;
+    while ((chunk = next_chunk.fetch_add(1)) < num_chunks) {
+      int64_t chunk_begin = begin + chunk * chunk_size;
+      int64_t chunk_end = std::min(end, chunk_begin + chunk_size);
+      try {
+        f(chunk_begin, chunk_end);
+      } catch (...) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!eptr) {
+          eptr = std::current_exception();
+        }
+      }
+      done++;
+    }
+    in_parallel_region_ = prev_in_parallel;
+    if (done > 0 && chunks_done.fetch_add(done) + done == num_chunks) {
+      std::unique_lock<std::mutex> lock(mutex);
+      finished.notify_all();
+    }
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]() { return chunks_done.load() == num_chunks; });
+  }
+
+  const int64_t begin;
+  const int64_t end;
+  const int64_t chunk_size;
+  const int64_t num_chunks;
+  // Only dereferenced after successfully claiming a chunk, which guarantees
+  // that the calling thread is still blocked in wait().
+  const std::function<void(int64_t, int64_t)>& f;
+  const int numa_node;
+  std::atomic<int64_t> next_chunk;
+  std::atomic<int64_t> chunks_done;
+  std::exception_ptr eptr;
+  std::mutex mutex;
+  std::condition_variable finished;
+};
+
+} // namespace
+
+bool in_parallel_region() {
+  return in_parallel_region_;
+}
+
+void _parallel_run(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const std::function<void(int64_t, int64_t)>& f) {
+  auto& pool = get_pool();
+  int64_t num_threads = at::get_num_threads();
+  if (num_threads <= 0 || static_cast<size_t>(num_threads) > pool.size() + 1) {
+    num_threads = pool.size() + 1;
+  }
+  int64_t chunk_size = std::max(
+      std::max<int64_t>(grain_size, 1),
+      divup(end - begin, num_threads * kChunksPerThread));
+  auto region = std::make_shared<ParallelRegion>(begin, end, chunk_size, f);
+
+  int64_t num_helpers = std::min(num_threads - 1, region->num_chunks - 1);
+  for (int64_t i = 0; i < num_helpers; ++i) {
+    pool.run([region]() { region->work(); });
+  }
+  region->work();
+  region->wait();
+  if (region->eptr) {
+    std::rethrow_exception(region->eptr);
+  }
+}
+
+} // namespace internal
+} // namespace at
+
+#endif // AT_PARALLEL_NATIVE()
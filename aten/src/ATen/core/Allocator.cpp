@@ -1,5 +1,8 @@
 #include <ATen/core/Allocator.h>
 
+#include <atomic>
+#include <utility>
+
 namespace at {
 
 static void deleteInefficientStdFunctionContext(void* ptr) {
@@ -16,6 +19,47 @@ at::DataPtr InefficientStdFunctionContext::makeDataPtr(
           device};
 }
 
+namespace {
+
+std::atomic<ReportMemoryUsageFn> report_memory_usage_hook(nullptr);
+
+struct ReportingContext {
+  ReportingContext(DataPtr data, size_t nbytes)
+      : data(std::move(data)), nbytes(nbytes) {}
+  DataPtr data;
+  size_t nbytes;
+};
+
+void deleteReportingContext(void* ptr) {
+  auto* ctx = static_cast<ReportingContext*>(ptr);
+  reportMemoryUsage(-static_cast<int64_t>(ctx->nbytes), ctx->data.device());
+  delete ctx;
+}
+
+} // namespace
+
+void setReportMemoryUsageHook(ReportMemoryUsageFn fn) {
+  report_memory_usage_hook.store(fn);
+}
+
+ReportMemoryUsageFn getReportMemoryUsageHook() {
+  return report_memory_usage_hook.load(std::memory_order_relaxed);
+}
+
+DataPtr MemoryReportingAllocator::allocate(size_t nbytes) const {
+  DataPtr data = base_->allocate(nbytes);
+  if (!getReportMemoryUsageHook() || !data) {
+    return data;
+  }
+  void* ptr = data.get();
+  Device device = data.device();
+  reportMemoryUsage(nbytes, device);
+  return {ptr,
+          new ReportingContext(std::move(data), nbytes),
+          &deleteReportingContext,
+          device};
+}
+
 } // namespace at
 
 namespace caffe2 {
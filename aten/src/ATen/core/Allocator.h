@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <cstdint>
 #include <memory>
 
 #include <ATen/core/Device.h>
@@ -121,6 +122,37 @@ struct Allocator {
   }
 };
 
+// Memory usage reporting, for profilers.
+//
+// While a hook is set, the allocators that support it (getCPUAllocator() and
+// the CUDA caching allocator) call it with the number of bytes of every
+// allocation, and with minus that number when the memory is freed. The hook
+// runs on the allocating or freeing thread, possibly with allocator locks
+// held, so it must not allocate tensors. Memory allocated before the hook was
+// set is not reported when it is freed.
+using ReportMemoryUsageFn = void (*)(int64_t nbytes, Device device);
+
+CAFFE2_API void setReportMemoryUsageHook(ReportMemoryUsageFn fn);
+CAFFE2_API ReportMemoryUsageFn getReportMemoryUsageHook();
+
+inline void reportMemoryUsage(int64_t nbytes, Device device) {
+  if (auto fn = getReportMemoryUsageHook()) {
+    fn(nbytes, device);
+  }
+}
+
+// Wraps an allocator to report its allocations, and their frees, while a
+// report hook is set. Otherwise it returns base's allocations as they are.
+// Its DataPtrs have a context of their own while reporting, so it doesn't
+// support the raw interface.
+struct CAFFE2_API MemoryReportingAllocator final : public Allocator {
+  explicit MemoryReportingAllocator(Allocator* base) : base_(base) {}
+  DataPtr allocate(size_t nbytes) const override;
+
+ private:
+  Allocator* base_;
+};
+
 // Question: is this still needed?
 struct CAFFE2_API InefficientStdFunctionContext {
   std::unique_ptr<void, std::function<void(void*)>> ptr_;
@@ -28,6 +28,9 @@
 #include <ATen/core/VariableHooksInterface.h>
 #include <c10/util/Exception.h>
 
+#include <atomic>
+#include <limits>
+
 namespace at {
 
 struct CAFFE2_API LegacyTypeInitInterface {
@@ -69,6 +72,14 @@ struct CAFFE2_API LegacyTypeDeleter {
 class CAFFE2_API LegacyTypeDispatch {
  public:
   using TypeUniquePtr = std::unique_ptr<Type, LegacyTypeDeleter>;
+  LegacyTypeDispatch() {
+    for (auto& types : type_id_registry) {
+      for (auto& type : types) {
+        type[0].store(nullptr, std::memory_order_relaxed);
+        type[1].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+  }
   // WARNING: This function has the precondition that you have
   // initialized the type you want to call.  This initialization
   // step is generally done by Context, or assumed because you
@@ -108,6 +119,20 @@ class CAFFE2_API LegacyTypeDispatch {
       return baseType;
     }
   }
+  // Same as getTypeRaw(tensorTypeIdToBackend(t), s, is_variable), but the
+  // result is cached in a table indexed by TensorTypeId. This is the path
+  // every operator call on a Tensor takes, and it saves the comparisons of
+  // tensorTypeIdToBackend and the virtual calls to get the Variable type.
+  Type* getTypeRaw(TensorTypeId t, ScalarType s, bool is_variable) {
+    auto& entry = type_id_registry[t.underlyingId()][static_cast<int>(s)]
+                                  [is_variable];
+    Type* type = entry.load(std::memory_order_acquire);
+    if (!type) {
+      type = getTypeRaw(tensorTypeIdToBackend(t), s, is_variable);
+      entry.store(type, std::memory_order_release);
+    }
+    return type;
+  }
   Type & getVariableType(Backend p, ScalarType s) {
     auto& baseType = getNonVariableType(p, s);
     return detail::getVariableHooks().getVariableTypeFromBaseType(baseType);
@@ -122,6 +147,10 @@ class CAFFE2_API LegacyTypeDispatch {
   void registerType(Backend b, ScalarType s, TypeUniquePtr&& t) {
     type_registry[static_cast<int>(b)][static_cast<int>(s)] = std::move(t);
     detail::getVariableHooks().registerVariableTypeFor(this, b, s);
+    auto& cached = type_id_registry[backendToTensorTypeId(b).underlyingId()]
+                                   [static_cast<int>(s)];
+    cached[0].store(nullptr, std::memory_order_release);
+    cached[1].store(nullptr, std::memory_order_release);
   }
 private:
   void initForDeviceType(DeviceType p) {
@@ -152,6 +181,14 @@ private:
   TypeUniquePtr type_registry
     [static_cast<int>(Backend::NumOptions)]
     [static_cast<int>(ScalarType::NumOptions)];
+
+  // Cache of getTypeRaw by TensorTypeId, ScalarType and is_variable
+  static constexpr int kNumTensorTypeIds =
+      std::numeric_limits<details::_tensorTypeId_underlyingType>::max() + 1;
+  std::atomic<Type*> type_id_registry
+    [kNumTensorTypeIds]
+    [static_cast<int>(ScalarType::NumOptions)]
+    [2];
 };
 
 CAFFE2_API LegacyTypeDispatch& globalLegacyTypeDispatch();
@@ -0,0 +1,100 @@
+#pragma once
+
+/// Philox4x32-10, the counter-based random number generator of Salmon et al.,
+/// "Parallel Random Numbers: As Easy as 1, 2, 3" (SC 2011), which curand also
+/// implements. Its output is a pure function of a 64-bit key (the seed) and a
+/// 128-bit counter, so the random numbers of element i of a tensor can be
+/// computed independently of the other elements: a parallel fill gives the
+/// same result for any number of threads.
+///
+/// Like curand_init(seed, subsequence, offset, &state), the counter is made of
+/// a subsequence, usually the index of the element, and an offset within it.
+
+#include <ATen/core/Macros.h>
+
+#include <cstdint>
+
+namespace at {
+
+class PhiloxRNG {
+ public:
+  AT_HOST_DEVICE inline PhiloxRNG(
+      uint64_t seed,
+      uint64_t subsequence = 0,
+      uint64_t offset = 0) {
+    key_[0] = static_cast<uint32_t>(seed);
+    key_[1] = static_cast<uint32_t>(seed >> 32);
+    counter_[0] = static_cast<uint32_t>(offset);
+    counter_[1] = static_cast<uint32_t>(offset >> 32);
+    counter_[2] = static_cast<uint32_t>(subsequence);
+    counter_[3] = static_cast<uint32_t>(subsequence >> 32);
+    index_ = 4;
+  }
+
+  /// Returns the next 32 random bits. Every block of 4 outputs is generated
+  /// at once, and advances the offset by one.
+  AT_HOST_DEVICE inline uint32_t operator()() {
+    if (index_ == 4) {
+      block(output_);
+      increment_offset();
+      index_ = 0;
+    }
+    return output_[index_++];
+  }
+
+  /// Returns a uniform float on [0, 1), from 24 random bits
+  AT_HOST_DEVICE inline float uniform_float() {
+    return ((*this)() >> 8) * (1.0f / (1u << 24));
+  }
+
+  /// Returns a uniform double on [0, 1), from 53 random bits
+  AT_HOST_DEVICE inline double uniform_double() {
+    uint64_t hi = (*this)();
+    uint64_t lo = (*this)();
+    return (((hi << 32) | lo) >> 11) * (1.0 / (UINT64_C(1) << 53));
+  }
+
+ private:
+  static constexpr uint32_t kMultiplier0 = 0xD2511F53;
+  static constexpr uint32_t kMultiplier1 = 0xCD9E8D57;
+  static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+  static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+  AT_HOST_DEVICE inline void block(uint32_t* out) const {
+    uint32_t c[4] = {counter_[0], counter_[1], counter_[2], counter_[3]};
+    uint32_t k[2] = {key_[0], key_[1]};
+    for (int round = 0; round < 10; ++round) {
+      if (round > 0) {
+        k[0] += kWeyl0;
+        k[1] += kWeyl1;
+      }
+      uint64_t p0 = static_cast<uint64_t>(kMultiplier0) * c[0];
+      uint64_t p1 = static_cast<uint64_t>(kMultiplier1) * c[2];
+      uint32_t hi0 = static_cast<uint32_t>(p0 >> 32);
+      uint32_t lo0 = static_cast<uint32_t>(p0);
+      uint32_t hi1 = static_cast<uint32_t>(p1 >> 32);
+      uint32_t lo1 = static_cast<uint32_t>(p1);
+      c[0] = hi1 ^ c[1] ^ k[0];
+      c[1] = lo1;
+      c[2] = hi0 ^ c[3] ^ k[1];
+      c[3] = lo0;
+    }
+    out[0] = c[0];
+    out[1] = c[1];
+    out[2] = c[2];
+    out[3] = c[3];
+  }
+
+  AT_HOST_DEVICE inline void increment_offset() {
+    if (++counter_[0] == 0) {
+      ++counter_[1];
+    }
+  }
+
+  uint32_t key_[2];
+  uint32_t counter_[4];
+  uint32_t output_[4];
+  int index_;
+};
+
+} // namespace at
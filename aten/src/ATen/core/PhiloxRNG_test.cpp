@@ -0,0 +1,70 @@
+#include "ATen/core/PhiloxRNG.h"
+
+#include <gtest/gtest.h>
+
+using at::PhiloxRNG;
+
+namespace {
+
+// Known answers of Philox4x32-10 from the Random123 distribution
+// (kat_vectors), with the counter split into offset and subsequence.
+TEST(PhiloxRNGTest, MatchesKnownAnswers) {
+  PhiloxRNG zero(0, 0, 0);
+  EXPECT_EQ(0x6627e8d5u, zero());
+  EXPECT_EQ(0xe169c58du, zero());
+  EXPECT_EQ(0xbc57ac4cu, zero());
+  EXPECT_EQ(0x9b00dbd8u, zero());
+
+  PhiloxRNG ones(UINT64_MAX, UINT64_MAX, UINT64_MAX);
+  EXPECT_EQ(0x408f276du, ones());
+  EXPECT_EQ(0x41c83b0eu, ones());
+  EXPECT_EQ(0xa20bc7c6u, ones());
+  EXPECT_EQ(0x6d5451fdu, ones());
+
+  PhiloxRNG pi(
+      UINT64_C(0x299f31d0a4093822),
+      UINT64_C(0x0370734413198a2e),
+      UINT64_C(0x85a308d3243f6a88));
+  EXPECT_EQ(0xd16cfe09u, pi());
+  EXPECT_EQ(0x94fdccebu, pi());
+  EXPECT_EQ(0x5001e420u, pi());
+  EXPECT_EQ(0x24126ea1u, pi());
+}
+
+TEST(PhiloxRNGTest, AdvancesTheOffsetEveryFourOutputs) {
+  PhiloxRNG first(42, 7, 0);
+  for (int i = 0; i < 4; ++i) {
+    first();
+  }
+  PhiloxRNG second(42, 7, 1);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(second(), first());
+  }
+}
+
+TEST(PhiloxRNGTest, SubsequencesDiffer) {
+  PhiloxRNG a(42, 0);
+  PhiloxRNG b(42, 1);
+  EXPECT_NE(a(), b());
+}
+
+TEST(PhiloxRNGTest, UniformsAreInUnitInterval) {
+  PhiloxRNG rng(1234);
+  double float_sum = 0;
+  double double_sum = 0;
+  const int n = 10000;
+  for (int i = 0; i < n; ++i) {
+    float f = rng.uniform_float();
+    double d = rng.uniform_double();
+    ASSERT_GE(f, 0.0f);
+    ASSERT_LT(f, 1.0f);
+    ASSERT_GE(d, 0.0);
+    ASSERT_LT(d, 1.0);
+    float_sum += f;
+    double_sum += d;
+  }
+  EXPECT_NEAR(0.5, float_sum / n, 0.02);
+  EXPECT_NEAR(0.5, double_sum / n, 0.02);
+}
+
+} // namespace
@@ -125,6 +125,17 @@ public:
     return impl_.weak_use_count();
   }
 
+  /// Makes the TensorImpl immortal, so that copies of this tensor don't
+  /// update its reference count. Use it for tensors that are shared
+  /// read-only by many threads, like the weights of a model, and call it
+  /// before they are shared. The tensor and its data are never freed.
+  void make_immortal() {
+    impl_.make_immortal();
+  }
+  bool is_immortal() const noexcept {
+    return impl_.is_immortal();
+  }
+
   const char * toString() const;
 
   IntList sizes() const {
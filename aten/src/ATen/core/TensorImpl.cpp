@@ -32,31 +32,29 @@ TensorImpl::TensorImpl(Storage&& storage, TensorTypeId type_id, bool is_variable
 TensorImpl::TensorImpl(Storage&& storage, TensorTypeId type_id, const caffe2::TypeMeta& data_type, bool is_variable)
     : storage_(std::move(storage)),
       sizes_{0},
+      strides_{1},
       storage_offset_(0),
       numel_(0),
       data_type_(data_type),
       type_id_(type_id),
-      is_variable_(is_variable) {
-  strides_.reset(new int64_t[1]);
-  strides_[0] = 1;
-}
+      is_variable_(is_variable) {}
 
 IntList TensorImpl::sizes() const {
   return sizes_;
 }
 
 IntList TensorImpl::strides() const {
-  AT_ASSERTM(strides_,
+  AT_ASSERTM(has_strides_,
              "Caffe2 tensors don't (yet) have meaningful strides and cannot "
              "be used in PyTorch.");
-  return IntList{strides_.get(), sizes_.size()};
+  return strides_;
 }
 
 bool TensorImpl::compute_contiguous() const {
   bool is_contiguous = true;
   if (is_empty())
     return is_contiguous;
-  if (!strides_) {
+  if (!has_strides_) {
     // Special case for Caffe2 tensors which don't have strides set.
     return true;
   }
@@ -90,7 +88,7 @@ int64_t TensorImpl::size(int64_t d) const {
 }
 
 int64_t TensorImpl::stride(int64_t d) const {
-  AT_ASSERTM(strides_,
+  AT_ASSERTM(has_strides_,
              "Caffe2 tensors don't (yet) have meaningful strides and cannot "
              "be used in PyTorch.");
   d = at::maybe_wrap_dim(d, dim(), false);
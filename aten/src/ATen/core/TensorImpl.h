@@ -4,6 +4,7 @@
 #include <memory>
 
 #include <ATen/core/Backend.h>
+#include <ATen/core/DimVector.h>
 #include <ATen/core/LegacyTypeDispatch.h>
 #include <ATen/core/Storage.h>
 #include <ATen/core/TensorTypeId.h>
@@ -193,7 +194,8 @@ struct CAFFE2_API TensorImpl : public c10::intrusive_ptr_target {
     // could not have been created without initializing the Type first.
     // TODO: This is not actually true via the Caffe2 codepath!  Make
     // it so.
-    return *globalLegacyTypeDispatch().getTypeRaw(tensorTypeIdToBackend(type_id()), dataTypeToScalarType(dtype().id()), is_variable());
+    return *globalLegacyTypeDispatch().getTypeRaw(
+        type_id(), dataTypeToScalarType(dtype().id()), is_variable());
   }
 
   TensorTypeId type_id() const { return type_id_; }
@@ -313,29 +315,24 @@ struct CAFFE2_API TensorImpl : public c10::intrusive_ptr_target {
   virtual void resize_dim(int64_t ndim) {
     // NB: This is *truly* a resize; calling code (e.g., squeeze)
     // assumes that old values are preserved
-    auto old_dim = sizes_.size();
-    sizes_.resize(ndim);
-    auto new_strides = c10::guts::make_unique<int64_t[]>(ndim);
-    for (size_t i = 0; i < std::min(old_dim, static_cast<size_t>(ndim)); i++) {
-      new_strides[i] = strides_[i];
-    }
-    for (size_t i = old_dim; i < static_cast<size_t>(ndim); i++) {
-      // If ndim < old_dim, this loop never executes
-      new_strides[i] = 0;
-    }
-    strides_ = std::move(new_strides);
+    sizes_.resize(ndim, 0);
+    strides_.resize(ndim, 0);
     refresh_numel();
     refresh_contiguous();
   }
 
   virtual void set_size(int64_t dim, int64_t new_size) {
-    sizes_.at(dim) = new_size;
+    AT_CHECK(
+        dim >= 0 && static_cast<size_t>(dim) < sizes_.size(),
+        "dimension ", dim, " out of range for a tensor of ", sizes_.size(),
+        " dims");
+    sizes_[dim] = new_size;
     refresh_numel();
     refresh_contiguous();
   }
 
   virtual void set_stride(int64_t dim, int64_t new_stride) {
-    AT_ASSERTM(strides_, "Caffe2 tensors don't have meaningful strides and "
+    AT_ASSERTM(has_strides_, "Caffe2 tensors don't have meaningful strides and "
                          "cannot be used in PyTorch");
     strides_[dim] = new_stride;
     refresh_numel();
@@ -360,14 +357,9 @@ struct CAFFE2_API TensorImpl : public c10::intrusive_ptr_target {
         ") must match dimensionality of strides (",
         new_stride.size(),
         ")");
-    auto old_dim = sizes_.size();
-    sizes_ = new_size.vec();
-    if (old_dim != sizes_.size()) {
-      strides_.reset(new int64_t[sizes_.size()]);
-    }
-    for (size_t i = 0; i < sizes_.size(); i++) {
-      strides_[i] = new_stride[i];
-    }
+    sizes_.assign(new_size.begin(), new_size.end());
+    strides_.assign(new_stride.begin(), new_stride.end());
+    has_strides_ = true;
     refresh_numel();
     refresh_contiguous();
   }
@@ -430,7 +422,8 @@ struct CAFFE2_API TensorImpl : public c10::intrusive_ptr_target {
     if (src.numel() == -1) {
       sizes_.clear();
       numel_ = -1;
-      strides_.reset();
+      strides_.clear();
+      has_strides_ = false;
       is_contiguous_ = true;
       storage_ = at::Storage(GetDevice(), caffe2::TypeMeta());
       data_type_ = caffe2::TypeMeta();
@@ -628,7 +621,7 @@ struct CAFFE2_API TensorImpl : public c10::intrusive_ptr_target {
         " The old caffe2 mixes Reshape and Resize but this behavior has "
         "been changed. If you find this error, most likely you will need "
         "to change corresponding code from Reshape to Resize.");
-    sizes_ = dims;
+    sizes_.assign(dims.begin(), dims.end());
     update_to_contiguous_strides();
   }
 
@@ -705,6 +698,21 @@ struct CAFFE2_API TensorImpl : public c10::intrusive_ptr_target {
     }
   }
 
+  /**
+   * Marks the tensor copy-on-write: the next mutable access to its data, through
+   * raw_mutable_data() or mutable_data(), first gives it a private copy of its
+   * storage if the storage is still shared with another tensor, e.g. after
+   * ShareData(). Tensors that share storage on purpose lose the sharing on
+   * their first write once marked.
+   */
+  void set_copy_on_write(bool copy_on_write) {
+    copy_on_write_ = copy_on_write;
+  }
+
+  bool copy_on_write() const {
+    return copy_on_write_;
+  }
+
   /**
    * Returns a mutable raw pointer of the underlying storage. Since we will need
    * to know the type of the data for allocation, a TypeMeta object is passed in
@@ -719,6 +727,9 @@ struct CAFFE2_API TensorImpl : public c10::intrusive_ptr_target {
   inline void* raw_mutable_data(const caffe2::TypeMeta& meta) {
     // For 0-size tensors it's fine to return any pointer (including nullptr)
     if (data_type_ == meta && (storage_.data() || numel_ == 0)) {
+      if (copy_on_write_) {
+        DetachSharedStorage();
+      }
       return static_cast<void*>(static_cast<char*>(storage_.data()) + storage_offset_ * meta.itemsize());
     } else {
       AT_ASSERTM(
@@ -782,7 +793,8 @@ struct CAFFE2_API TensorImpl : public c10::intrusive_ptr_target {
    */
   template <typename T>
   inline T* mutable_data() {
-    if ((numel_ == 0 || storage_.data()) && storage_.IsType<T>()) {
+    if ((numel_ == 0 || storage_.data()) && storage_.IsType<T>() &&
+        !copy_on_write_) {
       return static_cast<T*>(storage_.data()) + storage_offset_;
     }
     // Check it here statically - otherwise TypeMeta would throw the runtime
@@ -794,6 +806,31 @@ struct CAFFE2_API TensorImpl : public c10::intrusive_ptr_target {
   }
 
  private:
+  // Replaces a storage shared with other tensors by a copy of the numel_ items
+  // of this tensor, see set_copy_on_write()
+  void DetachSharedStorage() {
+    copy_on_write_ = false;
+    if (storage_.unique() || numel_ <= 0) {
+      return;
+    }
+    const void* src = static_cast<const char*>(storage_.data()) +
+        storage_offset_ * data_type_.itemsize();
+    // keeps the shared data alive until it is copied
+    at::Storage shared = storage_;
+    storage_ = at::Storage(shared.device(), data_type_);
+    storage_offset_ = 0;
+    void* dst = raw_mutable_data(data_type_);
+    if (data_type_.copy()) {
+      AT_ASSERTM(
+          device_type() == ::at::DeviceType::CPU,
+          "Copy-on-write of non-POD types is only supported on CPU");
+      data_type_.copy()(src, dst, numel_);
+    } else {
+      CreateContext(GetDevice())
+          ->CopyBytesSameDevice(numel_ * itemsize(), src, dst);
+    }
+  }
+
   template <
       typename T,
       typename = typename std::enable_if<std::is_integral<T>::value>::type>
@@ -843,7 +880,8 @@ struct CAFFE2_API TensorImpl : public c10::intrusive_ptr_target {
   }
 
   inline void update_to_contiguous_strides() {
-    strides_.reset();
+    strides_.clear();
+    has_strides_ = false;
     is_contiguous_ = true;
   }
 
@@ -851,8 +889,9 @@ public:
   at::Storage storage_; // TODO: Fix visibility on me
 
 protected:
-  std::vector<int64_t> sizes_;
-  std::unique_ptr<int64_t[]> strides_; // this saves two words
+  // Inline up to 5 dims, so that most tensors and views don't allocate them
+  DimVector sizes_;
+  DimVector strides_;
 
   int64_t storage_offset_ = 0;
   int64_t numel_ = -1;
@@ -865,6 +904,8 @@ protected:
   // should pack this into a bitfield.
   TensorTypeId type_id_;
   bool is_contiguous_ = true;
+  // False for Caffe2 tensors, which are contiguous and don't set strides_
+  bool has_strides_ = true;
   bool is_variable_ = false;
   bool is_wrapped_number_ = false;
   // we decide to keep reserved_ and it will
@@ -872,6 +913,8 @@ protected:
   // The logic is that if Extend() or ReserveSpace() were ever called,
   // then subsequent Resize()s will not free up Storage.
   bool reserved_ = false;
+  // See set_copy_on_write()
+  bool copy_on_write_ = false;
 
 };
 } // namespace at
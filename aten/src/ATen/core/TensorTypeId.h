@@ -11,6 +11,8 @@ namespace details {
 using _tensorTypeId_underlyingType = uint8_t;
 }
 
+class LegacyTypeDispatch;
+
 /**
  * Dynamic type ID of a Tensor argument.  It represents something like
  * CPUTensor, etc.
@@ -30,6 +32,8 @@ class CAFFE2_API TensorTypeId final
       : IdWrapper(id) {}
 
   friend class TensorTypeIdCreator;
+  // indexes its dispatch table with the underlying id
+  friend class LegacyTypeDispatch;
   friend CAFFE2_API std::ostream& operator<<(std::ostream&, TensorTypeId);
 };
 
@@ -69,6 +69,9 @@ namespace c10 {
   _(prim, LoadWorld)               \
   _(prim, StoreWorld)              \
   _(prim, DummyWorld)              \
+  _(prim, AllocateArena)           \
+  _(prim, ArenaSlot)               \
+  _(prim, ParallelBranches)        \
   _(aten, append)                  \
   _(aten, __not__)                 \
   FORALL_ATEN_BASE_SYMBOLS(_)      \
@@ -102,6 +105,7 @@ namespace c10 {
   FORALL_ATTR_BASE_SYMBOLS(_)      \
   _(attr, Subgraph)                \
   _(attr, ReverseSubgraph)         \
+  _(attr, Subgraphs)               \
   _(attr, f_real_outputs)          \
   _(attr, df_input_vjps)           \
   _(attr, df_input_captured_inputs) \
@@ -58,6 +58,11 @@ class CAFFE2_API intrusive_ptr_target {
   //
   mutable std::atomic<size_t> refcount_;
   mutable std::atomic<size_t> weakcount_;
+  // An immortal object is never destructed, and its pointers don't touch the
+  // counts, which are then frozen. Threads that share the object read-only,
+  // e.g. the weights of a model, thus don't contend for the cache line of
+  // the counts. See intrusive_ptr::make_immortal().
+  bool immortal_;
 
   template <typename T, typename NullType>
   friend class intrusive_ptr;
@@ -87,7 +92,8 @@ class CAFFE2_API intrusive_ptr_target {
 #pragma GCC diagnostic pop
   }
 
-  constexpr intrusive_ptr_target() noexcept : refcount_(0), weakcount_(0) {}
+  constexpr intrusive_ptr_target() noexcept
+      : refcount_(0), weakcount_(0), immortal_(false) {}
 
   // intrusive_ptr_target supports move: but refcount and weakcount don't
   // participate (since they are intrinsic properties of the memory location)
@@ -162,7 +168,7 @@ class C10_EXPORT intrusive_ptr final {
   friend class weak_intrusive_ptr<TTarget, NullType>;
 
   void retain_() {
-    if (target_ != NullType::singleton()) {
+    if (target_ != NullType::singleton() && !target_->immortal_) {
       size_t new_refcount = ++target_->refcount_;
       AT_ASSERTM(
           new_refcount != 1,
@@ -171,7 +177,8 @@ class C10_EXPORT intrusive_ptr final {
   }
 
   void reset_() noexcept {
-    if (target_ != NullType::singleton() && --target_->refcount_ == 0) {
+    if (target_ != NullType::singleton() && !target_->immortal_ &&
+        --target_->refcount_ == 0) {
       // See comment above about weakcount. As long as refcount>0,
       // weakcount is one larger than the actual number of weak references.
       // So we need to decrement it here.
@@ -310,6 +317,19 @@ class C10_EXPORT intrusive_ptr final {
     return target_->weakcount_.load();
   }
 
+  // Makes the object immortal: it is never destructed, and copying or
+  // destroying its pointers no longer updates the counts. This must be done
+  // before the object is shared with other threads.
+  void make_immortal() noexcept {
+    if (target_ != NullType::singleton()) {
+      target_->immortal_ = true;
+    }
+  }
+
+  bool is_immortal() const noexcept {
+    return target_ != NullType::singleton() && target_->immortal_;
+  }
+
   bool unique() const noexcept {
     return use_count() == 1;
   }
@@ -416,7 +436,7 @@ class C10_EXPORT weak_intrusive_ptr final {
   friend class weak_intrusive_ptr;
 
   void retain_() {
-    if (target_ != NullType::singleton()) {
+    if (target_ != NullType::singleton() && !target_->immortal_) {
       size_t new_weakcount = ++target_->weakcount_;
       AT_ASSERTM(
           new_weakcount != 1,
@@ -425,7 +445,8 @@ class C10_EXPORT weak_intrusive_ptr final {
   }
 
   void reset_() noexcept {
-    if (target_ != NullType::singleton() && --target_->weakcount_ == 0) {
+    if (target_ != NullType::singleton() && !target_->immortal_ &&
+        --target_->weakcount_ == 0) {
       delete target_;
     }
     target_ = NullType::singleton();
@@ -559,6 +580,9 @@ class C10_EXPORT weak_intrusive_ptr final {
   }
 
   intrusive_ptr<TTarget, NullType> lock() const noexcept {
+    if (target_->immortal_) {
+      return intrusive_ptr<TTarget, NullType>(target_);
+    }
     auto refcount = target_->refcount_.load();
     do {
       if (refcount == 0) {
@@ -3335,3 +3335,27 @@ TEST(WeakIntrusivePtrTest, givenStackObject_whenReclaimed_thenCrashes) {
   weak_intrusive_ptr<SomeClass> ptr = make_invalid_weak<SomeClass>();
   EXPECT_ANY_THROW(ptr = weak_intrusive_ptr<SomeClass>::reclaim(&obj));
 }
+
+TEST(
+    IntrusivePtrTest,
+    givenImmortalPtr_whenCopiedAndDestructed_thenCountsDontChangeAndDoesntDestruct) {
+  bool resourcesReleased = false;
+  bool wasDestructed = false;
+  {
+    auto obj =
+        make_intrusive<DestructableMock>(&resourcesReleased, &wasDestructed);
+    EXPECT_FALSE(obj.is_immortal());
+    obj.make_immortal();
+    EXPECT_TRUE(obj.is_immortal());
+    {
+      intrusive_ptr<DestructableMock> copy = obj;
+      weak_intrusive_ptr<DestructableMock> weak(copy);
+      EXPECT_EQ(1, obj.use_count());
+      EXPECT_EQ(1, obj.weak_use_count());
+      EXPECT_TRUE(weak.lock().is_immortal());
+    }
+    EXPECT_EQ(1, obj.use_count());
+  }
+  EXPECT_FALSE(resourcesReleased);
+  EXPECT_FALSE(wasDestructed);
+}
@@ -52,9 +52,14 @@ namespace {
 
 using namespace vec256;
 
+// Elementwise functions are parallelized with a grain size that depends on
+// how expensive they are per element, see at::internal::cost.
+#define VML_GRAIN_SIZE(op_cost) \
+  at::internal::grain_size_for_cost(at::internal::cost::op_cost)
+
 template <typename scalar_t>
 inline void vrsqrt(scalar_t* out, scalar_t* in, int64_t size) {
-  parallel_for(0, size, 2048, [out, in](int64_t begin, int64_t end) {
+  parallel_for(0, size, VML_GRAIN_SIZE(ARITHMETIC), [out, in](int64_t begin, int64_t end) {
     map(
         [](const Vec256<scalar_t>& x) {
           return Vec256<scalar_t>((scalar_t)(1)) / x.sqrt();
@@ -73,55 +78,57 @@ inline void vrsqrt(scalar_t* out, scalar_t* in, int64_t size) {
 // this. This duplication is also necessary since not all functions (e.g. rsqrt)
 // might be part of cmath.
 
-#define IMPLEMENT_VML_BUG(op)                                          \
+#define IMPLEMENT_VML_BUG(op, op_cost)                                  \
   template <typename scalar_t>                                          \
   inline void v##op(scalar_t* out, const scalar_t* in, int64_t size) {  \
     DL_RUNTIME_BUG(op, scalar_t)                                        \
-    parallel_for(0, size, 2048, [out, in](int64_t begin, int64_t end) { \
+    const int64_t grain_size = VML_GRAIN_SIZE(op_cost);                 \
+    parallel_for(0, size, grain_size, [out, in](int64_t b, int64_t e) {  \
       map([](const Vec256<scalar_t>& x) { return x.op(); },             \
-          out + begin,                                                  \
-          in + begin,                                                   \
-          end - begin);                                                 \
+          out + b,                                                      \
+          in + b,                                                       \
+          e - b);                                                       \
     });                                                                 \
   }
 
-#define IMPLEMENT_VML(op)                                              \
+#define IMPLEMENT_VML(op, op_cost)                                      \
   template <typename scalar_t>                                          \
   inline void v##op(scalar_t* out, const scalar_t* in, int64_t size) {  \
-    parallel_for(0, size, 2048, [out, in](int64_t begin, int64_t end) { \
+    const int64_t grain_size = VML_GRAIN_SIZE(op_cost);                 \
+    parallel_for(0, size, grain_size, [out, in](int64_t b, int64_t e) {  \
       map([](const Vec256<scalar_t>& x) { return x.op(); },             \
-          out + begin,                                                  \
-          in + begin,                                                   \
-          end - begin);                                                 \
+          out + b,                                                      \
+          in + b,                                                       \
+          e - b);                                                       \
     });                                                                 \
   }
 
-IMPLEMENT_VML_BUG(abs)
-IMPLEMENT_VML_BUG(acos)
-IMPLEMENT_VML_BUG(asin)
-IMPLEMENT_VML_BUG(atan)
-IMPLEMENT_VML_BUG(ceil)
-IMPLEMENT_VML_BUG(cos)
-// IMPLEMENT_VML_BUG(cosh)
-IMPLEMENT_VML_BUG(erf)
-IMPLEMENT_VML_BUG(erfc)
-IMPLEMENT_VML_BUG(exp)
-IMPLEMENT_VML_BUG(expm1)
-IMPLEMENT_VML_BUG(floor)
-IMPLEMENT_VML(reciprocal)
-IMPLEMENT_VML_BUG(log)
-IMPLEMENT_VML_BUG(log10)
-IMPLEMENT_VML_BUG(log1p)
-IMPLEMENT_VML_BUG(log2)
-IMPLEMENT_VML(neg)
-IMPLEMENT_VML_BUG(sin)
-// IMPLEMENT_VML_BUG(sinh)
-IMPLEMENT_VML_BUG(sqrt)
-IMPLEMENT_VML_BUG(round)
-IMPLEMENT_VML(rsqrt)
-IMPLEMENT_VML_BUG(tan)
-IMPLEMENT_VML_BUG(tanh)
-IMPLEMENT_VML_BUG(trunc)
+IMPLEMENT_VML_BUG(abs, MEMORY_BOUND)
+IMPLEMENT_VML_BUG(acos, TRANSCENDENTAL)
+IMPLEMENT_VML_BUG(asin, TRANSCENDENTAL)
+IMPLEMENT_VML_BUG(atan, TRANSCENDENTAL)
+IMPLEMENT_VML_BUG(ceil, MEMORY_BOUND)
+IMPLEMENT_VML_BUG(cos, TRANSCENDENTAL)
+// IMPLEMENT_VML_BUG(cosh, TRANSCENDENTAL)
+IMPLEMENT_VML_BUG(erf, SPECIAL)
+IMPLEMENT_VML_BUG(erfc, SPECIAL)
+IMPLEMENT_VML_BUG(exp, TRANSCENDENTAL)
+IMPLEMENT_VML_BUG(expm1, TRANSCENDENTAL)
+IMPLEMENT_VML_BUG(floor, MEMORY_BOUND)
+IMPLEMENT_VML(reciprocal, ARITHMETIC)
+IMPLEMENT_VML_BUG(log, TRANSCENDENTAL)
+IMPLEMENT_VML_BUG(log10, TRANSCENDENTAL)
+IMPLEMENT_VML_BUG(log1p, TRANSCENDENTAL)
+IMPLEMENT_VML_BUG(log2, TRANSCENDENTAL)
+IMPLEMENT_VML(neg, MEMORY_BOUND)
+IMPLEMENT_VML_BUG(sin, TRANSCENDENTAL)
+// IMPLEMENT_VML_BUG(sinh, TRANSCENDENTAL)
+IMPLEMENT_VML_BUG(sqrt, ARITHMETIC)
+IMPLEMENT_VML_BUG(round, MEMORY_BOUND)
+IMPLEMENT_VML(rsqrt, ARITHMETIC)
+IMPLEMENT_VML_BUG(tan, TRANSCENDENTAL)
+IMPLEMENT_VML_BUG(tanh, TRANSCENDENTAL)
+IMPLEMENT_VML_BUG(trunc, MEMORY_BOUND)
 
 #if AT_MKL_ENABLED() && !defined(__APPLE__)
 
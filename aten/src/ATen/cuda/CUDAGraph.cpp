@@ -0,0 +1,132 @@
+#include "ATen/cuda/CUDAGraph.h"
+#include "ATen/cuda/CUDAContext.h"
+#include "ATen/cuda/Exceptions.h"
+#include "ATen/DeviceGuard.h"
+#include "c10/util/Exception.h"
+
+#include <THC/THCCachingAllocator.h>
+
+#include <atomic>
+
+namespace at { namespace cuda {
+
+// Ids tag the memory reserved for each graph in the caching allocator; 0
+// means "no graph" there.
+static std::atomic<uint64_t> next_graph_id{1};
+
+CUDAGraph::CUDAGraph() : id_(next_graph_id++) {}
+
+CUDAGraph::~CUDAGraph() {
+  try {
+    reset();
+  } catch (...) { /* No throw */ }
+}
+
+#if !defined(__HIP_PLATFORM_HCC__) && CUDART_VERSION >= 10000
+
+void CUDAGraph::capture_begin() {
+  AT_CHECK(!has_graph_ && !capturing_,
+           "CUDAGraph::capture_begin: this graph was already captured, call reset() first");
+  auto stream = getCurrentCUDAStream();
+  AT_CHECK(stream.stream() != getDefaultCUDAStream().stream(),
+           "CUDA graphs must be captured on a non-default stream, e.g. one from at::cuda::createCUDAStream()");
+
+  // Notify the allocator first so that allocations made inside the capture
+  // are tagged from the first kernel on.
+  THCCachingAllocator_notifyCaptureBegin(id_, stream.stream());
+#if CUDART_VERSION >= 10010
+  cudaError_t err = cudaStreamBeginCapture(stream.stream(), cudaStreamCaptureModeGlobal);
+#else
+  cudaError_t err = cudaStreamBeginCapture(stream.stream());
+#endif
+  if (err != cudaSuccess) {
+    THCCachingAllocator_notifyCaptureEnd(id_);
+    THCCachingAllocator_releaseGraphPool(id_);
+    AT_CUDA_CHECK(err);
+  }
+  capture_stream_ = stream;
+  capture_device_ = stream.device();
+  capturing_ = true;
+}
+
+void CUDAGraph::capture_end() {
+  AT_CHECK(capturing_, "CUDAGraph::capture_end: capture_begin() was not called");
+  auto stream = getCurrentCUDAStream();
+  AT_CHECK(stream.internals() == capture_stream_.internals(),
+           "CUDAGraph::capture_end: the current stream is not the capture stream");
+
+  capturing_ = false;
+  cudaError_t err = cudaStreamEndCapture(capture_stream_.stream(), &graph_);
+  THCCachingAllocator_notifyCaptureEnd(id_);
+  if (err == cudaSuccess) {
+    err = cudaGraphInstantiate(&graph_exec_, graph_, nullptr, nullptr, 0);
+    if (err != cudaSuccess) {
+      cudaGraphDestroy(graph_);
+      graph_ = nullptr;
+    }
+  }
+  if (err != cudaSuccess) {
+    // an invalidated capture (e.g. by a synchronizing call) ends up here
+    THCCachingAllocator_releaseGraphPool(id_);
+    AT_CUDA_CHECK(err);
+  }
+  has_graph_ = true;
+}
+
+void CUDAGraph::replay() {
+  AT_CHECK(has_graph_, "CUDAGraph::replay: nothing was captured");
+  auto stream = getCurrentCUDAStream();
+  AT_CHECK(stream.device() == capture_device_,
+           "CUDAGraph::replay: the graph was captured on device ", capture_device_,
+           " but the current stream is on device ", stream.device());
+  AT_CUDA_CHECK(cudaGraphLaunch(graph_exec_, stream.stream()));
+}
+
+void CUDAGraph::reset() {
+  if (capturing_) {
+    // abandon the capture; the partial graph is useless
+    cudaGraph_t graph = nullptr;
+    cudaStreamEndCapture(capture_stream_.stream(), &graph);
+    if (graph) {
+      cudaGraphDestroy(graph);
+    }
+    cudaGetLastError();
+    capturing_ = false;
+    THCCachingAllocator_notifyCaptureEnd(id_);
+    THCCachingAllocator_releaseGraphPool(id_);
+    return;
+  }
+  if (!has_graph_) {
+    return;
+  }
+  at::DeviceGuard device_guard{(int)capture_device_};
+  // Replays may still be running; they must finish before the memory they
+  // use goes back to the allocator.
+  AT_CUDA_CHECK(cudaDeviceSynchronize());
+  AT_CUDA_CHECK(cudaGraphExecDestroy(graph_exec_));
+  AT_CUDA_CHECK(cudaGraphDestroy(graph_));
+  graph_exec_ = nullptr;
+  graph_ = nullptr;
+  has_graph_ = false;
+  THCCachingAllocator_releaseGraphPool(id_);
+}
+
+#else
+
+void CUDAGraph::capture_begin() {
+  AT_ERROR("CUDA graphs require CUDA 10 or newer");
+}
+
+void CUDAGraph::capture_end() {
+  AT_ERROR("CUDA graphs require CUDA 10 or newer");
+}
+
+void CUDAGraph::replay() {
+  AT_ERROR("CUDA graphs require CUDA 10 or newer");
+}
+
+void CUDAGraph::reset() {}
+
+#endif
+
+}} // namespace at::cuda
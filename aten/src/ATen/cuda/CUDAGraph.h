@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ATen/cuda/ATenCUDAGeneral.h"
+#include "ATen/cuda/CUDAStream.h"
+
+#include "cuda_runtime_api.h"
+
+#include <cstdint>
+
+namespace at { namespace cuda {
+
+/*
+* A CUDAGraph records the kernels and copies queued on a stream between
+* capture_begin() and capture_end(), and replays them with a single launch.
+*
+* This removes the CPU cost of dispatching and launching every kernel, which
+* dominates small-batch workloads, but everything about the captured work is
+* fixed: replays run the same kernels on the same addresses with the same
+* scalar arguments (including the seeds and offsets of random number
+* generators). Inputs have to be copied into the tensors used during capture
+* and outputs read from the tensors produced by it.
+*
+* To keep those addresses valid, the caching allocator reserves the memory
+* allocated on the capture stream during capture for this graph until the
+* graph is reset or destroyed. Memory freed during capture is only reused by
+* the same capture.
+*
+* Capture must happen on a non-default stream (see createCUDAStream), only
+* one graph can be captured at a time, and the captured region must not
+* synchronize with the host. Requires CUDA 10.
+*/
+struct AT_CUDA_API CUDAGraph {
+  CUDAGraph();
+  ~CUDAGraph();
+
+  CUDAGraph(const CUDAGraph&) = delete;
+  CUDAGraph& operator=(const CUDAGraph&) = delete;
+
+  // Starts capturing the work queued on the current stream.
+  void capture_begin();
+  // Stops capturing and instantiates the graph.
+  void capture_end();
+  // Launches the captured work on the current stream, which has to be on the
+  // capture device.
+  void replay();
+  // Destroys the graph and returns its memory to the caching allocator.
+  void reset();
+
+  bool has_graph() const { return has_graph_; }
+
+private:
+  uint64_t id_;
+  bool capturing_ = false;
+  bool has_graph_ = false;
+  CUDAStream capture_stream_;
+  int64_t capture_device_ = -1;
+#if !defined(__HIP_PLATFORM_HCC__) && CUDART_VERSION >= 10000
+  cudaGraph_t graph_ = nullptr;
+  cudaGraphExec_t graph_exec_ = nullptr;
+#endif
+};
+
+}} // namespace at::cuda
@@ -208,6 +208,17 @@ int64_t CUDAStream_device(CUDAStreamInternals* ptr) {
   return ptr->device;
 }
 
+bool CUDAStream_isCapturing(CUDAStreamInternals* ptr) {
+  AT_ASSERT(ptr);
+#if !defined(__HIP_PLATFORM_HCC__) && CUDART_VERSION >= 10000
+  cudaStreamCaptureStatus status;
+  AT_CUDA_CHECK(cudaStreamIsCapturing(ptr->stream, &status));
+  return status == cudaStreamCaptureStatusActive;
+#else
+  return false;
+#endif
+}
+
 void CUDAStream_synchronize_with(CUDAStreamInternals* ptr, const CUDAEvent& event) {
     if (event.isCreated())
       AT_CUDA_CHECK(cudaStreamWaitEvent(ptr->stream, event, 0));
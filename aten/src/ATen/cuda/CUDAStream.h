@@ -72,6 +72,7 @@ AT_CUDA_API void CUDAStream_uncheckedSetStream(CUDAStreamInternals* internals);
 
 AT_CUDA_API cudaStream_t CUDAStream_stream(CUDAStreamInternals*);
 AT_CUDA_API int64_t CUDAStream_device(CUDAStreamInternals*);
+AT_CUDA_API bool CUDAStream_isCapturing(CUDAStreamInternals*);
 
 } // namespace detail
 
@@ -102,6 +103,10 @@ struct AT_CUDA_API CUDAStream {
 
   void synchronize_with(const CUDAEvent& event) const;
 
+  // Returns true while work queued on the stream is being captured into a
+  // CUDA graph instead of executed (see CUDAGraph.h).
+  bool is_capturing() const { return detail::CUDAStream_isCapturing(internals_); }
+
 private:
   CUDAStreamInternals* internals_ = nullptr;
 };
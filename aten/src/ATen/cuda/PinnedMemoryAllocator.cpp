@@ -1,10 +1,13 @@
 #include <ATen/cuda/PinnedMemoryAllocator.h>
 #include <ATen/Context.h>
 #include <ATen/Config.h>
+#include <ATen/cuda/Exceptions.h>
 
 #include <THC/THC.h>
 #include <THC/THCGeneral.hpp>
 
+#include <cuda_runtime_api.h>
+
 #include <stdexcept>
 
 namespace at { namespace cuda {
@@ -14,4 +17,38 @@ at::Allocator* getPinnedMemoryAllocator() {
   return state->cudaHostAllocator;
 }
 
+namespace {
+
+// Owns the original allocation of a storage pinned in place.
+struct HostRegisteredContext {
+  at::DataPtr original;
+};
+
+void deleteHostRegistered(void* ctx) {
+  auto* context = static_cast<HostRegisteredContext*>(ctx);
+  // Errors cannot be reported from a deleter; the memory is freed regardless.
+  if (cudaHostUnregister(context->original.get()) != cudaSuccess) {
+    cudaGetLastError();
+  }
+  delete context;
+}
+
+} // namespace
+
+void pinStorageInPlace(StorageImpl* storage) {
+  AT_CHECK(storage->device_type() == at::DeviceType::CPU,
+           "only CPU memory can be pinned");
+  void* data = storage->data_ptr().get();
+  size_t nbytes = storage->capacity();
+  if (!data || nbytes == 0 || storage->data_ptr().get_deleter() == &deleteHostRegistered) {
+    return;
+  }
+  globalContext().lazyInitCUDA();
+  AT_CUDA_CHECK(cudaHostRegister(data, nbytes, cudaHostRegisterDefault));
+  auto* context = new HostRegisteredContext{
+      storage->set_data_ptr(at::DataPtr(nullptr, storage->device()))};
+  storage->set_data_ptr(
+      at::DataPtr(data, context, &deleteHostRegistered, storage->device()));
+}
+
 }} // namespace at::cuda
@@ -1,9 +1,17 @@
 #pragma once
 
 #include <ATen/Allocator.h>
+#include <ATen/core/StorageImpl.h>
 
 namespace at { namespace cuda {
 
 at::Allocator* getPinnedMemoryAllocator();
 
+// Page-locks the memory of a CPU storage where it is (cudaHostRegister), so
+// that it can be copied to the GPU asynchronously without first being copied
+// into a buffer from the pinned memory allocator. The memory is unregistered
+// when the storage frees it. Used for batches that DataLoader workers already
+// wrote to shared memory.
+void pinStorageInPlace(StorageImpl* storage);
+
 }} // namespace at::cuda
@@ -117,6 +117,10 @@ Allocator* CUDAHooks::getPinnedMemoryAllocator() const {
   return at::cuda::getPinnedMemoryAllocator();
 }
 
+void CUDAHooks::pinStorageInPlace(StorageImpl* storage) const {
+  at::cuda::pinStorageInPlace(storage);
+}
+
 void CUDAHooks::registerCUDATypes(Context* context) const {
   register_cuda_types(context);
 }
@@ -17,6 +17,7 @@ struct CUDAHooks : public at::CUDAHooksInterface {
   bool hasCuDNN() const override;
   int64_t current_device() const override;
   Allocator* getPinnedMemoryAllocator() const override;
+  void pinStorageInPlace(StorageImpl* storage) const override;
   void registerCUDATypes(Context*) const override;
   bool compiledWithCuDNN() const override;
   bool compiledWithMIOpen() const override;
@@ -15,6 +15,7 @@ struct THCState;
 
 namespace at {
 class Context;
+struct StorageImpl;
 }
 
 // NB: Class must live in `at` due to limitations of Registry.h.
@@ -82,6 +83,10 @@ struct CAFFE2_API CUDAHooksInterface {
     AT_ERROR("Pinned memory requires CUDA. ", CUDA_HELP);
   }
 
+  virtual void pinStorageInPlace(StorageImpl*) const {
+    AT_ERROR("Pinned memory requires CUDA. ", CUDA_HELP);
+  }
+
   virtual void registerCUDATypes(Context*) const {
     AT_ERROR("Cannot registerCUDATypes() without ATen_cuda library. ", CUDA_HELP);
   }
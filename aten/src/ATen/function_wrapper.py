@@ -1502,8 +1502,11 @@ def create_derived(backend_type_env, declarations):
             else:
                 types = [to_return_type(arg, option)['type']
                          for arg in arguments]
-                # TODO: check for move semantics...
-                names = [arg['name'] for arg in arguments]
+                # Allocated results are moved into the tuple, to save the
+                # refcount bumps of a copy; output arguments are references
+                names = [arg['name'] if t.endswith('&') else
+                         'std::move({})'.format(arg['name'])
+                         for arg, t in zip(arguments, types)]
                 body.append(CodeTemplate("return std::tuple<${types}>(${names});").substitute(
                     types=types, names=names))
         elif ret['kind'] == 'type':
@@ -1,12 +1,16 @@
 #include "ATen/ATen.h"
-#include "ATen/CPUApplyUtils.h"
 #include "ATen/Dispatch.h"
 #include "ATen/NativeFunctions.h"
 #include "ATen/core/Half.h"
+#include "ATen/native/PointwiseOps.h"
+#include "ATen/native/TensorIterator.h"
 
 
 namespace at { namespace native {
 
+DEFINE_DISPATCH(hardshrink_stub);
+DEFINE_DISPATCH(hardshrink_backward_stub);
+
 static const double SELU_ALPHA = 1.6732632423543772848170429916717;
 static const double SELU_SCALE = 1.0507009873554804934193349852946;
 
@@ -290,35 +294,19 @@ std::tuple<Tensor, Tensor> prelu_backward_cpu(const Tensor& grad_out_, const Ten
 // -----------------------------------
 Tensor hardshrink_cpu(const Tensor & self, Scalar lambd) {
   auto out_tensor = at::empty_like(self);
-  AT_DISPATCH_FLOATING_TYPES(self.type(), "hardshrink_cpu", [&] {
-    auto lambd_val = lambd.to<scalar_t>();
-    at::CPU_tensor_apply2<scalar_t, scalar_t>(
-      self,
-      out_tensor,
-      [&](
-        scalar_t& self_val,
-        scalar_t& out_tensor_val) {
-          out_tensor_val = (self_val >= -lambd_val && self_val <= lambd_val) ? scalar_t(0) : self_val;
-    });
-  });
+  auto iter = TensorIterator::unary_op(out_tensor, self);
+  hardshrink_stub(iter->device_type(), *iter, lambd);
   return out_tensor;
 }
 
 Tensor hardshrink_backward_cpu(const Tensor & grad, const Tensor & self, Scalar lambd) {
   auto out_tensor = at::empty_like(self);
-  AT_DISPATCH_FLOATING_TYPES(self.type(), "hardshrink_backward_cpu", [&] {
-    auto lambd_val = lambd.to<scalar_t>();
-    at::CPU_tensor_apply3<scalar_t, scalar_t, scalar_t>(
-      self,
-      grad,
-      out_tensor,
-      [&](
-        scalar_t& self_val,
-        scalar_t& grad_val,
-        scalar_t& out_tensor_val) {
-          out_tensor_val = (self_val >= -lambd_val && self_val <= lambd_val) ? scalar_t(0) : grad_val;
-    });
-  });
+  auto iter = TensorIterator::Builder()
+      .add_output(out_tensor)
+      .add_input(self)
+      .add_input(grad)
+      .build();
+  hardshrink_backward_stub(iter->device_type(), *iter, lambd);
   return out_tensor;
 }
 
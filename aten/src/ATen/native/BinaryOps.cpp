@@ -10,6 +10,7 @@ namespace native {
 
 DEFINE_DISPATCH(add_stub);
 DEFINE_DISPATCH(sub_stub);
+DEFINE_DISPATCH(add_relu_stub);
 DEFINE_DISPATCH(mul_stub);
 DEFINE_DISPATCH(div_stub);
 
@@ -41,6 +42,21 @@ Tensor& add_(Tensor& self, const Tensor& other, Scalar alpha) {
   return native::add_out(self, self, other, alpha);
 }
 
+Tensor& add_relu_out_cpu(Tensor& result, const Tensor& self, const Tensor& other, Scalar alpha) {
+  auto iter = TensorIterator::binary_op(result, self, other);
+  add_relu_stub(iter->device_type(), *iter, alpha);
+  return result;
+}
+
+Tensor add_relu_cpu(const Tensor& self, const Tensor& other, Scalar alpha) {
+  Tensor result;
+  return native::add_relu_out_cpu(result, self, other, alpha);
+}
+
+Tensor& add_relu_cpu_(Tensor& self, const Tensor& other, Scalar alpha) {
+  return native::add_relu_out_cpu(self, self, other, alpha);
+}
+
 Tensor& div_out(Tensor& result, const Tensor& self, const Tensor& other) {
   if (self.is_sparse()) {
     if (!result.defined()) {
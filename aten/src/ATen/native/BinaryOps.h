@@ -12,6 +12,7 @@ using binary_fn = void(*)(TensorIterator&);
 
 DECLARE_DISPATCH(binary_fn_alpha, add_stub);
 DECLARE_DISPATCH(binary_fn_alpha, sub_stub);
+DECLARE_DISPATCH(binary_fn_alpha, add_relu_stub);
 DECLARE_DISPATCH(binary_fn, mul_stub);
 DECLARE_DISPATCH(binary_fn, div_stub);
 
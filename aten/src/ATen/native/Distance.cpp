@@ -8,6 +8,8 @@ namespace at { namespace native {
 
 DEFINE_DISPATCH(pdist_forward_stub);
 DEFINE_DISPATCH(pdist_backward_stub);
+DEFINE_DISPATCH(cdist_stub);
+DEFINE_DISPATCH(cdist_backward_stub);
 
 Tensor pairwise_distance(const Tensor& x1, const Tensor& x2, double p, double eps, bool keepdim) {
   return at::norm(x1 - x2 + eps, p, 1, keepdim);
@@ -52,4 +54,87 @@ Tensor _pdist_backward(const Tensor& grad, const Tensor& self, const double p, c
   return result;
 }
 
+// Euclidean distances from ||x1||^2 - 2 x1 x2^T + ||x2||^2, which computes
+// the cross terms of all the pairs with one matrix product. It is much faster
+// than the direct computation when there are many rows, but cancellation
+// makes it less accurate for points that are close to each other.
+static Tensor euclidean_dist_mm(const Tensor& x1, const Tensor& x2) {
+  auto x1_norm = x1.pow(2).sum(-1, /*keepdim=*/true);
+  auto x2_norm = x2.pow(2).sum(-1, /*keepdim=*/true);
+  auto result = x1.matmul(x2.transpose(-2, -1)).mul(-2)
+      .add(x1_norm).add(x2_norm.transpose(-2, -1));
+  // The clamp also keeps the gradient of sqrt finite for identical points
+  return result.clamp_min(1e-30).sqrt();
+}
+
+Tensor cdist(const Tensor& x1, const Tensor& x2, const double p, int64_t compute_mode) {
+  AT_CHECK(x1.dim() >= 2,
+      "cdist only supports at least 2D tensors, X1 got: ", x1.dim(), "D");
+  AT_CHECK(x1.dim() == x2.dim(),
+      "cdist expects X1 and X2 to have the same number of dimensions, got: ",
+      x1.dim(), " and ", x2.dim());
+  AT_CHECK(x1.sizes().slice(0, x1.dim() - 2) == x2.sizes().slice(0, x2.dim() - 2),
+      "cdist expects X1 and X2 to have the same batch dimensions, got: ",
+      x1.sizes(), " and ", x2.sizes());
+  AT_CHECK(x1.size(-1) == x2.size(-1),
+      "cdist only supports X1 and X2 with the same number of columns, got: ",
+      x1.size(-1), " and ", x2.size(-1));
+  AT_CHECK(at::isFloatingType(x1.type().scalarType()),
+      "cdist only supports floating-point dtypes, X1 got: ", x1.type().scalarType());
+  AT_CHECK(at::isFloatingType(x2.type().scalarType()),
+      "cdist only supports floating-point dtypes, X2 got: ", x2.type().scalarType());
+  AT_CHECK(p >= 0, "cdist only supports non-negative p values");
+  AT_CHECK(compute_mode >= 0 && compute_mode <= 2,
+      "cdist got an invalid compute_mode: ", compute_mode);
+
+  const int64_t r1 = x1.size(-2);
+  const int64_t r2 = x2.size(-2);
+  const bool use_mm = p == 2 &&
+      (compute_mode == 1 || (compute_mode == 0 && (r1 > 25 || r2 > 25)));
+  if (use_mm) {
+    return euclidean_dist_mm(x1, x2);
+  }
+
+  const int64_t m = x1.size(-1);
+  std::vector<int64_t> result_size(x1.sizes().begin(), x1.sizes().end() - 2);
+  result_size.push_back(r1);
+  result_size.push_back(r2);
+  auto result = at::_cdist_forward(
+      x1.reshape({-1, r1, m}).contiguous(), x2.reshape({-1, r2, m}).contiguous(), p);
+  return result.view(result_size);
+}
+
+Tensor _cdist_forward(const Tensor& x1, const Tensor& x2, const double p) {
+  AT_CHECK(x1.dim() == 3 && x2.dim() == 3, "_cdist_forward requires 3D inputs");
+  AT_CHECK(x1.is_contiguous() && x2.is_contiguous(),
+      "_cdist_forward requires contiguous inputs");
+  auto device = x1.type().device_type();
+  AT_CHECK(device == kCPU || device == kCUDA, "_cdist_forward only supports CPU and CUDA devices, got: ", device);
+  Tensor result = at::empty({x1.size(0), x1.size(1), x2.size(1)}, x1.options());
+  if (result.numel() > 0) {
+    if (x1.size(2) == 0) {
+      result.fill_(0);
+    } else {
+      cdist_stub(device, result, x1, x2, p);
+    }
+  }
+  return result;
+}
+
+Tensor _cdist_backward(const Tensor& grad, const Tensor& x1, const Tensor& x2, const double p, const Tensor& cdist) {
+  AT_CHECK(grad.is_contiguous(), "_cdist_backward requires grad to be contiguous");
+  AT_CHECK(x1.is_contiguous() && x2.is_contiguous(),
+      "_cdist_backward requires X1 and X2 to be contiguous");
+  AT_CHECK(cdist.is_contiguous(), "_cdist_backward requires cdist to be contiguous");
+  auto device = x1.type().device_type();
+  AT_CHECK(device == kCPU || device == kCUDA, "_cdist_backward only supports CPU and CUDA devices, got: ", device);
+  Tensor result = at::empty_like(x1);
+  if (p == 0.0 || result.numel() == 0 || x2.size(1) == 0) {
+    result.fill_(0);
+  } else {
+    cdist_backward_stub(device, result, grad, x1, x2, p, cdist);
+  }
+  return result;
+}
+
 }}  // namespace at::native
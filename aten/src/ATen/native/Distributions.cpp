@@ -4,11 +4,13 @@
 #include "ATen/Dispatch.h"
 #include "ATen/ExpandUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
 #include "c10/util/Exception.h"
 
 #include "ATen/CPUGenerator.h"
 #include "ATen/CheckGenerator.h"
 #include "ATen/core/Generator.h"
+#include "ATen/core/PhiloxRNG.h"
 #include "ATen/native/Distributions.h"
 #include "ATen/native/DispatchStub.h"
 #include "ATen/native/cpu/UnaryOpsKernel.h"
@@ -105,6 +107,12 @@ int64_t sample_poisson(double lambda, THGenerator* generator) {
   }
 }
 
+// Key of the Philox stream of a parallel fill, see THTensor_(uniform)
+uint64_t philox_seed(THGenerator* generator) {
+  std::lock_guard<std::mutex> lock(generator->mutex);
+  return THRandom_random64(generator);
+}
+
 } // namespace
 
 namespace at {
@@ -128,8 +136,24 @@ Tensor& bernoulli_out(Tensor& result, const Tensor& self, Generator* gen) {
 Tensor& bernoulli_tensor_cpu_(Tensor& self, const Tensor& p_, Generator* gen) {
   AT_DISPATCH_ALL_TYPES(self.type(), "bernoulli_tensor_cpu_self_", [&] {
     THGenerator* generator = get_generator(gen);
-    std::lock_guard<std::mutex> lock(generator->mutex);
     using self_t = scalar_t;
+    if (self.is_contiguous()) {
+      const uint64_t seed = philox_seed(generator);
+      auto p = std::get<0>(expand_inplace(self, p_.to(kCPU, kDouble)))
+                   .contiguous();
+      self_t* self_data = self.data<self_t>();
+      const double* p_data = p.data<double>();
+      parallel_for(0, self.numel(),
+          internal::grain_size_for_cost(internal::cost::ARITHMETIC),
+          [=](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          PhiloxRNG rng(seed, i);
+          self_data[i] = static_cast<self_t>(rng.uniform_double() < p_data[i]);
+        }
+      });
+      return;
+    }
+    std::lock_guard<std::mutex> lock(generator->mutex);
     if (p_.type().scalarType() == kDouble) {
       auto p = std::get<0>(expand_inplace(self, p_.to(kCPU)));
       CPU_tensor_apply2<self_t, double>(
@@ -162,6 +186,19 @@ Tensor& bernoulli_scalar_cpu_(Tensor& self, double p, Generator* gen) {
 #endif
   AT_DISPATCH_ALL_TYPES(self.type(), "bernoulli_scalar_cpu_", [&] {
     THGenerator* generator = get_generator(gen);
+    if (self.is_contiguous()) {
+      const uint64_t seed = philox_seed(generator);
+      scalar_t* self_data = self.data<scalar_t>();
+      parallel_for(0, self.numel(),
+          internal::grain_size_for_cost(internal::cost::ARITHMETIC),
+          [=](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          PhiloxRNG rng(seed, i);
+          self_data[i] = static_cast<scalar_t>(rng.uniform_double() < p);
+        }
+      });
+      return;
+    }
     std::lock_guard<std::mutex> lock(generator->mutex);
     CPU_tensor_apply1<scalar_t>(
         self, [generator, p](scalar_t& ret_val) {
@@ -1,5 +1,9 @@
 #include "ATen/ATen.h"
 #include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/core/PhiloxRNG.h"
+#include "ATen/native/Distributions.h"
+#include "TH/THRandom.h"
 
 namespace at { namespace native {
 
@@ -18,7 +22,20 @@ Tensor make_feature_noise(const Tensor& input) {
 }
 
 bool is_fused_kernel_acceptable(const Tensor& input, double p) {
-  return input.is_cuda() && p > 0 && p < 1;
+  const bool supported = input.is_cuda() ||
+      (input.type().backend() == Backend::CPU &&
+       (input.type().scalarType() == kFloat ||
+        input.type().scalarType() == kDouble));
+  return supported && p > 0 && p < 1;
+}
+
+// The mask of _fused_dropout_packed keeps element i if bit i % 32 of word
+// i / 32 is set. Saved for backward, it is 32 times smaller than a mask of the
+// input type.
+constexpr int64_t kMaskWordBits = 32;
+
+int64_t packed_mask_size(int64_t numel) {
+  return (numel + kMaskWordBits - 1) / kMaskWordBits;
 }
 
 // NB: sure, we could have used different overloads here, but I would feel insecure
@@ -82,7 +99,7 @@ ALIAS_SPECIALIZATION(_feature_alpha_dropout, true,  true )
 
 Tensor dropout(const Tensor& input, double p, bool train) {
   if (train && is_fused_kernel_acceptable(input, p)) {
-    return std::get<0>(at::_fused_dropout(input, 1 - p));
+    return std::get<0>(at::_fused_dropout_packed(input, 1 - p));
   }
   return _dropout<false>(input, p, train);
 }
@@ -115,4 +132,76 @@ Tensor& feature_alpha_dropout_(Tensor& input, double p, bool train) {
   return _feature_alpha_dropout<true>(input, p, train);
 }
 
+// Mask generation, scaling and application in a single pass. Like
+// THTensor_(uniform), word w of the mask draws its uniforms from Philox
+// subsequence w, so the result doesn't depend on the number of threads.
+std::tuple<Tensor,Tensor>
+fused_dropout_packed_cpu(const Tensor& self, double p, Generator* gen) {
+  auto input = self.contiguous();
+  Tensor ret = at::empty_like(input);
+  const int64_t numel = input.numel();
+  Tensor mask = at::empty(
+      {packed_mask_size(numel)}, self.options().dtype(kInt));
+  uint64_t seed;
+  {
+    THGenerator* generator = get_generator(gen);
+    std::lock_guard<std::mutex> lock(generator->mutex);
+    seed = THRandom_random64(generator);
+  }
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "fused_dropout_packed", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* ret_data = ret.data<scalar_t>();
+    int32_t* mask_data = mask.data<int32_t>();
+    const scalar_t scale = 1. / p;
+    parallel_for(0, mask.numel(), internal::GRAIN_SIZE / kMaskWordBits,
+        [&](int64_t begin, int64_t end) {
+      for (int64_t w = begin; w < end; ++w) {
+        PhiloxRNG rng(seed, w);
+        const int64_t first = w * kMaskWordBits;
+        const int64_t last = std::min(first + kMaskWordBits, numel);
+        uint32_t word = 0;
+        for (int64_t i = first; i < last; ++i) {
+          const bool keep = rng.uniform_float() < p;
+          word |= static_cast<uint32_t>(keep) << (i - first);
+          ret_data[i] = input_data[i] * (keep * scale);
+        }
+        mask_data[w] = static_cast<int32_t>(word);
+      }
+    });
+  });
+  return std::tuple<Tensor,Tensor>(ret, mask);
+}
+
+Tensor masked_scale_packed_cpu(
+    const Tensor& self, const Tensor& mask, double scale) {
+  AT_CHECK(mask.type().scalarType() == at::ScalarType::Int,
+           "packed mask should be torch.int32 dtype");
+  auto input = self.contiguous();
+  const int64_t numel = input.numel();
+  AT_CHECK(mask.numel() == packed_mask_size(numel),
+           "packed mask of ", mask.numel(), " words doesn't match a tensor of ",
+           numel, " elements");
+  auto mask_ = mask.contiguous();
+  Tensor ret = at::empty_like(input);
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "masked_scale_packed", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* ret_data = ret.data<scalar_t>();
+    const int32_t* mask_data = mask_.data<int32_t>();
+    const scalar_t scale_ = scale;
+    parallel_for(0, mask_.numel(), internal::GRAIN_SIZE / kMaskWordBits,
+        [&](int64_t begin, int64_t end) {
+      for (int64_t w = begin; w < end; ++w) {
+        const uint32_t word = static_cast<uint32_t>(mask_data[w]);
+        const int64_t first = w * kMaskWordBits;
+        const int64_t last = std::min(first + kMaskWordBits, numel);
+        for (int64_t i = first; i < last; ++i) {
+          const bool keep = (word >> (i - first)) & 1;
+          ret_data[i] = input_data[i] * (keep * scale_);
+        }
+      }
+    });
+  });
+  return ret;
+}
+
 }} // namespace at::native
@@ -1,9 +1,14 @@
 #include "ATen/ATen.h"
 #include "ATen/TensorUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/cpu/EmbeddingBagKernel.h"
 
 #include "TH/THBlasUtils.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -23,6 +28,9 @@ namespace {
 namespace at {
 namespace native {
 
+DEFINE_DISPATCH(embedding_bag_sum_kernel);
+DEFINE_DISPATCH(embedding_bag_fused_rowwise_kernel);
+
 static void make_offset2bag(const Tensor &offsets, const Tensor &indices,
                             Tensor &offset2bag) {
   offset2bag.index_add_(
@@ -31,31 +39,6 @@ static void make_offset2bag(const Tensor &offsets, const Tensor &indices,
   offset2bag = offset2bag.cumsum(0);     // offset2bag = [0 0 1 1 2]
 }
 
-// This function combines index_select (using select_indices as the index) and
-// index_add (using add_indices as the index), without creating an intermediary
-// tensor to hold the selected embeddings
-template<typename T>
-static void index_select_add(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output) {
-  auto add_indices_data = add_indices.data<int64_t>();
-  auto select_indices_data = select_indices.data<int64_t>();
-  auto src_data = src.data<T>();
-  auto output_data = output.data<T>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.size(1);
-  auto src_stride0 = src.stride(0);
-  auto src_stride1 = src.stride(1);
-  auto output_stride0 = output.stride(0);
-  auto output_stride1 = output.stride(1);
-  for (int64_t i = 0; i < numel; i++) {
-    THBlas_axpy<T>(ddim, 1,
-            src_data + src_stride0 * select_indices_data[i], src_stride1,
-            output_data + output_stride0 * add_indices_data[i], output_stride1);
-  }
-}
-
 static void make_bag_size(const Tensor &offsets, const Tensor &indices,
                           const int64_t mode, Tensor &bag_size) {
   if (mode == MODE_MEAN || mode == MODE_MAX) {
@@ -69,26 +52,6 @@ static void make_bag_size(const Tensor &offsets, const Tensor &indices,
   }
 }
 
-static Tensor apply_bag_size(const Tensor &offsets, const Tensor &indices,
-                             const int64_t mode, Tensor &output,
-                             const Tensor &bag_size) {
-  if (mode == MODE_MEAN) {
-    if (offsets.size(0) == 1) {
-      auto bag_size_ = indices.size(0);
-      output /= bag_size_;
-    } else {
-      // Avoid dividing by 0 for empty bags.
-      // Instead we want empty bags to return all 0s
-      auto bag_size_ = at::max(bag_size, at::ones_like(bag_size))
-                           .toType(output.type())
-                           .unsqueeze(1)
-                           .expand_as(output);
-      output /= bag_size_;
-    }
-  }
-  return output;
-}
-
 static Tensor apply_bag_size_backward(const Tensor &offsets,
                                       const Tensor &indices, const int64_t mode,
                                       Tensor &output, const Tensor &offset2bag,
@@ -190,13 +153,8 @@ _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
   auto output = at::zeros({offsets.size(0), weight.size(1)}, weight.options());
 
   if (mode == MODE_MEAN || mode == MODE_SUM) {
-    if (weight.type().scalarType() == kFloat) {
-      index_select_add<float>(indices, offset2bag, weight, output);
-    } else if (weight.type().scalarType() == kDouble) {
-      index_select_add<double>(indices, offset2bag, weight, output);
-    }
-    auto ret = apply_bag_size(offsets, indices, mode, output, bag_size);
-    return std::tuple<Tensor, Tensor, Tensor, Tensor>(ret, offset2bag, bag_size, bag_size);
+    embedding_bag_sum_kernel(kCPU, output, weight, indices, offsets, mode == MODE_MEAN);
+    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, bag_size);
   } else { // MODE_MAX
     return AT_DISPATCH_FLOATING_TYPES_AND_HALF(
       weight.type(), "embedding_bag_cpu_max", [&]() {
@@ -287,42 +245,37 @@ Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indi
   }
 
   if (mode == MODE_MEAN || mode == MODE_SUM) {
-    #pragma omp parallel for if (numel > 1000)
-      for (int64_t i = 0; i < (int64_t)counts_uniq.size(); i++) {
-        int64_t start = i == 0 ? 0 : counts_uniq[i - 1];
-        int64_t index = indices_data[start];
-        for (int64_t j = start; j < counts_uniq[i]; j++) {
-          int64_t source = offset2bag_data[j];
-          double scale = 1.0;
-          if (scale_grad_by_freq) {
-            scale /= counts[indices_data[i]];
-          }
-          if (mode == 1) { // MODE_MEAN
-            if (offsets_.size(0) == 1) {
-              auto bag_size = indices.size(0);
+    int64_t num_bags = offsets_.size(0);
+    int64_t ddim = grad.size(1);
+    AT_DISPATCH_FLOATING_TYPES(grad.type(), "embedding_bag_backward", [&] {
+      auto igwd = index_grad_weight.data<scalar_t>();
+      auto gd = grad.data<scalar_t>();
+      // Each unique index owns one row of index_grad_weight, so the rows can
+      // be accumulated in parallel without synchronization.
+      int64_t grain_size = std::max<int64_t>(
+          internal::GRAIN_SIZE / std::max<int64_t>(divup(numel, std::max<int64_t>(counts_uniq.size(), 1)) * ddim, 1), 1);
+      parallel_for(0, counts_uniq.size(), grain_size, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          int64_t start = i == 0 ? 0 : counts_uniq[i - 1];
+          int64_t index = indices_data[start];
+          for (int64_t j = start; j < counts_uniq[i]; j++) {
+            int64_t source = offset2bag_data[j];
+            double scale = 1.0;
+            if (scale_grad_by_freq) {
+              scale /= counts[index];
+            }
+            if (mode == MODE_MEAN) {
+              int64_t bag_size = source == num_bags - 1
+                  ? numel - offsets_data[num_bags - 1]
+                  : offsets_data[source + 1] - offsets_data[source];
               scale /= bag_size;
-            } else {
-              if (source == offsets_.size(0) - 1) {
-                scale /= indices.size(0) - offsets_data[offsets_.size(0) - 1];
-              } else {
-                scale /= offsets_data[source + 1] - offsets_data[source];
-              }
             }
-          }
-          int64_t ddim = grad.size(1);
-          if (grad.type().scalarType() == kFloat) {
-            auto igwd = index_grad_weight.data<float>();
-            auto gd = grad.data<float>();
-            THBlas_axpy<float>(ddim, (float)scale, gd + ddim * source, 1,
-                        igwd + ddim * index, 1);
-          } else if (grad.type().scalarType() == kDouble) {
-            auto igwd = index_grad_weight.data<double>();
-            auto gd = grad.data<double>();
-            THBlas_axpy<double>(ddim, (double)scale, gd + ddim * source, 1,
-                         igwd + ddim * index, 1);
+            THBlas_axpy<scalar_t>(ddim, (scalar_t)scale, gd + ddim * source, 1,
+                                  igwd + ddim * index, 1);
           }
         }
-      }
+      });
+    });
   } else if (mode == MODE_MAX) {
     auto nonempty_max_indices = max_indices_.index_select(0, bag_size_.nonzero().view(-1));
     auto nonempty_grad = grad_.index_select(0, bag_size_.nonzero().view(-1));
@@ -336,6 +289,131 @@ Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indi
   return index_grad_weight;
 }
 
+// See NOTE [ fused row-wise quantized embeddings ] in native_functions.yaml.
+// Each row is followed by a float scale and a float bias.
+static constexpr int64_t kFusedScaleBiasBytes = 2 * sizeof(float);
+
+static void check_fused_rowwise_bit_width(int64_t bit_width) {
+  AT_CHECK(bit_width == 8 || bit_width == 4,
+           "fused row-wise quantization supports 8 or 4 bits, got ", bit_width);
+}
+
+// Number of embedding values per row of a fused row-wise quantized table.
+// 4-bit rows always hold an even number of values, see
+// fused_rowwise_quantize_cpu.
+static int64_t fused_rowwise_embedding_dim(const Tensor& weight, int64_t bit_width) {
+  AT_CHECK(weight.dim() == 2 && weight.size(1) > kFusedScaleBiasBytes,
+           "expected a 2-D fused row-wise quantized tensor with more than ",
+           kFusedScaleBiasBytes, " columns, got sizes ", weight.sizes());
+  checkScalarType("fused_rowwise", TensorArg(weight, "weight", 1), kByte);
+  return (weight.size(1) - kFusedScaleBiasBytes) * 8 / bit_width;
+}
+
+Tensor fused_rowwise_quantize_cpu(const Tensor& self, int64_t bit_width) {
+  check_fused_rowwise_bit_width(bit_width);
+  AT_CHECK(self.dim() == 2, "fused_rowwise_quantize: expected a 2-D tensor, got ",
+           self.dim(), "-D");
+  checkScalarTypes("fused_rowwise_quantize", TensorArg(self, "self", 1), {kFloat, kDouble});
+  auto input = self.toType(kFloat).contiguous();
+  const int64_t rows = input.size(0);
+  const int64_t dim = input.size(1);
+  // odd 4-bit rows are padded with a zero so values pack into whole bytes
+  const int64_t packed_dim = (dim * bit_width + 7) / 8;
+  auto output = at::empty({rows, packed_dim + kFusedScaleBiasBytes}, input.options().dtype(kByte));
+  const float* input_data = input.data<float>();
+  uint8_t* output_data = output.data<uint8_t>();
+  const int64_t row_bytes = output.size(1);
+  const float levels = static_cast<float>((1 << bit_width) - 1);
+  // same epsilon as caffe2's FloatToFused8BitRowwiseQuantized
+  const float epsilon = 1e-8f;
+
+  parallel_for(0, rows, std::max<int64_t>(internal::GRAIN_SIZE / std::max<int64_t>(dim, 1), 1),
+               [&](int64_t begin, int64_t end) {
+    for (int64_t row = begin; row < end; row++) {
+      const float* in = input_data + row * dim;
+      uint8_t* out = output_data + row * row_bytes;
+      float minimum = dim > 0 ? in[0] : 0.f;
+      float maximum = minimum;
+      for (int64_t d = 1; d < dim; d++) {
+        minimum = std::min(minimum, in[d]);
+        maximum = std::max(maximum, in[d]);
+      }
+      const float range = maximum - minimum;
+      const float inverse_scale = levels / (range + epsilon);
+      auto quantize = [&](int64_t d) -> uint8_t {
+        float q = std::nearbyint((in[d] - minimum) * inverse_scale);
+        return static_cast<uint8_t>(std::min(std::max(q, 0.f), levels));
+      };
+      if (bit_width == 8) {
+        for (int64_t d = 0; d < dim; d++) {
+          out[d] = quantize(d);
+        }
+      } else {
+        std::memset(out, 0, packed_dim);
+        for (int64_t d = 0; d < dim; d++) {
+          out[d / 2] |= quantize(d) << ((d % 2) * 4);
+        }
+      }
+      float scale_bias[2] = {range / levels, minimum};
+      std::memcpy(out + packed_dim, scale_bias, sizeof(scale_bias));
+    }
+  });
+  return output;
+}
+
+Tensor fused_rowwise_dequantize_cpu(const Tensor& self, int64_t bit_width) {
+  check_fused_rowwise_bit_width(bit_width);
+  const int64_t dim = fused_rowwise_embedding_dim(self, bit_width);
+  auto input = self.contiguous();
+  const int64_t rows = input.size(0);
+  const int64_t row_bytes = input.size(1);
+  auto output = at::empty({rows, dim}, input.options().dtype(kFloat));
+  const uint8_t* input_data = input.data<uint8_t>();
+  float* output_data = output.data<float>();
+
+  parallel_for(0, rows, std::max<int64_t>(internal::GRAIN_SIZE / dim, 1),
+               [&](int64_t begin, int64_t end) {
+    for (int64_t row = begin; row < end; row++) {
+      const uint8_t* in = input_data + row * row_bytes;
+      float* out = output_data + row * dim;
+      float scale_bias[2];
+      std::memcpy(scale_bias, in + row_bytes - kFusedScaleBiasBytes, sizeof(scale_bias));
+      for (int64_t d = 0; d < dim; d++) {
+        uint8_t q = bit_width == 8 ? in[d] : (in[d / 2] >> ((d % 2) * 4)) & 0xF;
+        out[d] = scale_bias[0] * q + scale_bias[1];
+      }
+    }
+  });
+  return output;
+}
+
+Tensor embedding_bag_fused_rowwise_cpu(const Tensor& weight, const Tensor& indices_,
+                                       const Tensor& offsets_, int64_t mode,
+                                       int64_t bit_width) {
+  check_fused_rowwise_bit_width(bit_width);
+  AT_CHECK(mode == MODE_SUM || mode == MODE_MEAN,
+           "embedding_bag_fused_rowwise: only sum and mean modes are supported");
+  const int64_t dim = fused_rowwise_embedding_dim(weight, bit_width);
+  auto indices = indices_.contiguous();
+  auto offsets = offsets_.contiguous();
+  checkScalarType("embedding_bag_fused_rowwise", TensorArg(indices, "indices", 2), kLong);
+  checkScalarType("embedding_bag_fused_rowwise", TensorArg(offsets, "offsets", 3), kLong);
+  AT_CHECK(indices.dim() == 1 && offsets.dim() == 1,
+           "embedding_bag_fused_rowwise: indices and offsets must be 1-D");
+  AT_CHECK(weight.stride(1) == 1,
+           "embedding_bag_fused_rowwise: weight rows must be contiguous");
+  if (indices.numel() > 0) {
+    AT_CHECK(indices.min().item<int64_t>() >= 0 &&
+             indices.max().item<int64_t>() < weight.size(0),
+             "embedding_bag_fused_rowwise: index out of range");
+  }
+
+  auto output = at::zeros({offsets.size(0), dim}, weight.options().dtype(kFloat));
+  embedding_bag_fused_rowwise_kernel(kCPU, output, weight, indices, offsets,
+                                     mode == MODE_MEAN, bit_width);
+  return output;
+}
+
 Tensor _embedding_bag_sparse_backward(
     const Tensor &grad_, const Tensor &indices, const Tensor &offsets,
     const Tensor &offset2bag, const Tensor &bag_size_, int64_t num_weights,
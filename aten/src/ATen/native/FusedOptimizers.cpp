@@ -0,0 +1,83 @@
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/native/cpu/FusedOptimizersKernel.h"
+
+// CPU versions of the fused optimizer steps in cuda/FusedOptimizers.cu.
+// Every tensor is updated in a single vectorized pass, so a model whose
+// parameters are flattened into one buffer (see torch::optim::Optimizer::
+// flatten_parameters) is updated by a single pass over that buffer.
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(fused_adam_stub);
+DEFINE_DISPATCH(fused_sgd_stub);
+DEFINE_DISPATCH(fused_adagrad_stub);
+
+namespace {
+
+void check_cpu_tensor_lists(const char* name, const std::vector<TensorList>& tensor_lists) {
+  AT_CHECK(tensor_lists.size() > 0 && tensor_lists[0].size() > 0,
+           name, ": expected a non-empty list of tensors");
+  const auto& first = tensor_lists[0][0];
+  AT_CHECK(first.type().backend() == Backend::CPU, name, ": expected dense CPU tensors");
+  for (size_t l = 0; l < tensor_lists.size(); l++) {
+    AT_CHECK(tensor_lists[l].size() == tensor_lists[0].size(),
+             name, ": expected all tensor lists to have the same length, but list ", l,
+             " has ", tensor_lists[l].size(), " tensors and list 0 has ", tensor_lists[0].size());
+    for (size_t t = 0; t < tensor_lists[l].size(); t++) {
+      const auto& tensor = tensor_lists[l][t];
+      AT_CHECK(tensor.type() == first.type(),
+               name, ": expected all tensors to be ", first.type().toString(),
+               ", but tensor ", t, " of list ", l, " is ", tensor.type().toString());
+      AT_CHECK(tensor.is_contiguous(),
+               name, ": expected contiguous tensors, but tensor ", t, " of list ", l, " is not");
+      AT_CHECK(tensor.numel() == tensor_lists[0][t].numel(),
+               name, ": tensor ", t, " of list ", l, " has ", tensor.numel(),
+               " elements, but tensor ", t, " of list 0 has ", tensor_lists[0][t].numel());
+    }
+  }
+}
+
+} // anonymous namespace
+
+void _fused_adam_cpu_(
+    TensorList params, TensorList grads, TensorList exp_avgs, TensorList exp_avg_sqs,
+    double beta1, double beta2, double step_size, double eps, double weight_decay) {
+  check_cpu_tensor_lists("_fused_adam_", {params, grads, exp_avgs, exp_avg_sqs});
+  for (size_t t = 0; t < params.size(); t++) {
+    Tensor param = params[t], grad = grads[t], exp_avg = exp_avgs[t], exp_avg_sq = exp_avg_sqs[t];
+    fused_adam_stub(kCPU, param, grad, exp_avg, exp_avg_sq,
+                    beta1, beta2, step_size, eps, weight_decay);
+  }
+}
+
+void _fused_sgd_cpu_(
+    TensorList params, TensorList grads, TensorList momentum_buffers,
+    double lr, double momentum, double dampening, double weight_decay,
+    bool nesterov, bool first_run) {
+  if (momentum == 0) {
+    AT_CHECK(momentum_buffers.size() == 0,
+             "_fused_sgd_: momentum_buffers must be empty when momentum is 0");
+    check_cpu_tensor_lists("_fused_sgd_", {params, grads});
+  } else {
+    check_cpu_tensor_lists("_fused_sgd_", {params, grads, momentum_buffers});
+  }
+  for (size_t t = 0; t < params.size(); t++) {
+    Tensor param = params[t], grad = grads[t];
+    Tensor buffer = momentum != 0 ? momentum_buffers[t] : Tensor();
+    fused_sgd_stub(kCPU, param, grad, buffer,
+                   lr, momentum, dampening, weight_decay, nesterov, first_run);
+  }
+}
+
+void _fused_adagrad_cpu_(
+    TensorList params, TensorList grads, TensorList sums,
+    double clr, double weight_decay, double eps) {
+  check_cpu_tensor_lists("_fused_adagrad_", {params, grads, sums});
+  for (size_t t = 0; t < params.size(); t++) {
+    Tensor param = params[t], sum = sums[t];
+    fused_adagrad_stub(kCPU, param, grads[t], sum, clr, weight_decay, eps);
+  }
+}
+
+}} // namespace at::native
@@ -239,7 +239,7 @@ inline void baddbmm_cpu_kernel(const Tensor& result, const Tensor& self, const T
   auto s0 = self.accessor<scalar_t, 3>();
   auto m0 = mat2.accessor<scalar_t, 3>();
 
-  int64_t grain_size = std::min(internal::GRAIN_SIZE / (is * js * ks), (int64_t)1);
+  int64_t grain_size = std::max(internal::GRAIN_SIZE / (is * js * ks), (int64_t)1);
   parallel_for(0, bs, grain_size, [&](int64_t b_begin, int64_t b_end) {
       for (int64_t b = b_begin; b < b_end; b++) {
         auto r1 = r0[b];
@@ -248,18 +248,23 @@ inline void baddbmm_cpu_kernel(const Tensor& result, const Tensor& self, const T
         for (int64_t i = 0; i < is; i++) {
           auto r2 = r1[i];
           auto s2 = s1[i];
-          for (int64_t j = 0; j < js; j++) {
-            scalar_t &r = r2[j];
-            if (is_bmm) {
-              r = 0;
-              for (int64_t k = 0; k < ks; k++) {
-                r += s2[k] * m1[k][j];
-              }
-            } else {
-              r *= beta;
-              for (int64_t k = 0; k < ks; k++) {
-                r += alpha * s2[k] * m1[k][j];
-              }
+          // Like BLAS, beta == 0 ignores the previous contents of result.
+          if (is_bmm || beta == scalar_t(0)) {
+            for (int64_t j = 0; j < js; j++) {
+              r2[j] = 0;
+            }
+          } else if (beta != scalar_t(1)) {
+            for (int64_t j = 0; j < js; j++) {
+              r2[j] *= beta;
+            }
+          }
+          // i-k-j order: the inner loop walks a row of mat2 and of the
+          // result, which is unit stride for contiguous operands.
+          for (int64_t k = 0; k < ks; k++) {
+            auto m2 = m1[k];
+            scalar_t s = is_bmm ? s2[k] : alpha * s2[k];
+            for (int64_t j = 0; j < js; j++) {
+              r2[j] += s * m2[j];
             }
           }
         }
@@ -271,7 +276,9 @@ inline void baddbmm_cpu_kernel(const Tensor& result, const Tensor& self, const T
 // - When the operand size is small, computation are parallelized over the batch
 //   dimension using OMP and naive matrix multiplication is applied.
 // - When the operand size is larger than the threshold, if compiled with MKL, MKL's batch gemm is used.
-// - Otherwise, we use a series of matrix multiplications.
+// - Otherwise, we use a series of matrix multiplications. These are run in
+//   parallel over the batch when each one is too small for BLAS to
+//   parallelize well on its own.
 // The threshold of 400 for the first has not been thoroughly benchmarked yet and may have room for further
 // optimization, it likely depends on the characteristics of the CPU, MKL will be different from non-MKL etc.,
 // but this seems to be a first starting point.
@@ -330,16 +337,20 @@ static inline Tensor& bmm_out_or_baddbmm_(Tensor& self_or_result, const Tensor&
 	     && self_or_result.is_contiguous()) {
     at::native::_baddbmm_mkl_(self_or_result, batch1, batch2, beta, alpha);
   } else { // split along batch dimension
-    if (is_bmm_out) {
-      for (int64_t b = 0; b < bs; b++) {
-        auto r = self_or_result.select(0, b);
-        at::native::mm_out(r, batch1.select(0, b), batch2.select(0, b));
-      }
-    } else {
-      for (int64_t b = 0; b < bs; b++) {
-        self_or_result.select(0, b).addmm_(batch1.select(0, b), batch2.select(0, b), beta, alpha);
-      }
-    }
+    int64_t matmul_size = contraction_size * res_rows * res_cols;
+    int64_t grain_size = matmul_size < internal::GRAIN_SIZE * 8
+        ? std::max(internal::GRAIN_SIZE / matmul_size, (int64_t)1)
+        : bs;
+    parallel_for(0, bs, grain_size, [&](int64_t b_begin, int64_t b_end) {
+        for (int64_t b = b_begin; b < b_end; b++) {
+          auto r = self_or_result.select(0, b);
+          if (is_bmm_out) {
+            at::native::mm_out(r, batch1.select(0, b), batch2.select(0, b));
+          } else {
+            r.addmm_(batch1.select(0, b), batch2.select(0, b), beta, alpha);
+          }
+        }
+      });
   }
   return self_or_result;
 }
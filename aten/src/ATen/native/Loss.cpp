@@ -1,7 +1,8 @@
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
 #include "ATen/Dispatch.h"
-#include "ATen/CPUApplyUtils.h"
+#include "ATen/native/PointwiseOps.h"
+#include "ATen/native/TensorIterator.h"
 
 #define EPSILON 1e-12
 
@@ -18,6 +19,8 @@ namespace {
 
 namespace at { namespace native {
 
+DEFINE_DISPATCH(kl_div_backward_stub);
+
 Tensor cosine_embedding_loss(const Tensor& input1, const Tensor& input2, const Tensor& target, double margin, int64_t reduction) {
   auto prod_sum = (input1 * input2).sum(1);
   auto mag_square1 = (input1 * input1).sum(1) + EPSILON;
@@ -68,19 +71,14 @@ Tensor kl_div(const Tensor& input, const Tensor& target, int64_t reduction) {
 }
 
 Tensor kl_div_backward_cpu(const Tensor& grad, const Tensor& input, const Tensor& target, int64_t reduction) {
-  auto grad_input = at::zeros_like(input);
+  auto grad_input = at::empty_like(input);
   auto grad_expand = grad.expand_as(input);
-  AT_DISPATCH_FLOATING_TYPES(input.type(), "kl_div_backward", [&]() {
-    at::CPU_tensor_apply3<scalar_t, scalar_t, scalar_t>(
-        grad_input,
-        target,
-        grad_expand,
-        [] (scalar_t& grad_input_val, const scalar_t& target_val, const scalar_t& grad_val) {
-          if (target_val > 0) {
-            grad_input_val = -target_val * grad_val;
-          }
-        });
-  });
+  auto iter = TensorIterator::Builder()
+      .add_output(grad_input)
+      .add_input(target)
+      .add_input(grad_expand)
+      .build();
+  kl_div_backward_stub(iter->device_type(), *iter);
   if (reduction == Reduction::ElementwiseMean) {
     return grad_input / input.numel();
   }
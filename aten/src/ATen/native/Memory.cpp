@@ -16,5 +16,13 @@ Tensor pin_memory(const Tensor& self) {
   return tensor;
 }
 
+Tensor _pin_memory_in_place(const Tensor& self) {
+  if (self.type().backend() != Backend::CPU) {
+    AT_ERROR("cannot pin '", self.type().toString(), "' only CPU memory can be pinned");
+  }
+  detail::getCUDAHooks().pinStorageInPlace(self.storage().unsafeGetStorageImpl());
+  return self;
+}
+
 }
 }
@@ -0,0 +1,43 @@
+#include "ATen/ATen.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+
+#include <atomic>
+#include <cmath>
+
+// CPU versions of the ops in cuda/MultiTensorOps.cu, which loop over the
+// tensors, for models that are trained or tested on CPU.
+
+namespace at { namespace native {
+
+void _multi_tensor_unscale_cpu_(TensorList self, Tensor found_non_finite, double scale) {
+  AT_CHECK(found_non_finite.type().backend() == Backend::CPU &&
+           found_non_finite.type().scalarType() == kFloat && found_non_finite.numel() == 1,
+           "_multi_tensor_unscale_: expected found_non_finite to be a one-element float CPU tensor");
+  std::atomic<bool> found{false};
+  for (size_t t = 0; t < self.size(); t++) {
+    Tensor tensor = self[t];
+    AT_CHECK(tensor.type().backend() == Backend::CPU && tensor.is_contiguous(),
+             "_multi_tensor_unscale_: expected dense contiguous CPU tensors, but tensor ", t, " is not");
+    AT_DISPATCH_FLOATING_TYPES(tensor.type(), "_multi_tensor_unscale_", [&] {
+      scalar_t* data = tensor.data<scalar_t>();
+      const scalar_t s = static_cast<scalar_t>(scale);
+      parallel_for(0, tensor.numel(), internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        bool chunk_found = false;
+        for (int64_t i = begin; i < end; i++) {
+          chunk_found |= !std::isfinite(data[i]);
+          data[i] *= s;
+        }
+        if (chunk_found) {
+          found = true;
+        }
+      });
+    });
+  }
+  if (found) {
+    found_non_finite.fill_(1);
+  }
+}
+
+}} // namespace at::native
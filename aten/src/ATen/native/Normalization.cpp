@@ -4,6 +4,7 @@
 #include "ATen/Config.h"
 
 #include "ATen/detail/CUDAHooksInterface.h"
+#include "ATen/native/cpu/LayerNormKernel.h"
 
 #include <vector>
 
@@ -21,8 +22,18 @@ namespace {
     }
     return t;
   }
+
+  static inline Tensor contiguous_view_if_defined(const Tensor& t, IntList size) {
+    if (t.defined()) {
+      return t.contiguous().view(size);
+    }
+    return t;
+  }
 }
 
+DEFINE_DISPATCH(layer_norm_stub);
+DEFINE_DISPATCH(layer_norm_backward_stub);
+
 Tensor batch_norm(
     const Tensor& input, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
     const Tensor& running_mean /* optional */, const Tensor& running_var /* optional */,
@@ -159,6 +170,15 @@ Tensor layer_norm(const Tensor& input, IntList normalized_shape,
       n *= input_shape[i];
     }
 
+    // The CPU kernel computes the statistics and the affine transform of every
+    // row in one fused pass
+    if (input.type().backend() == Backend::CPU) {
+      auto out = std::get<0>(at::native_layer_norm(
+          input.contiguous(), contiguous_view_if_defined(weight, {-1}),
+          contiguous_view_if_defined(bias, {-1}), n, prod_intlist(normalized_shape), eps));
+      return out.view(input_shape);
+    }
+
     // Apply layer norm
     auto input_reshaped = input.contiguous().view({1, n, -1});
 
@@ -222,4 +242,76 @@ Tensor group_norm(const Tensor& input, int64_t num_groups,
     }
 }
 
+std::tuple<Tensor, Tensor, Tensor> layer_norm_cpu(
+    const Tensor& input, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
+    int64_t M, int64_t N, double eps) {
+  AT_CHECK(input.is_contiguous() && input.numel() == M * N,
+           "Expected a contiguous input of ", M, " rows of ", N, " elements, but got input of shape ",
+           input.sizes());
+  AT_CHECK(!weight.defined() || (weight.is_contiguous() && weight.numel() == N),
+           "Expected weight to be a contiguous tensor of ", N, " elements");
+  AT_CHECK(!bias.defined() || (bias.is_contiguous() && bias.numel() == N),
+           "Expected bias to be a contiguous tensor of ", N, " elements");
+
+  auto out = at::empty_like(input);
+  auto mean = at::empty({M}, input.options());
+  auto rstd = at::empty({M}, input.options());
+  if (M > 0) {
+    layer_norm_stub(kCPU, input, weight, bias, M, N, eps, out, mean, rstd);
+  }
+  return std::make_tuple(out, mean, rstd);
+}
+
+std::tuple<Tensor, Tensor, Tensor> layer_norm_backward_cpu(
+    const Tensor& grad_out, const Tensor& input, const Tensor& mean, const Tensor& rstd,
+    const Tensor& weight /* optional */, int64_t M, int64_t N, std::array<bool,3> output_mask) {
+  auto grad_out_ = grad_out.contiguous();
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) {
+    grad_input = at::empty_like(input);
+  }
+  if (output_mask[1]) {
+    grad_weight = at::empty({N}, input.options());
+  }
+  if (output_mask[2]) {
+    grad_bias = at::empty({N}, input.options());
+  }
+  if (M > 0) {
+    layer_norm_backward_stub(kCPU, grad_out_, input, mean, rstd, weight, M, N,
+                             grad_input, grad_weight, grad_bias);
+  } else {
+    if (grad_weight.defined()) grad_weight.zero_();
+    if (grad_bias.defined()) grad_bias.zero_();
+  }
+  return std::make_tuple(grad_input, grad_weight, grad_bias);
+}
+
+// Differentiable alternative to native_layer_norm_backward, for backward passes that
+// create a graph. The statistics are recomputed from input, so that the graph includes
+// their dependence on it.
+std::tuple<Tensor, Tensor, Tensor> _layer_norm_differentiable_backward(
+    const Tensor& grad_out, const Tensor& input, const Tensor& weight /* optional */,
+    int64_t M, int64_t N, double eps, std::array<bool,3> output_mask) {
+  auto x = input.contiguous().view({M, N});
+  auto dy = grad_out.contiguous().view({M, N});
+  auto x_mu = x - x.mean(1, /*keepdim=*/true);
+  auto rstd = (x_mu.pow(2).mean(1, /*keepdim=*/true) + eps).rsqrt();
+  auto x_hat = x_mu * rstd;
+
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) {
+    auto dx_hat = weight.defined() ? dy * weight.view({1, N}) : dy;
+    grad_input = (rstd * (dx_hat - dx_hat.mean(1, /*keepdim=*/true) -
+                          x_hat * (dx_hat * x_hat).mean(1, /*keepdim=*/true)))
+                     .view(input.sizes());
+  }
+  if (output_mask[1]) {
+    grad_weight = (dy * x_hat).sum(0);
+  }
+  if (output_mask[2]) {
+    grad_bias = dy.sum(0);
+  }
+  return std::make_tuple(grad_input, grad_weight, grad_bias);
+}
+
 }} // at::native
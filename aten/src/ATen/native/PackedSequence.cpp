@@ -1,6 +1,9 @@
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
 
+#include <list>
+#include <mutex>
+
 namespace at { namespace native {
 
 void checkLongTensor(const Tensor& tensor) {
@@ -9,12 +12,143 @@ void checkLongTensor(const Tensor& tensor) {
            "'lengths' argument should be a 1D CPU int64 tensor");
 }
 
-std::tuple<Tensor, Tensor> _pack_padded_sequence(const Tensor& _input, const Tensor& _lengths, bool batch_first) {
-  auto input = batch_first ? _input.transpose(0, 1) : _input;
+namespace {
+
+// The data of a PackedSequence is a gather of the padded tensor viewed as
+// [T * B, *] (or [B * T, *] if batch_first): time step after time step, the
+// elements of the sequences that are still running. packedIndex lists the
+// rows of that view, so that packing, unpacking and the backward of packing
+// are each a single index_select or index_copy_ instead of a copy per step.
+//
+// Slot j of a time step belongs to the j-th longest sequence, which is column
+// sorted_indices[j] of the padded tensor, or column j without sorted_indices.
+struct PackedIndexKey {
+  std::vector<int64_t> batch_sizes;
+  std::vector<int64_t> sorted_indices;
+  int64_t padded_length;
+  int64_t padded_batch_size;
+  bool batch_first;
+  Device device;
+  bool is_variable;
+
+  bool operator==(const PackedIndexKey& other) const {
+    return batch_sizes == other.batch_sizes &&
+        sorted_indices == other.sorted_indices &&
+        padded_length == other.padded_length &&
+        padded_batch_size == other.padded_batch_size &&
+        batch_first == other.batch_first && device == other.device &&
+        is_variable == other.is_variable;
+  }
+};
+
+// Batches with the same lengths tend to come back (e.g. the buckets of a data
+// loader), so the last few indices are kept on their device instead of being
+// built and copied again.
+constexpr size_t kMaxCachedIndices = 16;
+
+struct PackedIndexCache {
+  std::mutex mutex;
+  // most recently used first
+  std::list<std::pair<PackedIndexKey, Tensor>> entries;
+};
+
+PackedIndexCache& getPackedIndexCache() {
+  // Leaked, so that CUDA indices aren't freed after CUDA is torn down at exit
+  static PackedIndexCache* cache = new PackedIndexCache();
+  return *cache;
+}
+
+std::vector<int64_t> toVector(const Tensor& t) {
+  if (!t.defined()) {
+    return {};
+  }
+  auto data = t.data<int64_t>();
+  return std::vector<int64_t>(data, data + t.numel());
+}
+
+// batch_sizes_t and sorted_indices_t are contiguous CPU int64 tensors; the
+// index is made with the options of batch_sizes_t on the device of like.
+Tensor packedIndex(
+    const Tensor& batch_sizes_t,
+    const Tensor& sorted_indices_t,
+    int64_t padded_length,
+    int64_t padded_batch_size,
+    bool batch_first,
+    const Tensor& like) {
+  PackedIndexKey key{toVector(batch_sizes_t),
+                     toVector(sorted_indices_t),
+                     padded_length,
+                     padded_batch_size,
+                     batch_first,
+                     like.device(),
+                     batch_sizes_t.is_variable()};
+  auto& cache = getPackedIndexCache();
+  {
+    std::lock_guard<std::mutex> guard(cache.mutex);
+    for (auto it = cache.entries.begin(); it != cache.entries.end(); ++it) {
+      if (it->first == key) {
+        cache.entries.splice(cache.entries.begin(), cache.entries, it);
+        return it->second;
+      }
+    }
+  }
+
+  int64_t numel = 0;
+  for (auto batch_size : key.batch_sizes) {
+    numel += batch_size;
+  }
+  auto index_t = at::empty({numel}, batch_sizes_t.options());
+  int64_t* index = index_t.data<int64_t>();
+  const int64_t* sorted_indices = key.sorted_indices.empty() ? nullptr : key.sorted_indices.data();
+  for (int64_t t = 0; t < static_cast<int64_t>(key.batch_sizes.size()); ++t) {
+    for (int64_t j = 0; j < key.batch_sizes[t]; ++j) {
+      int64_t b = sorted_indices ? sorted_indices[j] : j;
+      *index++ = batch_first ? b * padded_length + t : t * padded_batch_size + b;
+    }
+  }
+  index_t = index_t.to(like.device());
+
+  std::lock_guard<std::mutex> guard(cache.mutex);
+  cache.entries.emplace_front(std::move(key), index_t);
+  if (cache.entries.size() > kMaxCachedIndices) {
+    cache.entries.pop_back();
+  }
+  return index_t;
+}
+
+// == [shape[0] * shape[1], *shape[2:]]
+std::vector<int64_t> flatShape(IntList sizes) {
+  std::vector<int64_t> shape;
+  shape.reserve(sizes.size() - 1);
+  shape.push_back(sizes[0] * sizes[1]);
+  auto s_sizes = sizes.slice(2);
+  shape.insert(shape.end(), s_sizes.begin(), s_sizes.end());
+  return shape;
+}
+
+void checkSortedIndices(const Tensor& sorted_indices, int64_t batch_size) {
+  if (!sorted_indices.defined()) {
+    return;
+  }
+  auto & t = sorted_indices.type();
+  AT_CHECK(sorted_indices.dim() == 1 && t.device_type() == at::kCPU && t.scalarType() == at::kLong,
+           "'sorted_indices' argument should be a 1D CPU int64 tensor");
+  AT_CHECK(sorted_indices.size(0) == batch_size,
+           "Expected `len(sorted_indices)` to be equal to batch_size, but got ",
+           sorted_indices.size(0), " (batch_size=", batch_size, ")");
+}
+
+std::tuple<Tensor, Tensor> packPaddedSequence(
+    const Tensor& input,
+    const Tensor& _lengths,
+    const Tensor& _sorted_indices,
+    bool batch_first) {
+  AT_CHECK(input.dim() >= 2, "Expected the padded input to have at least 2 dimensions");
   auto lengths_t = _lengths.contiguous();
   checkLongTensor(lengths_t);
 
-  int64_t batch_size = input.size(1);
+  int64_t padded_length = input.size(batch_first ? 1 : 0);
+  int64_t batch_size = input.size(batch_first ? 0 : 1);
   int64_t * lengths = lengths_t.data<int64_t>();
   AT_CHECK(lengths_t.size(0) == batch_size,
            "Expected `len(lengths)` to be equal to batch_size, but got ", lengths_t.size(0),
@@ -22,47 +156,25 @@ std::tuple<Tensor, Tensor> _pack_padded_sequence(const Tensor& _input, const Ten
   AT_CHECK(lengths[batch_size - 1] > 0,
            "Length of all samples has to be greater than 0, but found an element "
            "in 'lengths' that is <= 0");
+  AT_CHECK(lengths[0] <= padded_length,
+           "Expected the longest sequence to fit in the input, but got a length of ",
+           lengths[0], " for an input of length ", padded_length);
+  Tensor sorted_indices_t;
+  if (_sorted_indices.defined()) {
+    sorted_indices_t = _sorted_indices.contiguous();
+    checkSortedIndices(sorted_indices_t, batch_size);
+  }
 
-  std::vector<at::Tensor> steps;
-  steps.reserve(batch_size);
+  // batch_sizes[t] is the number of sequences that are longer than t. Going
+  // from the shortest sequence to the longest one, every time the length
+  // increases, the steps it adds have the batch size of the remaining ones.
   at::Tensor batch_sizes_t = at::empty(lengths[0], _lengths.options());
   int64_t * batch_sizes = batch_sizes_t.data<int64_t>();
-
-  std::vector<int64_t> step_shape; // == [-1, *input.shape[2:]]
-  {
-    auto input_sizes = input.sizes();
-    step_shape.reserve(input_sizes.size());
-    auto s_input_sizes = input_sizes.slice(2);
-    step_shape.push_back(-1);
-    step_shape.insert(step_shape.end(), s_input_sizes.begin(), s_input_sizes.end());
-  }
-
-  // To understand what's going on in this loop imagine that the input is a padded 2D
-  // array that looks like this (x = valid entry, . = padding)
-  //
-  //  1 1 1 1 1
-  //  2 2 2 . .
-  //  2 2 2 . .
-  //  4 . . . .
-  //  4 . . . .
-  //
-  // Where the vertical dimension corresponds to time, and horizontal dim to batch.
-  // In this example, the lengths array will be equal to [5, 3, 3, 1, 1], and we will
-  // iterate over them in reverse order (from the rightmost column to the left).
-  // We want to avoid eager slicing of the input at every time step, and wait for
-  // the moments where the length increases. In this example, that will happen at the
-  // first, second and fourth steps. Then, we slice out the whole block of the input
-  // that corresponds to this length, and hasn't been sliced yet (the steps at which each
-  // element is sliced are annotated in the array above).  You can think of this as if we
-  // were scanning the sequences from the shortest one, and every time we realize there's
-  // more elements below in our column, we lower the counter (prev_l), and append the new
-  // block to the output.
   int64_t prev_l = 0;
   for (int64_t i = 0; i < batch_size; ++i) {
     int64_t l = lengths[batch_size - 1 - i];
     if (l > prev_l) {
       auto current_batch_size = batch_size - i;
-      steps.push_back(input.slice(0, prev_l, l).slice(1, 0, current_batch_size).contiguous().view(step_shape));
       for (int64_t j = 0; j < (l - prev_l); ++j) {
         (*batch_sizes++) = current_batch_size;
       }
@@ -72,35 +184,19 @@ std::tuple<Tensor, Tensor> _pack_padded_sequence(const Tensor& _input, const Ten
     }
   }
 
-  return std::make_tuple(at::cat(steps), batch_sizes_t);
+  auto index = packedIndex(
+      batch_sizes_t, sorted_indices_t, padded_length, batch_size, batch_first, input);
+  auto flat_input = input.contiguous().view(flatShape(input.sizes()));
+  return std::make_tuple(flat_input.index_select(0, index), batch_sizes_t);
 }
 
-Tensor _pack_padded_sequence_backward(const Tensor& grad, at::IntList input_size, const Tensor& _batch_sizes, bool batch_first) {
-  std::vector<int64_t> input_size_after_t = input_size.vec();
-  if (batch_first) {
-    AT_CHECK(input_size.size() >= 2);
-    std::swap(input_size_after_t[0], input_size_after_t[1]);
-  }
-  auto grad_input = at::zeros(input_size_after_t, grad.options());
-  auto batch_sizes_t = _batch_sizes.contiguous();
-  checkLongTensor(batch_sizes_t);
-
-  int64_t offset = 0;
-  int64_t max_seq_len = batch_sizes_t.size(0);
-  int64_t * batch_sizes = batch_sizes_t.data<int64_t>();
-  for (int64_t i = 0; i < max_seq_len; ++i) {
-    grad_input[i].slice(0, 0, batch_sizes[i]).copy_(grad.slice(0, offset, offset + batch_sizes[i]));
-    offset += batch_sizes[i];
-  }
-
-  if (batch_first) {
-    grad_input = grad_input.transpose(0, 1);
-  }
-
-  return grad_input;
-}
-
-std::tuple<Tensor, Tensor> _pad_packed_sequence(const Tensor& data, const Tensor& _batch_sizes, bool batch_first, Scalar padding_value, int64_t total_length) {
+std::tuple<Tensor, Tensor> padPackedSequence(
+    const Tensor& data,
+    const Tensor& _batch_sizes,
+    const Tensor& _sorted_indices,
+    bool batch_first,
+    Scalar padding_value,
+    int64_t total_length) {
   auto batch_sizes_t = _batch_sizes.contiguous();
   checkLongTensor(batch_sizes_t);
 
@@ -115,6 +211,11 @@ std::tuple<Tensor, Tensor> _pad_packed_sequence(const Tensor& data, const Tensor
              "max sequence length being ", max_seq_length);
     max_seq_length = total_length;
   }
+  Tensor sorted_indices_t;
+  if (_sorted_indices.defined()) {
+    sorted_indices_t = _sorted_indices.contiguous();
+    checkSortedIndices(sorted_indices_t, max_batch_size);
+  }
 
   std::vector<int64_t> output_size; // == [max_seq_length, max_batch_size, *var_data.size()[1:]]
   {
@@ -124,43 +225,67 @@ std::tuple<Tensor, Tensor> _pad_packed_sequence(const Tensor& data, const Tensor
     auto s_data_size = data.sizes().slice(1);
     output_size.insert(output_size.end(), s_data_size.begin(), s_data_size.end());
   }
-  auto output = at::full(output_size, padding_value, data.options());
-
-  // This will be modified at every iteration, but we reserve memory for it now.
-  std::vector<int64_t> tmp_view_size = std::move(output_size); // == [-1, -1, *var_data.size()[1:]]
+  if (batch_first) {
+    std::swap(output_size[0], output_size[1]);
+  }
+  auto output = at::full(flatShape(output_size), padding_value, data.options());
+  auto index = packedIndex(
+      batch_sizes_t, sorted_indices_t, max_seq_length, max_batch_size, batch_first, data);
+  output.index_copy_(0, index, data);
 
+  // The j-th longest sequence is as long as the number of steps with more
+  // than j sequences
   at::Tensor lengths_t = at::empty(max_batch_size, batch_sizes_t.options());
-  int64_t * lengths = lengths_t.data<int64_t>() + max_batch_size - 1;
-  int64_t data_offset = 0;
+  int64_t * lengths = lengths_t.data<int64_t>();
+  const int64_t * sorted_indices =
+      sorted_indices_t.defined() ? sorted_indices_t.data<int64_t>() : nullptr;
   int64_t prev_batch_size = max_batch_size;
-  int64_t prev_i = 0;
   for (int64_t i = 0; i <= max_real_seq_length; ++i) {
     int64_t batch_size = i != max_real_seq_length ? batch_sizes[i] : 0;
-    if (batch_size != prev_batch_size) {
-      int64_t l = prev_batch_size * (i - prev_i);
-      // The lines below are equivalent to this:
-      // output[prev_i:i, :prev_batch_size] = tmp.view(i - prev_i, prev_batch_size, *input.shape[2:])
-      auto tmp = data.slice(0, data_offset, data_offset + l);
-      tmp_view_size[0] = i - prev_i;
-      tmp_view_size[1] = prev_batch_size;
-      output.slice(0, prev_i, i).slice(1, 0, prev_batch_size).copy_(tmp.view(tmp_view_size));
-      data_offset += l;
-      prev_i = i;
-    }
-    int64_t dec = prev_batch_size - batch_size;
-    if (dec > 0) {
-      for (int64_t j = 0; j < dec; ++j) {
-        (*lengths--) = i;
-      }
+    for (int64_t j = batch_size; j < prev_batch_size; ++j) {
+      lengths[sorted_indices ? sorted_indices[j] : j] = i;
     }
     prev_batch_size = batch_size;
   }
 
-  if (batch_first) {
-    output = output.transpose(0, 1);
+  return std::make_tuple(output.view(output_size), lengths_t);
+}
+
+} // anonymous namespace
+
+std::tuple<Tensor, Tensor> _pack_padded_sequence(const Tensor& input, const Tensor& lengths, bool batch_first) {
+  return packPaddedSequence(input, lengths, Tensor(), batch_first);
+}
+
+std::tuple<Tensor, Tensor> _pack_padded_sequence_permuted(const Tensor& input, const Tensor& lengths, const Tensor& sorted_indices, bool batch_first) {
+  return packPaddedSequence(input, lengths, sorted_indices, batch_first);
+}
+
+Tensor _pack_padded_sequence_backward(const Tensor& grad, at::IntList input_size, const Tensor& _batch_sizes, bool batch_first, const Tensor& _sorted_indices) {
+  AT_CHECK(input_size.size() >= 2);
+  auto batch_sizes_t = _batch_sizes.contiguous();
+  checkLongTensor(batch_sizes_t);
+  int64_t padded_length = input_size[batch_first ? 1 : 0];
+  int64_t batch_size = input_size[batch_first ? 0 : 1];
+  Tensor sorted_indices_t;
+  if (_sorted_indices.defined()) {
+    sorted_indices_t = _sorted_indices.contiguous();
+    checkSortedIndices(sorted_indices_t, batch_size);
   }
 
-  return std::make_tuple(output, lengths_t);
+  auto grad_input = at::zeros(flatShape(input_size), grad.options());
+  auto index = packedIndex(
+      batch_sizes_t, sorted_indices_t, padded_length, batch_size, batch_first, grad);
+  grad_input.index_copy_(0, index, grad);
+  return grad_input.view(input_size);
+}
+
+std::tuple<Tensor, Tensor> _pad_packed_sequence(const Tensor& data, const Tensor& batch_sizes, bool batch_first, Scalar padding_value, int64_t total_length) {
+  return padPackedSequence(data, batch_sizes, Tensor(), batch_first, padding_value, total_length);
+}
+
+std::tuple<Tensor, Tensor> _pad_packed_sequence_permuted(const Tensor& data, const Tensor& batch_sizes, const Tensor& sorted_indices, bool batch_first, Scalar padding_value, int64_t total_length) {
+  return padPackedSequence(data, batch_sizes, sorted_indices, batch_first, padding_value, total_length);
 }
 
 }} // namespace at::native
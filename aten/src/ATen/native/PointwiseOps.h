@@ -0,0 +1,27 @@
+#pragma once
+
+// Element-wise ops that used to be implemented with the serial TH_TENSOR_APPLY
+// and CPU_tensor_apply loops. Their CPU kernels use TensorIterator, which
+// coalesces dimensions and parallelizes the loop.
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { struct TensorIterator; }
+
+namespace at { namespace native {
+
+using clamp_fn = void(*)(TensorIterator&, Scalar min, Scalar max);
+using clamp_bound_fn = void(*)(TensorIterator&, Scalar bound);
+using pointwise_fn = void(*)(TensorIterator&);
+using pointwise_fn_scalar = void(*)(TensorIterator&, Scalar);
+
+DECLARE_DISPATCH(clamp_fn, clamp_stub);
+DECLARE_DISPATCH(clamp_bound_fn, clamp_min_stub);
+DECLARE_DISPATCH(clamp_bound_fn, clamp_max_stub);
+DECLARE_DISPATCH(pointwise_fn, where_stub);
+DECLARE_DISPATCH(pointwise_fn_scalar, hardshrink_stub);
+DECLARE_DISPATCH(pointwise_fn_scalar, hardshrink_backward_stub);
+DECLARE_DISPATCH(pointwise_fn, kl_div_backward_stub);
+
+}} // namespace at::native
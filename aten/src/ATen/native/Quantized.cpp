@@ -0,0 +1,145 @@
+#include "ATen/ATen.h"
+#include "ATen/TensorUtils.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// See NOTE [ affine quantization ] in native_functions.yaml.
+
+namespace at { namespace native {
+
+namespace {
+
+constexpr int64_t kQuantizedMin = 0;
+constexpr int64_t kQuantizedMax = 255;
+
+void check_quantization_params(const char* fn, const char* name, double scale, int64_t zero_point) {
+  AT_CHECK(scale > 0 && std::isfinite(scale), fn, ": expected a positive ", name,
+           "scale, got ", scale);
+  AT_CHECK(zero_point >= kQuantizedMin && zero_point <= kQuantizedMax, fn, ": expected ",
+           name, "zero_point in [", kQuantizedMin, ", ", kQuantizedMax, "], got ", zero_point);
+}
+
+inline uint8_t quantize_value(float value, float inverse_scale, int32_t zero_point, int32_t minimum) {
+  // nearbyint rounds halfway cases to even, like caffe2's Int8 ops
+  int32_t q = static_cast<int32_t>(std::nearbyint(value * inverse_scale)) + zero_point;
+  return static_cast<uint8_t>(std::min<int32_t>(std::max<int32_t>(q, minimum), kQuantizedMax));
+}
+
+} // anonymous namespace
+
+Tensor quantize_linear_cpu(const Tensor& self, double scale, int64_t zero_point) {
+  check_quantization_params("quantize_linear", "", scale, zero_point);
+  checkScalarTypes("quantize_linear", TensorArg(self, "self", 1), {kFloat, kDouble});
+  auto input = self.toType(kFloat).contiguous();
+  auto output = at::empty(input.sizes(), input.options().dtype(kByte));
+  const float* input_data = input.data<float>();
+  uint8_t* output_data = output.data<uint8_t>();
+  const float inverse_scale = static_cast<float>(1.0 / scale);
+  const int32_t zp = static_cast<int32_t>(zero_point);
+  parallel_for(0, input.numel(), internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      output_data[i] = quantize_value(input_data[i], inverse_scale, zp, kQuantizedMin);
+    }
+  });
+  return output;
+}
+
+Tensor dequantize_linear_cpu(const Tensor& self, double scale, int64_t zero_point) {
+  check_quantization_params("dequantize_linear", "", scale, zero_point);
+  checkScalarType("dequantize_linear", TensorArg(self, "self", 1), kByte);
+  auto input = self.contiguous();
+  auto output = at::empty(input.sizes(), input.options().dtype(kFloat));
+  const uint8_t* input_data = input.data<uint8_t>();
+  float* output_data = output.data<float>();
+  const float s = static_cast<float>(scale);
+  const int32_t zp = static_cast<int32_t>(zero_point);
+  parallel_for(0, input.numel(), internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      output_data[i] = s * static_cast<float>(static_cast<int32_t>(input_data[i]) - zp);
+    }
+  });
+  return output;
+}
+
+Tensor quantized_linear_cpu(
+    const Tensor& input, double input_scale, int64_t input_zero_point,
+    const Tensor& weight, double weight_scale, const Tensor& bias,
+    double output_scale, int64_t output_zero_point, bool relu) {
+  check_quantization_params("quantized_linear", "input_", input_scale, input_zero_point);
+  check_quantization_params("quantized_linear", "output_", output_scale, output_zero_point);
+  AT_CHECK(weight_scale > 0 && std::isfinite(weight_scale),
+           "quantized_linear: expected a positive weight_scale, got ", weight_scale);
+  checkScalarType("quantized_linear", TensorArg(input, "input", 1), kByte);
+  checkScalarType("quantized_linear", TensorArg(weight, "weight", 4), kChar);
+  AT_CHECK(weight.dim() == 2, "quantized_linear: expected a 2-D weight, got ", weight.dim(), "-D");
+  const int64_t N = weight.size(0);
+  const int64_t K = weight.size(1);
+  AT_CHECK(input.dim() >= 1 && input.size(-1) == K,
+           "quantized_linear: expected input with ", K, " features in the last dimension, but got size ",
+           input.sizes());
+  Tensor bias_float;
+  if (bias.defined()) {
+    AT_CHECK(bias.dim() == 1 && bias.size(0) == N,
+             "quantized_linear: expected a bias of size [", N, "], got ", bias.sizes());
+    bias_float = bias.toType(kFloat).contiguous();
+  }
+
+  auto x = input.contiguous();
+  int64_t M = 1;
+  for (int64_t d = 0; d < input.dim() - 1; d++) {
+    M *= input.size(d);
+  }
+  auto w = weight.contiguous();
+  std::vector<int64_t> output_sizes = input.sizes().vec();
+  output_sizes.back() = N;
+  auto output = at::empty(output_sizes, x.options());
+  const uint8_t* x_data = x.data<uint8_t>();
+  const int8_t* w_data = w.data<int8_t>();
+  const float* bias_data = bias_float.defined() ? bias_float.data<float>() : nullptr;
+  uint8_t* output_data = output.data<uint8_t>();
+
+  // sum_k (x - zx) * w == sum_k x * w - zx * sum_k w, so the inner loop is a
+  // plain uint8 x int8 dot product, which compilers vectorize.
+  std::vector<int32_t> weight_row_sums(N);
+  for (int64_t n = 0; n < N; n++) {
+    int32_t sum = 0;
+    for (int64_t k = 0; k < K; k++) {
+      sum += w_data[n * K + k];
+    }
+    weight_row_sums[n] = sum;
+  }
+  const int32_t zx = static_cast<int32_t>(input_zero_point);
+  const float accumulator_scale = static_cast<float>(input_scale * weight_scale);
+  const float inverse_output_scale = static_cast<float>(1.0 / output_scale);
+  const int32_t zy = static_cast<int32_t>(output_zero_point);
+  // relu(y) requantizes to max(q, zero_point)
+  const int32_t minimum = relu ? zy : static_cast<int32_t>(kQuantizedMin);
+
+  // Batch sizes are often tiny at inference time, so split the output
+  // features instead of the rows; each weight row stays hot for all rows.
+  parallel_for(0, N, std::max<int64_t>(internal::GRAIN_SIZE / std::max<int64_t>(M * K, 1), 1),
+               [&](int64_t begin, int64_t end) {
+    for (int64_t n = begin; n < end; n++) {
+      const int8_t* w_row = w_data + n * K;
+      const float b = bias_data ? bias_data[n] : 0.f;
+      const int32_t offset = zx * weight_row_sums[n];
+      for (int64_t m = 0; m < M; m++) {
+        const uint8_t* x_row = x_data + m * K;
+        int32_t acc = 0;
+        for (int64_t k = 0; k < K; k++) {
+          acc += static_cast<int32_t>(x_row[k]) * static_cast<int32_t>(w_row[k]);
+        }
+        const float y = static_cast<float>(acc - offset) * accumulator_scale + b;
+        output_data[m * N + n] = quantize_value(y, inverse_output_scale, zy, minimum);
+      }
+    }
+  });
+  return output;
+}
+
+}} // namespace at::native
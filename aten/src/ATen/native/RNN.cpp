@@ -2,6 +2,8 @@
 
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/TensorUtils.h"
+#include "ATen/native/cpu/RNNKernel.h"
 
 namespace at { namespace native {
 
@@ -38,6 +40,19 @@ struct CellParams {
   CellParams(const Tensor& _w_ih, const Tensor& _w_hh, const Tensor& _b_ih, const Tensor& _b_hh)
     : w_ih(_w_ih), w_hh(_w_hh), b_ih(_b_ih), b_hh(_b_hh) {};
 
+  Tensor matmul_ih(const Tensor& input) const {
+    return at::matmul(input, w_ih.t());
+  }
+  Tensor matmul_hh(const Tensor& h) const {
+    return at::matmul(h, w_hh.t());
+  }
+  Tensor linear_ih(const Tensor& input) const {
+    return at::linear(input, w_ih, b_ih);
+  }
+  Tensor linear_hh(const Tensor& h) const {
+    return at::linear(h, w_hh, b_hh);
+  }
+
   const Tensor& w_ih;
   const Tensor& w_hh;
   const Tensor& b_ih; /* optional */
@@ -133,70 +148,55 @@ tpair_of<Tensor> hidden_slice(const tpair_of<Tensor>& t, int64_t start, int64_t
 // which means that it consumes an input tensor, and updates the previous hidden state.
 // It's a struct only because functional programming in C++ is a pain, and it's easier
 // to pass around "vtable pointers" than actual function pointers.
+//
+// If pre_compute_input is true, input has already been multiplied by w_ih (without
+// b_ih). Layers use this to compute the input projection of all time steps with a
+// single matmul, leaving only the hidden projection inside the sequential loop.
 
 template<typename hidden_type_tmpl>
 struct Cell {
   using hidden_type = hidden_type_tmpl;
   virtual ~Cell() {} // This is really dumb, but enables projects with -Wnon-virtual-dtor to compile...
-  virtual hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params) const = 0;
+  virtual hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params,
+                                 bool pre_compute_input = false) const = 0;
 };
 
 template<typename nonlinearity>
 struct SimpleCell : Cell<Tensor> {
-  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params) const override {
-    return nonlinearity{}(at::linear(input, params.w_ih, params.b_ih) + at::linear(hidden, params.w_hh, params.b_hh));
+  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params,
+                         bool pre_compute_input = false) const override {
+    if (pre_compute_input) {
+      auto igates = params.b_ih.defined() ? input + params.b_ih : input;
+      return nonlinearity{}(igates + params.linear_hh(hidden));
+    }
+    return nonlinearity{}(params.linear_ih(input) + params.linear_hh(hidden));
   }
 };
 
-// TODO: can use inplace ops?
+// The gate nonlinearities and the state update run as a single fused kernel
+// (on CPU see native/cpu/RNNKernel.cpp), so a step costs two matmuls and one
+// pointwise op instead of a dozen separately dispatched ones.
 struct LSTMCell : Cell<std::tuple<Tensor, Tensor>> {
-  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params) const override {
-    auto hx = std::get<0>(hidden);
-    auto cx = std::get<1>(hidden);
-
-    if (input.is_cuda()) {
-      auto igates = at::matmul(input, params.w_ih.t());
-      auto hgates = at::matmul(hx, params.w_hh.t());
-      auto result = at::_thnn_fused_lstm_cell(igates, hgates, cx, params.b_ih, params.b_hh);
-      // Slice off the workspace argument (it's needed only for AD).
-      return std::make_tuple(std::get<0>(result), std::get<1>(result));
-    }
-
-    auto gates = at::linear(input, params.w_ih, params.b_ih) + at::linear(hx, params.w_hh, params.b_hh);
-    auto chunked_gates = gates.chunk(4, 1);
-
-    auto ingate = chunked_gates[0].sigmoid();
-    auto forgetgate = chunked_gates[1].sigmoid();
-    auto cellgate = chunked_gates[2].tanh();
-    auto outgate = chunked_gates[3].sigmoid();
-
-    auto cy = (forgetgate * cx) + (ingate * cellgate);
-    auto hy = outgate * cy.tanh();
-
-    return std::make_tuple(hy, cy);
+  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params,
+                         bool pre_compute_input = false) const override {
+    const auto& hx = std::get<0>(hidden);
+    const auto& cx = std::get<1>(hidden);
+    auto igates = pre_compute_input ? input : params.matmul_ih(input);
+    auto hgates = params.matmul_hh(hx);
+    auto result = at::_thnn_fused_lstm_cell(igates, hgates, cx, params.b_ih, params.b_hh);
+    // Slice off the workspace argument (it's needed only for AD).
+    return std::make_tuple(std::get<0>(result), std::get<1>(result));
   }
 };
 
 struct GRUCell : Cell<Tensor> {
-  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params) const override {
-    if (input.is_cuda()) {
-      auto igates = at::matmul(input, params.w_ih.t());
-      auto hgates = at::matmul(hidden, params.w_hh.t());
-      auto result = at::_thnn_fused_gru_cell(igates, hgates, hidden, params.b_ih, params.b_hh);
-      // Slice off the workspace argument (it's needed only for AD).
-      return std::get<0>(result);
-    }
-
-    auto igates = at::linear(input, params.w_ih, params.b_ih);
-    auto hgates = at::linear(hidden, params.w_hh, params.b_hh);
-    auto chunked_igates = igates.chunk(3, 1);
-    auto chunked_hgates = hgates.chunk(3, 1);
-
-    auto reset_gate = at::sigmoid(chunked_igates[0] + chunked_hgates[0]);
-    auto input_gate = at::sigmoid(chunked_igates[1] + chunked_hgates[1]);
-    auto new_gate = at::tanh(chunked_igates[2] + reset_gate * chunked_hgates[2]);
-
-    return new_gate + input_gate * (hidden - new_gate);
+  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params,
+                         bool pre_compute_input = false) const override {
+    auto igates = pre_compute_input ? input : params.matmul_ih(input);
+    auto hgates = params.matmul_hh(hidden);
+    auto result = at::_thnn_fused_gru_cell(igates, hgates, hidden, params.b_ih, params.b_hh);
+    // Slice off the workspace argument (it's needed only for AD).
+    return std::get<0>(result);
   }
 };
 
@@ -232,18 +232,20 @@ struct FullLayer : Layer<Tensor, hidden_type, CellParams> {
   FullLayer(Cell<hidden_type>& cell)
     : cell_(cell) {};
 
+  // step_inputs are the input projections of every step, see pre_compute_input in Cell.
   unstacked_output_type operator()(std::vector<Tensor> step_inputs, const hidden_type& input_hidden, const CellParams& params) const {
     std::vector<Tensor> step_outputs;
+    step_outputs.reserve(step_inputs.size());
     auto hidden = input_hidden;
     for (size_t i = 0; i < step_inputs.size(); i++) {
-      hidden = cell_(step_inputs[i], hidden, params);
+      hidden = cell_(step_inputs[i], hidden, params, /*pre_compute_input=*/true);
       step_outputs.push_back(hidden_as_output(hidden));
     }
     return {step_outputs, hidden};
   }
 
   output_type operator()(const Tensor& inputs, const hidden_type& input_hidden, const CellParams& params) const override {
-    auto unstacked_output = (*this)(inputs.unbind(0), input_hidden, params);
+    auto unstacked_output = (*this)(params.matmul_ih(inputs).unbind(0), input_hidden, params);
     return {at::stack(unstacked_output.outputs, 0), unstacked_output.final_hidden};
   }
 
@@ -260,11 +262,10 @@ struct FullBidirectionalLayer : Layer<Tensor, pair_of<dir_hidden_type>, pair_of<
     : layer_(cell) {};
 
   output_type operator()(const Tensor& input, const hidden_type& input_hidden, const param_type& params) const override {
-    auto step_inputs = input.unbind(0);
-    auto fw_result = layer_(step_inputs, input_hidden.first, params.first);
+    auto fw_result = layer_(params.first.matmul_ih(input).unbind(0), input_hidden.first, params.first);
     auto fw_output = at::stack(fw_result.outputs, 0);
 
-    auto rev_step_inputs = reverse(std::move(step_inputs));
+    auto rev_step_inputs = reverse(params.second.matmul_ih(input).unbind(0));
     auto rev_result = layer_(rev_step_inputs, input_hidden.second, params.second);
     std::reverse(rev_result.outputs.begin(), rev_result.outputs.end());
     auto rev_output = at::stack(rev_result.outputs, 0);
@@ -302,10 +303,11 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
     // which requires us to slice the hidden state (since some sequences
     // are completed now). The sliced parts are also saved, because we will need
     // to return a tensor of final hidden state.
+    auto input_w = params.matmul_ih(input.data);
     auto hidden = input_hidden;
     for (int64_t i = 0; i < num_steps; ++i) {
       int64_t batch_size = batch_sizes[i];
-      auto step_input = input.data.narrow(0, input_offset, batch_size);
+      auto step_input = input_w.narrow(0, input_offset, batch_size);
       input_offset += batch_size;
 
       int64_t dec = last_batch_size - batch_size;
@@ -315,7 +317,7 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
       }
 
       last_batch_size = batch_size;
-      hidden = cell_(step_input, hidden, params);
+      hidden = cell_(step_input, hidden, params, /*pre_compute_input=*/true);
       step_outputs.push_back(hidden_as_output(hidden));
     }
     hiddens.push_back(hidden);
@@ -345,6 +347,7 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
     // the smallest batch size (and a small set of hidden states we actually use),
     // and progressively expand the hidden states, as we move backwards over the
     // 1D list of inputs.
+    auto input_w = params.matmul_ih(input.data);
     auto hidden = hidden_slice(input_hidden, 0, batch_sizes[num_steps - 1]);
     for (int64_t i = num_steps - 1; i >= 0; --i) {
       int64_t batch_size = batch_sizes[i];
@@ -353,11 +356,11 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
         hidden = hidden_concat(ArrayRef<hidden_type>{hidden, hidden_slice(input_hidden, last_batch_size, batch_size)});
       }
 
-      auto step_input = input.data.narrow(0, input_offset - batch_size, batch_size);
+      auto step_input = input_w.narrow(0, input_offset - batch_size, batch_size);
       input_offset -= batch_size;
 
       last_batch_size = batch_size;
-      hidden = cell_(step_input, hidden, params);
+      hidden = cell_(step_input, hidden, params, /*pre_compute_input=*/true);
       step_outputs.push_back(hidden_as_output(hidden));
     }
     std::reverse(step_outputs.begin(), step_outputs.end());
@@ -488,6 +491,58 @@ std::tuple<io_type, Tensor, Tensor> _lstm_impl(
   return std::make_tuple(result.outputs, at::stack(hy, 0), at::stack(cy, 0));
 }
 
+// Factor will be 3 for GRU and 4 for LSTM
+void check_fused_cell_sizes(CheckedFrom c,
+                            const TensorArg& input_gates, const TensorArg& hidden_gates,
+                            const TensorArg& input_bias, const TensorArg& hidden_bias,
+                            int64_t factor, const TensorArg& prev_hidden) {
+  checkDim(c, input_gates, 2);
+  checkSameSize(c, input_gates, hidden_gates);
+  int64_t gates_size = input_gates->size(1);
+
+  if (input_bias->defined()) {
+    checkDim(c, input_bias, 1);
+    checkNumel(c, input_bias, gates_size);
+    checkSameSize(c, input_bias, hidden_bias);
+  }
+
+  checkDim(c, prev_hidden, 2);
+  checkNumel(c, prev_hidden, input_gates->size(0) * gates_size / factor);
+
+  checkAllSameType(c, {input_gates, hidden_gates, input_bias, hidden_bias, prev_hidden});
+}
+
+void check_lstm_backward_sizes(const TensorArg& grad_hy, const TensorArg& grad_cy,
+                               const TensorArg& cx, const TensorArg& cy,
+                               const TensorArg& workspace) {
+  CheckedFrom c = "_thnn_fused_lstm_cell_backward_cpu";
+  const TensorArg& defined_grad = grad_hy->defined() ? grad_hy : grad_cy;
+  checkDim(c, defined_grad, 2);
+  auto exp_size = defined_grad->sizes();
+  if (grad_hy->defined()) {
+    checkSize(c, grad_hy, exp_size);
+  }
+  if (grad_cy->defined()) {
+    checkSize(c, grad_cy, exp_size);
+  }
+  checkSize(c, cx, exp_size);
+  checkSize(c, cy, exp_size);
+  checkDim(c, workspace, 2);
+  checkNumel(c, workspace, exp_size[0] * exp_size[1] * 4);
+}
+
+constexpr int64_t GRU_WORKSPACE_MULTIPLIER = 5;
+
+void check_gru_backward_sizes(const TensorArg& grad_hy, const TensorArg& workspace) {
+  CheckedFrom c = "_thnn_fused_gru_cell_backward_cpu";
+  checkDim(c, grad_hy, 2);
+  checkSize(c, workspace, {grad_hy->size(0), grad_hy->size(1) * GRU_WORKSPACE_MULTIPLIER});
+}
+
+Tensor contiguous_if_defined(const Tensor& t) {
+  return t.defined() ? t.contiguous() : t;
+}
+
 } // anonymous namespace
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -612,4 +667,91 @@ Tensor rnn_relu_cell(
   return SimpleCell<relu_f>{}(input, hx, CellParams{w_ih, w_hh, b_ih, b_hh});
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// FUSED CELLS (CPU)
+//
+// The CUDA versions live in cuda/RNN.cu; these take the same arguments and
+// produce the same workspaces, so derivatives.yaml covers both.
+////////////////////////////////////////////////////////////////////////////////
+
+DEFINE_DISPATCH(lstm_cell_stub);
+DEFINE_DISPATCH(lstm_cell_backward_stub);
+DEFINE_DISPATCH(gru_cell_stub);
+DEFINE_DISPATCH(gru_cell_backward_stub);
+
+std::tuple<Tensor, Tensor, Tensor> _thnn_fused_lstm_cell_cpu(
+      const Tensor& input_gates, const Tensor& hidden_gates,
+      const Tensor& cx,
+      const Tensor& input_bias, const Tensor& hidden_bias) {
+  check_fused_cell_sizes("_thnn_fused_lstm_cell_cpu",
+                         {input_gates, "input_gates", 1}, {hidden_gates, "hidden_gates", 2},
+                         {input_bias, "input_bias", 3}, {hidden_bias, "hidden_bias", 4},
+                         /*factor=*/4, {cx, "prev_hidden", 5});
+
+  auto cx_ = cx.contiguous();
+  auto workspace = at::empty(input_gates.sizes(), input_gates.options());
+  auto hy = at::empty(cx_.sizes(), cx_.options());
+  auto cy = at::empty(cx_.sizes(), cx_.options());
+  lstm_cell_stub(kCPU, hy, cy, workspace,
+                 input_gates.contiguous(), hidden_gates.contiguous(), cx_,
+                 contiguous_if_defined(input_bias), contiguous_if_defined(hidden_bias));
+  return std::make_tuple(hy, cy, workspace);
+}
+
+std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> _thnn_fused_lstm_cell_backward_cpu(
+      const Tensor& grad_hy, const Tensor& grad_cy,
+      const Tensor& cx, const Tensor& cy,
+      const Tensor& workspace, bool has_bias) {
+  check_lstm_backward_sizes({grad_hy, "grad_hy", 1}, {grad_cy, "grad_cy", 2},
+                            {cx, "cx", 3}, {cy, "cy", 4},
+                            {workspace, "workspace", 5});
+
+  auto grad_gates = at::empty(workspace.sizes(), workspace.options());
+  auto grad_cx = at::empty(cx.sizes(), cx.options());
+  lstm_cell_backward_stub(kCPU, grad_gates, grad_cx,
+                          contiguous_if_defined(grad_hy), contiguous_if_defined(grad_cy),
+                          cx.contiguous(), cy.contiguous(), workspace.contiguous());
+
+  auto grad_bias = has_bias ? grad_gates.sum(0, /*keepdim=*/false) : at::Tensor{};
+  return std::make_tuple(grad_gates, grad_gates, grad_cx, grad_bias, grad_bias);
+}
+
+std::tuple<Tensor, Tensor> _thnn_fused_gru_cell_cpu(
+      const Tensor& input_gates, const Tensor& hidden_gates,
+      const Tensor& hx,
+      const Tensor& input_bias, const Tensor& hidden_bias) {
+  check_fused_cell_sizes("_thnn_fused_gru_cell_cpu",
+                         {input_gates, "input_gates", 1}, {hidden_gates, "hidden_gates", 2},
+                         {input_bias, "input_bias", 3}, {hidden_bias, "hidden_bias", 4},
+                         /*factor=*/3, {hx, "prev_hidden", 5});
+
+  auto hx_ = hx.contiguous();
+  auto workspace = at::empty({hx_.size(0), hx_.size(1) * GRU_WORKSPACE_MULTIPLIER}, hx_.options());
+  auto hy = at::empty(hx_.sizes(), hx_.options());
+  gru_cell_stub(kCPU, hy, workspace,
+                input_gates.contiguous(), hidden_gates.contiguous(), hx_,
+                contiguous_if_defined(input_bias), contiguous_if_defined(hidden_bias));
+  return std::make_tuple(hy, workspace);
+}
+
+std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> _thnn_fused_gru_cell_backward_cpu(
+      const Tensor& grad_hy, const Tensor& workspace, bool has_bias) {
+  check_gru_backward_sizes({grad_hy, "grad_hy", 1}, {workspace, "workspace", 2});
+
+  int64_t hidden_size = workspace.size(1) / GRU_WORKSPACE_MULTIPLIER;
+  auto grad_input_gates = at::empty({workspace.size(0), hidden_size * 3}, workspace.options());
+  auto grad_hidden_gates = at::empty({workspace.size(0), hidden_size * 3}, workspace.options());
+  auto grad_hx = at::empty(grad_hy.sizes(), grad_hy.options());
+  gru_cell_backward_stub(kCPU, grad_input_gates, grad_hidden_gates, grad_hx,
+                         grad_hy.contiguous(), workspace.contiguous());
+
+  at::Tensor grad_input_bias, grad_hidden_bias;
+  if (has_bias) {
+    grad_input_bias = grad_input_gates.sum(0, /*keepdim=*/false);
+    grad_hidden_bias = grad_hidden_gates.sum(0, /*keepdim=*/false);
+  }
+
+  return std::make_tuple(grad_input_gates, grad_hidden_gates, grad_hx, grad_input_bias, grad_hidden_bias);
+}
+
 }}  // namespace at::native
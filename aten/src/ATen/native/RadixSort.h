@@ -0,0 +1,117 @@
+#pragma once
+
+// Parallel LSD radix sort of (key, value) pairs on CPU.
+//
+// Keys are unsigned 64-bit integers whose unsigned order is the order wanted
+// for the original scalars; radix_key() produces such keys for the integral
+// and floating point types. The sort is stable and makes one counting pass
+// per 8-bit digit, skipping digits that are the same for every key, so e.g.
+// small non-negative integer IDs only take one or two passes.
+
+#include <ATen/Parallel.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace at { namespace native {
+
+template <typename scalar_t>
+inline typename std::enable_if<std::is_integral<scalar_t>::value, uint64_t>::type
+radix_key(scalar_t x) {
+  // flipping the sign bit maps the signed range onto the unsigned one
+  return std::is_signed<scalar_t>::value
+      ? static_cast<uint64_t>(static_cast<int64_t>(x)) ^ (uint64_t(1) << 63)
+      : static_cast<uint64_t>(x);
+}
+
+template <typename scalar_t>
+inline typename std::enable_if<std::is_floating_point<scalar_t>::value, uint64_t>::type
+radix_key(scalar_t x) {
+  // -0.0 and 0.0 compare equal, so give them the same key
+  double d = x == 0 ? 0.0 : static_cast<double>(x);
+  uint64_t bits;
+  std::memcpy(&bits, &d, sizeof(bits));
+  // negative numbers: reverse their order; positive ones: move above them
+  return (bits >> 63) ? ~bits : bits | (uint64_t(1) << 63);
+}
+
+// Sorts keys[0:n] and applies the same permutation to values[0:n].
+template <typename value_t>
+void radix_sort_pairs(uint64_t* keys, value_t* values, int64_t n) {
+  constexpr int kBits = 8;
+  constexpr int kBuckets = 1 << kBits;
+  if (n < 2) {
+    return;
+  }
+
+  // Digits on which all keys agree do not affect the order.
+  uint64_t varying = 0;
+  for (int64_t i = 1; i < n; i++) {
+    varying |= keys[i] ^ keys[0];
+  }
+  if (varying == 0) {
+    return;
+  }
+
+  const int64_t num_chunks = std::max<int64_t>(
+      std::min<int64_t>(divup(n, internal::GRAIN_SIZE), std::max(get_num_threads(), 1)), 1);
+  const int64_t chunk_size = divup(n, num_chunks);
+
+  std::vector<uint64_t> keys_tmp(n);
+  std::vector<value_t> values_tmp(n);
+  uint64_t* keys_src = keys;
+  value_t* values_src = values;
+  uint64_t* keys_dst = keys_tmp.data();
+  value_t* values_dst = values_tmp.data();
+  std::vector<std::array<int64_t, kBuckets>> offsets(num_chunks);
+
+  for (int shift = 0; shift < 64; shift += kBits) {
+    if (((varying >> shift) & (kBuckets - 1)) == 0) {
+      continue;
+    }
+    // per-chunk histograms
+    parallel_for(0, num_chunks, 1, [&](int64_t chunk_begin, int64_t chunk_end) {
+      for (int64_t c = chunk_begin; c < chunk_end; c++) {
+        auto& hist = offsets[c];
+        hist.fill(0);
+        int64_t end = std::min(n, (c + 1) * chunk_size);
+        for (int64_t i = c * chunk_size; i < end; i++) {
+          hist[(keys_src[i] >> shift) & (kBuckets - 1)]++;
+        }
+      }
+    });
+    // exclusive prefix sum in (digit, chunk) order keeps the sort stable
+    int64_t total = 0;
+    for (int b = 0; b < kBuckets; b++) {
+      for (int64_t c = 0; c < num_chunks; c++) {
+        int64_t count = offsets[c][b];
+        offsets[c][b] = total;
+        total += count;
+      }
+    }
+    parallel_for(0, num_chunks, 1, [&](int64_t chunk_begin, int64_t chunk_end) {
+      for (int64_t c = chunk_begin; c < chunk_end; c++) {
+        auto& pos = offsets[c];
+        int64_t end = std::min(n, (c + 1) * chunk_size);
+        for (int64_t i = c * chunk_size; i < end; i++) {
+          int64_t dst = pos[(keys_src[i] >> shift) & (kBuckets - 1)]++;
+          keys_dst[dst] = keys_src[i];
+          values_dst[dst] = values_src[i];
+        }
+      }
+    });
+    std::swap(keys_src, keys_dst);
+    std::swap(values_src, values_dst);
+  }
+
+  if (keys_src != keys) {
+    std::copy(keys_src, keys_src + n, keys);
+    std::copy(values_src, values_src + n, values);
+  }
+}
+
+}} // namespace at::native
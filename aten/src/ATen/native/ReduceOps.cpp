@@ -4,6 +4,7 @@
 #include "ATen/NativeFunctions.h"
 #include "ATen/WrapDimUtils.h"
 #include "ATen/WrapDimUtilsMulti.h"
+#include "ReduceOps.h"
 #include "ReduceOpsUtils.h"
 #include "cpu/ReduceOpsKernel.h"
 
@@ -20,6 +21,12 @@ namespace native {
 DEFINE_DISPATCH(sum_kernel);
 DEFINE_DISPATCH(prod_kernel);
 DEFINE_DISPATCH(norm_kernel);
+DEFINE_DISPATCH(std_var_kernel);
+DEFINE_DISPATCH(sum_stub);
+DEFINE_DISPATCH(prod_stub);
+DEFINE_DISPATCH(mean_stub);
+DEFINE_DISPATCH(std_var_stub);
+DEFINE_DISPATCH(var_mean_stub);
 
 static inline Tensor integer_upcast(const Tensor& self, optional<ScalarType> dtype) {
   ScalarType scalarType = self.type().scalarType();
@@ -170,6 +177,12 @@ static inline Tensor &mean_out(Tensor &result, const Tensor &self, int64_t dim,
       "Can only calculate the mean of floating types. Got ",
       at::toString(scalarType),
       " instead.");
+  if (self.is_cuda() && self.numel() > 0) {
+    if (_reduce_iter(mean_stub, result, self.toType(result.type().scalarType()),
+                     dim, keepdim)) {
+      return result;
+    }
+  }
   at::native::sum_out(
       result, self.toType(result.type().scalarType()), dim, keepdim);
   if (result.numel() > 0 && self.ndimension() > 0) {
@@ -281,6 +294,12 @@ static inline Tensor mean(const Tensor &self, int64_t dim, bool keepdim, optiona
       "Can only calculate the mean of floating types. Got ",
       at::toString(scalarType),
       " instead.");
+  if (self.is_cuda() && self.numel() > 0) {
+    Tensor result = at::empty({0}, self.options());
+    if (_reduce_iter(mean_stub, result, self, dim, keepdim)) {
+      return result;
+    }
+  }
   Tensor result = at::native::sum(self, dim, keepdim);
   if (result.numel() > 0 && self.ndimension() > 0) {
     int64_t numel = self.size(dim);
@@ -580,11 +599,25 @@ Tensor& _sum_out(Tensor &result, const Tensor &self, int64_t dim, bool keepdim)
 }
 
 Tensor _sum(const Tensor &self, IntList dims, bool keepdim) {
+  if (self.is_cuda() && dims.size() > 1) {
+    Tensor result = at::empty({0}, self.options());
+    return at::native::_sum_out(result, self, dims, keepdim);
+  }
   return reduce_multi_associative<_sum, _sum_out>(self, dims, keepdim);
 }
 
 Tensor& _sum_out(Tensor &result, const Tensor &self, IntList dims, bool keepdim)
 {
+  // The CUDA kernel reduces all the dimensions in a single pass.
+  if (self.is_cuda() && dims.size() > 1) {
+    if (self.numel() == 0) {
+      _reduce_setup(result, self, dims, keepdim);
+      return result.fill_(0);
+    }
+    if (_reduce_iter(sum_stub, result, self, dims, keepdim)) {
+      return result;
+    }
+  }
   return reduce_multi_associative_out<_sum, _sum_out>(result, self, dims, keepdim);
 }
 
@@ -684,12 +717,41 @@ Tensor &any_out(Tensor &result, const Tensor &self, int64_t dim, bool keepdim) {
   }
 }
 
+static Tensor _std_var_all_cpu(const Tensor& self, bool unbiased, bool take_sqrt) {
+  auto input = self.contiguous();
+  Tensor result = at::empty({}, self.options());
+  std_var_kernel(kCPU, result, input, c10::nullopt, unbiased, take_sqrt);
+  return result;
+}
+
+static Tensor& _std_var_out_cpu(Tensor& result, const Tensor& self, int64_t dim,
+                                bool unbiased, bool keepdim, bool take_sqrt) {
+  auto input = self.contiguous();
+  _dimreduce_setup(result, input, dim);
+  AT_ASSERT(result.is_contiguous());
+  std_var_kernel(kCPU, result, input, dim, unbiased, take_sqrt);
+  if (!keepdim) {
+    result.squeeze_(dim);
+  }
+  return result;
+}
+
 Tensor var(const Tensor& self, bool unbiased) {
   AT_CHECK(self.type().backend() == Backend::CPU || self.type().backend() == Backend::CUDA,
            "var only supports CPU AND CUDA backend, got: ", at::toString(self.type().backend()));
   AT_CHECK(at::isFloatingType(self.type().scalarType()), "var only supports floating-point dtypes");
   auto trivial_return = _allreduce_return_trivial(self, std::numeric_limits<double>::quiet_NaN());
-  return trivial_return.has_value() ? trivial_return.value() : at::_th_var(self, unbiased);
+  if (trivial_return.has_value()) {
+    return trivial_return.value();
+  }
+  if (self.type().backend() == Backend::CPU) {
+    return _std_var_all_cpu(self, unbiased, /*take_sqrt=*/false);
+  }
+  Tensor result = at::empty({}, self.options());
+  if (_reduce_iter(std_var_stub, result, self, {}, false, unbiased, /*take_sqrt=*/false)) {
+    return result;
+  }
+  return at::_th_var(self, unbiased);
 }
 
 Tensor var(const Tensor& self, int64_t dim, bool unbiased, bool keepdim) {
@@ -704,6 +766,11 @@ Tensor &var_out(Tensor &result, const Tensor &self, int64_t dim, bool unbiased,
   dim = maybe_wrap_dim(dim, self.dim());
   if (_dimreduce_return_trivial(result, self, std::numeric_limits<double>::quiet_NaN(), dim, keepdim)) {
     return result;
+  } else if (self.type().backend() == Backend::CPU && result.is_contiguous()) {
+    return _std_var_out_cpu(result, self, dim, unbiased, keepdim, /*take_sqrt=*/false);
+  } else if (self.type().backend() == Backend::CUDA &&
+             _reduce_iter(std_var_stub, result, self, dim, keepdim, unbiased, /*take_sqrt=*/false)) {
+    return result;
   } else {
     return at::_th_var_out(result, self, dim, unbiased, keepdim);
   }
@@ -714,7 +781,17 @@ Tensor std(const Tensor& self, bool unbiased) {
            "std only supports CPU AND CUDA backend, got: ", at::toString(self.type().backend()));
   AT_CHECK(at::isFloatingType(self.type().scalarType()), "std only supports floating-point dtypes");
   auto trivial_return = _allreduce_return_trivial(self, std::numeric_limits<double>::quiet_NaN());
-  return trivial_return.has_value() ? trivial_return.value() : at::_th_std(self, unbiased);
+  if (trivial_return.has_value()) {
+    return trivial_return.value();
+  }
+  if (self.type().backend() == Backend::CPU) {
+    return _std_var_all_cpu(self, unbiased, /*take_sqrt=*/true);
+  }
+  Tensor result = at::empty({}, self.options());
+  if (_reduce_iter(std_var_stub, result, self, {}, false, unbiased, /*take_sqrt=*/true)) {
+    return result;
+  }
+  return at::_th_std(self, unbiased);
 }
 
 Tensor std(const Tensor& self, int64_t dim, bool unbiased, bool keepdim) {
@@ -729,9 +806,18 @@ Tensor &std_out(Tensor &result, const Tensor &self, int64_t dim, bool unbiased,
   dim = maybe_wrap_dim(dim, self.dim());
   if (_dimreduce_return_trivial(result, self, std::numeric_limits<double>::quiet_NaN(), dim, keepdim)) {
     return result;
+  } else if (self.type().backend() == Backend::CPU && result.is_contiguous()) {
+    return _std_var_out_cpu(result, self, dim, unbiased, keepdim, /*take_sqrt=*/true);
+  } else if (self.type().backend() == Backend::CUDA &&
+             _reduce_iter(std_var_stub, result, self, dim, keepdim, unbiased, /*take_sqrt=*/true)) {
+    return result;
   } else {
     return at::_th_std_out(result, self, dim, unbiased, keepdim);
   }
 }
 
+std::tuple<Tensor, Tensor> _var_mean_cpu(const Tensor& self, int64_t dim, bool unbiased, bool keepdim) {
+  return std::make_tuple(at::var(self, dim, unbiased, keepdim), at::mean(self, dim, keepdim));
+}
+
 }} // namespace at::native
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { struct TensorIterator; }
+
+namespace at { namespace native {
+
+// Reductions over a TensorIterator built with TensorIterator::reduce_op().
+// Only CUDA kernels exist for now (cuda/ReduceOpsKernel.cu); the CPU kernels
+// are declared in cpu/ReduceOpsKernel.h.
+
+using reduce_iter_fn = void(*)(TensorIterator&);
+using std_var_iter_fn = void(*)(TensorIterator&, bool unbiased, bool take_sqrt);
+using var_mean_iter_fn = void(*)(TensorIterator&, bool unbiased);
+
+DECLARE_DISPATCH(reduce_iter_fn, sum_stub);
+DECLARE_DISPATCH(reduce_iter_fn, prod_stub);
+DECLARE_DISPATCH(reduce_iter_fn, mean_stub);
+DECLARE_DISPATCH(std_var_iter_fn, std_var_stub);
+// Writes the variance to the first output and the mean to the second.
+DECLARE_DISPATCH(var_mean_iter_fn, var_mean_stub);
+
+}} // namespace at::native
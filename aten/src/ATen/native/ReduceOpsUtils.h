@@ -1,5 +1,9 @@
 #pragma once
 
+#include <ATen/ATen.h>
+#include <ATen/WrapDimUtilsMulti.h>
+#include <ATen/native/TensorIterator.h>
+
 namespace at { namespace native {
 
 static Tensor &_dimreduce_setup(Tensor &result, const Tensor &self,
@@ -53,4 +57,52 @@ static c10::optional<Tensor> _allreduce_return_trivial(
   }
   return c10::nullopt;
 }
+// Resizes `result` to the shape of `self` reduced over `dim` (all dimensions
+// if `dim` is empty) and returns a view of it that keeps the reduced
+// dimensions with size 1, as expected by TensorIterator::reduce_op().
+static Tensor _reduce_setup(Tensor &result, const Tensor &self, IntList dim,
+                            bool keepdim) {
+  int64_t ndim = self.dim();
+  auto mask = dim_list_to_bitset(dim, ndim);
+  if (dim.empty()) {
+    mask.set();
+  }
+  auto shape = self.sizes().vec();
+  for (int64_t d = ndim - 1; d >= 0; d--) {
+    if (mask[d]) {
+      if (keepdim) {
+        shape[d] = 1;
+      } else {
+        shape.erase(shape.begin() + d);
+      }
+    }
+  }
+  result.resize_(shape);
+  if (keepdim) {
+    return result;
+  }
+  Tensor viewed_result = result;
+  for (int64_t d = 0; d < ndim; d++) {
+    if (mask[d]) {
+      viewed_result = viewed_result.unsqueeze(d);
+    }
+  }
+  return viewed_result;
+}
+
+// Reduces non-empty `self` into `result` with one of the TensorIterator
+// kernels in ReduceOps.h. Returns false if the reduction of a single output
+// element does not fit 32-bit indexing; `result` is resized in any case, and
+// the caller should fall back to the TH kernels.
+template <typename Stub, typename... Args>
+static bool _reduce_iter(Stub &stub, Tensor &result, const Tensor &self,
+                         IntList dim, bool keepdim, Args... args) {
+  Tensor viewed_result = _reduce_setup(result, self, dim, keepdim);
+  auto iter = TensorIterator::reduce_op(viewed_result, self);
+  if (!iter->reduced_dims_fit_32bit_indexing()) {
+    return false;
+  }
+  stub(iter->device_type(), *iter, args...);
+  return true;
+}
 }}  // at::native
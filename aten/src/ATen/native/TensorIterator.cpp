@@ -29,7 +29,16 @@ void TensorIterator::reorder_dimensions() {
   perm_.resize(ndim());
   std::iota(std::begin(perm_), std::end(perm_), 0);
 
+  // Reductions keep the reduced dimensions (stride 0 in the outputs) in front
+  // of the others, so that kernels can index them separately.
+  auto is_reduced = [&](size_t dim) {
+    return is_reduction_ && operands_[0].stride_bytes[dim] == 0;
+  };
+
   std::sort(std::begin(perm_), std::end(perm_), [&](size_t i1, size_t i2) {
+    if (is_reduced(i1) != is_reduced(i2)) {
+      return is_reduced(i1);
+    }
     return sum_of_strides[i1] < sum_of_strides[i2];
   });
 
@@ -57,6 +66,8 @@ compute_result_type(at::ArrayRef<OperandInfo> operands, const F& predicate) {
   auto backend = Backend::Undefined;
   for (auto& op : operands) {
     if (!op.tensor->defined()) continue;
+    // operands with a fixed type don't affect the result type
+    if (op.type) continue;
     if (!predicate(*op.tensor)) continue;
     auto dtype = op.tensor->type().scalarType();;
     result_type = (result_type == ScalarType::Undefined
@@ -115,6 +126,8 @@ void TensorIterator::compute_common_type() {
         op.tensor = &(cast_tensors_.back());
         op.needs_cast = false;
       }
+    } else {
+      op.needs_cast = needs_cast(*op.tensor, *op.type);
     }
   }
 }
@@ -144,7 +157,7 @@ DimVector TensorIterator::invert_perm(IntList input) const {
 void TensorIterator::allocate_outputs() {
   for (int i = 0; i < num_outputs_; i++) {
     auto& op = operands_[i];
-    if (!op.tensor->defined()) {
+    if (!op.tensor->defined() || op.will_resize) {
       int element_size = op.type->elementSizeInBytes();
       op.stride_bytes = compatible_stride(element_size);
 
@@ -153,7 +166,14 @@ void TensorIterator::allocate_outputs() {
       for (int dim = 0; dim < ndim(); dim++) {
         tensor_stride[dim] /= element_size;
       }
-      *op.tensor = at::empty_strided(tensor_shape, tensor_stride, op.type->options());
+      if (op.will_resize) {
+        // set_ only grows the storage if it is too small, so an out= tensor
+        // that is reused across calls is not reallocated.
+        op.tensor->set_(op.tensor->storage(), op.tensor->storage_offset(),
+                        tensor_shape, tensor_stride);
+      } else {
+        *op.tensor = at::empty_strided(tensor_shape, tensor_stride, op.type->options());
+      }
     }
   }
 }
@@ -269,11 +289,11 @@ void TensorIterator::increment_counter(DimVector& counter, int64_t n) const {
   }
 }
 
-void TensorIterator::for_each(loop_t loop) {
+void TensorIterator::for_each(loop_t loop, int64_t grain_size) {
   auto inner_strides = get_inner_strides();
   auto base_ptrs = get_base_ptrs();
 
-  at::parallel_for(0, numel(), internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+  at::parallel_for(0, numel(), grain_size, [&](int64_t begin, int64_t end) {
     serial_for_each(loop, base_ptrs, inner_strides, begin, end - begin);
   });
 }
@@ -333,6 +353,13 @@ void TensorIterator::narrow(int dim, int64_t start, int64_t size) {
   }
 }
 
+std::unique_ptr<TensorIterator> TensorIterator::unary_op(Tensor& out, const Tensor& a) {
+  auto builder = TensorIterator::Builder();
+  builder.add_output(out);
+  builder.add_input(a);
+  return builder.build();
+}
+
 std::unique_ptr<TensorIterator> TensorIterator::binary_op(Tensor& out, const Tensor& a, const Tensor& b) {
   auto builder = TensorIterator::Builder();
   builder.add_output(out);
@@ -341,6 +368,27 @@ std::unique_ptr<TensorIterator> TensorIterator::binary_op(Tensor& out, const Ten
   return builder.build();
 }
 
+std::unique_ptr<TensorIterator> TensorIterator::reduce_op(Tensor& out, const Tensor& a) {
+  AT_ASSERT(out.defined());
+  auto builder = TensorIterator::Builder();
+  builder.add_output(out);
+  builder.add_input(a);
+  builder.iter_->is_reduction_ = true;
+  return builder.build();
+}
+
+std::unique_ptr<TensorIterator> TensorIterator::reduce_op(Tensor& out1, Tensor& out2, const Tensor& a) {
+  AT_ASSERT(out1.defined() && out2.defined());
+  AT_CHECK(out1.sizes().equals(out2.sizes()), "reduce_op(): expected both outputs to have the same ",
+           "shape, but got ", out1.sizes(), " and ", out2.sizes());
+  auto builder = TensorIterator::Builder();
+  builder.add_output(out1);
+  builder.add_output(out2);
+  builder.add_input(a);
+  builder.iter_->is_reduction_ = true;
+  return builder.build();
+}
+
 void TensorIterator::mark_outputs() {
   for (int i = 0; i < num_outputs_; i++) {
     operands_[i].is_output = true;
@@ -364,7 +412,7 @@ void TensorIterator::compute_shape() {
     // For now, don't include output tensors that are not also input tensors.
     // This preserves the legacy behavior where torch.add(..., out=dst) resizes
     // the destination tensor.
-    if (op.is_output && !op.is_read_write) continue;
+    if (op.is_output && (is_reduction_ || !op.is_read_write)) continue;
 
     auto shape = op.tensor->sizes();
     if (shape_.empty()) {
@@ -380,11 +428,22 @@ void TensorIterator::compute_shape() {
   // outputs.
   for (int i = 0; i < num_outputs_; i++) {
     auto& tensor = *operands_[i].tensor;
+    if (is_reduction_) {
+      // The outputs of a reduction keep the reduced dimensions with size 1.
+      bool matches = tensor.dim() == ndim();
+      for (int dim = 0; matches && dim < ndim(); dim++) {
+        matches = tensor.size(dim) == shape_[dim] || tensor.size(dim) == 1;
+      }
+      AT_CHECK(matches, "reduction output with shape ", tensor.sizes(),
+               " doesn't match the input shape ", shape_);
+      continue;
+    }
     if (tensor.defined() && !tensor.sizes().equals(shape_)) {
       if (!operands_[i].is_read_write) {
-        // Preserve legacy resizing behavior of out=... arguments
+        // Preserve legacy resizing behavior of out=... arguments. The resize
+        // itself is deferred to allocate_outputs().
         // TODO: issue warning
-        tensor.resize_(shape_);
+        operands_[i].will_resize = true;
         continue;
       }
       AT_ERROR("output with shape ", tensor.sizes(), " doesn't match the broadcast shape ",
@@ -413,7 +472,7 @@ static DimVector compute_stride(const Tensor& tensor, IntList shape) {
 
 void TensorIterator::compute_strides() {
   for (auto& op : operands_) {
-    if (op.tensor->defined()) {
+    if (op.tensor->defined() && !op.will_resize) {
       op.stride_bytes = compute_stride(*op.tensor, shape_);
     }
   }
@@ -445,15 +504,69 @@ bool TensorIterator::can_use_32bit_indexing() const {
   return true;
 }
 
+bool TensorIterator::reduced_dims_fit_32bit_indexing() const {
+  int64_t max_value = std::numeric_limits<int32_t>::max();
+  int64_t reduced_numel = 1;
+  for (int dim = 0; dim < ndim(); dim++) {
+    if (is_dim_reduced(dim)) {
+      reduced_numel *= shape_[dim];
+    }
+  }
+  if (reduced_numel > max_value) {
+    return false;
+  }
+  for (auto& op : operands_) {
+    int64_t max_offset = 1;
+    for (int dim = 0; dim < ndim(); dim++) {
+      if (is_dim_reduced(dim)) {
+        max_offset += (shape_[dim] - 1) * op.stride_bytes[dim];
+      }
+    }
+    if (max_offset > max_value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int TensorIterator::num_reduce_dims() const {
+  int count = 0;
+  for (int dim = 0; dim < ndim(); dim++) {
+    if (operands_[0].stride_bytes[dim] == 0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+int64_t TensorIterator::num_output_elements() const {
+  int64_t elem = 1;
+  for (int dim = 0; dim < ndim(); dim++) {
+    if (operands_[0].stride_bytes[dim] != 0 || shape_[dim] == 0) {
+      elem *= shape_[dim];
+    }
+  }
+  return elem;
+}
+
+bool TensorIterator::is_dim_reduced(int dim) const {
+  return is_reduction_ && operands_[0].stride_bytes[dim] == 0 && shape_[dim] > 1;
+}
+
 std::unique_ptr<TensorIterator> TensorIterator::split() {
-  AT_ASSERT(ndim() >= 1 && shape().back() >= 2);
+  // Split the outermost dimension that can be split. A reduced dimension is
+  // never split since each half would only produce a partial result.
+  int dim = ndim() - 1;
+  while (dim >= 0 && (shape_[dim] < 2 || is_dim_reduced(dim))) {
+    dim--;
+  }
+  AT_ASSERT(dim >= 0);
   std::unique_ptr<TensorIterator> copy(new TensorIterator(*this));
 
-  int last_dim = ndim() - 1;
-  auto copy_size = shape().back() / 2;
-  auto this_size = shape().back() - copy_size;
-  this->narrow(last_dim, 0, this_size);
-  copy->narrow(last_dim, this_size, copy_size);
+  auto copy_size = shape_[dim] / 2;
+  auto this_size = shape_[dim] - copy_size;
+  this->narrow(dim, 0, this_size);
+  copy->narrow(dim, this_size, copy_size);
 
   return copy;
 }
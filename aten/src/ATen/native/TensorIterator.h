@@ -1,13 +1,15 @@
 #pragma once
 
 #include <ATen/ATen.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/SmallVector.h>
 #include <ATen/detail/ScalarTypeConversions.h>
 #include "c10/util/Optional.h"
 
 // TensorIterator is a helper class for element-wise operations, such as
 // arithmetic, comparisions, and trigonometric functions. It handles
-// broadcasting and type conversions of operands.
+// broadcasting and type conversions of operands. It also describes reductions
+// (see reduce_op()), which are driven by cuda/Reduce.cuh on the GPU.
 //
 // This is inspired by NumPy's Array Iterator API (NpyIter).
 //
@@ -78,6 +80,12 @@ struct CAFFE2_API OperandInfo {
   bool is_output = false;
 
   bool is_read_write = false;
+
+  /// True for an `out=` argument whose shape does not match the broadcast
+  /// shape. Instead of being resized to a contiguous layout up front, it is
+  /// restrided in allocate_outputs() to match the iteration order of the
+  /// inputs, reusing its storage when that is large enough.
+  bool will_resize = false;
 };
 
 struct SplitUntil32Bit;
@@ -101,12 +109,29 @@ struct CAFFE2_API TensorIterator {
   // parallelization of the inner loop.
   using loop_t = const std::function<void(int ntensors, char** data, const int64_t* strides, int64_t size)>&;
 
+  static std::unique_ptr<TensorIterator> unary_op(Tensor& out, const Tensor& a);
   static std::unique_ptr<TensorIterator> binary_op(Tensor& out, const Tensor& a, const Tensor& b);
 
+  /// Reduces `a` into `out`, which must already have the shape of `a` with the
+  /// reduced dimensions set to 1 (as with keepdim=True). The outputs have
+  /// stride 0 along the reduced dimensions and are never resized. The second
+  /// overload fills two outputs in a single pass, e.g. the mean and variance.
+  static std::unique_ptr<TensorIterator> reduce_op(Tensor& out, const Tensor& a);
+  static std::unique_ptr<TensorIterator> reduce_op(Tensor& out1, Tensor& out2, const Tensor& a);
+
   int ndim() const { return shape_.size(); }
   IntList shape() const { return shape_; }
   int64_t numel() const;
   int ntensors() const { return operands_.size(); }
+  int noutputs() const { return num_outputs_; }
+
+  /// Reduction helpers. The reduced dimensions are the ones along which the
+  /// outputs have stride 0; reorder_dimensions() moves them in front of all
+  /// other dimensions.
+  bool is_reduction() const { return is_reduction_; }
+  int num_reduce_dims() const;
+  int64_t num_output_elements() const;
+  bool is_dim_reduced(int dim) const;
 
   /// 1-dimensional iteration and no buffering or type conversion
   bool is_trivial_1d() const;
@@ -135,7 +160,8 @@ struct CAFFE2_API TensorIterator {
   void narrow(int dim, int64_t start, int64_t size);
 
   /// Splits this TensorIterator into two iterators. Together they iterate over
-  /// the entire operation. Used by `with_32bit_indexing()`.
+  /// the entire operation. Used by `with_32bit_indexing()`. Reductions are
+  /// only split along dimensions that are not reduced.
   std::unique_ptr<TensorIterator> split();
 
   template <typename T>
@@ -144,7 +170,10 @@ struct CAFFE2_API TensorIterator {
     return at::detail::load<T>(op.data, op.tensor->type().scalarType());
   }
 
-  void for_each(loop_t loop);
+  /// Runs `loop` over the whole iteration space, in parallel across chunks of
+  /// at least `grain_size` elements. Kernels that are much more expensive
+  /// than a memory-bound op should pass internal::grain_size_for_cost(...).
+  void for_each(loop_t loop, int64_t grain_size = internal::GRAIN_SIZE);
   void serial_for_each(loop_t loop, ArrayRef<char*> base_ptrs, IntList inner_strides, int64_t start, int64_t size);
 
   /// Create a strides array for a Tensor with shape of this iterator. The
@@ -166,6 +195,11 @@ struct CAFFE2_API TensorIterator {
   /// true if the stride computation can use 32-bit arithmetic. Used by GPU kernels
   bool can_use_32bit_indexing() const;
 
+  /// true if the reduction of a single output element can use 32-bit
+  /// arithmetic. with_32bit_indexing() never splits a reduced dimension, so
+  /// reductions that fail this check cannot be run by 32-bit GPU kernels.
+  bool reduced_dims_fit_32bit_indexing() const;
+
   /// An "iteratable" object that recursively splits this iterator into sub-iterators
   /// that can use 32-bit indexing.
   SplitUntil32Bit with_32bit_indexing() const;
@@ -187,6 +221,7 @@ private:
   SmallVector<Tensor, 4> cast_tensors_;
   int num_outputs_ = 0;
   bool has_coalesced_dimensions_ = false;
+  bool is_reduction_ = false;
 };
 
 struct TensorIterator::Builder {
@@ -203,9 +238,18 @@ struct TensorIterator::Builder {
     return *this;
   }
 
+  /// Adds an input that keeps the given type instead of taking part in the
+  /// result type computation, e.g. the uint8 mask of a floating point op.
+  Builder& add_input(const Tensor& input, const Type& type) {
+    iter_->operands_.emplace_back(input);
+    iter_->operands_.back().type = const_cast<Type*>(&type);
+    return *this;
+  }
+
   std::unique_ptr<TensorIterator> build();
 
 private:
+  friend struct TensorIterator;
   std::unique_ptr<TensorIterator> iter_;
 };
 
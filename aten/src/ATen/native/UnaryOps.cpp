@@ -12,6 +12,8 @@
 
 #include "ATen/CPUApplyUtils.h"
 #include "ATen/Parallel.h"
+#include "ATen/native/PointwiseOps.h"
+#include "ATen/native/TensorIterator.h"
 #include "ATen/native/cpu/UnaryOpsKernel.h"
 
 #include <algorithm>
@@ -30,6 +32,10 @@
 namespace at {
 namespace native {
 
+DEFINE_DISPATCH(clamp_stub);
+DEFINE_DISPATCH(clamp_min_stub);
+DEFINE_DISPATCH(clamp_max_stub);
+
 Tensor clamp(const Tensor& self, Scalar min, Scalar max) {
   Tensor result = at::empty({0}, self.options());
   return clamp_out(result, self, min, max);
@@ -46,15 +52,7 @@ Tensor clamp_min(const Tensor& self, Scalar min) {
 }
 
 Tensor& _clamp__cpu(Tensor& self, Scalar min, Scalar max) {
-  if (!std::isnan(min.toDouble()) && !std::isnan(max.toDouble())) {
-    return _th_clamp_out(self, self, min, max);
-  } else if (std::isnan(min.toDouble())) {
-    return _th_clamp_max_out(self, self, max);
-  } else if (std::isnan(max.toDouble())) {
-    return _th_clamp_min_out(self, self, min);
-  } else {
-    return self;
-  }
+  return _clamp_out_cpu(self, self, min, max);
 }
 
 Tensor& _clamp_out_cpu(
@@ -63,29 +61,34 @@ Tensor& _clamp_out_cpu(
     Scalar min,
     Scalar max) {
   if (!std::isnan(min.toDouble()) && !std::isnan(max.toDouble())) {
-    _th_clamp_out(result, self, min, max);
+    auto iter = TensorIterator::unary_op(result, self);
+    clamp_stub(iter->device_type(), *iter, min, max);
   } else if (std::isnan(min.toDouble())) {
-    _th_clamp_max_out(result, self, max);
+    _clamp_max_out_cpu(result, self, max);
   } else if (std::isnan(max.toDouble())) {
-    _th_clamp_min_out(result, self, min);
+    _clamp_min_out_cpu(result, self, min);
   }
   return result;
 }
 
 Tensor& _clamp_max__cpu(Tensor& self, Scalar max) {
-  return _th_clamp_max_out(self, self, max);
+  return _clamp_max_out_cpu(self, self, max);
 }
 
 Tensor& _clamp_max_out_cpu(Tensor& result, const Tensor& self, Scalar max) {
-  return _th_clamp_max_out(result, self, max);
+  auto iter = TensorIterator::unary_op(result, self);
+  clamp_max_stub(iter->device_type(), *iter, max);
+  return result;
 }
 
 Tensor& _clamp_min__cpu(Tensor& self, Scalar min) {
-  return _th_clamp_min_out(self, self, min);
+  return _clamp_min_out_cpu(self, self, min);
 }
 
 Tensor& _clamp_min_out_cpu(Tensor& result, const Tensor& self, Scalar min) {
-  return _th_clamp_min_out(result, self, min);
+  auto iter = TensorIterator::unary_op(result, self);
+  clamp_min_stub(iter->device_type(), *iter, min);
+  return result;
 }
 
 Tensor& fill_(Tensor& self, Scalar value) {
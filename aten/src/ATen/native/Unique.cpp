@@ -2,50 +2,134 @@
 
 #include "ATen/ATen.h"
 #include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/RadixSort.h"
 
-#include <set>
+#include <numeric>
 #include <tuple>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 namespace at {
 namespace native{
 
 namespace {
 
+// Sort-based: radix sort (key, position) pairs, then every run of equal
+// values in sorted order becomes one output element. This is linear in the
+// number of elements and parallel, unlike inserting into a hash set, and
+// gives the inverse indices and counts without a second lookup. The output
+// is sorted whether or not `sorted` was requested.
 template <typename scalar_t>
-std::tuple<Tensor, Tensor> _unique_cpu_template(
+std::tuple<Tensor, Tensor, Tensor> _unique_cpu_template(
     const Tensor& self,
     const bool sorted,
-    const bool return_inverse) {
+    const bool return_inverse,
+    const bool return_counts) {
   const Tensor& input = self.contiguous();
   const scalar_t* input_data = input.data<scalar_t>();
-  std::unordered_set<scalar_t> set(input_data, input_data + input.numel());
-  Tensor output = at::empty({static_cast<int64_t>(set.size())}, input.options());
-  scalar_t* output_data = output.data<scalar_t>();
+  const int64_t numel = input.numel();
+
+  std::vector<uint64_t> keys(numel);
+  std::vector<int64_t> positions(numel);
+  parallel_for(0, numel, internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      keys[i] = radix_key(input_data[i]);
+      positions[i] = i;
+    }
+  });
+  radix_sort_pairs(keys.data(), positions.data(), numel);
+
+  // run_ids[i] is the output slot of the i-th smallest element. Compare
+  // values rather than keys so that NaNs stay distinct, as with a hash set.
+  std::vector<int64_t> run_ids(numel);
+  std::vector<int64_t> run_starts;
+  int64_t num_unique = 0;
+  for (int64_t i = 0; i < numel; i++) {
+    if (i == 0 || !(input_data[positions[i]] == input_data[positions[i - 1]])) {
+      num_unique++;
+      if (return_counts) {
+        run_starts.push_back(i);
+      }
+    }
+    run_ids[i] = num_unique - 1;
+  }
 
-  if (sorted) {
-    std::vector<scalar_t> vec(set.begin(), set.end());
-    std::sort(vec.begin(), vec.end());
-    std::copy(vec.begin(), vec.end(), output_data);
-  } else {
-    std::copy(set.begin(), set.end(), output_data);
+  Tensor output = at::empty({num_unique}, input.options());
+  scalar_t* output_data = output.data<scalar_t>();
+  Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
+  if (return_inverse) {
+    inverse_indices.resize_(input.sizes());
   }
+  int64_t* inverse_indices_data =
+      return_inverse ? inverse_indices.data<int64_t>() : nullptr;
+  parallel_for(0, numel, internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      if (i == 0 || run_ids[i] != run_ids[i - 1]) {
+        output_data[run_ids[i]] = input_data[positions[i]];
+      }
+      if (return_inverse) {
+        inverse_indices_data[positions[i]] = run_ids[i];
+      }
+    }
+  });
+  Tensor counts = at::empty({0}, self.options().dtype(kLong));
+  if (return_counts) {
+    counts.resize_({num_unique});
+    int64_t* counts_data = counts.data<int64_t>();
+    for (int64_t r = 0; r < num_unique; r++) {
+      counts_data[r] =
+          (r + 1 < num_unique ? run_starts[r + 1] : numel) - run_starts[r];
+    }
+  }
+  return std::make_tuple(output, inverse_indices, counts);
+}
 
+// Reduces every run of equal consecutive elements to one element, without
+// sorting, in a single pass.
+template <typename scalar_t>
+std::tuple<Tensor, Tensor, Tensor> _unique_consecutive_cpu_template(
+    const Tensor& self,
+    const bool return_inverse,
+    const bool return_counts) {
+  const Tensor& input = self.contiguous();
+  const scalar_t* input_data = input.data<scalar_t>();
+  const int64_t numel = input.numel();
+
+  Tensor output = at::empty({numel}, input.options());
+  scalar_t* output_data = output.data<scalar_t>();
   Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
+  Tensor counts = at::empty({0}, self.options().dtype(kLong));
   if (return_inverse) {
     inverse_indices.resize_(input.sizes());
-    int64_t* inverse_indices_data = inverse_indices.data<int64_t>();
-    std::unordered_map<scalar_t, int64_t> inverse_map;
-    inverse_map.reserve(output.numel());
-    for (int i = 0; i < output.numel(); ++i) {
-      inverse_map[output_data[i]] = i;
+  }
+  if (return_counts) {
+    counts.resize_({numel});
+  }
+  int64_t* inverse_indices_data =
+      return_inverse ? inverse_indices.data<int64_t>() : nullptr;
+  int64_t* counts_data = return_counts ? counts.data<int64_t>() : nullptr;
+
+  int64_t num_out = 0;
+  for (int64_t i = 0; i < numel; i++) {
+    if (i == 0 || !(input_data[i] == input_data[i - 1])) {
+      output_data[num_out] = input_data[i];
+      if (return_counts) {
+        counts_data[num_out] = 0;
+      }
+      num_out++;
+    }
+    if (return_inverse) {
+      inverse_indices_data[i] = num_out - 1;
     }
-    for (int i = 0; i < input.numel(); ++i) {
-      inverse_indices_data[i] = inverse_map[input_data[i]];
+    if (return_counts) {
+      counts_data[num_out - 1]++;
     }
   }
-  return std::make_tuple(output, inverse_indices);
+  output.resize_({num_out});
+  if (return_counts) {
+    counts.resize_({num_out});
+  }
+  return std::make_tuple(output, inverse_indices, counts);
 }
 
 template<class ForwardIt>
@@ -128,7 +212,26 @@ std::tuple<Tensor, Tensor> _unique_dim_cpu_template(
 std::tuple<Tensor, Tensor>
 _unique_cpu(const Tensor& self, const bool sorted, const bool return_inverse) {
   return AT_DISPATCH_ALL_TYPES(self.type(), "unique", [&] {
-    return _unique_cpu_template<scalar_t>(self, sorted, return_inverse);
+    Tensor output, inverse_indices;
+    std::tie(output, inverse_indices, std::ignore) =
+        _unique_cpu_template<scalar_t>(self, sorted, return_inverse, false);
+    return std::make_tuple(output, inverse_indices);
+  });
+}
+
+std::tuple<Tensor, Tensor, Tensor>
+_unique2_cpu(const Tensor& self, const bool sorted, const bool return_inverse, const bool return_counts) {
+  return AT_DISPATCH_ALL_TYPES(self.type(), "unique", [&] {
+    return _unique_cpu_template<scalar_t>(
+        self, sorted, return_inverse, return_counts);
+  });
+}
+
+std::tuple<Tensor, Tensor, Tensor>
+_unique_consecutive_cpu(const Tensor& self, const bool return_inverse, const bool return_counts) {
+  return AT_DISPATCH_ALL_TYPES(self.type(), "unique_consecutive", [&] {
+    return _unique_consecutive_cpu_template<scalar_t>(
+        self, return_inverse, return_counts);
   });
 }
 
@@ -25,6 +25,24 @@ void add_kernel(TensorIterator& iter, Scalar alpha_scalar) {
   });
 }
 
+// relu(a + alpha * b) computed in the same loop as the add, so the
+// intermediate sum never round-trips through memory.
+void add_relu_kernel(TensorIterator& iter, Scalar alpha_scalar) {
+  AT_DISPATCH_ALL_TYPES(iter.type(), "add_relu", [&]() {
+    auto alpha = alpha_scalar.to<scalar_t>();
+    auto alpha_vec = Vec256<scalar_t>(alpha);
+    auto zero_vec = Vec256<scalar_t>(static_cast<scalar_t>(0));
+    binary_kernel_vec(iter,
+      [=](scalar_t a, scalar_t b) -> scalar_t {
+        scalar_t sum = a + alpha * b;
+        return sum > static_cast<scalar_t>(0) ? sum : static_cast<scalar_t>(0);
+      },
+      [=](Vec256<scalar_t> a, Vec256<scalar_t> b) {
+        return vec256::max(vec256::fmadd(b, alpha_vec, a), zero_vec);
+      });
+  });
+}
+
 void sub_kernel(TensorIterator& iter, Scalar alpha_scalar) {
   add_kernel(iter, -alpha_scalar);
 }
@@ -46,7 +64,7 @@ void div_kernel(TensorIterator& iter) {
     AT_DISPATCH_INTEGRAL_TYPES(iter.type(), "div", [&]() {
       binary_kernel(iter, [](scalar_t a, scalar_t b) -> scalar_t {
         return a / b;
-      });
+      }, internal::grain_size_for_cost(internal::cost::ARITHMETIC));
     });
   } else {
     AT_DISPATCH_FLOATING_TYPES(iter.type(), "div", [&]() {
@@ -66,6 +84,7 @@ void div_kernel(TensorIterator& iter) {
 
 REGISTER_DISPATCH(add_stub, &add_kernel);
 REGISTER_DISPATCH(sub_stub, &sub_kernel);
+REGISTER_DISPATCH(add_relu_stub, &add_relu_kernel);
 REGISTER_DISPATCH(mul_stub, &mul_kernel);
 REGISTER_DISPATCH(div_stub, &div_kernel);
 
@@ -218,6 +218,103 @@ struct PDist {
     }
   }
 
+  // The cdist kernels take x1 of size (B, R1, M) and x2 of size (B, R2, M),
+  // and compute the (B, R1, R2) distances between the rows of every batch.
+  template <typename F>
+  static void run_cdist_parallel(Tensor& result, const Tensor& x1, const Tensor& x2, const scalar_t p) {
+    const scalar_t * const x1_start = x1.data<scalar_t>();
+    const scalar_t * const x2_start = x2.data<scalar_t>();
+    const int64_t r1 = x1.size(1);
+    const int64_t r2 = x2.size(1);
+    const int64_t m = x1.size(2);
+
+    scalar_t * const res_start = result.data<scalar_t>();
+    const int64_t combs = result.numel(); // B * R1 * R2
+    const Vec pvec(p);
+
+    parallel_for(0, combs, std::max<int64_t>(internal::GRAIN_SIZE / (16 * m), 1), [=, &pvec](int64_t k, int64_t end) {
+      for (; k != end; ++k) {
+        const int64_t b = k / (r1 * r2);
+        const int64_t i = k / r2 % r1;
+        const int64_t j = k % r2;
+        const scalar_t * x1_i = x1_start + (b * r1 + i) * m;
+        const scalar_t * x2_j = x2_start + (b * r2 + j) * m;
+        res_start[k] = F::finish(vec256::map2_reduce_all<scalar_t>(
+          [&pvec](Vec a, Vec b) { return F::map((a - b).abs(), pvec); },
+          F::red, x1_i, x2_j, m), p);
+      }
+    });
+  }
+
+  // Assumes x1 and x2 are nonempty, contiguous, and 3D
+  static void apply_cdist(Tensor& result, const Tensor& x1, const Tensor& x2, const scalar_t p) {
+    if (p == 0.0) {
+      run_cdist_parallel<zdist_calc>(result, x1, x2, p);
+    } else if (p == 1.0) {
+      run_cdist_parallel<odist_calc>(result, x1, x2, p);
+    } else if (p == 2.0) {
+      run_cdist_parallel<tdist_calc>(result, x1, x2, p);
+    } else if (std::isinf(p)) {
+      run_cdist_parallel<idist_calc>(result, x1, x2, p);
+    } else {
+      run_cdist_parallel<pdist_calc>(result, x1, x2, p);
+    }
+  }
+
+  // The gradient of x1 only: every row of x1 sums the gradients of its
+  // distances to the rows of x2, so the rows are independent. The gradient of
+  // x2 is the same computation with x1 and x2 swapped.
+  template <typename F>
+  static void run_cdist_backward_parallel(Tensor& result, const Tensor& grad, const Tensor& x1, const Tensor& x2, const scalar_t p, const Tensor& dist) {
+    const int64_t r1 = x1.size(1);
+    const int64_t r2 = x2.size(1);
+    const int64_t m = x1.size(2);
+    const int64_t rows = x1.size(0) * r1;
+    const Vec pvec(p);
+
+    const scalar_t * const grad_start = grad.data<scalar_t>();
+    const scalar_t * const dist_start = dist.data<scalar_t>();
+    const scalar_t * const x1_start = x1.data<scalar_t>();
+    const scalar_t * const x2_start = x2.data<scalar_t>();
+    scalar_t * const res_start = result.data<scalar_t>();
+
+    parallel_for(0, rows, std::max<int64_t>(internal::GRAIN_SIZE / (8 * r2 * m), 1), [=, &pvec](int64_t row, int64_t end) {
+      for (; row != end; ++row) {
+        const scalar_t * const x1_i = x1_start + row * m;
+        const scalar_t * const x2_b = x2_start + row / r1 * r2 * m;
+        const scalar_t * const grad_i = grad_start + row * r2;
+        const scalar_t * const dist_i = dist_start + row * r2;
+        scalar_t * const res_i = res_start + row * m;
+        for (int64_t l = 0; l < m; l += Vec::size) {
+          const int64_t count = std::min<int64_t>(Vec::size, m - l);
+          const Vec x1_vec = Vec::loadu(x1_i + l, count);
+          Vec res_vec(0);
+          for (int64_t j = 0; j < r2; ++j) {
+            const Vec x2_vec = Vec::loadu(x2_b + j * m + l, count);
+            res_vec = res_vec + F::backward(x1_vec - x2_vec, grad_i[j], dist_i[j], pvec);
+          }
+          res_vec.store(res_i + l, count);
+        }
+      }
+    });
+  }
+
+  // Assumes x1 and x2 are nonempty, contiguous, and 3D, p is not 0, and grad
+  // and dist are contiguous
+  static void apply_cdist_backward(Tensor& result, const Tensor& grad, const Tensor& x1, const Tensor& x2, const double p, const Tensor& dist) {
+    if (p == 1.0) {
+      run_cdist_backward_parallel<odist_calc>(result, grad, x1, x2, p, dist);
+    } else if (p < 2.0) {
+      run_cdist_backward_parallel<lttdist_calc>(result, grad, x1, x2, p, dist);
+    } else if (p == 2.0) {
+      run_cdist_backward_parallel<tdist_calc>(result, grad, x1, x2, p, dist);
+    } else if (std::isinf(p)) {
+      run_cdist_backward_parallel<idist_calc>(result, grad, x1, x2, p, dist);
+    } else {
+      run_cdist_backward_parallel<pdist_calc>(result, grad, x1, x2, p, dist);
+    }
+  }
+
 };
 
 void pdist_forward_kernel_impl(Tensor& result, const Tensor& self, const double p) {
@@ -232,9 +329,23 @@ static void pdist_backward_kernel_impl(Tensor& result, const Tensor& grad, const
   });
 }
 
+static void cdist_kernel_impl(Tensor& result, const Tensor& x1, const Tensor& x2, const double p) {
+  AT_DISPATCH_FLOATING_TYPES(x1.type(), "cdist", [&] {
+    PDist<scalar_t>::apply_cdist(result, x1, x2, p);
+  });
+}
+
+static void cdist_backward_kernel_impl(Tensor& result, const Tensor& grad, const Tensor& x1, const Tensor& x2, const double p, const Tensor& dist) {
+  AT_DISPATCH_FLOATING_TYPES(x1.type(), "cdist_backward", [&] {
+    PDist<scalar_t>::apply_cdist_backward(result, grad, x1, x2, p, dist);
+  });
+}
+
 }  // anonymous namespace
 
 REGISTER_DISPATCH(pdist_forward_stub, &pdist_forward_kernel_impl);
 REGISTER_DISPATCH(pdist_backward_stub, &pdist_backward_kernel_impl);
+REGISTER_DISPATCH(cdist_stub, &cdist_kernel_impl);
+REGISTER_DISPATCH(cdist_backward_stub, &cdist_backward_kernel_impl);
 
 }}  // namespace at::native
@@ -0,0 +1,167 @@
+#include "ATen/native/cpu/EmbeddingBagKernel.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+template <typename scalar_t>
+static inline void add_row(
+    scalar_t* out,
+    const scalar_t* src,
+    int64_t src_stride,
+    int64_t ddim) {
+  using Vec = Vec256<scalar_t>;
+  int64_t d = 0;
+  if (src_stride == 1) {
+    for (; d + Vec::size <= ddim; d += Vec::size) {
+      (Vec::loadu(out + d) + Vec::loadu(src + d)).store(out + d);
+    }
+  }
+  for (; d < ddim; d++) {
+    out[d] += src[d * src_stride];
+  }
+}
+
+template <typename scalar_t>
+static inline void div_row(scalar_t* out, scalar_t divisor, int64_t ddim) {
+  using Vec = Vec256<scalar_t>;
+  Vec divisor_vec(divisor);
+  int64_t d = 0;
+  for (; d + Vec::size <= ddim; d += Vec::size) {
+    (Vec::loadu(out + d) / divisor_vec).store(out + d);
+  }
+  for (; d < ddim; d++) {
+    out[d] /= divisor;
+  }
+}
+
+static void embedding_bag_sum_kernel_impl(
+    Tensor& output,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    bool mean) {
+  AT_DISPATCH_FLOATING_TYPES(weight.type(), "embedding_bag_sum", [&] {
+    const int64_t num_bags = offsets.size(0);
+    const int64_t numel = indices.numel();
+    const int64_t ddim = weight.size(1);
+    const int64_t weight_stride0 = weight.stride(0);
+    const int64_t weight_stride1 = weight.stride(1);
+    const int64_t* indices_data = indices.data<int64_t>();
+    const int64_t* offsets_data = offsets.data<int64_t>();
+    const scalar_t* weight_data = weight.data<scalar_t>();
+    scalar_t* output_data = output.data<scalar_t>();
+
+    // Bags are independent, so each thread owns whole output rows.
+    int64_t bag_cost = std::max<int64_t>(divup(numel, std::max<int64_t>(num_bags, 1)) * ddim, 1);
+    int64_t grain_size = std::max<int64_t>(internal::GRAIN_SIZE / bag_cost, 1);
+    parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t bag = begin; bag < end; bag++) {
+        int64_t start = offsets_data[bag];
+        int64_t stop = bag + 1 < num_bags ? offsets_data[bag + 1] : numel;
+        scalar_t* out = output_data + bag * ddim;
+        for (int64_t i = start; i < stop; i++) {
+          add_row<scalar_t>(
+              out,
+              weight_data + indices_data[i] * weight_stride0,
+              weight_stride1,
+              ddim);
+        }
+        if (mean && stop > start) {
+          div_row<scalar_t>(out, static_cast<scalar_t>(stop - start), ddim);
+        }
+      }
+    });
+  });
+}
+
+// Adds one dequantized row, scale * q + bias, to out. The loops are kept
+// simple so that they vectorize in each CPU capability build.
+template <int64_t bit_width>
+static inline void add_fused_rowwise_row(
+    float* out,
+    const uint8_t* row,
+    int64_t ddim) {
+  float scale_bias[2];
+  std::memcpy(scale_bias, row + (ddim * bit_width + 7) / 8, sizeof(scale_bias));
+  const float scale = scale_bias[0];
+  const float bias = scale_bias[1];
+  if (bit_width == 8) {
+    for (int64_t d = 0; d < ddim; d++) {
+      out[d] += scale * static_cast<float>(row[d]) + bias;
+    }
+  } else {
+    int64_t d = 0;
+    for (; d + 1 < ddim; d += 2) {
+      const uint8_t packed = row[d / 2];
+      out[d] += scale * static_cast<float>(packed & 0xF) + bias;
+      out[d + 1] += scale * static_cast<float>(packed >> 4) + bias;
+    }
+    if (d < ddim) {
+      out[d] += scale * static_cast<float>(row[d / 2] & 0xF) + bias;
+    }
+  }
+}
+
+template <int64_t bit_width>
+static void embedding_bag_fused_rowwise_impl(
+    Tensor& output,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    bool mean) {
+  const int64_t num_bags = offsets.size(0);
+  const int64_t numel = indices.numel();
+  const int64_t ddim = output.size(1);
+  const int64_t row_bytes = weight.size(1);
+  const int64_t* indices_data = indices.data<int64_t>();
+  const int64_t* offsets_data = offsets.data<int64_t>();
+  const uint8_t* weight_data = weight.data<uint8_t>();
+  float* output_data = output.data<float>();
+
+  int64_t bag_cost = std::max<int64_t>(divup(numel, std::max<int64_t>(num_bags, 1)) * ddim, 1);
+  int64_t grain_size = std::max<int64_t>(internal::GRAIN_SIZE / bag_cost, 1);
+  parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t bag = begin; bag < end; bag++) {
+      int64_t start = offsets_data[bag];
+      int64_t stop = bag + 1 < num_bags ? offsets_data[bag + 1] : numel;
+      float* out = output_data + bag * ddim;
+      for (int64_t i = start; i < stop; i++) {
+        add_fused_rowwise_row<bit_width>(
+            out, weight_data + indices_data[i] * row_bytes, ddim);
+      }
+      if (mean && stop > start) {
+        div_row<float>(out, static_cast<float>(stop - start), ddim);
+      }
+    }
+  });
+}
+
+static void embedding_bag_fused_rowwise_kernel_impl(
+    Tensor& output,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    bool mean,
+    int64_t bit_width) {
+  if (bit_width == 8) {
+    embedding_bag_fused_rowwise_impl<8>(output, weight, indices, offsets, mean);
+  } else {
+    embedding_bag_fused_rowwise_impl<4>(output, weight, indices, offsets, mean);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(embedding_bag_sum_kernel, &embedding_bag_sum_kernel_impl);
+REGISTER_DISPATCH(embedding_bag_fused_rowwise_kernel, &embedding_bag_fused_rowwise_kernel_impl);
+
+}} // namespace at::native
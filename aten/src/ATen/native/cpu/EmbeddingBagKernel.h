@@ -0,0 +1,33 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Sums (or averages, if mean is true) the rows of weight selected by indices
+// into one output row per bag, where bag b covers
+// indices[offsets[b] : offsets[b + 1]]. output must be a zero-filled,
+// contiguous {offsets.size(0), weight.size(1)} tensor; empty bags stay zero.
+using embedding_bag_sum_fn = void (*)(
+    Tensor& output,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    bool mean);
+DECLARE_DISPATCH(embedding_bag_sum_fn, embedding_bag_sum_kernel);
+
+// Same as embedding_bag_sum_kernel for a weight in fused row-wise quantized
+// format (see NOTE [ fused row-wise quantized embeddings ] in
+// native_functions.yaml). output has one float row of embedding_dim values per
+// bag.
+using embedding_bag_fused_rowwise_fn = void (*)(
+    Tensor& output,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    bool mean,
+    int64_t bit_width);
+DECLARE_DISPATCH(embedding_bag_fused_rowwise_fn, embedding_bag_fused_rowwise_kernel);
+
+}} // namespace at::native
@@ -0,0 +1,146 @@
+#include "ATen/native/cpu/FusedOptimizersKernel.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Calls f(i, n) for consecutive runs [i, i + n) of at most one vector that
+// cover [begin, end). Only the last run can be partial.
+template <typename scalar_t, typename F>
+static inline void vec_for(int64_t begin, int64_t end, const F& f) {
+  using Vec = Vec256<scalar_t>;
+  int64_t i = begin;
+  for (; i + Vec::size <= end; i += Vec::size) {
+    f(i, Vec::size);
+  }
+  if (i < end) {
+    f(i, end - i);
+  }
+}
+
+// Every element is read and written in a single pass, with a division and a
+// square root for Adam and Adagrad.
+static constexpr int64_t kGrainSize =
+    internal::grain_size_for_cost(internal::cost::ARITHMETIC);
+
+static void fused_adam_kernel_impl(
+    Tensor& param,
+    Tensor& grad,
+    Tensor& exp_avg,
+    Tensor& exp_avg_sq,
+    double beta1,
+    double beta2,
+    double step_size,
+    double eps,
+    double weight_decay) {
+  AT_DISPATCH_FLOATING_TYPES(param.type(), "_fused_adam_cpu_", [&] {
+    using Vec = Vec256<scalar_t>;
+    scalar_t* p_data = param.data<scalar_t>();
+    scalar_t* g_data = grad.data<scalar_t>();
+    scalar_t* m_data = exp_avg.data<scalar_t>();
+    scalar_t* v_data = exp_avg_sq.data<scalar_t>();
+    const Vec b1(beta1), b2(beta2), one_minus_b1(1 - beta1),
+        one_minus_b2(1 - beta2), step(step_size), epsilon(eps),
+        decay(weight_decay);
+
+    parallel_for(0, param.numel(), kGrainSize, [&](int64_t begin, int64_t end) {
+      vec_for<scalar_t>(begin, end, [&](int64_t i, int64_t n) {
+        Vec p = Vec::loadu(p_data + i, n);
+        Vec g = Vec::loadu(g_data + i, n);
+        if (weight_decay != 0) {
+          g = g + decay * p;
+          g.store(g_data + i, n);
+        }
+        Vec m = b1 * Vec::loadu(m_data + i, n) + one_minus_b1 * g;
+        Vec v = b2 * Vec::loadu(v_data + i, n) + one_minus_b2 * g * g;
+        m.store(m_data + i, n);
+        v.store(v_data + i, n);
+        (p - step * m / (v.sqrt() + epsilon)).store(p_data + i, n);
+      });
+    });
+  });
+}
+
+static void fused_sgd_kernel_impl(
+    Tensor& param,
+    Tensor& grad,
+    Tensor& momentum_buffer,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov,
+    bool first_run) {
+  AT_DISPATCH_FLOATING_TYPES(param.type(), "_fused_sgd_cpu_", [&] {
+    using Vec = Vec256<scalar_t>;
+    scalar_t* p_data = param.data<scalar_t>();
+    scalar_t* g_data = grad.data<scalar_t>();
+    scalar_t* b_data =
+        momentum != 0 ? momentum_buffer.data<scalar_t>() : nullptr;
+    const Vec rate(lr), mom(momentum), one_minus_dampening(1 - dampening),
+        decay(weight_decay);
+
+    parallel_for(0, param.numel(), kGrainSize, [&](int64_t begin, int64_t end) {
+      vec_for<scalar_t>(begin, end, [&](int64_t i, int64_t n) {
+        Vec p = Vec::loadu(p_data + i, n);
+        Vec g = Vec::loadu(g_data + i, n);
+        if (weight_decay != 0) {
+          g = g + decay * p;
+          g.store(g_data + i, n);
+        }
+        Vec update = g;
+        if (b_data != nullptr) {
+          Vec b = first_run
+              ? g
+              : mom * Vec::loadu(b_data + i, n) + one_minus_dampening * g;
+          b.store(b_data + i, n);
+          update = nesterov ? g + mom * b : b;
+        }
+        (p - rate * update).store(p_data + i, n);
+      });
+    });
+  });
+}
+
+static void fused_adagrad_kernel_impl(
+    Tensor& param,
+    const Tensor& grad,
+    Tensor& sum,
+    double clr,
+    double weight_decay,
+    double eps) {
+  AT_DISPATCH_FLOATING_TYPES(param.type(), "_fused_adagrad_cpu_", [&] {
+    using Vec = Vec256<scalar_t>;
+    scalar_t* p_data = param.data<scalar_t>();
+    const scalar_t* g_data = grad.data<scalar_t>();
+    scalar_t* s_data = sum.data<scalar_t>();
+    const Vec rate(clr), decay(weight_decay), epsilon(eps);
+
+    parallel_for(0, param.numel(), kGrainSize, [&](int64_t begin, int64_t end) {
+      vec_for<scalar_t>(begin, end, [&](int64_t i, int64_t n) {
+        Vec p = Vec::loadu(p_data + i, n);
+        Vec g = Vec::loadu(g_data + i, n);
+        // The decayed gradient is not written back
+        if (weight_decay != 0) {
+          g = g + decay * p;
+        }
+        Vec s = Vec::loadu(s_data + i, n) + g * g;
+        s.store(s_data + i, n);
+        (p - rate * g / (s.sqrt() + epsilon)).store(p_data + i, n);
+      });
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(fused_adam_stub, &fused_adam_kernel_impl);
+REGISTER_DISPATCH(fused_sgd_stub, &fused_sgd_kernel_impl);
+REGISTER_DISPATCH(fused_adagrad_stub, &fused_adagrad_kernel_impl);
+
+}} // namespace at::native
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Fused optimizer steps over a single tensor (see _fused_adam_, _fused_sgd_
+// and _fused_adagrad_). All tensors are contiguous, of the same type and of
+// the same number of elements. The math matches the CUDA kernels in
+// native/cuda/FusedOptimizers.cu, including which tensors are written.
+using fused_adam_fn = void (*)(
+    Tensor& param,
+    Tensor& grad,
+    Tensor& exp_avg,
+    Tensor& exp_avg_sq,
+    double beta1,
+    double beta2,
+    double step_size,
+    double eps,
+    double weight_decay);
+// momentum_buffer is undefined when momentum is 0.
+using fused_sgd_fn = void (*)(
+    Tensor& param,
+    Tensor& grad,
+    Tensor& momentum_buffer,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov,
+    bool first_run);
+using fused_adagrad_fn = void (*)(
+    Tensor& param,
+    const Tensor& grad,
+    Tensor& sum,
+    double clr,
+    double weight_decay,
+    double eps);
+
+DECLARE_DISPATCH(fused_adam_fn, fused_adam_stub);
+DECLARE_DISPATCH(fused_sgd_fn, fused_sgd_stub);
+DECLARE_DISPATCH(fused_adagrad_fn, fused_adagrad_stub);
+
+}} // namespace at::native
@@ -0,0 +1,238 @@
+#include "ATen/native/cpu/LayerNormKernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/functional.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Calls f(d, n) for consecutive runs [d, d + n) of at most one vector that
+// cover [0, size). Only the last run can be partial.
+template <typename scalar_t, typename F>
+static inline void vec_for(int64_t size, const F& f) {
+  using Vec = Vec256<scalar_t>;
+  int64_t d = 0;
+  for (; d + Vec::size <= size; d += Vec::size) {
+    f(d, Vec::size);
+  }
+  if (d < size) {
+    f(d, size - d);
+  }
+}
+
+// Mean and biased variance of the n values of x in a single pass. Every lane
+// of a vector runs Welford's update on its own strided subset of x, and the
+// lanes and the remaining tail are merged with Chan's pairwise formula.
+template <typename scalar_t>
+static inline std::pair<scalar_t, scalar_t> welford_moments(
+    const scalar_t* x,
+    int64_t n) {
+  using Vec = Vec256<scalar_t>;
+  const int64_t steps = n / Vec::size;
+  Vec mean_vec(0);
+  Vec m2_vec(0);
+  for (int64_t i = 0; i < steps; i++) {
+    const Vec x_vec = Vec::loadu(x + i * Vec::size);
+    const Vec delta = x_vec - mean_vec;
+    mean_vec = mean_vec + delta * Vec(scalar_t(1) / (i + 1));
+    m2_vec = m2_vec + delta * (x_vec - mean_vec);
+  }
+  scalar_t lane_mean[Vec::size];
+  scalar_t lane_m2[Vec::size];
+  mean_vec.store(lane_mean);
+  m2_vec.store(lane_m2);
+
+  scalar_t mean = 0;
+  scalar_t m2 = 0;
+  scalar_t count = 0;
+  if (steps > 0) {
+    for (int j = 0; j < Vec::size; j++) {
+      const scalar_t new_count = count + steps;
+      const scalar_t delta = lane_mean[j] - mean;
+      mean += delta * steps / new_count;
+      m2 += lane_m2[j] + delta * delta * count * steps / new_count;
+      count = new_count;
+    }
+  }
+  for (int64_t i = steps * Vec::size; i < n; i++) {
+    count += 1;
+    const scalar_t delta = x[i] - mean;
+    mean += delta / count;
+    m2 += delta * (x[i] - mean);
+  }
+  return std::make_pair(mean, n > 0 ? m2 / n : scalar_t(0));
+}
+
+// Rows are independent and normalizing a row costs a few arithmetic ops per
+// element, so rows are split into chunks of about that much work.
+static inline int64_t rows_grain_size(int64_t row_size) {
+  return std::max<int64_t>(
+      internal::grain_size_for_cost(internal::cost::ARITHMETIC) / std::max<int64_t>(row_size, 1),
+      1);
+}
+
+static void layer_norm_kernel_impl(
+    const Tensor& X,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double eps,
+    Tensor& Y,
+    Tensor& mean,
+    Tensor& rstd) {
+  AT_DISPATCH_FLOATING_TYPES(X.type(), "native_layer_norm", [&] {
+    using Vec = Vec256<scalar_t>;
+    const scalar_t* X_data = X.data<scalar_t>();
+    const scalar_t* gamma_data = gamma.defined() ? gamma.data<scalar_t>() : nullptr;
+    const scalar_t* beta_data = beta.defined() ? beta.data<scalar_t>() : nullptr;
+    scalar_t* Y_data = Y.data<scalar_t>();
+    scalar_t* mean_data = mean.data<scalar_t>();
+    scalar_t* rstd_data = rstd.data<scalar_t>();
+
+    parallel_for(0, M, rows_grain_size(N), [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        const scalar_t* x = X_data + i * N;
+        scalar_t* y = Y_data + i * N;
+        const auto moments = welford_moments(x, N);
+        const scalar_t row_rstd =
+            scalar_t(1) / std::sqrt(std::max<scalar_t>(moments.second, 0) + eps);
+        mean_data[i] = moments.first;
+        rstd_data[i] = row_rstd;
+        // y = (x - mean) * rstd * gamma + beta = x * scale + bias
+        const Vec rstd_vec(row_rstd);
+        const Vec shift_vec(-moments.first * row_rstd);
+        vec_for<scalar_t>(N, [&](int64_t d, int64_t n) {
+          Vec scale = rstd_vec;
+          Vec bias = shift_vec;
+          if (gamma_data != nullptr) {
+            const Vec g = Vec::loadu(gamma_data + d, n);
+            scale = scale * g;
+            bias = bias * g;
+          }
+          if (beta_data != nullptr) {
+            bias = bias + Vec::loadu(beta_data + d, n);
+          }
+          (Vec::loadu(x + d, n) * scale + bias).store(y + d, n);
+        });
+      }
+    });
+  });
+}
+
+// With xhat = (x - mean) * rstd and dxhat = dy * gamma over a row of N values,
+//   dx = rstd * dxhat + c1 * x + c2
+//   c1 = -rstd^3 * (sum(dxhat * x) - mean * sum(dxhat)) / N
+//   c2 = -rstd * sum(dxhat) / N - c1 * mean
+// and dgamma = sum over rows of dy * xhat, dbeta = sum over rows of dy.
+static void layer_norm_backward_kernel_impl(
+    const Tensor& dY,
+    const Tensor& X,
+    const Tensor& mean,
+    const Tensor& rstd,
+    const Tensor& gamma,
+    int64_t M,
+    int64_t N,
+    Tensor& dX,
+    Tensor& dgamma,
+    Tensor& dbeta) {
+  AT_DISPATCH_FLOATING_TYPES(X.type(), "native_layer_norm_backward", [&] {
+    using Vec = Vec256<scalar_t>;
+    const scalar_t* dY_data = dY.data<scalar_t>();
+    const scalar_t* X_data = X.data<scalar_t>();
+    const scalar_t* mean_data = mean.data<scalar_t>();
+    const scalar_t* rstd_data = rstd.data<scalar_t>();
+    const scalar_t* gamma_data = gamma.defined() ? gamma.data<scalar_t>() : nullptr;
+
+    if (dX.defined()) {
+      scalar_t* dX_data = dX.data<scalar_t>();
+      parallel_for(0, M, rows_grain_size(N), [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          const scalar_t* dy = dY_data + i * N;
+          const scalar_t* x = X_data + i * N;
+          scalar_t* dx = dX_data + i * N;
+          Vec ds_vec(0);
+          Vec db_vec(0);
+          vec_for<scalar_t>(N, [&](int64_t d, int64_t n) {
+            Vec dxhat = Vec::loadu(dy + d, n);
+            if (gamma_data != nullptr) {
+              dxhat = dxhat * Vec::loadu(gamma_data + d, n);
+            }
+            ds_vec = ds_vec + dxhat * Vec::loadu(x + d, n);
+            db_vec = db_vec + dxhat;
+          });
+          const scalar_t ds = vec_reduce_all<scalar_t>(
+              [](Vec& a, Vec& b) { return a + b; }, ds_vec, Vec::size);
+          const scalar_t db = vec_reduce_all<scalar_t>(
+              [](Vec& a, Vec& b) { return a + b; }, db_vec, Vec::size);
+
+          const scalar_t row_mean = mean_data[i];
+          const scalar_t row_rstd = rstd_data[i];
+          const scalar_t c1 =
+              -row_rstd * row_rstd * row_rstd * (ds - row_mean * db) / N;
+          const scalar_t c2 = -row_rstd * db / N - c1 * row_mean;
+          const Vec rstd_vec(row_rstd);
+          const Vec c1_vec(c1);
+          const Vec c2_vec(c2);
+          vec_for<scalar_t>(N, [&](int64_t d, int64_t n) {
+            Vec dxhat = Vec::loadu(dy + d, n);
+            if (gamma_data != nullptr) {
+              dxhat = dxhat * Vec::loadu(gamma_data + d, n);
+            }
+            (rstd_vec * dxhat + c1_vec * Vec::loadu(x + d, n) + c2_vec)
+                .store(dx + d, n);
+          });
+        }
+      });
+    }
+
+    if (dgamma.defined() || dbeta.defined()) {
+      scalar_t* dgamma_data = dgamma.defined() ? dgamma.data<scalar_t>() : nullptr;
+      scalar_t* dbeta_data = dbeta.defined() ? dbeta.data<scalar_t>() : nullptr;
+      // Columns are independent, so every chunk of columns walks all rows.
+      const int64_t grain =
+          std::max<int64_t>(internal::grain_size_for_cost(internal::cost::ARITHMETIC) / std::max<int64_t>(M, 1),
+                            Vec::size);
+      parallel_for(0, N, grain, [&](int64_t begin, int64_t end) {
+        if (dgamma_data != nullptr) {
+          std::fill(dgamma_data + begin, dgamma_data + end, scalar_t(0));
+        }
+        if (dbeta_data != nullptr) {
+          std::fill(dbeta_data + begin, dbeta_data + end, scalar_t(0));
+        }
+        for (int64_t i = 0; i < M; i++) {
+          const scalar_t* dy = dY_data + i * N;
+          const scalar_t* x = X_data + i * N;
+          const Vec mean_vec(mean_data[i]);
+          const Vec rstd_vec(rstd_data[i]);
+          vec_for<scalar_t>(end - begin, [&](int64_t d, int64_t n) {
+            const int64_t j = begin + d;
+            const Vec dy_vec = Vec::loadu(dy + j, n);
+            if (dgamma_data != nullptr) {
+              (Vec::loadu(dgamma_data + j, n) +
+               dy_vec * (Vec::loadu(x + j, n) - mean_vec) * rstd_vec)
+                  .store(dgamma_data + j, n);
+            }
+            if (dbeta_data != nullptr) {
+              (Vec::loadu(dbeta_data + j, n) + dy_vec).store(dbeta_data + j, n);
+            }
+          });
+        }
+      });
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(layer_norm_stub, &layer_norm_kernel_impl);
+REGISTER_DISPATCH(layer_norm_backward_stub, &layer_norm_backward_kernel_impl);
+
+}} // namespace at::native
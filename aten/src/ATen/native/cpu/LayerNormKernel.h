@@ -0,0 +1,38 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Fused layer normalization of the M rows of N values of a contiguous X (see
+// native_layer_norm). gamma and beta are either undefined or contiguous
+// vectors of size N. mean and rstd are preallocated vectors of size M that
+// receive the statistics of every row, which the backward reuses.
+using layer_norm_fn = void (*)(
+    const Tensor& X,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double eps,
+    Tensor& Y,
+    Tensor& mean,
+    Tensor& rstd);
+// Gradients of the above. Outputs that are undefined are not computed.
+using layer_norm_backward_fn = void (*)(
+    const Tensor& dY,
+    const Tensor& X,
+    const Tensor& mean,
+    const Tensor& rstd,
+    const Tensor& gamma,
+    int64_t M,
+    int64_t N,
+    Tensor& dX,
+    Tensor& dgamma,
+    Tensor& dbeta);
+
+DECLARE_DISPATCH(layer_norm_fn, layer_norm_stub);
+DECLARE_DISPATCH(layer_norm_backward_fn, layer_norm_backward_stub);
+
+}} // namespace at::native
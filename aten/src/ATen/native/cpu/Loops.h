@@ -1,9 +1,11 @@
 #pragma once
 
 #include <stdint.h>
+#include <initializer_list>
 #include <ATen/detail/FunctionTraits.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/cpu/vec256/vec256.h>
+#include <c10/util/C++17.h>
 
 namespace at { namespace native { namespace {
 
@@ -112,8 +114,11 @@ static inline void vectorized_binary_loop_s2(char** data, const int64_t* strides
   binary_loop<traits>(data, strides, i, n, op);
 }
 
+// `grain_size` is forwarded to TensorIterator::for_each; expensive ops should
+// pass internal::grain_size_for_cost(...) so they parallelize on smaller
+// inputs.
 template <typename func_t>
-void binary_kernel(TensorIterator& iter, func_t op) {
+void binary_kernel(TensorIterator& iter, func_t op, int64_t grain_size = internal::GRAIN_SIZE) {
   using traits = binary_function_traits<func_t>;
 
   iter.for_each([&](int ntensor, char** data, const int64_t* strides, int64_t n) {
@@ -127,11 +132,11 @@ void binary_kernel(TensorIterator& iter, func_t op) {
     } else {
       binary_loop<traits>(data, strides, 0, n, op);
     }
-  });
+  }, grain_size);
 }
 
 template <typename func_t, typename vec_func_t>
-void binary_kernel_vec(TensorIterator& iter, func_t op, vec_func_t vop) {
+void binary_kernel_vec(TensorIterator& iter, func_t op, vec_func_t vop, int64_t grain_size = internal::GRAIN_SIZE) {
   using traits = binary_function_traits<func_t>;
   static_assert(
     std::is_same<typename traits::result_type, typename traits::arg1_t>::value,
@@ -150,7 +155,57 @@ void binary_kernel_vec(TensorIterator& iter, func_t op, vec_func_t vop) {
     } else {
       binary_loop<traits>(data, strides, 0, n, op);
     }
-  });
+  }, grain_size);
+}
+
+// Calls op on the i-th element of each input (data[1], data[2], ...)
+template <typename traits, typename func_t, size_t... I>
+static inline typename traits::result_type
+invoke(const func_t& op, char** data, const int64_t* strides, int64_t i,
+       c10::guts::index_sequence<I...>) {
+  return op(*(typename traits::template arg<I>::type*)(data[I + 1] + i * strides[I + 1])...);
+}
+
+// all operands contiguous
+template <typename traits, size_t... I>
+static inline bool is_contiguous(const int64_t* strides, c10::guts::index_sequence<I...>) {
+  bool contiguous = strides[0] == sizeof(typename traits::result_type);
+  (void)std::initializer_list<int>{
+    (contiguous = contiguous &&
+        strides[I + 1] == sizeof(typename traits::template arg<I>::type), 0)...};
+  return contiguous;
+}
+
+// Basic loop operation with any number of inputs and one output. May be
+// auto-vectorized by the compiler.
+template <typename traits, typename func_t>
+static inline void basic_loop(char** data, const int64_t* strides, int64_t i, int64_t n, func_t op) {
+  using result_t = typename traits::result_type;
+  using indices = c10::guts::make_index_sequence<traits::arity>;
+  char* out_ptr = data[0];
+  int64_t s0 = strides[0];
+  for (; i < n; i++) {
+    *(result_t*)(out_ptr + i * s0) = invoke<traits>(op, data, strides, i, indices{});
+  }
+}
+
+// Element-wise kernel for ops with any number of inputs, e.g. where(cond, a, b).
+// The types of the operands must match the arguments and the result of op;
+// inputs of other types than the output need TensorIterator::Builder's
+// add_input(input, type).
+template <typename func_t>
+void cpu_kernel(TensorIterator& iter, func_t op, int64_t grain_size = internal::GRAIN_SIZE) {
+  using traits = function_traits<func_t>;
+  using indices = c10::guts::make_index_sequence<traits::arity>;
+
+  iter.for_each([&](int ntensor, char** data, const int64_t* strides, int64_t n) {
+    // Specialization to encourage auto-vectorization
+    if (is_contiguous<traits>(strides, indices{})) {
+      basic_loop<traits>(data, strides, 0, n, op);
+    } else {
+      basic_loop<traits>(data, strides, 0, n, op);
+    }
+  }, grain_size);
 }
 
 }}}  // namespace at::native::<anonymous>
@@ -0,0 +1,260 @@
+#include "ATen/native/cpu/LossCTCKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "ATen/Dispatch.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// log(exp(a) + exp(b) + exp(c)), the sum of eq (6) and (10) of Graves et al.
+// Clamping the maximum to the lowest finite value handles the case where all
+// three are -inf without a branch: the exps are then 0, and so is the sum.
+template <typename scalar_t>
+inline scalar_t log_add_exp3(scalar_t a, scalar_t b, scalar_t c) {
+  const scalar_t m = std::max(
+      std::max(a, b), std::max(c, std::numeric_limits<scalar_t>::lowest()));
+  return std::log(std::exp(a - m) + std::exp(b - m) + std::exp(c - m)) + m;
+}
+
+template <typename scalar_t>
+inline Vec256<scalar_t> log_add_exp3(
+    const Vec256<scalar_t>& a,
+    const Vec256<scalar_t>& b,
+    const Vec256<scalar_t>& c) {
+  using Vec = Vec256<scalar_t>;
+  const Vec m = vec256::max(
+      vec256::max(a, b),
+      vec256::max(c, Vec(std::numeric_limits<scalar_t>::lowest())));
+  return ((a - m).exp() + (b - m).exp() + (c - m).exp()).log() + m;
+}
+
+// The per-thread scratch of the recursions, reused across items and calls:
+// skip[s] is 0 if the alpha of s - 2 contributes to the alpha of s (eq (6)
+// versus (7), the same test applies to the betas), and -inf otherwise, so that
+// adding it masks that term. lp_row holds the log_probs of the augmented
+// target at one time step, and beta two rows of betas.
+template <typename scalar_t>
+struct CTCScratch {
+  scalar_t* skip;
+  scalar_t* lp_row;
+  scalar_t* beta;
+
+  CTCScratch(const int64_t* target_primes, int64_t num_target_primes) {
+    static thread_local std::vector<scalar_t> buffer;
+    const int64_t S = num_target_primes;
+    buffer.resize(4 * S);
+    skip = buffer.data();
+    lp_row = skip + S;
+    beta = lp_row + S;
+    constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+    for (int64_t s = 0; s < S; s++) {
+      skip[s] =
+          (s > 1 && target_primes[s - 2] != target_primes[s]) ? 0 : neginf;
+    }
+  }
+
+  void gather(
+      const Tensor& log_probs,
+      int64_t t,
+      const int64_t* target_primes,
+      int64_t S) {
+    const scalar_t* lp_t =
+        log_probs.data<scalar_t>() + t * log_probs.stride(0);
+    const int64_t lp_stride = log_probs.stride(1);
+    for (int64_t s = 0; s < S; s++) {
+      lp_row[s] = lp_t[target_primes[s] * lp_stride];
+    }
+  }
+};
+
+template <typename scalar_t>
+void ctc_loss_alpha(
+    Tensor& log_alpha,
+    const Tensor& log_probs,
+    const int64_t* target_primes,
+    int64_t S,
+    int64_t input_length) {
+  using Vec = Vec256<scalar_t>;
+  constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+  CTCScratch<scalar_t> scratch(target_primes, S);
+  scalar_t* const alpha = log_alpha.data<scalar_t>();
+  const int64_t alpha_stride = log_alpha.stride(0);
+
+  // alpha_1, above eq (6)
+  scratch.gather(log_probs, 0, target_primes, S);
+  std::fill(alpha, alpha + log_alpha.size(1), neginf);
+  alpha[0] = scratch.lp_row[0];
+  if (S > 1) {
+    alpha[1] = scratch.lp_row[1];
+  }
+
+  // eq (6) and (7). Every alpha of a row only depends on the previous row,
+  // so all s but the first two, which lack predecessors, are vectorized.
+  for (int64_t t = 1; t < input_length; t++) {
+    const scalar_t* prev = alpha + (t - 1) * alpha_stride;
+    scalar_t* cur = alpha + t * alpha_stride;
+    scratch.gather(log_probs, t, target_primes, S);
+    const scalar_t* lp_row = scratch.lp_row;
+    cur[0] = log_add_exp3(prev[0], neginf, neginf) + lp_row[0];
+    if (S > 1) {
+      cur[1] = log_add_exp3(prev[1], prev[0], neginf) + lp_row[1];
+    }
+    for (int64_t s = 2; s < S; s += Vec::size) {
+      const int64_t n = std::min<int64_t>(Vec::size, S - s);
+      const Vec skipped =
+          Vec::loadu(prev + s - 2, n) + Vec::loadu(scratch.skip + s, n);
+      const Vec res = log_add_exp3(
+          Vec::loadu(prev + s, n), Vec::loadu(prev + s - 1, n), skipped);
+      (res + Vec::loadu(lp_row + s, n)).store(cur + s, n);
+    }
+  }
+}
+
+template <typename scalar_t>
+void ctc_loss_backward(
+    Tensor& grad,
+    const Tensor& log_probs,
+    const Tensor& log_alpha,
+    const int64_t* target_primes,
+    int64_t S,
+    int64_t input_length,
+    scalar_t nll,
+    scalar_t grad_out) {
+  using Vec = Vec256<scalar_t>;
+  constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+  CTCScratch<scalar_t> scratch(target_primes, S);
+  const scalar_t* const alpha = log_alpha.data<scalar_t>();
+  const int64_t alpha_stride = log_alpha.stride(0);
+  scalar_t* const grad_data = grad.data<scalar_t>();
+  const int64_t grad_stride0 = grad.stride(0);
+  const int64_t grad_stride1 = grad.stride(1);
+
+  // collected[t, target'[s]] "log+=" log_alpha[t, s] + log_beta[t, s], the
+  // sum of eq (16). Several s map to the same label, so this stays scalar.
+  auto collect = [&](int64_t t, const scalar_t* beta_t) {
+    const scalar_t* alpha_t = alpha + t * alpha_stride;
+    scalar_t* grad_t = grad_data + t * grad_stride0;
+    for (int64_t s = 0; s < S; s++) {
+      const scalar_t log_alpha_beta = alpha_t[s] + beta_t[s];
+      scalar_t& lcab = grad_t[target_primes[s] * grad_stride1];
+      if (lcab == neginf) {
+        lcab = log_alpha_beta;
+      } else {
+        const scalar_t max = std::max(lcab, log_alpha_beta);
+        lcab = std::log(std::exp(lcab - max) + std::exp(log_alpha_beta - max)) +
+            max;
+      }
+    }
+  };
+
+  // The betas of a time step only depend on the next one, so two rows
+  // suffice when the collection follows every row.
+  if (input_length > 0) {
+    scalar_t* beta_last = scratch.beta + ((input_length - 1) % 2) * S;
+    scratch.gather(log_probs, input_length - 1, target_primes, S);
+    std::fill(beta_last, beta_last + S, neginf);
+    // the initialization of beta before eq (10)
+    beta_last[S - 1] = scratch.lp_row[S - 1];
+    if (S > 1) {
+      beta_last[S - 2] = scratch.lp_row[S - 2];
+    }
+    collect(input_length - 1, beta_last);
+  }
+
+  // eq (10) and (11), vectorized over all s but the last two, which lack
+  // successors
+  for (int64_t t = input_length - 2; t >= 0; t--) {
+    const scalar_t* next = scratch.beta + ((t + 1) % 2) * S;
+    scalar_t* cur = scratch.beta + (t % 2) * S;
+    scratch.gather(log_probs, t, target_primes, S);
+    const scalar_t* lp_row = scratch.lp_row;
+    for (int64_t s = 0; s < S - 2; s += Vec::size) {
+      const int64_t n = std::min<int64_t>(Vec::size, S - 2 - s);
+      const Vec skipped =
+          Vec::loadu(next + s + 2, n) + Vec::loadu(scratch.skip + s + 2, n);
+      const Vec res = log_add_exp3(
+          Vec::loadu(next + s, n), Vec::loadu(next + s + 1, n), skipped);
+      (res + Vec::loadu(lp_row + s, n)).store(cur + s, n);
+    }
+    if (S > 1) {
+      cur[S - 2] =
+          log_add_exp3(next[S - 2], next[S - 1], neginf) + lp_row[S - 2];
+    }
+    cur[S - 1] = log_add_exp3(next[S - 1], neginf, neginf) + lp_row[S - 1];
+    collect(t, cur);
+  }
+
+  // Now grad has the sum of eq (16). Wrap up the calculation by adding in
+  // the remaining items of eq (16). grad_out is the output gradient, nll the
+  // loss; the likelihood -nll is the Z of eq (16).
+  const int64_t num_labels = log_probs.size(1);
+  const scalar_t* const lp_data = log_probs.data<scalar_t>();
+  const bool contiguous_rows = log_probs.stride(1) == 1 && grad_stride1 == 1;
+  for (int64_t t = 0; t < input_length; t++) {
+    const scalar_t* lp_t = lp_data + t * log_probs.stride(0);
+    scalar_t* grad_t = grad_data + t * grad_stride0;
+    if (contiguous_rows) {
+      for (int64_t c = 0; c < num_labels; c += Vec::size) {
+        const int64_t n = std::min<int64_t>(Vec::size, num_labels - c);
+        const Vec lp = Vec::loadu(lp_t + c, n);
+        const Vec res = Vec::loadu(grad_t + c, n);
+        ((lp.exp() - (res + Vec(nll) - lp).exp()) * Vec(grad_out))
+            .store(grad_t + c, n);
+      }
+    } else {
+      for (int64_t c = 0; c < num_labels; c++) {
+        scalar_t& res = grad_t[c * grad_stride1];
+        const scalar_t lp = lp_t[c * log_probs.stride(1)];
+        res = (std::exp(lp) - std::exp(res + nll - lp)) * grad_out;
+      }
+    }
+  }
+}
+
+void ctc_loss_alpha_kernel_impl(
+    Tensor& log_alpha,
+    const Tensor& log_probs,
+    const int64_t* target_primes,
+    int64_t num_target_primes,
+    int64_t input_length) {
+  AT_DISPATCH_FLOATING_TYPES(log_probs.type(), "ctc_loss_alpha", [&] {
+    ctc_loss_alpha<scalar_t>(
+        log_alpha, log_probs, target_primes, num_target_primes, input_length);
+  });
+}
+
+void ctc_loss_backward_kernel_impl(
+    Tensor& grad,
+    const Tensor& log_probs,
+    const Tensor& log_alpha,
+    const int64_t* target_primes,
+    int64_t num_target_primes,
+    int64_t input_length,
+    double neg_log_likelihood,
+    double grad_out) {
+  AT_DISPATCH_FLOATING_TYPES(log_probs.type(), "ctc_loss_backward", [&] {
+    ctc_loss_backward<scalar_t>(
+        grad,
+        log_probs,
+        log_alpha,
+        target_primes,
+        num_target_primes,
+        input_length,
+        neg_log_likelihood,
+        grad_out);
+  });
+}
+
+} // namespace
+
+REGISTER_DISPATCH(ctc_loss_alpha_stub, &ctc_loss_alpha_kernel_impl);
+REGISTER_DISPATCH(ctc_loss_backward_stub, &ctc_loss_backward_kernel_impl);
+
+}} // namespace at::native
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// The recursions of the CPU CTC loss for one batch item (see LossCTC.cpp).
+// log_probs is the input_len x num_labels slice of the item, and
+// target_primes are the 2 * target_length + 1 labels of the augmented target
+// (l' in Graves et al.), starting and ending with the blank.
+//
+// Computes the rows [0, input_length) of log_alpha, an input_len x
+// (2 * max_target_length + 1) slice with contiguous rows.
+using ctc_loss_alpha_fn = void (*)(
+    Tensor& log_alpha,
+    const Tensor& log_probs,
+    const int64_t* target_primes,
+    int64_t num_target_primes,
+    int64_t input_length);
+// Computes the betas, and the gradient of eq (16) of Graves et al. into the
+// rows [0, input_length) of grad, which must be filled with -inf (the log of
+// an empty sum) and have the layout of log_probs.
+using ctc_loss_backward_fn = void (*)(
+    Tensor& grad,
+    const Tensor& log_probs,
+    const Tensor& log_alpha,
+    const int64_t* target_primes,
+    int64_t num_target_primes,
+    int64_t input_length,
+    double neg_log_likelihood,
+    double grad_out);
+
+DECLARE_DISPATCH(ctc_loss_alpha_fn, ctc_loss_alpha_stub);
+DECLARE_DISPATCH(ctc_loss_backward_fn, ctc_loss_backward_stub);
+
+}} // namespace at::native
@@ -0,0 +1,85 @@
+#include "ATen/Dispatch.h"
+#include "ATen/native/PointwiseOps.h"
+#include "ATen/native/TensorIterator.h"
+#include "ATen/native/cpu/Loops.h"
+
+namespace at { namespace native {
+namespace {
+
+// The comparisons are ordered so that nan values are propagated, as in TH
+void clamp_kernel(TensorIterator& iter, Scalar min_scalar, Scalar max_scalar) {
+  AT_DISPATCH_ALL_TYPES(iter.type(), "clamp", [&]() {
+    auto min = min_scalar.to<scalar_t>();
+    auto max = max_scalar.to<scalar_t>();
+    cpu_kernel(iter, [=](scalar_t a) -> scalar_t {
+      return a < min ? min : (a > max ? max : a);
+    });
+  });
+}
+
+void clamp_min_kernel(TensorIterator& iter, Scalar min_scalar) {
+  AT_DISPATCH_ALL_TYPES(iter.type(), "clamp_min", [&]() {
+    auto min = min_scalar.to<scalar_t>();
+    cpu_kernel(iter, [=](scalar_t a) -> scalar_t {
+      return a < min ? min : a;
+    });
+  });
+}
+
+void clamp_max_kernel(TensorIterator& iter, Scalar max_scalar) {
+  AT_DISPATCH_ALL_TYPES(iter.type(), "clamp_max", [&]() {
+    auto max = max_scalar.to<scalar_t>();
+    cpu_kernel(iter, [=](scalar_t a) -> scalar_t {
+      return a > max ? max : a;
+    });
+  });
+}
+
+// The operands are (result, condition, self, other), condition is uint8
+void where_kernel(TensorIterator& iter) {
+  AT_DISPATCH_ALL_TYPES(iter.type(), "where", [&]() {
+    cpu_kernel(iter, [](uint8_t cond, scalar_t a, scalar_t b) -> scalar_t {
+      return cond ? a : b;
+    });
+  });
+}
+
+void hardshrink_kernel(TensorIterator& iter, Scalar lambd_scalar) {
+  AT_DISPATCH_FLOATING_TYPES(iter.type(), "hardshrink_cpu", [&]() {
+    auto lambd = lambd_scalar.to<scalar_t>();
+    cpu_kernel(iter, [=](scalar_t a) -> scalar_t {
+      return (a >= -lambd && a <= lambd) ? scalar_t(0) : a;
+    });
+  });
+}
+
+// The operands are (grad_input, self, grad)
+void hardshrink_backward_kernel(TensorIterator& iter, Scalar lambd_scalar) {
+  AT_DISPATCH_FLOATING_TYPES(iter.type(), "hardshrink_backward_cpu", [&]() {
+    auto lambd = lambd_scalar.to<scalar_t>();
+    cpu_kernel(iter, [=](scalar_t a, scalar_t grad) -> scalar_t {
+      return (a >= -lambd && a <= lambd) ? scalar_t(0) : grad;
+    });
+  });
+}
+
+// The operands are (grad_input, target, grad)
+void kl_div_backward_kernel(TensorIterator& iter) {
+  AT_DISPATCH_FLOATING_TYPES(iter.type(), "kl_div_backward", [&]() {
+    cpu_kernel(iter, [](scalar_t target, scalar_t grad) -> scalar_t {
+      return target > 0 ? -target * grad : scalar_t(0);
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(clamp_stub, &clamp_kernel);
+REGISTER_DISPATCH(clamp_min_stub, &clamp_min_kernel);
+REGISTER_DISPATCH(clamp_max_stub, &clamp_max_kernel);
+REGISTER_DISPATCH(where_stub, &where_kernel);
+REGISTER_DISPATCH(hardshrink_stub, &hardshrink_kernel);
+REGISTER_DISPATCH(hardshrink_backward_stub, &hardshrink_backward_kernel);
+REGISTER_DISPATCH(kl_div_backward_stub, &kl_div_backward_kernel);
+
+}} // namespace at::native
@@ -0,0 +1,274 @@
+#include "ATen/native/cpu/RNNKernel.h"
+
+#include <algorithm>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/functional.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Calls f(d, n) for consecutive runs [d, d + n) of at most one vector that
+// cover [0, size). Only the last run can be partial.
+template <typename scalar_t, typename F>
+static inline void vec_for(int64_t size, const F& f) {
+  using Vec = Vec256<scalar_t>;
+  int64_t d = 0;
+  for (; d + Vec::size <= size; d += Vec::size) {
+    f(d, Vec::size);
+  }
+  if (d < size) {
+    f(d, size - d);
+  }
+}
+
+template <typename scalar_t>
+static inline Vec256<scalar_t> sigmoid(const Vec256<scalar_t>& x) {
+  const Vec256<scalar_t> one(1);
+  return one / (one + x.neg().exp());
+}
+
+// Sum of both biases at [d, d + n), or zero if the cell has no biases.
+template <typename scalar_t>
+static inline Vec256<scalar_t> load_bias(
+    const scalar_t* b1,
+    const scalar_t* b2,
+    int64_t d,
+    int64_t n) {
+  using Vec = Vec256<scalar_t>;
+  if (b1 == nullptr) {
+    return Vec(0);
+  }
+  return Vec::loadu(b1 + d, n) + Vec::loadu(b2 + d, n);
+}
+
+// Batch rows are independent. Every row does a few transcendental ops per
+// gate element, so rows are split into chunks of about that much work.
+static inline int64_t rows_grain_size(int64_t row_size) {
+  return std::max<int64_t>(
+      internal::grain_size_for_cost(internal::cost::TRANSCENDENTAL) / std::max<int64_t>(row_size, 1),
+      1);
+}
+
+static void lstm_cell_kernel_impl(
+    Tensor& hy,
+    Tensor& cy,
+    Tensor& workspace,
+    const Tensor& input_gates,
+    const Tensor& hidden_gates,
+    const Tensor& cx,
+    const Tensor& input_bias,
+    const Tensor& hidden_bias) {
+  AT_DISPATCH_FLOATING_TYPES(input_gates.type(), "_thnn_fused_lstm_cell_cpu", [&] {
+    using Vec = Vec256<scalar_t>;
+    const int64_t batch_size = cx.size(0);
+    const int64_t hsz = cx.size(1);
+    const int64_t gsz = 4 * hsz;
+    const scalar_t* ig_data = input_gates.data<scalar_t>();
+    const scalar_t* hg_data = hidden_gates.data<scalar_t>();
+    const scalar_t* b1_data = input_bias.defined() ? input_bias.data<scalar_t>() : nullptr;
+    const scalar_t* b2_data = hidden_bias.defined() ? hidden_bias.data<scalar_t>() : nullptr;
+    const scalar_t* cx_data = cx.data<scalar_t>();
+    scalar_t* hy_data = hy.data<scalar_t>();
+    scalar_t* cy_data = cy.data<scalar_t>();
+    scalar_t* w_data = workspace.data<scalar_t>();
+
+    parallel_for(0, batch_size, rows_grain_size(gsz), [&](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; b++) {
+        const scalar_t* ig = ig_data + b * gsz;
+        const scalar_t* hg = hg_data + b * gsz;
+        scalar_t* gates = w_data + b * gsz;
+        // Gate pre-activations go straight into the workspace, which then
+        // holds the activated input, forget, cell and output gates.
+        vec_for<scalar_t>(gsz, [&](int64_t d, int64_t n) {
+          (Vec::loadu(ig + d, n) + Vec::loadu(hg + d, n) + load_bias(b1_data, b2_data, d, n))
+              .store(gates + d, n);
+        });
+        map([](Vec x) { return sigmoid(x); }, gates, gates, 2 * hsz);
+        map([](Vec x) { return x.tanh(); }, gates + 2 * hsz, gates + 2 * hsz, hsz);
+        map([](Vec x) { return sigmoid(x); }, gates + 3 * hsz, gates + 3 * hsz, hsz);
+
+        const scalar_t* cx_row = cx_data + b * hsz;
+        scalar_t* hy_row = hy_data + b * hsz;
+        scalar_t* cy_row = cy_data + b * hsz;
+        vec_for<scalar_t>(hsz, [&](int64_t d, int64_t n) {
+          Vec i = Vec::loadu(gates + d, n);
+          Vec f = Vec::loadu(gates + hsz + d, n);
+          Vec c = Vec::loadu(gates + 2 * hsz + d, n);
+          Vec o = Vec::loadu(gates + 3 * hsz + d, n);
+          Vec c_new = f * Vec::loadu(cx_row + d, n) + i * c;
+          c_new.store(cy_row + d, n);
+          (o * c_new.tanh()).store(hy_row + d, n);
+        });
+      }
+    });
+  });
+}
+
+static void lstm_cell_backward_kernel_impl(
+    Tensor& grad_gates,
+    Tensor& grad_cx,
+    const Tensor& grad_hy,
+    const Tensor& grad_cy,
+    const Tensor& cx,
+    const Tensor& cy,
+    const Tensor& workspace) {
+  AT_DISPATCH_FLOATING_TYPES(workspace.type(), "_thnn_fused_lstm_cell_backward_cpu", [&] {
+    using Vec = Vec256<scalar_t>;
+    const int64_t batch_size = cx.size(0);
+    const int64_t hsz = cx.size(1);
+    const int64_t gsz = 4 * hsz;
+    const scalar_t* ghy_data = grad_hy.defined() ? grad_hy.data<scalar_t>() : nullptr;
+    const scalar_t* gcy_data = grad_cy.defined() ? grad_cy.data<scalar_t>() : nullptr;
+    const scalar_t* cx_data = cx.data<scalar_t>();
+    const scalar_t* cy_data = cy.data<scalar_t>();
+    const scalar_t* w_data = workspace.data<scalar_t>();
+    scalar_t* grad_gates_data = grad_gates.data<scalar_t>();
+    scalar_t* grad_cx_data = grad_cx.data<scalar_t>();
+
+    parallel_for(0, batch_size, rows_grain_size(gsz), [&](int64_t begin, int64_t end) {
+      const Vec one(1);
+      for (int64_t b = begin; b < end; b++) {
+        const scalar_t* gates = w_data + b * gsz;
+        scalar_t* grad = grad_gates_data + b * gsz;
+        const int64_t row = b * hsz;
+        vec_for<scalar_t>(hsz, [&](int64_t d, int64_t n) {
+          Vec i = Vec::loadu(gates + d, n);
+          Vec f = Vec::loadu(gates + hsz + d, n);
+          Vec c = Vec::loadu(gates + 2 * hsz + d, n);
+          Vec o = Vec::loadu(gates + 3 * hsz + d, n);
+          Vec go = ghy_data ? Vec::loadu(ghy_data + row + d, n) : Vec(0);
+          Vec goc = gcy_data ? Vec::loadu(gcy_data + row + d, n) : Vec(0);
+
+          Vec tanh_cy = Vec::loadu(cy_data + row + d, n).tanh();
+          Vec gcx = go * o * (one - tanh_cy * tanh_cy) + goc;
+
+          (gcx * c * (one - i) * i).store(grad + d, n);
+          (gcx * Vec::loadu(cx_data + row + d, n) * (one - f) * f).store(grad + hsz + d, n);
+          (gcx * i * (one - c * c)).store(grad + 2 * hsz + d, n);
+          (go * tanh_cy * (one - o) * o).store(grad + 3 * hsz + d, n);
+          (gcx * f).store(grad_cx_data + row + d, n);
+        });
+      }
+    });
+  });
+}
+
+static void gru_cell_kernel_impl(
+    Tensor& hy,
+    Tensor& workspace,
+    const Tensor& input_gates,
+    const Tensor& hidden_gates,
+    const Tensor& hx,
+    const Tensor& input_bias,
+    const Tensor& hidden_bias) {
+  AT_DISPATCH_FLOATING_TYPES(input_gates.type(), "_thnn_fused_gru_cell_cpu", [&] {
+    using Vec = Vec256<scalar_t>;
+    const int64_t batch_size = hx.size(0);
+    const int64_t hsz = hx.size(1);
+    const int64_t gsz = 3 * hsz;
+    const int64_t wsz = 5 * hsz;
+    const scalar_t* ig_data = input_gates.data<scalar_t>();
+    const scalar_t* hg_data = hidden_gates.data<scalar_t>();
+    const scalar_t* b1_data = input_bias.defined() ? input_bias.data<scalar_t>() : nullptr;
+    const scalar_t* b2_data = hidden_bias.defined() ? hidden_bias.data<scalar_t>() : nullptr;
+    const scalar_t* hx_data = hx.data<scalar_t>();
+    scalar_t* hy_data = hy.data<scalar_t>();
+    scalar_t* w_data = workspace.data<scalar_t>();
+
+    parallel_for(0, batch_size, rows_grain_size(wsz), [&](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; b++) {
+        const scalar_t* ig = ig_data + b * gsz;
+        const scalar_t* hg = hg_data + b * gsz;
+        const scalar_t* hx_row = hx_data + b * hsz;
+        scalar_t* hy_row = hy_data + b * hsz;
+        scalar_t* w = w_data + b * wsz;
+        // The reset and input gates only need the sum of both projections.
+        vec_for<scalar_t>(2 * hsz, [&](int64_t d, int64_t n) {
+          sigmoid(Vec::loadu(ig + d, n) + Vec::loadu(hg + d, n) + load_bias(b1_data, b2_data, d, n))
+              .store(w + d, n);
+        });
+        vec_for<scalar_t>(hsz, [&](int64_t d, int64_t n) {
+          const int64_t nd = 2 * hsz + d;
+          Vec r = Vec::loadu(w + d, n);
+          Vec i = Vec::loadu(w + hsz + d, n);
+          Vec h_n = Vec::loadu(hg + nd, n);
+          Vec i_n = Vec::loadu(ig + nd, n);
+          if (b1_data != nullptr) {
+            h_n = h_n + Vec::loadu(b2_data + nd, n);
+            i_n = i_n + Vec::loadu(b1_data + nd, n);
+          }
+          Vec h = Vec::loadu(hx_row + d, n);
+          Vec ng = (i_n + r * h_n).tanh();
+          (ng + i * (h - ng)).store(hy_row + d, n);
+          ng.store(w + 2 * hsz + d, n);
+          h.store(w + 3 * hsz + d, n);
+          h_n.store(w + 4 * hsz + d, n);
+        });
+      }
+    });
+  });
+}
+
+static void gru_cell_backward_kernel_impl(
+    Tensor& grad_input_gates,
+    Tensor& grad_hidden_gates,
+    Tensor& grad_hx,
+    const Tensor& grad_hy,
+    const Tensor& workspace) {
+  AT_DISPATCH_FLOATING_TYPES(workspace.type(), "_thnn_fused_gru_cell_backward_cpu", [&] {
+    using Vec = Vec256<scalar_t>;
+    const int64_t batch_size = grad_hy.size(0);
+    const int64_t hsz = grad_hy.size(1);
+    const int64_t gsz = 3 * hsz;
+    const int64_t wsz = 5 * hsz;
+    const scalar_t* ghy_data = grad_hy.data<scalar_t>();
+    const scalar_t* w_data = workspace.data<scalar_t>();
+    scalar_t* gig_data = grad_input_gates.data<scalar_t>();
+    scalar_t* ghg_data = grad_hidden_gates.data<scalar_t>();
+    scalar_t* ghx_data = grad_hx.data<scalar_t>();
+
+    parallel_for(0, batch_size, rows_grain_size(wsz), [&](int64_t begin, int64_t end) {
+      const Vec one(1);
+      for (int64_t b = begin; b < end; b++) {
+        const scalar_t* w = w_data + b * wsz;
+        scalar_t* gi = gig_data + b * gsz;
+        scalar_t* gh = ghg_data + b * gsz;
+        const int64_t row = b * hsz;
+        vec_for<scalar_t>(hsz, [&](int64_t d, int64_t n) {
+          Vec r = Vec::loadu(w + d, n);
+          Vec i = Vec::loadu(w + hsz + d, n);
+          Vec ng = Vec::loadu(w + 2 * hsz + d, n);
+          Vec h = Vec::loadu(w + 3 * hsz + d, n);
+          Vec h_n = Vec::loadu(w + 4 * hsz + d, n);
+          Vec go = Vec::loadu(ghy_data + row + d, n);
+
+          Vec gig = go * (h - ng) * (one - i) * i;
+          Vec gin = go * (one - i) * (one - ng * ng);
+          Vec grg = gin * h_n * (one - r) * r;
+
+          grg.store(gi + d, n);
+          gig.store(gi + hsz + d, n);
+          gin.store(gi + 2 * hsz + d, n);
+          grg.store(gh + d, n);
+          gig.store(gh + hsz + d, n);
+          (gin * r).store(gh + 2 * hsz + d, n);
+          (go * i).store(ghx_data + row + d, n);
+        });
+      }
+    });
+  });
+}
+
+} // namespace
+
+REGISTER_DISPATCH(lstm_cell_stub, &lstm_cell_kernel_impl);
+REGISTER_DISPATCH(lstm_cell_backward_stub, &lstm_cell_backward_kernel_impl);
+REGISTER_DISPATCH(gru_cell_stub, &gru_cell_kernel_impl);
+REGISTER_DISPATCH(gru_cell_backward_stub, &gru_cell_backward_kernel_impl);
+
+}} // namespace at::native
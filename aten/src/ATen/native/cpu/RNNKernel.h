@@ -0,0 +1,54 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Pointwise parts of the fused LSTM and GRU cells (see _thnn_fused_lstm_cell
+// and _thnn_fused_gru_cell). All tensors are contiguous and outputs are
+// preallocated. Biases are either both defined or both undefined, and so are
+// grad_hy and grad_cy, except that one of them may be undefined.
+//
+// The workspace layouts match the CUDA kernels:
+//  LSTM: {batch, 4 * hidden} activated input, forget, cell and output gates.
+//  GRU:  {batch, 5 * hidden} reset gate, input gate, new gate, hx and the
+//        hidden part of the new gate (including its bias).
+using lstm_cell_fn = void (*)(
+    Tensor& hy,
+    Tensor& cy,
+    Tensor& workspace,
+    const Tensor& input_gates,
+    const Tensor& hidden_gates,
+    const Tensor& cx,
+    const Tensor& input_bias,
+    const Tensor& hidden_bias);
+using lstm_cell_backward_fn = void (*)(
+    Tensor& grad_gates,
+    Tensor& grad_cx,
+    const Tensor& grad_hy,
+    const Tensor& grad_cy,
+    const Tensor& cx,
+    const Tensor& cy,
+    const Tensor& workspace);
+using gru_cell_fn = void (*)(
+    Tensor& hy,
+    Tensor& workspace,
+    const Tensor& input_gates,
+    const Tensor& hidden_gates,
+    const Tensor& hx,
+    const Tensor& input_bias,
+    const Tensor& hidden_bias);
+using gru_cell_backward_fn = void (*)(
+    Tensor& grad_input_gates,
+    Tensor& grad_hidden_gates,
+    Tensor& grad_hx,
+    const Tensor& grad_hy,
+    const Tensor& workspace);
+
+DECLARE_DISPATCH(lstm_cell_fn, lstm_cell_stub);
+DECLARE_DISPATCH(lstm_cell_backward_fn, lstm_cell_backward_stub);
+DECLARE_DISPATCH(gru_cell_fn, gru_cell_stub);
+DECLARE_DISPATCH(gru_cell_backward_fn, gru_cell_backward_stub);
+
+}} // namespace at::native
@@ -3,6 +3,8 @@
 #include <numeric>
 #include <iterator>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 #include "ATen/Dispatch.h"
 #include "ATen/Parallel.h"
@@ -357,10 +359,147 @@ static void norm_kernel_impl(
   });
 }
 
+// Running moments for Welford's online variance algorithm. Partial results
+// are merged with the parallel formulation of Chan et al., so both the row
+// and the all-reduce paths can be split across threads. Moments are kept in
+// double regardless of the input type to avoid catastrophic cancellation for
+// float inputs.
+struct WelfordData {
+  double mean = 0;
+  double m2 = 0;
+  int64_t n = 0;
+
+  void update(double x) {
+    n += 1;
+    double delta = x - mean;
+    mean += delta / n;
+    m2 += delta * (x - mean);
+  }
+
+  static WelfordData combine(const WelfordData& a, const WelfordData& b) {
+    if (a.n == 0) {
+      return b;
+    }
+    if (b.n == 0) {
+      return a;
+    }
+    WelfordData r;
+    r.n = a.n + b.n;
+    double delta = b.mean - a.mean;
+    double nb_over_n = (double)b.n / r.n;
+    r.mean = a.mean + delta * nb_over_n;
+    r.m2 = a.m2 + b.m2 + delta * delta * a.n * nb_over_n;
+    return r;
+  }
+
+  double finalize(bool unbiased, bool take_sqrt) const {
+    int64_t divisor = unbiased ? n - 1 : n;
+    double var = divisor > 0 ? m2 / divisor
+                             : std::numeric_limits<double>::quiet_NaN();
+    return take_sqrt ? std::sqrt(var) : var;
+  }
+};
+
+template <typename scalar_t>
+struct StdVarReduction {
+  static void apply(
+      Tensor& res,
+      const Tensor& self,
+      c10::optional<int64_t> dim,
+      bool unbiased,
+      bool take_sqrt) {
+    auto out_ = res.data<scalar_t>();
+    auto data_ = self.data<scalar_t>();
+    auto numel = self.numel();
+    if (!dim.has_value()) {
+      *out_ = (scalar_t)reduce_row(data_, numel).finalize(unbiased, take_sqrt);
+      return;
+    }
+
+    int64_t n = self.size(*dim);
+    int64_t stride = self.stride(*dim);
+    // A contiguous tensor does not need to hold a meaningful stride
+    // if the corresponding size is 1
+    if (n == 1) {
+      stride = 1;
+      for (int64_t i = self.ndimension() - 1; i > *dim; i--) {
+        stride *= self.size(i);
+      }
+    }
+    int64_t batch = numel / (n * stride);
+    if (stride == 1) {
+      int64_t grain_size = std::max<int64_t>(internal::GRAIN_SIZE / std::max<int64_t>(n, 1), 1);
+      parallel_for(0, batch, grain_size, [=](int64_t begin, int64_t end) {
+        for (int64_t b = begin; b < end; b++) {
+          WelfordData acc;
+          const scalar_t* data = &data_[b * n];
+          for (int64_t k = 0; k < n; k++) {
+            acc.update(data[k]);
+          }
+          out_[b] = (scalar_t)acc.finalize(unbiased, take_sqrt);
+        }
+      });
+    } else {
+      // Walk the reduced dimension row by row and keep one accumulator per
+      // output column, so every load is contiguous. Work is split over
+      // (batch, column block) pairs.
+      constexpr int64_t COLS = 256;
+      int64_t col_blocks = divup(stride, COLS);
+      parallel_for(0, batch * col_blocks, 1, [=](int64_t begin, int64_t end) {
+        WelfordData acc[COLS];
+        for (int64_t bi = begin; bi < end; bi++) {
+          int64_t b = bi / col_blocks;
+          int64_t col_begin = (bi % col_blocks) * COLS;
+          int64_t cols = std::min(COLS, stride - col_begin);
+          std::fill(acc, acc + cols, WelfordData());
+          const scalar_t* data = &data_[b * n * stride + col_begin];
+          for (int64_t k = 0; k < n; k++) {
+            for (int64_t j = 0; j < cols; j++) {
+              acc[j].update(data[k * stride + j]);
+            }
+          }
+          scalar_t* out = &out_[b * stride + col_begin];
+          for (int64_t j = 0; j < cols; j++) {
+            out[j] = (scalar_t)acc[j].finalize(unbiased, take_sqrt);
+          }
+        }
+      });
+    }
+  }
+
+  static WelfordData reduce_row(const scalar_t* data, int64_t size) {
+    return parallel_reduce(
+        0,
+        size,
+        internal::GRAIN_SIZE,
+        WelfordData(),
+        [data](int64_t begin, int64_t end, WelfordData init) {
+          WelfordData acc;
+          for (int64_t i = begin; i < end; i++) {
+            acc.update(data[i]);
+          }
+          return WelfordData::combine(init, acc);
+        },
+        WelfordData::combine);
+  }
+};
+
+static void std_var_kernel_impl(
+    Tensor& result,
+    const Tensor& self,
+    c10::optional<int64_t> dim,
+    bool unbiased,
+    bool take_sqrt) {
+  AT_DISPATCH_FLOATING_TYPES(self.type(), "std_var", [&] {
+    StdVarReduction<scalar_t>::apply(result, self, dim, unbiased, take_sqrt);
+  });
+}
+
 }  // anonymous namespace
 
 REGISTER_DISPATCH(sum_kernel, &sum_kernel_impl);
 REGISTER_DISPATCH(prod_kernel, &prod_kernel_impl);
 REGISTER_DISPATCH(norm_kernel, &norm_kernel_impl);
+REGISTER_DISPATCH(std_var_kernel, &std_var_kernel_impl);
 
 }}  // namespace at::native
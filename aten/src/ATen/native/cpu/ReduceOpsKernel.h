@@ -15,4 +15,10 @@ using reduce_norm_fn =
     void (*)(Tensor&, const Tensor&, Scalar, c10::optional<int64_t>);
 DECLARE_DISPATCH(reduce_norm_fn, norm_kernel);
 
+// Computes the variance (or standard deviation if take_sqrt is true) of a
+// contiguous tensor over `dim`, or over all elements if dim is empty.
+using reduce_std_var_fn =
+    void (*)(Tensor&, const Tensor&, c10::optional<int64_t>, bool unbiased, bool take_sqrt);
+DECLARE_DISPATCH(reduce_std_var_fn, std_var_kernel);
+
 }} // namespace at::native
@@ -111,7 +111,8 @@ static void sigmoid_kernel(Tensor& result, const Tensor& self) {
             for (int64_t j = 0; j < width; j++)
               x[stridex * (i + j)] = buffer[j];
           }
-        });
+        },
+        internal::grain_size_for_cost(internal::cost::TRANSCENDENTAL));
   });
 }
 
@@ -174,7 +175,7 @@ void bernoulli_mkl_kernel(Tensor &self, const double p, Generator* gen) {
 }
 #endif
 
-#define IMPLEMENT_FLOAT_KERNEL(dispatchtypes, op)                          \
+#define IMPLEMENT_FLOAT_KERNEL(dispatchtypes, op, op_cost)                 \
   static void op##_kernel(Tensor& result, const Tensor& self) {            \
     checkBackend(#op, {result}, Backend::CPU);                             \
     AT_DISPATCH_##dispatchtypes##_TYPES(self.type(), #op, [&] {            \
@@ -206,7 +207,8 @@ void bernoulli_mkl_kernel(Tensor &self, const double p, Generator* gen) {
                     x[stridex * (i + j)] = buffer[j];                      \
                 }                                                          \
               }                                                            \
-            });                                                            \
+            },                                                             \
+            internal::grain_size_for_cost(internal::cost::op_cost));       \
       }                                                                    \
     });                                                                    \
   }                                                                        \
@@ -217,29 +219,29 @@ void bernoulli_mkl_kernel(Tensor &self, const double p, Generator* gen) {
 REGISTER_DISPATCH(sigmoidImpl, &sigmoid_kernel)
 REGISTER_DISPATCH(bernoulli_mkl_stub, &bernoulli_mkl_kernel);
 
-// IMPLEMENT_FLOAT_KERNEL(ALL, abs)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, acos)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, asin)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, atan)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, ceil)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, cos)
-// IMPLEMENT_FLOAT_KERNEL(FLOATING, cosh)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, erf)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, erfc)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, exp)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, expm1)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, floor)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, log)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, log10)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, log1p)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, log2)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, round)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, rsqrt)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, sin)
-// IMPLEMENT_FLOAT_KERNEL(FLOATING, sinh)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, sqrt)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, tan)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, tanh)
-IMPLEMENT_FLOAT_KERNEL(FLOATING, trunc)
+// IMPLEMENT_FLOAT_KERNEL(ALL, abs, MEMORY_BOUND)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, acos, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, asin, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, atan, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, ceil, MEMORY_BOUND)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, cos, TRANSCENDENTAL)
+// IMPLEMENT_FLOAT_KERNEL(FLOATING, cosh, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, erf, SPECIAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, erfc, SPECIAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, exp, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, expm1, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, floor, MEMORY_BOUND)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, log, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, log10, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, log1p, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, log2, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, round, MEMORY_BOUND)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, rsqrt, ARITHMETIC)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, sin, TRANSCENDENTAL)
+// IMPLEMENT_FLOAT_KERNEL(FLOATING, sinh, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, sqrt, ARITHMETIC)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, tan, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, tanh, TRANSCENDENTAL)
+IMPLEMENT_FLOAT_KERNEL(FLOATING, trunc, MEMORY_BOUND)
 
 }} // namespace at::native
@@ -1,16 +1,39 @@
 #include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/WrapDimUtils.h>
+#include "ATen/native/ReduceOps.h"
 #include "ATen/native/ReduceOpsUtils.h"
 
 namespace at { namespace native {
 
-Tensor _sum_cuda(const Tensor &self_) { return at::_sumall(self_); }
+Tensor _sum_cuda(const Tensor &self_) {
+  Tensor result = at::empty({}, self_.options());
+  if (self_.numel() == 0) {
+    return result.fill_(0);
+  }
+  if (_reduce_iter(sum_stub, result, self_, {}, false)) {
+    return result;
+  }
+  return at::_sumall(self_);
+}
 
-Tensor _prod_cuda(const Tensor &self_) { return at::_prodall(self_); }
+Tensor _prod_cuda(const Tensor &self_) {
+  Tensor result = at::empty({}, self_.options());
+  if (self_.numel() == 0) {
+    return result.fill_(1);
+  }
+  if (_reduce_iter(prod_stub, result, self_, {}, false)) {
+    return result;
+  }
+  return at::_prodall(self_);
+}
 
 Tensor &_sum_out_cuda(Tensor &result, const Tensor &self, int64_t dim,
                       bool keepdim) {
   if (_dimreduce_return_trivial(result, self, 0, dim, keepdim)) {
     return result;
+  } else if (_reduce_iter(sum_stub, result, self, dim, keepdim)) {
+    return result;
   } else {
     return at::_th_sum_out(result, self, dim, keepdim);
   }
@@ -20,10 +43,31 @@ Tensor &_prod_out_cuda(Tensor &result, const Tensor &self, int64_t dim,
                        bool keepdim) {
   if (_dimreduce_return_trivial(result, self, 1, dim, keepdim)) {
     return result;
+  } else if (_reduce_iter(prod_stub, result, self, dim, keepdim)) {
+    return result;
   } else {
     return at::_th_prod_out(result, self, dim, keepdim);
   }
 }
 
+std::tuple<Tensor, Tensor> _var_mean_cuda(const Tensor &self, int64_t dim,
+                                          bool unbiased, bool keepdim) {
+  AT_CHECK(at::isFloatingType(self.type().scalarType()),
+           "_var_mean only supports floating-point dtypes");
+  dim = maybe_wrap_dim(dim, self.dim());
+  if (self.numel() > 0) {
+    Tensor var = at::empty({0}, self.options());
+    Tensor mean = at::empty({0}, self.options());
+    Tensor viewed_var = _reduce_setup(var, self, dim, keepdim);
+    Tensor viewed_mean = _reduce_setup(mean, self, dim, keepdim);
+    auto iter = TensorIterator::reduce_op(viewed_var, viewed_mean, self);
+    if (iter->reduced_dims_fit_32bit_indexing()) {
+      var_mean_stub(kCUDA, *iter, unbiased);
+      return std::make_tuple(var, mean);
+    }
+  }
+  return std::make_tuple(at::var(self, dim, unbiased, keepdim),
+                         at::mean(self, dim, keepdim));
+}
 
 }}
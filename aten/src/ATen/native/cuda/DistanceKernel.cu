@@ -1,4 +1,5 @@
 #include "ATen/ATen.h"
+#include "ATen/cuda/CUDAContext.h"
 #include <THC/THCTensorMathReduce.cuh>
 #include <math.h>
 
@@ -77,25 +78,10 @@ struct dists {
 
 };
 
+// Reduces the aggregates of the threads of a block. The result is valid in
+// thread 0.
 template <typename scalar_t, typename F>
-__global__ static void pdist_kernel_cuda_impl(scalar_t * result, const scalar_t * self, const int64_t n, const int64_t m, const scalar_t p) {
-  const int k = blockIdx.x;
-  const int stride = blockDim.x;
-
-  float n2 = n - .5;
-  // The -1 accounts for floating point truncation issues
-  int64_t i = static_cast<int64_t>((n2 - device_sqrt<scalar_t>(n2 * n2 - 2 * k - 1)));
-  int64_t j = k - n * i + i * (i + 1) / 2 + i + 1;
-
-  const scalar_t * const start = self + i * m;
-  const scalar_t * const end = start + m;
-  const scalar_t * a = start + threadIdx.x;
-  const scalar_t * b = self + j * m + threadIdx.x;
-  scalar_t agg = 0.0;
-  for (; a < end; a += stride, b += stride) {
-    F::inc(agg, std::abs(*a - *b), p);
-  }
-  
+__forceinline__ __device__ scalar_t reduce_agg(scalar_t agg) {
   // Reduce warps
   for (int offset = warpSize / 2; offset > 0; offset /= 2) {
     F::agg(agg, WARP_SHFL_DOWN(agg, offset));
@@ -118,6 +104,55 @@ __global__ static void pdist_kernel_cuda_impl(scalar_t * result, const scalar_t
       F::agg(agg, WARP_SHFL_DOWN(agg, offset));
     }
   }
+  return agg;
+}
+
+template <typename scalar_t, typename F>
+__global__ static void pdist_kernel_cuda_impl(scalar_t * result, const scalar_t * self, const int64_t n, const int64_t m, const scalar_t p) {
+  const int k = blockIdx.x;
+  const int stride = blockDim.x;
+
+  float n2 = n - .5;
+  // The -1 accounts for floating point truncation issues
+  int64_t i = static_cast<int64_t>((n2 - device_sqrt<scalar_t>(n2 * n2 - 2 * k - 1)));
+  int64_t j = k - n * i + i * (i + 1) / 2 + i + 1;
+
+  const scalar_t * const start = self + i * m;
+  const scalar_t * const end = start + m;
+  const scalar_t * a = start + threadIdx.x;
+  const scalar_t * b = self + j * m + threadIdx.x;
+  scalar_t agg = 0.0;
+  for (; a < end; a += stride, b += stride) {
+    F::inc(agg, std::abs(*a - *b), p);
+  }
+
+  agg = reduce_agg<scalar_t, F>(agg);
+  if (threadIdx.x == 0) {
+    result[k] = F::finish(agg, p);
+  }
+}
+
+// One block per distance, like pdist_kernel_cuda_impl. x1 is (B, R1, M), x2
+// is (B, R2, M) and result is (B, R1, R2).
+template <typename scalar_t, typename F>
+__global__ static void cdist_kernel_cuda_impl(scalar_t * result, const scalar_t * x1, const scalar_t * x2, const int64_t r1, const int64_t r2, const int64_t m, const scalar_t p) {
+  const int64_t k = blockIdx.x;
+  const int stride = blockDim.x;
+
+  const int64_t b = k / (r1 * r2);
+  const int64_t i = k / r2 % r1;
+  const int64_t j = k % r2;
+
+  const scalar_t * const start = x1 + (b * r1 + i) * m;
+  const scalar_t * const end = start + m;
+  const scalar_t * a = start + threadIdx.x;
+  const scalar_t * c = x2 + (b * r2 + j) * m + threadIdx.x;
+  scalar_t agg = 0.0;
+  for (; a < end; a += stride, c += stride) {
+    F::inc(agg, std::abs(*a - *c), p);
+  }
+
+  agg = reduce_agg<scalar_t, F>(agg);
   if (threadIdx.x == 0) {
     result[k] = F::finish(agg, p);
   }
@@ -156,6 +191,29 @@ __global__ static void pdist_backward_kernel_cuda_impl(scalar_t * buffer, const
   }
 }
 
+// Every row of x1 sums the gradients of its distances to the rows of x2, see
+// run_cdist_backward_parallel in cpu/DistanceOpsKernel.cpp. Threads in x go
+// over the columns, threads in y over the rows of x1.
+template <typename scalar_t, typename F>
+__global__ static void cdist_backward_kernel_cuda_impl(scalar_t * result, const scalar_t * grad, const scalar_t * x1, const scalar_t * x2, const scalar_t * dist, const int64_t r1, const int64_t r2, const int64_t m, const int64_t rows, const scalar_t p) {
+  const int64_t l = blockIdx.x * blockDim.x + threadIdx.x;
+  if (l >= m) {
+    return;
+  }
+
+  for (int64_t row = blockIdx.y * blockDim.y + threadIdx.y; row < rows; row += gridDim.y * blockDim.y) {
+    const scalar_t x1_l = x1[row * m + l];
+    const scalar_t * x2_l = x2 + row / r1 * r2 * m + l;
+    const scalar_t * const grad_i = grad + row * r2;
+    const scalar_t * const dist_i = dist + row * r2;
+    scalar_t res = 0;
+    for (int64_t j = 0; j < r2; ++j, x2_l += m) {
+      res += F::backward(x1_l - *x2_l, grad_i[j], dist_i[j], p);
+    }
+    result[row * m + l] = res;
+  }
+}
+
 void pdist_forward_kernel_impl(Tensor& result, const Tensor& self, double p) {
   const dim3 grid(result.numel());
   const dim3 block(forward_threads);
@@ -210,9 +268,64 @@ void pdist_backward_kernel_impl(Tensor& result, const Tensor& grad, const Tensor
   at::sum_out(result, buffer, 0);
 }
 
+void cdist_kernel_impl(Tensor& result, const Tensor& x1, const Tensor& x2, double p) {
+  const dim3 grid(result.numel());
+  const dim3 block(forward_threads);
+  const int64_t r1 = x1.size(1);
+  const int64_t r2 = x2.size(1);
+  const int64_t m = x1.size(2);
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+  AT_DISPATCH_FLOATING_TYPES(x1.type(), "cdist_cuda", [&] {
+    if (p == 0.0) {
+      cdist_kernel_cuda_impl<scalar_t, dists<scalar_t>::zero><<<grid, block, 0, stream>>>(result.data<scalar_t>(), x1.data<scalar_t>(), x2.data<scalar_t>(), r1, r2, m, p);
+    } else if (p == 1.0) {
+      cdist_kernel_cuda_impl<scalar_t, dists<scalar_t>::one><<<grid, block, 0, stream>>>(result.data<scalar_t>(), x1.data<scalar_t>(), x2.data<scalar_t>(), r1, r2, m, p);
+    } else if (p == 2.0) {
+      cdist_kernel_cuda_impl<scalar_t, dists<scalar_t>::two><<<grid, block, 0, stream>>>(result.data<scalar_t>(), x1.data<scalar_t>(), x2.data<scalar_t>(), r1, r2, m, p);
+    } else if (std::isinf(p)) {
+      cdist_kernel_cuda_impl<scalar_t, dists<scalar_t>::inf><<<grid, block, 0, stream>>>(result.data<scalar_t>(), x1.data<scalar_t>(), x2.data<scalar_t>(), r1, r2, m, p);
+    } else {
+      cdist_kernel_cuda_impl<scalar_t, dists<scalar_t>::p><<<grid, block, 0, stream>>>(result.data<scalar_t>(), x1.data<scalar_t>(), x2.data<scalar_t>(), r1, r2, m, p);
+    }
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+void cdist_backward_kernel_impl(Tensor& result, const Tensor& grad, const Tensor& x1, const Tensor& x2, const double p, const Tensor& dist) {
+  const int64_t r1 = x1.size(1);
+  const int64_t r2 = x2.size(1);
+  const int64_t m = x1.size(2);
+  const int64_t rows = x1.size(0) * r1;
+  const int block_x = 64;
+  const int block_y = 4;
+  const int grid_x = (m + block_x - 1) / block_x;
+  const int grid_y = std::min<int64_t>((rows + block_y - 1) / block_y, 65535);
+  const dim3 grid(grid_x, grid_y);
+  const dim3 block(block_x, block_y);
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+  AT_DISPATCH_FLOATING_TYPES(x1.type(), "cdist_cuda_backward", [&] {
+    if (p == 1.0) {
+      cdist_backward_kernel_cuda_impl<scalar_t, dists<scalar_t>::one><<<grid, block, 0, stream>>>(result.data<scalar_t>(), grad.data<scalar_t>(), x1.data<scalar_t>(), x2.data<scalar_t>(), dist.data<scalar_t>(), r1, r2, m, rows, p);
+    } else if (p < 2.0) {
+      cdist_backward_kernel_cuda_impl<scalar_t, dists<scalar_t>::lt_two><<<grid, block, 0, stream>>>(result.data<scalar_t>(), grad.data<scalar_t>(), x1.data<scalar_t>(), x2.data<scalar_t>(), dist.data<scalar_t>(), r1, r2, m, rows, p);
+    } else if (p == 2.0) {
+      cdist_backward_kernel_cuda_impl<scalar_t, dists<scalar_t>::two><<<grid, block, 0, stream>>>(result.data<scalar_t>(), grad.data<scalar_t>(), x1.data<scalar_t>(), x2.data<scalar_t>(), dist.data<scalar_t>(), r1, r2, m, rows, p);
+    } else if (std::isinf(p)) {
+      cdist_backward_kernel_cuda_impl<scalar_t, dists<scalar_t>::inf><<<grid, block, 0, stream>>>(result.data<scalar_t>(), grad.data<scalar_t>(), x1.data<scalar_t>(), x2.data<scalar_t>(), dist.data<scalar_t>(), r1, r2, m, rows, p);
+    } else {
+      cdist_backward_kernel_cuda_impl<scalar_t, dists<scalar_t>::p><<<grid, block, 0, stream>>>(result.data<scalar_t>(), grad.data<scalar_t>(), x1.data<scalar_t>(), x2.data<scalar_t>(), dist.data<scalar_t>(), r1, r2, m, rows, p);
+    }
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(pdist_forward_stub, &pdist_forward_kernel_impl);
 REGISTER_DISPATCH(pdist_backward_stub, &pdist_backward_kernel_impl);
+REGISTER_DISPATCH(cdist_stub, &cdist_kernel_impl);
+REGISTER_DISPATCH(cdist_backward_stub, &cdist_backward_kernel_impl);
 
 }} // at::native
@@ -86,6 +86,67 @@ fused_dropout_kernel(cuda::detail::TensorInfo<scalar_t, IndexType> a,
   }
 }
 
+// Packed masks hold the keep bit of element i in bit i % 32 of word i / 32,
+// see Dropout.cpp. Each thread builds whole words from the uniforms of its
+// Philox subsequence, so no two threads write to the same word, whatever the
+// warp size.
+const int MASK_WORD_BITS = 32;
+
+template <
+          typename scalar_t,
+          typename accscalar_t,
+          typename IndexType,
+          int ADims>
+#if __CUDA_ARCH__ >= 350
+__launch_bounds__(256,8)
+#endif
+__global__ void
+fused_dropout_packed_kernel(cuda::detail::TensorInfo<scalar_t, IndexType> a,
+                            cuda::detail::TensorInfo<scalar_t, IndexType> b,
+                            int32_t* mask,
+                            IndexType totalElements, accscalar_t p,
+                            std::pair<uint64_t, uint64_t> seeds) {
+  accscalar_t pinv = accscalar_t(1)/p;
+  IndexType words = (totalElements + MASK_WORD_BITS - 1) / MASK_WORD_BITS;
+  for (IndexType word = blockIdx.x * blockDim.x + threadIdx.x;
+       word < words;
+       word += gridDim.x * blockDim.x) {
+    curandStatePhilox4_32_10_t state;
+    curand_init(seeds.first, word, seeds.second, &state);
+    uint32_t bits = 0;
+    for (int j = 0; j < MASK_WORD_BITS; j += UNROLL) {
+      float4 rand = curand_uniform4(&state);
+      for (int ii = 0; ii < UNROLL; ii++) {
+        IndexType li = word * MASK_WORD_BITS + j + ii;
+        if (li < totalElements) {
+          bool keep = (&rand.x)[ii] < p;
+          bits |= static_cast<uint32_t>(keep) << (j + ii);
+          const IndexType aOffset =
+              cuda::detail::IndexToOffset<scalar_t, IndexType, ADims>::get(li, a);
+          const IndexType bOffset =
+              cuda::detail::IndexToOffset<scalar_t, IndexType, 1>::get(li, b);
+          b.data[bOffset] = a.data[aOffset] * (accscalar_t)keep * pinv;
+        }
+      }
+    }
+    mask[word] = static_cast<int32_t>(bits);
+  }
+}
+
+template <typename scalar_t, typename accscalar_t, typename IndexType>
+__global__ void
+masked_scale_packed_kernel(const scalar_t* src, scalar_t* ret,
+                           const int32_t* mask, IndexType totalElements,
+                           accscalar_t scale) {
+  for (IndexType li = blockIdx.x * blockDim.x + threadIdx.x;
+       li < totalElements;
+       li += gridDim.x * blockDim.x) {
+    uint32_t bits = static_cast<uint32_t>(mask[li / MASK_WORD_BITS]);
+    accscalar_t keep = (bits >> (li % MASK_WORD_BITS)) & 1;
+    ret[li] = src[li] * keep * scale;
+  }
+}
+
 template<typename scalar_t, typename accscalar_t>
 void masked_scale_kernel(at::Tensor& ret, const at::Tensor src, const at::Tensor mask, accscalar_t scale){
    at::cuda::CUDA_tensor_apply3<scalar_t, scalar_t, uint8_t>(ret, src, mask, [scale]__device__(scalar_t& ret_val, const scalar_t& src_val, const uint8_t mask_val){
@@ -158,5 +219,76 @@ Tensor masked_scale_cuda(const Tensor& self, const Tensor& mask, double scale){
   return ret;
 }
 
+std::tuple<Tensor,Tensor>
+fused_dropout_packed_cuda(const Tensor& self, double p, Generator * gen){
+  Tensor ret = at::empty_like(self);
+  const int64_t nelem = self.numel();
+  const int64_t nwords = (nelem + MASK_WORD_BITS - 1) / MASK_WORD_BITS;
+  Tensor mask = at::empty({nwords}, self.options().dtype(kInt));
+  if (nelem == 0) {
+    return std::tuple<Tensor,Tensor>(ret, mask);
+  }
+  const int64_t block_size = 256;
+  unsigned int blocks_per_sm = at::cuda::getCurrentDeviceProperties()->maxThreadsPerMultiProcessor/block_size;
+  dim3 dim_block(block_size);
+  dim3 grid((nwords + block_size -1)/block_size);
+  grid.x = std::min((unsigned int)at::cuda::getCurrentDeviceProperties()->multiProcessorCount * blocks_per_sm, grid.x);
+  // Each word is generated from its own subsequence, with 32 randoms
+  const int64_t counter_offset = MASK_WORD_BITS;
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(self.type(), "fused_dropout_packed", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    accscalar_t pa = (accscalar_t)(p);
+    int32_t* mask_data = mask.data<int32_t>();
+    if (cuda::detail::canUse32BitIndexMath(self)){
+      auto self_info = cuda::detail::getTensorInfo<scalar_t, unsigned int>(self);
+      auto ret_info = cuda::detail::getTensorInfo<scalar_t, unsigned int>(ret);
+      self_info.collapseDims();
+      ret_info.collapseDims(); //ret is collapsed to 1d contiguous tensor
+      if (self_info.dims == 1) {
+        fused_dropout_packed_kernel<scalar_t, accscalar_t, unsigned int, 1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(self_info, ret_info, mask_data, nelem, pa, next_philox_seed(gen, counter_offset));
+      } else {
+        fused_dropout_packed_kernel<scalar_t, accscalar_t, unsigned int, -1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(self_info, ret_info, mask_data, nelem, pa, next_philox_seed(gen, counter_offset));
+      }
+    } else {
+      auto self_info = cuda::detail::getTensorInfo<scalar_t, uint64_t>(self);
+      auto ret_info = cuda::detail::getTensorInfo<scalar_t, uint64_t>(ret);
+      self_info.collapseDims();
+      ret_info.collapseDims();
+      if (self_info.dims == 1) {
+        fused_dropout_packed_kernel<scalar_t, accscalar_t, uint64_t, 1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(self_info, ret_info, mask_data, nelem, pa, next_philox_seed(gen, counter_offset));
+      } else {
+        fused_dropout_packed_kernel<scalar_t, accscalar_t, uint64_t, -1><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(self_info, ret_info, mask_data, nelem, pa, next_philox_seed(gen, counter_offset));
+      }
+    }
+  });
+  THCudaCheck(cudaGetLastError());
+  return std::tuple<Tensor,Tensor>(ret, mask);
+}
+
+Tensor masked_scale_packed_cuda(const Tensor& self, const Tensor& mask, double scale){
+  AT_CHECK(mask.type().scalarType() == at::ScalarType::Int, "packed mask should be torch.int32 dtype");
+  auto src = self.contiguous();
+  const int64_t nelem = src.numel();
+  AT_CHECK(mask.numel() == (nelem + MASK_WORD_BITS - 1) / MASK_WORD_BITS,
+           "packed mask of ", mask.numel(), " words doesn't match a tensor of ",
+           nelem, " elements");
+  auto mask_ = mask.contiguous();
+  Tensor ret = at::empty_like(src);
+  if (nelem == 0) {
+    return ret;
+  }
+  const int64_t block_size = 256;
+  dim3 dim_block(block_size);
+  dim3 grid(std::min((nelem + block_size - 1) / block_size, (int64_t)65535));
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(ret.type(), "masked_scale_packed", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    accscalar_t pa = (accscalar_t)(scale);
+    masked_scale_packed_kernel<scalar_t, accscalar_t, int64_t><<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(
+        src.data<scalar_t>(), ret.data<scalar_t>(), mask_.data<int32_t>(), nelem, pa);
+  });
+  THCudaCheck(cudaGetLastError());
+  return ret;
+}
+
 }
 }
@@ -4,6 +4,7 @@
 #include "ATen/cuda/CUDAContext.h"
 #include "c10/util/Exception.h"
 
+#include <THC/THCAtomics.cuh>
 #include <THC/THCDeviceUtils.cuh>
 #include <THC/THCTensorMathReduce.cuh>
 #include <THC/THCTensorSort.cuh>
@@ -163,6 +164,39 @@ __global__ void embedding_backward_kernel(
   }
 }
 
+// Counts the occurrences of each index, for scale_grad_by_freq.
+__global__ void embedding_count_kernel(
+  int64_t* indices, int64_t* count, int64_t numel) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += blockDim.x * gridDim.x) {
+    atomicAdd(&count[indices[i]], (int64_t)1);
+  }
+}
+
+// Adds each row of grad_output into its row of grad_weight with atomicAdd, so
+// that the indices do not have to be sorted first. Each warp (threadIdx.y)
+// handles one input. The order of the additions to a row is undetermined.
+template <typename scalar_t>
+__global__ void embedding_backward_atomic_kernel(
+  int64_t* indices, scalar_t* grad_output, scalar_t* grad_weight,
+  int64_t* count, int64_t numel, int64_t stride, int64_t padding_idx) {
+
+  using accscalar_t = acc_type<scalar_t, true>;
+  const int64_t idx = (int64_t)blockIdx.x * blockDim.y + threadIdx.y;
+  if (idx >= numel) {
+    return;
+  }
+  const int64_t weight_row = indices[idx];
+  if (weight_row == padding_idx) {
+    return;
+  }
+  const accscalar_t scale = count ? (accscalar_t)1.0 / count[weight_row] : 1.0;
+  for (int64_t f = threadIdx.x; f < stride; f += blockDim.x) {
+    const accscalar_t gradient = static_cast<accscalar_t>(grad_output[idx * stride + f]);
+    atomicAdd(&grad_weight[weight_row * stride + f], static_cast<scalar_t>(gradient * scale));
+  }
+}
+
 /* Calculate norms of the rows of weight_ptr given by idx_ptr and capture them in norms */
 template <typename scalar_t, typename accscalar_t>
 __global__ void renorm_kernel(
@@ -252,6 +286,40 @@ Tensor embedding_dense_backward_cuda(const Tensor & grad_, const Tensor & indice
     return grad_weight;
   }
 
+  // Unless deterministic results are requested, accumulate with atomics:
+  // sorting the indices dominates the backward for large vocabularies.
+  if (!globalContext().deterministicCuDNN()) {
+    if (num_indices == 0) {
+      return grad_weight;
+    }
+    auto indices_contig = indices.contiguous();
+
+    Tensor count;
+    if (scale_grad_by_freq) {
+      count = at::zeros({num_weights}, indices.options());
+      dim3 count_grid(std::min(THCCeilDiv(num_indices, (int64_t)512), (int64_t)4096));
+      embedding_count_kernel<<<count_grid, 512, 0, stream>>>(
+        indices_contig.data<int64_t>(), count.data<int64_t>(), num_indices);
+      THCudaCheck(cudaGetLastError());
+    }
+
+    dim3 grid(THCCeilDiv(num_indices, (int64_t)BLOCKDIMY / 4));
+    dim3 block(WARP_SIZE, BLOCKDIMY / 4);
+
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(grad.type(), "embedding_backward", [&] {
+      embedding_backward_atomic_kernel<<<grid, block, 0, stream>>>(
+        indices_contig.data<int64_t>(),
+        grad.data<scalar_t>(),
+        grad_weight.data<scalar_t>(),
+        count.defined() ? count.data<int64_t>() : nullptr,
+        num_indices,
+        stride,
+        padding_idx);
+    });
+    THCudaCheck(cudaGetLastError());
+    return grad_weight;
+  }
+
   auto sorted_indices = at::empty_like(indices);
   auto orig_indices = at::empty_like(indices);
   using device_ptr = thrust::device_ptr<int64_t>;
@@ -270,10 +338,11 @@ Tensor embedding_dense_backward_cuda(const Tensor & grad_, const Tensor & indice
     auto orig_data = device_ptr(orig_indices.data<int64_t>());
     thrust::copy(policy, count_iter, count_iter + num_indices, orig_data);
 
-    // Sort; a stable sort is not required
+    // Sort; a stable sort is not required. With thrust::less on integer keys
+    // Thrust uses a radix sort instead of a merge sort.
     auto sorted_data = device_ptr(sorted_indices.data<int64_t>());
     thrust::sort_by_key(policy, sorted_data, sorted_data + num_indices, orig_data,
-                        ThrustLTOp<int64_t>());
+                        thrust::less<int64_t>());
   }
 
   Tensor count;
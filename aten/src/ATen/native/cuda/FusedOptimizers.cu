@@ -0,0 +1,161 @@
+#include "ATen/ATen.h"
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/native/cuda/MultiTensorApply.cuh"
+
+// Fused optimizer steps: each of these updates all the parameters in a few
+// launches (see multi_tensor_apply) and computes the whole update of an
+// element in registers, instead of launching several elementwise kernels
+// per parameter. The math follows torch/optim; gradients are changed in place
+// by weight decay where the unfused Python optimizers do so.
+
+namespace at { namespace native {
+
+namespace {
+
+// lists: param, grad, exp_avg, exp_avg_sq
+template <typename accscalar_t>
+struct AdamOp {
+  accscalar_t beta1;
+  accscalar_t beta2;
+  accscalar_t step_size;
+  accscalar_t eps;
+  accscalar_t weight_decay;
+
+  __device__ __forceinline__ void operator()(accscalar_t (&r)[4]) const {
+    if (weight_decay != 0) {
+      r[1] = r[1] + weight_decay * r[0];
+    }
+    r[2] = beta1 * r[2] + (1 - beta1) * r[1];
+    r[3] = beta2 * r[3] + (1 - beta2) * r[1] * r[1];
+    r[0] = r[0] - step_size * r[2] / (::sqrt(r[3]) + eps);
+  }
+};
+
+// lists: param, grad, momentum_buffer
+template <typename accscalar_t>
+struct SGDMomentumOp {
+  accscalar_t lr;
+  accscalar_t momentum;
+  accscalar_t dampening;
+  accscalar_t weight_decay;
+  bool nesterov;
+  bool first_run;
+
+  __device__ __forceinline__ void operator()(accscalar_t (&r)[3]) const {
+    if (weight_decay != 0) {
+      r[1] = r[1] + weight_decay * r[0];
+    }
+    if (first_run) {
+      r[2] = r[1];
+    } else {
+      r[2] = momentum * r[2] + (1 - dampening) * r[1];
+    }
+    const accscalar_t update = nesterov ? r[1] + momentum * r[2] : r[2];
+    r[0] = r[0] - lr * update;
+  }
+};
+
+// lists: param, grad
+template <typename accscalar_t>
+struct SGDOp {
+  accscalar_t lr;
+  accscalar_t weight_decay;
+
+  __device__ __forceinline__ void operator()(accscalar_t (&r)[2]) const {
+    if (weight_decay != 0) {
+      r[1] = r[1] + weight_decay * r[0];
+    }
+    r[0] = r[0] - lr * r[1];
+  }
+};
+
+// lists: param, grad, sum; the decayed gradient is not written back
+template <typename accscalar_t>
+struct AdagradOp {
+  accscalar_t clr;
+  accscalar_t weight_decay;
+  accscalar_t eps;
+
+  __device__ __forceinline__ void operator()(accscalar_t (&r)[3]) const {
+    const accscalar_t grad = weight_decay != 0 ? r[1] + weight_decay * r[0] : r[1];
+    r[2] = r[2] + grad * grad;
+    r[0] = r[0] - clr * grad / (::sqrt(r[2]) + eps);
+  }
+};
+
+} // anonymous namespace
+
+void _fused_adam_cuda_(
+    TensorList params, TensorList grads, TensorList exp_avgs, TensorList exp_avg_sqs,
+    double beta1, double beta2, double step_size, double eps, double weight_decay) {
+  std::vector<TensorList> lists{params, grads, exp_avgs, exp_avg_sqs};
+  multi_tensor_check("_fused_adam_", lists);
+  const int write_mask = weight_decay != 0 ? 0xf : 0xd;
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(params[0].type(), "_fused_adam_", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    AdamOp<accscalar_t> op{
+        static_cast<accscalar_t>(beta1),
+        static_cast<accscalar_t>(beta2),
+        static_cast<accscalar_t>(step_size),
+        static_cast<accscalar_t>(eps),
+        static_cast<accscalar_t>(weight_decay)};
+    multi_tensor_apply<4>(
+        lists, PointwiseChunkFunctor<4, scalar_t, accscalar_t>(), write_mask, op);
+  });
+}
+
+void _fused_sgd_cuda_(
+    TensorList params, TensorList grads, TensorList momentum_buffers,
+    double lr, double momentum, double dampening, double weight_decay,
+    bool nesterov, bool first_run) {
+  if (momentum == 0) {
+    AT_CHECK(momentum_buffers.size() == 0,
+             "_fused_sgd_: momentum_buffers must be empty when momentum is 0");
+    std::vector<TensorList> lists{params, grads};
+    multi_tensor_check("_fused_sgd_", lists);
+    const int write_mask = weight_decay != 0 ? 0x3 : 0x1;
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(params[0].type(), "_fused_sgd_", [&] {
+      using accscalar_t = acc_type<scalar_t, true>;
+      SGDOp<accscalar_t> op{
+        static_cast<accscalar_t>(lr),
+        static_cast<accscalar_t>(weight_decay)};
+      multi_tensor_apply<2>(
+          lists, PointwiseChunkFunctor<2, scalar_t, accscalar_t>(), write_mask, op);
+    });
+    return;
+  }
+  std::vector<TensorList> lists{params, grads, momentum_buffers};
+  multi_tensor_check("_fused_sgd_", lists);
+  const int write_mask = weight_decay != 0 ? 0x7 : 0x5;
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(params[0].type(), "_fused_sgd_", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    SGDMomentumOp<accscalar_t> op{
+        static_cast<accscalar_t>(lr),
+        static_cast<accscalar_t>(momentum),
+        static_cast<accscalar_t>(dampening),
+        static_cast<accscalar_t>(weight_decay),
+        nesterov,
+        first_run};
+    multi_tensor_apply<3>(
+        lists, PointwiseChunkFunctor<3, scalar_t, accscalar_t>(), write_mask, op);
+  });
+}
+
+void _fused_adagrad_cuda_(
+    TensorList params, TensorList grads, TensorList sums,
+    double clr, double weight_decay, double eps) {
+  std::vector<TensorList> lists{params, grads, sums};
+  multi_tensor_check("_fused_adagrad_", lists);
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(params[0].type(), "_fused_adagrad_", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    AdagradOp<accscalar_t> op{
+        static_cast<accscalar_t>(clr),
+        static_cast<accscalar_t>(weight_decay),
+        static_cast<accscalar_t>(eps)};
+    multi_tensor_apply<3>(
+        lists, PointwiseChunkFunctor<3, scalar_t, accscalar_t>(), 0x5, op);
+  });
+}
+
+}} // namespace at::native
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "ATen/ATen.h"
+#include "ATen/cuda/CUDAContext.h"
+#include "ATen/cuda/Exceptions.h"
+#include "c10/util/Exception.h"
+
+#include <vector>
+
+// multi_tensor_apply runs a functor over the elements of several lists of
+// tensors with one kernel launch per batch of tensors, instead of one launch
+// per tensor. This matters for optimizer steps, where models with thousands
+// of small parameters are otherwise dominated by launch overhead.
+//
+// The tensors are split into chunks of chunk_size elements and every block
+// processes one chunk. The addresses and sizes of the tensors in a launch are
+// passed by value in a TensorListMetadata (kernel arguments are limited to
+// 4KB, which bounds the number of tensors and blocks per launch); a tensor
+// that does not fit into a launch is continued in the next one.
+//
+// The i-th tensors of all lists must have the same number of elements, and all
+// tensors must be contiguous, of the same type and on the same device.
+
+namespace at { namespace native {
+
+namespace multi_tensor {
+
+constexpr int kBlockSize = 512;
+constexpr int kChunkSize = 65536;
+// Elements each thread keeps in registers per iteration.
+constexpr int kILP = 4;
+
+constexpr int kMaxBlocks = 320;
+constexpr int kMaxTensors[] = {110, 64, 48, 36};
+
+} // namespace multi_tensor
+
+template <int depth>
+struct TensorListMetadata {
+  void* addresses[depth][multi_tensor::kMaxTensors[depth - 1]];
+  int64_t sizes[multi_tensor::kMaxTensors[depth - 1]];
+  unsigned char block_to_tensor[multi_tensor::kMaxBlocks];
+  int block_to_chunk[multi_tensor::kMaxBlocks];
+};
+
+template <typename T, typename U, typename... ArgTypes>
+__global__ void
+__launch_bounds__(multi_tensor::kBlockSize)
+multi_tensor_apply_kernel(int chunk_size, T tl, U callable, ArgTypes... args) {
+  callable(chunk_size, tl, args...);
+}
+
+// Functor for elementwise updates: loads element i of every list of the
+// block's chunk into registers (as accscalar_t), calls op on them and writes
+// back the lists whose bit is set in write_mask. Op is a copyable struct
+// holding the hyperparameters, with a
+//   __device__ void operator()(accscalar_t (&r)[depth]) const
+template <int depth, typename scalar_t, typename accscalar_t>
+struct PointwiseChunkFunctor {
+  template <typename Op>
+  __device__ __forceinline__ void operator()(
+      int chunk_size,
+      TensorListMetadata<depth>& tl,
+      int write_mask,
+      Op op) {
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int64_t offset = static_cast<int64_t>(tl.block_to_chunk[blockIdx.x]) * chunk_size;
+    int64_t n = tl.sizes[tensor_loc] - offset;
+    if (n > chunk_size) {
+      n = chunk_size;
+    }
+
+    scalar_t* ptrs[depth];
+#pragma unroll
+    for (int d = 0; d < depth; d++) {
+      ptrs[d] = static_cast<scalar_t*>(tl.addresses[d][tensor_loc]) + offset;
+    }
+
+    for (int64_t i_start = 0; i_start < n; i_start += blockDim.x * multi_tensor::kILP) {
+      accscalar_t r[multi_tensor::kILP][depth];
+#pragma unroll
+      for (int ii = 0; ii < multi_tensor::kILP; ii++) {
+        const int64_t i = i_start + threadIdx.x + ii * blockDim.x;
+#pragma unroll
+        for (int d = 0; d < depth; d++) {
+          r[ii][d] = i < n ? static_cast<accscalar_t>(ptrs[d][i]) : accscalar_t(0);
+        }
+      }
+#pragma unroll
+      for (int ii = 0; ii < multi_tensor::kILP; ii++) {
+        op(r[ii]);
+      }
+#pragma unroll
+      for (int ii = 0; ii < multi_tensor::kILP; ii++) {
+        const int64_t i = i_start + threadIdx.x + ii * blockDim.x;
+        if (i < n) {
+#pragma unroll
+          for (int d = 0; d < depth; d++) {
+            if (write_mask & (1 << d)) {
+              ptrs[d][i] = static_cast<scalar_t>(r[ii][d]);
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+static inline void multi_tensor_check(const char* name, const std::vector<TensorList>& tensor_lists) {
+  AT_CHECK(tensor_lists.size() > 0 && tensor_lists[0].size() > 0,
+           name, ": expected a non-empty list of tensors");
+  const auto& first = tensor_lists[0][0];
+  AT_CHECK(first.is_cuda(), name, ": expected CUDA tensors");
+  for (size_t l = 0; l < tensor_lists.size(); l++) {
+    AT_CHECK(tensor_lists[l].size() == tensor_lists[0].size(),
+             name, ": expected all tensor lists to have the same length, but list ", l,
+             " has ", tensor_lists[l].size(), " tensors and list 0 has ", tensor_lists[0].size());
+    for (size_t t = 0; t < tensor_lists[l].size(); t++) {
+      const auto& tensor = tensor_lists[l][t];
+      AT_CHECK(tensor.type() == first.type() && tensor.get_device() == first.get_device(),
+               name, ": expected all tensors to be ", first.type().toString(), " on device ",
+               first.get_device(), ", but tensor ", t, " of list ", l, " is ",
+               tensor.type().toString(), " on device ", tensor.get_device());
+      AT_CHECK(tensor.is_contiguous(),
+               name, ": expected contiguous tensors, but tensor ", t, " of list ", l, " is not");
+      AT_CHECK(tensor.numel() == tensor_lists[0][t].numel(),
+               name, ": tensor ", t, " of list ", l, " has ", tensor.numel(),
+               " elements, but tensor ", t, " of list 0 has ", tensor_lists[0][t].numel());
+    }
+  }
+}
+
+// Launches callable(chunk_size, TensorListMetadata<depth>&, args...) on the
+// current stream, with one block per chunk.
+template <int depth, typename T, typename... ArgTypes>
+void multi_tensor_apply(
+    const std::vector<TensorList>& tensor_lists,
+    T callable,
+    ArgTypes... args) {
+  AT_ASSERT(tensor_lists.size() == depth);
+  constexpr int max_tensors = multi_tensor::kMaxTensors[depth - 1];
+  const int chunk_size = multi_tensor::kChunkSize;
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+  TensorListMetadata<depth> tl;
+  int loc_block_info = 0;
+  int loc_tensor_info = 0;
+  const size_t ntensors = tensor_lists[0].size();
+  for (size_t t = 0; t < ntensors; t++) {
+    const int64_t numel = tensor_lists[0][t].numel();
+    if (numel == 0) {
+      continue;
+    }
+    tl.sizes[loc_tensor_info] = numel;
+    for (int d = 0; d < depth; d++) {
+      tl.addresses[d][loc_tensor_info] = tensor_lists[d][t].data_ptr();
+    }
+    loc_tensor_info++;
+
+    const int64_t chunks = (numel + chunk_size - 1) / chunk_size;
+    for (int64_t chunk = 0; chunk < chunks; chunk++) {
+      tl.block_to_tensor[loc_block_info] = loc_tensor_info - 1;
+      tl.block_to_chunk[loc_block_info] = chunk;
+      loc_block_info++;
+
+      const bool last_chunk = chunk == chunks - 1;
+      const bool tensors_full = loc_tensor_info == max_tensors && last_chunk;
+      const bool blocks_full = loc_block_info == multi_tensor::kMaxBlocks;
+      const bool last = t == ntensors - 1 && last_chunk;
+      if (tensors_full || blocks_full || last) {
+        multi_tensor_apply_kernel<<<loc_block_info, multi_tensor::kBlockSize, 0, stream>>>(
+            chunk_size, tl, callable, args...);
+        AT_CUDA_CHECK(cudaGetLastError());
+
+        loc_block_info = 0;
+        if (last_chunk) {
+          loc_tensor_info = 0;
+        } else {
+          // the rest of this tensor goes into the next launch
+          tl.sizes[0] = tl.sizes[loc_tensor_info - 1];
+          for (int d = 0; d < depth; d++) {
+            tl.addresses[d][0] = tl.addresses[d][loc_tensor_info - 1];
+          }
+          loc_tensor_info = 1;
+        }
+      }
+    }
+  }
+  // zero-sized tensors at the end of the lists can leave a partial batch
+  if (loc_block_info != 0) {
+    multi_tensor_apply_kernel<<<loc_block_info, multi_tensor::kBlockSize, 0, stream>>>(
+        chunk_size, tl, callable, args...);
+    AT_CUDA_CHECK(cudaGetLastError());
+  }
+}
+
+}} // namespace at::native
@@ -0,0 +1,95 @@
+#include "ATen/ATen.h"
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/native/cuda/MultiTensorApply.cuh"
+
+// Pointwise updates of lists of small tensors, such as all the gradients of a
+// model, with one launch per batch of tensors (see multi_tensor_apply). For
+// tensors of a few thousand elements the launches, not the memory traffic,
+// are what these ops cost one tensor at a time.
+
+namespace at { namespace native {
+
+namespace {
+
+template <typename accscalar_t>
+struct ScaleOp {
+  accscalar_t scale;
+
+  __device__ __forceinline__ void operator()(accscalar_t (&r)[1]) const {
+    r[0] = r[0] * scale;
+  }
+};
+
+// Flags non-finite elements before scaling them. Threads that find one race
+// to write the same value, so no atomics are needed.
+template <typename accscalar_t>
+struct UnscaleOp {
+  accscalar_t scale;
+  float* found_non_finite;
+
+  __device__ __forceinline__ void operator()(accscalar_t (&r)[1]) const {
+    if (!::isfinite(r[0])) {
+      *found_non_finite = 1.f;
+    }
+    r[0] = r[0] * scale;
+  }
+};
+
+// Writes value to the block's chunk without loading it first.
+template <typename scalar_t>
+struct FillChunkFunctor {
+  __device__ __forceinline__ void operator()(
+      int chunk_size,
+      TensorListMetadata<1>& tl,
+      scalar_t value) {
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int64_t offset = static_cast<int64_t>(tl.block_to_chunk[blockIdx.x]) * chunk_size;
+    int64_t n = tl.sizes[tensor_loc] - offset;
+    if (n > chunk_size) {
+      n = chunk_size;
+    }
+    scalar_t* ptr = static_cast<scalar_t*>(tl.addresses[0][tensor_loc]) + offset;
+    for (int64_t i = threadIdx.x; i < n; i += blockDim.x) {
+      ptr[i] = value;
+    }
+  }
+};
+
+} // anonymous namespace
+
+void _multi_tensor_scale_cuda_(TensorList self, double scale) {
+  std::vector<TensorList> lists{self};
+  multi_tensor_check("_multi_tensor_scale_", lists);
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(self[0].type(), "_multi_tensor_scale_", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    ScaleOp<accscalar_t> op{static_cast<accscalar_t>(scale)};
+    multi_tensor_apply<1>(
+        lists, PointwiseChunkFunctor<1, scalar_t, accscalar_t>(), 0x1, op);
+  });
+}
+
+void _multi_tensor_zero_cuda_(TensorList self) {
+  std::vector<TensorList> lists{self};
+  multi_tensor_check("_multi_tensor_zero_", lists);
+  AT_DISPATCH_ALL_TYPES_AND_HALF(self[0].type(), "_multi_tensor_zero_", [&] {
+    multi_tensor_apply<1>(lists, FillChunkFunctor<scalar_t>(), scalar_t(0));
+  });
+}
+
+void _multi_tensor_unscale_cuda_(TensorList self, Tensor found_non_finite, double scale) {
+  std::vector<TensorList> lists{self};
+  multi_tensor_check("_multi_tensor_unscale_", lists);
+  AT_CHECK(found_non_finite.is_cuda() && found_non_finite.get_device() == self[0].get_device() &&
+           found_non_finite.type().scalarType() == kFloat && found_non_finite.numel() == 1,
+           "_multi_tensor_unscale_: expected found_non_finite to be a one-element float tensor "
+           "on device ", self[0].get_device());
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(self[0].type(), "_multi_tensor_unscale_", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    UnscaleOp<accscalar_t> op{static_cast<accscalar_t>(scale), found_non_finite.data<float>()};
+    multi_tensor_apply<1>(
+        lists, PointwiseChunkFunctor<1, scalar_t, accscalar_t>(), 0x1, op);
+  });
+}
+
+}} // namespace at::native
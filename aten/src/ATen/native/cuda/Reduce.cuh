@@ -0,0 +1,569 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/detail/OffsetCalculator.cuh>
+#include <ATen/native/TensorIterator.h>
+#include <THC/THCDeviceUtils.cuh>
+#include <thrust/pair.h>
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+
+// Reduction kernel driven by a TensorIterator built with reduce_op().
+//
+// The reduced dimensions of the iterator come first, so each thread indexes
+// the input with an offset of its output element (output_calc) plus an
+// offset within that element's reduction (input_calc). A reduction is
+// described by an `ops` object with the device functions
+//
+//   arg_t reduce(arg_t acc, scalar_t value)   // fold in an input element
+//   arg_t combine(arg_t a, arg_t b)           // merge two partial results
+//   out_t project(arg_t acc)                  // compute the output value
+//   arg_t warp_shfl_down(arg_t acc, int offset)
+//
+// where `project` returns a thrust::pair to fill two outputs at once.
+//
+// ReduceConfig decides how the input is split: across the lanes of a warp
+// when the reduced dimension is contiguous (otherwise each lane gets its own
+// output, so loads are still coalesced), across the warps of a block, and,
+// for long rows with few outputs, across several blocks. In the last case the
+// partial results are staged in global memory and the last block to finish
+// for an output combines them; see ReduceOp::global_reduce.
+
+namespace at { namespace native {
+
+namespace reduce {
+
+static inline int64_t div_up(int64_t a, int64_t b) {
+  return (a + b - 1) / b;
+}
+
+static inline int last_pow2(int n) {
+  n |= (n >>  1);
+  n |= (n >>  2);
+  n |= (n >>  4);
+  n |= (n >>  8);
+  n |= (n >> 16);
+  return std::max(1, n - (n >> 1));
+}
+
+template <typename scalar_t, int vec_size>
+struct alignas(sizeof(scalar_t) * vec_size) aligned_vector {
+  scalar_t val[vec_size];
+};
+
+// Number of elements loaded at once by the vectorized input path: up to
+// 16 bytes, and at most 4 elements to bound the number of accumulators.
+template <typename scalar_t>
+struct input_vec_size {
+  static constexpr int value =
+      sizeof(scalar_t) >= 16 ? 1 : std::min<int>(4, 16 / sizeof(scalar_t));
+};
+
+struct ReduceConfig {
+  static constexpr int BLOCK_X = 0;
+  static constexpr int BLOCK_Y = 1;
+  static constexpr int CTA = 2;
+
+  static constexpr int MAX_NUM_THREADS = 512;
+
+  ReduceConfig(int element_size_bytes, int num_outputs, int num_inputs)
+    : element_size_bytes(element_size_bytes)
+    , num_inputs(num_inputs)
+    , num_outputs(num_outputs) {}
+  int element_size_bytes;
+  int num_inputs;
+  int num_outputs;
+  int step_input = 1;
+  int step_output = 1;
+  int ctas_per_output = 1;
+  int input_mult[3] = {0, 0, 0};
+  int output_mult[2] = {0, 0};
+  int block_width = 1;
+  int block_height = 1;
+  int num_threads = 1;
+  bool vectorize_input = false;
+
+  void set_block_dimension(int64_t dim0, int64_t dim1) {
+    int dim0_pow2 = dim0 < MAX_NUM_THREADS ? last_pow2(static_cast<int>(dim0)) : MAX_NUM_THREADS;
+    int dim1_pow2 = dim1 < MAX_NUM_THREADS ? last_pow2(static_cast<int>(dim1)) : MAX_NUM_THREADS;
+    int warp_size = at::cuda::getCurrentDeviceProperties()->warpSize;
+    block_width = std::min(dim0_pow2, warp_size);
+    block_height = std::min(dim1_pow2, MAX_NUM_THREADS / block_width);
+    block_width = std::min(dim0_pow2, MAX_NUM_THREADS / block_height);
+    num_threads = block_width * block_height;
+  }
+
+  int split_input(int parallelism) {
+    int step = step_input;
+    step_input *= parallelism;
+    return step;
+  }
+
+  int split_output(int parallelism) {
+    int step = step_output;
+    step_output *= parallelism;
+    return step;
+  }
+
+  dim3 block() const {
+    return dim3(block_width, block_height);
+  }
+
+  dim3 grid() const {
+    return dim3(div_up(num_outputs, step_output), ctas_per_output);
+  }
+
+  __host__ __device__ bool should_block_x_reduce() const {
+    return input_mult[BLOCK_X] != 0;
+  }
+
+  __host__ __device__ bool should_block_y_reduce() const {
+    return input_mult[BLOCK_Y] != 0;
+  }
+
+  __host__ __device__ bool should_global_reduce() const {
+    return input_mult[CTA] != 0;
+  }
+
+  __device__ bool should_store(int output_idx) const {
+    return output_idx < num_outputs &&
+      (!should_block_x_reduce() || threadIdx.x == 0) &&
+      (!should_block_y_reduce() || threadIdx.y == 0);
+  }
+
+  __device__ int input_idx() const {
+    int lane = threadIdx.x;
+    int warp = threadIdx.y;
+    int cta2 = blockIdx.y;
+    return (lane * input_mult[BLOCK_X] +
+            warp * input_mult[BLOCK_Y] +
+            cta2 * input_mult[CTA]);
+  }
+
+  __device__ int output_idx() const {
+    int lane = threadIdx.x;
+    int warp = threadIdx.y;
+    int cta1 = blockIdx.x;
+    return (lane * output_mult[BLOCK_X] +
+            warp * output_mult[BLOCK_Y] +
+            cta1 * step_output);
+  }
+
+  __device__ int shared_memory_offset(int offset) const {
+    return threadIdx.x + (threadIdx.y + offset) * blockDim.x;
+  }
+
+  __device__ int staging_memory_offset(int cta2) const {
+    int offset = cta2 + blockIdx.x * gridDim.y;
+    if (!should_block_x_reduce()) {
+      offset = threadIdx.x + offset * blockDim.x;
+    }
+    return offset;
+  }
+
+  int shared_memory_size() const {
+    if (!should_block_y_reduce()) {
+      return 0;
+    }
+    return element_size_bytes * num_threads;
+  }
+
+  int64_t global_memory_size() const {
+    if (!should_global_reduce()) {
+      return 0;
+    }
+    auto size = (int64_t)element_size_bytes * num_outputs * ctas_per_output;
+    if (!should_block_x_reduce()) {
+      size *= block().x;
+    }
+    return size;
+  }
+
+  int semaphore_size() const {
+    if (!should_global_reduce()) {
+      return 0;
+    }
+    return sizeof(int) * grid().x;
+  }
+
+  int values_per_thread() const {
+    return div_up(num_inputs, step_input);
+  }
+};
+
+template<int nt, typename R>
+__launch_bounds__(nt, 4)
+__global__ void reduce_kernel(R reduction) {
+  reduction.run();
+}
+
+template <typename scalar_t, typename arg_t, int noutputs, typename ops_t>
+struct ReduceOp {
+  using InputCalculator = OffsetCalculator<1>;
+  using OutputCalculator = OffsetCalculator<noutputs + 1>;
+
+  ops_t ops;
+  arg_t ident;
+  ReduceConfig config;
+  InputCalculator input_calc;
+  OutputCalculator output_calc;
+  const void* src;
+  void* dst[noutputs];
+  void* buffer;
+  int* semaphores;
+
+  ReduceOp(ops_t ops, ReduceConfig config, InputCalculator input_calc, OutputCalculator output_calc,
+           const void* src, void* const* dst_, void* buffer, int* semaphores, arg_t ident)
+    : ops(ops)
+    , ident(ident)
+    , config(config)
+    , input_calc(input_calc)
+    , output_calc(output_calc)
+    , src(src)
+    , buffer(buffer)
+    , semaphores(semaphores) {
+    for (int i = 0; i < noutputs; i++) {
+      dst[i] = dst_[i];
+    }
+  }
+
+  __device__ void run() const {
+    extern __shared__ char shared_memory[];
+    int output_idx = config.output_idx();
+    int input_idx = config.input_idx();
+    auto base_offsets = output_calc.get(output_idx);
+
+    arg_t value = ident;
+    if (output_idx < config.num_outputs && input_idx < config.num_inputs) {
+      auto input_slice = (const char*)src + base_offsets[noutputs];
+      value = thread_reduce(input_slice);
+    }
+
+    if (config.should_block_y_reduce()) {
+      value = block_y_reduce(value, shared_memory);
+    }
+    if (config.should_block_x_reduce()) {
+      value = block_x_reduce(value);
+    }
+
+    if (config.should_global_reduce()) {
+      global_reduce(value, base_offsets, shared_memory);
+    } else if (config.should_store(output_idx)) {
+      set_results(ops.project(value), base_offsets);
+    }
+  }
+
+  __device__ arg_t thread_reduce(const char* data) const {
+    constexpr int vt = input_vec_size<scalar_t>::value;
+    if (vt > 1 && config.vectorize_input) {
+      return input_vectorized_thread_reduce<vt>((const scalar_t*)data);
+    }
+    return strided_thread_reduce<4>(data);
+  }
+
+  // Loads `vt` contiguous elements at once. The reduced dimension is
+  // contiguous, and leading elements are handled one by one until the data
+  // pointer is aligned for the vector loads.
+  template <int vt>
+  __device__ arg_t input_vectorized_thread_reduce(const scalar_t* data) const {
+    using vec_t = aligned_vector<scalar_t, vt>;
+    int end = config.num_inputs;
+    const int stride = config.step_input;
+
+    arg_t value_list[vt];
+    #pragma unroll
+    for (int i = 0; i < vt; i++) {
+      value_list[i] = ident;
+    }
+
+    int shift = (reinterpret_cast<uintptr_t>(data) % sizeof(vec_t)) / sizeof(scalar_t);
+    if (shift > 0) {
+      shift = vt - shift;
+      for (int idx = config.input_idx(); idx < shift && idx < end; idx += stride) {
+        value_list[0] = ops.reduce(value_list[0], data[idx]);
+      }
+      if (shift >= end) {
+        return value_list[0];
+      }
+      data += shift;
+      end -= shift;
+    }
+
+    const vec_t* data_vec = reinterpret_cast<const vec_t*>(data);
+    const int num_vec = end / vt;
+    for (int idx = config.input_idx(); idx < num_vec; idx += stride) {
+      vec_t values = data_vec[idx];
+      #pragma unroll
+      for (int i = 0; i < vt; i++) {
+        value_list[i] = ops.reduce(value_list[i], values.val[i]);
+      }
+    }
+
+    for (int idx = num_vec * vt + config.input_idx(); idx < end; idx += stride) {
+      value_list[0] = ops.reduce(value_list[0], data[idx]);
+    }
+
+    #pragma unroll
+    for (int i = 1; i < vt; i++) {
+      value_list[0] = ops.combine(value_list[0], value_list[i]);
+    }
+    return value_list[0];
+  }
+
+  // Keeps `vt` independent accumulators so that several loads are in flight
+  // at once, instead of each load waiting on the previous reduce.
+  template <int vt>
+  __device__ arg_t strided_thread_reduce(const char* data) const {
+    int idx = config.input_idx();
+    const int stride = config.step_input;
+    const int end = config.num_inputs;
+
+    arg_t value_list[vt];
+    #pragma unroll
+    for (int i = 0; i < vt; i++) {
+      value_list[i] = ident;
+    }
+
+    scalar_t values[vt];
+    while ((int64_t)idx + (int64_t)(vt - 1) * stride < end) {
+      #pragma unroll
+      for (int i = 0; i < vt; i++) {
+        values[i] = *(const scalar_t*)(data + input_calc.get(idx + i * stride)[0]);
+      }
+      #pragma unroll
+      for (int i = 0; i < vt; i++) {
+        value_list[i] = ops.reduce(value_list[i], values[i]);
+      }
+      idx += stride * vt;
+    }
+    for (; idx < end; idx += stride) {
+      scalar_t value = *(const scalar_t*)(data + input_calc.get(idx)[0]);
+      value_list[0] = ops.reduce(value_list[0], value);
+    }
+
+    #pragma unroll
+    for (int i = 1; i < vt; i++) {
+      value_list[0] = ops.combine(value_list[0], value_list[i]);
+    }
+    return value_list[0];
+  }
+
+  // blockDim.x is at most a warp, so lane 0 of each row collects its row.
+  __device__ arg_t block_x_reduce(arg_t value) const {
+    for (int offset = 1; offset < blockDim.x; offset <<= 1) {
+      arg_t other = ops.warp_shfl_down(value, offset);
+      value = ops.combine(value, other);
+    }
+    return value;
+  }
+
+  __device__ arg_t block_y_reduce(arg_t value, char* shared_memory) const {
+    arg_t* shared = (arg_t*)shared_memory;
+    shared[config.shared_memory_offset(0)] = value;
+    for (int offset = blockDim.y / 2; offset > 0; offset >>= 1) {
+      __syncthreads();
+      if (threadIdx.y < offset && threadIdx.y + offset < blockDim.y) {
+        arg_t other = shared[config.shared_memory_offset(offset)];
+        value = ops.combine(value, other);
+        shared[config.shared_memory_offset(0)] = value;
+      }
+    }
+    return value;
+  }
+
+  __device__ bool mark_block_finished() const {
+    __shared__ bool is_last_block_done_shared;
+
+    __syncthreads();
+    if (threadIdx.x == 0 && threadIdx.y == 0) {
+      int prev_blocks_finished = atomicAdd(&semaphores[blockIdx.x], 1);
+      is_last_block_done_shared = (prev_blocks_finished == gridDim.y - 1);
+    }
+
+    __syncthreads();
+    return is_last_block_done_shared;
+  }
+
+  template <typename offsets_t>
+  __device__ void global_reduce(arg_t value, offsets_t base_offsets, char* shared_memory) const {
+    arg_t* reduce_buffer = (arg_t*)buffer;
+
+    bool should_store = config.should_store(config.output_idx());
+    if (should_store) {
+      int offset = config.staging_memory_offset(blockIdx.y);
+      reduce_buffer[offset] = value;
+    }
+
+    __threadfence(); // make sure writes are globally visible
+    __syncthreads(); // if multiple warps in this block wrote to staging, make sure they're all done
+    bool is_last_block_done = mark_block_finished();
+
+    if (is_last_block_done) {
+      value = ident;
+      if (config.should_block_x_reduce()) {
+        int input_offset = threadIdx.x + threadIdx.y * blockDim.x;
+        int step = blockDim.x * blockDim.y;
+        for (; input_offset < config.ctas_per_output; input_offset += step) {
+          int idx = config.staging_memory_offset(input_offset);
+          arg_t next = reduce_buffer[idx];
+          value = ops.combine(value, next);
+        }
+      } else {
+        int input_offset = threadIdx.y;
+        int step = blockDim.y;
+        for (; input_offset < config.ctas_per_output; input_offset += step) {
+          int idx = config.staging_memory_offset(input_offset);
+          arg_t next = reduce_buffer[idx];
+          value = ops.combine(value, next);
+        }
+      }
+      value = block_y_reduce(value, shared_memory);
+      if (config.should_block_x_reduce()) {
+        value = block_x_reduce(value);
+      }
+      if (should_store) {
+        set_results(ops.project(value), base_offsets);
+      }
+    }
+  }
+
+  template <typename out_t, typename offsets_t>
+  __device__ void set_results(const out_t& x, offsets_t& base_offsets) const {
+    static_assert(noutputs == 1, "a reduction with two outputs must project to a thrust::pair");
+    *(out_t*)((char*)dst[0] + base_offsets[0]) = x;
+  }
+
+  template <typename out1_t, typename out2_t, typename offsets_t>
+  __device__ void set_results(const thrust::pair<out1_t, out2_t>& x, offsets_t& base_offsets) const {
+    static_assert(noutputs == 2, "only a reduction with two outputs can project to a thrust::pair");
+    *(out1_t*)((char*)dst[0] + base_offsets[0]) = x.first;
+    *(out2_t*)((char*)dst[1] + base_offsets[1]) = x.second;
+  }
+};
+
+template <typename scalar_t, typename arg_t, int noutputs, typename ops_t>
+static void launch_reduce_kernel(const ReduceConfig& config, const ReduceOp<scalar_t, arg_t, noutputs, ops_t>& reduction) {
+  dim3 block = config.block();
+  dim3 grid = config.grid();
+  auto stream = at::cuda::getCurrentCUDAStream();
+  int shared_memory = config.shared_memory_size();
+  reduce_kernel<ReduceConfig::MAX_NUM_THREADS><<<grid, block, shared_memory, stream>>>(reduction);
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+} // namespace reduce
+
+// Runs the reduction described by `ops` over `iter`, which must be built with
+// TensorIterator::reduce_op() and have at least one input element. The
+// outputs are written as returned by ops.project(); `ident` is the identity
+// of ops.combine(). With two outputs, project() returns a thrust::pair.
+template <typename scalar_t, int noutputs = 1, typename arg_t, typename ops_t>
+void gpu_reduce_kernel(TensorIterator& iter, const ops_t& ops, arg_t ident) {
+  using namespace reduce;
+  static_assert(noutputs == 1 || noutputs == 2, "reductions have one or two outputs");
+  AT_ASSERT(iter.is_reduction() && iter.numel() > 0);
+  AT_ASSERT(iter.noutputs() == noutputs);
+
+  if (!iter.can_use_32bit_indexing()) {
+    for (auto& sub_iter : iter.with_32bit_indexing()) {
+      gpu_reduce_kernel<scalar_t, noutputs>(sub_iter, ops, ident);
+    }
+    return;
+  }
+
+  const int num_reduce_dims = iter.num_reduce_dims();
+  const int64_t num_outputs = iter.num_output_elements();
+  const int64_t inputs_per_output = iter.numel() / num_outputs;
+  const char* in_data = (char*)iter.data_ptr(noutputs);
+
+  auto config = ReduceConfig(sizeof(arg_t), num_outputs, inputs_per_output);
+
+  // Adjust block size to fit width to the fast changing dimension: lanes of a
+  // warp go along the reduced dimension when it is the contiguous one, and
+  // along the outputs otherwise.
+  bool reduction_on_fastest_striding_dimension =
+      num_reduce_dims == iter.ndim() ||
+      (num_reduce_dims > 0 && iter.strides(noutputs)[0] == (int64_t)sizeof(scalar_t));
+  int64_t dim0, dim1;
+  if (reduction_on_fastest_striding_dimension) {
+    dim0 = inputs_per_output;
+    dim1 = num_outputs;
+  } else {
+    dim0 = num_outputs;
+    dim1 = inputs_per_output;
+  }
+  config.set_block_dimension(dim0, dim1);
+
+  int block_width = config.block_width;
+  int block_height = config.block_height;
+
+  if (iter.ndim() == 0 || reduction_on_fastest_striding_dimension) {
+    // Split the input across lanes if the input is contiguous in the reduced
+    // dimension.
+    config.input_mult[0] = config.split_input(block_width);
+  } else {
+    // Otherwise split the output across lanes in a warp.
+    config.output_mult[0] = config.split_output(block_width);
+  }
+
+  if (config.values_per_thread() >= block_height * 16 || config.values_per_thread() >= 256) {
+    // Divide the input across warps in a thread-block, if that leaves at least
+    // 16 elements to be summed by each thread.
+    config.input_mult[1] = config.split_input(block_height);
+  } else {
+    // Otherwise, each warp handles a separate output.
+    config.output_mult[1] = config.split_output(block_height);
+  }
+
+  if (config.input_mult[1] != 0 && config.values_per_thread() >= 256 && num_outputs <= 4096) {
+    // Divide the input across thread-blocks if the amount of work per-thread
+    // is large enough and the size of the output is small enough. The
+    // partial results are combined through global memory.
+    config.ctas_per_output = div_up(config.values_per_thread(), 16);
+    if (config.ctas_per_output > 65535) {
+      config.ctas_per_output = 65535;
+    }
+    config.input_mult[2] = config.split_input(config.ctas_per_output);
+  }
+
+  // Load several elements at once when they are contiguous for each output
+  // and the lanes of a warp read consecutive elements.
+  config.vectorize_input = reduction_on_fastest_striding_dimension &&
+      num_reduce_dims == 1 && config.input_mult[0] == 1 &&
+      iter.strides(noutputs)[0] == (int64_t)sizeof(scalar_t);
+
+  // The reduced dimensions are the first `num_reduce_dims` of the iterator.
+  std::array<const int64_t*, 1> input_strides = {{ iter.strides(noutputs).data() }};
+  auto input_calc = OffsetCalculator<1>(num_reduce_dims, iter.shape().data(), input_strides.data());
+
+  std::array<void*, 2> out_data = {{ iter.data_ptr(0), noutputs == 2 ? iter.data_ptr(1) : nullptr }};
+
+  at::Tensor buffer;
+  at::Tensor semaphores;
+  if (config.should_global_reduce()) {
+    auto& type = iter.type().toScalarType(kByte);
+    buffer = at::empty({config.global_memory_size()}, type.options());
+    semaphores = at::zeros({config.semaphore_size()}, type.options());
+  }
+  void* buffer_ptr = buffer.defined() ? buffer.data_ptr() : nullptr;
+  int* semaphores_ptr = semaphores.defined() ? (int*)semaphores.data_ptr() : nullptr;
+
+  // The outputs and the input are indexed by the remaining dimensions.
+  int num_output_dims = iter.ndim() - num_reduce_dims;
+  const int64_t* output_shape = iter.shape().data() + num_reduce_dims;
+  std::array<const int64_t*, noutputs + 1> output_strides;
+  for (int i = 0; i <= noutputs; i++) {
+    output_strides[i] = iter.strides(i).data() + num_reduce_dims;
+  }
+  auto output_calc = OffsetCalculator<noutputs + 1>(num_output_dims, output_shape, output_strides.data());
+
+  auto reduce = ReduceOp<scalar_t, arg_t, noutputs, ops_t>(
+      ops, config, input_calc, output_calc, in_data, out_data.data(),
+      buffer_ptr, semaphores_ptr, ident);
+  launch_reduce_kernel(config, reduce);
+}
+
+}} // namespace at::native
@@ -0,0 +1,177 @@
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/native/DispatchStub.h>
+#include <ATen/native/ReduceOps.h>
+#include <ATen/native/TensorIterator.h>
+#include <ATen/native/cuda/Reduce.cuh>
+#include <limits>
+
+namespace at { namespace native {
+
+template <typename scalar_t, typename acc_t>
+struct SumOps {
+  __device__ __forceinline__ acc_t reduce(acc_t acc, scalar_t data) const {
+    return acc + static_cast<acc_t>(data);
+  }
+
+  __device__ __forceinline__ acc_t combine(acc_t a, acc_t b) const {
+    return a + b;
+  }
+
+  __device__ __forceinline__ scalar_t project(acc_t a) const {
+    return static_cast<scalar_t>(a);
+  }
+
+  __device__ __forceinline__ acc_t warp_shfl_down(acc_t data, int offset) const {
+    return WARP_SHFL_DOWN(data, offset);
+  }
+};
+
+template <typename scalar_t, typename acc_t>
+struct MeanOps : SumOps<scalar_t, acc_t> {
+  acc_t factor;
+
+  MeanOps(acc_t factor) : factor(factor) {}
+
+  __device__ __forceinline__ scalar_t project(acc_t a) const {
+    return static_cast<scalar_t>(a * factor);
+  }
+};
+
+template <typename scalar_t, typename acc_t>
+struct ProdOps {
+  __device__ __forceinline__ acc_t reduce(acc_t acc, scalar_t data) const {
+    return acc * static_cast<acc_t>(data);
+  }
+
+  __device__ __forceinline__ acc_t combine(acc_t a, acc_t b) const {
+    return a * b;
+  }
+
+  __device__ __forceinline__ scalar_t project(acc_t a) const {
+    return static_cast<scalar_t>(a);
+  }
+
+  __device__ __forceinline__ acc_t warp_shfl_down(acc_t data, int offset) const {
+    return WARP_SHFL_DOWN(data, offset);
+  }
+};
+
+// Running moments for Welford's online variance algorithm; partial results
+// are merged with the parallel formulation of Chan et al., as on the CPU.
+template <typename acc_t>
+struct WelfordData {
+  acc_t mean;
+  acc_t m2;
+  int64_t n;
+};
+
+template <typename scalar_t, typename acc_t>
+struct WelfordOps {
+  using data_t = WelfordData<acc_t>;
+
+  bool unbiased;
+  bool take_sqrt;
+
+  WelfordOps(bool unbiased, bool take_sqrt) : unbiased(unbiased), take_sqrt(take_sqrt) {}
+
+  __device__ __forceinline__ data_t reduce(data_t acc, scalar_t data) const {
+    acc_t x = static_cast<acc_t>(data);
+    acc_t delta = x - acc.mean;
+    acc.n += 1;
+    acc.mean += delta / acc.n;
+    acc.m2 += delta * (x - acc.mean);
+    return acc;
+  }
+
+  __device__ __forceinline__ data_t combine(data_t a, data_t b) const {
+    if (a.n == 0) {
+      return b;
+    }
+    if (b.n == 0) {
+      return a;
+    }
+    data_t r;
+    r.n = a.n + b.n;
+    acc_t delta = b.mean - a.mean;
+    acc_t nb_over_n = static_cast<acc_t>(b.n) / r.n;
+    r.mean = a.mean + delta * nb_over_n;
+    r.m2 = a.m2 + b.m2 + delta * delta * a.n * nb_over_n;
+    return r;
+  }
+
+  __device__ __forceinline__ acc_t var(data_t acc) const {
+    int64_t divisor = unbiased ? acc.n - 1 : acc.n;
+    return divisor > 0 ? acc.m2 / divisor : std::numeric_limits<acc_t>::quiet_NaN();
+  }
+
+  __device__ __forceinline__ scalar_t project(data_t acc) const {
+    acc_t v = var(acc);
+    return static_cast<scalar_t>(take_sqrt ? ::sqrt(v) : v);
+  }
+
+  __device__ __forceinline__ data_t warp_shfl_down(data_t acc, int offset) const {
+    data_t r;
+    r.mean = WARP_SHFL_DOWN(acc.mean, offset);
+    r.m2 = WARP_SHFL_DOWN(acc.m2, offset);
+    r.n = WARP_SHFL_DOWN(acc.n, offset);
+    return r;
+  }
+};
+
+// Writes the variance and the mean from the same pass over the input.
+template <typename scalar_t, typename acc_t>
+struct VarMeanOps : WelfordOps<scalar_t, acc_t> {
+  VarMeanOps(bool unbiased) : WelfordOps<scalar_t, acc_t>(unbiased, false) {}
+
+  __device__ __forceinline__ thrust::pair<scalar_t, scalar_t> project(WelfordData<acc_t> acc) const {
+    return thrust::pair<scalar_t, scalar_t>(
+        static_cast<scalar_t>(this->var(acc)), static_cast<scalar_t>(acc.mean));
+  }
+};
+
+static void sum_kernel_cuda(TensorIterator& iter) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(), "sum", [&]() {
+    using acc_t = acc_type<scalar_t, true>;
+    gpu_reduce_kernel<scalar_t>(iter, SumOps<scalar_t, acc_t>(), acc_t(0));
+  });
+}
+
+static void prod_kernel_cuda(TensorIterator& iter) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(), "prod", [&]() {
+    using acc_t = acc_type<scalar_t, true>;
+    gpu_reduce_kernel<scalar_t>(iter, ProdOps<scalar_t, acc_t>(), acc_t(1));
+  });
+}
+
+static void mean_kernel_cuda(TensorIterator& iter) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter.type(), "mean", [&]() {
+    using acc_t = acc_type<scalar_t, true>;
+    auto factor = static_cast<acc_t>(iter.num_output_elements()) / iter.numel();
+    gpu_reduce_kernel<scalar_t>(iter, MeanOps<scalar_t, acc_t>(factor), acc_t(0));
+  });
+}
+
+static void std_var_kernel_cuda(TensorIterator& iter, bool unbiased, bool take_sqrt) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter.type(), "std_var", [&]() {
+    using acc_t = acc_type<scalar_t, true>;
+    gpu_reduce_kernel<scalar_t>(
+        iter, WelfordOps<scalar_t, acc_t>(unbiased, take_sqrt), WelfordData<acc_t>{0, 0, 0});
+  });
+}
+
+static void var_mean_kernel_cuda(TensorIterator& iter, bool unbiased) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter.type(), "var_mean", [&]() {
+    using acc_t = acc_type<scalar_t, true>;
+    gpu_reduce_kernel<scalar_t, 2>(
+        iter, VarMeanOps<scalar_t, acc_t>(unbiased), WelfordData<acc_t>{0, 0, 0});
+  });
+}
+
+REGISTER_DISPATCH(sum_stub, &sum_kernel_cuda);
+REGISTER_DISPATCH(prod_stub, &prod_kernel_cuda);
+REGISTER_DISPATCH(mean_stub, &mean_kernel_cuda);
+REGISTER_DISPATCH(std_var_stub, &std_var_kernel_cuda);
+REGISTER_DISPATCH(var_mean_stub, &var_mean_kernel_cuda);
+
+}} // namespace at::native
@@ -3,6 +3,7 @@
 #include "ATen/TensorUtils.h"
 #include "ATen/NativeFunctions.h"
 #include "ATen/WrapDimUtils.h"
+#include <THC/THCDeviceUtils.cuh>
 #include <THC/THCTensorMathReduce.cuh>
 #include <THC/THCTensorSort.cuh>
 #include <THC/THCThrustAllocator.cuh>
@@ -470,7 +471,214 @@ cunn_SoftMaxBackward(scalar_t *gradInput, outscalar_t *output, outscalar_t *grad
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+// Warp-per-row kernel (fast when inner_size == 1 and dim_size <= 1024)
+////////////////////////////////////////////////////////////////////////////////
+// A block-wide reduction per row leaves most of a block idle for rows of a
+// few hundred elements and goes through shared memory twice. Here every warp
+// handles WARP_BATCH rows, each lane keeps WARP_ITERATIONS elements of a row
+// in registers, so the input is read only once, and the reductions use warp
+// shuffles. Rows are padded to the next power of two, which is a template
+// parameter so that all loops are unrolled. Rows shorter than a warp are
+// handled by "warps" of that many lanes.
+//
+// The kernels never return early, since lanes of partial warps still take
+// part in the shuffles of their neighbours.
+
+const int SoftMax_warpMaxLog2Elements = 10;
+const int SoftMax_warpThreadsPerBlock = 128;
+
+template <int log2_elements>
+struct SoftMaxWarpSizes {
+  static constexpr int elements = 1 << log2_elements;
+  static constexpr int warp_size = elements < 32 ? elements : 32;
+  static constexpr int iterations = elements / warp_size;
+  // short rows: two rows per warp to have more work in flight
+  static constexpr int batch = elements <= 128 ? 2 : 1;
+};
+
+template <int warp_size, template<typename> class ReduceOp, typename T>
+__device__ __forceinline__ T warpAllReduce(T val) {
+  ReduceOp<T> r;
+#pragma unroll
+  for (int offset = warp_size / 2; offset > 0; offset /= 2)
+    val = r(val, WARP_SHFL_XOR(val, offset, warp_size));
+  return val;
+}
+
+template <typename scalar_t, typename accscalar_t, typename outscalar_t, int log2_elements,
+          template<typename, typename, typename> class Epilogue>
+__global__ void
+cunn_SoftMaxForwardWarp(outscalar_t *output, const scalar_t *input, int64_t rows, int dim_size)
+{
+  using Sizes = SoftMaxWarpSizes<log2_elements>;
+  constexpr int WARP_SIZE = Sizes::warp_size;
+  constexpr int WARP_ITERATIONS = Sizes::iterations;
+  constexpr int WARP_BATCH = Sizes::batch;
+
+  const int64_t first_row = (static_cast<int64_t>(blockIdx.x) * blockDim.y + threadIdx.y) * WARP_BATCH;
+  const int lane = threadIdx.x;
+
+  accscalar_t elements[WARP_BATCH][WARP_ITERATIONS];
+#pragma unroll
+  for (int i = 0; i < WARP_BATCH; ++i) {
+    const bool valid_row = first_row + i < rows;
+#pragma unroll
+    for (int it = 0; it < WARP_ITERATIONS; ++it) {
+      const int d = lane + it * WARP_SIZE;
+      elements[i][it] = (valid_row && d < dim_size)
+          ? static_cast<accscalar_t>(input[(first_row + i) * dim_size + d])
+          : at::numeric_limits<accscalar_t>::lowest();
+    }
+  }
+
+#pragma unroll
+  for (int i = 0; i < WARP_BATCH; ++i) {
+    accscalar_t max_input = elements[i][0];
+#pragma unroll
+    for (int it = 1; it < WARP_ITERATIONS; ++it)
+      max_input = Max<accscalar_t>()(max_input, elements[i][it]);
+    max_input = warpAllReduce<WARP_SIZE, Max>(max_input);
+
+    accscalar_t sum = 0;
+#pragma unroll
+    for (int it = 0; it < WARP_ITERATIONS; ++it) {
+      if (lane + it * WARP_SIZE < dim_size)
+        sum += std::exp(elements[i][it] - max_input);
+    }
+    sum = warpAllReduce<WARP_SIZE, Add>(sum);
+
+    if (first_row + i < rows) {
+      Epilogue<accscalar_t, accscalar_t, outscalar_t> epilogue(max_input, sum);
+#pragma unroll
+      for (int it = 0; it < WARP_ITERATIONS; ++it) {
+        const int d = lane + it * WARP_SIZE;
+        if (d < dim_size)
+          output[(first_row + i) * dim_size + d] = epilogue(elements[i][it]);
+      }
+    }
+  }
+}
+
+template <typename scalar_t, typename accscalar_t, typename outscalar_t, int log2_elements,
+          template<typename, typename, typename> class Epilogue>
+__global__ void
+cunn_SoftMaxBackwardWarp(scalar_t *gradInput, const outscalar_t *output, const outscalar_t *gradOutput,
+                         int64_t rows, int dim_size)
+{
+  using Sizes = SoftMaxWarpSizes<log2_elements>;
+  constexpr int WARP_SIZE = Sizes::warp_size;
+  constexpr int WARP_ITERATIONS = Sizes::iterations;
+  constexpr int WARP_BATCH = Sizes::batch;
+
+  const int64_t first_row = (static_cast<int64_t>(blockIdx.x) * blockDim.y + threadIdx.y) * WARP_BATCH;
+  const int lane = threadIdx.x;
+
+  outscalar_t grads[WARP_BATCH][WARP_ITERATIONS];
+  outscalar_t outputs[WARP_BATCH][WARP_ITERATIONS];
+#pragma unroll
+  for (int i = 0; i < WARP_BATCH; ++i) {
+    const bool valid_row = first_row + i < rows;
+#pragma unroll
+    for (int it = 0; it < WARP_ITERATIONS; ++it) {
+      const int d = lane + it * WARP_SIZE;
+      if (valid_row && d < dim_size) {
+        grads[i][it] = gradOutput[(first_row + i) * dim_size + d];
+        outputs[i][it] = output[(first_row + i) * dim_size + d];
+      } else {
+        grads[i][it] = outscalar_t(0);
+        outputs[i][it] = outscalar_t(0);
+      }
+    }
+  }
+
+#pragma unroll
+  for (int i = 0; i < WARP_BATCH; ++i) {
+    accscalar_t sum = 0;
+#pragma unroll
+    for (int it = 0; it < WARP_ITERATIONS; ++it)
+      sum += static_cast<accscalar_t>(grads[i][it]);
+    sum = warpAllReduce<WARP_SIZE, Add>(sum);
+
+    if (first_row + i < rows) {
+      Epilogue<scalar_t, accscalar_t, outscalar_t> epilogue(sum);
+#pragma unroll
+      for (int it = 0; it < WARP_ITERATIONS; ++it) {
+        const int d = lane + it * WARP_SIZE;
+        if (d < dim_size)
+          gradInput[(first_row + i) * dim_size + d] = epilogue(grads[i][it], outputs[i][it]);
+      }
+    }
+  }
+}
+
+inline bool SoftMax_useWarpKernel(int64_t inner_size, int64_t dim_size) {
+#ifdef __HIP_PLATFORM_HCC__
+  // the kernels assume 32-wide warps
+  return false;
+#else
+  return inner_size == 1 && dim_size > 0 && dim_size <= (1 << SoftMax_warpMaxLog2Elements);
+#endif
+}
+
+inline int SoftMax_log2Ceil(int value) {
+  int log2_value = 0;
+  while ((1 << log2_value) < value) ++log2_value;
+  return log2_value;
+}
+
+template <int log2_elements>
+inline void SoftMax_getWarpLaunchSizes(int64_t rows, dim3& grid, dim3& block) {
+  using Sizes = SoftMaxWarpSizes<log2_elements>;
+  const int warps_per_block = SoftMax_warpThreadsPerBlock / Sizes::warp_size;
+  const int64_t rows_per_block = warps_per_block * Sizes::batch;
+  block = dim3(Sizes::warp_size, warps_per_block);
+  grid = dim3((rows + rows_per_block - 1) / rows_per_block);
+}
 
+#define SOFTMAX_WARP_CASES(CASE) \
+  CASE(0) CASE(1) CASE(2) CASE(3) CASE(4) CASE(5) \
+  CASE(6) CASE(7) CASE(8) CASE(9) CASE(10)
+
+template <typename scalar_t, typename accscalar_t, typename outscalar_t,
+          template<typename, typename, typename> class Epilogue>
+void SoftMax_launchForwardWarp(outscalar_t *output, const scalar_t *input,
+                               int64_t rows, int dim_size, cudaStream_t stream) {
+  dim3 grid, block;
+  switch (SoftMax_log2Ceil(dim_size)) {
+#define SOFTMAX_FORWARD_WARP_CASE(L)                                            \
+    case L:                                                                     \
+      SoftMax_getWarpLaunchSizes<L>(rows, grid, block);                         \
+      cunn_SoftMaxForwardWarp<scalar_t, accscalar_t, outscalar_t, L, Epilogue>  \
+        <<<grid, block, 0, stream>>>(output, input, rows, dim_size);           \
+      break;
+    SOFTMAX_WARP_CASES(SOFTMAX_FORWARD_WARP_CASE)
+#undef SOFTMAX_FORWARD_WARP_CASE
+    default:
+      AT_ERROR("softmax: dim size ", dim_size, " is too large for the warp kernel");
+  }
+}
+
+template <typename scalar_t, typename accscalar_t, typename outscalar_t,
+          template<typename, typename, typename> class Epilogue>
+void SoftMax_launchBackwardWarp(scalar_t *gradInput, const outscalar_t *output, const outscalar_t *gradOutput,
+                                int64_t rows, int dim_size, cudaStream_t stream) {
+  dim3 grid, block;
+  switch (SoftMax_log2Ceil(dim_size)) {
+#define SOFTMAX_BACKWARD_WARP_CASE(L)                                              \
+    case L:                                                                        \
+      SoftMax_getWarpLaunchSizes<L>(rows, grid, block);                            \
+      cunn_SoftMaxBackwardWarp<scalar_t, accscalar_t, outscalar_t, L, Epilogue>    \
+        <<<grid, block, 0, stream>>>(gradInput, output, gradOutput, rows, dim_size); \
+      break;
+    SOFTMAX_WARP_CASES(SOFTMAX_BACKWARD_WARP_CASE)
+#undef SOFTMAX_BACKWARD_WARP_CASE
+    default:
+      AT_ERROR("softmax backward: dim size ", dim_size, " is too large for the warp kernel");
+  }
+}
+
+#undef SOFTMAX_WARP_CASES
 
 
 
@@ -493,9 +701,20 @@ Tensor host_softmax(const Tensor & input_, const int64_t dim_, const bool half_t
       outer_size *= input.size(i);
     for (int64_t i = dim + 1; i < input.dim(); ++i)
       inner_size *= input.size(i);
+    if (SoftMax_useWarpKernel(inner_size, dim_size)) {
+      AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.type(), "host_softmax", [&] {
+      using accscalar_t = acc_type<scalar_t, true>;
+      if (!half_to_float) {
+          SoftMax_launchForwardWarp<scalar_t, accscalar_t, scalar_t, Epilogue>(
+            output.data<scalar_t>(), input.data<scalar_t>(), outer_size, dim_size, stream);
+      } else {
+          SoftMax_launchForwardWarp<scalar_t, accscalar_t, accscalar_t, Epilogue>(
+            output.data<accscalar_t>(), input.data<scalar_t>(), outer_size, dim_size, stream);
+      }
+      });
     // This kernel spawns a block per each element in the batch.
     // XXX: it assumes that inner_size == 1
-    if (inner_size == 1) {
+    } else if (inner_size == 1) {
       const int ILP = 2;
       dim3 grid(outer_size);
       dim3 block = SoftMax_getBlockSize(ILP, dim_size);
@@ -566,7 +785,21 @@ Tensor host_softmax_backward(const Tensor &grad_, const Tensor &output_, int64_t
     inner_size *= output.size(i);
 // See descriptions of kernels above.
   cudaStream_t stream = at::cuda::getCurrentCUDAStream();
-  if (inner_size == 1) {
+  if (output.numel() == 0) {
+    return gI;
+  }
+  if (SoftMax_useWarpKernel(inner_size, dim_size)) {
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(gI.type(), "host_softmax_backward", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    if (!half_to_float) {
+        SoftMax_launchBackwardWarp<scalar_t, accscalar_t, scalar_t, Epilogue>(
+          gI.data<scalar_t>(), output.data<scalar_t>(), grad.data<scalar_t>(), outer_size, dim_size, stream);
+    } else {
+        SoftMax_launchBackwardWarp<scalar_t, accscalar_t, accscalar_t, Epilogue>(
+          gI.data<scalar_t>(), output.data<accscalar_t>(), grad.data<accscalar_t>(), outer_size, dim_size, stream);
+    }
+    });
+  } else if (inner_size == 1) {
     const int ILP = 2;
     dim3 grid(outer_size);
     dim3 block = SoftMax_getBlockSize(ILP, dim_size);
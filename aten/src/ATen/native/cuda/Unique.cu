@@ -5,8 +5,12 @@
 #include <thrust/execution_policy.h>
 
 #include <tuple>
-#include <thrust/unique.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/scan.h>
+#include <thrust/scatter.h>
 #include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/unique.h>
 
 namespace at {
 namespace native{
@@ -14,28 +18,83 @@ namespace native{
 #ifndef __HIP_PLATFORM_HCC__
 
 namespace {
-template <typename scalar_t>
-__global__ void inverse_indices_kernel(
-    const scalar_t* input_data,
-    const scalar_t* output_data,
-    int64_t* inverse_indices_data,
-    int64_t num_inp,
-    int64_t num_out) {
-    int64_t idx = blockIdx.x * blockDim.x + threadIdx.x;
-    int64_t stride = blockDim.x * gridDim.x;
-
-    for (int64_t i = idx; i < num_inp * num_out; i += stride) {
-      if (input_data[i / num_out] == output_data[i % num_out]){
-        inverse_indices_data[i / num_out] = i % num_out;   
-      }
+
+// Reduces every run of equal consecutive elements of data to one element of
+// the output. The inverse indices of the runs, which have the sizes of
+// `sizes`, are scattered to the positions in `perm` when data is a
+// permutation of the input, and the counts are the lengths of the runs.
+// Equality is ==, so that NaNs are all distinct as on the CPU.
+template <typename scalar_t, typename Policy>
+std::tuple<Tensor, Tensor, Tensor> _unique_consecutive_runs(
+    Policy& policy,
+    const scalar_t* data,
+    const int64_t num_inp,
+    const int64_t* perm,
+    IntList sizes,
+    const TensorOptions& options,
+    const bool return_inverse,
+    const bool return_counts) {
+  thrust::counting_iterator<int64_t> positions(0);
+
+  Tensor inverse_indices = at::empty({0}, options.dtype(kLong));
+  if (return_inverse) {
+    // The run of every element is the number of runs that start at or
+    // before it, minus one
+    Tensor run_ids = at::empty({num_inp}, options.dtype(kLong));
+    int64_t* run_ids_data = run_ids.data<int64_t>();
+    thrust::transform(policy, positions, positions + num_inp, run_ids_data,
+      [=] __device__ (int64_t i) -> int64_t {
+        return i > 0 && !(data[i] == data[i - 1]) ? 1 : 0;
+      });
+    thrust::inclusive_scan(
+      policy, run_ids_data, run_ids_data + num_inp, run_ids_data);
+    if (perm != nullptr) {
+      inverse_indices.resize_(sizes);
+      thrust::scatter(policy, run_ids_data, run_ids_data + num_inp, perm,
+                      inverse_indices.data<int64_t>());
+    } else {
+      inverse_indices = run_ids.view(sizes);
     }
   }
 
+  Tensor output = at::empty({num_inp}, options);
+  scalar_t* output_data = output.data<scalar_t>();
+  Tensor counts = at::empty({0}, options.dtype(kLong));
+  int64_t num_out;
+  if (return_counts) {
+    // Keep the start of every run, the counts are the differences of the
+    // consecutive starts
+    Tensor starts = at::empty({num_inp}, options.dtype(kLong));
+    int64_t* starts_data = starts.data<int64_t>();
+    auto ends = thrust::unique_by_key_copy(
+      policy, data, data + num_inp, positions, output_data, starts_data);
+    num_out = ends.first - output_data;
+    counts.resize_(num_out);
+    thrust::transform(policy, positions, positions + num_out,
+      counts.data<int64_t>(),
+      [=] __device__ (int64_t i) -> int64_t {
+        return (i + 1 < num_out ? starts_data[i + 1] : num_inp) - starts_data[i];
+      });
+  } else {
+    num_out =
+      thrust::unique_copy(policy, data, data + num_inp, output_data) -
+      output_data;
+  }
+  output.resize_(num_out);
+
+  THCudaCheck(cudaGetLastError());
+  return std::make_tuple(output, inverse_indices, counts);
+}
 
+// Sort-based: the (value, position) pairs are sorted by value, which thrust
+// does with a radix sort for arithmetic types, and the runs of equal values
+// are then reduced in a few linear passes. The output is sorted whether or
+// not `sorted` was requested, as on the CPU.
 template <typename scalar_t>
-  std::tuple<Tensor, Tensor> _unique_cuda_template(
+  std::tuple<Tensor, Tensor, Tensor> _unique_cuda_template(
     const Tensor& self,
-    const bool return_inverse) {
+    const bool return_inverse,
+    const bool return_counts) {
 
     cudaStream_t stream = at::cuda::getCurrentCUDAStream();
     auto allocator = THCThrustAllocator(globalContext().lazyInitCUDA());
@@ -43,31 +102,39 @@ template <typename scalar_t>
 
     const Tensor& input = self.contiguous();
     int64_t num_inp = input.numel();
-    const scalar_t* input_data = input.data<scalar_t>();
-
-    //sort & unique
-    Tensor output = input.clone();
-    output = output.view(-1);
-    scalar_t* output_data = output.data<scalar_t>();
-    thrust::sort(policy, output_data, output_data + num_inp);
-    scalar_t* output_end = thrust::unique(policy, output_data, output_data + num_inp);
-    int64_t num_out = output_end - output_data;
-    output.resize_(num_out);
-
-    Tensor inverse_indices = at::empty({0}, self.type().toScalarType(kLong));
 
+    Tensor sorted = input.clone().view(-1);
+    scalar_t* sorted_data = sorted.data<scalar_t>();
+    Tensor perm;
+    int64_t* perm_data = nullptr;
     if (return_inverse) {
-      inverse_indices.resize_(input.sizes());
-      int64_t* inverse_indices_data = inverse_indices.data<int64_t>();
-      int block = 512;
-      int grid = std::min<int64_t>((num_inp * num_out + block - 1) / block, 2048L);
-      inverse_indices_kernel<<<grid, block, 0, stream>>>(
-        input_data, output_data, inverse_indices_data, num_inp, num_out);
+      perm = at::arange(num_inp, self.options().dtype(kLong));
+      perm_data = perm.data<int64_t>();
+      thrust::sort_by_key(
+        policy, sorted_data, sorted_data + num_inp, perm_data);
+    } else {
+      thrust::sort(policy, sorted_data, sorted_data + num_inp);
     }
 
-    THCudaCheck(cudaGetLastError());   
-    return std::tuple<Tensor, Tensor>(output, inverse_indices);
+    return _unique_consecutive_runs<scalar_t>(
+      policy, sorted_data, num_inp, perm_data, input.sizes(), self.options(),
+      return_inverse, return_counts);
+  }
+
+template <typename scalar_t>
+  std::tuple<Tensor, Tensor, Tensor> _unique_consecutive_cuda_template(
+    const Tensor& self,
+    const bool return_inverse,
+    const bool return_counts) {
 
+    cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+    auto allocator = THCThrustAllocator(globalContext().lazyInitCUDA());
+    auto policy = thrust::cuda::par(allocator).on(stream);
+
+    const Tensor& input = self.contiguous();
+    return _unique_consecutive_runs<scalar_t>(
+      policy, input.data<scalar_t>(), input.numel(), nullptr, input.sizes(),
+      self.options(), return_inverse, return_counts);
   }
 
 template <typename scalar_t>
@@ -163,15 +230,38 @@ std::tuple<Tensor, Tensor>
 _unique_cuda(const Tensor& self, const bool sorted, const bool return_inverse) {
 #ifndef __HIP_PLATFORM_HCC__
   return AT_DISPATCH_ALL_TYPES(self.type(), "unique", [&] {
-    // The current CUDA implementation of unique always sort due to the
-    // lack of hashtable implementation in thrust
-    return _unique_cuda_template<scalar_t>(self, return_inverse);
+    Tensor output, inverse_indices;
+    std::tie(output, inverse_indices, std::ignore) =
+      _unique_cuda_template<scalar_t>(self, return_inverse, false);
+    return std::make_tuple(output, inverse_indices);
   });
 #else
   AT_ERROR("unique_cuda: HIP not supported");
 #endif
 }
 
+std::tuple<Tensor, Tensor, Tensor>
+_unique2_cuda(const Tensor& self, const bool sorted, const bool return_inverse, const bool return_counts) {
+#ifndef __HIP_PLATFORM_HCC__
+  return AT_DISPATCH_ALL_TYPES(self.type(), "unique", [&] {
+    return _unique_cuda_template<scalar_t>(self, return_inverse, return_counts);
+  });
+#else
+  AT_ERROR("unique_cuda: HIP not supported");
+#endif
+}
+
+std::tuple<Tensor, Tensor, Tensor>
+_unique_consecutive_cuda(const Tensor& self, const bool return_inverse, const bool return_counts) {
+#ifndef __HIP_PLATFORM_HCC__
+  return AT_DISPATCH_ALL_TYPES(self.type(), "unique_consecutive", [&] {
+    return _unique_consecutive_cuda_template<scalar_t>(self, return_inverse, return_counts);
+  });
+#else
+  AT_ERROR("unique_consecutive_cuda: HIP not supported");
+#endif
+}
+
 std::tuple<Tensor, Tensor>
 _unique_dim_cuda(const Tensor& self, const int64_t dim, const bool sorted, const bool return_inverse) {
   #ifndef __HIP_PLATFORM_HCC__
@@ -85,9 +85,14 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> cudnn_convolution_transpose_backwar
 
 #include <ATen/TensorUtils.h>
 
+#include <ATen/cuda/CUDAContext.h>
+
+#include <fstream>
 #include <functional>
 #include <iterator>
 #include <sstream>
+#include <string>
+#include <vector>
 #include <algorithm>
 #include <memory>
 #include <mutex>
@@ -252,6 +257,7 @@ static void convolution_shape_check(
 // parameters
 struct ConvolutionParams
 {
+  int device_id;
   cudnnDataType_t dataType;
   int input_size[2 + max_dim];
   int input_stride[2 + max_dim];
@@ -278,6 +284,7 @@ void setConvolutionParams(
 
   cudnnDataType_t dataType = getCudnnDataType(input);
   memset(params, 0, sizeof(ConvolutionParams));
+  params->device_id = input.get_device();
   params->dataType = dataType;
   // ASSERT(weight.dim() == input.dim())
   for (int i = 0; i != input.dim(); ++i) {
@@ -344,6 +351,121 @@ BenchmarkCache<cudnnConvolutionFwdAlgo_t> fwd_algos;
 BenchmarkCache<cudnnConvolutionBwdDataAlgo_t> bwd_data_algos;
 BenchmarkCache<cudnnConvolutionBwdFilterAlgo_t> bwd_filter_algos;
 
+// NOTE [ Persistent benchmark cache ]
+//
+// Benchmarking takes long enough that short-lived processes can spend most
+// of their warmup in it. If a cache file is set (see
+// Context::benchmarkCacheFileCuDNN), every algorithm found by benchmarking
+// is appended to it as a line
+//
+//    <cuDNN version> <GPU name> <fwd|bwd_data|bwd_filter> <params...> <algo>
+//
+// and the file is read into the caches above on the first miss in benchmark
+// mode (and again after the file is changed). Entries are only used with
+// the cuDNN version and on the GPU models they were found with; the device
+// index is replaced by every local device of that model. Malformed lines are
+// skipped, so several processes may append to the same file.
+
+static std::mutex cache_file_mutex;
+// the file the caches were last read from
+static std::string loaded_cache_file;
+
+static std::string deviceName(int64_t device) {
+  std::string name = at::cuda::getDeviceProperties(device)->name;
+  std::replace(name.begin(), name.end(), ' ', '_');
+  return name;
+}
+
+static void writeParams(std::ostream& out, const ConvolutionParams& params) {
+  out << static_cast<int>(params.dataType) << ' ' << params.groups << ' ' << params.deterministic;
+  for (int v : params.input_size) out << ' ' << v;
+  for (int v : params.input_stride) out << ' ' << v;
+  for (int v : params.weight_size) out << ' ' << v;
+  for (int v : params.padding) out << ' ' << v;
+  for (int v : params.stride) out << ' ' << v;
+  for (int v : params.dilation) out << ' ' << v;
+}
+
+static bool readParams(std::istream& in, ConvolutionParams* params) {
+  memset(params, 0, sizeof(ConvolutionParams));
+  int dataType;
+  in >> dataType >> params->groups >> params->deterministic;
+  params->dataType = static_cast<cudnnDataType_t>(dataType);
+  for (int& v : params->input_size) in >> v;
+  for (int& v : params->input_stride) in >> v;
+  for (int& v : params->weight_size) in >> v;
+  for (int& v : params->padding) in >> v;
+  for (int& v : params->stride) in >> v;
+  for (int& v : params->dilation) in >> v;
+  return !in.fail();
+}
+
+static void loadBenchmarkCacheFile() {
+  auto path = globalContext().benchmarkCacheFileCuDNN();
+  std::lock_guard<std::mutex> guard(cache_file_mutex);
+  if (path == loaded_cache_file) {
+    return;
+  }
+  loaded_cache_file = path;
+  if (path.empty()) {
+    return;
+  }
+  std::ifstream in(path);
+  if (!in) {
+    // a missing file is created by the first benchmark
+    return;
+  }
+
+  std::unordered_map<std::string, std::vector<int>> devices_by_name;
+  for (int64_t device = 0; device < at::cuda::getNumGPUs(); device++) {
+    devices_by_name[deviceName(device)].push_back(device);
+  }
+  const size_t version = cudnnGetVersion();
+
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    size_t entry_version;
+    std::string device_name, kind;
+    ConvolutionParams params;
+    int algo;
+    if (!(fields >> entry_version >> device_name >> kind) || entry_version != version ||
+        !readParams(fields, &params) || !(fields >> algo)) {
+      continue;
+    }
+    auto it = devices_by_name.find(device_name);
+    if (it == devices_by_name.end()) {
+      continue;
+    }
+    for (int device : it->second) {
+      params.device_id = device;
+      if (kind == "fwd") {
+        fwd_algos.insert(params, static_cast<cudnnConvolutionFwdAlgo_t>(algo));
+      } else if (kind == "bwd_data") {
+        bwd_data_algos.insert(params, static_cast<cudnnConvolutionBwdDataAlgo_t>(algo));
+      } else if (kind == "bwd_filter") {
+        bwd_filter_algos.insert(params, static_cast<cudnnConvolutionBwdFilterAlgo_t>(algo));
+      }
+    }
+  }
+}
+
+static void appendBenchmarkCacheFile(const char* kind, const ConvolutionParams& params, int algo) {
+  std::lock_guard<std::mutex> guard(cache_file_mutex);
+  if (loaded_cache_file.empty()) {
+    return;
+  }
+  std::ostringstream line;
+  line << cudnnGetVersion() << ' ' << deviceName(params.device_id) << ' ' << kind << ' ';
+  writeParams(line, params);
+  line << ' ' << algo << '\n';
+  std::ofstream out(loaded_cache_file, std::ios::app);
+  out << line.str();
+  if (!out) {
+    AT_WARN("could not write the cuDNN benchmark cache file ", loaded_cache_file);
+  }
+}
+
 // TODO: Stop manually allocating CUDA memory; allocate an ATen byte
 // tensor instead.
 struct Workspace {
@@ -455,6 +577,8 @@ template<>
 struct algorithm_search<cudnnConvolutionFwdAlgo_t> {
   using perf_t = cudnnConvolutionFwdAlgoPerf_t;
   using algo_t = cudnnConvolutionFwdAlgo_t;
+  // name in the benchmark cache file
+  static constexpr const char* NAME = "fwd";
 
   static constexpr auto DEFAULT_ALGO = CUDNN_CONVOLUTION_FWD_ALGO_IMPLICIT_PRECOMP_GEMM;
   static BenchmarkCache<algo_t>& cache() { return fwd_algos; }
@@ -526,6 +650,8 @@ template<>
 struct algorithm_search<cudnnConvolutionBwdDataAlgo_t> {
   using perf_t = cudnnConvolutionBwdDataAlgoPerf_t;
   using algo_t = cudnnConvolutionBwdDataAlgo_t;
+  // name in the benchmark cache file
+  static constexpr const char* NAME = "bwd_data";
 
   static constexpr auto DEFAULT_ALGO = CUDNN_CONVOLUTION_BWD_DATA_ALGO_1;
   static BenchmarkCache<algo_t>& cache() { return bwd_data_algos; }
@@ -591,6 +717,8 @@ template<>
 struct algorithm_search<cudnnConvolutionBwdFilterAlgo_t> {
   using perf_t = cudnnConvolutionBwdFilterAlgoPerf_t;
   using algo_t = cudnnConvolutionBwdFilterAlgo_t;
+  // name in the benchmark cache file
+  static constexpr const char* NAME = "bwd_filter";
 
   static constexpr auto DEFAULT_ALGO = CUDNN_CONVOLUTION_BWD_FILTER_ALGO_1;
 
@@ -675,8 +803,10 @@ void findAlgorithm(const ConvolutionArgs& args, bool benchmark, algo_t* algo) {
     return;
   }
 
+  // re-check cache since another thread may have benchmarked the algorithm,
+  // or another process may have recorded it in the benchmark cache file
+  loadBenchmarkCacheFile();
   if (cache.find(args.params, algo)) {
-    // re-check cache since another thread may have benchmarked the algorithm
     return;
   }
 
@@ -690,6 +820,7 @@ void findAlgorithm(const ConvolutionArgs& args, bool benchmark, algo_t* algo) {
       *algo = search::DEFAULT_ALGO;
   }
   cache.insert(args.params, *algo);
+  appendBenchmarkCacheFile(search::NAME, args.params, *algo);
 
   // Free the cached blocks in our caching allocator. They are
   // needed here because the above benchmarking uses a huge amount of memory,
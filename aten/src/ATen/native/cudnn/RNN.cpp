@@ -1170,15 +1170,19 @@ Tensor try_get_weight_buf(
 
   auto num_params = get_num_weights(handle, rnn_desc, x_desc, datatype);
 
-  // Try to get parameter storage
+  // Try to get parameter storage. The buffer starts at the first parameter,
+  // which need not be at the start of its storage: the parameters of
+  // DataParallel replicas, for example, are views into the buckets
+  // broadcast_coalesced flattens them into, which keeps them in the cuDNN
+  // layout of the original module but puts other parameters before them.
   auto & any_param = parameters.at(0);
   auto param_storage = any_param.storage();
-  auto weight_buf = at::empty({0}, any_param.options()).set_(param_storage);
-  if (weight_buf.size(0) < num_params) {
+  auto buf_offset = any_param.storage_offset();
+  if (static_cast<int64_t>(param_storage.size()) - buf_offset < num_params) {
     return {};
-  } else if (weight_buf.size(0) > num_params) {
-    weight_buf = weight_buf.narrow(0, 0, num_params);
   }
+  auto weight_buf = at::empty({0}, any_param.options()).set_(
+      param_storage, buf_offset, {num_params}, {1});
 
   // Get and check data pointers
   auto expected_data_ptrs = get_expected_data_ptrs(
@@ -10,6 +10,16 @@ Tensor& _baddbmm_mkl_(Tensor& self, const Tensor& batch1, const Tensor& batch2,
   AT_ERROR("bmm: ATen not compiled with MKL support");
 }
 
+Tensor _mkl_linear_prepack(const Tensor& weight) {
+  AT_ERROR("_mkl_linear_prepack: ATen not compiled with MKL support");
+}
+
+Tensor _mkl_linear_packed(const Tensor& input, const Tensor& weight, const Tensor& packed_weight, const Tensor& bias) {
+  // packed_weight can only have been made by an MKL build; the plain weight
+  // gives the same result.
+  return at::linear(input, weight, bias);
+}
+
 }}
 
 #else // AT_MKL_ENABLED
@@ -21,6 +31,7 @@ Tensor& _baddbmm_mkl_(Tensor& self, const Tensor& batch1, const Tensor& batch2,
 #include "ATen/NativeFunctions.h"
 
 #include <algorithm>
+#include <limits>
 #include <vector>
 #include <numeric>
 #include <cmath>
@@ -90,6 +101,89 @@ Tensor& _baddbmm_mkl_(Tensor& self, const Tensor& batch1, const Tensor& batch2,
   return self;
 }
 
+// See NOTE [ MKL packed linear weights ] in native_functions.yaml.
+//
+// The packed layout of the B operand only depends on its sizes (n, k), so the
+// same buffer serves inputs with any number of rows; m is only needed to
+// query and fill it.
+static constexpr MKL_INT kPackedLinearM = 1;
+
+static void check_packed_linear_weight(const Tensor& weight, const char* fn) {
+  AT_CHECK(weight.dim() == 2, fn, ": expected a 2-D weight, but got ", weight.dim(), "-D");
+  AT_CHECK(weight.type().backend() == Backend::CPU && weight.type().scalarType() == kFloat,
+           fn, ": expected a dense CPU float weight, but got ", weight.type().toString());
+  AT_CHECK(weight.size(0) <= std::numeric_limits<MKL_INT>::max() &&
+           weight.size(1) <= std::numeric_limits<MKL_INT>::max(),
+           fn, ": weight of size ", weight.sizes(), " is too large for MKL");
+}
+
+static size_t packed_linear_weight_nbytes(const Tensor& weight) {
+  return cblas_sgemm_pack_get_size(CblasBMatrix, kPackedLinearM, weight.size(0), weight.size(1));
+}
+
+Tensor _mkl_linear_prepack(const Tensor& weight) {
+  check_packed_linear_weight(weight, "_mkl_linear_prepack");
+  auto weight_ = weight.contiguous();
+  const MKL_INT N = weight_.size(0);
+  const MKL_INT K = weight_.size(1);
+  auto packed = at::empty({static_cast<int64_t>(packed_linear_weight_nbytes(weight_))},
+                          weight_.options().dtype(kByte));
+  // input @ weight^T: B is the transpose of the row-major {N, K} weight
+  cblas_sgemm_pack(CblasRowMajor, CblasBMatrix, CblasTrans, kPackedLinearM, N, K, 1.0f,
+                   weight_.data<float>(), K, reinterpret_cast<float*>(packed.data<uint8_t>()));
+  return packed;
+}
+
+Tensor _mkl_linear_packed(const Tensor& input, const Tensor& weight, const Tensor& packed_weight, const Tensor& bias) {
+  check_packed_linear_weight(weight, "_mkl_linear_packed");
+  AT_CHECK(packed_weight.type().backend() == Backend::CPU &&
+           packed_weight.type().scalarType() == kByte && packed_weight.dim() == 1 &&
+           packed_weight.is_contiguous() &&
+           packed_weight.numel() == static_cast<int64_t>(packed_linear_weight_nbytes(weight)),
+           "_mkl_linear_packed: packed_weight was not made by _mkl_linear_prepack from a weight of size ",
+           weight.sizes());
+  if (input.type() != weight.type()) {
+    // e.g. a double input; let linear type check and compute it
+    return at::linear(input, weight, bias);
+  }
+  const int64_t N = weight.size(0);
+  const int64_t K = weight.size(1);
+  AT_CHECK(input.dim() >= 1 && input.size(-1) == K,
+           "_mkl_linear_packed: expected input with ", K, " features in the last dimension, but got size ",
+           input.sizes());
+  if (bias.defined()) {
+    AT_CHECK(bias.dim() == 1 && bias.size(0) == N,
+             "_mkl_linear_packed: expected a bias of size [", N, "], but got ", bias.sizes());
+  }
+
+  auto input_2d = input.reshape({-1, K}).contiguous();
+  const int64_t M = input_2d.size(0);
+  AT_CHECK(M <= std::numeric_limits<MKL_INT>::max(),
+           "_mkl_linear_packed: input of size ", input.sizes(), " is too large for MKL");
+
+  Tensor output;
+  float beta = 0.0f;
+  if (bias.defined()) {
+    output = at::empty({M, N}, input_2d.options());
+    output.copy_(bias.expand({M, N}));
+    beta = 1.0f;
+  } else if (K == 0) {
+    output = at::zeros({M, N}, input_2d.options());
+  } else {
+    output = at::empty({M, N}, input_2d.options());
+  }
+  if (M > 0 && N > 0 && K > 0) {
+    cblas_sgemm_compute(CblasRowMajor, CblasNoTrans, CblasPacked, M, N, K,
+                        input_2d.data<float>(), K,
+                        reinterpret_cast<const float*>(packed_weight.data<uint8_t>()), K,
+                        beta, output.data<float>(), N);
+  }
+
+  auto output_size = input.sizes().vec();
+  output_size.back() = N;
+  return output.view(output_size);
+}
+
 }} // namespace at::native
 
 #endif
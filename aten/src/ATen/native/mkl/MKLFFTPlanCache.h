@@ -0,0 +1,165 @@
+#pragma once
+
+#include "ATen/ATen.h"
+#include "ATen/mkl/Descriptors.h"
+#include "ATen/native/utils/ParamsHash.h"
+
+#include <cstring>
+#include <limits>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace at { namespace native { namespace detail {
+
+constexpr int mkl_fft_max_rank = 3;
+
+// This POD struct holds everything a committed DFTI descriptor depends on.
+// It will be the **key** to the plan cache.
+//
+// Strides and distances are in units of the transform's element type, i.e.,
+// already divided by 2 for complex data.
+struct MKLFFTParams
+{
+  at::ScalarType scalar_type_;
+  int64_t batch_;
+  int64_t input_distance_;
+  int64_t output_distance_;
+  int64_t input_strides_[mkl_fft_max_rank];
+  int64_t output_strides_[mkl_fft_max_rank];
+  int64_t signal_sizes_[mkl_fft_max_rank];
+  uint8_t signal_ndim_;  // between 1 and mkl_fft_max_rank
+  bool complex_input_;
+  bool complex_output_;
+  bool inverse_;
+  bool normalized_;
+};
+
+// NB: This can't be a constructor, because then MKLFFTParams
+// would not be a POD anymore.
+static inline void setMKLFFTParams(MKLFFTParams* params,
+    const Tensor& input, const Tensor& output, int64_t signal_ndim,
+    bool complex_input, bool complex_output, bool inverse,
+    IntList checked_signal_sizes, bool normalized) {
+
+  memset(params, 0, sizeof(MKLFFTParams));
+  params->scalar_type_ = input.type().scalarType();
+  params->batch_ = input.size(0);
+  params->input_distance_ = complex_input ? input.stride(0) >> 1 : input.stride(0);
+  params->output_distance_ = complex_output ? output.stride(0) >> 1 : output.stride(0);
+  for (int64_t i = 0; i < signal_ndim; i++) {
+    params->input_strides_[i] = complex_input ? input.stride(i + 1) >> 1 : input.stride(i + 1);
+    params->output_strides_[i] = complex_output ? output.stride(i + 1) >> 1 : output.stride(i + 1);
+    params->signal_sizes_[i] = checked_signal_sizes[i];
+  }
+  params->signal_ndim_ = (uint8_t) signal_ndim;
+  params->complex_input_ = complex_input;
+  params->complex_output_ = complex_output;
+  params->inverse_ = inverse;
+  params->normalized_ = normalized;
+}
+
+// Committing a descriptor precomputes twiddle factors and picks kernels, which
+// for small transforms costs far more than the transform itself.
+//
+// The max plan number is arbitrary and only bounds how many descriptors (and
+// their twiddle tables) we keep alive.
+constexpr int64_t MKL_FFT_MAX_PLAN_NUM = 4096;
+constexpr int64_t MKL_FFT_DEFAULT_PLAN_NUM = 256;
+
+// This cache assumes that the mapping from key to value never changes.
+// This is **NOT** thread-safe. Please use a mutex when using it.
+//
+// Values are shared pointers so that a descriptor can be executed after the
+// mutex is released: committed DFTI descriptors may be used by several threads
+// at once, and a descriptor evicted while in use stays alive until its last
+// user is done with it.
+// The contract of using this cache is that try_emplace_value should only be
+// used when the max_size is positive.
+class MKLFFTParamsLRUCache {
+public:
+  using value_t = std::shared_ptr<DftiDescriptor>;
+  using kv_t = typename std::pair<MKLFFTParams, value_t>;
+  using map_t = typename std::unordered_map<std::reference_wrapper<MKLFFTParams>,
+                                            typename std::list<kv_t>::iterator,
+                                            ParamsHash<MKLFFTParams>,
+                                            ParamsEqual<MKLFFTParams>>;
+  using map_kkv_iter_t = typename map_t::iterator;
+
+  MKLFFTParamsLRUCache() : MKLFFTParamsLRUCache(MKL_FFT_DEFAULT_PLAN_NUM) {}
+
+  MKLFFTParamsLRUCache(int64_t max_size) {
+    _set_max_size(max_size);
+  }
+
+  // If key is in this cache, return the cached descriptor. Otherwise, create
+  // one with make_value(), store it in this cache and return it.
+  template<typename F>
+  value_t try_emplace_value(MKLFFTParams key, const F& make_value) {
+    AT_ASSERT(_max_size > 0);
+
+    map_kkv_iter_t map_it = _cache_map.find(key);
+    // Hit, put to list front
+    if (map_it != _cache_map.end()) {
+      _usage_list.splice(_usage_list.begin(), _usage_list, map_it->second);
+      return map_it->second->second;
+    }
+
+    // Miss. Create the value first so that a failure leaves the cache intact.
+    value_t value = make_value();
+
+    // remove if needed
+    if (_usage_list.size() >= _max_size) {
+      auto last = _usage_list.end();
+      last--;
+      _cache_map.erase(last->first);
+      _usage_list.pop_back();
+    }
+
+    // insert at list front, then into _cache_map
+    _usage_list.emplace_front(key, value);
+    auto kv_it = _usage_list.begin();
+    _cache_map.emplace(std::piecewise_construct,
+                std::forward_as_tuple(kv_it->first),
+                std::forward_as_tuple(kv_it));
+    return value;
+  }
+
+  void clear() {
+    _cache_map.clear();
+    _usage_list.clear();
+  }
+
+  void resize(int64_t new_size) {
+    _set_max_size(new_size);
+    auto cur_size = _usage_list.size();
+    if (cur_size > _max_size) {
+      auto delete_it = _usage_list.end();
+      for (size_t i = 0; i < cur_size - _max_size; i++) {
+        delete_it--;
+        _cache_map.erase(delete_it->first);
+      }
+      _usage_list.erase(delete_it, _usage_list.end());
+    }
+  }
+
+  size_t size() const { return _cache_map.size(); }
+
+  size_t max_size() const noexcept { return _max_size; }
+
+private:
+  // Only sets size and does value check. Does not resize the data structures.
+  void _set_max_size(int64_t new_size) {
+    AT_CHECK(new_size <= MKL_FFT_MAX_PLAN_NUM,
+             "MKL FFT plan cache size can not be larger than ", MKL_FFT_MAX_PLAN_NUM, ", but got ", new_size);
+    AT_CHECK(new_size >= 0,
+             "MKL FFT plan cache size must be non-negative, but got ", new_size);
+    _max_size = static_cast<size_t>(new_size);
+  }
+
+  std::list<kv_t> _usage_list;
+  map_t _cache_map;
+  size_t _max_size;
+};
+
+}}} // namespace at::native::detail
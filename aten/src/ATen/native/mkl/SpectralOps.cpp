@@ -15,6 +15,20 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
   AT_ERROR("fft: ATen not compiled with MKL support");
 }
 
+int64_t _mkl_fft_get_plan_cache_max_size() {
+  return 0;
+}
+
+void _mkl_fft_set_plan_cache_max_size(int64_t max_size) {
+  AT_ERROR("MKL FFT plan cache: ATen not compiled with MKL support");
+}
+
+int64_t _mkl_fft_get_plan_cache_size() {
+  return 0;
+}
+
+void _mkl_fft_clear_plan_cache() {}
+
 }}
 
 #else // AT_MKL_ENABLED
@@ -26,6 +40,9 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
 #include "ATen/NativeFunctions.h"
 
 #include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <numeric>
 #include <cmath>
@@ -34,6 +51,7 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
 #include <ATen/mkl/Exceptions.h>
 #include <ATen/mkl/Descriptors.h>
 #include <ATen/mkl/Limits.h>
+#include <ATen/native/mkl/MKLFFTPlanCache.h>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -159,13 +177,99 @@ static inline void _fft_fill_with_conjugate_symmetry_(Tensor& input,
   });
 }
 
+// Creates and commits a DFTI descriptor for the transform described by params.
+static std::shared_ptr<DftiDescriptor> _make_dfti_descriptor(const detail::MKLFFTParams& params) {
+  int64_t signal_ndim = params.signal_ndim_;
+  // precision
+  DFTI_CONFIG_VALUE prec = params.scalar_type_ == ScalarType::Float ? DFTI_SINGLE : DFTI_DOUBLE;
+  // signal type
+  DFTI_CONFIG_VALUE signal_type;
+  if (!params.inverse_) {
+    signal_type = params.complex_input_ ? DFTI_COMPLEX : DFTI_REAL;
+  } else {
+    signal_type = params.complex_output_ ? DFTI_COMPLEX : DFTI_REAL;
+  }
+  // create descriptor with signal size
+  std::vector<MKL_LONG> mkl_signal_sizes(params.signal_sizes_, params.signal_sizes_ + signal_ndim);
+  auto descriptor = std::make_shared<DftiDescriptor>();
+  descriptor->init(prec, signal_type, signal_ndim, mkl_signal_sizes.data());
+  // out of place FFT
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
+  // batch mode
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_NUMBER_OF_TRANSFORMS, (MKL_LONG) params.batch_));
+  // batch dim stride, i.e., dist between each data
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_INPUT_DISTANCE, (MKL_LONG) params.input_distance_));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_OUTPUT_DISTANCE, (MKL_LONG) params.output_distance_));
+  // signal strides
+  // first val is offset, set to zero (ignored)
+  std::vector<MKL_LONG> mkl_istrides(1 + signal_ndim, 0), mkl_ostrides(1 + signal_ndim, 0);
+  for (int64_t i = 0; i < signal_ndim; i++) {
+    mkl_istrides[i + 1] = params.input_strides_[i];
+    mkl_ostrides[i + 1] = params.output_strides_[i];
+  }
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
+  // if conjugate domain of real is involved, set standard CCE storage type
+  // this will become default in MKL in future
+  if (!params.complex_input_ || !params.complex_output_) {
+    MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
+  }
+  // rescale if needed by normalized flag or inverse transform
+  if (params.normalized_ || params.inverse_) {
+    auto signal_numel = std::accumulate(params.signal_sizes_, params.signal_sizes_ + signal_ndim,
+                                        (int64_t) 1, std::multiplies<int64_t>());
+    double double_scale;
+    if (params.normalized_) {
+      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
+    } else {
+      double_scale = 1.0 / static_cast<double>(signal_numel);
+    }
+    MKL_DFTI_CHECK(DftiSetValue(descriptor->get(),
+      params.inverse_ ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
+      prec == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
+  }
+  // finalize
+  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor->get()));
+  return descriptor;
+}
+
+// NOTE [ MKL FFT plan cache ]
+//
+// Creating and committing a DFTI descriptor dominates the cost of small
+// transforms, so committed descriptors are kept in an LRU cache keyed on
+// everything they depend on (see MKLFFTParams). Unlike the cuFFT cache, the
+// lock is only held for the lookup: the descriptor is shared and executed
+// outside of it, so concurrent transforms on different threads do not
+// serialize.
+static detail::MKLFFTParamsLRUCache plan_cache;
+static std::mutex plan_cache_mutex;
+
+int64_t _mkl_fft_get_plan_cache_max_size() {
+  std::lock_guard<std::mutex> guard(plan_cache_mutex);
+  return plan_cache.max_size();
+}
+
+void _mkl_fft_set_plan_cache_max_size(int64_t max_size) {
+  std::lock_guard<std::mutex> guard(plan_cache_mutex);
+  plan_cache.resize(max_size);
+}
+
+int64_t _mkl_fft_get_plan_cache_size() {
+  std::lock_guard<std::mutex> guard(plan_cache_mutex);
+  return plan_cache.size();
+}
+
+void _mkl_fft_clear_plan_cache() {
+  std::lock_guard<std::mutex> guard(plan_cache_mutex);
+  plan_cache.clear();
+}
+
 // MKL DFTI
 Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
                 bool complex_input, bool complex_output,
                 bool inverse, IntList checked_signal_sizes,
                 bool normalized, bool onesided,
                 IntList output_sizes) {
-  int64_t batch = self.size(0);
   Tensor input = self;
   // real/imag dimension must aligned when viewed as of complex type
   if (complex_input) {
@@ -209,75 +313,34 @@ Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
   }
   Tensor output = at::empty(output_sizes, input.options());
 
-  // precision
-  DFTI_CONFIG_VALUE prec;
-  if (input.type().scalarType() == ScalarType::Float) {
-    prec = DFTI_SINGLE;
-  } else if (input.type().scalarType() == ScalarType::Double) {
-    prec = DFTI_DOUBLE;
-  } else {
-    std::ostringstream ss;
-    ss << "MKL FFT doesn't support tensor of type: "
-       << at::toString(input.type().scalarType());
-    AT_ERROR(ss.str());
-  }
-  // signal type
-  DFTI_CONFIG_VALUE signal_type;
-  if (!inverse) {
-    signal_type = complex_input ? DFTI_COMPLEX : DFTI_REAL;
-  } else {
-    signal_type = complex_output ? DFTI_COMPLEX : DFTI_REAL;
-  }
-  // create descriptor with signal size
-  std::vector<MKL_LONG> mkl_signal_sizes(checked_signal_sizes.begin(), checked_signal_sizes.end());
-  DftiDescriptor descriptor;
-  descriptor.init(prec, signal_type, signal_ndim, mkl_signal_sizes.data());
-  // out of place FFT
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
-  // batch mode
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_NUMBER_OF_TRANSFORMS, batch));
+  AT_CHECK(input.type().scalarType() == ScalarType::Float ||
+           input.type().scalarType() == ScalarType::Double,
+           "MKL FFT doesn't support tensor of type: ",
+           at::toString(input.type().scalarType()));
 
-  auto istrides = input.strides();
-  auto ostrides = output.strides();
-  // batch dim stride, i.e., dist between each data
-  MKL_LONG idist = complex_input ? istrides[0] >> 1 : istrides[0];
-  MKL_LONG odist = complex_output ? ostrides[0] >> 1 : ostrides[0];
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_DISTANCE, idist));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_DISTANCE, odist));
-  // signal strides
-  // first val is offset, set to zero (ignored)
-  std::vector<MKL_LONG> mkl_istrides(1 + signal_ndim, 0), mkl_ostrides(1 + signal_ndim, 0);
-  for (int64_t i = 1; i <= signal_ndim; i++) {
-    mkl_istrides[i] = complex_input ? istrides[i] >> 1 : istrides[i];
-    mkl_ostrides[i] = complex_output ? ostrides[i] >> 1 : ostrides[i];
-  }
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
-  // if conjugate domain of real is involved, set standard CCE storage type
-  // this will become default in MKL in future
-  if (!complex_input || !complex_output) {
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
-  }
-  // rescale if needed by normalized flag or inverse transform
-  if (normalized || inverse) {
-    auto signal_numel = at::prod_intlist(checked_signal_sizes);
-    double double_scale;
-    if (normalized) {
-      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
-    } else {
-      double_scale = 1.0 / static_cast<double>(signal_numel);
+  detail::MKLFFTParams params;
+  detail::setMKLFFTParams(&params, input, output, signal_ndim, complex_input,
+                          complex_output, inverse, checked_signal_sizes, normalized);
+
+  // See NOTE [ MKL FFT plan cache ]. The max_size read is not locked for perf
+  // reason; it is checked again after acquiring the lock.
+  std::shared_ptr<DftiDescriptor> descriptor;
+  if (plan_cache.max_size() > 0) {
+    std::lock_guard<std::mutex> guard(plan_cache_mutex);
+    if (plan_cache.max_size() > 0) {
+      descriptor = plan_cache.try_emplace_value(params, [&params]() {
+        return _make_dfti_descriptor(params);
+      });
     }
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(),
-      inverse ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
-      prec == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
   }
-  // finalize
-  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor.get()));
+  if (!descriptor) {
+    descriptor = _make_dfti_descriptor(params);
+  }
   // run
   if (!inverse) {
-    MKL_DFTI_CHECK(DftiComputeForward(descriptor.get(), input.data_ptr(), output.data_ptr()));
+    MKL_DFTI_CHECK(DftiComputeForward(descriptor->get(), input.data_ptr(), output.data_ptr()));
   } else {
-    MKL_DFTI_CHECK(DftiComputeBackward(descriptor.get(), input.data_ptr(), output.data_ptr()));
+    MKL_DFTI_CHECK(DftiComputeBackward(descriptor->get(), input.data_ptr(), output.data_ptr()));
   }
   // now if needed, fill out the other half using Hermitian symmetry dim
   if (!complex_input && complex_output && !onesided) {
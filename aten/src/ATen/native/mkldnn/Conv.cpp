@@ -35,6 +35,10 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_backward(
 #else // AT_MKLDNN_EBABLED
 
 #include <ATen/mkldnn/Runtime.h>
+#include <ATen/native/utils/ParamsHash.h>
+
+#include <cstring>
+#include <unordered_map>
 
 using namespace mkldnn;
 
@@ -66,17 +70,62 @@ std::vector<int64_t> conv_output_size(
   return output_size;
 }
 
-at::Tensor mkldnn_convolution(
+// The forward convolutions of a thread are cached by their parameters. The
+// primitives of MKL-DNN are JIT-compiled when they are created, so creating
+// them for every call costs more than the convolution for small inputs. A
+// cached convolution is run on new tensors by rebinding the data handles of
+// its plain memories; its blocked input, weight and output buffers are
+// reused, hence the per thread cache.
+struct ConvolutionParams {
+  int input_size[2 + max_dim];
+  int weight_size[2 + max_dim];
+  int padding[max_dim];
+  int stride[max_dim];
+  int64_t groups;
+  bool bias_defined;
+};
+
+// NB: This can't be a constructor, because then ConvolutionParams
+// would not be a POD anymore.
+void setConvolutionParams(
+    ConvolutionParams* params, const at::Tensor& input,
+    const at::Tensor& weight, IntList padding, IntList stride,
+    int64_t groups, bool bias_defined) {
+  memset(params, 0, sizeof(ConvolutionParams));
+  for (int i = 0; i != input.dim(); ++i) {
+    params->input_size[i] = (int) input.size(i);
+    params->weight_size[i] = (int) weight.size(i);
+  }
+  for (size_t i = 0; i != padding.size(); ++i) {
+    params->padding[i] = padding[i];
+    params->stride[i] = stride[i];
+  }
+  params->groups = groups;
+  params->bias_defined = bias_defined;
+}
+
+struct ConvolutionForward {
+  // Memories in the layouts of the ATen tensors
+  std::shared_ptr<memory> input_usr_memory;
+  std::shared_ptr<memory> weight_usr_memory;
+  std::shared_ptr<memory> bias_usr_memory;
+  std::shared_ptr<memory> output_usr_memory;
+  // The reorders into and out of the layouts picked by MKL-DNN, and the
+  // convolution itself
+  std::vector<primitive> net;
+};
+
+// Distinct shapes are bounded in practice, but not by anything in here
+constexpr size_t max_cached_convolutions = 256;
+
+ConvolutionForward createConvolutionForward(
     const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
-    IntList padding, IntList stride, IntList dilation, int64_t groups)
+    const at::Tensor& output, IntList padding, IntList stride, int64_t groups)
 {
-  auto output = at::empty(conv_output_size(
-    input.sizes(), weight.sizes(), padding, stride, dilation, groups), input.options());
-
   auto cpu_engine = CpuEngine::Instance().get_engine();
 
   int32_t g = groups;
-  
+
   int32_t n = input.size(0);
   int32_t ic = input.size(1);
   int32_t ih = input.size(2);
@@ -127,53 +176,84 @@ at::Tensor mkldnn_convolution(
   conv_forward_pd.reset(new convolution_forward::primitive_desc(
     *conv_forward_desc, cpu_engine));
 
-  auto input_usr_memory = memory({{{input_tz}, data_t, format_nchw}, cpu_engine},
-    input.data_ptr());
-  auto weight_usr_memory = memory({{{weight_tz}, data_t,  format_weight}, cpu_engine},
-    weight.data_ptr());
-  auto output_usr_memory = memory({{{output_tz}, data_t, format_nchw}, cpu_engine},
-    output.data_ptr());
-
-  std::vector<primitive> net;
+  ConvolutionForward forward;
+  forward.input_usr_memory = std::make_shared<memory>(memory::primitive_desc(
+    {{input_tz}, data_t, format_nchw}, cpu_engine), input.data_ptr());
+  forward.weight_usr_memory = std::make_shared<memory>(memory::primitive_desc(
+    {{weight_tz}, data_t, format_weight}, cpu_engine), weight.data_ptr());
+  forward.output_usr_memory = std::make_shared<memory>(memory::primitive_desc(
+    {{output_tz}, data_t, format_nchw}, cpu_engine), output.data_ptr());
+  auto& net = forward.net;
 
   auto input_pd = conv_forward_pd->src_primitive_desc();
-  auto input_memory = input_usr_memory;
-  if (input_usr_memory.get_primitive_desc() != memory::primitive_desc(input_pd)) {
+  auto input_memory = *forward.input_usr_memory;
+  if (input_memory.get_primitive_desc() != memory::primitive_desc(input_pd)) {
     input_memory = memory(input_pd);
-    net.push_back(reorder(input_usr_memory, input_memory));
+    net.push_back(reorder(*forward.input_usr_memory, input_memory));
   }
 
   auto weight_pd = conv_forward_pd->weights_primitive_desc();
-  auto weight_memory = weight_usr_memory;
-  if (weight_usr_memory.get_primitive_desc() != memory::primitive_desc(weight_pd)) {
+  auto weight_memory = *forward.weight_usr_memory;
+  if (weight_memory.get_primitive_desc() != memory::primitive_desc(weight_pd)) {
     weight_memory = memory(weight_pd);
-    net.push_back(reorder(weight_usr_memory, weight_memory));
+    net.push_back(reorder(*forward.weight_usr_memory, weight_memory));
   }
 
   auto output_pd = conv_forward_pd->dst_primitive_desc();
-  auto output_memory = output_usr_memory;
-  if (output_usr_memory.get_primitive_desc() != memory::primitive_desc(output_pd)) {
+  auto output_memory = *forward.output_usr_memory;
+  if (output_memory.get_primitive_desc() != memory::primitive_desc(output_pd)) {
     output_memory = memory(output_pd);
   }
 
   std::shared_ptr<convolution_forward> conv_forward;
-  std::shared_ptr<memory> bias_usr_memory;
   if (bias.defined()) {
-    bias_usr_memory.reset(new memory({{{bias_tz}, data_t, format_x}, cpu_engine},
-      bias.data_ptr()));
+    forward.bias_usr_memory = std::make_shared<memory>(memory::primitive_desc(
+      {{bias_tz}, data_t, format_x}, cpu_engine), bias.data_ptr());
     conv_forward.reset(new convolution_forward(*conv_forward_pd, input_memory,
-      weight_memory, *bias_usr_memory, output_memory));
+      weight_memory, *forward.bias_usr_memory, output_memory));
   } else {
     conv_forward.reset(new convolution_forward(*conv_forward_pd, input_memory,
       weight_memory, output_memory));
   }
   net.push_back(*conv_forward);
 
-  if (output_memory != output_usr_memory) {
-    net.push_back(reorder(output_memory, output_usr_memory));
+  if (output_memory != *forward.output_usr_memory) {
+    net.push_back(reorder(output_memory, *forward.output_usr_memory));
   }
+  return forward;
+}
 
-  Stream::Instance().get_stream().submit(net);
+at::Tensor mkldnn_convolution(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntList padding, IntList stride, IntList dilation, int64_t groups)
+{
+  static thread_local std::unordered_map<
+      ConvolutionParams, ConvolutionForward,
+      ParamsHash<ConvolutionParams>, ParamsEqual<ConvolutionParams>> cache;
+
+  auto output = at::empty(conv_output_size(
+    input.sizes(), weight.sizes(), padding, stride, dilation, groups), input.options());
+
+  ConvolutionParams params;
+  setConvolutionParams(
+    &params, input, weight, padding, stride, groups, bias.defined());
+  auto it = cache.find(params);
+  if (it == cache.end()) {
+    if (cache.size() >= max_cached_convolutions) {
+      cache.clear();
+    }
+    it = cache.emplace(params, createConvolutionForward(
+      input, weight, bias, output, padding, stride, groups)).first;
+  }
+
+  auto& forward = it->second;
+  forward.input_usr_memory->set_data_handle(input.data_ptr());
+  forward.weight_usr_memory->set_data_handle(weight.data_ptr());
+  forward.output_usr_memory->set_data_handle(output.data_ptr());
+  if (bias.defined()) {
+    forward.bias_usr_memory->set_data_handle(bias.data_ptr());
+  }
+  Stream::Instance().get_stream().submit(forward.net);
 
   return output;
 }
@@ -6,8 +6,15 @@
 #include <ATen/InitialTensorOptions.h>
 #include <ATen/native/sparse/SparseUtils.h>
 
+#include <ATen/Parallel.h>
+
 #include <TH/THBlasUtils.h>
 
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
 namespace at { namespace native {
 
 /******************************************************************************
@@ -308,41 +315,66 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   Tensor newValues = at::empty(values.sizes(), values.options());
   _alias_into_sparse(dst, newIndices, newValues);
 
-  LongTensor indicesBuffer;
-  LongTensor indicesPermutation;
-  std::tie(indicesBuffer, indicesPermutation) = indices_scalar.sort(0);
-  // NB: The accessor accesses here rely on self._nnz() > 0 (tested earlier in this function)
+  // Hash-merge: find the distinct linearized indices with a hash map, sort
+  // only those, then accumulate every value row into the slot of its index.
+  // Sparse gradients usually repeat a few indices many times, so this sorts
+  // far fewer keys than sorting all nnz entries would.
+  auto indicesScalarAccessor = indices_scalar.accessor<int64_t, 1>();
+  std::unordered_map<int64_t, int64_t> uniqueIds;
+  uniqueIds.reserve(nnz);
+  std::vector<int64_t> uniqueKeys;
+  std::vector<int64_t> firstPos;
+  std::vector<int64_t> slotOf(nnz);
+  for (int64_t j = 0; j < nnz; j++) {
+    auto it = uniqueIds.emplace(indicesScalarAccessor[j], uniqueKeys.size());
+    if (it.second) {
+      uniqueKeys.push_back(indicesScalarAccessor[j]);
+      firstPos.push_back(j);
+    }
+    slotOf[j] = it.first->second;
+  }
+  int64_t numUnique = uniqueKeys.size();
+  std::vector<int64_t> order(numUnique);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return uniqueKeys[a] < uniqueKeys[b];
+  });
+
   auto newIndicesAccessor = newIndices.accessor<int64_t, 2>();
   auto indicesAccessor = indices.accessor<int64_t, 2>();
-  auto indicesPermutationAccessor = indicesPermutation.accessor<int64_t, 1>();
-  auto indicesBufferAccessor = indicesBuffer.accessor<int64_t, 1>();
-
-  int64_t i = -1;
-  AT_DISPATCH_ALL_TYPES(
-      values.type(), "coalesce", [&] {
-        int64_t prev = -1;
-        int64_t blockSize = values.stride(0);
-        scalar_t* values_ptr = values.data<scalar_t>();
-        scalar_t* newValues_ptr = newValues.data<scalar_t>();
-        for (int64_t j = 0; j < nnz; j++) {
-          int64_t pos = indicesPermutationAccessor[j];
-          int64_t curr = indicesBufferAccessor[j];
-          if (curr == prev) {
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
-            }
-          } else {
-            ++i;
-            for (int64_t d = 0; d < sparseDims; d++) {
-              newIndicesAccessor[d][i] = indicesAccessor[d][pos];
-            }
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_copy<scalar_t>(blockSize, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+  std::vector<int64_t> rank(numUnique);
+  for (int64_t k = 0; k < numUnique; k++) {
+    rank[order[k]] = k;
+    for (int64_t d = 0; d < sparseDims; d++) {
+      newIndicesAccessor[d][k] = indicesAccessor[d][firstPos[order[k]]];
+    }
+  }
+  for (int64_t j = 0; j < nnz; j++) {
+    slotOf[j] = rank[slotOf[j]];
+  }
+
+  int64_t blockSize = values.stride(0);
+  if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
+    newValues.narrow(0, 0, numUnique).zero_();
+    AT_DISPATCH_ALL_TYPES(
+        values.type(), "coalesce", [&] {
+          scalar_t* values_ptr = values.data<scalar_t>();
+          scalar_t* newValues_ptr = newValues.data<scalar_t>();
+          // Threads split the columns of the value rows, so no two threads
+          // ever write the same output element.
+          int64_t grain_size = std::max<int64_t>(internal::GRAIN_SIZE / nnz, 1);
+          parallel_for(0, blockSize, grain_size, [&](int64_t col_begin, int64_t col_end) {
+            for (int64_t j = 0; j < nnz; j++) {
+              scalar_t* src = values_ptr + j * blockSize;
+              scalar_t* dst = newValues_ptr + slotOf[j] * blockSize;
+              for (int64_t c = col_begin; c < col_end; c++) {
+                dst[c] += src[c];
+              }
             }
-          }
-          prev = curr;
-        }
-    });
+          });
+      });
+  }
+  int64_t i = numUnique - 1;
 
   _get_sparse_impl(dst)->set_coalesced(true);
   _get_sparse_impl(dst)->set_nnz_and_narrow(i + 1);
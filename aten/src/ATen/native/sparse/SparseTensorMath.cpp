@@ -4,6 +4,7 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/InitialTensorOptions.h>
 #include <ATen/native/sparse/SparseUtils.h>
+#include <ATen/Parallel.h>
 
 #include <TH/THBlasUtils.h>
 
@@ -461,10 +462,9 @@ SparseTensor& mul_out_sparse_cpu(SparseTensor& r, const Tensor& t_, const Tensor
 // addmm(Tensor, SparseTensorRef, Tensor, Scalar, Scalar)  [broadcasts]
 // --------------------------------------------------------------------
 
-// NB: OMP pragmas have to get their own functions; can't put them in lambdas
 template <typename scalar_t>
 void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, Scalar beta, const Tensor& t, Scalar alpha, const Tensor& csr, const Tensor& indices, const Tensor& values, const Tensor& dense) {
-  int64_t h, i;
+  int64_t i;
 
   // r_ = alpha * sparse * dense
   scalar_t cast_alpha = alpha.to<scalar_t>();
@@ -490,23 +490,31 @@ void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j,
   int64_t dense_stride1 = dense.stride(1);
   int64_t r_stride0 = r.stride(0);
   int64_t r_stride1 = r.stride(1);
-#pragma omp parallel for private(h, i) schedule(static) if (nnz > 10000)
-  for (h = 0; h < dim_i; h++) {
-    int64_t i_start = csr_accessor[h];
-    int64_t i_end = csr_accessor[h+1];
-    for (i = i_start; i < i_end; i++) {
-      scalar_t val = values_accessor[i];
-      int64_t col = indices_accessor[1][i];
-      if (col >= 0 && col < dim_j) {
+  // Validate up front: errors cannot propagate out of a parallel region.
+  for (i = 0; i < nnz; i++) {
+    int64_t col = indices_accessor[1][i];
+    if (col < 0 || col >= dim_j) {
+      AT_ERROR("addmm: index out of bound: ", col, " not between 1 and ", dim_j);
+    }
+  }
+
+  // Each output row only depends on the nonzeros of the same sparse row, so
+  // rows are split across threads. The grain size is based on the average
+  // work per row, nnz / dim_i row updates of length dim_k.
+  int64_t row_cost = std::max<int64_t>(divup(nnz, dim_i) * dim_k, 1);
+  int64_t grain_size = std::max<int64_t>(internal::GRAIN_SIZE / row_cost, 1);
+  parallel_for(0, dim_i, grain_size, [&](int64_t row_begin, int64_t row_end) {
+    for (int64_t row = row_begin; row < row_end; row++) {
+      int64_t i_start = csr_accessor[row];
+      int64_t i_end = csr_accessor[row + 1];
+      for (int64_t k = i_start; k < i_end; k++) {
         THBlas_axpy<scalar_t>(dim_k,
-            cast_alpha * val,
-            dense_ptr + col * dense_stride0, dense_stride1,
-            r_ptr + h * r_stride0, r_stride1);
-      } else {
-        AT_ERROR("addmm: index out of bound: ", col, " not between 1 and ", dim_j);
+            cast_alpha * values_accessor[k],
+            dense_ptr + indices_accessor[1][k] * dense_stride0, dense_stride1,
+            r_ptr + row * r_stride0, r_stride1);
       }
     }
-  }
+  });
 };
 
 Tensor& s_addmm_out_sparse_dense_cpu(
@@ -126,6 +126,15 @@ static void test(Type& type) {
     CATCH_REQUIRE(b.strides().equals({5, 1, 20}));
   }
 
+  CATCH_SECTION("more dims than inline") {
+    // Sizes and strides past the inline capacity of DimVector
+    Tensor a = rand({2, 1, 3, 1, 2, 2, 1}, type);
+    Tensor b = a.transpose(0, 6).unsqueeze(2);
+    CATCH_REQUIRE(b.sizes().equals({1, 1, 1, 3, 1, 2, 2, 2}));
+    CATCH_REQUIRE(b.strides().equals({1, 12, 12, 4, 4, 2, 1, 12}));
+    CATCH_REQUIRE(b.squeeze().equal(a.squeeze().permute({1, 2, 3, 0})));
+  }
+
   CATCH_SECTION("mm") {
     Tensor a = rand({3, 4}, type);
     Tensor b = rand({4}, type);
@@ -0,0 +1,57 @@
+#include "gtest/gtest.h"
+
+#include "ATen/ATen.h"
+#include "ATen/CPUCachingAllocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+TEST(CPUCachingAllocatorTest, ReusesFreedBlocks) {
+  auto* allocator = at::getCPUCachingAllocator();
+  void* first;
+  {
+    auto ptr = allocator->allocate(1000);
+    first = ptr.get();
+    std::memset(first, 0, 1000);
+  }
+  // same size class (1024 bytes)
+  auto ptr = allocator->allocate(900);
+  ASSERT_EQ(ptr.get(), first);
+  at::emptyCPUCachingAllocatorCache();
+}
+
+TEST(CPUCachingAllocatorTest, Alignment) {
+  auto* allocator = at::getCPUCachingAllocator();
+  for (size_t size : {1, 64, 4097, 1 << 20, (1 << 20) + 1, 4 << 20}) {
+    auto ptr = allocator->allocate(size);
+    ASSERT_NE(ptr.get(), nullptr);
+    if (size > 5120) {
+      ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr.get()) % 64, 0);
+    }
+    std::memset(ptr.get(), 1, size);
+  }
+  ASSERT_EQ(allocator->allocate(0).get(), nullptr);
+  at::emptyCPUCachingAllocatorCache();
+}
+
+TEST(CPUCachingAllocatorTest, FreeOnOtherThread) {
+  auto* allocator = at::getCPUCachingAllocator();
+  auto ptr = allocator->allocate(4096);
+  std::thread t([&]() { ptr.clear(); });
+  t.join();
+  ASSERT_EQ(ptr.get(), nullptr);
+}
+
+TEST(CPUCachingAllocatorTest, Storage) {
+  at::Storage storage(
+      at::scalarTypeToTypeMeta(at::kFloat),
+      256,
+      at::getCPUCachingAllocator(),
+      /*resizable=*/true);
+  auto t = at::empty({0}, at::kFloat).set_(storage);
+  t.resize_({16, 16}).fill_(2);
+  ASSERT_EQ(t.sum().toCFloat(), 512);
+  t.resize_({1024}).fill_(1);
+  ASSERT_EQ(t.sum().toCFloat(), 1024);
+}
@@ -0,0 +1,37 @@
+#include "gtest/gtest.h"
+
+#include "ATen/ATen.h"
+#include "ATen/NUMA.h"
+
+#include <cstring>
+
+TEST(NUMATest, GuardSetsAndRestoresNode) {
+  ASSERT_EQ(at::get_numa_node(), -1);
+  {
+    at::NUMAGuard guard(0);
+    ASSERT_EQ(at::get_numa_node(), 0);
+    {
+      at::NUMAGuard inner(-1);
+      ASSERT_EQ(at::get_numa_node(), -1);
+    }
+    ASSERT_EQ(at::get_numa_node(), 0);
+  }
+  ASSERT_EQ(at::get_numa_node(), -1);
+}
+
+TEST(NUMATest, RejectsUnavailableNode) {
+  if (!at::is_numa_available()) {
+    return;
+  }
+  ASSERT_ANY_THROW(at::NUMAGuard guard(at::get_num_numa_nodes()));
+}
+
+TEST(NUMATest, AllocatesOnGuardNode) {
+  at::NUMAGuard guard(0);
+  auto t = at::ones({1 << 20}, at::kFloat);
+  ASSERT_EQ(t.sum().item<float>(), float(1 << 20));
+  if (at::is_numa_available()) {
+    // Middle of the buffer, away from partially bound pages at the ends.
+    ASSERT_EQ(at::get_numa_node_of(t.data<float>() + (1 << 19)), 0);
+  }
+}
@@ -3,6 +3,8 @@
 #include "ATen/cuda/CUDAContext.h"
 #include "ATen/cuda/CUDAGuard.h"
 #include "ATen/cuda/CUDAEvent.h"
+#include "ATen/cuda/CUDAGraph.h"
+#include "ATen/ATen.h"
 
 #include "cuda_runtime.h"
 
@@ -284,3 +286,32 @@ TEST(TestStream, CrossDeviceTest) {
   cudaStreamSynchronize(stream0);
   ASSERT_TRUE(event0.happened());
 }
+
+// Captures a few kernels and replays them on new input values
+TEST(TestStream, CUDAGraphReplayTest) {
+#if CUDART_VERSION >= 10000
+  const auto stream = at::cuda::createCUDAStream();
+  at::cuda::CUDAGuard guard(stream);
+
+  auto x = at::ones({1024}, at::kCUDA);
+  at::cuda::CUDAGraph graph;
+  graph.capture_begin();
+  ASSERT_TRUE(stream.is_capturing());
+  auto y = (x * 2).add_(1);
+  graph.capture_end();
+  ASSERT_FALSE(stream.is_capturing());
+  ASSERT_TRUE(graph.has_graph());
+
+  for (int i = 0; i < 3; i++) {
+    x.fill_(i);
+    graph.replay();
+    cudaStreamSynchronize(stream);
+    ASSERT_TRUE(y.equal(at::full({1024}, 2 * i + 1, at::kCUDA)));
+  }
+
+  // the default stream cannot be captured
+  at::cuda::setCurrentCUDAStream(at::cuda::getDefaultCUDAStream());
+  at::cuda::CUDAGraph default_stream_graph;
+  ASSERT_ANY_THROW(default_stream_graph.capture_begin());
+#endif
+}
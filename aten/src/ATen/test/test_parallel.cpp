@@ -2,7 +2,9 @@
 
 #include "ATen/ATen.h"
 #include "ATen/DLConvertor.h"
+#include "ATen/Parallel.h"
 
+#include <atomic>
 #include <iostream>
 #include <string.h>
 #include <sstream>
@@ -24,3 +26,16 @@ TEST(TestParallel, TestParallel) {
   as[2] = 0;
   ASSERT_TRUE(a.sum(0).equal(as));
 }
+
+TEST(TestParallel, NestedParallelFor) {
+  set_num_threads(4);
+  std::atomic<int64_t> sum(0);
+  at::parallel_for(0, 1000, 10, [&](int64_t begin, int64_t end) {
+    at::parallel_for(begin, end, 1, [&](int64_t inner_begin, int64_t inner_end) {
+      for (int64_t i = inner_begin; i < inner_end; i++) {
+        sum += i;
+      }
+    });
+  });
+  ASSERT_EQ(sum.load(), 1000 * 999 / 2);
+}
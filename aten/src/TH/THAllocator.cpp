@@ -6,6 +6,11 @@
 #endif
 
 #include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
 #if ATOMIC_INT_LOCK_FREE == 2
 #define TH_ATOMIC_IPC_REFCOUNT 1
 #endif
@@ -561,3 +566,266 @@ at::DataPtr THRefcountedMapAllocator::makeDataPtr(WithFd, const char *filename,
 void* THRefcountedMapAllocator::data() const {
   return static_cast<void*>(static_cast<char*>(base_ptr_) + TH_ALLOC_ALIGNMENT);
 }
+
+#if defined(HAVE_MMAP) && defined(HAVE_SHM_OPEN) && defined(HAVE_SHM_UNLINK) && defined(TH_ATOMIC_IPC_REFCOUNT)
+
+// Segments of this process that no storage of this process uses, most
+// recently freed first. The least recently freed segments are unmapped past
+// kMaxPooledSegments.
+struct THMapPool {
+  static constexpr size_t kMaxPooledSegments = 64;
+
+  std::mutex mutex;
+  int pid = -1;
+  std::deque<THPooledMapAllocator*> free_segments;
+
+  // A forked child does not reuse the segments of its parent. Requires the
+  // lock.
+  void checkPid() {
+    int current_pid = getpid();
+    if (pid == current_pid) {
+      return;
+    }
+    for (auto* segment : free_segments) {
+      delete segment;
+    }
+    free_segments.clear();
+    pid = current_pid;
+  }
+
+  // The smallest unused segment that can hold size bytes without wasting
+  // more than half of it
+  THPooledMapAllocator* acquire(size_t size) {
+    std::lock_guard<std::mutex> guard(mutex);
+    checkPid();
+    auto best = free_segments.end();
+    for (auto it = free_segments.begin(); it != free_segments.end(); ++it) {
+      size_t capacity = (*it)->capacity();
+      if (capacity < size || capacity / 2 > size || (*it)->refcount() != 0) {
+        continue;
+      }
+      if (best == free_segments.end() || capacity < (*best)->capacity()) {
+        best = it;
+      }
+    }
+    if (best == free_segments.end()) {
+      return nullptr;
+    }
+    THPooledMapAllocator* segment = *best;
+    free_segments.erase(best);
+    segment->incref();
+    segment->counted_ = true;
+    return segment;
+  }
+
+  void release(THPooledMapAllocator* segment) {
+    std::lock_guard<std::mutex> guard(mutex);
+    checkPid();
+    if (segment->pid_ != pid) {
+      delete segment;
+      return;
+    }
+    segment->decref();
+    segment->counted_ = false;
+    free_segments.push_front(segment);
+    if (free_segments.size() > kMaxPooledSegments) {
+      delete free_segments.back();
+      free_segments.pop_back();
+    }
+  }
+
+  void trim() {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto* segment : free_segments) {
+      delete segment;
+    }
+    free_segments.clear();
+  }
+
+  static THMapPool& get() {
+    // Leaked, so that the storages freed at exit can still return to it
+    static THMapPool* pool = new THMapPool();
+    return *pool;
+  }
+
+  static void deleteSegment(void* ptr) {
+    auto* segment = static_cast<THPooledMapAllocator*>(ptr);
+    if (segment->pooled_) {
+      get().release(segment);
+    } else {
+      delete segment;
+    }
+  }
+};
+
+constexpr size_t THMapPool::kMaxPooledSegments;
+
+// Size of a segment holding size bytes of data, in whole pages
+static size_t THPooledSegmentSize(size_t size) {
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t total = size + TH_ALLOC_ALIGNMENT;
+  return (total + page_size - 1) / page_size * page_size;
+}
+
+// Returns -1 and sets errno on failure
+static int THTryNewPooledSegment(size_t size) {
+  static std::atomic<uint64_t> counter{0};
+  for (int attempt = 0;; ++attempt) {
+    std::string name = "/torch_pool_" + std::to_string(getpid()) + "_" +
+        std::to_string(counter++);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, (mode_t)0600);
+    if (fd == -1) {
+      // Left behind by a dead process with the same pid
+      if (errno == EEXIST && attempt < 16) {
+        continue;
+      }
+      return -1;
+    }
+    shm_unlink(name.c_str());
+#ifdef __linux__
+    // Reserves the pages now, so that a full /dev/shm fails here rather than
+    // with a SIGBUS when the storage is first written
+    int err = posix_fallocate(fd, 0, size);
+#else
+    int err = ftruncate(fd, size) == -1 ? errno : 0;
+#endif
+    if (err != 0) {
+      ::close(fd);
+      errno = err;
+      return -1;
+    }
+    return fd;
+  }
+}
+
+static int THNewPooledSegment(size_t size) {
+  int fd = THTryNewPooledSegment(size);
+  if (fd == -1 && (errno == ENOSPC || errno == EMFILE || errno == ENFILE)) {
+    // The unused segments of the pool may be what fills /dev/shm or the file
+    // descriptor table
+    THPooledMapAllocator::trimPool();
+    fd = THTryNewPooledSegment(size);
+  }
+  if (fd == -1) {
+    AT_ERROR(
+        "unable to allocate a shared memory segment of ", size, " bytes: ",
+        strerror(errno), ". /dev/shm may be full (e.g. increase the "
+        "--shm-size of a docker container) or the limit of open file "
+        "descriptors reached (see ulimit -n)");
+  }
+  return fd;
+}
+
+THPooledMapAllocator::THPooledMapAllocator(size_t size)
+  : THMapAllocator(
+        WITH_FD,
+        nullptr,
+        THNewPooledSegment(THPooledSegmentSize(size)),
+        TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_KEEPFD |
+            TH_ALLOCATOR_MAPPED_FROMFD,
+        THPooledSegmentSize(size)),
+    pid_(getpid()),
+    counted_(true),
+    pooled_(true) {
+  THMapInfo *map_info = static_cast<THMapInfo*>(base_ptr_);
+  new (&map_info->refcount) std::atomic<int>(1);
+}
+
+THPooledMapAllocator::THPooledMapAllocator(WithFd, int fd, size_t size)
+  : THMapAllocator(
+        WITH_FD,
+        nullptr,
+        fd,
+        TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_NOCREATE |
+            TH_ALLOCATOR_MAPPED_KEEPFD | TH_ALLOCATOR_MAPPED_FROMFD,
+        size + TH_ALLOC_ALIGNMENT),
+    pid_(getpid()),
+    counted_(true) {}
+
+THPooledMapAllocator* THPooledMapAllocator::fromDataPtr(const at::DataPtr& dptr) {
+  return dptr.cast_context<THPooledMapAllocator>(&THMapPool::deleteSegment);
+}
+
+at::DataPtr THPooledMapAllocator::makeDataPtr(size_t size, size_t* actual_size_out) {
+  THPooledMapAllocator* context = THMapPool::get().acquire(size);
+  if (!context) {
+    context = new THPooledMapAllocator(size);
+  }
+  if (actual_size_out) *actual_size_out = size;
+  return {context->data(), context, &THMapPool::deleteSegment, at::DeviceType::CPU};
+}
+
+at::DataPtr THPooledMapAllocator::makeDataPtr(WithFd, int fd, size_t size, size_t* actual_size_out) {
+  auto* context = new THPooledMapAllocator(WITH_FD, fd, size);
+  if (actual_size_out) *actual_size_out = size;
+  return {context->data(), context, &THMapPool::deleteSegment, at::DeviceType::CPU};
+}
+
+void THPooledMapAllocator::trimPool() {
+  THMapPool::get().trim();
+}
+
+void* THPooledMapAllocator::data() const {
+  return static_cast<void*>(static_cast<char*>(base_ptr_) + TH_ALLOC_ALIGNMENT);
+}
+
+size_t THPooledMapAllocator::capacity() const {
+  return size_ - TH_ALLOC_ALIGNMENT;
+}
+
+int THPooledMapAllocator::refcount() const {
+  return static_cast<THMapInfo*>(base_ptr_)->refcount.load();
+}
+
+void THPooledMapAllocator::incref() {
+  ++static_cast<THMapInfo*>(base_ptr_)->refcount;
+}
+
+int THPooledMapAllocator::decref() {
+  return --static_cast<THMapInfo*>(base_ptr_)->refcount == 0;
+}
+
+void THPooledMapAllocator::close() {
+  if (closed_) {
+    return;
+  }
+  if (base_ptr_ && counted_ && pid_ == getpid()) {
+    decref();
+  }
+  counted_ = false;
+  THMapAllocator::close();
+}
+
+#else
+
+THPooledMapAllocator::THPooledMapAllocator(size_t size)
+  : THMapAllocator(WITH_FD, nullptr, -1, 0, 0) {
+  AT_ERROR("pooled file mapping not supported on your system");
+}
+
+THPooledMapAllocator::THPooledMapAllocator(WithFd, int fd, size_t size)
+  : THMapAllocator(WITH_FD, nullptr, fd, 0, 0) {
+  AT_ERROR("pooled file mapping not supported on your system");
+}
+
+THPooledMapAllocator* THPooledMapAllocator::fromDataPtr(const at::DataPtr& dptr) {
+  return nullptr;
+}
+
+at::DataPtr THPooledMapAllocator::makeDataPtr(size_t size, size_t* actual_size_out) {
+  AT_ERROR("pooled file mapping not supported on your system");
+}
+
+at::DataPtr THPooledMapAllocator::makeDataPtr(WithFd, int fd, size_t size, size_t* actual_size_out) {
+  AT_ERROR("pooled file mapping not supported on your system");
+}
+
+void THPooledMapAllocator::trimPool() {}
+void* THPooledMapAllocator::data() const { return base_ptr_; }
+size_t THPooledMapAllocator::capacity() const { return 0; }
+int THPooledMapAllocator::refcount() const { return 0; }
+void THPooledMapAllocator::incref() {}
+int THPooledMapAllocator::decref() { return 0; }
+void THPooledMapAllocator::close() {}
+
+#endif
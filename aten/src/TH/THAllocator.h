@@ -110,4 +110,53 @@ protected:
   void initializeAlloc();
 };
 
+// Shared memory segment of a storage shared through a file descriptor. The
+// process that created the segment keeps it mapped when its storage is freed,
+// and reuses it for a later storage of a similar size once no other process
+// maps it anymore, e.g. for the batches of a DataLoader worker. This saves the
+// shm_open, ftruncate, mmap and page faults of a new segment per storage.
+//
+// Like for THRefcountedMapAllocator, the first TH_ALLOC_ALIGNMENT bytes of the
+// segment count its users in all processes: the storage of the creator, and
+// one per storage mapped from the file descriptor, which the sending side
+// counts with incref before sharing the descriptor.
+class CAFFE2_API THPooledMapAllocator : public THMapAllocator {
+ public:
+  // Creates a new segment of at least size bytes, which makeDataPtr recycles
+  THPooledMapAllocator(size_t size);
+  // Maps a segment shared by another process, and takes ownership of fd
+  THPooledMapAllocator(WithFd, int fd, size_t size);
+
+  static THPooledMapAllocator* fromDataPtr(const at::DataPtr&);
+  // Storage data in an unused segment of the pool of this process, or in a
+  // new segment
+  static at::DataPtr makeDataPtr(size_t size, size_t* actual_size_out);
+  static at::DataPtr makeDataPtr(WithFd, int fd, size_t size, size_t* actual_size_out);
+  // Unmaps the segments of the pool that no storage of this process uses
+  static void trimPool();
+
+  void* data() const override;
+  // Bytes of storage data that the segment can hold
+  size_t capacity() const;
+  // Number of users of the segment in all processes
+  int refcount() const;
+
+  void incref();
+  int decref();
+  void close() override;
+
+  virtual ~THPooledMapAllocator() { close(); }
+
+ private:
+  friend struct THMapPool;
+
+  // Process that mapped the segment, whose users the mapping counts. A forked
+  // child inherits the mapping but not the use of the segment.
+  int pid_ = -1;
+  // Whether the mapping currently counts as a user of the segment
+  bool counted_ = false;
+  // Whether the segment was created by, and returns to, the pool
+  bool pooled_ = false;
+};
+
 #endif // __cplusplus
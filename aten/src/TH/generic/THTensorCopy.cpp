@@ -15,16 +15,22 @@
 
 int THTensor_(copyTransposeValid)(THTensor *tensor, THTensor *src) {
   const int MIN_SZ = 60 * 60;
+  // src may be a transposed view of a larger matrix (e.g. x[:, :k].t()),
+  // so only require the column stride to cover a full column.
   return THTensor_(isContiguous)(tensor) &&
          !src->is_empty() &&
          THTensor_(nDimensionLegacyNoScalars)(src) == 2 &&
          THTensor_(stride)(src, 0) == 1 &&
-         THTensor_(stride)(src, 1) == THTensor_(size)(src, 0) &&
+         THTensor_(stride)(src, 1) >= THTensor_(size)(src, 0) &&
          THTensor_(nElement)(tensor) >= MIN_SZ;
 }
 
 // special case copy where tensor is contiguous and src is a transposed matrix
 // This can be generalized to most copies, but it's tricker
+//
+// The matrix is processed in BLOCK_SZ x BLOCK_SZ tiles that fit in L1. Each
+// horizontal band of tiles is independent, so bands are distributed across
+// threads, each using its own tile buffer.
 void THTensor_(copyTranspose)(THTensor *tensor, THTensor *src) {
 
 #ifdef TH_REAL_IS_BYTE
@@ -33,17 +39,22 @@ void THTensor_(copyTranspose)(THTensor *tensor, THTensor *src) {
   const int64_t BLOCK_SZ = 60;
 #endif
 
-  THTensor *buf = THTensor_(newWithSize2d)(BLOCK_SZ, BLOCK_SZ);
   scalar_t *sp = src->data<scalar_t>();
   scalar_t *rp = tensor->data<scalar_t>();
-  scalar_t *bp = buf->data<scalar_t>();
-
 
   int64_t NR = THTensor_(size)(src, 0);
   int64_t NC = THTensor_(size)(src, 1);
-  for (int64_t R = 0; R < NR; R += BLOCK_SZ) {
+  int64_t LD = THTensor_(stride)(src, 1);
+  int64_t num_bands = (NR + BLOCK_SZ - 1) / BLOCK_SZ;
+  int64_t band;
+#ifdef _OPENMP
+  #pragma omp parallel for if ((NR * NC > TH_OMP_OVERHEAD_THRESHOLD_COPY) && (!omp_in_parallel())) private(band)
+#endif
+  for (band = 0; band < num_bands; band++) {
+    scalar_t bp[BLOCK_SZ * BLOCK_SZ];
+    int64_t R = band * BLOCK_SZ;
     for (int64_t C = 0; C < NC; C += BLOCK_SZ) {
-      scalar_t *spo = sp + R + C * NR;
+      scalar_t *spo = sp + R + C * LD;
       scalar_t *rpo = rp + C + R * NC;
 
       int nr = std::min(NR - R, BLOCK_SZ);
@@ -51,7 +62,7 @@ void THTensor_(copyTranspose)(THTensor *tensor, THTensor *src) {
 
       // 1. copy columns from src to buf
       for (int c = 0; c < nc; c++) {
-        memcpy(bp + c * BLOCK_SZ, spo + c * NR, nr * sizeof(scalar_t));
+        memcpy(bp + c * BLOCK_SZ, spo + c * LD, nr * sizeof(scalar_t));
       }
 
       // 2. transpose buf in place
@@ -72,7 +83,6 @@ void THTensor_(copyTranspose)(THTensor *tensor, THTensor *src) {
       }
     }
   }
-  c10::raw::intrusive_ptr::decref(buf);
 }
 
 void THTensor_(copy)(THTensor *tensor, THTensor *src)
@@ -189,6 +199,26 @@ struct inter_copy_type<uint8_t> {
 template<typename T>
 using inter_copy_type_t = typename inter_copy_type<T>::type;
 
+// Converts n contiguous elements with a THVector conversion routine, split
+// across threads the same way as the same-type contiguous copy.
+template<typename dst_t, typename src_t>
+static void THTensor_convertContiguous(dst_t *dst, const src_t *src, ptrdiff_t n,
+                                       void (*convert)(dst_t *, const src_t *, const ptrdiff_t))
+{
+#ifdef _OPENMP
+  #pragma omp parallel if ( (n > TH_OMP_OVERHEAD_THRESHOLD_COPY) && (!omp_in_parallel()) )
+  {
+    size_t num_threads = omp_get_num_threads();
+    size_t tid = omp_get_thread_num();
+    ptrdiff_t offset = tid * (n / num_threads);
+    ptrdiff_t end = (tid == num_threads - 1) ? n : offset + n / num_threads;
+    convert(dst + offset, src + offset, end - offset);
+  }
+#else
+  convert(dst, src, n);
+#endif
+}
+
 #endif
 
 #define IMPLEMENT_THTensor_COPY(TYPENAMESRC, TYPE_SRC) \
@@ -204,8 +234,38 @@ IMPLEMENT_THTensor_COPY(Char, int8_t)
 IMPLEMENT_THTensor_COPY(Short, int16_t)
 IMPLEMENT_THTensor_COPY(Int, int32_t)
 IMPLEMENT_THTensor_COPY(Long, int64_t)
+#ifdef TH_REAL_IS_HALF
+void THTensor_(copyFloat)(THTensor *tensor, THFloatTensor *src)
+{
+  ptrdiff_t n = THTensor_(nElement)(tensor);
+  if (n == THFloatTensor_nElement(src) &&
+      THTensor_(isContiguous)(tensor) && THFloatTensor_isContiguous(src)) {
+    THTensor_convertContiguous(tensor->data<at::Half>(), src->data<float>(), n,
+                               &THFloatVector_copyToHalf);
+    return;
+  }
+  TH_TENSOR_APPLY2(scalar_t, tensor, float, src,
+                   *tensor_data = static_cast<scalar_t>(*src_data);)
+}
+#else
 IMPLEMENT_THTensor_COPY(Float, float)
+#endif
 IMPLEMENT_THTensor_COPY(Double, double)
+#ifdef TH_REAL_IS_FLOAT
+void THTensor_(copyHalf)(THTensor *tensor, THHalfTensor *src)
+{
+  ptrdiff_t n = THTensor_(nElement)(tensor);
+  if (n == THHalfTensor_nElement(src) &&
+      THTensor_(isContiguous)(tensor) && THHalfTensor_isContiguous(src)) {
+    THTensor_convertContiguous(tensor->data<float>(), src->data<at::Half>(), n,
+                               &THFloatVector_copyFromHalf);
+    return;
+  }
+  TH_TENSOR_APPLY2(scalar_t, tensor, at::Half, src,
+                   *tensor_data = static_cast<scalar_t>(*src_data);)
+}
+#else
 IMPLEMENT_THTensor_COPY(Half, at::Half)
+#endif
 
 #endif
@@ -202,6 +202,37 @@ void THTensor_(indexSelect)(THTensor *tensor, THTensor *src, int dim, THLongTens
         memcpy(tensor_data + i*rowsize, src_data + (index_data[i] - TH_INDEX_BASE)*rowsize, rowsize*sizeof(scalar_t));
     }
   }
+  else if (src->dim() > 1 && THTensor_(isContiguous)(src) && THTensor_(isContiguous)(tensor))
+  {
+    /* Contiguous, dim > 0: copy `inner`-sized blocks for every (outer, index)
+       pair instead of building a pair of slice tensors per index. */
+    int64_t src_dim_size = THTensor_sizeLegacyNoScalars(src, dim);
+    int64_t outer = 1, inner = 1, r;
+    int d;
+    for (d = 0; d < dim; d++)
+      outer *= THTensor_sizeLegacyNoScalars(src, d);
+    for (d = dim + 1; d < src->dim(); d++)
+      inner *= THTensor_sizeLegacyNoScalars(src, d);
+
+    int64_t max = src_dim_size - 1 + TH_INDEX_BASE;
+    for (i=0; i<numel; i++) {
+      if (index_data[i] < TH_INDEX_BASE || index_data[i] > max) {
+        THLongTensor_free(index);
+        THError("index out of range");
+      }
+    }
+
+    tensor_data = tensor->data<scalar_t>();
+    src_data = src->data<scalar_t>();
+    #pragma omp parallel for if(outer*numel*inner > TH_OMP_OVERHEAD_THRESHOLD) private(r)
+    for (r=0; r<outer*numel; r++) {
+      int64_t o = r / numel;
+      int64_t j = r % numel;
+      memcpy(tensor_data + r*inner,
+             src_data + (o*src_dim_size + index_data[j] - TH_INDEX_BASE)*inner,
+             inner*sizeof(scalar_t));
+    }
+  }
   else if (src->dim() <= 1)
   {
     for (i=0; i<numel; i++)
@@ -422,9 +453,34 @@ void THTensor_(indexFill)(THTensor *tensor, int dim, THLongTensor *index, scalar
   THLongTensor_free(index);
 }
 
+/* gather and scatterAdd visit index one slice along `dim` at a time, and a
+   slice only touches the matching slice of the other two tensors, so the
+   slices can be processed in parallel without synchronization. This computes
+   the offsets of the first element of slice number `slice` (counting over
+   the dimensions of index other than `dim`, last dimension fastest). */
+static void THTensor_(sliceOffsets)(int64_t slice, int dim, THLongTensor *index,
+                                    THTensor *t1, THTensor *t2,
+                                    int64_t *index_offset, int64_t *t1_offset, int64_t *t2_offset)
+{
+  int d;
+  *index_offset = *t1_offset = *t2_offset = 0;
+  for (d = THTensor_nDimensionLegacyNoScalars(index) - 1; d >= 0; d--) {
+    if (d == dim)
+      continue;
+    int64_t size = THTensor_sizeLegacyNoScalars(index, d);
+    int64_t coord = slice % size;
+    slice /= size;
+    *index_offset += coord * THTensor_strideLegacyNoScalars(index, d);
+    *t1_offset += coord * THTensor_strideLegacyNoScalars(t1, d);
+    *t2_offset += coord * THTensor_strideLegacyNoScalars(t2, d);
+  }
+}
+
 void THTensor_(gather)(THTensor *tensor, THTensor *src, int dim, THLongTensor *index)
 {
-  int64_t elems_per_row, i, idx;
+  int64_t elems_per_row, num_slices, slice;
+  int TH_TENSOR_DIM_APPLY_i;
+  int invalid = 0;
 
   THArgCheck(THLongTensor_nDimensionLegacyNoScalars(index) == THTensor_(nDimensionLegacyNoScalars)(src), 4,
              "Index tensor must have same dimensions as input tensor");
@@ -432,21 +488,36 @@ void THTensor_(gather)(THTensor *tensor, THTensor *src, int dim, THLongTensor *i
              "Index dimension is out of bounds");
   THArgCheck(THTensor_(nDimensionLegacyNoScalars)(src) == THTensor_(nDimensionLegacyNoScalars)(tensor), 2,
              "Input tensor must have same dimensions as output tensor");
+  TH_TENSOR_DIM_APPLY3_SIZE_EQ_EXCEPT_DIM(tensor, src, index, dim);
 
   elems_per_row = THTensor_sizeLegacyNoScalars(index, dim);
-
-  TH_TENSOR_DIM_APPLY3(scalar_t, tensor, scalar_t, src, int64_t, index, dim,
-                       TH_TENSOR_DIM_APPLY3_SIZE_EQ_EXCEPT_DIM,
-                       for (i = 0; i < elems_per_row; ++i)
-                       {
-                         idx = *(index_data + i*index_stride);
-                         if (idx < TH_INDEX_BASE || idx >= src_size + TH_INDEX_BASE)
-                         {
-                           THFree(TH_TENSOR_DIM_APPLY_counter);
-                           THError("Invalid index in gather");
-                         }
-                         *(tensor_data + i*tensor_stride) = src_data[(idx - TH_INDEX_BASE) * src_stride];
-                       })
+  if (elems_per_row == 0 || THLongTensor_nElement(index) == 0)
+    return;
+  num_slices = THLongTensor_nElement(index) / elems_per_row;
+
+  scalar_t *tensor_data = tensor->data<scalar_t>();
+  scalar_t *src_data = src->data<scalar_t>();
+  int64_t *index_data = THLongTensor_data(index);
+  int64_t tensor_stride = THTensor_strideLegacyNoScalars(tensor, dim);
+  int64_t src_stride = THTensor_strideLegacyNoScalars(src, dim);
+  int64_t index_stride = THTensor_strideLegacyNoScalars(index, dim);
+  int64_t src_size = THTensor_sizeLegacyNoScalars(src, dim);
+
+  #pragma omp parallel for if(num_slices * elems_per_row > TH_OMP_OVERHEAD_THRESHOLD) private(slice)
+  for (slice = 0; slice < num_slices; slice++) {
+    int64_t index_offset, tensor_offset, src_offset, i;
+    THTensor_(sliceOffsets)(slice, dim, index, tensor, src, &index_offset, &tensor_offset, &src_offset);
+    for (i = 0; i < elems_per_row; ++i) {
+      int64_t idx = index_data[index_offset + i*index_stride];
+      if (idx < TH_INDEX_BASE || idx >= src_size + TH_INDEX_BASE) {
+        invalid = 1;
+        break;
+      }
+      tensor_data[tensor_offset + i*tensor_stride] = src_data[src_offset + (idx - TH_INDEX_BASE) * src_stride];
+    }
+  }
+  if (invalid)
+    THError("Invalid index in gather");
 }
 
 void THTensor_(scatter)(THTensor *tensor, int dim, THLongTensor *index, THTensor *src)
@@ -477,28 +548,48 @@ void THTensor_(scatter)(THTensor *tensor, int dim, THLongTensor *index, THTensor
 
 void THTensor_(scatterAdd)(THTensor *tensor, int dim, THLongTensor *index, THTensor *src)
 {
-  int64_t elems_per_row, i, idx;
+  int64_t elems_per_row, num_slices, slice;
+  int TH_TENSOR_DIM_APPLY_i;
+  int invalid = 0;
 
   THArgCheck(dim < THTensor_(nDimensionLegacyNoScalars)(tensor), 2, "Index dimension is out of bounds");
   THArgCheck(THLongTensor_nDimensionLegacyNoScalars(index) == THTensor_(nDimensionLegacyNoScalars)(tensor), 3,
              "Index tensor must have same dimensions as output tensor");
   THArgCheck(THTensor_(nDimensionLegacyNoScalars)(src) == THTensor_(nDimensionLegacyNoScalars)(tensor), 4,
              "Input tensor must have same dimensions as output tensor");
+  THArgCheck(dim >= 0, 2, "Index dimension is out of bounds");
+  TH_TENSOR_DIM_APPLY3_SIZE_SCATTER(tensor, src, index, dim);
 
   elems_per_row = THTensor_sizeLegacyNoScalars(index, dim);
-
-  TH_TENSOR_DIM_APPLY3(scalar_t, tensor, scalar_t, src, int64_t, index, dim,
-                       TH_TENSOR_DIM_APPLY3_SIZE_SCATTER,
-                       for (i = 0; i < elems_per_row; ++i)
-                       {
-                         idx = *(index_data + i*index_stride);
-                         if (idx < TH_INDEX_BASE || idx >= tensor_size + TH_INDEX_BASE)
-                         {
-                           THFree(TH_TENSOR_DIM_APPLY_counter);
-                           THError("Invalid index in scatterAdd");
-                         }
-                         tensor_data[(idx - TH_INDEX_BASE) * tensor_stride] += *(src_data + i*src_stride);
-                       })
+  if (elems_per_row == 0 || THLongTensor_nElement(index) == 0)
+    return;
+  num_slices = THLongTensor_nElement(index) / elems_per_row;
+
+  scalar_t *tensor_data = tensor->data<scalar_t>();
+  scalar_t *src_data = src->data<scalar_t>();
+  int64_t *index_data = THLongTensor_data(index);
+  int64_t tensor_stride = THTensor_strideLegacyNoScalars(tensor, dim);
+  int64_t src_stride = THTensor_strideLegacyNoScalars(src, dim);
+  int64_t index_stride = THTensor_strideLegacyNoScalars(index, dim);
+  int64_t tensor_size = THTensor_sizeLegacyNoScalars(tensor, dim);
+
+  /* Slices of tensor along dim are disjoint, so every thread accumulates into
+     its own slices and no atomics are needed. */
+  #pragma omp parallel for if(num_slices * elems_per_row > TH_OMP_OVERHEAD_THRESHOLD) private(slice)
+  for (slice = 0; slice < num_slices; slice++) {
+    int64_t index_offset, tensor_offset, src_offset, i;
+    THTensor_(sliceOffsets)(slice, dim, index, tensor, src, &index_offset, &tensor_offset, &src_offset);
+    for (i = 0; i < elems_per_row; ++i) {
+      int64_t idx = index_data[index_offset + i*index_stride];
+      if (idx < TH_INDEX_BASE || idx >= tensor_size + TH_INDEX_BASE) {
+        invalid = 1;
+        break;
+      }
+      tensor_data[tensor_offset + (idx - TH_INDEX_BASE) * tensor_stride] += src_data[src_offset + i*src_stride];
+    }
+  }
+  if (invalid)
+    THError("Invalid index in scatterAdd");
 }
 
 void THTensor_(scatterFill)(THTensor *tensor, int dim, THLongTensor *index, scalar_t val)
@@ -10,6 +10,9 @@
 
 #include <cpuinfo.h>
 
+#include <ATen/Parallel.h>
+#include <ATen/core/PhiloxRNG.h>
+
 #include "THGenerator.hpp"
 
 void THTensor_(random)(THTensor *self, THGenerator *_generator)
@@ -67,8 +70,35 @@ void THTensor_(geometric)(THTensor *self, THGenerator *_generator, double p)
 #define TH_REAL_MIN DBL_MIN
 #endif
 
+// Contiguous tensors are filled in parallel from a Philox stream, whose key is
+// the only number drawn from the generator under its lock. Element i uses
+// subsequence i of the stream, so the result doesn't depend on the number of
+// threads, and the generator state still determines it.
+static uint64_t THTensor_(philoxSeed)(THGenerator *_generator)
+{
+  std::lock_guard<std::mutex> lock(_generator->mutex);
+  return THRandom_random64(_generator);
+}
+
 void THTensor_(uniform)(THTensor *self, THGenerator *_generator, double a, double b)
 {
+  if (THTensor_(isContiguous)(self)) {
+    const uint64_t seed = THTensor_(philoxSeed)(_generator);
+    scalar_t *data = self->data<scalar_t>();
+    at::parallel_for(0, THTensor_(nElement)(self),
+        at::internal::grain_size_for_cost(at::internal::cost::ARITHMETIC),
+        [=](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        at::PhiloxRNG rng(seed, i);
+  #if defined(TH_REAL_IS_FLOAT)
+        data[i] = (scalar_t)(rng.uniform_float() * (b - a) + a);
+  #else
+        data[i] = (scalar_t)(rng.uniform_double() * (b - a) + a);
+  #endif
+      }
+    });
+    return;
+  }
   std::lock_guard<std::mutex> lock(_generator->mutex);
   #if defined(TH_REAL_IS_FLOAT)
   TH_TENSOR_APPLY(scalar_t, self, *self_data =
@@ -81,13 +111,37 @@ void THTensor_(uniform)(THTensor *self, THGenerator *_generator, double a, doubl
 
 void THTensor_(normal)(THTensor *self, THGenerator *_generator, double mean, double stddev)
 {
-  std::lock_guard<std::mutex> lock(_generator->mutex);
-  const int64_t size = THTensor_(numel)(self);
-  if (size >= 16 && THTensor_(isContiguous)(self)) {
-    THVector_(normal_fill)(THStorage_(data)(THTensor_getStoragePtr(self)) + self->storage_offset(), size, _generator, mean, stddev);
-  } else {
-    TH_TENSOR_APPLY(scalar_t, self, *self_data = (scalar_t)THRandom_normal(_generator, mean, stddev););
+  if (THTensor_(isContiguous)(self)) {
+    // Box-Muller turns the uniforms of subsequence j into elements 2j and
+    // 2j + 1
+    const uint64_t seed = THTensor_(philoxSeed)(_generator);
+    scalar_t *data = self->data<scalar_t>();
+    const int64_t size = THTensor_(nElement)(self);
+    at::parallel_for(0, (size + 1) / 2,
+        at::internal::grain_size_for_cost(at::internal::cost::TRANSCENDENTAL),
+        [=](int64_t begin, int64_t end) {
+      for (int64_t j = begin; j < end; ++j) {
+        at::PhiloxRNG rng(seed, j);
+  #if defined(TH_REAL_IS_FLOAT)
+        const accreal u1 = 1 - rng.uniform_float();
+        const accreal u2 = rng.uniform_float();
+  #else
+        const accreal u1 = 1 - rng.uniform_double();
+        const accreal u2 = rng.uniform_double();
+  #endif
+        const accreal radius = std::sqrt(-2 * std::log(u1));
+        const accreal theta = 2 * M_PI * u2;
+        data[2 * j] = (scalar_t)(radius * std::cos(theta) * stddev + mean);
+        if (2 * j + 1 < size) {
+          data[2 * j + 1] =
+            (scalar_t)(radius * std::sin(theta) * stddev + mean);
+        }
+      }
+    });
+    return;
   }
+  std::lock_guard<std::mutex> lock(_generator->mutex);
+  TH_TENSOR_APPLY(scalar_t, self, *self_data = (scalar_t)THRandom_normal(_generator, mean, stddev););
 }
 
 void THTensor_(normal_means)(THTensor *self, THGenerator *gen, THTensor *means, double stddev)
@@ -20,6 +20,11 @@ TH_API void THVector_(normal_fill)(scalar_t *data,
 								   const scalar_t mean,
 								   const scalar_t stddev);
 
+#if defined(TH_REAL_IS_FLOAT)
+TH_API void THVector_(copyFromHalf)(scalar_t *y, const THHalf *x, const ptrdiff_t n);
+TH_API void THVector_(copyToHalf)(THHalf *y, const scalar_t *x, const ptrdiff_t n);
+#endif
+
 #if defined(TH_REAL_IS_SHORT) || defined(TH_REAL_IS_INT) || defined(TH_REAL_IS_LONG)
 TH_API void THVector_(abs)(scalar_t *y, const scalar_t *x, const ptrdiff_t n);
 #endif
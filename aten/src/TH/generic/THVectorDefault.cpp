@@ -182,6 +182,22 @@ void THVector_(normal_fill_DEFAULT)(scalar_t *data,
   }
 }
 
+#if defined(TH_REAL_IS_FLOAT)
+void THVector_(copyFromHalf_DEFAULT)(scalar_t *y, const THHalf *x, const ptrdiff_t n)
+{
+  ptrdiff_t i;
+  for (i = 0; i < n; i++)
+    y[i] = static_cast<scalar_t>(x[i]);
+}
+
+void THVector_(copyToHalf_DEFAULT)(THHalf *y, const scalar_t *x, const ptrdiff_t n)
+{
+  ptrdiff_t i;
+  for (i = 0; i < n; i++)
+    y[i] = static_cast<THHalf>(x[i]);
+}
+#endif
+
 #define VECTOR_IMPLEMENT_FUNCTION(NAME, CFUNC)  \
   void THVector_(NAME)(scalar_t *y, const scalar_t *x, const ptrdiff_t n) \
   { \
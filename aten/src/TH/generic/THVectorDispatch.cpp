@@ -208,6 +208,34 @@ void THVector_(normal_fill)(scalar_t *data,
   THVector_(normal_fill_DISPATCHPTR)(data, size, generator, mean, stddev);
 }
 
+#if defined(TH_REAL_IS_FLOAT)
+// The AVX2 versions use the F16C conversion instructions, which every AVX2
+// capable CPU implements.
+static void (*THVector_(copyFromHalf_DISPATCHPTR))(scalar_t *, const THHalf *, const ptrdiff_t) = &THVector_(copyFromHalf_DEFAULT);
+static FunctionDescription THVector_(copyFromHalf_DISPATCHTABLE)[] = {
+  #if defined(USE_AVX2)
+      FUNCTION_IMPL(THVector_(copyFromHalf_AVX2), SIMDExtension_AVX2),
+  #endif
+
+  FUNCTION_IMPL(THVector_(copyFromHalf_DEFAULT), SIMDExtension_DEFAULT)
+};
+void THVector_(copyFromHalf)(scalar_t *y, const THHalf *x, const ptrdiff_t n) {
+  THVector_(copyFromHalf_DISPATCHPTR)(y, x, n);
+}
+
+static void (*THVector_(copyToHalf_DISPATCHPTR))(THHalf *, const scalar_t *, const ptrdiff_t) = &THVector_(copyToHalf_DEFAULT);
+static FunctionDescription THVector_(copyToHalf_DISPATCHTABLE)[] = {
+  #if defined(USE_AVX2)
+      FUNCTION_IMPL(THVector_(copyToHalf_AVX2), SIMDExtension_AVX2),
+  #endif
+
+  FUNCTION_IMPL(THVector_(copyToHalf_DEFAULT), SIMDExtension_DEFAULT)
+};
+void THVector_(copyToHalf)(THHalf *y, const scalar_t *x, const ptrdiff_t n) {
+  THVector_(copyToHalf_DISPATCHPTR)(y, x, n);
+}
+#endif
+
 #if defined(TH_REAL_IS_FLOAT) || defined(TH_REAL_IS_DOUBLE)
 static void (*THVector_(sigmoid_DISPATCHPTR))(scalar_t *, const scalar_t *, const ptrdiff_t) = &THVector_(sigmoid_DEFAULT);
 static FunctionDescription THVector_(sigmoid_DISPATCHTABLE)[] = {
@@ -243,6 +271,11 @@ struct THVector_(startup) {
     INIT_DISPATCH_PTR(copy);
     INIT_DISPATCH_PTR(normal_fill);
 
+#if defined(TH_REAL_IS_FLOAT)
+    INIT_DISPATCH_PTR(copyFromHalf);
+    INIT_DISPATCH_PTR(copyToHalf);
+#endif
+
 #if defined(TH_REAL_IS_FLOAT) || defined(TH_REAL_IS_DOUBLE)
     INIT_DISPATCH_PTR(sigmoid);
 #endif
@@ -127,4 +127,34 @@ void THFloatVector_sigmoid_AVX2(float *y, const float *x, const ptrdiff_t n) {
   }
 }
 
+// at::Half is a 16-bit IEEE half, so the storage can be fed to F16C directly.
+void THFloatVector_copyFromHalf_AVX2(float *y, const THHalf *x, const ptrdiff_t n) {
+  ptrdiff_t i;
+  __m128i XMM0, XMM1;
+  for (i = 0; i <= ((n)-16); i += 16) {
+    XMM0 = _mm_loadu_si128((const __m128i *)(x + i));
+    XMM1 = _mm_loadu_si128((const __m128i *)(x + i + 8));
+    _mm256_storeu_ps(y + i, _mm256_cvtph_ps(XMM0));
+    _mm256_storeu_ps(y + i + 8, _mm256_cvtph_ps(XMM1));
+  }
+  for (; i < (n); i++) {
+    y[i] = static_cast<float>(x[i]);
+  }
+}
+
+void THFloatVector_copyToHalf_AVX2(THHalf *y, const float *x, const ptrdiff_t n) {
+  ptrdiff_t i;
+  __m256 YMM0, YMM1;
+  for (i = 0; i <= ((n)-16); i += 16) {
+    YMM0 = _mm256_loadu_ps(x + i);
+    YMM1 = _mm256_loadu_ps(x + i + 8);
+    // round to nearest even, like the scalar conversion
+    _mm_storeu_si128((__m128i *)(y + i), _mm256_cvtps_ph(YMM0, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storeu_si128((__m128i *)(y + i + 8), _mm256_cvtps_ph(YMM1, _MM_FROUND_TO_NEAREST_INT));
+  }
+  for (; i < (n); i++) {
+    y[i] = static_cast<THHalf>(x[i]);
+  }
+}
+
 #endif // defined(__AVX2__)
@@ -3,30 +3,57 @@
 #include <ATen/Context.h>
 #include <ATen/cuda/CUDAContext.h>
 #include <ATen/cuda/Exceptions.h>
+#include <c10/util/Backtrace.h>
 
 #include <cuda_runtime_api.h>
 #include <algorithm>
+#include <cstdlib>
 #include <deque>
+#include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 //
 // Yet another caching allocator for CUDA device allocations.
 //
 // - Allocations are associated with a stream. Once freed, blocks can be
-//   re-allocated on the same stream, but not on any other stream.
+//   re-allocated on the same stream, but not on any other stream (except for
+//   the out-of-memory fallback below).
 // - The allocator attempts to find the smallest cached block that will fit the
 //   requested size. If the block is larger than the requested size, it may be
 //   split. If no block is found, the allocator will delegate to cudaMalloc.
-// - If the cudaMalloc fails, the allocator will free all cached blocks that
-//   are not split and retry the allocation.
+// - If the cudaMalloc fails, the allocator first tries to take over a whole
+//   free segment cached for another stream of the same device, making the
+//   requesting stream wait (with an event) for the work queued on the old
+//   one. Failing that, it frees cached "oversize" blocks (see below), then
+//   all cached blocks that are not split, retrying the cudaMalloc after each.
 // - Large (>1MB) and small allocation requests are handled separately. Large
 //   allocation requests can be filled by a cudaMalloc call of the exact size.
 //   Small requests will allocate and split a 1MB buffer, if necessary.
+// - Blocks of at least the max split size (unlimited by default, set with the
+//   THC_CACHING_ALLOCATOR_MAX_SPLIT_SIZE_MB environment variable or
+//   THCCachingAllocator_setMaxSplitSize) are "oversize": they are never split,
+//   smaller requests never use them, and an oversize request only reuses a
+//   cached oversize block that is less than 20 MiB larger. This keeps a few
+//   huge variable-sized allocations from shredding the cache into pieces that
+//   only fit the next smaller request.
+// - THCCachingAllocator_snapshot() lists every segment (cudaMalloc'ed
+//   buffer) with the blocks it is split into, to inspect fragmentation.
+// - THCCachingAllocator_recordHistory() turns on a bounded trace of every
+//   allocation, free, cudaMalloc, cudaFree and OOM with its C++ backtrace,
+//   which is also attached to the allocated blocks in the snapshot.
+// - While a CUDA graph is captured (see ATen/cuda/CUDAGraph.h), allocations
+//   on the capture stream are tagged with the graph. Tagged blocks are only
+//   reused by the same graph once freed, so the addresses baked into the
+//   graph stay valid for replays, until the graph releases its pool. Since
+//   cudaFree and event queries are illegal during capture, cudaMalloc
+//   failures are not retried, and freed blocks that need events wait for
+//   the end of the capture.
 //
 // With this allocator, allocations and frees should logically be considered
 // "usages" of the memory segment associated with streams, just like kernel
@@ -47,6 +74,8 @@ typedef std::set<THCStreamPtr> stream_set;
 const size_t kRoundSmall = 512;     // round up small allocs to 512 bytes
 const size_t kRoundLarge = 131072;  // round up large allocs to 128 KiB
 const size_t kSmallAlloc = 1048576; // largest "small" allocation is 1 MiB
+const size_t kOversizeSlack = 20971520; // oversize blocks serve requests at most 20 MiB smaller
+const size_t kTraceFrames = 16;         // frames of backtrace kept per trace entry
 
 struct DeviceStats {
   uint64_t   amount_allocated;      // total amount allocated in bytes
@@ -87,10 +116,13 @@ struct Block {
   Block*        prev;        // prev block if split from a larger allocation
   Block*        next;        // next block if split from a larger allocation
   int           event_count; // number of outstanding CUDA events
+  std::string   backtrace;   // allocation site, if history is recorded
+  uint64_t      graph_id;    // CUDA graph the block is reserved for, or 0
 
   Block(int device, cudaStream_t stream, size_t size, char* ptr=NULL) :
       device(device), stream(stream), stream_uses(), size(size), ptr(ptr),
-      allocated(0), prev(NULL), next(NULL), event_count(0) { }
+      allocated(0), prev(NULL), next(NULL), event_count(0), backtrace(),
+      graph_id(0) { }
 };
 
 static bool BlockComparator(const Block* a, const Block* b)
@@ -129,15 +161,51 @@ struct THCCachingAllocator
   // cached blocks 1 MB or smaller
   FreeBlocks small_blocks;
 
+  // blocks at least this large are neither split nor used for smaller requests
+  size_t max_split_size;
+
   // allocated blocks by device pointer
   std::unordered_map<void*, Block*> allocated_blocks;
 
   // outstanding cuda events
   std::deque<std::pair<cudaEvent_t, Block*>> cuda_events;
 
+  // recorded history, if enabled (oldest first)
+  bool record_history;
+  size_t max_trace_entries;
+  std::deque<THCCachingAllocatorTraceEntry> trace;
+
+  // free blocks reserved for a CUDA graph
+  struct GraphPool {
+    FreeBlocks large_blocks;
+    FreeBlocks small_blocks;
+    GraphPool() : large_blocks(BlockComparator), small_blocks(BlockComparator) {}
+  };
+  std::unordered_map<uint64_t, GraphPool> graph_pools;
+
+  // graph being captured on capture_stream, or 0
+  uint64_t capture_graph_id;
+  cudaStream_t capture_stream;
+
+  // freed blocks with stream uses whose events wait for the capture to end
+  std::vector<Block*> capture_deferred_blocks;
+
   THCCachingAllocator() :
       large_blocks(BlockComparator),
-      small_blocks(BlockComparator) {}
+      small_blocks(BlockComparator),
+      max_split_size(std::numeric_limits<size_t>::max()),
+      record_history(false),
+      max_trace_entries(0),
+      capture_graph_id(0),
+      capture_stream(NULL) {
+    const char* env = std::getenv("THC_CACHING_ALLOCATOR_MAX_SPLIT_SIZE_MB");
+    if (env) {
+      size_t mb = std::strtoull(env, NULL, 10);
+      if (mb > 0 && mb < std::numeric_limits<size_t>::max() / 1048576) {
+        max_split_size = std::max(mb * 1048576, kSmallAlloc + 1);
+      }
+    }
+  }
 
   DeviceStats &get_stats_for_device(int device) {
     THAssert(device >= 0);
@@ -168,31 +236,60 @@ struct THCCachingAllocator
 
     DeviceStats &stats = get_stats_for_device(device);
 
-    Block search_key(device, stream, size);
-    auto& free_blocks = small ? large_blocks : small_blocks;
+    auto& free_blocks = small ? small_blocks : large_blocks;
+    bool capturing = capture_graph_id != 0 && stream == capture_stream;
 
     Block* block = NULL;
     Block* remaining = NULL;
 
-    auto it = free_blocks.lower_bound(&search_key);
-    if (it != free_blocks.end() && (*it)->device == device && (*it)->stream == stream) {
-      block = *it;
-      free_blocks.erase(it);
-    } else {
+    if (capturing) {
+      GraphPool& pool = graph_pools[capture_graph_id];
+      block = find_free_block(small ? pool.small_blocks : pool.large_blocks, device, stream, size);
+    }
+    if (!block) {
+      block = find_free_block(free_blocks, device, stream, size);
+    }
+
+    if (!block) {
       void* ptr;
       size_t alloc_size = small ? kSmallAlloc : size;
-      err = cuda_malloc_retry(device, &ptr, alloc_size);
-      if (err != cudaSuccess) {
+      err = cudaMalloc(&ptr, alloc_size);
+      if (err != cudaSuccess && capture_graph_id != 0) {
+        // freeing the cache or waiting on other streams would break the capture
+        record(THC_TRACE_OOM, device, NULL, alloc_size, stream);
         return err;
       }
-      stats.increaseCached(alloc_size);
-      block = new Block(device, stream, alloc_size, (char*)ptr);
+      if (err != cudaSuccess) {
+        cudaGetLastError();
+        // Prefer a whole cached segment of another stream over emptying the
+        // cache, which synchronizes the device.
+        block = find_other_stream_segment(free_blocks, device, stream, size);
+        if (block) {
+          err = move_to_stream(block, stream);
+          if (err != cudaSuccess) {
+            free_blocks.insert(block);
+            return err;
+          }
+        } else {
+          err = cuda_malloc_retry(device, &ptr, alloc_size);
+          if (err != cudaSuccess) {
+            record(THC_TRACE_OOM, device, NULL, alloc_size, stream);
+            return err;
+          }
+        }
+      }
+      if (!block) {
+        record(THC_TRACE_SEGMENT_ALLOC, device, ptr, alloc_size, stream);
+        stats.increaseCached(alloc_size);
+        block = new Block(device, stream, alloc_size, (char*)ptr);
+      }
     }
 
-    if (block->size - size >= (small ? kRoundSmall : kSmallAlloc + 1)) {
+    if (should_split(block, size)) {
       remaining = block;
 
       block = new Block(device, stream, size, block->ptr);
+      block->graph_id = remaining->graph_id;
       block->prev = remaining->prev;
       if (block->prev) {
         block->prev->next = block;
@@ -202,15 +299,23 @@ struct THCCachingAllocator
       remaining->prev = block;
       remaining->ptr += size;
       remaining->size -= size;
-      free_blocks.insert(remaining);
+      pool_for(remaining).insert(remaining);
     }
 
+    if (capturing) {
+      block->graph_id = capture_graph_id;
+    }
     block->allocated = true;
     allocated_blocks[block->ptr] = block;
+    if (record_history) {
+      record(THC_TRACE_ALLOC, device, block->ptr, block->size, stream);
+      block->backtrace = trace.back().backtrace;
+    }
 
     *devPtr = (void*)block->ptr;
 
     stats.increaseAllocated(block->size);
+    at::reportMemoryUsage(block->size, at::Device(at::kCUDA, device));
     return cudaSuccess;
   }
 
@@ -229,9 +334,16 @@ struct THCCachingAllocator
     Block* block = it->second;
     allocated_blocks.erase(it);
     block->allocated = false;
+    block->backtrace.clear();
+    record(THC_TRACE_FREE, block->device, block->ptr, block->size, block->stream);
 
     get_stats_for_device(block->device).decreaseAllocated(block->size);
+    at::reportMemoryUsage(-static_cast<int64_t>(block->size), at::Device(at::kCUDA, block->device));
     if (!block->stream_uses.empty()) {
+      if (capture_graph_id != 0) {
+        capture_deferred_blocks.push_back(block);
+        return cudaSuccess;
+      }
       return insert_events(block);
     }
 
@@ -239,6 +351,171 @@ struct THCCachingAllocator
     return cudaSuccess;
   }
 
+  void setMaxSplitSize(size_t size)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    // small requests are carved out of 1 MiB segments regardless
+    max_split_size = std::max(size, kSmallAlloc + 1);
+  }
+
+  /** returns every segment with its blocks, sorted by device and address */
+  std::vector<THCCachingAllocatorSegmentInfo> snapshot()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Blocks waiting on events are in neither the free lists nor
+    // allocated_blocks, so collect segment heads from cuda_events too.
+    std::unordered_set<Block*> heads;
+    auto add_head = [&](Block* block) {
+      while (block->prev) {
+        block = block->prev;
+      }
+      heads.insert(block);
+    };
+    for (auto& kv : allocated_blocks) {
+      add_head(kv.second);
+    }
+    for (Block* block : large_blocks) {
+      add_head(block);
+    }
+    for (Block* block : small_blocks) {
+      add_head(block);
+    }
+    for (auto& e : cuda_events) {
+      add_head(e.second);
+    }
+    for (auto& kv : graph_pools) {
+      for (Block* block : kv.second.large_blocks) {
+        add_head(block);
+      }
+      for (Block* block : kv.second.small_blocks) {
+        add_head(block);
+      }
+    }
+    for (Block* block : capture_deferred_blocks) {
+      add_head(block);
+    }
+
+    std::vector<THCCachingAllocatorSegmentInfo> segments;
+    segments.reserve(heads.size());
+    for (Block* head : heads) {
+      THCCachingAllocatorSegmentInfo segment;
+      segment.device = head->device;
+      segment.address = (uintptr_t)head->ptr;
+      segment.total_size = 0;
+      segment.allocated_size = 0;
+      segment.stream = head->stream;
+      for (Block* block = head; block; block = block->next) {
+        segment.blocks.push_back({block->size, block->allocated, block->backtrace});
+        segment.total_size += block->size;
+        if (block->allocated) {
+          segment.allocated_size += block->size;
+        }
+      }
+      // small segments are exactly kSmallAlloc, large ones always bigger
+      segment.is_large = segment.total_size > kSmallAlloc;
+      segments.push_back(std::move(segment));
+    }
+    std::sort(segments.begin(), segments.end(),
+        [](const THCCachingAllocatorSegmentInfo& a, const THCCachingAllocatorSegmentInfo& b) {
+          if (a.device != b.device) {
+            return a.device < b.device;
+          }
+          return a.address < b.address;
+        });
+    return segments;
+  }
+
+  void recordHistory(bool enabled, size_t max_entries)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    record_history = enabled && max_entries > 0;
+    if (record_history) {
+      max_trace_entries = max_entries;
+      trace.clear();
+    }
+  }
+
+  std::vector<THCCachingAllocatorTraceEntry> getTrace()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::vector<THCCachingAllocatorTraceEntry>(trace.begin(), trace.end());
+  }
+
+  /** appends to the trace if history is recorded; called with the lock held */
+  void record(THCCachingAllocatorTraceAction action, int device, void* ptr, size_t size,
+              cudaStream_t stream)
+  {
+    if (!record_history) {
+      return;
+    }
+    if (trace.size() >= max_trace_entries) {
+      trace.pop_front();
+    }
+    // skip this function and c10::get_backtrace itself
+    trace.push_back({action, device, (uintptr_t)ptr, size, stream,
+                     c10::get_backtrace(2, kTraceFrames)});
+  }
+
+  void notifyCaptureBegin(uint64_t graph_id, cudaStream_t stream)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    THAssertMsg(graph_id != 0, "invalid graph id");
+    THAssertMsg(capture_graph_id == 0, "only one CUDA graph can be captured at a time");
+    capture_graph_id = graph_id;
+    capture_stream = stream;
+    graph_pools[graph_id];
+  }
+
+  cudaError_t notifyCaptureEnd(uint64_t graph_id)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    THAssertMsg(capture_graph_id == graph_id, "CUDA graph capture was not started");
+    capture_graph_id = 0;
+    capture_stream = NULL;
+    cudaError_t err = cudaSuccess;
+    for (Block* block : capture_deferred_blocks) {
+      cudaError_t block_err = insert_events(block);
+      if (err == cudaSuccess) {
+        err = block_err;
+      }
+    }
+    capture_deferred_blocks.clear();
+    return err;
+  }
+
+  /** makes the blocks reserved for a graph available to all allocations */
+  void releaseGraphPool(uint64_t graph_id)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    THAssertMsg(capture_graph_id != graph_id, "cannot release the pool of a CUDA graph being captured");
+    auto it = graph_pools.find(graph_id);
+    if (it == graph_pools.end()) {
+      return;
+    }
+    GraphPool pool(std::move(it->second));
+    graph_pools.erase(it);
+
+    // Blocks that are still in use or wait on events go to the shared pools
+    // once freed.
+    for (auto& kv : allocated_blocks) {
+      if (kv.second->graph_id == graph_id) {
+        kv.second->graph_id = 0;
+      }
+    }
+    for (auto& e : cuda_events) {
+      if (e.second->graph_id == graph_id) {
+        e.second->graph_id = 0;
+      }
+    }
+    for (FreeBlocks* blocks : {&pool.large_blocks, &pool.small_blocks}) {
+      for (Block* block : *blocks) {
+        block->graph_id = 0;
+        free_block(block);
+      }
+    }
+  }
+
   /** returns cached blocks to the system allocator */
   cudaError_t emptyCache()
   {
@@ -317,17 +594,115 @@ struct THCCachingAllocator
   void free_block(Block* block)
   {
     THAssert(!block->allocated && block->event_count == 0);
-    bool small = block->size <= kSmallAlloc;
-    auto& free_blocks = small ? large_blocks : small_blocks;
+    if (block->graph_id != 0 && graph_pools.find(block->graph_id) == graph_pools.end()) {
+      block->graph_id = 0;
+    }
+    auto& free_blocks = pool_for(block);
     try_merge_blocks(block, block->prev, free_blocks);
     try_merge_blocks(block, block->next, free_blocks);
     free_blocks.insert(block);
   }
 
+  /** the free list a free block belongs to */
+  FreeBlocks& pool_for(const Block* block)
+  {
+    bool small = block->size <= kSmallAlloc;
+    if (block->graph_id != 0) {
+      GraphPool& pool = graph_pools.at(block->graph_id);
+      return small ? pool.small_blocks : pool.large_blocks;
+    }
+    return small ? small_blocks : large_blocks;
+  }
+
+  /** removes and returns the best cached block for a request, if any */
+  Block* find_free_block(FreeBlocks& free_blocks, int device, cudaStream_t stream, size_t size)
+  {
+    Block search_key(device, stream, size);
+    auto it = free_blocks.lower_bound(&search_key);
+    if (it == free_blocks.end() || (*it)->device != device || (*it)->stream != stream) {
+      return NULL;
+    }
+    // *it is the smallest fitting block, so if it is unusable all are
+    if (!fits_size_policy(*it, size)) {
+      return NULL;
+    }
+    Block* block = *it;
+    free_blocks.erase(it);
+    return block;
+  }
+
+  /** removes and returns the smallest whole free segment that another stream
+   *  of `device` cached and that fits a request, if any */
+  Block* find_other_stream_segment(FreeBlocks& free_blocks, int device, cudaStream_t stream, size_t size)
+  {
+    Block lower_bound(device, NULL, 0);
+    Block upper_bound(device + 1, NULL, 0);
+    auto best = free_blocks.end();
+    auto end = free_blocks.lower_bound(&upper_bound);
+    for (auto it = free_blocks.lower_bound(&lower_bound); it != end; ++it) {
+      Block* block = *it;
+      if (block->stream == stream || block->prev || block->next ||
+          block->size < size || !fits_size_policy(block, size)) {
+        continue;
+      }
+      if (best == free_blocks.end() || block->size < (*best)->size) {
+        best = it;
+      }
+    }
+    if (best == free_blocks.end()) {
+      return NULL;
+    }
+    Block* block = *best;
+    free_blocks.erase(best);
+    return block;
+  }
+
+  /** hands a whole free segment over to another stream */
+  cudaError_t move_to_stream(Block* block, cudaStream_t stream)
+  {
+    // Kernels queued on the old stream may still use the memory, so the new
+    // stream has to wait for them. The block must not be in a free list here,
+    // since the stream is part of the sort key.
+    THAssert(!block->allocated && !block->prev && !block->next);
+    cudaEvent_t event;
+    cudaError_t err = cudaEventCreateWithFlags(&event, cudaEventDisableTiming);
+    if (err != cudaSuccess) {
+      return err;
+    }
+    err = cudaEventRecord(event, block->stream);
+    if (err == cudaSuccess) {
+      err = cudaStreamWaitEvent(stream, event, 0);
+    }
+    cudaEventDestroy(event);
+    if (err != cudaSuccess) {
+      return err;
+    }
+    block->stream = stream;
+    return cudaSuccess;
+  }
+
+  /** oversize blocks only serve oversize requests of about their size */
+  bool fits_size_policy(const Block* block, size_t size)
+  {
+    if (size < max_split_size) {
+      return block->size < max_split_size;
+    }
+    return block->size - size < kOversizeSlack;
+  }
+
+  bool should_split(const Block* block, size_t size)
+  {
+    size_t remaining = block->size - size;
+    if (size <= kSmallAlloc) {
+      return remaining >= kRoundSmall;
+    }
+    return block->size < max_split_size && remaining > kSmallAlloc;
+  }
+
   /** combine previously split blocks */
   void try_merge_blocks(Block* dst, Block* src, FreeBlocks& free_blocks)
   {
-    if (!src || src->allocated || src->event_count > 0) {
+    if (!src || src->allocated || src->event_count > 0 || src->graph_id != dst->graph_id) {
       return;
     }
     if (dst->prev == src) {
@@ -361,36 +736,45 @@ struct THCCachingAllocator
 
   cudaError_t cuda_malloc_retry(int device, void** devPtr, size_t size)
   {
-    // Try cudaMalloc. If cudaMalloc fails, frees all non-split cached blocks
-    // and retries.
-    cudaError_t err = cudaMalloc(devPtr, size);
-    if (err != cudaSuccess) {
-      cudaGetLastError();
-      err = free_cached_blocks(device);
+    // Called after cudaMalloc failed once. Frees the cached oversize blocks,
+    // which are of little use to other requests, and retries; then frees all
+    // non-split cached blocks and retries again.
+    cudaError_t err;
+    if (max_split_size != std::numeric_limits<size_t>::max()) {
+      err = free_cached_blocks(device, max_split_size);
       if (err != cudaSuccess) {
         return err;
       }
       err = cudaMalloc(devPtr, size);
-      if (err != cudaSuccess) {
-        return err;
+      if (err == cudaSuccess) {
+        return cudaSuccess;
       }
+      cudaGetLastError();
     }
-    return cudaSuccess;
+    err = free_cached_blocks(device, 0);
+    if (err != cudaSuccess) {
+      return err;
+    }
+    return cudaMalloc(devPtr, size);
   }
 
-  cudaError_t free_cached_blocks(int device)
+  cudaError_t free_cached_blocks(int device, size_t min_size)
   {
-    // Free all non-split cached blocks on device
+    // Free all non-split cached blocks on device of at least min_size bytes
     Block lower_bound(device, NULL, 0);
     Block upper_bound(device + 1, NULL, 0);
 
     cudaError_t err = free_blocks(
         large_blocks,
         large_blocks.lower_bound(&lower_bound),
-        large_blocks.lower_bound(&upper_bound));
+        large_blocks.lower_bound(&upper_bound),
+        min_size);
     if (err != cudaSuccess) {
       return err;
     }
+    if (min_size > kSmallAlloc) {
+      return cudaSuccess;
+    }
     err = free_blocks(
         small_blocks,
         small_blocks.lower_bound(&lower_bound),
@@ -398,17 +782,19 @@ struct THCCachingAllocator
     return err;
   }
 
-  cudaError_t free_blocks(FreeBlocks& blocks, FreeBlocks::iterator it, FreeBlocks::iterator end)
+  cudaError_t free_blocks(FreeBlocks& blocks, FreeBlocks::iterator it, FreeBlocks::iterator end,
+                          size_t min_size=0)
   {
-    // Frees all non-split blocks between `it` and `end`
+    // Frees all non-split blocks of at least min_size bytes between `it` and `end`
     std::lock_guard<std::mutex> lock(cuda_free_mutex);
     while (it != end) {
       Block* block = *it;
-      if (!block->prev && !block->next) {
+      if (!block->prev && !block->next && block->size >= min_size) {
         cudaError_t err = cudaFree((void*)block->ptr);
         if (err != cudaSuccess) {
           return err;
         }
+        record(THC_TRACE_SEGMENT_FREE, block->device, block->ptr, block->size, block->stream);
         get_stats_for_device(block->device).decreaseCached(block->size);
         auto cur = it;
         ++it;
@@ -466,7 +852,11 @@ struct THCCachingAllocator
     // from the queue, and the 'event_count' for the corresponding allocation
     // is decremented. Stops at the first event which has not been completed.
     // Since events on different devices or streams may occur out of order,
-    // the processing of some events may be delayed.
+    // the processing of some events may be delayed. Skipped while a graph
+    // is captured, since cudaEventQuery is not allowed then.
+    if (capture_graph_id != 0) {
+      return cudaSuccess;
+    }
     while (!cuda_events.empty()) {
       auto& e = cuda_events.front();
       cudaEvent_t event = e.first;
@@ -547,6 +937,47 @@ THC_API std::mutex* THCCachingAllocator_getCudaFreeMutex()
   return &caching_allocator.cuda_free_mutex;
 }
 
+THC_API void THCCachingAllocator_setMaxSplitSize(size_t size)
+{
+  caching_allocator.setMaxSplitSize(size);
+}
+
+THC_API size_t THCCachingAllocator_maxSplitSize(void)
+{
+  std::lock_guard<std::mutex> lock(caching_allocator.mutex);
+  return caching_allocator.max_split_size;
+}
+
+THC_API void THCCachingAllocator_snapshot(std::vector<THCCachingAllocatorSegmentInfo>* segments)
+{
+  *segments = caching_allocator.snapshot();
+}
+
+THC_API void THCCachingAllocator_notifyCaptureBegin(uint64_t graph_id, cudaStream_t stream)
+{
+  caching_allocator.notifyCaptureBegin(graph_id, stream);
+}
+
+THC_API void THCCachingAllocator_notifyCaptureEnd(uint64_t graph_id)
+{
+  AT_CUDA_CHECK(caching_allocator.notifyCaptureEnd(graph_id));
+}
+
+THC_API void THCCachingAllocator_releaseGraphPool(uint64_t graph_id)
+{
+  caching_allocator.releaseGraphPool(graph_id);
+}
+
+THC_API void THCCachingAllocator_recordHistory(bool enabled, size_t max_entries)
+{
+  caching_allocator.recordHistory(enabled, max_entries);
+}
+
+THC_API void THCCachingAllocator_trace(std::vector<THCCachingAllocatorTraceEntry>* entries)
+{
+  *entries = caching_allocator.getTrace();
+}
+
 static inline void assertValidDevice(int device) {
   int device_count;
   THCudaCheck(cudaGetDeviceCount(&device_count));
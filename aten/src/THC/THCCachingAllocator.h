@@ -3,6 +3,8 @@
 
 #if (__cplusplus >= 201103L) || (defined(_MSC_VER) && defined(__cplusplus))
 #include <mutex>
+#include <string>
+#include <vector>
 #endif
 
 #include "THCGeneral.h"
@@ -17,9 +19,60 @@ THC_API uint64_t THCCachingAllocator_currentMemoryAllocated(int device);
 THC_API uint64_t THCCachingAllocator_maxMemoryAllocated(int device);
 THC_API uint64_t THCCachingAllocator_currentMemoryCached(int device);
 THC_API uint64_t THCCachingAllocator_maxMemoryCached(int device);
+/* Blocks of at least this many bytes are never split (SIZE_MAX disables the limit). */
+THC_API void THCCachingAllocator_setMaxSplitSize(size_t size);
+THC_API size_t THCCachingAllocator_maxSplitSize(void);
+/* Used by at::cuda::CUDAGraph: blocks allocated on `stream` between capture
+   begin and end are reserved for graph `graph_id` (non-zero) until its pool
+   is released. */
+THC_API void THCCachingAllocator_notifyCaptureBegin(uint64_t graph_id, cudaStream_t stream);
+THC_API void THCCachingAllocator_notifyCaptureEnd(uint64_t graph_id);
+THC_API void THCCachingAllocator_releaseGraphPool(uint64_t graph_id);
 
 #if (__cplusplus >= 201103L) || (defined(_MSC_VER) && defined(__cplusplus))
 THC_API std::mutex* THCCachingAllocator_getCudaFreeMutex();
+
+struct THCCachingAllocatorBlockInfo {
+  size_t size;
+  bool allocated;
+  std::string backtrace; /* where an allocated block came from, if recorded */
+};
+
+/* A cudaMalloc'ed buffer and the blocks it is currently split into, in address order. */
+struct THCCachingAllocatorSegmentInfo {
+  int device;
+  uintptr_t address;
+  size_t total_size;
+  size_t allocated_size;
+  cudaStream_t stream;
+  bool is_large;
+  std::vector<THCCachingAllocatorBlockInfo> blocks;
+};
+
+/* Fills `segments` with every segment held by the allocator, sorted by device and address. */
+THC_API void THCCachingAllocator_snapshot(std::vector<THCCachingAllocatorSegmentInfo>* segments);
+
+enum THCCachingAllocatorTraceAction {
+  THC_TRACE_ALLOC,         /* block handed out */
+  THC_TRACE_FREE,          /* block released by its user */
+  THC_TRACE_SEGMENT_ALLOC, /* cudaMalloc */
+  THC_TRACE_SEGMENT_FREE,  /* cudaFree */
+  THC_TRACE_OOM            /* cudaMalloc failed even after freeing the cache */
+};
+
+struct THCCachingAllocatorTraceEntry {
+  THCCachingAllocatorTraceAction action;
+  int device;
+  uintptr_t address;
+  size_t size;
+  cudaStream_t stream;
+  std::string backtrace;
+};
+
+/* Starts (clearing the trace) or stops recording allocator events with C++
+   backtraces. Only the last max_entries events are kept. */
+THC_API void THCCachingAllocator_recordHistory(bool enabled, size_t max_entries);
+THC_API void THCCachingAllocator_trace(std::vector<THCCachingAllocatorTraceEntry>* entries);
 #endif
 
 #endif
@@ -60,6 +60,7 @@ void THCudaInit(THCState* state)
 
   state->deviceProperties =
     (struct cudaDeviceProp*)malloc(numDevices * sizeof(struct cudaDeviceProp));
+  state->devicePropertiesFlags = new std::once_flag[numDevices];
 
   state->rngState = (THCRNGState*)malloc(sizeof(THCRNGState));
   THCRandom_init(state, numDevices, device);
@@ -81,26 +82,31 @@ void THCudaInit(THCState* state)
         state->p2pAccessEnabled[i][j] = -1;
   }
 
-  for (int i = 0; i < numDevices; ++i) {
-    THCCudaResourcesPerDevice* res = THCState_getDeviceResourcePtr(state, i);
-    THCudaCheck(cudaSetDevice(i));
-    THCudaCheck(cudaGetDeviceProperties(&state->deviceProperties[i], i));
-
-    /* The scratch space that we want to have available per each device is
-       based on the number of SMs available per device. We guarantee a
-       minimum of 128kb of space per device, but to future-proof against
-       future architectures that may have huge #s of SMs, we guarantee that
-       we have at least 16 bytes for each SM. */
-    int numSM = state->deviceProperties[i].multiProcessorCount;
-    size_t sizePerStream =
-      MIN_GLOBAL_SCRATCH_SPACE_PER_DEVICE >= numSM * MIN_GLOBAL_SCRATCH_SPACE_PER_SM_STREAM ?
-      MIN_GLOBAL_SCRATCH_SPACE_PER_DEVICE :
-      numSM * MIN_GLOBAL_SCRATCH_SPACE_PER_SM_STREAM;
-    res->scratchSpacePerStream = sizePerStream;
-  }
+}
+
+static void THCState_initDeviceProperties(THCState* state, int device)
+{
+  THCCudaResourcesPerDevice* res = THCState_getDeviceResourcePtr(state, device);
+  THCudaCheck(cudaGetDeviceProperties(&state->deviceProperties[device], device));
+
+  /* The scratch space that we want to have available per each device is
+     based on the number of SMs available per device. We guarantee a
+     minimum of 128kb of space per device, but to future-proof against
+     future architectures that may have huge #s of SMs, we guarantee that
+     we have at least 16 bytes for each SM. */
+  int numSM = state->deviceProperties[device].multiProcessorCount;
+  size_t sizePerStream =
+    MIN_GLOBAL_SCRATCH_SPACE_PER_DEVICE >= numSM * MIN_GLOBAL_SCRATCH_SPACE_PER_SM_STREAM ?
+    MIN_GLOBAL_SCRATCH_SPACE_PER_DEVICE :
+    numSM * MIN_GLOBAL_SCRATCH_SPACE_PER_SM_STREAM;
+  res->scratchSpacePerStream = sizePerStream;
+}
 
-  /* Restore to previous device */
-  THCudaCheck(cudaSetDevice(device));
+static void THCState_lazyInitDeviceProperties(THCState* state, int device)
+{
+  THAssert(device >= 0 && device < state->numDevices);
+  std::call_once(state->devicePropertiesFlags[device],
+                 THCState_initDeviceProperties, state, device);
 }
 
 void THCudaShutdown(THCState* state)
@@ -109,6 +115,7 @@ void THCudaShutdown(THCState* state)
 
   free(state->rngState);
   free(state->deviceProperties);
+  delete[] state->devicePropertiesFlags;
 
   int deviceCount = 0;
   int prevDev = -1;
@@ -186,12 +193,13 @@ struct cudaDeviceProp* THCState_getCurrentDeviceProperties(THCState* state)
   int curDev = -1;
   THCudaCheck(cudaGetDevice(&curDev));
 
+  THCState_lazyInitDeviceProperties(state, curDev);
   return &(state->deviceProperties[curDev]);
 }
 
 struct cudaDeviceProp* THCState_getDeviceProperties(THCState* state, int device)
 {
-  THAssert(device >= 0 && device < state->numDevices);
+  THCState_lazyInitDeviceProperties(state, device);
   return &(state->deviceProperties[device]);
 }
 
@@ -294,6 +302,7 @@ size_t THCState_getCurrentDeviceScratchSpaceSize(THCState* state)
 {
   int device = -1;
   THCudaCheck(cudaGetDevice(&device));
+  THCState_lazyInitDeviceProperties(state, device);
   THCCudaResourcesPerDevice* res = THCState_getDeviceResourcePtr(state, device);
   return res->scratchSpacePerStream;
 }
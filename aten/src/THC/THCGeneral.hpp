@@ -2,10 +2,15 @@
 
 #include "THCGeneral.h"
 
+#include <mutex>
+
 /* Global state of THC. */
 struct THCState {
   struct THCRNGState* rngState;
   struct cudaDeviceProp* deviceProperties;
+  /* The properties and scratch space size of a device are queried on first
+     use, since creating the contexts of all devices delays startup. */
+  std::once_flag* devicePropertiesFlags;
   /* Set of all allocated resources. blasHandles and sparseHandles do not have
      a default and must be explicitly initialized. We always initialize 1
      blasHandle and 1 sparseHandle but we can use more.
@@ -3,5 +3,51 @@
 #include "THCStream.h"
 #include "THCCachingHostAllocator.h"
 
+#include <algorithm>
+#include <cstring>
+
+// Size of the pinned buffers that pageable memory is staged through. The
+// memcpy of each chunk into its buffer overlaps the transfer of the previous
+// one, and the caching host allocator hands the buffers out again once their
+// transfer is done.
+static const size_t STAGING_CHUNK_SIZE = 1 << 20;
+
+static bool THC_isPinned(const void *ptr)
+{
+  cudaPointerAttributes attr;
+  cudaError_t err = cudaPointerGetAttributes(&attr, ptr);
+  if (err != cudaSuccess) {
+    // pageable memory that CUDA does not know about
+    cudaGetLastError();
+    return false;
+  }
+  return attr.memoryType == cudaMemoryTypeHost;
+}
+
+void THCudaMemcpyAsyncHostToDevice(THCState *state, void *dst, const void *src,
+                                   const void *src_base, size_t size,
+                                   THCStream *stream)
+{
+  if (THC_isPinned(src)) {
+    THCudaCheck(cudaMemcpyAsync(dst, src, size, cudaMemcpyHostToDevice,
+                                THCStream_stream(stream)));
+    THCudaCheck(THCCachingHostAllocator_recordEvent(const_cast<void*>(src_base), stream));
+    return;
+  }
+
+  THAllocator *host_allocator = getTHCCachingHostAllocator();
+  for (size_t offset = 0; offset < size; offset += STAGING_CHUNK_SIZE) {
+    size_t chunk_size = std::min(STAGING_CHUNK_SIZE, size - offset);
+    // The buffer is freed at the end of the iteration, but the recorded event
+    // keeps it from being reused before the transfer out of it is done.
+    at::DataPtr staging = host_allocator->allocate(chunk_size);
+    std::memcpy(staging.get(), static_cast<const char*>(src) + offset, chunk_size);
+    THCudaCheck(cudaMemcpyAsync(static_cast<char*>(dst) + offset, staging.get(),
+                                chunk_size, cudaMemcpyHostToDevice,
+                                THCStream_stream(stream)));
+    THCudaCheck(THCCachingHostAllocator_recordEvent(staging.get(), stream));
+  }
+}
+
 #include "generic/THCTensorCopy.cpp"
 #include "THCGenerateAllTypes.h"
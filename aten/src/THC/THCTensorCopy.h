@@ -6,6 +6,15 @@
 #include "TH/THHalf.h"
 #include "THCStream.h"
 
+// Copies `size` bytes from host memory at `src` to device memory at `dst` on
+// `stream`, without waiting for the copy to finish. When `src` is not pinned,
+// it is staged through pinned buffers from the caching host allocator, so that
+// the host only waits for its own memcpy into them. `src_base` is the start of
+// the host allocation that `src` points into.
+THC_API void THCudaMemcpyAsyncHostToDevice(THCState *state, void *dst, const void *src,
+                                           const void *src_base, size_t size,
+                                           THCStream *stream);
+
 #include "generic/THCTensorCopy.h"
 #include "THCGenerateAllTypes.h"
 
@@ -9,6 +9,10 @@
 #include "THCTensorTypeUtils.cuh"
 
 #include "THCThrustAllocator.cuh"
+#include <climits>
+#ifndef __HIP_PLATFORM_HCC__
+#include <cub/device/device_segmented_radix_sort.cuh>
+#endif
 #include <thrust/device_ptr.h>
 #include <thrust/sort.h>
 #if CUDA_VERSION >= 7000 || defined(__HIP_PLATFORM_HCC__)
@@ -82,6 +86,48 @@ struct GlobalIndexToPerSliceIndex {
   const int64_t sliceSize;
 };
 
+#ifndef __HIP_PLATFORM_HCC__
+// Fills the numSlices + 1 offsets of the slices of a contiguous tensor,
+// slice i spans [offsets[i], offsets[i + 1])
+template <typename IndexType>
+__global__ void
+fillSegmentOffsets(IndexType* offsets,
+                   IndexType numSlices,
+                   IndexType sliceSize) {
+  for (IndexType i = blockIdx.x * blockDim.x + threadIdx.x; i <= numSlices;
+       i += gridDim.x * blockDim.x) {
+    offsets[i] = i * sliceSize;
+  }
+}
+
+// Sorts the (key, index) pairs of every segment with a single CUB segmented
+// radix sort; the sort is stable. With a null storage, only sets
+// storageBytes to the size of the temporary storage needed.
+template <typename T>
+cudaError_t segmentedRadixSortPairs(void* storage,
+                                    size_t& storageBytes,
+                                    const T* keysIn,
+                                    T* keysOut,
+                                    const int64_t* valuesIn,
+                                    int64_t* valuesOut,
+                                    int numItems,
+                                    int numSegments,
+                                    const int* offsets,
+                                    bool descending,
+                                    cudaStream_t stream) {
+  if (descending) {
+    return cub::DeviceSegmentedRadixSort::SortPairsDescending(
+      storage, storageBytes, keysIn, keysOut, valuesIn, valuesOut,
+      numItems, numSegments, offsets, offsets + 1,
+      0, sizeof(T) * 8, stream);
+  }
+  return cub::DeviceSegmentedRadixSort::SortPairs(
+    storage, storageBytes, keysIn, keysOut, valuesIn, valuesOut,
+    numItems, numSegments, offsets, offsets + 1,
+    0, sizeof(T) * 8, stream);
+}
+#endif
+
 void THCudaLongTensor_fillSliceWithIndex(THCState* state,
                                          THCudaLongTensor* t,
                                          int dim);
@@ -131,14 +131,15 @@ void THCTensor_(copyAsyncCPU)(THCState *state, THCTensor *self, struct THTensor
     THCudaCheck(cudaSetDevice(tensorDevice));
   }
 
+  // Pageable memory is staged through pinned buffers, so this does not wait
+  // for the device either way.
   THCStream *stream  = THCState_getStream(state);
-  THCudaCheck(cudaMemcpyAsync(THCTensor_(data)(state, self),
-                              src->data<scalar_t>(),
-                              THTensor_(nElement)(src) * sizeof(scalar_t),
-                              cudaMemcpyHostToDevice,
-                              THCStream_stream(stream)));
-
-  THCudaCheck(THCCachingHostAllocator_recordEvent(THStorage_(data)(THTensor_getStoragePtr(src)), stream));
+  THCudaMemcpyAsyncHostToDevice(state,
+                                THCTensor_(data)(state, self),
+                                src->data<scalar_t>(),
+                                THStorage_(data)(THTensor_getStoragePtr(src)),
+                                THTensor_(nElement)(src) * sizeof(scalar_t),
+                                stream);
 
   if (currentDevice != tensorDevice) {
     THCudaCheck(cudaSetDevice(currentDevice));
@@ -274,6 +274,78 @@ void THCTensor_(sortViaThrust)(THCState* state,
   THCudaLongTensor_freeCopyTo(state, trContigIndices, indices);
 }
 
+#if !defined(THC_REAL_IS_HALF) && !defined(__HIP_PLATFORM_HCC__)
+void THCTensor_(sortViaSegmentedRadixSort)(THCState* state,
+                                           THCTensor* sorted,
+                                           THCudaLongTensor* indices,
+                                           THCTensor* input,
+                                           int dim, bool dir) {
+  int nDims = THCTensor_(nDimensionLegacyAll)(state, input);
+
+  ptrdiff_t totalElements = THCTensor_(nElement)(state, input);
+  if (totalElements == 0) {
+    return;
+  }
+  int64_t sliceSize = THCTensor_(sizeLegacyNoScalars)(state, input, dim);
+  int numSlices = (int) (totalElements / sliceSize);
+  cudaStream_t stream = THCState_getCurrentStream(state);
+
+  // Every slice is a segment of the sort, which needs the slices to be
+  // innermost and contiguous. Unlike the Thrust sort, all the slices are
+  // sorted in a single pass of the radix sort, which is stable.
+  THCTensor* trInput = THCTensor_(newWithTensor)(state, input);
+  if (dim != nDims - 1) {
+    THCTensor_(transpose)(state, trInput, NULL, dim, nDims - 1);
+  }
+  THCTensor* keysIn = THCTensor_(newContiguous)(state, trInput);
+  THCTensor_(free)(state, trInput);
+  THCTensor* keysOut = THCTensor_(new)(state);
+  THCTensor_(resizeAs)(state, keysOut, keysIn);
+
+  THCudaLongTensor* valuesIn = THCudaLongTensor_new(state);
+  THCudaLongTensor_resize(state, valuesIn, keysIn->sizes(), {});
+  THCudaLongTensor_fillSliceWithIndex(state, valuesIn, nDims - 1);
+  THCudaLongTensor* valuesOut = THCudaLongTensor_new(state);
+  THCudaLongTensor_resizeAs(state, valuesOut, valuesIn);
+
+  // The offsets and the temporary storage of the sort come from the
+  // caching allocator
+  int* offsets = (int*) THCudaMalloc(state, (numSlices + 1) * sizeof(int));
+  int offsetBlocks = (int) std::min(
+    THCCeilDiv((int64_t) numSlices + 1, (int64_t) 256), (int64_t) 1024);
+  fillSegmentOffsets<int><<<offsetBlocks, 256, 0, stream>>>(
+    offsets, numSlices, (int) sliceSize);
+
+  size_t storageBytes = 0;
+  THCudaCheck(segmentedRadixSortPairs<scalar_t>(
+    NULL, storageBytes,
+    THCTensor_(data)(state, keysIn), THCTensor_(data)(state, keysOut),
+    THCudaLongTensor_data(state, valuesIn),
+    THCudaLongTensor_data(state, valuesOut),
+    (int) totalElements, numSlices, offsets, dir, stream));
+  void* storage = THCudaMalloc(state, storageBytes);
+  THCudaCheck(segmentedRadixSortPairs<scalar_t>(
+    storage, storageBytes,
+    THCTensor_(data)(state, keysIn), THCTensor_(data)(state, keysOut),
+    THCudaLongTensor_data(state, valuesIn),
+    THCudaLongTensor_data(state, valuesOut),
+    (int) totalElements, numSlices, offsets, dir, stream));
+  THCudaFree(state, storage);
+  THCudaFree(state, offsets);
+  THCTensor_(free)(state, keysIn);
+  THCudaLongTensor_free(state, valuesIn);
+
+  // Reverse the transposition as needed
+  if (dim != nDims - 1) {
+    THCTensor_(transpose)(state, keysOut, NULL, dim, nDims - 1);
+    THCudaLongTensor_transpose(state, valuesOut, NULL, dim, nDims - 1);
+  }
+
+  THCTensor_(freeCopyTo)(state, keysOut, sorted);
+  THCudaLongTensor_freeCopyTo(state, valuesOut, indices);
+}
+#endif
+
 void THCTensor_(sort)(THCState* state,
                       THCTensor *sorted,
                       THCudaLongTensor *indices,
@@ -325,6 +397,13 @@ void THCTensor_(sort)(THCState* state,
     // Sort using our in-place k/v kernel that supports arbitrary
     // layout
     THCTensor_(sortKeyValueInplace)(state, sorted, indices, dim, order);
+#if !defined(THC_REAL_IS_HALF) && !defined(__HIP_PLATFORM_HCC__)
+  } else if (THCTensor_(nElement)(state, input) <= INT_MAX) {
+    // Sort all the slices at once with a segmented radix sort, which is
+    // much faster than Thrust for large batches of medium slices
+    THCTensor_(sortViaSegmentedRadixSort)(
+      state, sorted, indices, input, dim, (bool) order);
+#endif
   } else {
     // Otherwise, fall back upon Thrust, which handles all other cases
     // (potentially slowly, with extra copies/memory allocations)
@@ -139,12 +139,13 @@ void THCTensor_(topk)(THCState* state,
   // selection routine does not ensure sorting
   if (sorted) {
     // FIXME: the k/v inplace sort along slice only works for size <=
-    // 2048 at the moment
+    // 2048 at the moment. The slices being sorted are the k selected
+    // elements, not the input slices.
 #ifdef __HIP_PLATFORM_HCC__
     // TODO bitonicSortKVInPlace hangs on ROCm currently.
     if (0) {
 #else
-    if (sliceSize <= 2048) {
+    if (k <= 2048) {
 #endif
       // This avoids any memory allocations and performs all sorting
       // work inplace along the slice
@@ -152,12 +153,11 @@ void THCTensor_(topk)(THCState* state,
     } else {
       // Depend upon the backup sort that returns indices, which we
       // can use in conjunction with gather to produce the original
-      // indices.
-      // This is not the most efficient implementation, especially since
-      // there are memory allocations performed here. If the user desires
-      // greater performance, they should torch.gather() the results
-      // themselves using the reported indices, providing previously
-      // allocated tensors to receive the results.
+      // indices. All the slices are sorted by a single segmented radix
+      // sort, but there are memory allocations performed here. If the
+      // user desires greater performance, they should torch.gather() the
+      // results themselves using the reported indices, providing
+      // previously allocated tensors to receive the results.
       THCTensor* sortedTopK = THCTensor_(new)(state);
       THCudaLongTensor* sortedIndices = THCudaLongTensor_new(state);
       THCTensor_(sort)(state, sortedTopK, sortedIndices, topK, dim, dir);
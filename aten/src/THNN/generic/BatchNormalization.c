@@ -2,6 +2,59 @@
 #define TH_GENERIC_FILE "generic/BatchNormalization.c"
 #else
 
+// The input is viewed as nBatch x nInput x planeSize, where every plane (the
+// values of one channel of one sample) is contiguous. The kernels below run
+// flat loops over planes, which the compiler vectorizes, and parallelize over
+// all nBatch * nInput planes, so that small batches or few channels still
+// keep every thread busy.
+static inline int64_t THNN_(BatchNormalization_planeGrain)(int64_t planeSize)
+{
+  return std::max<int64_t>(at::internal::GRAIN_SIZE / std::max<int64_t>(planeSize, 1), 1);
+}
+
+// Chan et al.'s pairwise update of the count, mean and sum of squared
+// deviations (m2) of a set of values with those of another set.
+static inline void THNN_(BatchNormalization_mergeMoments)(
+  accreal *count, accreal *mean, accreal *m2,
+  accreal count_b, accreal mean_b, accreal m2_b)
+{
+  if (count_b == 0) {
+    return;
+  }
+  accreal total = *count + count_b;
+  accreal delta = mean_b - *mean;
+  *mean += delta * count_b / total;
+  *m2 += m2_b + delta * delta * *count * count_b / total;
+  *count = total;
+}
+
+// Mean and m2 of the n values of x in a single pass over memory: every chunk
+// is summed and then centered while it is still in cache, and the chunks are
+// merged pairwise.
+static void THNN_(BatchNormalization_planeMoments)(
+  const scalar_t *x, int64_t n, accreal *mean, accreal *m2)
+{
+  const int64_t chunkSize = 2048;
+  accreal count = 0;
+  *mean = 0;
+  *m2 = 0;
+  for (int64_t i = 0; i < n; i += chunkSize) {
+    const int64_t len = std::min(chunkSize, n - i);
+    const scalar_t *xc = x + i;
+    accreal sum = 0;
+    for (int64_t j = 0; j < len; j++) {
+      sum += xc[j];
+    }
+    const accreal chunkMean = sum / len;
+    accreal sq = 0;
+    for (int64_t j = 0; j < len; j++) {
+      const accreal delta = xc[j] - chunkMean;
+      sq += delta * delta;
+    }
+    THNN_(BatchNormalization_mergeMoments)(&count, mean, m2, len, chunkMean, sq);
+  }
+}
+
 void THNN_(BatchNormalization_updateOutput)(
   THNNState *state, THTensor *input, THTensor *output,
   THTensor *weight, THTensor *bias,
@@ -11,66 +64,93 @@ void THNN_(BatchNormalization_updateOutput)(
 {
   THTensor_(resizeAs)(output, input);
   int64_t nInput = THTensor_(size)(input, 1);
-  int64_t f;
+  int64_t nBatch = THTensor_(size)(input, 0);
+  int64_t nPlanes = nBatch * nInput;
   ptrdiff_t n = THTensor_(nElement)(input) / nInput;
+  int64_t planeSize = nPlanes > 0 ? THTensor_(nElement)(input) / nPlanes : 0;
 
   if (train) {
     THTensor_(resize1d)(save_mean, nInput);
     THTensor_(resize1d)(save_std, nInput);
   }
 
-  #pragma omp parallel for
-  for (f = 0; f < nInput; ++f) {
-    THTensor *in = THTensor_(newSelect)(input, 1, f);
-    THTensor *out = THTensor_(newSelect)(output, 1, f);
-
-    scalar_t mean, invstd;
-
-    if (train) {
-      // compute mean per input
-      accreal sum = 0;
-      TH_TENSOR_APPLY(scalar_t, in, sum += *in_data;);
+  input = THTensor_(newContiguous)(input);
+  const scalar_t *input_data = input->data<scalar_t>();
+  scalar_t *output_data = output->data<scalar_t>();
+  const int64_t grain = THNN_(BatchNormalization_planeGrain)(planeSize);
 
-      mean = (scalar_t) sum / n;
-      THTensor_(set1d)(save_mean, f, (scalar_t) mean);
+  std::vector<accreal> mean(nInput);
+  std::vector<accreal> invstd(nInput);
+  if (train) {
+    // moments of every plane, then merged per channel
+    std::vector<accreal> planeMean(nPlanes);
+    std::vector<accreal> planeM2(nPlanes);
+    at::parallel_for(0, nPlanes, grain, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        THNN_(BatchNormalization_planeMoments)(
+          input_data + i * planeSize, planeSize, &planeMean[i], &planeM2[i]);
+      }
+    });
 
-      // compute variance per input
-      sum = 0;
-      TH_TENSOR_APPLY(scalar_t, in,
-        sum += (*in_data - mean) * (*in_data - mean););
+    for (int64_t f = 0; f < nInput; ++f) {
+      accreal count = 0;
+      accreal m = 0;
+      accreal sum = 0;  // sum of squared deviations from the mean
+      for (int64_t b = 0; b < nBatch; ++b) {
+        THNN_(BatchNormalization_mergeMoments)(
+          &count, &m, &sum, planeSize, planeMean[b * nInput + f], planeM2[b * nInput + f]);
+      }
+      mean[f] = m;
+      THTensor_(set1d)(save_mean, f, (scalar_t) m);
 
       if (sum == 0 && eps == 0.0) {
-        invstd = 0;
+        invstd[f] = 0;
       } else {
-        invstd = (scalar_t) (1 / sqrt(sum/n + eps));
+        invstd[f] = (scalar_t) (1 / sqrt(sum/n + eps));
       }
-      THTensor_(set1d)(save_std, f, (scalar_t) invstd);
+      THTensor_(set1d)(save_std, f, (scalar_t) invstd[f]);
 
       // update running averages
       if (running_mean) {
         THTensor_(set1d)(running_mean, f,
-          (scalar_t) (momentum * mean + (1 - momentum) * THTensor_(get1d)(running_mean, f)));
+          (scalar_t) (momentum * m + (1 - momentum) * THTensor_(get1d)(running_mean, f)));
       }
       if (running_var) {
         accreal unbiased_var = sum / (n - 1);
         THTensor_(set1d)(running_var, f,
           (scalar_t) (momentum * unbiased_var + (1 - momentum) * THTensor_(get1d)(running_var, f)));
       }
-    } else {
-      mean = THTensor_(get1d)(running_mean, f);
-      invstd = 1 / sqrt(THTensor_(get1d)(running_var, f) + eps);
     }
+  } else {
+    for (int64_t f = 0; f < nInput; ++f) {
+      mean[f] = THTensor_(get1d)(running_mean, f);
+      invstd[f] = 1 / sqrt(THTensor_(get1d)(running_var, f) + eps);
+    }
+  }
 
-    // compute output
+  // compute output: ((x - mean) * invstd) * w + b = x * scale + shift
+  std::vector<scalar_t> scale(nInput);
+  std::vector<scalar_t> shift(nInput);
+  for (int64_t f = 0; f < nInput; ++f) {
     scalar_t w = weight ? THTensor_(get1d)(weight, f) : 1;
     scalar_t b = bias ? THTensor_(get1d)(bias, f) : 0;
+    scale[f] = (scalar_t) (invstd[f] * w);
+    shift[f] = (scalar_t) (b - mean[f] * invstd[f] * w);
+  }
 
-    TH_TENSOR_APPLY2(scalar_t, in, scalar_t, out,
-      *out_data = (scalar_t) (((*in_data - mean) * invstd) * w + b););
+  at::parallel_for(0, nPlanes, grain, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t a = scale[i % nInput];
+      const scalar_t c = shift[i % nInput];
+      const scalar_t *x = input_data + i * planeSize;
+      scalar_t *y = output_data + i * planeSize;
+      for (int64_t j = 0; j < planeSize; j++) {
+        y[j] = x[j] * a + c;
+      }
+    }
+  });
 
-    c10::raw::intrusive_ptr::decref(out);
-    c10::raw::intrusive_ptr::decref(in);
-  }
+  c10::raw::intrusive_ptr::decref(input);
 }
 
 void THNN_(BatchNormalization_backward)(
@@ -82,79 +162,125 @@ void THNN_(BatchNormalization_backward)(
 {
   THNN_CHECK_SHAPE(input, gradOutput);
   int64_t nInput = THTensor_(size)(input, 1);
-  int64_t f;
+  int64_t nBatch = THTensor_(size)(input, 0);
+  int64_t nPlanes = nBatch * nInput;
   ptrdiff_t n = THTensor_(nElement)(input) / nInput;
+  int64_t planeSize = nPlanes > 0 ? THTensor_(nElement)(input) / nPlanes : 0;
 
   if (gradInput) {
     THTensor_(resizeAs)(gradInput, input);
   }
 
-  #pragma omp parallel for
-  for (f = 0; f < nInput; ++f) {
-    THTensor *in = THTensor_(newSelect)(input, 1, f);
-    THTensor *gradOut = THTensor_(newSelect)(gradOutput, 1, f);
-    scalar_t w = weight ? THTensor_(get1d)(weight, f) : 1;
-    scalar_t mean, invstd;
+  input = THTensor_(newContiguous)(input);
+  gradOutput = THTensor_(newContiguous)(gradOutput);
+  const scalar_t *input_data = input->data<scalar_t>();
+  const scalar_t *gradOutput_data = gradOutput->data<scalar_t>();
+  const int64_t grain = THNN_(BatchNormalization_planeGrain)(planeSize);
+
+  std::vector<scalar_t> w(nInput);
+  std::vector<scalar_t> mean(nInput);
+  std::vector<scalar_t> invstd(nInput);
+  for (int64_t f = 0; f < nInput; ++f) {
+    w[f] = weight ? THTensor_(get1d)(weight, f) : 1;
     if (train) {
-      mean = THTensor_(get1d)(save_mean, f);
-      invstd = THTensor_(get1d)(save_std, f);
+      mean[f] = THTensor_(get1d)(save_mean, f);
+      invstd[f] = THTensor_(get1d)(save_std, f);
     } else {
-      mean = THTensor_(get1d)(running_mean, f);
-      invstd = 1 / sqrt(THTensor_(get1d)(running_var, f) + eps);
+      mean[f] = THTensor_(get1d)(running_mean, f);
+      invstd[f] = 1 / sqrt(THTensor_(get1d)(running_var, f) + eps);
     }
+  }
 
-    // sum over all gradOutput in feature plane
-    accreal sum = 0;
-    TH_TENSOR_APPLY(scalar_t, gradOut, sum += *gradOut_data;);
-
-    // dot product of the Q(X) and gradOuput
-    accreal dotp = 0;
-    TH_TENSOR_APPLY2(scalar_t, in, scalar_t, gradOut,
-      dotp += (*in_data - mean) * (*gradOut_data););
+  // per plane: the sum of gradOutput, and the dot product of Q(X) and gradOutput
+  std::vector<accreal> planeSum(nPlanes);
+  std::vector<accreal> planeDotp(nPlanes);
+  at::parallel_for(0, nPlanes, grain, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t m = mean[i % nInput];
+      const scalar_t *x = input_data + i * planeSize;
+      const scalar_t *dy = gradOutput_data + i * planeSize;
+      accreal sum = 0;
+      accreal dotp = 0;
+      for (int64_t j = 0; j < planeSize; j++) {
+        sum += dy[j];
+        dotp += (x[j] - m) * dy[j];
+      }
+      planeSum[i] = sum;
+      planeDotp[i] = dotp;
+    }
+  });
 
-    if (gradInput) {
-      THTensor *gradIn = THTensor_(newSelect)(gradInput, 1, f);
+  std::vector<accreal> sum(nInput, 0);
+  std::vector<accreal> dotp(nInput, 0);
+  for (int64_t b = 0; b < nBatch; ++b) {
+    for (int64_t f = 0; f < nInput; ++f) {
+      sum[f] += planeSum[b * nInput + f];
+      dotp[f] += planeDotp[b * nInput + f];
+    }
+  }
 
+  if (gradInput) {
+    // dL/dX = dy * a + x * k + c per channel
+    std::vector<scalar_t> a(nInput);
+    std::vector<scalar_t> k(nInput, 0);
+    std::vector<scalar_t> c(nInput, 0);
+    for (int64_t f = 0; f < nInput; ++f) {
+      a[f] = invstd[f] * w[f];
       if (train) {
         // when in training mode
         // Q(X) = X - E[x] ; i.e. input centered to zero mean
         // Y = Q(X) / σ    ; i.e. BN output before weight and bias
         // dL/dX = (Q(dL/dY) - dot(Y, dL/dY) * Y) / σ * w
-
-        // projection of gradOutput on to output scaled by std
-        scalar_t k = (scalar_t) dotp * invstd * invstd / n;
-        TH_TENSOR_APPLY2(scalar_t, gradIn, scalar_t, in,
-          *gradIn_data = (*in_data - mean) * k;);
-
-        accreal gradMean = sum / n;
-        TH_TENSOR_APPLY2(scalar_t, gradIn, scalar_t, gradOut,
-          *gradIn_data = (*gradOut_data - gradMean - *gradIn_data) * invstd * w;);
-
+        scalar_t proj = (scalar_t) dotp[f] * invstd[f] * invstd[f] / n;
+        accreal gradMean = sum[f] / n;
+        k[f] = -proj * a[f];
+        c[f] = (scalar_t) ((mean[f] * proj - gradMean) * a[f]);
       } else {
         // when in evaluation mode
         // Q(X) = X - running_mean  ; i.e. input centered to zero mean
         // Y = Q(X) / running_std    ; i.e. BN output before weight and bias
         // dL/dX = w / running_std
-        TH_TENSOR_APPLY2(scalar_t, gradIn, scalar_t, gradOut,
-          *gradIn_data = *gradOut_data * invstd * w;);
+        // so k and c stay 0, and the loop below skips them
       }
-
-      c10::raw::intrusive_ptr::decref(gradIn);
     }
 
+    scalar_t *gradInput_data = gradInput->data<scalar_t>();
+    at::parallel_for(0, nPlanes, grain, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        const int64_t f = i % nInput;
+        const scalar_t *x = input_data + i * planeSize;
+        const scalar_t *dy = gradOutput_data + i * planeSize;
+        scalar_t *dx = gradInput_data + i * planeSize;
+        const scalar_t af = a[f];
+        if (train) {
+          const scalar_t kf = k[f];
+          const scalar_t cf = c[f];
+          for (int64_t j = 0; j < planeSize; j++) {
+            dx[j] = dy[j] * af + x[j] * kf + cf;
+          }
+        } else {
+          for (int64_t j = 0; j < planeSize; j++) {
+            dx[j] = dy[j] * af;
+          }
+        }
+      }
+    });
+  }
+
+  for (int64_t f = 0; f < nInput; ++f) {
     if (gradWeight) {
       scalar_t val = THTensor_(get1d)(gradWeight, f);
-      THTensor_(set1d)(gradWeight, f, val + scale * dotp * invstd);
+      THTensor_(set1d)(gradWeight, f, val + scale * dotp[f] * invstd[f]);
     }
 
     if (gradBias) {
       scalar_t val = THTensor_(get1d)(gradBias, f);
-      THTensor_(set1d)(gradBias, f, val + scale * sum);
+      THTensor_(set1d)(gradBias, f, val + scale * sum[f]);
     }
-
-    c10::raw::intrusive_ptr::decref(gradOut);
-    c10::raw::intrusive_ptr::decref(in);
   }
+
+  c10::raw::intrusive_ptr::decref(gradOutput);
+  c10::raw::intrusive_ptr::decref(input);
 }
 
 #endif
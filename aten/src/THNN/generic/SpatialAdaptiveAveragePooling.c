@@ -22,7 +22,6 @@ static void THNN_(SpatialAdaptiveAveragePooling_updateOutput_frame)(
           int64_t istrideW)
 {
   int64_t d;
-#pragma omp parallel for private(d)
   for (d = 0; d < sizeD; d++)
   {
     /* loop over output */
@@ -112,37 +111,32 @@ void THNN_(SpatialAdaptiveAveragePooling_updateOutput)(
   if (input->dim() == 3)
   {
     THTensor_(resize3d)(output, sizeD, osizeH, osizeW);
-
-    input_data = input->data<scalar_t>();
-    output_data = output->data<scalar_t>();
-
-    THNN_(SpatialAdaptiveAveragePooling_updateOutput_frame)(input_data, output_data,
-                                                      sizeD,
-                                                      isizeH, isizeW,
-                                                      osizeH, osizeW,
-                                                      istrideD,
-                                                      istrideH, istrideW);
   }
   else
   {
-    int64_t b;
-
     THTensor_(resize4d)(output, sizeB, sizeD, osizeH, osizeW);
+  }
 
-    input_data = input->data<scalar_t>();
-    output_data = output->data<scalar_t>();
+  input_data = input->data<scalar_t>();
+  output_data = output->data<scalar_t>();
 
-#pragma omp parallel for private(b)
-    for (b = 0; b < sizeB; b++)
+  /* every plane of every frame is independent; parallelizing over all of them
+     keeps the threads busy for small batches too */
+  const int64_t grain = std::max<int64_t>(at::internal::GRAIN_SIZE / (isizeH*isizeW), 1);
+  at::parallel_for(0, sizeB * sizeD, grain, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++)
     {
-      THNN_(SpatialAdaptiveAveragePooling_updateOutput_frame)(input_data+b*istrideB, output_data+b*sizeD*osizeH*osizeW,
-                                                      sizeD,
-                                                      isizeH, isizeW,
-                                                      osizeH, osizeW,
-                                                      istrideD,
-                                                      istrideH, istrideW);
+      int64_t b = i / sizeD;
+      int64_t d = i % sizeD;
+      THNN_(SpatialAdaptiveAveragePooling_updateOutput_frame)(
+          input_data + b*istrideB + d*istrideD, output_data + i*osizeH*osizeW,
+          1,
+          isizeH, isizeW,
+          osizeH, osizeW,
+          istrideD,
+          istrideH, istrideW);
     }
-  }
+  });
 }
 
 static void THNN_(SpatialAdaptiveAveragePooling_updateGradInput_frame)(
@@ -155,7 +149,6 @@ static void THNN_(SpatialAdaptiveAveragePooling_updateGradInput_frame)(
           int64_t osizeW)
 {
   int64_t d;
-#pragma omp parallel for private(d)
   for (d = 0; d < sizeD; d++)
   {
     scalar_t *gradInput_p_d = gradInput_p + d*isizeW*isizeH;
@@ -235,26 +228,18 @@ void THNN_(SpatialAdaptiveAveragePooling_updateGradInput)(
   gradInput_data = gradInput->data<scalar_t>();
   gradOutput_data = gradOutput->data<scalar_t>();
 
-  /* backprop */
-  if (input->dim() == 3)
-  {
-    THNN_(SpatialAdaptiveAveragePooling_updateGradInput_frame)(gradInput_data, gradOutput_data,
-                                                         sizeD,
-                                                         isizeH, isizeW,
-                                                         osizeH, osizeW);
-  }
-  else
-  {
-    int64_t b;
-#pragma omp parallel for private(b)
-    for (b = 0; b < sizeB; b++)
+  /* backprop, in parallel over all planes of all frames as above */
+  const int64_t grain = std::max<int64_t>(at::internal::GRAIN_SIZE / (isizeH*isizeW), 1);
+  at::parallel_for(0, sizeB * sizeD, grain, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++)
     {
-      THNN_(SpatialAdaptiveAveragePooling_updateGradInput_frame)(gradInput_data+b*sizeD*isizeH*isizeW, gradOutput_data+b*sizeD*osizeH*osizeW,
-                                                           sizeD,
-                                                           isizeH, isizeW,
-                                                           osizeH, osizeW);
+      THNN_(SpatialAdaptiveAveragePooling_updateGradInput_frame)(
+          gradInput_data + i*isizeH*isizeW, gradOutput_data + i*osizeH*osizeW,
+          1,
+          isizeH, isizeW,
+          osizeH, osizeW);
     }
-  }
+  });
 
   /* cleanup */
   c10::raw::intrusive_ptr::decref(gradOutput);
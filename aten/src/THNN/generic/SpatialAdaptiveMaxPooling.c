@@ -23,7 +23,6 @@ static void THNN_(SpatialAdaptiveMaxPooling_updateOutput_frame)(
           int64_t istrideW)
 {
   int64_t d;
-#pragma omp parallel for private(d)
   for (d = 0; d < sizeD; d++)
   {
     /* loop over output */
@@ -123,43 +122,36 @@ void THNN_(SpatialAdaptiveMaxPooling_updateOutput)(
     THTensor_(resize3d)(output, sizeD, osizeH, osizeW);
     /* indices will contain i,j locations for each output point */
     THIndexTensor_(resize3d)(indices, sizeD, osizeH, osizeW);
-
-    input_data = input->data<scalar_t>();
-    output_data = output->data<scalar_t>();
-    indices_data = THIndexTensor_(data)(indices);
-
-    THNN_(SpatialAdaptiveMaxPooling_updateOutput_frame)(input_data, output_data,
-                                                      indices_data,
-                                                      sizeD,
-                                                      isizeH, isizeW,
-                                                      osizeH, osizeW,
-                                                      istrideD,
-                                                      istrideH, istrideW);
   }
   else
   {
-    int64_t b;
-
     THTensor_(resize4d)(output, sizeB, sizeD, osizeH, osizeW);
     /* indices will contain i,j locations for each output point */
     THIndexTensor_(resize4d)(indices, sizeB, sizeD, osizeH, osizeW);
+  }
 
-    input_data = input->data<scalar_t>();
-    output_data = output->data<scalar_t>();
-    indices_data = THIndexTensor_(data)(indices);
+  input_data = input->data<scalar_t>();
+  output_data = output->data<scalar_t>();
+  indices_data = THIndexTensor_(data)(indices);
 
-#pragma omp parallel for private(b)
-    for (b = 0; b < sizeB; b++)
+  /* every plane of every frame is independent; parallelizing over all of them
+     keeps the threads busy for small batches too */
+  const int64_t grain = std::max<int64_t>(at::internal::GRAIN_SIZE / (isizeH*isizeW), 1);
+  at::parallel_for(0, sizeB * sizeD, grain, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++)
     {
-      THNN_(SpatialAdaptiveMaxPooling_updateOutput_frame)(input_data+b*istrideB, output_data+b*sizeD*osizeH*osizeW,
-                                                        indices_data+b*sizeD*osizeH*osizeW,
-                                                        sizeD,
-                                                        isizeH, isizeW,
-                                                        osizeH, osizeW,
-                                                        istrideD,
-                                                        istrideH, istrideW);
+      int64_t b = i / sizeD;
+      int64_t d = i % sizeD;
+      THNN_(SpatialAdaptiveMaxPooling_updateOutput_frame)(
+          input_data + b*istrideB + d*istrideD, output_data + i*osizeH*osizeW,
+          indices_data + i*osizeH*osizeW,
+          1,
+          isizeH, isizeW,
+          osizeH, osizeW,
+          istrideD,
+          istrideH, istrideW);
     }
-  }
+  });
 }
 
 static void THNN_(SpatialAdaptiveMaxPooling_updateGradInput_frame)(
@@ -173,7 +165,6 @@ static void THNN_(SpatialAdaptiveMaxPooling_updateGradInput_frame)(
           int64_t osizeW)
 {
   int64_t d;
-#pragma omp parallel for private(d)
   for (d = 0; d < sizeD; d++)
   {
     scalar_t *gradInput_p_d = gradInput_p + d*isizeH*isizeW;
@@ -240,28 +231,19 @@ void THNN_(SpatialAdaptiveMaxPooling_updateGradInput)(
   gradOutput_data = gradOutput->data<scalar_t>();
   indices_data = THIndexTensor_(data)(indices);
 
-  /* backprop */
-  if (input->dim() == 3)
-  {
-    THNN_(SpatialAdaptiveMaxPooling_updateGradInput_frame)(gradInput_data, gradOutput_data,
-                                                           indices_data,
-                                                           sizeD,
-                                                           isizeH, isizeW,
-                                                           osizeH, osizeW);
-  }
-  else
-  {
-    int64_t b;
-#pragma omp parallel for private(b)
-    for (b = 0; b < sizeB; b++)
+  /* backprop, in parallel over all planes of all frames as above */
+  const int64_t grain = std::max<int64_t>(at::internal::GRAIN_SIZE / (isizeH*isizeW), 1);
+  at::parallel_for(0, sizeB * sizeD, grain, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++)
     {
-      THNN_(SpatialAdaptiveMaxPooling_updateGradInput_frame)(gradInput_data+b*sizeD*isizeH*isizeW, gradOutput_data+b*sizeD*osizeH*osizeW,
-                                                             indices_data+b*sizeD*osizeH*osizeW,
-                                                             sizeD,
-                                                             isizeH, isizeW,
-                                                             osizeH, osizeW);
+      THNN_(SpatialAdaptiveMaxPooling_updateGradInput_frame)(
+          gradInput_data + i*isizeH*isizeW, gradOutput_data + i*osizeH*osizeW,
+          indices_data + i*osizeH*osizeW,
+          1,
+          isizeH, isizeW,
+          osizeH, osizeW);
     }
-  }
+  });
 
   /* cleanup */
   c10::raw::intrusive_ptr::decref(gradOutput);
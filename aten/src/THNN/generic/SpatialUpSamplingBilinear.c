@@ -49,56 +49,79 @@ void THNN_(SpatialUpSamplingBilinear_updateOutput)(
      inputHeight, inputWidth,
      outputHeight, outputWidth);
 
-  input = THTensor_(newContiguous)(input);
-  THTensor_(resize4d)(output,
-		      THTensor_(size)(input, 0),
-		      THTensor_(size)(input, 1),
-		      outputHeight, outputWidth);
-  THTensor_(zero)(output);
-  scalar_t *idata = input->data<scalar_t>();
-  scalar_t *odata = output->data<scalar_t>();
-  channels = nbatch * channels;
+  const bool channels_last = upsampling_is_channels_last_2d(input);
+  if (channels_last) {
+    input = THTensor_(newWithTensor)(input);
+    int64_t size[4] = {nbatch, channels, outputHeight, outputWidth};
+    int64_t stride[4] = {(int64_t)outputHeight * outputWidth * channels, 1,
+                         (int64_t)outputWidth * channels, channels};
+    THTensor_(resizeNd)(output, 4, size, stride);
+  } else {
+    input = THTensor_(newContiguous)(input);
+    THTensor_(resize4d)(output, nbatch, channels, outputHeight, outputWidth);
+  }
   THAssert(inputHeight > 0 && inputWidth > 0 && outputHeight > 0 && outputWidth > 0);
   // special case: just copy
   if (inputHeight == outputHeight && inputWidth == outputWidth) {
-    for (int h2 = 0; h2 < outputHeight; ++h2) {
-      const int h1 = h2;
-      for (int w2 = 0; w2 < outputWidth; ++w2) {
-        const int w1 = w2;
-        const scalar_t* pos1 = &idata[h1 * inputWidth + w1];
-        scalar_t* pos2 = &odata[h2 * outputWidth + w2];
-        for (int c = 0; c < channels; ++c) {
-          pos2[0] = pos1[0];
-          pos1 += inputWidth * inputHeight;
-          pos2 += outputWidth * outputHeight;
-        }
-      }
-    }
+    THTensor_(copy)(output, input);
     c10::raw::intrusive_ptr::decref(input);
     return;
   }
-  const accreal rheight = linear_upsampling_compute_scale<accreal>(inputHeight, outputHeight, align_corners);
-  const accreal rwidth = linear_upsampling_compute_scale<accreal>(inputWidth, outputWidth, align_corners);
-  for (int h2 = 0; h2 < outputHeight; ++h2) {
-    const accreal h1r = linear_upsampling_compute_source_index<accreal>(rheight, h2, align_corners);
-    const int h1 = h1r;
-    const int h1p = (h1 < inputHeight - 1) ? 1 : 0;
-    const scalar_t h1lambda = h1r - h1;
-    const scalar_t h0lambda = (scalar_t)1. - h1lambda;
-    for (int w2 = 0; w2 < outputWidth; ++w2) {
-      const accreal w1r = linear_upsampling_compute_source_index<accreal>(rwidth, w2, align_corners);
-      const int w1 = w1r;
-      const int w1p = (w1 < inputWidth - 1) ? 1 : 0;
-      const scalar_t w1lambda = w1r - w1;
-      const scalar_t w0lambda = (scalar_t)1. - w1lambda;
-      const scalar_t* pos1 = &idata[h1 * inputWidth + w1];
-      scalar_t* pos2 = &odata[h2 * outputWidth + w2];
-      for (int c = 0; c < channels; ++c) {
-        pos2[0] = h0lambda * (w0lambda * pos1[0]+ w1lambda * pos1[w1p])
-                  + h1lambda * (w0lambda * pos1[h1p * inputWidth]
-                  + w1lambda * pos1[h1p * inputWidth + w1p]);
-        pos1 += inputWidth * inputHeight;
-        pos2 += outputWidth * outputHeight;
+  scalar_t *idata = input->data<scalar_t>();
+  scalar_t *odata = output->data<scalar_t>();
+  LinearUpsamplingWeights<scalar_t> hw, ww;
+  hw.compute<accreal>(inputHeight, outputHeight, align_corners);
+  ww.compute<accreal>(inputWidth, outputWidth, align_corners);
+  const int64_t outputSize = (int64_t)nbatch * channels * outputHeight * outputWidth;
+
+  if (channels_last) {
+    // one output row of one sample per iteration; the weights of each output
+    // pixel are applied to contiguous channel vectors
+    const int64_t C = channels;
+    const int64_t irowStride = (int64_t)inputWidth * C;
+    int64_t i;
+#pragma omp parallel for if (outputSize > THNN_UPSAMPLING_OMP_THRESHOLD) private(i)
+    for (i = 0; i < (int64_t)nbatch * outputHeight; ++i) {
+      const int64_t n = i / outputHeight;
+      const int h2 = i % outputHeight;
+      const scalar_t h0lambda = hw.lambda0[h2];
+      const scalar_t h1lambda = hw.lambda1[h2];
+      const scalar_t *row0 = idata + (n * inputHeight + hw.index[h2]) * irowStride;
+      const scalar_t *row1 = row0 + hw.offset[h2] * irowStride;
+      scalar_t *out = odata + i * outputWidth * C;
+      for (int w2 = 0; w2 < outputWidth; ++w2, out += C) {
+        const scalar_t w0lambda = ww.lambda0[w2];
+        const scalar_t w1lambda = ww.lambda1[w2];
+        const scalar_t *p00 = row0 + ww.index[w2] * C;
+        const scalar_t *p01 = p00 + ww.offset[w2] * C;
+        const scalar_t *p10 = row1 + ww.index[w2] * C;
+        const scalar_t *p11 = p10 + ww.offset[w2] * C;
+        for (int64_t c = 0; c < C; ++c) {
+          out[c] = h0lambda * (w0lambda * p00[c] + w1lambda * p01[c])
+                   + h1lambda * (w0lambda * p10[c] + w1lambda * p11[c]);
+        }
+      }
+    }
+  } else {
+    // one channel plane per iteration, written row by row
+    int64_t c;
+#pragma omp parallel for if (outputSize > THNN_UPSAMPLING_OMP_THRESHOLD) private(c)
+    for (c = 0; c < (int64_t)nbatch * channels; ++c) {
+      const scalar_t *iplane = idata + c * inputHeight * inputWidth;
+      scalar_t *out = odata + c * outputHeight * outputWidth;
+      for (int h2 = 0; h2 < outputHeight; ++h2, out += outputWidth) {
+        const scalar_t h0lambda = hw.lambda0[h2];
+        const scalar_t h1lambda = hw.lambda1[h2];
+        const scalar_t *row0 = iplane + hw.index[h2] * inputWidth;
+        const scalar_t *row1 = row0 + hw.offset[h2] * inputWidth;
+        for (int w2 = 0; w2 < outputWidth; ++w2) {
+          const int w1 = ww.index[w2];
+          const int w1p = ww.offset[w2];
+          const scalar_t w0lambda = ww.lambda0[w2];
+          const scalar_t w1lambda = ww.lambda1[w2];
+          out[w2] = h0lambda * (w0lambda * row0[w1] + w1lambda * row0[w1 + w1p])
+                    + h1lambda * (w0lambda * row1[w1] + w1lambda * row1[w1 + w1p]);
+        }
       }
     }
   }
@@ -123,54 +146,84 @@ void THNN_(SpatialUpSamplingBilinear_updateGradInput)(
      inputHeight, inputWidth,
      outputHeight, outputWidth);
 
-  THTensor_(resize4d)(gradInput, nbatch, channels, inputHeight, inputWidth);
+  const bool channels_last = upsampling_is_channels_last_2d(gradOutput);
+  if (channels_last) {
+    gradOutput = THTensor_(newWithTensor)(gradOutput);
+    int64_t size[4] = {nbatch, channels, inputHeight, inputWidth};
+    int64_t stride[4] = {(int64_t)inputHeight * inputWidth * channels, 1,
+                         (int64_t)inputWidth * channels, channels};
+    THTensor_(resizeNd)(gradInput, 4, size, stride);
+  } else {
+    gradOutput = THTensor_(newContiguous)(gradOutput);
+    THTensor_(resize4d)(gradInput, nbatch, channels, inputHeight, inputWidth);
+  }
+
+  // special case: same-size matching grids
+  if (inputHeight == outputHeight && inputWidth == outputWidth) {
+    THTensor_(copy)(gradInput, gradOutput);
+    c10::raw::intrusive_ptr::decref(gradOutput);
+    return;
+  }
   THTensor_(zero)(gradInput);
-  gradOutput = THTensor_(newContiguous)(gradOutput);
   scalar_t *data1 = gradInput->data<scalar_t>();
   scalar_t *data2 = gradOutput->data<scalar_t>();
-  channels = nbatch * channels;
+  LinearUpsamplingWeights<scalar_t> hw, ww;
+  hw.compute<accreal>(inputHeight, outputHeight, align_corners);
+  ww.compute<accreal>(inputWidth, outputWidth, align_corners);
+  const int64_t outputSize = (int64_t)nbatch * channels * outputHeight * outputWidth;
 
-  // special case: same-size matching grids
-  if (inputHeight == outputHeight && inputWidth == outputWidth) {
-    for (int h2 = 0; h2 < outputHeight; ++h2) {
-      const int h1 = h2;
-      for (int w2 = 0; w2 < outputWidth; ++w2) {
-        const int w1 = w2;
-        scalar_t* pos1 = &data1[h1 * inputWidth + w1];
-        const scalar_t* pos2 = &data2[h2 * outputWidth + w2];
-        for (int c = 0; c < channels; ++c) {
-          pos1[0] += pos2[0];
-          pos1 += inputWidth * inputHeight;
-          pos2 += outputWidth * outputHeight;
+  if (channels_last) {
+    // neighbouring output rows scatter into the same input rows, so only
+    // samples are processed in parallel
+    const int64_t C = channels;
+    const int64_t irowStride = (int64_t)inputWidth * C;
+    int64_t n;
+#pragma omp parallel for if (nbatch > 1 && outputSize > THNN_UPSAMPLING_OMP_THRESHOLD) private(n)
+    for (n = 0; n < nbatch; ++n) {
+      const scalar_t *gout = data2 + n * outputHeight * outputWidth * C;
+      for (int h2 = 0; h2 < outputHeight; ++h2) {
+        const scalar_t h0lambda = hw.lambda0[h2];
+        const scalar_t h1lambda = hw.lambda1[h2];
+        scalar_t *row0 = data1 + (n * inputHeight + hw.index[h2]) * irowStride;
+        scalar_t *row1 = row0 + hw.offset[h2] * irowStride;
+        for (int w2 = 0; w2 < outputWidth; ++w2, gout += C) {
+          const scalar_t w0lambda = ww.lambda0[w2];
+          const scalar_t w1lambda = ww.lambda1[w2];
+          scalar_t *p00 = row0 + ww.index[w2] * C;
+          scalar_t *p01 = p00 + ww.offset[w2] * C;
+          scalar_t *p10 = row1 + ww.index[w2] * C;
+          scalar_t *p11 = p10 + ww.offset[w2] * C;
+          for (int64_t c = 0; c < C; ++c) {
+            p00[c] += h0lambda * w0lambda * gout[c];
+            p01[c] += h0lambda * w1lambda * gout[c];
+            p10[c] += h1lambda * w0lambda * gout[c];
+            p11[c] += h1lambda * w1lambda * gout[c];
+          }
         }
       }
     }
-    c10::raw::intrusive_ptr::decref(gradOutput);
-    return;
-  }
-  const accreal rheight = linear_upsampling_compute_scale<accreal>(inputHeight, outputHeight, align_corners);
-  const accreal rwidth = linear_upsampling_compute_scale<accreal>(inputWidth, outputWidth, align_corners);
-  for (int h2 = 0; h2 < outputHeight; ++h2) {
-    const accreal h1r = linear_upsampling_compute_source_index<accreal>(rheight, h2, align_corners);
-    const int h1 = h1r;
-    const int h1p = (h1 < inputHeight - 1) ? 1 : 0;
-    const scalar_t h1lambda = h1r - h1;
-    const scalar_t h0lambda = (scalar_t)1. - h1lambda;
-    for (int w2 = 0; w2 < outputWidth; ++w2) {
-      const accreal w1r = linear_upsampling_compute_source_index<accreal>(rwidth, w2, align_corners);
-      const int w1 = w1r;
-      const int w1p = (w1 < inputWidth - 1) ? 1 : 0;
-      const scalar_t w1lambda = w1r - w1;
-      const scalar_t w0lambda = (scalar_t)1. - w1lambda;
-      scalar_t* pos1 = &data1[h1 * inputWidth + w1];
-      const scalar_t* pos2 = &data2[h2 * outputWidth + w2];
-      for (int c = 0; c < channels; ++c) {
-        pos1[0] += h0lambda * w0lambda * pos2[0];
-        pos1[w1p] += h0lambda * w1lambda * pos2[0];
-        pos1[h1p * inputWidth] += h1lambda * w0lambda * pos2[0];
-        pos1[h1p * inputWidth + w1p] += h1lambda * w1lambda * pos2[0];
-        pos1 += inputWidth * inputHeight;
-        pos2 += outputWidth * outputHeight;
+  } else {
+    // every channel plane only accumulates into its own input plane
+    int64_t c;
+#pragma omp parallel for if (outputSize > THNN_UPSAMPLING_OMP_THRESHOLD) private(c)
+    for (c = 0; c < (int64_t)nbatch * channels; ++c) {
+      scalar_t *iplane = data1 + c * inputHeight * inputWidth;
+      const scalar_t *gout = data2 + c * outputHeight * outputWidth;
+      for (int h2 = 0; h2 < outputHeight; ++h2, gout += outputWidth) {
+        const scalar_t h0lambda = hw.lambda0[h2];
+        const scalar_t h1lambda = hw.lambda1[h2];
+        scalar_t *row0 = iplane + hw.index[h2] * inputWidth;
+        scalar_t *row1 = row0 + hw.offset[h2] * inputWidth;
+        for (int w2 = 0; w2 < outputWidth; ++w2) {
+          const int w1 = ww.index[w2];
+          const int w1p = ww.offset[w2];
+          const scalar_t w0lambda = ww.lambda0[w2];
+          const scalar_t w1lambda = ww.lambda1[w2];
+          row0[w1] += h0lambda * w0lambda * gout[w2];
+          row0[w1 + w1p] += h0lambda * w1lambda * gout[w2];
+          row1[w1] += h1lambda * w0lambda * gout[w2];
+          row1[w1 + w1p] += h1lambda * w1lambda * gout[w2];
+        }
       }
     }
   }
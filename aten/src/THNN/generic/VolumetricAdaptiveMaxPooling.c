@@ -26,7 +26,6 @@ static void THNN_(VolumetricAdaptiveMaxPooling_updateOutput_frame)(
           int64_t istrideW)
 {
   int64_t d;
-#pragma omp parallel for private(d)
   for (d = 0; d < sizeD; d++)
   {
     /* loop over output */
@@ -145,43 +144,36 @@ void THNN_(VolumetricAdaptiveMaxPooling_updateOutput)(
     THTensor_(resize4d)(output, sizeD, osizeT, osizeH, osizeW);
     /* indices will contain max input locations for each output point */
     THIndexTensor_(resize4d)(indices, sizeD, osizeT, osizeH, osizeW);
-
-    input_data = input->data<scalar_t>();
-    output_data = output->data<scalar_t>();
-    indices_data = THIndexTensor_(data)(indices);
-
-    THNN_(VolumetricAdaptiveMaxPooling_updateOutput_frame)(input_data, output_data,
-                                                      indices_data,
-                                                      sizeD,
-                                                      isizeT, isizeH, isizeW,
-                                                      osizeT, osizeH, osizeW,
-                                                      istrideD, istrideT,
-                                                      istrideH, istrideW);
   }
   else
   {
-    int64_t b;
-
     THTensor_(resize5d)(output, sizeB, sizeD, osizeT, osizeH, osizeW);
     /* indices will contain max input locations for each output point */
     THIndexTensor_(resize5d)(indices, sizeB, sizeD, osizeT, osizeH, osizeW);
+  }
 
-    input_data = input->data<scalar_t>();
-    output_data = output->data<scalar_t>();
-    indices_data = THIndexTensor_(data)(indices);
+  input_data = input->data<scalar_t>();
+  output_data = output->data<scalar_t>();
+  indices_data = THIndexTensor_(data)(indices);
 
-#pragma omp parallel for private(b)
-    for (b = 0; b < sizeB; b++)
+  /* every plane of every frame is independent; parallelizing over all of them
+     keeps the threads busy for small batches too */
+  const int64_t grain = std::max<int64_t>(at::internal::GRAIN_SIZE / (isizeT*isizeH*isizeW), 1);
+  at::parallel_for(0, sizeB * sizeD, grain, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++)
     {
-      THNN_(VolumetricAdaptiveMaxPooling_updateOutput_frame)(input_data+b*istrideB, output_data+b*sizeD*osizeT*osizeH*osizeW,
-                                                        indices_data+b*sizeD*osizeT*osizeH*osizeW,
-                                                        sizeD,
-                                                        isizeT, isizeH, isizeW,
-                                                        osizeT, osizeH, osizeW,
-                                                        istrideD, istrideT,
-                                                        istrideH, istrideW);
+      int64_t b = i / sizeD;
+      int64_t d = i % sizeD;
+      THNN_(VolumetricAdaptiveMaxPooling_updateOutput_frame)(
+          input_data + b*istrideB + d*istrideD, output_data + i*osizeT*osizeH*osizeW,
+          indices_data + i*osizeT*osizeH*osizeW,
+          1,
+          isizeT, isizeH, isizeW,
+          osizeT, osizeH, osizeW,
+          istrideD, istrideT,
+          istrideH, istrideW);
     }
-  }
+  });
 }
 
 static void THNN_(VolumetricAdaptiveMaxPooling_updateGradInput_frame)(
@@ -197,7 +189,6 @@ static void THNN_(VolumetricAdaptiveMaxPooling_updateGradInput_frame)(
           int64_t osizeW)
 {
   int64_t d;
-#pragma omp parallel for private(d)
   for (d = 0; d < sizeD; d++)
   {
     scalar_t *gradInput_p_d = gradInput_p + d*isizeT*isizeH*isizeW;
@@ -275,28 +266,19 @@ void THNN_(VolumetricAdaptiveMaxPooling_updateGradInput)(
   gradOutput_data = gradOutput->data<scalar_t>();
   indices_data = THIndexTensor_(data)(indices);
 
-  /* backprop */
-  if (input->dim() == 4)
-  {
-    THNN_(VolumetricAdaptiveMaxPooling_updateGradInput_frame)(gradInput_data, gradOutput_data,
-                                                         indices_data,
-                                                         sizeD,
-                                                         isizeT, isizeH, isizeW,
-                                                         osizeT, osizeH, osizeW);
-  }
-  else
-  {
-    int64_t b;
-#pragma omp parallel for private(b)
-    for (b = 0; b < sizeB; b++)
+  /* backprop, in parallel over all planes of all frames as above */
+  const int64_t grain = std::max<int64_t>(at::internal::GRAIN_SIZE / (isizeT*isizeH*isizeW), 1);
+  at::parallel_for(0, sizeB * sizeD, grain, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++)
     {
-      THNN_(VolumetricAdaptiveMaxPooling_updateGradInput_frame)(gradInput_data+b*sizeD*isizeT*isizeH*isizeW, gradOutput_data+b*sizeD*osizeT*osizeH*osizeW,
-                                                           indices_data+b*sizeD*osizeT*osizeH*osizeW,
-                                                           sizeD,
-                                                           isizeT, isizeH, isizeW,
-                                                           osizeT, osizeH, osizeW);
+      THNN_(VolumetricAdaptiveMaxPooling_updateGradInput_frame)(
+          gradInput_data + i*isizeT*isizeH*isizeW, gradOutput_data + i*osizeT*osizeH*osizeW,
+          indices_data + i*osizeT*osizeH*osizeW,
+          1,
+          isizeT, isizeH, isizeW,
+          osizeT, osizeH, osizeW);
     }
-  }
+  });
 
   /* cleanup */
   c10::raw::intrusive_ptr::decref(gradOutput);
@@ -1,6 +1,8 @@
 #ifndef THNN_LINEAR_UPSAMPLING_H
 #define THNN_LINEAR_UPSAMPLING_H
 
+#include <vector>
+
 #undef MIN
 #define MIN(a,b) ( ((a)<(b)) ? (a) : (b) )
 #undef MAX
@@ -40,6 +42,53 @@ static inline T linear_upsampling_compute_source_index(
   }
 }
 
+// Source indices and interpolation weights of every output position along
+// one dimension; they only depend on the geometry, so they are computed once
+// instead of once per channel.
+//   index[i]  : first source index
+//   offset[i] : distance to the second source index (0 at the border)
+//   lambda0/1 : weights of the first and second source element
+template<typename T>
+struct LinearUpsamplingWeights {
+  std::vector<int> index;
+  std::vector<int> offset;
+  std::vector<T> lambda0;
+  std::vector<T> lambda1;
+
+  template<typename AccT>
+  void compute(int inputSize, int outputSize, bool align_corners) {
+    index.resize(outputSize);
+    offset.resize(outputSize);
+    lambda0.resize(outputSize);
+    lambda1.resize(outputSize);
+    const AccT scale = linear_upsampling_compute_scale<AccT>(inputSize, outputSize, align_corners);
+    for (int i = 0; i < outputSize; ++i) {
+      const AccT src = linear_upsampling_compute_source_index<AccT>(scale, i, align_corners);
+      index[i] = src;
+      offset[i] = (index[i] < inputSize - 1) ? 1 : 0;
+      lambda1[i] = src - index[i];
+      lambda0[i] = (T)1. - lambda1[i];
+    }
+  }
+};
+
+// True for an N x C x H x W tensor whose memory is laid out as N x H x W x C
+// (channels last), i.e. a permuted view of a contiguous NHWC tensor. Such
+// tensors are processed as they are: the weights of each output pixel are
+// then applied to a contiguous vector of channels.
+static inline bool upsampling_is_channels_last_2d(THTensor *t) {
+  if (t->dim() != 4) {
+    return false;
+  }
+  const int64_t C = t->size(1), H = t->size(2), W = t->size(3);
+  return C > 1 && t->stride(1) == 1 && t->stride(3) == C &&
+         (H == 1 || t->stride(2) == W * C) &&
+         (t->size(0) == 1 || t->stride(0) == H * W * C);
+}
+
+// Minimum number of output elements for which upsampling kernels go parallel.
+#define THNN_UPSAMPLING_OMP_THRESHOLD 32768
+
 static inline int nearest_neighbor_compute_source_index(
 		const float scale, int dst_index, int inputSize) {
   const int src_index = MIN(floorf(dst_index * scale), inputSize - 1);
@@ -2,7 +2,10 @@
 #include "THNN.h"
 
 #include "THTensor.hpp"
+#include <ATen/Parallel.h>
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 #define torch_(NAME) TH_CONCAT_3(torch_, Real, NAME)
 #define nn_(NAME) TH_CONCAT_3(nn_, Real, NAME)
@@ -0,0 +1,325 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Microbenchmarks of the main ATen ops across dtypes, sizes, strides, thread
+// counts and devices. Every benchmark is named
+//
+//   <op>/<device>/<dtype>/<size>/<layout>/threads:<n>
+//
+// so that a subset can be picked with --benchmark_filter, e.g.
+// --benchmark_filter='^add/cpu/float/'. To track regressions, save the
+// results of two builds with
+//
+//   aten_op_benchmark --benchmark_out=old.json --benchmark_out_format=json
+//
+// and compare them with binaries/compare_benchmarks.py old.json new.json.
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ATen/ATen.h"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+using Inputs = std::vector<at::Tensor>;
+
+enum OpKind {
+  // Elementwise ops and reductions on a square matrix of `size` elements
+  kPointwise,
+  // Matrix products of `size` x `size` matrices
+  kMatrix,
+  // Convolutions of a 1 x 32 x `size` x `size` image
+  kImage,
+};
+
+struct OpCase {
+  const char* name;
+  OpKind kind;
+  int num_inputs;
+  // Integer dtypes are skipped for the ops that only support floating point
+  bool floating_only;
+  std::function<at::Tensor(const Inputs&)> run;
+};
+
+const std::vector<OpCase>& OpCases() {
+  static const std::vector<OpCase> cases = {
+      {"abs", kPointwise, 1, false, [](const Inputs& x) { return x[0].abs(); }},
+      {"neg", kPointwise, 1, false, [](const Inputs& x) { return x[0].neg(); }},
+      {"exp", kPointwise, 1, true, [](const Inputs& x) { return x[0].exp(); }},
+      {"log", kPointwise, 1, true, [](const Inputs& x) { return x[0].log(); }},
+      {"sqrt",
+       kPointwise,
+       1,
+       true,
+       [](const Inputs& x) { return x[0].sqrt(); }},
+      {"sigmoid",
+       kPointwise,
+       1,
+       true,
+       [](const Inputs& x) { return x[0].sigmoid(); }},
+      {"tanh",
+       kPointwise,
+       1,
+       true,
+       [](const Inputs& x) { return x[0].tanh(); }},
+      {"erf", kPointwise, 1, true, [](const Inputs& x) { return x[0].erf(); }},
+      {"relu",
+       kPointwise,
+       1,
+       true,
+       [](const Inputs& x) { return x[0].relu(); }},
+      {"add",
+       kPointwise,
+       2,
+       false,
+       [](const Inputs& x) { return x[0] + x[1]; }},
+      {"mul",
+       kPointwise,
+       2,
+       false,
+       [](const Inputs& x) { return x[0] * x[1]; }},
+      {"div", kPointwise, 2, true, [](const Inputs& x) { return x[0] / x[1]; }},
+      {"contiguous",
+       kPointwise,
+       1,
+       false,
+       [](const Inputs& x) { return x[0].clone(); }},
+      {"sum", kPointwise, 1, false, [](const Inputs& x) { return x[0].sum(); }},
+      {"sum_dim",
+       kPointwise,
+       1,
+       false,
+       [](const Inputs& x) { return x[0].sum(1); }},
+      {"mean",
+       kPointwise,
+       1,
+       true,
+       [](const Inputs& x) { return x[0].mean(); }},
+      {"max", kPointwise, 1, false, [](const Inputs& x) { return x[0].max(); }},
+      {"softmax",
+       kPointwise,
+       1,
+       true,
+       [](const Inputs& x) { return x[0].softmax(1); }},
+      {"log_softmax",
+       kPointwise,
+       1,
+       true,
+       [](const Inputs& x) { return x[0].log_softmax(1); }},
+      {"index_select",
+       kPointwise,
+       1,
+       false,
+       [](const Inputs& x) {
+         const auto index = at::arange(
+             0, x[0].size(0), 2, x[0].options().dtype(at::kLong));
+         return x[0].index_select(0, index);
+       }},
+      {"cat",
+       kPointwise,
+       2,
+       false,
+       [](const Inputs& x) { return at::cat({x[0], x[1]}, 1); }},
+      {"mm", kMatrix, 2, true, [](const Inputs& x) { return x[0].mm(x[1]); }},
+      {"addmm",
+       kMatrix,
+       3,
+       true,
+       [](const Inputs& x) { return x[0].addmm(x[1], x[2]); }},
+      {"conv2d",
+       kImage,
+       2,
+       true,
+       [](const Inputs& x) {
+         return at::conv2d(x[0], x[1], {}, {1, 1}, {1, 1});
+       }},
+  };
+  return cases;
+}
+
+struct DtypeCase {
+  const char* name;
+  at::ScalarType dtype;
+};
+
+const std::vector<DtypeCase> kDtypes = {
+    {"float", at::kFloat},
+    {"double", at::kDouble},
+    {"int64", at::kLong},
+};
+
+std::vector<int64_t> Sizes(OpKind kind) {
+  switch (kind) {
+    case kPointwise:
+      return {1 << 6, 1 << 16, 1 << 22};
+    case kMatrix:
+      return {64, 256, 1024};
+    case kImage:
+      return {32, 128};
+  }
+  return {};
+}
+
+// Input `index` of the op for a benchmark of the given size. Strided inputs
+// are transposed, so that they are not contiguous.
+at::Tensor MakeInput(
+    const OpCase& op,
+    int index,
+    int64_t size,
+    bool strided,
+    const at::TensorOptions& options) {
+  std::vector<int64_t> sizes;
+  switch (op.kind) {
+    case kPointwise: {
+      int64_t rows = 1;
+      while (rows * rows < size) {
+        rows *= 2;
+      }
+      sizes = {rows, size / rows};
+      break;
+    }
+    case kMatrix:
+      sizes = {size, size};
+      break;
+    case kImage:
+      sizes = index == 0 ? std::vector<int64_t>{1, 32, size, size}
+                         : std::vector<int64_t>{32, 32, 3, 3};
+      break;
+  }
+  auto float_options = options.dtype(at::kFloat);
+  at::Tensor input;
+  if (strided && sizes.size() == 2) {
+    input = at::rand({sizes[1], sizes[0]}, float_options).t();
+  } else {
+    input = at::rand(sizes, float_options);
+  }
+  // Away from 0 for log, sqrt and div, and integer values for int64
+  input = (input * 10 + 1).floor();
+  return input.toType(options.dtype());
+}
+
+void Synchronize(const at::Tensor& output) {
+  // A blocking copy waits for the work queued on the device
+  if (output.is_cuda()) {
+    output.reshape({-1}).narrow(0, 0, 1).cpu();
+  }
+}
+
+void RunOp(
+    benchmark::State& state,
+    const OpCase& op,
+    at::TensorOptions options,
+    int64_t size,
+    bool strided,
+    int num_threads) {
+  at::set_num_threads(num_threads);
+  Inputs inputs;
+  for (int i = 0; i < op.num_inputs; ++i) {
+    inputs.push_back(MakeInput(op, i, size, strided, options));
+  }
+  // Warm up, e.g. the allocators and the cuDNN algorithm search
+  auto output = op.run(inputs);
+  Synchronize(output);
+  int64_t bytes = output.numel() * output.type().elementSizeInBytes();
+  for (const auto& input : inputs) {
+    bytes += input.numel() * input.type().elementSizeInBytes();
+  }
+  const int64_t items = inputs[0].numel();
+
+  while (state.KeepRunning()) {
+    Synchronize(op.run(inputs));
+  }
+  state.SetBytesProcessed(state.iterations() * bytes);
+  state.SetItemsProcessed(state.iterations() * items);
+}
+
+void RegisterBenchmarks() {
+  std::vector<std::pair<const char*, at::Device>> devices = {
+      {"cpu", at::Device(at::kCPU)}};
+  if (at::hasCUDA()) {
+    devices.emplace_back("cuda", at::Device(at::kCUDA));
+  }
+  const int max_threads = at::get_num_threads();
+
+  for (const auto& op : OpCases()) {
+    for (const auto& device : devices) {
+      const bool is_cpu = device.second.type() == at::kCPU;
+      // The number of threads only matters on the CPU
+      std::vector<int> thread_counts = {max_threads};
+      if (is_cpu && max_threads > 1) {
+        thread_counts = {1, max_threads};
+      }
+      for (const auto& dtype : kDtypes) {
+        if (op.floating_only && !at::isFloatingType(dtype.dtype)) {
+          continue;
+        }
+        for (int64_t size : Sizes(op.kind)) {
+          for (bool strided : {false, true}) {
+            if (strided && op.kind == kImage) {
+              continue;
+            }
+            for (int num_threads : thread_counts) {
+              const std::string name = std::string(op.name) + "/" +
+                  device.first + "/" + dtype.name + "/" +
+                  std::to_string(size) + "/" +
+                  (strided ? "strided" : "contiguous") + "/threads:" +
+                  std::to_string(num_threads);
+              const auto options = at::TensorOptions()
+                                       .dtype(dtype.dtype)
+                                       .device(device.second);
+              benchmark::RegisterBenchmark(
+                  name.c_str(),
+                  [&op, options, size, strided, num_threads](
+                      benchmark::State& state) {
+                    RunOp(state, op, options, size, strided, num_threads);
+                  })
+                  ->UseRealTime();
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// Per-op overhead of the dispatch, on one element tensors
+void BM_TensorType(benchmark::State& state) {
+  const auto tensor = at::ones({1});
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(&tensor.type());
+  }
+}
+BENCHMARK(BM_TensorType);
+
+void BM_AddScalarSize(benchmark::State& state) {
+  const auto a = at::ones({1});
+  const auto b = at::ones({1});
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(a + b);
+  }
+}
+BENCHMARK(BM_AddScalarSize);
+
+} // namespace
+
+int main(int argc, char** argv) {
+  RegisterBenchmarks();
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,85 @@
+#!/usr/bin/env python
+
+"""Compares the Google Benchmark JSON results of two builds, e.g. of
+aten_op_benchmark run with --benchmark_out=<file> --benchmark_out_format=json,
+or of torch/lib/c10d/benchmark/training_benchmark run with --output=<file>,
+and lists the benchmarks that got slower or faster than a threshold.
+
+Exits with status 1 if any benchmark regressed, so that it can gate a build.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import argparse
+import json
+import sys
+
+
+def load_times(path, metric):
+    """Returns the time per iteration of every benchmark in the file, in ns.
+
+    With --benchmark_repetitions, the median of the repetitions is used.
+    """
+    with open(path) as f:
+        results = json.load(f)
+    scale = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+    times = {}
+    medians = {}
+    for benchmark in results['benchmarks']:
+        if 'error_occurred' in benchmark and benchmark['error_occurred']:
+            continue
+        time = benchmark[metric] * scale[benchmark.get('time_unit', 'ns')]
+        name = benchmark['name']
+        if name.endswith('_median'):
+            medians[name[:-len('_median')]] = time
+        elif not name.endswith(('_mean', '_stddev')):
+            times[name] = time
+    times.update(medians)
+    return times
+
+
+def main(args):
+    old = load_times(args.old, args.metric)
+    new = load_times(args.new, args.metric)
+
+    rows = []
+    for name in sorted(set(old) & set(new)):
+        if old[name] > 0:
+            rows.append((new[name] / old[name] - 1, name))
+    rows.sort(reverse=True)
+
+    regressions = [row for row in rows if row[0] > args.threshold]
+    improvements = sorted(row for row in rows if row[0] < -args.threshold)
+    for title, selected in (('Regressions', regressions),
+                            ('Improvements', improvements)):
+        if not selected:
+            continue
+        print('{} ({} of {}):'.format(title, len(selected), len(rows)))
+        for change, name in selected:
+            print('  {:+8.1%}  {:>12.0f} ns -> {:>12.0f} ns  {}'.format(
+                change, old[name], new[name], name))
+
+    for label, missing in (('only in old', set(old) - set(new)),
+                           ('only in new', set(new) - set(old))):
+        if missing:
+            print('{} benchmarks {}, e.g. {}'.format(
+                len(missing), label, sorted(missing)[0]))
+
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('old', help='JSON results of the baseline build')
+    parser.add_argument('new', help='JSON results of the build to check')
+    parser.add_argument(
+        '--threshold', type=float, default=0.05,
+        help='Relative change in time reported as a regression or an '
+             'improvement')
+    parser.add_argument(
+        '--metric', choices=['real_time', 'cpu_time'], default='real_time',
+        help='Time compared, the benchmarks use real time')
+    sys.exit(main(parser.parse_args()))
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmarks of the graph optimizations run at model load on synthetic nets
+// of up to 50k ops: the NetDef <-> NNModule conversion, binary matching and
+// dead code elimination in nomnigraph, and pattern net transforms. The time
+// of every benchmark should grow linearly with the number of ops.
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#include "caffe2/core/graph.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/passes.h"
+#include "caffe2/transforms/pattern_net_transform.h"
+#include "nomnigraph/Graph/Algorithms.h"
+
+namespace {
+
+using caffe2::NetDef;
+
+std::string BlobName(int i) {
+  return "X" + caffe2::to_string(i);
+}
+
+// A chain of Conv, Relu pairs with a side branch every 16 ops, the first of
+// which feeds the net output. The other branches are dead code.
+NetDef SyntheticNet(int num_ops) {
+  NetDef net;
+  net.add_external_input(BlobName(0));
+  net.add_external_input("W");
+  for (int i = 0; i < num_ops; ++i) {
+    if (i % 2 == 0) {
+      caffe2::AddOp(&net, "Conv", {BlobName(i), "W"}, {BlobName(i + 1)});
+    } else {
+      caffe2::AddOp(&net, "Relu", {BlobName(i)}, {BlobName(i + 1)});
+    }
+    if (i % 16 == 0) {
+      caffe2::AddOp(
+          &net, "Copy", {BlobName(i + 1)}, {"side_" + caffe2::to_string(i)});
+    }
+  }
+  net.add_external_output(BlobName(num_ops));
+  net.add_external_output("side_0");
+  return net;
+}
+
+void BM_ConvertRoundTrip(benchmark::State& state) {
+  auto net = SyntheticNet(state.range(0));
+  while (state.KeepRunning()) {
+    auto nn = caffe2::convertToNNModule(net);
+    benchmark::DoNotOptimize(caffe2::convertToCaffe2Proto(nn, net));
+  }
+  state.SetItemsProcessed(state.iterations() * net.op_size());
+}
+BENCHMARK(BM_ConvertRoundTrip)->Arg(1000)->Arg(10000)->Arg(50000);
+
+void BM_BinaryMatch(benchmark::State& state) {
+  auto net = SyntheticNet(state.range(0));
+  auto nn = caffe2::convertToNNModule(net);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(nom::algorithm::binaryMatch(
+        &nn.dataFlow, [](nom::repr::NNGraph::NodeRef node) {
+          return nom::repr::nn::is<nom::repr::NeuralNetOperator>(node) &&
+              nom::repr::nn::get<nom::repr::NeuralNetOperator>(node)
+                      ->getName() != "Copy";
+        }));
+  }
+  state.SetItemsProcessed(state.iterations() * net.op_size());
+}
+BENCHMARK(BM_BinaryMatch)->Arg(1000)->Arg(10000)->Arg(50000);
+
+void BM_DeadCodeElim(benchmark::State& state) {
+  auto net = SyntheticNet(state.range(0));
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto nn = caffe2::convertToNNModule(net);
+    state.ResumeTiming();
+    caffe2::OptimizationPassRegistry()->Create("DeadCodeElim", &nn)->run();
+  }
+  state.SetItemsProcessed(state.iterations() * net.op_size());
+}
+BENCHMARK(BM_DeadCodeElim)->Arg(1000)->Arg(10000)->Arg(50000);
+
+// Fuses every Conv, Relu pair of the net
+void BM_PatternNetTransform(benchmark::State& state) {
+  auto net = SyntheticNet(state.range(0));
+  NetDef pattern;
+  caffe2::AddOp(&pattern, "Conv", {"in", "w"}, {"mid"});
+  caffe2::AddOp(&pattern, "Relu", {"mid"}, {"out"});
+  pattern.add_external_input("in");
+  pattern.add_external_input("w");
+  pattern.add_external_output("out");
+  NetDef replace;
+  caffe2::AddOp(&replace, "ConvRelu", {"in", "w"}, {"out"});
+  replace.add_external_input("in");
+  replace.add_external_input("w");
+  replace.add_external_output("out");
+  while (state.KeepRunning()) {
+    caffe2::PatternNetTransform transform(pattern, replace);
+    benchmark::DoNotOptimize(transform.ApplyTo(net));
+  }
+  state.SetItemsProcessed(state.iterations() * net.op_size());
+}
+BENCHMARK(BM_PatternNetTransform)->Arg(1000)->Arg(10000)->Arg(50000);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -1,5 +1,6 @@
 #include "caffe2/contrib/tensorrt/tensorrt_op_trt.h"
 
+#include <algorithm>
 #include <numeric>
 #include <unordered_map>
 
@@ -7,6 +8,13 @@
 #include "caffe2/core/logging.h"
 #include "onnx/onnx_pb.h"
 
+C10_DEFINE_string(
+    caffe2_tensorrt_engine_cache_dir,
+    "",
+    "Directory where TensorRT ops built from ONNX keep their serialized "
+    "engines, unless set by the engine_cache_dir argument of the op. Empty "
+    "to always build the engines.");
+
 namespace caffe2 {
 
 namespace {
@@ -61,8 +69,11 @@ TensorRTOp::TensorRTOp(const OperatorDef& operator_def, Workspace* ws)
       auto trt_runtime =
           tensorrt::TrtObject(nvinfer1::createInferRuntime(logger_));
       // TODO(support trt plugin factory)
-      trt_engine_ = tensorrt::TrtObject(trt_runtime->deserializeCudaEngine(
-          engine_string.data(), engine_string.size(), nullptr));
+      trt_engines_.push_back(
+          {max_batch_size_,
+           tensorrt::TrtObject(trt_runtime->deserializeCudaEngine(
+               engine_string.data(), engine_string.size(), nullptr)),
+           nullptr});
     } else {
       auto onnx_model_str =
           OperatorBase::GetSingleArgument<std::string>("onnx_model", "");
@@ -70,6 +81,8 @@ TensorRTOp::TensorRTOp(const OperatorDef& operator_def, Workspace* ws)
       auto debug_builder = OperatorBase::GetSingleArgument<int>("debug_builder", 0);
       auto max_workspace_size = OperatorBase::GetSingleArgument<int>(
           "max_workspace_size", 1024 * 1024 * 2);
+      auto cache_dir = OperatorBase::GetSingleArgument<std::string>(
+          "engine_cache_dir", FLAGS_caffe2_tensorrt_engine_cache_dir);
 
       // Pull the weights from workspace and assembly it back to the onnx model,
       // notice that since we may have rewritten the net, we need to map the
@@ -91,24 +104,42 @@ TensorRTOp::TensorRTOp(const OperatorDef& operator_def, Workspace* ws)
       onnx_model_str.clear();
       onnx_model.SerializeToString(&onnx_model_str);
 
-      // Build the trt engine
-      trt_engine_ = tensorrt::BuildTrtEngine(
-          onnx_model_str,
-          &logger_,
-          max_batch_size_,
-          max_workspace_size,
-          debug_builder);
+      // Build a trt engine for every batch size bucket, up to max_batch_size
+      auto buckets =
+          OperatorBase::GetRepeatedArgument<int>("batch_size_buckets");
+      buckets.push_back(max_batch_size_);
+      std::sort(buckets.begin(), buckets.end());
+      buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+      for (const auto bucket : buckets) {
+        if (bucket <= 0 || bucket > max_batch_size_) {
+          continue;
+        }
+        trt_engines_.push_back(
+            {bucket,
+             tensorrt::BuildTrtEngine(
+                 onnx_model_str,
+                 &logger_,
+                 bucket,
+                 max_workspace_size,
+                 debug_builder,
+                 cache_dir),
+             nullptr});
+      }
     }
   }
 
-  CAFFE_ENFORCE(trt_engine_, "Cannot build TensorRT engine!");
+  CAFFE_ENFORCE(!trt_engines_.empty(), "Cannot build TensorRT engine!");
+  for (const auto& engine : trt_engines_) {
+    CAFFE_ENFORCE(engine.engine, "Cannot build TensorRT engine!");
+  }
 
-  // match and bind the input/output
-  const int num_bindings = trt_engine_->getNbBindings();
+  // match and bind the input/output, which are the same for all the engines
+  const auto& trt_engine = trt_engines_.back().engine;
+  const int num_bindings = trt_engine->getNbBindings();
   int output_idx = 0;
   for (int b = 0; b < num_bindings; ++b) {
-    nv_dims_.push_back(trt_engine_->getBindingDimensions(b));
-    bool is_input = trt_engine_->bindingIsInput(b);
+    nv_dims_.push_back(trt_engine->getBindingDimensions(b));
+    bool is_input = trt_engine->bindingIsInput(b);
     is_input_.push_back(is_input);
     if (!is_input) {
       // For output, we try to get its output size hint
@@ -125,7 +156,20 @@ TensorRTOp::TensorRTOp(const OperatorDef& operator_def, Workspace* ws)
     }
   }
 
-  trt_executor_ = tensorrt::TrtObject(trt_engine_->createExecutionContext());
+  for (auto& engine : trt_engines_) {
+    engine.executor =
+        tensorrt::TrtObject(engine.engine->createExecutionContext());
+  }
+}
+
+const TensorRTOp::TrtEngine& TensorRTOp::EngineForBatchSize(
+    size_t batch_size) const {
+  for (const auto& engine : trt_engines_) {
+    if (batch_size <= static_cast<size_t>(engine.max_batch_size)) {
+      return engine;
+    }
+  }
+  return trt_engines_.back();
 }
 
 void TensorRTOp::MaybeAdjustOutputShape(
@@ -156,7 +200,7 @@ void TensorRTOp::MaybeAdjustOutputShape(
 }
 
 bool TensorRTOp::RunOnDevice() {
-  CAFFE_ENFORCE(trt_executor_);
+  CAFFE_ENFORCE(!trt_engines_.empty());
   // Decide input batch size
   size_t N = 0;
   for (int i = 0; i < InputSize(); ++i) {
@@ -223,7 +267,8 @@ bool TensorRTOp::RunOnDevice() {
     }
 
     CAFFE_ENFORCE_EQ(bindings.size(), InputSize() + OutputSize());
-    if (!trt_executor_->execute(batch_size, bindings.data())) {
+    const auto& engine = EngineForBatchSize(batch_size);
+    if (!engine.executor->execute(batch_size, bindings.data())) {
       CAFFE_THROW("Error running the TensorRT executor");
     }
   }
@@ -252,7 +297,18 @@ This is a GPU only operator.
         "max_batch_size",
         "(int default 0) Batch size set by the TensorRT engine builder."
         "It must be no larger than the max_batch_size of the engine builder so "
-        "it is better not to edit this manually.");
+        "it is better not to edit this manually.")
+    .Arg(
+        "batch_size_buckets",
+        "(ints default empty) Besides the engine for max_batch_size, build "
+        "engines for these smaller batch sizes from onnx_model, and run every "
+        "batch on the smallest engine it fits in.")
+    .Arg(
+        "engine_cache_dir",
+        "(string default caffe2_tensorrt_engine_cache_dir) Directory where "
+        "engines built from onnx_model are cached across processes. They "
+        "are keyed by the model with its weights, the builder settings, the "
+        "GPU and the TensorRT version.");
 
 REGISTER_CUDA_OPERATOR(TensorRT, TensorRTOp);
 } // namespace caffe2
@@ -19,13 +19,23 @@ class TensorRTOp final : public Operator<CUDAContext> {
  private:
   void MaybeAdjustOutputShape(int output_idx, std::vector<int64_t>* dims);
 
+  // An engine built for batches of up to max_batch_size
+  struct TrtEngine {
+    int max_batch_size;
+    std::shared_ptr<nvinfer1::ICudaEngine> engine;
+    std::shared_ptr<nvinfer1::IExecutionContext> executor;
+  };
+  // The engine of the smallest bucket fitting batch_size, or of the largest
+  const TrtEngine& EngineForBatchSize(size_t batch_size) const;
+
   tensorrt::TrtLogger logger_;
   int max_batch_size_;
   std::vector<nvinfer1::Dims> nv_dims_;
   std::vector<bool> is_input_;
   std::unordered_map<int, std::vector<int64_t>> output_size_hints_;
-  std::shared_ptr<nvinfer1::ICudaEngine> trt_engine_{nullptr};
-  std::shared_ptr<nvinfer1::IExecutionContext> trt_executor_{nullptr};
+  // Sorted by max_batch_size. TensorRT picks kernels for the max batch size
+  // of an engine, so smaller batches run faster on engines built for them.
+  std::vector<TrtEngine> trt_engines_;
   bool batch_warning_issued_{false};
 };
 
@@ -235,6 +235,18 @@ OperatorDef TensorRTTransformer::BuildTrtOpLazy(
   auto* max_workspace_size_arg = op.add_arg();
   max_workspace_size_arg->set_name("max_workspace_size");
   max_workspace_size_arg->set_i(max_workspace_size_);
+  if (!engine_cache_dir_.empty()) {
+    auto* engine_cache_dir_arg = op.add_arg();
+    engine_cache_dir_arg->set_name("engine_cache_dir");
+    engine_cache_dir_arg->set_s(engine_cache_dir_);
+  }
+  if (!batch_size_buckets_.empty()) {
+    auto* batch_size_buckets_arg = op.add_arg();
+    batch_size_buckets_arg->set_name("batch_size_buckets");
+    for (const auto b : batch_size_buckets_) {
+      batch_size_buckets_arg->add_ints(b);
+    }
+  }
   AddTrtOptions(&op, output_size_hints);
   return op;
 }
@@ -251,7 +263,8 @@ OperatorDef TensorRTTransformer::BuildTrtOp(
       &logger,
       max_batch_size_,
       max_workspace_size_,
-      debug_builder_);
+      debug_builder_,
+      engine_cache_dir_);
 
   // Set up inputs/outputs in the order of they appearnce in getNbBindings
   int num_bindings = trt_engine->getNbBindings();
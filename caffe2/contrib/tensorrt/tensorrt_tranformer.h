@@ -26,12 +26,16 @@ class TensorRTTransformer {
       size_t max_workspace_size,
       int verbosity,
       bool debug_builder,
-      bool build_serializable_op = false)
+      bool build_serializable_op = false,
+      const std::string& engine_cache_dir = "",
+      const std::vector<int>& batch_size_buckets = {})
       : build_serializable_op_(build_serializable_op),
         max_batch_size_(max_batch_size),
         max_workspace_size_(max_workspace_size),
         verbosity_(verbosity),
-        debug_builder_(debug_builder) {}
+        debug_builder_(debug_builder),
+        engine_cache_dir_(engine_cache_dir),
+        batch_size_buckets_(batch_size_buckets) {}
 
   OperatorDef BuildTrtOp(
       const std::string& onnx_model_str,
@@ -88,5 +92,11 @@ class TensorRTTransformer {
   size_t max_workspace_size_{1024 * 1024 * 2};
   int verbosity_{2};
   bool debug_builder_{false};
+
+  // Where built engines are cached across processes, empty to disable
+  std::string engine_cache_dir_;
+  // Batch sizes below max_batch_size_ that lazily built trt ops get engines
+  // for as well
+  std::vector<int> batch_size_buckets_;
 };
 } // namespace caffe2
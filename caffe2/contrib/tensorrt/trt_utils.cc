@@ -1,15 +1,139 @@
 #include "caffe2/contrib/tensorrt/trt_utils.h"
 
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
 #include <NvOnnxParser.h>
+#include <unistd.h>
+
+#include "caffe2/core/context_gpu.h"
 
 namespace caffe2 {
 namespace tensorrt {
+namespace {
+
+// 64-bit FNV-1a
+uint64_t HashString(const std::string& str) {
+  uint64_t hash = 14695981039346656037ull;
+  for (const unsigned char c : str) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Everything an engine depends on but the model itself. It is stored at the
+// head of the cache file and checked on load, which also guards against
+// collisions of the model hash in the file name.
+std::string EngineCacheHeader(
+    const std::string& onnx_model_str,
+    size_t max_batch_size,
+    size_t max_workspace_size) {
+  const auto& prop = GetDeviceProperty(CaffeCudaGetDevice());
+  return c10::str(
+      "trt=",
+      NV_TENSORRT_MAJOR,
+      ".",
+      NV_TENSORRT_MINOR,
+      ".",
+      NV_TENSORRT_PATCH,
+      ";gpu=",
+      prop.name,
+      ";sm=",
+      prop.major,
+      prop.minor,
+      ";max_batch_size=",
+      max_batch_size,
+      ";max_workspace_size=",
+      max_workspace_size,
+      ";model_size=",
+      onnx_model_str.size(),
+      "\n");
+}
+
+std::string EngineCachePath(
+    const std::string& cache_dir,
+    const std::string& onnx_model_str,
+    const std::string& header) {
+  std::ostringstream name;
+  name << cache_dir << "/" << std::hex << HashString(onnx_model_str) << "_"
+       << HashString(header) << ".trt";
+  return name.str();
+}
+
+std::shared_ptr<nvinfer1::ICudaEngine> LoadCachedEngine(
+    const std::string& path,
+    const std::string& header,
+    TrtLogger* logger) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return nullptr;
+  }
+  std::string contents(
+      (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if (contents.compare(0, header.size(), header) != 0) {
+    LOG(WARNING) << "Ignoring TensorRT engine cache " << path
+                 << " built for another model or setup";
+    return nullptr;
+  }
+  auto trt_runtime = TrtObject(nvinfer1::createInferRuntime(*logger));
+  auto* engine = trt_runtime->deserializeCudaEngine(
+      contents.data() + header.size(), contents.size() - header.size(), nullptr);
+  if (!engine) {
+    LOG(WARNING) << "Cannot deserialize TensorRT engine cache " << path;
+    return nullptr;
+  }
+  VLOG(1) << "Loaded TensorRT engine from " << path;
+  return TrtObject(engine);
+}
+
+// Writes to a temporary file first, so that processes sharing the cache
+// never read a partial engine
+void SaveCachedEngine(
+    const std::string& path,
+    const std::string& header,
+    nvinfer1::ICudaEngine* engine) {
+  auto engine_plan = TrtObject(engine->serialize());
+  const std::string tmp_path = c10::str(path, ".tmp", getpid());
+  {
+    std::ofstream out(tmp_path, std::ios::binary);
+    out.write(header.data(), header.size());
+    out.write(
+        static_cast<const char*>(engine_plan->data()), engine_plan->size());
+    if (!out) {
+      LOG(WARNING) << "Cannot write TensorRT engine cache " << tmp_path;
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Cannot write TensorRT engine cache " << path;
+    std::remove(tmp_path.c_str());
+  }
+}
+
+} // namespace
+
 std::shared_ptr<nvinfer1::ICudaEngine> BuildTrtEngine(
     const std::string& onnx_model_str,
     TrtLogger* logger,
     size_t max_batch_size,
     size_t max_workspace_size,
-    bool debug_builder) {
+    bool debug_builder,
+    const std::string& cache_dir) {
+  std::string cache_header;
+  std::string cache_path;
+  if (!cache_dir.empty()) {
+    cache_header =
+        EngineCacheHeader(onnx_model_str, max_batch_size, max_workspace_size);
+    cache_path = EngineCachePath(cache_dir, onnx_model_str, cache_header);
+    auto engine = LoadCachedEngine(cache_path, cache_header, logger);
+    if (engine) {
+      return engine;
+    }
+  }
+
   auto trt_builder = TrtObject(nvinfer1::createInferBuilder(*logger));
   auto trt_network = TrtObject(trt_builder->createNetwork());
   auto trt_parser =
@@ -38,7 +162,11 @@ std::shared_ptr<nvinfer1::ICudaEngine> BuildTrtEngine(
   trt_builder->setMaxBatchSize(max_batch_size);
   trt_builder->setMaxWorkspaceSize(max_workspace_size);
   trt_builder->setDebugSync(debug_builder);
-  return TrtObject(trt_builder->buildCudaEngine(*trt_network.get()));
+  auto engine = TrtObject(trt_builder->buildCudaEngine(*trt_network.get()));
+  if (!cache_dir.empty()) {
+    SaveCachedEngine(cache_path, cache_header, engine.get());
+  }
+  return engine;
 }
 } // namespace tensorrt
 } // namespace caffe2
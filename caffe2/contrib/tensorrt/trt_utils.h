@@ -44,12 +44,17 @@ inline std::shared_ptr<T> TrtObject(T* obj) {
   return std::shared_ptr<T>(obj, TrtDeleter());
 }
 
+// Builds the TensorRT engine of an ONNX model. When cache_dir is not empty,
+// serialized engines are kept there, keyed by the model, the builder
+// settings, the GPU and the TensorRT version, so that later processes load
+// the engine instead of building it again.
 std::shared_ptr<nvinfer1::ICudaEngine> BuildTrtEngine(
     const std::string& onnx_model_str,
     TrtLogger* logger,
     size_t max_batch_size,
     size_t max_workspace_size,
-    bool debug_builder);
+    bool debug_builder,
+    const std::string& cache_dir = "");
 }
 }
 
@@ -21,6 +21,13 @@ C10_DEFINE_bool(
     false,
     "Serialize FLOAT16 tensors using byte_data field");
 
+C10_DEFINE_bool(
+    caffe2_serialize_raw_data,
+    false,
+    "Serialize tensors of fixed size types as little-endian bytes in the "
+    "raw_data field (storage_type RAW), which is copied with a single memcpy "
+    "instead of being packed into typed repeated fields");
+
 namespace caffe2 {
 /**
  * @brief StringSerializer is the serializer for String.
@@ -216,6 +223,26 @@ void TensorSerializer::Serialize(
   proto.set_data_type(data_type);
   StoreDeviceDetail(input, &proto);
   auto uniq_ptr = CreateContext(input.GetDevice());
+  if (FLAGS_caffe2_serialize_raw_data &&
+      data_type != TensorProto_DataType_STRING &&
+      data_type != TensorProto_DataType_UNDEFINED) {
+    const int kValue = 1;
+    CAFFE_ENFORCE_EQ(
+        reinterpret_cast<const char*>(&kValue)[0],
+        1,
+        "Serialization of raw data on big endian platform "
+        "is not written yet.");
+    proto.set_storage_type(TensorProto_StorageType_RAW);
+    string* raw_data = proto.mutable_raw_data();
+    raw_data->resize(chunkSize * input.itemsize());
+    uniq_ptr->CopyBytesToCPU(
+        raw_data->size(),
+        static_cast<const char*>(input.raw_data()) +
+            chunkBegin * input.itemsize(),
+        &(*raw_data)[0]);
+    uniq_ptr->FinishDeviceComputation();
+    return;
+  }
   // A lot of copypaste is error prone. Should we create a macro for this?
   switch (data_type) {
     case TensorProto_DataType_FLOAT:
@@ -395,7 +422,11 @@ void TensorDeserializer::Deserialize(const TensorProto& proto, Tensor* tensor) {
   for (const int64_t d : proto.dims()) {
     dims.push_back(d);
   }
-  tensor->Resize(dims);
+  // Chunks of a tensor can be deserialized concurrently into a tensor that
+  // already has their shape, which must then be left untouched
+  if (!tensor->dims().equals(dims)) {
+    tensor->Resize(dims);
+  }
 
   int64_t chunkBegin = 0;
   auto chunkEnd = tensor->size();
@@ -413,6 +444,31 @@ void TensorDeserializer::Deserialize(const TensorProto& proto, Tensor* tensor) {
       tensor->size());
   auto chunkSize = chunkEnd - chunkBegin;
 
+  if (proto.storage_type() == TensorProto_StorageType_RAW) {
+    const int kValue = 1;
+    CAFFE_ENFORCE_EQ(
+        reinterpret_cast<const char*>(&kValue)[0],
+        1,
+        "Serialization of raw data on big endian platform "
+        "is not written yet.");
+    CAFFE_ENFORCE(
+        proto.data_type() != TensorProto_DataType_STRING &&
+            proto.data_type() != TensorProto_DataType_UNDEFINED,
+        "Raw data can only hold tensors of fixed size types.");
+    const TypeMeta& meta = DataTypeToTypeMeta(proto.data_type());
+    CAFFE_ENFORCE_EQ(
+        chunkSize * meta.itemsize(),
+        proto.raw_data().size(),
+        "Incorrect proto field size.");
+    context->CopyBytesFromCPU(
+        proto.raw_data().size(),
+        proto.raw_data().data(),
+        static_cast<char*>(tensor->raw_mutable_data(meta)) +
+            chunkBegin * meta.itemsize());
+    context->FinishDeviceComputation();
+    return;
+  }
+
   switch (proto.data_type()) {
     case TensorProto_DataType_FLOAT:
       detail::CopyFromProtoAsIs(
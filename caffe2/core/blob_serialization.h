@@ -16,6 +16,7 @@
 C10_DECLARE_int(caffe2_tensor_chunk_size);
 C10_DECLARE_int(caffe2_max_tensor_serializer_threads);
 C10_DECLARE_bool(caffe2_serialize_fp16_as_bytes);
+C10_DECLARE_bool(caffe2_serialize_raw_data);
 
 namespace caffe2 {
 
@@ -124,10 +125,7 @@ inline void CopyToProtoAsIs(
       sizeof(SrcType) == sizeof(DstType),
       "The source type and dest type cannot be copied as-is. Did "
       "you mean CopyToProtoWithCast?");
-  field->Reserve(size);
-  for (int i = 0; i < size; ++i) {
-    field->Add(0);
-  }
+  field->Resize(size, 0);
   context->template CopyToCPU<SrcType>(
       size, src, reinterpret_cast<SrcType*>(field->mutable_data()));
   // Make sure that we finish the copy into the protobuf.
@@ -21,6 +21,7 @@
 C10_DEFINE_int64(caffe2_test_big_tensor_size, 100000000, "");
 C10_DECLARE_int(caffe2_tensor_chunk_size);
 C10_DECLARE_bool(caffe2_serialize_fp16_as_bytes);
+C10_DECLARE_bool(caffe2_serialize_raw_data);
 
 namespace caffe2 {
 using namespace ::caffe2::db;
@@ -735,6 +736,32 @@ TEST(TensorTest, Half) {
   }
 }
 
+TEST(TensorTest, RawDataSerialization) {
+  FLAGS_caffe2_serialize_raw_data = true;
+  Blob blob;
+  TensorCPU* tensor = BlobGetMutableTensor(&blob, CPU);
+  tensor->Resize(2, 3);
+  for (int i = 0; i < 6; ++i) {
+    tensor->mutable_data<int64_t>()[i] = (int64_t(1) << 40) + i;
+  }
+  string serialized = SerializeBlob(blob, "test");
+  FLAGS_caffe2_serialize_raw_data = false;
+  BlobProto proto;
+  CHECK(proto.ParseFromString(serialized));
+  const TensorProto& tensor_proto = proto.tensor();
+  EXPECT_EQ(tensor_proto.storage_type(), TensorProto_StorageType_RAW);
+  EXPECT_EQ(tensor_proto.raw_data().size(), 6 * sizeof(int64_t));
+  EXPECT_EQ(tensor_proto.int64_data_size(), 0);
+  Blob new_blob;
+  EXPECT_NO_THROW(DeserializeBlob(serialized, &new_blob));
+  EXPECT_TRUE(BlobIsTensorType(new_blob, CPU));
+  const TensorCPU& new_tensor = new_blob.Get<TensorCPU>();
+  EXPECT_EQ(new_tensor.dims(), tensor->dims());
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(new_tensor.data<int64_t>()[i], tensor->data<int64_t>()[i]);
+  }
+}
+
 TEST(TensorTest, TensorFactory) {
   Tensor a = empty({1, 2, 3}, at::device(CPU).dtype<float>());
   EXPECT_NE(a.data<float>(), nullptr);
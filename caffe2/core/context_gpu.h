@@ -14,6 +14,8 @@
 #include "caffe2/core/types.h"
 #include "caffe2/proto/caffe2_pb.h"
 
+C10_DECLARE_int(caffe2_priority_streams_per_gpu);
+
 // Since we are using the macro CAFFE2_USE_CUDNN, we will need to include this
 // file after common.h is included.
 #ifdef CAFFE2_USE_CUDNN
@@ -65,8 +67,16 @@ class CAFFE2_CUDA_API ThreadLocalCUDAObjects {
     }
     if (!gpu_streams[stream_id]) {
       DeviceGuard guard(gpu);
-      CUDA_ENFORCE(cudaStreamCreateWithFlags(
-          &gpu_streams[stream_id], cudaStreamNonBlocking));
+      if (stream_id < FLAGS_caffe2_priority_streams_per_gpu) {
+        int least_priority, greatest_priority;
+        CUDA_ENFORCE(cudaDeviceGetStreamPriorityRange(
+            &least_priority, &greatest_priority));
+        CUDA_ENFORCE(cudaStreamCreateWithPriority(
+            &gpu_streams[stream_id], cudaStreamNonBlocking, greatest_priority));
+      } else {
+        CUDA_ENFORCE(cudaStreamCreateWithFlags(
+            &gpu_streams[stream_id], cudaStreamNonBlocking));
+      }
     }
     return gpu_streams[stream_id];
   }
@@ -14,6 +14,18 @@ namespace db {
 
 C10_DEFINE_REGISTRY(Caffe2DBRegistry, DB, const string&, Mode);
 
+size_t Cursor::NextBatch(size_t n, std::vector<Record>* records) {
+  batch_buffer_.Clear();
+  for (size_t i = 0; i < n && Valid(); ++i) {
+    const string k = key();
+    const string v = value();
+    batch_buffer_.Add(k.data(), k.size(), v.data(), v.size());
+    Next();
+  }
+  batch_buffer_.GetRecords(records);
+  return records->size();
+}
+
 // Below, we provide a bare minimum database "minidb" as a reference
 // implementation as well as a portable choice to store data.
 // Note that the MiniDB classes are not exposed via a header file - they should
@@ -79,6 +91,18 @@ class MiniDBCursor : public Cursor {
 
   bool Valid() override { return valid_; }
 
+  size_t NextBatch(size_t n, std::vector<Record>* records) override {
+    // Copies straight from the read buffers, without the strings of key()
+    // and value()
+    batch_buffer_.Clear();
+    for (size_t i = 0; i < n && valid_; ++i) {
+      batch_buffer_.Add(key_.data(), key_len_, value_.data(), value_len_);
+      Next();
+    }
+    batch_buffer_.GetRecords(records);
+    return records->size();
+  }
+
  private:
   FILE* file_;
   std::lock_guard<std::mutex> lock_;
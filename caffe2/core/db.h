@@ -2,6 +2,7 @@
 #define CAFFE2_CORE_DB_H_
 
 #include <mutex>
+#include <vector>
 
 #include "c10/util/Registry.h"
 #include "caffe2/core/blob_serialization.h"
@@ -16,6 +17,82 @@ namespace db {
  */
 enum Mode { READ, WRITE, NEW };
 
+/**
+ * A non-owning view of a string, such as a key or a value of a record.
+ */
+struct CAFFE2_API StringView {
+  const char* data;
+  size_t size;
+
+  string ToString() const {
+    return string(data, size);
+  }
+};
+
+/**
+ * A record read by Cursor::NextBatch. The key and the value point into memory
+ * owned by the cursor or by the database.
+ */
+struct CAFFE2_API Record {
+  StringView key;
+  StringView value;
+};
+
+/**
+ * Contiguous storage for the keys and values of a batch of records, for
+ * cursors that cannot hand out views of their own memory. Adding a record
+ * copies it once and does not allocate once the buffer has grown to the size
+ * of a batch.
+ */
+class CAFFE2_API RecordBuffer {
+ public:
+  void Clear() {
+    data_.clear();
+    spans_.clear();
+  }
+
+  void Add(
+      const char* key,
+      size_t key_size,
+      const char* value,
+      size_t value_size) {
+    spans_.push_back({data_.size(), key_size, value_size});
+    data_.insert(data_.end(), key, key + key_size);
+    data_.insert(data_.end(), value, value + value_size);
+  }
+
+  size_t size() const {
+    return spans_.size();
+  }
+
+  Record record(size_t i) const {
+    const Span& span = spans_[i];
+    const char* key = data_.data() + span.offset;
+    return Record{StringView{key, span.key_size},
+                  StringView{key + span.key_size, span.value_size}};
+  }
+
+  /**
+   * Sets records to views of the buffered records, which stay valid until
+   * the buffer is modified.
+   */
+  void GetRecords(std::vector<Record>* records) const {
+    records->clear();
+    for (size_t i = 0; i < spans_.size(); ++i) {
+      records->push_back(record(i));
+    }
+  }
+
+ private:
+  struct Span {
+    size_t offset;
+    size_t key_size;
+    size_t value_size;
+  };
+  std::vector<char> data_;
+  std::vector<Span> spans_;
+};
+
 /**
  * An abstract class for the cursor of the database while reading.
  */
@@ -51,6 +128,22 @@ class CAFFE2_API Cursor {
    * reached the end of the database, return false.
    */
   virtual bool Valid() = 0;
+  /**
+   * Reads up to n records starting at the current location and moves past
+   * them. Fewer than n records are read only at the end of the database.
+   * Returns the number of records read.
+   *
+   * The records are views that stay valid until the next call that moves the
+   * cursor, which saves the virtual calls and the string copies of reading
+   * the records one by one with key() and value(). The default
+   * implementation does exactly that into a buffer owned by the cursor;
+   * backends override it to hand out their own memory where they can.
+   */
+  virtual size_t NextBatch(size_t n, std::vector<Record>* records);
+
+ protected:
+  // Backs the records returned by the default NextBatch.
+  RecordBuffer batch_buffer_;
 
   C10_DISABLE_COPY_AND_ASSIGN(Cursor);
 };
@@ -222,6 +315,10 @@ class CAFFE2_API DBReader {
   void Read(string* key, string* value) const {
     CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
     std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
+    if (!cursor_->Valid()) {
+      // ReadBatch() can stop right at the end of the db
+      MoveToBeginning();
+    }
     *key = cursor_->key();
     *value = cursor_->value();
 
@@ -235,6 +332,45 @@ class CAFFE2_API DBReader {
     }
   }
 
+  /**
+   * Reads the values of the next n records and moves past them, going back
+   * to the head of the db as Read() does. Thread safe.
+   *
+   * The records are read with a single lock and a single call to the
+   * cursor's NextBatch, and copied once into the strings of values, whose
+   * capacity is reused across calls.
+   */
+  void ReadBatch(size_t n, vector<string>* values) const {
+    CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
+    std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
+    values->resize(n);
+    size_t i = 0;
+    while (i < n) {
+      if (num_shards_ > 1) {
+        // Sharded reads skip records, which NextBatch cannot do
+        (*values)[i++] = cursor_->value();
+        for (uint32_t s = 0; s < num_shards_; s++) {
+          cursor_->Next();
+          if (!cursor_->Valid()) {
+            MoveToBeginning();
+            break;
+          }
+        }
+        continue;
+      }
+      const size_t read = cursor_->NextBatch(n - i, &batch_records_);
+      for (const Record& record : batch_records_) {
+        (*values)[i++].assign(record.value.data, record.value.size);
+      }
+      if (i < n) {
+        // Reached the end of the db
+        MoveToBeginning();
+        CAFFE_ENFORCE(
+            read > 0 || cursor_->Valid(), "Cannot read from an empty db.");
+      }
+    }
+  }
+
   /**
    * @brief Seeks to the first key. Thread safe.
    */
@@ -282,6 +418,7 @@ class CAFFE2_API DBReader {
   unique_ptr<DB> db_;
   unique_ptr<Cursor> cursor_;
   mutable std::mutex reader_mutex_;
+  mutable vector<Record> batch_records_;
   uint32_t num_shards_;
   uint32_t shard_id_;
 
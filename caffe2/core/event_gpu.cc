@@ -1,24 +1,104 @@
 #include "caffe2/core/context_gpu.h"
 #include "caffe2/core/event_cpu.h"
 #include "caffe2/core/operator.h"
+#include "caffe2/utils/simple_queue.h"
 
 #include <atomic>
+#include <thread>
+#include <unordered_map>
 
 namespace caffe2 {
 
+namespace {
+
+// CUDA events are recycled across Event objects, so that creating a net, with
+// an event per op, does not call cudaEventCreate for every op every time.
+class CudaEventPool {
+ public:
+  static CudaEventPool& Get() {
+    // Leaked, so that events can be released from static destructors
+    static CudaEventPool* pool = new CudaEventPool();
+    return *pool;
+  }
+
+  cudaEvent_t Acquire(int device_id) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& events = free_events_[device_id];
+      if (!events.empty()) {
+        auto event = events.back();
+        events.pop_back();
+        return event;
+      }
+    }
+    DeviceGuard g(device_id);
+    cudaEvent_t event;
+    CUDA_ENFORCE(
+        cudaEventCreate(&event, cudaEventDefault | cudaEventDisableTiming));
+    return event;
+  }
+
+  void Release(int device_id, cudaEvent_t event) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& events = free_events_[device_id];
+      if (events.size() < kMaxFreeEventsPerDevice) {
+        events.push_back(event);
+        return;
+      }
+    }
+    DeviceGuard g(device_id);
+    CUDA_CHECK(cudaEventDestroy(event));
+  }
+
+ private:
+  static constexpr size_t kMaxFreeEventsPerDevice = 4096;
+
+  std::mutex mutex_;
+  std::unordered_map<int, std::vector<cudaEvent_t>> free_events_;
+};
+
+constexpr size_t CudaEventPool::kMaxFreeEventsPerDevice;
+
+// Stream callbacks must not call into CUDA, while event callbacks typically
+// query other events. A single thread shared by all events runs the latter on
+// behalf of the former.
+class CudaEventCallbackDispatcher {
+ public:
+  static CudaEventCallbackDispatcher& Get() {
+    static CudaEventCallbackDispatcher* dispatcher =
+        new CudaEventCallbackDispatcher();
+    return *dispatcher;
+  }
+
+  void Push(std::function<void()> f) {
+    queue_.Push(std::move(f));
+  }
+
+ private:
+  CudaEventCallbackDispatcher() : thread_([this] {
+    std::function<void()> f;
+    while (queue_.Pop(&f)) {
+      f();
+    }
+  }) {}
+
+  SimpleQueue<std::function<void()>> queue_;
+  std::thread thread_;
+};
+
+} // namespace
+
 struct CudaEventWrapper {
   explicit CudaEventWrapper(const DeviceOption& option)
       : cuda_stream_(nullptr),
         device_id_(option.device_id()),
         status_(EventStatus::EVENT_INITIALIZED) {
     CAFFE_ENFORCE(option.device_type(), PROTO_CUDA);
-    DeviceGuard g(device_id_);
-    CUDA_ENFORCE(cudaEventCreate(
-        &cuda_event_, cudaEventDefault | cudaEventDisableTiming));
+    cuda_event_ = CudaEventPool::Get().Acquire(device_id_);
   }
   ~CudaEventWrapper() {
-    DeviceGuard g(device_id_);
-    CUDA_CHECK(cudaEventDestroy(cuda_event_));
+    CudaEventPool::Get().Release(device_id_, cuda_event_);
   }
 
   cudaEvent_t cuda_event_;
@@ -29,11 +109,80 @@ struct CudaEventWrapper {
   std::mutex mutex_recorded_;
   std::condition_variable cv_recorded_;
   std::string err_msg_;
+
+  // Callbacks to run on completion. While the event is scheduled and has
+  // callbacks, a stream callback enqueued after it is pending, and runs them.
+  std::vector<EventCallbackFunction> callbacks_;
+  bool stream_callback_pending_ = false;
+  // Incremented by Reset, so that a stream callback of a previous run does
+  // not complete the event of the next one
+  int generation_ = 0;
 };
 
 namespace {
 const std::string kNoError = "No error";
+
+// Runs on the dispatcher thread once the work recorded before the event
+// completed on its stream.
+void RunCudaEventCallbacks(
+    const std::shared_ptr<void>& event,
+    int generation,
+    cudaError_t result) {
+  auto* wrapper = static_cast<CudaEventWrapper*>(event.get());
+  std::vector<EventCallbackFunction> callbacks;
+  {
+    std::unique_lock<std::mutex> lock(wrapper->mutex_recorded_);
+    if (wrapper->generation_ != generation) {
+      return;
+    }
+    wrapper->stream_callback_pending_ = false;
+    if (wrapper->status_ == EventStatus::EVENT_SCHEDULED) {
+      if (result == cudaSuccess) {
+        wrapper->status_ = EventStatus::EVENT_SUCCESS;
+      } else {
+        wrapper->err_msg_ = cudaGetErrorString(result);
+        wrapper->status_ = EventStatus::EVENT_FAILED;
+      }
+    }
+    callbacks.swap(wrapper->callbacks_);
+  }
+  for (auto& callback : callbacks) {
+    callback();
+  }
+}
+
+struct CudaStreamCallbackArgs {
+  std::shared_ptr<void> event;
+  int generation;
+};
+
+void CUDART_CB CudaEventStreamCallback(
+    cudaStream_t /* stream */,
+    cudaError_t result,
+    void* data) {
+  auto* args = static_cast<CudaStreamCallbackArgs*>(data);
+  CudaEventCallbackDispatcher::Get().Push([args, result]() {
+    std::unique_ptr<CudaStreamCallbackArgs> owned(args);
+    RunCudaEventCallbacks(owned->event, owned->generation, result);
+  });
+}
+
+// Must be called with mutex_recorded_ held, on a scheduled event
+void AddCudaEventStreamCallback(const Event* event) {
+  auto* wrapper = static_cast<CudaEventWrapper*>(event->event_.get());
+  if (wrapper->stream_callback_pending_) {
+    return;
+  }
+  CudaEventCallbackDispatcher::Get();
+  DeviceGuard g(wrapper->device_id_);
+  CUDA_ENFORCE(cudaStreamAddCallback(
+      wrapper->cuda_stream_,
+      CudaEventStreamCallback,
+      new CudaStreamCallbackArgs{event->event_, wrapper->generation_},
+      0));
+  wrapper->stream_callback_pending_ = true;
 }
+} // namespace
 
 void EventCreateCUDA(const DeviceOption& option, Event* event) {
   event->event_ = std::make_shared<CudaEventWrapper>(option);
@@ -41,6 +190,7 @@ void EventCreateCUDA(const DeviceOption& option, Event* event) {
 
 void EventRecordCUDA(Event* event, const void* context, const char* err_msg) {
   auto* wrapper = static_cast<CudaEventWrapper*>(event->event_.get());
+  std::vector<EventCallbackFunction> callbacks;
   {
     std::unique_lock<std::mutex> lock(wrapper->mutex_recorded_);
 
@@ -77,12 +227,19 @@ void EventRecordCUDA(Event* event, const void* context, const char* err_msg) {
       wrapper->cuda_stream_ =
           static_cast<const CUDAContext*>(context)->cuda_stream();
       wrapper->status_ = EventStatus::EVENT_SCHEDULED;
+      if (!wrapper->callbacks_.empty()) {
+        AddCudaEventStreamCallback(event);
+      }
     } else {
       wrapper->err_msg_ = err_msg;
       wrapper->status_ = EventStatus::EVENT_FAILED;
+      callbacks.swap(wrapper->callbacks_);
     }
   }
   wrapper->cv_recorded_.notify_all();
+  for (auto& callback : callbacks) {
+    callback();
+  }
 }
 
 void EventFinishCUDA(const Event* event) {
@@ -172,6 +329,7 @@ const std::string& EventErrorMessageCUDA(const Event* event) {
 
 void EventSetFinishedCUDA(const Event* event, const char* err_msg) {
   auto* wrapper = static_cast<CudaEventWrapper*>(event->event_.get());
+  std::vector<EventCallbackFunction> callbacks;
   {
     std::unique_lock<std::mutex> lock(wrapper->mutex_recorded_);
 
@@ -186,8 +344,12 @@ void EventSetFinishedCUDA(const Event* event, const char* err_msg) {
       wrapper->err_msg_ = err_msg;
       wrapper->status_ = EventStatus::EVENT_FAILED;
     }
+    callbacks.swap(wrapper->callbacks_);
   }
   wrapper->cv_recorded_.notify_all();
+  for (auto& callback : callbacks) {
+    callback();
+  }
 }
 
 void EventResetCUDA(Event* event) {
@@ -196,6 +358,27 @@ void EventResetCUDA(Event* event) {
   wrapper->status_ = EventStatus::EVENT_INITIALIZED;
   wrapper->err_msg_ = "";
   wrapper->cuda_stream_ = nullptr;
+  wrapper->callbacks_.clear();
+  wrapper->stream_callback_pending_ = false;
+  wrapper->generation_++;
+}
+
+// Runs the callback once the event completes, without polling: a scheduled
+// event gets a stream callback that fires when the work before it is done.
+void EventSetCallbackCUDA(Event* event, EventCallbackFunction callback) {
+  auto* wrapper = static_cast<CudaEventWrapper*>(event->event_.get());
+  {
+    std::unique_lock<std::mutex> lock(wrapper->mutex_recorded_);
+    if (wrapper->status_ != EventStatus::EVENT_SUCCESS &&
+        wrapper->status_ != EventStatus::EVENT_FAILED) {
+      wrapper->callbacks_.push_back(std::move(callback));
+      if (wrapper->status_ == EventStatus::EVENT_SCHEDULED) {
+        AddCudaEventStreamCallback(event);
+      }
+      return;
+    }
+  }
+  callback();
 }
 
 REGISTER_EVENT_CREATE_FUNCTION(CUDA, EventCreateCUDA);
@@ -209,6 +392,7 @@ REGISTER_EVENT_QUERY_FUNCTION(CUDA, EventQueryCUDA);
 REGISTER_EVENT_ERROR_MESSAGE_FUNCTION(CUDA, EventErrorMessageCUDA);
 REGISTER_EVENT_SET_FINISHED_FUNCTION(CUDA, EventSetFinishedCUDA);
 REGISTER_EVENT_RESET_FUNCTION(CUDA, EventResetCUDA);
+REGISTER_EVENT_SET_CALLBACK_FUNCTION(CUDA, EventSetCallbackCUDA);
 
 REGISTER_EVENT_WAIT_FUNCTION(MKLDNN, CUDA, EventWaitCPUCUDA);
 REGISTER_EVENT_WAIT_FUNCTION(CUDA, MKLDNN, EventWaitCUDACPU);
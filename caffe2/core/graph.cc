@@ -13,10 +13,12 @@ Graph::Graph(const NetDef& net) : netdef_(net) {
   nodes_.clear();
   nodes_.resize(net.op_size());
 
-  // Copy over operators
+  // Move the operators over from our copy of the net, so that they are only
+  // copied once; GetNetDef regenerates them from the nodes anyway.
   for (int x = 0; x < net.op_size(); x++) {
-    node(x).op = net.op(x);
+    node(x).op.Swap(netdef_.mutable_op(x));
   }
+  netdef_.clear_op();
 
   // For any blob, which operator was the last to write to it?
   // In python, this is known as "versions".
@@ -76,20 +78,18 @@ const std::vector<std::pair<string, int>> Graph::GetSubgraphPerimeterHelper(
     const std::vector<int>& match) {
   std::vector<std::pair<string, int>> edge_list;
   std::unordered_set<int> match_set(match.begin(), match.end());
-  for (int x = 0; x < (int)nodes_.size(); x++) {
-    if (!is_node_active(x)) {
-      continue;
-    }
-    if (!match_set.count(x)) { // x is not in subgraph
-      const auto& list = from_children ? node(x).children : node(x).parents;
-      for (const auto& edge : list) {
-        int parent = edge.first;
-        const auto& blobs = edge.second;
-        if (match_set.count(parent)) { // but has a parent that is in subgraph
-          for (const string& blob : blobs) {
-            edge_list.push_back({blob, x});
-          }
-        }
+  // Only the neighbors of the subgraph can be on its perimeter, so look at
+  // those instead of every node of the graph: x is a node not in the
+  // subgraph, with an edge from (or to) a node of the subgraph.
+  for (int idx : match) {
+    const auto& list = from_children ? node(idx).parents : node(idx).children;
+    for (const auto& edge : list) {
+      int x = edge.first;
+      if (match_set.count(x) || !is_node_active(x)) {
+        continue;
+      }
+      for (const string& blob : edge.second) {
+        edge_list.push_back({blob, x});
       }
     }
   }
@@ -1,8 +1,10 @@
 #include "caffe2/core/memonger.h"
 
+#include <algorithm>
 #include <set>
 #include <unordered_set>
 
+#include "caffe2/core/allocator.h"
 #include "caffe2/utils/proto_utils.h"
 
 namespace caffe2 {
@@ -589,5 +591,289 @@ NetDef compute_blob_recycling_for_dag(
       blob_shapes);
 }
 
+namespace {
+
+size_t alignedSize(size_t nbytes) {
+  return (nbytes + gCaffe2Alignment - 1) / gCaffe2Alignment * gCaffe2Alignment;
+}
+
+} // namespace
+
+ArenaPlan compute_arena_plan(
+    const std::map<string, size_t>& blob_nbytes,
+    const std::map<string, std::vector<int>>& touching_ops,
+    const std::function<bool(int, int)>& precedes) {
+  static const std::vector<int> kNoOps;
+  auto opsOf = [&](const string& name) -> const std::vector<int>& {
+    auto it = touching_ops.find(name);
+    return it != touching_ops.end() ? it->second : kNoOps;
+  };
+  // Whether all uses of one blob finish before any use of the other starts
+  auto before = [&](const std::vector<int>& first,
+                    const std::vector<int>& second) {
+    for (auto i : first) {
+      for (auto j : second) {
+        if (!precedes(i, j)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  // Places the largest blobs first, each at the lowest offset that doesn't
+  // overlap the blobs already placed that it can be live with
+  std::vector<std::pair<size_t, string>> order;
+  for (const auto& entry : blob_nbytes) {
+    order.emplace_back(entry.second, entry.first);
+  }
+  std::sort(
+      order.begin(),
+      order.end(),
+      [](const std::pair<size_t, string>& a,
+         const std::pair<size_t, string>& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+      });
+
+  ArenaPlan plan;
+  std::vector<string> placed;
+  for (const auto& entry : order) {
+    const auto& name = entry.second;
+    const auto size = alignedSize(entry.first);
+    const auto& ops = opsOf(name);
+
+    std::vector<std::pair<size_t, size_t>> taken;
+    for (const auto& other : placed) {
+      const auto& other_ops = opsOf(other);
+      if (!before(ops, other_ops) && !before(other_ops, ops)) {
+        const auto& slice = plan.slices.at(other);
+        taken.emplace_back(slice.offset, slice.offset + alignedSize(slice.nbytes));
+      }
+    }
+    std::sort(taken.begin(), taken.end());
+    size_t offset = 0;
+    for (const auto& range : taken) {
+      if (range.first >= offset + size) {
+        break;
+      }
+      offset = std::max(offset, range.second);
+    }
+
+    plan.slices[name] = ArenaPlan::Slice{offset, entry.first};
+    plan.size = std::max(plan.size, offset + size);
+    placed.push_back(name);
+  }
+  return plan;
+}
+
+ActivationArena::ActivationArena(
+    const NetDef& net,
+    std::vector<OperatorBase*> ops,
+    std::function<bool(int, int)> precedes)
+    : net_(net), ops_(std::move(ops)), precedes_(std::move(precedes)) {
+  CAFFE_ENFORCE_EQ(net_.op_size(), ops_.size());
+  std::set<string> external(
+      net_.external_input().begin(), net_.external_input().end());
+  external.insert(net_.external_output().begin(), net_.external_output().end());
+
+  std::set<string> written;
+  std::set<string> non_cpu;
+  for (int i = 0; i < net_.op_size(); ++i) {
+    const auto& op_def = net_.op(i);
+    auto* op = ops_[i];
+    CAFFE_ENFORCE_EQ(op_def.input_size(), op->InputSize());
+    CAFFE_ENFORCE_EQ(op_def.output_size(), op->OutputSize());
+    // Ops on other devices may use blobs asynchronously
+    const bool on_cpu = op->device_option().device_type() == PROTO_CPU;
+    for (int j = 0; j < op_def.input_size(); ++j) {
+      const auto& name = op_def.input(j);
+      touching_ops_[name].push_back(i);
+      blobs_[name] = op->Inputs()[j];
+      if (!written.count(name)) {
+        inputs_.emplace(name, op->Inputs()[j]);
+      }
+      if (!on_cpu) {
+        non_cpu.insert(name);
+      }
+    }
+    for (int j = 0; j < op_def.output_size(); ++j) {
+      const auto& name = op_def.output(j);
+      touching_ops_[name].push_back(i);
+      blobs_[name] = op->OutputBlob(j);
+      written.insert(name);
+      if (!on_cpu) {
+        non_cpu.insert(name);
+      }
+      if (!external.count(name) && !inputs_.count(name)) {
+        activations_.emplace(name, op->OutputBlob(j));
+      }
+    }
+  }
+  for (const auto& name : non_cpu) {
+    activations_.erase(name);
+  }
+}
+
+ActivationArena::~ActivationArena() {
+  Unbind();
+}
+
+ActivationArena::Signature ActivationArena::InputsSignature() const {
+  Signature signature;
+  signature.reserve(inputs_.size());
+  for (const auto& input : inputs_) {
+    const auto* blob = input.second;
+    if (BlobIsTensorType(*blob, CPU)) {
+      const auto& tensor = blob->Get<Tensor>();
+      signature.emplace_back(tensor.dims().vec(), tensor.meta());
+    } else {
+      signature.emplace_back(std::vector<int64_t>(), blob->meta());
+    }
+  }
+  return signature;
+}
+
+void ActivationArena::Prepare() {
+  auto signature = InputsSignature();
+  if (!has_signature_ || signature != signature_) {
+    // This run allocates as usual, and shows the shapes and aliasing of the
+    // activations for these inputs
+    Unbind();
+    signature_ = std::move(signature);
+    has_signature_ = true;
+    planned_ = false;
+    return;
+  }
+  if (!planned_) {
+    planned_ = true;
+    Plan();
+  }
+}
+
+void ActivationArena::Plan() {
+  CaffeMap<string, TensorShape> shapes;
+  for (const auto& input : inputs_) {
+    if (BlobIsTensorType(*input.second, CPU)) {
+      shapes[input.first] = GetTensorShapeOfBlob(input.second);
+    }
+  }
+  NetDef net = net_;
+  try {
+    InferBlobShapesAndTypes(shapes, {&net});
+  } catch (const EnforceNotMet& err) {
+    VLOG(1) << "Shape inference failed for net " << net_.name() << ": "
+            << err.msg();
+  }
+
+  // Blobs whose memory overlaps after the last run alias each other: they
+  // are live as long as any of them, and activations that alias other blobs
+  // are not placed in the arena
+  std::map<string, string> alias_of;
+  std::function<string(const string&)> find = [&](const string& name) {
+    auto it = alias_of.find(name);
+    if (it == alias_of.end() || it->second == name) {
+      return name;
+    }
+    return it->second = find(it->second);
+  };
+  std::vector<std::tuple<const char*, const char*, string>> ranges;
+  for (const auto& entry : blobs_) {
+    const auto* blob = entry.second;
+    if (!BlobIsTensorType(*blob, CPU)) {
+      continue;
+    }
+    const auto& tensor = blob->Get<Tensor>();
+    if (tensor.nbytes() == 0 || !tensor.storage().data()) {
+      continue;
+    }
+    const auto* begin = static_cast<const char*>(tensor.raw_data());
+    ranges.emplace_back(begin, begin + tensor.nbytes(), entry.first);
+  }
+  std::sort(ranges.begin(), ranges.end());
+  const char* end = nullptr;
+  string last;
+  for (const auto& range : ranges) {
+    if (end && std::get<0>(range) < end) {
+      alias_of[find(std::get<2>(range))] = find(last);
+    }
+    if (!end || std::get<1>(range) > end) {
+      end = std::get<1>(range);
+      last = std::get<2>(range);
+    }
+  }
+  std::map<string, std::vector<int>> alias_ops;
+  std::set<string> non_activation_aliases;
+  for (const auto& entry : blobs_) {
+    const auto root = find(entry.first);
+    auto& ops = alias_ops[root];
+    const auto& blob_ops = touching_ops_.at(entry.first);
+    ops.insert(ops.end(), blob_ops.begin(), blob_ops.end());
+    if (!activations_.count(entry.first)) {
+      non_activation_aliases.insert(root);
+    }
+  }
+
+  std::map<string, size_t> nbytes;
+  std::map<string, std::vector<int>> touching;
+  std::map<string, std::pair<std::vector<int64_t>, TypeMeta>> layouts;
+  for (const auto& activation : activations_) {
+    const auto& name = activation.first;
+    const auto* blob = activation.second;
+    if (non_activation_aliases.count(find(name)) ||
+        !BlobIsTensorType(*blob, CPU)) {
+      continue;
+    }
+    const auto& tensor = blob->Get<Tensor>();
+    const auto& meta = tensor.meta();
+    if (meta.id() == TypeIdentifier::uninitialized() || meta.placementNew()) {
+      continue;
+    }
+    // Inferred shapes are used when they agree with the type of the last run
+    auto dims = tensor.dims().vec();
+    auto it = shapes.find(name);
+    if (it != shapes.end() && !it->second.unknown_shape() &&
+        DataTypeToTypeMeta(it->second.data_type()) == meta) {
+      dims.assign(it->second.dims().begin(), it->second.dims().end());
+    }
+    size_t size = meta.itemsize();
+    for (auto d : dims) {
+      size *= d;
+    }
+    if (size == 0) {
+      continue;
+    }
+    nbytes[name] = size;
+    touching[name] = alias_ops.at(find(name));
+    layouts[name] = std::make_pair(std::move(dims), meta);
+  }
+
+  plan_ = compute_arena_plan(nbytes, touching, precedes_);
+  if (plan_.slices.empty()) {
+    return;
+  }
+  data_ = GetCPUAllocator()->allocate(plan_.size);
+  auto* base = static_cast<char*>(data_.get());
+  for (const auto& entry : plan_.slices) {
+    const auto& layout = layouts.at(entry.first);
+    auto* tensor = BlobGetMutableTensor(activations_.at(entry.first), CPU);
+    tensor->Resize(layout.first);
+    tensor->ShareExternalPointer(
+        base + entry.second.offset, layout.second, entry.second.nbytes);
+  }
+  VLOG(1) << "Bound " << plan_.slices.size() << " activations of net "
+          << net_.name() << " to an arena of " << plan_.size << " bytes";
+}
+
+void ActivationArena::Unbind() {
+  for (const auto& entry : plan_.slices) {
+    auto* blob = activations_.at(entry.first);
+    if (BlobIsTensorType(*blob, CPU)) {
+      BlobGetMutableTensor(blob, CPU)->FreeMemory();
+    }
+  }
+  plan_ = ArenaPlan();
+  data_.clear();
+}
+
 } // memonger
 } // caffe2
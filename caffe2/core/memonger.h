@@ -1,9 +1,12 @@
 #ifndef CAFFE2_CORE_MEMONGER_H_
 #define CAFFE2_CORE_MEMONGER_H_
 
+#include <functional>
+#include <map>
 #include <unordered_set>
 
 #include "caffe2/core/common.h"
+#include "caffe2/core/operator.h"
 #include "caffe2/core/workspace.h"
 #include "caffe2/proto/caffe2_pb.h"
 
@@ -23,6 +26,85 @@ CAFFE2_API NetDef compute_blob_recycling_for_dag(
     const std::unordered_set<string>& dont_share_blob_names,
     const std::unordered_map<string, vector<int>>& blob_shapes);
 
+// Offsets of blobs in a single preallocated arena
+struct CAFFE2_API ArenaPlan {
+  struct Slice {
+    size_t offset;
+    size_t nbytes;
+  };
+  std::map<string, Slice> slices;
+  size_t size = 0;
+};
+
+// Places blobs of the given sizes in an arena, so that blobs that can be live
+// at the same time don't overlap. `touching_ops[blob]` are the indices of the
+// ops that write or read the blob, and `precedes(i, j)` returns whether op i
+// always finishes before op j starts. Slices are aligned to gCaffe2Alignment.
+CAFFE2_API ArenaPlan compute_arena_plan(
+    const std::map<string, size_t>& blob_nbytes,
+    const std::map<string, std::vector<int>>& touching_ops,
+    const std::function<bool(int, int)>& precedes);
+
+// Keeps the activations of a net in a single arena, so that running the net
+// doesn't allocate once the shapes of its inputs are stable.
+//
+// Activations are the CPU tensors that ops of the net output, other than the
+// external inputs and outputs of the net. When the shapes of the blobs that
+// the net reads but doesn't write change, the next run allocates as usual,
+// and is used to find out which outputs alias other blobs, and the shapes of
+// outputs that shape inference can't infer. The run after that plans the
+// arena from the inferred shapes with compute_arena_plan and binds the
+// activations to their slices. Ops that resize an activation beyond its slice
+// or change its type fall back to allocating memory for it.
+//
+// Blobs of activations must not be read outside of the net, since their
+// memory is reused during the run.
+class CAFFE2_API ActivationArena {
+ public:
+  // `ops` are the operators of `net`, in the order of its ops
+  ActivationArena(
+      const NetDef& net,
+      std::vector<OperatorBase*> ops,
+      std::function<bool(int, int)> precedes);
+
+  // Frees the activations bound to the arena
+  ~ActivationArena();
+
+  // Called before every run of the net
+  void Prepare();
+
+  const ArenaPlan& plan() const {
+    return plan_;
+  }
+
+  bool IsBound() const {
+    return static_cast<bool>(data_);
+  }
+
+ private:
+  using Signature = std::vector<std::pair<std::vector<int64_t>, TypeMeta>>;
+
+  Signature InputsSignature() const;
+  void Plan();
+  void Unbind();
+
+  NetDef net_;
+  std::vector<OperatorBase*> ops_;
+  std::function<bool(int, int)> precedes_;
+  // Blobs the net reads before writing them, blobs output by CPU ops that
+  // are not external inputs or outputs, and all blobs of the net
+  std::map<string, const Blob*> inputs_;
+  std::map<string, Blob*> activations_;
+  std::map<string, const Blob*> blobs_;
+  std::map<string, std::vector<int>> touching_ops_;
+
+  Signature signature_;
+  bool has_signature_ = false;
+  bool planned_ = false;
+  ArenaPlan plan_;
+  at::DataPtr data_;
+};
+
 } // memonger
 } // caffe2
 
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "caffe2/core/allocator.h"
+#include "caffe2/core/memonger.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator.h"
+
+#include <google/protobuf/text_format.h>
+
+namespace caffe2 {
+
+namespace {
+
+class ArenaTestAddOneOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  using Operator<CPUContext>::Operator;
+
+  bool RunOnDevice() override {
+    const auto& input = Input(0);
+    auto* output = Output(0);
+    output->ResizeLike(input);
+    const auto* x = input.data<float>();
+    auto* y = output->mutable_data<float>();
+    for (int i = 0; i < input.size(); ++i) {
+      y[i] = x[i] + 1;
+    }
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(ArenaTestAddOne, ArenaTestAddOneOp);
+OPERATOR_SCHEMA(ArenaTestAddOne)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .IdenticalTypeAndShape();
+
+const auto kChainNet = R"DOC(
+  name: "chain"
+  type: "simple"
+  arg { name: "activation_arena" i: 1 }
+  external_input: "x"
+  external_output: "y"
+  op { input: "x" output: "a" type: "ArenaTestAddOne" }
+  op { input: "a" output: "b" type: "ArenaTestAddOne" }
+  op { input: "b" output: "c" type: "ArenaTestAddOne" }
+  op { input: "c" output: "y" type: "ArenaTestAddOne" }
+)DOC";
+
+const float* dataOf(Workspace* ws, const string& name) {
+  return ws->GetBlob(name)->Get<TensorCPU>().data<float>();
+}
+
+void runChain(Workspace* ws, NetBase* net, int64_t rows) {
+  auto* x = BlobGetMutableTensor(ws->GetBlob("x"), CPU);
+  x->Resize(rows, 3);
+  auto* data = x->mutable_data<float>();
+  for (int i = 0; i < x->size(); ++i) {
+    data[i] = i;
+  }
+  ASSERT_TRUE(net->Run());
+  const auto& y = ws->GetBlob("y")->Get<TensorCPU>();
+  ASSERT_EQ(y.size(), rows * 3);
+  for (int i = 0; i < y.size(); ++i) {
+    EXPECT_EQ(y.data<float>()[i], i + 4);
+  }
+}
+
+} // namespace
+
+TEST(MemongerTest, ArenaPlanReusesMemoryOfDeadBlobs) {
+  const size_t size = 2 * gCaffe2Alignment;
+  auto plan = memonger::compute_arena_plan(
+      {{"a", size}, {"b", size}, {"c", size}},
+      {{"a", {0, 1}}, {"b", {1, 2}}, {"c", {2, 3}}},
+      [](int i, int j) { return i < j; });
+  ASSERT_EQ(plan.slices.size(), 3);
+  EXPECT_EQ(plan.slices.at("a").offset, plan.slices.at("c").offset);
+  EXPECT_NE(plan.slices.at("a").offset, plan.slices.at("b").offset);
+  EXPECT_EQ(plan.size, 2 * size);
+}
+
+TEST(MemongerTest, ArenaPlanSeparatesConcurrentBlobs) {
+  // Ops 1 and 2 may run concurrently
+  auto plan = memonger::compute_arena_plan(
+      {{"a", 1}, {"b", 100}, {"c", gCaffe2Alignment}},
+      {{"a", {0, 1}}, {"b", {0, 2}}, {"c", {1, 2}}},
+      [](int i, int j) { return i == 0 && j > 0; });
+  ASSERT_EQ(plan.slices.size(), 3);
+  std::vector<std::pair<size_t, size_t>> ranges;
+  for (const auto& entry : plan.slices) {
+    EXPECT_EQ(entry.second.offset % gCaffe2Alignment, 0);
+    ranges.emplace_back(
+        entry.second.offset, entry.second.offset + entry.second.nbytes);
+  }
+  std::sort(ranges.begin(), ranges.end());
+  for (size_t i = 1; i < ranges.size(); ++i) {
+    EXPECT_LE(ranges[i - 1].second, ranges[i].first);
+  }
+  EXPECT_EQ(plan.slices.at("a").nbytes, 1);
+}
+
+TEST(MemongerTest, ActivationArenaBindsActivations) {
+  NetDef net_def;
+  CAFFE_ENFORCE(
+      google::protobuf::TextFormat::ParseFromString(kChainNet, &net_def));
+  Workspace ws;
+  ws.CreateBlob("x");
+  auto net = CreateNet(net_def, &ws);
+  ASSERT_TRUE(net);
+
+  // The first run only profiles the net
+  runChain(&ws, net.get(), 2);
+  EXPECT_NE(dataOf(&ws, "a"), dataOf(&ws, "c"));
+
+  // a and c are never live at the same time
+  for (int i = 0; i < 3; ++i) {
+    runChain(&ws, net.get(), 2);
+    EXPECT_EQ(dataOf(&ws, "a"), dataOf(&ws, "c"));
+    EXPECT_NE(dataOf(&ws, "a"), dataOf(&ws, "b"));
+  }
+  const auto* bound = dataOf(&ws, "a");
+  runChain(&ws, net.get(), 2);
+  EXPECT_EQ(dataOf(&ws, "a"), bound);
+
+  // New shapes of inputs profile the net again before binding
+  runChain(&ws, net.get(), 5);
+  EXPECT_NE(dataOf(&ws, "a"), dataOf(&ws, "c"));
+  runChain(&ws, net.get(), 5);
+  EXPECT_EQ(dataOf(&ws, "a"), dataOf(&ws, "c"));
+}
+
+TEST(MemongerTest, ActivationArenaInAsyncNet) {
+  NetDef net_def;
+  CAFFE_ENFORCE(
+      google::protobuf::TextFormat::ParseFromString(kChainNet, &net_def));
+  net_def.set_type("async_scheduling");
+  Workspace ws;
+  ws.CreateBlob("x");
+  auto net = CreateNet(net_def, &ws);
+  ASSERT_TRUE(net);
+
+  for (int i = 0; i < 3; ++i) {
+    runChain(&ws, net.get(), 4);
+  }
+  EXPECT_EQ(dataOf(&ws, "a"), dataOf(&ws, "c"));
+}
+
+} // namespace caffe2
@@ -1,6 +1,7 @@
 #include "caffe2/core/net_async_base.h"
 
 #include "caffe2/core/net_async_tracing.h"
+#include "caffe2/core/op_profile.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/timer.h"
 
@@ -11,6 +12,19 @@ C10_DEFINE_int(
     "Number of streams per worker per GPU"
     " to use in GPU thread pool (experimental)");
 
+C10_DEFINE_bool(
+    caffe2_net_async_stream_assignment,
+    false,
+    "Assign streams to tasks by coloring the task graph, so that independent "
+    "tasks run on different streams, instead of round robin");
+
+C10_DEFINE_int(
+    caffe2_priority_streams_per_gpu,
+    0,
+    "Number of the streams per worker per GPU that are created with the "
+    "highest priority; with stream assignment these run the tasks on the "
+    "critical path of the net");
+
 C10_DECLARE_bool(caffe2_dag_net_collect_stats);
 
 C10_DEFINE_bool(
@@ -58,6 +72,11 @@ C10_DEFINE_bool(
     false,
     "Use per net thread pools");
 
+C10_DEFINE_bool(
+    caffe2_net_async_work_stealing_pool,
+    false,
+    "Use CPU thread pools with per worker task deques and work stealing");
+
 namespace caffe2 {
 
 std::vector<int>& AsyncNetBase::getStreamCounters() {
@@ -90,6 +109,9 @@ AsyncNetBase::AsyncNetBase(
     chains_.push_back(kv.second);
   }
   chain_nodes_ = dag_utils::prepareChainGraphNodes(operator_nodes_, chains_);
+  if (use_stream_assignment_) {
+    assignTaskStreams();
+  }
 
   events_.reserve(chains_.size());
   for (const auto& chain : chains_) {
@@ -109,6 +131,31 @@ AsyncNetBase::AsyncNetBase(
 
   num_workers_ = net_def->has_num_workers() ? net_def->num_workers() : -1;
 
+  if (ArgumentHelper::GetSingleArgument<NetDef, bool>(
+          *net_def, "activation_arena", false)) {
+    // An op only starts once all of its ancestors finished. Parents always
+    // come before their children in the net.
+    const auto num_ops = operator_nodes_.size();
+    auto reachable = std::make_shared<std::vector<std::vector<bool>>>(
+        num_ops, std::vector<bool>(num_ops, false));
+    for (int op_id = num_ops - 1; op_id >= 0; --op_id) {
+      auto& op_reachable = (*reachable)[op_id];
+      for (auto child_id : operator_nodes_[op_id].children_) {
+        op_reachable[child_id] = true;
+        const auto& child_reachable = (*reachable)[child_id];
+        for (size_t other_id = 0; other_id < num_ops; ++other_id) {
+          if (child_reachable[other_id]) {
+            op_reachable[other_id] = true;
+          }
+        }
+      }
+    }
+    arena_ = caffe2::make_unique<memonger::ActivationArena>(
+        *net_def, operators_, [reachable](int i, int j) {
+          return (*reachable)[i][j];
+        });
+  }
+
   tracer_ = tracing::create(this, net_def->name());
   if (tracer_) {
     LOG(INFO) << "Tracing net: " << net_def->name();
@@ -128,6 +175,9 @@ bool AsyncNetBase::handleRunError() {
 bool AsyncNetBase::RunAsync() {
   tracing::startIter(tracer_);
   reset();
+  if (arena_) {
+    arena_->Prepare();
+  }
   return DoRunAsync();
 }
 
@@ -181,7 +231,29 @@ TaskThreadPoolBase* AsyncNetBase::pool(const DeviceOption& device_option) {
   }
 }
 
+void AsyncNetBase::assignTaskStreams() {
+  std::vector<int> task_devices(chains_.size(), -1);
+  for (int task_id = 0; task_id < tasksNum(); ++task_id) {
+    const auto& device_option = event(task_id).GetDeviceOption();
+    if (device_option.device_type() == PROTO_CUDA) {
+      task_devices[task_id] = device_option.device_id();
+    }
+  }
+  task_streams_ = dag_utils::assignStreams(
+      chain_nodes_,
+      chains_,
+      task_devices,
+      streams_per_gpu_,
+      FLAGS_caffe2_priority_streams_per_gpu);
+  // Parents on the same stream are skipped by the waits already, and parents
+  // implied by other parents don't need a wait at all
+  task_wait_parents_ = dag_utils::reduceChainParents(chain_nodes_);
+}
+
 int AsyncNetBase::stream(int task_id) {
+  if (!task_streams_.empty()) {
+    return task_streams_[task_id];
+  }
   const auto& device_option = event(task_id).GetDeviceOption();
   int stream_id = 0;
   if (device_option.device_type() == PROTO_CUDA) {
@@ -377,7 +449,11 @@ bool AsyncNetBase::run(int task_id, int stream_id) {
     // skip when using --caffe2_net_async_finish_chain -
     // all parents are guaranteed to be finished
     if (!finish_chain_) {
-      asyncWait(task_id, stream_id, parents(task_id));
+      asyncWait(
+          task_id,
+          stream_id,
+          task_wait_parents_.empty() ? parents(task_id)
+                                     : task_wait_parents_[task_id]);
     }
     for (auto& op_id : chains_[task_id]) {
       op = operators_[op_id];
@@ -393,11 +469,15 @@ bool AsyncNetBase::run(int task_id, int stream_id) {
         success = op->RunAsync(stream_id);
       } else {
         counters_.AddPerOpStartTime(op_id);
+        Timer op_timer;
         success = op->RunAsync(stream_id);
         if (success && op->device_option().device_type() != PROTO_CPU) {
           op->Finish();
         }
         counters_.AddPerOpEndTime(op_id);
+        if (success) {
+          OpProfileStore::Get().Record(*op, op_timer.MilliSeconds());
+        }
       }
       if (!success) {
         auto err_msg = "Failed to execute an op: " +
@@ -473,10 +553,19 @@ C10_DEFINE_SHARED_REGISTRY(
     int,
     bool);
 
-C10_REGISTER_CREATOR(
-    ThreadPoolRegistry,
-    CPU,
-    GetAsyncNetCPUThreadPool<TaskThreadPool>);
+namespace {
+std::shared_ptr<TaskThreadPoolBase>
+GetAsyncNetCPUPool(int numa_node_id, int pool_size, bool create_new) {
+  if (FLAGS_caffe2_net_async_work_stealing_pool) {
+    return GetAsyncNetCPUThreadPool<WorkStealingTaskThreadPool>(
+        numa_node_id, pool_size, create_new);
+  }
+  return GetAsyncNetCPUThreadPool<TaskThreadPool>(
+      numa_node_id, pool_size, create_new);
+}
+} // namespace
+
+C10_REGISTER_CREATOR(ThreadPoolRegistry, CPU, GetAsyncNetCPUPool);
 
 void AsyncNetBase::computeExecutionModeFlags() {
   static const std::string kDag = "dag";
@@ -492,6 +581,7 @@ void AsyncNetBase::computeExecutionModeFlags() {
   }
   if (net_type == kDag || net_type == kProfDag) {
     streams_per_gpu_ = 1;
+    use_stream_assignment_ = false;
     finish_chain_ = true;
     always_schedule_child_ = true;
     check_stream_status_ = false;
@@ -501,6 +591,7 @@ void AsyncNetBase::computeExecutionModeFlags() {
     report_stats_ = (net_type == kProfDag);
   } else if (net_type == kAsyncDag) {
     streams_per_gpu_ = 1;
+    use_stream_assignment_ = false;
     finish_chain_ = false;
     always_schedule_child_ = true;
     check_stream_status_ = false;
@@ -510,6 +601,8 @@ void AsyncNetBase::computeExecutionModeFlags() {
     report_stats_ = false;
   } else {
     streams_per_gpu_ = FLAGS_caffe2_streams_per_gpu;
+    use_stream_assignment_ =
+        FLAGS_caffe2_net_async_stream_assignment && streams_per_gpu_ > 1;
     finish_chain_ = FLAGS_caffe2_net_async_finish_chain;
     always_schedule_child_ = FLAGS_caffe2_net_async_always_schedule_child;
     check_stream_status_ = FLAGS_caffe2_net_async_check_stream_status;
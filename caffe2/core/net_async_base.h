@@ -3,6 +3,7 @@
 
 #include "c10/util/Registry.h"
 #include "caffe2/core/common.h"
+#include "caffe2/core/memonger.h"
 #include "caffe2/core/net.h"
 #include "caffe2/core/net_async_base.h"
 #include "caffe2/core/net_dag_utils.h"
@@ -16,6 +17,8 @@
 #include "caffe2/utils/thread_pool.h"
 
 C10_DECLARE_int(caffe2_streams_per_gpu);
+C10_DECLARE_bool(caffe2_net_async_stream_assignment);
+C10_DECLARE_int(caffe2_priority_streams_per_gpu);
 C10_DECLARE_bool(caffe2_net_async_finish_chain);
 C10_DECLARE_bool(caffe2_net_async_always_schedule_child);
 C10_DECLARE_int(caffe2_net_async_max_gpus);
@@ -24,6 +27,7 @@ C10_DECLARE_int(caffe2_net_async_cpu_pool_size);
 C10_DECLARE_bool(caffe2_net_async_check_stream_status);
 C10_DECLARE_bool(caffe2_net_async_use_single_pool);
 C10_DECLARE_bool(caffe2_net_async_use_per_net_pools);
+C10_DECLARE_bool(caffe2_net_async_work_stealing_pool);
 
 namespace caffe2 {
 
@@ -102,6 +106,8 @@ class CAFFE2_API AsyncNetBase : public NetBase {
   std::vector<std::vector<int>> chains_;
   std::vector<dag_utils::OpGraphNode> chain_nodes_; // chains' parents/children
   dag_utils::ExecutionChains execution_chains_; // for testing
+  // Set with the activation_arena argument of the net
+  std::unique_ptr<memonger::ActivationArena> arena_;
 
   // Pools and streams
   std::mutex pools_mutex_;
@@ -114,6 +120,11 @@ class CAFFE2_API AsyncNetBase : public NetBase {
   PoolsMap gpu_pools_;
   static std::vector<int>& getStreamCounters();
   int num_workers_;
+  // Set with --caffe2_net_async_stream_assignment: the stream of every task,
+  // and the parents every task has to wait on
+  void assignTaskStreams();
+  std::vector<int> task_streams_;
+  std::vector<std::vector<int>> task_wait_parents_;
 
   // Exception/error handling
   void setTaskErrorMessage(int task_id, const std::string& err_msg);
@@ -130,6 +141,7 @@ class CAFFE2_API AsyncNetBase : public NetBase {
   // execution mode flags
   void computeExecutionModeFlags();
   int streams_per_gpu_;
+  bool use_stream_assignment_;
   bool finish_chain_;
   bool always_schedule_child_;
   bool check_stream_status_;
@@ -32,6 +32,10 @@ C10_DECLARE_int(caffe2_streams_per_gpu);
 
 C10_DECLARE_bool(caffe2_net_async_check_stream_status);
 
+C10_DECLARE_bool(caffe2_net_async_stream_assignment);
+
+C10_DECLARE_int(caffe2_priority_streams_per_gpu);
+
 namespace caffe2 {
 
 thread_local std::vector<int> AsyncDAGNet::stream_counters_;
@@ -107,6 +111,32 @@ AsyncDAGNet::AsyncDAGNet(
   }
   VLOG(1) << "Total " << execution_chains_.size()
           << " chains, final waiting on " << events_.size() << " events";
+
+  if (FLAGS_caffe2_async_dag_use_multiple_streams &&
+      FLAGS_caffe2_net_async_stream_assignment &&
+      FLAGS_caffe2_streams_per_gpu > 1) {
+    std::vector<std::vector<int>> chains;
+    std::vector<int> chain_devices;
+    chains.reserve(execution_chains_.size());
+    for (const auto& chain : execution_chains_) {
+      chains.push_back(chain.second);
+      const auto& device_option =
+          operator_nodes_[chain.first].operator_->event().GetDeviceOption();
+      chain_devices.push_back(
+          device_option.device_type() == PROTO_CUDA
+              ? device_option.device_id()
+              : -1);
+    }
+    const auto streams = dag_utils::assignStreams(
+        dag_utils::prepareChainGraphNodes(operator_nodes_, chains),
+        chains,
+        chain_devices,
+        FLAGS_caffe2_streams_per_gpu,
+        FLAGS_caffe2_priority_streams_per_gpu);
+    for (size_t idx = 0; idx < chains.size(); ++idx) {
+      chain_streams_[chains[idx].front()] = streams[idx];
+    }
+  }
 }
 
 int AsyncDAGNet::stream(const DeviceOption& device_option) {
@@ -141,7 +171,9 @@ bool AsyncDAGNet::RunAt(int chain_id, const std::vector<int>& chain) {
       "None of the parent is recorded for an event.");
 
   int stream_id = 0;
-  if (FLAGS_caffe2_async_dag_use_multiple_streams) {
+  if (!chain_streams_.empty()) {
+    stream_id = chain_streams_.at(source_idx);
+  } else if (FLAGS_caffe2_async_dag_use_multiple_streams) {
     stream_id = stream(
         operator_nodes_[source_idx].operator_->event().GetDeviceOption());
   }
@@ -31,6 +31,9 @@ class AsyncDAGNet : public DAGNetBase {
 
   int stream(const DeviceOption& device_option);
   static thread_local std::vector<int> stream_counters_;
+  // Set with --caffe2_net_async_stream_assignment: the stream of every chain,
+  // by the id of its first op
+  std::unordered_map<int, int> chain_streams_;
 
   C10_DISABLE_COPY_AND_ASSIGN(AsyncDAGNet);
 };
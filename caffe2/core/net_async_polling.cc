@@ -10,7 +10,10 @@ namespace caffe2 {
 AsyncPollingNet::AsyncPollingNet(
     const std::shared_ptr<const NetDef>& net_def,
     Workspace* ws)
-    : AsyncNetBase(net_def, ws), running_(false) {
+    : AsyncNetBase(net_def, ws),
+      running_(false),
+      status_changed_(false),
+      pending_callbacks_(0) {
   task_timers_.resize(tasksNum());
   for (auto task_id = 0; task_id < tasksNum(); ++task_id) {
     task_timers_[task_id] = caffe2::make_unique<Timer>();
@@ -42,6 +45,7 @@ bool AsyncPollingNet::DoRunAsync() {
   if (!success) {
     finalizeEvents();
   }
+  waitForCallbacks();
 
   StopAllObservers();
   running_ = false;
@@ -77,13 +81,63 @@ void AsyncPollingNet::schedule(int task_id) {
     } catch (const std::exception&) {
       has_chain_failed_ = true;
     }
+    notifyStatusChange();
   });
 }
 
+void AsyncPollingNet::notifyStatusChange() {
+  {
+    std::unique_lock<std::mutex> lock(running_mutex_);
+    status_changed_ = true;
+  }
+  running_cv_.notify_all();
+}
+
+void AsyncPollingNet::waitForStatusChange(
+    const std::unordered_set<int>& tasks) {
+  // Tasks that are still running notify when they are done; the others need
+  // a callback on their event
+  for (auto task_id : tasks) {
+    if (status_[task_id] != EventStatus::EVENT_SCHEDULED ||
+        callback_set_[task_id]) {
+      continue;
+    }
+    auto& task_event = event(task_id);
+    if (!task_event.SupportsCallback()) {
+      return;
+    }
+    callback_set_[task_id] = true;
+    {
+      std::unique_lock<std::mutex> lock(running_mutex_);
+      ++pending_callbacks_;
+    }
+    task_event.SetCallback([this]() {
+      {
+        std::unique_lock<std::mutex> lock(running_mutex_);
+        --pending_callbacks_;
+        status_changed_ = true;
+      }
+      running_cv_.notify_all();
+    });
+  }
+
+  std::unique_lock<std::mutex> lock(running_mutex_);
+  running_cv_.wait(lock, [this]() { return status_changed_; });
+}
+
+// Callbacks refer to the net, and must not outlive the run
+void AsyncPollingNet::waitForCallbacks() {
+  std::unique_lock<std::mutex> lock(running_mutex_);
+  running_cv_.wait(lock, [this]() { return pending_callbacks_ == 0; });
+}
+
 void AsyncPollingNet::reset() {
   status_.clear();
   status_.resize(tasksNum(), EventStatus::EVENT_INITIALIZED);
   has_chain_failed_ = false;
+  callback_set_.assign(tasksNum(), false);
+  std::unique_lock<std::mutex> lock(running_mutex_);
+  status_changed_ = false;
 }
 
 bool AsyncPollingNet::pollAndSchedule() {
@@ -107,6 +161,11 @@ bool AsyncPollingNet::pollAndSchedule() {
     if (FLAGS_caffe2_dag_net_collect_stats) {
       timer.Start();
     }
+    {
+      // Changes from here on are seen by this pass or wake up the wait below
+      std::unique_lock<std::mutex> lock(running_mutex_);
+      status_changed_ = false;
+    }
     if (has_chain_failed_) {
       finishTasks(current_tasks);
       return false;
@@ -158,6 +217,9 @@ bool AsyncPollingNet::pollAndSchedule() {
       }
     }
 
+    if (updated_tasks.empty() && !next_tasks.empty()) {
+      waitForStatusChange(next_tasks);
+    }
     current_tasks.swap(next_tasks);
   }
   return true;
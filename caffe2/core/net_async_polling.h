@@ -3,6 +3,8 @@
 
 #include "caffe2/core/net_async_base.h"
 
+#include <unordered_set>
+
 namespace caffe2 {
 
 class AsyncPollingNet : public AsyncNetBase {
@@ -21,6 +23,16 @@ class AsyncPollingNet : public AsyncNetBase {
   std::condition_variable running_cv_;
   std::atomic<bool> running_;
 
+  // Instead of spinning, the polling loop sleeps until a task finishes
+  // running on its pool or the event of a scheduled task completes. Events
+  // that do not support callbacks are still polled.
+  void notifyStatusChange();
+  void waitForStatusChange(const std::unordered_set<int>& tasks);
+  void waitForCallbacks();
+  bool status_changed_; // guarded by running_mutex_
+  int pending_callbacks_; // guarded by running_mutex_
+  std::vector<bool> callback_set_;
+
   // Stats
   struct AsyncPollingNetStats {
     CAFFE_STAT_CTOR(AsyncPollingNetStats);
@@ -1,6 +1,11 @@
 #include "caffe2/core/net_async_scheduling.h"
 
 #include "caffe2/core/net_async_tracing.h"
+#include "caffe2/core/op_profile.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/operator_schema.h"
+
+#include <algorithm>
 
 C10_DEFINE_bool(
     caffe2_net_async_optimize_polling,
@@ -10,19 +15,62 @@ C10_DEFINE_bool(
     caffe2_net_async_run_root_tasks_inline,
     false,
     "Run root tasks in current thread instread of scheduling to threadpool");
+C10_DEFINE_bool(
+    caffe2_net_async_priority_scheduling,
+    false,
+    "Run ready tasks in the order of the lengths of their critical paths "
+    "instead of in FIFO order");
 
 namespace caffe2 {
 
+namespace {
+// Estimates the cost of an op by its flops, returns a negative value if
+// the op has no cost inference function or its input shapes are unknown
+float estimateOpCost(const OperatorBase& op, bool* pending) {
+  const auto* schema = OpSchemaRegistry::Schema(op.type());
+  if (!schema || !schema->HasCostInferenceFunction()) {
+    return -1.0;
+  }
+  auto shapes = op.InputTensorShapes();
+  for (const auto& shape : shapes) {
+    if (shape.unknown_shape()) {
+      *pending = true;
+      return -1.0;
+    }
+  }
+  try {
+    return schema->InferCost(op.debug_def(), shapes).flops;
+  } catch (const EnforceNotMet&) {
+    return -1.0;
+  }
+}
+} // namespace
+
 AsyncSchedulingNet::AsyncSchedulingNet(
     const std::shared_ptr<const NetDef>& net_def,
     Workspace* ws)
-    : AsyncNetBase(net_def, ws), running_(false), use_dfs_scheduling_(false) {
+    : AsyncNetBase(net_def, ws),
+      running_(false),
+      use_dfs_scheduling_(false),
+      use_priority_scheduling_(FLAGS_caffe2_net_async_priority_scheduling),
+      estimates_pending_(false) {
   for (int arg_idx = 0; arg_idx < net_def->arg_size(); ++arg_idx) {
     auto& arg = net_def->arg(arg_idx);
     if (arg.has_name() && arg.name() == "deferrable_mode") {
       CAFFE_ENFORCE(arg.has_i(), "deferrable_mode should be an int");
       use_dfs_scheduling_ = arg.i() == 1; // corr. to DFS scheduling
-      break;
+    } else if (arg.has_name() && arg.name() == "priority_scheduling") {
+      CAFFE_ENFORCE(arg.has_i(), "priority_scheduling should be an int");
+      use_priority_scheduling_ = arg.i() == 1;
+    }
+  }
+  if (use_priority_scheduling_) {
+    computeTaskPriorities();
+  }
+  if (tracer_) {
+    task_ready_us_ = std::vector<std::atomic<long>>(tasksNum());
+    for (auto& ready_us : task_ready_us_) {
+      ready_us = -1;
     }
   }
 }
@@ -30,6 +78,94 @@ AsyncSchedulingNet::AsyncSchedulingNet(
 void AsyncSchedulingNet::reset() {
   AsyncNetBase::reset();
   processed_tasks_num_ = 0;
+  // Estimates improve as shapes become known, observed timings with every
+  // profiled run
+  if (use_priority_scheduling_ && (estimates_pending_ || report_stats_)) {
+    computeTaskPriorities();
+  }
+}
+
+void AsyncSchedulingNet::computeTaskPriorities() {
+  // Observed timings are collected when profiling is enabled, and take
+  // precedence over timings of ops with the same shapes from the profile
+  // store, and then over estimates
+  std::vector<float> op_costs;
+  if (report_stats_) {
+    op_costs = counters_.GetPerOperatorMeanTime();
+  }
+  estimates_pending_ = false;
+  auto none_known = [&op_costs]() {
+    return std::none_of(op_costs.begin(), op_costs.end(), [](float cost) {
+      return cost >= 0;
+    });
+  };
+  if (none_known()) {
+    op_costs.clear();
+    for (const auto* op : operators_) {
+      op_costs.push_back(OpProfileStore::Get().MeanTime(
+          OpProfileStore::Key(*op), op->engine()));
+    }
+  }
+  if (none_known()) {
+    op_costs.clear();
+    for (const auto* op : operators_) {
+      op_costs.push_back(estimateOpCost(*op, &estimates_pending_));
+    }
+  }
+
+  // Ops of unknown cost are assumed to cost as much as known ops on average
+  float known_costs_sum = 0;
+  int known_costs_num = 0;
+  for (auto cost : op_costs) {
+    if (cost >= 0) {
+      known_costs_sum += cost;
+      ++known_costs_num;
+    }
+  }
+  const float default_cost =
+      known_costs_num > 0 ? known_costs_sum / known_costs_num : 1.0;
+
+  // Visit tasks after all of their children, starting from the last ones
+  task_priorities_.assign(tasksNum(), 0);
+  std::vector<int> children_left(tasksNum());
+  std::vector<int> ready;
+  for (auto task_id = 0; task_id < tasksNum(); ++task_id) {
+    children_left[task_id] = children(task_id).size();
+    if (children_left[task_id] == 0) {
+      ready.push_back(task_id);
+    }
+  }
+  while (!ready.empty()) {
+    auto task_id = ready.back();
+    ready.pop_back();
+    float longest_child_path = 0;
+    for (auto child_id : children(task_id)) {
+      longest_child_path =
+          std::max(longest_child_path, task_priorities_[child_id]);
+    }
+    float cost = 0;
+    for (auto op_id : chains_[task_id]) {
+      cost += op_costs[op_id] >= 0 ? op_costs[op_id] : default_cost;
+    }
+    task_priorities_[task_id] = cost + longest_child_path;
+    for (auto parent_id : parents(task_id)) {
+      if (--children_left[parent_id] == 0) {
+        ready.push_back(parent_id);
+      }
+    }
+  }
+}
+
+void AsyncSchedulingNet::runReadyTask(TaskThreadPoolBase* task_pool) {
+  std::function<void()> func;
+  {
+    std::lock_guard<std::mutex> lock(ready_tasks_mutex_);
+    auto& ready_tasks = ready_tasks_[task_pool];
+    CAFFE_ENFORCE(!ready_tasks.empty(), "No ready task to run");
+    func = ready_tasks.top().func;
+    ready_tasks.pop();
+  }
+  func();
 }
 
 void AsyncSchedulingNet::Wait() {
@@ -54,7 +190,22 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
   if (!testAndSetScheduled(task_id)) {
     return;
   }
-  auto schedule_func = [this, task_id]() {
+  // Traces the time the task waited for its parents' events since its last
+  // parent finished (scheduling delay), and for a thread of the pool
+  long scheduled_us = -1;
+  if (tracer_ && tracer_->isEnabled()) {
+    scheduled_us = tracer_->timestamp();
+    const long ready_us = task_ready_us_[task_id].exchange(-1);
+    if (ready_us >= 0) {
+      tracer_->recordSpan(
+          "scheduling_delay", task_id, ready_us, scheduled_us);
+    }
+  }
+  auto schedule_func = [this, task_id, run_inline, scheduled_us]() {
+    if (scheduled_us >= 0 && !run_inline) {
+      tracer_->recordSpan(
+          "queue_wait", task_id, scheduled_us, tracer_->timestamp());
+    }
     if (success_) {
       int stream_id = 0;
       if (streams_per_gpu_ > 1) {
@@ -78,6 +229,9 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
     for (auto child_id : children(task_id)) {
       int parent_count = updateParentCount(child_id);
       if (parent_count == 0) {
+        if (scheduled_us >= 0) {
+          task_ready_us_[child_id] = tracer_->timestamp();
+        }
         // Schedule a child if:
         // - there is failure, we skip an op execution and finish the job
         // - forced scheduling though --caffe2_net_async_always_schedule_child
@@ -182,7 +336,20 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
     schedule_func();
   } else {
     const auto& device_option = event(task_id).GetDeviceOption();
-    pool(device_option)->run(schedule_func);
+    auto* task_pool = pool(device_option);
+    if (use_priority_scheduling_) {
+      // Every job of the pool runs the best task that is ready by the time
+      // the job starts, rather than the task it was submitted for
+      {
+        std::lock_guard<std::mutex> lock(ready_tasks_mutex_);
+        ready_tasks_[task_pool].push(
+            ReadyTask{task_priorities_[task_id], task_id, schedule_func});
+      }
+      task_pool->run(
+          std::bind(&AsyncSchedulingNet::runReadyTask, this, task_pool));
+    } else {
+      task_pool->run(schedule_func);
+    }
   }
 }
 
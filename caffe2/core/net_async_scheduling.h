@@ -3,6 +3,11 @@
 
 #include "caffe2/core/net_async_base.h"
 
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
 namespace caffe2 {
 
 class CAFFE2_API AsyncSchedulingNet : public AsyncNetBase {
@@ -14,6 +19,10 @@ class CAFFE2_API AsyncSchedulingNet : public AsyncNetBase {
 
   void Wait() override;
 
+  const std::vector<float>& TEST_task_priorities() const {
+    return task_priorities_;
+  }
+
  protected:
   bool RunAsync() override;
 
@@ -23,6 +32,8 @@ class CAFFE2_API AsyncSchedulingNet : public AsyncNetBase {
   virtual void finishRun();
   void parentCallback(int parent_id);
   bool isInlineTask(int parent_id, int child_id) const;
+  void computeTaskPriorities();
+  void runReadyTask(TaskThreadPoolBase* task_pool);
 
   std::mutex running_mutex_;
   std::condition_variable running_cv_;
@@ -31,6 +42,31 @@ class CAFFE2_API AsyncSchedulingNet : public AsyncNetBase {
 
   std::atomic<int> processed_tasks_num_;
 
+  // When traced, time (us) at which the last parent of a task finished, or -1
+  std::vector<std::atomic<long>> task_ready_us_;
+
+  // Priority scheduling: ready tasks wait in a queue per pool and are run in
+  // the order of the lengths of their critical paths, i.e. the costs of the
+  // longest paths from them to the end of the net
+  struct ReadyTask {
+    float priority;
+    int task_id;
+    std::function<void()> func;
+
+    bool operator<(const ReadyTask& other) const {
+      return priority < other.priority ||
+          (priority == other.priority && task_id > other.task_id);
+    }
+  };
+  bool use_priority_scheduling_;
+  // Whether some op costs are still to be estimated from the shapes of their
+  // inputs, which are not known until they are produced by a run
+  bool estimates_pending_;
+  std::vector<float> task_priorities_;
+  std::mutex ready_tasks_mutex_;
+  std::unordered_map<TaskThreadPoolBase*, std::priority_queue<ReadyTask>>
+      ready_tasks_;
+
   C10_DISABLE_COPY_AND_ASSIGN(AsyncSchedulingNet);
 };
 
@@ -16,7 +16,10 @@
 
 #include "caffe2/core/net_async_tracing.h"
 
+#include <csignal>
+
 #include "caffe2/utils/proto_utils.h"
+#include "caffe2/utils/signal_handler.h"
 #include "caffe2/utils/string_utils.h"
 
 C10_DEFINE_string(
@@ -38,9 +41,83 @@ C10_DEFINE_int(
     10000,
     "Dump profiling result file every Nth batch");
 
+C10_DEFINE_int(
+    caffe2_net_async_tracing_buffer_size,
+    16384,
+    "Number of the last events kept per thread and traced net");
+
+C10_DEFINE_bool(
+    caffe2_net_async_tracing_on_demand,
+    false,
+    "Create a tracer for every async net, which only traces when a trace is "
+    "requested (see caffe2_net_async_tracing_signal)");
+
+C10_DEFINE_int(
+    caffe2_net_async_tracing_on_demand_iters,
+    10,
+    "Number of iterations traced and dumped by every tracer on a trace "
+    "request");
+
+C10_DEFINE_int(
+    caffe2_net_async_tracing_signal,
+    0,
+    "If positive, number of the signal (e.g. 10 for SIGUSR1 on Linux) that "
+    "requests a trace of the next caffe2_net_async_tracing_on_demand_iters "
+    "iterations of the traced nets");
+
 namespace caffe2 {
 namespace tracing {
 
+namespace {
+
+std::atomic<int64_t>& traceRequests() {
+  static std::atomic<int64_t> requests(0);
+  return requests;
+}
+
+// Spans of the task i are shown as the thread kSpanThreadLabel + i, apart
+// from the ops that the pool threads ran meanwhile
+const long kSpanThreadLabel = 1000000;
+
+int64_t nextTracerId() {
+  static std::atomic<int64_t> next_id(0);
+  return next_id++;
+}
+
+#if defined(CAFFE2_SUPPORTS_SIGNAL_HANDLER)
+struct sigaction previousTraceSignalAction;
+
+void handleTraceSignal(int signal) {
+  requestTrace();
+  if (previousTraceSignalAction.sa_handler != SIG_DFL &&
+      previousTraceSignalAction.sa_handler != SIG_IGN &&
+      previousTraceSignalAction.sa_handler) {
+    previousTraceSignalAction.sa_handler(signal);
+  }
+}
+#endif // defined(CAFFE2_SUPPORTS_SIGNAL_HANDLER)
+
+void installTraceSignalHandler() {
+#if defined(CAFFE2_SUPPORTS_SIGNAL_HANDLER)
+  static std::once_flag installed;
+  std::call_once(installed, [] {
+    const int signal = FLAGS_caffe2_net_async_tracing_signal;
+    if (signal <= 0) {
+      return;
+    }
+    struct sigaction sa;
+    sa.sa_handler = &handleTraceSignal;
+    sa.sa_flags = SA_RESTART;
+    sigfillset(&sa.sa_mask);
+    if (sigaction(signal, &sa, &previousTraceSignalAction) == -1) {
+      LOG(ERROR) << "Cannot install the tracing handler of signal " << signal;
+    }
+  });
+#endif // defined(CAFFE2_SUPPORTS_SIGNAL_HANDLER)
+}
+
+} // namespace
+
 int getCounterForNetName(const std::string& net_name) {
   // Append a unique number suffix because there could be multiple instances
   // of the same net and we want to uniquely associate each instance with
@@ -53,17 +130,99 @@ int getCounterForNetName(const std::string& net_name) {
   return counter;
 }
 
-Tracer::Tracer(const NetBase* net, const std::string& net_name)
-    : net_(net), filename_(net_name), iter_(0) {
+Tracer::Tracer(
+    const NetBase* net,
+    const std::string& net_name,
+    bool periodic)
+    : net_(net),
+      id_(nextTracerId()),
+      periodic_(periodic),
+      filename_(net_name),
+      iter_(0),
+      seen_requests_(traceRequests().load()) {
   std::replace(filename_.begin(), filename_.end(), '/', '_');
   filename_ = FLAGS_caffe2_net_async_tracing_filepath + "/" + filename_ +
       +"_id_" + caffe2::to_string(getCounterForNetName(net_name));
   timer_.Start();
 }
 
+TracerThreadBuffer* Tracer::threadBuffer() {
+  // The buffers of the tracers the thread recorded in. The entries of the
+  // destroyed tracers are never looked up again, their ids are not reused.
+  static thread_local std::unordered_map<int64_t, TracerThreadBuffer*>
+      thread_buffers;
+  auto& buffer = thread_buffers[id_];
+  if (!buffer) {
+    const auto tid = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(tracer_mutex_);
+    auto& owned_buffer = buffers_[tid];
+    if (!owned_buffer) {
+      owned_buffer = caffe2::make_unique<TracerThreadBuffer>(
+          std::max(FLAGS_caffe2_net_async_tracing_buffer_size, 1), tid);
+    }
+    buffer = owned_buffer.get();
+  }
+  return buffer;
+}
+
 void Tracer::recordEvent(const TracerEvent& event) {
+  auto* buffer = threadBuffer();
+  const auto written = buffer->written.load(std::memory_order_relaxed);
+  buffer->events[written % buffer->events.size()] = event;
+  buffer->written.store(written + 1, std::memory_order_release);
+}
+
+void Tracer::recordSpan(
+    const char* category,
+    int task_id,
+    long start_us,
+    long end_us) {
+  TracerEvent event;
+  event.name_ = category;
+  event.category_ = category;
+  event.task_id_ = task_id;
+  event.timestamp_ = start_us;
+  event.duration_ = std::max(end_us - start_us, 0L);
+  event.thread_label_ = kSpanThreadLabel + task_id;
+  recordEvent(event);
+}
+
+long Tracer::timestamp() {
+  return (long)caffe2::round(timer_.MicroSeconds());
+}
+
+std::vector<TracerEvent> Tracer::collectEvents() {
+  std::vector<TracerEvent> events;
   std::lock_guard<std::mutex> lock(tracer_mutex_);
-  events_.push_back(event);
+  for (auto& kv : buffers_) {
+    auto* buffer = kv.second.get();
+    const uint64_t capacity = buffer->events.size();
+    const auto written = buffer->written.load(std::memory_order_acquire);
+    const auto begin =
+        std::max(buffer->dumped, written - std::min(written, capacity));
+    const auto first = events.size();
+    for (auto idx = begin; idx < written; ++idx) {
+      events.push_back(buffer->events[idx % capacity]);
+    }
+    // The owning thread may have overwritten the oldest events while they
+    // were copied, including the slot of the event it is writing
+    const auto rewritten = buffer->written.load(std::memory_order_acquire);
+    if (rewritten + 1 > begin + capacity) {
+      const auto overwritten =
+          std::min<uint64_t>(rewritten + 1 - capacity - begin, written - begin);
+      events.erase(
+          events.begin() + first, events.begin() + first + overwritten);
+    }
+    buffer->dumped = written;
+  }
+  // Events of a thread are recorded in the order of their timestamps
+  std::stable_sort(
+      events.begin(),
+      events.end(),
+      [](const TracerEvent& lhs, const TracerEvent& rhs) {
+        return lhs.timestamp_ < rhs.timestamp_;
+      });
+  return events;
 }
 
 // Forward
@@ -108,7 +267,7 @@ std::string Tracer::serializeEvent(const TracerEvent& event) {
     serialized_event << " \"tid\": " << event.tid_ << ",\n";
   }
 
-  if (event.is_beginning_) {
+  if (event.is_beginning_ || event.duration_ >= 0) {
     std::unordered_map<std::string, int> int_args;
     std::unordered_map<std::string, std::string> string_args;
     if (event.name_) {
@@ -142,7 +301,12 @@ std::string Tracer::serializeEvent(const TracerEvent& event) {
       int_args["stream_id"] = event.stream_id_;
     }
 
-    serialized_event << " \"ph\": \"B\"";
+    if (event.duration_ >= 0) {
+      serialized_event << " \"ph\": \"X\",\n";
+      serialized_event << " \"dur\": " << event.duration_;
+    } else {
+      serialized_event << " \"ph\": \"B\"";
+    }
     if (!int_args.empty() || !string_args.empty()) {
       serialized_event << ",\n \"args\": {\n";
       auto left_to_output = int_args.size() + string_args.size();
@@ -171,12 +335,12 @@ std::string Tracer::serializeEvent(const TracerEvent& event) {
 }
 
 // fix occasional cases with zero duration events
-void Tracer::linearizeEvents() {
+void Tracer::linearizeEvents(std::vector<TracerEvent>* events) {
   std::unordered_map<long, long> time_offsets;
   std::unordered_map<long, long> last_times;
   std::hash<std::thread::id> hasher;
   const long time_eps = 1; // us
-  for (auto& event : events_) {
+  for (auto& event : *events) {
     long tid =
         (event.thread_label_ >= 0) ? event.thread_label_ : hasher(event.tid_);
     auto event_ts = event.timestamp_;
@@ -205,13 +369,13 @@ void Tracer::linearizeEvents() {
   }
 }
 
-void Tracer::renameThreads() {
+void Tracer::renameThreads(std::vector<TracerEvent>* events) {
   std::unordered_map<long, int> tids;
   std::unordered_map<int, int> numa_counters;
   std::unordered_map<long, int> tid_to_numa;
   std::hash<std::thread::id> hasher;
   const long numa_multiplier = 1000000000;
-  for (auto& event : events_) {
+  for (auto& event : *events) {
     if (event.thread_label_ >= 0 || event.op_id_ < 0) {
       continue;
     }
@@ -247,21 +411,51 @@ bool Tracer::isEnabled() const {
   return enabled_;
 }
 
+bool Tracer::isPeriodic() const {
+  return periodic_;
+}
+
 int Tracer::bumpIter() {
   return iter_++;
 }
 
+bool Tracer::onDemandIter() {
+  const auto requests = traceRequests().load();
+  if (requests != seen_requests_) {
+    seen_requests_ = requests;
+    if (!on_demand_dump_pending_) {
+      on_demand_iters_left_ = FLAGS_caffe2_net_async_tracing_on_demand_iters;
+      on_demand_dump_pending_ = true;
+    }
+  }
+  if (on_demand_iters_left_ > 0) {
+    --on_demand_iters_left_;
+    return true;
+  }
+  if (on_demand_dump_pending_) {
+    // the previous iteration was the last requested one
+    on_demand_dump_pending_ = false;
+    dumpTracingResultAndClearEvents(
+        "on_demand_" + caffe2::to_string(on_demand_dumps_++));
+  }
+  return false;
+}
+
 void Tracer::dumpTracingResultAndClearEvents(const std::string& file_suffix) {
-  if (events_.empty() || filename_.empty()) {
+  if (filename_.empty()) {
     return;
   }
-  linearizeEvents();
-  renameThreads();
+  auto events = collectEvents();
+  if (events.empty()) {
+    return;
+  }
+  linearizeEvents(&events);
+  renameThreads(&events);
   std::stringstream serialized;
   serialized << "[\n";
-  for (size_t idx = 0; idx < events_.size(); ++idx) {
-    serialized << serializeEvent(events_[idx]);
-    if (idx != events_.size() - 1) {
+  for (size_t idx = 0; idx < events.size(); ++idx) {
+    serialized << serializeEvent(events[idx]);
+    if (idx != events.size() - 1) {
       serialized << ",\n";
     }
   }
@@ -270,7 +464,6 @@ void Tracer::dumpTracingResultAndClearEvents(const std::string& file_suffix) {
   auto output_file_name = filename_ + "_iter_" + file_suffix + ".json";
   LOG(INFO) << "Dumping profiling result file to " << output_file_name;
   WriteStringToFile(serialized.str(), output_file_name.c_str());
-  events_.clear();
 }
 
 Tracer::~Tracer() {
@@ -326,7 +519,7 @@ void TracerGuard::recordEventStart() {
       event_.tid_ = std::this_thread::get_id();
     }
     event_.is_beginning_ = true;
-    event_.timestamp_ = (long)caffe2::round(tracer_->timer_.MicroSeconds());
+    event_.timestamp_ = tracer_->timestamp();
     tracer_->recordEvent(event_);
   }
 }
@@ -334,7 +527,7 @@ void TracerGuard::recordEventStart() {
 TracerGuard::~TracerGuard() {
   if (enabled_) {
     event_.is_beginning_ = false;
-    event_.timestamp_ = (long)caffe2::round(tracer_->timer_.MicroSeconds());
+    event_.timestamp_ = tracer_->timestamp();
     tracer_->recordEvent(event_);
   }
 }
@@ -394,8 +587,14 @@ std::shared_ptr<Tracer> create(
   // Enable the tracer if the net has the "enable_tracing" argument set OR
   // if the command line option includes the net name option in the list of
   // tracable nets.
+  // Otherwise, with --caffe2_net_async_tracing_on_demand, the tracer only
+  // traces on request.
   bool trace_net = hasEnableTracingFlag(net) || isTraceableNetName(net_name);
-  return trace_net ? std::make_shared<Tracer>(net, net_name) : nullptr;
+  if (trace_net || FLAGS_caffe2_net_async_tracing_on_demand) {
+    installTraceSignalHandler();
+    return std::make_shared<Tracer>(net, net_name, trace_net);
+  }
+  return nullptr;
 }
 
 bool startIter(const std::shared_ptr<Tracer>& tracer) {
@@ -403,15 +602,25 @@ bool startIter(const std::shared_ptr<Tracer>& tracer) {
     return false;
   }
   auto iter = tracer->bumpIter();
-  auto is_enabled = iter % FLAGS_caffe2_net_async_tracing_nth == 0;
-  tracer->setEnabled(is_enabled);
-  if (iter % FLAGS_caffe2_net_async_tracing_dumping_nth == 0) {
-    int dumping_iter = iter / FLAGS_caffe2_net_async_tracing_dumping_nth;
-    tracer->dumpTracingResultAndClearEvents(caffe2::to_string(dumping_iter));
+  bool is_enabled = false;
+  if (tracer->isPeriodic()) {
+    is_enabled = iter % FLAGS_caffe2_net_async_tracing_nth == 0;
+    if (iter % FLAGS_caffe2_net_async_tracing_dumping_nth == 0) {
+      int dumping_iter = iter / FLAGS_caffe2_net_async_tracing_dumping_nth;
+      tracer->dumpTracingResultAndClearEvents(caffe2::to_string(dumping_iter));
+    }
+  }
+  if (tracer->onDemandIter()) {
+    is_enabled = true;
   }
+  tracer->setEnabled(is_enabled);
   return is_enabled;
 }
 
+void requestTrace() {
+  ++traceRequests();
+}
+
 } // namespace tracing
 
 } // namespace caffe2
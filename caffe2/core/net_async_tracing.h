@@ -17,6 +17,10 @@
 #ifndef CAFFE2_CORE_NET_ASYNC_TRACING_H_
 #define CAFFE2_CORE_NET_ASYNC_TRACING_H_
 
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
 #include "caffe2/core/common.h"
 #include "caffe2/core/net_async_base.h"
 #include "caffe2/core/operator.h"
@@ -25,6 +29,7 @@
 C10_DECLARE_string(caffe2_net_async_tracing_filepath);
 C10_DECLARE_string(caffe2_net_async_names_to_trace);
 C10_DECLARE_int(caffe2_net_async_tracing_nth);
+C10_DECLARE_bool(caffe2_net_async_tracing_on_demand);
 
 namespace caffe2 {
 namespace tracing {
@@ -36,6 +41,9 @@ struct CAFFE2_API TracerEvent {
   const char* name_ = nullptr;
   const char* category_ = nullptr;
   long timestamp_ = -1.0;
+  // Non-negative for the complete events of the given duration (us), which
+  // have no end event
+  long duration_ = -1;
   bool is_beginning_ = false;
   long thread_label_ = -1;
   std::thread::id tid_;
@@ -50,19 +58,52 @@ enum TracingField {
   TRACE_CATEGORY,
 };
 
+// Fixed size ring of the last events recorded by a thread. Only the owning
+// thread writes it, without locking; the events are formatted only when they
+// are dumped.
+struct CAFFE2_API TracerThreadBuffer {
+  TracerThreadBuffer(size_t capacity, std::thread::id tid)
+      : events(capacity), tid(tid) {}
+
+  std::vector<TracerEvent> events;
+  std::thread::id tid;
+  // number of events recorded, published after the event is written
+  std::atomic<uint64_t> written{0};
+  // number of events already dumped, only used by the dumping thread
+  uint64_t dumped = 0;
+};
+
 class CAFFE2_API Tracer {
  public:
-  Tracer(const NetBase* net, const std::string& net_name);
+  // A periodic tracer traces every caffe2_net_async_tracing_nth iteration,
+  // the others only trace on demand (see requestTrace)
+  Tracer(
+      const NetBase* net,
+      const std::string& net_name,
+      bool periodic = true);
 
   void recordEvent(const TracerEvent& event);
+  // Records a complete event of the given category for the time between
+  // start_us and end_us, e.g. the wait of a task in the queue of a pool
+  void recordSpan(
+      const char* category,
+      int task_id,
+      long start_us,
+      long end_us);
+  // Time since the creation of the tracer, in us
+  long timestamp();
   std::string opTraceName(const OperatorBase* op);
   std::string opBlobsInfo(const OperatorBase& op);
   std::string serializeEvent(const TracerEvent& event);
-  void linearizeEvents();
-  void renameThreads();
+  void linearizeEvents(std::vector<TracerEvent>* events);
+  void renameThreads(std::vector<TracerEvent>* events);
   void setEnabled(bool enabled);
   bool isEnabled() const;
+  bool isPeriodic() const;
   int bumpIter();
+  // Whether the coming iteration is traced because of a trace request. Dumps
+  // the events once the requested iterations are traced.
+  bool onDemandIter();
   // Dump the tracing result to file with given suffix, and then
   // clear current events.
   void dumpTracingResultAndClearEvents(const std::string& file_suffix);
@@ -70,13 +111,26 @@ class CAFFE2_API Tracer {
   virtual ~Tracer();
 
  private:
+  TracerThreadBuffer* threadBuffer();
+  // Events recorded since the last dump by all the threads, in the order of
+  // their timestamps
+  std::vector<TracerEvent> collectEvents();
+
   const NetBase* net_ = nullptr;
+  // unique, unlike the address of the tracer, to look up the buffers
+  const int64_t id_;
+  const bool periodic_;
   std::string filename_;
-  std::vector<TracerEvent> events_;
+  std::unordered_map<std::thread::id, std::unique_ptr<TracerThreadBuffer>>
+      buffers_;
   std::mutex tracer_mutex_;
   bool enabled_ = false;
   Timer timer_;
   int iter_;
+  int64_t seen_requests_;
+  int on_demand_iters_left_ = 0;
+  bool on_demand_dump_pending_ = false;
+  int on_demand_dumps_ = 0;
 
   friend class TracerGuard;
 };
@@ -118,6 +172,13 @@ CAFFE2_API bool isTraceableNetName(const std::string& net_name);
 CAFFE2_API std::shared_ptr<Tracer> create(const NetBase* net, const std::string& net_name);
 CAFFE2_API bool startIter(const std::shared_ptr<Tracer>& tracer);
 
+// Makes every tracer trace its next caffe2_net_async_tracing_on_demand_iters
+// iterations and dump them, e.g. from an RPC handler of a live server. With
+// caffe2_net_async_tracing_on_demand, every async net has a tracer, and the
+// signal caffe2_net_async_tracing_signal (if positive) requests a trace too.
+// Async signal safe.
+CAFFE2_API void requestTrace();
+
 } // namespace tracing
 
 #define TRACE_NAME_CONCATENATE(s1, s2) s1##s2
@@ -16,6 +16,10 @@
 
 #include <gtest/gtest.h>
 #include "caffe2/core/net_async_tracing.h"
+#include "caffe2/utils/proto_utils.h"
+
+C10_DECLARE_int(caffe2_net_async_tracing_buffer_size);
+C10_DECLARE_int(caffe2_net_async_tracing_on_demand_iters);
 
 namespace caffe2 {
 
@@ -37,6 +41,37 @@ TEST(NetAsyncTracingTest, ExtractShardId) {
   testExtractShardId("FC:shard:15", 15);
 }
 
+TEST(NetAsyncTracingTest, OnDemandTraceKeepsLastEvents) {
+  FLAGS_caffe2_net_async_tracing_buffer_size = 4;
+  FLAGS_caffe2_net_async_tracing_on_demand_iters = 2;
+  Tracer tracer(nullptr, "on_demand_test", /* periodic */ false);
+  EXPECT_FALSE(tracer.onDemandIter());
+
+  requestTrace();
+  for (int iter = 0; iter < 2; ++iter) {
+    EXPECT_TRUE(tracer.onDemandIter());
+    for (int task_id = 0; task_id < 5; ++task_id) {
+      tracer.recordSpan("queue_wait", task_id, 10 * task_id, 10 * task_id + 1);
+    }
+  }
+  // Dumps the last 4 events
+  EXPECT_FALSE(tracer.onDemandIter());
+
+  std::string trace;
+  ASSERT_TRUE(ReadStringFromFile(
+      (FLAGS_caffe2_net_async_tracing_filepath +
+       "/on_demand_test_id_1_iter_on_demand_0.json")
+          .c_str(),
+      &trace));
+  int num_events = 0;
+  for (auto pos = trace.find("\"ph\": \"X\""); pos != std::string::npos;
+       pos = trace.find("\"ph\": \"X\"", pos + 1)) {
+    ++num_events;
+  }
+  EXPECT_EQ(num_events, 4);
+  EXPECT_NE(trace.find("\"task_id\": 4"), std::string::npos);
+}
+
 } // namespace tracing
 
 } // namespace caffe2
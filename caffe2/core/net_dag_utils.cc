@@ -508,5 +508,191 @@ std::vector<OpGraphNode> prepareChainGraphNodes(
   return chain_nodes;
 }
 
+namespace {
+
+std::vector<int> topologicalOrder(const std::vector<OpGraphNode>& nodes) {
+  std::vector<int> order;
+  order.reserve(nodes.size());
+  std::vector<int> num_parents(nodes.size());
+  for (int idx = 0; idx < (int)nodes.size(); ++idx) {
+    num_parents[idx] = nodes[idx].parents_.size();
+    if (num_parents[idx] == 0) {
+      order.push_back(idx);
+    }
+  }
+  for (size_t pos = 0; pos < order.size(); ++pos) {
+    for (auto child : nodes[order[pos]].children_) {
+      if (--num_parents[child] == 0) {
+        order.push_back(child);
+      }
+    }
+  }
+  CAFFE_ENFORCE_EQ(order.size(), nodes.size(), "Chain graph has a cycle");
+  return order;
+}
+
+// Ancestor bitsets of all nodes of a graph. Above kMaxNodes nodes the table
+// would take too much memory, and only parents count as ancestors.
+class AncestorTable {
+ public:
+  AncestorTable(
+      const std::vector<OpGraphNode>& nodes,
+      const std::vector<int>& order)
+      : nodes_(nodes), words_((nodes.size() + 63) / 64) {
+    if (nodes.size() > kMaxNodes) {
+      return;
+    }
+    bits_.assign(nodes.size() * words_, 0);
+    for (auto idx : order) {
+      uint64_t* node_bits = &bits_[idx * words_];
+      for (auto parent : nodes[idx].parents_) {
+        const uint64_t* parent_bits = &bits_[parent * words_];
+        for (size_t w = 0; w < words_; ++w) {
+          node_bits[w] |= parent_bits[w];
+        }
+        node_bits[parent / 64] |= uint64_t(1) << (parent % 64);
+      }
+    }
+  }
+
+  bool isAncestor(int ancestor, int idx) const {
+    if (bits_.empty()) {
+      const auto& parents = nodes_[idx].parents_;
+      return std::find(parents.begin(), parents.end(), ancestor) !=
+          parents.end();
+    }
+    return (bits_[idx * words_ + ancestor / 64] >> (ancestor % 64)) & 1;
+  }
+
+ private:
+  static constexpr size_t kMaxNodes = 16384;
+
+  const std::vector<OpGraphNode>& nodes_;
+  const size_t words_;
+  std::vector<uint64_t> bits_;
+};
+
+} // namespace
+
+std::vector<int> assignStreams(
+    const std::vector<OpGraphNode>& chain_nodes,
+    const std::vector<std::vector<int>>& execution_chains,
+    const std::vector<int>& chain_devices,
+    int num_streams,
+    int num_priority_streams) {
+  const int num_chains = chain_nodes.size();
+  CAFFE_ENFORCE_EQ(execution_chains.size(), chain_nodes.size());
+  CAFFE_ENFORCE_EQ(chain_devices.size(), chain_nodes.size());
+  CAFFE_ENFORCE_GT(num_streams, 0);
+  CAFFE_ENFORCE(
+      num_priority_streams >= 0 && num_priority_streams < num_streams,
+      "Need at least one stream besides the ",
+      num_priority_streams,
+      " priority streams");
+
+  const auto order = topologicalOrder(chain_nodes);
+  std::vector<int> position(num_chains);
+  for (int pos = 0; pos < num_chains; ++pos) {
+    position[order[pos]] = pos;
+  }
+
+  // Longest paths from a source through every chain, and from every chain
+  // to a sink, in ops
+  std::vector<bool> critical(num_chains, false);
+  if (num_priority_streams > 0) {
+    std::vector<int> from_source(num_chains, 0);
+    std::vector<int> to_sink(num_chains, 0);
+    int longest = 0;
+    for (auto idx : order) {
+      for (auto parent : chain_nodes[idx].parents_) {
+        from_source[idx] = std::max(from_source[idx], from_source[parent]);
+      }
+      from_source[idx] += execution_chains[idx].size();
+      longest = std::max(longest, from_source[idx]);
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+      for (auto child : chain_nodes[*it].children_) {
+        to_sink[*it] = std::max(to_sink[*it], to_sink[child]);
+      }
+      to_sink[*it] += execution_chains[*it].size();
+    }
+    for (int idx = 0; idx < num_chains; ++idx) {
+      critical[idx] = from_source[idx] + to_sink[idx] -
+              (int)execution_chains[idx].size() ==
+          longest;
+    }
+  }
+
+  const AncestorTable ancestors(chain_nodes, order);
+  // The last chain assigned to every stream of every GPU
+  std::unordered_map<int, std::vector<int>> last_chains;
+  std::vector<int> streams(num_chains, 0);
+  for (auto idx : order) {
+    const auto device = chain_devices[idx];
+    if (device < 0) {
+      continue;
+    }
+    auto& last_chain = last_chains[device];
+    if (last_chain.empty()) {
+      last_chain.assign(num_streams, -1);
+    }
+    int begin = 0;
+    int end = num_streams;
+    if (num_priority_streams > 0) {
+      begin = critical[idx] ? 0 : num_priority_streams;
+      end = critical[idx] ? num_priority_streams : num_streams;
+    }
+
+    int stream_id = -1;
+    for (auto parent : chain_nodes[idx].parents_) {
+      const auto parent_stream = streams[parent];
+      if (chain_devices[parent] == device && parent_stream >= begin &&
+          parent_stream < end && last_chain[parent_stream] == parent) {
+        stream_id = parent_stream;
+        break;
+      }
+    }
+    for (int s = begin; stream_id < 0 && s < end; ++s) {
+      if (last_chain[s] < 0 || ancestors.isAncestor(last_chain[s], idx)) {
+        stream_id = s;
+      }
+    }
+    if (stream_id < 0) {
+      // Out of streams, serialize after the chain that was assigned first
+      stream_id = begin;
+      for (int s = begin + 1; s < end; ++s) {
+        if (position[last_chain[s]] < position[last_chain[stream_id]]) {
+          stream_id = s;
+        }
+      }
+    }
+    streams[idx] = stream_id;
+    last_chain[stream_id] = idx;
+  }
+  return streams;
+}
+
+std::vector<std::vector<int>> reduceChainParents(
+    const std::vector<OpGraphNode>& chain_nodes) {
+  const AncestorTable ancestors(chain_nodes, topologicalOrder(chain_nodes));
+  std::vector<std::vector<int>> reduced(chain_nodes.size());
+  for (size_t idx = 0; idx < chain_nodes.size(); ++idx) {
+    const auto& parents = chain_nodes[idx].parents_;
+    for (auto parent : parents) {
+      bool implied = false;
+      for (auto other : parents) {
+        if (other != parent && ancestors.isAncestor(parent, other)) {
+          implied = true;
+          break;
+        }
+      }
+      if (!implied) {
+        reduced[idx].push_back(parent);
+      }
+    }
+  }
+  return reduced;
+}
+
 } // namespace dag_utils
 } // namespace caffe2
@@ -63,6 +63,28 @@ std::vector<OpGraphNode> prepareChainGraphNodes(
     const std::vector<dag_utils::OperatorNode>& operator_nodes,
     const std::vector<std::vector<int>>& execution_chains);
 
+// Assigns streams to the chains of a net by coloring the chain graph: a chain
+// continues the stream of one of its parents when it is the first child to
+// run there, and otherwise takes a stream whose last chain is one of its
+// ancestors, so that chains which may run concurrently land on different
+// streams while there are enough of them. chain_devices holds the GPU of
+// every chain, or -1 for chains that don't run on streams (these get stream
+// 0). If num_priority_streams > 0, chains on a longest path through the net,
+// counted in ops, get the first num_priority_streams streams of their GPU and
+// all other chains the remaining ones. Returns the stream of every chain.
+C10_EXPORT std::vector<int> assignStreams(
+    const std::vector<OpGraphNode>& chain_nodes,
+    const std::vector<std::vector<int>>& execution_chains,
+    const std::vector<int>& chain_devices,
+    int num_streams,
+    int num_priority_streams = 0);
+
+// The parents of every chain without the ones that are also ancestors of
+// another of its parents. Waiting on these is enough, since the events of
+// the remaining parents are only recorded after their own waits.
+C10_EXPORT std::vector<std::vector<int>> reduceChainParents(
+    const std::vector<OpGraphNode>& chain_nodes);
+
 } // namespace dag_utils
 } // namespace caffe2
 
@@ -293,4 +293,55 @@ TEST(DagUtilTest, Mixed2) {
       {0, {0}}, {1, {1}}, {3, {3, 6}}, {4, {4, 2, 5}}, {7, {7}}, {8, {8}}};
   EXPECT_EQ(chains, expected);
 }
+namespace {
+std::vector<dag_utils::OpGraphNode> ChainGraph(
+    int num_chains,
+    const std::vector<std::pair<int, int>>& edges) {
+  std::vector<dag_utils::OpGraphNode> nodes(num_chains);
+  for (const auto& edge : edges) {
+    nodes[edge.first].children_.push_back(edge.second);
+    nodes[edge.second].parents_.push_back(edge.first);
+  }
+  return nodes;
+}
+} // namespace
+
+// 0 forks into 1 and 2, which join in 3
+TEST(DagUtilTest, AssignStreamsDiamond) {
+  const auto nodes = ChainGraph(4, {{0, 1}, {0, 2}, {1, 3}, {2, 3}});
+  const std::vector<std::vector<int>> chains{{0}, {1}, {2}, {3}};
+  auto streams = dag_utils::assignStreams(nodes, chains, {0, 0, 0, 0}, 2);
+  EXPECT_EQ(streams, (std::vector<int>{0, 0, 1, 0}));
+
+  // With a single stream everything is serialized
+  streams = dag_utils::assignStreams(nodes, chains, {0, 0, 0, 0}, 1);
+  EXPECT_EQ(streams, (std::vector<int>{0, 0, 0, 0}));
+
+  // Chains on different GPUs and CPU chains don't compete for streams
+  streams = dag_utils::assignStreams(nodes, chains, {0, 1, 0, -1}, 2);
+  EXPECT_EQ(streams, (std::vector<int>{0, 0, 0, 0}));
+}
+
+// Three independent branches of 0, where 0 -> 2 -> 4 is the longest
+TEST(DagUtilTest, AssignStreamsPriority) {
+  const auto nodes = ChainGraph(5, {{0, 1}, {0, 2}, {0, 3}, {2, 4}});
+  const std::vector<std::vector<int>> chains{{0}, {1}, {2, 3}, {4}, {5}};
+  const std::vector<int> devices(5, 0);
+  auto streams = dag_utils::assignStreams(nodes, chains, devices, 3, 1);
+  // The critical path has the priority stream to itself
+  EXPECT_EQ(streams, (std::vector<int>{0, 1, 0, 2, 0}));
+
+  streams = dag_utils::assignStreams(nodes, chains, devices, 3);
+  EXPECT_EQ(streams, (std::vector<int>{0, 0, 1, 2, 1}));
+}
+
+TEST(DagUtilTest, ReduceChainParents) {
+  // 0 -> 1 -> 2 and 0 -> 2, 3 -> 2
+  const auto nodes = ChainGraph(4, {{0, 1}, {1, 2}, {0, 2}, {3, 2}});
+  const auto parents = dag_utils::reduceChainParents(nodes);
+  EXPECT_TRUE(parents[0].empty());
+  EXPECT_EQ(parents[1], (std::vector<int>{0}));
+  EXPECT_EQ(parents[2], (std::vector<int>{1, 3}));
+}
+
 } // namespace caffe2
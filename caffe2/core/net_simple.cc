@@ -45,9 +45,18 @@ SimpleNet::SimpleNet(
     }
     operators_.emplace_back(std::move(op));
   }
+
+  if (ArgumentHelper::GetSingleArgument<NetDef, bool>(
+          *net_def, "activation_arena", false)) {
+    arena_ = caffe2::make_unique<memonger::ActivationArena>(
+        *net_def, GetOperators(), [](int i, int j) { return i < j; });
+  }
 }
 
 bool SimpleNet::Run() {
+  if (arena_) {
+    arena_->Prepare();
+  }
   StartAllObservers();
   VLOG(1) << "Running net " << name_;
   for (auto& op : operators_) {
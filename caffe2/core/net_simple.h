@@ -6,6 +6,7 @@
 #include "c10/util/Registry.h"
 #include "caffe2/core/common.h"
 #include "caffe2/core/logging.h"
+#include "caffe2/core/memonger.h"
 #include "caffe2/core/net.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/core/workspace.h"
@@ -47,6 +48,8 @@ class CAFFE2_API SimpleNet : public NetBase {
   bool RunAsync() override;
 
   vector<unique_ptr<OperatorBase>> operators_;
+  // Set with the activation_arena argument of the net
+  unique_ptr<memonger::ActivationArena> arena_;
 
   C10_DISABLE_COPY_AND_ASSIGN(SimpleNet);
 };
@@ -815,4 +815,158 @@ TEST(NetTest, PendingOpsAndNetFailure) {
   ASSERT_FALSE(net->Run());
 }
 
+namespace {
+// Returns the priority of the task that runs the op at op_id
+float taskPriorityOfOp(const AsyncSchedulingNet& net, int op_id) {
+  const auto& chains = net.TEST_execution_chains();
+  const auto& priorities = net.TEST_task_priorities();
+  int task_id = 0;
+  for (const auto& chain : chains) {
+    const auto& ops = chain.second;
+    if (std::find(ops.begin(), ops.end(), op_id) != ops.end()) {
+      return priorities.at(task_id);
+    }
+    ++task_id;
+  }
+  CAFFE_THROW("No task runs op ", op_id);
+}
+} // namespace
+
+TEST(NetTest, PrioritySchedulingByCriticalPath) {
+  const auto spec = R"DOC(
+        name: "example"
+        type: "async_scheduling"
+        arg {
+          name: "priority_scheduling"
+          i: 1
+        }
+        external_input: "in"
+        op {
+          input: "in"
+          output: "x"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "x"
+          output: "long1"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "long1"
+          output: "long2"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "long2"
+          output: "long3"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "x"
+          output: "side"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "long3"
+          input: "side"
+          output: "out"
+          type: "NetTestDummy"
+        }
+)DOC";
+
+  NetDef net_def;
+  CAFFE_ENFORCE(TextFormat::ParseFromString(spec, &net_def));
+  Workspace ws;
+  ws.CreateBlob("in");
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  auto* async_net = dynamic_cast_if_rtti<AsyncSchedulingNet*>(net.get());
+  CHECK_NOTNULL(async_net);
+
+  // Ops without a known cost count as one each
+  EXPECT_EQ(5, taskPriorityOfOp(*async_net, 0));
+  EXPECT_EQ(4, taskPriorityOfOp(*async_net, 1));
+  EXPECT_EQ(2, taskPriorityOfOp(*async_net, 4));
+  EXPECT_EQ(1, taskPriorityOfOp(*async_net, 5));
+
+  testExecution(net, net_def.op().size());
+}
+
+REGISTER_CPU_OPERATOR(NetTestCostly, NetTestDummyOp);
+
+OPERATOR_SCHEMA(NetTestCostly)
+    .NumInputs(0, INT_MAX)
+    .NumOutputs(0, INT_MAX)
+    .CostInferenceFunction([](const OperatorDef& def,
+                              const vector<TensorShape>& /*inputs*/) {
+      struct OpSchema::Cost c;
+      ArgumentHelper helper(def);
+      c.flops = helper.GetSingleArgument<int>("flops", 1);
+      return c;
+    });
+
+TEST(NetTest, PrioritySchedulingByEstimatedCost) {
+#ifdef CAFFE2_NO_OPERATOR_SCHEMA
+  return;
+#endif
+  const auto spec = R"DOC(
+        name: "example"
+        type: "async_scheduling"
+        arg {
+          name: "priority_scheduling"
+          i: 1
+        }
+        external_input: "in"
+        op {
+          input: "in"
+          output: "x"
+          type: "NetTestCostly"
+        }
+        op {
+          input: "x"
+          output: "costly"
+          type: "NetTestCostly"
+          arg {
+            name: "flops"
+            i: 100
+          }
+        }
+        op {
+          input: "x"
+          output: "cheap1"
+          type: "NetTestCostly"
+        }
+        op {
+          input: "cheap1"
+          output: "cheap2"
+          type: "NetTestCostly"
+        }
+        op {
+          input: "costly"
+          input: "cheap2"
+          output: "out"
+          type: "NetTestCostly"
+        }
+)DOC";
+
+  NetDef net_def;
+  CAFFE_ENFORCE(TextFormat::ParseFromString(spec, &net_def));
+  // Costs are estimated once the shapes of all inputs are known
+  Workspace ws;
+  for (const auto& name : {"in", "x", "costly", "cheap1", "cheap2"}) {
+    auto* tensor = BlobGetMutableTensor(ws.CreateBlob(name), CPU);
+    tensor->Resize(1);
+    tensor->mutable_data<float>();
+  }
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  auto* async_net = dynamic_cast_if_rtti<AsyncSchedulingNet*>(net.get());
+  CHECK_NOTNULL(async_net);
+
+  EXPECT_EQ(102, taskPriorityOfOp(*async_net, 0));
+  EXPECT_EQ(101, taskPriorityOfOp(*async_net, 1));
+  EXPECT_EQ(3, taskPriorityOfOp(*async_net, 2));
+  EXPECT_EQ(1, taskPriorityOfOp(*async_net, 4));
+
+  testExecution(net, net_def.op().size());
+}
+
 } // namespace caffe2
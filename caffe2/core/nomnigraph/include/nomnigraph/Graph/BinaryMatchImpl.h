@@ -3,6 +3,8 @@
 
 #include "nomnigraph/Graph/Graph.h"
 
+#include <unordered_map>
+
 namespace nom {
 namespace algorithm {
 
@@ -11,12 +13,12 @@ template <typename F, typename T, typename... U>
 std::vector<Subgraph<T, U...>> binaryMatch(Graph<T, U...>* g, F condition) {
   using G = Graph<T, U...>;
 
-  auto swappableCondition = [&](typename G::NodeRef m, bool match) {
-    return match ? condition(m) : !condition(m);
-  };
-
-  auto edges = g->getMutableEdges();
-  std::unordered_set<typename G::EdgeRef> edgeSet(edges.begin(), edges.end());
+  // The condition of every node is evaluated once, and Kahn's algorithm
+  // counts the in-edges every node has left instead of searching for them,
+  // so that matching is linear in the size of the graph.
+  std::unordered_map<typename G::NodeRef, bool> conditions;
+  std::unordered_map<typename G::NodeRef, size_t> remainingInEdges;
+  size_t remainingEdges = 0;
 
   // Topologically sorted matching subgraphs.
   std::vector<Subgraph<T, U...>> sortedNodes;
@@ -26,8 +28,13 @@ std::vector<Subgraph<T, U...>> binaryMatch(Graph<T, U...>* g, F condition) {
   std::vector<typename G::NodeRef> nextFrontier;
 
   for (auto n : g->getMutableNodes()) {
-    if (n->getInEdges().size() == 0) {
-      if (condition(n)) {
+    const bool nodeMatches = condition(n);
+    conditions[n] = nodeMatches;
+    const size_t inEdges = n->getInEdges().size();
+    remainingInEdges[n] = inEdges;
+    remainingEdges += inEdges;
+    if (inEdges == 0) {
+      if (nodeMatches) {
         frontier.emplace_back(n);
       } else {
         nextFrontier.emplace_back(n);
@@ -35,15 +42,6 @@ std::vector<Subgraph<T, U...>> binaryMatch(Graph<T, U...>* g, F condition) {
     }
   }
 
-  auto stillHasInEdge = [&](typename G::NodeRef m) {
-    for (auto inEdge : m->getInEdges()) {
-      if (edgeSet.count(inEdge)) {
-        return true;
-      }
-    }
-    return false;
-  };
-
   // This boolean will store which type of match we are looking for.
   // If true we are looking for the condition to return true,
   // if false we are looking for the condition to return false
@@ -59,8 +57,7 @@ std::vector<Subgraph<T, U...>> binaryMatch(Graph<T, U...>* g, F condition) {
   while (frontier.size() || nextFrontier.size()) {
     // Swap everything if we exhausted the current frontier.
     if (!frontier.size() && nextFrontier.size()) {
-      frontier = nextFrontier;
-      nextFrontier.clear();
+      frontier.swap(nextFrontier);
       match = !match;
       if (match) {
         sortedNodes.emplace_back();
@@ -78,13 +75,9 @@ std::vector<Subgraph<T, U...>> binaryMatch(Graph<T, U...>* g, F condition) {
 
     for (auto outEdge : n->getOutEdges()) {
       auto m = outEdge->head();
-      if (!edgeSet.count(outEdge)) {
-        continue;
-      }
-      edgeSet.erase(outEdge);
-
-      if (!stillHasInEdge(m)) {
-        if (swappableCondition(m, match)) {
+      remainingEdges--;
+      if (--remainingInEdges[m] == 0) {
+        if (conditions[m] == match) {
           frontier.emplace_back(m);
         } else {
           nextFrontier.emplace_back(m);
@@ -93,7 +86,7 @@ std::vector<Subgraph<T, U...>> binaryMatch(Graph<T, U...>* g, F condition) {
     }
   }
 
-  if (edgeSet.size()) {
+  if (remainingEdges) {
     assert(
         0 &&
         "Invalid graph for Kahn's algorithm, cycle detected.  Please use Tarjans.");
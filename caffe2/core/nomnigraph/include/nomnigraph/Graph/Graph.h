@@ -14,6 +14,7 @@
 #include <algorithm>
 #include <iterator>
 #include <list>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -257,15 +258,11 @@ class Graph {
   // Move a node from this graph to the destGraph
   void moveNode(NodeRef node, Graph<T, U...>* destGraph) {
     assert(hasNode(node));
-    for (auto it = nodes_.begin(); it != nodes_.end(); ++it) {
-      if (&(*it) == node) {
-        std::list<Node<T, U...>>& destNodes = destGraph->nodes_;
-        destNodes.splice(destNodes.end(), nodes_, it);
-        nodeRefs_.erase(node);
-        destGraph->nodeRefs_.insert(node);
-        break;
-      }
-    }
+    auto it = nodeRefs_.find(node)->second;
+    std::list<Node<T, U...>>& destNodes = destGraph->nodes_;
+    destNodes.splice(destNodes.end(), nodes_, it);
+    nodeRefs_.erase(node);
+    destGraph->nodeRefs_[node] = it;
   }
 
   // Move an edge from this graph to the destGraph
@@ -273,13 +270,11 @@ class Graph {
     assert(hasEdge(edge));
     assert(destGraph->hasNode(edge->tail()));
     assert(destGraph->hasNode(edge->head()));
+    auto it = edgeRefs_.find(edge)->second;
     std::list<Edge<T, U...>>& destEdges = destGraph->edges_;
-    for (auto it = edges_.begin(); it != edges_.end(); ++it) {
-      if (&(*it) == edge) {
-        destEdges.splice(destEdges.end(), edges_, it);
-        break;
-      }
-    }
+    destEdges.splice(destEdges.end(), edges_, it);
+    edgeRefs_.erase(edge);
+    destGraph->edgeRefs_[edge] = it;
   }
 
   // Move entire subgraph to destGraph.
@@ -293,9 +288,10 @@ class Graph {
       auto node = &(*it);
       if (sg.hasNode(node)) {
         std::list<Node<T, U...>>& destNodes = destGraph->nodes_;
-        destNodes.splice(destNodes.end(), nodes_, it--);
+        auto nodeIt = it--;
+        destNodes.splice(destNodes.end(), nodes_, nodeIt);
         nodeRefs_.erase(node);
-        destGraph->nodeRefs_.insert(node);
+        destGraph->nodeRefs_[node] = nodeIt;
         sg.removeNode(node);
       }
     }
@@ -304,7 +300,10 @@ class Graph {
       if (sg.hasEdge(edge)) {
         assert(destGraph->hasNode(edge->tail()));
         assert(destGraph->hasNode(edge->head()));
-        destEdges.splice(destEdges.end(), edges_, it--);
+        auto edgeIt = it--;
+        destEdges.splice(destEdges.end(), edges_, edgeIt);
+        edgeRefs_.erase(edge);
+        destGraph->edgeRefs_[edge] = edgeIt;
         sg.removeEdge(edge);
       }
     }
@@ -417,6 +416,7 @@ class Graph {
     this->edges_.emplace_back(
         Edge<T, U...>(tail, head, std::forward<U...>(data)...));
     EdgeRef e = &this->edges_.back();
+    edgeRefs_[e] = std::prev(this->edges_.end());
     head->addInEdge(e);
     tail->addOutEdge(e);
     return e;
@@ -439,12 +439,7 @@ class Graph {
   }
 
   bool hasEdge(EdgeRef e) const {
-    for (auto& edge : edges_) {
-      if (e == &edge) {
-        return true;
-      }
-    }
-    return false;
+    return edgeRefs_.find(e) != edgeRefs_.end();
   }
 
   /// \brief Get a reference to the edge between two nodes if it exists.
@@ -471,13 +466,9 @@ class Graph {
       deleteEdge(edge);
     }
 
-    for (auto i = nodes_.begin(); i != nodes_.end(); ++i) {
-      if (&*i == n) {
-        nodeRefs_.erase(n);
-        nodes_.erase(i);
-        break;
-      }
-    }
+    auto it = nodeRefs_.find(n);
+    nodes_.erase(it->second);
+    nodeRefs_.erase(it);
   }
 
   // Delete all nodes in the set.
@@ -496,11 +487,10 @@ class Graph {
   void deleteEdge(EdgeRef e) {
     e->tail_->removeOutEdge(e);
     e->head_->removeInEdge(e);
-    for (auto i = edges_.begin(); i != edges_.end(); ++i) {
-      if (&*i == e) {
-        edges_.erase(i);
-        break;
-      }
+    auto it = edgeRefs_.find(e);
+    if (it != edgeRefs_.end()) {
+      edges_.erase(it->second);
+      edgeRefs_.erase(it);
     }
   }
 
@@ -533,13 +523,18 @@ class Graph {
  private:
   std::list<Node<T, U...>> nodes_;
   std::list<Edge<T, U...>> edges_;
-  std::unordered_set<NodeRef> nodeRefs_;
+  // Where every node and edge lives in the lists above, so that looking
+  // them up and deleting them does not scan the whole graph.
+  std::unordered_map<NodeRef, typename std::list<Node<T, U...>>::iterator>
+      nodeRefs_;
+  std::unordered_map<EdgeRef, typename std::list<Edge<T, U...>>::iterator>
+      edgeRefs_;
 
   NodeRef createNodeInternal(Node<T, U...>&& node) {
     nodes_.emplace_back(std::move(node));
     NodeRef nodeRef = &nodes_.back();
     DEBUG_PRINT("Creating node (%p)\n", nodeRef);
-    nodeRefs_.insert(nodeRef);
+    nodeRefs_[nodeRef] = std::prev(nodes_.end());
     return nodeRef;
   }
 
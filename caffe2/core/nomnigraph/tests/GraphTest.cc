@@ -39,6 +39,34 @@ TEST(Basic, DeleteEdge) {
   g.deleteEdge(e);
 }
 
+TEST(Basic, DeleteAfterMoves) {
+  TestGraph g;
+  auto n1 = createTestNode(g);
+  auto n2 = createTestNode(g);
+  auto n3 = createTestNode(g);
+  auto e1 = g.createEdge(n1, n2);
+  auto e2 = g.createEdge(n2, n3);
+  EXPECT_TRUE(g.hasEdge(e1));
+
+  // Nodes and edges are still found in the graph they were moved to
+  TestGraph g2;
+  g.deleteEdge(e2);
+  EXPECT_FALSE(g.hasEdge(e2));
+  g.moveNode(n1, &g2);
+  g.moveNode(n2, &g2);
+  g.moveEdge(e1, &g2);
+  EXPECT_FALSE(g.hasEdge(e1));
+  EXPECT_TRUE(g2.hasEdge(e1));
+  g2.deleteNode(n1);
+  EXPECT_FALSE(g2.hasNode(n1));
+  EXPECT_FALSE(g2.hasEdge(e1));
+  EXPECT_TRUE(g2.isValid());
+  EXPECT_EQ(g2.getMutableNodes().size(), 1);
+  EXPECT_EQ(g2.getMutableEdges().size(), 0);
+  g.deleteNode(n3);
+  EXPECT_EQ(g.getMutableNodes().size(), 0);
+}
+
 TEST(Basic, ReplaceEdges) {
   TestGraph g;
   auto n1 = createTestNode(g);
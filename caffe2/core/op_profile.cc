@@ -0,0 +1,211 @@
+#include "caffe2/core/op_profile.h"
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/core/workspace.h"
+
+C10_DEFINE_string(
+    caffe2_op_profile_file,
+    "",
+    "File with op run times to load into the op profile store");
+
+namespace caffe2 {
+
+OpProfileStore& OpProfileStore::Get() {
+  static OpProfileStore* store = []() {
+    auto* store = new OpProfileStore();
+    if (!FLAGS_caffe2_op_profile_file.empty()) {
+      store->Load(FLAGS_caffe2_op_profile_file);
+    }
+    return store;
+  }();
+  return *store;
+}
+
+std::string OpProfileStore::Key(
+    const std::string& type,
+    int device_type,
+    const std::vector<TensorShape>& input_shapes) {
+  std::ostringstream key;
+  key << type << "|" << device_type << "|";
+  for (size_t i = 0; i < input_shapes.size(); ++i) {
+    const auto& shape = input_shapes[i];
+    if (i > 0) {
+      key << ",";
+    }
+    if (shape.unknown_shape()) {
+      key << "?";
+      continue;
+    }
+    key << shape.data_type() << ":";
+    for (int j = 0; j < shape.dims_size(); ++j) {
+      key << (j > 0 ? "x" : "") << shape.dims(j);
+    }
+  }
+  return key.str();
+}
+
+std::string OpProfileStore::Key(const OperatorBase& op) {
+  return Key(
+      op.type(), op.device_option().device_type(), op.InputTensorShapes());
+}
+
+void OpProfileStore::Record(
+    const std::string& key,
+    const std::string& engine,
+    float ms) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& times = times_[key][engine];
+  times.sum_ms += ms;
+  ++times.runs;
+}
+
+float OpProfileStore::MeanTime(
+    const std::string& key,
+    const std::string& engine) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = times_.find(key);
+  if (it == times_.end()) {
+    return -1.0;
+  }
+  auto engine_it = it->second.find(engine);
+  if (engine_it == it->second.end() || engine_it->second.runs == 0) {
+    return -1.0;
+  }
+  return engine_it->second.sum_ms / engine_it->second.runs;
+}
+
+bool OpProfileStore::FastestEngine(
+    const std::string& key,
+    int64_t min_runs,
+    std::string* engine) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = times_.find(key);
+  if (it == times_.end()) {
+    return false;
+  }
+  bool found = false;
+  double fastest = std::numeric_limits<double>::max();
+  for (const auto& entry : it->second) {
+    const auto& times = entry.second;
+    if (times.runs == 0 || times.runs < min_runs) {
+      continue;
+    }
+    const auto mean = times.sum_ms / times.runs;
+    if (mean < fastest) {
+      fastest = mean;
+      *engine = entry.first;
+      found = true;
+    }
+  }
+  return found;
+}
+
+// One line per key and engine, with tab separated fields:
+// key, engine, number of runs, total time in milliseconds
+void OpProfileStore::Save(const std::string& path) const {
+  std::ofstream file(path);
+  CAFFE_ENFORCE(file.good(), "Unable to open op profile file ", path);
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (const auto& entry : times_) {
+    for (const auto& engine_times : entry.second) {
+      file << entry.first << "\t" << engine_times.first << "\t"
+           << engine_times.second.runs << "\t" << engine_times.second.sum_ms
+           << "\n";
+    }
+  }
+  CAFFE_ENFORCE(file.good(), "Unable to write op profile file ", path);
+}
+
+void OpProfileStore::Load(const std::string& path) {
+  std::ifstream file(path);
+  if (!file.good()) {
+    LOG(WARNING) << "Unable to open op profile file " << path;
+    return;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string key, engine;
+    Times times;
+    if (!std::getline(fields, key, '\t') ||
+        !std::getline(fields, engine, '\t') ||
+        !(fields >> times.runs >> times.sum_ms)) {
+      LOG(WARNING) << "Skipping malformed line of op profile file " << path
+                   << ": " << line;
+      continue;
+    }
+    auto& merged = times_[key][engine];
+    merged.runs += times.runs;
+    merged.sum_ms += times.sum_ms;
+  }
+}
+
+void OpProfileStore::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  times_.clear();
+}
+
+void ProfileEngines(
+    const NetDef& net,
+    Workspace* ws,
+    const std::vector<std::string>& engines,
+    int num_runs) {
+  for (const auto& engine : engines) {
+    NetDef engine_net = net;
+    engine_net.set_type("simple");
+    for (auto& op : *engine_net.mutable_op()) {
+      op.set_engine(engine);
+    }
+    auto instance = CreateNet(engine_net, ws);
+    CAFFE_ENFORCE(instance, "Unable to create net ", net.name());
+    const auto ops = instance->GetOperators();
+    for (int run = 0; run <= num_runs; ++run) {
+      for (auto* op : ops) {
+        // Keyed by the shapes of the inputs before ops change them in place
+        const auto key = OpProfileStore::Key(*op);
+        Timer timer;
+        CAFFE_ENFORCE(op->Run(), "Failed to run op ", op->type());
+        // The first run only warms up
+        if (run > 0) {
+          OpProfileStore::Get().Record(key, op->engine(), timer.MilliSeconds());
+        }
+      }
+    }
+  }
+}
+
+int SelectFastestEngines(NetDef* net, const Workspace& ws, int64_t min_runs) {
+  int selected = 0;
+  for (auto& op : *net->mutable_op()) {
+    std::vector<TensorShape> input_shapes;
+    for (const auto& input : op.input()) {
+      const auto* blob = ws.GetBlob(input);
+      if (blob) {
+        input_shapes.push_back(GetTensorShapeOfBlob(blob));
+      } else {
+        input_shapes.emplace_back();
+        input_shapes.back().set_unknown_shape(true);
+      }
+    }
+    // Ops run on the device of the net unless they set their own
+    const auto& device_option =
+        op.has_device_option() ? op.device_option() : net->device_option();
+    const auto key = OpProfileStore::Key(
+        op.type(), device_option.device_type(), input_shapes);
+    std::string engine;
+    if (OpProfileStore::Get().FastestEngine(key, min_runs, &engine)) {
+      op.set_engine(engine);
+      ++selected;
+    }
+  }
+  return selected;
+}
+
+} // namespace caffe2
@@ -0,0 +1,89 @@
+#ifndef CAFFE2_CORE_OP_PROFILE_H_
+#define CAFFE2_CORE_OP_PROFILE_H_
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/proto/caffe2_pb.h"
+
+C10_DECLARE_string(caffe2_op_profile_file);
+
+namespace caffe2 {
+
+/**
+ * Run times of operators shared by all nets of the process, keyed by the op
+ * type, the device type and the shapes of the inputs, and then by the engine
+ * that ran the op.
+ *
+ * Async nets record the run time of every op when they collect stats, and
+ * the async scheduling net uses the recorded times to prioritize ops on the
+ * critical path. SelectFastestEngines uses them to pick an engine for every
+ * op of a net. The store can be saved to a file and loaded back, and is
+ * loaded from --caffe2_op_profile_file when it is first used.
+ */
+class CAFFE2_API OpProfileStore {
+ public:
+  static OpProfileStore& Get();
+
+  static std::string Key(
+      const std::string& type,
+      int device_type,
+      const std::vector<TensorShape>& input_shapes);
+  static std::string Key(const OperatorBase& op);
+
+  void Record(const std::string& key, const std::string& engine, float ms);
+  void Record(const OperatorBase& op, float ms) {
+    Record(Key(op), op.engine(), ms);
+  }
+
+  // Mean run time in milliseconds, negative when no runs were recorded
+  float MeanTime(const std::string& key, const std::string& engine) const;
+
+  // Sets `engine` to the engine with the lowest mean run time among the
+  // engines with at least `min_runs` runs. Returns false when there are none.
+  bool FastestEngine(
+      const std::string& key,
+      int64_t min_runs,
+      std::string* engine) const;
+
+  // Saves all recorded times, or merges the times saved to a file
+  void Save(const std::string& path) const;
+  void Load(const std::string& path);
+
+  void Clear();
+
+ private:
+  struct Times {
+    double sum_ms = 0;
+    int64_t runs = 0;
+  };
+
+  OpProfileStore() {}
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::map<std::string, Times>> times_;
+};
+
+// Runs every op of `net` `num_runs` times after one warmup run, once for
+// each of `engines` preferred by all ops, and records the run times of the
+// ops. The net must be safe to run repeatedly in `ws`.
+CAFFE2_API void ProfileEngines(
+    const NetDef& net,
+    Workspace* ws,
+    const std::vector<std::string>& engines,
+    int num_runs);
+
+// Sets the engine of every op of `net` to the fastest engine recorded for the
+// shapes of its inputs in `ws`, among engines with at least `min_runs` runs.
+// Returns the number of ops whose engine was set.
+CAFFE2_API int
+SelectFastestEngines(NetDef* net, const Workspace& ws, int64_t min_runs = 1);
+
+} // namespace caffe2
+
+#endif // CAFFE2_CORE_OP_PROFILE_H_
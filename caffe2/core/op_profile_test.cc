@@ -0,0 +1,86 @@
+#include <cstdio>
+
+#include <gtest/gtest.h>
+#include "caffe2/core/op_profile.h"
+#include "caffe2/core/workspace.h"
+
+#include <google/protobuf/text_format.h>
+
+namespace caffe2 {
+
+namespace {
+
+class OpProfileTestOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  using Operator<CPUContext>::Operator;
+
+  bool RunOnDevice() override {
+    Output(0)->CopyFrom(Input(0), &context_);
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(OpProfileTest, OpProfileTestOp);
+OPERATOR_SCHEMA(OpProfileTest).NumInputs(1).NumOutputs(1);
+
+const auto kNet = R"DOC(
+  name: "profiled"
+  external_input: "x"
+  op { input: "x" output: "y" type: "OpProfileTest" }
+)DOC";
+
+} // namespace
+
+TEST(OpProfileTest, RecordsAndSavesTimes) {
+  OpProfileStore::Get().Clear();
+  const auto key = OpProfileStore::Key("Conv", PROTO_CPU, {});
+  EXPECT_LT(OpProfileStore::Get().MeanTime(key, ""), 0);
+  OpProfileStore::Get().Record(key, "", 3);
+  OpProfileStore::Get().Record(key, "", 1);
+  OpProfileStore::Get().Record(key, "FAST", 1);
+  EXPECT_EQ(OpProfileStore::Get().MeanTime(key, ""), 2);
+
+  std::string engine;
+  ASSERT_TRUE(OpProfileStore::Get().FastestEngine(key, 1, &engine));
+  EXPECT_EQ(engine, "FAST");
+  ASSERT_TRUE(OpProfileStore::Get().FastestEngine(key, 2, &engine));
+  EXPECT_EQ(engine, "");
+
+  const std::string path = std::tmpnam(nullptr);
+  OpProfileStore::Get().Save(path);
+  OpProfileStore::Get().Clear();
+  OpProfileStore::Get().Load(path);
+  std::remove(path.c_str());
+  EXPECT_EQ(OpProfileStore::Get().MeanTime(key, ""), 2);
+  EXPECT_EQ(OpProfileStore::Get().MeanTime(key, "FAST"), 1);
+}
+
+TEST(OpProfileTest, SelectsFastestEngines) {
+  OpProfileStore::Get().Clear();
+  NetDef net_def;
+  CAFFE_ENFORCE(google::protobuf::TextFormat::ParseFromString(kNet, &net_def));
+  Workspace ws;
+  auto* x = BlobGetMutableTensor(ws.CreateBlob("x"), CPU);
+  x->Resize(4, 2);
+  x->mutable_data<float>();
+
+  // Nothing is selected for ops that were never profiled
+  EXPECT_EQ(SelectFastestEngines(&net_def, ws), 0);
+
+  ProfileEngines(net_def, &ws, {""}, 3);
+  const auto key = OpProfileStore::Key(
+      "OpProfileTest", PROTO_CPU, {GetTensorShapeOfBlob(ws.GetBlob("x"))});
+  EXPECT_GE(OpProfileStore::Get().MeanTime(key, ""), 0);
+
+  // Slower than the default engine ever is
+  OpProfileStore::Get().Record(key, "SLOW", 1e6);
+  OpProfileStore::Get().Record(key, "SLOW", 1e6);
+  OpProfileStore::Get().Record(key, "SLOW", 1e6);
+  net_def.mutable_op(0)->set_engine("SLOW");
+  EXPECT_EQ(SelectFastestEngines(&net_def, ws, 3), 1);
+  EXPECT_EQ(net_def.op(0).engine(), "");
+  OpProfileStore::Get().Clear();
+}
+
+} // namespace caffe2
@@ -64,6 +64,49 @@ vector<TensorShape> OperatorBase::InputTensorShapes() const {
   return tps;
 }
 
+bool OperatorBase::InputShapesChanged() {
+  bool changed = input_shape_types_.size() != inputs_.size();
+  size_t pos = 0;
+  for (size_t i = 0; i < inputs_.size() && !changed; ++i) {
+    const auto* blob = inputs_[i];
+    if (!blob->IsType<Tensor>()) {
+      changed = blob->meta() != input_shape_types_[i] ||
+          pos >= input_shape_dims_.size() || input_shape_dims_[pos++] != 0;
+      continue;
+    }
+    const auto& tensor = blob->Get<Tensor>();
+    const auto dims = tensor.dims();
+    changed = tensor.meta() != input_shape_types_[i] ||
+        pos + dims.size() >= input_shape_dims_.size() ||
+        input_shape_dims_[pos] != static_cast<int64_t>(dims.size()) ||
+        !std::equal(
+            dims.begin(), dims.end(), input_shape_dims_.begin() + pos + 1);
+    pos += dims.size() + 1;
+  }
+  changed = changed || pos != input_shape_dims_.size();
+  if (!changed) {
+    ++input_shape_cache_hits_;
+    return false;
+  }
+
+  ++input_shape_cache_misses_;
+  input_shape_types_.clear();
+  input_shape_dims_.clear();
+  for (const auto* blob : inputs_) {
+    if (!blob->IsType<Tensor>()) {
+      input_shape_types_.push_back(blob->meta());
+      input_shape_dims_.push_back(0);
+      continue;
+    }
+    const auto& tensor = blob->Get<Tensor>();
+    input_shape_types_.push_back(tensor.meta());
+    input_shape_dims_.push_back(tensor.ndim());
+    input_shape_dims_.insert(
+        input_shape_dims_.end(), tensor.dims().begin(), tensor.dims().end());
+  }
+  return true;
+}
+
 namespace {
 
 PerOpEnginePrefType& g_per_op_engine_pref() {
@@ -186,6 +186,20 @@ class CAFFE2_API OperatorBase : public Observable<OperatorBase> {
   inline const vector<Blob*>& Outputs() { return outputs_; }
   vector<TensorShape> InputTensorShapes() const;
 
+  // Returns whether the types or shapes of the inputs changed since the last
+  // call, and remembers them. Operators call it once per run to skip setup
+  // that only depends on the input shapes, such as shape checks, descriptors
+  // or scratch buffer sizes. The first call always returns true.
+  bool InputShapesChanged();
+
+  // The number of calls to InputShapesChanged that returned false and true
+  int64_t input_shape_cache_hits() const {
+    return input_shape_cache_hits_;
+  }
+  int64_t input_shape_cache_misses() const {
+    return input_shape_cache_misses_;
+  }
+
   virtual void WaitEvent(const Event& ev, int /*stream_id */ = -1) {
     ev.Finish();
   }
@@ -386,6 +400,13 @@ class CAFFE2_API OperatorBase : public Observable<OperatorBase> {
 
   ExecutorHelper* helper_ = nullptr;
 
+  // Types and shapes of the inputs at the last call of InputShapesChanged,
+  // with the number of dims of each input followed by its dims
+  vector<TypeMeta> input_shape_types_;
+  vector<int64_t> input_shape_dims_;
+  int64_t input_shape_cache_hits_ = 0;
+  int64_t input_shape_cache_misses_ = 0;
+
  protected:
   virtual void RecordEvent(const char* /*err_msg*/ = nullptr) {
     CAFFE_NOT_IMPLEMENTED;
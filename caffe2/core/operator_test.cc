@@ -125,6 +125,36 @@ TEST(OperatorTest, ExceptionWorks) {
   }
 }
 
+TEST(OperatorTest, InputShapesChanged) {
+  OperatorDef op_def;
+  Workspace ws;
+  op_def.set_type("JustTest");
+  op_def.add_input("input");
+  op_def.add_input("other");
+  auto* input = BlobGetMutableTensor(ws.CreateBlob("input"), CPU);
+  ws.CreateBlob("other")->GetMutable<int>();
+  unique_ptr<OperatorBase> op = CreateOperator(op_def, &ws);
+  EXPECT_NE(nullptr, op.get());
+
+  input->Resize(2, 3);
+  input->mutable_data<float>();
+  EXPECT_TRUE(op->InputShapesChanged());
+  EXPECT_FALSE(op->InputShapesChanged());
+  // Same number of elements in another shape
+  input->Resize(3, 2);
+  EXPECT_TRUE(op->InputShapesChanged());
+  EXPECT_FALSE(op->InputShapesChanged());
+  input->mutable_data<int>();
+  EXPECT_TRUE(op->InputShapesChanged());
+  input->Resize(3, 2, 1);
+  EXPECT_TRUE(op->InputShapesChanged());
+  ws.GetBlob("other")->GetMutable<float>();
+  EXPECT_TRUE(op->InputShapesChanged());
+  EXPECT_FALSE(op->InputShapesChanged());
+  EXPECT_EQ(op->input_shape_cache_hits(), 3);
+  EXPECT_EQ(op->input_shape_cache_misses(), 5);
+}
+
 TEST(OperatorTest, FallbackIfEngineDoesNotBuild) {
   OperatorDef op_def;
   Workspace ws;
@@ -1,12 +1,15 @@
 #include "caffe2/core/plan_executor.h"
 
 #include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include "caffe2/core/scope_guard.h"
+#include "caffe2/core/stats.h"
 #include "caffe2/core/timer.h"
 #include "caffe2/core/workspace.h"
 #include "caffe2/proto/caffe2_pb.h"
@@ -69,6 +72,59 @@ struct Reporter {
   bool done{false};
 };
 
+// Runs the workers of concurrent substeps. Threads are reused across
+// iterations and steps, and a thread is only started when all threads are
+// busy, since the workers of nested concurrent steps wait for their own
+// workers.
+class StepWorkerPool {
+ public:
+  static StepWorkerPool& get() {
+    // Leaked, since its threads never exit
+    static auto* pool = new StepWorkerPool();
+    return *pool;
+  }
+
+  void run(std::function<void()> task) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    tasks_.push_back(std::move(task));
+    if (idle_ >= tasks_.size()) {
+      cv_.notify_one();
+      return;
+    }
+    std::thread([this]() { workerLoop(); }).detach();
+  }
+
+ private:
+  void workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      ++idle_;
+      cv_.wait(lock, [this]() { return !tasks_.empty(); });
+      --idle_;
+      auto task = std::move(tasks_.front());
+      tasks_.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  size_t idle_{0};
+};
+
+struct ExecutionStepStats {
+  CAFFE_STAT_CTOR(ExecutionStepStats);
+  CAFFE_EXPORTED_STAT(num_iterations);
+  CAFFE_AVG_EXPORTED_STAT(iteration_time_ns);
+  // Time that the workers of concurrent substeps ran, and waited for the
+  // other workers of the same iteration to finish
+  CAFFE_EXPORTED_STAT(worker_busy_time_ns);
+  CAFFE_EXPORTED_STAT(worker_idle_time_ns);
+};
+
 // Returns a function that returns `true` if we should continue
 // iterating, given the current iteration count.
 std::function<bool(int64_t)> getContinuationTest(
@@ -243,7 +299,7 @@ struct CompiledExecutionStep {
       ShouldContinue externalShouldContinue,
       NetDefMap* netDefs,
       WorkspaceIdInjector* ws_id_injector)
-      : step(mainStep) {
+      : step(mainStep), stats("execution_step/" + mainStep->name()) {
     if (mainStep->create_workspace()) {
       localWorkspace_.reset(new Workspace(externalWorkspace));
       workspace = localWorkspace_.get();
@@ -332,6 +388,7 @@ struct CompiledExecutionStep {
   ShouldContinue netShouldContinue;
   ShouldContinue shouldContinue;
   std::atomic<bool> gotFailure{false};
+  ExecutionStepStats stats;
 
  private:
   std::unique_ptr<Workspace> localWorkspace_;
@@ -389,6 +446,14 @@ bool ExecuteStepRecursive(ExecutionStepWrapper& stepWrapper) {
         (!step.has_num_concurrent_instances() ||
          step.num_concurrent_instances() <= 1);
     for (int64_t iter = 0; compiledStep->shouldContinue(iter); ++iter) {
+      Timer iterationTimer;
+      auto recordIteration = MakeGuard([&]() {
+        CAFFE_EVENT(compiledStep->stats, num_iterations);
+        CAFFE_EVENT(
+            compiledStep->stats,
+            iteration_time_ns,
+            iterationTimer.NanoSeconds());
+      });
       if (sequential) {
         VLOG(1) << "Executing step " << step.name() << " iteration " << iter;
         for (auto& substepWrapper : compiledStep->recurringSubsteps) {
@@ -404,7 +469,11 @@ bool ExecuteStepRecursive(ExecutionStepWrapper& stepWrapper) {
         std::atomic<int> next_substep{0};
         std::mutex exception_mutex;
         string first_exception;
+        std::atomic<int64_t> busy_ns{0};
         auto worker = [&]() {
+          Timer workerTimer;
+          auto recordBusy = MakeGuard(
+              [&]() { busy_ns += int64_t(workerTimer.NanoSeconds()); });
           auto num_substeps = compiledStep->recurringSubsteps.size();
           int substep_id = next_substep++ % num_substeps;
           if (compiledStep->gotFailure) {
@@ -432,17 +501,35 @@ bool ExecuteStepRecursive(ExecutionStepWrapper& stepWrapper) {
           }
         };
 
-        std::vector<std::thread> threads;
         auto numThreads = compiledStep->recurringSubsteps.size();
         if (step.has_num_concurrent_instances()) {
           numThreads *= step.num_concurrent_instances();
         }
+        std::mutex done_mutex;
+        std::condition_variable done_cv;
+        size_t running = numThreads;
         for (size_t i = 0; i < numThreads; ++i) {
-          threads.emplace_back(worker);
+          StepWorkerPool::get().run([&]() {
+            auto done = MakeGuard([&]() {
+              std::lock_guard<std::mutex> guard(done_mutex);
+              if (--running == 0) {
+                done_cv.notify_all();
+              }
+            });
+            worker();
+          });
         }
-        for (auto& thread : threads) {
-          thread.join();
+        {
+          std::unique_lock<std::mutex> lock(done_mutex);
+          done_cv.wait(lock, [&]() { return running == 0; });
         }
+        const auto wall_ns = int64_t(iterationTimer.NanoSeconds());
+        CAFFE_EVENT(compiledStep->stats, worker_busy_time_ns, busy_ns.load());
+        CAFFE_EVENT(
+            compiledStep->stats,
+            worker_idle_time_ns,
+            std::max<int64_t>(
+                0, wall_ns * static_cast<int64_t>(numThreads) - busy_ns));
         if (compiledStep->gotFailure) {
           LOG(ERROR) << "One of the workers failed.";
           if (first_exception.size()) {
@@ -460,6 +547,14 @@ bool ExecuteStepRecursive(ExecutionStepWrapper& stepWrapper) {
   } else {
     // If this ExecutionStep just contains nets, we can directly run it.
     for (int64_t iter = 0; compiledStep->shouldContinue(iter); ++iter) {
+      Timer iterationTimer;
+      auto recordIteration = MakeGuard([&]() {
+        CAFFE_EVENT(compiledStep->stats, num_iterations);
+        CAFFE_EVENT(
+            compiledStep->stats,
+            iteration_time_ns,
+            iterationTimer.NanoSeconds());
+      });
       VLOG(1) << "Executing networks " << step.name() << " iteration " << iter;
       for (NetBase* network : compiledStep->networks) {
         if (!network->Run()) {
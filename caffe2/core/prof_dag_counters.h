@@ -63,6 +63,10 @@ class ProfDAGCounters {
   // formatted as a map: (netName__opIndex__opType, cost)
   ProfDAGProtos GetPerOperatorCost() const;
 
+  // Returns the mean execution time of each operator in milliseconds,
+  // or a negative value for operators that were not timed yet
+  std::vector<float> GetPerOperatorMeanTime() const;
+
   // ReportRunStart/End are called at the beginning and at the end of
   // each net's run
   void ReportRunStart();
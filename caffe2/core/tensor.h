@@ -228,6 +228,14 @@ class CAFFE2_API Tensor final {
     impl_.get()->ShareData(*src.impl_.get());
   }
 
+  /**
+   * Marks the tensor copy-on-write: its next mutable_data() call copies the
+   * data first if it is still shared with another tensor.
+   */
+  void set_copy_on_write(bool copy_on_write) const {
+    impl_.get()->set_copy_on_write(copy_on_write);
+  }
+
   /**
    * @brief Shares the data with an externally managed pointer.
    *
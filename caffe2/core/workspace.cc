@@ -121,6 +121,28 @@ Blob* Workspace::CreateLocalBlob(const string& name) {
   return GetBlob(name);
 }
 
+std::unique_ptr<Workspace> Workspace::Fork() {
+  std::unique_ptr<Workspace> fork(new Workspace(root_folder_, this));
+  for (const auto& entry : blob_map_) {
+    const Blob* blob = entry.second.get();
+    if (!blob->IsType<Tensor>()) {
+      continue;
+    }
+    const auto& tensor = blob->Get<Tensor>();
+    auto* forked = BlobGetMutableTensor(
+        fork->CreateLocalBlob(entry.first), tensor.GetDeviceType());
+    if (tensor.numel() < 0 || (tensor.numel() > 0 && !tensor.storage().data())) {
+      // nothing to share yet
+      continue;
+    }
+    forked->ResizeLike(tensor);
+    forked->ShareData(tensor);
+    forked->set_copy_on_write(true);
+    tensor.set_copy_on_write(true);
+  }
+  return fork;
+}
+
 Blob* Workspace::RenameBlob(const string& old_name, const string& new_name) {
   // We allow renaming only local blobs for API clarity purpose
   auto it = blob_map_.find(old_name);
@@ -156,6 +156,18 @@ class CAFFE2_API Workspace {
     }
   }
 
+  /**
+   * Creates a copy-on-write fork of this workspace, in O(number of blobs). The
+   * fork has a local blob for every local tensor blob of this workspace that
+   * shares the storage of the tensor here until either of the two tensors
+   * calls mutable_data(), which copies it first. All other blobs, like those of
+   * the parents of this workspace, are only visible through the fork, as with
+   * Workspace(this), so writes to them are visible here too. Since tensors of
+   * this workspace are marked copy-on-write as well, tensors that share
+   * storage on purpose stop sharing it on their first write after a fork.
+   */
+  std::unique_ptr<Workspace> Fork();
+
   /**
    * Return list of blobs owned by this Workspace, not including blobs
    * shared from parent workspace.
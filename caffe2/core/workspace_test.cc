@@ -1,6 +1,7 @@
 #include <iostream>
 
 #include "caffe2/core/operator.h"
+#include "caffe2/core/stats.h"
 #include <gtest/gtest.h>
 
 namespace caffe2 {
@@ -59,6 +60,33 @@ TEST(WorkspaceTest, RunEmptyPlan) {
   EXPECT_TRUE(ws.RunPlan(plan_def));
 }
 
+TEST(WorkspaceTest, RunPlanWithNestedConcurrentSteps) {
+  PlanDef plan_def;
+  auto* net_def = plan_def.add_network();
+  net_def->set_name("empty");
+  auto* outer = plan_def.add_execution_step();
+  outer->set_name("workspace_test_outer");
+  outer->set_concurrent_substeps(true);
+  outer->set_num_iter(3);
+  for (int i = 0; i < 2; ++i) {
+    auto* inner = outer->add_substep();
+    inner->set_concurrent_substeps(true);
+    inner->set_num_concurrent_instances(4);
+    for (int j = 0; j < 2; ++j) {
+      auto* leaf = inner->add_substep();
+      leaf->add_network("empty");
+      leaf->set_num_iter(5);
+    }
+  }
+  Workspace ws;
+  EXPECT_TRUE(ws.RunPlan(plan_def));
+  EXPECT_TRUE(ws.RunPlan(plan_def));
+
+  auto stats = toMap(StatRegistry::get().publish());
+  EXPECT_EQ(stats["execution_step/workspace_test_outer/num_iterations"], 6);
+  EXPECT_GT(stats["execution_step/workspace_test_outer/worker_busy_time_ns"], 0);
+}
+
 TEST(WorkspaceTest, Sharing) {
   Workspace parent;
   EXPECT_FALSE(parent.HasBlob("a"));
@@ -114,6 +142,32 @@ TEST(WorkspaceTest, BlobMapping) {
   }
 }
 
+TEST(WorkspaceTest, Fork) {
+  Workspace parent;
+  auto* a = BlobGetMutableTensor(parent.CreateBlob("a"), CPU);
+  a->Resize(4);
+  std::fill(a->mutable_data<float>(), a->mutable_data<float>() + 4, 1.0f);
+  parent.CreateBlob("foo")->GetMutable<WorkspaceTestFoo>();
+
+  auto fork = parent.Fork();
+  // Non-tensor blobs are shared
+  EXPECT_EQ(fork->GetBlob("foo"), parent.GetBlob("foo"));
+  // Tensor blobs share storage until the first write
+  auto* forked_a = BlobGetMutableTensor(fork->GetBlob("a"), CPU);
+  EXPECT_NE(forked_a, a);
+  EXPECT_EQ(forked_a->data<float>(), a->data<float>());
+  forked_a->mutable_data<float>()[0] = 2.0f;
+  EXPECT_NE(forked_a->data<float>(), a->data<float>());
+  EXPECT_EQ(forked_a->data<float>()[0], 2.0f);
+  EXPECT_EQ(forked_a->data<float>()[3], 1.0f);
+  EXPECT_EQ(a->data<float>()[0], 1.0f);
+  // The parent no longer shares its storage, so it writes in place
+  const float* data = a->data<float>();
+  a->mutable_data<float>()[1] = 3.0f;
+  EXPECT_EQ(a->data<float>(), data);
+  EXPECT_EQ(forked_a->data<float>()[1], 1.0f);
+}
+
 /**
  * Checks that Workspace::ForEach(f) applies f on  the specified set of
  * workspaces in any order.
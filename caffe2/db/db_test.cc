@@ -86,6 +86,72 @@ TEST(DBSeekTest, LMDB) {
   DBSeekTestWrapper("lmdb");
 }
 
+static void DBNextBatchTestWrapper(const string& db_type) {
+  std::string name = std::tmpnam(nullptr);
+  if (!CreateAndFill(db_type, name)) {
+    EXPECT_TRUE(0);
+    return;
+  }
+  std::unique_ptr<DB> db(CreateDB(db_type, name, READ));
+  std::unique_ptr<Cursor> cursor(db->NewCursor());
+  cursor->SeekToFirst();
+  std::vector<Record> records;
+  // Batches of 4 cover the db in 4, 4 and 2 records.
+  for (int batch = 0; batch < 3; ++batch) {
+    const size_t expected = batch < 2 ? 4 : 2;
+    ASSERT_EQ(cursor->NextBatch(4, &records), expected);
+    ASSERT_EQ(records.size(), expected);
+    for (size_t i = 0; i < expected; ++i) {
+      std::stringstream ss;
+      ss << std::setw(2) << std::setfill('0') << batch * 4 + i;
+      EXPECT_EQ(records[i].key.ToString(), ss.str());
+      EXPECT_EQ(records[i].value.ToString(), ss.str());
+    }
+  }
+  EXPECT_FALSE(cursor->Valid());
+  EXPECT_EQ(cursor->NextBatch(4, &records), 0);
+
+  // The cursor moves past the batch, even when the next batch was read ahead.
+  cursor->SeekToFirst();
+  ASSERT_EQ(cursor->NextBatch(3, &records), 3);
+  EXPECT_EQ(cursor->key(), "03");
+  ASSERT_EQ(cursor->NextBatch(3, &records), 3);
+  EXPECT_EQ(records[0].key.ToString(), "03");
+}
+
+TEST(DBNextBatchTest, LevelDB) {
+  DBNextBatchTestWrapper("leveldb");
+}
+
+TEST(DBNextBatchTest, LMDB) {
+  DBNextBatchTestWrapper("lmdb");
+}
+
+TEST(DBNextBatchTest, MiniDB) {
+  DBNextBatchTestWrapper("minidb");
+}
+
+TEST(DBReaderTest, ReadBatch) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("leveldb", name);
+  DBReader reader("leveldb", name);
+  vector<string> values;
+  // Reading past the end goes back to the head of the db.
+  reader.ReadBatch(7, &values);
+  ASSERT_EQ(values.size(), 7);
+  EXPECT_EQ(values[0], "00");
+  EXPECT_EQ(values[6], "06");
+  reader.ReadBatch(7, &values);
+  EXPECT_EQ(values[0], "07");
+  EXPECT_EQ(values[2], "09");
+  EXPECT_EQ(values[3], "00");
+  EXPECT_EQ(values[6], "03");
+  string key;
+  string value;
+  reader.Read(&key, &value);
+  EXPECT_EQ(key, "04");
+}
+
 TEST(DBReaderTest, Reader) {
   std::string name = std::tmpnam(nullptr);
   CreateAndFill("leveldb", name);
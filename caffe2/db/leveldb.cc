@@ -1,3 +1,6 @@
+#include <future>
+#include <vector>
+
 #include "caffe2/core/db.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/core/flags.h"
@@ -8,6 +11,11 @@ C10_DEFINE_int(
     caffe2_leveldb_block_size,
     65536,
     "The caffe2 leveldb block size when writing a leveldb.");
+C10_DEFINE_bool(
+    caffe2_leveldb_readahead,
+    true,
+    "If set, a leveldb cursor reads the next batch of records on a "
+    "background thread while the current batch of NextBatch() is used.");
 
 namespace caffe2 {
 namespace db {
@@ -18,17 +26,88 @@ class LevelDBCursor : public Cursor {
       : iter_(db->NewIterator(leveldb::ReadOptions())) {
     SeekToFirst();
   }
-  ~LevelDBCursor() {}
-  void Seek(const string& key) override { iter_->Seek(key); }
+  ~LevelDBCursor() {
+    CancelReadahead();
+  }
+  void Seek(const string& key) override {
+    CancelReadahead();
+    iter_->Seek(key);
+  }
   bool SupportsSeek() override { return true; }
-  void SeekToFirst() override { iter_->SeekToFirst(); }
-  void Next() override { iter_->Next(); }
-  string key() override { return iter_->key().ToString(); }
-  string value() override { return iter_->value().ToString(); }
-  bool Valid() override { return iter_->Valid(); }
+  void SeekToFirst() override {
+    CancelReadahead();
+    iter_->SeekToFirst();
+  }
+  void Next() override {
+    CancelReadahead();
+    iter_->Next();
+  }
+  string key() override {
+    CancelReadahead();
+    return iter_->key().ToString();
+  }
+  string value() override {
+    CancelReadahead();
+    return iter_->value().ToString();
+  }
+  bool Valid() override {
+    CancelReadahead();
+    return iter_->Valid();
+  }
+
+  // The iterator's slices are only valid until it moves, so the records are
+  // copied into a buffer. With readahead, the next batch of the same size is
+  // then read into a second buffer on a background thread.
+  size_t NextBatch(size_t n, std::vector<Record>* records) override {
+    if (readahead_size_ != n) {
+      CancelReadahead();
+    }
+    if (readahead_.valid()) {
+      readahead_.get();
+    } else {
+      ReadBatch(n, &next_batch_);
+    }
+    readahead_size_ = 0;
+    std::swap(batch_buffer_, next_batch_);
+    batch_buffer_.GetRecords(records);
+    if (FLAGS_caffe2_leveldb_readahead && iter_->Valid()) {
+      readahead_size_ = n;
+      readahead_ = std::async(
+          std::launch::async, [this, n]() { ReadBatch(n, &next_batch_); });
+    }
+    return records->size();
+  }
 
  private:
+  void ReadBatch(size_t n, RecordBuffer* buffer) {
+    buffer->Clear();
+    for (size_t i = 0; i < n && iter_->Valid(); ++i) {
+      const leveldb::Slice key = iter_->key();
+      const leveldb::Slice value = iter_->value();
+      buffer->Add(key.data(), key.size(), value.data(), value.size());
+      iter_->Next();
+    }
+  }
+
+  // Waits for the readahead and moves the iterator back to the first record
+  // that was read ahead, which is where the caller expects the cursor to be.
+  void CancelReadahead() {
+    if (!readahead_.valid()) {
+      return;
+    }
+    readahead_.get();
+    if (next_batch_.size() > 0) {
+      const StringView key = next_batch_.record(0).key;
+      iter_->Seek(leveldb::Slice(key.data, key.size));
+    }
+    readahead_size_ = 0;
+  }
+
   std::unique_ptr<leveldb::Iterator> iter_;
+  RecordBuffer next_batch_;
+  // Number of records requested from the pending readahead, if any
+  size_t readahead_size_ = 0;
+  std::future<void> readahead_;
 };
 
 class LevelDBTransaction : public Transaction {
@@ -7,6 +7,7 @@
 #include <sys/stat.h>
 
 #include <string>
+#include <vector>
 
 #include "caffe2/core/db.h"
 #include "caffe2/core/logging.h"
@@ -70,6 +71,21 @@ class LMDBCursor : public Cursor {
 
   bool Valid() override { return valid_; }
 
+  // Keys and values of a read-only transaction point into the memory map and
+  // stay valid until the transaction ends, so the records are not copied.
+  size_t NextBatch(size_t n, std::vector<Record>* records) override {
+    records->clear();
+    for (size_t i = 0; i < n && valid_; ++i) {
+      records->push_back(Record{
+          StringView{static_cast<const char*>(mdb_key_.mv_data),
+                     mdb_key_.mv_size},
+          StringView{static_cast<const char*>(mdb_value_.mv_data),
+                     mdb_value_.mv_size}});
+      Next();
+    }
+    return records->size();
+  }
+
  private:
   void SeekLMDB(MDB_cursor_op op) {
     int mdb_status = mdb_cursor_get(mdb_cursor_, &mdb_key_, &mdb_value_, op);
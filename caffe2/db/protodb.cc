@@ -1,4 +1,5 @@
 #include <unordered_set>
+#include <vector>
 
 #include "caffe2/core/db.h"
 #include "caffe2/utils/proto_utils.h"
@@ -23,9 +24,27 @@ class ProtoDBCursor : public Cursor {
   string value() override { return proto_->protos(iter_).SerializeAsString(); }
   bool Valid() override { return iter_ < proto_->protos_size(); }
 
+  // Keys are the names in the proto. Values are serialized into strings owned
+  // by the cursor, whose capacity is reused across batches.
+  size_t NextBatch(size_t n, std::vector<Record>* records) override {
+    records->clear();
+    if (values_.size() < n) {
+      values_.resize(n);
+    }
+    for (size_t i = 0; i < n && Valid(); ++i, ++iter_) {
+      const TensorProto& proto = proto_->protos(iter_);
+      proto.SerializeToString(&values_[i]);
+      records->push_back(Record{
+          StringView{proto.name().data(), proto.name().size()},
+          StringView{values_[i].data(), values_[i].size()}});
+    }
+    return records->size();
+  }
+
  private:
   const TensorProtos* proto_;
   int iter_;
+  std::vector<string> values_;
 };
 
 class ProtoDBTransaction : public Transaction {
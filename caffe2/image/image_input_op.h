@@ -81,11 +81,13 @@ class ImageInputOp final
       const std::string& value, float *image_data, int item_id,
       const int channels, std::size_t thread_index);
   void DecodeAndTransposeOnly(
-      const std::string& value, uint8_t *image_data, int item_id,
-      const int channels, std::size_t thread_index);
+      const std::string& value, uint8_t *image_data, float *color_params,
+      int item_id, const int channels, std::size_t thread_index);
 
   unique_ptr<db::DBReader> owned_reader_;
   const db::DBReader* reader_;
+  // Values of the batch being decoded, reused across prefetches
+  vector<std::string> batch_values_;
   CPUContext cpu_context_;
   Tensor prefetched_image_{CPU};
   Tensor prefetched_label_{CPU};
@@ -93,6 +95,9 @@ class ImageInputOp final
   Tensor prefetched_image_on_device_{Context::GetDeviceType()};
   Tensor prefetched_label_on_device_{Context::GetDeviceType()};
   vector<Tensor> prefetched_additional_outputs_on_device_;
+  // Per image color augmentation params of the GPU transform
+  Tensor prefetched_color_params_{CPU};
+  Tensor prefetched_color_params_on_device_{Context::GetDeviceType()};
   // Default parameters for images
   PerImageArg default_arg_;
   int batch_size_;
@@ -124,6 +129,8 @@ class ImageInputOp final
   bool is_test_;
   bool use_caffe_datum_;
   bool gpu_transform_;
+  // Whether the GPU transform applies color jitter or color lighting
+  bool gpu_color_augmentation_;
   bool mean_std_copied_ = false;
 
   // thread pool for parse + decode
@@ -307,6 +314,9 @@ ImageInputOp<Context>::ImageInputOp(
     default_arg_.bounding_params.valid = true;
   }
 
+  gpu_color_augmentation_ = gpu_transform_ && color_ && !is_test_ &&
+      (color_jitter_ || color_lighting_);
+
   if (mean_.size() == 1) {
     // We are going to extend to 3 using the first value
     mean_.resize(3, mean_[0]);
@@ -317,6 +327,9 @@ ImageInputOp<Context>::ImageInputOp(
   LOG(INFO) << "    Using " << num_decode_threads_ << " CPU threads;";
   if (gpu_transform_) {
     LOG(INFO) << "    Performing transformation on GPU";
+    if (gpu_color_augmentation_) {
+      LOG(INFO) << "    Performing color augmentation on GPU";
+    }
   }
   LOG(INFO) << "    Outputting in batches of " << batch_size_ << " images;";
   LOG(INFO) << "    Treating input image as "
@@ -376,6 +389,10 @@ ImageInputOp<Context>::ImageInputOp(
       int64_t(crop_),
       int64_t(crop_),
       int64_t(color_ ? 3 : 1));
+  if (gpu_color_augmentation_) {
+    prefetched_color_params_.Resize(
+        int64_t(batch_size_), int64_t(kColorAugmentationParams));
+  }
   if (label_type_ != SINGLE_LABEL && label_type_ != SINGLE_LABEL_WEIGHTED) {
     prefetched_label_.Resize(int64_t(batch_size_), int64_t(num_labels_));
   } else {
@@ -1007,6 +1024,51 @@ void TransformImage(
   ColorNormalization<Context>(image_data, crop, channels, mean, std);
 }
 
+// Draws the color jitter and color lighting of an image for the GPU
+// transform, see kColorAugmentationParams. The alphas of disabled jitters are
+// 1 and the lighting shift is 0 when color lighting is disabled.
+template <class Context>
+void RandomColorAugmentationParams(
+    float* params,
+    const bool color_jitter,
+    const float saturation,
+    const float brightness,
+    const float contrast,
+    const bool color_lighting,
+    const float color_lighting_std,
+    const std::vector<std::vector<float>>& color_lighting_eigvecs,
+    const std::vector<float>& color_lighting_eigvals,
+    std::mt19937* randgen) {
+  std::vector<int> jitter_order{0, 1, 2};
+  std::fill(params + 3, params + kColorAugmentationParams, 0.0f);
+  if (color_jitter) {
+    std::shuffle(jitter_order.begin(), jitter_order.end(), *randgen);
+    const float alpha_rands[3] = {saturation, brightness, contrast};
+    for (int i = 0; i < 3; ++i) {
+      params[3 + i] = 1.0f +
+          std::uniform_real_distribution<float>(
+              -alpha_rands[i], alpha_rands[i])(*randgen);
+    }
+  } else {
+    std::fill(params + 3, params + 6, 1.0f);
+  }
+  std::copy(jitter_order.begin(), jitter_order.end(), params);
+  if (color_lighting) {
+    std::normal_distribution<float> d(0, color_lighting_std);
+    float alphas[3];
+    for (int i = 0; i < 3; ++i) {
+      alphas[i] = d(*randgen);
+    }
+    // delta_rgb of ColorLighting, in BGR order
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        params[8 - i] += color_lighting_eigvecs[i][j] *
+            color_lighting_eigvals[j] * alphas[j];
+      }
+    }
+  }
+}
+
 // Only crop / transose the image
 // leave in uint8_t dataType
 template <class Context>
@@ -1082,8 +1144,8 @@ void ImageInputOp<Context>::DecodeAndTransform(
 
 template <class Context>
 void ImageInputOp<Context>::DecodeAndTransposeOnly(
-    const std::string& value, uint8_t *image_data, int item_id,
-    const int channels, std::size_t thread_index) {
+    const std::string& value, uint8_t *image_data, float *color_params,
+    int item_id, const int channels, std::size_t thread_index) {
 
   CAFFE_ENFORCE((int)thread_index < num_decode_threads_);
 
@@ -1099,6 +1161,12 @@ void ImageInputOp<Context>::DecodeAndTransposeOnly(
   // Factor out the image transformation
   CropTransposeImage<Context>(img, channels, image_data, crop_, mirror_,
                               randgen, &mirror_this_image, is_test_);
+  if (color_params) {
+    RandomColorAugmentationParams<Context>(color_params,
+      color_jitter_, img_saturation_, img_brightness_, img_contrast_,
+      color_lighting_, color_lighting_std_, color_lighting_eigvecs_,
+      color_lighting_eigvals_, randgen);
+  }
 }
 
 
@@ -1115,6 +1183,9 @@ bool ImageInputOp<Context>::Prefetch() {
   if (gpu_transform_) {
     // we'll transfer up in int8, then convert later
     prefetched_image_.mutable_data<uint8_t>();
+    if (gpu_color_augmentation_) {
+      prefetched_color_params_.mutable_data<float>();
+    }
   } else {
     prefetched_image_.mutable_data<float>();
   }
@@ -1122,12 +1193,11 @@ bool ImageInputOp<Context>::Prefetch() {
   prefetched_label_.mutable_data<int>();
   // Prefetching handled with a thread pool of "decode_threads" threads.
 
-  for (int item_id = 0; item_id < batch_size_; ++item_id) {
-    std::string key, value;
-    cv::Mat img;
+  // read data
+  reader_->ReadBatch(batch_size_, &batch_values_);
 
-    // read data
-    reader_->Read(&key, &value);
+  for (int item_id = 0; item_id < batch_size_; ++item_id) {
+    const std::string& value = batch_values_[item_id];
 
     // determine label type based on first item
     if( item_id == 0 ) {
@@ -1168,16 +1238,21 @@ bool ImageInputOp<Context>::Prefetch() {
     }
 
     // launch into thread pool for processing
-    // TODO: support color jitter and color lighting in gpu_transform
     if (gpu_transform_) {
       // output of decode will still be int8
       uint8_t* image_data = prefetched_image_.mutable_data<uint8_t>() +
           crop_ * crop_ * channels * item_id;
+      // the color augmentation is drawn here and applied on the GPU
+      float* color_params = gpu_color_augmentation_
+          ? prefetched_color_params_.mutable_data<float>() +
+              kColorAugmentationParams * item_id
+          : nullptr;
       thread_pool_->runTaskWithID(std::bind(
           &ImageInputOp<Context>::DecodeAndTransposeOnly,
           this,
-          std::string(value),
+          std::cref(value),
           image_data,
+          color_params,
           item_id,
           channels,
           std::placeholders::_1));
@@ -1187,7 +1262,7 @@ bool ImageInputOp<Context>::Prefetch() {
       thread_pool_->runTaskWithID(std::bind(
           &ImageInputOp<Context>::DecodeAndTransform,
           this,
-          std::string(value),
+          std::cref(value),
           image_data,
           item_id,
           channels,
@@ -1210,6 +1285,10 @@ bool ImageInputOp<Context>::Prefetch() {
   if (!std::is_same<Context, CPUContext>::value) {
     prefetched_image_on_device_.CopyFrom(prefetched_image_, &cpu_context_);
     prefetched_label_on_device_.CopyFrom(prefetched_label_, &cpu_context_);
+    if (gpu_color_augmentation_) {
+      prefetched_color_params_on_device_.CopyFrom(
+          prefetched_color_params_, &cpu_context_);
+    }
 
     for (int i = 0; i < prefetched_additional_outputs_on_device_.size(); ++i) {
       prefetched_additional_outputs_on_device_[i].CopyFrom(
@@ -1244,7 +1323,6 @@ bool ImageInputOp<Context>::CopyPrefetched() {
           prefetched_additional_outputs_[i], &context_);
     }
   } else {
-    // TODO: support color jitter and color lighting in gpu_transform
     if (gpu_transform_) {
       if (!mean_std_copied_) {
         mean_gpu_.Resize(mean_.size());
@@ -1258,15 +1336,20 @@ bool ImageInputOp<Context>::CopyPrefetched() {
             std_.size(), std_.data(), std_gpu_.template mutable_data<float>());
         mean_std_copied_ = true;
       }
+      const Tensor* color_params = gpu_color_augmentation_
+          ? &prefetched_color_params_on_device_
+          : nullptr;
       // GPU transform kernel allows explicitly setting output type
       if (output_type_ == TensorProto_DataType_FLOAT) {
         TransformOnGPU<uint8_t,float,Context>(prefetched_image_on_device_,
                                               image_output, mean_gpu_,
-                                              std_gpu_, &context_);
+                                              std_gpu_, color_params,
+                                              &context_);
       } else if (output_type_ == TensorProto_DataType_FLOAT16) {
         TransformOnGPU<uint8_t,at::Half,Context>(prefetched_image_on_device_,
                                                 image_output, mean_gpu_,
-                                                std_gpu_, &context_);
+                                                std_gpu_, color_params,
+                                                &context_);
       }  else {
         return false;
       }
@@ -1,3 +1,4 @@
+#include <cub/block/block_reduce.cuh>
 #include "caffe2/core/context_gpu.h"
 #include "caffe2/image/transform_gpu.h"
 #include "caffe2/utils/conversions.h"
@@ -13,6 +14,72 @@ namespace caffe2 {
 
 namespace {
 
+// BGR to gray scale weights: R -> 0.299, G -> 0.587, B -> 0.114
+__constant__ float kGrayWeights[3] = {0.114f, 0.587f, 0.299f};
+
+// Composes the color jitter and color lighting of an image, which are all
+// affine in the pixel values, into out = A * in + b. A is stored row major
+// in affine[0..8] and b in affine[9..11]. See ColorJitter and ColorLighting
+// in image_input_op.h for the CPU version.
+__device__ void compose_color_augmentation(
+    const float* params,
+    const float* mean_pixel,
+    float* affine) {
+  float* A = affine;
+  float* b = affine + 9;
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      A[i * 3 + j] = i == j ? 1.0f : 0.0f;
+    }
+    b[i] = 0.0f;
+  }
+  for (int k = 0; k < 3; ++k) {
+    const int op = static_cast<int>(params[k]);
+    const float alpha = params[3 + op];
+    if (op == 0) {
+      // saturation: alpha * x + (1 - alpha) * gray(x)
+      float gray_A[3];
+      float gray_b = 0.0f;
+      for (int j = 0; j < 3; ++j) {
+        gray_A[j] = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+          gray_A[j] += kGrayWeights[i] * A[i * 3 + j];
+        }
+        gray_b += kGrayWeights[j] * b[j];
+      }
+      for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+          A[i * 3 + j] = alpha * A[i * 3 + j] + (1.0f - alpha) * gray_A[j];
+        }
+        b[i] = alpha * b[i] + (1.0f - alpha) * gray_b;
+      }
+    } else {
+      // brightness: alpha * x, contrast: alpha * x + (1 - alpha) * gray mean
+      float shift = 0.0f;
+      if (op == 2 && alpha != 1.0f) {
+        for (int i = 0; i < 3; ++i) {
+          float value = b[i];
+          for (int j = 0; j < 3; ++j) {
+            value += A[i * 3 + j] * mean_pixel[j];
+          }
+          shift += kGrayWeights[i] * value;
+        }
+        shift *= 1.0f - alpha;
+      }
+      for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+          A[i * 3 + j] *= alpha;
+        }
+        b[i] = alpha * b[i] + shift;
+      }
+    }
+  }
+  // color lighting
+  for (int i = 0; i < 3; ++i) {
+    b[i] += params[6 + i];
+  }
+}
+
 // input in (int8, NHWC), output in (fp32, NCHW)
 template <typename In, typename Out>
 __global__ void transform_kernel(
@@ -46,6 +113,71 @@ __global__ void transform_kernel(
   }
 }
 
+// Same as transform_kernel for 3 channel images, but applies the color
+// augmentation described by kColorAugmentationParams params per image
+// before the normalization.
+template <typename In, typename Out>
+__global__ void color_augmentation_transform_kernel(
+    const int N,
+    const int H,
+    const int W,
+    const float* mean,
+    const float* std,
+    const float* color_params,
+    const In* in,
+    Out* out) {
+  typedef cub::BlockReduce<float, kTransformBlockDim,
+                           cub::BLOCK_REDUCE_WARP_REDUCTIONS,
+                           kTransformBlockDim> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  __shared__ float mean_pixel[3];
+  __shared__ float affine[12];
+
+  const int n = blockIdx.x;
+  const int nStride = 3*H*W;
+  const In* input_ptr = &in[n*nStride];
+  Out* output_ptr = &out[n*nStride];
+  const float* params = &color_params[n*kColorAugmentationParams];
+
+  // the contrast jitter needs the mean pixel of the image
+  if (params[5] != 1.0f) {
+    for (int c = 0; c < 3; ++c) {
+      float sum = 0.0f;
+      for (int h = threadIdx.y; h < H; h += blockDim.y) {
+        for (int w = threadIdx.x; w < W; w += blockDim.x) {
+          sum += convert::To<In,float>(input_ptr[c + 3*w + 3*W*h]);
+        }
+      }
+      sum = BlockReduce(temp_storage).Sum(sum);
+      if (threadIdx.x == 0 && threadIdx.y == 0) {
+        mean_pixel[c] = sum / (H * W);
+      }
+      __syncthreads();
+    }
+  }
+  if (threadIdx.x == 0 && threadIdx.y == 0) {
+    compose_color_augmentation(params, mean_pixel, affine);
+  }
+  __syncthreads();
+
+  for (int h=threadIdx.y; h < H; h += blockDim.y) {
+    for (int w=threadIdx.x; w < W; w += blockDim.x) {
+      const In* x = &input_ptr[3*w + 3*W*h];  // HWC
+      float values[3];
+      for (int c = 0; c < 3; ++c) {
+        values[c] = convert::To<In,float>(x[c]);
+      }
+      for (int c = 0; c < 3; ++c) {
+        const float value = affine[c*3] * values[0] +
+            affine[c*3 + 1] * values[1] + affine[c*3 + 2] * values[2] +
+            affine[9 + c];
+        output_ptr[c*H*W + h*W + w] =  // CHW
+            convert::To<float,Out>((value - mean[c]) * std[c]);
+      }
+    }
+  }
+}
+
 }
 
 template <typename T_IN, typename T_OUT, class Context>
@@ -55,6 +187,7 @@ bool TransformOnGPU(
     Tensor* Y,
     Tensor& mean,
     Tensor& std,
+    const Tensor* color_params,
     Context* context) {
   // data comes in as NHWC
   const int N = X.dim32(0), C = X.dim32(3), H = X.dim32(1), W = X.dim32(2);
@@ -64,10 +197,18 @@ bool TransformOnGPU(
   auto* input_data = X.template data<T_IN>();
   auto* output_data = Y->template mutable_data<T_OUT>();
 
-  transform_kernel<
-    T_IN, T_OUT><<<N, dim3(16, 16), 0, context->cuda_stream()>>>(
-      N, C, H, W, mean.template data<float>(), std.template data<float>(),
-      input_data, output_data);
+  const dim3 block(kTransformBlockDim, kTransformBlockDim);
+  if (color_params != nullptr && C == 3) {
+    color_augmentation_transform_kernel<
+      T_IN, T_OUT><<<N, block, 0, context->cuda_stream()>>>(
+        N, H, W, mean.template data<float>(), std.template data<float>(),
+        color_params->template data<float>(), input_data, output_data);
+  } else {
+    transform_kernel<
+      T_IN, T_OUT><<<N, block, 0, context->cuda_stream()>>>(
+        N, C, H, W, mean.template data<float>(), std.template data<float>(),
+        input_data, output_data);
+  }
   return true;
 };
 
@@ -76,6 +217,7 @@ template bool TransformOnGPU<uint8_t, float, CUDAContext>(
     Tensor* Y,
     Tensor& mean,
     Tensor& std,
+    const Tensor* color_params,
     CUDAContext* context);
 
 template bool TransformOnGPU<uint8_t, at::Half, CUDAContext>(
@@ -83,6 +225,7 @@ template bool TransformOnGPU<uint8_t, at::Half, CUDAContext>(
     Tensor* Y,
     Tensor& mean,
     Tensor& std,
+    const Tensor* color_params,
     CUDAContext* context);
 
 }  // namespace caffe2
@@ -30,12 +30,23 @@
 
 namespace caffe2 {
 
+// Threads per block dimension of the transform kernels
+constexpr int kTransformBlockDim = 16;
+
+// Per image color augmentation params of TransformOnGPU: the order of the
+// saturation (0), brightness (1) and contrast (2) jitters, the alpha of each
+// jitter, and the color lighting shift of each (BGR) channel.
+constexpr int kColorAugmentationParams = 9;
+
+// Converts uint8 NHWC images to normalized NCHW images. If color_params is
+// not null, the images are also color augmented (3 channel images only).
 template <typename T_IN, typename T_OUT, class Context>
 bool TransformOnGPU(
     Tensor& X,
     Tensor* Y,
     Tensor& mean,
     Tensor& std,
+    const Tensor* color_params,
     Context* context);
 
 }  // namespace caffe2
@@ -1,5 +1,6 @@
 
 #include "AndroidGLContext.h"
+#include "../core/GLTexturePool.h"
 
 std::unique_ptr<GLContext> GLContext::_glcontext = nullptr;
 
@@ -16,4 +17,7 @@ GLContext* GLContext::getGLContext() {
   return _glcontext.get();
 }
 
-void GLContext::deleteGLContext() { _glcontext.reset(nullptr); }
+void GLContext::deleteGLContext() {
+  GLTexturePool::getGLTexturePool().clear();
+  _glcontext.reset(nullptr);
+}
@@ -1,6 +1,22 @@
 
 #include "GLFilter.h"
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
+
+namespace {
+
+// Linked programs by vertex and fragment shaders and attribute locations,
+// with the number of filters using them
+struct SharedProgram {
+  GLuint program;
+  int users;
+};
+
+std::mutex shared_programs_mutex;
+std::unordered_map<std::string, SharedProgram> shared_programs;
+
+} // namespace
 
 GLFilter::GLFilter(const std::string _kernel_name,
                    const std::string _vertex_shader,
@@ -13,11 +29,20 @@ GLFilter::GLFilter(const std::string _kernel_name,
       uniforms_(uniforms),
       uniform_blocks_(uniform_blocks),
       attributes_(attributes) {
-  // shader program
-  if (createProgram(_vertex_shader.c_str(),
-                    process_replacements(_fragment_shader, _replacements).c_str(),
-                    &program)) {
+  // shader program, shared with the other filters built from the same shaders
+  const std::string fragment_shader =
+      process_replacements(_fragment_shader, _replacements);
+  program_key = _vertex_shader + '\0' + fragment_shader;
+  for (auto&& attribute : attributes_) {
+    program_key += '\0' + attribute->name + '@' +
+                   caffe2::to_string(attribute->location);
+  }
+  if (acquireSharedProgram()) {
+    gl_log(GL_VERBOSE, "reusing program %d\n", program);
+  } else if (createProgram(
+                 _vertex_shader.c_str(), fragment_shader.c_str(), &program)) {
     gl_log(GL_VERBOSE, "created program %d\n", program);
+    addSharedProgram();
   } else {
     releaseBuffers();
 
@@ -261,10 +286,14 @@ void GLFilter::run(const std::vector<texture_attachment>& input,
     });
   }
 
-  // Validate program
-  if (check_opengl_errors && !validateProgram(program)) {
-    throwRuntimeError(
-        [&](std::stringstream& errmsg) { errmsg << "Couldn't validate OpenGL program"; });
+  // Validate program on the first run only, validation stalls the pipeline
+  if (check_opengl_errors && !program_validated) {
+    if (!validateProgram(program)) {
+      throwRuntimeError([&](std::stringstream& errmsg) {
+        errmsg << "Couldn't validate OpenGL program";
+      });
+    }
+    program_validated = true;
   }
 
   glViewport(0, 0, width, height);
@@ -383,12 +412,48 @@ void GLFilter::releaseBuffers() {
 
 void GLFilter::deleteProgram() {
   if (program) {
+    std::unique_lock<std::mutex> lock(shared_programs_mutex);
+    auto it = shared_programs.find(program_key);
+    if (it != shared_programs.end() && it->second.program == program) {
+      if (--it->second.users > 0) {
+        program = 0;
+        return;
+      }
+      shared_programs.erase(it);
+    }
+    lock.unlock();
+
     gl_log(GL_VERBOSE, "deleting program %d\n", program);
     glDeleteProgram(program);
     program = 0;
   }
 }
 
+bool GLFilter::acquireSharedProgram() {
+  {
+    std::lock_guard<std::mutex> lock(shared_programs_mutex);
+    auto it = shared_programs.find(program_key);
+    if (it == shared_programs.end()) {
+      return false;
+    }
+    program = it->second.program;
+    it->second.users++;
+  }
+  resolveLocations(program);
+  return true;
+}
+
+void GLFilter::addSharedProgram() {
+  std::lock_guard<std::mutex> lock(shared_programs_mutex);
+  auto inserted =
+      shared_programs.emplace(program_key, SharedProgram{program, 1});
+  if (!inserted.second) {
+    // Another filter linked the same shaders concurrently, this one keeps its
+    // program to itself
+    program_key.clear();
+  }
+}
+
 void GLFilter::deleteBindings() {
   for (binding* uniform : uniforms_) {
     delete uniform;
@@ -415,6 +480,29 @@ const char* GLFilter::vertex_shader = R"GLSL(#version 300 es
   }
 )GLSL";
 
+void GLFilter::resolveLocations(GLuint prog) const {
+  for (auto&& uniform : uniforms_) {
+    uniform->location = glGetUniformLocation(prog, uniform->name.c_str());
+
+    checkGLError([&](std::stringstream& errmsg) {
+      errmsg << "Couldn't resolve uniform: " << uniform->name;
+    });
+  }
+
+  for (auto&& uniform_block : uniform_blocks_) {
+    uniform_block->location =
+        glGetUniformBlockIndex(prog, uniform_block->name.c_str());
+    gl_log(GL_VERBOSE,
+           "Getting location for uniform block: %s, location: %d\n",
+           uniform_block->name.c_str(),
+           uniform_block->location);
+
+    checkGLError([&](std::stringstream& errmsg) {
+      errmsg << "Couldn't resolve uniform block: " << uniform_block->name;
+    });
+  }
+}
+
 bool GLFilter::createProgram(const GLchar* vertSource,
                              const GLchar* fragSource,
                              GLuint* program) const {
@@ -455,26 +543,7 @@ bool GLFilter::createProgram(const GLchar* vertSource,
 
   // Get locations of uniforms
   if (status) {
-    for (auto&& uniform : uniforms_) {
-      uniform->location = glGetUniformLocation(prog, uniform->name.c_str());
-
-      checkGLError([&](std::stringstream& errmsg) {
-        errmsg << "Couldn't resolve uniform: " << uniform->name;
-      });
-    }
-
-    for (auto&& uniform_block : uniform_blocks_) {
-      uniform_block->location = glGetUniformBlockIndex(prog, uniform_block->name.c_str());
-      gl_log(GL_VERBOSE,
-             "Getting location for uniform block: %s, location: %d\n",
-             uniform_block->name.c_str(),
-             uniform_block->location);
-
-      checkGLError([&](std::stringstream& errmsg) {
-        errmsg << "Couldn't resolve uniform block: " << uniform_block->name;
-      });
-    }
-
+    resolveLocations(prog);
     *program = prog;
   }
 
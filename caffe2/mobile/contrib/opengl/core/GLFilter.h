@@ -21,6 +21,7 @@ class GLFilter {
   GLuint uniformBlock[kMaxUniformBlocks] = {0};
   GLint blockSize[kMaxUniformBlocks]     = {0};
   bool frame_buffer_initialized = false;
+  bool program_validated = false;
 
   // glGetError() can be expensive, we should turn error checking off when we're done with debugging
 
@@ -96,7 +97,15 @@ public:
 
   std::string process_replacements(std::string source, const replacements_t& replacements) const;
 
+  // Shaders and attribute locations of the program, empty if the program
+  // isn't shared
+  std::string program_key;
+
+  bool acquireSharedProgram();
+  void addSharedProgram();
+
   bool createProgram(const GLchar* vertSource, const GLchar* fragSource, GLuint* program) const;
+  void resolveLocations(GLuint program) const;
 
   GLint compileShader(GLenum target, GLsizei count, const GLchar** sources, GLuint* shader) const;
   GLint linkProgram(GLuint program) const;
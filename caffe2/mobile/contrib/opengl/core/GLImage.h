@@ -2,6 +2,7 @@
 #pragma once
 
 #include "GLTexture.h"
+#include "GLTexturePool.h"
 #include "caffe2/core/logging.h"
 
 #include <functional>
@@ -93,7 +94,9 @@ class GLImage {
   virtual ~GLImage() {
     gl_log(GL_VERBOSE, "deleting GLImage\n");
     for (auto&& texture : textures) {
-      delete texture;
+      if (!GLTexturePool::getGLTexturePool().release(texture)) {
+        delete texture;
+      }
     }
   }
 };
@@ -11,7 +11,8 @@ GLImageVector<T>* GLImageAllocator<T>::newImage(
     images->push_back(
         new GLImage<T>(width, height, channels, tile_x, tile_y, [&](int slice) -> const GLTexture* {
           bool usePadding = is_output;
-          return new GLPlainTexture(type, nullptr, width * tile_x, height * tile_y, usePadding);
+          return GLTexturePool::getGLTexturePool().acquire(
+              type, width * tile_x, height * tile_y, usePadding);
         }));
   }
   return images;
@@ -0,0 +1,50 @@
+
+#include "GLTexturePool.h"
+#include "GLPlainTexture.h"
+
+GLTexturePool& GLTexturePool::getGLTexturePool() {
+  static GLTexturePool pool;
+  return pool;
+}
+
+const GLTexture* GLTexturePool::acquire(const GLTexture::Type& type,
+                                        int width,
+                                        int height,
+                                        bool use_padding) {
+  const Key key{&type, width, height, use_padding};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& textures = free_[key];
+    if (!textures.empty()) {
+      const GLTexture* texture = textures.back();
+      textures.pop_back();
+      return texture;
+    }
+  }
+  const GLTexture* texture =
+      new GLPlainTexture(type, nullptr, width, height, use_padding);
+  std::lock_guard<std::mutex> lock(mutex_);
+  owned_.emplace(texture, key);
+  return texture;
+}
+
+bool GLTexturePool::release(const GLTexture* texture) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = owned_.find(texture);
+  if (it == owned_.end()) {
+    return false;
+  }
+  free_[it->second].push_back(texture);
+  return true;
+}
+
+void GLTexturePool::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& textures : free_) {
+    for (const GLTexture* texture : textures.second) {
+      delete texture;
+    }
+  }
+  free_.clear();
+  owned_.clear();
+}
@@ -0,0 +1,54 @@
+
+#pragma once
+
+#include "GLTexture.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Keeps the textures of the released images to hand them out again to new
+// images of the same size and type, so that running a net again, or running
+// ops that allocate scratch images, doesn't allocate any texture once every
+// shape has been seen.
+class GLTexturePool {
+ public:
+  static GLTexturePool& getGLTexturePool();
+
+  const GLTexture* acquire(const GLTexture::Type& type,
+                           int width,
+                           int height,
+                           bool use_padding);
+
+  // Returns false if the texture wasn't acquired from the pool, in which case
+  // the caller still owns it
+  bool release(const GLTexture* texture);
+
+  // Deletes the free textures and gives up the ones in use, which are then
+  // deleted by their images. Must be called while the GL context is current.
+  void clear();
+
+ private:
+  struct Key {
+    const GLTexture::Type* type;
+    int width;
+    int height;
+    bool use_padding;
+
+    bool operator==(const Key& other) const {
+      return type == other.type && width == other.width &&
+             height == other.height && use_padding == other.use_padding;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return std::hash<const void*>()(key.type) ^
+             ((key.width * 31 + key.height) * 2 + key.use_padding);
+    }
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<Key, std::vector<const GLTexture*>, KeyHash> free_;
+  std::unordered_map<const GLTexture*, Key> owned_;
+};
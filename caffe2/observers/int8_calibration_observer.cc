@@ -0,0 +1,374 @@
+#include "caffe2/observers/int8_calibration_observer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+
+namespace {
+
+// uint8 activations
+constexpr int kInt8Levels = 256;
+
+bool IsObservedOp(const OperatorBase& op) {
+  if (!op.has_debug_def()) {
+    return false;
+  }
+  const auto& type = op.debug_def().type();
+  return type == "FC" || type == "Conv" || type == "Int8FC" ||
+      type == "Int8Conv";
+}
+
+void SetArgument(OperatorDef* op, const Argument& arg) {
+  for (auto& existing : *op->mutable_arg()) {
+    if (existing.name() == arg.name()) {
+      existing = arg;
+      return;
+    }
+  }
+  *op->add_arg() = arg;
+}
+
+// KL divergence of the histogram quantized to kInt8Levels levels over the bins
+// [begin, end) from the histogram clipped to them, where the values of the
+// bins out of [begin, end) are added to the bins at its ends. prefix holds the
+// prefix sums of counts.
+double QuantizationDivergence(
+    const std::vector<uint64_t>& counts,
+    const std::vector<uint64_t>& prefix,
+    int begin,
+    int end) {
+  const int n = end - begin;
+  std::vector<double> p(counts.begin() + begin, counts.begin() + end);
+  p[0] += prefix[begin];
+  p[n - 1] += prefix.back() - prefix[end];
+
+  // The values of every level are spread over the nonzero bins it covers.
+  // The clipped values aren't, so clipping many values is penalized.
+  std::vector<double> q(n);
+  for (int level = 0; level < kInt8Levels; ++level) {
+    const int level_begin = static_cast<int64_t>(level) * n / kInt8Levels;
+    const int level_end = static_cast<int64_t>(level + 1) * n / kInt8Levels;
+    double sum = 0;
+    int nonzero = 0;
+    for (int i = level_begin; i < level_end; ++i) {
+      sum += counts[begin + i];
+      nonzero += counts[begin + i] > 0;
+    }
+    for (int i = level_begin; i < level_end; ++i) {
+      q[i] = counts[begin + i] > 0 ? sum / nonzero : 0;
+    }
+  }
+
+  const double p_sum = prefix.back();
+  const double q_sum = prefix[end] - prefix[begin];
+  if (q_sum == 0) {
+    return std::numeric_limits<double>::infinity();
+  }
+  double divergence = 0;
+  for (int i = 0; i < n; ++i) {
+    if (p[i] > 0) {
+      const double pi = p[i] / p_sum;
+      const double qi = std::max(q[i] / q_sum, 1e-10);
+      divergence += pi * std::log(pi / qi);
+    }
+  }
+  return divergence;
+}
+
+} // namespace
+
+constexpr int Int8Histogram::kDefaultNumBins;
+
+Int8Histogram::Int8Histogram(int num_bins) : counts_(num_bins) {
+  CAFFE_ENFORCE_GT(num_bins, 0);
+}
+
+int Int8Histogram::Bin(float x) const {
+  const float width = BinWidth();
+  if (!(width > 0)) {
+    return 0;
+  }
+  const int bin = static_cast<int>((x - hist_min_) / width);
+  return std::max(0, std::min(static_cast<int>(counts_.size()) - 1, bin));
+}
+
+void Int8Histogram::Extend(float min, float max) {
+  if (total_ == 0) {
+    hist_min_ = min;
+    hist_max_ = max;
+    return;
+  }
+  if (min >= hist_min_ && max <= hist_max_) {
+    return;
+  }
+  float lo = std::min(hist_min_, min);
+  float hi = std::max(hist_max_, max);
+  const float min_span = 2 * (hist_max_ - hist_min_);
+  if (hi - lo < min_span) {
+    const float extra = min_span - (hi - lo);
+    if (min < hist_min_ && max > hist_max_) {
+      lo -= extra / 2;
+      hi += extra / 2;
+    } else if (min < hist_min_) {
+      lo -= extra;
+    } else {
+      hi += extra;
+    }
+  }
+
+  // Every bin moves to the new bin of its center
+  std::vector<uint64_t> old_counts(counts_.size());
+  std::swap(old_counts, counts_);
+  const float old_min = hist_min_;
+  const float old_width = BinWidth();
+  hist_min_ = lo;
+  hist_max_ = hi;
+  for (size_t i = 0; i < old_counts.size(); ++i) {
+    if (old_counts[i] > 0) {
+      counts_[Bin(old_min + (i + 0.5f) * old_width)] += old_counts[i];
+    }
+  }
+}
+
+void Int8Histogram::Add(const float* X, int64_t N) {
+  // Non-finite values are ignored
+  float min = std::numeric_limits<float>::max();
+  float max = std::numeric_limits<float>::lowest();
+  for (int64_t i = 0; i < N; ++i) {
+    if (std::isfinite(X[i])) {
+      min = std::min(min, X[i]);
+      max = std::max(max, X[i]);
+    }
+  }
+  if (min > max) {
+    return;
+  }
+  Extend(min, max);
+  uint64_t added = 0;
+  for (int64_t i = 0; i < N; ++i) {
+    if (std::isfinite(X[i])) {
+      ++counts_[Bin(X[i])];
+      ++added;
+    }
+  }
+  total_ += added;
+  min_ = std::min(min_, min);
+  max_ = std::max(max_, max);
+}
+
+void Int8Histogram::Merge(const Int8Histogram& other) {
+  if (other.total_ == 0) {
+    return;
+  }
+  Extend(other.min_, other.max_);
+  for (size_t i = 0; i < other.counts_.size(); ++i) {
+    if (other.counts_[i] > 0) {
+      const float center =
+          other.BinLowerBound(i) + 0.5f * other.BinWidth();
+      counts_[Bin(center)] += other.counts_[i];
+    }
+  }
+  total_ += other.total_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+std::pair<float, float> ChooseInt8Range(
+    const Int8Histogram& hist,
+    Int8RangeMethod method,
+    float percentile) {
+  if (hist.total() == 0) {
+    return {0.0f, 0.0f};
+  }
+  const float min = hist.min();
+  const float max = hist.max();
+  const auto& counts = hist.counts();
+  const int num_bins = counts.size();
+  if (method == Int8RangeMethod::MinMax || !(hist.BinWidth() > 0)) {
+    return {min, max};
+  }
+
+  if (method == Int8RangeMethod::Percentile) {
+    CAFFE_ENFORCE(
+        percentile > 0.5f && percentile <= 1.0f,
+        "percentile must be in (0.5, 1], got ",
+        percentile);
+    const double clipped = (1.0 - percentile) * hist.total();
+    int begin = 0;
+    for (double sum = counts[0]; sum <= clipped && begin < num_bins - 1;
+         sum += counts[++begin]) {
+    }
+    int end = num_bins;
+    for (double sum = counts[end - 1]; sum <= clipped && end > begin + 1;
+         sum += counts[--end - 1]) {
+    }
+    return {std::max(min, hist.BinLowerBound(begin)),
+            std::min(max, hist.BinLowerBound(end))};
+  }
+
+  CAFFE_ENFORCE(method == Int8RangeMethod::KL);
+  std::vector<uint64_t> prefix(num_bins + 1);
+  for (int i = 0; i < num_bins; ++i) {
+    prefix[i + 1] = prefix[i] + counts[i];
+  }
+  int begin = 0;
+  while (counts[begin] == 0) {
+    ++begin;
+  }
+  int end = num_bins;
+  while (counts[end - 1] == 0) {
+    --end;
+  }
+  // Shrinks the range one bin at a time, from the end with the fewer values
+  int best_begin = begin;
+  int best_end = end;
+  double best_divergence = std::numeric_limits<double>::infinity();
+  while (end - begin >= kInt8Levels) {
+    const double divergence =
+        QuantizationDivergence(counts, prefix, begin, end);
+    if (divergence < best_divergence) {
+      best_divergence = divergence;
+      best_begin = begin;
+      best_end = end;
+    }
+    if (counts[begin] <= counts[end - 1]) {
+      ++begin;
+    } else {
+      --end;
+    }
+  }
+  return {std::max(min, hist.BinLowerBound(best_begin)),
+          std::min(max, hist.BinLowerBound(best_end))};
+}
+
+Int8CalibrationOperatorObserver::Int8CalibrationOperatorObserver(
+    OperatorBase* subject,
+    Int8CalibrationObserver* /* unused */)
+    : ObserverBase<OperatorBase>(subject), enabled_(IsObservedOp(*subject)) {}
+
+void Int8CalibrationOperatorObserver::Start() {
+  if (!enabled_ || !subject_->InputIsTensorType(0, CPU)) {
+    return;
+  }
+  const auto& X = subject_->Input<Tensor>(0, CPU);
+  if (!X.IsType<float>() || X.size() == 0) {
+    return;
+  }
+  histogram_.Add(X.data<float>(), X.size());
+}
+
+std::unique_ptr<ObserverBase<OperatorBase>>
+Int8CalibrationOperatorObserver::rnnCopy(
+    OperatorBase* subject,
+    int /* rnn_order */) const {
+  return std::unique_ptr<ObserverBase<OperatorBase>>(
+      new Int8CalibrationOperatorObserver(subject, nullptr));
+}
+
+std::unordered_map<std::string, Int8Histogram>
+Int8CalibrationObserver::GetBlobHistograms() const {
+  std::unordered_map<std::string, Int8Histogram> histograms;
+  for (const auto* observer : operator_observers_) {
+    if (observer->calibrated()) {
+      histograms[observer->subject()->debug_def().input(0)].Merge(
+          observer->histogram());
+    }
+  }
+  return histograms;
+}
+
+std::unordered_map<std::string, Int8QuantizationParams>
+Int8CalibrationObserver::GetActivationParams(
+    Int8RangeMethod method,
+    float percentile) const {
+  std::unordered_map<std::string, Int8QuantizationParams> params;
+  for (const auto& entry : GetBlobHistograms()) {
+    const auto range = ChooseInt8Range(entry.second, method, percentile);
+    params[entry.first] =
+        ChooseInt8QuantizationParams(range.first, range.second);
+  }
+  return params;
+}
+
+void Int8CalibrationObserver::SetQuantizationArgs(
+    NetDef* net,
+    Int8RangeMethod method,
+    float percentile) const {
+  CAFFE_ENFORCE_EQ(
+      net->op_size(),
+      operator_observers_.size(),
+      "The NetDef doesn't match the observed net");
+  const auto params = GetActivationParams(method, percentile);
+  for (int i = 0; i < net->op_size(); ++i) {
+    const auto* observer = operator_observers_[i];
+    auto* op = net->mutable_op(i);
+    if (!observer->calibrated() ||
+        (op->type() != "Int8FC" && op->type() != "Int8Conv")) {
+      continue;
+    }
+    CAFFE_ENFORCE_EQ(op->type(), observer->subject()->debug_def().type());
+    const auto& qparams = params.at(op->input(0));
+    SetArgument(op, MakeArgument<float>("X_scale", qparams.scale));
+    SetArgument(op, MakeArgument<int>("X_zero_point", qparams.zero_point));
+  }
+}
+
+int QuantizeNetToInt8(
+    NetDef* net,
+    NetDef* init_net,
+    const std::unordered_map<std::string, Int8QuantizationParams>&
+        activation_params) {
+  std::vector<OperatorDef> ops(net->op().begin(), net->op().end());
+  std::unordered_set<std::string> packed_weights;
+  int replaced = 0;
+  net->clear_op();
+  for (auto& op : ops) {
+    ArgumentHelper helper(op);
+    bool quantizable = false;
+    if (op.type() == "FC") {
+      quantizable = op.input_size() == 3 &&
+          helper.GetSingleArgument<int>("axis_w", 1) == 1;
+    } else if (op.type() == "Conv") {
+      quantizable =
+          helper.GetSingleArgument<std::string>("order", "NCHW") == "NHWC" &&
+          helper.GetSingleArgument<int>("group", 1) == 1 &&
+          (!helper.HasArgument("kernels") ||
+           helper.GetRepeatedArgument<int>("kernels").size() == 2);
+    }
+    if (op.device_option().device_type() != PROTO_CPU) {
+      quantizable = false;
+    }
+    const auto qparams = activation_params.find(op.input(0));
+    if (!quantizable || qparams == activation_params.end()) {
+      *net->add_op() = op;
+      continue;
+    }
+
+    const std::string weight = op.input(1);
+    const std::string packed_weight = weight + "_int8_packed";
+    if (packed_weights.insert(weight).second) {
+      auto pack = CreateOperatorDef(
+          "Int8PackWeight",
+          "",
+          std::vector<std::string>{weight},
+          std::vector<std::string>{packed_weight},
+          op.device_option());
+      *(init_net ? init_net->add_op() : net->add_op()) = pack;
+    }
+    op.set_type(op.type() == "FC" ? "Int8FC" : "Int8Conv");
+    op.set_input(1, packed_weight);
+    op.clear_engine();
+    SetArgument(&op, MakeArgument<float>("X_scale", qparams->second.scale));
+    SetArgument(
+        &op, MakeArgument<int>("X_zero_point", qparams->second.zero_point));
+    *net->add_op() = op;
+    ++replaced;
+  }
+  return replaced;
+}
+
+} // namespace caffe2
@@ -0,0 +1,165 @@
+#ifndef CAFFE2_OBSERVERS_INT8_CALIBRATION_OBSERVER_H_
+#define CAFFE2_OBSERVERS_INT8_CALIBRATION_OBSERVER_H_
+
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/observer.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/observers/operator_attaching_net_observer.h"
+#include "caffe2/operators/int8_quantization.h"
+
+namespace caffe2 {
+
+// Histogram of a stream of floats, in a constant number of bins. The bins
+// cover a range that grows with the data: when values fall outside of it, the
+// range is at least doubled and the counts are moved to the new bins, so a
+// stream is rebinned only a few times, and every value is read twice.
+class CAFFE2_API Int8Histogram {
+ public:
+  static constexpr int kDefaultNumBins = 2048;
+
+  explicit Int8Histogram(int num_bins = kDefaultNumBins);
+
+  void Add(const float* X, int64_t N);
+  void Merge(const Int8Histogram& other);
+
+  uint64_t total() const {
+    return total_;
+  }
+  // The extremes of the values added
+  float min() const {
+    return min_;
+  }
+  float max() const {
+    return max_;
+  }
+  const std::vector<uint64_t>& counts() const {
+    return counts_;
+  }
+  float BinLowerBound(int bin) const {
+    return hist_min_ + bin * BinWidth();
+  }
+  float BinWidth() const {
+    return (hist_max_ - hist_min_) / counts_.size();
+  }
+
+ private:
+  void Extend(float min, float max);
+  int Bin(float x) const;
+
+  std::vector<uint64_t> counts_;
+  uint64_t total_ = 0;
+  float min_ = std::numeric_limits<float>::max();
+  float max_ = std::numeric_limits<float>::lowest();
+  // The range of the bins
+  float hist_min_ = 0;
+  float hist_max_ = 0;
+};
+
+enum class Int8RangeMethod {
+  // The whole range of the values
+  MinMax,
+  // Clips (1 - percentile) of the values at each end
+  Percentile,
+  // Clips the range whose quantization loses the least information, as the
+  // KL divergence of the quantized histogram from the original one
+  KL,
+};
+
+// Range of the values of hist to quantize to 8 bits, chosen with method
+CAFFE2_API std::pair<float, float> ChooseInt8Range(
+    const Int8Histogram& hist,
+    Int8RangeMethod method,
+    float percentile = 0.9999f);
+
+class Int8CalibrationObserver;
+
+// Records the values of the float input of an FC, Conv, Int8FC or Int8Conv
+// over the runs
+class CAFFE2_API Int8CalibrationOperatorObserver final
+    : public ObserverBase<OperatorBase> {
+ public:
+  explicit Int8CalibrationOperatorObserver(OperatorBase* subject) = delete;
+  Int8CalibrationOperatorObserver(
+      OperatorBase* subject,
+      Int8CalibrationObserver* /* unused */);
+  std::unique_ptr<ObserverBase<OperatorBase>> rnnCopy(
+      OperatorBase* subject,
+      int rnn_order) const override;
+
+  bool calibrated() const {
+    return histogram_.total() > 0;
+  }
+  float min() const {
+    return histogram_.min();
+  }
+  float max() const {
+    return histogram_.max();
+  }
+  const Int8Histogram& histogram() const {
+    return histogram_;
+  }
+
+ private:
+  void Start() override;
+  void Stop() override {}
+
+  bool enabled_;
+  Int8Histogram histogram_;
+};
+
+// Calibrates the activation quantization of a net: run the net on
+// representative inputs with the observer attached, then either
+// - call SetQuantizationArgs on the NetDef of the net to fix the X_scale and
+//   X_zero_point arguments of its Int8FC and Int8Conv ops, so that they don't
+//   compute the range of their input in every run, or
+// - call QuantizeNetToInt8 with GetActivationParams to turn the FC and Conv
+//   ops of a float net into Int8FC and Int8Conv ops with those arguments.
+// Every op observer only updates its own histogram, from the thread that runs
+// the op, so this works with the async nets too. The results may be read
+// between runs.
+class CAFFE2_API Int8CalibrationObserver final
+    : public OperatorAttachingNetObserver<
+          Int8CalibrationOperatorObserver,
+          Int8CalibrationObserver> {
+ public:
+  explicit Int8CalibrationObserver(NetBase* subject)
+      : OperatorAttachingNetObserver<
+            Int8CalibrationOperatorObserver,
+            Int8CalibrationObserver>(subject, this) {}
+
+  // The histograms of the observed blobs, merged over the ops that read them
+  std::unordered_map<std::string, Int8Histogram> GetBlobHistograms() const;
+
+  // The quantization parameters of the observed blobs
+  std::unordered_map<std::string, Int8QuantizationParams> GetActivationParams(
+      Int8RangeMethod method = Int8RangeMethod::MinMax,
+      float percentile = 0.9999f) const;
+
+  // The ops of `net` are the ones the observed net was created from
+  void SetQuantizationArgs(
+      NetDef* net,
+      Int8RangeMethod method = Int8RangeMethod::MinMax,
+      float percentile = 0.9999f) const;
+};
+
+// Replaces the FC ops, and the 2D NHWC Conv ops without groups, whose input
+// has quantization parameters in activation_params by Int8FC and Int8Conv ops
+// with those parameters. Their weights are packed by Int8PackWeight ops, added
+// to init_net if given, or else before their first use in net. Returns the
+// number of ops replaced.
+CAFFE2_API int QuantizeNetToInt8(
+    NetDef* net,
+    NetDef* init_net,
+    const std::unordered_map<std::string, Int8QuantizationParams>&
+        activation_params);
+
+} // namespace caffe2
+
+#endif // CAFFE2_OBSERVERS_INT8_CALIBRATION_OBSERVER_H_
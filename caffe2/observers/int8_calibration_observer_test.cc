@@ -0,0 +1,124 @@
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/observers/int8_calibration_observer.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+
+namespace {
+
+void FillTensor(Workspace* ws, const string& name, vector<int64_t> dims) {
+  auto* tensor = BlobGetMutableTensor(ws->CreateBlob(name), CPU);
+  tensor->Resize(dims);
+  float* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->size(); ++i) {
+    data[i] = std::sin(0.7 * i + name.size());
+  }
+}
+
+} // namespace
+
+TEST(Int8CalibrationObserverTest, HistogramGrowsWithTheData) {
+  Int8Histogram hist(64);
+  std::vector<float> X(100);
+  for (int i = 0; i < X.size(); ++i) {
+    X[i] = i * 0.01f;
+  }
+  hist.Add(X.data(), X.size());
+  for (auto& x : X) {
+    x = -x * 3;
+  }
+  hist.Add(X.data(), X.size());
+  const float nan = std::nanf("");
+  hist.Add(&nan, 1);
+
+  EXPECT_EQ(hist.total(), 200);
+  EXPECT_FLOAT_EQ(hist.min(), -2.97f);
+  EXPECT_FLOAT_EQ(hist.max(), 0.99f);
+  uint64_t sum = 0;
+  for (auto count : hist.counts()) {
+    sum += count;
+  }
+  EXPECT_EQ(sum, 200);
+  EXPECT_LE(hist.BinLowerBound(0), hist.min());
+  EXPECT_GE(hist.BinLowerBound(64), hist.max());
+
+  Int8Histogram other(64);
+  const float x = 5;
+  other.Add(&x, 1);
+  hist.Merge(other);
+  EXPECT_EQ(hist.total(), 201);
+  EXPECT_FLOAT_EQ(hist.max(), 5);
+}
+
+TEST(Int8CalibrationObserverTest, RangesClipOutliers) {
+  Int8Histogram hist;
+  std::vector<float> X(10000);
+  for (int i = 0; i < X.size(); ++i) {
+    X[i] = std::sin(0.1 * i);
+  }
+  X[0] = 100;
+  hist.Add(X.data(), X.size());
+
+  const auto minmax = ChooseInt8Range(hist, Int8RangeMethod::MinMax);
+  EXPECT_FLOAT_EQ(minmax.first, hist.min());
+  EXPECT_FLOAT_EQ(minmax.second, 100);
+  for (auto method : {Int8RangeMethod::Percentile, Int8RangeMethod::KL}) {
+    const auto range = ChooseInt8Range(hist, method, 0.999f);
+    EXPECT_LE(range.first, -0.9f);
+    EXPECT_GE(range.second, 0.9f);
+    EXPECT_LT(range.second, 2.0f);
+  }
+}
+
+TEST(Int8CalibrationObserverTest, QuantizesCalibratedNet) {
+  Workspace ws;
+  FillTensor(&ws, "X", {5, 37});
+  FillTensor(&ws, "W", {11, 37});
+  FillTensor(&ws, "b", {11});
+
+  NetDef net_def;
+  net_def.set_name("calibration_test_net");
+  *net_def.add_op() = CreateOperatorDef(
+      "FC",
+      "",
+      std::vector<string>{"X", "W", "b"},
+      std::vector<string>{"Y_ref"});
+  unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  auto* observer = dynamic_cast<const Int8CalibrationObserver*>(
+      net->AttachObserver(make_unique<Int8CalibrationObserver>(net.get())));
+  ASSERT_TRUE(net->Run());
+  const auto params = observer->GetActivationParams(Int8RangeMethod::KL);
+  ASSERT_EQ(params.size(), 1);
+  EXPECT_GT(params.at("X").scale, 0);
+
+  NetDef init_net;
+  EXPECT_EQ(QuantizeNetToInt8(&net_def, &init_net, params), 1);
+  ASSERT_EQ(init_net.op_size(), 1);
+  EXPECT_EQ(init_net.op(0).type(), "Int8PackWeight");
+  ASSERT_EQ(net_def.op_size(), 1);
+  EXPECT_EQ(net_def.op(0).type(), "Int8FC");
+  EXPECT_EQ(net_def.op(0).input(1), init_net.op(0).output(0));
+  EXPECT_TRUE(ArgumentHelper(net_def.op(0)).HasArgument("X_scale"));
+
+  net_def.mutable_op(0)->set_output(0, "Y");
+  ASSERT_TRUE(ws.RunNetOnce(init_net));
+  ASSERT_TRUE(ws.RunNetOnce(net_def));
+  const auto& Y = ws.GetBlob("Y")->Get<TensorCPU>();
+  const auto& ref = ws.GetBlob("Y_ref")->Get<TensorCPU>();
+  ASSERT_EQ(Y.dims(), ref.dims());
+  float max_abs = 0;
+  for (int64_t i = 0; i < ref.size(); ++i) {
+    max_abs = std::max(max_abs, std::abs(ref.data<float>()[i]));
+  }
+  for (int64_t i = 0; i < ref.size(); ++i) {
+    EXPECT_NEAR(Y.data<float>()[i], ref.data<float>()[i], 0.03 * max_abs);
+  }
+}
+
+} // namespace caffe2
@@ -0,0 +1,178 @@
+#include "caffe2/observers/latency_observer.h"
+
+#include <cmath>
+
+#include "caffe2/core/init.h"
+#include "caffe2/core/logging.h"
+
+C10_DEFINE_int(
+    caffe2_latency_observer_sample_rate,
+    0,
+    "If positive, attach a LatencyObserver to every net, which records the "
+    "latencies of its ops in one of every N runs.");
+C10_DEFINE_int(
+    caffe2_latency_observer_aggregation_period,
+    100,
+    "Number of sampled runs between the exports of the latencies recorded "
+    "by the LatencyObserver.");
+
+namespace caffe2 {
+
+namespace {
+
+bool registerGlobalLatencyObserverCreator(int* /*pargc*/, char*** /*pargv*/) {
+  if (FLAGS_caffe2_latency_observer_sample_rate > 0) {
+    AddGlobalNetObserverCreator([](NetBase* subject) {
+      return caffe2::make_unique<LatencyObserver>(
+          subject,
+          FLAGS_caffe2_latency_observer_sample_rate,
+          FLAGS_caffe2_latency_observer_aggregation_period);
+    });
+  }
+  return true;
+}
+
+} // namespace
+
+REGISTER_CAFFE2_INIT_FUNCTION(
+    registerGlobalLatencyObserverCreator,
+    &registerGlobalLatencyObserverCreator,
+    "Attach a LatencyObserver to every net.");
+
+constexpr int LatencyHistogram::kNumBuckets;
+
+LatencyHistogram::LatencyHistogram() : sum_micros_(0) {
+  for (auto& count : counts_) {
+    count.store(0);
+  }
+}
+
+int LatencyHistogram::Bucket(float micros) {
+  if (!(micros >= 1.0f)) {
+    return 0;
+  }
+  const int bucket = static_cast<int>(2.0f * std::log2(micros)) + 1;
+  return bucket < kNumBuckets ? bucket : kNumBuckets - 1;
+}
+
+float LatencyHistogram::BucketUpperBound(int bucket) {
+  return bucket == kNumBuckets - 1 ? INFINITY : std::exp2(bucket * 0.5f);
+}
+
+int64_t LatencyHistogram::Drain(int64_t* counts, int64_t* sum_micros) {
+  int64_t total = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    counts[i] = counts_[i].exchange(0, std::memory_order_relaxed);
+    total += counts[i];
+  }
+  *sum_micros = sum_micros_.exchange(0, std::memory_order_relaxed);
+  return total;
+}
+
+LatencyOperatorObserver::LatencyOperatorObserver(
+    OperatorBase* subject,
+    LatencyObserver* netObserver)
+    : ObserverBase<OperatorBase>(subject), netObserver_(netObserver) {}
+
+void LatencyOperatorObserver::Start() {
+  sampled_ = netObserver_ && netObserver_->sampling();
+  if (sampled_) {
+    timer_.Start();
+  }
+}
+
+void LatencyOperatorObserver::Stop() {
+  if (sampled_) {
+    histogram_.Record(timer_.MicroSeconds());
+  }
+}
+
+std::unique_ptr<ObserverBase<OperatorBase>> LatencyOperatorObserver::rnnCopy(
+    OperatorBase* subject,
+    int /* rnn_order */) const {
+  return std::unique_ptr<ObserverBase<OperatorBase>>(
+      new LatencyOperatorObserver(subject, nullptr));
+}
+
+LatencyObserver::LatencyObserver(
+    NetBase* subject,
+    int sample_rate,
+    int aggregation_period)
+    : OperatorAttachingNetObserver<LatencyOperatorObserver, LatencyObserver>(
+          subject,
+          this),
+      sample_rate_(sample_rate),
+      aggregation_period_(aggregation_period),
+      stats_prefix_("latency/" + subject->Name()) {
+  CAFFE_ENFORCE_GT(aggregation_period_, 0);
+  auto& registry = StatRegistry::get();
+  const auto& operators = subject->GetOperators();
+  op_stats_.resize(operators.size());
+  for (size_t i = 0; i < operators.size(); ++i) {
+    auto& stats = op_stats_[i];
+    stats.prefix = stats_prefix_ + "/" + caffe2::to_string(i) + "_" +
+        operators[i]->type();
+    stats.count = registry.add(stats.prefix + "/count");
+    stats.sum_micros = registry.add(stats.prefix + "/sum_us");
+    stats.buckets.fill(nullptr);
+  }
+}
+
+void LatencyObserver::Start() {
+  sampling_ = sample_rate_ > 0 && ++runs_ % sample_rate_ == 0;
+}
+
+void LatencyObserver::Stop() {
+  if (sampling_ && ++sampled_runs_ % aggregation_period_ == 0) {
+    Aggregate();
+  }
+}
+
+void LatencyObserver::Aggregate() {
+  std::lock_guard<std::mutex> guard(aggregation_mutex_);
+  int64_t counts[LatencyHistogram::kNumBuckets];
+  int64_t sum_micros = 0;
+  for (size_t i = 0; i < operator_observers_.size(); ++i) {
+    auto& stats = op_stats_[i];
+    const int64_t total =
+        operator_observers_[i]->histogram()->Drain(counts, &sum_micros);
+    if (total == 0) {
+      continue;
+    }
+    stats.count->increment(total);
+    stats.sum_micros->increment(sum_micros);
+    for (int j = 0; j < LatencyHistogram::kNumBuckets; ++j) {
+      if (counts[j] == 0) {
+        continue;
+      }
+      if (!stats.buckets[j]) {
+        stats.buckets[j] = StatRegistry::get().add(
+            stats.prefix + "/bucket_" + caffe2::to_string(j));
+      }
+      stats.buckets[j]->increment(counts[j]);
+    }
+  }
+}
+
+float LatencyObserver::Percentile(
+    const ExportedStatMap& stats,
+    const std::string& op_prefix,
+    double p) {
+  int64_t counts[LatencyHistogram::kNumBuckets];
+  int64_t total = 0;
+  for (int i = 0; i < LatencyHistogram::kNumBuckets; ++i) {
+    auto it = stats.find(op_prefix + "/bucket_" + caffe2::to_string(i));
+    counts[i] = it == stats.end() ? 0 : it->second;
+    total += counts[i];
+  }
+  int64_t cumulative = 0;
+  for (int i = 0; i < LatencyHistogram::kNumBuckets; ++i) {
+    cumulative += counts[i];
+    if (cumulative > 0 && cumulative >= p * total) {
+      return LatencyHistogram::BucketUpperBound(i);
+    }
+  }
+  return 0;
+}
+
+} // namespace caffe2
@@ -0,0 +1,134 @@
+#ifndef CAFFE2_OBSERVERS_LATENCY_OBSERVER_H_
+#define CAFFE2_OBSERVERS_LATENCY_OBSERVER_H_
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/flags.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/observer.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/stats.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/observers/operator_attaching_net_observer.h"
+
+C10_DECLARE_int(caffe2_latency_observer_sample_rate);
+C10_DECLARE_int(caffe2_latency_observer_aggregation_period);
+
+namespace caffe2 {
+
+class LatencyObserver;
+
+// Histogram of the latencies of an operator. It is written by the thread
+// running the operator and drained by the aggregation with relaxed atomics,
+// so that recording a latency never takes a lock.
+class CAFFE2_API LatencyHistogram {
+ public:
+  // Bucket 0 counts the latencies below 1us, bucket i > 0 the latencies below
+  // 2^(i / 2) us, and the last bucket all the larger ones.
+  static constexpr int kNumBuckets = 48;
+
+  LatencyHistogram();
+
+  static int Bucket(float micros);
+  static float BucketUpperBound(int bucket);
+
+  void Record(float micros) {
+    counts_[Bucket(micros)].fetch_add(1, std::memory_order_relaxed);
+    sum_micros_.fetch_add(
+        static_cast<int64_t>(micros), std::memory_order_relaxed);
+  }
+
+  // Moves the recorded counts into the kNumBuckets counts and returns the
+  // number of recorded latencies. Nothing recorded concurrently is lost.
+  int64_t Drain(int64_t* counts, int64_t* sum_micros);
+
+ private:
+  std::array<std::atomic<int64_t>, kNumBuckets> counts_;
+  std::atomic<int64_t> sum_micros_;
+};
+
+class CAFFE2_API LatencyOperatorObserver final
+    : public ObserverBase<OperatorBase> {
+ public:
+  explicit LatencyOperatorObserver(OperatorBase* subject) = delete;
+  LatencyOperatorObserver(OperatorBase* subject, LatencyObserver* netObserver);
+  std::unique_ptr<ObserverBase<OperatorBase>> rnnCopy(
+      OperatorBase* subject,
+      int rnn_order) const override;
+
+  LatencyHistogram* histogram() const {
+    return &histogram_;
+  }
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  // null for the copies in RNN step nets, which don't record
+  LatencyObserver* netObserver_;
+  Timer timer_;
+  bool sampled_ = false;
+  mutable LatencyHistogram histogram_;
+};
+
+// Records the latency of every op of a net in one of every sample_rate runs,
+// and adds them every aggregation_period sampled runs to the StatRegistry
+// counters "latency/<net name>/<op index>_<op type>/{count,sum_us,bucket_<i>}"
+// (see LatencyHistogram for the buckets), which are exported with
+// StatRegistry::publish. The runs that are not sampled only check a flag per
+// op. Attached to every net when caffe2_latency_observer_sample_rate > 0.
+class CAFFE2_API LatencyObserver final
+    : public OperatorAttachingNetObserver<
+          LatencyOperatorObserver,
+          LatencyObserver> {
+ public:
+  LatencyObserver(NetBase* subject, int sample_rate, int aggregation_period);
+
+  bool sampling() const {
+    return sampling_;
+  }
+
+  // Adds the latencies recorded since the last aggregation to the counters
+  void Aggregate();
+
+  const std::string& stats_prefix() const {
+    return stats_prefix_;
+  }
+
+  // Upper bound of the bucket of the p quantile of the latencies exported
+  // under op_prefix, i.e. "latency/<net name>/<op index>_<op type>"
+  static float Percentile(
+      const ExportedStatMap& stats,
+      const std::string& op_prefix,
+      double p);
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  struct OpStats {
+    std::string prefix;
+    StatValue* count;
+    StatValue* sum_micros;
+    // added on the first latency of the bucket
+    std::array<StatValue*, LatencyHistogram::kNumBuckets> buckets;
+  };
+
+  const int sample_rate_;
+  const int aggregation_period_;
+  int64_t runs_ = 0;
+  int64_t sampled_runs_ = 0;
+  bool sampling_ = false;
+  std::string stats_prefix_;
+  std::mutex aggregation_mutex_;
+  std::vector<OpStats> op_stats_;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OBSERVERS_LATENCY_OBSERVER_H_
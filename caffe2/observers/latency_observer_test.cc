@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/stats.h"
+#include "caffe2/observers/latency_observer.h"
+
+namespace caffe2 {
+
+namespace {
+
+unique_ptr<NetBase> CreateNetTestHelper(Workspace* ws) {
+  NetDef net_def;
+  net_def.set_name("latency_test_net");
+  for (const char* output : {"a", "b"}) {
+    auto& op = *(net_def.add_op());
+    op.set_type("ConstantFill");
+    op.add_output(output);
+    op.add_arg()->CopyFrom(MakeArgument("shape", vector<int64_t>{16}));
+  }
+  return CreateNet(net_def, ws);
+}
+
+} // namespace
+
+TEST(LatencyObserverTest, Buckets) {
+  EXPECT_EQ(LatencyHistogram::Bucket(0.5f), 0);
+  EXPECT_EQ(LatencyHistogram::Bucket(1.0f), 1);
+  EXPECT_EQ(LatencyHistogram::Bucket(1.5f), 2);
+  EXPECT_EQ(LatencyHistogram::Bucket(1e9f), LatencyHistogram::kNumBuckets - 1);
+  for (int i = 0; i < LatencyHistogram::kNumBuckets - 1; ++i) {
+    const float bound = LatencyHistogram::BucketUpperBound(i);
+    EXPECT_EQ(LatencyHistogram::Bucket(bound * 0.99f), i);
+    EXPECT_EQ(LatencyHistogram::Bucket(bound * 1.01f), i + 1);
+  }
+}
+
+TEST(LatencyObserverTest, ExportsSampledRuns) {
+  Workspace ws;
+  unique_ptr<NetBase> net(CreateNetTestHelper(&ws));
+  auto net_ob = caffe2::make_unique<LatencyObserver>(
+      net.get(), /*sample_rate=*/2, /*aggregation_period=*/1);
+  const std::string prefix = net_ob->stats_prefix();
+  net->AttachObserver(std::move(net_ob));
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(net->Run());
+  }
+
+  auto stats = toMap(StatRegistry::get().publish());
+  for (const char* op : {"/0_ConstantFill", "/1_ConstantFill"}) {
+    EXPECT_EQ(stats[prefix + op + "/count"], 2);
+    int64_t buckets = 0;
+    for (int i = 0; i < LatencyHistogram::kNumBuckets; ++i) {
+      buckets += stats[prefix + op + "/bucket_" + caffe2::to_string(i)];
+    }
+    EXPECT_EQ(buckets, 2);
+    EXPECT_GT(LatencyObserver::Percentile(stats, prefix + op, 0.5), 0);
+  }
+}
+
+} // namespace caffe2
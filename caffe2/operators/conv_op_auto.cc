@@ -0,0 +1,364 @@
+#include <limits>
+#include <mutex>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/flags.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/operators/conv_op_cache_cudnn.h"
+#include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/utils/math.h"
+
+C10_DEFINE_bool(
+    caffe2_conv_auto_benchmark,
+    false,
+    "If set, the AUTO engine of Conv times the applicable algorithms the "
+    "first time it sees a shape, instead of choosing by the shape");
+
+namespace caffe2 {
+
+namespace {
+
+enum class ConvAutoAlgorithm {
+  IM2COL_GEMM = 0,
+  DIRECT_DEPTHWISE = 1,
+  WINOGRAD_F2X3 = 2,
+};
+
+// Algorithms timed by --caffe2_conv_auto_benchmark, shared by all ops
+AlgorithmsCache<ConvAutoAlgorithm>& BenchmarkCache() {
+  static AlgorithmsCache<ConvAutoAlgorithm> cache;
+  return cache;
+}
+
+std::mutex& BenchmarkCacheMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// Winograd F(2x2, 3x3) transforms, see Lavin & Gray, "Fast Algorithms for
+// Convolutional Neural Networks". The filter transform is G g G^T, the input
+// transform B^T d B and the output transform A^T m A.
+inline void WinogradFilterTransform(const float* g, float* u, int stride) {
+  float t[4][3];
+  for (int j = 0; j < 3; ++j) {
+    t[0][j] = g[j];
+    t[1][j] = 0.5f * (g[j] + g[3 + j] + g[6 + j]);
+    t[2][j] = 0.5f * (g[j] - g[3 + j] + g[6 + j]);
+    t[3][j] = g[6 + j];
+  }
+  for (int i = 0; i < 4; ++i) {
+    u[(4 * i) * stride] = t[i][0];
+    u[(4 * i + 1) * stride] = 0.5f * (t[i][0] + t[i][1] + t[i][2]);
+    u[(4 * i + 2) * stride] = 0.5f * (t[i][0] - t[i][1] + t[i][2]);
+    u[(4 * i + 3) * stride] = t[i][2];
+  }
+}
+
+inline void WinogradInputTransform(const float d[4][4], float* v, int stride) {
+  float t[4][4];
+  for (int j = 0; j < 4; ++j) {
+    t[0][j] = d[0][j] - d[2][j];
+    t[1][j] = d[1][j] + d[2][j];
+    t[2][j] = d[2][j] - d[1][j];
+    t[3][j] = d[1][j] - d[3][j];
+  }
+  for (int i = 0; i < 4; ++i) {
+    v[(4 * i) * stride] = t[i][0] - t[i][2];
+    v[(4 * i + 1) * stride] = t[i][1] + t[i][2];
+    v[(4 * i + 2) * stride] = t[i][2] - t[i][1];
+    v[(4 * i + 3) * stride] = t[i][1] - t[i][3];
+  }
+}
+
+inline void WinogradOutputTransform(const float* m, int stride, float y[2][2]) {
+  float t[2][4];
+  for (int j = 0; j < 4; ++j) {
+    t[0][j] = m[j * stride] + m[(4 + j) * stride] + m[(8 + j) * stride];
+    t[1][j] = m[(4 + j) * stride] - m[(8 + j) * stride] - m[(12 + j) * stride];
+  }
+  for (int i = 0; i < 2; ++i) {
+    y[i][0] = t[i][0] + t[i][1] + t[i][2];
+    y[i][1] = t[i][1] - t[i][2] - t[i][3];
+  }
+}
+
+} // namespace
+
+// Conv engine that picks the CPU algorithm for the shapes of every layer:
+// - a direct loop for depthwise convolutions, where im2col + GEMM runs one
+//   tiny GEMM per channel,
+// - Winograd F(2x2, 3x3) for 3x3 convolutions with stride 1 and enough
+//   channels, which takes 2.25x fewer multiplications than a direct 3x3,
+// - im2col + GEMM (the default Conv) otherwise.
+// The choice is cached until the input shapes change. Select it for all
+// Conv ops of a process, without editing the models, with
+// SetPerOpEnginePref({{CPU, {{"Conv", {"AUTO"}}}}}).
+class ConvAutoOp final : public ConvPoolOpBase<CPUContext> {
+ public:
+  USE_CONV_POOL_BASE_FUNCTIONS(CPUContext);
+  ConvAutoOp(const OperatorDef& operator_def, Workspace* ws)
+      : ConvPoolOpBase<CPUContext>(operator_def, ws),
+        // The default Conv, created without going through the engine
+        // preferences that would select this engine again
+        im2col_op_(CPUOperatorRegistry()->Create(
+            operator_def.type(),
+            operator_def,
+            ws)) {
+    CAFFE_ENFORCE(im2col_op_, "No default CPU op for ", operator_def.type());
+  }
+
+  bool RunOnDeviceWithOrderNCHW() override {
+    return RunWithAlgorithm(ChooseAlgorithm());
+  }
+
+  bool RunOnDeviceWithOrderNHWC() override {
+    return im2col_op_->Run();
+  }
+
+ private:
+  bool IsDepthwise(const Tensor& X, const Tensor& filter) const {
+    return kernel_.size() == 2 && group_ > 1 && X.dim32(1) == group_ &&
+        filter.dim32(0) == group_;
+  }
+
+  bool IsWinogradApplicable() const {
+    return kernel_.size() == 2 && group_ == 1 && kernel_h() == 3 &&
+        kernel_w() == 3 && !HasStride() && dilation_h() == 1 &&
+        dilation_w() == 1;
+  }
+
+  ConvAutoAlgorithm ChooseAlgorithm() {
+    const auto& X = Input(INPUT);
+    const auto& filter = Input(FILTER);
+    if (X.dims() == cached_input_dims_ &&
+        filter.dims() == cached_filter_dims_) {
+      return algorithm_;
+    }
+    cached_input_dims_ = X.dims().vec();
+    cached_filter_dims_ = filter.dims().vec();
+
+    std::vector<ConvAutoAlgorithm> candidates{ConvAutoAlgorithm::IM2COL_GEMM};
+    if (IsDepthwise(X, filter)) {
+      candidates.push_back(ConvAutoAlgorithm::DIRECT_DEPTHWISE);
+    }
+    if (IsWinogradApplicable()) {
+      candidates.push_back(ConvAutoAlgorithm::WINOGRAD_F2X3);
+    }
+
+    if (!FLAGS_caffe2_conv_auto_benchmark) {
+      algorithm_ = candidates.back();
+      // The transforms cost more than the multiplications they save with
+      // few channels or tiny images
+      if (algorithm_ == ConvAutoAlgorithm::WINOGRAD_F2X3 &&
+          (X.dim32(1) < 16 || filter.dim32(0) < 16 || X.dim32(2) < 4 ||
+           X.dim32(3) < 4)) {
+        algorithm_ = ConvAutoAlgorithm::IM2COL_GEMM;
+      }
+      return algorithm_;
+    }
+
+    // The parameters that change the algorithms, in the flags of the cache
+    int flags = group_;
+    for (const auto& params : {kernel_, stride_, pads_, dilation_}) {
+      for (int p : params) {
+        flags = flags * 31 + p;
+      }
+    }
+    std::lock_guard<std::mutex> guard(BenchmarkCacheMutex());
+    algorithm_ = BenchmarkCache().getAlgorithm(
+        X.dims(), filter.dims(), flags, [&]() {
+          auto best = ConvAutoAlgorithm::IM2COL_GEMM;
+          float best_ms = std::numeric_limits<float>::max();
+          for (const auto candidate : candidates) {
+            // One warmup run
+            RunWithAlgorithm(candidate);
+            Timer timer;
+            RunWithAlgorithm(candidate);
+            const float ms = timer.MilliSeconds();
+            if (ms < best_ms) {
+              best = candidate;
+              best_ms = ms;
+            }
+          }
+          return best;
+        });
+    return algorithm_;
+  }
+
+  bool RunWithAlgorithm(ConvAutoAlgorithm algorithm) {
+    switch (algorithm) {
+      case ConvAutoAlgorithm::DIRECT_DEPTHWISE:
+        return RunDepthwise();
+      case ConvAutoAlgorithm::WINOGRAD_F2X3:
+        return RunWinograd();
+      default:
+        return im2col_op_->Run();
+    }
+  }
+
+  const float* BiasData() {
+    return InputSize() == 3 ? Input(BIAS).data<float>() : nullptr;
+  }
+
+  bool RunDepthwise() {
+    const auto& X = Input(INPUT);
+    const auto& filter = Input(FILTER);
+    auto* Y = Output(0);
+    const int N = X.dim32(0), C = X.dim32(1), H = X.dim32(2), W = X.dim32(3);
+    CAFFE_ENFORCE_EQ(filter.ndim(), 4);
+    CAFFE_ENFORCE_EQ(filter.dim32(1), 1);
+    CAFFE_ENFORCE_EQ(filter.dim32(2), kernel_h());
+    CAFFE_ENFORCE_EQ(filter.dim32(3), kernel_w());
+    SetOutputSize(X, Y, C);
+    const int output_h = Y->dim32(2), output_w = Y->dim32(3);
+    const int kh = kernel_h(), kw = kernel_w();
+    const float* X_data = X.data<float>();
+    const float* filter_data = filter.data<float>();
+    const float* bias_data = BiasData();
+    float* Y_data = Y->mutable_data<float>();
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int nc = 0; nc < N * C; ++nc) {
+      const int c = nc % C;
+      const float* x = X_data + static_cast<int64_t>(nc) * H * W;
+      const float* w = filter_data + c * kh * kw;
+      float* y = Y_data + static_cast<int64_t>(nc) * output_h * output_w;
+      const float b = bias_data ? bias_data[c] : 0.0f;
+      for (int oh = 0; oh < output_h; ++oh) {
+        for (int ow = 0; ow < output_w; ++ow) {
+          float sum = b;
+          for (int r = 0; r < kh; ++r) {
+            const int ih = oh * stride_h() - pad_t() + r * dilation_h();
+            if (ih < 0 || ih >= H) {
+              continue;
+            }
+            for (int s = 0; s < kw; ++s) {
+              const int iw = ow * stride_w() - pad_l() + s * dilation_w();
+              if (iw >= 0 && iw < W) {
+                sum += x[ih * W + iw] * w[r * kw + s];
+              }
+            }
+          }
+          y[oh * output_w + ow] = sum;
+        }
+      }
+    }
+    return true;
+  }
+
+  bool RunWinograd() {
+    const auto& X = Input(INPUT);
+    const auto& filter = Input(FILTER);
+    auto* Y = Output(0);
+    const int N = X.dim32(0), C = X.dim32(1), H = X.dim32(2), W = X.dim32(3);
+    const int M = filter.dim32(0);
+    CAFFE_ENFORCE_EQ(filter.ndim(), 4);
+    CAFFE_ENFORCE_EQ(filter.dim32(1), C);
+    CAFFE_ENFORCE_EQ(filter.dim32(2), 3);
+    CAFFE_ENFORCE_EQ(filter.dim32(3), 3);
+    SetOutputSize(X, Y, M);
+    const int output_h = Y->dim32(2), output_w = Y->dim32(3);
+    const int tiles_h = (output_h + 1) / 2, tiles_w = (output_w + 1) / 2;
+    const int T = tiles_h * tiles_w;
+    const float* X_data = X.data<float>();
+    const float* filter_data = filter.data<float>();
+    const float* bias_data = BiasData();
+    float* Y_data = Y->mutable_data<float>();
+
+    // U is [16][M][C], V is [16][C][T] and the products are [16][M][T]
+    transformed_filter_.Resize(16, M, C);
+    transformed_input_.Resize(16, C, T);
+    products_.Resize(16, M, T);
+    float* U = transformed_filter_.mutable_data<float>();
+    float* V = transformed_input_.mutable_data<float>();
+    float* P = products_.mutable_data<float>();
+    // The filter may change between runs (e.g. in training)
+    for (int mc = 0; mc < M * C; ++mc) {
+      WinogradFilterTransform(filter_data + mc * 9, U + mc, M * C);
+    }
+
+    for (int image = 0; image < N; ++image) {
+      const float* x = X_data + static_cast<int64_t>(image) * C * H * W;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for (int c = 0; c < C; ++c) {
+        const float* xc = x + static_cast<int64_t>(c) * H * W;
+        for (int th = 0; th < tiles_h; ++th) {
+          for (int tw = 0; tw < tiles_w; ++tw) {
+            const int ih0 = 2 * th - pad_t(), iw0 = 2 * tw - pad_l();
+            float d[4][4];
+            for (int i = 0; i < 4; ++i) {
+              const int ih = ih0 + i;
+              for (int j = 0; j < 4; ++j) {
+                const int iw = iw0 + j;
+                d[i][j] = (ih >= 0 && ih < H && iw >= 0 && iw < W)
+                    ? xc[ih * W + iw]
+                    : 0.0f;
+              }
+            }
+            WinogradInputTransform(
+                d, V + static_cast<int64_t>(c) * T + th * tiles_w + tw, C * T);
+          }
+        }
+      }
+
+      for (int k = 0; k < 16; ++k) {
+        math::Gemm<float, CPUContext>(
+            CblasNoTrans,
+            CblasNoTrans,
+            M,
+            T,
+            C,
+            1.0f,
+            U + static_cast<int64_t>(k) * M * C,
+            V + static_cast<int64_t>(k) * C * T,
+            0.0f,
+            P + static_cast<int64_t>(k) * M * T,
+            &context_);
+      }
+
+      float* y = Y_data + static_cast<int64_t>(image) * M * output_h * output_w;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for (int m = 0; m < M; ++m) {
+        float* ym = y + static_cast<int64_t>(m) * output_h * output_w;
+        const float b = bias_data ? bias_data[m] : 0.0f;
+        for (int th = 0; th < tiles_h; ++th) {
+          for (int tw = 0; tw < tiles_w; ++tw) {
+            float out[2][2];
+            WinogradOutputTransform(
+                P + static_cast<int64_t>(m) * T + th * tiles_w + tw,
+                M * T,
+                out);
+            for (int i = 0; i < 2 && 2 * th + i < output_h; ++i) {
+              for (int j = 0; j < 2 && 2 * tw + j < output_w; ++j) {
+                ym[(2 * th + i) * output_w + 2 * tw + j] = out[i][j] + b;
+              }
+            }
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  std::unique_ptr<OperatorBase> im2col_op_;
+  ConvAutoAlgorithm algorithm_ = ConvAutoAlgorithm::IM2COL_GEMM;
+  std::vector<int64_t> cached_input_dims_;
+  std::vector<int64_t> cached_filter_dims_;
+  Tensor transformed_filter_{CPU};
+  Tensor transformed_input_{CPU};
+  Tensor products_{CPU};
+
+  INPUT_TAGS(INPUT, FILTER, BIAS);
+};
+
+REGISTER_CPU_OPERATOR_WITH_ENGINE(Conv, AUTO, ConvAutoOp);
+REGISTER_CPU_OPERATOR_WITH_ENGINE(Conv2D, AUTO, ConvAutoOp);
+
+} // namespace caffe2
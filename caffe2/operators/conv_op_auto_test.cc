@@ -0,0 +1,70 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include "caffe2/core/operator.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+
+namespace {
+
+void FillTensor(Workspace* ws, const string& name, vector<int64_t> dims) {
+  auto* tensor = BlobGetMutableTensor(ws->CreateBlob(name), CPU);
+  tensor->Resize(dims);
+  float* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->size(); ++i) {
+    data[i] = std::sin(0.3 * i + name.size());
+  }
+}
+
+// Runs Conv with the default and the AUTO engine and compares the outputs
+void CheckAutoConv(int kernel, int group, const vector<Argument>& args) {
+  Workspace ws;
+  FillTensor(&ws, "X", {2, 16, 9, 7});
+  FillTensor(&ws, "b", {16});
+  FillTensor(&ws, "W", {16, 16 / group, kernel, kernel});
+
+  for (const string engine : {"", "AUTO"}) {
+    OperatorDef def;
+    def.set_type("Conv");
+    def.set_engine(engine);
+    def.add_input("X");
+    def.add_input("W");
+    def.add_input("b");
+    def.add_output(engine.empty() ? "Y_ref" : "Y");
+    def.add_arg()->CopyFrom(MakeArgument<int>("kernel", kernel));
+    def.add_arg()->CopyFrom(MakeArgument<int>("group", group));
+    for (const auto& arg : args) {
+      *def.add_arg() = arg;
+    }
+    unique_ptr<OperatorBase> op(CreateOperator(def, &ws));
+    ASSERT_NE(nullptr, op.get());
+    // The second run uses the cached choice
+    ASSERT_TRUE(op->Run());
+    ASSERT_TRUE(op->Run());
+  }
+
+  const auto& Y = ws.GetBlob("Y")->Get<TensorCPU>();
+  const auto& Y_ref = ws.GetBlob("Y_ref")->Get<TensorCPU>();
+  ASSERT_EQ(Y.dims(), Y_ref.dims());
+  for (int64_t i = 0; i < Y.size(); ++i) {
+    EXPECT_NEAR(Y.data<float>()[i], Y_ref.data<float>()[i], 1e-3);
+  }
+}
+
+} // namespace
+
+TEST(ConvAutoTest, Winograd) {
+  CheckAutoConv(3, 1, {MakeArgument<int>("pad", 1)});
+}
+
+TEST(ConvAutoTest, Depthwise) {
+  CheckAutoConv(
+      3, 16, {MakeArgument<int>("stride", 2), MakeArgument<int>("pad", 1)});
+}
+
+TEST(ConvAutoTest, Im2ColGemm) {
+  CheckAutoConv(1, 1, {});
+}
+
+} // namespace caffe2
@@ -575,8 +575,10 @@ bool CudnnConvOp::DoRunWithType() {
   int group_offset_filter = filter.size() / group_;
 
   // Set up the cudnn algorithms & workspace if necessary
-  bool input_changed = (X.dims() != cudnn_input_dims_);
-  bool filter_changed = (filter.dims() != cudnn_filter_dims_);
+  const bool shapes_changed = InputShapesChanged();
+  bool input_changed = shapes_changed && (X.dims() != cudnn_input_dims_);
+  bool filter_changed =
+      shapes_changed && (filter.dims() != cudnn_filter_dims_);
   if (input_changed || filter_changed) {
     VLOG(1) << "Changing the cudnn descriptor configurations.";
     if (input_changed) {
@@ -931,8 +933,10 @@ bool CudnnConvGradientOp::DoRunWithType() {
   dfilter->ResizeLike(filter);
 
   // Set up the cudnn algorithms & workspace if necessary
-  bool input_changed = (X.dims() != cudnn_input_dims_);
-  bool filter_changed = (filter.dims() != cudnn_filter_dims_);
+  const bool shapes_changed = InputShapesChanged();
+  bool input_changed = shapes_changed && (X.dims() != cudnn_input_dims_);
+  bool filter_changed =
+      shapes_changed && (filter.dims() != cudnn_filter_dims_);
   if (input_changed || filter_changed) {
     VLOG(1) << "Changing the cudnn descriptor configurations.";
     if (input_changed) {
@@ -25,23 +25,29 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNCHW() {
   const int N = X.dim32(0);
   const int C = X.dim32(1);
   const int G = group_;
-  CAFFE_ENFORCE_EQ(X.ndim(), filter.ndim());
   const int M = filter.dim32(0);
-  CAFFE_ENFORCE_EQ(
-      C,
-      filter.dim32(1) * G,
-      "Convolution op: input channels does not match: # of input channels ",
-      C,
-      " is not equal to kernel channels * group: ",
-      filter.dim32(1),
-      "*",
-      G);
-  CAFFE_ENFORCE_EQ(
-      M % G, 0, "The number of output channels is not divisible by group.");
+  // Shapes are only checked when they changed since the last run
+  const bool shapes_changed = InputShapesChanged();
+  if (shapes_changed) {
+    CAFFE_ENFORCE_EQ(X.ndim(), filter.ndim());
+    CAFFE_ENFORCE_EQ(
+        C,
+        filter.dim32(1) * G,
+        "Convolution op: input channels does not match: # of input channels ",
+        C,
+        " is not equal to kernel channels * group: ",
+        filter.dim32(1),
+        "*",
+        G);
+    CAFFE_ENFORCE_EQ(
+        M % G, 0, "The number of output channels is not divisible by group.");
+  }
 
   int kernel_size = 1;
   for (std::size_t i = 0; i < kernel_.size(); ++i) {
-    CAFFE_ENFORCE_EQ(filter.dim32(i + 2), kernel_[i]);
+    if (shapes_changed) {
+      CAFFE_ENFORCE_EQ(filter.dim32(i + 2), kernel_[i]);
+    }
     kernel_size *= kernel_[i];
   }
   ConvPoolOpBase<Context>::SetOutputSize(X, Y, M);
@@ -69,8 +75,10 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNCHW() {
   const T* bias_data = nullptr;
   if (InputSize() == 3) {
     const auto& bias = Input(BIAS);
-    CAFFE_ENFORCE_EQ(bias.ndim(), 1);
-    CAFFE_ENFORCE_EQ(bias.dim32(0), M);
+    if (shapes_changed) {
+      CAFFE_ENFORCE_EQ(bias.ndim(), 1);
+      CAFFE_ENFORCE_EQ(bias.dim32(0), M);
+    }
     bias_data = bias.template data<T>();
     ConvPoolOpBase<Context>::template SetBiasMultiplier<T>(
         Y_HxW, &bias_multiplier_);
@@ -192,14 +200,20 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNHWC() {
   const Tensor& X = Input(INPUT);
   auto& filter = Input(FILTER);
   Tensor* Y = Output(0);
-  CAFFE_ENFORCE_EQ(X.ndim(), 4);
+  // Shapes are only checked when they changed since the last run
+  const bool shapes_changed = InputShapesChanged();
+  if (shapes_changed) {
+    CAFFE_ENFORCE_EQ(X.ndim(), 4);
+    CAFFE_ENFORCE_EQ(X.ndim(), filter.ndim());
+  }
   const int N = X.dim32(0), H = X.dim32(1), W = X.dim32(2), C = X.dim32(3);
 
-  CAFFE_ENFORCE_EQ(X.ndim(), filter.ndim());
   const int M = filter.dim32(0);
-  CAFFE_ENFORCE_EQ(filter.dim32(1), kernel_h());
-  CAFFE_ENFORCE_EQ(filter.dim32(2), kernel_w());
-  CAFFE_ENFORCE_EQ(filter.dim32(3), C / group_);
+  if (shapes_changed) {
+    CAFFE_ENFORCE_EQ(filter.dim32(1), kernel_h());
+    CAFFE_ENFORCE_EQ(filter.dim32(2), kernel_w());
+    CAFFE_ENFORCE_EQ(filter.dim32(3), C / group_);
+  }
 
   ConvPoolOpBase<Context>::SetOutputSize(X, Y, filter.dim32(0));
   // The dimension of each kernel
@@ -218,8 +232,10 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNHWC() {
   T* Y_data = Y->template mutable_data<T>();
   if (InputSize() == 3) {
     const auto& bias = Input(BIAS);
-    CAFFE_ENFORCE_EQ(bias.ndim(), 1);
-    CAFFE_ENFORCE_EQ(bias.dim32(0), M);
+    if (shapes_changed) {
+      CAFFE_ENFORCE_EQ(bias.ndim(), 1);
+      CAFFE_ENFORCE_EQ(bias.dim32(0), M);
+    }
     bias_data = bias.template data<T>();
   }
   // Specialized path for 1 by 1 convolution with stride 1, pad 0 - we
@@ -1,5 +1,8 @@
 #include "caffe2/operators/dataset_ops.h"
 
+#include <atomic>
+#include <cstring>
+#include <exception>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -8,6 +11,7 @@
 #include "caffe2/core/operator.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/utils/string_utils.h"
+#include "caffe2/utils/thread_pool.h"
 
 namespace caffe2 {
 
@@ -450,6 +454,147 @@ class UnPackRecordsOp : public Operator<CPUContext> {
   std::vector<std::string> fields_;
 };
 
+// Rows [offset, offset + size) of a dataset field
+struct RowRange {
+  TOffset offset;
+  TOffset size;
+};
+
+// Appends a range of rows to ranges, merging it with the last one if they are
+// adjacent, so that runs of contiguous rows are gathered with a single copy
+void appendRowRange(std::vector<RowRange>* ranges, TOffset offset, TOffset size) {
+  if (size == 0) {
+    return;
+  }
+  if (!ranges->empty() &&
+      ranges->back().offset + ranges->back().size == offset) {
+    ranges->back().size += size;
+  } else {
+    ranges->push_back({offset, size});
+  }
+}
+
+// The deleter of the outputs that are views of the dataset, which own a
+// reference to its storage
+void deleteDatasetView(void* storage) {
+  delete static_cast<at::Storage*>(storage);
+}
+
+// Gathers ranges of rows of the dataset fields into the outputs of the read
+// ops. The copies of all fields are split into chunks of at most kChunkBytes,
+// which the threads of the op share. With share_data, a field whose rows are a
+// single run is returned as a view of the dataset instead of a copy.
+class BatchGatherer {
+ public:
+  BatchGatherer(int numThreads, bool shareData) : shareData_(shareData) {
+    CAFFE_ENFORCE_GE(numThreads, 1, "num_threads must be positive");
+    if (numThreads > 1) {
+      pool_.reset(new TaskThreadPool(numThreads - 1));
+    }
+  }
+
+  // Resizes out to the rows of ranges of in, and either makes it a view of
+  // them or queues their copy for run()
+  void add(const Tensor& in, const std::vector<RowRange>& ranges, Tensor* out) {
+    auto outDim = in.dims().vec();
+    outDim[0] = 0;
+    for (const auto& range : ranges) {
+      outDim[0] += range.size;
+    }
+    out->Resize(outDim);
+    const auto& meta = in.meta();
+    const size_t rowItems = in.size_from_dim(1);
+    const size_t rowBytes = rowItems * meta.itemsize();
+    if (shareData_ && ranges.size() == 1 && rowBytes > 0) {
+      // the view keeps the storage of the dataset alive
+      auto* src = static_cast<char*>(const_cast<void*>(in.raw_data())) +
+          ranges[0].offset * rowBytes;
+      out->ShareExternalPointer(
+          at::DataPtr(
+              src,
+              new at::Storage(in.storage()),
+              &deleteDatasetView,
+              in.GetDevice()),
+          meta,
+          out->size() * meta.itemsize());
+      return;
+    }
+    if (out->storage().data_ptr().get_deleter() == &deleteDatasetView) {
+      // out is still a view of the dataset from a previous batch
+      out->FreeMemory();
+    }
+    auto* dst = static_cast<char*>(out->raw_mutable_data(meta));
+    if (out->size() == 0) {
+      return;
+    }
+    const auto* src = static_cast<const char*>(in.raw_data());
+    const TOffset chunkRows = std::max<TOffset>(kChunkBytes / rowBytes, 1);
+    for (const auto& range : ranges) {
+      for (TOffset row = 0; row < range.size; row += chunkRows) {
+        const TOffset numRows = std::min(chunkRows, range.size - row);
+        copies_.push_back({meta,
+                           src + (range.offset + row) * rowBytes,
+                           dst,
+                           numRows * rowItems});
+        dst += numRows * rowBytes;
+      }
+    }
+  }
+
+  // Runs the queued copies
+  void run() {
+    const size_t numTasks =
+        std::min<size_t>(pool_ ? pool_->size() + 1 : 1, copies_.size());
+    std::atomic<size_t> next{0};
+    std::vector<std::exception_ptr> errors(numTasks);
+    auto copyTask = [&](size_t task) {
+      try {
+        for (size_t i = next++; i < copies_.size(); i = next++) {
+          // the same as CPUContext::CopyItemsSameDevice, but free of context
+          // state, so that the threads can share it
+          const auto& copy = copies_[i];
+          if (copy.meta.copy()) {
+            copy.meta.copy()(copy.src, copy.dst, copy.numItems);
+          } else {
+            std::memcpy(copy.dst, copy.src, copy.numItems * copy.meta.itemsize());
+          }
+        }
+      } catch (...) {
+        errors[task] = std::current_exception();
+      }
+    };
+    for (size_t task = 1; task < numTasks; ++task) {
+      pool_->run([&copyTask, task]() { copyTask(task); });
+    }
+    if (numTasks > 0) {
+      copyTask(0);
+    }
+    if (numTasks > 1) {
+      pool_->waitWorkComplete();
+    }
+    copies_.clear();
+    for (const auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kChunkBytes = 1 << 20;
+
+  struct Copy {
+    TypeMeta meta;
+    const void* src;
+    void* dst;
+    size_t numItems;
+  };
+
+  bool shareData_;
+  std::unique_ptr<TaskThreadPool> pool_;
+  std::vector<Copy> copies_;
+};
+
 class ReadNextBatchOp : public Operator<CPUContext> {
  public:
   ReadNextBatchOp(const OperatorDef& operator_def, Workspace* ws)
@@ -457,7 +602,10 @@ class ReadNextBatchOp : public Operator<CPUContext> {
         batchSize_(OperatorBase::GetSingleArgument<int>("batch_size", 1)),
         enforceBatchSize_(OperatorBase::GetSingleArgument<bool>(
             "enforce_batch_size",
-            false)) {}
+            false)),
+        gatherer_(
+            OperatorBase::GetSingleArgument<int>("num_threads", 1),
+            OperatorBase::GetSingleArgument<bool>("share_data", false)) {}
 
   bool RunOnDevice() override {
     auto& cursor = OperatorBase::Input<std::unique_ptr<TreeCursor>>(0);
@@ -501,29 +649,20 @@ class ReadNextBatchOp : public Operator<CPUContext> {
       }
     }
     // gather data
-    std::vector<int64_t> outDim;
+    std::vector<std::vector<RowRange>> ranges(sizes.size());
+    for (int i = 0; i < sizes.size(); ++i) {
+      appendRowRange(&ranges[i], offsets[i], sizes[i]);
+    }
     for (int i = 0; i < cursor->it.fields().size(); ++i) {
       auto lengthIdx = cursor->it.fields()[i].lengthFieldId + 1;
-      auto size = sizes[lengthIdx];
-      auto offset = offsets[lengthIdx];
-      auto& in = Input(i + 1);
-      auto innerSize = in.size_from_dim(1);
-      outDim = in.dims().vec();
-      outDim[0] = size;
-      auto* out = Output(i);
-      out->Resize(outDim);
-      void* src =
-          (char*)in.raw_data() + offset * innerSize * in.meta().itemsize();
-      void* dst = out->raw_mutable_data(in.meta()); // create the tensor
-      if (out->size() == 0) {
-        continue;
-      }
-      context_.CopyItemsSameDevice(in.meta(), out->size(), src, dst);
+      gatherer_.add(Input(i + 1), ranges[lengthIdx], Output(i));
     }
+    gatherer_.run();
     return true;
   }
   int batchSize_;
   bool enforceBatchSize_;
+  BatchGatherer gatherer_;
 };
 
 class ComputeOffsetOp : public Operator<CPUContext> {
@@ -667,7 +806,10 @@ class ReadRandomBatchOp : public Operator<CPUContext> {
         batchSize_(OperatorBase::GetSingleArgument<int>("batch_size", 1)),
         enforceBatchSize_(
             OperatorBase::GetSingleArgument<bool>("enforce_batch_size", false)),
-        loopOver_(OperatorBase::GetSingleArgument<bool>("loop_over", false)) {}
+        loopOver_(OperatorBase::GetSingleArgument<bool>("loop_over", false)),
+        gatherer_(
+            OperatorBase::GetSingleArgument<int>("num_threads", 1),
+            OperatorBase::GetSingleArgument<bool>("share_data", false)) {}
   bool RunOnDevice() override {
     auto& cursor = OperatorBase::Input<std::unique_ptr<TreeCursor>>(0);
     auto& idxblob = Input(1);
@@ -675,8 +817,6 @@ class ReadRandomBatchOp : public Operator<CPUContext> {
     CAFFE_ENFORCE(InputSize() == cursor->it.fields().size() + 3);
     auto idxvec = idxblob.template data<int64_t>();
     auto offsetdim = offsetsmat.dims();
-    // gather data
-    std::vector<int64_t> outDim;
     int64_t idx;
     {
       std::lock_guard<std::mutex> lock(cursor->mutex_);
@@ -694,62 +834,41 @@ class ReadRandomBatchOp : public Operator<CPUContext> {
       cursor->offsets.at(0) += batchSize_;
     }
 
+    // the ranges of rows of the batch, per length field, shared by all the
+    // fields of that length
+    std::vector<std::vector<RowRange>> ranges(offsetdim[1]);
+    std::vector<bool> rangesComputed(offsetdim[1], false);
     for (int i = 0; i < cursor->it.fields().size(); ++i) {
       auto lengthIdx = cursor->it.fields()[i].lengthFieldId + 1;
       auto& in = Input(i + 3);
-      outDim = in.dims().vec();
-      outDim.at(0) = 0;
-      auto idxbegin = idx;
-      for (int j = 0; j < batchSize_; ++j) {
-        if (idx >= idxblob.size()) {
-          break;
-        }
-        CAFFE_ENFORCE(
-            (idxvec[idx] + 1) * offsetdim[1] + lengthIdx < offsetsmat.size(),
-            "Out of bound when trying to get elem from offsetsmat");
-        auto offsetptr = offsetsmat.template data<TOffset>() +
-            idxvec[idx] * offsetdim[1] + lengthIdx;
-        auto offset = *offsetptr;
-        auto size = *(offsetptr + offsetdim[1]) - offset;
-        outDim.at(0) += size; // accumulate over the batch
-        idx++;
-      }
-      idx = idxbegin; // reSet
-      auto* out = Output(i);
-      out->Resize(outDim);
-      if (out->size() == 0) {
-        continue;
-      }
-      auto dst = static_cast<char*>(out->raw_mutable_data(in.meta()));
-      int block_size = in.size() / in.dim(0);
-      auto block_bytesize = in.size_from_dim(1) * in.meta().itemsize();
       CAFFE_ENFORCE(
-          block_bytesize == in.nbytes() / in.dim(0),
+          in.dim(0) == 0 ||
+              in.size_from_dim(1) * in.meta().itemsize() ==
+                  in.nbytes() / in.dim(0),
           "block_bytesize should be consistent with data dim");
-      auto src_base = static_cast<const char*>(in.raw_data());
-      int start = 0;
-      for (int j = 0; j < batchSize_; ++j) {
-        if (idx >= idxblob.size()) {
-          break;
+      if (!rangesComputed[lengthIdx]) {
+        for (int64_t j = idx; j < std::min<int64_t>(idx + batchSize_, idxblob.size());
+             ++j) {
+          CAFFE_ENFORCE(
+              (idxvec[j] + 1) * offsetdim[1] + lengthIdx < offsetsmat.size(),
+              "Out of bound when trying to get elem from offsetsmat");
+          auto offsetptr = offsetsmat.template data<TOffset>() +
+              idxvec[j] * offsetdim[1] + lengthIdx;
+          auto offset = *offsetptr;
+          auto size = *(offsetptr + offsetdim[1]) - offset;
+          appendRowRange(&ranges[lengthIdx], offset, size);
         }
-        auto offsetptr = offsetsmat.template data<TOffset>() +
-            idxvec[idx] * offsetdim[1] + lengthIdx;
-        auto offset = *offsetptr;
-        auto size = *(offsetptr + offsetdim[1]) - offset;
-        // copy data
-        auto src = src_base + offset * block_bytesize;
-        context_.CopyItemsSameDevice(
-            in.meta(), size * block_size, src, dst + start * block_bytesize);
-        start += size;
-        idx++;
+        rangesComputed[lengthIdx] = true;
       }
-      idx = idxbegin; // reSet
+      gatherer_.add(in, ranges[lengthIdx], Output(i));
     }
+    gatherer_.run();
     return true;
   }
   int batchSize_;
   bool enforceBatchSize_;
   bool loopOver_;
+  BatchGatherer gatherer_;
 };
 
 template <class Context>
@@ -1131,7 +1250,14 @@ ReadNextBatch is thread safe.
     .Input(0, "cursor", "A blob containing a pointer to the cursor.")
     .Input(1, "dataset_field_0", "First dataset field")
     .Output(0, "field_0", "Tensor containing the next batch for field 0.")
-    .Arg("batch_size", "Number of top-level entries to read.");
+    .Arg("batch_size", "Number of top-level entries to read.")
+    .Arg(
+        "num_threads",
+        "(int, default 1) Number of threads that copy the fields of a batch.")
+    .Arg(
+        "share_data",
+        "(bool, default false) Return every field as a view of the dataset "
+        "instead of a copy. The outputs must then not be modified in place.");
 
 OPERATOR_SCHEMA(GetCursorOffset)
     .NumInputs(1)
@@ -1208,7 +1334,15 @@ ReadRandomBatch is thread safe.
     .Input(3, "dataset_field_0", "First dataset field")
     .Output(0, "field_0", "Tensor containing the next batch for field 0.")
     .Arg("batch_size", "Number of top-level entries to read.")
-    .Arg("loop_over", "(bool) Repeat the dataset indefinitely");
+    .Arg("loop_over", "(bool) Repeat the dataset indefinitely")
+    .Arg(
+        "num_threads",
+        "(int, default 1) Number of threads that copy the fields of a batch.")
+    .Arg(
+        "share_data",
+        "(bool, default false) Return the fields whose rows in the batch are "
+        "contiguous in the dataset as views instead of copies. The outputs "
+        "must then not be modified in place.");
 
 OPERATOR_SCHEMA(CheckDatasetConsistency)
     .NumInputs(1, INT_MAX)
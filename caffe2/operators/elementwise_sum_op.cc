@@ -1,4 +1,5 @@
 #include "caffe2/operators/utility_ops.h"
+#include "caffe2/utils/eigen_utils.h"
 
 namespace caffe2 {
 
@@ -11,9 +12,47 @@ OpSchema::Cost CostInferenceForSum(
   cost.params_bytes = 0;
   return cost;
 }
+
+// Sum followed by Relu, with the relu applied while adding the last input
+class SumReluOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  SumReluOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws) {}
+
+  bool RunOnDevice() override {
+    const auto& X0 = Input(0);
+    auto* Y = Output(0);
+    for (int i = 1; i < InputSize(); ++i) {
+      CAFFE_ENFORCE_EQ(
+          Input(i).dims(), X0.dims(), "Input #", i, " has a different shape");
+    }
+    Y->ResizeLike(X0);
+    const int size = X0.size();
+    float* Y_data = Y->template mutable_data<float>();
+    // Works in-place, since Y only aliases X0
+    const float* sum = X0.data<float>();
+    for (int i = 1; i + 1 < InputSize(); ++i) {
+      math::Add(size, sum, Input(i).data<float>(), Y_data, &context_);
+      sum = Y_data;
+    }
+    EigenVectorArrayMap<float> Y_arr(Y_data, size);
+    if (InputSize() == 1) {
+      Y_arr = ConstEigenVectorArrayMap<float>(sum, size).cwiseMax(0.0f);
+    } else {
+      Y_arr = (ConstEigenVectorArrayMap<float>(sum, size) +
+               ConstEigenVectorArrayMap<float>(
+                   Input(InputSize() - 1).data<float>(), size))
+                  .cwiseMax(0.0f);
+    }
+    return true;
+  }
+};
+
 } // namespace
 
 REGISTER_CPU_OPERATOR(Sum, SumOp<CPUContext>);
+REGISTER_CPU_OPERATOR(SumRelu, SumReluOp);
 
 OPERATOR_SCHEMA(Sum)
     .NumInputs(1, INT_MAX)
@@ -124,4 +163,19 @@ A after Sum: [[10.  7. 11.]
         "*(type: Tensor`<float>`)* Second tensor to be added element-wise.")
     .Output(0, "C", "*(type: Tensor`<float>`)* Sum of A and B.")
     .InheritOnnxSchema();
+
+OPERATOR_SCHEMA(SumRelu)
+    .NumInputs(1, INT_MAX)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}})
+    .CostInferenceFunction(CostInferenceForSum)
+    .IdenticalTypeAndShapeOfInput(0)
+    .SetDoc(R"DOC(
+Same as Sum followed by Relu, for float tensors, without a separate pass over
+the output for the relu. The FuseFCAndSumActivation pass replaces Sum and Relu
+ops with it in inference nets.
+)DOC")
+    .Input(0, "A", "*(type: Tensor`<float>`)* First tensor to be added.")
+    .Output(0, "C", "*(type: Tensor`<float>`)* Relu of the sum.");
+NO_GRADIENT(SumRelu);
 }
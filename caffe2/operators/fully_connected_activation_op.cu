@@ -0,0 +1,57 @@
+#include "caffe2/core/context_gpu.h"
+#include "caffe2/operators/fully_connected_op.h"
+#include "caffe2/utils/conversions.h"
+
+namespace caffe2 {
+
+namespace {
+
+template <typename T>
+__global__ void FCAddBiasAndActivationCUDAKernel(
+    const int size,
+    const int N,
+    const FCActivation activation,
+    const T* b,
+    T* Y) {
+  CUDA_1D_KERNEL_LOOP(i, size) {
+    float y = convert::To<T, float>(Y[i]) + convert::To<T, float>(b[i % N]);
+    switch (activation) {
+      case FCActivation::RELU:
+        y = fmaxf(y, 0.0f);
+        break;
+      case FCActivation::SIGMOID:
+        y = 1.0f / (1.0f + expf(-y));
+        break;
+      case FCActivation::TANH:
+        y = tanhf(y);
+        break;
+      default:
+        break;
+    }
+    Y[i] = convert::To<float, T>(y);
+  }
+}
+
+} // namespace
+
+#define CAFFE2_SPECIALIZED_CUDA_FC_ADD_BIAS_AND_ACTIVATION(T)              \
+  template <>                                                            \
+  void FCAddBiasAndActivation<T, CUDAContext>(                           \
+      FCActivation activation,                                           \
+      int M,                                                             \
+      int N,                                                             \
+      const T* b,                                                        \
+      T* Y,                                                              \
+      CUDAContext* context) {                                            \
+    const int size = M * N;                                              \
+    FCAddBiasAndActivationCUDAKernel<T>                                  \
+        <<<CAFFE_GET_BLOCKS(size),                                       \
+           CAFFE_CUDA_NUM_THREADS,                                       \
+           0,                                                            \
+           context->cuda_stream()>>>(size, N, activation, b, Y);         \
+  }
+CAFFE2_SPECIALIZED_CUDA_FC_ADD_BIAS_AND_ACTIVATION(float)
+CAFFE2_SPECIALIZED_CUDA_FC_ADD_BIAS_AND_ACTIVATION(at::Half)
+#undef CAFFE2_SPECIALIZED_CUDA_FC_ADD_BIAS_AND_ACTIVATION
+
+} // namespace caffe2
@@ -1,9 +1,36 @@
 #include <functional>
 
 #include "caffe2/operators/fully_connected_op.h"
+#include "caffe2/utils/eigen_utils.h"
 
 namespace caffe2 {
 
+template <>
+void FCAddBiasAndActivation<float, CPUContext>(
+    FCActivation activation,
+    int M,
+    int N,
+    const float* b,
+    float* Y,
+    CPUContext* /* context */) {
+  // The columns of Y_arr are the rows of Y
+  EigenArrayMap<float> Y_arr(Y, N, M);
+  ConstEigenVectorArrayMap<float> b_arr(b, N);
+  switch (activation) {
+    case FCActivation::RELU:
+      Y_arr = (Y_arr.colwise() + b_arr).cwiseMax(0.0f);
+      break;
+    case FCActivation::SIGMOID:
+      Y_arr = ((-(Y_arr.colwise() + b_arr)).exp() + 1.0f).inverse();
+      break;
+    case FCActivation::TANH:
+      Y_arr = (Y_arr.colwise() + b_arr).tanh();
+      break;
+    default:
+      Y_arr.colwise() += b_arr;
+  }
+}
+
 REGISTER_CPU_OPERATOR(FC, FullyConnectedOp<CPUContext>);
 REGISTER_CPU_OPERATOR(FCGradient, FullyConnectedGradientOp<CPUContext>);
 
@@ -20,6 +47,16 @@ REGISTER_CPU_OPERATOR(
         DefaultEngine,
         false /* don't transpose weight */>);
 
+REGISTER_CPU_OPERATOR(
+    FCRelu,
+    FullyConnectedOp<CPUContext, DefaultEngine, true, FCActivation::RELU>);
+REGISTER_CPU_OPERATOR(
+    FCSigmoid,
+    FullyConnectedOp<CPUContext, DefaultEngine, true, FCActivation::SIGMOID>);
+REGISTER_CPU_OPERATOR(
+    FCTanh,
+    FullyConnectedOp<CPUContext, DefaultEngine, true, FCActivation::TANH>);
+
 namespace {
 std::vector<TensorShape> FCShapeInference(
     const OperatorDef& def,
@@ -255,6 +292,31 @@ Y:
         "Ouput blob containing a 2D output matrix of shape $(M,N)$, where $M$ is the batch size and $N$ is the number of nodes in the layer. The ouput is calculated as $Y=XW^T+b$.")
     .InheritOnnxSchema("Gemm");
 
+#define FC_ACTIVATION_SCHEMA(name, activation)                                \
+  OPERATOR_SCHEMA(name)                                                       \
+      .NumInputs(3)                                                           \
+      .NumOutputs(1)                                                          \
+      .TensorInferenceFunction(std::bind(FCShapeInference, _1, _2, false))    \
+      .CostInferenceFunction(std::bind(CostInferenceForFC, _1, _2, false))    \
+      .SetDoc(                                                                \
+          "Same as FC followed by " activation ", with the bias and the "     \
+          "activation applied in a single pass over the output. The "         \
+          "FuseFCAndSumActivation pass replaces FC and " activation " ops "   \
+          "with it in inference nets.")                                       \
+      .Arg("axis", "*(type: int; default: 1)* Same as in FC")                 \
+      .Arg("axis_w", "*(type: int; default: 1)* Same as in FC")               \
+      .Input(0, "X", "Input of shape $(M,K)$, after coercion")                \
+      .Input(1, "W", "Weights of shape $(N,K)$, after coercion")              \
+      .Input(2, "b", "Bias of length $N$")                                    \
+      .Output(0, "Y", "Output of shape $(M,N)$");                             \
+  NO_GRADIENT(name);
+
+FC_ACTIVATION_SCHEMA(FCRelu, "Relu")
+FC_ACTIVATION_SCHEMA(FCSigmoid, "Sigmoid")
+FC_ACTIVATION_SCHEMA(FCTanh, "Tanh")
+
+#undef FC_ACTIVATION_SCHEMA
+
 OPERATOR_SCHEMA(FCGradient)
     .NumInputs(3)
     .NumOutputs(2, 3)
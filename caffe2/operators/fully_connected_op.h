@@ -1,6 +1,8 @@
 #ifndef CAFFE2_OPERATORS_FULLY_CONNECTED_OP_H_
 #define CAFFE2_OPERATORS_FULLY_CONNECTED_OP_H_
 
+#include <type_traits>
+
 #include "caffe2/core/context.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/utils/conversions.h"
@@ -8,11 +10,25 @@
 
 namespace caffe2 {
 
+// Activations that FCRelu, FCSigmoid and FCTanh apply with the bias
+enum class FCActivation { NONE, RELU, SIGMOID, TANH };
+
+// Y = activation(Y + b) for the M x N matrix Y, in a single pass over Y
+template <typename T, class Context>
+void FCAddBiasAndActivation(
+    FCActivation activation,
+    int M,
+    int N,
+    const T* b,
+    T* Y,
+    Context* context);
+
 // This is Caffe's InnerProductOp, with a name that fits its purpose better.
 template <
     class Context,
     class Engine = DefaultEngine,
-    bool TransposeWeight = true>
+    bool TransposeWeight = true,
+    FCActivation Activation = FCActivation::NONE>
 class FullyConnectedOp final : public Operator<Context> {
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
@@ -103,6 +119,15 @@ class FullyConnectedOp final : public Operator<Context> {
         Y->template mutable_data<T_Y>(),
         &context_,
         math_type);
+    if (Activation != FCActivation::NONE) {
+      AddBiasAndActivation(
+          std::integral_constant<bool, Activation != FCActivation::NONE>(),
+          M,
+          N,
+          b.template data<T_B>(),
+          Y->template mutable_data<T_Y>());
+      return true;
+    }
     // Add bias term
     if (bias_multiplier_.size() != M) {
       // If the helper bias multiplier is not M, reshape and fill it with one.
@@ -139,6 +164,20 @@ class FullyConnectedOp final : public Operator<Context> {
   }
 
  protected:
+  // Only instantiated for the fused ops, the only ones that need
+  // FCAddBiasAndActivation for the types they run with
+  template <typename T>
+  void AddBiasAndActivation(
+      std::true_type /* fused */,
+      int M,
+      int N,
+      const T* b,
+      T* Y) {
+    FCAddBiasAndActivation<T, Context>(Activation, M, N, b, Y, &context_);
+  }
+  template <typename T>
+  void AddBiasAndActivation(std::false_type, int, int, const T*, T*) {}
+
   size_t axis_{1};
   size_t axis_w_{1};
   // A local vector to cache the output shape so we don't need to recreate
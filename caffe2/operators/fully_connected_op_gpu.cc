@@ -127,6 +127,33 @@ bool FullyConnectedOp<
   return RunFullyConnectedOpOnCUDADevice(float16_compute_, this);
 }
 
+template <>
+bool FullyConnectedOp<
+    CUDAContext,
+    DefaultEngine,
+    true,
+    FCActivation::RELU>::RunOnDevice() {
+  return RunFullyConnectedOpOnCUDADevice(float16_compute_, this);
+}
+
+template <>
+bool FullyConnectedOp<
+    CUDAContext,
+    DefaultEngine,
+    true,
+    FCActivation::SIGMOID>::RunOnDevice() {
+  return RunFullyConnectedOpOnCUDADevice(float16_compute_, this);
+}
+
+template <>
+bool FullyConnectedOp<
+    CUDAContext,
+    DefaultEngine,
+    true,
+    FCActivation::TANH>::RunOnDevice() {
+  return RunFullyConnectedOpOnCUDADevice(float16_compute_, this);
+}
+
 template <>
 bool FullyConnectedGradientOp<CUDAContext>::RunOnDevice() {
   return RunFullyConnectedGradientOpOnCUDADevice(float16_compute_, this);
@@ -192,6 +219,16 @@ REGISTER_CUDA_OPERATOR(
         DefaultEngine,
         false /* don't transpose weight */>);
 
+REGISTER_CUDA_OPERATOR(
+    FCRelu,
+    FullyConnectedOp<CUDAContext, DefaultEngine, true, FCActivation::RELU>);
+REGISTER_CUDA_OPERATOR(
+    FCSigmoid,
+    FullyConnectedOp<CUDAContext, DefaultEngine, true, FCActivation::SIGMOID>);
+REGISTER_CUDA_OPERATOR(
+    FCTanh,
+    FullyConnectedOp<CUDAContext, DefaultEngine, true, FCActivation::TANH>);
+
 #if CUDA_VERSION >= 9000
 REGISTER_CUDA_OPERATOR_WITH_ENGINE(
     FC,
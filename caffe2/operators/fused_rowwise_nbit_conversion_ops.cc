@@ -0,0 +1,158 @@
+#include "caffe2/operators/fused_rowwise_nbit_conversion_ops.h"
+#include <fp16.h>
+#include "c10/util/Registry.h"
+
+namespace caffe2 {
+
+namespace {
+void convertfp32fp32(float* dst, const float* src, size_t N) {
+  memcpy(dst, src, sizeof(float) * N);
+}
+
+void convertfp16fp32(float* dst, const at::Half* src, size_t N) {
+  for (size_t i = 0; i < N; i++) {
+    dst[i] = fp16_ieee_to_fp32_value(src[i].x);
+  }
+}
+
+void convertfp32fp16(at::Half* dst, const float* src, size_t N) {
+  for (size_t i = 0; i < N; i++) {
+    uint16_t out = fp16_ieee_from_fp32_value(src[i]);
+    memcpy(dst + i, &out, sizeof(uint16_t));
+  }
+}
+
+// Shapes of the fused representation of rows of `columns` values
+std::vector<TensorShape> FusedNBitOutputShape(
+    const vector<TensorShape>& in,
+    int bit_rate) {
+  vector<TensorShape> out;
+  TensorShape X = in[0];
+  X.set_dims(
+      1,
+      FusedNBitRowwiseBlockBytes(bit_rate, X.dims(1)) + 2 * sizeof(at::Half));
+  out.push_back(std::move(X));
+  out[0].set_data_type(TensorProto_DataType_UINT8);
+  return out;
+}
+
+std::vector<TensorShape> FusedNBitInputShape(
+    const vector<TensorShape>& in,
+    int bit_rate,
+    TensorProto_DataType data_type) {
+  vector<TensorShape> out;
+  TensorShape X = in[0];
+  X.set_dims(1, (X.dims(1) - 2 * sizeof(at::Half)) * (8 / bit_rate));
+  out.push_back(std::move(X));
+  out[0].set_data_type(data_type);
+  return out;
+}
+} // namespace
+
+#define REGISTER_FUSED_NBIT_ROWWISE_CONVERSION_OPS(BIT_RATE)                   \
+  REGISTER_CPU_OPERATOR(                                                       \
+      FloatToFused##BIT_RATE##BitRowwiseQuantized,                             \
+      FloatToFusedNBitRowwiseQuantizedOp<                                      \
+          BIT_RATE,                                                            \
+          float,                                                               \
+          convertfp32fp32,                                                     \
+          CPUContext>);                                                        \
+  OPERATOR_SCHEMA(FloatToFused##BIT_RATE##BitRowwiseQuantized)                 \
+      .NumInputs(1)                                                            \
+      .NumOutputs(1)                                                           \
+      .TensorInferenceFunction([](const OperatorDef& /* def */,                \
+                                  const vector<TensorShape>& in) {             \
+        return FusedNBitOutputShape(in, BIT_RATE);                             \
+      })                                                                       \
+      .SetDoc(                                                                 \
+          "Applies " #BIT_RATE "-bit row-wise quantization by determining "    \
+          "the range (maximum - minimum) and offset (minimum value) of each "  \
+          "row in the input matrix, and then scaling each element to a "       \
+          #BIT_RATE "-bit number. The values of a row are packed into bytes, " \
+          "starting from the lowest bits, and followed by the scale and the "  \
+          "bias as 2-byte half floats.")                                       \
+      .Input(0, "input", "Float32 input data")                                 \
+      .Output(0, "output", "Fused scale, bias and quantized data");            \
+  NO_GRADIENT(FloatToFused##BIT_RATE##BitRowwiseQuantized);                    \
+                                                                               \
+  REGISTER_CPU_OPERATOR(                                                       \
+      HalfFloatToFused##BIT_RATE##BitRowwiseQuantized,                         \
+      FloatToFusedNBitRowwiseQuantizedOp<                                      \
+          BIT_RATE,                                                            \
+          at::Half,                                                            \
+          convertfp16fp32,                                                     \
+          CPUContext>);                                                        \
+  OPERATOR_SCHEMA(HalfFloatToFused##BIT_RATE##BitRowwiseQuantized)             \
+      .NumInputs(1)                                                            \
+      .NumOutputs(1)                                                           \
+      .TensorInferenceFunction([](const OperatorDef& /* def */,                \
+                                  const vector<TensorShape>& in) {             \
+        return FusedNBitOutputShape(in, BIT_RATE);                             \
+      })                                                                       \
+      .SetDoc(                                                                 \
+          "Same as FloatToFused" #BIT_RATE "BitRowwiseQuantized, for float16 " \
+          "input data.")                                                       \
+      .Input(0, "input", "Float16 input data")                                 \
+      .Output(0, "output", "Fused scale, bias and quantized data");            \
+  NO_GRADIENT(HalfFloatToFused##BIT_RATE##BitRowwiseQuantized);                \
+                                                                               \
+  REGISTER_CPU_OPERATOR(                                                       \
+      Fused##BIT_RATE##BitRowwiseQuantizedToFloat,                             \
+      FusedNBitRowwiseQuantizedToFloatOp<                                      \
+          BIT_RATE,                                                            \
+          float,                                                               \
+          convertfp32fp32,                                                     \
+          CPUContext>);                                                        \
+  OPERATOR_SCHEMA(Fused##BIT_RATE##BitRowwiseQuantizedToFloat)                 \
+      .NumInputs(1)                                                            \
+      .NumOutputs(1)                                                           \
+      .TensorInferenceFunction([](const OperatorDef& /* def */,                \
+                                  const vector<TensorShape>& in) {             \
+        return FusedNBitInputShape(                                            \
+            in, BIT_RATE, TensorProto_DataType_FLOAT);                         \
+      })                                                                       \
+      .SetDoc(                                                                 \
+          "De-quantizes the result of the FloatToFused" #BIT_RATE              \
+          "BitRowwiseQuantized operator. The number of columns of the "        \
+          "output is the number of values that the packed bytes of a row "     \
+          "hold, which is rounded up to a multiple of 8 / " #BIT_RATE          \
+          ". De-quantized values are not exactly equal to the original, "      \
+          "un-quantized floating point values.")                               \
+      .Input(                                                                  \
+          0,                                                                   \
+          "scale_bias_quantized_input",                                        \
+          "Fused scale, bias and quantized data")                              \
+      .Output(0, "float_output", "Float32 data");                              \
+  NO_GRADIENT(Fused##BIT_RATE##BitRowwiseQuantizedToFloat);                    \
+                                                                               \
+  REGISTER_CPU_OPERATOR(                                                       \
+      Fused##BIT_RATE##BitRowwiseQuantizedToHalfFloat,                         \
+      FusedNBitRowwiseQuantizedToFloatOp<                                      \
+          BIT_RATE,                                                            \
+          at::Half,                                                            \
+          convertfp32fp16,                                                     \
+          CPUContext>);                                                        \
+  OPERATOR_SCHEMA(Fused##BIT_RATE##BitRowwiseQuantizedToHalfFloat)             \
+      .NumInputs(1)                                                            \
+      .NumOutputs(1)                                                           \
+      .TensorInferenceFunction([](const OperatorDef& /* def */,                \
+                                  const vector<TensorShape>& in) {             \
+        return FusedNBitInputShape(                                            \
+            in, BIT_RATE, TensorProto_DataType_FLOAT16);                       \
+      })                                                                       \
+      .SetDoc(                                                                 \
+          "Same as Fused" #BIT_RATE "BitRowwiseQuantizedToFloat, with "        \
+          "float16 output data.")                                              \
+      .Input(                                                                  \
+          0,                                                                   \
+          "scale_bias_quantized_input",                                        \
+          "Fused scale, bias and quantized data")                              \
+      .Output(0, "float16_output", "Float16 data");                            \
+  NO_GRADIENT(Fused##BIT_RATE##BitRowwiseQuantizedToHalfFloat);
+
+REGISTER_FUSED_NBIT_ROWWISE_CONVERSION_OPS(4)
+REGISTER_FUSED_NBIT_ROWWISE_CONVERSION_OPS(2)
+
+#undef REGISTER_FUSED_NBIT_ROWWISE_CONVERSION_OPS
+
+} // namespace caffe2
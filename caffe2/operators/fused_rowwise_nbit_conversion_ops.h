@@ -0,0 +1,174 @@
+#ifndef CAFFE2_OPERATORS_FUSED_ROWWISE_NBIT_CONVERSION_OPS_H_
+#define CAFFE2_OPERATORS_FUSED_ROWWISE_NBIT_CONVERSION_OPS_H_
+
+#include <algorithm>
+#include <cmath>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/perfkernels/fused_nbit_rowwise_embedding_lookup.h"
+
+namespace caffe2 {
+
+#define IS_LITTLE_ENDIAN                                      \
+  [] {                                                        \
+    const int32_t kValue = 1;                                 \
+    return reinterpret_cast<const uint8_t*>(&kValue)[0] == 1; \
+  }()
+
+// The "fused" representation stores the scale and bias with the row-wise
+// quantized data in one tensor. The values of a row are packed into bytes,
+// 8 / BIT_RATE values per byte starting from the lowest bits, and the scale
+// and bias are half floats in the last 4 bytes of the row.
+// | ... packed data ... | scale | bias |
+// |    packed bytes     |  2B   |  2B  |
+template <
+    int BIT_RATE,
+    typename T,
+    void (*convert)(float* dst, const T* src, size_t N),
+    class Context>
+class FloatToFusedNBitRowwiseQuantizedOp : public Operator<Context> {
+ public:
+  static_assert(BIT_RATE == 2 || BIT_RATE == 4, "Unsupported bit rate");
+
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  USE_SIMPLE_CTOR_DTOR(FloatToFusedNBitRowwiseQuantizedOp)
+
+  bool RunOnDevice() override {
+    CAFFE_ENFORCE(IS_LITTLE_ENDIAN, "Unsupported endianness");
+
+    const auto& input = Input(DATA_FLOAT);
+    auto* output = Output(DATA_FUSED_SCALE_BIAS);
+
+    CAFFE_ENFORCE_EQ(input.ndim(), 2, "Expect input to be a matrix");
+    const auto input_rows = input.dim(0);
+    const auto input_columns = input.dim(1);
+
+    const int64_t block_bytes =
+        FusedNBitRowwiseBlockBytes(BIT_RATE, input_columns);
+    const std::vector<int64_t> output_dimensions = {
+        input_rows, block_bytes + 2 * static_cast<int64_t>(sizeof(at::Half))};
+    output->Resize(output_dimensions);
+
+    const auto* input_data = input.template data<T>();
+    auto* output_data = output->template mutable_data<uint8_t>();
+    const auto output_columns = output->dim(1);
+    constexpr int kNumElemPerByte = 8 / BIT_RATE;
+    constexpr int kMaxQuantized = (1 << BIT_RATE) - 1;
+
+    std::vector<float> tmp(input_columns);
+    for (int64_t row = 0; row < input_rows; ++row) {
+      convert(tmp.data(), input_data + row * input_columns, input_columns);
+      uint8_t* output_row = output_data + row * output_columns;
+      at::Half* output_row_scale_bias =
+          reinterpret_cast<at::Half*>(output_row + block_bytes);
+
+      float minimum_element = 0;
+      float maximum_element = 0;
+      if (input_columns > 0) {
+        const auto minmax = std::minmax_element(tmp.begin(), tmp.end());
+        minimum_element = *minmax.first;
+        maximum_element = *minmax.second;
+      }
+      // The bias is rounded to half first, so that the range covers the
+      // values with the bias that is stored
+      minimum_element = at::Half(minimum_element);
+      const float range = maximum_element - minimum_element;
+      float scale = at::Half(range == 0 ? 1.0f : range / kMaxQuantized);
+      if (scale == 0) {
+        // Underflow of the half scale, all values are quantized to 0
+        scale = 1.0f;
+      }
+      const float inverse_scale = 1.0f / scale;
+      output_row_scale_bias[0] = at::Half(scale);
+      output_row_scale_bias[1] = at::Half(minimum_element);
+
+      memset(output_row, 0, block_bytes);
+      for (int64_t col = 0; col < input_columns; ++col) {
+        const float quantized = std::max(
+            0.0f,
+            std::min<float>(
+                std::nearbyint((tmp[col] - minimum_element) * inverse_scale),
+                kMaxQuantized));
+        output_row[col / kNumElemPerByte] |= static_cast<uint8_t>(quantized)
+            << ((col % kNumElemPerByte) * BIT_RATE);
+      }
+    }
+
+    return true;
+  }
+
+ private:
+  INPUT_TAGS(DATA_FLOAT);
+  OUTPUT_TAGS(DATA_FUSED_SCALE_BIAS);
+};
+
+template <
+    int BIT_RATE,
+    typename T,
+    void (*convert)(T* dst, const float* src, size_t N),
+    class Context>
+class FusedNBitRowwiseQuantizedToFloatOp : public Operator<Context> {
+ public:
+  static_assert(BIT_RATE == 2 || BIT_RATE == 4, "Unsupported bit rate");
+
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  USE_SIMPLE_CTOR_DTOR(FusedNBitRowwiseQuantizedToFloatOp)
+
+  bool RunOnDevice() override {
+    CAFFE_ENFORCE(IS_LITTLE_ENDIAN, "Unsupported endianness");
+
+    const auto& input = Input(DATA_FUSED_SCALE_BIAS);
+    auto* output = Output(DATA_FLOAT);
+
+    CAFFE_ENFORCE_EQ(input.ndim(), 2, "Expect input to be a matrix");
+    const auto input_rows = input.dim(0);
+    const auto input_columns = input.dim(1);
+    CAFFE_ENFORCE_GT(
+        input_columns,
+        2 * sizeof(at::Half),
+        "DATA must have more than 4 columns");
+
+    // The last 4 bytes per row are the scale and the bias, and every other
+    // byte holds 8 / BIT_RATE values
+    constexpr int kNumElemPerByte = 8 / BIT_RATE;
+    const int64_t block_bytes = input_columns - 2 * sizeof(at::Half);
+    const std::vector<int64_t> output_dimensions = {
+        input_rows, block_bytes * kNumElemPerByte};
+    output->Resize(output_dimensions);
+    const auto output_columns = output->dim(1);
+
+    const auto* input_data = input.template data<uint8_t>();
+    T* output_data = output->template mutable_data<T>();
+
+    std::vector<float> tmp(output_columns);
+    for (int64_t row = 0; row < input_rows; ++row) {
+      const uint8_t* input_row = input_data + row * input_columns;
+      const at::Half* input_row_scale_bias =
+          reinterpret_cast<const at::Half*>(input_row + block_bytes);
+      const float scale = input_row_scale_bias[0];
+      const float bias = input_row_scale_bias[1];
+
+      for (int64_t col = 0; col < output_columns; ++col) {
+        const uint8_t quantized = (input_row[col / kNumElemPerByte] >>
+                                   ((col % kNumElemPerByte) * BIT_RATE)) &
+            ((1 << BIT_RATE) - 1);
+        tmp[col] = scale * quantized + bias;
+      }
+
+      convert(output_data + row * output_columns, tmp.data(), output_columns);
+    }
+    return true;
+  }
+
+ private:
+  INPUT_TAGS(DATA_FUSED_SCALE_BIAS);
+  OUTPUT_TAGS(DATA_FLOAT);
+};
+
+#undef IS_LITTLE_ENDIAN
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_FUSED_ROWWISE_NBIT_CONVERSION_OPS_H_
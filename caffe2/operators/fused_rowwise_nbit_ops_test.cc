@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include "caffe2/core/operator.h"
+
+namespace caffe2 {
+
+namespace {
+
+void RunOp(
+    const string& type,
+    const vector<string>& inputs,
+    const string& output,
+    Workspace* ws) {
+  OperatorDef def;
+  def.set_type(type);
+  for (const auto& input : inputs) {
+    def.add_input(input);
+  }
+  def.add_output(output);
+  unique_ptr<OperatorBase> op(CreateOperator(def, ws));
+  ASSERT_NE(nullptr, op.get());
+  ASSERT_TRUE(op->Run());
+}
+
+const TensorCPU& Get(Workspace* ws, const string& name) {
+  return ws->GetBlob(name)->Get<TensorCPU>();
+}
+
+void CheckQuantizedSum(int bit_rate) {
+  const int64_t kRows = 5;
+  const int64_t kColumns = 24;
+  Workspace ws;
+  auto* data = BlobGetMutableTensor(ws.CreateBlob("data"), CPU);
+  data->Resize(kRows, kColumns);
+  for (int64_t i = 0; i < data->size(); ++i) {
+    data->mutable_data<float>()[i] = std::sin(i) * (i % kRows + 1);
+  }
+  auto* indices = BlobGetMutableTensor(ws.CreateBlob("indices"), CPU);
+  indices->Resize(5);
+  for (int i = 0; i < 5; ++i) {
+    indices->mutable_data<int64_t>()[i] = (3 * i + 1) % kRows;
+  }
+  auto* lengths = BlobGetMutableTensor(ws.CreateBlob("lengths"), CPU);
+  lengths->Resize(2);
+  lengths->mutable_data<int>()[0] = 2;
+  lengths->mutable_data<int>()[1] = 3;
+
+  const string bits = to_string(bit_rate);
+  RunOp(
+      "FloatToFused" + bits + "BitRowwiseQuantized",
+      {"data"},
+      "quantized",
+      &ws);
+  EXPECT_EQ(Get(&ws, "quantized").dim(1), kColumns * bit_rate / 8 + 4);
+  RunOp(
+      "Fused" + bits + "BitRowwiseQuantizedToFloat",
+      {"quantized"},
+      "dequantized",
+      &ws);
+
+  // Every value is within half a quantization step of the original
+  const auto& dequantized = Get(&ws, "dequantized");
+  ASSERT_EQ(dequantized.dims(), data->dims());
+  for (int64_t row = 0; row < kRows; ++row) {
+    const float* values = data->data<float>() + row * kColumns;
+    const auto minmax = std::minmax_element(values, values + kColumns);
+    const float step =
+        (*minmax.second - *minmax.first) / ((1 << bit_rate) - 1);
+    for (int64_t col = 0; col < kColumns; ++col) {
+      EXPECT_NEAR(
+          dequantized.data<float>()[row * kColumns + col],
+          values[col],
+          step / 2 + 1e-2);
+    }
+  }
+
+  // The lookup sums the dequantized rows
+  RunOp(
+      "SparseLengthsSumFused" + bits + "BitRowwise",
+      {"quantized", "indices", "lengths"},
+      "sum",
+      &ws);
+  RunOp("SparseLengthsSum", {"dequantized", "indices", "lengths"}, "ref", &ws);
+  const auto& sum = Get(&ws, "sum");
+  const auto& ref = Get(&ws, "ref");
+  ASSERT_EQ(sum.dims(), ref.dims());
+  for (int64_t i = 0; i < sum.size(); ++i) {
+    EXPECT_NEAR(sum.data<float>()[i], ref.data<float>()[i], 1e-4);
+  }
+}
+
+} // namespace
+
+TEST(FusedNBitRowwiseTest, Quantizes4Bit) {
+  CheckQuantizedSum(4);
+}
+
+TEST(FusedNBitRowwiseTest, Quantizes2Bit) {
+  CheckQuantizedSum(2);
+}
+
+} // namespace caffe2
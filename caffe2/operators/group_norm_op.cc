@@ -8,10 +8,19 @@
 
 #include "group_norm_op.h"
 
+#include <cmath>
+#include <vector>
+
+#include "caffe2/utils/math_utils.h"
+
 namespace caffe2 {
 
 namespace {
 
+// Groups are processed in parallel when the input has at least this many
+// values
+constexpr int64_t kGroupNormParallelGrain = 1 << 15;
+
 template <typename T, StorageOrder kOrder>
 void ComputeInternalGradients(
     const std::array<int, 4>& dims,
@@ -76,8 +85,165 @@ void GroupNormBackward(
   }
 }
 
+// Same as GroupNormBackward for NCHW, where every channel of an image is
+// contiguous: the sums over the HxW values of every channel are reduced
+// first, then every group of an image gives dX with a single pass.
+template <typename T>
+void GroupNormBackwardNCHW(
+    const int N,
+    const int G,
+    const int D,
+    const int HxW,
+    const T* dY,
+    const T* X,
+    const T* mu,
+    const T* rsig,
+    const T* gamma,
+    T* dX,
+    T* dgamma,
+    T* dbeta) {
+  const int C = G * D;
+  const bool parallel =
+      static_cast<int64_t>(N) * C * HxW >= kGroupNormParallelGrain;
+  // Sum(dL/dY) and Sum(dL/dY * X) of every channel of every image
+  std::vector<T> dy_sum(N * C);
+  std::vector<T> dy_x_sum(N * C);
+#ifdef _OPENMP
+#pragma omp parallel for if (parallel)
+#endif
+  for (int i = 0; i < N * C; ++i) {
+    const T* dY_ptr = dY + static_cast<int64_t>(i) * HxW;
+    const T* X_ptr = X + static_cast<int64_t>(i) * HxW;
+    T dy = 0;
+    T dy_x = 0;
+    for (int j = 0; j < HxW; ++j) {
+      dy += dY_ptr[j];
+      dy_x += dY_ptr[j] * X_ptr[j];
+    }
+    dy_sum[i] = dy;
+    dy_x_sum[i] = dy_x;
+  }
+
+  for (int c = 0; c < C; ++c) {
+    T dg = 0;
+    T db = 0;
+    for (int n = 0; n < N; ++n) {
+      const int i_mu = n * G + c / D;
+      dg += (dy_x_sum[n * C + c] - mu[i_mu] * dy_sum[n * C + c]) * rsig[i_mu];
+      db += dy_sum[n * C + c];
+    }
+    dgamma[c] = dg;
+    dbeta[c] = db;
+  }
+
+  // dL/dX = gamma * rsig * dL/dY + c1 * X + c2
+  const T denom = T(1) / static_cast<T>(D * HxW);
+#ifdef _OPENMP
+#pragma omp parallel for if (parallel)
+#endif
+  for (int i = 0; i < N * G; ++i) {
+    const int n = i / G;
+    const int g = i % G;
+    // dL/ds and dL/db
+    T ds = 0;
+    T db = 0;
+    for (int d = 0; d < D; ++d) {
+      const int c = g * D + d;
+      ds += gamma[c] * dy_x_sum[n * C + c];
+      db += gamma[c] * dy_sum[n * C + c];
+    }
+    const T c1 = (db * mu[i] - ds) * math::utils::Cube(rsig[i]) * denom;
+    const T c2 = -c1 * mu[i] - db * rsig[i] * denom;
+    for (int d = 0; d < D; ++d) {
+      const int c = g * D + d;
+      const T scale = gamma[c] * rsig[i];
+      const int64_t offset = (static_cast<int64_t>(n) * C + c) * HxW;
+      for (int j = 0; j < HxW; ++j) {
+        dX[offset + j] = scale * dY[offset + j] + c1 * X[offset + j] + c2;
+      }
+    }
+  }
+}
+
 } // namespace
 
+// Single pass Welford statistics, and the normalization with the affine
+// transform fused into one scale and bias per channel
+template <>
+bool GroupNormOp<float, CPUContext>::RunOnDeviceImpl(
+    const int N,
+    const int G,
+    const int D,
+    const int HxW,
+    const float* X,
+    const float* gamma,
+    const float* beta,
+    float* Y,
+    float* mu,
+    float* rsig) {
+  const int C = G * D;
+  const bool parallel =
+      static_cast<int64_t>(N) * C * HxW >= kGroupNormParallelGrain;
+  if (order_ == StorageOrder::NCHW) {
+    const int64_t group_size = static_cast<int64_t>(D) * HxW;
+#ifdef _OPENMP
+#pragma omp parallel for if (parallel)
+#endif
+    for (int i = 0; i < N * G; ++i) {
+      const float* X_ptr = X + i * group_size;
+      float* Y_ptr = Y + i * group_size;
+      const auto moments = math::utils::WelfordMoments(X_ptr, group_size);
+      mu[i] = moments.mean;
+      rsig[i] = 1.0f / std::sqrt(moments.m2 / group_size + epsilon_);
+      for (int d = 0; d < D; ++d) {
+        const int c = (i % G) * D + d;
+        const float scale = gamma[c] * rsig[i];
+        const float bias = beta[c] - scale * mu[i];
+        for (int j = 0; j < HxW; ++j) {
+          Y_ptr[d * HxW + j] = scale * X_ptr[d * HxW + j] + bias;
+        }
+      }
+    }
+  } else {
+#ifdef _OPENMP
+#pragma omp parallel for if (parallel)
+#endif
+    for (int n = 0; n < N; ++n) {
+      const float* X_ptr = X + static_cast<int64_t>(n) * HxW * C;
+      float* Y_ptr = Y + static_cast<int64_t>(n) * HxW * C;
+      // The D values of a group are contiguous at every position
+      std::vector<math::utils::WelfordData<float>> moments(
+          G, math::utils::WelfordData<float>{0.0f, 0.0f, 0.0f});
+      for (int j = 0; j < HxW; ++j) {
+        for (int g = 0; g < G; ++g) {
+          moments[g] = math::utils::WelfordCombine(
+              moments[g],
+              math::utils::WelfordMoments(X_ptr + j * C + g * D, D));
+        }
+      }
+      std::vector<float> scale(C);
+      std::vector<float> bias(C);
+      for (int g = 0; g < G; ++g) {
+        const int i = n * G + g;
+        mu[i] = moments[g].mean;
+        rsig[i] = 1.0f /
+            std::sqrt(moments[g].m2 / (static_cast<float>(D) * HxW) +
+                      epsilon_);
+        for (int c = g * D; c < (g + 1) * D; ++c) {
+          scale[c] = gamma[c] * rsig[i];
+          bias[c] = beta[c] - scale[c] * mu[i];
+        }
+      }
+      for (int j = 0; j < HxW; ++j) {
+        for (int c = 0; c < C; ++c) {
+          Y_ptr[j * C + c] = scale[c] * X_ptr[j * C + c] + bias[c];
+        }
+      }
+    }
+  }
+  return true;
+}
+
 // Math:
 // let: s = gamma * rsig
 // let: b = beta - mu * gamma * rsig
@@ -96,6 +262,23 @@ bool GroupNormGradientOp<T, Context>::RunOnDeviceImpl(
     T* dX_data,
     T* dgamma_data,
     T* dbeta_data) {
+  if (order_ == StorageOrder::NCHW) {
+    GroupNormBackwardNCHW<T>(
+        N,
+        G,
+        D,
+        HxW,
+        dY_data,
+        X_data,
+        mu_data,
+        rsig_data,
+        gamma_data,
+        dX_data,
+        dgamma_data,
+        dbeta_data);
+    return true;
+  }
+
   const std::array<int, 4> dims = order_ == StorageOrder::NCHW
       ? std::array<int, 4>{N, G, D, HxW}
       : std::array<int, 4>{N, HxW, G, D};
@@ -0,0 +1,158 @@
+#include "caffe2/operators/int8_conv_op.h"
+
+#include <cstring>
+
+namespace caffe2 {
+
+namespace {
+
+// im2col of one NHWC image of uint8 values, with the padding set to the
+// zero point
+void Im2ColNHWCUint8(
+    int C,
+    int H,
+    int W,
+    int kernel_h,
+    int kernel_w,
+    int dilation_h,
+    int dilation_w,
+    int pad_t,
+    int pad_l,
+    int stride_h,
+    int stride_w,
+    int output_h,
+    int output_w,
+    uint8_t zero_point,
+    const uint8_t* img,
+    uint8_t* col) {
+  for (int oh = 0; oh < output_h; ++oh) {
+    for (int ow = 0; ow < output_w; ++ow) {
+      for (int r = 0; r < kernel_h; ++r) {
+        const int ih = oh * stride_h - pad_t + r * dilation_h;
+        for (int s = 0; s < kernel_w; ++s) {
+          const int iw = ow * stride_w - pad_l + s * dilation_w;
+          if (ih >= 0 && ih < H && iw >= 0 && iw < W) {
+            memcpy(col, img + (static_cast<int64_t>(ih) * W + iw) * C, C);
+          } else {
+            memset(col, zero_point, C);
+          }
+          col += C;
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+bool Int8ConvOp::RunOnDeviceWithOrderNHWC() {
+  CAFFE_ENFORCE_EQ(kernel_.size(), 2, "Int8Conv only supports 2D");
+  const auto& X = Input(INPUT);
+  const auto& filter = OperatorBase::Input<PackedInt8Weights>(PACKED_FILTER);
+  auto* Y = Output(0);
+  CAFFE_ENFORCE_EQ(X.ndim(), 4);
+  const int N = X.dim32(0), H = X.dim32(1), W = X.dim32(2), C = X.dim32(3);
+  const int M = filter.N;
+  CAFFE_ENFORCE_EQ(filter.dims.size(), 4, "The filter must be 4D (NHWC)");
+  CAFFE_ENFORCE_EQ(filter.dims[1], kernel_h());
+  CAFFE_ENFORCE_EQ(filter.dims[2], kernel_w());
+  CAFFE_ENFORCE_EQ(filter.dims[3], C);
+
+  const float* bias_data = nullptr;
+  if (InputSize() == 3) {
+    const auto& bias = Input(BIAS);
+    CAFFE_ENFORCE_EQ(bias.ndim(), 1);
+    CAFFE_ENFORCE_EQ(bias.dim32(0), M);
+    bias_data = bias.data<float>();
+  }
+
+  SetOutputSize(X, Y, M);
+  const int output_h = Y->dim32(1);
+  const int output_w = Y->dim32(2);
+  const int output_image_size = output_h * output_w;
+  const int kernel_dim = filter.K;
+
+  const float* X_data = X.data<float>();
+  const auto x_qparams = GetInt8ActivationParams(*this, X_data, X.size());
+  X_quantized_.resize(X.size());
+  QuantizeToUint8(X_data, X.size(), x_qparams, X_quantized_.data());
+
+  const bool is_1x1 = kernel_dim == C && !HasPad() && !HasStride();
+  if (!is_1x1) {
+    col_buffer_.resize(static_cast<size_t>(output_image_size) * kernel_dim);
+  }
+  products_.resize(static_cast<size_t>(output_image_size) * M);
+  float* Y_data = Y->template mutable_data<float>();
+  for (int image = 0; image < N; ++image) {
+    const uint8_t* img =
+        X_quantized_.data() + static_cast<int64_t>(image) * H * W * C;
+    const uint8_t* col = img;
+    if (!is_1x1) {
+      Im2ColNHWCUint8(
+          C,
+          H,
+          W,
+          kernel_h(),
+          kernel_w(),
+          dilation_h(),
+          dilation_w(),
+          pad_t(),
+          pad_l(),
+          stride_h(),
+          stride_w(),
+          output_h,
+          output_w,
+          x_qparams.zero_point,
+          img,
+          col_buffer_.data());
+      col = col_buffer_.data();
+    }
+    Int8GemmPacked(
+        output_image_size,
+        M,
+        kernel_dim,
+        col,
+        kernel_dim,
+        filter.packed.data(),
+        products_.data(),
+        M);
+    float* Y_image =
+        Y_data + static_cast<int64_t>(image) * output_image_size * M;
+    for (int i = 0; i < output_image_size; ++i) {
+      Int8DequantizeRow(
+          products_.data() + static_cast<int64_t>(i) * M,
+          x_qparams,
+          filter,
+          bias_data,
+          relu_,
+          Y_image + static_cast<int64_t>(i) * M);
+    }
+  }
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(Int8Conv, Int8ConvOp);
+OPERATOR_SCHEMA(Int8Conv)
+    .NumInputs(2, 3)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Computes the same output as a 2D NHWC Conv without groups, with the
+convolution in 8 bits: X is quantized to uint8, the filter is int8 with a scale
+per output channel (packed by Int8PackWeight from the NHWC filter), and the
+products are accumulated in int32 before they are dequantized to float with
+the bias added.
+
+The quantization parameters of X are given by the X_scale and X_zero_point
+arguments, e.g. set by calibration with Int8CalibrationObserver. Without them,
+X is quantized over its range in every run.
+)DOC")
+    .Arg("relu", "(bool, default false) Apply a relu to the output")
+    .Arg("X_scale", "(float) Quantization scale of X")
+    .Arg("X_zero_point", "(int) Quantization zero point of X")
+    .Input(0, "X", "Float NHWC input")
+    .Input(1, "filter_packed", "Filter packed by Int8PackWeight")
+    .Input(2, "bias", "Optional float bias of the size of the output channels")
+    .Output(0, "Y", "Float NHWC output");
+NO_GRADIENT(Int8Conv);
+
+} // namespace caffe2
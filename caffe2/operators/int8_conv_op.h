@@ -0,0 +1,39 @@
+#ifndef CAFFE2_OPERATORS_INT8_CONV_OP_H_
+#define CAFFE2_OPERATORS_INT8_CONV_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/operators/int8_quantization.h"
+
+namespace caffe2 {
+
+// 2D NHWC convolution with uint8 activations and int8 weights packed by
+// Int8PackWeight, computed as an int8 GEMM over the im2col of the quantized
+// input. The products are dequantized to float with the bias and an optional
+// fused relu.
+class Int8ConvOp final : public ConvPoolOpBase<CPUContext> {
+ public:
+  USE_CONV_POOL_BASE_FUNCTIONS(CPUContext);
+  Int8ConvOp(const OperatorDef& operator_def, Workspace* ws)
+      : ConvPoolOpBase<CPUContext>(operator_def, ws),
+        relu_(GetSingleArgument<bool>("relu", false)) {
+    CAFFE_ENFORCE(
+        order_ == StorageOrder::NHWC, "Int8Conv only supports NHWC order");
+    CAFFE_ENFORCE_EQ(group_, 1, "Int8Conv does not support groups");
+  }
+
+  bool RunOnDeviceWithOrderNHWC() override;
+
+ private:
+  bool relu_;
+  vector<uint8_t> X_quantized_;
+  vector<uint8_t> col_buffer_;
+  vector<int32_t> products_;
+
+  INPUT_TAGS(INPUT, PACKED_FILTER, BIAS);
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_CONV_OP_H_
@@ -0,0 +1,77 @@
+#include "caffe2/operators/int8_fc_op.h"
+
+namespace caffe2 {
+
+bool Int8FCOp::RunOnDevice() {
+  const auto& X = Input(INPUT);
+  const auto& W = OperatorBase::Input<PackedInt8Weights>(PACKED_WEIGHT);
+  const auto& b = Input(BIAS);
+  auto* Y = Output(0);
+
+  const auto canonical_axis = X.canonical_axis_index(axis_);
+  const auto M = X.size_to_dim(canonical_axis);
+  const auto K = X.size_from_dim(canonical_axis);
+  const int N = W.N;
+  CAFFE_ENFORCE_EQ(K, W.K, "Dimension mismatch of X: ", X.dims(), " and W");
+  CAFFE_ENFORCE_EQ(b.ndim(), 1);
+  CAFFE_ENFORCE_EQ(b.dim32(0), N);
+
+  auto Y_shape = X.dims().vec();
+  Y_shape.resize(canonical_axis + 1);
+  Y_shape[canonical_axis] = N;
+  Y->Resize(Y_shape);
+  if (X.size() == 0) {
+    Y->template mutable_data<float>();
+    return true;
+  }
+
+  const float* X_data = X.data<float>();
+  const auto x_qparams = GetInt8ActivationParams(*this, X_data, X.size());
+  X_quantized_.resize(X.size());
+  QuantizeToUint8(X_data, X.size(), x_qparams, X_quantized_.data());
+
+  products_.resize(M * N);
+  Int8GemmPacked(
+      M,
+      N,
+      K,
+      X_quantized_.data(),
+      K,
+      W.packed.data(),
+      products_.data(),
+      N);
+
+  const float* b_data = b.data<float>();
+  float* Y_data = Y->template mutable_data<float>();
+  for (int64_t m = 0; m < M; ++m) {
+    Int8DequantizeRow(
+        products_.data() + m * N, x_qparams, W, b_data, relu_, Y_data + m * N);
+  }
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(Int8FC, Int8FCOp);
+OPERATOR_SCHEMA(Int8FC)
+    .NumInputs(3)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Computes the same output as FC, Y = X W^T + b, with the matrix product in
+8 bits: X is quantized to uint8, W is int8 with a scale per output channel
+(packed by Int8PackWeight), and the products are accumulated in int32 before
+they are dequantized to float with the bias added.
+
+The quantization parameters of X are given by the X_scale and X_zero_point
+arguments, e.g. set by calibration with Int8CalibrationObserver. Without them,
+X is quantized over its range in every run.
+)DOC")
+    .Arg("axis", "(int, default 1) Axis along which X is coerced to a matrix")
+    .Arg("relu", "(bool, default false) Apply a relu to the output")
+    .Arg("X_scale", "(float) Quantization scale of X")
+    .Arg("X_zero_point", "(int) Quantization zero point of X")
+    .Input(0, "X", "Float input")
+    .Input(1, "W_packed", "Weights packed by Int8PackWeight")
+    .Input(2, "b", "Float bias, with the size of the output channels")
+    .Output(0, "Y", "Float output");
+NO_GRADIENT(Int8FC);
+
+} // namespace caffe2
@@ -0,0 +1,34 @@
+#ifndef CAFFE2_OPERATORS_INT8_FC_OP_H_
+#define CAFFE2_OPERATORS_INT8_FC_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/operators/int8_quantization.h"
+
+namespace caffe2 {
+
+// FC with uint8 activations and int8 weights packed by Int8PackWeight. The
+// products are accumulated in int32, and dequantized to float with the bias
+// and an optional fused relu.
+class Int8FCOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  Int8FCOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        axis_(GetSingleArgument<int32_t>("axis", 1)),
+        relu_(GetSingleArgument<bool>("relu", false)) {}
+
+  bool RunOnDevice() override;
+
+ private:
+  int axis_;
+  bool relu_;
+  vector<uint8_t> X_quantized_;
+  vector<int32_t> products_;
+
+  INPUT_TAGS(INPUT, PACKED_WEIGHT, BIAS);
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_FC_OP_H_
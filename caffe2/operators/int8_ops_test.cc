@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include "caffe2/core/operator.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+
+namespace {
+
+void FillTensor(Workspace* ws, const string& name, vector<int64_t> dims) {
+  auto* tensor = BlobGetMutableTensor(ws->CreateBlob(name), CPU);
+  tensor->Resize(dims);
+  float* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->size(); ++i) {
+    data[i] = std::sin(0.7 * i + name.size());
+  }
+}
+
+void RunOp(
+    const string& type,
+    const vector<string>& inputs,
+    const string& output,
+    const vector<Argument>& args,
+    Workspace* ws) {
+  OperatorDef def;
+  def.set_type(type);
+  for (const auto& input : inputs) {
+    def.add_input(input);
+  }
+  def.add_output(output);
+  for (const auto& arg : args) {
+    *def.add_arg() = arg;
+  }
+  unique_ptr<OperatorBase> op(CreateOperator(def, ws));
+  ASSERT_NE(nullptr, op.get());
+  ASSERT_TRUE(op->Run());
+}
+
+// The int8 output is within a few quantization steps of the float one
+void ExpectClose(Workspace* ws, const string& name, const string& ref_name) {
+  const auto& Y = ws->GetBlob(name)->Get<TensorCPU>();
+  const auto& ref = ws->GetBlob(ref_name)->Get<TensorCPU>();
+  ASSERT_EQ(Y.dims(), ref.dims());
+  float max_abs = 0;
+  for (int64_t i = 0; i < ref.size(); ++i) {
+    max_abs = std::max(max_abs, std::abs(ref.data<float>()[i]));
+  }
+  for (int64_t i = 0; i < ref.size(); ++i) {
+    EXPECT_NEAR(Y.data<float>()[i], ref.data<float>()[i], 0.03 * max_abs);
+  }
+}
+
+} // namespace
+
+TEST(Int8OpsTest, FCMatchesFloat) {
+  Workspace ws;
+  FillTensor(&ws, "X", {5, 37});
+  FillTensor(&ws, "W", {11, 37});
+  FillTensor(&ws, "b", {11});
+  RunOp("FC", {"X", "W", "b"}, "Y_ref", {}, &ws);
+  RunOp("Int8PackWeight", {"W"}, "W_packed", {}, &ws);
+  RunOp("Int8FC", {"X", "W_packed", "b"}, "Y", {}, &ws);
+  ExpectClose(&ws, "Y", "Y_ref");
+
+  RunOp("Relu", {"Y_ref"}, "Y_ref", {}, &ws);
+  RunOp(
+      "Int8FC",
+      {"X", "W_packed", "b"},
+      "Y",
+      {MakeArgument<bool>("relu", true)},
+      &ws);
+  ExpectClose(&ws, "Y", "Y_ref");
+}
+
+TEST(Int8OpsTest, ConvMatchesFloat) {
+  Workspace ws;
+  FillTensor(&ws, "X", {2, 7, 6, 5});
+  FillTensor(&ws, "W", {9, 3, 3, 5});
+  FillTensor(&ws, "b", {9});
+  const vector<Argument> args = {MakeArgument<string>("order", "NHWC"),
+                                 MakeArgument<int>("kernel", 3),
+                                 MakeArgument<int>("stride", 2),
+                                 MakeArgument<int>("pad", 1)};
+  RunOp("Conv", {"X", "W", "b"}, "Y_ref", args, &ws);
+  RunOp("Int8PackWeight", {"W"}, "W_packed", {}, &ws);
+  RunOp("Int8Conv", {"X", "W_packed", "b"}, "Y", args, &ws);
+  ExpectClose(&ws, "Y", "Y_ref");
+
+  // 1x1 convolutions use the quantized input without im2col
+  FillTensor(&ws, "W1", {9, 1, 1, 5});
+  const vector<Argument> args1 = {MakeArgument<string>("order", "NHWC"),
+                                  MakeArgument<int>("kernel", 1)};
+  RunOp("Conv", {"X", "W1", "b"}, "Y1_ref", args1, &ws);
+  RunOp("Int8PackWeight", {"W1"}, "W1_packed", {}, &ws);
+  RunOp("Int8Conv", {"X", "W1_packed", "b"}, "Y1", args1, &ws);
+  ExpectClose(&ws, "Y1", "Y1_ref");
+}
+
+} // namespace caffe2
@@ -0,0 +1,72 @@
+#include "caffe2/operators/int8_quantization.h"
+
+namespace caffe2 {
+
+CAFFE_KNOWN_TYPE(PackedInt8Weights);
+
+bool Int8PackWeightOp::RunOnDevice() {
+  const auto& W = Input(0);
+  CAFFE_ENFORCE_GE(W.ndim(), 2, "W must have an output channel dimension");
+  const int N = W.dim32(0);
+  const int K = W.size_from_dim(1);
+  const float* W_data = W.data<float>();
+
+  auto* packed = OperatorBase::Output<PackedInt8Weights>(0);
+  packed->N = N;
+  packed->K = K;
+  packed->dims = W.dims().vec();
+  packed->scales.resize(N);
+  packed->col_offsets.resize(N);
+
+  float max_abs = 0;
+  vector<float> max_abs_per_channel(N);
+  for (int n = 0; n < N; ++n) {
+    const float* row = W_data + static_cast<int64_t>(n) * K;
+    for (int k = 0; k < K; ++k) {
+      max_abs_per_channel[n] =
+          std::max(max_abs_per_channel[n], std::abs(row[k]));
+    }
+    max_abs = std::max(max_abs, max_abs_per_channel[n]);
+  }
+
+  vector<int8_t> quantized(static_cast<size_t>(N) * K);
+  for (int n = 0; n < N; ++n) {
+    const float range = per_channel_ ? max_abs_per_channel[n] : max_abs;
+    const float scale = range > 0 ? range / 127.0f : 1.0f;
+    packed->scales[n] = scale;
+    const float* row = W_data + static_cast<int64_t>(n) * K;
+    int8_t* quantized_row = quantized.data() + static_cast<int64_t>(n) * K;
+    int32_t col_offset = 0;
+    for (int k = 0; k < K; ++k) {
+      const float q = std::nearbyint(row[k] / scale);
+      quantized_row[k] =
+          static_cast<int8_t>(std::max(-127.0f, std::min(127.0f, q)));
+      col_offset += quantized_row[k];
+    }
+    packed->col_offsets[n] = col_offset;
+  }
+
+  packed->packed.resize(Int8GemmPackedSize(N, K));
+  Int8GemmPackB(N, K, quantized.data(), packed->packed.data());
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(Int8PackWeight, Int8PackWeightOp);
+OPERATOR_SCHEMA(Int8PackWeight)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Quantizes the float weights of Int8FC or Int8Conv to int8, and packs them for
+the int8 GEMM kernels. Every slice of W along the first dimension is an output
+channel. The quantization is symmetric, with a scale per output channel unless
+per_channel is false. The output blob holds the packed weights, and is meant to
+be computed once, e.g. in the init net of a predictor.
+)DOC")
+    .Arg(
+        "per_channel",
+        "(bool, default true) Quantize every output channel with its own scale")
+    .Input(0, "W", "Float weights, with the output channels first")
+    .Output(0, "W_packed", "Packed int8 weights");
+NO_GRADIENT(Int8PackWeight);
+
+} // namespace caffe2
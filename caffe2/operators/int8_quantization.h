@@ -0,0 +1,123 @@
+#ifndef CAFFE2_OPERATORS_INT8_QUANTIZATION_H_
+#define CAFFE2_OPERATORS_INT8_QUANTIZATION_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/perfkernels/int8_gemm.h"
+
+namespace caffe2 {
+
+// Affine quantization of activations to uint8: x = scale * (q - zero_point)
+struct Int8QuantizationParams {
+  float scale;
+  int32_t zero_point;
+};
+
+// Quantization parameters covering [min, max]. The range is extended to
+// include 0, so that 0 (e.g. padding) is exactly representable.
+inline Int8QuantizationParams ChooseInt8QuantizationParams(
+    float min,
+    float max) {
+  min = std::min(min, 0.0f);
+  max = std::max(max, 0.0f);
+  Int8QuantizationParams qparams;
+  qparams.scale = max > min ? (max - min) / 255.0f : 1.0f;
+  const auto zero_point =
+      static_cast<int32_t>(std::nearbyint(-min / qparams.scale));
+  qparams.zero_point = std::max(0, std::min(255, zero_point));
+  return qparams;
+}
+
+// Quantization parameters of the N activations in X: the ones given by the
+// X_scale and X_zero_point arguments of the op when they are set (by
+// calibration), or else the ones covering the range of X
+inline Int8QuantizationParams GetInt8ActivationParams(
+    const OperatorBase& op,
+    const float* X,
+    int64_t N) {
+  if (op.HasArgument("X_scale")) {
+    Int8QuantizationParams qparams;
+    qparams.scale = op.GetSingleArgument<float>("X_scale", 1.0f);
+    qparams.zero_point = op.GetSingleArgument<int>("X_zero_point", 0);
+    CAFFE_ENFORCE_GT(qparams.scale, 0, "X_scale must be positive");
+    CAFFE_ENFORCE(
+        qparams.zero_point >= 0 && qparams.zero_point <= 255,
+        "X_zero_point must be in [0, 255]");
+    return qparams;
+  }
+  if (N == 0) {
+    return ChooseInt8QuantizationParams(0, 0);
+  }
+  const auto minmax = std::minmax_element(X, X + N);
+  return ChooseInt8QuantizationParams(*minmax.first, *minmax.second);
+}
+
+inline void QuantizeToUint8(
+    const float* X,
+    int64_t N,
+    const Int8QuantizationParams& qparams,
+    uint8_t* Xq) {
+  const float inverse_scale = 1.0f / qparams.scale;
+  for (int64_t i = 0; i < N; ++i) {
+    const float q = std::nearbyint(X[i] * inverse_scale) + qparams.zero_point;
+    Xq[i] = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, q)));
+  }
+}
+
+// Weights of Int8FC and Int8Conv: N output channels of K int8 values, with
+// symmetric quantization (w = scale * q) per output channel, packed by
+// Int8GemmPackB
+struct PackedInt8Weights {
+  int N = 0;
+  int K = 0;
+  std::vector<int8_t> packed;
+  // Shape of the unpacked weights
+  std::vector<int64_t> dims;
+  std::vector<float> scales;
+  // Sum of the quantized weights of every output channel, which corrects
+  // the products for the zero point of the activations
+  std::vector<int32_t> col_offsets;
+};
+
+// Output channels of a row of int32 products of quantized activations and
+// weights: the products are dequantized, the bias is added and, for a fused
+// relu, negative values are clamped to 0.
+inline void Int8DequantizeRow(
+    const int32_t* products,
+    const Int8QuantizationParams& x_qparams,
+    const PackedInt8Weights& W,
+    const float* bias,
+    bool relu,
+    float* Y) {
+  const float lowest = relu ? 0.0f : std::numeric_limits<float>::lowest();
+  for (int n = 0; n < W.N; ++n) {
+    const float y = x_qparams.scale * W.scales[n] *
+            (products[n] - x_qparams.zero_point * W.col_offsets[n]) +
+        (bias ? bias[n] : 0.0f);
+    Y[n] = std::max(y, lowest);
+  }
+}
+
+// Quantizes and packs the weights W of Int8FC or Int8Conv, with one output
+// channel per slice along the first dimension.
+class Int8PackWeightOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  Int8PackWeightOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        per_channel_(GetSingleArgument<bool>("per_channel", true)) {}
+
+  bool RunOnDevice() override;
+
+ private:
+  bool per_channel_;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_QUANTIZATION_H_
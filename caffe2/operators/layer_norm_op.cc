@@ -1,16 +1,16 @@
 #include "caffe2/operators/layer_norm_op.h"
-#include "caffe2/utils/eigen_utils.h"
+
+#include <cmath>
+
+#include "caffe2/utils/math_utils.h"
 
 namespace caffe2 {
 
 namespace {
-template <typename T>
-using EigenMatrixMapRowMajor = Eigen::Map<
-    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
 
-template <typename T>
-using ConstEigenMatrixMapRowMajor = Eigen::Map<
-    const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+// Rows are normalized in parallel when the input has at least this many values
+constexpr int64_t kLayerNormParallelGrain = 1 << 15;
+
 } // namespace
 
 template <>
@@ -34,37 +34,44 @@ bool LayerNormOp<CPUContext>::DoRunWithType<float>() {
   mean->Resize(stats_dims);
   stdev->Resize(stats_dims);
 
-  auto input_map = ConstEigenMatrixMapRowMajor<float>(
-      input.template data<float>(), left, right);
-  auto mean_map = EigenMatrixMapRowMajor<float>(
-      mean->template mutable_data<float>(), left, 1);
-  auto stdev_map = EigenMatrixMapRowMajor<float>(
-      stdev->template mutable_data<float>(), left, 1);
-  auto output_map = EigenMatrixMapRowMajor<float>(
-      output->template mutable_data<float>(), left, right);
-
-  auto sqr = [](float f) { return f * f; };
-  auto add_ep = [this](float f) { return f + epsilon_; };
-  auto fsqrt = [](float f) { return std::sqrt(f); };
-  // Calculate row-wise statistics
-  mean_map = input_map.rowwise().mean();
-  stdev_map =
-      (input_map.unaryExpr(sqr).rowwise().mean() - mean_map.unaryExpr(sqr))
-          .unaryExpr(add_ep)
-          .unaryExpr(fsqrt);
-  output_map = (input_map - mean_map.replicate(1, right))
-                   .cwiseQuotient(stdev_map.replicate(1, right));
+  const float* X = input.template data<float>();
+  float* Y = output->template mutable_data<float>();
+  float* mean_data = mean->template mutable_data<float>();
+  float* stdev_data = stdev->template mutable_data<float>();
+
+  // One pass over a row for its statistics, and one to normalize it
+#ifdef _OPENMP
+#pragma omp parallel for if (input.size() >= kLayerNormParallelGrain)
+#endif
+  for (int i = 0; i < left; ++i) {
+    const float* X_row = X + static_cast<int64_t>(i) * right;
+    float* Y_row = Y + static_cast<int64_t>(i) * right;
+    const auto moments = math::utils::WelfordMoments(X_row, right);
+    const float sigma = std::sqrt(moments.m2 / right + epsilon_);
+    mean_data[i] = moments.mean;
+    stdev_data[i] = sigma;
+    const float scale = 1.0f / sigma;
+    const float bias = -moments.mean * scale;
+    for (int j = 0; j < right; ++j) {
+      Y_row[j] = X_row[j] * scale + bias;
+    }
+  }
 
   return true;
 }
 
 REGISTER_CPU_OPERATOR(LayerNorm, LayerNormOp<CPUContext>);
 
+// Math:
+// y = (x - mean) * rsig, with rsig = 1 / stdev
+// dx = rsig * (dy - Mean(dy) - y * Mean(dy * y))
+//    = rsig * dy + c1 * x + c2
+// with c1 = -rsig^3 * (Sum(dy * x) - mean * Sum(dy)) / D
+// and c2 = -rsig * Sum(dy) / D - c1 * mean
 template <>
 template <>
 bool LayerNormGradientOp<CPUContext>::DoRunWithType<float>() {
   const auto& dout = Input(0);
-  const auto& norm_outputs = Input(1);
   const auto& means = Input(2);
   const auto& stdev = Input(3);
   const auto& norm_inputs = Input(4);
@@ -76,57 +83,34 @@ bool LayerNormGradientOp<CPUContext>::DoRunWithType<float>() {
 
   ginput->ResizeLike(norm_inputs);
 
-  auto dout_map = ConstEigenMatrixMapRowMajor<float>(
-      dout.template data<float>(), left, right);
-  auto means_map =
-      ConstEigenMatrixMapRowMajor<float>(means.template data<float>(), left, 1);
-  auto stdev_map =
-      ConstEigenMatrixMapRowMajor<float>(stdev.template data<float>(), left, 1);
-  auto norm_inputs_map = ConstEigenMatrixMapRowMajor<float>(
-      norm_inputs.template data<float>(), left, right);
-  auto ginput_map = EigenMatrixMapRowMajor<float>(
-      ginput->template mutable_data<float>(), left, right);
-
-  // Helper functors
-  auto sqr = [](float f) { return f * f; };
-  auto recip = [](float f) { return 1.0f / f; };
-  auto neg_recip = [](float f) { return -1.0f / f; };
-
-  // Gradients - output block
-  // -1 / (stdev + epsilon)^2 * \sum_j^D x_ij - mean * dout
-  // First part: -1 / (stdev + epsilon)^2
-  auto dstdev_end_0 = stdev_map.unaryExpr(sqr).unaryExpr(neg_recip);
-  // Second part: \sum_j^D x_ij - mean * dout
-  auto dstdev_end_1 = (norm_inputs_map - means_map.replicate(1, right))
-                          .cwiseProduct(dout_map)
-                          .rowwise()
-                          .sum();
-  auto dstdev_end = dstdev_end_0.cwiseProduct(dstdev_end_1);
-  // \sum_j^D -dout * 1/(std+epsilon)
-  auto dmean_end = stdev_map.unaryExpr(neg_recip)
-                       .replicate(1, right)
-                       .cwiseProduct(dout_map)
-                       .rowwise()
-                       .sum();
-  // 1.0 / (stdev + epsilon) * dout
-  auto dx_end =
-      stdev_map.unaryExpr(recip).replicate(1, right).cwiseProduct(dout_map);
-
-  // Gradients - standard deviation block
-  // -1.0*(mean / stdev) * dstdev_end
-  auto dmean_stdev = stdev_map.unaryExpr(neg_recip)
-                         .cwiseProduct(means_map)
-                         .cwiseProduct(dstdev_end);
-  // (mean / (D*stdev)) * dstdev
-  auto dx_stdev = (1.0f / right) *
-      norm_inputs_map.cwiseQuotient(stdev_map.replicate(1, right))
-          .cwiseProduct(dstdev_end.replicate(1, right));
-
-  // Gradients - mean block
-  auto dmean = dmean_end + dmean_stdev;
-  auto dx_mean = (1.0f / right) * dmean.replicate(1, right);
-
-  ginput_map = dx_end + dx_stdev + dx_mean;
+  const float* dY = dout.template data<float>();
+  const float* X = norm_inputs.template data<float>();
+  const float* mean_data = means.template data<float>();
+  const float* stdev_data = stdev.template data<float>();
+  float* dX = ginput->template mutable_data<float>();
+
+#ifdef _OPENMP
+#pragma omp parallel for if (norm_inputs.size() >= kLayerNormParallelGrain)
+#endif
+  for (int i = 0; i < left; ++i) {
+    const float* dY_row = dY + static_cast<int64_t>(i) * right;
+    const float* X_row = X + static_cast<int64_t>(i) * right;
+    float* dX_row = dX + static_cast<int64_t>(i) * right;
+    float sum_dy = 0.0f;
+    float sum_dy_x = 0.0f;
+    for (int j = 0; j < right; ++j) {
+      sum_dy += dY_row[j];
+      sum_dy_x += dY_row[j] * X_row[j];
+    }
+    const float mu = mean_data[i];
+    const float rsig = 1.0f / stdev_data[i];
+    const float c1 =
+        -rsig * rsig * rsig * (sum_dy_x - mu * sum_dy) / right;
+    const float c2 = -rsig * sum_dy / right - c1 * mu;
+    for (int j = 0; j < right; ++j) {
+      dX_row[j] = rsig * dY_row[j] + c1 * X_row[j] + c2;
+    }
+  }
 
   return true;
 }
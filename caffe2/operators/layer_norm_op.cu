@@ -1,81 +1,105 @@
 #include "caffe2/operators/layer_norm_op.h"
 
-#include <cub/cub.cuh>
+#include <cub/block/block_reduce.cuh>
 
 #include "caffe2/core/context_gpu.h"
 #include "caffe2/utils/math.h"
+#include "caffe2/utils/math_utils.h"
 
 namespace caffe2 {
 
 namespace {
-template <typename T>
-struct SqrTransform {
-  inline __host__ __device__ T operator()(const T v) const {
-    return v * v;
+
+struct WelfordCombineOp {
+  inline __device__ math::utils::WelfordData<float> operator()(
+      const math::utils::WelfordData<float>& a,
+      const math::utils::WelfordData<float>& b) const {
+    return math::utils::WelfordCombine(a, b);
   }
 };
 
-// X = X - Y^2
-__global__ void sqrtXMinusYSquaredKernel(
-    const int N,
-    float* x,
-    const float* y,
-    const float epsilon) {
-  CUDA_1D_KERNEL_LOOP(i, N) {
-    x[i] = sqrtf(x[i] - y[i] * y[i] + epsilon);
+// One block per row: the threads update Welford statistics of strided values
+// of the row, which are combined by a block reduction, and then normalize
+// the row.
+__global__ void LayerNormForwardCUDAKernel(
+    const int right,
+    const float epsilon,
+    const float* X,
+    float* mean,
+    float* stdev,
+    float* Y) {
+  typedef math::utils::WelfordData<float> WelfordData;
+  typedef cub::BlockReduce<WelfordData, CAFFE_CUDA_NUM_THREADS> BlockReduce;
+  __shared__ BlockReduce::TempStorage temp_storage;
+  __shared__ float row_mean;
+  __shared__ float row_rsig;
+
+  const int i = blockIdx.x;
+  const float* X_row = X + static_cast<int64_t>(i) * right;
+  float* Y_row = Y + static_cast<int64_t>(i) * right;
+
+  WelfordData data = {0.0f, 0.0f, 0.0f};
+  for (int j = threadIdx.x; j < right; j += blockDim.x) {
+    math::utils::WelfordUpdate(__ldg(X_row + j), &data);
   }
-}
+  data = BlockReduce(temp_storage).Reduce(data, WelfordCombineOp());
+  if (threadIdx.x == 0) {
+    const float sigma = sqrtf(data.m2 / right + epsilon);
+    mean[i] = data.mean;
+    stdev[i] = sigma;
+    row_mean = data.mean;
+    row_rsig = 1.0f / sigma;
+  }
+  __syncthreads();
 
-// out[i, j] = (X[i, j] - mu[i]) / sigma[i]
-__global__ void normalizeKernel(
-    const int row_dim,
-    const int N,
-    const float* x,
-    const float* mu,
-    const float* sigma,
-    float* out) {
-  CUDA_1D_KERNEL_LOOP(i, N) {
-    out[i] = (x[i] - mu[i / row_dim]) / (sigma[i / row_dim]);
+  for (int j = threadIdx.x; j < right; j += blockDim.x) {
+    Y_row[j] = (__ldg(X_row + j) - row_mean) * row_rsig;
   }
 }
 
-template <typename InputIterator_t>
-void allocScratchAndReduce(
-    InputIterator_t input,
-    float* output,
-    int num_segments,
-    int* seg_indices,
-    Tensor* scratch,
-    cudaStream_t stream) {
-  size_t temp_storage_bytes;
-  cub::DeviceSegmentedReduce::Sum(
-      nullptr, // To retrieve required temporary storage size
-      temp_storage_bytes, // size_t &temp_storage_bytes
-      input, // InputIteratorT d_i
-      output, // OutputIteratorT d_out
-      num_segments, // int num_segments
-      seg_indices, // int *d_begin_offsets
-      seg_indices + 1, // int *d_end_offsets
-      stream // cudaStream_t stream=0
-      );
-  size_t temp_storage_floats = temp_storage_bytes / sizeof(float) +
-      (temp_storage_bytes % sizeof(float) ? 1 : 0);
-  scratch->Resize(vector<size_t>{temp_storage_floats});
+// One block per row, see LayerNormGradientOp<CPUContext> for the math
+__global__ void LayerNormBackwardCUDAKernel(
+    const int right,
+    const float* dY,
+    const float* X,
+    const float* mean,
+    const float* stdev,
+    float* dX) {
+  typedef cub::BlockReduce<float, CAFFE_CUDA_NUM_THREADS> BlockReduce;
+  __shared__ BlockReduce::TempStorage dy_storage;
+  __shared__ BlockReduce::TempStorage dy_x_storage;
+  __shared__ float rsig;
+  __shared__ float c1;
+  __shared__ float c2;
+
+  const int i = blockIdx.x;
+  const float* dY_row = dY + static_cast<int64_t>(i) * right;
+  const float* X_row = X + static_cast<int64_t>(i) * right;
+  float* dX_row = dX + static_cast<int64_t>(i) * right;
+
+  float sum_dy = 0.0f;
+  float sum_dy_x = 0.0f;
+  for (int j = threadIdx.x; j < right; j += blockDim.x) {
+    const float dy = __ldg(dY_row + j);
+    sum_dy += dy;
+    sum_dy_x += dy * __ldg(X_row + j);
+  }
+  sum_dy = BlockReduce(dy_storage).Sum(sum_dy);
+  sum_dy_x = BlockReduce(dy_x_storage).Sum(sum_dy_x);
+  if (threadIdx.x == 0) {
+    const float mu = mean[i];
+    rsig = 1.0f / stdev[i];
+    c1 = -rsig * rsig * rsig * (sum_dy_x - mu * sum_dy) / right;
+    c2 = -rsig * sum_dy / right - c1 * mu;
+  }
+  __syncthreads();
 
-  cub::DeviceSegmentedReduce::Sum(
-      scratch->template mutable_data<float>(), // To retrieve required temporary
-                                               // storage size
-      temp_storage_bytes, // size_t &temp_storage_bytes
-      input, // InputIteratorT d_i
-      output, // OutputIteratorT d_out
-      num_segments, // int num_segments
-      seg_indices, // int *d_begin_offsets
-      seg_indices + 1, // int *d_end_offsets
-      stream // cudaStream_t stream=0
-  );
+  for (int j = threadIdx.x; j < right; j += blockDim.x) {
+    dX_row[j] = rsig * __ldg(dY_row + j) + c1 * __ldg(X_row + j) + c2;
+  }
 }
 
-} //  namespace
+} // namespace
 
 template <>
 template <>
@@ -97,90 +121,20 @@ bool LayerNormOp<CUDAContext>::DoRunWithType<float>() {
   stats_dims.push_back(1);
   mean->Resize(stats_dims);
   stdev->Resize(stats_dims);
-
-  std::vector<int> segs(left + 1);
-  std::iota(segs.begin(), segs.end(), 0);
-  std::transform(
-      segs.begin(),
-      segs.end(),
-      segs.begin(),
-      std::bind1st(std::multiplies<int>(), right));
-
-  seg_indices_.Resize(at::IntList{static_cast<int64_t>(segs.size())});
-  context_.CopyBytesFromCPU(
-      sizeof(int) * segs.size(),
-      static_cast<void*>(segs.data()),
-      static_cast<void*>(seg_indices_.mutable_data<int>()));
-
-  if (right == 1) {
-    mean->CopyFrom(input);
-    mean->Resize(stats_dims);
-    math::Set<float, CUDAContext>(
-        left, sqrtf(epsilon_), stdev->mutable_data<float>(), &context_);
-  } else {
-    // Calculate row-wise means
-    // First stage: sum up feature vectors
-    allocScratchAndReduce(
-        input.data<float>(),
-        mean->mutable_data<float>(),
-        left,
-        seg_indices_.mutable_data<int>(),
-        &scratch_,
-        context_.cuda_stream());
-
-    // Second stage: Normalize by feature vector dim
-    math::Scale<float, float, CUDAContext>(
-        left,
-        1.0f / right,
-        mean->mutable_data<float>(),
-        mean->mutable_data<float>(),
-        &context_);
-
-    // Calculate row-wise standard deviation
-
-    // First stage: sum up row-wise squared values
-    SqrTransform<float> transform;
-    cub::TransformInputIterator<float, SqrTransform<float>, const float*> it(
-        input.data<float>(), transform);
-    allocScratchAndReduce(
-        it,
-        stdev->mutable_data<float>(),
-        left,
-        seg_indices_.mutable_data<int>(),
-        &scratch_,
-        context_.cuda_stream());
-
-    // Second stage: Normalize by feature vector dim
-    math::Scale<float, float, CUDAContext>(
-        left,
-        1.0f / right,
-        stdev->mutable_data<float>(),
-        stdev->mutable_data<float>(),
-        &context_);
-
-    // stddev = sqrt(E(x^2) - E(x)^2 + epsilon)
-    sqrtXMinusYSquaredKernel<<<
-        CAFFE_GET_BLOCKS(left),
-        CAFFE_CUDA_NUM_THREADS,
-        0,
-        context_.cuda_stream()>>>(
-        left,
-        stdev->mutable_data<float>(),
-        mean->mutable_data<float>(),
-        epsilon_);
+  if (left == 0) {
+    return true;
   }
 
-  // out[i, j] = (in[i,j] - mu[i]) / (sigma[i])
-  normalizeKernel<<<
-      CAFFE_GET_BLOCKS(left),
+  LayerNormForwardCUDAKernel<<<
+      left,
       CAFFE_CUDA_NUM_THREADS,
       0,
       context_.cuda_stream()>>>(
       right,
-      left * right,
+      epsilon_,
       input.data<float>(),
-      mean->data<float>(),
-      stdev->data<float>(),
+      mean->mutable_data<float>(),
+      stdev->mutable_data<float>(),
       output->mutable_data<float>());
 
   return true;
@@ -188,178 +142,34 @@ bool LayerNormOp<CUDAContext>::DoRunWithType<float>() {
 
 REGISTER_CUDA_OPERATOR(LayerNorm, LayerNormOp<CUDAContext>);
 
-namespace {
-// x : [N, D]
-// y : [N, 1]
-// z : [N, D]
-// (x - broadcast(y)) * z
-__global__ void zTimesXminusYbroadcast(
-    int N,
-    int D,
-    const float* x,
-    const float* y,
-    const float* z,
-    float* out) {
-  CUDA_1D_KERNEL_LOOP(i, N * D) {
-    out[i] = (x[i] - y[i / D]) * z[i];
-  }
-}
-
-__global__ void normalizeByNegStdev(
-    int N,
-    bool var,
-    const float* x,
-    const float* stdev,
-    float* out) {
-  if (var) {
-    CUDA_1D_KERNEL_LOOP(i, N) {
-      out[i] = (-1.0f * x[i]) / (stdev[i] * stdev[i]);
-    }
-  } else {
-    CUDA_1D_KERNEL_LOOP(i, N) {
-      out[i] = (-1.0f * x[i]) / (stdev[i]);
-    }
-  }
-}
-
-__global__ void gradientMegaKernel(
-    int N,
-    int D,
-    const float* stdev,
-    const float* X,
-    const float* dstdev,
-    const float* dmean,
-    const float* dout,
-    float* out) {
-  CUDA_1D_KERNEL_LOOP(i, N * D) {
-    out[i] = 1.0f / stdev[i / D] * dout[i] +
-        X[i] / (D * stdev[i / D]) * dstdev[i / D] + 1.0f / D * dmean[i / D];
-  }
-}
-
-#define PRINT(X, N, D) printTensor >> (X, N, D)
-
-} // namespace
-
 template <>
 template <>
 bool LayerNormGradientOp<CUDAContext>::DoRunWithType<float>() {
   const auto& dout = Input(0);
-  const auto& norm_outputs = Input(1);
   const auto& means = Input(2);
   const auto& stdev = Input(3);
   const auto& norm_inputs = Input(4);
   auto* ginput = Output(0);
 
   const auto canonical_axis = norm_inputs.canonical_axis_index(axis_);
-  const unsigned long left = norm_inputs.size_to_dim(canonical_axis);
-  const unsigned long right = norm_inputs.size_from_dim(canonical_axis);
+  const int left = norm_inputs.size_to_dim(canonical_axis);
+  const int right = norm_inputs.size_from_dim(canonical_axis);
 
   ginput->ResizeLike(norm_inputs);
-  std::vector<int64_t> stats_dims(
-      norm_inputs.dims().begin(), norm_inputs.dims().begin() + canonical_axis);
-  stats_dims.push_back(1);
-  dmean_.Resize(stats_dims);
-  dstdev_.Resize(stats_dims);
-  gscratch_.Resize(at::IntList{static_cast<int64_t>(left), static_cast<int64_t>(right)});
-
-  std::vector<int> segs(left + 1);
-  std::iota(segs.begin(), segs.end(), 0);
-  std::transform(
-      segs.begin(),
-      segs.end(),
-      segs.begin(),
-      std::bind1st(std::multiplies<int>(), right));
-
-  seg_indices_.Resize(vector<size_t>{segs.size()});
-  context_.CopyBytesFromCPU(
-      sizeof(int) * segs.size(),
-      static_cast<void*>(segs.data()),
-      static_cast<void*>(seg_indices_.mutable_data<int>()));
-
-  // Calculate gradient of the standard deviation
-  // temp1 = (x - mean) * dout
-  zTimesXminusYbroadcast<<<
-      CAFFE_GET_BLOCKS(left * right),
-      CAFFE_CUDA_NUM_THREADS,
-      0,
-      context_.cuda_stream()>>>(
-      left,
-      right,
-      norm_inputs.data<float>(),
-      means.data<float>(),
-      dout.data<float>(),
-      gscratch_.mutable_data<float>());
+  if (left == 0) {
+    return true;
+  }
 
-  dstdev_.Resize(vector<size_t>{left, 1});
-  // dstdev = reduce(temp1)
-  allocScratchAndReduce(
-      gscratch_.data<float>(),
-      dstdev_.mutable_data<float>(),
+  LayerNormBackwardCUDAKernel<<<
       left,
-      seg_indices_.mutable_data<int>(),
-      &scratch_,
-      context_.cuda_stream());
-  // dstdev = -dstdev / sqrt(stdev)
-  normalizeByNegStdev<<<
-      CAFFE_GET_BLOCKS(left),
       CAFFE_CUDA_NUM_THREADS,
       0,
       context_.cuda_stream()>>>(
-      left,
-      true,
-      dstdev_.data<float>(),
-      stdev.data<float>(),
-      dstdev_.mutable_data<float>());
-
-  // Calculate gradient of the mean
-  // dmean = reduce(dout)
-  allocScratchAndReduce(
+      right,
       dout.data<float>(),
-      dmean_.mutable_data<float>(),
-      left,
-      seg_indices_.mutable_data<int>(),
-      &scratch_,
-      context_.cuda_stream());
-  // mean * stdev
-  math::Mul(
-      left,
+      norm_inputs.data<float>(),
       means.data<float>(),
-      dstdev_.data<float>(),
-      gscratch_.mutable_data<float>(),
-      &context_);
-  // [\sum dout] + mean * stdev
-  math::Add(
-      left,
-      dmean_.data<float>(),
-      gscratch_.data<float>(),
-      dmean_.mutable_data<float>(),
-      &context_);
-  // -1 / std * [[\sum dout] + mean * stdev]
-  normalizeByNegStdev<<<
-      CAFFE_GET_BLOCKS(left),
-      CAFFE_CUDA_NUM_THREADS,
-      0,
-      context_.cuda_stream()>>>(
-      left,
-      false,
-      dmean_.data<float>(),
       stdev.data<float>(),
-      dmean_.mutable_data<float>());
-
-  // Calculate gradient of input
-  gradientMegaKernel<<<
-      CAFFE_GET_BLOCKS(left),
-      CAFFE_CUDA_NUM_THREADS,
-      0,
-      context_.cuda_stream()>>>(
-      left,
-      right,
-      stdev.data<float>(),
-      norm_inputs.data<float>(),
-      dstdev_.data<float>(),
-      dmean_.data<float>(),
-      dout.data<float>(),
       ginput->mutable_data<float>());
 
   return true;
@@ -27,9 +27,6 @@ class LayerNormOp : public Operator<Context> {
  protected:
   int axis_;
   float epsilon_;
-
-  Tensor scratch_{Context::GetDeviceType()};
-  Tensor seg_indices_{Context::GetDeviceType()};
 };
 
 template <class Context>
@@ -52,12 +49,6 @@ class LayerNormGradientOp : public Operator<Context> {
  protected:
   int axis_;
   float epsilon_;
-
-  Tensor scratch_{Context::GetDeviceType()};
-  Tensor gscratch_{Context::GetDeviceType()};
-  Tensor seg_indices_{Context::GetDeviceType()};
-  Tensor dstdev_{Context::GetDeviceType()};
-  Tensor dmean_{Context::GetDeviceType()};
 };
 
 } // namespace caffe2
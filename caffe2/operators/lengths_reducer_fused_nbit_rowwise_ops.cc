@@ -0,0 +1,122 @@
+#include "caffe2/operators/lengths_reducer_fused_nbit_rowwise_ops.h"
+#include "c10/util/Registry.h"
+
+namespace caffe2 {
+
+#define REGISTER_SPARSE_LENGTHS_FUSED_NBIT_ROWWISE_OPS(BIT_RATE)               \
+  REGISTER_CPU_OPERATOR(                                                       \
+      SparseLengthsSumFused##BIT_RATE##BitRowwise,                             \
+      SparseLengthsFusedNBitRowwiseOp<BIT_RATE, CPUContext>);                  \
+  OPERATOR_SCHEMA(SparseLengthsSumFused##BIT_RATE##BitRowwise)                 \
+      .NumInputs(3)                                                            \
+      .NumOutputs(1)                                                           \
+      .ValueKeyLengthInputFillers(                                             \
+          SparseLengthsFusedNBitRowwiseOp<BIT_RATE, CPUContext>::DATA,         \
+          SparseLengthsFusedNBitRowwiseOp<BIT_RATE, CPUContext>::INDICES,      \
+          SparseLengthsFusedNBitRowwiseOp<BIT_RATE, CPUContext>::LENGTHS)      \
+      .SetDoc(                                                                 \
+          "Performs the same operation as SparseLengthsSum, but operating "    \
+          "on " #BIT_RATE "-bit rowwise quantized matrices with fused "        \
+          "storage (where each row stores packed quantized values, and then "  \
+          "2-byte scale and 2-byte bias).")                                    \
+      .Input(                                                                  \
+          0,                                                                   \
+          "DATA",                                                              \
+          "uint8 tensor obtained with "                                        \
+          "operator FloatToFused" #BIT_RATE "BitRowwiseQuantized")             \
+      .Input(                                                                  \
+          1,                                                                   \
+          "INDICES",                                                           \
+          "Integer vector containing indices of the first "                    \
+          "dimension of DATA for the slices that are being aggregated")        \
+      .Input(                                                                  \
+          2,                                                                   \
+          "LENGTHS",                                                           \
+          "Vector with the same sum of elements as the first dimension of "    \
+          "DATA")                                                              \
+      .Output(0, "output", "output");                                          \
+  NO_GRADIENT(SparseLengthsSumFused##BIT_RATE##BitRowwise);                    \
+                                                                               \
+  REGISTER_CPU_OPERATOR(                                                       \
+      SparseLengthsWeightedSumFused##BIT_RATE##BitRowwise,                     \
+      SparseLengthsFusedNBitRowwiseOp<                                         \
+          BIT_RATE,                                                            \
+          CPUContext,                                                          \
+          /*with_weights=*/true>);                                             \
+  OPERATOR_SCHEMA(SparseLengthsWeightedSumFused##BIT_RATE##BitRowwise)         \
+      .NumInputs(4)                                                            \
+      .NumOutputs(1)                                                           \
+      .DisallowInputFillers()                                                  \
+      .SetDoc(                                                                 \
+          "Performs the same operation as SparseLengthsWeightedSum, but "      \
+          "operating on " #BIT_RATE "-bit rowwise quantized matrices with "    \
+          "fused storage (where each row stores packed quantized values, "     \
+          "and then 2-byte scale and 2-byte bias).")                           \
+      .Input(                                                                  \
+          0,                                                                   \
+          "DATA",                                                              \
+          "uint8 tensor obtained with "                                        \
+          "operator FloatToFused" #BIT_RATE "BitRowwiseQuantized")             \
+      .Input(                                                                  \
+          1,                                                                   \
+          "INDICES",                                                           \
+          "Integer vector containing indices of the first "                    \
+          "dimension of DATA for the slices that are being aggregated")        \
+      .Input(                                                                  \
+          2,                                                                   \
+          "LENGTHS",                                                           \
+          "Vector with the same sum of elements as the first dimension of "    \
+          "DATA")                                                              \
+      .Input(                                                                  \
+          3,                                                                   \
+          "WEIGHTS",                                                           \
+          "Vector of weights to scale rows of DATA with before reduction")     \
+      .Output(0, "output", "output");                                          \
+  NO_GRADIENT(SparseLengthsWeightedSumFused##BIT_RATE##BitRowwise);            \
+                                                                               \
+  REGISTER_CPU_OPERATOR(                                                       \
+      SparseLengthsMeanFused##BIT_RATE##BitRowwise,                            \
+      SparseLengthsFusedNBitRowwiseOp<                                         \
+          BIT_RATE,                                                            \
+          CPUContext,                                                          \
+          /*with_weights=*/false,                                              \
+          /*is_mean=*/true>);                                                  \
+  OPERATOR_SCHEMA(SparseLengthsMeanFused##BIT_RATE##BitRowwise)                \
+      .NumInputs(3)                                                            \
+      .NumOutputs(1)                                                           \
+      .ValueKeyLengthInputFillers(                                             \
+          SparseLengthsFusedNBitRowwiseOp<BIT_RATE, CPUContext, false, true>:: \
+              DATA,                                                            \
+          SparseLengthsFusedNBitRowwiseOp<BIT_RATE, CPUContext, false, true>:: \
+              INDICES,                                                         \
+          SparseLengthsFusedNBitRowwiseOp<BIT_RATE, CPUContext, false, true>:: \
+              LENGTHS)                                                         \
+      .SetDoc(                                                                 \
+          "Performs the same operation as SparseLengthsMean, but operating "   \
+          "on " #BIT_RATE "-bit rowwise quantized matrices with fused "        \
+          "storage (where each row stores packed quantized values, and then "  \
+          "2-byte scale and 2-byte bias).")                                    \
+      .Input(                                                                  \
+          0,                                                                   \
+          "DATA",                                                              \
+          "uint8 tensor obtained with "                                        \
+          "operator FloatToFused" #BIT_RATE "BitRowwiseQuantized")             \
+      .Input(                                                                  \
+          1,                                                                   \
+          "INDICES",                                                           \
+          "Integer vector containing indices of the first "                    \
+          "dimension of DATA for the slices that are being aggregated")        \
+      .Input(                                                                  \
+          2,                                                                   \
+          "LENGTHS",                                                           \
+          "Vector with the same sum of elements as the first dimension of "    \
+          "DATA")                                                              \
+      .Output(0, "output", "output");                                          \
+  NO_GRADIENT(SparseLengthsMeanFused##BIT_RATE##BitRowwise);
+
+REGISTER_SPARSE_LENGTHS_FUSED_NBIT_ROWWISE_OPS(4)
+REGISTER_SPARSE_LENGTHS_FUSED_NBIT_ROWWISE_OPS(2)
+
+#undef REGISTER_SPARSE_LENGTHS_FUSED_NBIT_ROWWISE_OPS
+
+} // namespace caffe2
@@ -1,7 +1,10 @@
 #ifndef CAFFE2_OPERATORS_LOAD_SAVE_OP_H_
 #define CAFFE2_OPERATORS_LOAD_SAVE_OP_H_
 
+#include <atomic>
 #include <cstdio>
+#include <functional>
+#include <future>
 #include <map>
 #include <unordered_set>
 
@@ -206,24 +209,18 @@ class LoadOp final : public Operator<Context> {
       int* total_loaded_blobs) {
     CAFFE_ENFORCE(cursor, "cursor is not valid");
     int loaded_blobs = 0;
-    for (; cursor->Valid(); cursor->Next()) {
-      const auto key = buildBlobNameFromDbKey(cursor->key());
-      if (key_to_dbid_.count(key) && key_to_dbid_[key] != db_id) {
-        CAFFE_THROW("Duplicate Key ", key, " is found!\n");
-      } else {
-        key_to_dbid_[key] = db_id;
-      }
-
-      BlobProto proto;
-      CAFFE_ENFORCE(
-          proto.ParseFromString(cursor->value()), "Couldn't parse Proto");
-      if (!keep_device_) {
-        // If we are not keeping the device as the one specified in the
-        // proto, we will set the current device.
-        SetCurrentDevice(&proto);
+    while (cursor->NextBatch(LoadBatchSize(), &records_) > 0) {
+      pending_.clear();
+      for (const auto& record : records_) {
+        const auto key = buildBlobNameFromDbKey(record.key.ToString());
+        if (key_to_dbid_.count(key) && key_to_dbid_[key] != db_id) {
+          CAFFE_THROW("Duplicate Key ", key, " is found!\n");
+        } else {
+          key_to_dbid_[key] = db_id;
+        }
+        pending_.emplace_back(ws_->CreateBlob(key), key, record.value);
       }
-      Blob* blob = ws_->CreateBlob(key);
-      ProcessBlob(blob, proto, blob_states, key, &loaded_blobs);
+      LoadPending(blob_states, &loaded_blobs, -1);
     }
     *total_loaded_blobs += loaded_blobs;
   }
@@ -236,36 +233,144 @@ class LoadOp final : public Operator<Context> {
       int* total_loaded_blobs) {
     CAFFE_ENFORCE(cursor);
     int loaded_blobs = 0;
-    for (; cursor->Valid(); cursor->Next()) {
-      const auto key = buildBlobNameFromDbKey(cursor->key());
-      if (!output_indices_.count(key)) {
-        VLOG(1) << "Key " << key << " not used. Skipping.";
-      } else {
+    bool done = false;
+    while (!done && cursor->NextBatch(LoadBatchSize(), &records_) > 0) {
+      pending_.clear();
+      for (const auto& record : records_) {
+        const auto key = buildBlobNameFromDbKey(record.key.ToString());
+        if (!output_indices_.count(key)) {
+          VLOG(1) << "Key " << key << " not used. Skipping.";
+          continue;
+        }
         if (key_to_dbid_.count(key) && key_to_dbid_[key] != db_id) {
           CAFFE_THROW("Duplicate Key ", key, " is found!\n");
         } else {
           key_to_dbid_[key] = db_id;
         }
+        pending_.emplace_back(
+            outputs.at(output_indices_[key]), key, record.value);
+      }
+      done = LoadPending(
+          blob_states, &loaded_blobs, OutputSize() - *total_loaded_blobs);
+    }
 
-        VLOG(2) << "Deserializing blob " << key;
-        BlobProto proto;
-        CAFFE_ENFORCE(proto.ParseFromString(cursor->value()));
-        if (!keep_device_) {
-          // If we are not keeping the device as the one specified in the
-          // proto, we will set the current device.
-          SetCurrentDevice(&proto);
-        }
-        auto blobIndex = output_indices_[key];
-        Blob* blob = outputs.at(blobIndex);
-        ProcessBlob(blob, proto, blob_states, key, &loaded_blobs);
+    *total_loaded_blobs += loaded_blobs;
+  }
 
-        if (*total_loaded_blobs + loaded_blobs == OutputSize()) {
-          break;
-        }
+  // A record of the db to be loaded into a blob.
+  struct PendingBlob {
+    PendingBlob(Blob* blob, const string& key, db::StringView value)
+        : blob(blob), key(key), value(value), deferred(false) {}
+
+    Blob* blob;
+    string key;
+    db::StringView value;
+    BlobProto proto;
+    // Whether the tensor chunk is deserialized after the bookkeeping
+    bool deferred;
+  };
+
+  // Number of records read and loaded together.
+  static int LoadBatchSize() {
+    return 2 * std::max(FLAGS_caffe2_max_tensor_serializer_threads, 1);
+  }
+
+  // Calls f(i) for every i in [0, n) on up to
+  // caffe2_max_tensor_serializer_threads threads, as the tensor serializer
+  // does for the chunks of a tensor.
+  static void ParallelFor(size_t n, const std::function<void(size_t)>& f) {
+#ifndef __ANDROID__
+    const size_t num_threads = std::min<size_t>(
+        n, std::max(FLAGS_caffe2_max_tensor_serializer_threads, 1));
+    std::atomic<size_t> next(0);
+    auto task = [&]() {
+      for (size_t i = next++; i < n; i = next++) {
+        f(i);
       }
+    };
+    std::vector<std::future<void>> futures;
+    for (size_t t = 1; t < num_threads; ++t) {
+      futures.emplace_back(std::async(std::launch::async, task));
+    }
+    task();
+    for (auto& future : futures) {
+      future.get();
+    }
+#else
+    // Since Android does not have std::future, we will always do sync mode
+    for (size_t i = 0; i < n; ++i) {
+      f(i);
     }
+#endif
+  }
 
-    *total_loaded_blobs += loaded_blobs;
+  // Loads pending_: the protos are parsed in parallel, the blob states are
+  // updated in order, and then the CPU tensor chunks, whose tensors have
+  // been given their final shape and type, are deserialized in parallel.
+  // Stops after max_loaded_blobs blobs have been completed (if not negative)
+  // and returns whether it did.
+  bool LoadPending(
+      std::unordered_map<string, BlobState>* blob_states,
+      int* loaded_blobs,
+      int max_loaded_blobs) {
+    ParallelFor(pending_.size(), [this](size_t i) {
+      PendingBlob& pending = pending_[i];
+      VLOG(2) << "Deserializing blob " << pending.key;
+      CAFFE_ENFORCE(
+          pending.proto.ParseFromArray(
+              pending.value.data, pending.value.size),
+          "Couldn't parse Proto");
+      if (!keep_device_) {
+        // If we are not keeping the device as the one specified in the
+        // proto, we will set the current device.
+        SetCurrentDevice(&pending.proto);
+      }
+    });
+
+    bool done = false;
+    size_t num_processed = 0;
+    while (num_processed < pending_.size() && !done) {
+      PendingBlob& pending = pending_[num_processed++];
+      ProcessBlob(
+          pending.blob,
+          pending.proto,
+          blob_states,
+          pending.key,
+          loaded_blobs,
+          &pending.deferred);
+      done = max_loaded_blobs >= 0 && *loaded_blobs == max_loaded_blobs;
+    }
+
+    ParallelFor(num_processed, [this](size_t i) {
+      if (pending_[i].deferred) {
+        DeserializeBlob(pending_[i].proto, pending_[i].blob);
+      }
+    });
+    return done;
+  }
+
+  // Gives blob a CPU tensor with the shape and type of a tensor chunk, so
+  // that the chunk can be deserialized concurrently with other chunks of the
+  // same tensor. Returns false if the chunk has to be deserialized right
+  // away.
+  bool PreallocateTensor(Blob* blob, const BlobProto& proto) {
+    if (proto.type() != kTensorBlobType) {
+      return false;
+    }
+    const TensorProto& tensor_proto = proto.tensor();
+    if (tensor_proto.device_detail().device_type() != PROTO_CPU ||
+        tensor_proto.data_type() == TensorProto_DataType_BYTE ||
+        tensor_proto.data_type() == TensorProto_DataType_UNDEFINED) {
+      return false;
+    }
+    Tensor* tensor = BlobGetMutableTensor(blob, CPU);
+    const vector<int64_t> dims(
+        tensor_proto.dims().begin(), tensor_proto.dims().end());
+    if (!tensor->dims().equals(dims)) {
+      tensor->Resize(dims);
+    }
+    tensor->raw_mutable_data(DataTypeToTypeMeta(tensor_proto.data_type()));
+    return true;
   }
 
   string buildBlobNameFromDbKey(const string& dbKey) {
@@ -288,7 +393,8 @@ class LoadOp final : public Operator<Context> {
       const BlobProto& proto,
       std::unordered_map<string, BlobState>* blob_states_ptr,
       const string& key,
-      int* loaded_blobs) {
+      int* loaded_blobs,
+      bool* deferred) {
     auto& blob_states = *blob_states_ptr;
     if (blob_states.count(key) == 0) {
       // We reset the blob so that any existing content is destroyed. This
@@ -298,7 +404,10 @@ class LoadOp final : public Operator<Context> {
       // different GPU.
       blob->Reset();
     }
-    DeserializeBlob(proto, blob);
+    *deferred = PreallocateTensor(blob, proto);
+    if (!*deferred) {
+      DeserializeBlob(proto, blob);
+    }
     if (proto.has_content_num_chunks()) {
       if (!blob_states.count(key)) {
         blob_states[key] = BlobState(proto.content_num_chunks());
@@ -402,6 +511,8 @@ class LoadOp final : public Operator<Context> {
   std::map<string, int> output_indices_;
   std::map<string, int> key_to_dbid_;
   std::vector<std::string> blob_names_;
+  std::vector<db::Record> records_;
+  std::vector<PendingBlob> pending_;
 };
 
 template <class Context>
@@ -43,6 +43,59 @@ void BlobToTensorDescriptor(
 }
 } // namespace
 
+OnnxifiGraph::~OnnxifiGraph() {
+  if (graph) {
+    if (lib->onnxReleaseGraph(graph) != ONNXIFI_STATUS_SUCCESS) {
+      LOG(ERROR) << "Error when calling onnxReleaseGraph";
+    }
+  }
+  if (backend) {
+    if (lib->onnxReleaseBackend(backend) != ONNXIFI_STATUS_SUCCESS) {
+      LOG(ERROR) << "Error when calling onnxReleaseBackend";
+    }
+  }
+  for (auto backend_id : backend_ids) {
+    if (lib->onnxReleaseBackendID(backend_id) != ONNXIFI_STATUS_SUCCESS) {
+      LOG(ERROR) << "Error when calling onnxReleaseBackendID";
+    }
+  }
+}
+
+void OnnxifiGraph::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  released_.wait(lock, [this] { return !acquired_; });
+  acquired_ = true;
+}
+
+void OnnxifiGraph::Release() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    acquired_ = false;
+  }
+  released_.notify_one();
+}
+
+std::shared_ptr<OnnxifiGraph> GetOrCreateOnnxifiGraph(
+    const std::string& key,
+    std::function<std::shared_ptr<OnnxifiGraph>()> create) {
+  static std::mutex cache_mutex;
+  static std::unordered_map<std::string, std::weak_ptr<OnnxifiGraph>> cache;
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  // Drop the graphs released since the last lookup
+  for (auto it = cache.begin(); it != cache.end();) {
+    it = it->second.expired() ? cache.erase(it) : std::next(it);
+  }
+  auto& cached = cache[key];
+  auto graph = cached.lock();
+  if (!graph) {
+    graph = create();
+    cached = graph;
+  } else {
+    VLOG(1) << "Reusing the ONNXIFI graph and weights of another op";
+  }
+  return graph;
+}
+
 template <>
 std::vector<onnxTensorDescriptorV1>
 OnnxifiOp<float, CPUContext>::BuildInitializationList(
@@ -72,8 +125,26 @@ OnnxifiOp<float, CPUContext>::BuildInitializationList(
   return descs;
 }
 
+template <>
+void OnnxifiOp<float, CPUContext>::FinishRun(
+    onnxEvent input_event,
+    onnxEvent output_event) {
+  const auto wait_status = lib_->onnxWaitEvent(output_event);
+  // Destroy the event objects
+  const auto input_release_status = lib_->onnxReleaseEvent(input_event);
+  const auto output_release_status = lib_->onnxReleaseEvent(output_event);
+  graph_->Release();
+  CAFFE_ENFORCE_EQ(wait_status, ONNXIFI_STATUS_SUCCESS);
+  CAFFE_ENFORCE_EQ(input_release_status, ONNXIFI_STATUS_SUCCESS);
+  CAFFE_ENFORCE_EQ(output_release_status, ONNXIFI_STATUS_SUCCESS);
+}
+
 template <>
 bool OnnxifiOp<float, CPUContext>::RunOnDevice() {
+  input_shapes_.clear();
+  output_shapes_.clear();
+  input_shapes_.reserve(InputSize());
+  output_shapes_.reserve(OutputSize());
   for (unsigned i = 0U; i < InputSize(); ++i) {
     const auto& input_tensor = Input(i);
     const auto tensor_dims = input_tensor.dims();
@@ -108,41 +179,55 @@ bool OnnxifiOp<float, CPUContext>::RunOnDevice() {
         reinterpret_cast<onnxPointer>(output_tensor->mutable_data<float>());
   }
 
-  CAFFE_ENFORCE_EQ(
-      lib_->onnxSetGraphIO(
-          graph_,
-          input_desc_.size(),
-          input_desc_.data(),
-          output_desc_.size(),
-          output_desc_.data()),
-      ONNXIFI_STATUS_SUCCESS);
-
+  graph_->Acquire();
   onnxMemoryFenceV1 input_fence;
   input_fence.tag = ONNXIFI_TAG_MEMORY_FENCE_V1;
   input_fence.type = ONNXIFI_SYNCHRONIZATION_EVENT;
-  CAFFE_ENFORCE_EQ(
-      lib_->onnxInitEvent(backend_, &input_fence.event),
-      ONNXIFI_STATUS_SUCCESS);
   onnxMemoryFenceV1 output_fence;
   output_fence.tag = ONNXIFI_TAG_MEMORY_FENCE_V1;
   output_fence.type = ONNXIFI_SYNCHRONIZATION_EVENT;
+  try {
+    CAFFE_ENFORCE_EQ(
+        lib_->onnxSetGraphIO(
+            graph_->graph,
+            input_desc_.size(),
+            input_desc_.data(),
+            output_desc_.size(),
+            output_desc_.data()),
+        ONNXIFI_STATUS_SUCCESS);
+    CAFFE_ENFORCE_EQ(
+        lib_->onnxInitEvent(graph_->backend, &input_fence.event),
+        ONNXIFI_STATUS_SUCCESS);
 
-  // Call the asycn run on backend, singal event on input fence and wait for the
-  // event on output fence
-  CAFFE_ENFORCE_EQ(
-      lib_->onnxSignalEvent(input_fence.event), ONNXIFI_STATUS_SUCCESS);
-  CAFFE_ENFORCE_EQ(
-      lib_->onnxRunGraph(graph_, &input_fence, &output_fence),
-      ONNXIFI_STATUS_SUCCESS);
-  CAFFE_ENFORCE_EQ(
-      lib_->onnxWaitEvent(output_fence.event), ONNXIFI_STATUS_SUCCESS);
-
-  // Destroy the event objects
-  CAFFE_ENFORCE_EQ(
-      lib_->onnxReleaseEvent(input_fence.event), ONNXIFI_STATUS_SUCCESS);
-  CAFFE_ENFORCE_EQ(
-      lib_->onnxReleaseEvent(output_fence.event), ONNXIFI_STATUS_SUCCESS);
+    // Call the asycn run on backend, singal event on input fence and wait for
+    // the event on output fence
+    CAFFE_ENFORCE_EQ(
+        lib_->onnxSignalEvent(input_fence.event), ONNXIFI_STATUS_SUCCESS);
+    CAFFE_ENFORCE_EQ(
+        lib_->onnxRunGraph(graph_->graph, &input_fence, &output_fence),
+        ONNXIFI_STATUS_SUCCESS);
+  } catch (...) {
+    graph_->Release();
+    throw;
+  }
 
+  if (!HasAsyncPart()) {
+    FinishRun(input_fence.event, output_fence.event);
+    return true;
+  }
+  // The host runs the next ops while a thread of the net's pool waits for the
+  // backend, ONNXIFI has no completion callbacks
+  const auto input_event = input_fence.event;
+  const auto output_event = output_fence.event;
+  GetExecutorHelper()->GetPool(device_option())->run(
+      [this, input_event, output_event]() {
+        try {
+          FinishRun(input_event, output_event);
+          event().SetFinished();
+        } catch (const std::exception& e) {
+          event().SetFinished(e.what());
+        }
+      });
   return true;
 }
 
@@ -158,5 +243,13 @@ OPERATOR_SCHEMA(Onnxifi)
         "(string default=\"\") Serialized ONNX model to be converted to backend representation")
     .Arg(
         "initializers",
-        "Initialization pair indicating the mapping of the name between NetDef and ONNX model");
+        "Initialization pair indicating the mapping of the name between NetDef and ONNX model")
+    .Arg(
+        "share_graph",
+        "(int default 0) Share the backend graph, and thus the uploaded "
+        "weights, with the ops that run the same model on the same weights")
+    .Arg(
+        "async",
+        "(int default 0) In async nets, return once the model is launched on "
+        "the backend and finish the op when the backend is done");
 } // namespace caffe2
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "onnx/onnx_pb.h"
@@ -12,12 +16,41 @@
 
 namespace caffe2 {
 
+// Backend and graph that an ONNX model and its weights were loaded into
+struct CAFFE2_API OnnxifiGraph {
+  explicit OnnxifiGraph(onnxifi_library* lib) : lib(lib) {}
+  ~OnnxifiGraph();
+
+  // Waits until the graph is not run by another op. Unlike a mutex, the graph
+  // can be released by another thread, the one waiting for the run to finish.
+  // onnxSetGraphIO and onnxRunGraph are not thread safe for a given graph.
+  void Acquire();
+  void Release();
+
+  onnxifi_library* lib;
+  std::vector<onnxBackendID> backend_ids;
+  onnxBackend backend{nullptr};
+  onnxGraph graph{nullptr};
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable released_;
+  bool acquired_{false};
+};
+
+// Returns the graph cached under key, or the graph built by create, which is
+// cached until the last op that uses it is destroyed
+CAFFE2_API std::shared_ptr<OnnxifiGraph> GetOrCreateOnnxifiGraph(
+    const std::string& key,
+    std::function<std::shared_ptr<OnnxifiGraph>()> create);
+
 template <typename T, typename Context>
 class OnnxifiOp final : public Operator<Context> {
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
   OnnxifiOp(const OperatorDef& operator_def, Workspace* ws)
-      : Operator<Context>(operator_def, ws) {
+      : Operator<Context>(operator_def, ws),
+        async_(this->template GetSingleArgument<int>("async", 0)) {
     lib_ = onnx::initOnnxifiLibrary();
     CAFFE_ENFORCE(lib_, "Cannot initialize ONNXIFI library");
     auto onnx_model_str =
@@ -73,55 +106,24 @@ class OnnxifiOp final : public Operator<Context> {
     auto weight_descs = BuildInitializationList(
         &mapped_ws, &initializer_set, &weight_names, &weight_shapes);
 
-    // Build the Onnxifi engine
-    // TODO: In spec, backends are hot-pluggable, so two calls to
-    // onnxGetBackendIDs may result in different number of backend. And we
-    // should retry until it get consistent. For now, we don't do that.
-    CAFFE_ENFORCE_EQ(
-        lib_->onnxGetBackendIDs(nullptr, &num_backends_),
-        ONNXIFI_STATUS_FALLBACK);
-    CAFFE_ENFORCE_GT(
-        num_backends_, 0, "At least 1 onnxifi backend should be available");
-    backend_ids_.resize(num_backends_);
-    CAFFE_ENFORCE_EQ(
-        lib_->onnxGetBackendIDs(backend_ids_.data(), &num_backends_),
-        ONNXIFI_STATUS_SUCCESS);
-
-    // TODO: choose backend id
-    CAFFE_ENFORCE_EQ(
-        lib_->onnxInitBackend(
-            backend_ids_[0], property_pointers.data(), &backend_),
-        ONNXIFI_STATUS_SUCCESS);
-    CAFFE_ENFORCE_EQ(
-        lib_->onnxInitGraph(
-            backend_,
-            nullptr,
-            onnx_model_str.size(),
-            (void*)(onnx_model_str.c_str()),
-            weight_descs.size(),
-            weight_descs.data(),
-            &graph_),
-        ONNXIFI_STATUS_SUCCESS);
+    // Build the Onnxifi engine. The ops that run the same model with the same
+    // weight buffers, e.g. in different predictor instances, can share it so
+    // that the weights are uploaded to the backend once.
+    auto create = [this, &onnx_model_str, &property_pointers, &weight_descs]() {
+      return CreateGraph(onnx_model_str, property_pointers, weight_descs);
+    };
+    if (this->template GetSingleArgument<int>("share_graph", 0)) {
+      graph_ = GetOrCreateOnnxifiGraph(
+          GraphKey(onnx_model_str, weight_descs), create);
+    } else {
+      graph_ = create();
+    }
   }
 
-  ~OnnxifiOp() {
-    if (graph_) {
-      if (lib_->onnxReleaseGraph(graph_) != ONNXIFI_STATUS_SUCCESS) {
-        LOG(ERROR) << "Error when calling onnxReleaseGraph";
-      }
-      graph_ = nullptr;
-    }
-    if (backend_) {
-      if (lib_->onnxReleaseBackend(backend_) != ONNXIFI_STATUS_SUCCESS) {
-        LOG(ERROR) << "Error when calling onnxReleaseBackend";
-      }
-      backend_ = nullptr;
-    }
-    for (unsigned i = 0; i < num_backends_; ++i) {
-      if (lib_->onnxReleaseBackendID(backend_ids_[i]) != ONNXIFI_STATUS_SUCCESS) {
-        LOG(ERROR) << "Error when calling onnxReleaseBackendID";
-      }
-    }
+  // Only async nets, which provide a pool to wait on the backend in, finish
+  // the op asynchronously
+  bool HasAsyncPart() const override {
+    return async_ && this->GetExecutorHelper();
   }
 
   bool RunOnDevice() override;
@@ -148,13 +150,66 @@ class OnnxifiOp final : public Operator<Context> {
       std::vector<std::string>* weight_names,
       std::vector<std::vector<uint64_t>>* weight_shapes);
 
+  std::shared_ptr<OnnxifiGraph> CreateGraph(
+      const std::string& onnx_model_str,
+      const std::vector<uint64_t>& property_pointers,
+      const std::vector<onnxTensorDescriptorV1>& weight_descs) {
+    std::shared_ptr<OnnxifiGraph> graph = std::make_shared<OnnxifiGraph>(lib_);
+    // TODO: In spec, backends are hot-pluggable, so two calls to
+    // onnxGetBackendIDs may result in different number of backend. And we
+    // should retry until it get consistent. For now, we don't do that.
+    size_t num_backends = 0;
+    CAFFE_ENFORCE_EQ(
+        lib_->onnxGetBackendIDs(nullptr, &num_backends),
+        ONNXIFI_STATUS_FALLBACK);
+    CAFFE_ENFORCE_GT(
+        num_backends, 0, "At least 1 onnxifi backend should be available");
+    graph->backend_ids.resize(num_backends);
+    CAFFE_ENFORCE_EQ(
+        lib_->onnxGetBackendIDs(graph->backend_ids.data(), &num_backends),
+        ONNXIFI_STATUS_SUCCESS);
+
+    // TODO: choose backend id
+    CAFFE_ENFORCE_EQ(
+        lib_->onnxInitBackend(
+            graph->backend_ids[0], property_pointers.data(), &graph->backend),
+        ONNXIFI_STATUS_SUCCESS);
+    CAFFE_ENFORCE_EQ(
+        lib_->onnxInitGraph(
+            graph->backend,
+            nullptr,
+            onnx_model_str.size(),
+            (void*)(onnx_model_str.c_str()),
+            weight_descs.size(),
+            weight_descs.data(),
+            &graph->graph),
+        ONNXIFI_STATUS_SUCCESS);
+    return graph;
+  }
+
+  // Identifies the model and the buffers of its weights
+  static std::string GraphKey(
+      const std::string& onnx_model_str,
+      const std::vector<onnxTensorDescriptorV1>& weight_descs) {
+    std::string key = onnx_model_str;
+    for (const auto& desc : weight_descs) {
+      key += c10::str(
+          '\0', desc.name, ':', desc.dataType, ':', desc.buffer, ':');
+      for (uint32_t i = 0; i < desc.dimensions; ++i) {
+        key += c10::str(desc.shape[i], ',');
+      }
+    }
+    return key;
+  }
+
+  // Waits for the output fence and releases the fences and the graph
+  void FinishRun(onnxEvent input_event, onnxEvent output_event);
+
   // pointer to loaded onnxifi library
   onnxifi_library* lib_{nullptr};
 
-  std::vector<onnxBackendID> backend_ids_;
-  onnxBackend backend_{nullptr};
-  onnxGraph graph_{nullptr};
-  size_t num_backends_{0};
+  std::shared_ptr<OnnxifiGraph> graph_;
+  bool async_;
 
   // input/output descriptors
   std::vector<onnxTensorDescriptorV1> input_desc_;
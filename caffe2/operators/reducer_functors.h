@@ -207,13 +207,8 @@ class MeanRangeReducer<T, CPUContext> {
       const T* in,
       T* out,
       CPUContext* /*context*/) {
-    for (int j = 0; j < block_size; ++j) {
-      T avg_value = 0;
-      for (int i = 0; i < blocks; ++i) {
-        avg_value += in[i * block_size + j] / blocks;
-      }
-      *(out++) = avg_value;
-    }
+    EigenVectorMap<T> out_vec(out, block_size);
+    out_vec = ConstEigenMatrixMap<T>(in, block_size, blocks).rowwise().mean();
   }
 };
 
@@ -228,14 +223,9 @@ class MeanRangeReducerGradient {
       const T* /*data_in*/, // I
       const T* /*data_out*/, // O
       Context* /*context*/) {
-    const auto in_grad = 1.0 / blocks;
-    for (int j = 0; j < block_size; ++j) {
-      const T out_grad = *(segment_grad++);
-      for (int i = 0; i < blocks; ++i) {
-        auto idx = i * block_size + j;
-        data_grad[idx] = out_grad * in_grad;
-      }
-    }
+    const T in_grad = 1.0 / blocks;
+    EigenMatrixMap<T>(data_grad, block_size, blocks).colwise() =
+        ConstEigenVectorMap<T>(segment_grad, block_size) * in_grad;
   }
 };
 
@@ -266,13 +256,9 @@ class MaxRangeReducer<T, CPUContext> {
       const T* in,
       T* out,
       CPUContext* /*context*/) {
-    for (int j = 0; j < block_size; ++j) {
-      T max_value = std::numeric_limits<T>::lowest();
-      for (int i = 0; i < blocks; ++i) {
-        max_value = std::max(max_value, in[i * block_size + j]);
-      }
-      *(out++) = max_value;
-    }
+    EigenVectorMap<T> out_vec(out, block_size);
+    out_vec =
+        ConstEigenMatrixMap<T>(in, block_size, blocks).rowwise().maxCoeff();
   }
 };
 
@@ -287,16 +273,13 @@ class MaxRangeReducerGradient {
       const T* data_in, // I
       const T* data_out, // O
       Context* /*context*/) {
-    std::memset(
-        static_cast<void*>(data_grad), 0, blocks * block_size * sizeof(T));
-    for (int j = 0; j < block_size; ++j) {
-      const T out_grad = *(segment_grad++);
-      const T out = data_out[j];
-      for (int i = 0; i < blocks; ++i) {
-        auto idx = i * block_size + j;
-        if (out == data_in[idx]) {
-          data_grad[idx] = out_grad;
-        }
+    // Walk the blocks in memory order, so that the loop over a block
+    // vectorizes
+    for (int64_t i = 0; i < blocks; ++i) {
+      const T* in = data_in + i * block_size;
+      T* grad = data_grad + i * block_size;
+      for (int64_t j = 0; j < block_size; ++j) {
+        grad[j] = in[j] == data_out[j] ? segment_grad[j] : T(0);
       }
     }
   }
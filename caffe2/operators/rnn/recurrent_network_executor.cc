@@ -146,27 +146,27 @@ void ThreadedRecurrentNetworkExecutor::WorkerFunction() {
   static std::atomic<int> seq(0);
   int id = seq.fetch_add(1);
 
+  // With limited timestep parallelism, a task must not start before
+  // enough earlier timesteps finished; Pop() waits for that instead of
+  // spinning on the queue.
+  auto admit = [this](const OpTask& job) {
+    return max_parallel_timesteps_ <= 0 ||
+        job.step() - finished_timesteps_ < max_parallel_timesteps_;
+  };
+
   while (!failed_) {
     OpTask job;
-    if (!task_queue_.Pop(&job)) {
+    if (!task_queue_.Pop(&job, admit)) {
       break;
     }
 
-    // Check for limited timestep parallelism, and if too many timesteps would
-    // be started concurrently, return the task to task queue.
-    if (max_parallel_timesteps_ > 0) {
-      int t = (job.direction == 1 ? job.timestep : job.T - job.timestep + 1);
-      if (t - finished_timesteps_ >= max_parallel_timesteps_) {
-        // Return to queue
-        task_queue_.Push(job);
-        continue;
-      }
-    }
-
     try {
       RunOp(job, id);
       if (job.op_idx == timestep_ops_template_.size() - 1) {
         finished_timesteps_.fetch_add(1);
+        if (max_parallel_timesteps_ > 0) {
+          task_queue_.Wake();
+        }
       }
       num_jobs++;
     } catch (::caffe2::EnforceNotMet& enf) {
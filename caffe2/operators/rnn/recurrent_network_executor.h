@@ -504,7 +504,7 @@ class CAFFE2_API ThreadedRecurrentNetworkExecutor : public RecurrentNetworkExecu
 
   void RunOp(OpTask job, int thread_id);
 
-  SimpleQueue<OpTask> task_queue_;
+  RNNTaskQueue task_queue_;
   std::atomic<int> countdown_;
   std::atomic<bool> failed_;
   std::atomic<int> finished_timesteps_;
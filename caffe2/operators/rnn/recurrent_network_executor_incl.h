@@ -2,6 +2,10 @@
 #ifndef CAFFE2_OPERATORS_RECURRENT_NETWORK_EXECUTOR_INCL_H_
 #define CAFFE2_OPERATORS_RECURRENT_NETWORK_EXECUTOR_INCL_H_
 
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
 #include <vector>
 #include "caffe2/core/operator.h"
 
@@ -67,6 +71,79 @@ struct OpTask {
   inline bool forward() {
     return direction == 1;
   }
+
+  // Number of timesteps that precede this one in the direction of execution
+  inline int step() const {
+    return direction == 1 ? timestep : T - 1 - timestep;
+  }
+};
+
+/**
+ * Thread-safe task queue of ThreadedRecurrentNetworkExecutor that hands out
+ * the ready op of the earliest timestep first (in the direction of execution),
+ * and within a timestep the earliest op. With stacked layers this runs the
+ * timesteps as a wavefront: layer l of step t + 1 starts as soon as its inputs
+ * are ready and runs in parallel with layer l + 1 of step t, while the oldest
+ * timestep, which is on the critical path, is never queued behind work of
+ * later timesteps.
+ */
+class RNNTaskQueue {
+ public:
+  // Pops the highest-priority task into *task once admit(task) holds, and
+  // returns false when the queue is closed. Tasks of later timesteps are never
+  // admitted before those of earlier ones, so waiting for the top suffices.
+  bool Pop(OpTask* task, const std::function<bool(const OpTask&)>& admit) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] {
+      return no_more_jobs_ || (!queue_.empty() && admit(queue_.top()));
+    });
+    if (no_more_jobs_) {
+      return false;
+    }
+    *task = queue_.top();
+    queue_.pop();
+    return true;
+  }
+
+  void Push(const OpTask& task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push(task);
+    }
+    cv_.notify_one();
+  }
+
+  // Re-evaluates the admission of waiting Pop() calls
+  void Wake() {
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    cv_.notify_all();
+  }
+
+  void NoMoreJobs() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      no_more_jobs_ = true;
+    }
+    cv_.notify_all();
+  }
+
+  int size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+  }
+
+ private:
+  struct LaterFirst {
+    bool operator()(const OpTask& a, const OpTask& b) const {
+      return a.step() > b.step() ||
+          (a.step() == b.step() && a.op_idx > b.op_idx);
+    }
+  };
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::priority_queue<OpTask, std::vector<OpTask>, LaterFirst> queue_;
+  bool no_more_jobs_ = false;
 };
 
 } // namespace caffe2
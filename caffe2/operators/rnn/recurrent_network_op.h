@@ -184,8 +184,15 @@ class RecurrentNetworkOp final : public Operator<Context> {
             false)),
         timestep_(this->template GetSingleArgument<std::string>(
             "timestep",
-            "timestep")) {
+            "timestep")),
+        fwdOnlyMaxParallelTimesteps_(this->template GetSingleArgument<int>(
+            "rnn_executor.max_parallel_timesteps",
+            4)) {
     CAFFE_ENFORCE(ws);
+    CAFFE_ENFORCE_GT(
+        fwdOnlyMaxParallelTimesteps_,
+        0,
+        "rnn_executor.max_parallel_timesteps must be positive");
 
     stepNetDef_ = detail::extractNetDef(operator_def, "step_net");
 
@@ -331,10 +338,12 @@ class RecurrentNetworkOp final : public Operator<Context> {
       stepWorkspaces.resize(seqLen);
     }
 
-    // In forward-only mode, we cycle over workspaces. This limits the amount
-    // of parallelism over timesteps that the RNNExecutor provides. So with
-    // RNN executor we use more workspaces to get better perf.
-    int num_workspaces_on_fwd_only = rnnExecutor_ ? 4 : 2;
+    // In forward-only mode, we cycle over workspaces, so that timestep t
+    // reuses the blobs of timestep t - num_workspaces_on_fwd_only. This limits
+    // the amount of parallelism over timesteps that the RNNExecutor provides.
+    // So with RNN executor we use more workspaces to get better perf, and
+    // rnn_executor.max_parallel_timesteps trades memory for parallelism.
+    int num_workspaces_on_fwd_only = rnnExecutor_ ? fwdOnlyMaxParallelTimesteps_ : 2;
 
     if (!has_backward_pass && stepWorkspaces.size() < num_workspaces_on_fwd_only) {
       // Use alternating stepWorkspaces when forward_only=True.
@@ -396,6 +405,7 @@ class RecurrentNetworkOp final : public Operator<Context> {
   std::vector<detail::OffsetAlias> aliases_;
   std::vector<detail::RecurrentInput> recurrentInputs_;
   std::string timestep_;
+  int fwdOnlyMaxParallelTimesteps_;
 };
 
 template <class Context>
@@ -1,6 +1,7 @@
 #ifndef CAFFE2_OPERATORS_SEGMENT_REDUCTION_OP_H_
 #define CAFFE2_OPERATORS_SEGMENT_REDUCTION_OP_H_
 
+#include "caffe2/core/common_omp.h"
 #include "caffe2/core/context.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/core/operator.h"
@@ -27,6 +28,51 @@ class BaseInputAccessor {
   const void* data_ = nullptr;
 };
 
+// Segments are reduced in parallel (with OpenMP) once the op touches at least
+// that many values. All the checks that can throw are done before, so that
+// the segments are reduced independently.
+constexpr int64_t kSegmentReductionParallelGrain = 32768;
+
+// Offsets of the segments of the sorted SEGMENT_IDS, which must not have
+// gaps: segment k is [offsets[k], offsets[k + 1]).
+template <typename SIndex>
+void SortedSegmentOffsets(
+    const SIndex* s_ids,
+    int64_t N,
+    vector<int64_t>* offsets) {
+  offsets->clear();
+  offsets->push_back(0);
+  if (N == 0) {
+    return;
+  }
+  CAFFE_ENFORCE_EQ(0, s_ids[0], "Indices must be sorted and not have gaps");
+  for (int64_t i = 1; i < N; ++i) {
+    if (s_ids[i] != s_ids[i - 1]) {
+      CAFFE_ENFORCE_EQ(
+          s_ids[i - 1] + 1,
+          s_ids[i],
+          "Indices must be sorted and not have gaps");
+      offsets->push_back(i);
+    }
+  }
+  offsets->push_back(N);
+}
+
+// Offsets of the segments of LENGTHS: segment k is
+// [offsets[k], offsets[k + 1]).
+template <typename TLengths>
+void LengthsToSegmentOffsets(
+    const TLengths* lengths,
+    int64_t numSegments,
+    vector<int64_t>* offsets) {
+  offsets->resize(numSegments + 1);
+  (*offsets)[0] = 0;
+  for (int64_t i = 0; i < numSegments; ++i) {
+    CAFFE_ENFORCE_GE(lengths[i], 0, "LENGTHS must be non-negative");
+    (*offsets)[i + 1] = (*offsets)[i] + lengths[i];
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Range reducer ops: leverage that input segment is continuous and allow
 // reducer functors to do something special
@@ -85,26 +131,20 @@ class AbstractSortedSegmentRangeOp : public Operator<Context> {
     int64_t block_size = dataInput.size() / N;
 
     // Assume the segments are sorted and there are no gaps
-    CAFFE_ENFORCE_EQ(0, s_ids[0], "Indices must be sorted and not have gaps");
-    for (int64_t i = 0; i < N;) {
-      int64_t start = i;
-      for (++i; i < N && s_ids[start] == s_ids[i]; ++i)
-        ;
-
+    SortedSegmentOffsets(s_ids, N, &offsets_);
+
+#ifdef _OPENMP
+#pragma omp parallel for if (N * block_size >= kSegmentReductionParallelGrain)
+#endif
+    for (int64_t k = 0; k < K; ++k) {
+      const int64_t start = offsets_[k];
+      const int64_t blocks = offsets_[k + 1] - start;
       RangeReducer()(
           block_size,
-          i - start,
-          inputAccessor_.getBlockPtr(block_size, start, i - start),
-          out + block_size * s_ids[start],
+          blocks,
+          inputAccessor_.getBlockPtr(block_size, start, blocks),
+          out + block_size * k,
           &context_);
-
-      // check correctness of the next segment
-      if (i < N) {
-        CAFFE_ENFORCE_EQ(
-            s_ids[start] + 1,
-            s_ids[i],
-            "Indices must be sorted and not have gaps");
-      }
     }
     return true;
   }
@@ -114,6 +154,7 @@ class AbstractSortedSegmentRangeOp : public Operator<Context> {
 
  private:
   InputAccessor inputAccessor_;
+  vector<int64_t> offsets_;
 };
 
 template <
@@ -156,39 +197,35 @@ class AbstractSortedSegmentRangeGradientOp : public Operator<Context> {
     int64_t block_size = segment_grads.size_from_dim(1);
 
     // Assume the segments are sorted and there are no gaps
-    CAFFE_ENFORCE_EQ(0, s_ids[0], "Indices must be sorted and not have gaps");
+    SortedSegmentOffsets(s_ids, N, &offsets_);
     // repeat the check from forward op
     CAFFE_ENFORCE_EQ(
         K - 1, s_ids[N - 1], "Indices must be sorted and not have gaps");
-    for (int64_t i = 0; i < N;) {
-      int64_t start = i;
-      for (++i; i < N && s_ids[start] == s_ids[i]; ++i)
-        ;
 
+#ifdef _OPENMP
+#pragma omp parallel for if (N * block_size >= kSegmentReductionParallelGrain)
+#endif
+    for (int64_t k = 0; k < K; ++k) {
+      const int64_t start = offsets_[k];
       auto expanded_idx = block_size * start;
-      auto reduced_idx = block_size * s_ids[start];
+      auto reduced_idx = block_size * k;
       RangeReducerGradient()(
           block_size,
-          i - start,
+          offsets_[k + 1] - start,
           s_grads + reduced_idx,
           out + expanded_idx,
           d_in + expanded_idx,
           d_out + reduced_idx,
           &context_);
-
-      // check correctness of the next segment
-      if (i < N) {
-        CAFFE_ENFORCE_EQ(
-            s_ids[start] + 1,
-            s_ids[i],
-            "Indices must be sorted and not have gaps");
-      }
     }
     return true;
   }
 
   static constexpr int kNumInputs = 4;
   INPUT_TAGS(DATA_IN, DATA_OUT, SEGMENT_GRADS, SEGMENT_IDS);
+
+ private:
+  vector<int64_t> offsets_;
 };
 
 template <typename T, typename SIndex, typename Context, typename ReducerDef>
@@ -624,7 +661,7 @@ class AbstractSortedSegmentOp : public Operator<Context> {
     int64_t N = segment_ids.dim(0);
     const int64_t M = dataInput.dim(0);
 
-    const IndexType* idxs;
+    const IndexType* idxs = nullptr;
     if (SparseFused) { // static if
       auto& indices = Input(INDICES);
       CAFFE_ENFORCE_EQ(1, indices.ndim(), "INDICES must be a vector");
@@ -675,36 +712,30 @@ class AbstractSortedSegmentOp : public Operator<Context> {
     int64_t out_block_size = output->size_from_dim(1);
 
     // Assume the segments are sorted and there are no gaps
-    CAFFE_ENFORCE_EQ(0, s_ids[0], "Indices must be sorted and not have gaps");
-    for (int64_t i = 0; i < N;) {
-      int64_t start = i;
+    SortedSegmentOffsets(s_ids, N, &offsets_);
+    if (SparseFused) { // static if
+      for (int64_t i = 0; i < N; ++i) {
+        CAFFE_ENFORCE(
+            0 <= idxs[i] && idxs[i] < M,
+            "Index out of bounds: ",
+            idxs[i],
+            ", range 0 to ",
+            M);
+      }
+    }
 
-      Reducer r(ctx, out + out_block_size * s_ids[start], &context_);
-      for (; i < N && s_ids[start] == s_ids[i]; ++i) {
-        IndexType idx;
-        if (SparseFused) { // static if
-          CAFFE_ENFORCE(
-              0 <= idxs[i] && idxs[i] < M,
-              "Index out of bounds: ",
-              idxs[i],
-              ", range 0 to ",
-              M);
-          idx = idxs[i];
-        } else {
-          idx = i;
-        }
+#ifdef _OPENMP
+#pragma omp parallel for if ( \
+    N * in_block_size >= kSegmentReductionParallelGrain)
+#endif
+    for (int64_t k = 0; k < K; ++k) {
+      Reducer r(ctx, out + out_block_size * k, &context_);
+      for (int64_t i = offsets_[k]; i < offsets_[k + 1]; ++i) {
+        const IndexType idx = SparseFused ? idxs[i] : i;
         r.template process<FixedSize>(
             ctx, inputAccessor_.getBlockPtr(in_block_size, idx), i, &context_);
       }
-
       r.template finish<FixedSize>(ctx, &context_);
-      // check correctness of the next segment
-      if (i < N) {
-        CAFFE_ENFORCE_EQ(
-            s_ids[start] + 1,
-            s_ids[i],
-            "Indices must be sorted and not have gaps");
-      }
     }
     return true;
   }
@@ -718,6 +749,7 @@ class AbstractSortedSegmentOp : public Operator<Context> {
 
  private:
   InputAccessor inputAccessor_;
+  vector<int64_t> offsets_;
 };
 
 // Gradient actually doesn't depend on whether sparse lookup is fused or not
@@ -775,32 +807,22 @@ class AbstractSortedSegmentGradientOp : public Operator<Context> {
     }
 
     // Assume the segments are sorted and there are no gaps
-    CAFFE_ENFORCE_EQ(0, s_ids[0], "Indices must be sorted and not have gaps");
+    SortedSegmentOffsets(s_ids, N, &offsets_);
     // repeat the check from forward op
     CAFFE_ENFORCE_EQ(
         K - 1, s_ids[N - 1], "Indices must be sorted and not have gaps");
-    for (int64_t i = 0; i < N;) {
-      int64_t start = i;
-      int64_t end = start;
-
-      if (ReducerGradient::computeLength()) {
-        for (; end < N && s_ids[start] == s_ids[end]; ++end) {
-        }
-      }
 
-      ReducerGradient r(ctx, s_grads + s_block_size * s_ids[start], &context_);
-      for (; i < N && s_ids[start] == s_ids[i]; ++i) {
+#ifdef _OPENMP
+#pragma omp parallel for if (N * d_block_size >= kSegmentReductionParallelGrain)
+#endif
+    for (int64_t k = 0; k < K; ++k) {
+      const int64_t start = offsets_[k];
+      const int64_t end = offsets_[k + 1];
+      ReducerGradient r(ctx, s_grads + s_block_size * k, &context_);
+      for (int64_t i = start; i < end; ++i) {
         r.template fillGrad<FixedSize>(
             ctx, out + d_block_size * i, i, &context_, end - start);
       }
-
-      // check correctness of the next segment
-      if (i < N) {
-        CAFFE_ENFORCE_EQ(
-            s_ids[start] + 1,
-            s_ids[i],
-            "Indices must be sorted and not have gaps");
-      }
     }
     return true;
   }
@@ -815,6 +837,9 @@ class AbstractSortedSegmentGradientOp : public Operator<Context> {
     SEGMENT_GRADS = ReducerGradient::originalInputs().size(),
     SEGMENT_IDS
   };
+
+ private:
+  vector<int64_t> offsets_;
 };
 
 // base implementation of sorted/unsorted sparse/non-sparse gradient computation
@@ -1028,7 +1053,7 @@ class AbstractUnsortedSegmentOp : public Operator<Context> {
     int64_t N = segment_ids.dim(0);
     const int64_t M = data.dim(0);
 
-    const IndexType* idxs;
+    const IndexType* idxs = nullptr;
     if (SparseFused) { // static if
       auto& indices = Input(INDICES);
       CAFFE_ENFORCE_EQ(1, indices.ndim(), "INDICES must be a vector");
@@ -1424,7 +1449,7 @@ class AbstractLengthsOp : public Operator<Context> {
     int64_t dataToReduceSize;
     const int64_t outputSize = lengthsInput.dim(0);
 
-    const IndexType* indices;
+    const IndexType* indices = nullptr;
     if (SparseFused) { // static if
       auto& indicesInput = Input(INDICES);
       CAFFE_ENFORCE_EQ(1, indicesInput.ndim(), "INDICES must be a vector");
@@ -1462,43 +1487,37 @@ class AbstractLengthsOp : public Operator<Context> {
     int64_t out_block_size = output->size_from_dim(1);
     TData* out = output->template mutable_data<TData>();
 
-    int64_t dataIndex = 0;
+    LengthsToSegmentOffsets(lengths, outputSize, &offsets_);
+    const int64_t dataIndex = offsets_[outputSize];
+    CAFFE_ENFORCE(
+        dataIndex == dataToReduceSize, dataIndex, " != ", dataToReduceSize);
+    if (SparseFused) { // static if
+      for (int64_t i = 0; i < dataToReduceSize; ++i) {
+        CAFFE_ENFORCE(
+            0 <= indices[i] && indices[i] < dataSize,
+            "The ",
+            i,
+            "th index from the input indices is out of bounds: ",
+            indices[i],
+            " vs. valid range 0 to ",
+            dataSize);
+      }
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for if ( \
+    dataToReduceSize * in_block_size >= kSegmentReductionParallelGrain)
+#endif
     for (int64_t rangeIndex = 0; rangeIndex < outputSize; ++rangeIndex) {
       Reducer reducer(ctx, out + out_block_size * rangeIndex, &context_);
-      for (int64_t start = dataIndex; dataIndex < start + lengths[rangeIndex];
-           ++dataIndex) {
-        IndexType idx;
-        if (SparseFused) { // static if
-          idx = indices[dataIndex];
-          CAFFE_ENFORCE(
-              0 <= idx && idx < dataSize,
-              "The ",
-              dataIndex,
-              "th index from the input indices is out of bounds: ",
-              idx,
-              " vs. valid range 0 to ",
-              dataSize);
-        } else {
-          idx = dataIndex;
-          CAFFE_ENFORCE(
-              0 <= idx && idx < dataSize,
-              "When calculating the ",
-              rangeIndex,
-              "th output with length=",
-              lengths[rangeIndex],
-              ", the index is out of bounds: ",
-              idx,
-              " vs. valid range 0 to ",
-              dataSize);
-        }
-
+      for (int64_t i = offsets_[rangeIndex]; i < offsets_[rangeIndex + 1];
+           ++i) {
+        const IndexType idx = SparseFused ? indices[i] : i;
         const TData* input = inputAccessor_.getBlockPtr(in_block_size, idx);
-        reducer.template process<FixedSize>(ctx, input, dataIndex, &context_);
+        reducer.template process<FixedSize>(ctx, input, i, &context_);
       }
       reducer.template finish<FixedSize>(ctx, &context_);
     }
-    CAFFE_ENFORCE(
-        dataIndex == dataToReduceSize, dataIndex, " != ", dataToReduceSize);
 
     return true;
   }
@@ -1512,6 +1531,7 @@ class AbstractLengthsOp : public Operator<Context> {
 
  private:
   InputAccessor inputAccessor_;
+  vector<int64_t> offsets_;
 };
 
 /*
@@ -1553,9 +1573,8 @@ class AbstractLengthsGradientOp : public Operator<Context> {
     CAFFE_ENFORCE(segmentGradsInput.ndim() > 0);
     CAFFE_ENFORCE(numSegments == segmentGradsInput.dim(0));
     const TLengths* lengths = lengthsInput.template data<TLengths>();
-    for (int64_t i = 0; i < numSegments; ++i) {
-      reducedDataSize += lengths[i];
-    }
+    LengthsToSegmentOffsets(lengths, numSegments, &offsets_);
+    reducedDataSize = offsets_[numSegments];
 
     typename ReducerGradient::Meta ctx(segmentGradsInput, 1);
     for (int i = 0; i < ReducerGradient::originalInputs().size(); ++i) {
@@ -1581,11 +1600,15 @@ class AbstractLengthsGradientOp : public Operator<Context> {
     int64_t segmentBlockSize = segmentGradsInput.size_from_dim(1);
     T* dataGrads = dataGradsOutput->template mutable_data<T>();
 
-    int64_t dataIndex = 0;
+#ifdef _OPENMP
+#pragma omp parallel for if ( \
+    reducedDataSize * dataGradsBlockSize >= kSegmentReductionParallelGrain)
+#endif
     for (int64_t rangeIndex = 0; rangeIndex < numSegments; ++rangeIndex) {
       ReducerGradient reducer(
           ctx, segmentGrads + segmentBlockSize * rangeIndex, &context_);
-      for (int64_t start = dataIndex; dataIndex < start + lengths[rangeIndex];
+      for (int64_t dataIndex = offsets_[rangeIndex];
+           dataIndex < offsets_[rangeIndex + 1];
            ++dataIndex) {
         reducer.template fillGrad<FixedSize>(
             ctx,
@@ -1595,8 +1618,6 @@ class AbstractLengthsGradientOp : public Operator<Context> {
             lengths[rangeIndex]);
       }
     }
-    CAFFE_ENFORCE(
-        dataIndex == reducedDataSize, dataIndex, " != ", reducedDataSize);
     return true;
   }
 
@@ -1611,6 +1632,9 @@ class AbstractLengthsGradientOp : public Operator<Context> {
     LENGTHS,
     INDICES
   };
+
+ private:
+  vector<int64_t> offsets_;
 };
 
 // Version of gradient that requires the main input and thus needs to receive
@@ -1691,11 +1715,21 @@ class AbstractLengthsWithMainInputGradientOp : public Operator<Context> {
     T* dataGrads = dataGradsOutput->template mutable_data<T>();
 
     const Tembedding* data = dataInput.template data<Tembedding>();
-    int64_t dataIndex = 0;
+    LengthsToSegmentOffsets(lengths, numSegments, &offsets_);
+    CAFFE_ENFORCE_EQ(
+        offsets_[numSegments],
+        dataToReduceSize,
+        "LENGTHS must sum to the number of reduced slices");
+
+#ifdef _OPENMP
+#pragma omp parallel for if ( \
+    dataToReduceSize * dataGradsBlockSize >= kSegmentReductionParallelGrain)
+#endif
     for (int64_t rangeIndex = 0; rangeIndex < numSegments; ++rangeIndex) {
       ReducerGradient reducer(
           ctx, segmentGrads + segmentBlockSize * rangeIndex, &context_);
-      for (int64_t start = dataIndex; dataIndex < start + lengths[rangeIndex];
+      for (int64_t dataIndex = offsets_[rangeIndex];
+           dataIndex < offsets_[rangeIndex + 1];
            ++dataIndex) {
         IndexType data_pos;
         // No range checking, should've been verified in forward pass
@@ -1729,6 +1763,9 @@ class AbstractLengthsWithMainInputGradientOp : public Operator<Context> {
     DATA_INPUT,
     INDICES,
   };
+
+ private:
+  vector<int64_t> offsets_;
 };
 
 // Version of gradient that requires the main input as well as the output of the
@@ -1788,12 +1825,21 @@ class AbstractLengthsWithMainInputAndForwardOutputGradientOp
     T* dataGrads = dataGradsOutput->template mutable_data<T>();
 
     const T* data = dataInput.template data<T>();
-
-    int64_t dataIndex = 0;
+    LengthsToSegmentOffsets(lengths, numSegments, &offsets_);
+    CAFFE_ENFORCE_EQ(
+        offsets_[numSegments],
+        dataToReduceSize,
+        "LENGTHS must sum to the number of reduced slices");
+
+#ifdef _OPENMP
+#pragma omp parallel for if ( \
+    dataToReduceSize * dataGradsBlockSize >= kSegmentReductionParallelGrain)
+#endif
     for (int64_t rangeIndex = 0; rangeIndex < numSegments; ++rangeIndex) {
       ReducerGradient reducer(
           ctx, segmentGrads + segmentBlockSize * rangeIndex, &context_);
-      for (int64_t start = dataIndex; dataIndex < start + lengths[rangeIndex];
+      for (int64_t dataIndex = offsets_[rangeIndex];
+           dataIndex < offsets_[rangeIndex + 1];
            ++dataIndex) {
         // No range checking, should've been verified in forward pass
         reducer.template fillGradWithMainInputAndForwardOutput<FixedSize>(
@@ -1822,6 +1868,9 @@ class AbstractLengthsWithMainInputAndForwardOutputGradientOp
     LENGTHS,
     DATA_INPUT,
   };
+
+ private:
+  vector<int64_t> offsets_;
 };
 
 // base implementation of sparse/non-sparse gradient computation
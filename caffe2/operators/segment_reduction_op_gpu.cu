@@ -3,6 +3,8 @@
 #include <cub/device/device_scan.cuh>
 #include "caffe2/core/context_gpu.h"
 #include "caffe2/core/operator.h"
+#include "caffe2/utils/GpuDefs.cuh"
+#include "caffe2/utils/conversions.h"
 #include "caffe2/utils/math.h"
 
 
@@ -296,6 +298,151 @@ __global__ void sparse_length_sum_kernel(
   }
 }
 
+// Reads kVecSize consecutive values of a row with one 128-bit load, and
+// converts them to float
+template <typename T>
+struct RowVectorLoader;
+
+template <>
+struct RowVectorLoader<float> {
+  static constexpr int kVecSize = 4;
+
+  static __device__ __forceinline__ void Load(const float* in, float* out) {
+    const float4 v = __ldg(reinterpret_cast<const float4*>(in));
+    out[0] = v.x;
+    out[1] = v.y;
+    out[2] = v.z;
+    out[3] = v.w;
+  }
+};
+
+template <>
+struct RowVectorLoader<at::Half> {
+  static constexpr int kVecSize = 8;
+
+  static __device__ __forceinline__ void Load(const at::Half* in, float* out) {
+    const float4 v = __ldg(reinterpret_cast<const float4*>(in));
+    const at::Half* values = reinterpret_cast<const at::Half*>(&v);
+#pragma unroll
+    for (int i = 0; i < kVecSize; ++i) {
+      out[i] = convert::To<at::Half, float>(values[i]);
+    }
+  }
+};
+
+// Reduces a segment per warp instead of per block: the lanes of a warp read
+// consecutive columns of every looked up row, so short segments of wide rows
+// keep the whole warp busy. The sum is in float whatever the type of the
+// data, and weights are optional.
+template <typename T, typename IndexType, bool Vectorized, bool Average>
+__global__ void sparse_length_sum_warp_kernel(
+    const T* __restrict__ in,
+    const float* __restrict__ weights,
+    float* __restrict__ out,
+    const int* __restrict__ prefix_sum_length_data,
+    const IndexType* __restrict__ indices,
+    int post,
+    int len_length,
+    int len_indices) {
+  // blockDim.y segments per block
+  const int group = blockIdx.x * blockDim.y + threadIdx.y;
+  if (group >= len_length) {
+    return;
+  }
+
+  const int start = group == 0 ? 0 : prefix_sum_length_data[group - 1];
+  const int end = prefix_sum_length_data[group];
+  CUDA_KERNEL_ASSERT(start <= len_indices);
+  CUDA_KERNEL_ASSERT(end <= len_indices);
+
+  const float scale =
+      Average && (end - start) > 1 ? 1.0f / (end - start) : 1.0f;
+  float* out_row = out + static_cast<int64_t>(group) * post;
+
+  if (Vectorized) {
+    constexpr int kVecSize = RowVectorLoader<T>::kVecSize;
+    for (int i = threadIdx.x * kVecSize; i < post; i += blockDim.x * kVecSize) {
+      float sum[kVecSize] = {0};
+      for (int line = start; line < end; ++line) {
+        const float weight = weights == nullptr ? 1.0f : weights[line];
+        float values[kVecSize];
+        RowVectorLoader<T>::Load(
+            in + static_cast<int64_t>(indices[line]) * post + i, values);
+#pragma unroll
+        for (int j = 0; j < kVecSize; ++j) {
+          sum[j] += weight * values[j];
+        }
+      }
+#pragma unroll
+      for (int j = 0; j < kVecSize; ++j) {
+        out_row[i + j] = sum[j] * scale;
+      }
+    }
+  } else {
+    for (int i = threadIdx.x; i < post; i += blockDim.x) {
+      float sum = 0.0f;
+      for (int line = start; line < end; ++line) {
+        const float weight = weights == nullptr ? 1.0f : weights[line];
+        sum += weight *
+            convert::To<T, float>(
+                   in[static_cast<int64_t>(indices[line]) * post + i]);
+      }
+      out_row[i] = sum * scale;
+    }
+  }
+}
+
+// Reads a float that may not be aligned, as the scale and bias of the rows of
+// fused 8-bit rowwise quantized data
+__device__ __forceinline__ float LoadUnalignedFloat(const uint8_t* in) {
+  const unsigned int bits = in[0] | (in[1] << 8) | (in[2] << 16) |
+      (static_cast<unsigned int>(in[3]) << 24);
+  return __uint_as_float(bits);
+}
+
+// Same as sparse_length_sum_warp_kernel, for fused 8-bit rowwise quantized
+// data: every row holds post uint8 values followed by a float scale and a
+// float bias.
+template <typename IndexType, bool Average>
+__global__ void sparse_length_sum_fused_8bit_rowwise_kernel(
+    const uint8_t* __restrict__ in,
+    const float* __restrict__ weights,
+    float* __restrict__ out,
+    const int* __restrict__ prefix_sum_length_data,
+    const IndexType* __restrict__ indices,
+    int row_bytes,
+    int post,
+    int len_length,
+    int len_indices) {
+  // blockDim.y segments per block
+  const int group = blockIdx.x * blockDim.y + threadIdx.y;
+  if (group >= len_length) {
+    return;
+  }
+
+  const int start = group == 0 ? 0 : prefix_sum_length_data[group - 1];
+  const int end = prefix_sum_length_data[group];
+  CUDA_KERNEL_ASSERT(start <= len_indices);
+  CUDA_KERNEL_ASSERT(end <= len_indices);
+
+  const float scale =
+      Average && (end - start) > 1 ? 1.0f / (end - start) : 1.0f;
+  float* out_row = out + static_cast<int64_t>(group) * post;
+
+  for (int i = threadIdx.x; i < post; i += blockDim.x) {
+    float sum = 0.0f;
+    for (int line = start; line < end; ++line) {
+      const uint8_t* row =
+          in + static_cast<int64_t>(indices[line]) * row_bytes;
+      const float weight = weights == nullptr ? 1.0f : weights[line];
+      sum += weight *
+          (LoadUnalignedFloat(row + post) * row[i] +
+           LoadUnalignedFloat(row + post + sizeof(float)));
+    }
+    out_row[i] = sum * scale;
+  }
+}
+
 template <typename T, typename IndexType, bool ExactBlock = false>
 __global__ void sparse_length_max_kernel(
     const T* __restrict__ in,
@@ -405,6 +552,102 @@ __global__ void sparse_length_weighted_sum_kernel(
   }
 }
 
+// Segments reduced by a block of the warp per segment kernels
+constexpr int kSegmentsPerBlock = 4;
+
+// The warp per segment kernels beat the block per segment ones when rows are
+// wide enough to occupy a warp, and segments are short on average, so that a
+// block of post threads would mostly wait on few rows
+inline bool
+UseWarpPerSegment(int post, int64_t len_indices, int64_t len_length) {
+  return post >= kWarpSize && len_indices <= kWarpSize * len_length;
+}
+
+template <typename T, typename IndexType, bool Average>
+void LaunchSparseLengthsSumWarpKernel(
+    const T* in,
+    const float* weights,
+    float* out,
+    const int* prefix_sum_length_data,
+    const IndexType* indices,
+    int post,
+    int len_length,
+    int len_indices,
+    CUDAContext* context) {
+  const dim3 block(kWarpSize, kSegmentsPerBlock);
+  const int grid = (len_length + kSegmentsPerBlock - 1) / kSegmentsPerBlock;
+  if (post % RowVectorLoader<T>::kVecSize == 0) {
+    sparse_length_sum_warp_kernel<T, IndexType, true, Average>
+        <<<grid, block, 0, context->cuda_stream()>>>(
+            in,
+            weights,
+            out,
+            prefix_sum_length_data,
+            indices,
+            post,
+            len_length,
+            len_indices);
+  } else {
+    sparse_length_sum_warp_kernel<T, IndexType, false, Average>
+        <<<grid, block, 0, context->cuda_stream()>>>(
+            in,
+            weights,
+            out,
+            prefix_sum_length_data,
+            indices,
+            post,
+            len_length,
+            len_indices);
+  }
+}
+
+// SparseLengths{Sum,WeightedSum,Mean} of a float16 table, which is always
+// reduced in float by the warp per segment kernel into a float output
+template <typename IndexType, bool Average>
+bool SparseLengthsHalfSum(
+    const Tensor& dataInput,
+    const float* weights,
+    const Tensor& indicesInput,
+    const Tensor& lengthsInput,
+    Tensor* output,
+    Tensor* inclusive_scan_buffer,
+    Tensor* inclusive_scan_length_buffer,
+    CUDAContext* context) {
+  CAFFE_ENFORCE_EQ(1, indicesInput.ndim(), "INDICES must be a vector");
+  CAFFE_ENFORCE_EQ(1, lengthsInput.ndim(), "LENGTHS must be a vector");
+  const int len_length = lengthsInput.dim(0);
+
+  auto shape = dataInput.dims().vec();
+  shape[0] = len_length;
+  output->Resize(shape);
+  float* out_data = output->template mutable_data<float>();
+
+  if (len_length <= 0) {
+    // return early to avoid invalid empty kernel
+    return true;
+  }
+
+  inclusive_scan_length_buffer->ResizeLike(lengthsInput);
+  inclusive_scan_wrapper(
+      lengthsInput.template data<int>(),
+      len_length,
+      inclusive_scan_buffer,
+      inclusive_scan_length_buffer,
+      context);
+
+  LaunchSparseLengthsSumWarpKernel<at::Half, IndexType, Average>(
+      dataInput.template data<at::Half>(),
+      weights,
+      out_data,
+      inclusive_scan_length_buffer->template data<int>(),
+      indicesInput.template data<IndexType>(),
+      dataInput.size_from_dim(1),
+      len_length,
+      indicesInput.dim(0),
+      context);
+  return true;
+}
+
 } // namespace
 
 template <typename T, class Context = CUDAContext, bool SparseFused = true>
@@ -418,6 +661,10 @@ class CUDASparseLengthsSumOp : public Operator<CUDAContext> {
 
   bool RunOnDevice() override {
     if (SparseFused) {
+      if (Input(0).template IsType<at::Half>()) {
+        return DispatchHelper<TensorTypes2<int32_t, int64_t>>::call(
+            this, Input(INDICES));
+      }
       return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
           this, Input(INDICES));
     } else {
@@ -477,7 +724,18 @@ class CUDASparseLengthsSumOp : public Operator<CUDAContext> {
     auto maxThreads =
         GetDeviceProperty(CaffeCudaGetDevice()).maxThreadsPerBlock;
     if (SparseFused) {
-      if (post <= maxThreads) {
+      if (UseWarpPerSegment(post, dataToReduceSize, len_length)) {
+        LaunchSparseLengthsSumWarpKernel<T, IndexType, false>(
+            in_data,
+            nullptr,
+            out_data,
+            prefix_sum_length_data,
+            indices,
+            post,
+            len_length,
+            dataToReduceSize,
+            &context_);
+      } else if (post <= maxThreads) {
         int multiple = std::min(maxThreads / post, 16);
         dim3 block(post, multiple);
         size_t smem = sizeof(T) * post * multiple;
@@ -520,6 +778,20 @@ class CUDASparseLengthsSumOp : public Operator<CUDAContext> {
     return true;
   }
 
+  // float16 tables
+  template <typename IndexType>
+  bool DoRunWithType2() {
+    return SparseLengthsHalfSum<IndexType, false>(
+        Input(0),
+        nullptr,
+        Input(INDICES),
+        Input(LENGTHS),
+        Output(0),
+        &inclusive_scan_buffer_,
+        &inclusive_scan_length_buffer_,
+        &context_);
+  }
+
   enum { INDICES = 1, LENGTHS = 1 + (SparseFused ? 1 : 0) };
 
  private:
@@ -539,6 +811,10 @@ class CUDASparseLengthsMeanOp : public Operator<CUDAContext> {
 
   bool RunOnDevice() override {
     if (SparseFused) {
+      if (Input(0).template IsType<at::Half>()) {
+        return DispatchHelper<TensorTypes2<int32_t, int64_t>>::call(
+            this, Input(INDICES));
+      }
       return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
           this, Input(INDICES));
     } else {
@@ -598,7 +874,18 @@ class CUDASparseLengthsMeanOp : public Operator<CUDAContext> {
     auto maxThreads =
         GetDeviceProperty(CaffeCudaGetDevice()).maxThreadsPerBlock;
     if (SparseFused) {
-      if (post <= maxThreads) {
+      if (UseWarpPerSegment(post, dataToReduceSize, len_length)) {
+        LaunchSparseLengthsSumWarpKernel<T, IndexType, true>(
+            in_data,
+            nullptr,
+            out_data,
+            prefix_sum_length_data,
+            indices,
+            post,
+            len_length,
+            dataToReduceSize,
+            &context_);
+      } else if (post <= maxThreads) {
         int multiple = std::min(maxThreads / post, 16);
         dim3 block(post, multiple);
         size_t smem = sizeof(T) * post * multiple;
@@ -642,6 +929,20 @@ class CUDASparseLengthsMeanOp : public Operator<CUDAContext> {
     return true;
   }
 
+  // float16 tables
+  template <typename IndexType>
+  bool DoRunWithType2() {
+    return SparseLengthsHalfSum<IndexType, true>(
+        Input(0),
+        nullptr,
+        Input(INDICES),
+        Input(LENGTHS),
+        Output(0),
+        &inclusive_scan_buffer_,
+        &inclusive_scan_length_buffer_,
+        &context_);
+  }
+
   enum { INDICES = 1, LENGTHS = 1 + (SparseFused ? 1 : 0) };
 
  private:
@@ -794,6 +1095,10 @@ class CUDASparseLengthsWeightedSumOp : public Operator<CUDAContext> {
   ~CUDASparseLengthsWeightedSumOp() {}
 
   bool RunOnDevice() override {
+    if (Input(DATA).template IsType<at::Half>()) {
+      return DispatchHelper<TensorTypes2<int32_t, int64_t>>::call(
+          this, Input(INDICES));
+    }
     return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
         this, Input(INDICES));
   }
@@ -844,7 +1149,18 @@ class CUDASparseLengthsWeightedSumOp : public Operator<CUDAContext> {
 
     auto maxThreads =
         GetDeviceProperty(CaffeCudaGetDevice()).maxThreadsPerBlock;
-    if (post <= maxThreads) {
+    if (UseWarpPerSegment(post, dataToReduceSize, len_length)) {
+      LaunchSparseLengthsSumWarpKernel<T, IndexType, false>(
+          in_data,
+          in_weights,
+          out_data,
+          prefix_sum_length_data,
+          indices,
+          post,
+          len_length,
+          dataToReduceSize,
+          &context_);
+    } else if (post <= maxThreads) {
       int multiple = std::min(maxThreads / post, 16);
       dim3 block(post, multiple);
       size_t smem = sizeof(T) * post * multiple;
@@ -876,6 +1192,26 @@ class CUDASparseLengthsWeightedSumOp : public Operator<CUDAContext> {
     return true;
   }
 
+  // float16 tables, the weights are float
+  template <typename IndexType>
+  bool DoRunWithType2() {
+    auto& weightsInput = Input(WEIGHTS);
+    CAFFE_ENFORCE_EQ(1, weightsInput.ndim(), "WEIGHTS must be a vector");
+    CAFFE_ENFORCE_EQ(
+        weightsInput.size(),
+        Input(INDICES).size(),
+        "WEIGHTS should have the same length as INDICES.");
+    return SparseLengthsHalfSum<IndexType, false>(
+        Input(DATA),
+        weightsInput.template data<float>(),
+        Input(INDICES),
+        Input(LENGTHS),
+        Output(0),
+        &inclusive_scan_buffer_,
+        &inclusive_scan_length_buffer_,
+        &context_);
+  }
+
   enum { DATA = 0, WEIGHTS = 1, INDICES = 2, LENGTHS = 3 };
 
  private:
@@ -884,6 +1220,95 @@ class CUDASparseLengthsWeightedSumOp : public Operator<CUDAContext> {
   Tensor inclusive_scan_length_buffer_{CUDA};
 };
 
+template <bool with_weights = false, bool is_mean = false>
+class CUDASparseLengthsFused8BitRowwiseOp : public Operator<CUDAContext> {
+ public:
+  static_assert(
+      !(with_weights && is_mean),
+      "Cannot have with_weights and is_mean a the same time");
+
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  CUDASparseLengthsFused8BitRowwiseOp(
+      const OperatorDef& operator_def,
+      Workspace* ws)
+      : Operator<CUDAContext>(operator_def, ws) {}
+
+  bool RunOnDevice() override {
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
+        this, Input(INDICES));
+  }
+
+  template <typename IndexType>
+  bool DoRunWithType() {
+    auto& dataInput = Input(DATA);
+    auto& indicesInput = Input(INDICES);
+    auto& lengthsInput = Input(LENGTHS);
+    auto* output = Output(0);
+
+    CAFFE_ENFORCE_EQ(1, indicesInput.ndim(), "INDICES must be a vector");
+    CAFFE_ENFORCE_EQ(1, lengthsInput.ndim(), "LENGTHS must be a vector");
+
+    const float* weights = nullptr;
+    if (with_weights) {
+      auto& weightsInput = Input(WEIGHTS);
+      CAFFE_ENFORCE_EQ(1, weightsInput.ndim(), "WEIGHTS must be a vector");
+      CAFFE_ENFORCE_EQ(
+          weightsInput.size(),
+          indicesInput.size(),
+          "WEIGHTS should have the same length as INDICES.");
+      weights = weightsInput.template data<float>();
+    }
+
+    CAFFE_ENFORCE_GT(dataInput.dim(1), 8, "DATA must have more than 8 columns");
+    // The last 8 bytes of every row are the float scale and bias
+    const int row_bytes = dataInput.dim(1);
+    const int post = row_bytes - 2 * sizeof(float);
+    const int len_length = lengthsInput.dim(0);
+    output->Resize(len_length, post);
+    float* out_data = output->template mutable_data<float>();
+
+    if (len_length <= 0) {
+      // return early to avoid invalid empty kernel
+      return true;
+    }
+
+    inclusive_scan_length_buffer_.ResizeLike(lengthsInput);
+    inclusive_scan_wrapper(
+        lengthsInput.template data<int>(),
+        len_length,
+        &inclusive_scan_buffer_,
+        &inclusive_scan_length_buffer_,
+        &context_);
+
+    const dim3 block(kWarpSize, kSegmentsPerBlock);
+    const int grid = (len_length + kSegmentsPerBlock - 1) / kSegmentsPerBlock;
+    sparse_length_sum_fused_8bit_rowwise_kernel<IndexType, is_mean>
+        <<<grid, block, 0, context_.cuda_stream()>>>(
+            dataInput.template data<uint8_t>(),
+            weights,
+            out_data,
+            inclusive_scan_length_buffer_.template data<int>(),
+            indicesInput.template data<IndexType>(),
+            row_bytes,
+            post,
+            len_length,
+            indicesInput.dim(0));
+    return true;
+  }
+
+  enum {
+    DATA = 0,
+    WEIGHTS = 1,
+    INDICES = 1 + with_weights,
+    LENGTHS = 2 + with_weights,
+  };
+
+ private:
+  // menber field to manage memory
+  Tensor inclusive_scan_buffer_{CUDA};
+  Tensor inclusive_scan_length_buffer_{CUDA};
+};
+
 template <typename SIndex>
 __global__ void
 MaxSegmentKernel(int n, const SIndex* segment_ids, SIndex* max_segment) {
@@ -1266,6 +1691,15 @@ REGISTER_CUDA_OPERATOR_STR(
 REGISTER_CUDA_OPERATOR_STR(
     "SparseLengthsWeightedSum",
     CUDASparseLengthsWeightedSumOp<float, CUDAContext, true>);
+REGISTER_CUDA_OPERATOR_STR(
+    "SparseLengthsSumFused8BitRowwise",
+    CUDASparseLengthsFused8BitRowwiseOp<false, false>);
+REGISTER_CUDA_OPERATOR_STR(
+    "SparseLengthsWeightedSumFused8BitRowwise",
+    CUDASparseLengthsFused8BitRowwiseOp<true, false>);
+REGISTER_CUDA_OPERATOR_STR(
+    "SparseLengthsMeanFused8BitRowwise",
+    CUDASparseLengthsFused8BitRowwiseOp<false, true>);
 REGISTER_CUDA_OPERATOR_STR(
     "UnsortedSegmentSum",
     CUDAUnsortedSegmentSumOp<float, int, false>);
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <gtest/gtest.h>
+#include "caffe2/core/operator.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Large enough for the segments to be reduced in parallel
+constexpr int64_t kRows = 4096;
+constexpr int64_t kBlockSize = 16;
+
+void RunOp(
+    const string& type,
+    const vector<string>& inputs,
+    const string& output,
+    Workspace* ws) {
+  OperatorDef def;
+  def.set_type(type);
+  for (const auto& input : inputs) {
+    def.add_input(input);
+  }
+  def.add_output(output);
+  unique_ptr<OperatorBase> op(CreateOperator(def, ws));
+  ASSERT_NE(nullptr, op.get());
+  ASSERT_TRUE(op->Run());
+}
+
+TensorCPU* AddInput(Workspace* ws, const string& name) {
+  return BlobGetMutableTensor(ws->CreateBlob(name), CPU);
+}
+
+const TensorCPU& Get(Workspace* ws, const string& name) {
+  return ws->GetBlob(name)->Get<TensorCPU>();
+}
+
+// Segment lengths summing to kRows, with empty segments if allow_empty
+vector<int> MakeLengths(bool allow_empty) {
+  vector<int> lengths;
+  int64_t total = 0;
+  for (int i = 0; total < kRows; ++i) {
+    const int length =
+        std::min<int64_t>(i % 7 + (allow_empty ? 0 : 1), kRows - total);
+    lengths.push_back(length);
+    total += length;
+  }
+  return lengths;
+}
+
+void FillData(Workspace* ws) {
+  auto* data = AddInput(ws, "data");
+  data->Resize(kRows, kBlockSize);
+  for (int64_t i = 0; i < data->size(); ++i) {
+    data->mutable_data<float>()[i] = std::sin(i * 0.37f) * (i % 11);
+  }
+}
+
+void FillSegmentGrads(Workspace* ws, int64_t segments) {
+  auto* grads = AddInput(ws, "segment_grads");
+  grads->Resize(segments, kBlockSize);
+  for (int64_t i = 0; i < grads->size(); ++i) {
+    grads->mutable_data<float>()[i] = std::cos(i * 0.11f);
+  }
+}
+
+} // namespace
+
+TEST(SegmentReductionTest, LengthsOps) {
+  Workspace ws;
+  FillData(&ws);
+  const auto lengths = MakeLengths(/*allow_empty=*/true);
+  const int64_t segments = lengths.size();
+  auto* lengthsTensor = AddInput(&ws, "lengths");
+  lengthsTensor->Resize(segments);
+  std::copy(
+      lengths.begin(), lengths.end(), lengthsTensor->mutable_data<int>());
+  auto* indices = AddInput(&ws, "indices");
+  indices->Resize(kRows);
+  for (int64_t i = 0; i < kRows; ++i) {
+    indices->mutable_data<int>()[i] = i;
+  }
+  FillSegmentGrads(&ws, segments);
+
+  RunOp("LengthsSum", {"data", "lengths"}, "sum", &ws);
+  RunOp("LengthsMean", {"data", "lengths"}, "mean", &ws);
+  RunOp("LengthsMax", {"data", "lengths"}, "max", &ws);
+  RunOp(
+      "LengthsSumGradient",
+      {"segment_grads", "lengths", "indices"},
+      "sum_grad",
+      &ws);
+  RunOp(
+      "LengthsMeanGradient",
+      {"segment_grads", "lengths", "indices"},
+      "mean_grad",
+      &ws);
+  RunOp(
+      "LengthsMaxWithMainInputAndForwardOutputGradient",
+      {"max", "segment_grads", "lengths", "data"},
+      "max_grad",
+      &ws);
+
+  const float* data = Get(&ws, "data").data<float>();
+  const float* segmentGrads = Get(&ws, "segment_grads").data<float>();
+  const float* sum = Get(&ws, "sum").data<float>();
+  const float* mean = Get(&ws, "mean").data<float>();
+  const float* max = Get(&ws, "max").data<float>();
+  const float* sumGrad = Get(&ws, "sum_grad").data<float>();
+  const float* meanGrad = Get(&ws, "mean_grad").data<float>();
+  const float* maxGrad = Get(&ws, "max_grad").data<float>();
+  ASSERT_EQ(Get(&ws, "sum").dim(0), segments);
+  ASSERT_EQ(Get(&ws, "sum_grad").dim(0), kRows);
+
+  int64_t row = 0;
+  for (int64_t k = 0; k < segments; ++k) {
+    for (int64_t j = 0; j < kBlockSize; ++j) {
+      float expectedSum = 0;
+      float expectedMax = lengths[k] ? std::numeric_limits<float>::lowest() : 0;
+      for (int64_t i = row; i < row + lengths[k]; ++i) {
+        expectedSum += data[i * kBlockSize + j];
+        expectedMax = std::max(expectedMax, data[i * kBlockSize + j]);
+      }
+      const auto out = k * kBlockSize + j;
+      EXPECT_NEAR(sum[out], expectedSum, 1e-4);
+      EXPECT_NEAR(mean[out], lengths[k] ? expectedSum / lengths[k] : 0, 1e-4);
+      EXPECT_EQ(max[out], expectedMax);
+      for (int64_t i = row; i < row + lengths[k]; ++i) {
+        const auto in = i * kBlockSize + j;
+        EXPECT_EQ(sumGrad[in], segmentGrads[out]);
+        EXPECT_NEAR(meanGrad[in], segmentGrads[out] / lengths[k], 1e-6);
+        EXPECT_EQ(maxGrad[in], data[in] == max[out] ? segmentGrads[out] : 0);
+      }
+    }
+    row += lengths[k];
+  }
+}
+
+TEST(SegmentReductionTest, SortedSegmentOps) {
+  Workspace ws;
+  FillData(&ws);
+  const auto lengths = MakeLengths(/*allow_empty=*/false);
+  const int64_t segments = lengths.size();
+  auto* segmentIds = AddInput(&ws, "segment_ids");
+  segmentIds->Resize(kRows);
+  int64_t row = 0;
+  for (int64_t k = 0; k < segments; ++k) {
+    for (int i = 0; i < lengths[k]; ++i) {
+      segmentIds->mutable_data<int>()[row++] = k;
+    }
+  }
+  FillSegmentGrads(&ws, segments);
+
+  RunOp("SortedSegmentSum", {"data", "segment_ids"}, "sum", &ws);
+  RunOp("SortedSegmentRangeMean", {"data", "segment_ids"}, "mean", &ws);
+  RunOp("SortedSegmentRangeMax", {"data", "segment_ids"}, "max", &ws);
+  RunOp(
+      "SortedSegmentMeanGradient",
+      {"segment_grads", "segment_ids"},
+      "mean_grad",
+      &ws);
+  RunOp(
+      "SortedSegmentRangeMaxGradient",
+      {"data", "max", "segment_grads", "segment_ids"},
+      "max_grad",
+      &ws);
+
+  const float* data = Get(&ws, "data").data<float>();
+  const float* segmentGrads = Get(&ws, "segment_grads").data<float>();
+  const float* sum = Get(&ws, "sum").data<float>();
+  const float* mean = Get(&ws, "mean").data<float>();
+  const float* max = Get(&ws, "max").data<float>();
+  const float* meanGrad = Get(&ws, "mean_grad").data<float>();
+  const float* maxGrad = Get(&ws, "max_grad").data<float>();
+  ASSERT_EQ(Get(&ws, "sum").dim(0), segments);
+
+  row = 0;
+  for (int64_t k = 0; k < segments; ++k) {
+    for (int64_t j = 0; j < kBlockSize; ++j) {
+      float expectedSum = 0;
+      float expectedMax = std::numeric_limits<float>::lowest();
+      for (int64_t i = row; i < row + lengths[k]; ++i) {
+        expectedSum += data[i * kBlockSize + j];
+        expectedMax = std::max(expectedMax, data[i * kBlockSize + j]);
+      }
+      const auto out = k * kBlockSize + j;
+      EXPECT_NEAR(sum[out], expectedSum, 1e-4);
+      EXPECT_NEAR(mean[out], expectedSum / lengths[k], 1e-4);
+      EXPECT_EQ(max[out], expectedMax);
+      for (int64_t i = row; i < row + lengths[k]; ++i) {
+        const auto in = i * kBlockSize + j;
+        EXPECT_NEAR(meanGrad[in], segmentGrads[out] / lengths[k], 1e-6);
+        EXPECT_EQ(maxGrad[in], data[in] == max[out] ? segmentGrads[out] : 0);
+      }
+    }
+    row += lengths[k];
+  }
+}
+
+} // namespace caffe2
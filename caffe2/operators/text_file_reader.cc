@@ -1,36 +1,68 @@
+#include <cstring>
+#include <exception>
+
 #include "caffe2/core/context.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/core/types.h"
 #include "caffe2/operators/text_file_reader_utils.h"
 #include "caffe2/utils/string_utils.h"
+#include "caffe2/utils/thread_pool.h"
 
 namespace caffe2 {
 
+namespace {
+std::unique_ptr<StringProvider> CreateProvider(
+    const std::string& filename,
+    const std::string& compression,
+    int numThreads) {
+  if (compression.empty()) {
+    // Larger reads keep the parsing threads busy
+    return caffe2::make_unique<FileReader>(
+        filename, numThreads > 1 ? (1 << 22) : 65536);
+  }
+  auto provider = TextFileProviderRegistry()->Create(compression, filename);
+  CAFFE_ENFORCE(provider, "Unsupported compression: ", compression);
+  return provider;
+}
+} // namespace
+
 struct TextFileReaderInstance {
   TextFileReaderInstance(
       const std::vector<char>& delims,
       char escape,
       const std::string& filename,
       int numPasses,
-      const std::vector<int>& types)
-      : fileReader(filename),
-        tokenizer(Tokenizer(delims, escape), &fileReader, numPasses),
+      const std::vector<int>& types,
+      const std::string& compression = "",
+      int numThreads = 1)
+      : fileReader(CreateProvider(filename, compression, numThreads)),
+        tokenizer(Tokenizer(delims, escape), fileReader.get(), numPasses),
         fieldTypes(types) {
     for (const auto dt : fieldTypes) {
       fieldMetas.push_back(
           DataTypeToTypeMeta(static_cast<TensorProto_DataType>(dt)));
       fieldByteSizes.push_back(fieldMetas.back().itemsize());
     }
+    if (numThreads > 1) {
+      lineReader.reset(new LineReader(fileReader.get(), numPasses));
+      pool.reset(new TaskThreadPool(numThreads - 1));
+    }
   }
 
-  FileReader fileReader;
+  std::unique_ptr<StringProvider> fileReader;
   BufferedTokenizer tokenizer;
   std::vector<int> fieldTypes;
   std::vector<TypeMeta> fieldMetas;
   std::vector<size_t> fieldByteSizes;
   size_t rowsRead{0};
 
+  // With more than one thread, the read op takes whole lines from lineReader
+  // and parses them in parallel instead of using tokenizer
+  std::unique_ptr<LineReader> lineReader;
+  std::unique_ptr<TaskThreadPool> pool;
+  std::vector<const char*> lines;
+
   // hack to guarantee thread-safeness of the read op
   // TODO(azzolini): support multi-threaded reading.
   std::mutex globalMutex_;
@@ -42,14 +74,23 @@ class CreateTextFileReaderOp : public Operator<CPUContext> {
       : Operator<CPUContext>(operator_def, ws),
         filename_(GetSingleArgument<string>("filename", "")),
         numPasses_(GetSingleArgument<int>("num_passes", 1)),
-        fieldTypes_(GetRepeatedArgument<int>("field_types")) {
+        fieldTypes_(GetRepeatedArgument<int>("field_types")),
+        compression_(GetSingleArgument<string>("compression", "")),
+        numThreads_(GetSingleArgument<int>("num_threads", 1)) {
     CAFFE_ENFORCE(fieldTypes_.size() > 0, "field_types arg must be non-empty");
+    CAFFE_ENFORCE_GE(numThreads_, 1, "num_threads must be positive");
   }
 
   bool RunOnDevice() override {
     *OperatorBase::Output<std::unique_ptr<TextFileReaderInstance>>(0) =
         std::unique_ptr<TextFileReaderInstance>(new TextFileReaderInstance(
-            {'\n', '\t'}, '\0', filename_, numPasses_, fieldTypes_));
+            {'\n', '\t'},
+            '\0',
+            filename_,
+            numPasses_,
+            fieldTypes_,
+            compression_,
+            numThreads_));
     return true;
   }
 
@@ -57,6 +98,8 @@ class CreateTextFileReaderOp : public Operator<CPUContext> {
   std::string filename_;
   int numPasses_;
   std::vector<int> fieldTypes_;
+  std::string compression_;
+  int numThreads_;
 };
 
 inline void convert(
@@ -69,13 +112,14 @@ inline void convert(
       static_cast<std::string*>(dst)->assign(src_start, src_end);
     } break;
     case TensorProto_DataType_FLOAT: {
-      // TODO(azzolini): avoid copy, use faster convertion
-      std::string str_copy(src_start, src_end);
-      const char* src_copy = str_copy.c_str();
-      char* src_copy_end;
-      float val = strtof(src_copy, &src_copy_end);
-      if (src_copy == src_copy_end) {
-        throw std::runtime_error("Invalid float: " + str_copy);
+      // Tokens are followed by their delimiter or a terminating null, so
+      // strtof stops at the end of the token, unless the token is blank and
+      // it skips the delimiter as white space.
+      char* parsed_end;
+      float val = strtof(src_start, &parsed_end);
+      if (parsed_end == src_start || parsed_end > src_end) {
+        throw std::runtime_error(
+            "Invalid float: " + std::string(src_start, src_end));
       }
       *static_cast<float*>(dst) = val;
     } break;
@@ -113,7 +157,12 @@ class TextFileReaderReadOp : public Operator<CPUContext> {
     }
 
     int rowsRead = 0;
-    {
+    if (instance->lineReader) {
+      std::lock_guard<std::mutex> guard(instance->globalMutex_);
+      rowsRead = instance->lineReader->next(batchSize_, instance->lines);
+      parseLines(instance, rowsRead, datas);
+      instance->rowsRead += rowsRead;
+    } else {
       // TODO(azzolini): support multi-threaded reading
       std::lock_guard<std::mutex> guard(instance->globalMutex_);
 
@@ -156,6 +205,78 @@ class TextFileReaderReadOp : public Operator<CPUContext> {
   }
 
  private:
+  // Parses the fields of the numRows lines of the instance into the columns,
+  // splitting the lines evenly across the threads of the instance
+  void parseLines(
+      TextFileReaderInstance* instance,
+      int numRows,
+      const std::vector<char*>& datas) {
+    constexpr int kMinRowsPerTask = 256;
+    const int numTasks = std::max(
+        1,
+        std::min<int>(
+            instance->pool->size() + 1,
+            (numRows + kMinRowsPerTask - 1) / kMinRowsPerTask));
+    std::vector<std::exception_ptr> errors(numTasks);
+    auto parseTask = [&](int task) {
+      try {
+        parseRows(
+            instance,
+            (int64_t)numRows * task / numTasks,
+            (int64_t)numRows * (task + 1) / numTasks,
+            datas);
+      } catch (...) {
+        errors[task] = std::current_exception();
+      }
+    };
+    for (int task = 1; task < numTasks; ++task) {
+      instance->pool->run([&parseTask, task]() { parseTask(task); });
+    }
+    parseTask(0);
+    instance->pool->waitWorkComplete();
+    for (const auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  void parseRows(
+      const TextFileReaderInstance* instance,
+      int begin,
+      int end,
+      const std::vector<char*>& datas) {
+    const int numFields = datas.size();
+    for (int row = begin; row < end; ++row) {
+      const char* start = instance->lines[row];
+      // the newline
+      const char* rowEnd = instance->lines[row + 1] - 1;
+      CAFFE_ENFORCE(
+          !std::memchr(start, '\0', rowEnd - start),
+          "Escapes are not supported with num_threads > 1, at row ",
+          instance->rowsRead + row + 1);
+      for (int field = 0; field < numFields; ++field) {
+        const char* fieldEnd = rowEnd;
+        if (field + 1 < numFields) {
+          fieldEnd =
+              static_cast<const char*>(std::memchr(start, '\t', rowEnd - start));
+        }
+        CAFFE_ENFORCE(
+            fieldEnd &&
+                (field + 1 < numFields ||
+                 !std::memchr(start, '\t', rowEnd - start)),
+            "Invalid number of columns at row ",
+            instance->rowsRead + row + 1);
+        convert(
+            (TensorProto_DataType)instance->fieldTypes[field],
+            start,
+            fieldEnd,
+            datas[field] + row * instance->fieldByteSizes[field]);
+        start = fieldEnd + 1;
+      }
+    }
+  }
+
   int64_t batchSize_;
 };
 
@@ -173,6 +294,14 @@ OPERATOR_SCHEMA(CreateTextFileReader)
     .Arg(
         "field_types",
         "List with type of each field. Type enum is found at core.DataType.")
+    .Arg(
+        "compression",
+        "Compression of the file, e.g. zstd if built with USE_ZSTD. Empty for "
+        "plain text.")
+    .Arg(
+        "num_threads",
+        "Number of threads that parse every batch. With more than one, "
+        "escapes (null characters) are not supported.")
     .Output(0, "handler", "Pointer to the created TextFileReaderInstance.");
 
 OPERATOR_SCHEMA(TextFileReaderRead)
@@ -5,15 +5,59 @@
 #include <cstring>
 #include <sstream>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace caffe2 {
 
+C10_DEFINE_REGISTRY(
+    TextFileProviderRegistry,
+    StringProvider,
+    const std::string&);
+
 Tokenizer::Tokenizer(const std::vector<char>& delims, char escape)
-    : escape_(escape) {
+    : escape_(escape), specials_(delims) {
   reset();
   std::memset(delimTable_, 0, sizeof(delimTable_));
   for (int i = 0; i < delims.size(); ++i) {
     delimTable_[(unsigned char)delims.at(i)] = i + 1;
   }
+  specials_.push_back(escape);
+}
+
+const char* Tokenizer::findSpecial(const char* start, const char* end) const {
+  const char* ch = start;
+#ifdef __SSE2__
+  // 16 characters at a time, when there are few enough specials to compare
+  // every one of them
+  constexpr int kMaxVectorSpecials = 4;
+  if (specials_.size() <= kMaxVectorSpecials) {
+    __m128i specials[kMaxVectorSpecials];
+    const int numSpecials = specials_.size();
+    for (int i = 0; i < numSpecials; ++i) {
+      specials[i] = _mm_set1_epi8(specials_[i]);
+    }
+    for (; ch + 16 <= end; ch += 16) {
+      const __m128i chars =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(ch));
+      __m128i found = _mm_cmpeq_epi8(chars, specials[0]);
+      for (int i = 1; i < numSpecials; ++i) {
+        found = _mm_or_si128(found, _mm_cmpeq_epi8(chars, specials[i]));
+      }
+      const int mask = _mm_movemask_epi8(found);
+      if (mask != 0) {
+        return ch + __builtin_ctz(mask);
+      }
+    }
+  }
+#endif
+  for (; ch < end; ++ch) {
+    if (delimTable_[(unsigned char)*ch] > 0 || *ch == escape_) {
+      return ch;
+    }
+  }
+  return end;
 }
 
 void Tokenizer::reset() {
@@ -36,6 +80,10 @@ void Tokenizer::next(char* start, char* end, TokenizedString& tokenized) {
 
   char* ch;
   for (ch = start + toBeSkipped_; ch < end; ++ch) {
+    ch = const_cast<char*>(findSpecial(ch, end));
+    if (ch == end) {
+      break;
+    }
     if (*ch == escape_) {
       if (!copied) {
         tokenized.modifiedStrings_.emplace_back(new std::string());
@@ -116,4 +164,44 @@ void FileReader::operator()(CharRange& range) {
   range.start = buffer;
   range.end = buffer + numRead;
 }
+
+size_t LineReader::next(size_t maxLines, std::vector<const char*>& lines) {
+  // Drop the lines returned before, keeping the rest of the buffer
+  buffer_.erase(buffer_.begin(), buffer_.begin() + consumed_);
+  offsets_.assign(1, 0);
+  size_t scanned = 0;
+  while (offsets_.size() <= maxLines) {
+    const char* data = buffer_.data();
+    const void* newline =
+        std::memchr(data + scanned, '\n', buffer_.size() - scanned);
+    if (newline) {
+      scanned = static_cast<const char*>(newline) - data + 1;
+      offsets_.push_back(scanned);
+      continue;
+    }
+    scanned = buffer_.size();
+    if (pass_ >= numPasses_) {
+      break;
+    }
+    CharRange range;
+    (*provider_)(range);
+    if (range.start == nullptr) {
+      buffer_.resize(offsets_.back());
+      scanned = buffer_.size();
+      if (++pass_ < numPasses_) {
+        provider_->reset();
+      }
+      continue;
+    }
+    buffer_.insert(buffer_.end(), range.start, range.end);
+  }
+
+  consumed_ = offsets_.back();
+  lines.clear();
+  for (auto offset : offsets_) {
+    lines.push_back(buffer_.data() + offset);
+  }
+  return offsets_.size() - 1;
 }
+
+} // namespace caffe2
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 
+#include "c10/util/Registry.h"
 #include "caffe2/core/common.h"
 
 namespace caffe2 {
@@ -41,6 +42,10 @@ class CAFFE2_API Tokenizer {
   int toBeSkipped_;
   int delimTable_[256];
   const char escape_;
+  // the delimiters and the escape, which the scan for the next token stops at
+  std::vector<char> specials_;
+
+  const char* findSpecial(const char* start, const char* end) const;
 
  public:
   Tokenizer(const std::vector<char>& delimiters, char escape);
@@ -117,6 +122,37 @@ class CAFFE2_API FileReader : public StringProvider {
   std::unique_ptr<char[]> buffer_;
 };
 
+// Splits the text of a StringProvider into batches of complete lines, which
+// can then be parsed in parallel. Lines end with '\n'; like with the
+// Tokenizer, an unterminated last line of a pass is dropped.
+class CAFFE2_API LineReader {
+ public:
+  LineReader(StringProvider* p, int numPasses = 1)
+      : provider_(p), numPasses_(numPasses) {}
+
+  // Sets lines to the starts of the next up to maxLines lines, followed by
+  // the end of the last one, and returns the number of lines. The lines stay
+  // valid until the next call.
+  size_t next(size_t maxLines, std::vector<const char*>& lines);
+
+ private:
+  StringProvider* provider_;
+  int numPasses_;
+  int pass_{0};
+  std::vector<char> buffer_;
+  // the lines before were returned already
+  size_t consumed_{0};
+  std::vector<size_t> offsets_;
+};
+
+// Providers of the decompressed text of compressed files by the name of the
+// compression, e.g. "zstd" when built with USE_ZSTD. Take the path of the
+// file.
+C10_DECLARE_REGISTRY(
+    TextFileProviderRegistry,
+    StringProvider,
+    const std::string&);
+
 } // namespace caffe2
 
 #endif // CAFFE2_OPERATORS_TEXT_FILE_READER_UTILS_H
@@ -119,4 +119,55 @@ TEST(TextFileReaderUtilsTest, TokenizeTest) {
   std::remove(tmpname);
 }
 
+TEST(TextFileReaderUtilsTest, LineReaderTest) {
+  // The last line lacks a newline, and is dropped
+  const std::string text = "a\tb\n\nlong line\tc\nd\tlast\ne";
+  const std::vector<std::string> expected = {"a\tb\n", "\n", "long line\tc\n",
+                                             "d\tlast\n"};
+
+  struct ChunkProvider : public StringProvider {
+    ChunkProvider(const std::string& str, size_t size) : ch(str), size(size) {}
+    std::string ch;
+    size_t size;
+    size_t charIdx{0};
+    void operator()(CharRange& range) {
+      if (charIdx >= ch.size()) {
+        range.start = nullptr;
+        range.end = nullptr;
+      } else {
+        size_t endIdx = std::min(charIdx + size, ch.size());
+        range.start = &ch.front() + charIdx;
+        range.end = &ch.front() + endIdx;
+        charIdx = endIdx;
+      }
+    };
+    void reset() {
+      charIdx = 0;
+    }
+  };
+
+  for (size_t chunkSize = 1; chunkSize <= text.size(); ++chunkSize) {
+    for (size_t maxLines = 1; maxLines <= 5; ++maxLines) {
+      for (int numPasses = 1; numPasses <= 2; ++numPasses) {
+        ChunkProvider provider(text, chunkSize);
+        LineReader reader(&provider, numPasses);
+        std::vector<const char*> lines;
+        std::vector<std::string> read;
+        size_t numLines;
+        while ((numLines = reader.next(maxLines, lines)) > 0) {
+          EXPECT_GE(maxLines, numLines);
+          EXPECT_EQ(numLines + 1, lines.size());
+          for (size_t i = 0; i < numLines; ++i) {
+            read.emplace_back(lines[i], lines[i + 1]);
+          }
+        }
+        ASSERT_EQ(expected.size() * numPasses, read.size());
+        for (size_t i = 0; i < read.size(); ++i) {
+          EXPECT_EQ(expected[i % expected.size()], read[i]);
+        }
+      }
+    }
+  }
+}
+
 } // namespace caffe2
@@ -1,6 +1,7 @@
 #include "caffe2/operators/top_k.h"
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
 #include <queue>
 #include <utility>
@@ -23,6 +24,12 @@ struct ValueComp {
   }
 };
 
+// Values filtered at once by GetTopK on contiguous rows
+constexpr int64_t kTopKBlockSize = 16;
+
+// Rows are selected in parallel when the input has at least this many values
+constexpr int64_t kTopKParallelGrain = 1 << 14;
+
 template <typename T>
 void GetTopK(
     const T* input,
@@ -46,7 +53,29 @@ void GetTopK(
       std::vector<std::pair<T, int64_t>>,
       ValueComp<T>>
       pq(ValueComp<T>(), std::move(heap_data));
-  for (int64_t i = k; i < n; ++i) {
+  int64_t i = k;
+  if (stride == 1) {
+    // Contiguous values are filtered a block at a time with a vectorizable
+    // max against the smallest value of the heap, which rejects most blocks
+    // once the heap holds large values
+    for (; i + kTopKBlockSize <= n; i += kTopKBlockSize) {
+      const T threshold = pq.top().first;
+      T block_max = threshold;
+      for (int64_t j = 0; j < kTopKBlockSize; ++j) {
+        block_max = std::max(block_max, src_ptr[j]);
+      }
+      if (threshold < block_max) {
+        for (int64_t j = 0; j < kTopKBlockSize; ++j) {
+          if (pq.top().first < src_ptr[j]) {
+            pq.pop();
+            pq.emplace(src_ptr[j], i + j);
+          }
+        }
+      }
+      src_ptr += kTopKBlockSize;
+    }
+  }
+  for (; i < n; ++i) {
     if (pq.top().first < *src_ptr) {
       pq.pop();
       pq.emplace(*src_ptr, i);
@@ -135,23 +164,24 @@ bool TopKOp<T, Context>::RunOnDevice() {
       std::multiplies<int64_t>());
   const int64_t src_offset_stride = input_dims[axis_] * next_size;
   const int64_t dst_offset_stride = k_ * next_size;
-  int64_t src_offset = 0;
-  int64_t dst_offset = 0;
-  for (int64_t i = 0; i < prev_size; ++i) {
-    for (int64_t j = 0; j < next_size; ++j) {
-      GetTopK(
-          input_data,
-          input_dims[axis_],
-          k_,
-          src_offset + j,
-          dst_offset + j,
-          next_size,
-          values_data,
-          indices_data,
-          flatten_indices_data);
-    }
-    src_offset += src_offset_stride;
-    dst_offset += dst_offset_stride;
+  const int64_t num_rows = prev_size * next_size;
+  // Every row writes its own values and indices
+#ifdef _OPENMP
+#pragma omp parallel for if (input.size() >= kTopKParallelGrain)
+#endif
+  for (int64_t row = 0; row < num_rows; ++row) {
+    const int64_t i = row / next_size;
+    const int64_t j = row % next_size;
+    GetTopK(
+        input_data,
+        input_dims[axis_],
+        k_,
+        i * src_offset_stride + j,
+        i * dst_offset_stride + j,
+        next_size,
+        values_data,
+        indices_data,
+        flatten_indices_data);
   }
   return true;
 }
@@ -205,7 +235,81 @@ bool TopKGradientOp<T, Context>::RunOnDevice() {
   return true;
 }
 
+template <typename T, class Context>
+bool BeamSearchStepOp<T, Context>::RunOnDevice() {
+  const auto& logits = Input(0);
+  const auto& scores = Input(1);
+  auto* new_scores = Output(0);
+  auto* tokens = Output(1);
+  auto* parents = Output(2);
+
+  CAFFE_ENFORCE_EQ(logits.ndim(), 2, "LOGITS must be a matrix");
+  const int64_t num_rows = logits.dim(0);
+  const int64_t vocab_size = logits.dim(1);
+  CAFFE_ENFORCE_GT(vocab_size, 0);
+  CAFFE_ENFORCE_EQ(scores.size(), num_rows);
+  CAFFE_ENFORCE_EQ(
+      num_rows % beam_size_,
+      0,
+      "The number of rows of LOGITS must be a multiple of beam_size");
+  const int64_t batch_size = num_rows / beam_size_;
+  const int64_t beam_vocab_size = beam_size_ * vocab_size;
+
+  new_scores->Resize(num_rows);
+  tokens->Resize(num_rows);
+  parents->Resize(num_rows);
+  candidates_.ResizeLike(logits);
+  const T* logits_data = logits.template data<T>();
+  const T* scores_data = scores.template data<T>();
+  T* candidates_data = candidates_.template mutable_data<T>();
+  T* new_scores_data = new_scores->template mutable_data<T>();
+  int64_t* tokens_data = tokens->template mutable_data<int64_t>();
+  int64_t* parents_data = parents->template mutable_data<int64_t>();
+
+  // Batch items are independent
+#ifdef _OPENMP
+#pragma omp parallel for if (logits.size() >= kTopKParallelGrain)
+#endif
+  for (int64_t b = 0; b < batch_size; ++b) {
+    for (int64_t row = b * beam_size_; row < (b + 1) * beam_size_; ++row) {
+      const T* x = logits_data + row * vocab_size;
+      T* candidates = candidates_data + row * vocab_size;
+      T offset = scores_data[row];
+      if (log_softmax_) {
+        const T max_value = *std::max_element(x, x + vocab_size);
+        T sum = 0;
+        for (int64_t v = 0; v < vocab_size; ++v) {
+          sum += std::exp(x[v] - max_value);
+        }
+        offset -= max_value + std::log(sum);
+      }
+      for (int64_t v = 0; v < vocab_size; ++v) {
+        candidates[v] = x[v] + offset;
+      }
+    }
+
+    // The indices of the best extensions are in the beam_size x vocab_size
+    // candidates of the batch item
+    GetTopK(
+        candidates_data,
+        beam_vocab_size,
+        int64_t(beam_size_),
+        b * beam_vocab_size,
+        b * beam_size_,
+        int64_t(1),
+        new_scores_data,
+        parents_data,
+        nullptr);
+    for (int64_t i = b * beam_size_; i < (b + 1) * beam_size_; ++i) {
+      tokens_data[i] = parents_data[i] % vocab_size;
+      parents_data[i] = b * beam_size_ + parents_data[i] / vocab_size;
+    }
+  }
+  return true;
+}
+
 REGISTER_CPU_OPERATOR(TopK, TopKOp<float, CPUContext>);
+REGISTER_CPU_OPERATOR(BeamSearchStep, BeamSearchStepOp<float, CPUContext>);
 REGISTER_CPU_OPERATOR(TopKGradient, TopKGradientOp<float, CPUContext>);
 
 OPERATOR_SCHEMA(TopK)
@@ -340,6 +444,54 @@ Flattened_indices: [ 1  0  3  4  8  7 10 11 13 14 17 16 20 18 23 22 26 25]
 
 OPERATOR_SCHEMA(TopKGradient).NumInputs(3).NumOutputs(1);
 
+OPERATOR_SCHEMA(BeamSearchStep)
+    .NumInputs(2)
+    .NumOutputs(3)
+    .SetDoc(R"DOC(
+Runs one step of beam search decoding for a batch of `batch_size` items with
+`beam_size` hypotheses each. Every hypothesis is extended with every token of
+the vocabulary, with the score of the hypothesis plus the log-probability of
+the token, and the `beam_size` best extensions of each batch item are kept,
+best first. Ties are broken by the lower hypothesis, then the lower token.
+
+This fuses the log-softmax of the logits, the addition of the scores and the
+TopK over `beam_size * vocab_size` candidates of a decoding step. The parents
+are rows of the inputs, so that the states of the decoder can be reordered
+with Gather. On the first step, where all hypotheses of an item are the same,
+give all but one of them a score of -inf.
+)DOC")
+    .Arg("beam_size", "(*int*): number of hypotheses per batch item")
+    .Arg(
+        "log_softmax",
+        "(*bool*): apply log-softmax to the logits; set to false if they "
+        "are log-probabilities already (default true)")
+    .Input(
+        0,
+        "LOGITS",
+        "(*Tensor`<float>`*): logits of the next token, of shape "
+        "(batch_size * beam_size, vocab_size)")
+    .Input(
+        1,
+        "SCORES",
+        "(*Tensor`<float>`*): scores of the hypotheses, of shape "
+        "(batch_size * beam_size)")
+    .Output(
+        0,
+        "NEW_SCORES",
+        "(*Tensor`<float>`*): scores of the kept extensions, of shape "
+        "(batch_size * beam_size)")
+    .Output(
+        1,
+        "TOKENS",
+        "(*Tensor`<int64>`*): tokens of the kept extensions")
+    .Output(
+        2,
+        "PARENTS",
+        "(*Tensor`<int64>`*): rows of LOGITS of the hypotheses that the kept "
+        "extensions extend");
+
+SHOULD_NOT_DO_GRADIENT(BeamSearchStep);
+
 class GetTopKGradient : public GradientMakerBase {
   using GradientMakerBase::GradientMakerBase;
   vector<OperatorDef> GetGradientDefs() override {
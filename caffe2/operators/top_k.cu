@@ -7,6 +7,7 @@
 #include <numeric>
 #include <vector>
 
+#include <cub/device/device_segmented_radix_sort.cuh>
 #include <thrust/sort.h>
 #include <thrust/system/cuda/execution_policy.h>
 
@@ -46,6 +47,27 @@ void RunHeapSelectionImpl(
           k);
 }
 
+__global__ void SetSegmentOffsetsCUDAKernel(
+    const int num_segments,
+    const int stride,
+    const int size,
+    int* begin_offsets,
+    int* end_offsets) {
+  CUDA_1D_KERNEL_LOOP(i, num_segments) {
+    begin_offsets[i] = i * stride;
+    end_offsets[i] = i * stride + size;
+  }
+}
+
+// The buffers of the radix selection: the unsorted top k of every row, the
+// segment offsets and the temporary storage of the segmented sort.
+struct RadixSelectionBuffers {
+  Tensor values{CUDA};
+  Tensor indices{CUDA};
+  Tensor offsets{CUDA};
+  Tensor sort_storage{CUDA};
+};
+
 template <typename T, bool kSelectMax = true>
 void RunRadixSelectionImpl(
     const T* input,
@@ -54,24 +76,79 @@ void RunRadixSelectionImpl(
     const int k,
     T* values,
     int64_t* indices,
+    RadixSelectionBuffers* buffers,
     CUDAContext* context) {
   const int block = std::min(
       math::roundUp(static_cast<int>(inner_size), kWarpSize),
       CAFFE_CUDA_NUM_THREADS);
+  const int sort_size = k <= inner_size ? k : inner_size;
+  if (outer_size * k > std::numeric_limits<int>::max()) {
+    gatherTopK<T, kSelectMax, int64_t>
+        <<<outer_size, block, 0, context->cuda_stream()>>>(
+            input, inner_size, k, outer_size, values, indices);
+    // The segmented sort takes int offsets, sort the rows one at a time.
+    for (int64_t i = 0; i < outer_size; ++i) {
+      thrust::sort_by_key(
+          thrust::cuda::par.on(context->cuda_stream()),
+          values + i * k,
+          values + i * k + sort_size,
+          indices + i * k,
+          thrust::greater<T>());
+    }
+    return;
+  }
+
+  // The selection is not sorted, so it goes to the buffers and all the rows
+  // are sorted into the outputs by a single segmented radix sort. The
+  // entries past sort_size in each row of the outputs are left untouched.
+  const int num_items = outer_size * k;
+  buffers->values.Resize(num_items);
+  buffers->indices.Resize(num_items);
+  buffers->offsets.Resize(2 * outer_size);
+  T* values_buffer = buffers->values.template mutable_data<T>();
+  int64_t* indices_buffer = buffers->indices.template mutable_data<int64_t>();
+  int* begin_offsets = buffers->offsets.template mutable_data<int>();
+  int* end_offsets = begin_offsets + outer_size;
   gatherTopK<T, kSelectMax, int64_t>
       <<<outer_size, block, 0, context->cuda_stream()>>>(
-          input, inner_size, k, outer_size, values, indices);
-  // Unfortunately the output is not currently sorted, and there is no batch
-  // sorting utility available. Iterate over all of the slices and sort them
-  // in-place using Thrust.
-  for (int i = 0; i < outer_size; ++i) {
-    thrust::sort_by_key(
-        thrust::cuda::par.on(context->cuda_stream()),
-        values + i * k,
-        values + i * k + (k <= inner_size ? k : inner_size),
-        indices + i * k,
-        thrust::greater<T>());
-  }
+          input, inner_size, k, outer_size, values_buffer, indices_buffer);
+  SetSegmentOffsetsCUDAKernel<<<
+      CAFFE_GET_BLOCKS(outer_size),
+      CAFFE_CUDA_NUM_THREADS,
+      0,
+      context->cuda_stream()>>>(
+      outer_size, k, sort_size, begin_offsets, end_offsets);
+
+  size_t sort_storage_bytes = 0;
+  CUDA_ENFORCE(cub::DeviceSegmentedRadixSort::SortPairsDescending(
+      nullptr,
+      sort_storage_bytes,
+      values_buffer,
+      values,
+      indices_buffer,
+      indices,
+      num_items,
+      outer_size,
+      begin_offsets,
+      end_offsets,
+      0,
+      sizeof(T) * 8,
+      context->cuda_stream()));
+  buffers->sort_storage.Resize(sort_storage_bytes);
+  CUDA_ENFORCE(cub::DeviceSegmentedRadixSort::SortPairsDescending(
+      buffers->sort_storage.template mutable_data<uint8_t>(),
+      sort_storage_bytes,
+      values_buffer,
+      values,
+      indices_buffer,
+      indices,
+      num_items,
+      outer_size,
+      begin_offsets,
+      end_offsets,
+      0,
+      sizeof(T) * 8,
+      context->cuda_stream()));
 }
 
 template <typename T>
@@ -82,6 +159,7 @@ void RunTopKOnLastDimCUDAImpl(
     const int k,
     T* values,
     int64_t* indices,
+    RadixSelectionBuffers* buffers,
     CUDAContext* context) {
   // If k is small, uses heap selection, otherwise uses radix selection.
   if (k < 32) {
@@ -95,7 +173,7 @@ void RunTopKOnLastDimCUDAImpl(
         input, outer_size, inner_size, k, values, indices, context);
   } else {
     RunRadixSelectionImpl<T>(
-        input, outer_size, inner_size, k, values, indices, context);
+        input, outer_size, inner_size, k, values, indices, buffers, context);
   }
 }
 
@@ -169,6 +247,7 @@ class TopKCudaOp : public Operator<Context> {
   Tensor input_transposed_buffer_{CUDA};
   Tensor values_transposed_buffer_{CUDA};
   Tensor indices_transposed_buffer_{CUDA};
+  RadixSelectionBuffers radix_selection_buffers_;
 
   // Shape tensors on device for CUDAContext.
   Tensor input_dims_device_{CUDA};
@@ -259,6 +338,7 @@ bool TopKCudaOp<T, Context>::RunOnDevice() {
       k_,
       values_data,
       indices_data,
+      &radix_selection_buffers_,
       &context_);
   if (need_transpose) {
     const std::array<int, 3> dims = {
@@ -45,6 +45,32 @@ class TopKGradientOp : public Operator<Context> {
   int axis_;
 };
 
+// One step of beam search decoding: extends every hypothesis of a beam with
+// every token of the vocabulary, and keeps the beam_size best extensions of
+// each batch item with their tokens and the rows of their parents.
+template <typename T, class Context>
+class BeamSearchStepOp : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+
+  BeamSearchStepOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        OP_SINGLE_ARG(int, "beam_size", beam_size_, -1),
+        OP_SINGLE_ARG(bool, "log_softmax", log_softmax_, true) {
+    CAFFE_ENFORCE(beam_size_ >= 1, "beam_size argument must be >= 1");
+  }
+
+  ~BeamSearchStepOp() {}
+
+  bool RunOnDevice() override;
+
+ private:
+  const int beam_size_;
+  const bool log_softmax_;
+  // Scores of the extensions, one row per hypothesis
+  Tensor candidates_{Context::GetDeviceType()};
+};
+
 } // namespace caffe2
 
 #endif // CAFFE2_OPERATORS_TOP_K_H_
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "caffe2/core/operator.h"
+
+namespace caffe2 {
+
+namespace {
+
+void FillTensor(
+    Workspace* ws,
+    const string& name,
+    const vector<int64_t>& dims,
+    const vector<float>& values) {
+  auto* tensor = BlobGetMutableTensor(ws->CreateBlob(name), CPU);
+  tensor->Resize(dims);
+  std::copy(values.begin(), values.end(), tensor->mutable_data<float>());
+}
+
+const TensorCPU& Get(Workspace* ws, const string& name) {
+  return ws->GetBlob(name)->Get<TensorCPU>();
+}
+
+} // namespace
+
+TEST(TopKTest, MatchesSortOnLongRows) {
+  const int64_t kRows = 8;
+  const int64_t kColumns = 4099;
+  const int kK = 10;
+  Workspace ws;
+  vector<float> values(kRows * kColumns);
+  for (size_t i = 0; i < values.size(); ++i) {
+    // Repeated values check the tie breaking by index
+    values[i] = std::floor(100 * std::sin(i * 0.37f));
+  }
+  FillTensor(&ws, "X", {kRows, kColumns}, values);
+
+  OperatorDef def;
+  def.set_type("TopK");
+  def.add_input("X");
+  def.add_output("values");
+  def.add_output("indices");
+  def.add_arg()->CopyFrom(MakeArgument("k", kK));
+  unique_ptr<OperatorBase> op(CreateOperator(def, &ws));
+  ASSERT_NE(nullptr, op.get());
+  ASSERT_TRUE(op->Run());
+
+  const auto& top_values = Get(&ws, "values");
+  const auto& top_indices = Get(&ws, "indices");
+  for (int64_t row = 0; row < kRows; ++row) {
+    const float* x = values.data() + row * kColumns;
+    vector<int64_t> order(kColumns);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [x](int64_t a, int64_t b) {
+      return x[a] > x[b];
+    });
+    for (int i = 0; i < kK; ++i) {
+      EXPECT_EQ(top_indices.data<int64_t>()[row * kK + i], order[i]);
+      EXPECT_EQ(top_values.data<float>()[row * kK + i], x[order[i]]);
+    }
+  }
+}
+
+TEST(BeamSearchStepTest, MatchesExhaustiveSearch) {
+  const int kBatch = 2;
+  const int kBeam = 3;
+  const int kVocab = 5;
+  Workspace ws;
+  vector<float> logits(kBatch * kBeam * kVocab);
+  for (size_t i = 0; i < logits.size(); ++i) {
+    logits[i] = std::cos(i * 1.3f);
+  }
+  const vector<float> scores = {-0.5f, -1.0f, -2.0f, -0.1f, -0.2f, -3.0f};
+  FillTensor(&ws, "logits", {kBatch * kBeam, kVocab}, logits);
+  FillTensor(&ws, "scores", {kBatch * kBeam}, scores);
+
+  OperatorDef def;
+  def.set_type("BeamSearchStep");
+  def.add_input("logits");
+  def.add_input("scores");
+  def.add_output("new_scores");
+  def.add_output("tokens");
+  def.add_output("parents");
+  def.add_arg()->CopyFrom(MakeArgument("beam_size", kBeam));
+  unique_ptr<OperatorBase> op(CreateOperator(def, &ws));
+  ASSERT_NE(nullptr, op.get());
+  ASSERT_TRUE(op->Run());
+
+  const auto& new_scores = Get(&ws, "new_scores");
+  const auto& tokens = Get(&ws, "tokens");
+  const auto& parents = Get(&ws, "parents");
+  for (int b = 0; b < kBatch; ++b) {
+    // Scores of every extension of the batch item
+    vector<float> candidates;
+    for (int row = b * kBeam; row < (b + 1) * kBeam; ++row) {
+      const float* x = logits.data() + row * kVocab;
+      float sum = 0;
+      for (int v = 0; v < kVocab; ++v) {
+        sum += std::exp(x[v]);
+      }
+      for (int v = 0; v < kVocab; ++v) {
+        candidates.push_back(scores[row] + x[v] - std::log(sum));
+      }
+    }
+    vector<int> order(candidates.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int lhs, int rhs) {
+      return candidates[lhs] > candidates[rhs];
+    });
+    for (int i = 0; i < kBeam; ++i) {
+      const int out = b * kBeam + i;
+      EXPECT_NEAR(new_scores.data<float>()[out], candidates[order[i]], 1e-5);
+      EXPECT_EQ(tokens.data<int64_t>()[out], order[i] % kVocab);
+      EXPECT_EQ(parents.data<int64_t>()[out], b * kBeam + order[i] / kVocab);
+    }
+  }
+}
+
+} // namespace caffe2
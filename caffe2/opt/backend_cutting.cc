@@ -265,6 +265,32 @@ void DetectBoundaryReferences(
   }
 }
 
+// Gain of running the subgraph on the backend rather than on the host
+float OffloadGain(
+    const TransformSubgraph& subgraph,
+    const BackendCuttingCost& cost) {
+  float gain = 0;
+  for (auto node : subgraph.nodes) {
+    if (nn::is<NeuralNetOperator>(node)) {
+      const auto* nn_op = nn::get<NeuralNetOperator>(node);
+      const auto& op_def =
+          dyn_cast<Caffe2Annotation>(nn_op->getAnnotation())->getOperatorDef();
+      gain += cost.op_cost ? cost.op_cost(op_def) : 1.0f;
+    }
+  }
+  for (const auto& kv : subgraph.external_input_refs) {
+    if (nn::hasProducer(kv.second)) {
+      gain -= cost.transfer_cost;
+    }
+  }
+  for (const auto& kv : subgraph.external_output_refs) {
+    if (nn::hasConsumer(kv.second)) {
+      gain -= cost.transfer_cost;
+    }
+  }
+  return gain;
+}
+
 void ReplaceSubgraph(
     const TransformSubgraph& subgraph,
     caffe2::NetDef& net_opt,
@@ -346,7 +372,8 @@ void PruneUnrefereredNodes(NNModule* nn) {
 caffe2::NetDef OptimizeForBackend(
     caffe2::NetDef& net,
     std::function<bool(const caffe2::OperatorDef&)> supports,
-    std::function<caffe2::NetDef(const caffe2::NetDef&)> transform_func) {
+    std::function<caffe2::NetDef(const caffe2::NetDef&)> transform_func,
+    const BackendCuttingCost& cost) {
   auto nn = convertToNNModule(net);
   auto& dfg = nn.dataFlow;
 
@@ -401,6 +428,13 @@ caffe2::NetDef OptimizeForBackend(
     // Generate boundary input/output edges
     DetectBoundaryReferences(&g, context.infos, external_outputs);
 
+    const float gain = OffloadGain(g, cost);
+    if (gain < cost.min_gain) {
+      VLOG(1) << "Keeping group " << g.group_id << " on the host, gain "
+              << gain;
+      continue;
+    }
+
     caffe2::NetDef subnet = ConvertToC2Net(g, context.infos);
     // Transform the subgraph protobuf def, note that we can have less external
     // inputs/outputs but not more
@@ -9,9 +9,24 @@
 namespace caffe2 {
 namespace opt {
 
+// Cost model of offloading a supported subgraph to the backend. The subgraph
+// is only transformed if the host cost of its ops exceeds the cost of moving
+// its boundary tensors between the host and the backend by at least min_gain.
+// Only the boundary tensors produced by the net are counted, the net inputs
+// and the weights are transferred whatever the cut. Small islands of supported
+// ops between unsupported ones thus stay on the host.
+struct CAFFE2_API BackendCuttingCost {
+  // Host cost of a supported op, 1 if not set
+  std::function<float(const caffe2::OperatorDef&)> op_cost;
+  // Cost of a boundary tensor
+  float transfer_cost{0};
+  float min_gain{0};
+};
+
 CAFFE2_API caffe2::NetDef OptimizeForBackend(
     caffe2::NetDef& net,
     std::function<bool(const caffe2::OperatorDef&)> supports,
-    std::function<caffe2::NetDef(const caffe2::NetDef&)> transform_func);
+    std::function<caffe2::NetDef(const caffe2::NetDef&)> transform_func,
+    const BackendCuttingCost& cost = BackendCuttingCost());
 }
 } // namespace caffe2
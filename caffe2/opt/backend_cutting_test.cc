@@ -152,3 +152,43 @@ TEST(BackendCuttingTest, skipPath) {
   auto net_opt = caffe2::opt::OptimizeForBackend(net, Supports, Transform);
   EXPECT_EQ(4, net_opt.op_size());
 }
+
+// X -> CopyIn -> MyRelu -> Random -> MyConv -> MyConv -> CopyOut -> Y
+TEST(BackendCuttingTest, smallIslandStaysOnHost) {
+  caffe2::NetDef net;
+  net.add_external_input("X");
+  net.add_external_output("Y");
+  auto* op = net.add_op();
+  op->set_type("CopyIn");
+  op->add_input("X");
+  op->add_output("R0");
+  op = net.add_op();
+  op->set_type("MyRelu");
+  op->add_input("R0");
+  op->add_output("R1");
+  op = net.add_op();
+  op->set_type("Random");
+  op->add_input("R1");
+  op->add_output("N0");
+  for (int i = 0; i < 2; ++i) {
+    AddConv(&net, i);
+  }
+  op = net.add_op();
+  op->set_type("CopyOut");
+  op->add_input("N2");
+  op->add_output("Y");
+
+  // Offloading MyRelu costs two transfers for one op
+  caffe2::opt::BackendCuttingCost cost;
+  cost.transfer_cost = 1;
+  auto net_opt =
+      caffe2::opt::OptimizeForBackend(net, Supports, Transform, cost);
+  int num_offloaded = 0;
+  int num_relu = 0;
+  for (const auto& opt_op : net_opt.op()) {
+    num_offloaded += opt_op.type() == "BigOpt";
+    num_relu += opt_op.type() == "MyRelu";
+  }
+  EXPECT_EQ(1, num_offloaded);
+  EXPECT_EQ(1, num_relu);
+}
@@ -59,18 +59,20 @@ namespace caffe2 {
 C10_DEFINE_REGISTRY(ConverterRegistry, Converter);
 
 std::map<std::string, caffe2::Argument> Converter::getArgumentsFromOperator(
-    caffe2::OperatorDef op) {
+    const caffe2::OperatorDef& op) {
   std::map<std::string, caffe2::Argument> argMap;
-  for (auto arg : op.arg()) {
+  for (const auto& arg : op.arg()) {
     argMap[arg.name()] = arg;
   }
   return argMap;
 }
 
-repr::NeuralNetOperator::NNLayout getLayout(std::map<std::string, caffe2::Argument> argMap) {
-  auto arg = argMap.find("order");
-  if (arg != argMap.end()) {
-    auto order = argMap["order"].s();
+repr::NeuralNetOperator::NNLayout getLayout(const caffe2::OperatorDef& op) {
+  for (const auto& arg : op.arg()) {
+    if (arg.name() != "order") {
+      continue;
+    }
+    const auto& order = arg.s();
     if (order == "NCHW" || order == "nchw") {
       return repr::NeuralNetOperator::NNLayout::NCHW;
     } else if (order == "NHWC" || order == "nhwc") {
@@ -231,8 +233,6 @@ REGISTER_CONVERTER(Concat, ConcatConverter);
 
 std::unique_ptr<repr::NeuralNetOperator> convertToNeuralNetOperator(
     const caffe2::OperatorDef& op) {
-  auto argMap = Converter::getArgumentsFromOperator(op);
-
   std::unique_ptr<repr::NeuralNetOperator> nnOp;
 
   if (ConverterRegistry()->Has(op.type())) {
@@ -245,7 +245,7 @@ std::unique_ptr<repr::NeuralNetOperator> convertToNeuralNetOperator(
   }
 
   // Generic attributes associated with Ops here
-  nnOp->setLayout(getLayout(argMap));
+  nnOp->setLayout(getLayout(op));
 
   auto annotation = util::make_unique<Caffe2Annotation>();
   annotation->setOperatorDef(op);
@@ -294,18 +294,21 @@ repr::NNModule convertToNNModule(
     // First calculate in-edges (data dependencies).
     for (const auto &input : op.input()) {
       // If we've never seen this tensor, make one.
-      if (!blobMap.count(input)) {
+      auto it = blobMap.find(input);
+      if (it == blobMap.end()) {
         auto tensor = util::make_unique<repr::Tensor>(input);
-        blobMap[input] =
-            dfg.createNode(unique_dyn_cast<repr::NeuralNetData>(tensor));
-        if (externalInputNames.count(input)) {
-          module.inputs.insert(blobMap[input]);
-          externalInputNames.erase(input);
+        it = blobMap
+                 .emplace(
+                     input,
+                     dfg.createNode(
+                         unique_dyn_cast<repr::NeuralNetData>(tensor)))
+                 .first;
+        if (externalInputNames.erase(input)) {
+          module.inputs.insert(it->second);
         }
       }
 
-      auto tensorNode = blobMap[input];
-      dfg.createEdge(tensorNode, opNode);
+      dfg.createEdge(it->second, opNode);
     }
 
     // Then save outputs into the blobMap for later consumption.
@@ -438,9 +441,23 @@ std::vector<std::string> mergeExternalTensors(
 
 caffe2::NetDef convertToCaffe2Proto(repr::NNModule &m, const caffe2::NetDef& oldNet) {
   auto predictNet = caffe2::NetDef();
-  // We copy the old net rather than mutate it.
-  predictNet.CopyFrom(oldNet);
-  predictNet.mutable_op()->Clear();
+  // We copy the old net rather than mutate it, all but its operators, which
+  // are regenerated from the graph below.
+  if (oldNet.has_name()) {
+    predictNet.set_name(oldNet.name());
+  }
+  if (oldNet.has_type()) {
+    predictNet.set_type(oldNet.type());
+  }
+  if (oldNet.has_num_workers()) {
+    predictNet.set_num_workers(oldNet.num_workers());
+  }
+  if (oldNet.has_device_option()) {
+    *predictNet.mutable_device_option() = oldNet.device_option();
+  }
+  *predictNet.mutable_arg() = oldNet.arg();
+  *predictNet.mutable_external_input() = oldNet.external_input();
+  *predictNet.mutable_external_output() = oldNet.external_output();
 
   repr::nn::coalesceInsertedDataDependencies(&m);
 
@@ -49,7 +49,7 @@ class CAFFE2_API Converter {
   convertToNeuralNetOperator(const OperatorDef&) = 0;
   virtual OperatorDef convertToOperatorDef(const nom::repr::NeuralNetOperator*);
   static std::map<std::string, caffe2::Argument> getArgumentsFromOperator(
-      caffe2::OperatorDef op);
+      const caffe2::OperatorDef& op);
 
   virtual ~Converter() {}
 };
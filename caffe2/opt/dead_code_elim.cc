@@ -9,32 +9,44 @@ using namespace nom;
 using namespace nom::repr;
 
 void deadCodeElim(NNModule* nn) {
-  // Iteratively remove unconsumed non-external outputs.
-  bool changed = false;
-  do {
-    changed = false;
-    for (const auto& node : nn->dataFlow.getMutableNodes()) {
-      NOM_REQUIRE_OR_CONT(nn::is<repr::NeuralNetOperator>(node));
-
-      bool isUsed = false;
-      for (const auto& output : nn::getOutputs(node)) {
-        if (nn::hasConsumer(output) || nn->outputs.count(output)) {
-          isUsed = true;
-          break;
-        }
+  // Remove the operators none of whose outputs are consumed or external.
+  // Deleting one can leave the producers of its inputs unused, so those are
+  // revisited, rather than rescanning the whole graph after every deletion.
+  std::vector<NNGraph::NodeRef> worklist;
+  for (const auto& node : nn->dataFlow.getMutableNodes()) {
+    if (nn::is<repr::NeuralNetOperator>(node)) {
+      worklist.emplace_back(node);
+    }
+  }
+
+  while (!worklist.empty()) {
+    auto node = worklist.back();
+    worklist.pop_back();
+    // Nodes can be queued again after they have been deleted
+    NOM_REQUIRE_OR_CONT(nn->dataFlow.hasNode(node));
+
+    bool isUsed = false;
+    for (const auto& output : nn::getOutputs(node)) {
+      if (nn::hasConsumer(output) || nn->outputs.count(output)) {
+        isUsed = true;
+        break;
       }
+    }
 
-      NOM_REQUIRE_OR_CONT(!isUsed);
+    NOM_REQUIRE_OR_CONT(!isUsed);
 
-      // No outputs are used, delete them and the node itself.
-      for (const auto& output : nn::getOutputs(node)) {
-        nn->dataFlow.deleteNode(output);
+    for (const auto& input : nn::getInputs(node)) {
+      if (nn::hasProducer(input)) {
+        worklist.emplace_back(nn::getProducer(input));
       }
-      nn->dataFlow.deleteNode(node);
-      changed = true;
-      break;
     }
-  } while (changed);
+
+    // No outputs are used, delete them and the node itself.
+    for (const auto& output : nn::getOutputs(node)) {
+      nn->dataFlow.deleteNode(output);
+    }
+    nn->dataFlow.deleteNode(node);
+  }
 }
 
 REGISTER_OPT_PASS_FROM_FUNC(DeadCodeElim, deadCodeElim);
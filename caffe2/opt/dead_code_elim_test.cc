@@ -55,3 +55,28 @@ TEST(DeadCodeElim, PartiallyUsedNoElim) {
   auto optimized_net = caffe2::convertToCaffe2Proto(nn, net);
   EXPECT_EQ(optimized_net.op().size(), 1);
 }
+
+TEST(DeadCodeElim, ChainElim) {
+  caffe2::NetDef net;
+  for (int i = 0; i < 4; ++i) {
+    caffe2::OperatorDef* def = net.add_op();
+    def->set_type("Fake");
+    def->add_input("X" + caffe2::to_string(i));
+    def->add_output("X" + caffe2::to_string(i + 1));
+  }
+  {
+    caffe2::OperatorDef* def = net.add_op();
+    def->set_type("Fake");
+    def->add_input("X1");
+    def->add_output("Y");
+  }
+  net.add_external_output("Y");
+  // Only the first op feeds an external output, removing the last op makes
+  // the ones before it unused in turn
+
+  auto nn = caffe2::convertToNNModule(net);
+  auto pass = caffe2::OptimizationPassRegistry()->Create("DeadCodeElim", &nn);
+  pass->run();
+  auto optimized_net = caffe2::convertToCaffe2Proto(nn, net);
+  EXPECT_EQ(optimized_net.op().size(), 2);
+}
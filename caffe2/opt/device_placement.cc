@@ -0,0 +1,285 @@
+#include "caffe2/opt/device_placement.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+namespace opt {
+
+namespace {
+
+// Stage of every op, see PlaceOnDevices
+std::vector<int> PartitionStages(
+    const NetDef& net,
+    const DevicePlacementOptions& options) {
+  const int num_ops = net.op_size();
+  const int num_stages = options.devices.size();
+  CAFFE_ENFORCE(
+      options.memory_budgets.empty() ||
+      options.memory_budgets.size() == options.devices.size());
+
+  // Prefix sums of the costs of the ops and of the bytes of the blobs, which
+  // are counted at their first use
+  std::vector<double> cost_prefix(num_ops + 1, 0);
+  std::vector<double> bytes_prefix(num_ops + 1, 0);
+  std::unordered_set<std::string> seen_blobs;
+  for (int i = 0; i < num_ops; ++i) {
+    const auto& op = net.op(i);
+    cost_prefix[i + 1] =
+        cost_prefix[i] + (options.op_cost ? options.op_cost(op) : 1.0f);
+    double bytes = 0;
+    if (options.blob_bytes) {
+      for (const auto& names : {op.input(), op.output()}) {
+        for (const auto& name : names) {
+          if (seen_blobs.insert(name).second) {
+            bytes += options.blob_bytes(name);
+          }
+        }
+      }
+    }
+    bytes_prefix[i + 1] = bytes_prefix[i] + bytes;
+  }
+  auto fits = [&](int stage, int begin, int end) {
+    return options.memory_budgets.empty() ||
+        bytes_prefix[end] - bytes_prefix[begin] <=
+        options.memory_budgets[stage];
+  };
+
+  // best[s][j] is the lowest cost of the most costly stage when the first j
+  // ops are run by the first s + 1 stages, the last of which starts at
+  // begin[s][j]. Stages may be empty.
+  const double kInfinity = std::numeric_limits<double>::infinity();
+  std::vector<std::vector<double>> best(
+      num_stages, std::vector<double>(num_ops + 1, kInfinity));
+  std::vector<std::vector<int>> begin(
+      num_stages, std::vector<int>(num_ops + 1, 0));
+  for (int j = 0; j <= num_ops; ++j) {
+    if (fits(0, 0, j)) {
+      best[0][j] = cost_prefix[j];
+    }
+  }
+  for (int s = 1; s < num_stages; ++s) {
+    for (int j = 0; j <= num_ops; ++j) {
+      for (int i = 0; i <= j; ++i) {
+        if (best[s - 1][i] == kInfinity || !fits(s, i, j)) {
+          continue;
+        }
+        const double cost =
+            std::max(best[s - 1][i], cost_prefix[j] - cost_prefix[i]);
+        if (cost < best[s][j]) {
+          best[s][j] = cost;
+          begin[s][j] = i;
+        }
+      }
+    }
+  }
+  CAFFE_ENFORCE(
+      best[num_stages - 1][num_ops] != kInfinity,
+      "Net ",
+      net.name(),
+      " does not fit in the memory budgets of the devices");
+
+  std::vector<int> stages(num_ops);
+  for (int s = num_stages - 1, end = num_ops; s >= 0; --s) {
+    const int stage_begin = s > 0 ? begin[s][end] : 0;
+    std::fill(stages.begin() + stage_begin, stages.begin() + end, s);
+    end = stage_begin;
+  }
+  return stages;
+}
+
+std::string MicroBatchName(const std::string& name, int micro_batch) {
+  return name + "_mb" + caffe2::to_string(micro_batch);
+}
+
+// Replicates the ops that depend on the batch inputs per micro-batch, and
+// updates the stages of the ops accordingly
+NetDef SplitMicroBatches(
+    const NetDef& net,
+    const DevicePlacementOptions& options,
+    std::vector<int>* stages) {
+  const int num_micro_batches = options.num_micro_batches;
+  NetDef result(net);
+  result.clear_op();
+  std::vector<int> result_stages;
+
+  // The batch inputs are split by the stage of their first consumer
+  std::unordered_set<std::string> batch_blobs;
+  for (const auto& input : options.batch_inputs) {
+    for (int i = 0; i < net.op_size(); ++i) {
+      const auto& op_inputs = net.op(i).input();
+      if (std::find(op_inputs.begin(), op_inputs.end(), input) ==
+          op_inputs.end()) {
+        continue;
+      }
+      auto* split = result.add_op();
+      split->set_type("Split");
+      split->add_input(input);
+      for (int m = 0; m < num_micro_batches; ++m) {
+        split->add_output(MicroBatchName(input, m));
+      }
+      split->add_arg()->CopyFrom(MakeArgument<int>("axis", 0));
+      result_stages.push_back(stages->at(i));
+      batch_blobs.insert(input);
+      break;
+    }
+  }
+
+  std::unordered_map<std::string, int> producer_stages;
+  for (int i = 0; i < net.op_size(); ++i) {
+    const auto& op = net.op(i);
+    const bool depends_on_batch = std::any_of(
+        op.input().begin(),
+        op.input().end(),
+        [&batch_blobs](const std::string& input) {
+          return batch_blobs.count(input) > 0;
+        });
+    if (!depends_on_batch) {
+      result.add_op()->CopyFrom(op);
+      result_stages.push_back(stages->at(i));
+      for (const auto& output : op.output()) {
+        batch_blobs.erase(output);
+      }
+      continue;
+    }
+    for (int m = 0; m < num_micro_batches; ++m) {
+      auto* replica = result.add_op();
+      replica->CopyFrom(op);
+      for (auto& input : *replica->mutable_input()) {
+        if (batch_blobs.count(input)) {
+          input = MicroBatchName(input, m);
+        }
+      }
+      for (auto& output : *replica->mutable_output()) {
+        output = MicroBatchName(output, m);
+      }
+      result_stages.push_back(stages->at(i));
+    }
+    for (const auto& output : op.output()) {
+      batch_blobs.insert(output);
+      producer_stages[output] = stages->at(i);
+    }
+  }
+
+  for (const auto& output : net.external_output()) {
+    if (!batch_blobs.count(output)) {
+      continue;
+    }
+    auto* concat = result.add_op();
+    concat->set_type("Concat");
+    for (int m = 0; m < num_micro_batches; ++m) {
+      concat->add_input(MicroBatchName(output, m));
+    }
+    concat->add_output(output);
+    concat->add_output(output + "_split_info");
+    concat->add_arg()->CopyFrom(MakeArgument<int>("axis", 0));
+    const auto it = producer_stages.find(output);
+    result_stages.push_back(
+        it != producer_stages.end() ? it->second : result_stages.back());
+  }
+
+  *stages = std::move(result_stages);
+  return result;
+}
+
+OperatorDef MakeCopy(
+    const std::string& input,
+    const std::string& output,
+    const DeviceOption& from,
+    const DeviceOption& to) {
+  OperatorDef copy;
+  copy.add_input(input);
+  copy.add_output(output);
+  const auto from_type = from.device_type();
+  const auto to_type = to.device_type();
+  if (from_type == PROTO_CPU && to_type == PROTO_CUDA) {
+    copy.set_type("CopyCPUToGPU");
+    copy.mutable_device_option()->CopyFrom(to);
+  } else if (from_type == PROTO_CUDA && to_type == PROTO_CPU) {
+    copy.set_type("CopyGPUToCPU");
+    copy.mutable_device_option()->CopyFrom(from);
+  } else if (from_type == to_type) {
+    copy.set_type("Copy");
+    copy.mutable_device_option()->CopyFrom(to);
+  } else {
+    CAFFE_THROW(
+        "Unsupported copy of ",
+        input,
+        " from device type ",
+        from_type,
+        " to ",
+        to_type);
+  }
+  return copy;
+}
+
+// Sets the device options of the ops and inserts the copies between devices
+NetDef InsertCopies(
+    const NetDef& net,
+    const DevicePlacementOptions& options,
+    std::vector<int>* stages) {
+  NetDef result(net);
+  result.clear_op();
+  std::vector<int> result_stages;
+
+  // Stage that wrote the current value of a blob, and its copies per stage
+  std::unordered_map<std::string, int> locations;
+  std::unordered_map<std::string, std::unordered_map<int, std::string>> copies;
+  for (int i = 0; i < net.op_size(); ++i) {
+    const int stage = stages->at(i);
+    const auto& device = options.devices[stage];
+    OperatorDef op(net.op(i));
+    for (auto& input : *op.mutable_input()) {
+      // External inputs are expected on the device of their first consumer
+      const int location = locations.emplace(input, stage).first->second;
+      if (IsSameDevice(options.devices[location], device)) {
+        continue;
+      }
+      auto& copy_name = copies[input][stage];
+      if (copy_name.empty()) {
+        copy_name = input + "_stage_" + caffe2::to_string(stage);
+        *result.add_op() = MakeCopy(
+            input, copy_name, options.devices[location], device);
+        result_stages.push_back(stage);
+      }
+      input = copy_name;
+    }
+    op.mutable_device_option()->CopyFrom(device);
+    for (const auto& output : op.output()) {
+      locations[output] = stage;
+      copies.erase(output);
+    }
+    *result.add_op() = std::move(op);
+    result_stages.push_back(stage);
+  }
+
+  *stages = std::move(result_stages);
+  return result;
+}
+
+} // namespace
+
+NetDef PlaceOnDevices(
+    const NetDef& net,
+    const DevicePlacementOptions& options,
+    std::vector<int>* stages) {
+  CAFFE_ENFORCE(!options.devices.empty(), "No device to place net on");
+  CAFFE_ENFORCE_GE(options.num_micro_batches, 1);
+  std::vector<int> op_stages = PartitionStages(net, options);
+  NetDef result = options.num_micro_batches > 1
+      ? SplitMicroBatches(net, options, &op_stages)
+      : net;
+  result = InsertCopies(result, options, &op_stages);
+  if (stages) {
+    *stages = std::move(op_stages);
+  }
+  return result;
+}
+
+} // namespace opt
+} // namespace caffe2
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "caffe2/core/common.h"
+#include "caffe2/proto/caffe2_pb.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace caffe2 {
+namespace opt {
+
+struct CAFFE2_API DevicePlacementOptions {
+  // Devices of the stages, in the order of the net
+  std::vector<caffe2::DeviceOption> devices;
+  // Cost of an op, 1 if not set
+  std::function<float(const caffe2::OperatorDef&)> op_cost;
+  // Size in bytes of a blob, e.g. from shape inference, 0 if not set
+  std::function<int64_t(const std::string&)> blob_bytes;
+  // Bytes available on each device, unlimited if empty
+  std::vector<int64_t> memory_budgets;
+  // Number of micro-batches that the batch_inputs are split into along their
+  // first dimension
+  int num_micro_batches{1};
+  std::vector<std::string> batch_inputs;
+};
+
+// Splits a topologically sorted net into contiguous stages, one per device,
+// which minimize the cost of the most costly stage while the blobs that each
+// stage touches fit in its device's memory budget.
+//
+// Every op gets the device option of its stage. A blob read on another device
+// than the one it was written on (or, for the external inputs, the one of
+// their first consumer) is copied once per device, with CopyCPUToGPU,
+// CopyGPUToCPU or Copy.
+//
+// With num_micro_batches > 1, the batch inputs are split, the ops that depend
+// on them are replicated per micro-batch and the external outputs that depend
+// on them are concatenated. Run by an async net, a stage can then work on a
+// micro-batch while the next stage works on the previous one. This is only
+// valid for ops that treat the rows of the batch independently, as inference
+// ops do.
+//
+// Returns the stage of every op of the net in stages if not null.
+CAFFE2_API caffe2::NetDef PlaceOnDevices(
+    const caffe2::NetDef& net,
+    const DevicePlacementOptions& options,
+    std::vector<int>* stages = nullptr);
+
+} // namespace opt
+} // namespace caffe2
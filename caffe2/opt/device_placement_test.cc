@@ -0,0 +1,89 @@
+#include "caffe2/core/common.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/opt/device_placement.h"
+#include "caffe2/utils/proto_utils.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+void AddOp(
+    caffe2::NetDef* net,
+    const std::string& type,
+    const std::string& input,
+    const std::string& output) {
+  auto* op = net->add_op();
+  op->set_type(type);
+  op->add_input(input);
+  op->add_output(output);
+}
+
+} // namespace
+
+// X -> Relu -> h0 -> Relu -> h1 -> Relu -> h2 -> Relu -> Y
+TEST(DevicePlacementTest, BalancesStagesAndCopies) {
+  caffe2::NetDef net;
+  net.add_external_input("X");
+  net.add_external_output("Y");
+  AddOp(&net, "Relu", "X", "h0");
+  AddOp(&net, "Relu", "h0", "h1");
+  AddOp(&net, "Relu", "h1", "h2");
+  AddOp(&net, "Relu", "h2", "Y");
+
+  caffe2::opt::DevicePlacementOptions options;
+  options.devices.resize(2);
+  options.devices[0].set_device_type(caffe2::PROTO_CPU);
+  options.devices[1].set_device_type(caffe2::PROTO_CUDA);
+  std::vector<int> stages;
+  auto placed = caffe2::opt::PlaceOnDevices(net, options, &stages);
+
+  ASSERT_EQ(5, placed.op_size());
+  EXPECT_EQ(std::vector<int>({0, 0, 1, 1, 1}), stages);
+  EXPECT_EQ("CopyCPUToGPU", placed.op(2).type());
+  EXPECT_EQ("h1", placed.op(2).input(0));
+  EXPECT_EQ(placed.op(2).output(0), placed.op(3).input(0));
+  EXPECT_EQ(caffe2::PROTO_CPU, placed.op(1).device_option().device_type());
+  EXPECT_EQ(caffe2::PROTO_CUDA, placed.op(3).device_option().device_type());
+
+  // The five blobs do not fit in the budgets
+  options.blob_bytes = [](const std::string&) { return 1; };
+  options.memory_budgets = {1, 3};
+  EXPECT_ANY_THROW(caffe2::opt::PlaceOnDevices(net, options));
+  options.memory_budgets = {2, 10};
+  caffe2::opt::PlaceOnDevices(net, options, &stages);
+  EXPECT_EQ(std::vector<int>({0, 1, 1, 1}), stages);
+}
+
+TEST(DevicePlacementTest, MicroBatchesMatchNet) {
+  caffe2::NetDef net;
+  net.add_external_input("X");
+  net.add_external_output("Y");
+  AddOp(&net, "Relu", "X", "h");
+  AddOp(&net, "Scale", "h", "Y");
+  net.mutable_op(1)->add_arg()->CopyFrom(
+      caffe2::MakeArgument<float>("scale", 2.0f));
+
+  caffe2::opt::DevicePlacementOptions options;
+  options.devices.resize(2);
+  options.num_micro_batches = 2;
+  options.batch_inputs = {"X"};
+  auto placed = caffe2::opt::PlaceOnDevices(net, options);
+  // Split, 2 Relu, 2 Scale and Concat
+  ASSERT_EQ(6, placed.op_size());
+
+  caffe2::Workspace ws;
+  auto* X = caffe2::BlobGetMutableTensor(ws.CreateBlob("X"), caffe2::CPU);
+  X->Resize(4, 3);
+  for (int i = 0; i < X->size(); ++i) {
+    X->mutable_data<float>()[i] = i % 5 - 2.0f;
+  }
+  ASSERT_TRUE(ws.RunNetOnce(net));
+  caffe2::Tensor expected(caffe2::CPU);
+  expected.CopyFrom(ws.GetBlob("Y")->Get<caffe2::TensorCPU>());
+  ASSERT_TRUE(ws.RunNetOnce(placed));
+  const auto& Y = ws.GetBlob("Y")->Get<caffe2::TensorCPU>();
+  ASSERT_EQ(expected.dims(), Y.dims());
+  for (int i = 0; i < Y.size(); ++i) {
+    EXPECT_EQ(expected.data<float>()[i], Y.data<float>()[i]);
+  }
+}
@@ -1,4 +1,7 @@
 #include "caffe2/opt/fusion.h"
+
+#include <map>
+
 #include "caffe2/core/logging.h"
 #include "caffe2/opt/converter.h"
 #include "caffe2/opt/passes.h"
@@ -120,5 +123,99 @@ void fuseConvBN(nom::repr::NNModule* nn, caffe2::Workspace* ws) {
 
 REGISTER_WS_OPT_PASS_FROM_FUNC(FuseConvBN, fuseConvBN);
 
+namespace {
+
+Caffe2Annotation* getCaffe2Annotation(repr::NNGraph::NodeRef node) {
+  auto* annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getMutableAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return nullptr;
+  }
+  return dyn_cast<Caffe2Annotation>(annotation);
+}
+
+// The fused op of an op followed by an activation, or "" when there is none
+std::string getFusedActivationOp(
+    const OperatorDef& op,
+    const OperatorDef& activation) {
+  static const std::map<std::pair<std::string, std::string>, std::string>
+      kFusedOps = {{{"FC", "Relu"}, "FCRelu"},
+                   {{"FC", "Sigmoid"}, "FCSigmoid"},
+                   {{"FC", "Tanh"}, "FCTanh"},
+                   {{"Sum", "Relu"}, "SumRelu"}};
+  auto it = kFusedOps.find(std::make_pair(op.type(), activation.type()));
+  if (it == kFusedOps.end()) {
+    return "";
+  }
+  // The fused ops are registered for the default engine, and SumRelu only
+  // for CPU
+  const auto device_type = op.device_option().device_type();
+  const bool registered = device_type == PROTO_CPU ||
+      (device_type == PROTO_CUDA && op.type() == "FC");
+  if (!op.engine().empty() || !registered) {
+    return "";
+  }
+  return it->second;
+}
+
+bool fuseFCAndSumActivationHelper(repr::NNModule* nn) {
+  for (auto node : nn->dataFlow.getMutableNodes()) {
+    NOM_REQUIRE_OR_CONT(repr::nn::is<repr::NeuralNetOperator>(node));
+    auto* annotation = getCaffe2Annotation(node);
+    NOM_REQUIRE_OR_CONT(annotation != nullptr);
+
+    auto outputs = repr::nn::getOutputs(node);
+    NOM_REQUIRE_OR_CONT(outputs.size() == 1);
+    auto output = outputs.front();
+    // The unfused output must not be used elsewhere
+    NOM_REQUIRE_OR_CONT(nn->outputs.count(output) == 0);
+    auto consumers = repr::nn::getConsumers(output);
+    NOM_REQUIRE_OR_CONT(consumers.size() == 1);
+    auto activationNode = consumers.front();
+    auto* activationAnnotation = getCaffe2Annotation(activationNode);
+    NOM_REQUIRE_OR_CONT(activationAnnotation != nullptr);
+    auto activationOutputs = repr::nn::getOutputs(activationNode);
+    NOM_REQUIRE_OR_CONT(activationOutputs.size() == 1);
+    auto activationOutput = activationOutputs.front();
+
+    auto* op = annotation->getMutableOperatorDef();
+    const auto& activationOp = activationAnnotation->getOperatorDef();
+    NOM_REQUIRE_OR_CONT(
+        op->device_option().device_type() ==
+        activationOp.device_option().device_type());
+    const auto fusedType = getFusedActivationOp(*op, activationOp);
+    NOM_REQUIRE_OR_CONT(!fusedType.empty());
+
+    // FC can't run in-place
+    const auto& outputName =
+        repr::nn::get<repr::Tensor>(activationOutput)->getName();
+    bool inplace = false;
+    for (auto input : repr::nn::getInputs(node)) {
+      inplace |= repr::nn::get<repr::Tensor>(input)->getName() == outputName;
+    }
+    NOM_REQUIRE_OR_CONT(!inplace || op->type() == "Sum");
+
+    nn->dataFlow.deleteNode(activationNode);
+    nn->dataFlow.deleteNode(output);
+    nn->dataFlow.createEdge(node, activationOutput);
+    op->set_type(fusedType);
+    auto* nnOp = repr::nn::get<repr::NeuralNetOperator>(node);
+    if (isa<repr::GenericOperator>(nnOp)) {
+      dyn_cast<repr::GenericOperator>(nnOp)->setName(fusedType);
+    }
+    return true;
+  }
+  return false;
+}
+
+} // namespace
+
+void fuseFCAndSumActivation(repr::NNModule* nn) {
+  while (fuseFCAndSumActivationHelper(nn)) {
+  }
+}
+
+REGISTER_OPT_PASS_FROM_FUNC(FuseFCAndSumActivation, fuseFCAndSumActivation);
+
 } // namespace opt
 } // namespace caffe2
@@ -27,6 +27,11 @@ using namespace nom;
 
 CAFFE2_API void fuseConvBN(repr::NNModule* nn, caffe2::Workspace* ws);
 
+// Replaces FC followed by Relu, Sigmoid or Tanh with FCRelu, FCSigmoid or
+// FCTanh, and Sum followed by Relu with SumRelu, for CPU and CUDA ops of the
+// default engine whose unfused output is only used by the activation
+CAFFE2_API void fuseFCAndSumActivation(repr::NNModule* nn);
+
 // Generic activation fusion helper.
 //
 // \tparam OperationT The operator to be fused.
@@ -0,0 +1,86 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include "caffe2/core/net.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/fusion.h"
+
+namespace caffe2 {
+
+namespace {
+
+void AddOp(
+    NetDef* net,
+    const string& type,
+    const vector<string>& inputs,
+    const string& output) {
+  auto* op = net->add_op();
+  op->set_type(type);
+  for (const auto& input : inputs) {
+    op->add_input(input);
+  }
+  op->add_output(output);
+}
+
+void FillTensor(Workspace* ws, const string& name, vector<int64_t> dims) {
+  auto* tensor = BlobGetMutableTensor(ws->CreateBlob(name), CPU);
+  tensor->Resize(dims);
+  float* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->size(); ++i) {
+    data[i] = std::sin(0.9 * i + name.size());
+  }
+}
+
+} // namespace
+
+TEST(FusionTest, FCAndSumActivation) {
+  NetDef net;
+  net.set_name("fc_activation");
+  AddOp(&net, "FC", {"X", "W1", "b1"}, "h");
+  AddOp(&net, "Relu", {"h"}, "h");
+  AddOp(&net, "FC", {"h", "W2", "b2"}, "y");
+  AddOp(&net, "Sigmoid", {"y"}, "s");
+  AddOp(&net, "Sum", {"s", "X"}, "t");
+  AddOp(&net, "Relu", {"t"}, "z");
+  // The output of this FC is used twice, so it can't be fused
+  AddOp(&net, "FC", {"z", "W3", "b3"}, "u");
+  AddOp(&net, "Tanh", {"u"}, "v");
+  for (const auto& input : {"X", "W1", "b1", "W2", "b2", "W3", "b3"}) {
+    net.add_external_input(input);
+  }
+  net.add_external_output("u");
+  net.add_external_output("v");
+
+  auto nn = convertToNNModule(net);
+  opt::fuseFCAndSumActivation(&nn);
+  auto fused = convertToCaffe2Proto(nn, net);
+  vector<string> types;
+  for (const auto& op : fused.op()) {
+    types.push_back(op.type());
+  }
+  EXPECT_EQ(
+      types,
+      (vector<string>{"FCRelu", "FCSigmoid", "SumRelu", "FC", "Tanh"}));
+
+  // The fused net computes the same outputs
+  Workspace ws;
+  FillTensor(&ws, "X", {3, 4});
+  FillTensor(&ws, "W1", {5, 4});
+  FillTensor(&ws, "b1", {5});
+  FillTensor(&ws, "W2", {4, 5});
+  FillTensor(&ws, "b2", {4});
+  FillTensor(&ws, "W3", {2, 4});
+  FillTensor(&ws, "b3", {2});
+  ASSERT_TRUE(ws.RunNetOnce(net));
+  Tensor expected(CPU);
+  expected.CopyFrom(ws.GetBlob("v")->Get<TensorCPU>());
+  ASSERT_TRUE(ws.RunNetOnce(fused));
+  const auto& v = ws.GetBlob("v")->Get<TensorCPU>();
+  ASSERT_EQ(v.dims(), expected.dims());
+  for (int64_t i = 0; i < v.size(); ++i) {
+    EXPECT_NEAR(v.data<float>()[i], expected.data<float>()[i], 1e-5);
+  }
+}
+
+} // namespace caffe2
@@ -12,6 +12,26 @@
 #include "caffe2/onnx/onnx_exporter.h"
 #include "caffe2/opt/backend_cutting.h"
 
+C10_DEFINE_double(
+    caffe2_onnxifi_transfer_cost,
+    0,
+    "Cost, in ops, of moving a tensor between the host and the ONNXIFI "
+    "backend. The supported subgraphs that do not have more ops than the "
+    "costs of their boundary tensors are kept on the host.");
+
+C10_DEFINE_bool(
+    caffe2_onnxifi_share_graph,
+    false,
+    "Share the backend graphs, and thus the weights uploaded to the backend, "
+    "between the Onnxifi ops of the predictor instances of a model. The runs "
+    "of a shared graph are serialized.");
+
+C10_DEFINE_bool(
+    caffe2_onnxifi_async,
+    false,
+    "Let the Onnxifi ops of async nets finish on the backend while the host "
+    "runs the next ops");
+
 namespace caffe2 {
 
 namespace {
@@ -131,6 +151,12 @@ OperatorDef OnnxifiTransformer::BuildOnnxifiOp(
     initializers_arg->add_strings(s);
     initializers_arg->add_strings(input_mapping_.at(s));
   }
+  if (FLAGS_caffe2_onnxifi_share_graph) {
+    op.add_arg()->CopyFrom(MakeArgument<int>("share_graph", 1));
+  }
+  if (FLAGS_caffe2_onnxifi_async) {
+    op.add_arg()->CopyFrom(MakeArgument<int>("async", 1));
+  }
 
   // Add the input/output
   for (const auto& input : net.external_input()) {
@@ -409,7 +435,11 @@ void OnnxifiTransformer::Transform(
     return SubnetToOnnxifiOp(net, mapped_ws, ws, &exporter2, &shape_hints);
   };
 
-  NetDef net_opt = opt::OptimizeForBackend(*pred_net, supports, trt_converter);
+  // Each boundary tensor of a subgraph is copied on every run
+  opt::BackendCuttingCost cost;
+  cost.transfer_cost = FLAGS_caffe2_onnxifi_transfer_cost;
+  NetDef net_opt =
+      opt::OptimizeForBackend(*pred_net, supports, trt_converter, cost);
 
   // Need to figure out a proper place to handle device option
   net_opt.mutable_device_option()->CopyFrom(pred_net->device_option());
@@ -0,0 +1,70 @@
+#include "caffe2/perfkernels/adagrad.h"
+
+#include <cmath>
+
+#include "caffe2/perfkernels/common.h"
+#include "caffe2/utils/cpuid.h"
+
+namespace caffe2 {
+
+void adagrad_update__base(
+    int N,
+    const float* w,
+    const float* g,
+    const float* h,
+    float* nw,
+    float* nh,
+    float epsilon,
+    float decay,
+    float lr) {
+  for (auto i = 0; i < N; ++i) {
+    float gi = g[i];
+    float hi = nh[i] = decay * h[i] + gi * gi;
+    nw[i] = w[i] + lr * gi / (std::sqrt(hi) + epsilon);
+  }
+}
+
+void rowwise_adagrad_update__base(
+    int N,
+    float* w,
+    const float* g,
+    float* h,
+    float epsilon,
+    float lr) {
+  float hs = 0.;
+  for (auto i = 0; i < N; ++i) {
+    hs += g[i] * g[i];
+  }
+  float hi = *h = *h + hs / N;
+  float step = lr / (std::sqrt(hi) + epsilon);
+  for (auto i = 0; i < N; ++i) {
+    w[i] += g[i] * step;
+  }
+}
+
+void adagrad_update(
+    int N,
+    const float* w,
+    const float* g,
+    const float* h,
+    float* nw,
+    float* nh,
+    float epsilon,
+    float decay,
+    float lr) {
+  AVX2_FMA_DO(adagrad_update, N, w, g, h, nw, nh, epsilon, decay, lr);
+  BASE_DO(adagrad_update, N, w, g, h, nw, nh, epsilon, decay, lr);
+}
+
+void rowwise_adagrad_update(
+    int N,
+    float* w,
+    const float* g,
+    float* h,
+    float epsilon,
+    float lr) {
+  AVX2_FMA_DO(rowwise_adagrad_update, N, w, g, h, epsilon, lr);
+  BASE_DO(rowwise_adagrad_update, N, w, g, h, epsilon, lr);
+}
+
+} // namespace caffe2
@@ -0,0 +1,32 @@
+#pragma once
+
+namespace caffe2 {
+
+// Adagrad update of N values, where every value has its own moment:
+//   nh[i] = decay * h[i] + g[i]^2
+//   nw[i] = w[i] + lr * g[i] / (sqrt(nh[i]) + epsilon)
+// nw and nh may alias w and h.
+void adagrad_update(
+    int N,
+    const float* w,
+    const float* g,
+    const float* h,
+    float* nw,
+    float* nh,
+    float epsilon,
+    float decay,
+    float lr);
+
+// Row-wise Adagrad update of a row of N values that share the moment *h,
+// in place:
+//   *h += mean(g^2)
+//   w[i] += lr * g[i] / (sqrt(*h) + epsilon)
+void rowwise_adagrad_update(
+    int N,
+    float* w,
+    const float* g,
+    float* h,
+    float epsilon,
+    float lr);
+
+} // namespace caffe2
@@ -0,0 +1,79 @@
+#include "caffe2/perfkernels/adagrad.h"
+
+#include <cmath>
+
+#include <immintrin.h>
+
+namespace caffe2 {
+
+void adagrad_update__avx2_fma(
+    int N,
+    const float* w,
+    const float* g,
+    const float* h,
+    float* nw,
+    float* nh,
+    float epsilon,
+    float decay,
+    float lr) {
+  constexpr int kSize = 8;
+  const __m256 vdecay = _mm256_set1_ps(decay);
+  const __m256 vepsilon = _mm256_set1_ps(epsilon);
+  const __m256 vlr = _mm256_set1_ps(lr);
+  auto i = 0;
+  for (; i + kSize <= N; i += kSize) {
+    __m256 gi = _mm256_loadu_ps(g + i);
+    __m256 hi = _mm256_fmadd_ps(gi, gi, _mm256_mul_ps(vdecay,
+        _mm256_loadu_ps(h + i)));
+    _mm256_storeu_ps(nh + i, hi);
+    __m256 step = _mm256_div_ps(
+        _mm256_mul_ps(vlr, gi), _mm256_add_ps(_mm256_sqrt_ps(hi), vepsilon));
+    _mm256_storeu_ps(nw + i, _mm256_add_ps(_mm256_loadu_ps(w + i), step));
+  }
+  for (; i < N; ++i) {
+    float gi = g[i];
+    float hi = nh[i] = decay * h[i] + gi * gi;
+    nw[i] = w[i] + lr * gi / (std::sqrt(hi) + epsilon);
+  }
+}
+
+void rowwise_adagrad_update__avx2_fma(
+    int N,
+    float* w,
+    const float* g,
+    float* h,
+    float epsilon,
+    float lr) {
+  constexpr int kSize = 8;
+  __m256 partial_sum = _mm256_setzero_ps();
+  auto i = 0;
+  for (; i + kSize <= N; i += kSize) {
+    __m256 gi = _mm256_loadu_ps(g + i);
+    partial_sum = _mm256_fmadd_ps(gi, gi, partial_sum);
+  }
+  // Horizontal sum of the 8 partial sums
+  __m128 sum = _mm_add_ps(
+      _mm256_castps256_ps128(partial_sum),
+      _mm256_extractf128_ps(partial_sum, 1));
+  sum = _mm_hadd_ps(sum, sum);
+  sum = _mm_hadd_ps(sum, sum);
+  float hs = _mm_cvtss_f32(sum);
+  for (; i < N; ++i) {
+    hs += g[i] * g[i];
+  }
+
+  float hi = *h = *h + hs / N;
+  float step = lr / (std::sqrt(hi) + epsilon);
+  const __m256 vstep = _mm256_set1_ps(step);
+  for (i = 0; i + kSize <= N; i += kSize) {
+    _mm256_storeu_ps(
+        w + i,
+        _mm256_fmadd_ps(
+            _mm256_loadu_ps(g + i), vstep, _mm256_loadu_ps(w + i)));
+  }
+  for (; i < N; ++i) {
+    w[i] += g[i] * step;
+  }
+}
+
+} // namespace caffe2
@@ -1,5 +1,8 @@
 #include "caffe2/perfkernels/embedding_lookup.h"
 
+#include <algorithm>
+
+#include "c10/util/Flags.h"
 #include "caffe2/core/types.h"
 #include "caffe2/perfkernels/common.h"
 #include "caffe2/perfkernels/typed_axpy.h"
@@ -7,8 +10,33 @@
 #include "caffe2/utils/eigen_utils.h"
 #include "caffe2/utils/math.h"
 
+C10_DEFINE_int64(
+    caffe2_embedding_lookup_prefetch_bytes,
+    8192,
+    "Bytes of rows that embedding lookups keep prefetching ahead of the "
+    "current lookup");
+C10_DEFINE_int64(
+    caffe2_embedding_lookup_prefetch_distance,
+    0,
+    "If positive, the number of lookups ahead of the current one whose rows "
+    "embedding lookups prefetch, instead of deriving it from the row size");
+
 namespace caffe2 {
 
+int64_t EmbeddingLookupPrefetchDistance(int64_t row_bytes) {
+  if (FLAGS_caffe2_embedding_lookup_prefetch_distance > 0) {
+    return FLAGS_caffe2_embedding_lookup_prefetch_distance;
+  }
+  // Capped so that the kernels don't evict rows they are about to use
+  const int64_t kMaxDistance = 64;
+  return std::max<int64_t>(
+      1,
+      std::min(
+          kMaxDistance,
+          FLAGS_caffe2_embedding_lookup_prefetch_bytes /
+              std::max<int64_t>(row_bytes, 1)));
+}
+
 // Base implementation does runtime dispatch for each segment of reduction
 template <
     typename IndexType,
@@ -27,6 +55,8 @@ static void EmbeddingLookupGenericSlow(
     const float* scale_bias, // optional scale & bias params for uint8 input
     bool normalize_by_lengths,
     OutType* out) {
+  const int64_t prefdist =
+      EmbeddingLookupPrefetchDistance(block_size * sizeof(InType));
   int64_t current = 0;
   for (int m = 0; m < output_size; ++m) {
     memset(out, 0, sizeof(OutType) * block_size);
@@ -44,8 +74,9 @@ static void EmbeddingLookupGenericSlow(
           data_size);
       CAFFE_ENFORCE_LT(idx, data_size);
 #ifdef __GNUC__
-      if (current + 1 < index_size) {
-        __builtin_prefetch(input + block_size * indices[current + 1], 0, 1);
+      if (current + prefdist < index_size) {
+        __builtin_prefetch(
+            input + block_size * indices[current + prefdist], 0, 1);
       }
 #endif // __GNUC__
 
@@ -127,6 +158,19 @@ static void EmbeddingLookupGenericSlow(
       const float* scale_bias,                                                                         \
       bool normalize_by_lengths,                                                                       \
       OutType* out) {                                                                                  \
+    AVX512_DO(                                                                                         \
+        EmbeddingLookup_##IndexTypeName##_##InTypeName##_##OutTypeName##_##IS_WEIGHT_POSITIONAL,       \
+        block_size,                                                                                    \
+        output_size,                                                                                   \
+        index_size,                                                                                    \
+        data_size,                                                                                     \
+        input,                                                                                         \
+        indices,                                                                                       \
+        lengths,                                                                                       \
+        weights,                                                                                       \
+        scale_bias,                                                                                    \
+        normalize_by_lengths,                                                                          \
+        out);                                                                                          \
     AVX2_FMA_DO(                                                                                       \
         EmbeddingLookup_##IndexTypeName##_##InTypeName##_##OutTypeName##_##IS_WEIGHT_POSITIONAL,       \
         block_size,                                                                                    \
@@ -1,9 +1,23 @@
 #pragma once
 
+#include <vector>
+
 #include "caffe2/core/common.h"
+#include "caffe2/core/logging.h"
 
 namespace caffe2 {
 
+/**
+ * Number of lookups ahead of the current one whose rows the embedding lookup
+ * kernels prefetch, for rows of `row_bytes` bytes.
+ *
+ * Lookups into large tables mostly wait on memory, so the distance keeps about
+ * --caffe2_embedding_lookup_prefetch_bytes of rows in flight: short rows are
+ * prefetched further ahead than long ones. A positive
+ * --caffe2_embedding_lookup_prefetch_distance sets the distance instead.
+ */
+CAFFE2_API int64_t EmbeddingLookupPrefetchDistance(int64_t row_bytes);
+
 /**
  * Embedding lookup with reduction.
  *
@@ -48,4 +62,50 @@ void EmbeddingLookup(
     bool normalize_by_lengths,
     OutType* out);
 
+/**
+ * Same as EmbeddingLookup, with the segments given by `offsets` of size
+ * output_size + 1 instead of by lengths: segment i holds the indices from
+ * offsets[i] to offsets[i + 1] - 1, and offsets[output_size] == index_size.
+ */
+template <
+    typename IndexType,
+    typename InType,
+    typename OutType,
+    bool IS_WEIGHT_POSITIONAL = false>
+void EmbeddingLookupIdx(
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const InType* input,
+    const IndexType* indices,
+    const int* offsets,
+    const float* weights, // optional, can be null for non-weighted sum
+    const float* scale_bias, // optional scale & bias params for uint8 input
+    bool normalize_by_lengths,
+    OutType* out) {
+  CAFFE_ENFORCE_EQ(offsets[0], 0, "Offsets must start at 0");
+  CAFFE_ENFORCE_EQ(
+      offsets[output_size],
+      index_size,
+      "The last offset must be the size of the indices tensor");
+  std::vector<int> lengths(output_size);
+  for (int64_t i = 0; i < output_size; ++i) {
+    lengths[i] = offsets[i + 1] - offsets[i];
+    CAFFE_ENFORCE_GE(lengths[i], 0, "Offsets must not decrease");
+  }
+  EmbeddingLookup<IndexType, InType, OutType, IS_WEIGHT_POSITIONAL>(
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths.data(),
+      weights,
+      scale_bias,
+      normalize_by_lengths,
+      out);
+}
+
 } // namespace caffe2
@@ -7,6 +7,7 @@
 
 #include <caffe2/core/common.h>
 #include <caffe2/core/types.h>
+#include <caffe2/perfkernels/embedding_lookup.h>
 #include <immintrin.h>
 
 namespace caffe2 {
@@ -24,8 +25,9 @@ static void EmbeddingLookup_int32_t_float_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int32_t prefdist_T0 = 16;
   const int32_t fused_block_size = block_size + 0;
+  const int32_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size * sizeof(float));
   CAFFE_ENFORCE(scale_bias == nullptr, "scale_bias must be nullptr");
   if (block_size == 128) {
     // unrolling 16 times
@@ -439,8 +441,9 @@ static void EmbeddingLookup_int64_t_float_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 0;
+  const int64_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size * sizeof(float));
   CAFFE_ENFORCE(scale_bias == nullptr, "scale_bias must be nullptr");
   if (block_size == 128) {
     // unrolling 16 times
@@ -854,8 +857,9 @@ static void EmbeddingLookup_int32_t_half_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int32_t prefdist_T0 = 16;
   const int32_t fused_block_size = block_size + 0;
+  const int32_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size * sizeof(float));
   CAFFE_ENFORCE(scale_bias == nullptr, "scale_bias must be nullptr");
   if (block_size == 128) {
     // unrolling 16 times
@@ -1395,8 +1399,9 @@ static void EmbeddingLookup_int64_t_half_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 0;
+  const int64_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size * sizeof(at::Half));
   CAFFE_ENFORCE(scale_bias == nullptr, "scale_bias must be nullptr");
   if (block_size == 128) {
     // unrolling 16 times
@@ -1936,8 +1941,9 @@ static void EmbeddingLookup_int32_t_uint8_t_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int32_t prefdist_T0 = 16;
   const int32_t fused_block_size = block_size + 0;
+  const int32_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size * sizeof(at::Half));
   CAFFE_ENFORCE(scale_bias != nullptr, "scale_bias must not be nullptr");
   if (block_size == 128) {
     // unrolling 16 times
@@ -2495,8 +2501,9 @@ static void EmbeddingLookup_int64_t_uint8_t_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 0;
+  const int64_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size * sizeof(uint8_t));
   CAFFE_ENFORCE(scale_bias != nullptr, "scale_bias must not be nullptr");
   if (block_size == 128) {
     // unrolling 16 times
@@ -0,0 +1,231 @@
+#include <immintrin.h>
+
+#include <cstring>
+#include <type_traits>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/types.h"
+#include "caffe2/perfkernels/embedding_lookup.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Loads 16 elements of a row as floats
+inline __m512 Load16(const float* ip) {
+  return _mm512_loadu_ps(ip);
+}
+
+inline __m512 Load16(const at::Half* ip) {
+  return _mm512_cvtph_ps(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ip)));
+}
+
+inline __m512 Load16(const uint8_t* ip) {
+  return _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(ip))));
+}
+
+// Rows of NUM_VECS * 16 elements are summed in registers. Other block sizes
+// (NUM_VECS == 0) are summed in the output, with a scalar loop for the last
+// elements of every row.
+template <
+    int NUM_VECS,
+    typename IndexType,
+    typename InType,
+    bool IS_WEIGHT_POSITIONAL>
+void EmbeddingLookupKernel(
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const InType* input,
+    const IndexType* indices,
+    const int* lengths,
+    const float* weights,
+    const float* scale_bias,
+    bool normalize_by_lengths,
+    float* out) {
+  constexpr bool kHasScaleBias = std::is_same<InType, uint8_t>::value;
+  // Elements of a row in a cache line
+  constexpr int64_t kLineSize = 64 / sizeof(InType);
+  const int64_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(block_size * sizeof(InType));
+
+  int64_t dataInd = 0;
+  for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+    float* op = &out[rangeIndex * block_size];
+    __m512 vop[NUM_VECS > 0 ? NUM_VECS : 1];
+    for (int i = 0; i < NUM_VECS; ++i) {
+      vop[i] = _mm512_setzero_ps();
+    }
+    if (NUM_VECS == 0) {
+      memset(op, 0, sizeof(float) * block_size);
+    }
+    const int64_t start = dataInd;
+    CAFFE_ENFORCE_LE(start + lengths[rangeIndex], index_size);
+    for (; dataInd < start + lengths[rangeIndex]; ++dataInd) {
+      const IndexType idx = indices[dataInd];
+      CAFFE_ENFORCE(
+          idx >= 0 && idx < data_size,
+          "Index ",
+          dataInd,
+          " is out of bounds: ",
+          idx,
+          ", range 0 to ",
+          data_size);
+      float wgt = 1.f;
+      float bio = 0.f;
+      if (weights) {
+        wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+      }
+      if (kHasScaleBias) {
+        bio = wgt * scale_bias[2 * idx + 1];
+        wgt = wgt * scale_bias[2 * idx];
+      }
+      const __m512 vwgt = _mm512_set1_ps(wgt);
+      const __m512 vbio = _mm512_set1_ps(bio);
+      const InType* ip = &input[idx * block_size];
+
+      const int64_t next_T0 = (dataInd < index_size - prefdist_T0)
+          ? (dataInd + prefdist_T0)
+          : dataInd;
+      const IndexType idx_pref_T0 = indices[next_T0];
+      CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+      const InType* ip_next_T0 = &input[idx_pref_T0 * block_size];
+      for (int64_t j = 0; j < block_size; j += kLineSize) {
+        _mm_prefetch(
+            reinterpret_cast<const char*>(&ip_next_T0[j]), _MM_HINT_T0);
+      }
+
+      if (NUM_VECS > 0) {
+        for (int i = 0; i < NUM_VECS; ++i) {
+          if (kHasScaleBias) {
+            vop[i] = _mm512_add_ps(vop[i], vbio);
+          }
+          vop[i] = _mm512_fmadd_ps(vwgt, Load16(ip + 16 * i), vop[i]);
+        }
+        continue;
+      }
+      int64_t j = 0;
+      for (; j + 16 <= block_size; j += 16) {
+        __m512 vacc = _mm512_loadu_ps(&op[j]);
+        if (kHasScaleBias) {
+          vacc = _mm512_add_ps(vacc, vbio);
+        }
+        _mm512_storeu_ps(&op[j], _mm512_fmadd_ps(vwgt, Load16(&ip[j]), vacc));
+      }
+      for (; j < block_size; ++j) {
+        op[j] += wgt * static_cast<float>(ip[j]) + bio;
+      }
+    }
+
+    const float len_inv = (normalize_by_lengths && lengths[rangeIndex])
+        ? 1.0f / lengths[rangeIndex]
+        : 1.0f;
+    if (NUM_VECS > 0) {
+      const __m512 vlen_inv = _mm512_set1_ps(len_inv);
+      for (int i = 0; i < NUM_VECS; ++i) {
+        _mm512_storeu_ps(&op[16 * i], _mm512_mul_ps(vop[i], vlen_inv));
+      }
+    } else if (len_inv != 1.0f) {
+      for (int64_t j = 0; j < block_size; ++j) {
+        op[j] *= len_inv;
+      }
+    }
+  }
+}
+
+template <typename IndexType, typename InType, bool IS_WEIGHT_POSITIONAL>
+void EmbeddingLookupAvx512(
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const InType* input,
+    const IndexType* indices,
+    const int* lengths,
+    const float* weights,
+    const float* scale_bias,
+    bool normalize_by_lengths,
+    float* out) {
+  if (std::is_same<InType, uint8_t>::value) {
+    CAFFE_ENFORCE(scale_bias != nullptr, "scale_bias must not be nullptr");
+  } else {
+    CAFFE_ENFORCE(scale_bias == nullptr, "scale_bias must be nullptr");
+  }
+#define CAFFE2_EMBEDDING_LOOKUP_KERNEL(num_vecs)                            \
+  EmbeddingLookupKernel<num_vecs, IndexType, InType, IS_WEIGHT_POSITIONAL>( \
+      block_size,                                                           \
+      output_size,                                                          \
+      index_size,                                                           \
+      data_size,                                                            \
+      input,                                                                \
+      indices,                                                              \
+      lengths,                                                              \
+      weights,                                                              \
+      scale_bias,                                                           \
+      normalize_by_lengths,                                                 \
+      out)
+  if (block_size == 128) {
+    CAFFE2_EMBEDDING_LOOKUP_KERNEL(8);
+  } else if (block_size == 64) {
+    CAFFE2_EMBEDDING_LOOKUP_KERNEL(4);
+  } else if (block_size == 32) {
+    CAFFE2_EMBEDDING_LOOKUP_KERNEL(2);
+  } else if (block_size == 16) {
+    CAFFE2_EMBEDDING_LOOKUP_KERNEL(1);
+  } else {
+    CAFFE2_EMBEDDING_LOOKUP_KERNEL(0);
+  }
+#undef CAFFE2_EMBEDDING_LOOKUP_KERNEL
+}
+
+} // namespace
+
+#define EMBEDDING_AVX512_SPECIALIZATION(                                                       \
+    IndexTypeName, IndexType, InTypeName, InType, IS_WEIGHT_POSITIONAL)                        \
+  void                                                                                         \
+      EmbeddingLookup_##IndexTypeName##_##InTypeName##_float_##IS_WEIGHT_POSITIONAL##__avx512( \
+          const int64_t block_size,                                                            \
+          const int64_t output_size,                                                           \
+          const int64_t index_size,                                                            \
+          const int64_t data_size,                                                             \
+          const InType* input,                                                                 \
+          const IndexType* indices,                                                            \
+          const int* lengths,                                                                  \
+          const float* weights,                                                                \
+          const float* scale_bias,                                                             \
+          bool normalize_by_lengths,                                                           \
+          float* out) {                                                                        \
+    EmbeddingLookupAvx512<IndexType, InType, IS_WEIGHT_POSITIONAL>(                            \
+        block_size,                                                                            \
+        output_size,                                                                           \
+        index_size,                                                                            \
+        data_size,                                                                             \
+        input,                                                                                 \
+        indices,                                                                               \
+        lengths,                                                                               \
+        weights,                                                                               \
+        scale_bias,                                                                            \
+        normalize_by_lengths,                                                                  \
+        out);                                                                                  \
+  }
+
+EMBEDDING_AVX512_SPECIALIZATION(int32_t, int32_t, float, float, false);
+EMBEDDING_AVX512_SPECIALIZATION(int64_t, int64_t, float, float, false);
+EMBEDDING_AVX512_SPECIALIZATION(int32_t, int32_t, half, at::Half, false);
+EMBEDDING_AVX512_SPECIALIZATION(int64_t, int64_t, half, at::Half, false);
+EMBEDDING_AVX512_SPECIALIZATION(int32_t, int32_t, uint8_t, uint8_t, false);
+EMBEDDING_AVX512_SPECIALIZATION(int64_t, int64_t, uint8_t, uint8_t, false);
+
+EMBEDDING_AVX512_SPECIALIZATION(int32_t, int32_t, float, float, true);
+EMBEDDING_AVX512_SPECIALIZATION(int64_t, int64_t, float, float, true);
+EMBEDDING_AVX512_SPECIALIZATION(int32_t, int32_t, half, at::Half, true);
+EMBEDDING_AVX512_SPECIALIZATION(int64_t, int64_t, half, at::Half, true);
+EMBEDDING_AVX512_SPECIALIZATION(int32_t, int32_t, uint8_t, uint8_t, true);
+EMBEDDING_AVX512_SPECIALIZATION(int64_t, int64_t, uint8_t, uint8_t, true);
+
+#undef EMBEDDING_AVX512_SPECIALIZATION
+
+} // namespace caffe2
@@ -7,6 +7,7 @@
 
 #include <caffe2/core/common.h>
 #include <caffe2/core/types.h>
+#include <caffe2/perfkernels/embedding_lookup.h>
 #include <immintrin.h>
 
 namespace caffe2 {
@@ -23,8 +24,9 @@ static void Fused8BitRowwiseEmbeddingLookup_int32_t_float_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int32_t prefdist_T0 = 16;
   const int32_t fused_block_size = block_size + 2;
+  const int32_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size * sizeof(float));
   if (block_size == 128) {
     // unrolling 16 times
     int32_t dataInd = 0;
@@ -432,8 +434,9 @@ static void Fused8BitRowwiseEmbeddingLookup_int64_t_float_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 2;
+  const int64_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size * sizeof(float));
   if (block_size == 128) {
     // unrolling 16 times
     int64_t dataInd = 0;
@@ -841,8 +844,9 @@ static void Fused8BitRowwiseEmbeddingLookup_int32_t_half_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int32_t prefdist_T0 = 16;
   const int32_t fused_block_size = block_size + 4;
+  const int32_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size * sizeof(float));
   if (block_size == 128) {
     // unrolling 16 times
     int32_t dataInd = 0;
@@ -1376,8 +1380,9 @@ static void Fused8BitRowwiseEmbeddingLookup_int64_t_half_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 4;
+  const int64_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size * sizeof(at::Half));
   if (block_size == 128) {
     // unrolling 16 times
     int64_t dataInd = 0;
@@ -1911,8 +1916,9 @@ static void Fused8BitRowwiseEmbeddingLookup_int32_t_uint8_t_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int32_t prefdist_T0 = 16;
   const int32_t fused_block_size = block_size + 8;
+  const int32_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size * sizeof(at::Half));
   if (block_size == 128) {
     // unrolling 16 times
     int32_t dataInd = 0;
@@ -2473,8 +2479,9 @@ static void Fused8BitRowwiseEmbeddingLookup_int64_t_uint8_t_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 8;
+  const int64_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size * sizeof(uint8_t));
   if (block_size == 128) {
     // unrolling 16 times
     int64_t dataInd = 0;
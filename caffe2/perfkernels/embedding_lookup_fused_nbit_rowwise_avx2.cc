@@ -0,0 +1,232 @@
+#include <immintrin.h>
+
+#include <cstring>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/types.h"
+#include "caffe2/perfkernels/cvtsh_ss_bugfix.h"
+#include "caffe2/perfkernels/embedding_lookup.h"
+#include "caffe2/perfkernels/fused_nbit_rowwise_embedding_lookup.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Unpacks the 8 BIT_RATE-bit values starting at `ip` to floats. The values
+// take BIT_RATE bytes.
+template <int BIT_RATE>
+inline __m256 Unpack8(const uint8_t* ip, __m256i vshift, __m256i vmask) {
+  uint32_t packed = 0;
+  memcpy(&packed, ip, BIT_RATE);
+  return _mm256_cvtepi32_ps(_mm256_and_si256(
+      _mm256_srlv_epi32(_mm256_set1_epi32(packed), vshift), vmask));
+}
+
+// Rows of NUM_VECS * 8 values are summed in registers. Other block sizes
+// (NUM_VECS == 0) are summed in the output, with a scalar loop for the last
+// values of every row.
+template <
+    int BIT_RATE,
+    int NUM_VECS,
+    typename IndexType,
+    bool IS_WEIGHT_POSITIONAL>
+void FusedNBitRowwiseEmbeddingLookupKernel(
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const uint8_t* input,
+    const IndexType* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  constexpr int kNumElemPerByte = 8 / BIT_RATE;
+  const int64_t block_bytes = FusedNBitRowwiseBlockBytes(BIT_RATE, block_size);
+  const int64_t fused_block_size = block_bytes + 2 * sizeof(at::Half);
+  const int64_t prefdist_T0 =
+      EmbeddingLookupPrefetchDistance(fused_block_size);
+  const __m256i vshift = _mm256_mullo_epi32(
+      _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(BIT_RATE));
+  const __m256i vmask = _mm256_set1_epi32((1 << BIT_RATE) - 1);
+
+  int64_t dataInd = 0;
+  for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+    float* op = &out[rangeIndex * block_size];
+    __m256 vop[NUM_VECS > 0 ? NUM_VECS : 1];
+    for (int i = 0; i < NUM_VECS; ++i) {
+      vop[i] = _mm256_setzero_ps();
+    }
+    if (NUM_VECS == 0) {
+      memset(op, 0, sizeof(float) * block_size);
+    }
+    const int64_t start = dataInd;
+    CAFFE_ENFORCE_LE(start + lengths[rangeIndex], index_size);
+    for (; dataInd < start + lengths[rangeIndex]; ++dataInd) {
+      const IndexType idx = indices[dataInd];
+      CAFFE_ENFORCE(
+          idx >= 0 && idx < data_size,
+          "Index ",
+          dataInd,
+          " is out of bounds: ",
+          idx,
+          ", range 0 to ",
+          data_size);
+      const uint8_t* ip = &input[idx * fused_block_size];
+      const at::Half* scale_bias =
+          reinterpret_cast<const at::Half*>(ip + block_bytes);
+      float wgt = 1.f;
+      if (weights) {
+        wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+      }
+      const float scale = wgt * _cvtsh_ss(scale_bias[0].x);
+      const float bio = wgt * _cvtsh_ss(scale_bias[1].x);
+      const __m256 vscale = _mm256_set1_ps(scale);
+      const __m256 vbio = _mm256_set1_ps(bio);
+
+      const int64_t next_T0 = (dataInd < index_size - prefdist_T0)
+          ? (dataInd + prefdist_T0)
+          : dataInd;
+      const IndexType idx_pref_T0 = indices[next_T0];
+      CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+      const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+      for (int64_t j = 0; j < fused_block_size; j += 64) {
+        _mm_prefetch(
+            reinterpret_cast<const char*>(&ip_next_T0[j]), _MM_HINT_T0);
+      }
+
+      if (NUM_VECS > 0) {
+        for (int i = 0; i < NUM_VECS; ++i) {
+          vop[i] = _mm256_fmadd_ps(
+              vscale,
+              Unpack8<BIT_RATE>(ip + BIT_RATE * i, vshift, vmask),
+              _mm256_add_ps(vop[i], vbio));
+        }
+        continue;
+      }
+      int64_t j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        _mm256_storeu_ps(
+            &op[j],
+            _mm256_fmadd_ps(
+                vscale,
+                Unpack8<BIT_RATE>(ip + j / kNumElemPerByte, vshift, vmask),
+                _mm256_add_ps(_mm256_loadu_ps(&op[j]), vbio)));
+      }
+      for (; j < block_size; ++j) {
+        const uint8_t quantized = (ip[j / kNumElemPerByte] >>
+                                   ((j % kNumElemPerByte) * BIT_RATE)) &
+            ((1 << BIT_RATE) - 1);
+        op[j] += scale * quantized + bio;
+      }
+    }
+
+    const float len_inv = (normalize_by_lengths && lengths[rangeIndex])
+        ? 1.0f / lengths[rangeIndex]
+        : 1.0f;
+    if (NUM_VECS > 0) {
+      const __m256 vlen_inv = _mm256_set1_ps(len_inv);
+      for (int i = 0; i < NUM_VECS; ++i) {
+        _mm256_storeu_ps(&op[8 * i], _mm256_mul_ps(vop[i], vlen_inv));
+      }
+    } else if (len_inv != 1.0f) {
+      for (int64_t j = 0; j < block_size; ++j) {
+        op[j] *= len_inv;
+      }
+    }
+  }
+}
+
+template <int BIT_RATE, typename IndexType, bool IS_WEIGHT_POSITIONAL>
+void FusedNBitRowwiseEmbeddingLookupAvx2(
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const uint8_t* input,
+    const IndexType* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+#define CAFFE2_FUSED_NBIT_LOOKUP_KERNEL(num_vecs) \
+  FusedNBitRowwiseEmbeddingLookupKernel<          \
+      BIT_RATE,                                   \
+      num_vecs,                                   \
+      IndexType,                                  \
+      IS_WEIGHT_POSITIONAL>(                      \
+      block_size,                                 \
+      output_size,                                \
+      index_size,                                 \
+      data_size,                                  \
+      input,                                      \
+      indices,                                    \
+      lengths,                                    \
+      weights,                                    \
+      normalize_by_lengths,                       \
+      out)
+  if (block_size == 128) {
+    CAFFE2_FUSED_NBIT_LOOKUP_KERNEL(16);
+  } else if (block_size == 64) {
+    CAFFE2_FUSED_NBIT_LOOKUP_KERNEL(8);
+  } else if (block_size == 32) {
+    CAFFE2_FUSED_NBIT_LOOKUP_KERNEL(4);
+  } else if (block_size == 16) {
+    CAFFE2_FUSED_NBIT_LOOKUP_KERNEL(2);
+  } else {
+    CAFFE2_FUSED_NBIT_LOOKUP_KERNEL(0);
+  }
+#undef CAFFE2_FUSED_NBIT_LOOKUP_KERNEL
+}
+
+} // namespace
+
+#define FUSED_NBIT_ROWWISE_EMBEDDING_AVX2_SPECIALIZATION(IndexType, IS_WEIGHT_POSITIONAL)             \
+  void                                                                                                \
+      FusedNBitRowwiseEmbeddingLookup_##IndexType##_uint8_t_float_##IS_WEIGHT_POSITIONAL##__avx2_fma( \
+          const int bit_rate,                                                                         \
+          const int64_t block_size,                                                                   \
+          const int64_t output_size,                                                                  \
+          const int64_t index_size,                                                                   \
+          const int64_t data_size,                                                                    \
+          const uint8_t* input,                                                                       \
+          const IndexType* indices,                                                                   \
+          const int* lengths,                                                                         \
+          const float* weights,                                                                       \
+          bool normalize_by_lengths,                                                                  \
+          float* out) {                                                                               \
+    if (bit_rate == 4) {                                                                              \
+      FusedNBitRowwiseEmbeddingLookupAvx2<4, IndexType, IS_WEIGHT_POSITIONAL>(                        \
+          block_size,                                                                                 \
+          output_size,                                                                                \
+          index_size,                                                                                 \
+          data_size,                                                                                  \
+          input,                                                                                      \
+          indices,                                                                                    \
+          lengths,                                                                                    \
+          weights,                                                                                    \
+          normalize_by_lengths,                                                                       \
+          out);                                                                                       \
+    } else {                                                                                          \
+      FusedNBitRowwiseEmbeddingLookupAvx2<2, IndexType, IS_WEIGHT_POSITIONAL>(                        \
+          block_size,                                                                                 \
+          output_size,                                                                                \
+          index_size,                                                                                 \
+          data_size,                                                                                  \
+          input,                                                                                      \
+          indices,                                                                                    \
+          lengths,                                                                                    \
+          weights,                                                                                    \
+          normalize_by_lengths,                                                                       \
+          out);                                                                                       \
+    }                                                                                                 \
+  }
+
+FUSED_NBIT_ROWWISE_EMBEDDING_AVX2_SPECIALIZATION(int32_t, false);
+FUSED_NBIT_ROWWISE_EMBEDDING_AVX2_SPECIALIZATION(int64_t, false);
+FUSED_NBIT_ROWWISE_EMBEDDING_AVX2_SPECIALIZATION(int32_t, true);
+FUSED_NBIT_ROWWISE_EMBEDDING_AVX2_SPECIALIZATION(int64_t, true);
+
+#undef FUSED_NBIT_ROWWISE_EMBEDDING_AVX2_SPECIALIZATION
+
+} // namespace caffe2
@@ -0,0 +1,187 @@
+#include "caffe2/perfkernels/fused_nbit_rowwise_embedding_lookup.h"
+
+#include <cstring>
+
+#include "caffe2/core/types.h"
+#include "caffe2/perfkernels/common.h"
+#include "caffe2/perfkernels/embedding_lookup.h"
+#include "caffe2/utils/cpuid.h"
+
+namespace caffe2 {
+
+// Base implementation does runtime dispatch for each segment of reduction
+template <
+    typename IndexType,
+    typename InType,
+    typename OutType,
+    bool IS_WEIGHT_POSITIONAL = false>
+static void FusedNBitRowwiseEmbeddingLookupGenericSlow(
+    const int bit_rate,
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const InType* input,
+    const IndexType* indices,
+    const int* lengths,
+    const float* weights, // optional, can be null for sum reducer
+    bool normalize_by_lengths,
+    OutType* out) {
+  // block_size is the number of elements and fused_block_size is the size of
+  // an entire row, including scale and bias.
+  const int num_elem_per_byte = 8 / bit_rate;
+  const int64_t block_bytes = FusedNBitRowwiseBlockBytes(bit_rate, block_size);
+  const int64_t fused_block_size = block_bytes + 2 * sizeof(at::Half);
+  const int64_t prefdist = EmbeddingLookupPrefetchDistance(fused_block_size);
+  const uint8_t mask = (1 << bit_rate) - 1;
+  int64_t current = 0;
+  for (int m = 0; m < output_size; ++m) {
+    memset(out, 0, sizeof(OutType) * block_size);
+    for (int i = 0; i < lengths[m]; ++i) {
+      CAFFE_ENFORCE_LT(current, index_size);
+      int64_t idx = indices[current];
+      CAFFE_ENFORCE(
+          0 <= idx && idx < data_size,
+          "Index ",
+          current,
+          " is out of bounds: ",
+          idx,
+          ", range 0 to ",
+          data_size);
+#ifdef __GNUC__
+      if (current + prefdist < index_size) {
+        __builtin_prefetch(
+            input + fused_block_size * indices[current + prefdist], 0, 1);
+      }
+#endif // __GNUC__
+
+      const InType* row = input + fused_block_size * idx;
+      const at::Half* scale_bias =
+          reinterpret_cast<const at::Half*>(row + block_bytes);
+
+      float weight = 1.0f;
+      if (weights) {
+        weight = weights[IS_WEIGHT_POSITIONAL ? i : current];
+      }
+      const float scale = weight * scale_bias[0];
+      const float bias = weight * scale_bias[1];
+
+      for (int64_t k = 0; k < block_size; ++k) {
+        const uint8_t quantized = (row[k / num_elem_per_byte] >>
+                                   ((k % num_elem_per_byte) * bit_rate)) &
+            mask;
+        out[k] += scale * quantized + bias;
+      }
+
+      ++current;
+    }
+    if (normalize_by_lengths && lengths[m]) {
+      const float len_inv = 1.0f / lengths[m];
+      for (int64_t k = 0; k < block_size; ++k) {
+        out[k] *= len_inv;
+      }
+    }
+    out += block_size;
+  }
+  CAFFE_ENFORCE_EQ(
+      current,
+      index_size,
+      "Your input seems to be incorrect: the sum of lengths values should be "
+      "the size of the indices tensor, but it appears not.");
+}
+
+// Proxy back to generic implementation
+#define FUSED_NBIT_ROWWISE_EMBEDDING_SPECIALIZATION(                                                       \
+    IndexType, InType, OutType, IS_WEIGHT_POSITIONAL)                                                      \
+  void                                                                                                     \
+      FusedNBitRowwiseEmbeddingLookup_##IndexType##_##InType##_##OutType##_##IS_WEIGHT_POSITIONAL##__base( \
+          const int bit_rate,                                                                              \
+          const int64_t block_size,                                                                        \
+          const int64_t output_size,                                                                       \
+          const int64_t index_size,                                                                        \
+          const int64_t data_size,                                                                         \
+          const InType* input,                                                                             \
+          const IndexType* indices,                                                                        \
+          const int* lengths,                                                                              \
+          const float* weights,                                                                            \
+          bool normalize_by_lengths,                                                                       \
+          OutType* out) {                                                                                  \
+    FusedNBitRowwiseEmbeddingLookupGenericSlow<                                                            \
+        IndexType,                                                                                         \
+        InType,                                                                                            \
+        OutType,                                                                                           \
+        IS_WEIGHT_POSITIONAL>(                                                                             \
+        bit_rate,                                                                                          \
+        block_size,                                                                                        \
+        output_size,                                                                                       \
+        index_size,                                                                                        \
+        data_size,                                                                                         \
+        input,                                                                                             \
+        indices,                                                                                           \
+        lengths,                                                                                           \
+        weights,                                                                                           \
+        normalize_by_lengths,                                                                              \
+        out);                                                                                              \
+  }                                                                                                        \
+  template <>                                                                                              \
+  void FusedNBitRowwiseEmbeddingLookup<                                                                    \
+      IndexType,                                                                                           \
+      InType,                                                                                              \
+      OutType,                                                                                             \
+      IS_WEIGHT_POSITIONAL>(                                                                               \
+      const int bit_rate,                                                                                  \
+      const int64_t block_size,                                                                            \
+      const int64_t output_size,                                                                           \
+      const int64_t index_size,                                                                            \
+      const int64_t data_size,                                                                             \
+      const InType* input,                                                                                 \
+      const IndexType* indices,                                                                            \
+      const int* lengths,                                                                                  \
+      const float* weights,                                                                                \
+      bool normalize_by_lengths,                                                                           \
+      OutType* out) {                                                                                      \
+    const int32_t one = 1;                                                                                 \
+    CAFFE_ENFORCE_EQ(                                                                                      \
+        reinterpret_cast<const uint8_t*>(&one)[0],                                                         \
+        1,                                                                                                 \
+        "FusedNBitRowwiseEmbeddingLookup is not supported on this platform");                              \
+    CAFFE_ENFORCE(                                                                                         \
+        bit_rate == 2 || bit_rate == 4,                                                                    \
+        "Unsupported bit rate ",                                                                           \
+        bit_rate);                                                                                         \
+    AVX2_FMA_DO(                                                                                           \
+        FusedNBitRowwiseEmbeddingLookup_##IndexType##_##InType##_##OutType##_##IS_WEIGHT_POSITIONAL,       \
+        bit_rate,                                                                                          \
+        block_size,                                                                                        \
+        output_size,                                                                                       \
+        index_size,                                                                                        \
+        data_size,                                                                                         \
+        input,                                                                                             \
+        indices,                                                                                           \
+        lengths,                                                                                           \
+        weights,                                                                                           \
+        normalize_by_lengths,                                                                              \
+        out);                                                                                              \
+    BASE_DO(                                                                                               \
+        FusedNBitRowwiseEmbeddingLookup_##IndexType##_##InType##_##OutType##_##IS_WEIGHT_POSITIONAL,       \
+        bit_rate,                                                                                          \
+        block_size,                                                                                        \
+        output_size,                                                                                       \
+        index_size,                                                                                        \
+        data_size,                                                                                         \
+        input,                                                                                             \
+        indices,                                                                                           \
+        lengths,                                                                                           \
+        weights,                                                                                           \
+        normalize_by_lengths,                                                                              \
+        out);                                                                                              \
+  }
+
+FUSED_NBIT_ROWWISE_EMBEDDING_SPECIALIZATION(int32_t, uint8_t, float, false);
+FUSED_NBIT_ROWWISE_EMBEDDING_SPECIALIZATION(int64_t, uint8_t, float, false);
+FUSED_NBIT_ROWWISE_EMBEDDING_SPECIALIZATION(int32_t, uint8_t, float, true);
+FUSED_NBIT_ROWWISE_EMBEDDING_SPECIALIZATION(int64_t, uint8_t, float, true);
+
+#undef FUSED_NBIT_ROWWISE_EMBEDDING_SPECIALIZATION
+
+} // namespace caffe2
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "caffe2/core/common.h"
+
+namespace caffe2 {
+
+/**
+ * Embedding lookup with reduction over N-bit rowwise quantized data with
+ * fused storage, for N (bit_rate) of 2 or 4.
+ *
+ * `input` of size data_size * fused_block_size, where every row holds
+ *     the quantized values, block_size * bit_rate bits rounded up to whole
+ *     bytes, followed by the scale and the bias as 2-byte half floats.
+ *     Value k of a row is in the bits k * bit_rate to (k + 1) * bit_rate - 1,
+ *     starting from the lowest bit of the first byte.
+ * `indices` of size index_size
+ * `lengths` of size output_size
+ * `weights` nullptr or array of size index_size
+ * `out` of size output_size * block_size
+ * sum(lengths[i]) == index_size
+ *
+ * Behavior is roughly equivalent to pseudocode:
+ *
+ * pos = 0
+ * for (i = 0..index_size-1)
+ *   for (k = 0..block_size-1)
+ *     out[i*block_size + k] = 0
+ *   for (j = 0..lengths[i]-1)
+ *     row = indices[pos]
+ *     w = weights ? weights[IS_WEIGHT_POSITIONAL ? j : pos] : 1.0
+ *     for (k = 0..block_size-1)
+ *       out[i*block_size + k] +=
+ *           w * (value(row, k) * scale(row) + bias(row))
+ *     pos += 1
+ *   if (normalize_weights && lengths[i] > 0)
+ *     for (k = 0..block_size-1)
+ *       out[i*block_size + k] /= lengths[i]
+ *
+ */
+template <
+    typename IndexType,
+    typename InType,
+    typename OutType,
+    bool IS_WEIGHT_POSITIONAL = false>
+void FusedNBitRowwiseEmbeddingLookup(
+    const int bit_rate,
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const InType* input,
+    const IndexType* indices,
+    const int* lengths,
+    const float* weights, // optional, can be null for non-weighted sum
+    bool normalize_by_lengths,
+    OutType* out);
+
+// Bytes of a row of block_size N-bit values, excluding the scale and bias
+inline int64_t FusedNBitRowwiseBlockBytes(int bit_rate, int64_t block_size) {
+  const int64_t num_elem_per_byte = 8 / bit_rate;
+  return (block_size + num_elem_per_byte - 1) / num_elem_per_byte;
+}
+
+} // namespace caffe2
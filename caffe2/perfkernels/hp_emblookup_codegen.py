@@ -281,8 +281,8 @@ options = [["int32_t", "int32_t", "float", "float", "float", "float"],
            ["int64_t", "int64_t", "float", "float", "float", "float"],
            ["int32_t", "int32_t", "half", "at::Half", "float", "float"],
            ["int64_t", "int64_t", "half", "at::Half", "float", "float"],
-           ["int32_t", "int32_t", "uint8_t", "uint8_t", "float"],
-           ["int64_t", "int64_t", "uint8_t", "uint8_t", "float"]]
+           ["int32_t", "int32_t", "uint8_t", "uint8_t", "float", "float"],
+           ["int64_t", "int64_t", "uint8_t", "uint8_t", "float", "float"]]
 
 code = []
 # includes
@@ -295,6 +295,7 @@ code.append("//// --------------------------\n\n")
 
 code.append("#include <caffe2/core/types.h>")
 code.append("#include <caffe2/core/common.h>")
+code.append("#include <caffe2/perfkernels/embedding_lookup.h>")
 code.append("#include <immintrin.h>")
 code.append("\n")
 
@@ -327,7 +328,6 @@ for o in options:
     code += args
 
     code.append("{")
-    code.append("const " + IndexType + " prefdist_T0 = 16;")
     # block_size is the number of elements and fused_block_size is the size of
     # an entire row, including scale and bias.
     offset = (8 // sizeof[InType]) if opts.fused else 0
@@ -335,6 +335,10 @@ for o in options:
         "const {} fused_block_size = block_size + {};".
         format(IndexType, offset)
     )
+    code.append(
+        "const {} prefdist_T0 = EmbeddingLookupPrefetchDistance("
+        "fused_block_size * sizeof({}));".format(IndexType, InType)
+    )
 
     #code.append("printf(\"calling " + fn + "\\n\");");
     if not opts.fused:
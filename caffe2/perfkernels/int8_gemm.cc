@@ -0,0 +1,79 @@
+#include "caffe2/perfkernels/int8_gemm.h"
+
+#include <cstring>
+
+#include "caffe2/perfkernels/common.h"
+#include "caffe2/utils/cpuid.h"
+
+namespace caffe2 {
+
+namespace {
+inline int PaddedK(int K) {
+  return (K + 1) / 2 * 2;
+}
+
+inline int NumPanels(int N) {
+  return (N + kInt8GemmPanelCols - 1) / kInt8GemmPanelCols;
+}
+} // namespace
+
+int64_t Int8GemmPackedSize(int N, int K) {
+  return static_cast<int64_t>(NumPanels(N)) * kInt8GemmPanelCols * PaddedK(K);
+}
+
+void Int8GemmPackB(int N, int K, const int8_t* B, int8_t* packed_B) {
+  const int padded_K = PaddedK(K);
+  memset(packed_B, 0, Int8GemmPackedSize(N, K));
+  for (int n = 0; n < N; ++n) {
+    int8_t* panel = packed_B +
+        static_cast<int64_t>(n / kInt8GemmPanelCols) * kInt8GemmPanelCols *
+            padded_K;
+    const int col = n % kInt8GemmPanelCols;
+    for (int k = 0; k < K; ++k) {
+      panel[(k / 2) * 2 * kInt8GemmPanelCols + col * 2 + k % 2] =
+          B[static_cast<int64_t>(n) * K + k];
+    }
+  }
+}
+
+void Int8GemmPacked__base(
+    int M,
+    int N,
+    int K,
+    const uint8_t* A,
+    int lda,
+    const int8_t* packed_B,
+    int32_t* C,
+    int ldc) {
+  const int padded_K = PaddedK(K);
+  for (int m = 0; m < M; ++m) {
+    const uint8_t* a = A + static_cast<int64_t>(m) * lda;
+    for (int n = 0; n < N; ++n) {
+      const int8_t* panel = packed_B +
+          static_cast<int64_t>(n / kInt8GemmPanelCols) * kInt8GemmPanelCols *
+              padded_K;
+      const int col = n % kInt8GemmPanelCols;
+      int32_t sum = 0;
+      for (int k = 0; k < K; ++k) {
+        sum += static_cast<int32_t>(a[k]) *
+            panel[(k / 2) * 2 * kInt8GemmPanelCols + col * 2 + k % 2];
+      }
+      C[static_cast<int64_t>(m) * ldc + n] = sum;
+    }
+  }
+}
+
+void Int8GemmPacked(
+    int M,
+    int N,
+    int K,
+    const uint8_t* A,
+    int lda,
+    const int8_t* packed_B,
+    int32_t* C,
+    int ldc) {
+  AVX2_FMA_DO(Int8GemmPacked, M, N, K, A, lda, packed_B, C, ldc);
+  BASE_DO(Int8GemmPacked, M, N, K, A, lda, packed_B, C, ldc);
+}
+
+} // namespace caffe2
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+namespace caffe2 {
+
+// Number of columns of B in a panel of the packed layout
+constexpr int kInt8GemmPanelCols = 8;
+
+// Size in bytes of B of N x K packed by Int8GemmPackB. Panels of
+// kInt8GemmPanelCols columns store the pairs of consecutive values along K of
+// every column next to each other, with N rounded up to a whole panel and K
+// rounded up to even, padded with zeros.
+int64_t Int8GemmPackedSize(int N, int K);
+
+// Packs the row-major N x K int8 matrix B (one row per output column) for
+// Int8GemmPacked.
+void Int8GemmPackB(int N, int K, const int8_t* B, int8_t* packed_B);
+
+// C = A * B^T with int32 accumulation, where A is a row-major M x K uint8
+// matrix with leading dimension lda, and B is N x K, packed by Int8GemmPackB.
+// C is row-major M x N with leading dimension ldc. The products are exact
+// (no saturation) for any K below 2^16.
+void Int8GemmPacked(
+    int M,
+    int N,
+    int K,
+    const uint8_t* A,
+    int lda,
+    const int8_t* packed_B,
+    int32_t* C,
+    int ldc);
+
+} // namespace caffe2
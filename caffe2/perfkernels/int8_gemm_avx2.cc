@@ -0,0 +1,107 @@
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "caffe2/perfkernels/int8_gemm.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Pair of consecutive values of A along K, as two int16 in an int32
+inline __m256i BroadcastPair(const uint8_t* a, bool second) {
+  const int32_t pair = a[0] | (second ? static_cast<int32_t>(a[1]) << 16 : 0);
+  return _mm256_set1_epi32(pair);
+}
+
+// Computes MR rows and one panel of 8 columns of C. Every step widens 16
+// values of B (8 columns x 2 values along K) to int16, and multiplies them
+// with a pair of values of A, adding adjacent products with vpmaddwd. The
+// products of uint8 and int8 values fit in int16 pairs, so unlike vpmaddubsw
+// nothing saturates.
+template <int MR>
+void Int8GemmPanel(
+    int K,
+    const uint8_t* A,
+    int lda,
+    const int8_t* panel,
+    int32_t* C,
+    int ldc,
+    int cols) {
+  __m256i acc[MR];
+  for (int r = 0; r < MR; ++r) {
+    acc[r] = _mm256_setzero_si256();
+  }
+  int k = 0;
+  for (; k + 2 <= K; k += 2) {
+    const __m256i b = _mm256_cvtepi8_epi16(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(panel + k * kInt8GemmPanelCols)));
+    for (int r = 0; r < MR; ++r) {
+      acc[r] = _mm256_add_epi32(
+          acc[r],
+          _mm256_madd_epi16(BroadcastPair(A + r * lda + k, true), b));
+    }
+  }
+  if (k < K) {
+    // The last value of B along K is paired with zero padding
+    const __m256i b = _mm256_cvtepi8_epi16(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(panel + k * kInt8GemmPanelCols)));
+    for (int r = 0; r < MR; ++r) {
+      acc[r] = _mm256_add_epi32(
+          acc[r],
+          _mm256_madd_epi16(BroadcastPair(A + r * lda + k, false), b));
+    }
+  }
+  for (int r = 0; r < MR; ++r) {
+    if (cols == kInt8GemmPanelCols) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(C + r * ldc), acc[r]);
+    } else {
+      int32_t tmp[kInt8GemmPanelCols];
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(tmp), acc[r]);
+      memcpy(C + r * ldc, tmp, cols * sizeof(int32_t));
+    }
+  }
+}
+
+} // namespace
+
+void Int8GemmPacked__avx2_fma(
+    int M,
+    int N,
+    int K,
+    const uint8_t* A,
+    int lda,
+    const int8_t* packed_B,
+    int32_t* C,
+    int ldc) {
+  constexpr int kMR = 4;
+  const int padded_K = (K + 1) / 2 * 2;
+  for (int n = 0; n < N; n += kInt8GemmPanelCols) {
+    const int8_t* panel = packed_B + static_cast<int64_t>(n) * padded_K;
+    const int cols = std::min(kInt8GemmPanelCols, N - n);
+    int m = 0;
+    for (; m + kMR <= M; m += kMR) {
+      Int8GemmPanel<kMR>(
+          K,
+          A + static_cast<int64_t>(m) * lda,
+          lda,
+          panel,
+          C + static_cast<int64_t>(m) * ldc + n,
+          ldc,
+          cols);
+    }
+    for (; m < M; ++m) {
+      Int8GemmPanel<1>(
+          K,
+          A + static_cast<int64_t>(m) * lda,
+          lda,
+          panel,
+          C + static_cast<int64_t>(m) * ldc + n,
+          ldc,
+          cols);
+    }
+  }
+}
+
+} // namespace caffe2
@@ -0,0 +1,275 @@
+#include "caffe2/predictor/batching_predictor.h"
+
+namespace caffe2 {
+
+namespace {
+
+int64_t elapsedNanos(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - since)
+      .count();
+}
+
+// Concatenates tensors of the same type and trailing dimensions along their
+// first dimension
+void concatRows(
+    const std::vector<const TensorCPU*>& parts,
+    CPUContext* context,
+    TensorCPU* output) {
+  std::vector<int64_t> dims(
+      parts.front()->dims().begin(), parts.front()->dims().end());
+  dims[0] = 0;
+  for (const auto* part : parts) {
+    dims[0] += part->dim(0);
+  }
+  output->Resize(dims);
+  const auto& meta = parts.front()->meta();
+  auto* dst = static_cast<char*>(output->raw_mutable_data(meta));
+  for (const auto* part : parts) {
+    context->CopyItems<CPUContext, CPUContext>(
+        meta, part->size(), part->raw_data(), dst);
+    dst += part->nbytes();
+  }
+}
+
+// Copies `rows` rows of `input` starting at `offset`
+void sliceRows(
+    const TensorCPU& input,
+    int64_t offset,
+    int64_t rows,
+    CPUContext* context,
+    TensorCPU* output) {
+  std::vector<int64_t> dims(input.dims().begin(), input.dims().end());
+  dims[0] = rows;
+  output->Resize(dims);
+  const auto& meta = input.meta();
+  const auto row_items = input.size_from_dim(1);
+  context->CopyItems<CPUContext, CPUContext>(
+      meta,
+      rows * row_items,
+      static_cast<const char*>(input.raw_data()) +
+          offset * row_items * meta.itemsize(),
+      output->raw_mutable_data(meta));
+}
+
+} // namespace
+
+BatchingPredictor::BatchingPredictor(
+    std::unique_ptr<Predictor> predictor,
+    BatchingPredictorOptions options)
+    : predictor_(std::move(predictor)),
+      options_(std::move(options)),
+      stats_(options_.name) {
+  CAFFE_ENFORCE(predictor_, "Predictor must be specified");
+  CAFFE_ENFORCE_GT(options_.max_batch_size, 0);
+  thread_ = std::thread([this] { batchingThread(); });
+}
+
+BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+bool BatchingPredictor::operator()(
+    const TensorList& inputs,
+    TensorList* outputs) {
+  const auto& def = predictor_->def();
+  CAFFE_ENFORCE(
+      inputs.size() <= static_cast<unsigned>(def.external_input_size()));
+  TensorMap named_inputs;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    named_inputs.emplace(def.external_input(i), inputs[i]);
+  }
+  return run(std::move(named_inputs), outputs);
+}
+
+bool BatchingPredictor::operator()(
+    const TensorMap& inputs,
+    TensorList* outputs) {
+  return run(inputs, outputs);
+}
+
+bool BatchingPredictor::operator()(
+    const TensorMap& inputs,
+    TensorMap* outputs) {
+  TensorList output_list;
+  if (!run(inputs, &output_list)) {
+    return false;
+  }
+  const auto& def = predictor_->def();
+  for (size_t i = 0; i < output_list.size(); ++i) {
+    outputs->emplace(def.external_output(i), std::move(output_list[i]));
+  }
+  return true;
+}
+
+bool BatchingPredictor::run(TensorMap inputs, TensorList* outputs) {
+  const auto start = std::chrono::steady_clock::now();
+  CAFFE_ENFORCE(!inputs.empty(), "Requests must have inputs");
+  auto request = std::make_shared<Request>();
+  request->batch_size = -1;
+  for (const auto& input : inputs) {
+    CAFFE_ENFORCE_GT(
+        input.second.ndim(), 0, "Input has no batch dimension: ", input.first);
+    if (request->batch_size < 0) {
+      request->batch_size = input.second.dim(0);
+    }
+    CAFFE_ENFORCE_EQ(
+        input.second.dim(0),
+        request->batch_size,
+        "Inputs of a request must have the same first dimension");
+  }
+  request->inputs = std::move(inputs);
+  auto done = request->done.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CAFFE_ENFORCE(!stop_, "BatchingPredictor is stopping");
+    request->enqueued = std::chrono::steady_clock::now();
+    queued_batch_size_ += request->batch_size;
+    queue_.push_back(request);
+  }
+  cv_.notify_all();
+
+  bool success = done.get();
+  *outputs = std::move(request->outputs);
+  CAFFE_EVENT(stats_, num_requests);
+  CAFFE_EVENT(stats_, request_time_ns, elapsedNanos(start));
+  return success;
+}
+
+bool BatchingPredictor::canBatch(const Request& first, const Request& request)
+    const {
+  if (request.inputs.size() != first.inputs.size()) {
+    return false;
+  }
+  for (const auto& input : first.inputs) {
+    auto it = request.inputs.find(input.first);
+    if (it == request.inputs.end()) {
+      return false;
+    }
+    const auto& tensor = it->second;
+    if (tensor.meta() != input.second.meta() ||
+        tensor.ndim() != input.second.ndim()) {
+      return false;
+    }
+    for (int d = 1; d < tensor.ndim(); ++d) {
+      if (tensor.dim(d) != input.second.dim(d)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void BatchingPredictor::batchingThread() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    // Waits for more requests, unless the batch is already full
+    const auto deadline = queue_.front()->enqueued + options_.timeout;
+    cv_.wait_until(lock, deadline, [this] {
+      return stop_ || queued_batch_size_ >= options_.max_batch_size;
+    });
+
+    std::vector<std::shared_ptr<Request>> batch;
+    int64_t batch_size = 0;
+    batch.push_back(queue_.front());
+    batch_size += queue_.front()->batch_size;
+    queue_.pop_front();
+    for (auto it = queue_.begin(); it != queue_.end();) {
+      if (batch_size + (*it)->batch_size > options_.max_batch_size) {
+        break;
+      }
+      if (!canBatch(*batch.front(), **it)) {
+        ++it;
+        continue;
+      }
+      batch_size += (*it)->batch_size;
+      batch.push_back(*it);
+      it = queue_.erase(it);
+    }
+    queued_batch_size_ -= batch_size;
+    lock.unlock();
+
+    runBatch(batch);
+
+    lock.lock();
+  }
+}
+
+void BatchingPredictor::runBatch(
+    const std::vector<std::shared_ptr<Request>>& batch) {
+  const auto start = std::chrono::steady_clock::now();
+  int64_t batch_size = 0;
+  for (const auto& request : batch) {
+    CAFFE_EVENT(
+        stats_,
+        queue_time_ns,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            start - request->enqueued)
+            .count());
+    batch_size += request->batch_size;
+  }
+
+  try {
+    bool success;
+    if (batch.size() == 1) {
+      success = (*predictor_)(batch.front()->inputs, &batch.front()->outputs);
+    } else {
+      TensorMap inputs;
+      for (const auto& input : batch.front()->inputs) {
+        std::vector<const TensorCPU*> parts;
+        for (const auto& request : batch) {
+          parts.push_back(&request->inputs.at(input.first));
+        }
+        auto iter = inputs.emplace(input.first, TensorCPU(CPU));
+        concatRows(parts, &context_, &iter.first->second);
+      }
+
+      TensorList outputs;
+      success = (*predictor_)(inputs, &outputs);
+      if (success) {
+        for (const auto& output : outputs) {
+          CAFFE_ENFORCE(
+              output.ndim() > 0 && output.dim(0) == batch_size,
+              "Outputs must have one row per example to be split into "
+              "requests");
+        }
+        int64_t offset = 0;
+        for (const auto& request : batch) {
+          for (const auto& output : outputs) {
+            request->outputs.emplace_back(CPU);
+            sliceRows(
+                output,
+                offset,
+                request->batch_size,
+                &context_,
+                &request->outputs.back());
+          }
+          offset += request->batch_size;
+        }
+      }
+    }
+    CAFFE_EVENT(stats_, num_batches);
+    CAFFE_EVENT(stats_, batch_size, batch_size);
+    CAFFE_EVENT(stats_, run_time_ns, elapsedNanos(start));
+    for (const auto& request : batch) {
+      request->done.set_value(success);
+    }
+  } catch (...) {
+    for (const auto& request : batch) {
+      request->outputs.clear();
+      request->done.set_exception(std::current_exception());
+    }
+  }
+}
+
+} // namespace caffe2
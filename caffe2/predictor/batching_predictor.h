@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/stats.h"
+#include "caffe2/predictor/predictor.h"
+
+namespace caffe2 {
+
+struct CAFFE2_API BatchingPredictorOptions {
+  // The maximum number of examples, summed over the first dimension of the
+  // inputs of the requests, run in a single batch
+  int64_t max_batch_size = 32;
+  // How long the first request of a batch waits for more requests
+  std::chrono::microseconds timeout{1000};
+  // The name of the group of exported stats
+  std::string name = "batching_predictor";
+};
+
+// Batches concurrent requests to a Predictor.
+//
+// Requests from any thread are queued, and a single thread runs them in
+// batches: it waits for up to `timeout` after the first request of a batch,
+// or until `max_batch_size` examples are queued, concatenates the inputs of
+// the requests along their first dimension, runs the net once, and splits
+// every output along its first dimension back into the requests. Requests
+// whose inputs have different types or trailing dimensions go into different
+// batches.
+//
+// Every output of the net must have one row per example. The number of
+// requests and batches, the batch sizes, and the time requests spend queued,
+// running and in total are exported as stats under `name`.
+class CAFFE2_API BatchingPredictor {
+ public:
+  using TensorList = Predictor::TensorList;
+  using TensorMap = Predictor::TensorMap;
+
+  explicit BatchingPredictor(
+      std::unique_ptr<Predictor> predictor,
+      BatchingPredictorOptions options = BatchingPredictorOptions());
+
+  // Runs the queued requests, then stops batching
+  ~BatchingPredictor();
+
+  // Same as the Predictor functions, and safe to call concurrently. Blocks
+  // until the batch of the request has run. Outputs are always keyed by the
+  // external outputs of the net.
+  bool operator()(const TensorList& inputs, TensorList* outputs);
+  bool operator()(const TensorMap& inputs, TensorList* outputs);
+  bool operator()(const TensorMap& inputs, TensorMap* outputs);
+
+  const Predictor& predictor() const {
+    return *predictor_;
+  }
+
+  const BatchingPredictorOptions& options() const {
+    return options_;
+  }
+
+ private:
+  struct Request {
+    TensorMap inputs;
+    int64_t batch_size;
+    std::chrono::steady_clock::time_point enqueued;
+    TensorList outputs;
+    std::promise<bool> done;
+  };
+
+  bool run(TensorMap inputs, TensorList* outputs);
+  void batchingThread();
+  void runBatch(const std::vector<std::shared_ptr<Request>>& batch);
+  bool canBatch(const Request& first, const Request& request) const;
+
+  std::unique_ptr<Predictor> predictor_;
+  BatchingPredictorOptions options_;
+  CPUContext context_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::shared_ptr<Request>> queue_;
+  int64_t queued_batch_size_{0};
+  bool stop_{false};
+  std::thread thread_;
+
+  struct BatchingStats {
+    CAFFE_STAT_CTOR(BatchingStats);
+    CAFFE_EXPORTED_STAT(num_requests);
+    CAFFE_EXPORTED_STAT(num_batches);
+    CAFFE_AVG_EXPORTED_STAT(batch_size);
+    CAFFE_AVG_EXPORTED_STAT(queue_time_ns);
+    CAFFE_AVG_EXPORTED_STAT(run_time_ns);
+    CAFFE_AVG_EXPORTED_STAT(request_time_ns);
+  } stats_;
+};
+
+} // namespace caffe2
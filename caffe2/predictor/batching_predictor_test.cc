@@ -0,0 +1,195 @@
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/stats.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/predictor/batching_predictor.h"
+#include "caffe2/utils/math.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace caffe2 {
+
+namespace {
+
+const char* predictSpec = R"DOC(
+        name: "predict"
+        type: "simple"
+        external_input: "data"
+        external_input: "W"
+        external_input: "b"
+        external_output: "y"
+        op {
+          input: "data"
+          input: "W"
+          input: "b"
+          output: "y"
+          type: "FC"
+        }
+)DOC";
+
+const char* initSpec = R"DOC(
+        name: "init"
+        type: "simple"
+        op {
+          type: "UniformFill"
+          output: "W"
+          arg {
+            name: "shape"
+            ints: 10
+            ints: 4
+          }
+        }
+        op {
+          type: "UniformFill"
+          output: "b"
+          arg {
+            name: "shape"
+            ints: 10
+          }
+        }
+)DOC";
+
+NetDef parseNetDef(const std::string& value) {
+  NetDef def;
+  CAFFE_ENFORCE(
+      TextFormat::ParseFromString(value, &def),
+      "Failed to parse NetDef with value: ",
+      value);
+  return def;
+}
+
+TensorCPU randomTensor(const std::vector<int64_t>& dims, CPUContext* ctx) {
+  TensorCPU t(CPU);
+  t.Resize(dims);
+  math::RandUniform<float, CPUContext>(
+      t.size(), -1.0, 1.0, t.template mutable_data<float>(), ctx);
+  return t;
+}
+
+int64_t statValue(const std::string& name) {
+  ExportedStatList stats;
+  StatRegistry::get().publish(stats);
+  for (const auto& stat : stats) {
+    if (stat.key == name) {
+      return stat.value;
+    }
+  }
+  return 0;
+}
+
+} // namespace
+
+class BatchingPredictorTest : public testing::Test {
+ public:
+  void SetUp() override {
+    DeviceOption op;
+    op.set_random_seed(1701);
+    ctx_ = caffe2::make_unique<CPUContext>(op);
+    ws_ = caffe2::make_unique<Workspace>();
+    CAFFE_ENFORCE(ws_->RunNetOnce(parseNetDef(initSpec)));
+  }
+
+  std::unique_ptr<Predictor> makePredictor() {
+    return caffe2::make_unique<Predictor>(makePredictorConfig(
+        NetDef(), parseNetDef(predictSpec), ws_.get(), /*run_init=*/false));
+  }
+
+  std::unique_ptr<CPUContext> ctx_;
+  std::unique_ptr<Workspace> ws_;
+};
+
+TEST_F(BatchingPredictorTest, MatchesUnbatchedRequests) {
+  const int kThreads = 8;
+  const int kRequests = 5;
+  auto predictor = makePredictor();
+  std::vector<TensorCPU> inputs;
+  std::vector<std::vector<float>> expected;
+  for (int i = 0; i < kThreads * kRequests; ++i) {
+    inputs.push_back(randomTensor({i % 2 + 1, 4}, ctx_.get()));
+    Predictor::TensorList input{inputs.back()};
+    Predictor::TensorList output;
+    ASSERT_TRUE((*predictor)(input, &output));
+    const auto* data = output.front().data<float>();
+    expected.emplace_back(data, data + output.front().size());
+  }
+
+  BatchingPredictorOptions options;
+  options.max_batch_size = 2 * kThreads;
+  options.timeout = std::chrono::milliseconds(50);
+  options.name = "batching_predictor_test";
+  BatchingPredictor batching(makePredictor(), options);
+
+  std::vector<std::thread> threads;
+  std::vector<std::vector<std::vector<float>>> results(kThreads);
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int r = 0; r < kRequests; ++r) {
+        BatchingPredictor::TensorList input{inputs[t * kRequests + r]};
+        BatchingPredictor::TensorList output;
+        CAFFE_ENFORCE(batching(input, &output));
+        CAFFE_ENFORCE_EQ(output.size(), 1);
+        const auto* data = output.front().data<float>();
+        results[t].emplace_back(data, data + output.front().size());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int t = 0; t < kThreads; ++t) {
+    for (int r = 0; r < kRequests; ++r) {
+      const auto& result = results[t][r];
+      const auto& want = expected[t * kRequests + r];
+      ASSERT_EQ(want.size(), result.size());
+      for (size_t i = 0; i < want.size(); ++i) {
+        EXPECT_NEAR(want[i], result[i], 1E-4);
+      }
+    }
+  }
+
+  EXPECT_EQ(
+      kThreads * kRequests,
+      statValue("batching_predictor_test/num_requests"));
+  // Concurrent requests run together
+  EXPECT_LT(
+      statValue("batching_predictor_test/num_batches"),
+      kThreads * kRequests);
+}
+
+TEST_F(BatchingPredictorTest, MapInputsAndOutputs) {
+  BatchingPredictor batching(makePredictor());
+  BatchingPredictor::TensorMap input;
+  input.emplace("data", randomTensor({3, 4}, ctx_.get()));
+  BatchingPredictor::TensorMap output;
+  ASSERT_TRUE(batching(input, &output));
+  ASSERT_EQ(1, output.count("y"));
+  EXPECT_EQ(3, output.at("y").dim(0));
+  EXPECT_EQ(10, output.at("y").dim(1));
+}
+
+TEST_F(BatchingPredictorTest, ErrorsReachRequests) {
+  BatchingPredictor batching(makePredictor());
+  BatchingPredictor::TensorList output;
+  // FC expects 4 features
+  BatchingPredictor::TensorList invalid{randomTensor({2, 5}, ctx_.get())};
+  EXPECT_THROW(batching(invalid, &output), EnforceNotMet);
+  // Requests still run afterwards
+  BatchingPredictor::TensorList valid{randomTensor({2, 4}, ctx_.get())};
+  EXPECT_TRUE(batching(valid, &output));
+  EXPECT_EQ(2, output.front().dim(0));
+}
+
+TEST_F(BatchingPredictorTest, RejectsInputsWithoutBatchDimension) {
+  BatchingPredictor batching(makePredictor());
+  BatchingPredictor::TensorList output;
+  BatchingPredictor::TensorList input;
+  input.emplace_back(CPU);
+  input.back().Resize(std::vector<int64_t>{});
+  input.back().mutable_data<float>();
+  EXPECT_THROW(batching(input, &output), EnforceNotMet);
+}
+
+} // namespace caffe2
@@ -1,6 +1,9 @@
 #include "caffe2/predictor/predictor.h"
+#include <set>
 #include <unordered_set>
 #include "caffe2/core/init.h"
+#include "caffe2/core/memonger.h"
+#include "caffe2/core/scope_guard.h"
 
 namespace caffe2 {
 
@@ -134,4 +137,200 @@ bool Predictor::operator()(const TensorMap& inputs, TensorMap* outputs) {
   return true;
 }
 
+ConcurrentPredictor::ConcurrentPredictor(
+    PredictorConfig config,
+    size_t max_instances,
+    bool optimize_memory)
+    : config_(std::move(config)),
+      predict_net_(std::make_shared<NetDef>(*config_.predict_net)),
+      max_instances_(max_instances) {
+  if (optimize_memory) {
+    std::set<std::string> static_blobs;
+    for (const auto& name : predict_net_->external_input()) {
+      static_blobs.insert(name);
+    }
+    for (const auto& name : predict_net_->external_output()) {
+      static_blobs.insert(name);
+    }
+    for (const auto& name : output_names()) {
+      static_blobs.insert(name);
+    }
+    *predict_net_ =
+        memonger::optimize_inference_net(*predict_net_, static_blobs);
+  }
+
+  // Inputs are the given input names, or otherwise the external inputs that
+  // were not initialized as parameters. Outputs of ops must not be written
+  // to the shared workspace either.
+  if (!input_names().empty()) {
+    local_blobs_.insert(input_names().begin(), input_names().end());
+  } else {
+    for (const auto& name : predict_net_->external_input()) {
+      if (!config_.ws->HasBlob(name)) {
+        local_blobs_.insert(name);
+      }
+    }
+  }
+  for (const auto& op : predict_net_->op()) {
+    local_blobs_.insert(op.output().begin(), op.output().end());
+  }
+
+  // Fails early if the net can't be created
+  release(acquire());
+}
+
+size_t ConcurrentPredictor::num_instances() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_instances_;
+}
+
+std::unique_ptr<ConcurrentPredictor::Instance> ConcurrentPredictor::acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  released_.wait(lock, [this] {
+    return !free_instances_.empty() || max_instances_ == 0 ||
+        num_instances_ < max_instances_;
+  });
+  if (!free_instances_.empty()) {
+    auto instance = std::move(free_instances_.back());
+    free_instances_.pop_back();
+    return instance;
+  }
+  ++num_instances_;
+  lock.unlock();
+
+  try {
+    std::unique_ptr<Instance> instance(new Instance());
+    instance->ws = caffe2::make_unique<Workspace>(config_.ws.get());
+    for (const auto& name : local_blobs_) {
+      BlobGetMutableTensor(instance->ws->CreateLocalBlob(name), CPU);
+    }
+    instance->net = instance->ws->CreateNet(predict_net_);
+    CAFFE_ENFORCE(instance->net, "Failed to create net: ", predict_net_->name());
+    return instance;
+  } catch (...) {
+    lock.lock();
+    --num_instances_;
+    lock.unlock();
+    released_.notify_one();
+    throw;
+  }
+}
+
+void ConcurrentPredictor::release(std::unique_ptr<Instance> instance) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_instances_.push_back(std::move(instance));
+  }
+  released_.notify_one();
+}
+
+bool ConcurrentPredictor::run(
+    Instance* instance,
+    const std::vector<std::pair<std::string, const TensorCPU*>>& inputs) {
+  auto* ws = instance->ws.get();
+  for (const auto& input : inputs) {
+    CAFFE_ENFORCE(
+        local_blobs_.count(input.first),
+        "Input is a parameter of the model: ",
+        input.first);
+    shareInputTensor(ws, input.first, *input.second);
+  }
+  // The inputs of the caller are not kept alive by the instance
+  auto guard = MakeGuard([&] {
+    for (const auto& input : inputs) {
+      getTensor(ws, input.first)->FreeMemory();
+    }
+  });
+  return instance->net->Run();
+}
+
+void ConcurrentPredictor::exportOutput(
+    Instance* instance,
+    const std::string& name,
+    TensorCPU* output) {
+  exportOutputTensor(instance->ws.get(), name, *output);
+  // Later requests write to new memory, unless the output is a parameter
+  if (local_blobs_.count(name)) {
+    getTensor(instance->ws.get(), name)->FreeMemory();
+  }
+}
+
+bool ConcurrentPredictor::operator()(
+    const TensorList& inputs,
+    TensorList* outputs) {
+  CAFFE_ENFORCE(
+      inputs.size() <=
+      static_cast<unsigned>(predict_net_->external_input_size()));
+  std::vector<std::pair<std::string, const TensorCPU*>> named_inputs;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    named_inputs.emplace_back(predict_net_->external_input(i), &inputs[i]);
+  }
+
+  auto instance = acquire();
+  auto guard = MakeGuard([&] { release(std::move(instance)); });
+  if (!run(instance.get(), named_inputs)) {
+    return false;
+  }
+  outputs->clear();
+  for (size_t i = 0; i < predict_net_->external_output_size(); ++i) {
+    const auto& name = predict_net_->external_output(i);
+    outputs->emplace_back(CPU);
+    exportOutput(instance.get(), name, &outputs->back());
+  }
+  return true;
+}
+
+std::vector<std::pair<std::string, const TensorCPU*>>
+ConcurrentPredictor::namedInputs(const TensorMap& inputs) const {
+  if (!input_names().empty()) {
+    CAFFE_ENFORCE_EQ(inputs.size(), input_names().size());
+  }
+  std::vector<std::pair<std::string, const TensorCPU*>> named_inputs;
+  for (const auto& input : inputs) {
+    if (!input_names().empty()) {
+      CAFFE_ENFORCE(
+          std::find(input_names().begin(), input_names().end(), input.first) !=
+              input_names().end(),
+          "Input can't be found: ",
+          input.first);
+    }
+    named_inputs.emplace_back(input.first, &input.second);
+  }
+  return named_inputs;
+}
+
+bool ConcurrentPredictor::operator()(
+    const TensorMap& inputs,
+    TensorList* outputs) {
+  auto named_inputs = namedInputs(inputs);
+  auto instance = acquire();
+  auto guard = MakeGuard([&] { release(std::move(instance)); });
+  if (!run(instance.get(), named_inputs)) {
+    return false;
+  }
+  outputs->clear();
+  for (size_t i = 0; i < predict_net_->external_output_size(); ++i) {
+    const auto& name = predict_net_->external_output(i);
+    outputs->emplace_back(CPU);
+    exportOutput(instance.get(), name, &outputs->back());
+  }
+  return true;
+}
+
+bool ConcurrentPredictor::operator()(
+    const TensorMap& inputs,
+    TensorMap* outputs) {
+  auto named_inputs = namedInputs(inputs);
+  auto instance = acquire();
+  auto guard = MakeGuard([&] { release(std::move(instance)); });
+  if (!run(instance.get(), named_inputs)) {
+    return false;
+  }
+  for (const std::string& name : output_names()) {
+    auto iter = outputs->emplace(name, TensorCPU(CPU));
+    exportOutput(instance.get(), name, &iter.first->second);
+  }
+  return true;
+}
+
 } // namespace caffe2
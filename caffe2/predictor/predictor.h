@@ -1,5 +1,8 @@
 #pragma once
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <unordered_set>
 #include "caffe2/core/net.h"
 #include "caffe2/core/tensor.h"
@@ -65,4 +68,86 @@ class CAFFE2_API Predictor {
   bool run_map_workspace(const TensorMap& inputs);
   PredictorConfig config_;
 };
-}
+
+// A predictor that can run requests from many threads at the same time.
+//
+// Parameters are kept once, in the workspace of the config, which is only
+// read while running. Every request borrows an instance of the net from a
+// pool, with its own child workspace holding the inputs and activations of the
+// request, and returns it when done. Instances are created on demand, up to
+// `max_instances` (0 for no limit); beyond that, requests wait for an instance
+// to be returned.
+//
+// With `optimize_memory`, activations of the net are shared through memonger,
+// which bounds the memory of every instance to the planned activations.
+//
+// Outputs own their data, which is not reused by later requests.
+class CAFFE2_API ConcurrentPredictor {
+ public:
+  using TensorList = Predictor::TensorList;
+  using TensorMap = Predictor::TensorMap;
+
+  ConcurrentPredictor(
+      PredictorConfig config,
+      size_t max_instances = 0,
+      bool optimize_memory = true);
+
+  // Same as the Predictor functions, and safe to call concurrently. The first
+  // `inputs.size()` inputs from run_net::external_inputs must be inputs of
+  // the model, rather than parameters.
+  bool operator()(const TensorList& inputs, TensorList* outputs);
+  bool operator()(const TensorMap& inputs, TensorList* outputs);
+  bool operator()(const TensorMap& inputs, TensorMap* outputs);
+
+  // The net that instances run, after memory optimization
+  const NetDef& def() const {
+    return *predict_net_;
+  };
+
+  // The workspace holding the parameters
+  Workspace* ws() {
+    return config_.ws.get();
+  };
+
+  const std::vector<std::string>& input_names() const {
+    return config_.input_names;
+  }
+
+  const std::vector<std::string>& output_names() const {
+    return config_.output_names;
+  }
+
+  // The number of instances created so far
+  size_t num_instances() const;
+
+ private:
+  struct Instance {
+    std::unique_ptr<Workspace> ws;
+    NetBase* net;
+  };
+
+  std::unique_ptr<Instance> acquire();
+  void release(std::unique_ptr<Instance> instance);
+
+  std::vector<std::pair<std::string, const TensorCPU*>> namedInputs(
+      const TensorMap& inputs) const;
+  bool run(
+      Instance* instance,
+      const std::vector<std::pair<std::string, const TensorCPU*>>& inputs);
+  void exportOutput(
+      Instance* instance,
+      const std::string& name,
+      TensorCPU* output);
+
+  PredictorConfig config_;
+  std::shared_ptr<NetDef> predict_net_;
+  // Blobs that every instance holds in its own workspace
+  std::unordered_set<std::string> local_blobs_;
+  size_t max_instances_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable released_;
+  std::vector<std::unique_ptr<Instance>> free_instances_;
+  size_t num_instances_{0};
+};
+} // namespace caffe2
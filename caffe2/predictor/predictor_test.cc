@@ -2,10 +2,14 @@
 #include "caffe2/core/operator.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/predictor/predictor.h"
+#include "caffe2/predictor/predictor_utils.h"
 #include "caffe2/utils/math.h"
 
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <thread>
+
 namespace caffe2 {
 
 namespace {
@@ -192,6 +196,49 @@ TEST_F(PredictorTest, SimpleBatchSized) {
   EXPECT_NEAR(output.front().data<float>()[4], 0.1209, 1E-4);
 }
 
+TEST_F(PredictorTest, MappedWeightsMatchInitNet) {
+  Workspace source;
+  ASSERT_TRUE(source.RunNetOnce(parseNetDef(initSpec)));
+  const std::string path = std::tmpnam(nullptr);
+  predictor_utils::saveMappedWeights(source, {"W", "b"}, path);
+
+  Workspace weights;
+  predictor_utils::loadMappedWeights(path, &weights);
+  for (const char* name : {"W", "b"}) {
+    const auto& expected = source.GetBlob(name)->Get<TensorCPU>();
+    const auto& mapped = weights.GetBlob(name)->Get<TensorCPU>();
+    EXPECT_EQ(mapped.dims(), expected.dims());
+    EXPECT_EQ(
+        reinterpret_cast<uintptr_t>(mapped.raw_data()) %
+            predictor_utils::kMappedWeightsAlignment,
+        0);
+    for (int i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(mapped.data<float>()[i], expected.data<float>()[i]);
+    }
+  }
+
+  // The mapped weights replace the init net of a predictor
+  Predictor mapped(makePredictorConfig(
+      NetDef(), parseNetDef(predictSpec), &weights, /*run_init=*/false));
+  auto inputData = randomTensor({1, 4}, ctx_.get());
+  Predictor::TensorList input;
+  input.emplace_back(CPU);
+  auto tensor = BlobGetMutableTensor(inputData.get(), CPU);
+  input.back().ResizeLike(*tensor);
+  input.back().ShareData(*tensor);
+  Predictor::TensorList expected_output;
+  Predictor::TensorList mapped_output;
+  ASSERT_TRUE((*p_)(input, &expected_output));
+  ASSERT_TRUE(mapped(input, &mapped_output));
+  ASSERT_EQ(mapped_output.size(), 1);
+  for (int i = 0; i < expected_output.front().size(); ++i) {
+    EXPECT_EQ(
+        mapped_output.front().data<float>()[i],
+        expected_output.front().data<float>()[i]);
+  }
+  std::remove(path.c_str());
+}
+
 TEST_F(PredictorTest, SimpleBatchSizedMapInput) {
   auto inputData = randomTensor({1, 4}, ctx_.get());
   Predictor::TensorMap input;
@@ -209,4 +256,127 @@ TEST_F(PredictorTest, SimpleBatchSizedMapInput) {
   EXPECT_NEAR(output.front().data<float>()[4], 0.1209, 1E-4);
 }
 
+TEST_F(PredictorTest, ConcurrentPredictorMatchesPredictor) {
+  const int kThreads = 4;
+  const int kRequests = 20;
+  ConcurrentPredictor predictor(
+      makePredictorConfig(parseNetDef(initSpec), parseNetDef(predictSpec)));
+
+  // Expected outputs of every request, computed one by one
+  std::vector<std::unique_ptr<Blob>> inputs;
+  std::vector<std::vector<float>> expected;
+  for (int i = 0; i < kThreads * kRequests; ++i) {
+    inputs.push_back(randomTensor({i % 3 + 1, 4}, ctx_.get()));
+    Predictor::TensorList input;
+    input.emplace_back(CPU);
+    auto tensor = BlobGetMutableTensor(inputs.back().get(), CPU);
+    input.back().ResizeLike(*tensor);
+    input.back().ShareData(*tensor);
+    Predictor::TensorList output;
+    ASSERT_TRUE((*p_)(input, &output));
+    const auto* data = output.front().data<float>();
+    expected.emplace_back(data, data + output.front().size());
+  }
+
+  std::vector<std::thread> threads;
+  std::vector<std::vector<std::vector<float>>> results(kThreads);
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int r = 0; r < kRequests; ++r) {
+        ConcurrentPredictor::TensorMap input;
+        auto iter = input.emplace("data", Tensor(CPU));
+        auto tensor =
+            BlobGetMutableTensor(inputs[t * kRequests + r].get(), CPU);
+        iter.first->second.ResizeLike(*tensor);
+        iter.first->second.ShareData(*tensor);
+        ConcurrentPredictor::TensorList output;
+        CAFFE_ENFORCE(predictor(input, &output));
+        const auto* data = output.front().data<float>();
+        results[t].emplace_back(data, data + output.front().size());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int t = 0; t < kThreads; ++t) {
+    for (int r = 0; r < kRequests; ++r) {
+      const auto& result = results[t][r];
+      const auto& want = expected[t * kRequests + r];
+      ASSERT_EQ(want.size(), result.size());
+      for (size_t i = 0; i < want.size(); ++i) {
+        EXPECT_NEAR(want[i], result[i], 1E-4);
+      }
+    }
+  }
+  EXPECT_LE(predictor.num_instances(), kThreads);
+}
+
+TEST_F(PredictorTest, ConcurrentPredictorBoundsInstances) {
+  const int kThreads = 8;
+  ConcurrentPredictor predictor(
+      makePredictorConfig(parseNetDef(initSpec), parseNetDef(predictSpec)),
+      /*max_instances=*/2);
+  auto inputData = randomTensor({1, 4}, ctx_.get());
+  auto tensor = BlobGetMutableTensor(inputData.get(), CPU);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&] {
+      for (int r = 0; r < 10; ++r) {
+        ConcurrentPredictor::TensorList input;
+        input.emplace_back(CPU);
+        input.back().ResizeLike(*tensor);
+        input.back().ShareData(*tensor);
+        ConcurrentPredictor::TensorList output;
+        CAFFE_ENFORCE(predictor(input, &output));
+        CAFFE_ENFORCE_EQ(output.front().size(), 10);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_GE(predictor.num_instances(), 1);
+  EXPECT_LE(predictor.num_instances(), 2);
+}
+
+TEST_F(PredictorTest, ConcurrentPredictorKeepsOutputs) {
+  ConcurrentPredictor predictor(
+      makePredictorConfig(parseNetDef(initSpec), parseNetDef(predictSpec)),
+      /*max_instances=*/1);
+  auto first = randomTensor({1, 4}, ctx_.get());
+  auto second = randomTensor({1, 4}, ctx_.get());
+
+  ConcurrentPredictor::TensorList input;
+  input.emplace_back(CPU);
+  auto tensor = BlobGetMutableTensor(first.get(), CPU);
+  input.back().ResizeLike(*tensor);
+  input.back().ShareData(*tensor);
+  ConcurrentPredictor::TensorList first_output;
+  ASSERT_TRUE(predictor(input, &first_output));
+  const std::vector<float> saved(
+      first_output.front().data<float>(),
+      first_output.front().data<float>() + first_output.front().size());
+
+  // The same instance runs the second request
+  tensor = BlobGetMutableTensor(second.get(), CPU);
+  input.back().ShareData(*tensor);
+  ConcurrentPredictor::TensorList second_output;
+  ASSERT_TRUE(predictor(input, &second_output));
+  for (size_t i = 0; i < saved.size(); ++i) {
+    EXPECT_EQ(saved[i], first_output.front().data<float>()[i]);
+  }
+}
+
+TEST_F(PredictorTest, ConcurrentPredictorRejectsParameterInputs) {
+  ConcurrentPredictor predictor(
+      makePredictorConfig(parseNetDef(initSpec), parseNetDef(predictSpec)));
+  ConcurrentPredictor::TensorMap input;
+  input.emplace("W", Tensor(CPU));
+  ConcurrentPredictor::TensorList output;
+  EXPECT_THROW(predictor(input, &output), EnforceNotMet);
+}
+
 } // namespace caffe2
@@ -1,5 +1,15 @@
 #include "caffe2/predictor/predictor_utils.h"
 
+#include <cstring>
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "caffe2/core/blob.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/proto/caffe2_pb.h"
@@ -78,5 +88,174 @@ std::unique_ptr<MetaNetDef> runGlobalInitialization(
   return metaNetDef;
 }
 
+namespace {
+
+constexpr char kMappedWeightsMagic[8] =
+    {'C', '2', 'W', 'E', 'I', 'G', 'H', 'T'};
+
+// Magic, then the offset and the size of the index
+constexpr size_t kMappedWeightsHeaderSize = 8 + 2 * sizeof(uint64_t);
+
+size_t alignUp(size_t offset) {
+  return (offset + kMappedWeightsAlignment - 1) / kMappedWeightsAlignment *
+      kMappedWeightsAlignment;
+}
+
+#if !defined(_WIN32)
+// A read-only mapping of a whole file, unmapped with its last tensor.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    CAFFE_ENFORCE(fd >= 0, "Cannot open mapped weights ", path);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      CAFFE_THROW("Cannot stat mapped weights ", path);
+    }
+    size_ = st.st_size;
+    data_ = size_ > 0 ? mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0)
+                      : MAP_FAILED;
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    CAFFE_ENFORCE(data_ != MAP_FAILED, "Cannot map weights ", path);
+  }
+
+  ~MappedFile() {
+    munmap(data_, size_);
+  }
+
+  const char* data() const {
+    return static_cast<const char*>(data_);
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  void* data_;
+  size_t size_;
+
+  C10_DISABLE_COPY_AND_ASSIGN(MappedFile);
+};
+
+void deleteMappedFileRef(void* ref) {
+  delete static_cast<std::shared_ptr<MappedFile>*>(ref);
+}
+#endif
+
+} // namespace
+
+void saveMappedWeights(
+    const Workspace& ws,
+    const std::vector<std::string>& names,
+    const std::string& path) {
+  const int kValue = 1;
+  CAFFE_ENFORCE_EQ(
+      reinterpret_cast<const char*>(&kValue)[0],
+      1,
+      "Mapped weights on big endian platform is not written yet.");
+  TensorProtos index;
+  std::vector<const Tensor*> tensors;
+  size_t offset = alignUp(kMappedWeightsHeaderSize);
+  for (const auto& name : names) {
+    const Blob* blob = ws.GetBlob(name);
+    CAFFE_ENFORCE(blob, "Blob not found: ", name);
+    CAFFE_ENFORCE(BlobIsTensorType(*blob, CPU), name, " is not a CPU tensor");
+    const Tensor& tensor = blob->Get<Tensor>();
+    const auto data_type = TypeMetaToDataType(tensor.meta());
+    CAFFE_ENFORCE(
+        data_type != TensorProto_DataType_STRING &&
+            data_type != TensorProto_DataType_UNDEFINED,
+        "Cannot map ",
+        name,
+        " of type ",
+        tensor.meta().name());
+    TensorProto* proto = index.add_protos();
+    proto->set_name(name);
+    for (const auto d : tensor.dims()) {
+      proto->add_dims(d);
+    }
+    proto->set_data_type(data_type);
+    proto->set_storage_type(TensorProto_StorageType_EXTERNAL);
+    proto->mutable_external_data()->set_source_type(
+        ExternalDataProto_SourceType_SIMPLE_FILE);
+    proto->mutable_external_data()->set_offset(offset);
+    tensors.push_back(&tensor);
+    offset = alignUp(offset + tensor.nbytes());
+  }
+  const std::string serialized_index = index.SerializeAsString();
+  const uint64_t header[2] = {offset, serialized_index.size()};
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  CAFFE_ENFORCE(out.good(), "Cannot write mapped weights ", path);
+  const std::string padding(kMappedWeightsAlignment, '\0');
+  out.write(kMappedWeightsMagic, sizeof(kMappedWeightsMagic));
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+  size_t written = kMappedWeightsHeaderSize;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const size_t begin = index.protos(i).external_data().offset();
+    out.write(padding.data(), begin - written);
+    out.write(
+        static_cast<const char*>(tensors[i]->raw_data()),
+        tensors[i]->nbytes());
+    written = begin + tensors[i]->nbytes();
+  }
+  out.write(padding.data(), offset - written);
+  out << serialized_index;
+  CAFFE_ENFORCE(out.good(), "Failed writing mapped weights ", path);
+}
+
+void loadMappedWeights(const std::string& path, Workspace* ws) {
+#if !defined(_WIN32)
+  auto file = std::make_shared<MappedFile>(path);
+  CAFFE_ENFORCE(
+      file->size() >= kMappedWeightsHeaderSize &&
+          std::memcmp(
+              file->data(),
+              kMappedWeightsMagic,
+              sizeof(kMappedWeightsMagic)) == 0,
+      path,
+      " is not a mapped weights file");
+  uint64_t header[2];
+  std::memcpy(
+      header, file->data() + sizeof(kMappedWeightsMagic), sizeof(header));
+  CAFFE_ENFORCE_LE(header[0] + header[1], file->size(), "Truncated ", path);
+  TensorProtos index;
+  CAFFE_ENFORCE(
+      index.ParseFromArray(file->data() + header[0], header[1]),
+      "Cannot parse the index of ",
+      path);
+
+  for (const auto& proto : index.protos()) {
+    CAFFE_ENFORCE_EQ(
+        proto.storage_type(), TensorProto_StorageType_EXTERNAL, proto.name());
+    const TypeMeta& meta = DataTypeToTypeMeta(proto.data_type());
+    std::vector<int64_t> dims(proto.dims().begin(), proto.dims().end());
+    Tensor* tensor = BlobGetMutableTensor(ws->CreateBlob(proto.name()), CPU);
+    tensor->Resize(dims);
+    const int64_t offset = proto.external_data().offset();
+    CAFFE_ENFORCE(
+        offset % kMappedWeightsAlignment == 0 &&
+            offset + tensor->size() * meta.itemsize() <= header[0],
+        "Invalid offset of ",
+        proto.name());
+    // Every tensor keeps a reference to the mapping
+    void* data = const_cast<char*>(file->data() + offset);
+    tensor->ShareExternalPointer(
+        at::DataPtr(
+            data,
+            new std::shared_ptr<MappedFile>(file),
+            &deleteMappedFileRef,
+            at::Device(CPU)),
+        meta,
+        tensor->size() * meta.itemsize());
+  }
+#else
+  CAFFE_THROW("Mapped weights are not supported on Windows.");
+#endif
+}
+
 } // namespace predictor_utils
 } // namespace caffe2
@@ -23,5 +23,29 @@ CAFFE2_API std::unique_ptr<MetaNetDef> runGlobalInitialization(
     std::unique_ptr<db::DBReader> db,
     Workspace* master);
 
+// Mapped weights are a file of CPU tensors that can be memory-mapped and used
+// in place. The file starts with a header (magic, offset and size of the
+// index), followed by the data of every tensor at an offset aligned to
+// kMappedWeightsAlignment bytes, and ends with the index: a TensorProtos of
+// the name, type and shape of every tensor, with the offset of its data in
+// external_data.
+constexpr size_t kMappedWeightsAlignment = 64;
+
+// Writes the CPU tensors `names` of `ws` as a mapped weights file at `path`.
+// Only tensors of fixed size types can be mapped.
+CAFFE2_API void saveMappedWeights(
+    const Workspace& ws,
+    const std::vector<std::string>& names,
+    const std::string& path);
+
+// Maps the weights file at `path` read-only and creates a CPU tensor in `ws`
+// for every weight, which points into the mapping instead of holding a copy.
+// The pages are shared by every process that maps the same file, and the
+// mapping lives as long as any of its tensors. The tensors must not be
+// written to, so they are meant to be predictor parameters, e.g. loaded into
+// the parent workspace of the predictors instead of being filled by their
+// init nets.
+CAFFE2_API void loadMappedWeights(const std::string& path, Workspace* ws);
+
 } // namespace predictor_utils
 } // namespace caffe2
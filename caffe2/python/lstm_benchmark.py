@@ -156,6 +156,8 @@ def create_model(args, queue, label_queue, input_shape):
                     op,
                     num_threads=args.rnn_executor_num_threads,
                     max_cuda_streams=args.rnn_executor_max_cuda_streams,
+                    max_parallel_timesteps=(
+                        args.rnn_executor_max_parallel_timesteps),
                 )
     return model, output
 
@@ -325,6 +327,13 @@ def GetArgumentParser():
         default=None,
         help="Maximum number of CUDA streams used by RNN executor on GPU"
     )
+    parser.add_argument(
+        "--rnn_executor_max_parallel_timesteps",
+        type=int,
+        default=None,
+        help="Number of timesteps the RNN executor runs concurrently in "
+             "forward-only mode, each with its own step workspace"
+    )
     return parser
 
 
@@ -537,6 +537,66 @@ class TestDatasetOps(TestCase):
         actual_sizes = [d.shape[0] for d in trimmed.field_blobs()]
         self.assertEquals(EXPECTED_SIZES, actual_sizes)
 
+    def test_read_batch_threads_and_views(self):
+        schema = Struct(
+            ('x', Scalar(np.float32)),
+            ('lst', List(Scalar(np.int64))),
+        )
+        contents = from_blob_list(schema, [
+            [1.0, 2.0, 3.0, 4.0],  # x
+            [1, 0, 2, 3],  # lst:lengths
+            [11, 31, 32, 41, 42, 43],  # lst:values
+        ])
+        ds = dataset.Dataset(schema)
+        net = core.Net('init')
+        ds.init_empty(net)
+        content_blobs = NewRecord(net, contents)
+        FeedRecord(content_blobs, contents)
+        ds.writer(init_net=net).write_record(net, content_blobs)
+        workspace.RunNetOnce(net)
+
+        field_blobs = ds.content().field_blobs()
+        outputs = ['x', 'lengths', 'values']
+        workspace.RunOperatorOnce(core.CreateOperator(
+            'CreateTreeCursor', [], ['cursor'], fields=ds.fields))
+        workspace.RunOperatorOnce(core.CreateOperator(
+            'ComputeOffset', ['cursor'] + field_blobs, ['offsets']))
+
+        def read(op_type, inputs, batch_size, **kwargs):
+            results = []
+            for num_threads, share_data in [(1, False), (3, False), (3, True)]:
+                workspace.RunOperatorOnce(core.CreateOperator(
+                    'ResetCursor', ['cursor'], []))
+                workspace.RunOperatorOnce(core.CreateOperator(
+                    op_type, inputs + field_blobs, outputs,
+                    batch_size=batch_size, num_threads=num_threads,
+                    share_data=share_data, **kwargs))
+                results.append([workspace.FetchBlob(o) for o in outputs])
+            for result in results[1:]:
+                for actual, ref in zip(result, results[0]):
+                    npt.assert_array_equal(actual, ref)
+            return results[0]
+
+        x, lengths, values = read('ReadNextBatch', ['cursor'], 3)
+        npt.assert_array_equal(x, [1.0, 2.0, 3.0])
+        npt.assert_array_equal(lengths, [1, 0, 2])
+        npt.assert_array_equal(values, [11, 31, 32])
+
+        workspace.FeedBlob('idx', np.array([2, 0, 3, 1], dtype=np.int64))
+        x, lengths, values = read(
+            'ReadRandomBatch', ['cursor', 'idx', 'offsets'], 3)
+        npt.assert_array_equal(x, [3.0, 1.0, 4.0])
+        npt.assert_array_equal(lengths, [2, 1, 3])
+        npt.assert_array_equal(values, [31, 32, 11, 41, 42, 43])
+
+        # contiguous rows, returned as views with share_data
+        workspace.FeedBlob('idx', np.array([1, 2, 3, 0], dtype=np.int64))
+        x, lengths, values = read(
+            'ReadRandomBatch', ['cursor', 'idx', 'offsets'], 3)
+        npt.assert_array_equal(x, [2.0, 3.0, 4.0])
+        npt.assert_array_equal(lengths, [0, 2, 3])
+        npt.assert_array_equal(values, [31, 32, 41, 42, 43])
+
     def test_last_n_window_ops(self):
         collect_net = core.Net('collect_net')
         collect_net.GivenTensorFill(
@@ -0,0 +1,144 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+from caffe2.python import core, optimizer, workspace
+from hypothesis import given
+import caffe2.python.hypothesis_test_util as hu
+import hypothesis.strategies as st
+import numpy as np
+
+
+class TestMultiTensorUpdate(hu.HypothesisTestCase):
+
+    def _run_single_and_multi(
+            self, op_type, inputs, num_outputs, gc, inplace=None, **kwargs):
+        """Runs op_type on every list of inputs, and its Multi version on all of
+        them, and checks that the outputs match. inplace maps the outputs that
+        must be in-place to their inputs."""
+        inplace = inplace or {}
+        expected = []
+        multi_inputs = []
+        multi_outputs = []
+        for prefix in ('single', 'multi'):
+            for i, param_inputs in enumerate(inputs):
+                names = ['{}_in_{}_{}'.format(prefix, i, j)
+                         for j in range(len(param_inputs))]
+                for name, value in zip(names, param_inputs):
+                    workspace.FeedBlob(name, value, device_option=gc)
+                outputs = [
+                    names[inplace[j]] if j in inplace else
+                    '{}_out_{}_{}'.format(prefix, i, j)
+                    for j in range(num_outputs)
+                ]
+                if prefix == 'single':
+                    workspace.RunOperatorOnce(core.CreateOperator(
+                        op_type, names, outputs, device_option=gc, **kwargs))
+                    expected.extend(workspace.FetchBlob(o) for o in outputs)
+                else:
+                    multi_inputs.extend(names)
+                    multi_outputs.extend(outputs)
+        workspace.RunOperatorOnce(core.CreateOperator(
+            'Multi' + op_type, multi_inputs, multi_outputs, device_option=gc,
+            **kwargs))
+        for name, value in zip(multi_outputs, expected):
+            np.testing.assert_allclose(
+                workspace.FetchBlob(name), value, rtol=1e-4, atol=1e-6)
+
+    @given(num_params=st.integers(1, 4),
+           nesterov=st.booleans(),
+           **hu.gcs)
+    def test_multi_momentum_sgd_update(self, num_params, nesterov, gc, dc):
+        inputs = []
+        for i in range(num_params):
+            shape = (i + 1, 2 * i + 3)
+            inputs.append([
+                np.random.rand(*shape).astype(np.float32),
+                np.random.rand(*shape).astype(np.float32),
+                np.random.rand(1).astype(np.float32),
+                np.random.rand(*shape).astype(np.float32),
+            ])
+        self._run_single_and_multi(
+            'MomentumSGDUpdate', inputs, 3, gc, inplace={2: 3},
+            momentum=0.9, nesterov=nesterov)
+
+    @given(num_params=st.integers(1, 4), **hu.gcs)
+    def test_multi_adagrad(self, num_params, gc, dc):
+        inputs = []
+        for i in range(num_params):
+            shape = (3 * i + 1,)
+            inputs.append([
+                np.random.rand(*shape).astype(np.float32),
+                np.random.rand(*shape).astype(np.float32),
+                np.random.rand(*shape).astype(np.float32),
+                -np.random.rand(1).astype(np.float32),
+            ])
+        self._run_single_and_multi('Adagrad', inputs, 2, gc, epsilon=1e-4)
+
+    @given(num_params=st.integers(1, 4), **hu.gcs)
+    def test_multi_lars(self, num_params, gc, dc):
+        inputs = []
+        for i in range(num_params):
+            shape = (5, i + 1)
+            inputs.append([
+                np.random.rand(*shape).astype(np.float32),
+                np.random.rand(*shape).astype(np.float32),
+                np.array([1e-4]).astype(np.float32),
+                np.random.rand(1).astype(np.float32),
+                np.random.rand(1).astype(np.float32),
+            ])
+        self._run_single_and_multi('Lars', inputs, 1, gc, offset=0.5)
+
+    def test_multi_adam(self):
+        inputs = []
+        for i in range(3):
+            shape = (i + 2, 4)
+            inputs.append([
+                np.random.rand(*shape).astype(np.float32),
+                np.random.rand(*shape).astype(np.float32),
+                np.random.rand(*shape).astype(np.float32),
+                np.random.rand(*shape).astype(np.float32),
+                -np.random.rand(1).astype(np.float32),
+                np.array([i * 10]).astype(np.int64),
+            ])
+        self._run_single_and_multi(
+            'Adam', inputs, 3, hu.cpu_do, beta1=0.8, beta2=0.99)
+
+    def test_fuse_multi_tensor_updates(self):
+        net = core.Net('fuse_multi_tensor_updates')
+        blobs = {}
+        for i in range(3):
+            p, g, m = 'p{}'.format(i), 'g{}'.format(i), 'm{}'.format(i)
+            for name in (p, g, m):
+                blobs[name] = np.random.rand(4, i + 1).astype(np.float32)
+            net.Lars([p, g, 'wd', 'trust', 'lr_max'], 'rescale{}'.format(i))
+            net.Mul(['lr', 'rescale{}'.format(i)], 'lr{}'.format(i))
+            net.MomentumSGDUpdate(
+                [g, 'm{}'.format(i), 'lr{}'.format(i), p], [g, m, p],
+                momentum=0.9)
+        blobs['wd'] = np.array([1e-4]).astype(np.float32)
+        blobs['trust'] = np.array([0.1]).astype(np.float32)
+        blobs['lr_max'] = np.array([1.0]).astype(np.float32)
+        blobs['lr'] = np.array([-0.1]).astype(np.float32)
+
+        fused = net.Clone('fused')
+        self.assertEqual(optimizer.fuse_multi_tensor_updates(fused), 4)
+        self.assertEqual(
+            [op.type for op in fused.Proto().op],
+            ['MultiLars', 'Mul', 'Mul', 'Mul', 'MultiMomentumSGDUpdate'])
+
+        results = []
+        for n in (net, fused):
+            for name, value in blobs.items():
+                workspace.FeedBlob(name, value)
+            workspace.RunNetOnce(n)
+            results.append(
+                [workspace.FetchBlob('p{}'.format(i)) for i in range(3)])
+        for expected, actual in zip(*results):
+            np.testing.assert_allclose(actual, expected, rtol=1e-5)
+
+
+if __name__ == "__main__":
+    import unittest
+    unittest.main()
@@ -1549,3 +1549,122 @@ def build_rms_prop(
         max_gradient_norm=max_gradient_norm,
         allow_lr_injection=allow_lr_injection,
     )
+
+
+
+# The optimizer ops that have a variadic version updating a list of parameters,
+# with the number of inputs and outputs per parameter
+_MULTI_TENSOR_OPS = {
+    'MomentumSGDUpdate': ('MultiMomentumSGDUpdate', 4, 3),
+    'Adagrad': ('MultiAdagrad', 4, 2),
+    'Adam': ('MultiAdam', 6, 3),
+    'Lars': ('MultiLars', 5, 1),
+}
+
+
+class _MultiTensorGroup(object):
+    def __init__(self):
+        self.members = []
+        self.reads = set()
+        self.writes = set()
+        # The blobs used by the ops between the first member and the last
+        self.between_reads = set()
+        self.between_writes = set()
+        # Whether the group can be placed at its last member (sinking the
+        # others) or at its first member (hoisting the others)
+        self.can_sink = True
+        self.can_hoist = True
+
+    def add_between(self, inputs, outputs):
+        if inputs & self.writes or outputs & (self.reads | self.writes):
+            self.can_sink = False
+        self.between_reads |= inputs
+        self.between_writes |= outputs
+
+    def try_add(self, i, inputs, outputs):
+        if inputs & self.writes or outputs & (self.reads | self.writes):
+            return False
+        can_hoist = self.can_hoist and not (
+            inputs & self.between_writes or
+            outputs & (self.between_reads | self.between_writes))
+        if not (self.can_sink or can_hoist):
+            return False
+        self.can_hoist = can_hoist
+        self.members.append(i)
+        self.reads |= inputs
+        self.writes |= outputs
+        return True
+
+
+def fuse_multi_tensor_updates(net):
+    """Replaces the per-parameter optimizer ops of net with their multi-tensor
+    versions (e.g. MomentumSGDUpdate with MultiMomentumSGDUpdate), which update
+    all the parameters of a group in one op and, on the GPU, one kernel launch.
+
+    Ops are grouped when they have the same type, device, engine and
+    arguments. A group replaces either its last member, if the other members
+    can be moved past the ops in between, or its first member (e.g. Lars,
+    whose outputs are used right away), if the other members can be moved
+    before the ops in between.
+
+    Returns the number of ops that were removed from the net.
+    """
+    ops = list(net.Proto().op)
+    open_groups = {}
+    groups = []
+    for i, op in enumerate(ops):
+        inputs = set(op.input)
+        outputs = set(op.output)
+        multi = _MULTI_TENSOR_OPS.get(op.type)
+        key = None
+        if multi is not None and len(op.input) == multi[1] and \
+                len(op.output) == multi[2]:
+            key = (
+                op.type,
+                op.device_option.SerializeToString(),
+                op.engine,
+                tuple(sorted(arg.SerializeToString() for arg in op.arg)),
+            )
+        for group_key, group in list(open_groups.items()):
+            if group_key == key and group.try_add(i, inputs, outputs):
+                continue
+            group.add_between(inputs, outputs)
+            if group_key == key or not (group.can_sink or group.can_hoist):
+                groups.append(open_groups.pop(group_key))
+        if key is not None and key not in open_groups:
+            open_groups[key] = _MultiTensorGroup()
+            open_groups[key].members.append(i)
+            open_groups[key].reads |= inputs
+            open_groups[key].writes |= outputs
+    groups.extend(open_groups.values())
+
+    # The fused op of every group at its position, and None at the positions
+    # of its other members
+    fused = {}
+    for group in groups:
+        members = group.members
+        if len(members) < 2:
+            continue
+        multi_op = caffe2_pb2.OperatorDef()
+        multi_op.CopyFrom(ops[members[0]])
+        multi_op.type = _MULTI_TENSOR_OPS[multi_op.type][0]
+        multi_op.ClearField('input')
+        multi_op.ClearField('output')
+        for m in members:
+            multi_op.input.extend(ops[m].input)
+            multi_op.output.extend(ops[m].output)
+        position = members[-1] if group.can_sink else members[0]
+        for m in members:
+            fused[m] = multi_op if m == position else None
+
+    if not fused:
+        return 0
+    new_ops = []
+    for i, op in enumerate(ops):
+        if i not in fused:
+            new_ops.append(op)
+        elif fused[i] is not None:
+            new_ops.append(fused[i])
+    del net.Proto().op[:]
+    net.Proto().op.extend(new_ops)
+    return len(ops) - len(new_ops)
@@ -69,10 +69,16 @@ void addCUDAGlobalMethods(py::module& m) {
          int max_batch_size,
          int max_workspace_size,
          int verbosity,
-         bool debug_builder) -> py::bytes {
+         bool debug_builder,
+         const std::string& engine_cache_dir) -> py::bytes {
 #ifdef CAFFE2_USE_TRT
         TensorRTTransformer t(
-            max_batch_size, max_workspace_size, verbosity, debug_builder);
+            max_batch_size,
+            max_workspace_size,
+            verbosity,
+            debug_builder,
+            true,
+            engine_cache_dir);
         auto op_def =
             t.BuildTrtOp(onnx_model_str.cast<std::string>(), output_size_hints);
         std::string out;
@@ -90,7 +96,9 @@ void addCUDAGlobalMethods(py::module& m) {
          int max_workspace_size,
          int verbosity,
          bool debug_builder,
-         bool build_serializable_op) -> py::bytes {
+         bool build_serializable_op,
+         const std::string& engine_cache_dir,
+         const std::vector<int>& batch_size_buckets) -> py::bytes {
 #ifdef CAFFE2_USE_TRT
         caffe2::NetDef pred_net;
         if (!ParseProtoFromLargeString(
@@ -107,7 +115,9 @@ void addCUDAGlobalMethods(py::module& m) {
             max_workspace_size,
             verbosity,
             debug_builder,
-            build_serializable_op);
+            build_serializable_op,
+            engine_cache_dir,
+            batch_size_buckets);
         ts.Transform(GetCurrentWorkspace(), &pred_net, tensor_shapes);
         std::string pred_net_str2;
         pred_net.SerializeToString(&pred_net_str2);
@@ -286,7 +286,8 @@ def recurrent_net(
     return results[:-1]
 
 
-def set_rnn_executor_config(rnn_op, num_threads=None, max_cuda_streams=None):
+def set_rnn_executor_config(rnn_op, num_threads=None, max_cuda_streams=None,
+                            max_parallel_timesteps=None):
     from caffe2.proto import caffe2_pb2
     assert rnn_op.type in {'RecurrentNetwork', 'RecurrentNetworkGradient'}
 
@@ -300,6 +301,10 @@ def set_rnn_executor_config(rnn_op, num_threads=None, max_cuda_streams=None):
         add_arg('num_threads', num_threads)
     if max_cuda_streams is not None:
         add_arg('max_cuda_streams', max_cuda_streams)
+    if max_parallel_timesteps is not None:
+        # Forward-only: number of step workspaces cycled over, and thus the
+        # number of timesteps in flight
+        add_arg('max_parallel_timesteps', max_parallel_timesteps)
 
 
 def retrieve_step_blobs(net, prefix='rnn'):
@@ -38,9 +38,14 @@ def convert_onnx_model_to_trt_op(onnx_model,
         max_batch_size=50,
         max_workspace_size=2*1024*1024,
         verbosity=1,
-        debug_builder=False):
+        debug_builder=False,
+        engine_cache_dir=""):
     """
     Convert the whole ONNX model to a TensorRT C2 op
+
+    If engine_cache_dir is set, the TensorRT engine is cached there, and
+    loaded instead of built by later conversions of the same model on the
+    same GPU and TensorRT version.
     """
     check_gpu_()
     trt_str = C.onnx_to_trt_op(onnx_model.SerializeToString(),
@@ -48,7 +53,8 @@ def convert_onnx_model_to_trt_op(onnx_model,
                                max_batch_size,
                                max_workspace_size,
                                verbosity,
-                               debug_builder)
+                               debug_builder,
+                               engine_cache_dir)
     op = caffe2_pb2.OperatorDef()
     op.ParseFromString(trt_str)
     return op
@@ -81,9 +87,16 @@ def transform_caffe2_net(
         max_workspace_size=2*1024*1024,
         verbosity=1,
         debug_builder=False,
-        build_serializable_op=True):
+        build_serializable_op=True,
+        engine_cache_dir="",
+        batch_size_buckets=None):
     """
     Transfrom the caffe2_net by collapsing TRT-runnable nodes into trt c2 ops
+
+    engine_cache_dir caches the TensorRT engines on disk across processes.
+    Without build_serializable_op, the trt ops build their engines when they
+    are created, one for max_batch_size and one for each of the smaller
+    batch_size_buckets, and run every batch on the smallest that fits.
     """
     check_gpu_()
 
@@ -104,7 +117,9 @@ def transform_caffe2_net(
                                    max_workspace_size,
                                    verbosity,
                                    debug_builder,
-                                   build_serializable_op)
+                                   build_serializable_op,
+                                   engine_cache_dir,
+                                   batch_size_buckets or [])
     pred_net_cut = caffe2_pb2.NetDef()
     pred_net_cut.ParseFromString(pred_net_str)
     return pred_net_cut
@@ -1,6 +1,8 @@
 #include "caffe2/queue/blobs_queue.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -29,15 +31,19 @@ BlobsQueue::BlobsQueue(
     size_t numBlobs,
     bool enforceUniqueName,
     const std::vector<std::string>& fieldNames)
-    : numBlobs_(numBlobs), name_(queueName), stats_(queueName) {
+    : numBlobs_(numBlobs),
+      capacity_(capacity),
+      name_(queueName),
+      stats_(queueName) {
+  CAFFE_ENFORCE_GT(capacity, 0, "Queue capacity must be positive");
   if (!fieldNames.empty()) {
     CAFFE_ENFORCE_EQ(
         fieldNames.size(), numBlobs, "Wrong number of fieldNames provided.");
     stats_.queue_dequeued_bytes.setDetails(fieldNames);
   }
-  queue_.reserve(capacity);
+  slots_.reset(new Slot[capacity]);
   for (auto i = 0; i < capacity; ++i) {
-    std::vector<Blob*> blobs;
+    auto& blobs = slots_[i].blobs;
     blobs.reserve(numBlobs);
     for (auto j = 0; j < numBlobs; ++j) {
       const auto blobName = queueName + "_" + to_string(i) + "_" + to_string(j);
@@ -49,57 +55,98 @@ BlobsQueue::BlobsQueue(
       }
       blobs.push_back(ws->CreateBlob(blobName));
     }
-    queue_.push_back(blobs);
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+template <typename Op>
+size_t BlobsQueue::retryUntilReady(
+    const Op& op,
+    const std::atomic<uint64_t>& epoch,
+    std::atomic<int>& waiters,
+    std::condition_variable& cv,
+    float timeout_secs) {
+  const auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(int(timeout_secs * 1000));
+  while (true) {
+    auto done = op();
+    if (done > 0 || closing_) {
+      return done;
+    }
+    // Tries again after registering as a waiter, so that a thread that makes
+    // records ready after this try either sees the waiter or changes the
+    // epoch before it is loaded
+    ++waiters;
+    const auto lastEpoch = epoch.load();
+    done = op();
+    if (done > 0 || closing_) {
+      --waiters;
+      return done;
+    }
+    std::unique_lock<std::mutex> g(mutex_);
+    auto changed = [&]() { return closing_ || epoch.load() != lastEpoch; };
+    bool woken = true;
+    if (timeout_secs > 0) {
+      woken = cv.wait_until(g, deadline, changed);
+    } else {
+      cv.wait(g, changed);
+    }
+    --waiters;
+    if (!woken) {
+      return 0;
+    }
   }
-  DCHECK_EQ(queue_.size(), capacity);
 }
 
 bool BlobsQueue::blockingRead(
     const std::vector<Blob*>& inputs,
     float timeout_secs) {
+  return blockingRead(&inputs, 1, timeout_secs) == 1;
+}
+
+size_t BlobsQueue::blockingReadBatch(
+    const std::vector<std::vector<Blob*>>& inputs,
+    float timeout_secs) {
+  return blockingRead(inputs.data(), inputs.size(), timeout_secs);
+}
+
+size_t BlobsQueue::blockingRead(
+    const std::vector<Blob*>* inputs,
+    size_t count,
+    float timeout_secs) {
   Timer readTimer;
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_read_start, name, (void*)this, SDT_BLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
-  auto canRead = [this]() {
-    CAFFE_ENFORCE_LE(reader_, writer_);
-    return reader_ != writer_;
-  };
+  for (size_t i = 0; i < count; ++i) {
+    CAFFE_ENFORCE(inputs[i].size() >= numBlobs_);
+  }
   // Decrease queue balance before reading to indicate queue read pressure
   // is being increased (-ve queue balance indicates more reads than writes)
   CAFFE_EVENT(stats_, queue_balance, -1);
-  if (timeout_secs > 0) {
-    std::chrono::milliseconds timeout_ms(int(timeout_secs * 1000));
-    cv_.wait_for(
-        g, timeout_ms, [this, canRead]() { return closing_ || canRead(); });
-  } else {
-    cv_.wait(g, [this, canRead]() { return closing_ || canRead(); });
-  }
-  if (!canRead()) {
+  const auto numRead = retryUntilReady(
+      [&]() { return read(inputs, count); },
+      writtenEpoch_,
+      readWaiters_,
+      readCv_,
+      timeout_secs);
+  if (numRead == 0) {
     if (timeout_secs > 0 && !closing_) {
       LOG(ERROR) << "DequeueBlobs timed out in " << timeout_secs << " secs";
       CAFFE_SDT(queue_read_end, name, (void*)this, SDT_TIMEOUT);
     } else {
       CAFFE_SDT(queue_read_end, name, (void*)this, SDT_CANCEL);
     }
-    return false;
+    return 0;
   }
-  DCHECK(canRead());
-  auto& result = queue_[reader_ % queue_.size()];
-  CAFFE_ENFORCE(inputs.size() >= result.size());
-  for (auto i = 0; i < result.size(); ++i) {
-    auto bytes = BlobStat::sizeBytes(*result[i]);
-    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
-    using std::swap;
-    swap(*(inputs[i]), *(result[i]));
-  }
-  CAFFE_SDT(queue_read_end, name, (void*)this, writer_ - reader_);
-  CAFFE_EVENT(stats_, queue_dequeued_records);
-  ++reader_;
-  cv_.notify_all();
+  CAFFE_SDT(
+      queue_read_end,
+      name,
+      (void*)this,
+      writer_.load(std::memory_order_relaxed) -
+          reader_.load(std::memory_order_relaxed));
   CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
-  return true;
+  return numRead;
 }
 
 bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
@@ -107,67 +154,150 @@ bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_write_start, name, (void*)this, SDT_NONBLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
-  if (!canWrite()) {
+  CAFFE_ENFORCE(inputs.size() >= numBlobs_);
+  if (write(&inputs, 1) == 0) {
     CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
     return false;
   }
-  // Increase queue balance before writing to indicate queue write pressure is
-  // being increased (+ve queue balance indicates more writes than reads)
+  // Increase queue balance after writing to indicate queue write pressure was
+  // increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
-  DCHECK(canWrite());
-  doWrite(inputs);
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
 
 bool BlobsQueue::blockingWrite(const std::vector<Blob*>& inputs) {
+  return blockingWrite(&inputs, 1) == 1;
+}
+
+size_t BlobsQueue::blockingWriteBatch(
+    const std::vector<std::vector<Blob*>>& inputs) {
+  return blockingWrite(inputs.data(), inputs.size());
+}
+
+size_t BlobsQueue::blockingWrite(
+    const std::vector<Blob*>* inputs,
+    size_t count) {
   Timer writeTimer;
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_write_start, name, (void*)this, SDT_BLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
+  for (size_t i = 0; i < count; ++i) {
+    CAFFE_ENFORCE(inputs[i].size() >= numBlobs_);
+  }
   // Increase queue balance before writing to indicate queue write pressure is
   // being increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
-  cv_.wait(g, [this]() { return closing_ || canWrite(); });
-  if (!canWrite()) {
-    CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
-    return false;
+  size_t numWritten = 0;
+  while (numWritten < count) {
+    const auto written = retryUntilReady(
+        [&]() { return write(inputs + numWritten, count - numWritten); },
+        readEpoch_,
+        writeWaiters_,
+        writeCv_,
+        0.0f);
+    if (written == 0) {
+      CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
+      return numWritten;
+    }
+    numWritten += written;
   }
-  DCHECK(canWrite());
-  doWrite(inputs);
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
-  return true;
+  return numWritten;
 }
 
 void BlobsQueue::close() {
   closing_ = true;
 
   std::lock_guard<std::mutex> g(mutex_);
-  cv_.notify_all();
+  readCv_.notify_all();
+  writeCv_.notify_all();
+}
+
+std::pair<uint64_t, size_t> BlobsQueue::claim(
+    std::atomic<uint64_t>& position,
+    uint64_t offset,
+    size_t count) {
+  count = std::min(count, capacity_);
+  auto pos = position.load(std::memory_order_relaxed);
+  while (true) {
+    size_t ready = 0;
+    bool stale = false;
+    for (; ready < count; ++ready) {
+      const auto sequence = slots_[(pos + ready) % capacity_].sequence.load(
+          std::memory_order_acquire);
+      const auto diff =
+          static_cast<int64_t>(sequence - (pos + ready + offset));
+      if (diff != 0) {
+        // Another thread claimed the position since it was loaded
+        stale = ready == 0 && diff > 0;
+        break;
+      }
+    }
+    if (stale) {
+      pos = position.load(std::memory_order_relaxed);
+    } else if (ready == 0) {
+      return std::make_pair(pos, size_t(0));
+    } else if (position.compare_exchange_weak(
+                   pos, pos + ready, std::memory_order_relaxed)) {
+      return std::make_pair(pos, ready);
+    }
+  }
 }
 
-bool BlobsQueue::canWrite() {
-  // writer is always within [reader, reader + size)
-  // we can write if reader is within [reader, reader + size)
-  CAFFE_ENFORCE_LE(reader_, writer_);
-  CAFFE_ENFORCE_LE(writer_, reader_ + queue_.size());
-  return writer_ != reader_ + queue_.size();
+size_t BlobsQueue::read(const std::vector<Blob*>* records, size_t count) {
+  const auto claimed = claim(reader_, 1, count);
+  for (size_t i = 0; i < claimed.second; ++i) {
+    const auto pos = claimed.first + i;
+    auto& slot = slots_[pos % capacity_];
+    for (auto j = 0; j < slot.blobs.size(); ++j) {
+      auto bytes = BlobStat::sizeBytes(*slot.blobs[j]);
+      CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, j);
+      using std::swap;
+      swap(*(records[i][j]), *(slot.blobs[j]));
+    }
+    CAFFE_EVENT(stats_, queue_dequeued_records);
+    // The slot can be written in the next round
+    slot.sequence.store(pos + capacity_, std::memory_order_release);
+  }
+  if (claimed.second > 0) {
+    notify(readEpoch_, writeWaiters_, writeCv_);
+  }
+  return claimed.second;
 }
 
-void BlobsQueue::doWrite(const std::vector<Blob*>& inputs) {
-  auto& result = queue_[writer_ % queue_.size()];
-  CAFFE_ENFORCE(inputs.size() >= result.size());
-  const auto& name = name_.c_str();
-  for (auto i = 0; i < result.size(); ++i) {
-    using std::swap;
-    swap(*(inputs[i]), *(result[i]));
+size_t BlobsQueue::write(const std::vector<Blob*>* records, size_t count) {
+  const auto claimed = claim(writer_, 0, count);
+  for (size_t i = 0; i < claimed.second; ++i) {
+    const auto pos = claimed.first + i;
+    auto& slot = slots_[pos % capacity_];
+    for (auto j = 0; j < slot.blobs.size(); ++j) {
+      using std::swap;
+      swap(*(records[i][j]), *(slot.blobs[j]));
+    }
+    slot.sequence.store(pos + 1, std::memory_order_release);
+  }
+  if (claimed.second > 0) {
+    CAFFE_SDT(
+        queue_write_end,
+        name_.c_str(),
+        (void*)this,
+        reader_.load(std::memory_order_relaxed) + capacity_ -
+            writer_.load(std::memory_order_relaxed));
+    notify(writtenEpoch_, readWaiters_, readCv_);
+  }
+  return claimed.second;
+}
+
+void BlobsQueue::notify(
+    std::atomic<uint64_t>& epoch,
+    std::atomic<int>& waiters,
+    std::condition_variable& cv) {
+  ++epoch;
+  if (waiters.load() > 0) {
+    std::lock_guard<std::mutex> g(mutex_);
+    cv.notify_all();
   }
-  CAFFE_SDT(
-      queue_write_end, name, (void*)this, reader_ + queue_.size() - writer_);
-  ++writer_;
-  cv_.notify_all();
 }
 
 } // namespace caffe2
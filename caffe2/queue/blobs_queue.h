@@ -5,6 +5,8 @@
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <utility>
+#include <vector>
 
 #include "caffe2/core/blob_stats.h"
 #include "caffe2/core/logging.h"
@@ -15,7 +17,12 @@
 namespace caffe2 {
 
 // A thread-safe, bounded, blocking queue.
-// Modelled as a circular buffer.
+// Modelled as a lock-free multi-producer multi-consumer ring buffer, where
+// every slot has a sequence number that tells whether it is ready to be
+// written or read in the current round (see
+// http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue).
+// Readers and writers only take a lock to wait, when the queue is empty or
+// full.
 
 // Containing blobs are owned by the workspace.
 // On read, we swap out the underlying data for the blob passed in for blobs
@@ -39,23 +46,81 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
       float timeout_secs = 0.0f);
   bool tryWrite(const std::vector<Blob*>& inputs);
   bool blockingWrite(const std::vector<Blob*>& inputs);
+
+  // Reads up to `inputs.size()` records at once, waiting until at least one
+  // can be read. Returns the number of records read, which is 0 when the
+  // queue is closed or the read timed out.
+  size_t blockingReadBatch(
+      const std::vector<std::vector<Blob*>>& inputs,
+      float timeout_secs = 0.0f);
+  // Writes all records in order, waiting while the queue is full. Returns the
+  // number of records written, which is less than `inputs.size()` only when
+  // the queue is closed.
+  size_t blockingWriteBatch(const std::vector<std::vector<Blob*>>& inputs);
+
   void close();
   size_t getNumBlobs() const {
     return numBlobs_;
   }
 
  private:
-  bool canWrite();
-  void doWrite(const std::vector<Blob*>& inputs);
+  struct Slot {
+    // pos when the slot can be written for position pos, and pos + 1 when it
+    // can be read
+    std::atomic<uint64_t> sequence;
+    std::vector<Blob*> blobs;
+  };
+
+  // Claims up to `count` consecutive positions of `position` whose slots have
+  // sequence `position + offset`. Returns the first claimed position and the
+  // number of positions claimed, which is 0 when the queue is empty or full.
+  std::pair<uint64_t, size_t>
+  claim(std::atomic<uint64_t>& position, uint64_t offset, size_t count);
+  size_t blockingRead(
+      const std::vector<Blob*>* inputs,
+      size_t count,
+      float timeout_secs);
+  size_t blockingWrite(const std::vector<Blob*>* inputs, size_t count);
+  // Read or write up to `count` records without waiting, and return the
+  // number of records read or written
+  size_t read(const std::vector<Blob*>* records, size_t count);
+  size_t write(const std::vector<Blob*>* records, size_t count);
+  // Calls `op` until it reads or writes records, waiting on `cv` for `epoch`
+  // to change between calls. Returns 0 when the queue is closed or the wait
+  // timed out.
+  template <typename Op>
+  size_t retryUntilReady(
+      const Op& op,
+      const std::atomic<uint64_t>& epoch,
+      std::atomic<int>& waiters,
+      std::condition_variable& cv,
+      float timeout_secs);
+  // Changes `epoch` and wakes up the readers or writers waiting on `cv`
+  void notify(
+      std::atomic<uint64_t>& epoch,
+      std::atomic<int>& waiters,
+      std::condition_variable& cv);
 
   std::atomic<bool> closing_{false};
 
   size_t numBlobs_;
-  std::mutex mutex_; // protects all variables in the class.
-  std::condition_variable cv_;
-  int64_t reader_{0};
-  int64_t writer_{0};
-  std::vector<std::vector<Blob*>> queue_;
+  size_t capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  // The next positions to write and read, on separate cache lines
+  std::atomic<uint64_t> writer_{0};
+  char writerPadding_[64 - sizeof(std::atomic<uint64_t>)];
+  std::atomic<uint64_t> reader_{0};
+  char readerPadding_[64 - sizeof(std::atomic<uint64_t>)];
+
+  // Only used to wait while the queue is empty or full. The epochs change
+  // whenever records are written or read.
+  std::mutex mutex_;
+  std::condition_variable readCv_;
+  std::condition_variable writeCv_;
+  std::atomic<uint64_t> writtenEpoch_{0};
+  std::atomic<uint64_t> readEpoch_{0};
+  std::atomic<int> readWaiters_{0};
+  std::atomic<int> writeWaiters_{0};
   const std::string name_;
 
   struct QueueStats {
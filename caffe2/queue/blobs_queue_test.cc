@@ -0,0 +1,132 @@
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "caffe2/core/workspace.h"
+#include "caffe2/queue/blobs_queue.h"
+
+namespace caffe2 {
+
+namespace {
+
+std::vector<Blob*>
+makeRecord(Workspace* ws, const std::string& name, int value) {
+  auto* blob = ws->CreateBlob(name);
+  *blob->GetMutable<int>() = value;
+  return {blob};
+}
+
+} // namespace
+
+TEST(BlobsQueueTest, ReadsInOrder) {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "queue", 4, 1, true);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(queue->blockingWrite(makeRecord(&ws, "in", i)));
+  }
+  std::vector<std::vector<Blob*>> records;
+  for (int i = 0; i < 5; ++i) {
+    records.push_back({ws.CreateBlob("out_" + to_string(i))});
+  }
+  EXPECT_EQ(queue->blockingReadBatch(records), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(records[i][0]->Get<int>(), i);
+  }
+}
+
+TEST(BlobsQueueTest, TryWriteFailsWhenFull) {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "queue", 2, 1, true);
+  EXPECT_TRUE(queue->tryWrite(makeRecord(&ws, "in", 0)));
+  EXPECT_TRUE(queue->tryWrite(makeRecord(&ws, "in", 1)));
+  EXPECT_FALSE(queue->tryWrite(makeRecord(&ws, "in", 2)));
+  EXPECT_TRUE(queue->blockingRead({ws.CreateBlob("out")}));
+  EXPECT_EQ(ws.GetBlob("out")->Get<int>(), 0);
+  EXPECT_TRUE(queue->tryWrite(makeRecord(&ws, "in", 2)));
+}
+
+TEST(BlobsQueueTest, CloseWakesUpReaders) {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "queue", 2, 1, true);
+  auto* out = ws.CreateBlob("out");
+  std::thread reader([&]() { EXPECT_FALSE(queue->blockingRead({out})); });
+  queue->close();
+  reader.join();
+  EXPECT_FALSE(queue->blockingRead({out}, 0.01f));
+}
+
+TEST(BlobsQueueTest, ReadTimesOut) {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "queue", 2, 1, true);
+  EXPECT_FALSE(queue->blockingRead({ws.CreateBlob("out")}, 0.01f));
+}
+
+TEST(BlobsQueueTest, ConcurrentReadersAndWriters) {
+  const int kThreads = 4;
+  const int kRecordsPerThread = 2000;
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "queue", 8, 1, true);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      Workspace local(&ws);
+      std::vector<std::vector<Blob*>> batch(3);
+      for (int i = 0; i < 3; ++i) {
+        batch[i] = {local.CreateLocalBlob("in_" + to_string(i))};
+      }
+      for (int i = 0; i < kRecordsPerThread;) {
+        // Writes single records and batches of 3
+        if (i % 2 == 0 || i + 3 > kRecordsPerThread) {
+          *batch[0][0]->GetMutable<int>() = t * kRecordsPerThread + i;
+          ASSERT_TRUE(queue->blockingWrite(batch[0]));
+          ++i;
+        } else {
+          for (int j = 0; j < 3; ++j) {
+            *batch[j][0]->GetMutable<int>() = t * kRecordsPerThread + i + j;
+          }
+          ASSERT_EQ(queue->blockingWriteBatch(batch), 3);
+          i += 3;
+        }
+      }
+    });
+  }
+
+  std::atomic<int> numRead{0};
+  std::vector<std::atomic<int>> seen(kThreads * kRecordsPerThread);
+  for (auto& count : seen) {
+    count = 0;
+  }
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&]() {
+      Workspace local(&ws);
+      std::vector<std::vector<Blob*>> records(2);
+      for (int i = 0; i < 2; ++i) {
+        records[i] = {local.CreateLocalBlob("out_" + to_string(i))};
+      }
+      while (true) {
+        const auto read = queue->blockingReadBatch(records);
+        if (read == 0) {
+          return;
+        }
+        for (size_t i = 0; i < read; ++i) {
+          ++seen.at(records[i][0]->Get<int>());
+        }
+        if ((numRead += read) == kThreads * kRecordsPerThread) {
+          queue->close();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(numRead, kThreads * kRecordsPerThread);
+  for (const auto& count : seen) {
+    EXPECT_EQ(count, 1);
+  }
+}
+
+} // namespace caffe2
@@ -1,101 +1,84 @@
 #include "rebatching_queue.h"
-#include "caffe2/utils/smart_tensor_printer.h"
 
 namespace caffe2 {
 
-namespace {
+constexpr int64_t RebatchingQueue::kWholeBatch;
 
-// This concat function will always create a new first dimension to concat
-void concat(
+void RebatchingQueue::concat(
     CPUContext& context,
-    const std::vector<std::vector<TensorCPU>>& inputs,
+    const std::vector<Row>& rows,
     const std::vector<TensorCPU*>& outputs) {
-  CAFFE_ENFORCE(!inputs.empty());
-
-  const auto& inputZero = inputs[0];
-  const auto numTensors = inputZero.size();
-  const auto numRows = inputs.size();
-
-  // Precompute the output sizes to avoid resizing
-  std::vector<std::vector<int64_t>> outputDims(numTensors);
-
-  for (int i = 0; i < numTensors; ++i) {
-    SmartTensorPrinter::PrintTensor(inputZero.at(i));
-    outputDims[i] = inputZero.at(i).dims().vec();
-    outputDims[i].insert(outputDims[i].begin(), numRows);
+  CAFFE_ENFORCE(!rows.empty());
+
+  const auto& batchZero = *rows[0].batch;
+  const auto numTensors = batchZero.size();
+  const auto numRows = rows.size();
+  const bool wholeZero = rows[0].index == kWholeBatch;
+
+  // The rows are a whole batch in order, whose data is shared
+  bool isBatch = !wholeZero && rows[0].index == 0 &&
+      static_cast<int64_t>(numRows) == batchZero.at(0).dim(0);
+  for (int i = 1; i < numRows && isBatch; ++i) {
+    isBatch = rows[i].batch == rows[0].batch && rows[i].index == i;
   }
-
-  // Resize to the final output size
-  std::vector<void*> destinations(numTensors);
-  for (int i = 0; i < numTensors; ++i) {
-    outputs[i]->Resize(outputDims[i]);
-    destinations[i] = outputs[i]->raw_mutable_data(inputZero[i].meta());
-  }
-
-  for (int i = 0; i < numRows; ++i) {
-    CAFFE_ENFORCE_EQ(inputs[i].size(), numTensors);
-
+  if (isBatch) {
     for (int j = 0; j < numTensors; ++j) {
-      const auto& input = inputs[i][j];
-
-      CAFFE_ENFORCE(inputZero[j].meta() == input.meta());
-      CAFFE_ENFORCE_EQ(inputZero[j].itemsize(), input.itemsize());
-      CAFFE_ENFORCE_EQ(inputZero[j].ndim(), input.ndim());
-      for (int k = 0; k < input.ndim(); ++k) {
-        CAFFE_ENFORCE_EQ(input.dims()[k], inputZero[j].dims()[k]);
-      }
-
-      // Skip empty tensors
-      if (input.size() == 0) {
-        continue;
-      }
-
-      context.CopyItemsToCPU(
-          input.meta(),
-          input.size(),
-          input.raw_data() /* src */,
-          destinations[j] /* dst */
-      );
-
-      destinations[j] =
-          (char*)destinations[j] + input.size() * input.itemsize();
+      outputs[j]->Resize(batchZero[j].dims());
+      outputs[j]->ShareData(batchZero[j]);
     }
+    return;
   }
-}
 
-std::vector<std::vector<TensorCPU>> split(
-    CPUContext& context,
-    const std::vector<const TensorCPU*>& inputs) {
-  CAFFE_ENFORCE(!inputs.empty());
-
-  const auto outputSize = inputs[0]->dims().at(0);
-  std::vector<std::vector<TensorCPU>> outputs(outputSize);
-
-  for (const auto* inputPtr : inputs) {
-    CAFFE_ENFORCE(inputPtr);
-
-    const auto& input = *inputPtr;
-    const auto innerSize = input.size_from_dim(1);
-    const auto itemSize = input.meta().itemsize();
-
-    auto outputDims = input.dims().vec();
-    CAFFE_ENFORCE(!outputDims.empty());
-    outputDims.erase(outputDims.begin());
-    CAFFE_ENFORCE_EQ(input.dims().at(0), outputSize);
-
-    for (int i = 0; i < outputSize; ++i) {
-      outputs[i].push_back(Tensor(outputDims, CPU));
+  for (int j = 0; j < numTensors; ++j) {
+    const auto& tensorZero = batchZero[j];
+    // Rows of tensors with a batch dimension don't have its first dimension
+    const auto rowDimsBegin = tensorZero.dims().begin() + (wholeZero ? 0 : 1);
+    std::vector<int64_t> outputDims(rowDimsBegin, tensorZero.dims().end());
+    const auto rowSize = wholeZero ? tensorZero.size()
+                                   : tensorZero.size_from_dim(1);
+    for (const auto& row : rows) {
+      CAFFE_ENFORCE_EQ(row.batch->size(), numTensors);
+      const auto& tensor = row.batch->at(j);
+      const bool whole = row.index == kWholeBatch;
+      CAFFE_ENFORCE(tensorZero.meta() == tensor.meta());
+      CAFFE_ENFORCE_EQ(tensor.ndim() - (whole ? 0 : 1), outputDims.size());
+      for (int k = 0; k < outputDims.size(); ++k) {
+        CAFFE_ENFORCE_EQ(tensor.dims()[k + (whole ? 0 : 1)], outputDims[k]);
+      }
+    }
+    outputDims.insert(outputDims.begin(), numRows);
+
+    // Resize to the final output size
+    outputs[j]->Resize(outputDims);
+    auto* destination =
+        static_cast<char*>(outputs[j]->raw_mutable_data(tensorZero.meta()));
+    if (rowSize == 0) {
+      continue;
+    }
+    const auto rowBytes = rowSize * tensorZero.itemsize();
+
+    // Copies runs of consecutive rows of the same batch at once
+    for (int i = 0; i < numRows;) {
+      const auto& row = rows[i];
+      int runLength = 1;
+      while (row.index != kWholeBatch && i + runLength < numRows &&
+             rows[i + runLength].batch == row.batch &&
+             rows[i + runLength].index == row.index + runLength) {
+        ++runLength;
+      }
+      const auto& tensor = row.batch->at(j);
+      const auto* source = static_cast<const char*>(tensor.raw_data()) +
+          (row.index == kWholeBatch ? 0 : row.index * rowBytes);
       context.CopyItemsToCPU(
-          input.meta(),
-          innerSize,
-          (char*)input.raw_data() + i * innerSize * itemSize /* src */,
-          outputs[i].back().raw_mutable_data(input.meta()) /* dst */);
+          tensor.meta(),
+          runLength * rowSize,
+          source /* src */,
+          destination /* dst */);
+      destination += runLength * rowBytes;
+      i += runLength;
     }
   }
-
-  return outputs;
 }
-} // anonymous namespace
 
 RebatchingQueue::RebatchingQueue(size_t capacity, size_t numBlobs)
     : capacity_(capacity), numBlobs_(numBlobs), queue_(capacity) {}
@@ -112,7 +95,7 @@ bool RebatchingQueue::dequeue(
     CPUContext& context,
     size_t numElements,
     const std::vector<TensorCPU*>& outputs) {
-  std::vector<std::vector<TensorCPU>> results;
+  std::vector<Row> results;
   results.reserve(numElements);
 
   for (;;) {
@@ -158,32 +141,46 @@ bool RebatchingQueue::canWrite() const {
 bool RebatchingQueue::enqueueOne(
     CPUContext& /*context*/,
     const std::vector<const TensorCPU*>& inputs) {
-  std::vector<std::vector<TensorCPU>> splittedInputs;
-  splittedInputs.emplace_back();
-  auto& tensorVector = splittedInputs.back();
-  tensorVector.reserve(inputs.size());
+  auto batch = std::make_shared<Batch>();
+  batch->reserve(inputs.size());
   for (const auto* tensorPtr : inputs) {
-    tensorVector.push_back(tensorPtr->Clone());
+    batch->push_back(tensorPtr->Clone());
   }
 
-  return enqueue(std::move(splittedInputs));
+  return enqueue(std::move(batch), kWholeBatch);
 }
 
 bool RebatchingQueue::enqueueMany(
     CPUContext& context,
     const std::vector<const TensorCPU*>& inputs) {
   CAFFE_ENFORCE_EQ(numBlobs_, inputs.size());
+  CAFFE_ENFORCE(!inputs.empty());
+
+  // The inputs are copied once, and their rows are shared by the queue
+  CAFFE_ENFORCE(inputs[0]);
+  CAFFE_ENFORCE(!inputs[0]->dims().empty());
+  const auto numRows = inputs[0]->dim(0);
+  auto batch = std::make_shared<Batch>();
+  batch->reserve(inputs.size());
+  for (const auto* inputPtr : inputs) {
+    CAFFE_ENFORCE(inputPtr);
+    CAFFE_ENFORCE(!inputPtr->dims().empty());
+    CAFFE_ENFORCE_EQ(inputPtr->dim(0), numRows);
+    batch->emplace_back(CPU);
+    batch->back().CopyFrom(*inputPtr, &context);
+  }
 
-  std::vector<std::vector<TensorCPU>> splittedInputs;
-  splittedInputs = split(context, inputs);
-  return enqueue(std::move(splittedInputs));
+  return enqueue(std::move(batch), numRows);
 }
 
 bool RebatchingQueue::enqueue(
-    std::vector<std::vector<TensorCPU>> splittedInputs) {
-  int idx = 0;
+    std::shared_ptr<const Batch> batch,
+    int64_t numRows) {
+  const bool whole = numRows == kWholeBatch;
+  const int64_t numEntries = whole ? 1 : numRows;
+  int64_t idx = 0;
   for (;;) {
-    if (idx >= splittedInputs.size()) {
+    if (idx >= numEntries) {
       break;
     }
 
@@ -199,8 +196,9 @@ bool RebatchingQueue::enqueue(
       }
 
       do {
-        queue_[head_++ % capacity()] = std::move(splittedInputs[idx++]);
-      } while (canWrite() && idx < splittedInputs.size());
+        queue_[head_++ % capacity()] = Row{batch, whole ? kWholeBatch : idx};
+        ++idx;
+      } while (canWrite() && idx < numEntries);
     }
 
     cvEmpty_.notify_all();
@@ -17,6 +17,11 @@ namespace caffe2 {
 // atomic index + circular queue optimizations or pull something more
 // heavy-weight later
 
+// Enqueued batches are copied once, and the queue holds references to their
+// rows. Dequeue gathers the rows into the outputs with one copy per run of
+// consecutive rows of a batch, and shares the data of a batch when it dequeues
+// all of its rows in order.
+
 class RebatchingQueue {
  public:
   RebatchingQueue(size_t capacity, size_t numBlobs);
@@ -45,7 +50,25 @@ class RebatchingQueue {
   void close();
 
  private:
-  bool enqueue(std::vector<std::vector<TensorCPU>> splittedInputs);
+  using Batch = std::vector<TensorCPU>;
+
+  // A row of an enqueued batch. `index` is kWholeBatch when the tensors of
+  // the batch are a single row, without a batch dimension.
+  struct Row {
+    std::shared_ptr<const Batch> batch;
+    int64_t index;
+  };
+  static constexpr int64_t kWholeBatch = -1;
+
+  // Enqueues `numRows` rows of `batch`, or the whole batch as a single row
+  // when `numRows` is kWholeBatch
+  bool enqueue(std::shared_ptr<const Batch> batch, int64_t numRows);
+
+  // Stacks the tensors of `rows` along a new first dimension
+  static void concat(
+      CPUContext& context,
+      const std::vector<Row>& rows,
+      const std::vector<TensorCPU*>& outputs);
 
   bool canWrite() const;
   bool canRead() const;
@@ -63,6 +86,6 @@ class RebatchingQueue {
   std::condition_variable cvEmpty_;
   std::condition_variable cvOverflow_;
 
-  std::vector<std::vector<TensorCPU>> queue_;
+  std::vector<Row> queue_;
 };
 } // caffe2
@@ -0,0 +1,83 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "caffe2/queue/rebatching_queue.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Rows of 2 floats: row i of a batch starting at `first` is {i, -i}
+TensorCPU makeBatch(int64_t first, int64_t numRows) {
+  TensorCPU tensor(std::vector<int64_t>{numRows, 2}, CPU);
+  auto* data = tensor.mutable_data<float>();
+  for (int64_t i = 0; i < numRows; ++i) {
+    data[2 * i] = first + i;
+    data[2 * i + 1] = -(first + i);
+  }
+  return tensor;
+}
+
+void expectRows(const TensorCPU& tensor, int64_t first, int64_t numRows) {
+  ASSERT_EQ(tensor.dims().vec(), (std::vector<int64_t>{numRows, 2}));
+  for (int64_t i = 0; i < numRows; ++i) {
+    EXPECT_EQ(tensor.data<float>()[2 * i], first + i);
+    EXPECT_EQ(tensor.data<float>()[2 * i + 1], -(first + i));
+  }
+}
+
+} // namespace
+
+TEST(RebatchingQueueTest, RebatchesRows) {
+  CPUContext context;
+  RebatchingQueue queue(10, 1);
+  for (int64_t first = 0; first < 9; first += 3) {
+    auto batch = makeBatch(first, 3);
+    EXPECT_TRUE(queue.enqueueMany(context, {&batch}));
+    // The queue doesn't depend on the enqueued tensor
+    batch.mutable_data<float>()[0] = 100;
+  }
+
+  TensorCPU output(CPU);
+  EXPECT_TRUE(queue.dequeue(context, 2, {&output}));
+  expectRows(output, 0, 2);
+  EXPECT_TRUE(queue.dequeue(context, 4, {&output}));
+  expectRows(output, 2, 4);
+  EXPECT_TRUE(queue.dequeue(context, 3, {&output}));
+  expectRows(output, 6, 3);
+}
+
+TEST(RebatchingQueueTest, DequeuesWholeBatches) {
+  CPUContext context;
+  RebatchingQueue queue(10, 1);
+  auto batch = makeBatch(0, 4);
+  EXPECT_TRUE(queue.enqueueMany(context, {&batch}));
+  batch = makeBatch(4, 4);
+  EXPECT_TRUE(queue.enqueueMany(context, {&batch}));
+
+  TensorCPU first(CPU);
+  TensorCPU second(CPU);
+  EXPECT_TRUE(queue.dequeue(context, 4, {&first}));
+  EXPECT_TRUE(queue.dequeue(context, 4, {&second}));
+  expectRows(first, 0, 4);
+  expectRows(second, 4, 4);
+}
+
+TEST(RebatchingQueueTest, MixesSingleRowsAndBatches) {
+  CPUContext context;
+  RebatchingQueue queue(10, 1);
+  TensorCPU row(std::vector<int64_t>{2}, CPU);
+  row.mutable_data<float>()[0] = 0;
+  row.mutable_data<float>()[1] = 0;
+  EXPECT_TRUE(queue.enqueueOne(context, {&row}));
+  auto batch = makeBatch(1, 2);
+  EXPECT_TRUE(queue.enqueueMany(context, {&batch}));
+  queue.close();
+
+  TensorCPU output(CPU);
+  EXPECT_TRUE(queue.dequeue(context, 5, {&output}));
+  expectRows(output, 0, 3);
+  EXPECT_FALSE(queue.dequeue(context, 1, {&output}));
+}
+
+} // namespace caffe2
@@ -190,6 +190,90 @@ class PyTorchStreamReader {
   }
 };
 
+// Reads the same format as PyTorchStreamReader from a file that is already in
+// memory, e.g. because it has been mmap'ed. Records aren't copied out, instead
+// their payloads are returned as an offset into the buffer and a size. Given
+// a page aligned buffer, payloads are aligned to kFieldAlignment bytes.
+class PyTorchBufferReader {
+ public:
+  PyTorchBufferReader(const char* data, size_t size) : data(data), file_size(size) {
+    readAndValidateFileHeader();
+    if (file_size % kFieldAlignment != 0) {
+      throw std::runtime_error("File length is not a multiple of the alignment"
+                               " size. Is this a valid PyTorch file?");
+    }
+    readAndValidateFileFooter();
+  }
+  uint64_t getLastRecordKey() const {
+    return last_record_offset;
+  }
+  std::tuple<size_t, size_t> getRecordWithKey(uint64_t key) {
+    if (key + kFieldAlignment > file_size) {
+      throw std::runtime_error("Provided key is larger than the size of the file.");
+    }
+    if (key % kFieldAlignment != 0) {
+      throw std::runtime_error("Provided key is not divisible by the alignment size.");
+    }
+    auto tag = read64BitIntegerLittleEndian(key);
+    if (tag != RecordTags::STORAGE) {
+      throw std::runtime_error("Attempted to read a record of non-storage type");
+    }
+    auto size = read64BitIntegerLittleEndian(key + 8);
+    size_t payload_offset = key + kFieldAlignment;
+    if (size > file_size - payload_offset) {
+      throw std::runtime_error("Record extends past the end of the file. Is this"
+                               " file corrupted?");
+    }
+    return std::tuple<size_t, size_t>(payload_offset, size);
+  }
+ private:
+  const char* data;
+  size_t file_size;
+  size_t last_record_offset;
+
+  uint64_t read64BitIntegerLittleEndian(size_t offset) {
+    if (offset + 8 > file_size) {
+      std::ostringstream errmsg;
+      errmsg << "Expected to read 8 bytes at offset " << offset
+             << " but the file is only " << file_size << " bytes long";
+      throw std::runtime_error(errmsg.str());
+    }
+    uint64_t retval;
+    // TODO endian swap on platforms that need it?
+    std::memcpy(&retval, data + offset, 8);
+    return retval;
+  }
+
+  void readAndValidateFileHeader() {
+    uint64_t magic = read64BitIntegerLittleEndian(0);
+    if (magic != kFileMagicNumber) {
+      throw std::runtime_error("Magic number mismatch in PyTorch file. File may"
+                               " be corrupted or is not actually a PyTorch file.");
+    }
+    uint64_t file_format_version = read64BitIntegerLittleEndian(8);
+    if (file_format_version > kMaxSupportedFileFormatVersion) {
+      std::ostringstream errmsg;
+      errmsg << "Attempted to read a PyTorch file with version " << file_format_version
+             << " but the maximum supported version for reading is " << kMaxSupportedFileFormatVersion
+             << ". Your PyTorch installation may be too old.";
+      throw std::runtime_error(errmsg.str());
+    }
+  }
+  void readAndValidateFileFooter() {
+    size_t footer_offset = file_size - kFieldAlignment;
+    auto tag = read64BitIntegerLittleEndian(footer_offset);
+    if (tag != RecordTags::FOOTER) {
+      throw std::runtime_error("File footer has wrong record type. Is this"
+                               " file corrupted?");
+    }
+    last_record_offset = read64BitIntegerLittleEndian(footer_offset + 8);
+    if (last_record_offset > file_size) {
+      throw std::runtime_error("Offset of last record is higher than the size"
+                               " of the file! Is this file corrupted?");
+    }
+  }
+};
+
 class PyTorchStreamWriter {
  public:
   PyTorchStreamWriter(std::ostream& out_) : out(out_) {
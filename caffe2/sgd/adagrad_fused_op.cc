@@ -0,0 +1,145 @@
+#include "caffe2/sgd/adagrad_fused_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(
+    SparseAdagradFusedWithSparseLengthsSumGradient,
+    SparseAdagradFusedWithSparseLengthsSumGradientOp<float, CPUContext>);
+OPERATOR_SCHEMA(SparseAdagradFusedWithSparseLengthsSumGradient)
+    .NumInputs(6)
+    .NumOutputs(2)
+    .EnforceOneToOneInplace()
+    .SetDoc(R"DOC(
+
+Fused operator of SparseLengthsSumGradient and SparseAdagrad. Given inputs
+(param, moment, indices, grad, lr, lengths), where grad is the gradient of the
+output of SparseLengthsSum(param, indices, lengths), runs the dense AdaGrad
+update of SparseAdagrad on every row of param that indices looks up, with the
+gradient row of its segment. The gradient of every looked up row is never
+materialized. Returns (new_param, new_moment) as in SparseAdagrad.
+
+)DOC")
+    .Input(0, "param", "Parameters to be updated")
+    .Input(1, "moment", "Moment history")
+    .Input(
+        2,
+        "indices",
+        "Integer vector containing indices of the first dimension of param "
+        "for the slices that are aggregated")
+    .Input(3, "grad", "Gradient of the output of SparseLengthsSum")
+    .Input(4, "lr", "learning rate")
+    .Input(
+        5,
+        "lengths",
+        "Non negative vector with sum of elements equal to indices length")
+    .Output(0, "output_param", "Updated parameters")
+    .Output(1, "output_moment", "Updated moment")
+    .Arg("epsilon", "Default 1e-5");
+
+REGISTER_CPU_OPERATOR(
+    SparseAdagradFusedWithSparseLengthsMeanGradient,
+    SparseAdagradFusedWithSparseLengthsSumGradientOp<
+        float,
+        CPUContext,
+        /*is_mean=*/true>);
+OPERATOR_SCHEMA(SparseAdagradFusedWithSparseLengthsMeanGradient)
+    .NumInputs(6)
+    .NumOutputs(2)
+    .EnforceOneToOneInplace()
+    .SetDoc(R"DOC(
+
+Same as SparseAdagradFusedWithSparseLengthsSumGradient, for the gradient of
+SparseLengthsMean: the gradient row of a segment is divided by its length.
+
+)DOC")
+    .Input(0, "param", "Parameters to be updated")
+    .Input(1, "moment", "Moment history")
+    .Input(
+        2,
+        "indices",
+        "Integer vector containing indices of the first dimension of param "
+        "for the slices that are aggregated")
+    .Input(3, "grad", "Gradient of the output of SparseLengthsMean")
+    .Input(4, "lr", "learning rate")
+    .Input(
+        5,
+        "lengths",
+        "Non negative vector with sum of elements equal to indices length")
+    .Output(0, "output_param", "Updated parameters")
+    .Output(1, "output_moment", "Updated moment")
+    .Arg("epsilon", "Default 1e-5");
+
+REGISTER_CPU_OPERATOR(
+    RowWiseSparseAdagradFusedWithSparseLengthsSumGradient,
+    RowWiseSparseAdagradFusedWithSparseLengthsSumGradientOp<float, CPUContext>);
+OPERATOR_SCHEMA(RowWiseSparseAdagradFusedWithSparseLengthsSumGradient)
+    .NumInputs(6)
+    .NumOutputs(2)
+    .EnforceOneToOneInplace()
+    .SetDoc(R"DOC(
+
+Fused operator of SparseLengthsSumGradient and RowWiseSparseAdagrad. Given
+inputs (param, moment, indices, grad, lr, lengths), where grad is the gradient
+of the output of SparseLengthsSum(param, indices, lengths), runs the row-wise
+AdaGrad update of RowWiseSparseAdagrad on every row of param that indices
+looks up, with the gradient row of its segment. moment has one value per row
+of param. The gradient of every looked up row is never materialized.
+
+)DOC")
+    .Input(0, "param", "Parameters to be updated")
+    .Input(1, "moment", "Moment history")
+    .Input(
+        2,
+        "indices",
+        "Integer vector containing indices of the first dimension of param "
+        "for the slices that are aggregated")
+    .Input(3, "grad", "Gradient of the output of SparseLengthsSum")
+    .Input(4, "lr", "learning rate")
+    .Input(
+        5,
+        "lengths",
+        "Non negative vector with sum of elements equal to indices length")
+    .Output(0, "output_param", "Updated parameters")
+    .Output(1, "output_moment", "Updated moment")
+    .Arg("epsilon", "Default 1e-5");
+
+REGISTER_CPU_OPERATOR(
+    RowWiseSparseAdagradFusedWithSparseLengthsMeanGradient,
+    RowWiseSparseAdagradFusedWithSparseLengthsSumGradientOp<
+        float,
+        CPUContext,
+        /*is_mean=*/true>);
+OPERATOR_SCHEMA(RowWiseSparseAdagradFusedWithSparseLengthsMeanGradient)
+    .NumInputs(6)
+    .NumOutputs(2)
+    .EnforceOneToOneInplace()
+    .SetDoc(R"DOC(
+
+Same as RowWiseSparseAdagradFusedWithSparseLengthsSumGradient, for the
+gradient of SparseLengthsMean: the gradient row of a segment is divided by its
+length.
+
+)DOC")
+    .Input(0, "param", "Parameters to be updated")
+    .Input(1, "moment", "Moment history")
+    .Input(
+        2,
+        "indices",
+        "Integer vector containing indices of the first dimension of param "
+        "for the slices that are aggregated")
+    .Input(3, "grad", "Gradient of the output of SparseLengthsMean")
+    .Input(4, "lr", "learning rate")
+    .Input(
+        5,
+        "lengths",
+        "Non negative vector with sum of elements equal to indices length")
+    .Output(0, "output_param", "Updated parameters")
+    .Output(1, "output_moment", "Updated moment")
+    .Arg("epsilon", "Default 1e-5");
+
+SHOULD_NOT_DO_GRADIENT(SparseAdagradFusedWithSparseLengthsSumGradient);
+SHOULD_NOT_DO_GRADIENT(SparseAdagradFusedWithSparseLengthsMeanGradient);
+SHOULD_NOT_DO_GRADIENT(RowWiseSparseAdagradFusedWithSparseLengthsSumGradient);
+SHOULD_NOT_DO_GRADIENT(RowWiseSparseAdagradFusedWithSparseLengthsMeanGradient);
+
+} // namespace caffe2
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "caffe2/core/operator.h"
+#include "caffe2/perfkernels/adagrad.h"
+
+namespace caffe2 {
+
+// Applies the gradient of SparseLengths{Sum,Mean} to the looked up rows of
+// param with (row-wise) Adagrad, without materializing the gradient of every
+// looked up row. GRAD is the gradient of the output of the lookup, one row
+// per segment of LENGTHS; every index of a segment gets the row of its
+// segment (divided by the segment length for the mean).
+template <typename T, class Context, bool is_mean = false>
+class SparseAdagradFusedWithSparseLengthsSumGradientOp final
+    : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  SparseAdagradFusedWithSparseLengthsSumGradientOp(
+      const OperatorDef& operator_def,
+      Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)) {}
+
+  bool RunOnDevice() override {
+    // Enforce shapes
+    CAFFE_ENFORCE_EQ(Input(PARAM).size(), Input(MOMENT_1).size());
+    CAFFE_ENFORCE_EQ(Input(LR).size(), 1);
+    CAFFE_ENFORCE_EQ(Input(LENGTHS).ndim(), 1, "LENGTHS must be a vector");
+    CAFFE_ENFORCE_EQ(Input(INDICES).ndim(), 1, "INDICES must be a vector");
+    CAFFE_ENFORCE_GT(Input(GRAD).ndim(), 0, "GRAD must be at least 1-D");
+    CAFFE_ENFORCE_EQ(Input(GRAD).dim(0), Input(LENGTHS).dim(0));
+    CAFFE_ENFORCE_EQ(
+        Input(PARAM).size_from_dim(1), Input(GRAD).size_from_dim(1));
+
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
+        this, Input(INDICES));
+  }
+
+  template <typename SIndex>
+  bool DoRunWithType() {
+    const auto* lr = Input(LR).template data<T>();
+    const auto* indices = Input(INDICES).template data<SIndex>();
+    const auto* lengths = Input(LENGTHS).template data<int>();
+    const auto* gradIn = Input(GRAD).template data<T>();
+    auto* paramOut = Output(OUTPUT_PARAM)->template mutable_data<T>();
+    auto* momentOut = Output(OUTPUT_MOMENT_1)->template mutable_data<T>();
+
+    const auto n = Input(INDICES).size();
+    const auto numSegments = Input(LENGTHS).size();
+    const auto numRows = Input(PARAM).size() ? Input(PARAM).dim(0) : 0;
+    const auto block_size = Input(GRAD).size_from_dim(1);
+
+    if (is_mean) {
+      grad_buffer_.resize(block_size);
+    }
+    int64_t dataIndex = 0;
+    for (int64_t segment = 0; segment < numSegments; ++segment) {
+      const auto length = lengths[segment];
+      CAFFE_ENFORCE_LE(
+          dataIndex + length, n, "LENGTHS and INDICES sizes mismatch");
+      const T* g = gradIn + segment * block_size;
+      if (is_mean && length > 0) {
+        for (int64_t j = 0; j < block_size; ++j) {
+          grad_buffer_[j] = g[j] / length;
+        }
+        g = grad_buffer_.data();
+      }
+      for (const auto end = dataIndex + length; dataIndex < end; ++dataIndex) {
+        const auto idx = indices[dataIndex];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < numRows,
+            "Index ",
+            dataIndex,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            numRows);
+        T* w = paramOut + idx * block_size;
+        T* h = momentOut + idx * block_size;
+        adagrad_update(block_size, w, g, h, w, h, epsilon_, 1.0f, lr[0]);
+      }
+    }
+    CAFFE_ENFORCE_EQ(dataIndex, n, "LENGTHS and INDICES sizes mismatch");
+    return true;
+  }
+
+ protected:
+  T epsilon_;
+  std::vector<T> grad_buffer_;
+  INPUT_TAGS(PARAM, MOMENT_1, INDICES, GRAD, LR, LENGTHS);
+  OUTPUT_TAGS(OUTPUT_PARAM, OUTPUT_MOMENT_1);
+};
+
+// Row-wise variant of SparseAdagradFusedWithSparseLengthsSumGradientOp: the
+// moment has one value per row of param, as in RowWiseSparseAdagrad.
+template <typename T, class Context, bool is_mean = false>
+class RowWiseSparseAdagradFusedWithSparseLengthsSumGradientOp final
+    : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  RowWiseSparseAdagradFusedWithSparseLengthsSumGradientOp(
+      const OperatorDef& operator_def,
+      Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)) {}
+
+  bool RunOnDevice() override {
+    // Enforce shapes
+    CAFFE_ENFORCE_GT(Input(PARAM).ndim(), 0, "PARAM must be at least 1-D");
+    CAFFE_ENFORCE_EQ(Input(PARAM).dim(0), Input(MOMENT_1).size());
+    CAFFE_ENFORCE_EQ(Input(LR).size(), 1);
+    CAFFE_ENFORCE_EQ(Input(LENGTHS).ndim(), 1, "LENGTHS must be a vector");
+    CAFFE_ENFORCE_EQ(Input(INDICES).ndim(), 1, "INDICES must be a vector");
+    CAFFE_ENFORCE_GT(Input(GRAD).ndim(), 0, "GRAD must be at least 1-D");
+    CAFFE_ENFORCE_EQ(Input(GRAD).dim(0), Input(LENGTHS).dim(0));
+    CAFFE_ENFORCE_EQ(
+        Input(PARAM).size_from_dim(1), Input(GRAD).size_from_dim(1));
+
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
+        this, Input(INDICES));
+  }
+
+  template <typename SIndex>
+  bool DoRunWithType() {
+    const auto* lr = Input(LR).template data<T>();
+    const auto* indices = Input(INDICES).template data<SIndex>();
+    const auto* lengths = Input(LENGTHS).template data<int>();
+    const auto* gradIn = Input(GRAD).template data<T>();
+    auto* paramOut = Output(OUTPUT_PARAM)->template mutable_data<T>();
+    auto* momentOut = Output(OUTPUT_MOMENT_1)->template mutable_data<T>();
+
+    const auto n = Input(INDICES).size();
+    const auto numSegments = Input(LENGTHS).size();
+    const auto numRows = Input(PARAM).dim(0);
+    const auto block_size = Input(GRAD).size_from_dim(1);
+
+    if (is_mean) {
+      grad_buffer_.resize(block_size);
+    }
+    int64_t dataIndex = 0;
+    for (int64_t segment = 0; segment < numSegments; ++segment) {
+      const auto length = lengths[segment];
+      CAFFE_ENFORCE_LE(
+          dataIndex + length, n, "LENGTHS and INDICES sizes mismatch");
+      const T* g = gradIn + segment * block_size;
+      if (is_mean && length > 0) {
+        for (int64_t j = 0; j < block_size; ++j) {
+          grad_buffer_[j] = g[j] / length;
+        }
+        g = grad_buffer_.data();
+      }
+      for (const auto end = dataIndex + length; dataIndex < end; ++dataIndex) {
+        const auto idx = indices[dataIndex];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < numRows,
+            "Index ",
+            dataIndex,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            numRows);
+        rowwise_adagrad_update(
+            block_size,
+            paramOut + idx * block_size,
+            g,
+            momentOut + idx,
+            epsilon_,
+            lr[0]);
+      }
+    }
+    CAFFE_ENFORCE_EQ(dataIndex, n, "LENGTHS and INDICES sizes mismatch");
+    return true;
+  }
+
+ protected:
+  T epsilon_;
+  std::vector<T> grad_buffer_;
+  INPUT_TAGS(PARAM, MOMENT_1, INDICES, GRAD, LR, LENGTHS);
+  OUTPUT_TAGS(OUTPUT_PARAM, OUTPUT_MOMENT_1);
+};
+
+} // namespace caffe2
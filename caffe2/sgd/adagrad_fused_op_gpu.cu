@@ -0,0 +1,232 @@
+#include <cub/block/block_reduce.cuh>
+#include <cub/device/device_scan.cuh>
+#include "caffe2/core/common_gpu.h"
+#include "caffe2/core/context_gpu.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/utils/GpuDefs.cuh"
+
+namespace caffe2 {
+
+namespace {
+
+// Segments updated by a block of the warp per segment kernel
+constexpr int kSegmentsPerBlock = 4;
+
+// Updates the rows looked up by a segment with the gradient row of the
+// segment, one warp per segment. As in SparseAdagrad, rows that are looked up
+// by several segments are updated without synchronization.
+template <typename SIndex, bool is_mean>
+__global__ void SparseAdagradFusedWithSparseLengthsSumGradientKernel(
+    const int num_segments,
+    const int block_size,
+    const float epsilon,
+    float* param,
+    float* param_mom,
+    const SIndex* indices,
+    const int* prefix_sum_lengths,
+    const float* grad,
+    const float* lr) {
+  const int segment = blockIdx.x * blockDim.y + threadIdx.y;
+  if (segment >= num_segments) {
+    return;
+  }
+
+  const int start = segment == 0 ? 0 : prefix_sum_lengths[segment - 1];
+  const int end = prefix_sum_lengths[segment];
+  const float scale = is_mean && end - start > 1 ? 1.0f / (end - start) : 1.0f;
+  const float LR = lr[0];
+
+  for (int j = threadIdx.x; j < block_size; j += blockDim.x) {
+    const float gj = grad[static_cast<int64_t>(segment) * block_size + j] *
+        scale;
+    for (int line = start; line < end; ++line) {
+      const int64_t paramIdx =
+          static_cast<int64_t>(indices[line]) * block_size + j;
+      const float mom_new = gj * gj + param_mom[paramIdx];
+      param_mom[paramIdx] = mom_new;
+      param[paramIdx] += LR * gj / (sqrtf(mom_new) + epsilon);
+    }
+  }
+}
+
+// Row-wise variant, one block per segment: the average of the squares of the
+// gradient row is the same for every row that the segment looks up, so it is
+// reduced once per segment.
+template <typename SIndex, bool is_mean>
+__global__ void RowWiseSparseAdagradFusedWithSparseLengthsSumGradientKernel(
+    const int num_segments,
+    const int block_size,
+    const float epsilon,
+    float* param,
+    float* param_mom,
+    const SIndex* indices,
+    const int* prefix_sum_lengths,
+    const float* grad,
+    const float* lr) {
+  typedef cub::BlockReduce<float, CAFFE_CUDA_NUM_THREADS> BlockReduce;
+  __shared__ BlockReduce::TempStorage temp_storage;
+  __shared__ float step;
+
+  // in case gridDim is smaller than num_segments
+  for (int segment = blockIdx.x; segment < num_segments;
+       segment += gridDim.x) {
+    const int start = segment == 0 ? 0 : prefix_sum_lengths[segment - 1];
+    const int end = prefix_sum_lengths[segment];
+    const float scale =
+        is_mean && end - start > 1 ? 1.0f / (end - start) : 1.0f;
+    const float* g = grad + static_cast<int64_t>(segment) * block_size;
+
+    float sum_squares = 0.0f;
+    for (int j = threadIdx.x; j < block_size; j += blockDim.x) {
+      const float gj = g[j] * scale;
+      sum_squares += gj * gj;
+    }
+    // only valid in thread 0
+    const float row_sum_squares_avg =
+        BlockReduce(temp_storage).Sum(sum_squares) / block_size;
+
+    for (int line = start; line < end; ++line) {
+      const SIndex index = indices[line];
+      if (threadIdx.x == 0) {
+        param_mom[index] += row_sum_squares_avg;
+        step = lr[0] / (sqrtf(param_mom[index]) + epsilon);
+      }
+      __syncthreads();
+      float* w = param + static_cast<int64_t>(index) * block_size;
+      for (int j = threadIdx.x; j < block_size; j += blockDim.x) {
+        w[j] += g[j] * scale * step;
+      }
+      __syncthreads();
+    }
+    // temp_storage is reused by the next segment
+    __syncthreads();
+  }
+}
+
+} // namespace
+
+// CUDA versions of SparseAdagradFusedWithSparseLengths{Sum,Mean}Gradient and
+// of their row-wise variants, which update the param and the moment in place
+template <bool rowwise, bool is_mean = false>
+class CUDASparseAdagradFusedWithSparseLengthsSumGradientOp final
+    : public Operator<CUDAContext> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  CUDASparseAdagradFusedWithSparseLengthsSumGradientOp(
+      const OperatorDef& operator_def,
+      Workspace* ws)
+      : Operator<CUDAContext>(operator_def, ws),
+        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)) {}
+
+  bool RunOnDevice() override {
+    // Enforce shapes
+    CAFFE_ENFORCE_GT(Input(PARAM).ndim(), 0, "PARAM must be at least 1-D");
+    if (rowwise) {
+      CAFFE_ENFORCE_EQ(Input(PARAM).dim(0), Input(MOMENT_1).size());
+    } else {
+      CAFFE_ENFORCE_EQ(Input(PARAM).size(), Input(MOMENT_1).size());
+    }
+    CAFFE_ENFORCE_EQ(Input(LR).size(), 1);
+    CAFFE_ENFORCE_EQ(Input(LENGTHS).ndim(), 1, "LENGTHS must be a vector");
+    CAFFE_ENFORCE_EQ(Input(INDICES).ndim(), 1, "INDICES must be a vector");
+    CAFFE_ENFORCE_GT(Input(GRAD).ndim(), 0, "GRAD must be at least 1-D");
+    CAFFE_ENFORCE_EQ(Input(GRAD).dim(0), Input(LENGTHS).dim(0));
+    CAFFE_ENFORCE_EQ(
+        Input(PARAM).size_from_dim(1), Input(GRAD).size_from_dim(1));
+
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
+        this, Input(INDICES));
+  }
+
+  template <typename SIndex>
+  bool DoRunWithType() {
+    const auto& lengthsInput = Input(LENGTHS);
+    const int num_segments = lengthsInput.size();
+    const int block_size = Input(GRAD).size_from_dim(1);
+    if (num_segments == 0 || block_size == 0 || Input(INDICES).size() == 0) {
+      // nothing to update, not even launching the kernel
+      return true;
+    }
+
+    // Ends of the segments in indices
+    prefix_sum_lengths_.ResizeLike(lengthsInput);
+    size_t temp_storage_bytes = 0;
+    cub::DeviceScan::InclusiveSum(
+        nullptr,
+        temp_storage_bytes,
+        lengthsInput.template data<int>(),
+        prefix_sum_lengths_.template mutable_data<int>(),
+        num_segments,
+        context_.cuda_stream());
+    scan_buffer_.Resize((temp_storage_bytes + sizeof(int)) / sizeof(int));
+    cub::DeviceScan::InclusiveSum(
+        static_cast<void*>(scan_buffer_.template mutable_data<int>()),
+        temp_storage_bytes,
+        lengthsInput.template data<int>(),
+        prefix_sum_lengths_.template mutable_data<int>(),
+        num_segments,
+        context_.cuda_stream());
+
+    if (rowwise) {
+      RowWiseSparseAdagradFusedWithSparseLengthsSumGradientKernel<
+          SIndex,
+          is_mean>
+          <<<std::min(num_segments, CAFFE_MAXIMUM_NUM_BLOCKS),
+             CAFFE_CUDA_NUM_THREADS,
+             0,
+             context_.cuda_stream()>>>(
+              num_segments,
+              block_size,
+              epsilon_,
+              Output(OUTPUT_PARAM)->template mutable_data<float>(),
+              Output(OUTPUT_MOMENT_1)->template mutable_data<float>(),
+              Input(INDICES).template data<SIndex>(),
+              prefix_sum_lengths_.template data<int>(),
+              Input(GRAD).template data<float>(),
+              Input(LR).template data<float>());
+    } else {
+      const dim3 block(kWarpSize, kSegmentsPerBlock);
+      SparseAdagradFusedWithSparseLengthsSumGradientKernel<SIndex, is_mean>
+          <<<(num_segments + kSegmentsPerBlock - 1) / kSegmentsPerBlock,
+             block,
+             0,
+             context_.cuda_stream()>>>(
+              num_segments,
+              block_size,
+              epsilon_,
+              Output(OUTPUT_PARAM)->template mutable_data<float>(),
+              Output(OUTPUT_MOMENT_1)->template mutable_data<float>(),
+              Input(INDICES).template data<SIndex>(),
+              prefix_sum_lengths_.template data<int>(),
+              Input(GRAD).template data<float>(),
+              Input(LR).template data<float>());
+    }
+    return true;
+  }
+
+ protected:
+  float epsilon_;
+  Tensor prefix_sum_lengths_{CUDA};
+  Tensor scan_buffer_{CUDA};
+  INPUT_TAGS(PARAM, MOMENT_1, INDICES, GRAD, LR, LENGTHS);
+  OUTPUT_TAGS(OUTPUT_PARAM, OUTPUT_MOMENT_1);
+};
+
+REGISTER_CUDA_OPERATOR(
+    SparseAdagradFusedWithSparseLengthsSumGradient,
+    CUDASparseAdagradFusedWithSparseLengthsSumGradientOp<false>);
+REGISTER_CUDA_OPERATOR(
+    SparseAdagradFusedWithSparseLengthsMeanGradient,
+    CUDASparseAdagradFusedWithSparseLengthsSumGradientOp<
+        false,
+        /*is_mean=*/true>);
+REGISTER_CUDA_OPERATOR(
+    RowWiseSparseAdagradFusedWithSparseLengthsSumGradient,
+    CUDASparseAdagradFusedWithSparseLengthsSumGradientOp<true>);
+REGISTER_CUDA_OPERATOR(
+    RowWiseSparseAdagradFusedWithSparseLengthsMeanGradient,
+    CUDASparseAdagradFusedWithSparseLengthsSumGradientOp<
+        true,
+        /*is_mean=*/true>);
+
+} // namespace caffe2
@@ -0,0 +1,210 @@
+#include "caffe2/sgd/multi_tensor_update_op.h"
+#include "caffe2/sgd/adagrad_op.h"
+#include "caffe2/sgd/adam_op.h"
+#include "caffe2/sgd/momentum_sgd_op.h"
+
+namespace caffe2 {
+
+template <>
+void multi_momentum_sgd_update<CPUContext>(
+    const std::vector<MomentumSGDTensors>& tensors,
+    float momentum,
+    bool nesterov,
+    Tensor* /*scratch*/,
+    CPUContext* context) {
+  for (const auto& t : tensors) {
+    momentum_sgd_update<CPUContext>(
+        t.size,
+        t.grad,
+        t.moment,
+        t.grad_out,
+        t.moment_out,
+        t.lr,
+        momentum,
+        nesterov,
+        t.param,
+        context);
+  }
+}
+
+template <>
+void multi_adagrad_update<CPUContext>(
+    const std::vector<AdagradTensors>& tensors,
+    float epsilon,
+    float decay,
+    Tensor* /*scratch*/,
+    CPUContext* context) {
+  for (const auto& t : tensors) {
+    adagrad_update<CPUContext>(
+        t.size,
+        t.param,
+        t.grad,
+        t.moment,
+        t.param_out,
+        t.moment_out,
+        epsilon,
+        decay,
+        t.lr,
+        context);
+  }
+}
+
+template <>
+void multi_adam_update<CPUContext>(
+    const std::vector<AdamTensors>& tensors,
+    float beta1,
+    float beta2,
+    float epsilon,
+    Tensor* /*scratch*/,
+    CPUContext* context) {
+  for (const auto& t : tensors) {
+    adam_compute<CPUContext>(
+        t.size,
+        t.param,
+        t.grad,
+        t.moment1,
+        t.moment2,
+        t.param_out,
+        t.moment1_out,
+        t.moment2_out,
+        beta1,
+        beta2,
+        epsilon,
+        t.correction,
+        t.lr,
+        context);
+  }
+}
+
+template <>
+void multi_lars<CPUContext>(
+    const std::vector<LarsTensors>& tensors,
+    float offset,
+    float lr_min,
+    Tensor* /*scratch*/,
+    CPUContext* /*context*/) {
+  for (const auto& t : tensors) {
+    float X_sumsq = 0;
+    float dX_sumsq = 0;
+    for (int64_t i = 0; i < t.size; ++i) {
+      X_sumsq += t.param[i] * t.param[i];
+      dX_sumsq += t.grad[i] * t.grad[i];
+    }
+    const float X_norm = std::sqrt(X_sumsq);
+    const float dX_norm = std::sqrt(dX_sumsq);
+    float val = 1.0;
+    if (X_norm > 0) {
+      val = (*t.trust) / (dX_norm / X_norm + (*t.wd) + offset);
+    }
+    *t.lr_rescaled = fmaxf(fminf(val, *t.lr_max), lr_min);
+  }
+}
+
+namespace {
+// The (input, output) pairs of a variadic op that repeats the in-place pairs
+// of its single parameter op for every parameter
+std::function<bool(int, int)> RepeatedInplace(
+    int numInputs,
+    int numOutputs,
+    std::vector<std::pair<int, int>> inplace) {
+  return [=](int in, int out) {
+    const int param = in / numInputs;
+    for (const auto& p : inplace) {
+      if (in == param * numInputs + p.first &&
+          out == param * numOutputs + p.second) {
+        return true;
+      }
+    }
+    return false;
+  };
+}
+} // namespace
+
+REGISTER_CPU_OPERATOR(
+    MultiMomentumSGDUpdate,
+    MultiMomentumSGDUpdateOp<CPUContext>);
+OPERATOR_SCHEMA(MultiMomentumSGDUpdate)
+    .NumInputs(4, INT_MAX)
+    .NumOutputs(3, INT_MAX)
+    .NumInputsOutputs([](int in, int out) {
+      return in % 4 == 0 && out == in / 4 * 3;
+    })
+    .AllowInplace(RepeatedInplace(4, 3, {{0, 0}, {1, 1}, {3, 2}}))
+    .SetDoc(R"DOC(
+
+Performs MomentumSGDUpdate for a list of parameters. The inputs are
+(grad, m, lr, param) and the outputs (grad, momentum, parameter) of
+MomentumSGDUpdate, repeated for every parameter. Every parameter may have its
+own learning rate. On the GPU all the parameters are updated by a single
+kernel launch.
+
+)DOC")
+    .Arg("momentum", "Momentum hyperparameter.")
+    .Arg("nesterov", "(boolean) Whether to use Nesterov Accelerated Gradient.");
+SHOULD_NOT_DO_GRADIENT(MultiMomentumSGDUpdate);
+
+REGISTER_CPU_OPERATOR(MultiAdagrad, MultiAdagradOp<CPUContext>);
+OPERATOR_SCHEMA(MultiAdagrad)
+    .NumInputs(4, INT_MAX)
+    .NumOutputs(2, INT_MAX)
+    .NumInputsOutputs([](int in, int out) {
+      return in % 4 == 0 && out == in / 4 * 2;
+    })
+    .AllowInplace(RepeatedInplace(4, 2, {{0, 0}, {1, 1}}))
+    .SetDoc(R"DOC(
+
+Performs Adagrad for a list of parameters. The inputs are
+(param, moment, grad, lr) and the outputs (param, moment) of Adagrad, repeated
+for every parameter. Every parameter may have its own learning rate. On the GPU
+all the parameters are updated by a single kernel launch.
+
+)DOC")
+    .Arg("epsilon", "Default 1e-5")
+    .Arg(
+        "decay",
+        "Default 1. If it is in (0, 1), the gradient square sum "
+        "is decayed by this factor.");
+SHOULD_NOT_DO_GRADIENT(MultiAdagrad);
+
+REGISTER_CPU_OPERATOR(MultiAdam, MultiAdamOp<CPUContext>);
+OPERATOR_SCHEMA(MultiAdam)
+    .NumInputs(6, INT_MAX)
+    .NumOutputs(3, INT_MAX)
+    .NumInputsOutputs([](int in, int out) {
+      return in % 6 == 0 && out == in / 6 * 3;
+    })
+    .AllowInplace(RepeatedInplace(6, 3, {{0, 0}, {1, 1}, {2, 2}}))
+    .SetDoc(R"DOC(
+
+Performs Adam for a list of parameters. The inputs are
+(param, moment_1, moment_2, grad, lr, iter) and the outputs
+(param, moment_1, moment_2) of Adam, repeated for every parameter. The iter
+inputs live on the CPU. On the GPU all the parameters are updated by a single
+kernel launch.
+
+)DOC")
+    .Arg("beta1", "Default 0.9")
+    .Arg("beta2", "Default 0.999")
+    .Arg("epsilon", "Default 1e-5");
+SHOULD_NOT_DO_GRADIENT(MultiAdam);
+
+REGISTER_CPU_OPERATOR(MultiLars, MultiLarsOp<CPUContext>);
+OPERATOR_SCHEMA(MultiLars)
+    .NumInputs(5, INT_MAX)
+    .NumOutputs(1, INT_MAX)
+    .NumInputsOutputs([](int in, int out) {
+      return in % 5 == 0 && out == in / 5;
+    })
+    .SetDoc(R"DOC(
+
+Computes the Lars rescaled learning rate of a list of parameters. The inputs
+are (X, dX, wd, trust, lr_max) of Lars, repeated for every parameter, and there
+is one lr_rescaled output per parameter. On the GPU the norms of all the
+parameters are computed by a single kernel launch.
+
+)DOC")
+    .Arg("offset", "rescaling offset parameter")
+    .Arg("lr_min", "minimum learning rate for clipping");
+SHOULD_NOT_DO_GRADIENT(MultiLars);
+
+} // namespace caffe2
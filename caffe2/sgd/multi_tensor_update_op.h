@@ -0,0 +1,281 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "caffe2/core/operator.h"
+
+namespace caffe2 {
+
+// Variadic versions of the dense optimizer ops, which update a list of
+// parameters in a single operator: the inputs and outputs of the single
+// parameter op are repeated for every parameter, and the parameters may have
+// different learning rates (e.g. rescaled by Lars). On the GPU every op is one
+// kernel launch over chunks of all the tensors, so that the cost of a training
+// step doesn't grow with the number of parameter blobs. The scratch tensor
+// holds the device copy of the per-tensor arguments of the kernels.
+
+// The tensors of one parameter of MultiMomentumSGDUpdate
+struct MomentumSGDTensors {
+  int64_t size;
+  const float* grad;
+  const float* moment;
+  const float* lr;
+  float* grad_out;
+  float* moment_out;
+  float* param;
+};
+
+// The tensors of one parameter of MultiAdagrad
+struct AdagradTensors {
+  int64_t size;
+  const float* param;
+  const float* moment;
+  const float* grad;
+  const float* lr;
+  float* param_out;
+  float* moment_out;
+};
+
+// The tensors of one parameter of MultiAdam, and its bias correction
+struct AdamTensors {
+  int64_t size;
+  const float* param;
+  const float* moment1;
+  const float* moment2;
+  const float* grad;
+  const float* lr;
+  float* param_out;
+  float* moment1_out;
+  float* moment2_out;
+  float correction;
+};
+
+// The tensors of one parameter of MultiLars
+struct LarsTensors {
+  int64_t size;
+  const float* param;
+  const float* grad;
+  const float* wd;
+  const float* trust;
+  const float* lr_max;
+  float* lr_rescaled;
+};
+
+template <class Context>
+void multi_momentum_sgd_update(
+    const std::vector<MomentumSGDTensors>& tensors,
+    float momentum,
+    bool nesterov,
+    Tensor* scratch,
+    Context* context);
+
+template <class Context>
+void multi_adagrad_update(
+    const std::vector<AdagradTensors>& tensors,
+    float epsilon,
+    float decay,
+    Tensor* scratch,
+    Context* context);
+
+template <class Context>
+void multi_adam_update(
+    const std::vector<AdamTensors>& tensors,
+    float beta1,
+    float beta2,
+    float epsilon,
+    Tensor* scratch,
+    Context* context);
+
+template <class Context>
+void multi_lars(
+    const std::vector<LarsTensors>& tensors,
+    float offset,
+    float lr_min,
+    Tensor* scratch,
+    Context* context);
+
+template <class Context>
+class MultiMomentumSGDUpdateOp final : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  MultiMomentumSGDUpdateOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        momentum_(this->template GetSingleArgument<float>("momentum", 0.0)),
+        nesterov_(this->template GetSingleArgument<int>("nesterov", 0)) {}
+
+  bool RunOnDevice() override {
+    CAFFE_ENFORCE_EQ(InputSize() % 4, 0);
+    const int numParams = InputSize() / 4;
+    CAFFE_ENFORCE_EQ(OutputSize(), 3 * numParams);
+    std::vector<MomentumSGDTensors> tensors(numParams);
+    for (int i = 0; i < numParams; ++i) {
+      const auto& grad = Input(4 * i);
+      const auto& moment = Input(4 * i + 1);
+      const auto& lr = Input(4 * i + 2);
+      CAFFE_ENFORCE_EQ(lr.size(), 1);
+      CAFFE_ENFORCE_EQ(grad.size(), moment.size());
+      CAFFE_ENFORCE_EQ(grad.size(), Input(4 * i + 3).size());
+      Output(3 * i)->ResizeLike(grad);
+      Output(3 * i + 1)->ResizeLike(moment);
+      tensors[i] = {grad.size(),
+                    grad.template data<float>(),
+                    moment.template data<float>(),
+                    lr.template data<float>(),
+                    Output(3 * i)->template mutable_data<float>(),
+                    Output(3 * i + 1)->template mutable_data<float>(),
+                    Output(3 * i + 2)->template mutable_data<float>()};
+    }
+    multi_momentum_sgd_update<Context>(
+        tensors, momentum_, nesterov_, &scratch_, &context_);
+    return true;
+  }
+
+ protected:
+  float momentum_;
+  bool nesterov_;
+  Tensor scratch_{Context::GetDeviceType()};
+};
+
+template <class Context>
+class MultiAdagradOp final : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  MultiAdagradOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)),
+        decay_(this->template GetSingleArgument<float>("decay", 1.0f)) {}
+
+  bool RunOnDevice() override {
+    CAFFE_ENFORCE_EQ(InputSize() % 4, 0);
+    const int numParams = InputSize() / 4;
+    CAFFE_ENFORCE_EQ(OutputSize(), 2 * numParams);
+    std::vector<AdagradTensors> tensors(numParams);
+    for (int i = 0; i < numParams; ++i) {
+      const auto& param = Input(4 * i);
+      const auto& moment = Input(4 * i + 1);
+      const auto& grad = Input(4 * i + 2);
+      const auto& lr = Input(4 * i + 3);
+      CAFFE_ENFORCE_EQ(lr.size(), 1);
+      CAFFE_ENFORCE_EQ(grad.size(), moment.size());
+      CAFFE_ENFORCE_EQ(grad.size(), param.size());
+      Output(2 * i)->ResizeLike(param);
+      Output(2 * i + 1)->ResizeLike(moment);
+      tensors[i] = {grad.size(),
+                    param.template data<float>(),
+                    moment.template data<float>(),
+                    grad.template data<float>(),
+                    lr.template data<float>(),
+                    Output(2 * i)->template mutable_data<float>(),
+                    Output(2 * i + 1)->template mutable_data<float>()};
+    }
+    multi_adagrad_update<Context>(
+        tensors, epsilon_, decay_, &scratch_, &context_);
+    return true;
+  }
+
+ protected:
+  float epsilon_;
+  float decay_;
+  Tensor scratch_{Context::GetDeviceType()};
+};
+
+template <class Context>
+class MultiAdamOp final : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  MultiAdamOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        beta1_(this->template GetSingleArgument<float>("beta1", 0.9f)),
+        beta2_(this->template GetSingleArgument<float>("beta2", 0.999f)),
+        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)) {}
+
+  bool RunOnDevice() override {
+    CAFFE_ENFORCE_EQ(InputSize() % 6, 0);
+    const int numParams = InputSize() / 6;
+    CAFFE_ENFORCE_EQ(OutputSize(), 3 * numParams);
+    std::vector<AdamTensors> tensors(numParams);
+    for (int i = 0; i < numParams; ++i) {
+      const auto& param = Input(6 * i);
+      const auto& moment1 = Input(6 * i + 1);
+      const auto& moment2 = Input(6 * i + 2);
+      const auto& grad = Input(6 * i + 3);
+      const auto& lr = Input(6 * i + 4);
+      // Iter live on the CPU
+      CAFFE_ENFORCE(OperatorBase::InputIsTensorType(6 * i + 5, CPU));
+      CAFFE_ENFORCE_EQ(lr.size(), 1);
+      CAFFE_ENFORCE_EQ(grad.size(), param.size());
+      CAFFE_ENFORCE_EQ(grad.size(), moment1.size());
+      CAFFE_ENFORCE_EQ(grad.size(), moment2.size());
+      Output(3 * i)->ResizeLike(param);
+      Output(3 * i + 1)->ResizeLike(moment1);
+      Output(3 * i + 2)->ResizeLike(moment2);
+      const auto iter = OperatorBase::Input<Tensor>(6 * i + 5, CPU)
+                            .template data<int64_t>()[0];
+      const auto t = iter + 1;
+      tensors[i] = {grad.size(),
+                    param.template data<float>(),
+                    moment1.template data<float>(),
+                    moment2.template data<float>(),
+                    grad.template data<float>(),
+                    lr.template data<float>(),
+                    Output(3 * i)->template mutable_data<float>(),
+                    Output(3 * i + 1)->template mutable_data<float>(),
+                    Output(3 * i + 2)->template mutable_data<float>(),
+                    std::sqrt(1.0f - std::pow(beta2_, t)) /
+                        (1.0f - std::pow(beta1_, t))};
+    }
+    multi_adam_update<Context>(
+        tensors, beta1_, beta2_, epsilon_, &scratch_, &context_);
+    return true;
+  }
+
+ protected:
+  float beta1_;
+  float beta2_;
+  float epsilon_;
+  Tensor scratch_{Context::GetDeviceType()};
+};
+
+template <class Context>
+class MultiLarsOp final : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  MultiLarsOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        offset_(this->template GetSingleArgument<float>("offset", 0.5)),
+        lr_min_(this->template GetSingleArgument<float>("lr_min", 0.02)) {}
+
+  bool RunOnDevice() override {
+    CAFFE_ENFORCE_EQ(InputSize() % 5, 0);
+    const int numParams = InputSize() / 5;
+    CAFFE_ENFORCE_EQ(OutputSize(), numParams);
+    CAFFE_ENFORCE_GE(offset_, 0);
+    CAFFE_ENFORCE_GE(lr_min_, 0);
+    std::vector<LarsTensors> tensors(numParams);
+    for (int i = 0; i < numParams; ++i) {
+      const auto& param = Input(5 * i);
+      const auto& grad = Input(5 * i + 1);
+      CAFFE_ENFORCE(
+          grad.size() == param.size(),
+          "Gradient size doesn't match parameter size.");
+      Output(i)->Resize(vector<int64_t>{1});
+      tensors[i] = {param.size(),
+                    param.template data<float>(),
+                    grad.template data<float>(),
+                    Input(5 * i + 2).template data<float>(),
+                    Input(5 * i + 3).template data<float>(),
+                    Input(5 * i + 4).template data<float>(),
+                    Output(i)->template mutable_data<float>()};
+    }
+    multi_lars<Context>(tensors, offset_, lr_min_, &scratch_, &context_);
+    return true;
+  }
+
+ protected:
+  float offset_;
+  float lr_min_;
+  Tensor scratch_{Context::GetDeviceType()};
+};
+
+} // namespace caffe2
@@ -0,0 +1,271 @@
+#include <cub/block/block_reduce.cuh>
+#include "caffe2/core/common_gpu.h"
+#include "caffe2/core/context_gpu.h"
+#include "caffe2/sgd/multi_tensor_update_op.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Every block of the kernels processes one chunk of one of the tensors
+constexpr int64_t kChunkSize = 16 * CAFFE_CUDA_NUM_THREADS;
+
+struct TensorChunk {
+  int tensor;
+  int64_t begin;
+  int64_t end;
+};
+
+// Copies the per-tensor arguments and the chunks of all the tensors to the
+// device, followed by numFloats floats of uninitialized space, and returns the
+// number of chunks
+template <typename T>
+int CopyTensorsAndChunks(
+    const std::vector<T>& tensors,
+    int64_t numFloats,
+    Tensor* scratch,
+    CUDAContext* context,
+    const T** deviceTensors,
+    const TensorChunk** deviceChunks,
+    float** deviceFloats) {
+  std::vector<TensorChunk> chunks;
+  for (int i = 0; i < tensors.size(); ++i) {
+    for (int64_t begin = 0; begin < tensors[i].size; begin += kChunkSize) {
+      chunks.push_back(
+          {i, begin, std::min(begin + kChunkSize, tensors[i].size)});
+    }
+  }
+  const size_t tensorBytes = tensors.size() * sizeof(T);
+  const size_t chunkBytes = chunks.size() * sizeof(TensorChunk);
+  std::vector<char> host(tensorBytes + chunkBytes);
+  std::memcpy(host.data(), tensors.data(), tensorBytes);
+  std::memcpy(host.data() + tensorBytes, chunks.data(), chunkBytes);
+  scratch->Resize(host.size() + numFloats * sizeof(float));
+  char* device = scratch->template mutable_data<char>();
+  context->CopyBytesFromCPU(host.size(), host.data(), device);
+  *deviceTensors = reinterpret_cast<const T*>(device);
+  *deviceChunks = reinterpret_cast<const TensorChunk*>(device + tensorBytes);
+  if (deviceFloats) {
+    *deviceFloats = reinterpret_cast<float*>(device + host.size());
+  }
+  return chunks.size();
+}
+
+__global__ void MultiMomentumSGDKernel(
+    const MomentumSGDTensors* tensors,
+    const TensorChunk* chunks,
+    const float momentum,
+    const bool nesterov) {
+  const TensorChunk chunk = chunks[blockIdx.x];
+  const MomentumSGDTensors t = tensors[chunk.tensor];
+  const float LR = t.lr[0];
+  for (int64_t i = chunk.begin + threadIdx.x; i < chunk.end;
+       i += blockDim.x) {
+    if (!nesterov) {
+      const float adjusted_gradient = LR * t.grad[i] + momentum * t.moment[i];
+      t.moment_out[i] = adjusted_gradient;
+      t.grad_out[i] = adjusted_gradient;
+      t.param[i] -= adjusted_gradient;
+    } else {
+      const float mi = t.moment[i];
+      const float mi_new = momentum * mi + LR * t.grad[i];
+      const float ng = (1 + momentum) * mi_new - momentum * mi;
+      t.moment_out[i] = mi_new;
+      t.grad_out[i] = ng;
+      t.param[i] -= ng;
+    }
+  }
+}
+
+__global__ void MultiAdagradKernel(
+    const AdagradTensors* tensors,
+    const TensorChunk* chunks,
+    const float epsilon,
+    const float decay) {
+  const TensorChunk chunk = chunks[blockIdx.x];
+  const AdagradTensors t = tensors[chunk.tensor];
+  const float LR = t.lr[0];
+  for (int64_t i = chunk.begin + threadIdx.x; i < chunk.end;
+       i += blockDim.x) {
+    const float gi = t.grad[i];
+    const float hi = t.moment_out[i] = decay * t.moment[i] + gi * gi;
+    t.param_out[i] = t.param[i] + LR * gi / (sqrtf(hi) + epsilon);
+  }
+}
+
+__global__ void MultiAdamKernel(
+    const AdamTensors* tensors,
+    const TensorChunk* chunks,
+    const float beta1,
+    const float beta2,
+    const float eps_hat) {
+  const TensorChunk chunk = chunks[blockIdx.x];
+  const AdamTensors t = tensors[chunk.tensor];
+  const float LR = t.lr[0];
+  for (int64_t i = chunk.begin + threadIdx.x; i < chunk.end;
+       i += blockDim.x) {
+    const float gi = t.grad[i];
+    const float mi = t.moment1_out[i] = t.moment1[i] * beta1 + gi * (1 - beta1);
+    const float vi = t.moment2_out[i] =
+        t.moment2[i] * beta2 + gi * gi * (1 - beta2);
+    t.param_out[i] =
+        t.param[i] + LR * t.correction * mi / (sqrtf(vi) + eps_hat);
+  }
+}
+
+// Adds the sums of squares of the chunks of the parameters and the gradients
+// to sumsq[2 * tensor] and sumsq[2 * tensor + 1]
+__global__ void MultiLarsSumSquaresKernel(
+    const LarsTensors* tensors,
+    const TensorChunk* chunks,
+    float* sumsq) {
+  typedef cub::BlockReduce<float, CAFFE_CUDA_NUM_THREADS> BlockReduce;
+  __shared__ BlockReduce::TempStorage temp_storage;
+  const TensorChunk chunk = chunks[blockIdx.x];
+  const LarsTensors t = tensors[chunk.tensor];
+  float X_sumsq = 0;
+  float dX_sumsq = 0;
+  for (int64_t i = chunk.begin + threadIdx.x; i < chunk.end;
+       i += blockDim.x) {
+    X_sumsq += t.param[i] * t.param[i];
+    dX_sumsq += t.grad[i] * t.grad[i];
+  }
+  X_sumsq = BlockReduce(temp_storage).Sum(X_sumsq);
+  __syncthreads();
+  dX_sumsq = BlockReduce(temp_storage).Sum(dX_sumsq);
+  if (threadIdx.x == 0) {
+    atomicAdd(&sumsq[2 * chunk.tensor], X_sumsq);
+    atomicAdd(&sumsq[2 * chunk.tensor + 1], dX_sumsq);
+  }
+}
+
+__global__ void MultiLarsLearningRateKernel(
+    const int numTensors,
+    const LarsTensors* tensors,
+    const float* sumsq,
+    const float offset,
+    const float lr_min) {
+  CUDA_1D_KERNEL_LOOP(i, numTensors) {
+    const LarsTensors t = tensors[i];
+    const float X_norm = sqrtf(sumsq[2 * i]);
+    const float dX_norm = sqrtf(sumsq[2 * i + 1]);
+    float val = 1.0;
+    if (X_norm > 0) {
+      val = (*t.trust) / (dX_norm / X_norm + (*t.wd) + offset);
+    }
+    *t.lr_rescaled = fmaxf(fminf(val, *t.lr_max), lr_min);
+  }
+}
+
+} // namespace
+
+template <>
+void multi_momentum_sgd_update<CUDAContext>(
+    const std::vector<MomentumSGDTensors>& tensors,
+    float momentum,
+    bool nesterov,
+    Tensor* scratch,
+    CUDAContext* context) {
+  const MomentumSGDTensors* deviceTensors;
+  const TensorChunk* deviceChunks;
+  const int numChunks = CopyTensorsAndChunks(
+      tensors, 0, scratch, context, &deviceTensors, &deviceChunks, nullptr);
+  if (numChunks == 0) {
+    return;
+  }
+  MultiMomentumSGDKernel<<<
+      numChunks,
+      CAFFE_CUDA_NUM_THREADS,
+      0,
+      context->cuda_stream()>>>(
+      deviceTensors, deviceChunks, momentum, nesterov);
+}
+
+template <>
+void multi_adagrad_update<CUDAContext>(
+    const std::vector<AdagradTensors>& tensors,
+    float epsilon,
+    float decay,
+    Tensor* scratch,
+    CUDAContext* context) {
+  const AdagradTensors* deviceTensors;
+  const TensorChunk* deviceChunks;
+  const int numChunks = CopyTensorsAndChunks(
+      tensors, 0, scratch, context, &deviceTensors, &deviceChunks, nullptr);
+  if (numChunks == 0) {
+    return;
+  }
+  MultiAdagradKernel<<<
+      numChunks,
+      CAFFE_CUDA_NUM_THREADS,
+      0,
+      context->cuda_stream()>>>(deviceTensors, deviceChunks, epsilon, decay);
+}
+
+template <>
+void multi_adam_update<CUDAContext>(
+    const std::vector<AdamTensors>& tensors,
+    float beta1,
+    float beta2,
+    float epsilon,
+    Tensor* scratch,
+    CUDAContext* context) {
+  const AdamTensors* deviceTensors;
+  const TensorChunk* deviceChunks;
+  const int numChunks = CopyTensorsAndChunks(
+      tensors, 0, scratch, context, &deviceTensors, &deviceChunks, nullptr);
+  if (numChunks == 0) {
+    return;
+  }
+  MultiAdamKernel<<<
+      numChunks,
+      CAFFE_CUDA_NUM_THREADS,
+      0,
+      context->cuda_stream()>>>(
+      deviceTensors, deviceChunks, beta1, beta2, epsilon);
+}
+
+template <>
+void multi_lars<CUDAContext>(
+    const std::vector<LarsTensors>& tensors,
+    float offset,
+    float lr_min,
+    Tensor* scratch,
+    CUDAContext* context) {
+  const int numTensors = tensors.size();
+  const LarsTensors* deviceTensors;
+  const TensorChunk* deviceChunks;
+  float* sumsq;
+  const int numChunks = CopyTensorsAndChunks(
+      tensors,
+      2 * numTensors,
+      scratch,
+      context,
+      &deviceTensors,
+      &deviceChunks,
+      &sumsq);
+  CUDA_ENFORCE(cudaMemsetAsync(
+      sumsq, 0, 2 * numTensors * sizeof(float), context->cuda_stream()));
+  if (numChunks > 0) {
+    MultiLarsSumSquaresKernel<<<
+        numChunks,
+        CAFFE_CUDA_NUM_THREADS,
+        0,
+        context->cuda_stream()>>>(deviceTensors, deviceChunks, sumsq);
+  }
+  MultiLarsLearningRateKernel<<<
+      CAFFE_GET_BLOCKS(numTensors),
+      CAFFE_CUDA_NUM_THREADS,
+      0,
+      context->cuda_stream()>>>(
+      numTensors, deviceTensors, sumsq, offset, lr_min);
+}
+
+REGISTER_CUDA_OPERATOR(
+    MultiMomentumSGDUpdate,
+    MultiMomentumSGDUpdateOp<CUDAContext>);
+REGISTER_CUDA_OPERATOR(MultiAdagrad, MultiAdagradOp<CUDAContext>);
+REGISTER_CUDA_OPERATOR(MultiAdam, MultiAdamOp<CUDAContext>);
+REGISTER_CUDA_OPERATOR(MultiLars, MultiLarsOp<CUDAContext>);
+
+} // namespace caffe2
@@ -0,0 +1,86 @@
+#include <zstd.h>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/operators/text_file_reader_utils.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Streams the decompressed text of a zstd compressed file, for
+// CreateTextFileReader with compression="zstd".
+class ZstdFileReader : public StringProvider {
+ public:
+  explicit ZstdFileReader(const std::string& path)
+      : fileReader_(path),
+        stream_(ZSTD_createDStream()),
+        outSize_(ZSTD_DStreamOutSize()),
+        out_(new char[outSize_]) {
+    CAFFE_ENFORCE(stream_, "Failed to create a zstd stream");
+    reset();
+  }
+
+  ~ZstdFileReader() override {
+    ZSTD_freeDStream(stream_);
+  }
+
+  void operator()(CharRange& range) override {
+    while (true) {
+      // A full output buffer means that the stream may hold more output
+      // for the input read so far
+      if (in_.pos == in_.size && !outputFull_) {
+        CharRange compressed;
+        fileReader_(compressed);
+        if (compressed.start == nullptr) {
+          CAFFE_ENFORCE_EQ(frameRemaining_, 0, "Truncated zstd file");
+          range.start = nullptr;
+          range.end = nullptr;
+          return;
+        }
+        in_.src = compressed.start;
+        in_.size = compressed.end - compressed.start;
+        in_.pos = 0;
+      }
+      ZSTD_outBuffer out = {out_.get(), outSize_, 0};
+      frameRemaining_ = ZSTD_decompressStream(stream_, &out, &in_);
+      CAFFE_ENFORCE(
+          !ZSTD_isError(frameRemaining_),
+          "Error decompressing zstd file: ",
+          ZSTD_getErrorName(frameRemaining_));
+      outputFull_ = out.pos == out.size;
+      if (out.pos > 0) {
+        range.start = out_.get();
+        range.end = out_.get() + out.pos;
+        return;
+      }
+    }
+  }
+
+  void reset() override {
+    fileReader_.reset();
+    const auto ret = ZSTD_initDStream(stream_);
+    CAFFE_ENFORCE(
+        !ZSTD_isError(ret),
+        "Error initializing zstd stream: ",
+        ZSTD_getErrorName(ret));
+    in_ = {nullptr, 0, 0};
+    frameRemaining_ = 0;
+    outputFull_ = false;
+  }
+
+ private:
+  FileReader fileReader_;
+  ZSTD_DStream* stream_;
+  const size_t outSize_;
+  std::unique_ptr<char[]> out_;
+  ZSTD_inBuffer in_;
+  // 0 when the last frame was decoded completely
+  size_t frameRemaining_;
+  bool outputFull_;
+};
+
+} // namespace
+
+C10_REGISTER_CLASS(TextFileProviderRegistry, zstd, ZstdFileReader);
+
+} // namespace caffe2
@@ -54,6 +54,71 @@ MATH_UTILS_DECL bool IsAGeZeroAndALtB(const int a, const int b) {
   return static_cast<unsigned int>(a) < static_cast<unsigned>(b);
 }
 
+// Mean and sum of squared deviations from the mean (m2) of count values, as
+// updated by Welford's single pass algorithm. The variance is m2 / count.
+template <typename T>
+struct WelfordData {
+  T mean;
+  T m2;
+  T count;
+};
+
+template <typename T>
+MATH_UTILS_DECL void WelfordUpdate(const T x, WelfordData<T>* data) {
+  data->count += T(1);
+  const T delta = x - data->mean;
+  data->mean += delta / data->count;
+  data->m2 += delta * (x - data->mean);
+}
+
+// Statistics of the union of two disjoint sets of values (Chan et al.).
+template <typename T>
+MATH_UTILS_DECL WelfordData<T> WelfordCombine(
+    const WelfordData<T>& a,
+    const WelfordData<T>& b) {
+  if (a.count == T(0)) {
+    return b;
+  }
+  if (b.count == T(0)) {
+    return a;
+  }
+  const T count = a.count + b.count;
+  const T delta = b.mean - a.mean;
+  const T b_ratio = b.count / count;
+  return WelfordData<T>{a.mean + delta * b_ratio,
+                        a.m2 + b.m2 + delta * delta * a.count * b_ratio,
+                        count};
+}
+
+// Welford statistics of N contiguous values in a single pass. The values are
+// spread over kLanes independent accumulators, so that the updates vectorize,
+// which are combined at the end.
+template <typename T>
+inline WelfordData<T> WelfordMoments(const T* X, const int64_t N) {
+  constexpr int kLanes = 8;
+  T mean[kLanes] = {0};
+  T m2[kLanes] = {0};
+  const int64_t steps = N / kLanes;
+  for (int64_t i = 0; i < steps; ++i) {
+    const T scale = T(1) / static_cast<T>(i + 1);
+    const T* x = X + i * kLanes;
+    for (int j = 0; j < kLanes; ++j) {
+      const T delta = x[j] - mean[j];
+      mean[j] += delta * scale;
+      m2[j] += delta * (x[j] - mean[j]);
+    }
+  }
+  WelfordData<T> result{T(0), T(0), T(0)};
+  for (int j = 0; j < kLanes; ++j) {
+    result = WelfordCombine(
+        result, WelfordData<T>{mean[j], m2[j], static_cast<T>(steps)});
+  }
+  for (int64_t i = steps * kLanes; i < N; ++i) {
+    WelfordUpdate(X[i], &result);
+  }
+  return result;
+}
+
 // Increase the index digits by one based on dims.
 CAFFE2_API void IncreaseIndexInDims(const int n, const int* dims, int* index);
 
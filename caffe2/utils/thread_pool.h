@@ -1,13 +1,19 @@
 #ifndef CAFFE2_UTILS_THREAD_POOL_H_
 #define CAFFE2_UTILS_THREAD_POOL_H_
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
 #include <utility>
+#include <vector>
 
+#include "caffe2/core/logging.h"
 #include "caffe2/core/numa.h"
 #include "caffe2/utils/thread_name.h"
 
@@ -177,6 +183,323 @@ class CAFFE2_API TaskThreadPool : public TaskThreadPoolBase {
   }
 };
 
+/**
+ * Deque of Chase and Lev ("Dynamic Circular Work-Stealing Deque", SPAA 2005),
+ * with the memory orders of Le et al. ("Correct and Efficient Work-Stealing
+ * for Weak Memory Models", PPoPP 2013). Only the thread that owns the deque
+ * may push and pop, at the bottom; any thread may steal, at the top. None of
+ * the operations take a lock.
+ *
+ * T must be trivially copyable, e.g. a pointer.
+ */
+template <typename T>
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(int64_t capacity = 256)
+      : top_(0), bottom_(0), array_(nullptr) {
+    CAFFE_ENFORCE(
+        capacity > 0 && (capacity & (capacity - 1)) == 0,
+        "Capacity must be a power of two: ",
+        capacity);
+    arrays_.emplace_back(new Array(capacity));
+    array_.store(arrays_.back().get(), std::memory_order_relaxed);
+  }
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  /// @brief Adds an item at the bottom, only called by the owner.
+  void push(T item) {
+    auto bottom = bottom_.load(std::memory_order_relaxed);
+    auto top = top_.load(std::memory_order_acquire);
+    auto* array = array_.load(std::memory_order_relaxed);
+    if (bottom - top > array->capacity - 1) {
+      array = grow(array, top, bottom);
+    }
+    array->put(bottom, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  /// @brief Takes the item at the bottom, only called by the owner. Returns
+  /// false if the deque is empty.
+  bool pop(T* item) {
+    auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    auto* array = array_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return false;
+    }
+    *item = array->get(bottom);
+    if (top < bottom) {
+      return true;
+    }
+    // Last item, which a thief may be stealing at the same time
+    bool taken = top_.compare_exchange_strong(
+        top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return taken;
+  }
+
+  /// @brief Takes the item at the top. Returns false if the deque is empty,
+  /// or if another thread took the item first.
+  bool steal(T* item) {
+    auto top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return false;
+    }
+    auto* array = array_.load(std::memory_order_acquire);
+    *item = array->get(top);
+    return top_.compare_exchange_strong(
+        top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+  }
+
+  bool empty() const {
+    auto top = top_.load(std::memory_order_acquire);
+    auto bottom = bottom_.load(std::memory_order_acquire);
+    return top >= bottom;
+  }
+
+ private:
+  struct Array {
+    explicit Array(int64_t capacity)
+        : capacity(capacity), items(new std::atomic<T>[capacity]) {}
+
+    T get(int64_t index) const {
+      return items[index & (capacity - 1)].load(std::memory_order_relaxed);
+    }
+
+    void put(int64_t index, T item) {
+      items[index & (capacity - 1)].store(item, std::memory_order_relaxed);
+    }
+
+    const int64_t capacity;
+    std::unique_ptr<std::atomic<T>[]> items;
+  };
+
+  Array* grow(Array* array, int64_t top, int64_t bottom) {
+    arrays_.emplace_back(new Array(array->capacity * 2));
+    auto* grown = arrays_.back().get();
+    for (auto index = top; index < bottom; ++index) {
+      grown->put(index, array->get(index));
+    }
+    array_.store(grown, std::memory_order_release);
+    return grown;
+  }
+
+  // The top is written by thieves and the bottom by the owner, so they are
+  // kept on separate cache lines
+  std::atomic<int64_t> top_;
+  char padding_[64 - sizeof(std::atomic<int64_t>)];
+  std::atomic<int64_t> bottom_;
+  std::atomic<Array*> array_;
+  // Replaced arrays are only freed with the deque, since thieves may still
+  // be reading from them
+  std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+/**
+ * Thread pool in which every worker has its own deque of tasks, instead of
+ * all workers sharing a single locked queue.
+ *
+ * Tasks run from a worker of the pool are pushed to the deque of that worker,
+ * which runs the most recent one next (LIFO), likely using data that is still
+ * in its cache. Idle workers steal the oldest tasks of other workers (FIFO).
+ * Tasks run from other threads are added to a shared queue. Workers only take
+ * a lock to go to sleep once there are no tasks left, and are only notified
+ * while some of them sleep.
+ *
+ * Workers are bound to the NUMA node of the pool, and only steal tasks of the
+ * same pool, so that tasks stay on that node.
+ */
+class CAFFE2_API WorkStealingTaskThreadPool : public TaskThreadPoolBase {
+ private:
+  using Task = std::function<void()>*;
+
+  // Rounds of looking for a task before going to sleep
+  static constexpr int kSpinRounds = 16;
+
+  struct Worker {
+    const WorkStealingTaskThreadPool* pool;
+    std::size_t index;
+  };
+
+  std::vector<std::unique_ptr<WorkStealingDeque<Task>>> deques_;
+  std::vector<std::thread> threads_;
+  int numa_node_id_;
+  std::atomic<bool> running_;
+  std::atomic<std::size_t> available_;
+
+  // Tasks run from threads that are not workers of the pool
+  std::mutex injected_mutex_;
+  std::deque<Task> injected_;
+  std::atomic<std::size_t> injected_size_;
+
+  // Guards sleeping workers
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::atomic<int> sleeping_;
+
+ public:
+  explicit WorkStealingTaskThreadPool(
+      std::size_t pool_size,
+      int numa_node_id = -1)
+      : numa_node_id_(numa_node_id),
+        running_(true),
+        available_(pool_size),
+        injected_size_(0),
+        sleeping_(0) {
+    for (std::size_t i = 0; i < pool_size; ++i) {
+      deques_.emplace_back(new WorkStealingDeque<Task>());
+    }
+    for (std::size_t i = 0; i < pool_size; ++i) {
+      threads_.emplace_back(&WorkStealingTaskThreadPool::main_loop, this, i);
+    }
+  }
+
+  ~WorkStealingTaskThreadPool() override {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      running_ = false;
+      condition_.notify_all();
+    }
+
+    try {
+      for (auto& t : threads_) {
+        t.join();
+      }
+    } catch (const std::exception&) {
+    }
+
+    // Tasks that did not run
+    Task task;
+    for (auto& deque : deques_) {
+      while (deque->pop(&task)) {
+        delete task;
+      }
+    }
+    for (auto* injected_task : injected_) {
+      delete injected_task;
+    }
+  }
+
+  size_t size() const override {
+    return threads_.size();
+  }
+
+  /**
+   * The number of available (i.e. idle) threads in this thread pool.
+   */
+  size_t numAvailable() const override {
+    return available_;
+  }
+
+  void run(const std::function<void()>& func) override {
+    const auto& worker = currentWorker();
+    if (worker.pool == this) {
+      deques_[worker.index]->push(new std::function<void()>(func));
+    } else {
+      std::lock_guard<std::mutex> lock(injected_mutex_);
+      injected_.push_back(new std::function<void()>(func));
+      injected_size_ = injected_.size();
+    }
+
+    // Pairs with the fence of a worker going to sleep, which either sees the
+    // new task or is seen here
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      condition_.notify_one();
+    }
+  }
+
+ private:
+  static Worker& currentWorker() {
+    static thread_local Worker worker{nullptr, 0};
+    return worker;
+  }
+
+  bool findTask(std::size_t index, Task* task) {
+    if (deques_[index]->pop(task)) {
+      return true;
+    }
+    if (injected_size_.load(std::memory_order_acquire) > 0) {
+      std::lock_guard<std::mutex> lock(injected_mutex_);
+      if (!injected_.empty()) {
+        *task = injected_.front();
+        injected_.pop_front();
+        injected_size_ = injected_.size();
+        return true;
+      }
+    }
+    for (std::size_t i = 1; i < deques_.size(); ++i) {
+      if (deques_[(index + i) % deques_.size()]->steal(task)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool hasTasks() const {
+    if (injected_size_.load(std::memory_order_acquire) > 0) {
+      return true;
+    }
+    for (const auto& deque : deques_) {
+      if (!deque->empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void waitForTasks() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleeping_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (running_ && !hasTasks()) {
+      condition_.wait(lock);
+    }
+    sleeping_.fetch_sub(1);
+  }
+
+  /// @brief Entry point for pool threads.
+  void main_loop(std::size_t index) {
+    setThreadName("CaffeTaskThread");
+    NUMABind(numa_node_id_);
+    currentWorker() = Worker{this, index};
+
+    int idle_rounds = 0;
+    Task task;
+    while (running_) {
+      if (!findTask(index, &task)) {
+        if (++idle_rounds < kSpinRounds) {
+          std::this_thread::yield();
+        } else {
+          waitForTasks();
+          idle_rounds = 0;
+        }
+        continue;
+      }
+      idle_rounds = 0;
+
+      // Decrement count, indicating thread is no longer available.
+      --available_;
+      try {
+        (*task)();
+      } catch (const std::exception&) {
+      }
+      delete task;
+      // Increment count, indicating thread is available.
+      ++available_;
+    }
+  }
+};
+
 } // namespace caffe2
 
 #endif // CAFFE2_UTILS_THREAD_POOL_H_
@@ -0,0 +1,174 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread> // NOLINT
+#include <vector>
+
+#include "caffe2/utils/thread_pool.h"
+#include <gtest/gtest.h>
+
+namespace caffe2 {
+
+namespace {
+// Counts down to zero, and lets threads wait until it reaches zero
+class Latch {
+ public:
+  explicit Latch(int count) : count_(count) {}
+
+  void countDown() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--count_ == 0) {
+      done_.notify_all();
+    }
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return count_ == 0; });
+  }
+
+ private:
+  int count_;
+  std::mutex mutex_;
+  std::condition_variable done_;
+};
+} // namespace
+
+TEST(WorkStealingDequeTest, PopIsLastInFirstOutAndStealIsFirstInFirstOut) {
+  WorkStealingDeque<int> deque(2);
+  for (int i = 0; i < 10; ++i) {
+    deque.push(i);
+  }
+  int item;
+  EXPECT_TRUE(deque.pop(&item));
+  EXPECT_EQ(9, item);
+  EXPECT_TRUE(deque.steal(&item));
+  EXPECT_EQ(0, item);
+  EXPECT_TRUE(deque.steal(&item));
+  EXPECT_EQ(1, item);
+  for (int i = 8; i >= 2; --i) {
+    EXPECT_TRUE(deque.pop(&item));
+    EXPECT_EQ(i, item);
+  }
+  EXPECT_TRUE(deque.empty());
+  EXPECT_FALSE(deque.pop(&item));
+  EXPECT_FALSE(deque.steal(&item));
+}
+
+TEST(WorkStealingDequeTest, EveryItemIsTakenOnce) {
+  const int kItems = 100000;
+  const int kThieves = 3;
+  WorkStealingDeque<int> deque;
+  std::vector<std::vector<int>> taken(kThieves + 1);
+  std::atomic<int> taken_num(0);
+
+  std::vector<std::thread> thieves;
+  for (int t = 1; t <= kThieves; ++t) {
+    thieves.emplace_back([&, t] {
+      int item;
+      while (taken_num < kItems) {
+        if (deque.steal(&item)) {
+          taken[t].push_back(item);
+          ++taken_num;
+        }
+      }
+    });
+  }
+  int item;
+  for (int i = 0; i < kItems; ++i) {
+    deque.push(i);
+    if (i % 3 == 0 && deque.pop(&item)) {
+      taken[0].push_back(item);
+      ++taken_num;
+    }
+  }
+  while (deque.pop(&item)) {
+    taken[0].push_back(item);
+    ++taken_num;
+  }
+  for (auto& thief : thieves) {
+    thief.join();
+  }
+
+  std::vector<int> counts(kItems, 0);
+  for (const auto& items : taken) {
+    for (auto i : items) {
+      ++counts[i];
+    }
+  }
+  for (int i = 0; i < kItems; ++i) {
+    EXPECT_EQ(1, counts[i]) << "item " << i;
+  }
+}
+
+TEST(WorkStealingTaskThreadPoolTest, RunsAllTasks) {
+  const int kTasks = 10000;
+  std::atomic<int> ran(0);
+  Latch latch(kTasks);
+  WorkStealingTaskThreadPool pool(4);
+  EXPECT_EQ(4, pool.size());
+  for (int i = 0; i < kTasks; ++i) {
+    pool.run([&] {
+      ++ran;
+      latch.countDown();
+    });
+  }
+  latch.wait();
+  EXPECT_EQ(kTasks, ran);
+}
+
+TEST(WorkStealingTaskThreadPoolTest, TasksOfWorkersRunLastInFirstOut) {
+  std::vector<int> order;
+  Latch latch(1);
+  WorkStealingTaskThreadPool pool(1);
+  pool.run([&] {
+    for (int i = 0; i < 10; ++i) {
+      pool.run([&, i] {
+        order.push_back(i);
+        if (order.size() == 10) {
+          latch.countDown();
+        }
+      });
+    }
+  });
+  latch.wait();
+  EXPECT_EQ(std::vector<int>({9, 8, 7, 6, 5, 4, 3, 2, 1, 0}), order);
+}
+
+TEST(WorkStealingTaskThreadPoolTest, IdleWorkersStealTasks) {
+  const int kTasks = 64;
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  Latch latch(kTasks);
+  WorkStealingTaskThreadPool pool(4);
+  // All tasks are pushed to the deque of the worker running this one
+  pool.run([&] {
+    for (int i = 0; i < kTasks; ++i) {
+      pool.run([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          threads.insert(std::this_thread::get_id());
+        }
+        latch.countDown();
+      });
+    }
+  });
+  latch.wait();
+  EXPECT_GT(threads.size(), 1);
+}
+
+TEST(WorkStealingTaskThreadPoolTest, WakesSleepingWorkers) {
+  WorkStealingTaskThreadPool pool(2);
+  for (int i = 0; i < 5; ++i) {
+    // Lets the workers go to sleep
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    Latch latch(1);
+    pool.run([&] { latch.countDown(); });
+    latch.wait();
+  }
+}
+
+} // namespace caffe2
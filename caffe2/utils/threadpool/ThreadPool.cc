@@ -4,6 +4,14 @@
 
 #include <cpuinfo.h>
 
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
 C10_DEFINE_bool(
     caffe2_threadpool_force_inline,
     false,
@@ -15,12 +23,67 @@ C10_DEFINE_int(caffe2_threadpool_android_cap, true, "");
 // Whether or not threadpool caps apply to iOS
 C10_DEFINE_int(caffe2_threadpool_ios_cap, true, "");
 
+C10_DEFINE_int(
+    caffe2_threadpool_spin_us,
+    5000,
+    "How long the threads busy-wait for work before sleeping, in "
+    "microseconds. Idle workers shorten it by themselves");
+
+C10_DEFINE_bool(
+    caffe2_threadpool_pin_big_cores,
+    false,
+    "Pin the worker threads of the default thread pool to the processors "
+    "with the highest maximum frequency (the big cores of big.LITTLE)");
+
 namespace caffe2 {
 
 // Default smallest amount of work that will be partitioned between
 // multiple threads; the runtime value is configurable
 constexpr size_t kDefaultMinWorkSize = 1;
 
+// The number of chunks per thread the range of a run is split into; more
+// chunks balance the load better, at the cost of more atomic operations
+constexpr size_t kChunksPerThread = 8;
+
+namespace {
+
+// Returns the processors with the highest maximum frequency, or an empty
+// list if all the processors have the same or it can't be read.
+std::vector<int> getBigCoreProcessors() {
+  std::vector<int> bigCores;
+#if defined(__linux__)
+  const long numProcessors = sysconf(_SC_NPROCESSORS_CONF);
+  std::vector<int64_t> frequencies;
+  for (long cpu = 0; cpu < numProcessors; ++cpu) {
+    std::ostringstream path;
+    path << "/sys/devices/system/cpu/cpu" << cpu
+         << "/cpufreq/cpuinfo_max_freq";
+    std::ifstream file(path.str());
+    int64_t frequency = 0;
+    if (!(file >> frequency)) {
+      return bigCores;
+    }
+    frequencies.push_back(frequency);
+  }
+  if (frequencies.empty()) {
+    return bigCores;
+  }
+  const int64_t maxFrequency =
+      *std::max_element(frequencies.begin(), frequencies.end());
+  for (size_t cpu = 0; cpu < frequencies.size(); ++cpu) {
+    if (frequencies[cpu] == maxFrequency) {
+      bigCores.push_back(static_cast<int>(cpu));
+    }
+  }
+  if (bigCores.size() == frequencies.size()) {
+    bigCores.clear();
+  }
+#endif
+  return bigCores;
+}
+
+} // namespace
+
 std::unique_ptr<ThreadPool> ThreadPool::defaultThreadPool() {
   CAFFE_ENFORCE(cpuinfo_initialize(), "cpuinfo initialization failed");
   int numThreads = cpuinfo_get_processors_count();
@@ -74,7 +137,17 @@ std::unique_ptr<ThreadPool> ThreadPool::defaultThreadPool() {
     }
   }
   LOG(INFO) << "Constructing thread pool with " << numThreads << " threads";
-  return caffe2::make_unique<ThreadPool>(numThreads);
+  auto pool = caffe2::make_unique<ThreadPool>(numThreads);
+  if (FLAGS_caffe2_threadpool_pin_big_cores) {
+    const auto bigCores = getBigCoreProcessors();
+    if (!bigCores.empty()) {
+      LOG(INFO) << "Pinning the thread pool to " << bigCores.size()
+                << " big cores";
+      pool->withPool(
+          [&](WorkersPool* workers) { workers->SetAffinity(bigCores); });
+    }
+  }
+  return pool;
 }
 
 ThreadPool::ThreadPool(int numThreads)
@@ -111,38 +184,47 @@ void ThreadPool::run(const std::function<void(int, size_t)>& fn, size_t range) {
     return;
   }
 
+  // Every task takes the next chunk of the range until there are none left,
+  // so that threads on slower cores, or descheduled ones, don't hold the
+  // others back as they did with one equal share of the range per thread.
   struct FnTask : public Task {
     FnTask(){};
     virtual ~FnTask(){};
     const std::function<void(int, size_t)> *fn_;
     int idx_;
-    size_t start_;
-    size_t end_;
+    std::atomic<size_t>* nextChunk_;
+    size_t numChunks_;
+    size_t chunkSize_;
+    size_t range_;
     virtual void Run() override {
-      for (auto i = start_; i < end_; ++i) {
-        (*fn_)(idx_, i);
+      for (size_t chunk = nextChunk_->fetch_add(1, std::memory_order_relaxed);
+           chunk < numChunks_;
+           chunk = nextChunk_->fetch_add(1, std::memory_order_relaxed)) {
+        const size_t end = std::min(range_, (chunk + 1) * chunkSize_);
+        for (auto i = chunk * chunkSize_; i < end; ++i) {
+          (*fn_)(idx_, i);
+        }
       }
     }
   };
 
   CAFFE_ENFORCE_GE(numThreads_, 1);
-  const size_t unitsPerTask = (range + numThreads_ - 1) / numThreads_;
-  tasks_.resize(numThreads_);
-  for (size_t i = 0; i < numThreads_; ++i) {
+  const size_t chunkSize =
+      std::max<size_t>(1, range / (numThreads_ * kChunksPerThread));
+  const size_t numChunks = (range + chunkSize - 1) / chunkSize;
+  nextChunk_ = 0;
+  tasks_.resize(std::min(numThreads_, numChunks));
+  for (size_t i = 0; i < tasks_.size(); ++i) {
     if (!tasks_[i]) {
       tasks_[i].reset(new FnTask());
     }
     auto *task = (FnTask *)tasks_[i].get();
     task->fn_ = &fn;
     task->idx_ = i;
-    task->start_ = std::min<size_t>(range, i * unitsPerTask);
-    task->end_ = std::min<size_t>(range, (i + 1) * unitsPerTask);
-    if (task->start_ >= task->end_) {
-      tasks_.resize(i);
-      break;
-    }
-    CAFFE_ENFORCE_LE(task->start_, range);
-    CAFFE_ENFORCE_LE(task->end_, range);
+    task->nextChunk_ = &nextChunk_;
+    task->numChunks_ = numChunks;
+    task->chunkSize_ = chunkSize;
+    task->range_ = range;
   }
   CAFFE_ENFORCE_LE(tasks_.size(), numThreads_);
   CAFFE_ENFORCE_GE(tasks_.size(), 1);
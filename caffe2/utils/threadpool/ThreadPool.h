@@ -3,6 +3,7 @@
 
 #include "ThreadPoolCommon.h"
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -42,6 +43,9 @@ class CAFFE2_API /*alignas(kCacheLineSize)*/ ThreadPool {
   // main (calling) thread
   void setMinWorkSize(size_t size);
   size_t getMinWorkSize() const { return minWorkSize_; }
+  // Runs fn(threadId, i) for every i in [0, range). The range is split in
+  // chunks that the threads take as they become free, so that the faster
+  // cores of a big.LITTLE system do more of the work.
   void run(const std::function<void(int, size_t)>& fn, size_t range);
 
   // Run an arbitrary function in a thread-safe manner accessing the Workers
@@ -54,6 +58,8 @@ class CAFFE2_API /*alignas(kCacheLineSize)*/ ThreadPool {
   size_t numThreads_;
   std::shared_ptr<WorkersPool> workersPool_;
   std::vector<std::shared_ptr<Task>> tasks_;
+  // The next chunk of the range of the current run
+  std::atomic<size_t> nextChunk_;
 };
 
 } // namespace caffe2
@@ -0,0 +1,47 @@
+#include <atomic>
+#include <chrono>
+#include <thread> // NOLINT
+#include <vector>
+
+#include "caffe2/utils/threadpool/ThreadPool.h"
+#include <gtest/gtest.h>
+
+namespace caffe2 {
+
+TEST(ThreadPoolTest, RunsEveryIndexOnce) {
+  ThreadPool pool(4);
+  for (size_t range : {1, 3, 4, 31, 32, 1000}) {
+    std::vector<std::atomic<int>> counts(range);
+    for (auto& count : counts) {
+      count = 0;
+    }
+    pool.run([&](int, size_t i) { ++counts[i]; }, range);
+    for (size_t i = 0; i < range; ++i) {
+      EXPECT_EQ(counts[i].load(), 1) << "range " << range << " index " << i;
+    }
+  }
+}
+
+TEST(ThreadPoolTest, FreeThreadsTakeMoreWork) {
+  // The thread that runs the first index is held back, so the work should
+  // go to the others instead of waiting for it.
+  ThreadPool pool(2);
+  const size_t range = 64;
+  std::vector<int> threadIds(range, -1);
+  pool.run(
+      [&](int threadId, size_t i) {
+        if (i == 0) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        threadIds[i] = threadId;
+      },
+      range);
+  int slowThreadItems = 0;
+  for (size_t i = 0; i < range; ++i) {
+    ASSERT_GE(threadIds[i], 0);
+    slowThreadItems += threadIds[i] == threadIds[0];
+  }
+  EXPECT_LT(slowThreadItems, range / 2);
+}
+
+} // namespace caffe2
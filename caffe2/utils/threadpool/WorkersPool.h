@@ -1,8 +1,10 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <thread>
+#include <vector>
 #include "caffe2/core/common.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/utils/thread_name.h"
@@ -11,6 +13,12 @@
 #include <intrin.h>
 #endif
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+C10_DECLARE_int(caffe2_threadpool_spin_us);
+
 namespace caffe2 {
 
 // Uses code derived from gemmlowp,
@@ -24,6 +32,9 @@ namespace caffe2 {
 // - cache-line align Worker.
 // - use std::atomic instead of volatile and custom barriers.
 // - use std::mutex/std::condition_variable instead of raw pthreads.
+// - busy-wait for a configurable time, adapted by the workers to how long
+//   they wait for work.
+// - optionally pin the workers to a set of processors.
 
 constexpr size_t kGEMMLOWPCacheLineSize = 64;
 
@@ -74,8 +85,6 @@ struct MakeAligned {
   }
 };
 
-const int kMaxBusyWaitNOPs = 32 * 1000 * 1000;
-
 #if defined(_MSC_VER)
 #define GEMMLOWP_NOP __nop();
 #else
@@ -112,9 +121,8 @@ inline int Do256NOPs() {
 // still the value of *var when this function returns, since *var is
 // not assumed to be guarded by any lock.
 //
-// First does some busy-waiting for a fixed number of no-op cycles,
-// then falls back to passive waiting for the given condvar, guarded
-// by the given mutex.
+// First does some busy-waiting for spin_us microseconds, then falls back
+// to passive waiting for the given condvar, guarded by the given mutex.
 //
 // The idea of doing some initial busy-waiting is to help get
 // better and more consistent multithreading benefits for small GEMM sizes.
@@ -129,10 +137,10 @@ template <typename T>
 T WaitForVariableChange(std::atomic<T>* var,
                         T initial_value,
                         std::condition_variable* cond,
-                        std::mutex* mutex) {
+                        std::mutex* mutex,
+                        int64_t spin_us) {
   // If we are on a platform that supports it, spin for some time.
   {
-    int nops = 0;
     // First, trivial case where the variable already changed value.
     T new_value = var->load(std::memory_order_relaxed);
     if (new_value != initial_value) {
@@ -140,13 +148,18 @@ T WaitForVariableChange(std::atomic<T>* var,
       return new_value;
     }
     // Then try busy-waiting.
-    while (nops < kMaxBusyWaitNOPs) {
-      nops += Do256NOPs();
+    const auto spin_end = std::chrono::steady_clock::now() +
+        std::chrono::microseconds(spin_us);
+    while (spin_us > 0) {
+      Do256NOPs();
       new_value = var->load(std::memory_order_relaxed);
       if (new_value != initial_value) {
         std::atomic_thread_fence(std::memory_order_acquire);
         return new_value;
       }
+      if (std::chrono::steady_clock::now() >= spin_end) {
+        break;
+      }
     }
   }
 
@@ -196,7 +209,12 @@ class BlockingCounter {
   // to hit the BlockingCounter.
   void Wait() {
     while (size_t count_value = count_.load(std::memory_order_relaxed)) {
-      WaitForVariableChange(&count_, count_value, &cond_, &mutex_);
+      WaitForVariableChange(
+          &count_,
+          count_value,
+          &cond_,
+          &mutex_,
+          static_cast<int64_t>(FLAGS_caffe2_threadpool_spin_us));
     }
   }
 
@@ -223,10 +241,14 @@ class alignas(kGEMMLOWPCacheLineSize) Worker {
     ExitAsSoonAsPossible // Should exit at earliest convenience.
   };
 
-  explicit Worker(BlockingCounter* counter_to_decrement_when_ready)
+  Worker(
+      BlockingCounter* counter_to_decrement_when_ready,
+      const std::vector<int>& affinity)
       : task_(nullptr),
         state_(State::ThreadStartup),
-        counter_to_decrement_when_ready_(counter_to_decrement_when_ready) {
+        counter_to_decrement_when_ready_(counter_to_decrement_when_ready),
+        affinity_(affinity),
+        spin_us_(FLAGS_caffe2_threadpool_spin_us) {
     thread_ = caffe2::make_unique<std::thread>([this]() { this->ThreadFunc(); });
   }
 
@@ -264,6 +286,7 @@ class alignas(kGEMMLOWPCacheLineSize) Worker {
   // Thread entry point.
   void ThreadFunc() {
     setThreadName("CaffeWorkersPool");
+    SetAffinity();
     ChangeState(State::Ready);
 
     // Thread main loop
@@ -271,8 +294,19 @@ class alignas(kGEMMLOWPCacheLineSize) Worker {
       // Get a state to act on
       // In the 'Ready' state, we have nothing to do but to wait until
       // we switch to another state.
-      State state_to_act_upon =
-          WaitForVariableChange(&state_, State::Ready, &state_cond_, &state_mutex_);
+      const auto wait_start = std::chrono::steady_clock::now();
+      State state_to_act_upon = WaitForVariableChange(
+          &state_, State::Ready, &state_cond_, &state_mutex_, spin_us_);
+
+      // Work that comes within the spin time is worth spinning for; when
+      // the waits are longer (e.g. between two runs of a net), halve the
+      // spin so that the idle workers stop burning power.
+      const int64_t max_spin_us = FLAGS_caffe2_threadpool_spin_us;
+      const int64_t waited_us =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - wait_start)
+              .count();
+      spin_us_ = waited_us <= max_spin_us ? max_spin_us : spin_us_ / 2;
 
       // We now have a state to act on, so act.
       switch (state_to_act_upon) {
@@ -291,6 +325,23 @@ class alignas(kGEMMLOWPCacheLineSize) Worker {
     }
   }
 
+  // Pins the calling thread to the processors of affinity_, if any.
+  void SetAffinity() {
+#if defined(__linux__)
+    if (affinity_.empty()) {
+      return;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int cpu : affinity_) {
+      CPU_SET(cpu, &cpus);
+    }
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+      LOG(WARNING) << "Failed to set the affinity of a worker thread";
+    }
+#endif
+  }
+
   static void* ThreadFunc(void* arg) {
     static_cast<Worker*>(arg)->ThreadFunc();
     return nullptr;
@@ -322,6 +373,13 @@ class alignas(kGEMMLOWPCacheLineSize) Worker {
   // pointer to the master's thread BlockingCounter object, to notify the
   // master thread of when this worker switches to the 'Ready' state.
   BlockingCounter* const counter_to_decrement_when_ready_;
+
+  // The processors the thread runs on, or empty to let the OS decide.
+  const std::vector<int> affinity_;
+
+  // The current busy-wait time for new work, at most
+  // FLAGS_caffe2_threadpool_spin_us.
+  int64_t spin_us_;
 };
 
 class WorkersPool {
@@ -345,6 +403,12 @@ class WorkersPool {
     counter_to_decrement_when_ready_.Wait();
   }
 
+  // Pins the workers created from now on to the given processors; an empty
+  // list lets the OS schedule them anywhere.
+  void SetAffinity(const std::vector<int>& cpus) {
+    affinity_ = cpus;
+  }
+
  private:
   // Ensures that the pool has at least the given count of workers.
   // If any new worker has to be created, this function waits for it to
@@ -355,7 +419,8 @@ class WorkersPool {
     }
     counter_to_decrement_when_ready_.Reset(workers_count - workers_.size());
     while (workers_.size() < workers_count) {
-      workers_.push_back(MakeAligned<Worker>::make(&counter_to_decrement_when_ready_));
+      workers_.push_back(MakeAligned<Worker>::make(
+          &counter_to_decrement_when_ready_, affinity_));
     }
     counter_to_decrement_when_ready_.Wait();
   }
@@ -364,5 +429,7 @@ class WorkersPool {
   std::vector<std::unique_ptr<Worker, AlignedDeleter<Worker>>> workers_;
   // The BlockingCounter used to wait for the workers.
   BlockingCounter counter_to_decrement_when_ready_;
+  // The processors of the new workers.
+  std::vector<int> affinity_;
 };
 } // namespace caffe2
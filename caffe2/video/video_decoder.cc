@@ -239,9 +239,12 @@ void VideoDecoder::decodeLoop(
     // frame index of outputed frames
     int outputFrameIndex = -1;
 
-    /* identify the starting point from where we must start decoding */
+    /* identify the starting points from where we must start decoding */
     std::mt19937 meta_randgen(time(nullptr));
-    long int start_ts = -1;
+    // start timestamp of each clip to decode, every clip is decoded from the
+    // key frame before its start
+    std::vector<long int> clipStartTs;
+    long int margin = 0;
     bool mustDecodeAll = false;
     if (videoStream_->duration > 0 && videoStream_->nb_frames > 0) {
       /* we have a valid duration and nb_frames. We can safely
@@ -249,7 +252,7 @@ void VideoDecoder::decodeLoop(
 
       // leave a margin of 10 frames to take in to account the error
       // from av_seek_frame
-      long int margin =
+      margin =
           int(ceil((10 * videoStream_->duration) / (videoStream_->nb_frames)));
       // if we need to do temporal jittering
       if (params.decode_type_ == DecodeType::DO_TMP_JITTER) {
@@ -262,34 +265,31 @@ void VideoDecoder::decodeLoop(
         ts2 = ts2 > 0 ? ts2 : 0;
         // pick a random timestamp between ts1 and ts2. ts2 is selected such
         // that you have enough frames to satisfy the required # of frames.
-        start_ts = std::uniform_int_distribution<>(ts1, ts2)(meta_randgen);
-        // seek a frame at start_ts
-        ret = av_seek_frame(
-            inputContext,
-            videoStreamIndex_,
-            0 > (start_ts - margin) ? 0 : (start_ts - margin),
-            AVSEEK_FLAG_BACKWARD);
+        clipStartTs.push_back(
+            std::uniform_int_distribution<>(ts1, ts2)(meta_randgen));
 
         // if we need to decode from the start_frm
       } else if (params.decode_type_ == DecodeType::USE_START_FRM) {
-        start_ts = int(floor(
-            (videoStream_->duration * start_frm) / (videoStream_->nb_frames)));
-        // seek a frame at start_ts
-        ret = av_seek_frame(
-            inputContext,
-            videoStreamIndex_,
-            0 > (start_ts - margin) ? 0 : (start_ts - margin),
-            AVSEEK_FLAG_BACKWARD);
+        clipStartTs.push_back(int(floor(
+            (videoStream_->duration * start_frm) / (videoStream_->nb_frames))));
+      } else if (
+          params.num_of_clips_ > 0 &&
+          videoStream_->nb_frames >= params.num_of_required_frame_) {
+        // uniformly sample the clips, as DecodeMultipleClipsFromVideo does
+        // from all the frames, but only decode the frames of the clips
+        double clipStep = (params.num_of_clips_ <= 1)
+            ? 0
+            : (double(videoStream_->nb_frames - params.num_of_required_frame_) /
+               (params.num_of_clips_ - 1));
+        for (int i = 0; i < params.num_of_clips_; i++) {
+          long int clipStartFrm = floor(i * clipStep);
+          clipStartTs.push_back(int(floor(
+              (videoStream_->duration * clipStartFrm) /
+              (videoStream_->nb_frames))));
+        }
       } else {
         mustDecodeAll = true;
       }
-
-      if (ret < 0) {
-        LOG(ERROR) << "Unable to decode from a random start point";
-        /* fall back to default decoding of all frames from start */
-        av_seek_frame(inputContext, videoStreamIndex_, 0, AVSEEK_FLAG_BACKWARD);
-        mustDecodeAll = true;
-      }
     } else {
       /* we do not have the necessary metadata to selectively decode frames.
        * Decode all frames as we do in the default case */
@@ -301,191 +301,248 @@ void VideoDecoder::decodeLoop(
     int gotPicture = 0;
     int eof = 0;
     int selectiveDecodedFrames = 0;
+    long int start_ts = -1;
+    size_t clip = 0;
 
-    int maxFrames = (params.decode_type_ == DecodeType::DO_UNIFORM_SMP)
-        ? MAX_DECODING_FRAMES
-        : params.num_of_required_frame_;
+    const int maxFrames = params.num_of_required_frame_;
     // There is a delay between reading packets from the
     // transport and getting decoded frames back.
     // Therefore, after EOF, continue going while
     // the decoder is still giving us frames.
     int ipacket = 0;
-    while ((!eof || gotPicture) &&
-           /* either you must decode all frames or decode upto maxFrames
-            * based on status of the mustDecodeAll flag */
-           (mustDecodeAll ||
-            ((!mustDecodeAll) && (selectiveDecodedFrames < maxFrames))) &&
-           /* If on the last interval and not autodecoding keyframes and a
-            * SpecialFps indicates no more frames are needed, stop decoding */
-           !((itvlIter == params.intervals_.end() &&
-              (currFps == SpecialFps::SAMPLE_TIMESTAMP_ONLY ||
-               currFps == SpecialFps::SAMPLE_NO_FRAME)) &&
-             !params.keyFrames_)) {
-      try {
-        if (!eof) {
-          ret = av_read_frame(inputContext, &packet);
-          if (ret == AVERROR_EOF) {
-            eof = 1;
-            av_free_packet(&packet);
-            packet.data = nullptr;
-            packet.size = 0;
-            // stay in the while loop to flush frames
-          } else if (ret == AVERROR(EAGAIN)) {
-            av_free_packet(&packet);
-            continue;
-          } else if (ret < 0) {
-            LOG(ERROR) << "Error reading packet : " << ffmpegErrorStr(ret);
-          }
-          ipacket++;
-
-          // Ignore packets from other streams
-          if (packet.stream_index != videoStreamIndex_) {
-            av_free_packet(&packet);
-            continue;
-          }
-        }
-
-        ret = avcodec_decode_video2(
-            videoCodecContext_, videoStreamFrame_, &gotPicture, &packet);
+    while (true) {
+      if (!mustDecodeAll) {
+        start_ts = clipStartTs[clip];
+        // seek a frame at start_ts
+        ret = av_seek_frame(
+            inputContext,
+            videoStreamIndex_,
+            0 > (start_ts - margin) ? 0 : (start_ts - margin),
+            AVSEEK_FLAG_BACKWARD);
         if (ret < 0) {
-          LOG(ERROR) << "Error decoding video frame : " << ffmpegErrorStr(ret);
+          LOG(ERROR) << "Unable to decode from a random start point";
+          /* fall back to default decoding of all frames from start */
+          av_seek_frame(
+              inputContext, videoStreamIndex_, 0, AVSEEK_FLAG_BACKWARD);
+          mustDecodeAll = true;
+          sampledFrames.clear();
         }
+        // drop the frames the decoder buffered before the seek
+        avcodec_flush_buffers(videoCodecContext_);
+        gotPicture = 0;
+        eof = 0;
+        selectiveDecodedFrames = 0;
+        lastFrameTimestamp = -1.0;
+      }
 
+      while ((!eof || gotPicture) &&
+             /* either you must decode all frames or decode upto maxFrames
+              * based on status of the mustDecodeAll flag */
+             (mustDecodeAll ||
+              ((!mustDecodeAll) && (selectiveDecodedFrames < maxFrames))) &&
+             /* If on the last interval and not autodecoding keyframes and a
+              * SpecialFps indicates no more frames are needed, stop decoding */
+             !((itvlIter == params.intervals_.end() &&
+                (currFps == SpecialFps::SAMPLE_TIMESTAMP_ONLY ||
+                 currFps == SpecialFps::SAMPLE_NO_FRAME)) &&
+               !params.keyFrames_)) {
         try {
-          // Nothing to do without a picture
-          if (!gotPicture) {
-            av_free_packet(&packet);
-            continue;
+          if (!eof) {
+            ret = av_read_frame(inputContext, &packet);
+            if (ret == AVERROR_EOF) {
+              eof = 1;
+              av_free_packet(&packet);
+              packet.data = nullptr;
+              packet.size = 0;
+              // stay in the while loop to flush frames
+            } else if (ret == AVERROR(EAGAIN)) {
+              av_free_packet(&packet);
+              continue;
+            } else if (ret < 0) {
+              LOG(ERROR) << "Error reading packet : " << ffmpegErrorStr(ret);
+            }
+            ipacket++;
+
+            // Ignore packets from other streams
+            if (packet.stream_index != videoStreamIndex_) {
+              av_free_packet(&packet);
+              continue;
+            }
           }
-          frameIndex++;
-
-          long int frame_ts =
-              av_frame_get_best_effort_timestamp(videoStreamFrame_);
-          double timestamp = frame_ts * av_q2d(videoStream_->time_base);
-
-          if ((frame_ts >= start_ts && !mustDecodeAll) || mustDecodeAll) {
-            /* process current frame if:
-             * 1) We are not doing selective decoding and mustDecodeAll
-             *    OR
-             * 2) We are doing selective decoding and current frame
-             *   timestamp is >= start_ts from where we start selective
-             *   decoding*/
-            // if reaching the next interval, update the current fps
-            // and reset lastFrameTimestamp so the current frame could be
-            // sampled (unless fps == SpecialFps::SAMPLE_NO_FRAME)
-            if (itvlIter != params.intervals_.end() &&
-                timestamp >= itvlIter->timestamp) {
-              lastFrameTimestamp = -1.0;
-              currFps = itvlIter->fps;
-              prevTimestamp = itvlIter->timestamp;
-              itvlIter++;
+
+          // the frames before the clip that no other frame references do
+          // not need to be decoded
+          videoCodecContext_->skip_frame = !mustDecodeAll && !eof &&
+                  packet.pts != AV_NOPTS_VALUE && packet.pts < start_ts
+              ? AVDISCARD_NONREF
+              : AVDISCARD_DEFAULT;
+          ret = avcodec_decode_video2(
+              videoCodecContext_, videoStreamFrame_, &gotPicture, &packet);
+          if (ret < 0) {
+            LOG(ERROR) << "Error decoding video frame : "
+                       << ffmpegErrorStr(ret);
+          }
+
+          try {
+            // Nothing to do without a picture
+            if (!gotPicture) {
+              av_free_packet(&packet);
+              continue;
+            }
+            frameIndex++;
+
+            long int frame_ts =
+                av_frame_get_best_effort_timestamp(videoStreamFrame_);
+            double timestamp = frame_ts * av_q2d(videoStream_->time_base);
+
+            if ((frame_ts >= start_ts && !mustDecodeAll) || mustDecodeAll) {
+              /* process current frame if:
+               * 1) We are not doing selective decoding and mustDecodeAll
+               *    OR
+               * 2) We are doing selective decoding and current frame
+               *   timestamp is >= start_ts from where we start selective
+               *   decoding*/
+              // if reaching the next interval, update the current fps
+              // and reset lastFrameTimestamp so the current frame could be
+              // sampled (unless fps == SpecialFps::SAMPLE_NO_FRAME)
               if (itvlIter != params.intervals_.end() &&
-                  prevTimestamp >= itvlIter->timestamp) {
-                LOG(ERROR)
-                    << "Sampling interval timestamps must be strictly ascending.";
+                  timestamp >= itvlIter->timestamp) {
+                lastFrameTimestamp = -1.0;
+                currFps = itvlIter->fps;
+                prevTimestamp = itvlIter->timestamp;
+                itvlIter++;
+                if (itvlIter != params.intervals_.end() &&
+                    prevTimestamp >= itvlIter->timestamp) {
+                  LOG(ERROR) << "Sampling interval timestamps must be "
+                                "strictly ascending.";
+                }
               }
-            }
 
-            // keyFrame will bypass all checks on fps sampling settings
-            bool keyFrame = params.keyFrames_ && videoStreamFrame_->key_frame;
-            if (!keyFrame) {
-              // if fps == SpecialFps::SAMPLE_NO_FRAME (0), don't sample at all
-              if (currFps == SpecialFps::SAMPLE_NO_FRAME) {
-                av_free_packet(&packet);
-                continue;
+              // keyFrame will bypass all checks on fps sampling settings
+              bool keyFrame = params.keyFrames_ && videoStreamFrame_->key_frame;
+              if (!keyFrame) {
+                // if fps == SpecialFps::SAMPLE_NO_FRAME (0), don't sample at
+                // all
+                if (currFps == SpecialFps::SAMPLE_NO_FRAME) {
+                  av_free_packet(&packet);
+                  continue;
+                }
+
+                // fps is considered reached in the following cases:
+                // 1. lastFrameTimestamp < 0 - start of a new interval
+                //    (or first frame)
+                // 2. currFps == SpecialFps::SAMPLE_ALL_FRAMES (-1) - sample
+                //    every frame
+                // 3. timestamp - lastFrameTimestamp has reached target fps and
+                //    currFps > 0 (not special fps setting)
+                // different modes for fps:
+                // SpecialFps::SAMPLE_NO_FRAMES (0):
+                //     disable fps sampling, no frame sampled at all
+                // SpecialFps::SAMPLE_ALL_FRAMES (-1):
+                //     unlimited fps sampling, will sample at native video fps
+                // SpecialFps::SAMPLE_TIMESTAMP_ONLY (-2):
+                //     disable fps sampling, but will get the frame at specific
+                //     timestamp
+                // others (> 0): decoding at the specified fps
+                bool fpsReached = lastFrameTimestamp < 0 ||
+                    currFps == SpecialFps::SAMPLE_ALL_FRAMES ||
+                    (currFps > 0 &&
+                     timestamp >= lastFrameTimestamp + (1 / currFps));
+
+                if (!fpsReached) {
+                  av_free_packet(&packet);
+                  continue;
+                }
               }
 
-              // fps is considered reached in the following cases:
-              // 1. lastFrameTimestamp < 0 - start of a new interval
-              //    (or first frame)
-              // 2. currFps == SpecialFps::SAMPLE_ALL_FRAMES (-1) - sample every
-              //    frame
-              // 3. timestamp - lastFrameTimestamp has reached target fps and
-              //    currFps > 0 (not special fps setting)
-              // different modes for fps:
-              // SpecialFps::SAMPLE_NO_FRAMES (0):
-              //     disable fps sampling, no frame sampled at all
-              // SpecialFps::SAMPLE_ALL_FRAMES (-1):
-              //     unlimited fps sampling, will sample at native video fps
-              // SpecialFps::SAMPLE_TIMESTAMP_ONLY (-2):
-              //     disable fps sampling, but will get the frame at specific
-              //     timestamp
-              // others (> 0): decoding at the specified fps
-              bool fpsReached = lastFrameTimestamp < 0 ||
-                  currFps == SpecialFps::SAMPLE_ALL_FRAMES ||
-                  (currFps > 0 &&
-                   timestamp >= lastFrameTimestamp + (1 / currFps));
-
-              if (!fpsReached) {
+              lastFrameTimestamp = timestamp;
+
+              outputFrameIndex++;
+              if (params.maximumOutputFrames_ != -1 &&
+                  outputFrameIndex >= params.maximumOutputFrames_) {
+                // enough frames
                 av_free_packet(&packet);
-                continue;
+                break;
               }
-            }
-
-            lastFrameTimestamp = timestamp;
-
-            outputFrameIndex++;
-            if (params.maximumOutputFrames_ != -1 &&
-                outputFrameIndex >= params.maximumOutputFrames_) {
-              // enough frames
-              av_free_packet(&packet);
-              break;
-            }
 
-            AVFrame* rgbFrame = av_frame_alloc();
-            if (!rgbFrame) {
-              LOG(ERROR) << "Error allocating AVframe";
-            }
+              AVFrame* rgbFrame = av_frame_alloc();
+              if (!rgbFrame) {
+                LOG(ERROR) << "Error allocating AVframe";
+              }
 
-            try {
-              // Determine required buffer size and allocate buffer
-              int numBytes = avpicture_get_size(pixFormat, outWidth, outHeight);
-              DecodedFrame::AvDataPtr buffer(
-                  (uint8_t*)av_malloc(numBytes * sizeof(uint8_t)));
-
-              int size = avpicture_fill(
-                  (AVPicture*)rgbFrame,
-                  buffer.get(),
-                  pixFormat,
-                  outWidth,
-                  outHeight);
-
-              sws_scale(
-                  scaleContext_,
-                  videoStreamFrame_->data,
-                  videoStreamFrame_->linesize,
-                  0,
-                  videoCodecContext_->height,
-                  rgbFrame->data,
-                  rgbFrame->linesize);
-
-              unique_ptr<DecodedFrame> frame = make_unique<DecodedFrame>();
-              frame->width_ = outWidth;
-              frame->height_ = outHeight;
-              frame->data_ = move(buffer);
-              frame->size_ = size;
-              frame->index_ = frameIndex;
-              frame->outputFrameIndex_ = outputFrameIndex;
-              frame->timestamp_ = timestamp;
-              frame->keyFrame_ = videoStreamFrame_->key_frame;
-
-              sampledFrames.push_back(move(frame));
-              selectiveDecodedFrames++;
-              av_frame_free(&rgbFrame);
-            } catch (const std::exception&) {
-              av_frame_free(&rgbFrame);
+              try {
+                // Determine required buffer size and allocate buffer
+                int numBytes =
+                    avpicture_get_size(pixFormat, outWidth, outHeight);
+                DecodedFrame::AvDataPtr buffer(
+                    (uint8_t*)av_malloc(numBytes * sizeof(uint8_t)));
+
+                int size = avpicture_fill(
+                    (AVPicture*)rgbFrame,
+                    buffer.get(),
+                    pixFormat,
+                    outWidth,
+                    outHeight);
+
+                sws_scale(
+                    scaleContext_,
+                    videoStreamFrame_->data,
+                    videoStreamFrame_->linesize,
+                    0,
+                    videoCodecContext_->height,
+                    rgbFrame->data,
+                    rgbFrame->linesize);
+
+                unique_ptr<DecodedFrame> frame = make_unique<DecodedFrame>();
+                frame->width_ = outWidth;
+                frame->height_ = outHeight;
+                frame->data_ = move(buffer);
+                frame->size_ = size;
+                frame->index_ = frameIndex;
+                frame->outputFrameIndex_ = outputFrameIndex;
+                frame->timestamp_ = timestamp;
+                frame->keyFrame_ = videoStreamFrame_->key_frame;
+
+                sampledFrames.push_back(move(frame));
+                selectiveDecodedFrames++;
+                av_frame_free(&rgbFrame);
+              } catch (const std::exception&) {
+                av_frame_free(&rgbFrame);
+              }
             }
+            av_frame_unref(videoStreamFrame_);
+          } catch (const std::exception&) {
+            av_frame_unref(videoStreamFrame_);
           }
-          av_frame_unref(videoStreamFrame_);
+
+          av_free_packet(&packet);
         } catch (const std::exception&) {
-          av_frame_unref(videoStreamFrame_);
+          av_free_packet(&packet);
         }
-
-        av_free_packet(&packet);
-      } catch (const std::exception&) {
-        av_free_packet(&packet);
+      } // of while loop
+
+      if (!mustDecodeAll && selectiveDecodedFrames < maxFrames &&
+          clipStartTs.size() > 1) {
+        // a clip is short of frames, e.g. because of inaccurate metadata, so
+        // sample the clips from all the frames instead
+        LOG(INFO) << "Decoding all frames of " << videoName
+                  << " as a clip could not be decoded";
+        av_seek_frame(inputContext, videoStreamIndex_, 0, AVSEEK_FLAG_BACKWARD);
+        avcodec_flush_buffers(videoCodecContext_);
+        sampledFrames.clear();
+        mustDecodeAll = true;
+        gotPicture = 0;
+        eof = 0;
+        frameIndex = -1;
+        outputFrameIndex = -1;
+        lastFrameTimestamp = -1.0;
+        continue;
       }
-    } // of while loop
+      if (mustDecodeAll || ++clip == clipStartTs.size()) {
+        break;
+      }
+    }
+
 
     // free all stuffs
     sws_freeContext(scaleContext_);
@@ -101,6 +101,9 @@ class Params {
   // params for decoding behavior
   int decode_type_ = DecodeType::DO_TMP_JITTER;
   int num_of_required_frame_ = -1;
+  // number of clips of DO_UNIFORM_SMP, each decoded by seeking to its start
+  // when the video has the metadata for it. 0 decodes all the frames
+  int num_of_clips_ = 0;
 
   // intervals_ control variable sampling fps between different timestamps
   // intervals_ must be ordered strictly ascending by timestamps
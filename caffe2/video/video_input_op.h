@@ -34,6 +34,7 @@ class VideoInputOp final : public PrefetchOperator<Context> {
   void CheckParamsAndPrint();
 
   bool GetClipsAndLabelsFromDBValue(
+      const std::string& key,
       const std::string& value,
       int& height,
       int& width,
@@ -42,6 +43,7 @@ class VideoInputOp final : public PrefetchOperator<Context> {
       int* video_id_data);
 
   void DecodeAndTransform(
+      const std::string& key,
       const std::string& value,
       float* clip_rgb_data,
       float* clip_of_data,
@@ -107,6 +109,9 @@ class VideoInputOp final : public PrefetchOperator<Context> {
   // thread pool for parse + decode
   int num_decode_threads_;
   std::shared_ptr<TaskThreadPool> thread_pool_;
+
+  // decoded clips of the videos, by db key, if decoded_clip_cache_mb > 0
+  std::unique_ptr<DecodedClipCache> clip_cache_;
 };
 
 template <class Context>
@@ -347,6 +352,13 @@ VideoInputOp<Context>::VideoInputOp(
           "num_decode_threads",
           4)),
       thread_pool_(std::make_shared<TaskThreadPool>(num_decode_threads_)) {
+  // temporal jittering decodes different clips on every read
+  const int64_t clip_cache_mb = OperatorBase::template GetSingleArgument<int>(
+      "decoded_clip_cache_mb", 0);
+  if (clip_cache_mb > 0 && decode_type_ != DecodeType::DO_TMP_JITTER) {
+    clip_cache_.reset(new DecodedClipCache(clip_cache_mb << 20));
+  }
+
   // hard-coded PCA eigenvectors and eigenvalues, based on RBG channel order
   color_lighting_eigvecs_.push_back(
       std::vector<float>{-144.7125, 183.396, 102.2295});
@@ -495,6 +507,7 @@ VideoInputOp<Context>::VideoInputOp(
 
 template <class Context>
 bool VideoInputOp<Context>::GetClipsAndLabelsFromDBValue(
+    const std::string& key,
     const std::string& value,
     int& height,
     int& width,
@@ -561,6 +574,10 @@ bool VideoInputOp<Context>::GetClipsAndLabelsFromDBValue(
         "Database with a file_list is expected to be string data");
   }
 
+  if (clip_cache_ && clip_cache_->Lookup(key, height, width, buffer_rgb)) {
+    return true;
+  }
+
   // initializing the decoding params
   Params params;
   params.maximumOutputFrames_ = MAX_DECODING_FRAMES;
@@ -573,6 +590,9 @@ bool VideoInputOp<Context>::GetClipsAndLabelsFromDBValue(
   params.scale_h_ = scale_h_;
   params.decode_type_ = decode_type_;
   params.num_of_required_frame_ = num_of_required_frame_;
+  if (decode_type_ == DecodeType::DO_UNIFORM_SMP) {
+    params.num_of_clips_ = clip_per_video_;
+  }
 
   char* video_buffer = nullptr; // for decoding from buffer
   std::string video_filename; // for decoding from file
@@ -608,12 +628,18 @@ bool VideoInputOp<Context>::GetClipsAndLabelsFromDBValue(
       height,
       width,
       buffer_rgb);
+  if (clip_cache_) {
+    clip_cache_->Insert(
+        key, height, width, num_of_required_frame_ * 3 * height * width,
+        buffer_rgb);
+  }
 
   return true;
 }
 
 template <class Context>
 void VideoInputOp<Context>::DecodeAndTransform(
+    const std::string& key,
     const std::string& value,
     float* clip_rgb_data,
     float* clip_of_data,
@@ -627,7 +653,7 @@ void VideoInputOp<Context>::DecodeAndTransform(
   int width = 0;
   // Decode the video from memory or read from a local file
   CHECK(GetClipsAndLabelsFromDBValue(
-      value, height, width, buffer_rgb, label_data, video_id_data));
+      key, value, height, width, buffer_rgb, label_data, video_id_data));
 
   int clip_offset_rgb = multi_crop_count_ * channels_rgb_ * length_rgb_ *
       crop_height_ * crop_width_;
@@ -795,6 +821,7 @@ bool VideoInputOp<Context>::Prefetch() {
     thread_pool_->runTask(std::bind(
         &VideoInputOp<Context>::DecodeAndTransform,
         this,
+        std::string(key),
         std::string(value),
         clip_rgb_data,
         clip_of_data,
@@ -559,4 +559,66 @@ bool DecodeMultipleClipsFromVideo(
   return true;
 }
 
+bool DecodedClipCache::Lookup(
+    const std::string& key,
+    int& height,
+    int& width,
+    std::vector<unsigned char*>& buffer_rgb) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return false;
+  }
+  Entry& entry = it->second;
+  lru_.splice(lru_.begin(), lru_, entry.lru_position);
+
+  for (int i = 0; i < buffer_rgb.size(); i++) {
+    delete[] buffer_rgb[i];
+  }
+  buffer_rgb.clear();
+  height = entry.height;
+  width = entry.width;
+  for (const auto& clip : entry.clips) {
+    unsigned char* buffer_rgb_ptr = new unsigned char[clip.size()];
+    std::copy(clip.begin(), clip.end(), buffer_rgb_ptr);
+    buffer_rgb.push_back(buffer_rgb_ptr);
+  }
+  return true;
+}
+
+void DecodedClipCache::Insert(
+    const std::string& key,
+    const int height,
+    const int width,
+    const int clip_size,
+    const std::vector<unsigned char*>& buffer_rgb) {
+  const size_t bytes = size_t(clip_size) * buffer_rgb.size();
+  if (buffer_rgb.empty() || bytes > capacity_bytes_) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (entries_.count(key)) {
+    return;
+  }
+  // evict the least recently used videos
+  while (size_bytes_ + bytes > capacity_bytes_) {
+    auto victim = entries_.find(lru_.back());
+    for (const auto& clip : victim->second.clips) {
+      size_bytes_ -= clip.size();
+    }
+    entries_.erase(victim);
+    lru_.pop_back();
+  }
+
+  lru_.push_front(key);
+  Entry& entry = entries_[key];
+  entry.height = height;
+  entry.width = width;
+  entry.lru_position = lru_.begin();
+  for (unsigned char* clip : buffer_rgb) {
+    entry.clips.emplace_back(clip, clip + clip_size);
+  }
+  size_bytes_ += bytes;
+}
+
 } // namespace caffe2
@@ -8,7 +8,10 @@
 #include <random>
 
 #include <istream>
+#include <list>
+#include <mutex>
 #include <ostream>
+#include <unordered_map>
 
 namespace caffe2 {
 
@@ -74,6 +77,44 @@ bool DecodeMultipleClipsFromVideo(
     int& width,
     std::vector<unsigned char*>& buffer_rgb);
 
+// LRU cache of the decoded clips of videos, for the decode types that decode
+// the same clips every time a video is read, e.g. across epochs
+class DecodedClipCache {
+ public:
+  explicit DecodedClipCache(size_t capacity_bytes)
+      : capacity_bytes_(capacity_bytes) {}
+
+  // Copies the cached clips of key into buffer_rgb, returns false on a miss
+  bool Lookup(
+      const std::string& key,
+      int& height,
+      int& width,
+      std::vector<unsigned char*>& buffer_rgb);
+
+  // Caches a copy of the clips of key, of clip_size bytes each
+  void Insert(
+      const std::string& key,
+      const int height,
+      const int width,
+      const int clip_size,
+      const std::vector<unsigned char*>& buffer_rgb);
+
+ private:
+  struct Entry {
+    int height;
+    int width;
+    std::vector<std::vector<unsigned char>> clips;
+    std::list<std::string>::iterator lru_position;
+  };
+
+  std::mutex mutex_;
+  const size_t capacity_bytes_;
+  size_t size_bytes_ = 0;
+  // most recently used first
+  std::list<std::string> lru_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
 } // namespace caffe2
 
 #endif // CAFFE2_VIDEO_VIDEO_IO_H_
@@ -1243,6 +1243,19 @@ if (NOT BUILD_ATEN_MOBILE)
     set(AT_ROCM_ENABLED 1)
   ENDIF()
 
+  if (ATEN_THREADING STREQUAL "NATIVE")
+    message(STATUS "Using ATen native thread pool for intra-op parallelism")
+    set(AT_PARALLEL_NATIVE 1)
+  else()
+    set(AT_PARALLEL_NATIVE 0)
+  endif()
+
+  if (USE_NUMA AND NOT CAFFE2_DISABLE_NUMA)
+    set(AT_NUMA_ENABLED 1)
+  else()
+    set(AT_NUMA_ENABLED 0)
+  endif()
+
   if (NO_MKLDNN)
     message("disabling MKLDNN because NO_MKLDNN is set")
     set(AT_MKLDNN_ENABLED 0)
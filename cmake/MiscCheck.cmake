@@ -131,6 +131,28 @@ if (CAFFE2_COMPILER_SUPPORTS_AVX2_EXTENSIONS)
 endif()
 cmake_pop_check_state()
 
+# ---[ Check if the compiler has AVX-512 support, used by the perfkernels
+# that have AVX-512 implementations.
+cmake_push_check_state(RESET)
+if (MSVC)
+  set(CMAKE_REQUIRED_FLAGS "/arch:AVX512")
+else()
+  set(CMAKE_REQUIRED_FLAGS "-mavx512f")
+endif()
+CHECK_CXX_SOURCE_COMPILES(
+    "#include <immintrin.h>
+     int main() {
+       __m512 a, b;
+       a = _mm512_set1_ps(1.f);
+       b = _mm512_fmadd_ps(a, a, a);
+       return 0;
+     }" CAFFE2_COMPILER_SUPPORTS_AVX512_EXTENSIONS)
+if (CAFFE2_COMPILER_SUPPORTS_AVX512_EXTENSIONS AND CAFFE2_PERF_WITH_AVX2)
+  message(STATUS "Current compiler supports avx512f extension. Will build perfkernels with it.")
+  set(CAFFE2_PERF_WITH_AVX512 1)
+endif()
+cmake_pop_check_state()
+
 # ---[ Checks if compiler supports -fvisibility=hidden
 check_cxx_compiler_flag("-fvisibility=hidden" COMPILER_SUPPORTS_HIDDEN_VISIBILITY)
 check_cxx_compiler_flag("-fvisibility-inlines-hidden" COMPILER_SUPPORTS_HIDDEN_INLINE_VISIBILITY)
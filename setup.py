@@ -921,6 +921,7 @@ main_sources = [
     "torch/csrc/autograd/python_variable_indexing.cpp",
     "torch/csrc/byte_order.cpp",
     "torch/csrc/jit/batched/BatchTensor.cpp",
+    "torch/csrc/jit/batched/DynamicBatcher.cpp",
     "torch/csrc/jit/init.cpp",
     "torch/csrc/jit/passes/onnx.cpp",
     "torch/csrc/jit/passes/onnx/fixup_onnx_loop.cpp",
@@ -974,6 +975,8 @@ if USE_DISTRIBUTED:
     if IS_LINUX:
         extra_compile_args.append('-DUSE_C10D')
         main_sources.append('torch/csrc/distributed/c10d/init.cpp')
+        main_sources.append('torch/csrc/distributed/c10d/reducer.cpp')
+        main_sources.append('torch/csrc/distributed/c10d/comm_hook.cpp')
         if USE_CUDA:
             main_sources.append('torch/csrc/distributed/c10d/ddp.cpp')
         main_link_args.append(C10D_LIB)
@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+
+#include <torch/data.h>
+#include <torch/tensor.h>
+
+#include <test/cpp/api/support.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+using namespace torch::data;
+
+struct DummyDataset : datasets::Dataset<int> {
+  int get(size_t index) override {
+    if (index == fail_at) {
+      throw std::runtime_error("Failed to load example");
+    }
+    return static_cast<int>(index);
+  }
+  size_t size() const override {
+    return 10;
+  }
+  size_t fail_at = -1;
+};
+
+/// Chunk `c` holds the examples `[10 * c, 10 * c + c]`.
+struct DummyChunkReader : datasets::ChunkDataReader<int> {
+  ChunkType read_chunk(size_t chunk_index) override {
+    if (chunk_index == fail_at) {
+      throw std::runtime_error("Failed to read chunk");
+    }
+    ChunkType chunk;
+    for (size_t i = 0; i <= chunk_index; ++i) {
+      chunk.push_back(static_cast<int>(10 * chunk_index + i));
+    }
+    return chunk;
+  }
+  size_t chunk_count() override {
+    return 6;
+  }
+  /// Changed while the preloaders of an epoch are reading chunks.
+  std::atomic<size_t> fail_at{size_t(-1)};
+};
+
+std::vector<int> read_epoch(datasets::ChunkDataset<DummyChunkReader>& dataset) {
+  dataset.reset();
+  std::vector<int> examples;
+  while (auto batch = dataset.get_batch(4)) {
+    examples.insert(examples.end(), batch->begin(), batch->end());
+  }
+  return examples;
+}
+
+std::vector<int> concatenate(std::vector<int> batch) {
+  return batch;
+}
+
+TEST(DataTest, SequentialSamplerReturnsIndicesInOrder) {
+  samplers::SequentialSampler sampler(5);
+  ASSERT_EQ(sampler.next(3).value(), std::vector<size_t>({0, 1, 2}));
+  ASSERT_EQ(sampler.next(3).value(), std::vector<size_t>({3, 4}));
+  ASSERT_FALSE(sampler.next(3).has_value());
+  sampler.reset();
+  ASSERT_EQ(sampler.next(1).value(), std::vector<size_t>({0}));
+}
+
+TEST(DataTest, RandomSamplerReturnsAllIndices) {
+  torch::manual_seed(0);
+  samplers::RandomSampler sampler(10);
+  std::vector<size_t> indices;
+  while (auto batch = sampler.next(4)) {
+    indices.insert(indices.end(), batch->begin(), batch->end());
+  }
+  ASSERT_EQ(indices.size(), size_t(10));
+  std::sort(indices.begin(), indices.end());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    ASSERT_EQ(indices[i], i);
+  }
+}
+
+TEST(DataTest, StackCollatesExamples) {
+  std::vector<Example<>> examples = {
+      {torch::ones({2, 3}), torch::zeros({})},
+      {torch::ones({2, 3}) * 2, torch::ones({})}};
+  auto batch = Stack()(examples);
+  ASSERT_EQ(batch.data.sizes().vec(), std::vector<int64_t>({2, 2, 3}));
+  ASSERT_TRUE(batch.data[1].allclose(torch::ones({2, 3}) * 2));
+  ASSERT_TRUE(batch.target.allclose(torch::arange(2, torch::kFloat)));
+
+  examples[1].data = torch::ones({3, 2});
+  ASSERT_THROWS_WITH(Stack()(examples), "Cannot stack tensors");
+}
+
+TEST(DataTest, DataLoaderLoadsTensorDataset) {
+  auto dataset = std::make_shared<datasets::TensorDataset>(
+      torch::arange(20, torch::kFloat).view({10, 2}),
+      torch::arange(10, torch::kInt64));
+  auto loader = make_data_loader(
+      dataset,
+      DataLoaderOptions(4).workers(2),
+      torch::make_unique<samplers::SequentialSampler>(10));
+
+  std::vector<int64_t> targets;
+  for (auto& batch : *loader) {
+    ASSERT_EQ(batch.data.size(0), batch.target.size(0));
+    ASSERT_TRUE(batch.data.select(1, 0).allclose(
+        (batch.target * 2).to(torch::kFloat)));
+    for (int64_t i = 0; i < batch.target.size(0); ++i) {
+      targets.push_back(batch.target[i].item<int64_t>());
+    }
+  }
+  ASSERT_EQ(targets, std::vector<int64_t>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+TEST(DataTest, DataLoaderReturnsBatchesInOrderWithWorkers) {
+  for (size_t workers : {0, 1, 4}) {
+    for (bool drop_last : {false, true}) {
+      auto loader = make_data_loader(
+          std::make_shared<DummyDataset>(),
+          DataLoaderOptions(3).workers(workers).drop_last(drop_last),
+          torch::make_unique<samplers::SequentialSampler>(10),
+          concatenate);
+      // Every epoch restarts the sampler
+      for (size_t epoch = 0; epoch < 2; ++epoch) {
+        std::vector<std::vector<int>> batches(loader->begin(), loader->end());
+        std::vector<std::vector<int>> expected = {
+            {0, 1, 2}, {3, 4, 5}, {6, 7, 8}};
+        if (!drop_last) {
+          expected.push_back({9});
+        }
+        ASSERT_EQ(batches, expected);
+      }
+    }
+  }
+}
+
+TEST(DataTest, DataLoaderRethrowsExceptionsFromWorkers) {
+  auto dataset = std::make_shared<DummyDataset>();
+  dataset->fail_at = 4;
+  auto loader = make_data_loader(
+      dataset,
+      DataLoaderOptions(2).workers(2),
+      torch::make_unique<samplers::SequentialSampler>(10),
+      concatenate);
+  auto iterator = loader->begin();
+  ASSERT_EQ(*iterator, std::vector<int>({0, 1}));
+  ++iterator;
+  ASSERT_EQ(*iterator, std::vector<int>({2, 3}));
+  ASSERT_THROWS_WITH(++iterator, "Failed to load example");
+
+  // A new epoch discards the batches loaded ahead of time
+  dataset->fail_at = -1;
+  ASSERT_EQ(std::distance(loader->begin(), loader->end()), 5);
+}
+
+TEST(DataTest, ChunkDatasetReturnsAllExamplesOnce) {
+  std::vector<int> expected;
+  for (int c = 0; c < 6; ++c) {
+    for (int i = 0; i <= c; ++i) {
+      expected.push_back(10 * c + i);
+    }
+  }
+  for (size_t preloaders : {1, 3}) {
+    for (size_t cache_size : {4, 100}) {
+      datasets::ChunkDataset<DummyChunkReader> dataset(
+          std::make_shared<DummyChunkReader>(),
+          datasets::ChunkDatasetOptions(preloaders).cache_size(cache_size));
+      for (size_t epoch = 0; epoch < 2; ++epoch) {
+        auto examples = read_epoch(dataset);
+        std::sort(examples.begin(), examples.end());
+        ASSERT_EQ(examples, expected);
+      }
+    }
+  }
+}
+
+TEST(DataTest, ChunkDatasetReadsChunksInOrderWithoutShuffling) {
+  datasets::ChunkDataset<DummyChunkReader> dataset(
+      std::make_shared<DummyChunkReader>(),
+      datasets::ChunkDatasetOptions(1).shuffle(false));
+  auto examples = read_epoch(dataset);
+  ASSERT_TRUE(std::is_sorted(examples.begin(), examples.end()));
+  ASSERT_EQ(examples.size(), size_t(21));
+}
+
+TEST(DataTest, ChunkDatasetSplitsChunksAmongRanks) {
+  for (size_t epoch = 0; epoch < 3; ++epoch) {
+    std::vector<int> examples;
+    for (size_t rank = 0; rank < 2; ++rank) {
+      datasets::ChunkDataset<DummyChunkReader> dataset(
+          std::make_shared<DummyChunkReader>(),
+          datasets::ChunkDatasetOptions(2).seed(epoch).rank(rank).world_size(
+              2));
+      auto shard = read_epoch(dataset);
+      // Every rank reads three whole chunks
+      std::set<int> chunks;
+      for (int example : shard) {
+        chunks.insert(example / 10);
+      }
+      ASSERT_EQ(chunks.size(), size_t(3));
+      examples.insert(examples.end(), shard.begin(), shard.end());
+    }
+    std::sort(examples.begin(), examples.end());
+    ASSERT_EQ(examples.size(), size_t(21));
+    ASSERT_EQ(std::unique(examples.begin(), examples.end()), examples.end());
+  }
+}
+
+TEST(DataTest, ChunkDatasetRethrowsExceptionsFromReader) {
+  auto reader = std::make_shared<DummyChunkReader>();
+  reader->fail_at = 2;
+  datasets::ChunkDataset<DummyChunkReader> dataset(
+      reader, datasets::ChunkDatasetOptions(2));
+  ASSERT_THROWS_WITH(read_epoch(dataset), "Failed to read chunk");
+
+  reader->fail_at = -1;
+  ASSERT_EQ(read_epoch(dataset).size(), size_t(21));
+}
+
+TEST(DataTest, DataLoaderLoadsChunkDataset) {
+  auto dataset = std::make_shared<datasets::ChunkDataset<DummyChunkReader>>(
+      std::make_shared<DummyChunkReader>(), datasets::ChunkDatasetOptions(2));
+  auto loader = make_data_loader(
+      dataset, DataLoaderOptions(5).drop_last(true), nullptr, concatenate);
+  for (size_t epoch = 0; epoch < 2; ++epoch) {
+    size_t count = 0;
+    for (auto& batch : *loader) {
+      ASSERT_EQ(batch.size(), size_t(5));
+      ++count;
+    }
+    ASSERT_EQ(count, size_t(4));
+  }
+  ASSERT_THROWS_WITH(
+      make_data_loader(
+          dataset, DataLoaderOptions(5).workers(1), nullptr, concatenate),
+      "can't have workers");
+}
@@ -1,7 +1,12 @@
 #include <gtest/gtest.h>
 
 #include <torch/jit.h>
+#include <torch/nn/modules/functional.h>
+#include <torch/nn/modules/linear.h>
+#include <torch/nn/modules/sequential.h>
+#include <torch/optim/sgd.h>
 #include <torch/tensor.h>
+#include <torch/utils.h>
 
 #include <string>
 
@@ -27,3 +32,60 @@ TEST(TorchScriptTest, CanCompileMultipleFunctions) {
   ASSERT_TRUE(
       0x200 == module->run_method("test_while", a, b).toTensor().item<int64_t>());
 }
+
+TEST(TorchScriptTest, TracedModuleMatchesModule) {
+  torch::manual_seed(0);
+  torch::nn::Sequential model(
+      torch::nn::Linear(4, 8),
+      torch::nn::Functional(torch::tanh),
+      torch::nn::Linear(8, 2));
+  auto input = torch::randn({3, 4});
+
+  auto traced = torch::jit::trace(model, input);
+  ASSERT_TRUE(traced->find_module("0") != nullptr);
+  ASSERT_TRUE(traced->find_module("2")->find_parameter("bias") != nullptr);
+
+  auto other_input = torch::randn({5, 4});
+  auto output = traced->forward({other_input}).toTensor();
+  ASSERT_TRUE(output.allclose(model->forward(other_input)));
+}
+
+TEST(TorchScriptTest, TracedModuleSharesParameters) {
+  torch::manual_seed(0);
+  torch::nn::Sequential model(
+      torch::nn::Linear(4, 8),
+      torch::nn::Functional(torch::sigmoid),
+      torch::nn::Linear(8, 1));
+  auto traced = torch::jit::trace(model, torch::randn({3, 4}));
+  torch::optim::SGD optimizer(model->parameters(), 0.1);
+
+  auto input = torch::randn({3, 4});
+  for (size_t step = 0; step < 3; ++step) {
+    optimizer.zero_grad();
+    auto loss = traced->forward({input}).toTensor().sum();
+    loss.backward();
+    for (const auto& parameter : model->parameters()) {
+      ASSERT_TRUE(parameter->grad().defined());
+    }
+    optimizer.step();
+    ASSERT_TRUE(traced->forward({input}).toTensor().allclose(
+        model->forward(input)));
+  }
+}
+
+namespace {
+struct AddImpl : torch::nn::Module {
+  torch::Tensor forward(torch::Tensor a, torch::Tensor b) {
+    return torch::relu(a + b * 2);
+  }
+};
+TORCH_MODULE(Add);
+} // namespace
+
+TEST(TorchScriptTest, TracesMultipleInputs) {
+  Add model;
+  auto traced = torch::jit::trace(model, torch::ones(3), torch::ones(3));
+  auto a = torch::randn(3), b = torch::randn(3);
+  ASSERT_TRUE(
+      traced->forward({a, b}).toTensor().allclose(model->forward(a, b)));
+}
@@ -43,6 +43,34 @@ TEST_F(AutogradTest, CanPassCustomGradientInputs) {
   ASSERT_TRUE(x.grad().allclose(y * 2));
 }
 
+TEST_F(AutogradTest, CheckpointRecomputesGradients) {
+  auto w = torch::randn({3, 3}, torch::requires_grad());
+  auto segment = [&](const torch::autograd::variable_list& inputs) {
+    return torch::autograd::variable_list{inputs[0].mm(w).tanh().sin()};
+  };
+  segment({x})[0].sum().backward();
+  auto x_grad = x.grad().clone();
+  auto w_grad = w.grad().clone();
+  x.grad().zero_();
+  w.grad().zero_();
+
+  auto output = torch::checkpoint(segment, {x})[0];
+  ASSERT_TRUE(output.requires_grad());
+  output.sum().backward();
+  ASSERT_TRUE(x.grad().allclose(x_grad));
+  ASSERT_TRUE(w.grad().allclose(w_grad));
+}
+
+TEST_F(AutogradTest, ReusesMemoryOfFreedFunctions) {
+  torch::autograd::Function* freed = nullptr;
+  {
+    auto product = torch::autograd::as_variable_ref(x * y);
+    freed = product.grad_fn().get();
+  }
+  auto product = torch::autograd::as_variable_ref(x * y);
+  ASSERT_EQ(product.grad_fn().get(), freed);
+}
+
 TEST(NNInitTest, CanInitializeTensorThatRequiresGrad) {
   auto tensor = torch::empty({3, 4}, torch::requires_grad());
   ASSERT_THROWS_WITH(
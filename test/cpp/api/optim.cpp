@@ -15,6 +15,7 @@
 #include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <random>
 #include <vector>
@@ -338,3 +339,199 @@ TEST(OptimTest, AddParameter_LBFGS) {
 
   // REQUIRE this doesn't throw
 }
+
+template <typename OptimizerClass, typename Options>
+void check_flat_matches_unflattened(Options options) {
+  torch::manual_seed(0);
+  Sequential model(Linear(2, 3), Functional(torch::sigmoid), Linear(3, 1));
+  Sequential flat_model =
+      std::dynamic_pointer_cast<SequentialImpl>(model->clone());
+
+  OptimizerClass optimizer(model->parameters(), options);
+  OptimizerClass flat_optimizer(flat_model->parameters(), options);
+  flat_optimizer.flatten_parameters();
+  ASSERT_TRUE(flat_optimizer.is_flat());
+  ASSERT_EQ(flat_optimizer.flat_parameters().size(), 1);
+
+  auto inputs = torch::randn({4, 2});
+  for (size_t step = 0; step < 10; ++step) {
+    optimizer.zero_grad();
+    model->forward(inputs).sum().backward();
+    optimizer.step();
+
+    flat_optimizer.zero_grad();
+    flat_model->forward(inputs).sum().backward();
+    flat_optimizer.step();
+  }
+
+  auto parameters = model->parameters();
+  auto flat_parameters = flat_model->parameters();
+  for (size_t p = 0; p < parameters.size(); ++p) {
+    ASSERT_TRUE(parameters[p]->allclose(*flat_parameters[p]));
+  }
+}
+
+TEST(OptimTest, FlattenedParametersMatchUnflattened_SGD) {
+  check_flat_matches_unflattened<SGD>(
+      SGDOptions(0.1).weight_decay(1e-6).momentum(0.9).nesterov(true));
+}
+
+TEST(OptimTest, FlattenedParametersMatchUnflattened_Adam) {
+  check_flat_matches_unflattened<Adam>(
+      AdamOptions(0.1).weight_decay(1e-6).amsgrad(true));
+}
+
+TEST(OptimTest, FlattenedParametersMatchUnflattened_Adagrad) {
+  check_flat_matches_unflattened<Adagrad>(
+      AdagradOptions(0.1).weight_decay(1e-6).lr_decay(1e-3));
+}
+
+TEST(OptimTest, FlattenedParametersMatchUnflattened_RMSprop) {
+  check_flat_matches_unflattened<RMSprop>(
+      RMSpropOptions(0.1).momentum(0.9).centered(true));
+}
+
+TEST(OptimTest, FlattenedParametersAreViewsOfBuffers) {
+  torch::manual_seed(0);
+
+  Linear model(2, 8);
+  SGD optimizer(model->parameters(), 0.1);
+  optimizer.flatten_parameters();
+
+  auto output = model->forward(torch::ones({5, 2}));
+  output.sum().backward();
+  optimizer.step();
+
+  auto flat_parameters = optimizer.flat_parameters().front();
+  auto flat_gradients = optimizer.flat_gradients().front();
+  ASSERT_EQ(flat_parameters.numel(), 8 * 2 + 8);
+  ASSERT_GT(flat_gradients.sum().item<float>(), 0);
+
+  {
+    torch::NoGradGuard guard;
+    flat_parameters.fill_(1);
+  }
+  for (const auto& parameter : model->parameters()) {
+    ASSERT_EQ(parameter->sum().item<float>(), parameter->numel());
+  }
+
+  optimizer.zero_grad();
+  ASSERT_EQ(flat_gradients.sum().item<float>(), 0);
+  for (const auto& parameter : model->parameters()) {
+    ASSERT_EQ(parameter->grad().sum().item<float>(), 0);
+  }
+
+  optimizer.add_parameters(std::vector<torch::Tensor>{});
+  ASSERT_FALSE(optimizer.is_flat());
+  ASSERT_TRUE(optimizer.flat_parameters().empty());
+}
+
+TEST(OptimTest, LossScalerAdjustsScale) {
+  LossScaler scaler(
+      LossScalerOptions(1024).growth_interval(2).backoff_factor(0.25));
+  ASSERT_EQ(scaler.loss_scale(), 1024);
+  scaler.update(/*found_non_finite=*/false);
+  ASSERT_EQ(scaler.loss_scale(), 1024);
+  scaler.update(/*found_non_finite=*/false);
+  ASSERT_EQ(scaler.loss_scale(), 2048);
+  scaler.update(/*found_non_finite=*/false);
+  scaler.update(/*found_non_finite=*/true);
+  ASSERT_EQ(scaler.loss_scale(), 512);
+  scaler.update(/*found_non_finite=*/false);
+  ASSERT_EQ(scaler.loss_scale(), 512);
+  ASSERT_EQ(scaler.skipped_steps(), 1);
+
+  LossScaler static_scaler(LossScalerOptions(8).dynamic(false));
+  static_scaler.update(/*found_non_finite=*/true);
+  ASSERT_EQ(static_scaler.loss_scale(), 8);
+  ASSERT_EQ(static_scaler.skipped_steps(), 1);
+}
+
+TEST(OptimTest, LossScalerUnscalesAndFindsNonFiniteGradients) {
+  LossScaler scaler(4);
+  std::vector<torch::Tensor> gradients = {torch::full({3}, 8),
+                                          torch::full({2, 2}, 4)};
+  ASSERT_TRUE(scaler.unscale(gradients));
+  ASSERT_TRUE(gradients[0].allclose(torch::full({3}, 2)));
+  ASSERT_TRUE(gradients[1].allclose(torch::ones({2, 2})));
+
+  gradients[1][0][1] = std::numeric_limits<float>::infinity();
+  ASSERT_FALSE(scaler.unscale(gradients));
+  gradients[1][0][1] = std::numeric_limits<float>::quiet_NaN();
+  ASSERT_FALSE(scaler.unscale(gradients));
+}
+
+TEST(OptimTest, MixedPrecisionOptimizerMatchesOptimizer) {
+  torch::manual_seed(0);
+  Sequential model(Linear(2, 3), Functional(torch::sigmoid), Linear(3, 1));
+  Sequential mixed_model =
+      std::dynamic_pointer_cast<SequentialImpl>(model->clone());
+
+  SGD optimizer(model->parameters(), SGDOptions(0.1).momentum(0.9));
+  MixedPrecisionOptimizer<SGD> mixed_optimizer(
+      mixed_model->parameters(), SGDOptions(0.1).momentum(0.9), 1024);
+
+  auto inputs = torch::randn({4, 2});
+  for (size_t step = 0; step < 5; ++step) {
+    optimizer.zero_grad();
+    model->forward(inputs).sum().backward();
+    optimizer.step();
+
+    mixed_optimizer.zero_grad();
+    mixed_optimizer.backward(mixed_model->forward(inputs).sum());
+    ASSERT_TRUE(mixed_optimizer.step());
+  }
+
+  auto parameters = model->parameters();
+  auto mixed_parameters = mixed_model->parameters();
+  for (size_t p = 0; p < parameters.size(); ++p) {
+    ASSERT_TRUE(parameters[p]->allclose(*mixed_parameters[p]));
+    ASSERT_TRUE(parameters[p]->allclose(
+        mixed_optimizer.master_parameters()[p]));
+  }
+}
+
+TEST(OptimTest, MixedPrecisionOptimizerSkipsStepsWithNonFiniteGradients) {
+  torch::manual_seed(0);
+  Linear model(2, 3);
+  MixedPrecisionOptimizer<Adam> optimizer(model->parameters(), 0.1, 1024);
+  const auto original = model->parameters()["weight"]->clone();
+
+  optimizer.zero_grad();
+  optimizer.backward(model->forward(torch::randn({4, 2})).sum());
+  model->parameters()["bias"]->grad()[0] =
+      std::numeric_limits<float>::infinity();
+  ASSERT_FALSE(optimizer.step());
+  ASSERT_TRUE(model->parameters()["weight"]->equal(original));
+  ASSERT_EQ(optimizer.loss_scaler().loss_scale(), 512);
+  ASSERT_EQ(optimizer.loss_scaler().skipped_steps(), 1);
+
+  optimizer.zero_grad();
+  optimizer.backward(model->forward(torch::randn({4, 2})).sum());
+  ASSERT_TRUE(optimizer.step());
+  ASSERT_FALSE(model->parameters()["weight"]->equal(original));
+}
+
+TEST(OptimTest, MixedPrecisionOptimizerTrainsHalfModel_CUDA) {
+  torch::manual_seed(0);
+  Linear model(2, 3);
+  model->to(torch::kCUDA);
+  model->to(torch::kHalf);
+  MixedPrecisionOptimizer<Adam> optimizer(model->parameters(), 0.1);
+  for (const auto& master : optimizer.master_parameters()) {
+    ASSERT_EQ(master.scalar_type(), torch::kFloat);
+    ASSERT_TRUE(master.is_cuda());
+  }
+
+  auto inputs =
+      torch::randn({4, 2}, torch::device(torch::kCUDA)).to(torch::kHalf);
+  for (size_t step = 0; step < 3; ++step) {
+    optimizer.zero_grad();
+    optimizer.backward(model->forward(inputs).pow(2).sum());
+    ASSERT_TRUE(optimizer.step());
+  }
+  for (size_t p = 0; p < optimizer.parameters().size(); ++p) {
+    ASSERT_TRUE(optimizer.parameters()[p].equal(
+        optimizer.master_parameters()[p].to(torch::kHalf)));
+  }
+}
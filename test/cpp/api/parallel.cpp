@@ -157,6 +157,41 @@ TEST_F(ParallelTest, ParallelApplyWithDifferentOutputDevice_MultiCUDA) {
   ASSERT_TRUE(outputs[2].device().is_cpu());
 }
 
+TEST_F(ParallelTest, ParallelApplyUsesGradModeOfCaller) {
+  std::vector<Linear> modules = {Linear(3, 4), Linear(3, 4), Linear(3, 4)};
+  std::vector<torch::Tensor> inputs(3, torch::ones({2, 3}));
+
+  auto outputs = parallel::parallel_apply(modules, inputs);
+  for (auto& output : outputs) {
+    ASSERT_TRUE(output.requires_grad());
+  }
+
+  torch::NoGradGuard no_grad;
+  outputs = parallel::parallel_apply(modules, inputs);
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    ASSERT_FALSE(outputs[i].requires_grad());
+    ASSERT_TRUE(outputs[i].allclose(modules[i]->forward(inputs[i])));
+  }
+}
+
+TEST_F(ParallelTest, DataParallelRefreshesCachedReplicas_MultiCUDA) {
+  Linear linear(3, 4);
+  linear->to({torch::kCUDA, 0});
+  auto input = torch::ones({10, 3}, torch::device({torch::kCUDA, 0}));
+  std::vector<torch::Device> devices = {{torch::kCUDA, 0}, {torch::kCUDA, 1}};
+
+  auto output = parallel::data_parallel(linear, input, devices);
+  ASSERT_TRUE(output.allclose(linear->forward(input)));
+
+  // The cached replicas see the new parameters.
+  {
+    torch::NoGradGuard no_grad;
+    linear->weight.mul_(2);
+  }
+  output = parallel::data_parallel(linear, input, devices);
+  ASSERT_TRUE(output.allclose(linear->forward(input)));
+}
+
 TEST_F(ParallelTest, ParallelApplyRethrowsException_MultiCUDA) {
   struct M : torch::nn::Cloneable<M> {
     void reset() override {}
@@ -227,3 +227,123 @@ TEST_F(RNNTest, EndToEndRNNTanh_CUDA) {
   ASSERT_TRUE(test_RNN_xor<RNN>(
       [](int s) { return RNN(RNNOptions(s, s).tanh().layers(2)); }, true));
 }
+
+TEST_F(RNNTest, PackAndPadSequences) {
+  auto input = torch::randn({4, 3, 2});
+  auto lengths = torch::tensor({4, 2, 1}, torch::kLong);
+  auto packed = pack_padded_sequence(input, lengths);
+  ASSERT_EQ(packed.data.size(0), 7);
+  ASSERT_EQ(packed.data.size(1), 2);
+  ASSERT_TRUE(torch::equal(
+      packed.batch_sizes, torch::tensor({3, 2, 1, 1}, torch::kLong)));
+
+  torch::Tensor padded, padded_lengths;
+  std::tie(padded, padded_lengths) = pad_packed_sequence(packed);
+  ASSERT_TRUE(torch::equal(padded_lengths, lengths));
+  for (int64_t b = 0; b < 3; ++b) {
+    const auto length = lengths[b].item<int64_t>();
+    ASSERT_TRUE(torch::equal(
+        padded.slice(0, 0, length).select(1, b),
+        input.slice(0, 0, length).select(1, b)));
+    ASSERT_EQ(padded.slice(0, length).select(1, b).sum().item<float>(), 0);
+  }
+
+  auto batch_first = pack_padded_sequence(
+      input.transpose(0, 1), lengths, /*batch_first=*/true);
+  ASSERT_TRUE(torch::equal(batch_first.data, packed.data));
+}
+
+template <typename R>
+void check_packed_forward_matches_forward(R model, int64_t state_dim) {
+  const std::vector<int64_t> lengths = {5, 3, 2};
+  auto input = torch::randn({5, 3, 4});
+  auto packed = pack_padded_sequence(
+      input, torch::tensor(at::ArrayRef<int64_t>(lengths)));
+  auto output = model->packed_forward(packed);
+
+  torch::Tensor padded;
+  std::tie(padded, std::ignore) = pad_packed_sequence(output.output);
+  for (size_t b = 0; b < lengths.size(); ++b) {
+    auto sequence = input.slice(0, 0, lengths[b]).slice(1, b, b + 1);
+    auto expected = model->forward(sequence);
+    ASSERT_TRUE(padded.slice(0, 0, lengths[b])
+                    .slice(1, b, b + 1)
+                    .allclose(expected.output, 1e-5, 1e-6));
+    ASSERT_TRUE(output.state.slice(state_dim, b, b + 1)
+                    .allclose(expected.state, 1e-5, 1e-6));
+  }
+}
+
+TEST_F(RNNTest, PackedForwardMatchesForwardOfEverySequence) {
+  check_packed_forward_matches_forward(LSTM(LSTMOptions(4, 6).layers(2)), 2);
+  check_packed_forward_matches_forward(GRU(GRUOptions(4, 6).layers(2)), 1);
+  check_packed_forward_matches_forward(
+      RNN(RNNOptions(4, 6).tanh().layers(2)), 1);
+}
+
+TEST_F(RNNTest, PackedForwardBackward) {
+  LSTM model(3, 5);
+  auto input = torch::randn({4, 2, 3}, torch::requires_grad());
+  auto lengths = torch::tensor({4, 2}, torch::kLong);
+  auto packed = pack_padded_sequence(input, lengths);
+  auto output = model->packed_forward(packed);
+  output.output.data.sum().backward();
+  // The padding does not contribute to the output.
+  auto padding_grad = input.grad().slice(0, 2).select(1, 1);
+  ASSERT_EQ(padding_grad.abs().sum().item<float>(), 0);
+  ASSERT_GT(input.grad().select(1, 0).abs().sum().item<float>(), 0);
+  for (const auto& parameter : model->parameters()) {
+    ASSERT_TRUE(parameter->grad().defined());
+  }
+}
+
+TEST_F(RNNTest, PackedForward_CUDA) {
+  LSTM model(LSTMOptions(4, 6).layers(2));
+  model->to(torch::kCUDA);
+  auto input = torch::randn({5, 3, 4}, torch::kCUDA);
+  auto lengths = torch::tensor({5, 3, 2}, torch::kLong);
+  auto output = model->packed_forward(pack_padded_sequence(input, lengths));
+  ASSERT_TRUE(output.output.data.is_cuda());
+
+  model->to(torch::kCPU);
+  auto expected = model->packed_forward(
+      pack_padded_sequence(input.to(torch::kCPU), lengths));
+  ASSERT_TRUE(
+      output.output.data.cpu().allclose(expected.output.data, 1e-4, 1e-5));
+  ASSERT_TRUE(output.state.cpu().allclose(expected.state, 1e-4, 1e-5));
+}
+
+TEST_F(RNNTest, FlatWeightsPersistAcrossDevices_CUDA) {
+  LSTM model(LSTMOptions(4, 6).layers(2));
+  model->to(torch::kCUDA);
+  auto storage_of = [](const torch::Tensor& tensor) {
+    return tensor.storage().unsafeGetStorageImpl();
+  };
+  auto parameters = model->parameters();
+  const auto* storage = storage_of(*parameters[0]);
+  for (const auto& parameter : parameters) {
+    ASSERT_EQ(storage_of(*parameter), storage);
+  }
+  std::vector<torch::Tensor> values;
+  for (const auto& parameter : parameters) {
+    values.push_back(parameter->clone());
+  }
+  auto input = torch::randn({5, 3, 4}, torch::kCUDA);
+  auto expected = model->forward(input).output;
+
+  model->to(torch::kCPU);
+  storage = storage_of(*parameters[0]);
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    ASSERT_FALSE(parameters[i]->is_cuda());
+    ASSERT_EQ(storage_of(*parameters[i]), storage);
+    ASSERT_TRUE(torch::equal(parameters[i]->to(torch::kCUDA), values[i]));
+  }
+
+  model->to(torch::kCUDA);
+  storage = storage_of(*parameters[0]);
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    ASSERT_EQ(storage_of(*parameters[i]), storage);
+    ASSERT_TRUE(torch::equal(*parameters[i], values[i]));
+  }
+  ASSERT_TRUE(model->forward(input).output.allclose(expected));
+}
@@ -325,3 +325,63 @@ TEST_F(SequentialTest, CloneToDevice_CUDA) {
     ASSERT_EQ(b->device(), device);
   }
 }
+
+TEST_F(SequentialTest, CompiledSequentialMatchesSequential) {
+  Sequential sequential(
+      Linear(10, 20),
+      Functional(torch::relu)->inplace(torch::relu_),
+      Dropout(0.5),
+      Linear(20, 30),
+      Functional(torch::tanh),
+      Functional(torch::sigmoid)->inplace(torch::sigmoid_),
+      Linear(30, 5));
+  sequential->eval();
+  CompiledSequential compiled(sequential, torch::ones({8, 10}));
+  for (size_t i = 0; i < 3; ++i) {
+    auto input = torch::randn({8, 10});
+    auto expected = sequential->forward(input);
+    auto output = compiled.forward(input);
+    ASSERT_FALSE(output.requires_grad());
+    ASSERT_TRUE(output.allclose(expected, 1e-5, 1e-6));
+  }
+}
+
+TEST_F(SequentialTest, CompiledSequentialReusesActivations) {
+  Sequential sequential(
+      Linear(4, 6), Functional(torch::relu)->inplace(torch::relu_));
+  sequential->eval();
+  CompiledSequential compiled(sequential, torch::ones({2, 4}));
+  const auto first = compiled.forward(torch::ones({2, 4}));
+  ASSERT_TRUE(torch::equal(first, sequential->forward(torch::ones({2, 4}))));
+  const auto* data = first.data_ptr();
+  ASSERT_EQ(compiled.forward(torch::randn({2, 4})).data_ptr(), data);
+}
+
+TEST_F(SequentialTest, CompiledSequentialChecksInputs) {
+  Sequential sequential(Linear(4, 6));
+  ASSERT_THROWS_WITH(
+      CompiledSequential(sequential, torch::ones({2, 4})),
+      "Only a Sequential in evaluation mode can be compiled");
+  sequential->eval();
+  CompiledSequential compiled(sequential, torch::ones({2, 4}));
+  ASSERT_THROWS_WITH(
+      compiled.forward(torch::ones({3, 4})),
+      "The Sequential was compiled for inputs of shape [2, 4]");
+  ASSERT_THROWS_WITH(
+      compiled.forward(torch::ones({2, 4}, torch::kDouble)),
+      "The Sequential was compiled for inputs of shape [2, 4] and type");
+}
+
+TEST_F(SequentialTest, CompiledSequential_CUDA) {
+  Sequential sequential(
+      Linear(10, 20),
+      Functional(torch::relu)->inplace(torch::relu_),
+      Linear(20, 5));
+  sequential->eval();
+  sequential->to(torch::kCUDA);
+  CompiledSequential compiled(sequential, torch::ones({8, 10}, torch::kCUDA));
+  auto input = torch::randn({8, 10}, torch::kCUDA);
+  auto output = compiled.forward(input);
+  ASSERT_TRUE(output.is_cuda());
+  ASSERT_TRUE(output.allclose(sequential->forward(input), 1e-5, 1e-6));
+}
@@ -262,3 +262,118 @@ TEST(SerializeTest, XOR_CUDA) {
   loss = getLoss(model3, 100);
   ASSERT_LT(loss.item<float>(), 0.1);
 }
+
+TEST(SerializeTest, SaveAsyncWritesSnapshot) {
+  torch::manual_seed(0);
+
+  auto model = xor_model();
+  std::vector<torch::Tensor> original;
+  for (const auto& p : model->parameters()) {
+    original.push_back(p->clone());
+  }
+
+  torch::test::TempFile tempfile;
+  auto checkpoint = torch::save_async(model, tempfile.name);
+  {
+    torch::NoGradGuard guard;
+    for (auto& p : model->parameters()) {
+      p->fill_(0);
+    }
+  }
+  checkpoint.get();
+
+  auto model2 = xor_model();
+  torch::load(model2, tempfile.name);
+  auto parameters = model2->parameters();
+  for (size_t i = 0; i < original.size(); ++i) {
+    ASSERT_TRUE(parameters[i]->equal(original[i]));
+  }
+}
+
+TEST(SerializeTest, SnapshotPreservesSharedStorage) {
+  auto x = torch::randn({4, 4});
+  auto row = x[1];
+  auto expected = x.clone();
+
+  torch::serialize::OutputArchive archive;
+  archive.write("x", x);
+  archive.write("row", row);
+  archive.snapshot();
+  x.fill_(0);
+
+  std::stringstream stream;
+  archive.save_to(stream);
+  torch::serialize::InputArchive input;
+  input.load_from(stream);
+  torch::Tensor x2, row2;
+  input.read("x", x2);
+  input.read("row", row2);
+
+  ASSERT_TRUE(x2.equal(expected));
+  ASSERT_TRUE(row2.equal(expected[1]));
+  ASSERT_EQ(row2.data<float>(), x2.data<float>() + 4);
+}
+
+TEST(SerializeTest, SaveAsyncAndLoadIntoDevice_CUDA) {
+  torch::manual_seed(0);
+
+  auto x = torch::randn({5, 5}, torch::device(torch::kCUDA));
+  auto expected = x.cpu();
+
+  torch::test::TempFile tempfile;
+  auto checkpoint = torch::save_async(x, tempfile.name);
+  x.fill_(0);
+  checkpoint.get();
+
+  auto y = torch::zeros({5, 5}, torch::device(torch::kCUDA));
+  torch::load(y, tempfile.name);
+  ASSERT_TRUE(y.is_cuda());
+  ASSERT_TRUE(y.cpu().equal(expected));
+}
+
+TEST(SerializeTest, CheckpointerWritesSnapshots) {
+  torch::manual_seed(0);
+
+  auto model = xor_model();
+  torch::optim::SGD optimizer(
+      model->parameters(), torch::optim::SGDOptions(0.1).momentum(0.9));
+  auto loss = model->forward(torch::randn({4, 2})).sum();
+  loss.backward();
+  optimizer.step();
+
+  std::vector<torch::Tensor> original;
+  for (const auto& p : model->parameters()) {
+    original.push_back(p->clone());
+  }
+  auto original_momentum = optimizer.momentum_buffers[0].clone();
+
+  torch::test::TempFile model_file, optimizer_file;
+  torch::serialize::Checkpointer checkpointer(/*max_pending=*/1);
+  auto model_written = checkpointer.save(model, model_file.name);
+  auto optimizer_written = checkpointer.save(optimizer, optimizer_file.name);
+  ASSERT_LE(checkpointer.pending(), 1);
+  optimizer.step();
+  checkpointer.wait();
+  ASSERT_EQ(checkpointer.pending(), 0);
+  model_written.get();
+  optimizer_written.get();
+
+  auto model2 = xor_model();
+  torch::optim::SGD optimizer2(
+      model2->parameters(), torch::optim::SGDOptions(0.1).momentum(0.9));
+  torch::load(model2, model_file.name);
+  torch::load(optimizer2, optimizer_file.name);
+  auto parameters = model2->parameters();
+  for (size_t i = 0; i < original.size(); ++i) {
+    ASSERT_TRUE(parameters[i]->equal(original[i]));
+  }
+  ASSERT_TRUE(optimizer2.momentum_buffers[0].equal(original_momentum));
+}
+
+TEST(SerializeTest, CheckpointerReportsErrorsThroughFutures) {
+  torch::serialize::Checkpointer checkpointer;
+  auto written =
+      checkpointer.save(torch::ones({3}), "/nonexistent/directory/x.pt");
+  checkpointer.wait();
+  ASSERT_THROWS_WITH(written.get(), "Unable to rename");
+}
@@ -198,6 +198,19 @@ class TestAutograd(TestCase):
         x_grad, x_grad_clone = compute_grad(create_graph=True)
         self.assertEqual(x_grad, x_grad_clone)
 
+    def test_accumulate_grad_in_input_buffer(self):
+        x = torch.randn(4, requires_grad=True)
+        y = x * 1
+        # the gradients of a and b are summed into the gradient of y, in
+        # place of the one that isn't referenced elsewhere
+        a = y.clone()
+        a_grads = []
+        a.register_hook(lambda grad: a_grads.append(grad))
+        b = y.clone()
+        (a * 2 + b * 3).sum().backward()
+        self.assertEqual(a_grads[0], torch.full((4,), 2))
+        self.assertEqual(x.grad, torch.full((4,), 5))
+
     def test_hessian_vector(self):
         x = torch.randn(2, 2, requires_grad=True)
         y = torch.randn(2, 2, requires_grad=True)
@@ -239,6 +252,37 @@ class TestAutograd(TestCase):
         self.assertEqual(x.grad.data, x_grad)
         self.assertEqual(y.grad.data, y_grad)
 
+    def test_grad_skips_unneeded_outputs(self):
+        x = torch.randn(3, 3, requires_grad=True)
+        w = torch.randn(3, 3, requires_grad=True)
+        y = x.mm(w).sum()
+        with profile() as p:
+            x_grad, = torch.autograd.grad(y, [x], retain_graph=True)
+        # MmBackward only computes the gradient of x
+        self.assertEqual([evt.name for evt in p.function_events].count('mm'), 1)
+        self.assertEqual(x_grad, torch.ones(3, 3).mm(w.t()))
+        self.assertIsNone(w.grad)
+
+    def test_double_backward_fused_formulas(self):
+        x = torch.randn(4, 3, dtype=torch.double, requires_grad=True)
+        target = torch.randn(4, 3, dtype=torch.double)
+        fns = [torch.tanh, torch.sigmoid, lambda x: torch.nn.functional.softplus(x, beta=2, threshold=1),
+               lambda x: torch.nn.functional.mse_loss(x, target)]
+        for fn in fns:
+            # the last backward of gradgradcheck runs without grad mode
+            gradgradcheck(fn, [x])
+            # and a third derivative records the second derivatives
+            gradgradcheck(lambda x: torch.autograd.grad(fn(x).sum(), x, create_graph=True)[0], [x])
+
+    def test_broadcast_backward_single_sum(self):
+        x = torch.randn(4, 1, 3, requires_grad=True)
+        y = torch.randn(2, 4, 5, 3, requires_grad=True)
+        with profile() as p:
+            x_grad, = torch.autograd.grad((x * y).sum(), [x], create_graph=True)
+        self.assertEqual([evt.name for evt in p.function_events].count('sum'), 2)
+        self.assertEqual(x_grad, y.sum(0).sum(1, keepdim=True))
+        self.assertIsNotNone(x_grad.grad_fn)
+
     def test_grad_nonleaf(self):
         x_init = torch.randn(2, 2, requires_grad=True)
         x = x_init
@@ -1920,6 +1964,74 @@ class TestAutograd(TestCase):
         out.sum().backward()
         self.assertEqual(x.grad.data, y_data)
 
+    def test_cpu_threads(self):
+        num_threads = max(torch.autograd.get_num_cpu_threads(), 4)
+        torch.autograd.set_num_cpu_threads(num_threads)
+        self.assertEqual(torch.autograd.get_num_cpu_threads(), num_threads)
+        # the workers that are running can't be stopped
+        with self.assertRaisesRegex(RuntimeError, "can't be reduced"):
+            torch.autograd.set_num_cpu_threads(1)
+        with self.assertRaisesRegex(RuntimeError, "has to be positive"):
+            torch.autograd.set_num_cpu_threads(0)
+
+        # independent towers that meet in a shared input and a shared weight
+        x = torch.randn(8, 16, requires_grad=True)
+        w = torch.randn(16, 16, requires_grad=True)
+        towers = [torch.randn(16, 16, requires_grad=True) for _ in range(8)]
+        out = sum(((x.mm(w).tanh().mm(t)).sigmoid() for t in towers), torch.zeros(()))
+        grads = torch.autograd.grad(out.sum(), [x, w] + towers)
+        for _ in range(5):
+            for inp in [x, w] + towers:
+                inp.grad = None
+            out.sum().backward(retain_graph=True)
+            for inp, grad in zip([x, w] + towers, grads):
+                self.assertEqual(inp.grad, grad)
+
+        # reentrant backward that finishes on another worker
+        y_data = torch.randn(2, 2)
+
+        class Reenter(Function):
+            @staticmethod
+            def forward(ctx, x):
+                with torch.enable_grad():
+                    ctx.x = x.detach().requires_grad_()
+                    ctx.output_var = (ctx.x * y_data).exp().log()
+                return ctx.output_var.detach()
+
+            @staticmethod
+            def backward(ctx, grad_output):
+                with torch.enable_grad():
+                    ctx.output_var.sum().backward()
+                return ctx.x.grad * grad_output
+
+        inputs = [torch.randn(2, 2, requires_grad=True) for _ in range(8)]
+        sum(Reenter.apply(inp).sum() for inp in inputs).backward()
+        for inp in inputs:
+            self.assertEqual(inp.grad, y_data)
+
+    @unittest.skipIf(not torch.cuda.is_available(), "CUDA unavailable")
+    def test_offload_saved_tensors(self):
+        x = torch.randn(64, 64, device='cuda', requires_grad=True)
+        ws = [torch.randn(64, 64, device='cuda', requires_grad=True) for _ in range(6)]
+
+        def run():
+            out = x
+            for w in ws:
+                out = out.mm(w).tanh()
+            return out.sum()
+
+        expected = torch.autograd.grad(run(), [x] + ws)
+        with torch.autograd.offload_saved_tensors(min_bytes=0):
+            out = run()
+        out.backward(retain_graph=True)
+        for inp, grad in zip([x] + ws, expected):
+            self.assertEqual(inp.grad, grad)
+            inp.grad = None
+        # the host copies are kept for another backward pass
+        out.backward()
+        for inp, grad in zip([x] + ws, expected):
+            self.assertEqual(inp.grad, grad)
+
     def test_broadcast_tensors(self):
         f_args_variable = (torch.randn(3, requires_grad=True),
                            torch.randn(1, 2, 1, requires_grad=True),
@@ -2194,6 +2306,59 @@ class TestAutograd(TestCase):
             self.assertEqual(info.name, expected_name)
             last_end = info.cpu_interval.end
 
+    def test_profiler_memory(self):
+        x = torch.randn(128, 128)
+        y = torch.randn(128, 128)
+        nbytes = 128 * 128 * x.element_size()
+
+        with profile(profile_memory=True) as p:
+            (x * y).add_(1)
+        events = {evt.name: evt for evt in p.function_events}
+        self.assertEqual(events['mul'].cpu_memory_usage, nbytes)
+        self.assertEqual(events['mul'].cpu_memory_peak, nbytes)
+        self.assertEqual(events['add_'].cpu_memory_usage, 0)
+        self.assertIn('CPU Mem peak', p.table())
+
+        with profile() as p:
+            x * y
+        self.assertEqual(p.function_events[0].cpu_memory_usage, 0)
+        self.assertNotIn('CPU Mem', p.table())
+
+    @unittest.skipIf(not torch.cuda.is_available() or not torch.autograd._cupti_available(),
+                     "CUPTI not available")
+    def test_profiler_cupti(self):
+        x = torch.randn(128, 128, device='cuda')
+
+        with profile(use_cupti=True) as p:
+            x * 2
+        events = {evt.name: evt for evt in p.function_events}
+        self.assertGreater(len(events['mul'].kernels), 0)
+        for k in events['mul'].kernels:
+            self.assertEqual(k.device, x.get_device())
+            self.assertLessEqual(k.interval.start, k.interval.end)
+
+        with self.assertRaisesRegex(ValueError, "can't be combined"):
+            profile(use_cuda=True, use_cupti=True)
+
+    def test_sampling_profiler(self):
+        x = torch.randn(10, 10)
+        torch.autograd.profiler.sampled_stats(reset=True)
+        torch.autograd.profiler.enable_sampling(every_n_ranges=2)
+        try:
+            for _ in range(10):
+                x * 2
+            with self.assertRaisesRegex(RuntimeError, "can't change kind of profiling"):
+                torch.autograd.profiler.enable_sampling()
+        finally:
+            torch.autograd.profiler.disable_sampling()
+        x * 2
+
+        stats = {s.name: s for s in torch.autograd.profiler.sampled_stats(reset=True)}
+        self.assertEqual(stats['mul'].count, 5)
+        self.assertEqual(sum(stats['mul'].histogram), 5)
+        self.assertGreaterEqual(stats['mul'].total_ns, stats['mul'].max_ns)
+        self.assertEqual(torch.autograd.profiler.sampled_stats(), [])
+
     def test_dir(self):
         x = torch.randn(10, 10)
         keys = dir(x)
@@ -2552,6 +2717,31 @@ class TestAutograd(TestCase):
                     out.backward()
             self.assertIn('MyFunc.apply', str(w[0].message))
 
+    def test_anomaly_detect_lightweight(self):
+        size = 10
+
+        class MyFunc(Function):
+            @staticmethod
+            def forward(ctx, inp):
+                return inp.sum(0, keepdim=True)
+
+            @staticmethod
+            def backward(ctx, gO):
+                gI = gO.clone().expand(size)
+                gI[0] = float('inf')
+                return gI
+
+        inp = torch.rand(size, requires_grad=True)
+        with detect_anomaly(lightweight=True):
+            self.assertTrue(torch._C._is_anomaly_lightweight())
+            out = (inp * 2).sum()
+            out.backward()  # Should not fail
+            out = MyFunc.apply(inp * 2)
+            with self.assertRaisesRegex(RuntimeError, "Function 'MyFuncBackward' returned nan or inf values in its "
+                                                      "0th output.(.|\n)*in test_anomaly_detect_lightweight"):
+                out.backward()
+        self.assertFalse(torch._C._is_anomaly_lightweight())
+
     def test_symeig_no_eigenvectors(self):
         A = torch.tensor([[1., 2.], [2., 4.]], dtype=torch.float32, requires_grad=True)
         w, v = torch.symeig(A, eigenvectors=False)
@@ -4,6 +4,7 @@ import multiprocessing
 import os
 import sys
 import tempfile
+import threading
 import time
 import unittest
 from datetime import timedelta
@@ -147,6 +148,17 @@ class TCPStoreTest(TestCase, StoreTestBase):
             store1 = c10d.TCPStore(addr, port, True)
             store2 = c10d.TCPStore(addr, port, True)
 
+    def test_multi_set_get(self):
+        store = self._create_store()
+        store.multi_set(["key0", "key1"], ["value0", "value1"])
+        self.assertEqual([b"value1", b"value0"], store.multi_get(["key1", "key0"]))
+
+    def test_compare_set(self):
+        store = self._create_store()
+        self.assertEqual(b"value0", store.compare_set("key", "", "value0"))
+        self.assertEqual(b"value0", store.compare_set("key", "other", "value1"))
+        self.assertEqual(b"value1", store.compare_set("key", "value0", "value1"))
+
 
 class PrefixTCPStoreTest(TestCase, StoreTestBase):
     def setUp(self):
@@ -454,6 +466,72 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
         work.wait()
         self.assertEqual(torch.Tensor([float(self.world_size * (self.world_size + 1) / 2)]), x)
 
+    def test_sparse_allreduce(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        def sparse(rows, size):
+            indices = torch.LongTensor([rows])
+            values = torch.Tensor(len(rows), 2).fill_(1.0)
+            return torch.sparse_coo_tensor(indices, values, (size, 2))
+
+        # Few rows per process are gathered, many are reduced densely
+        for size in [1000, 8]:
+            rows = [self.rank, self.rank + 1, 7]
+            x = sparse(rows, size)
+            pg.allreduce(x).wait()
+
+            expected = torch.zeros(size, 2)
+            for rank in range(self.world_size):
+                for row in [rank, rank + 1, 7]:
+                    expected[row] += 1.0
+            self.assertTrue(x.is_sparse)
+            self.assertEqual(expected, x.to_dense())
+
+    def test_allreduce_coalesced(self):
+        store = c10d.FileStore(self.file.name)
+        opts = self.opts()
+        opts.cacheMaxAlgorithmKeys = 2
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, opts)
+
+        # Calls with different shapes, and more of them than cached keys
+        for n in [1, 1000, 3000, 7000, 1]:
+            xs = [
+                torch.Tensor(n).fill_(self.rank + 1.0),
+                torch.Tensor(2, n).fill_(self.rank + 2.0),
+                torch.Tensor(3).fill_(self.rank + 3.0),
+            ]
+            pg.allreduce_coalesced(xs).wait()
+            for i, x in enumerate(xs):
+                expected = self.world_size * (self.world_size + 1) / 2 + i * self.world_size
+                self.assertEqual(torch.Tensor(x.size()).fill_(expected), x)
+
+        # Non-contiguous tensors are packed and unpacked too
+        x = torch.Tensor(4, 3).fill_(self.rank + 1.0).t()
+        pg.allreduce_coalesced([x], c10d.AllreduceOptions()).wait()
+        self.assertEqual(torch.Tensor(3, 4).fill_(self.world_size * (self.world_size + 1) / 2), x)
+
+    def test_allreduce_callback(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        x = torch.Tensor([self.rank + 1.0])
+        done = threading.Event()
+        results = []
+
+        def callback():
+            results.append(x.clone())
+            done.set()
+
+        work = pg.allreduce(x)
+        work.add_callback(callback)
+        self.assertTrue(done.wait(timeout=5.0))
+        self.assertEqual(torch.Tensor([float(self.world_size * (self.world_size + 1) / 2)]), results[0])
+
+        # Callbacks added after completion run right away
+        work.add_callback(lambda: results.append(None))
+        self.assertEqual(2, len(results))
+
     def test_send_recv_all_to_all(self):
         store = c10d.FileStore(self.file.name)
         pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
@@ -490,6 +568,144 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
                 continue
             self.assertEqual(torch.Tensor([i]), outputs[i])
 
+    def test_reduce_scatter_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        def reduce_scatter(output, inputs, op):
+            opts = c10d.ReduceScatterOptions()
+            opts.reduceOp = op
+            work = pg.reduce_scatter([output], [inputs], opts)
+            work.wait()
+
+        # Sum, rank r receives the sum of the r-th inputs
+        inputs = [torch.Tensor([self.rank + i, 1.0]) for i in range(self.world_size)]
+        output = torch.Tensor([-1, -1])
+        reduce_scatter(output, inputs, c10d.ReduceOp.SUM)
+        expected = self.world_size * self.rank + self.world_size * (self.world_size - 1) / 2
+        self.assertEqual(torch.Tensor([expected, self.world_size]), output)
+
+        # Max
+        inputs = [torch.Tensor([self.rank * i]) for i in range(self.world_size)]
+        output = torch.Tensor([-1])
+        reduce_scatter(output, inputs, c10d.ReduceOp.MAX)
+        self.assertEqual(torch.Tensor([(self.world_size - 1) * self.rank]), output)
+
+        # Test overloaded convenience function (defaults to using sum)
+        inputs = [torch.Tensor([1.0]) for _ in range(self.world_size)]
+        output = torch.Tensor([-1])
+        pg.reduce_scatter(output, inputs).wait()
+        self.assertEqual(torch.Tensor([self.world_size]), output)
+
+    def test_alltoall_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Rank r sends [r, i] to rank i
+        inputs = [torch.Tensor([self.rank, i]) for i in range(self.world_size)]
+        outputs = [torch.Tensor([-1, -1]) for _ in range(self.world_size)]
+        work = pg.alltoall(outputs, inputs)
+        work.wait()
+
+        for i in range(self.world_size):
+            self.assertEqual(torch.Tensor([i, self.rank]), outputs[i])
+
+
+class ProcessGroupTracingTest(MultiProcessTestCase):
+    def test_trace_allreduce(self):
+        store = c10d.FileStore(self.file.name)
+        opts = c10d.ProcessGroupGloo.Options()
+        opts.timeout = 1.0
+        opts.devices = [c10d.ProcessGroupGloo.create_tcp_device(interface="lo")]
+        gloo = c10d.ProcessGroupGloo(store, self.rank, self.world_size, opts)
+
+        trace_opts = c10d.ProcessGroupTracing.Options()
+        trace_opts.maxRecords = 3
+        pg = c10d.ProcessGroupTracing(c10d.PrefixStore('trace', store), gloo, trace_opts)
+
+        for _ in range(4):
+            x = torch.ones(256)
+            pg.allreduce(x).wait()
+            self.assertEqual(torch.Tensor(256).fill_(self.world_size), x)
+        pg.broadcast(torch.ones(8), 1).wait()
+
+        # Completion is traced by a callback, which may run after wait()
+        records = pg.records()
+        while not all(record['completed'] for record in records):
+            time.sleep(0.01)
+            records = pg.records()
+
+        # Only the most recent records are kept
+        self.assertEqual([2, 3, 4], [record['seq'] for record in records])
+        self.assertEqual('broadcast', records[-1]['op'])
+        self.assertEqual(1, records[-1]['peer'])
+        for record in records:
+            self.assertTrue(record['success'])
+            self.assertLessEqual(record['enqueued'], record['started'])
+            self.assertLessEqual(record['started'], record['finished'])
+
+        stats = pg.stats()
+        self.assertEqual(4, stats['allreduce']['count'])
+        self.assertEqual(4 * 256 * 4, stats['allreduce']['bytes'])
+        self.assertAlmostEqual(
+            stats['allreduce']['algbw'] * 2.0 * (self.world_size - 1) / self.world_size,
+            stats['allreduce']['busbw'])
+
+        gathered = pg.gather_stats()
+        self.assertEqual(self.world_size, len(gathered['ranks']))
+        self.assertEqual(stats, gathered['ranks'][self.rank])
+        self.assertIn(gathered['straggler'], range(self.world_size))
+
+
+class ParameterServerTest(MultiProcessTestCase):
+    def opts(self):
+        opts = c10d.ParameterServer.Options()
+        opts.hostname = '127.0.0.1'
+        return opts
+
+    def barrier(self, store, name):
+        store.set('%s/%d' % (name, self.rank), '1')
+        store.wait(['%s/%d' % (name, rank) for rank in range(self.world_size)])
+
+    def test_push_pull(self):
+        store = c10d.FileStore(self.file.name)
+        ps = c10d.ParameterServer(store, self.rank, self.world_size, self.opts())
+
+        table_opts = c10d.ParameterServer.TableOptions()
+        table_opts.learningRate = 1.0
+        ps.create_table('sgd', 10, 2, table_opts)
+
+        # Rows of every shard, and a duplicate row
+        rows = [self.rank, self.rank + 1, 9, 9]
+        ps.push('sgd', torch.LongTensor(rows), torch.ones(len(rows), 2)).wait()
+        self.barrier(store, 'push')
+
+        output = torch.zeros(10, 2)
+        work = ps.pull('sgd', torch.arange(10, dtype=torch.long), output)
+        self.assertTrue(work.wait())
+        expected = torch.zeros(10, 2)
+        for rank in range(self.world_size):
+            for row in [rank, rank + 1, 9, 9]:
+                expected[row] -= 1.0
+        self.assertEqual(expected, output)
+
+        # The optimizer state lives with the row
+        table_opts.optimizer = c10d.ParameterServer.Optimizer.ADAGRAD
+        ps.create_table('adagrad', 4, 1, table_opts)
+        if self.rank == 0:
+            ps.push('adagrad', torch.LongTensor([3, 3]), torch.Tensor([[2.0], [2.0]])).wait()
+        self.barrier(store, 'push_adagrad')
+
+        output = torch.zeros(1, 1)
+        ps.pull('adagrad', torch.LongTensor([3]), output).wait()
+        expected = -2.0 / (2.0 + table_opts.epsilon) - 2.0 / (math.sqrt(8.0) + table_opts.epsilon)
+        self.assertAlmostEqual(expected, output.item(), places=5)
+
+        # Out of range rows fail the work
+        work = ps.pull('adagrad', torch.LongTensor([4]), output)
+        self.assertFalse(work.wait())
+        self.barrier(store, 'done')
+
 
 class ProcessGroupNCCLTest(TestCase):
     MAIN_PROCESS_RANK = 0
@@ -531,6 +747,20 @@ class ProcessGroupNCCLTest(TestCase):
             for i in range(self.num_gpus):
                 self.assertEqual(tensors[i], tensors[rt])
 
+    def test_precreated_communicators(self):
+        store = c10d.FileStore(self.file.name)
+        opts = c10d.ProcessGroupNCCL.Options()
+        opts.deviceSets = [list(range(self.num_gpus))]
+        opts.highPriorityStreams = False
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size, opts)
+
+        tensors = [torch.Tensor([i + 1]).cuda(i) for i in range(self.num_gpus)]
+        pg.allreduce(tensors).wait()
+        for i in range(self.num_gpus):
+            self.assertEqual(
+                torch.Tensor([float(self.num_gpus * (self.num_gpus + 1) / 2)]),
+                tensors[i])
+
     def test_allreduce_ops(self):
         store = c10d.FileStore(self.file.name)
         pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
@@ -633,6 +863,66 @@ class ProcessGroupNCCLTest(TestCase):
             for s_idx, t in enumerate(device_ts):
                 self.assertEqual(torch.Tensor([s_idx]), t)
 
+    def test_reduce_scatter_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+
+        def reduce_scatter(output_ts, input_ts):
+            work = pg.reduce_scatter(output_ts, input_ts)
+            work.wait()
+
+        # The inputs of device i hold i + j for every device j, so device j
+        # receives the sum of i + j over all devices
+        output_ts = []
+        input_ts = []
+        for i in range(self.num_gpus):
+            output_ts.append(torch.Tensor([-1]).cuda(i))
+            input_ts.append([torch.Tensor([i + j]).cuda(i)
+                             for j in range(self.world_size * self.num_gpus)])
+
+        reduce_scatter(output_ts, input_ts)
+
+        # Verification
+        for j, t in enumerate(output_ts):
+            expected = self.num_gpus * j + self.num_gpus * (self.num_gpus - 1) / 2
+            self.assertEqual(torch.Tensor([expected]), t)
+
+    def test_hierarchical_allreduce_ops(self):
+        store = c10d.FileStore(self.file.name)
+        intra_node_store = c10d.PrefixStore("intra", store)
+        inter_node_store = c10d.PrefixStore("inter", store)
+        intra_node_pg = c10d.ProcessGroupNCCL(intra_node_store, self.rank, self.world_size)
+        opts = c10d.ProcessGroupGloo.Options()
+        opts.devices = [c10d.ProcessGroupGloo.create_tcp_device(interface="lo")]
+        inter_node_pg = c10d.ProcessGroupGloo(inter_node_store, self.rank, self.world_size, opts)
+        pg = c10d.ProcessGroupHierarchical(
+            self.rank, self.world_size, intra_node_pg, inter_node_pg)
+        self.assertTrue(pg.is_node_leader())
+
+        tensors = []
+        for i in range(self.num_gpus):
+            tensors.append(torch.Tensor([i + 1]).cuda(i))
+
+        work = pg.allreduce(tensors)
+        work.wait()
+
+        for i in range(self.num_gpus):
+            self.assertEqual(
+                torch.Tensor([float(self.num_gpus * (self.num_gpus + 1) / 2)]),
+                tensors[i])
+
+        times = pg.stage_times()
+        for stage in ["intra_node_reduce", "inter_node_allreduce", "intra_node_broadcast"]:
+            count, seconds = times[stage]
+            self.assertEqual(1, count)
+            self.assertGreaterEqual(seconds, 0)
+        pg.reset_stage_times()
+        self.assertEqual(0, pg.stage_times()["intra_node_reduce"][0])
+
+        # Only node leaders have an inter-node group
+        with self.assertRaises(RuntimeError):
+            c10d.ProcessGroupHierarchical(self.rank, self.world_size, intra_node_pg, None)
+
 
 class Net(nn.Module):
     def __init__(self):
@@ -720,6 +1010,47 @@ class DistributedDataParallelTest(MultiProcessTestCase):
         self._test_ddp_with_process_group(process_group, gpus)
         self._test_ddp_with_process_group(process_group, list(map(lambda i: torch.device('cuda:' + str(i)), gpus)))
 
+    def test_reducer_averages_gradients(self):
+        store = c10d.FileStore(self.file.name)
+        options = c10d.ProcessGroupGloo.Options()
+        options.devices = [c10d.ProcessGroupGloo.create_tcp_device(interface="lo")]
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size, options)
+
+        model = nn.Linear(4, 3)
+        params = list(model.parameters())
+        bucket_indices = c10d._compute_bucket_assignment_by_size(params, 16)
+        reducer = c10d.Reducer([params], bucket_indices, process_group)
+        for _ in range(2):
+            model.zero_grad()
+            model(torch.full((2, 4), self.rank + 1)).sum().backward()
+            # The average of the gradients 2 * (rank + 1) of the two processes
+            self.assertEqual(model.weight.grad, torch.full((3, 4), 3))
+            self.assertEqual(model.bias.grad, torch.full((3,), 2))
+
+    def test_reducer_fp16_comm_hook(self):
+        store = c10d.FileStore(self.file.name)
+        options = c10d.ProcessGroupGloo.Options()
+        options.devices = [c10d.ProcessGroupGloo.create_tcp_device(interface="lo")]
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size, options)
+
+        model = nn.Linear(4, 3)
+        params = list(model.parameters())
+        bucket_indices = c10d._compute_bucket_assignment_by_size(params, 16)
+        reducer = c10d.Reducer([params], bucket_indices, process_group)
+        reducer.register_comm_hook(c10d.FP16CompressCommHook())
+        for _ in range(2):
+            model.zero_grad()
+            model(torch.full((2, 4), self.rank + 1.5)).sum().backward()
+            # The averages are exact in half precision
+            self.assertEqual(model.weight.grad, torch.full((3, 4), 4))
+            self.assertEqual(model.bias.grad, torch.full((3,), 2))
+
+    def test_compute_bucket_assignment_by_size(self):
+        tensors = [torch.empty(4), torch.empty(4), torch.empty(2, dtype=torch.double), torch.empty(8)]
+        # Reverse order, at least 40 bytes per bucket, one type per bucket
+        self.assertEqual(c10d._compute_bucket_assignment_by_size(tensors, 40), [[3, 1], [2], [0]])
+        self.assertEqual(c10d._compute_bucket_assignment_by_size(tensors, 1), [[3], [2], [1], [0]])
+
     @skip_if_not_multigpu
     def test_dist_broadcast_coalesced(self):
         store = c10d.FileStore(self.file.name)
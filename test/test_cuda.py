@@ -1,4 +1,5 @@
 import io
+import json
 import math
 import tempfile
 import re
@@ -825,6 +826,90 @@ class TestCuda(TestCase):
                 end1 = advance(gen1, end1)
                 t += 1
 
+    def test_memory_snapshot(self):
+        def device_segments():
+            device = torch.cuda.current_device()
+            return [s for s in torch.cuda.memory_snapshot() if s['device'] == device]
+
+        torch.cuda.empty_cache()
+        x = torch.empty(1024 * 1024 * 8, dtype=torch.uint8, device='cuda')
+        y = torch.empty(1024, dtype=torch.uint8, device='cuda')
+        segments = device_segments()
+        for segment in segments:
+            self.assertEqual(segment['total_size'], sum(b['size'] for b in segment['blocks']))
+            self.assertEqual(segment['allocated_size'],
+                             sum(b['size'] for b in segment['blocks'] if b['state'] == 'allocated'))
+        self.assertEqual(sum(s['allocated_size'] for s in segments), torch.cuda.memory_allocated())
+        self.assertEqual(sum(s['total_size'] for s in segments), torch.cuda.memory_cached())
+        def segment_type(ptr):
+            for s in segments:
+                if s['address'] <= ptr < s['address'] + s['total_size']:
+                    return s['segment_type']
+
+        self.assertEqual(segment_type(x.data_ptr()), 'large')
+        self.assertEqual(segment_type(y.data_ptr()), 'small')
+        del x, y
+
+    def test_memory_history(self):
+        torch.cuda.record_memory_history(max_entries=4)
+        try:
+            x = torch.empty(1024, dtype=torch.uint8, device='cuda')
+            ptr = x.data_ptr()
+            del x
+            trace = [e for e in torch.cuda.memory_trace() if e['address'] == ptr]
+            self.assertEqual([e['action'] for e in trace[-2:]], ['alloc', 'free'])
+            self.assertTrue(all(e['size'] == 1024 for e in trace[-2:]))
+
+            y = torch.empty(1024, dtype=torch.uint8, device='cuda')
+            blocks = [b for s in torch.cuda.memory_snapshot() for b in s['blocks']
+                      if b['state'] == 'allocated']
+            self.assertTrue(all(b['backtrace'] for b in blocks if b['size'] == 1024))
+
+            for _ in range(10):
+                torch.empty(1024, dtype=torch.uint8, device='cuda')
+            self.assertEqual(len(torch.cuda.memory_trace()), 4)
+
+            f = io.StringIO() if sys.version_info[0] >= 3 else io.BytesIO()
+            torch.cuda.dump_memory_snapshot(f)
+            self.assertEqual(sorted(json.loads(f.getvalue()).keys()), ['segments', 'trace'])
+            del y
+        finally:
+            torch.cuda.record_memory_history(False)
+
+    def test_max_split_size(self):
+        mb = 1024 * 1024
+        old_max_split_size = torch.cuda.max_split_size()
+        try:
+            torch.cuda.empty_cache()
+            torch.cuda.set_max_split_size(None)
+            self.assertIsNone(torch.cuda.max_split_size())
+
+            # a cached 64 MB block is split for a 32 MB request...
+            x = torch.empty(64 * mb, dtype=torch.uint8, device='cuda')
+            ptr = x.data_ptr()
+            del x
+            y = torch.empty(32 * mb, dtype=torch.uint8, device='cuda')
+            self.assertEqual(y.data_ptr(), ptr)
+            del y
+
+            # ...but not once it is oversize
+            torch.cuda.set_max_split_size(16 * mb)
+            self.assertEqual(torch.cuda.max_split_size(), 16 * mb)
+            y = torch.empty(32 * mb, dtype=torch.uint8, device='cuda')
+            self.assertNotEqual(y.data_ptr(), ptr)
+            # nor used for a smaller request
+            z = torch.empty(4 * mb, dtype=torch.uint8, device='cuda')
+            self.assertNotEqual(z.data_ptr(), ptr)
+            # blocks in the oversize range are reused within the slack
+            del y
+            w = torch.empty(20 * mb, dtype=torch.uint8, device='cuda')
+            self.assertTrue(any(s['address'] == w.data_ptr() and s['total_size'] == 32 * mb
+                                for s in torch.cuda.memory_snapshot()))
+            del w, z
+        finally:
+            torch.cuda.set_max_split_size(old_max_split_size)
+            torch.cuda.empty_cache()
+
     @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
     @skipIfRocm
     def test_autogpu(self):
@@ -1051,6 +1136,27 @@ class TestCuda(TestCase):
         self.assertEqual(result.get_device(), 0)
         self.assertEqual(result.cpu(), x + y)
 
+    @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
+    @skipIfRocm
+    def test_reduce_add_destination(self):
+        x = torch.randn(5, 5)
+        y = torch.randn(5, 5)
+        inputs = (x.cuda(0), y.cuda(1))
+        result = comm.reduce_add(inputs, destination=1)
+        self.assertEqual(result.get_device(), 1)
+        self.assertEqual(result.cpu(), x + y)
+        # the inputs must not be overwritten
+        self.assertEqual(inputs[0].cpu(), x)
+        self.assertEqual(inputs[1].cpu(), y)
+
+        tensors = [torch.randn(numel).cuda(0) for numel in (5, 100, 7, 1000)]
+        dup_tensors = [tensors, [t.cuda(1) for t in tensors]]
+        # a small buffer so that several buckets are in flight at once
+        results = comm.reduce_add_coalesced(dup_tensors, destination=1, buffer_size=64)
+        for r, t in zip(results, tensors):
+            self.assertEqual(r.get_device(), 1)
+            self.assertEqual(r.cpu(), t.cpu() * 2)
+
     @staticmethod
     def _test_reduce_add_coalesced(self, tensors, buffer_size):
         dup_tensors = [tensors, list(map(lambda t: t.cuda(1), tensors))]
@@ -1494,6 +1600,19 @@ class TestCuda(TestCase):
         self.assertEqual(gpu_tensor1[0], 1)
         self.assertEqual(gpu_tensor0[0], 2)
 
+    def test_copy_non_blocking_pageable(self):
+        # pageable memory is staged through pinned buffers in chunks; the
+        # source can be changed as soon as copy_ returns
+        cycles_per_ms = get_cycles_per_ms()
+        for numel in [1, 1000, 1000000]:
+            src = torch.randn(numel + 5)[5:]  # starts inside its storage
+            expected = src.clone()
+            gpu_tensor = torch.cuda.FloatTensor(numel)
+            torch.cuda._sleep(int(50 * cycles_per_ms))  # delay the copy
+            gpu_tensor.copy_(src, non_blocking=True)
+            src.zero_()
+            self.assertEqual(gpu_tensor.cpu(), expected)
+
     @staticmethod
     def _select_broadcastable_dims(dims_full=None):
         return TestTorch._select_broadcastable_dims(dims_full)
@@ -1810,6 +1929,50 @@ class TestCuda(TestCase):
         tensor = tensor.unsqueeze(1)
         self.assertEqual(tensor.var(0), 0.03125)
 
+    def test_reduction_layouts(self):
+        # Covers the ways the reduction kernel splits its work: across lanes
+        # or across outputs, across warps, and across blocks for long rows.
+        shapes = [((5, 300000), (1,)), ((300000, 5), (0,)), ((7, 33, 129), (0, 2)),
+                  ((4, 5, 6, 7), (1, 3)), ((3, 1, 2048), (2,))]
+        for shape, dims in shapes:
+            cpu_tensor = torch.randn(*shape, dtype=torch.double)
+            for x in [cpu_tensor, cpu_tensor.transpose(0, -1).contiguous().transpose(0, -1)]:
+                y = x.cuda()
+                self.assertEqual(x.sum(dims), y.sum(dims))
+                self.assertEqual(x.sum(dims, keepdim=True), y.sum(dims, keepdim=True))
+                self.assertEqual(x.mean(dims[0]), y.mean(dims[0]))
+                self.assertEqual(x.var(dims[0]), y.var(dims[0]))
+                self.assertEqual(x.std(dims[0], unbiased=False), y.std(dims[0], unbiased=False))
+                self.assertEqual(x.var(), y.var())
+                self.assertEqual(x.sum(), y.sum(), prec=1e-8)
+
+        # rows that don't start on a 16 byte boundary use unaligned loads first
+        x = torch.randn(10, 1003, device='cuda')
+        for offset in range(4):
+            view = x[:, offset:]
+            self.assertEqual(view.sum(1), view.cpu().sum(1), prec=1e-4)
+            view = view / 10 + 1
+            self.assertEqual(view.prod(1), view.cpu().prod(1), prec=1e-4)
+
+        x = torch.randn(64, 500, device='cuda').half()
+        self.assertEqual(x.sum(1).float(), x.float().sum(1), prec=1e-1)
+        self.assertEqual(x.var(1).float(), x.float().var(1), prec=1e-2)
+
+        result = torch.cuda.FloatTensor()
+        torch.sum(x.float(), (0, 1), out=result)
+        self.assertEqual(result, x.float().cpu().sum((0, 1)), prec=1e-2)
+
+    def test_var_mean(self):
+        x = torch.randn(17, 1000, 3, dtype=torch.double)
+        for dim in range(x.dim()):
+            for unbiased in [True, False]:
+                var, mean = torch._var_mean(x.cuda(), dim, unbiased)
+                self.assertEqual(var, x.var(dim, unbiased))
+                self.assertEqual(mean, x.mean(dim))
+                var, mean = torch._var_mean(x.cuda(), dim, unbiased, keepdim=True)
+                self.assertEqual(var, x.var(dim, unbiased, keepdim=True))
+                self.assertEqual(mean, x.mean(dim, keepdim=True))
+
     @skipIfRocm
     def test_digamma(self):
         def test(use_double=False):
@@ -12,7 +12,7 @@ import unittest
 import subprocess
 import itertools
 from torch import multiprocessing as mp
-from torch.utils.data import Dataset, TensorDataset, DataLoader, ConcatDataset
+from torch.utils.data import Dataset, TensorDataset, DataLoader, ConcatDataset, CUDAPrefetcher
 from torch.utils.data.dataset import random_split
 from torch.utils.data.dataloader import default_collate, ExceptionWrapper, MP_STATUS_CHECK_INTERVAL
 from common_utils import TestCase, run_tests, TEST_NUMPY, IS_WINDOWS, NO_MULTIPROCESSING_SPAWN, skipIfRocm
@@ -583,6 +583,32 @@ class TestDataLoader(TestCase):
             self.assertTrue(input.is_pinned())
             self.assertTrue(target.is_pinned())
 
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    @skipIfRocm
+    def test_cuda_prefetcher(self):
+        for num_workers in (0, 2):
+            loader = DataLoader(self.dataset, batch_size=2, num_workers=num_workers)
+            prefetcher = CUDAPrefetcher(loader)
+            self.assertEqual(len(prefetcher), len(loader))
+            for i, (sample, target) in enumerate(prefetcher):
+                self.assertTrue(sample.is_cuda)
+                self.assertTrue(target.is_cuda)
+                idx = i * 2
+                self.assertEqual(sample.cpu(), self.data[idx:idx + 2])
+                self.assertEqual(target.cpu(), self.labels[idx:idx + 2])
+            self.assertEqual(i, len(loader) - 1)
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    @skipIfRocm
+    def test_pin_memory_in_place(self):
+        t = torch.randn(16, 8).share_memory_()
+        ptr = t.data_ptr()
+        self.assertFalse(t.is_pinned())
+        t._pin_memory_in_place()
+        self.assertTrue(t.is_pinned())
+        self.assertEqual(t.data_ptr(), ptr)
+        self.assertEqual(t.cuda(non_blocking=True).cpu(), t)
+
     @unittest.skipIf(not TEST_NUMPY, "numpy unavailable")
     def test_numpy(self):
         import numpy as np
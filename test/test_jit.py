@@ -419,6 +419,303 @@ class TestJit(JitTestCase):
         torch._C._jit_pass_peephole(fn.graph)
         self.assertEqual(s, str(fn.graph))
 
+    @unittest.skipIf(not torch._C.has_mkl, "MKL not available")
+    def test_prepack_linear(self):
+        weight = torch.randn(5, 4)
+        bias = torch.randn(5)
+
+        def fn(x):
+            return F.linear(x, weight, bias), torch.matmul(x, weight.t())
+
+        x = torch.randn(3, 4)
+        traced = torch.jit.trace(fn, (x,))
+        expected = fn(x)
+        self.run_pass('prepack_linear', traced.graph)
+        self.assertGraphContains(traced.graph, kind='aten::_mkl_linear_packed')
+        kinds = [n.kind() for n in traced.graph.nodes()]
+        self.assertNotIn('aten::addmm', kinds)
+        self.assertNotIn('aten::matmul', kinds)
+        self.assertEqual(traced(x), expected)
+
+        # weights that are inputs to the graph are left alone
+        traced = torch.jit.trace(lambda x, w: F.linear(x, w), (x, weight))
+        graph_str = str(traced.graph)
+        self.run_pass('prepack_linear', traced.graph)
+        self.assertEqual(graph_str, str(traced.graph))
+
+    def test_fuse_quantized_ops(self):
+        w1 = torch.randn(6, 8)
+        b1 = torch.randn(6)
+        w2 = torch.randn(3, 6)
+
+        def fn(x):
+            x = torch.dequantize_linear(torch.quantize_linear(x, 0.05, 128), 0.05, 128)
+            h = F.relu(F.linear(x, w1, b1))
+            h = torch.dequantize_linear(torch.quantize_linear(h, 0.1, 0), 0.1, 0)
+            h = h.view(2, 6)
+            y = torch.matmul(h, w2.t())
+            return torch.dequantize_linear(torch.quantize_linear(y, 0.2, 100), 0.2, 100)
+
+        x = torch.rand(2, 8) * 4 - 2
+        traced = torch.jit.trace(fn, (x,))
+        expected = fn(x)
+        self.run_pass('fuse_quantized_ops', traced.graph)
+        kinds = [n.kind() for n in traced.graph.nodes()]
+        self.assertEqual(kinds.count('aten::quantized_linear'), 2)
+        self.assertNotIn('aten::addmm', kinds)
+        self.assertNotIn('aten::matmul', kinds)
+        self.assertNotIn('aten::relu', kinds)
+        # only rounding the weights to int8 changes the result
+        self.assertEqual(traced(x), expected, prec=0.5)
+
+        xq = torch.quantize_linear(x, 0.05, 128)
+        self.assertEqual(xq.dtype, torch.uint8)
+        self.assertEqual(torch.dequantize_linear(xq, 0.05, 128), x, prec=0.025)
+        wq = (w1 / 0.02).round().clamp(-127, 127).to(torch.int8)
+        out = torch.quantized_linear(xq, 0.05, 128, wq, 0.02, b1, 0.1, 0, True)
+        reference = F.relu(F.linear(torch.dequantize_linear(xq, 0.05, 128), wq.float() * 0.02, b1))
+        self.assertEqual(torch.dequantize_linear(out, 0.1, 0), reference.clamp(max=25.5), prec=0.05 + 1e-4)
+
+    def test_freeze(self):
+        class M(torch.jit.ScriptModule):
+            def __init__(self):
+                super(M, self).__init__()
+                self.conv_weight = nn.Parameter(torch.randn(4, 3, 3, 3))
+                self.bn_weight = nn.Parameter(torch.randn(4))
+                self.bn_bias = nn.Parameter(torch.randn(4))
+                self.register_buffer('running_mean', torch.randn(4))
+                self.register_buffer('running_var', torch.rand(4) + 0.5)
+                self.fc_weight = nn.Parameter(torch.randn(5, 4))
+
+            @torch.jit.script_method
+            def forward(self, x):
+                y = torch.conv2d(x, self.conv_weight)
+                y = torch.batch_norm(y, self.bn_weight, self.bn_bias, self.running_mean, self.running_var,
+                                     False, 0.1, 1e-5, False)
+                return torch.linear(y.mean(3).mean(2), self.fc_weight)
+
+        m = M()
+        graph = m.graph.copy()
+        torch._C._jit_pass_freeze_parameters(graph, m._get_method('forward').params())
+        self.assertEqual(len(list(graph.inputs())), 1)
+        torch._C._jit_pass_optimize_frozen_graph(graph)
+        kinds = [n.kind() for n in graph.nodes()]
+        self.assertNotIn('aten::batch_norm', kinds)
+        self.assertNotIn('aten::linear', kinds)
+        self.assertIn('aten::conv2d', kinds)
+
+        frozen = torch.jit.ScriptModule()
+        frozen._create_method_from_graph('forward', graph)
+        x = torch.randn(2, 3, 8, 8)
+        with torch.no_grad():
+            self.assertEqual(frozen(x), m(x))
+
+    def test_memory_planning(self):
+        def fn(x, w):
+            a = torch.mm(x, w)
+            b = torch.tanh(a)
+            c = torch.mm(b, w)
+            d = torch.sigmoid(c)
+            return torch.mm(d, w) + x
+
+        x = torch.randn(4, 4)
+        w = torch.randn(4, 4)
+        traced = torch.jit.trace(fn, (x, w))
+        torch._C._jit_set_memory_planning_enabled(True)
+        try:
+            self.assertEqual(traced(x, w), fn(x, w))
+            self.assertEqual(traced(x, w), fn(x, w))
+            graph = traced.graph_for(x, w)
+        finally:
+            torch._C._jit_set_memory_planning_enabled(False)
+
+        self.assertGraphContains(graph, kind='prim::AllocateArena')
+        # every intermediate gets a slot, but the returned sum owns its memory
+        slots = [n for n in graph.nodes() if n.kind() == 'prim::ArenaSlot']
+        self.assertEqual(len(slots), 5)
+        # intermediates that are never live at the same time share memory
+        self.assertEqual(len(set(n.i('offset') for n in slots)), 2)
+
+    def test_convert_to_inplace(self):
+        def fn(x, y):
+            a = torch.relu(x * y)
+            b = torch.sigmoid(a) + a
+            return torch.tanh(b)
+
+        x, y = torch.randn(4, 4), torch.randn(4, 4)
+        traced = torch.jit.trace(fn, (x, y))
+        graph = traced.graph.copy()
+        self.run_pass('convert_to_inplace', graph)
+        kinds = [n.kind() for n in graph.nodes()]
+        # x is an input and a is still used after sigmoid
+        self.assertIn('aten::mul', kinds)
+        self.assertIn('aten::sigmoid', kinds)
+        for kind in ['aten::relu_', 'aten::add_', 'aten::tanh_']:
+            self.assertIn(kind, kinds)
+
+        m = torch.jit.ScriptModule()
+        m._create_method_from_graph('forward', graph)
+        x_copy, y_copy = x.clone(), y.clone()
+        with torch.no_grad():
+            self.assertEqual(m(x, y), fn(x_copy, y_copy))
+        self.assertEqual(x, x_copy)
+        self.assertEqual(y, y_copy)
+
+    def test_parallelize_branches(self):
+        def fn(x, w1, w2):
+            a = torch.mm(torch.tanh(torch.mm(torch.mm(x, w1), w1)), w1)
+            b = torch.mm(torch.sigmoid(torch.mm(torch.mm(x, w2), w2)), w2)
+            return torch.cat([a, b]) * 2
+
+        x, w1, w2 = torch.randn(8, 8), torch.randn(8, 8), torch.randn(8, 8)
+        traced = torch.jit.trace(fn, (x, w1, w2))
+        graph = traced.graph.copy()
+        self.run_pass('parallelize_branches', graph)
+        nodes = [n for n in graph.nodes() if n.kind() == 'prim::ParallelBranches']
+        self.assertEqual(len(nodes), 1)
+        self.assertEqual(len(nodes[0].gs('Subgraphs')), 2)
+        self.assertGraphContains(graph, kind='aten::cat')
+
+        old_threads = torch._C._jit_get_inter_op_threads()
+        torch._C._jit_set_inter_op_threads(4)
+        try:
+            self.assertEqual(traced(x, w1, w2), fn(x, w1, w2))
+            self.assertEqual(traced(x, w1, w2), fn(x, w1, w2))
+            graph = traced.graph_for(x, w1, w2)
+        finally:
+            torch._C._jit_set_inter_op_threads(old_threads)
+        self.assertGraphContains(graph, kind='prim::ParallelBranches')
+
+    def test_batch_mm_side(self):
+        def shared_lhs(x, w1, w2, w3):
+            return torch.mm(x, w1) * torch.mm(x, w2) + torch.mm(x, w3)
+
+        x = torch.randn(64, 32)
+        ws = [torch.randn(32, 16) for _ in range(3)]
+        traced = torch.jit.trace(shared_lhs, (x,) + tuple(ws))
+        self.assertEqual(traced(x, *ws), shared_lhs(x, *ws))
+        graph = traced.graph_for(x, *ws)
+        self.assertEqual(len([n for n in graph.nodes() if n.kind() == 'aten::mm']), 1)
+
+        # traced F.linear turns into addmm
+        def shared_addmm(x, w1, b1, w2, b2):
+            return F.linear(x, w1, b1).sum() + F.linear(x, w2, b2).sum()
+
+        args = (x, torch.randn(16, 32), torch.randn(16), torch.randn(24, 32), torch.randn(24))
+        traced = torch.jit.trace(shared_addmm, args)
+        self.assertEqual(traced(*args), shared_addmm(*args))
+        graph = traced.graph_for(*args)
+        self.assertEqual(len([n for n in graph.nodes() if n.kind() == 'aten::addmm']), 1)
+
+        @torch.jit.script
+        def shared_linear(x, w1, b1, w2, b2):
+            return torch.linear(x, w1, b1).sum() + torch.linear(x, w2, b2).sum()
+
+        self.assertEqual(shared_linear(*args), shared_addmm(*args))
+        graph = shared_linear.graph_for(*args)
+        self.assertEqual(len([n for n in graph.nodes() if n.kind() == 'aten::linear']), 1)
+
+        # operands of the same shape that share nothing are only batched on the GPU
+        def independent(a, b, c, d):
+            return torch.mm(a, b) * torch.mm(c, d)
+
+        args = (x, ws[0], torch.randn(64, 32), ws[1])
+        traced = torch.jit.trace(independent, args)
+        self.assertEqual(traced(*args), independent(*args))
+        graph = traced.graph_for(*args)
+        self.assertEqual(len([n for n in graph.nodes() if n.kind() == 'aten::mm']), 2)
+
+    @unittest.skipIf(not RUN_CUDA, "batching independent mms requires CUDA")
+    def test_batch_mm_independent_cuda(self):
+        def independent(a, b, c, d):
+            return torch.mm(a, b) * torch.mm(c, d)
+
+        args = tuple(torch.randn(64, 32, device='cuda') if i % 2 == 0 else torch.randn(32, 16, device='cuda')
+                     for i in range(4))
+        traced = torch.jit.trace(independent, args)
+        self.assertEqual(traced(*args), independent(*args))
+        graph = traced.graph_for(*args)
+        self.assertGraphContains(graph, kind='aten::bmm')
+
+    def test_profiler(self):
+        @torch.jit.script
+        def fn(x, w):
+            y = torch.mm(x, w)
+            return torch.tanh(y)
+
+        x, w = torch.randn(4, 4), torch.randn(4, 4)
+        with torch.autograd.profiler.profile() as prof:
+            fn(x, w)
+            fn(x, w)
+        names = [e.name for e in prof.function_events]
+        # nodes are attributed to the line of code they come from
+        self.assertEqual(names.count('aten::mm (y = torch.mm(x, w))'), 2)
+        # compilation only happens on the first run
+        self.assertEqual(names.count('GraphExecutor::compile'), 1)
+        self.assertIn('jit::PropagateInputShapes', names)
+
+    def test_plan_cache(self):
+        @torch.jit.script
+        def fn(x):
+            return x * 2 + 1
+
+        # sizes aren't part of the specialization, only ranks are
+        for batch in range(1, 6):
+            fn(torch.randn(batch, 3))
+        state = fn.get_debug_state()
+        self.assertEqual(len(state.execution_plans), 1)
+        self.assertEqual(state.plan_cache_misses, 1)
+        self.assertEqual(state.plan_cache_hits, 4)
+
+        old_capacity = torch._C._jit_get_plan_cache_capacity()
+        torch._C._jit_set_plan_cache_capacity(2)
+        try:
+            fn(torch.randn(3))
+            fn(torch.randn(2, 3, 4))
+            fn(torch.randn(2, 3))
+        finally:
+            torch._C._jit_set_plan_cache_capacity(old_capacity)
+        state = fn.get_debug_state()
+        self.assertEqual(len(state.execution_plans), 2)
+        self.assertEqual(state.plan_cache_misses, 4)
+        self.assertEqual(state.plan_cache_evictions, 2)
+
+    def test_plan_cache_alternating_specs(self):
+        @torch.jit.script
+        def fn(x):
+            return x * 2
+
+        # the plan run last is checked first, but a mismatch must still find the right one
+        for _ in range(2):
+            self.assertEqual(fn(torch.ones(2)).dtype, torch.float)
+            self.assertEqual(fn(torch.ones(2, dtype=torch.double)).dtype, torch.double)
+            self.assertFalse(fn(torch.ones(2)).requires_grad)
+            self.assertTrue(fn(torch.ones(2, requires_grad=True)).requires_grad)
+        state = fn.get_debug_state()
+        self.assertEqual(len(state.execution_plans), 3)
+        self.assertEqual(state.plan_cache_misses, 3)
+        self.assertEqual(state.plan_cache_hits, 5)
+
+    def test_pass_report(self):
+        @torch.jit.script
+        def fn(x):
+            y = x * 2 + 1
+            z = x * 2 + 1
+            return y + z
+
+        torch._C._jit_clear_pass_report()
+        torch._C._jit_set_pass_report_enabled(True)
+        try:
+            fn(torch.randn(3))
+        finally:
+            torch._C._jit_set_pass_report_enabled(False)
+        report = torch._C._jit_get_pass_report()
+        torch._C._jit_clear_pass_report()
+        calls, seconds, nodes_before, nodes_after = report['EliminateCommonSubexpression']
+        self.assertGreaterEqual(calls, 1)
+        self.assertGreaterEqual(seconds, 0)
+        self.assertLess(nodes_after, nodes_before)
+
     @unittest.skipIf(not RUN_CUDA, "cpp tests require CUDA")
     def test_peephole_cuda(self):
         a = torch.tensor([0.4], device='cpu')
@@ -2084,6 +2381,29 @@ class TestBatched(TestCase):
         res = [torch.add(xs[j], b) for j in range(4)]
         self.assertEqual(res, res_batch.examples())
 
+    def test_dynamic_batch(self):
+        import threading
+
+        @torch.jit.dynamic_batch([[True, False]], max_batch_size=4, max_delay_ms=50.)
+        def tanh(a):
+            return torch.tanh(a)
+
+        xs = [torch.rand(random.randint(1, 5), 2) for _ in range(6)]
+        results = [None] * len(xs)
+
+        def run(i):
+            results[i] = tanh(xs[i])
+
+        threads = [threading.Thread(target=run, args=(i,)) for i in range(len(xs))]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(results, [torch.tanh(x) for x in xs])
+
+        with self.assertRaisesRegex(RuntimeError, "expected 1 inputs"):
+            tanh(xs[0], xs[1])
+
     def test_batch_mm(self):
         @torch.jit.batch(batch_size=4)
         def mm(a, b):
@@ -3748,6 +4068,102 @@ a")
         ge = self.checkScript(fn, (x, y))
         self.assertExpectedGraph(ge.graph_for(x, y))
 
+    @unittest.skipIf(IS_WINDOWS or IS_SANDCASTLE, "NYI: fuser support for Windows or Sandcastle")
+    @enable_cpu_fuser
+    def test_fusion_cpu_large_noncontiguous(self):
+        # large enough to be split into many blocks and across threads, with
+        # one input that has to be gathered
+        def fn(x, y):
+            return torch.tanh(x * y + 0.5) * torch.sigmoid(y)
+
+        x = torch.randn(300, 257, dtype=torch.float)
+        y = torch.randn(257, 300, dtype=torch.float).t()
+        ge = self.checkTrace(fn, (x, y))
+        self.assertAllFused(ge.graph_for(x, y))
+
+    @unittest.skipIf(IS_WINDOWS or IS_SANDCASTLE, "NYI: fuser support for Windows or Sandcastle")
+    def test_fusion_cpu_kernel_cache(self):
+        # kernels compiled by one process are reused by the next one, even
+        # though it compiles them under a different name
+        import subprocess
+        script = dedent('''
+            import torch
+            torch._C._jit_override_can_fuse_on_cpu(True)
+
+            @torch.jit.script
+            def unused(x, y):
+                return x * y + y
+
+            @torch.jit.script
+            def fn(x, y):
+                return torch.tanh(x + y) * y
+
+            x = torch.ones(4, 4)
+            y = torch.ones(4, 4)
+            if {compile_unused}:
+                unused(x, y)
+            print(fn(x, y).sum().item())
+        ''')
+        cache_dir = tempfile.mkdtemp()
+        try:
+            env = dict(os.environ, PYTORCH_FUSION_CACHE_DIR=cache_dir, PYTORCH_FUSION_CPU_COMPILE='1')
+
+            def run(compile_unused):
+                return subprocess.check_output(
+                    [sys.executable, '-c', script.format(compile_unused=compile_unused)], env=env)
+
+            first = run(compile_unused=True)
+            entries = sorted(os.listdir(cache_dir))
+            self.assertEqual(len([f for f in entries if f.endswith('.so')]), 2)
+            self.assertEqual(len([f for f in entries if f.endswith('.key')]), 2)
+            self.assertEqual(run(compile_unused=False), first)
+            self.assertEqual(sorted(os.listdir(cache_dir)), entries)
+        finally:
+            shutil.rmtree(cache_dir)
+
+    @unittest.skipIf(IS_WINDOWS or IS_SANDCASTLE, "NYI: fuser support for Windows or Sandcastle")
+    @enable_cpu_fuser
+    def test_fusion_reduction_cpu(self):
+        def sum_fn(x, b):
+            return torch.relu(x + b).sum(-1)
+
+        def mean_fn(x, b):
+            return (x * b - 1).mean(1, keepdim=True)
+
+        def var_fn(x, b):
+            return torch.sigmoid(x * b).var(-1)
+
+        def std_fn(x, b):
+            return torch.tanh(x - b).std(1, unbiased=False)
+
+        x = torch.randn(7, 130, dtype=torch.float)
+        b = torch.randn(130, dtype=torch.float)
+        for fn in (sum_fn, mean_fn, var_fn, std_fn):
+            ge = self.checkTrace(fn, (x, b))
+            self.assertAllFused(ge.graph_for(x, b))
+
+    @unittest.skipIf(IS_WINDOWS or IS_SANDCASTLE, "NYI: fuser support for Windows or Sandcastle")
+    @enable_cpu_fuser
+    def test_fusion_reduction_not_innermost_cpu(self):
+        def fn(x, y):
+            return (x * y).sum(0)
+
+        x = torch.randn(7, 13, dtype=torch.float)
+        y = torch.randn(7, 13, dtype=torch.float)
+        ge = self.checkTrace(fn, (x, y))
+        self.assertNotIn('prim::FusionGroup', str(ge.graph_for(x, y)))
+
+    @unittest.skipIf(IS_WINDOWS or IS_SANDCASTLE, "NYI: fuser support for Windows or Sandcastle")
+    @enable_cpu_fuser
+    def test_fusion_expand_cpu(self):
+        def fn(x, b):
+            return torch.tanh(x * b.expand(3, 4) + 1)
+
+        x = torch.randn(3, 4, dtype=torch.float)
+        b = torch.randn(4, dtype=torch.float)
+        ge = self.checkTrace(fn, (x, b))
+        self.assertAllFused(ge.graph_for(x, b))
+
     @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
     @unittest.skipIf(not RUN_CUDA, "fuser requires CUDA")
     @skipIfRocm
@@ -3955,6 +4371,32 @@ a")
         inputs = self._make_scalar_vars([-1234, 4321], torch.int64)
         self.checkScript(func, inputs, optimize=True)
 
+    def test_while_scalar_ops(self):
+        # int and float arithmetic and comparisons are run inline by the
+        # interpreter, check that they agree with the Python semantics
+        def func(n, x):
+            # type: (int, float) -> float
+            i = 0
+            a = 1
+            b = 2
+            y = 0.5
+            while i < n:
+                a, b = b, a * 3 - b
+                y = y * x - 0.25 + x
+                if a == b:
+                    y = y - 1.0
+                if a != b:
+                    if y >= 100.0:
+                        y = y / 4.0
+                if i > 0:
+                    if y <= 1.0:
+                        y = y + 1.0
+                i = i + 1
+            return y + float(a) - float(b)
+
+        self.checkScript(func, (8, 1.5), optimize=True)
+        self.checkScript(func, (3, -2.0), optimize=True)
+
     def test_math_schema(self):
         # This should use the add(Tensor, Tensor) schema.
         # Also tests to see if alpha={1} is lifted correctly.
@@ -4527,6 +4969,39 @@ a")
         m2.sub2.a.data.zero_()
         self.assertEqual(torch.zeros(2, 2), m2.forward(torch.randn(3, 2)))
 
+    def test_script_module_lazy_compilation(self):
+        class M(torch.jit.ScriptModule):
+            def __init__(self):
+                super(M, self).__init__()
+                self.define("""
+                    def broken(self, x):
+                        return x + not_defined
+                """)
+
+            @torch.jit.script_method
+            def forward(self, x):
+                return self.helper(x) + 1
+
+            @torch.jit.script_method
+            def helper(self, x):
+                return x * 2
+
+        with self.assertRaisesRegex(RuntimeError, "undefined value not_defined"):
+            M()
+
+        old_lazy = torch._C._jit_get_lazy_method_compilation()
+        torch._C._jit_set_lazy_method_compilation(True)
+        try:
+            m = M()
+        finally:
+            torch._C._jit_set_lazy_method_compilation(old_lazy)
+        x = torch.randn(3)
+        self.assertEqual(m(x), x * 2 + 1)
+        # errors are reported every time the method is used
+        for _ in range(2):
+            with self.assertRaisesRegex(RuntimeError, "undefined value not_defined"):
+                m.broken(x)
+
     def test_script_module_call_noscript(self):
         class M(torch.jit.ScriptModule):
             def __init__(self):
@@ -5545,6 +6020,60 @@ a")
         t = torch.rand(200)
         self.assertEqual(m_orig(t), m_import(t))
 
+    @unittest.skipIf(IS_WINDOWS or IS_SANDCASTLE, "NYI: fuser support for Windows or Sandcastle")
+    @enable_cpu_fuser
+    def test_script_module_export_for_inference(self):
+        class M(torch.jit.ScriptModule):
+            def __init__(self):
+                super(M, self).__init__()
+                self.weight = torch.nn.Parameter(torch.rand(4, 4))
+
+            @torch.jit.script_method
+            def forward(self, x):
+                return (x * self.weight + 1).tanh() * 2
+
+        m_orig = M()
+        x = torch.rand(4, 4)
+        buffer = io.BytesIO()
+        torch.jit.save(m_orig, buffer, example_inputs=(x,))
+        buffer.seek(0)
+        m_import = torch.jit.load(buffer)
+
+        # forward was saved post-optimization and runs without being optimized again
+        self.assertAllFused(m_import.graph)
+        with torch.no_grad():
+            self.assertEqual(m_orig(x), m_import(x))
+            self.assertEqual(m_orig(x), m_import(x))
+        self.assertEqual(len(m_import.get_debug_state().execution_plans), 0)
+
+    def test_script_module_load_mapped_file(self):
+        class M(torch.jit.ScriptModule):
+            def __init__(self):
+                super(M, self).__init__()
+                self.weight = torch.nn.Parameter(torch.rand(100, 100))
+
+            @torch.jit.script_method
+            def forward(self, x):
+                return self.weight.mm(x)
+
+        m_orig = M()
+        f = tempfile.NamedTemporaryFile(delete=False)
+        try:
+            f.close()
+            m_orig.save(f.name)
+            # loading from a file maps it, writes to the tensors must not reach it
+            m_first = torch.jit.load(f.name)
+            with torch.no_grad():
+                m_first.weight.zero_()
+            m_second = torch.jit.load(f.name)
+        finally:
+            os.unlink(f.name)
+
+        x = torch.rand(100, 3)
+        self.assertEqual(m_first.weight, torch.zeros(100, 100))
+        self.assertEqual(m_second.weight, m_orig.weight)
+        self.assertEqual(m_orig(x), m_second(x))
+
     def test_script_module_export_shared_storage(self):
         class M(torch.jit.ScriptModule):
 
@@ -5909,6 +6438,35 @@ a")
 
         self.checkScript(foo, (torch.zeros(1), torch.zeros(4), torch.zeros(5)), optimize=False)
 
+    def test_shape_analysis_keeps_rank_across_control_flow(self):
+        @torch.jit.script
+        def fn(x, y):
+            for _ in range(3):
+                x = torch.cat([x, y], dim=0)
+            if bool(x.sum() > 0):
+                z = x.flatten()
+            else:
+                z = y.flatten()
+            if True:
+                w = y
+            else:
+                w = x
+            return x, z, w
+
+        x = torch.randn(2, 3)
+        y = torch.randn(1, 3)
+        graph = fn.graph.copy()
+        torch._C._jit_pass_shape_analysis(graph, (x, y), False)
+        x_type, z_type, w_type = [o.type() for o in graph.outputs()]
+        # the loop and the first if change sizes, but not ranks
+        self.assertEqual(x_type.kind(), 'TensorType')
+        self.assertEqual(x_type.dim(), 2)
+        self.assertEqual(z_type.kind(), 'TensorType')
+        self.assertEqual(z_type.dim(), 1)
+        # only the true branch of the second if can run
+        self.assertEqual(w_type.kind(), 'CompleteTensorType')
+        self.assertEqual(w_type.sizes(), [1, 3])
+
     def test_intlist_args(self):
         def func_1(x):
             return torch.nn.functional.adaptive_avg_pool1d(x, 1)
@@ -6222,6 +6780,42 @@ a")
         self.checkScript(fn, (torch.tensor(1),))
         self.checkScript(fn, (torch.tensor(2),))
 
+    def test_loop_optimization(self):
+        def fn(x, w, n):
+            trips = int(n)
+            a = x
+            for i in range(trips):
+                a = torch.mm(a, w.t())
+            b = x
+            for i in range(trips):
+                b = b * 2
+            return a + b
+
+        graph = torch.jit.script(fn).graph
+        self.run_pass('fuse_loops', graph)
+        self.run_pass('hoist_loop_invariants', graph)
+        kinds = [n.kind() for n in graph.nodes()]
+        self.assertEqual(kinds.count('prim::Loop'), 1)
+        self.assertIn('aten::t', kinds)
+        self.checkScript(fn, (torch.randn(3, 3), torch.randn(3, 3), torch.tensor(3)))
+        self.checkScript(fn, (torch.randn(3, 3), torch.randn(3, 3), torch.tensor(0)))
+
+        def inplace(x, n):
+            y = torch.zeros(3)
+            for i in range(int(n)):
+                z = torch.zeros(3)
+                z.add_(x)
+                y = y + z
+            return y
+
+        graph = torch.jit.script(inplace).graph
+        self.run_pass('hoist_loop_invariants', graph)
+        # z is written to, so every iteration needs its own
+        self.assertNotIn('aten::add_', [n.kind() for n in graph.nodes()])
+        loop = [n for n in graph.nodes() if n.kind() == 'prim::Loop'][0]
+        self.assertIn('aten::zeros', [n.kind() for n in next(loop.blocks()).nodes()])
+        self.checkScript(inplace, (torch.randn(3), torch.tensor(4)))
+
     def test_where(self):
         def fn(x, y):
             return torch.where(x > 0.0, x, y)
@@ -7985,6 +8579,22 @@ class TestPytorchExportModes(JitTestCase):
                            export_type=torch.onnx.ExportTypes.DIRECTORY)
         shutil.rmtree(d)
 
+    def test_external_data(self):
+        torch_model = nn.Linear(3, 4)
+        fake_input = torch.randn(2, 3)
+        d = tempfile.mkdtemp()
+        try:
+            f = os.path.join(d, 'model.onnx')
+            torch.onnx._export(torch_model, (fake_input), f, verbose=False,
+                               export_type=torch.onnx.ExportTypes.EXTERNAL_DATA)
+            # the model file and one file per parameter
+            self.assertEqual(len(os.listdir(d)), 3)
+            sizes = sorted(os.path.getsize(os.path.join(d, name))
+                           for name in os.listdir(d) if name != 'model.onnx')
+            self.assertEqual(sizes, [4 * 4, 4 * 3 * 4])
+        finally:
+            shutil.rmtree(d)
+
     @skipIfRocm
     def test_aten_fallback(self):
         class ModelWithAtenNotONNXOp(nn.Module):
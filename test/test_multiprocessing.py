@@ -269,6 +269,23 @@ class TestMultiprocessing(TestCase):
     def test_fd_pool(self):
         self._test_pool(repeat=TEST_REPEATS)
 
+    @unittest.skipIf(platform == 'darwin', "file descriptor strategy is not supported on macOS")
+    def test_fd_segment_reuse(self):
+        def inode(storage):
+            return os.fstat(storage._get_shared_fd()).st_ino
+
+        x = torch.FloatStorage(1024).share_memory_()
+        x_inode = inode(x)
+        # Mapped like by a receiving process
+        x._shared_incref()
+        y = torch.FloatStorage._new_shared_fd(x._get_shared_fd(), x.size())
+        del x
+        z = torch.FloatStorage(1024).share_memory_()
+        self.assertNotEqual(inode(z), x_inode)
+        del y
+        w = torch.FloatStorage(1024).share_memory_()
+        self.assertEqual(inode(w), x_inode)
+
     @unittest.skipIf(TEST_WITH_ASAN,
                      "seems to hang with ASAN, see https://github.com/pytorch/pytorch/issues/5326")
     def test_fs_sharing(self):
@@ -12,6 +12,7 @@ from functools import wraps, reduce
 from operator import mul
 from collections import OrderedDict
 import hashlib
+import tempfile
 import os
 
 import torch
@@ -1602,6 +1603,27 @@ class TestNN(NNTestCase):
             clip_grad_norm_([p2], max_norm, norm_type=norm_type)
             self.assertEqual(p1.grad, p2.grad)
 
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_clip_grad_norm_cuda(self):
+        # CUDA gradients are scaled in batches; mix in types and a
+        # non-contiguous gradient that take the per-tensor path
+        grads = [torch.randn(100, 100), torch.randn(7), torch.randn(3, 5).t(),
+                 torch.randn(1000000), torch.randn(5).half().float()]
+        for norm_type in [2, 'inf']:
+            params_cpu = [torch.zeros_like(g, requires_grad=True) for g in grads]
+            params_cuda = [torch.zeros(g.size(), device='cuda', dtype=dtype, requires_grad=True)
+                           for g, dtype in zip(grads, [torch.float, torch.double, torch.float,
+                                                       torch.float, torch.half])]
+            for p_cpu, p_cuda, g in zip(params_cpu, params_cuda, grads):
+                p_cpu._grad = g.clone()
+                p_cuda._grad = g.to('cuda', p_cuda.dtype)
+            params_cuda[2]._grad = grads[2].t().cuda().t()
+            norm_cpu = clip_grad_norm_(params_cpu, 1, norm_type=norm_type)
+            norm_cuda = clip_grad_norm_(params_cuda, 1, norm_type=norm_type)
+            self.assertAlmostEqual(float(norm_cpu), float(norm_cuda), delta=1e-2)
+            for p_cpu, p_cuda in zip(params_cpu, params_cuda):
+                self.assertEqual(p_cpu.grad, p_cuda.grad.float().cpu(), prec=1e-3)
+
     def test_clip_grad_value(self):
         l = nn.Linear(10, 10)
         clip_value = 2.5
@@ -1719,6 +1741,37 @@ class TestNN(NNTestCase):
         m = pickle.loads(pickle.dumps(m))
         self.assertIsInstance(m, nn.Linear)
 
+    def test_per_sample_grads(self):
+        model = nn.Sequential(nn.Conv2d(2, 3, 3, padding=1, stride=2), nn.ReLU())
+        embedding = nn.Embedding(10, 4, padding_idx=0)
+        linear = nn.Linear(3 * 3 * 3 + 4, 5)
+        modules = nn.ModuleList([model, embedding, linear])
+        images = torch.randn(6, 2, 5, 5)
+        words = torch.tensor([[0, 1, 2], [3, 3, 0], [9, 8, 7], [1, 1, 1], [2, 0, 5], [6, 4, 3]])
+
+        def loss(images, words):
+            features = torch.cat([model(images).flatten(1), embedding(words).sum(1)], 1)
+            return linear(features).pow(2).sum()
+
+        expected = [[] for _ in modules.parameters()]
+        for i in range(images.size(0)):
+            modules.zero_grad()
+            loss(images[i:i + 1], words[i:i + 1]).backward()
+            for grads, param in zip(expected, modules.parameters()):
+                grads.append(param.grad.clone())
+
+        torch.nn.utils.per_sample_grads(modules)
+        modules.zero_grad()
+        loss(images, words).backward()
+        for grads, param in zip(expected, modules.parameters()):
+            self.assertEqual(param.grad_sample, torch.stack(grads))
+            self.assertEqual(param.grad_sample.sum(0), param.grad)
+
+        torch.nn.utils.remove_per_sample_grads(modules)
+        loss(images, words).backward()
+        for param in modules.parameters():
+            self.assertFalse(hasattr(param, 'grad_sample'))
+
     def test_spectral_norm(self):
         input = torch.randn(3, 5)
         m = nn.Linear(5, 7)
@@ -1910,6 +1963,27 @@ class TestNN(NNTestCase):
         self.assertEqual(output[1], output[2])
         self.assertTrue(output.data.norm(p=2, dim=1).le(1).all())
 
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    @skipIfRocm
+    def test_embedding_backward_cuda(self):
+        # more indices than the small-batch kernel handles, so that both the
+        # atomics and the sort-based backward are used
+        for scale_grad_by_freq in [False, True]:
+            for padding_idx in [None, 3]:
+                input = torch.randint(0, 50, (40, 30), dtype=torch.long)
+                grad = torch.randn(40, 30, 16, dtype=torch.double)
+                expected = None
+                for device, deterministic in [('cpu', False), ('cuda', False), ('cuda', True)]:
+                    embedding = nn.Embedding(50, 16, padding_idx=padding_idx,
+                                             scale_grad_by_freq=scale_grad_by_freq)
+                    embedding = embedding.to(device, torch.double)
+                    with torch.backends.cudnn.flags(deterministic=deterministic):
+                        embedding(input.to(device)).backward(grad.to(device))
+                    if expected is None:
+                        expected = embedding.weight.grad
+                    else:
+                        self.assertEqual(embedding.weight.grad, expected)
+
     def test_embedding_from_pretrained(self):
         a = torch.Tensor([[1, 2, 3], [4, 5, 6]])
         embedding = nn.Embedding.from_pretrained(a)
@@ -1948,6 +2022,28 @@ class TestNN(NNTestCase):
         # should be bitwise equal
         self.assertEqual(input.grad, inputf.grad.to(dtype), prec=0)
 
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_softmax_cuda_sizes(self):
+        # dim sizes around the powers of two handled by the warp-per-row kernel
+        # and beyond it, for both the softmax and the log_softmax epilogues
+        for dim_size in [1, 2, 3, 31, 32, 33, 100, 127, 128, 129, 511, 512, 1000, 1024, 1025, 2049]:
+            for rows in [1, 7, 65]:
+                for fn in [F.softmax, F.log_softmax]:
+                    input = torch.randn(rows, dim_size, dtype=torch.double, requires_grad=True)
+                    input_cuda = input.detach().cuda().requires_grad_()
+                    out = fn(input, dim=-1)
+                    out_cuda = fn(input_cuda, dim=-1)
+                    self.assertEqual(out, out_cuda)
+                    grad = torch.randn(rows, dim_size, dtype=torch.double)
+                    out.backward(grad)
+                    out_cuda.backward(grad.cuda())
+                    self.assertEqual(input.grad, input_cuda.grad)
+
+                    # half inputs accumulate in float
+                    input_half = input.detach().half().cuda()
+                    out_half = fn(input_half, dim=-1, dtype=torch.float)
+                    self.assertEqual(out_half, fn(input_half.float(), dim=-1), prec=0)
+
     def _test_gumbel_softmax_st(self, cuda, dtype=torch.float):
         th = torch.cuda if cuda else torch
         """
@@ -2189,6 +2285,37 @@ class TestNN(NNTestCase):
         self._test_EmbeddingBag(False, 'sum', True)
         self._test_EmbeddingBag(False, 'mean', True)
 
+    def test_embedding_bag_many_bags(self):
+        # enough bags and indices to take the parallel paths, with repeated
+        # indices, empty bags and a non-contiguous weight
+        num_embeddings, dim, num_bags = 50, 37, 300
+        lengths = torch.randint(0, 10, (num_bags,), dtype=torch.long)
+        offsets = torch.cat([torch.zeros(1, dtype=torch.long), lengths.cumsum(0)[:-1]])
+        indices = torch.randint(0, num_embeddings, (int(lengths.sum()),), dtype=torch.long)
+        for mode in ['sum', 'mean']:
+            for scale_grad_by_freq in [False, True]:
+                weight = torch.randn(dim, num_embeddings, dtype=torch.double).t().requires_grad_()
+                out = F.embedding_bag(indices, weight, offsets, mode=mode,
+                                      scale_grad_by_freq=scale_grad_by_freq)
+                grad = torch.randn_like(out)
+                out.backward(grad)
+
+                ref_weight = weight.detach().clone().requires_grad_()
+                emb = F.embedding(indices, ref_weight, scale_grad_by_freq=scale_grad_by_freq)
+                rows = []
+                for bag, bag_len in enumerate(lengths.tolist()):
+                    start = int(offsets[bag])
+                    if bag_len == 0:
+                        rows.append(torch.zeros(dim, dtype=torch.double))
+                    elif mode == 'sum':
+                        rows.append(emb[start:start + bag_len].sum(0))
+                    else:
+                        rows.append(emb[start:start + bag_len].mean(0))
+                ref_out = torch.stack(rows)
+                ref_out.backward(grad)
+                self.assertEqual(out, ref_out)
+                self.assertEqual(weight.grad, ref_weight.grad)
+
     @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
     @repeat_test_for_types(ALL_TENSORTYPES)
     @skipIfRocm
@@ -2240,6 +2367,24 @@ class TestNN(NNTestCase):
         input = torch.Tensor(num_features, b, d, w, h)
         self._test_dropout(nn.Dropout3d, False, input)
 
+    def test_fused_dropout_packed(self):
+        devices = ['cpu'] + (['cuda'] if TEST_CUDA else [])
+        for device in devices:
+            # Not a multiple of 32 elements, and not contiguous
+            x = torch.randn(7, 11, device=device).t().requires_grad_()
+            output, mask = torch._fused_dropout_packed(x, 0.7)
+            self.assertEqual(mask.dtype, torch.int32)
+            self.assertEqual(mask.shape, (3,))
+            words = mask.tolist()
+            keep = torch.tensor([(words[i // 32] >> (i % 32)) & 1
+                                 for i in range(77)], dtype=x.dtype,
+                                device=device).view(11, 7)
+            self.assertEqual(output, x.detach() * keep / 0.7)
+
+            grad = torch.randn(11, 7, device=device)
+            output.backward(grad)
+            self.assertEqual(x.grad, grad * keep / 0.7)
+
     @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
     def test_Dropout_cuda(self):
         input = torch.Tensor(1000)
@@ -3499,6 +3644,33 @@ class TestNN(NNTestCase):
             self.assertEqual(conv1.bias.grad.data, conv2.bias.grad.data, prec=0.0)
             self.assertEqual(conv1.weight.grad.data, conv2.weight.grad.data, prec=0.0)
 
+    @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
+    @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
+    @skipIfRocm
+    def test_Conv2d_benchmark_cache_cudnn(self):
+        def conv_step(conv, inputs):
+            with cudnn.flags(enabled=True, benchmark=True):
+                out = conv(inputs)
+                out.backward(torch.ones_like(out))
+            return out
+
+        # a shape no other test uses, so that it gets benchmarked here
+        inputs = torch.randn(3, 5, 19, 23, device="cuda", requires_grad=True)
+        conv = torch.nn.Conv2d(5, 7, 3).cuda()
+        with tempfile.NamedTemporaryFile(mode='r') as f:
+            cudnn.benchmark_cache = f.name
+            try:
+                self.assertEqual(cudnn.benchmark_cache, f.name)
+                out = conv_step(conv, inputs)
+                kinds = set(line.split()[2] for line in f.read().splitlines())
+                self.assertEqual(kinds, {'fwd', 'bwd_data', 'bwd_filter'})
+                self.assertEqual(conv_step(conv, inputs), out, prec=0.0)
+                # cached configurations are not appended again
+                self.assertEqual(f.read(), '')
+            finally:
+                cudnn.benchmark_cache = None
+        self.assertIsNone(cudnn.benchmark_cache)
+
     def test_Conv2d_missing_argument(self):
         c = nn.Conv2d(3, 3, 3)
         self.assertRaises(TypeError, lambda: c(None))
@@ -3952,6 +4124,55 @@ class TestNN(NNTestCase):
                 if l < 10:
                     self.assertEqual(padded.grad.data[l:, i].abs().sum(), 0)
 
+    def test_pack_padded_sequence_unsorted(self):
+        lengths = [2, 10, 1, 4, 3, 8, 5]
+        order = sorted(range(len(lengths)), key=lambda i: -lengths[i])
+        for batch_first in (True, False):
+            padded = torch.randn(len(lengths), 10, 5) if batch_first else torch.randn(10, len(lengths), 5)
+            padded.requires_grad_()
+            batch_dim = 0 if batch_first else 1
+            sorted_padded = padded.index_select(batch_dim, torch.tensor(order))
+            expected = rnn_utils.pack_padded_sequence(
+                sorted_padded, sorted(lengths, reverse=True), batch_first=batch_first)
+
+            packed = rnn_utils.pack_padded_sequence(padded, lengths, batch_first=batch_first,
+                                                    enforce_sorted=False)
+            self.assertEqual(packed.data, expected.data)
+            self.assertEqual(packed.batch_sizes, expected.batch_sizes)
+            self.assertEqual(packed.sorted_indices, order)
+            self.assertEqual(packed.sorted_indices[packed.unsorted_indices], range(len(lengths)))
+
+            # unpacking restores the original order
+            unpacked, unpacked_len = rnn_utils.pad_packed_sequence(
+                packed, batch_first=batch_first, total_length=12)
+            self.assertEqual(unpacked_len, lengths)
+            for i, l in enumerate(lengths):
+                self.assertEqual(unpacked.narrow(batch_dim, i, 1).narrow(1 - batch_dim, 0, l),
+                                 padded.narrow(batch_dim, i, 1).narrow(1 - batch_dim, 0, l))
+                self.assertEqual(unpacked.narrow(batch_dim, i, 1).narrow(1 - batch_dim, l, 12 - l).abs().sum(), 0)
+
+            # check grad
+            padded.grad = None
+            grad_output = torch.randn(packed.data.size())
+            packed.data.backward(grad_output)
+            self.assertEqual(padded.grad.index_select(batch_dim, torch.tensor(order)),
+                             torch.autograd.grad(expected.data, sorted_padded, grad_output)[0])
+
+        # the RNN modules take and return the hidden states in the original order
+        lstm = nn.LSTM(5, 4)
+        x = torch.randn(10, len(lengths), 5)
+        h0 = (torch.randn(1, len(lengths), 4), torch.randn(1, len(lengths), 4))
+        out, (h, c) = lstm(rnn_utils.pack_padded_sequence(x, lengths, enforce_sorted=False), h0)
+        unpacked, _ = rnn_utils.pad_packed_sequence(out)
+        for i, l in enumerate(lengths):
+            seq_out, (seq_h, seq_c) = lstm(x[:l, i:i + 1], (h0[0][:, i:i + 1], h0[1][:, i:i + 1]))
+            self.assertEqual(unpacked[:l, i:i + 1], seq_out)
+            self.assertEqual(h[:, i:i + 1], seq_h)
+            self.assertEqual(c[:, i:i + 1], seq_c)
+
+        with self.assertRaisesRegex(RuntimeError, "sorted in decreasing order"):
+            rnn_utils.pack_padded_sequence(x, lengths)
+
     def _test_variable_sequence(self, device="cpu", dtype=torch.float):
         def pad(var, length):
             if var.size(0) == length:
@@ -4018,6 +4239,71 @@ class TestNN(NNTestCase):
 
             (hx + cx).sum().backward()
 
+    def test_fused_rnn_cells_cpu(self):
+        # reference implementations of the gate math done by the fused kernels
+        def lstm_ref(input, hx, cx, w_ih, w_hh, b_ih=None, b_hh=None):
+            gates = F.linear(input, w_ih, b_ih) + F.linear(hx, w_hh, b_hh)
+            i, f, c, o = gates.chunk(4, 1)
+            cy = f.sigmoid() * cx + i.sigmoid() * c.tanh()
+            return o.sigmoid() * cy.tanh(), cy
+
+        def gru_ref(input, hx, w_ih, w_hh, b_ih=None, b_hh=None):
+            ir, ii, in_ = F.linear(input, w_ih, b_ih).chunk(3, 1)
+            hr, hi, hn = F.linear(hx, w_hh, b_hh).chunk(3, 1)
+            r = (ir + hr).sigmoid()
+            i = (ii + hi).sigmoid()
+            n = (in_ + r * hn).tanh()
+            return n + i * (hx - n)
+
+        # hidden size is not a multiple of the vector width to cover the tails
+        for bias, dtype in product((True, False), (torch.float, torch.double)):
+            input = torch.randn(5, 10, dtype=dtype)
+            hx = torch.randn(5, 19, dtype=dtype)
+            cx = torch.randn(5, 19, dtype=dtype)
+
+            lstm = nn.LSTMCell(10, 19, bias=bias).to(dtype)
+            hy, cy = lstm(input, (hx, cx))
+            ref_hy, ref_cy = lstm_ref(input, hx, cx, *lstm.parameters())
+            self.assertEqual(hy, ref_hy)
+            self.assertEqual(cy, ref_cy)
+
+            gru = nn.GRUCell(10, 19, bias=bias).to(dtype)
+            self.assertEqual(gru(input, hx), gru_ref(input, hx, *gru.parameters()))
+
+        input = torch.randn(3, 4, dtype=torch.double, requires_grad=True)
+        hx = torch.randn(3, 5, dtype=torch.double, requires_grad=True)
+        cx = torch.randn(3, 5, dtype=torch.double, requires_grad=True)
+        for bias in (True, False):
+            lstm = nn.LSTMCell(4, 5, bias=bias).double()
+            gru = nn.GRUCell(4, 5, bias=bias).double()
+            params = tuple(lstm.parameters())
+            self.assertTrue(gradcheck(lambda *args: torch.lstm_cell(args[0], args[1:3], *args[3:]),
+                                      (input, hx, cx) + params))
+            # only one of the outputs contributing to the loss
+            self.assertTrue(gradcheck(lambda *args: torch.lstm_cell(args[0], args[1:3], *args[3:])[1],
+                                      (input, hx, cx) + params))
+            self.assertTrue(gradcheck(torch.gru_cell, (input, hx) + tuple(gru.parameters())))
+
+        # full layers compute the input projection of all steps up front
+        for module, bidirectional in product((nn.LSTM, nn.GRU), (False, True)):
+            rnn = module(10, 19, bidirectional=bidirectional).double()
+            input = torch.randn(6, 3, 10, dtype=torch.double)
+            output, _ = rnn(input)
+            num_directions = 2 if bidirectional else 1
+            for direction in range(num_directions):
+                suffix = '_reverse' if direction == 1 else ''
+                params = [getattr(rnn, name + suffix) for name in ('weight_ih_l0', 'weight_hh_l0',
+                                                                  'bias_ih_l0', 'bias_hh_l0')]
+                steps = range(6) if direction == 0 else reversed(range(6))
+                hx = torch.zeros(3, 19, dtype=torch.double)
+                cx = torch.zeros(3, 19, dtype=torch.double)
+                for t in steps:
+                    if module is nn.LSTM:
+                        hx, cx = lstm_ref(input[t], hx, cx, *params)
+                    else:
+                        hx = gru_ref(input[t], hx, *params)
+                    self.assertEqual(output[t, :, direction * 19:(direction + 1) * 19], hx)
+
     @unittest.skipIf(not (TEST_CUDNN and TEST_MULTIGPU), 'CUDNN or multi-gpu not available')
     @skipIfRocm
     def test_cudnn_rnn_dropout_states_device(self):
@@ -4076,6 +4362,30 @@ class TestNN(NNTestCase):
             weight_data[:] = 4
             self.assertEqual(weight_data, all_vars[4].data)
 
+    @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
+    @skipIfRocm
+    def test_cudnn_weight_format_offset(self):
+        # weights that keep the cuDNN layout but start inside a larger
+        # storage, like the buckets DataParallel replicas are broadcast in,
+        # must not need to be copied
+        from torch._utils import _flatten_dense_tensors, _unflatten_dense_tensors
+        for rnn in [nn.LSTM(10, 20), nn.GRU(10, 20, num_layers=2), nn.RNN(10, 20, bidirectional=True)]:
+            rnn.cuda()
+            input = torch.randn(5, 4, 10, device='cuda')
+            output = rnn(input)[0]
+
+            params = [p.data for p in rnn.parameters()]
+            pad = torch.zeros(3, device='cuda')
+            flat = _flatten_dense_tensors([pad] + params)
+            with torch.no_grad():
+                for p, view in zip(rnn.parameters(), _unflatten_dense_tensors(flat, [pad] + params)[1:]):
+                    p.set_(view)
+            with warnings.catch_warnings(record=True) as w:
+                warnings.simplefilter('always')
+                output_offset = rnn(input)[0]
+            self.assertEqual(len(w), 0)
+            self.assertEqual(output, output_offset)
+
     @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
     @skipIfRocm
     def test_cudnn_weight_tying(self):
@@ -5781,6 +6091,26 @@ class TestNN(NNTestCase):
         out_t_5 = m(in_t_9[:, :, :5, :5])
         self.assertEqual(out_t_9[:, :, :15, :15], out_t_5)
 
+    def test_upsamplingBilinear2d_channels_last(self):
+        # inputs laid out as NHWC in memory take a separate path; it has to
+        # agree with the NCHW one, forward and backward
+        for align_corners in [True, False]:
+            for in_size, out_size in [((5, 7), (11, 3)), ((4, 4), (4, 4)), ((1, 6), (3, 9))]:
+                for n in [1, 3]:
+                    nhwc = torch.randn(n, in_size[0], in_size[1], 5, dtype=torch.double)
+                    x_cl = nhwc.permute(0, 3, 1, 2).requires_grad_()
+                    x = x_cl.detach().contiguous().requires_grad_()
+                    out_cl = F.interpolate(x_cl, size=out_size, mode='bilinear', align_corners=align_corners)
+                    out = F.interpolate(x, size=out_size, mode='bilinear', align_corners=align_corners)
+                    self.assertEqual(out_cl, out)
+                    grad = torch.randn(n, out_size[0], out_size[1], 5, dtype=torch.double)
+                    out_cl.backward(grad.permute(0, 3, 1, 2))
+                    out.backward(grad.permute(0, 3, 1, 2).contiguous())
+                    self.assertEqual(x_cl.grad, x.grad)
+
+                    gradcheck(lambda x: F.interpolate(x, size=out_size, mode='bilinear',
+                                                      align_corners=align_corners), [x_cl])
+
     def test_upsamplingNearest3d(self):
         m = nn.Upsample(size=4, mode='nearest')
         in_t = torch.ones(1, 1, 2, 2, 2)
@@ -5867,6 +6197,25 @@ class TestNN(NNTestCase):
         expected = m(inp.view(6, 5)).view(2, 3, 8)
         self.assertEqual(expected, m(inp))
 
+    @unittest.skipIf(not torch._C.has_mkl, "MKL not available")
+    def test_linear_prepacked_mkl(self):
+        for bias in (True, False):
+            m = nn.Linear(12, 7, bias=bias)
+            with torch.no_grad():
+                packed = torch._mkl_linear_prepack(m.weight)
+                # the same packed weight serves any number of input rows
+                for input_size in ((1, 12), (5, 12), (2, 3, 12), (12,), (0, 12)):
+                    inp = torch.randn(*input_size)
+                    self.assertEqual(m(inp), torch._mkl_linear_packed(inp, m.weight, packed, m.bias))
+
+        m = nn.Linear(12, 7)
+        with torch.no_grad():
+            packed = torch._mkl_linear_prepack(m.weight)
+            self.assertRaises(RuntimeError, lambda: torch._mkl_linear_packed(
+                torch.randn(3, 11), m.weight, packed, m.bias))
+            self.assertRaises(RuntimeError, lambda: torch._mkl_linear_packed(
+                torch.randn(3, 12), m.weight, packed[1:].clone(), m.bias))
+
     def test_bilinear(self):
         module = nn.Bilinear(10, 10, 8)
         input1 = torch.randn(4, 10, requires_grad=True)
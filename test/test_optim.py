@@ -285,6 +285,50 @@ class TestOptim(TestCase):
             lambda params: optim.Adagrad(params, lr=1e-1)
         )
 
+    def test_fused_cuda_step(self):
+        # CUDA parameters are updated by the fused multi-tensor steps, which
+        # have to match the CPU optimizers. The sizes need several launches
+        # and include an empty tensor and one split into several chunks.
+        if not torch.cuda.is_available():
+            return
+        sizes = [(3,), (0,), (65536 * 2 + 7,)] + [(i + 1, 5) for i in range(80)]
+        constructors = [
+            lambda params: optim.SGD(params, lr=1e-1),
+            lambda params: optim.SGD(params, lr=1e-1, momentum=0.9, dampening=0.1, weight_decay=0.1),
+            lambda params: optim.SGD(params, lr=1e-1, momentum=0.9, nesterov=True),
+            lambda params: optim.Adam(params, lr=1e-1, weight_decay=0.1),
+            lambda params: optim.Adagrad(params, lr=1e-1, lr_decay=0.1, weight_decay=0.1),
+        ]
+        for constructor in constructors:
+            params = [torch.randn(*size, dtype=torch.double, requires_grad=True) for size in sizes]
+            params_cuda = [p.detach().cuda().requires_grad_() for p in params]
+            optimizer = constructor(params)
+            optimizer_cuda = constructor(params_cuda)
+            for _ in range(3):
+                for p, p_cuda in zip(params, params_cuda):
+                    p.grad = torch.randn_like(p)
+                    p_cuda.grad = p.grad.cuda()
+                optimizer.step()
+                optimizer_cuda.step()
+                for p, p_cuda in zip(params, params_cuda):
+                    self.assertEqual(p, p_cuda)
+                    self.assertEqual(p.grad, p_cuda.grad)
+
+    def test_zero_grad_cuda(self):
+        # dense CUDA gradients are zeroed in batches by _multi_tensor_zero_
+        if not torch.cuda.is_available():
+            return
+        sizes = [(3,), (0,), (65536 * 2 + 7,)] + [(i + 1, 5) for i in range(80)]
+        params = [torch.randn(*size, device='cuda', requires_grad=True) for size in sizes]
+        params.append(torch.randn(3, device='cuda', dtype=torch.half, requires_grad=True))
+        optimizer = optim.SGD(params, lr=1e-1)
+        for p in params:
+            p.grad = torch.randn_like(p)
+        params[4].grad = torch.randn(5, 2, device='cuda').t()  # not contiguous
+        optimizer.zero_grad()
+        for p in params:
+            self.assertEqual(p.grad.abs().sum().item(), 0)
+
     @skipIfRocm
     def test_adamax(self):
         self._test_basic_cases(
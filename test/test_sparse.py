@@ -190,6 +190,27 @@ class TestSparse(TestCase):
         self.assertEqual(x._indices().numel(), 0)
         self.assertEqual(x._values().numel(), 0)
 
+    def test_coalesce_many_duplicates(self):
+        # a sparse embedding gradient: few distinct rows, each repeated often
+        i = torch.randint(0, 20, (1, 2000), dtype=torch.long, device=self.device)
+        v = torch.randn(2000, 300, dtype=self.value_dtype, device=self.device)
+        x = self.SparseTensor(i, v, torch.Size([30, 300]))
+        y = self.safeCoalesce(x)
+        self.assertTrue(y.is_coalesced())
+        self.assertEqual(y._nnz(), i.unique().numel())
+        self.assertEqual(y._indices()[0], i.unique())
+        self.assertEqual(self.safeToDense(y), self.safeToDense(x))
+
+        # multiple sparse dims with hybrid values
+        i = torch.randint(0, 4, (2, 500), dtype=torch.long, device=self.device)
+        v = torch.randn(500, 3, dtype=self.value_dtype, device=self.device)
+        x = self.SparseTensor(i, v, torch.Size([4, 4, 3]))
+        y = self.safeCoalesce(x)
+        self.assertEqual(self.safeToDense(y), self.safeToDense(x))
+        indices = y._indices()
+        linear = indices[0] * 4 + indices[1]
+        self.assertTrue((linear[1:] > linear[:-1]).all())
+
     def test_ctor_size_checks(self):
         indices = self.IndexTensor([
             [0, 0, 0],
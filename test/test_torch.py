@@ -21,6 +21,7 @@ from torch._utils import _rebuild_tensor
 from torch._six import inf, nan, string_classes
 from itertools import product, combinations
 from functools import reduce
+from contextlib import contextmanager
 from torch import multiprocessing as mp
 from common_utils import TestCase, iter_indices, TEST_NUMPY, TEST_SCIPY, TEST_MKL, \
     TEST_LIBROSA, run_tests, download_file, skipIfNoLapack, suppress_warnings, \
@@ -148,6 +149,12 @@ class TestTorch(TestCase):
     def test_dir(self):
         dir(torch)
 
+    def test_startup_times(self):
+        phases = [phase for phase, _ in torch._startup_times]
+        self.assertIn('load torch._C', phases)
+        self.assertIn('import torch', phases)
+        self.assertTrue(all(t >= 0 for _, t in torch._startup_times))
+
     def test_doc(self):
         checked_types = (types.MethodType, types.FunctionType,
                          types.BuiltinFunctionType, types.BuiltinMethodType)
@@ -1128,6 +1135,38 @@ class TestTorch(TestCase):
                         self.assertEqual(expected.shape, actual.shape)
                         self.assertTrue(np.allclose(expected, actual.cpu().numpy()))
 
+    def test_cdist(self):
+        def brute_cdist(x, y, p):
+            diff = (x.unsqueeze(-2) - y.unsqueeze(-3)).abs()
+            if p == 0:
+                return (diff != 0).sum(-1).to(x.dtype)
+            return diff.norm(p, -1)
+
+        devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
+        modes = ['use_mm_for_euclid_dist_if_necessary', 'use_mm_for_euclid_dist',
+                 'donot_use_mm_for_euclid_dist']
+        for device in devices:
+            for shapes in [((5, 3), (4, 3)), ((2, 30, 7), (2, 6, 7)),
+                           ((2, 3, 4, 5), (2, 3, 2, 5))]:
+                for p in [0, 1, 2, 3, 1.5, float('inf')]:
+                    for mode in modes:
+                        x = torch.randn(shapes[0], device=device)
+                        y = torch.randn(shapes[1], device=device)
+                        actual = torch.cdist(x, y, p=p, compute_mode=mode)
+                        self.assertEqual(actual, brute_cdist(x, y, p), 1e-4)
+
+        # Gradients of the direct computation, and of the matrix product
+        x = torch.randn(2, 4, 3, dtype=torch.double, requires_grad=True)
+        y = torch.randn(2, 5, 3, dtype=torch.double, requires_grad=True)
+        for p in [1, 2, 3, 1.5, float('inf')]:
+            self.assertTrue(torch.autograd.gradcheck(
+                lambda x, y: torch.cdist(x, y, p), (x, y)))
+        self.assertTrue(torch.autograd.gradcheck(
+            lambda x, y: torch.cdist(x, y, compute_mode='use_mm_for_euclid_dist'), (x, y)))
+
+        self.assertRaises(ValueError, lambda: torch.cdist(x, y, compute_mode='fast'))
+        self.assertRaises(RuntimeError, lambda: torch.cdist(x, y[0]))
+
     @unittest.skipIf(not TEST_SCIPY, "Scipy not found")
     def test_logsumexp(self):
         from scipy.special import logsumexp
@@ -1325,6 +1364,71 @@ class TestTorch(TestCase):
 
         # [res] torch.add([res,] tensor1, value, tensor2)
 
+    def test_add_out_resize(self):
+        a = torch.randn(10, 20)
+        b = torch.randn(10, 20)
+        # out= with too many elements keeps its storage
+        out = torch.empty(500)
+        data_ptr = out.data_ptr()
+        torch.add(a, b, out=out)
+        self.assertEqual(out, a + b)
+        self.assertEqual(out.size(), a.size())
+        self.assertEqual(out.data_ptr(), data_ptr)
+
+        # out= follows the memory layout of the inputs
+        out = torch.empty(0)
+        torch.add(a.t(), b.t(), out=out)
+        self.assertEqual(out, a.t() + b.t())
+        self.assertEqual(out.stride(), a.t().stride())
+
+        # out= that is too small grows
+        out = torch.empty(3)
+        torch.mul(a, b, out=out)
+        self.assertEqual(out, a * b)
+
+    def test_fused_rowwise_embedding_bag(self):
+        for bit_width, dim in [(8, 16), (8, 7), (4, 16), (4, 7)]:
+            weight = torch.randn(20, dim)
+            packed = torch.fused_rowwise_quantize(weight, bit_width)
+            self.assertEqual(packed.dtype, torch.uint8)
+            dequantized = torch.fused_rowwise_dequantize(packed, bit_width)
+            # odd 4-bit rows come back with one padding column
+            self.assertEqual(dequantized.size(1), dim + (dim % 2 if bit_width == 4 else 0))
+            dequantized = dequantized[:, :dim]
+            scale = (weight.max(1)[0] - weight.min(1)[0]) / (2 ** bit_width - 1)
+            self.assertTrue(((dequantized - weight).abs() <= scale.unsqueeze(1) / 2 + 1e-6).all())
+
+            indices = torch.tensor([1, 5, 5, 19, 0, 3, 3, 3], dtype=torch.long)
+            offsets = torch.tensor([0, 3, 3, 5], dtype=torch.long)
+            for mode, mode_name in [(0, 'sum'), (1, 'mean')]:
+                out = torch.embedding_bag_fused_rowwise(packed, indices, offsets, mode, bit_width)
+                expected = torch.nn.functional.embedding_bag(
+                    indices, dequantized, offsets, mode=mode_name)
+                self.assertEqual(out[:, :dim], expected, prec=1e-5)
+
+        packed = torch.fused_rowwise_quantize(torch.randn(4, 8))
+        self.assertRaises(RuntimeError, lambda: torch.embedding_bag_fused_rowwise(
+            packed, torch.tensor([4]), torch.tensor([0])))
+        self.assertRaises(RuntimeError, lambda: torch.fused_rowwise_quantize(torch.randn(4, 8), 2))
+
+    def test_add_relu(self):
+        m1 = torch.randn(100, 100)
+        m2 = torch.randn(100, 100)
+        self.assertEqual(torch._add_relu(m1, m2), torch.relu(m1 + m2))
+        self.assertEqual(torch._add_relu(m1, m2, alpha=3), torch.relu(m1 + 3 * m2))
+
+        # non-contiguous and broadcast
+        self.assertEqual(torch._add_relu(m1.t(), m2[0]), torch.relu(m1.t() + m2[0]))
+
+        # in-place
+        res = m1.clone()
+        torch._add_relu_(res, m2)
+        self.assertEqual(res, torch.relu(m1 + m2))
+
+        # integral types
+        i1 = torch.arange(-5, 5, dtype=torch.long)
+        self.assertEqual(torch._add_relu(i1, i1), torch.relu(i1 + i1))
+
     def test_csub(self):
         # with a tensor
         a = torch.randn(100, 90)
@@ -1605,6 +1709,24 @@ class TestTorch(TestCase):
             self.assertRaises(RuntimeError, lambda: torch.bmm(b1, b2.cuda()))
             self.assertRaises(RuntimeError, lambda: torch.bmm(b1.cuda(), b2))
 
+    def test_bmm_many_small(self):
+        # small matrices take the parallel-over-batch path
+        for M, N, O in [(4, 5, 6), (1, 7, 1), (16, 16, 16)]:
+            b1 = torch.randn(500, M, N)
+            b2 = torch.randn(500, O, N).transpose(1, 2)
+            res = torch.bmm(b1, b2)
+            for i in range(0, 500, 37):
+                self.assertEqual(torch.mm(b1[i], b2[i]), res[i])
+
+            b1_int = torch.randint(-5, 5, (50, M, N), dtype=torch.long)
+            b2_int = torch.randint(-5, 5, (50, N, O), dtype=torch.long)
+            res_int = torch.bmm(b1_int, b2_int)
+            self.assertEqual(res_int, torch.bmm(b1_int.double(), b2_int.double()).long())
+
+            # beta == 0 ignores NaNs in self, as BLAS does
+            self_nan = torch.full((500, M, O), float('nan'))
+            self.assertEqual(torch.baddbmm(0, self_nan, 2, b1, b2), res * 2)
+
     def test_addbmm(self):
         # num_batches = 10
         # M, N, O = 12, 8, 5
@@ -1702,6 +1824,19 @@ class TestTorch(TestCase):
         torch.clamp(m1, max=max_val, out=out)
         self.assertEqual(out, res1)
 
+    def test_pointwise_noncontiguous(self):
+        m1 = torch.randn(30, 40).t()[::2]
+        m2 = torch.randn(20, 30)
+        cond = m1 > 0
+        self.assertEqual(m1.clamp(-0.5, 0.5), m1.contiguous().clamp(-0.5, 0.5))
+        self.assertEqual(m1.clamp(min=0), m1.contiguous().clamp(min=0))
+        res = m1.clone()
+        res.clamp_(max=0)
+        self.assertEqual(res, m1.contiguous().clamp(max=0))
+        self.assertEqual(torch.where(cond, m1, m2),
+                         torch.where(cond.contiguous(), m1.contiguous(), m2))
+        self.assertEqual(torch.where(cond, m1, m2), m1 * cond.float() + m2 * (1 - cond.float()))
+
     def test_pow(self):
         # [res] torch.pow([res,] x)
 
@@ -2413,6 +2548,21 @@ class TestTorch(TestCase):
             a[0] = 7.
             self.assertEqual(5., res1[0].item())
 
+    @unittest.skipIf(sys.version_info[0] == 2, "no buffer protocol for array in Python 2")
+    def test_tensor_factory_buffer(self):
+        import array
+        floats = array.array('f', [1.5, 2.5, 3.5])
+        self.assertEqual(torch.tensor(floats), torch.tensor([1.5, 2.5, 3.5]))
+        self.assertIs(torch.get_default_dtype(), torch.tensor(floats).dtype)
+
+        ints = array.array('i', [1, 2, 3])
+        self.assertIs(torch.int64, torch.tensor(ints).dtype)
+        self.assertEqual(torch.tensor([1., 2., 3.]), torch.tensor(ints, dtype=torch.float))
+        self.assertEqual(torch.tensor([1, 3]), torch.tensor(memoryview(ints)[::2]))
+
+        matrix = memoryview(array.array('d', range(6))).cast('B').cast('d', [2, 3])
+        self.assertEqual(torch.arange(6.).view(2, 3), torch.tensor(matrix))
+
     def test_tensor_factory_copy_var(self):
 
         def check_copy(copy, is_leaf, requires_grad, data_ptr=None):
@@ -3253,6 +3403,18 @@ class TestTorch(TestCase):
     def test_contiguous(self):
         return self._test_contiguous(self, lambda t: t)
 
+    def test_contiguous_transposed(self):
+        for dtype in [torch.uint8, torch.float, torch.double]:
+            # sizes that are not multiples of the copy tile size
+            x = torch.arange(0, 257 * 131, dtype=torch.double).view(257, 131).to(dtype)
+            for src in [x.t(), x[:, :100].t(), x[:200, :77].t()]:
+                res = src.contiguous()
+                self.assertTrue(res.is_contiguous())
+                expected = res.new_empty(res.size())
+                for i in range(src.size(0)):
+                    expected[i] = src[i]
+                self.assertEqual(res, expected, 0)
+
     def test_empty_tensor_props(self):
         sizes = [(0,), (0, 3), (5, 0), (5, 0, 3, 0, 2), (0, 3, 0, 2), (0, 5, 0, 2, 0)]
         devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
@@ -3598,6 +3760,24 @@ class TestTorch(TestCase):
         self.assertEqual(top1, top2)
         self.assertEqual(idx1, idx2)
 
+    @unittest.skipIf(not torch.cuda.is_available(), 'no CUDA')
+    @skipIfRocm
+    def test_sort_topk_large_slices_gpu(self):
+        # Slices larger than 2048 are sorted by the segmented radix sort
+        for dtype in (torch.float, torch.double, torch.long):
+            t = torch.randn(30, 3000).mul(1000).to(dtype)
+            for dim, descending in product((0, 1), (False, True)):
+                x = t.t() if dim == 0 else t
+                res, idx = x.cuda().sort(dim, descending)
+                expected, _ = x.sort(dim, descending)
+                self.assertEqual(res.cpu(), expected, 0)
+                self.assertEqual(x.cuda().gather(dim, idx), res, 0)
+
+            val, idx = t.cuda().topk(2500, 1)
+            expected, _ = t.sort(1, True)
+            self.assertEqual(val.cpu(), expected[:, :2500], 0)
+            self.assertEqual(t.cuda().gather(1, idx), val, 0)
+
     @skipIfRocm
     def test_kthvalue(self):
         SIZE = 50
@@ -4988,6 +5168,42 @@ class TestTorch(TestCase):
     def test_fft_ifft_rfft_irfft(self):
         self._test_fft_ifft_rfft_irfft(self)
 
+    @unittest.skipIf(not TEST_MKL, "PyTorch is built without MKL support")
+    def test_fft_plan_cache(self):
+        @contextmanager
+        def plan_cache_max_size(n):
+            original = torch.backends.mkl.fft_plan_cache.max_size
+            torch.backends.mkl.fft_plan_cache.max_size = n
+            yield
+            torch.backends.mkl.fft_plan_cache.max_size = original
+
+        with plan_cache_max_size(max(1, torch.backends.mkl.fft_plan_cache.size - 10)):
+            self._test_fft_ifft_rfft_irfft(self)
+
+        with plan_cache_max_size(0):
+            self._test_fft_ifft_rfft_irfft(self)
+
+        torch.backends.mkl.fft_plan_cache.clear()
+        self.assertEqual(torch.backends.mkl.fft_plan_cache.size, 0)
+
+        # repeated transforms of the same geometry reuse one descriptor
+        with plan_cache_max_size(10):
+            x = torch.randn(4, 16, 2, dtype=torch.double)
+            expected = x.fft(1)
+            for _ in range(5):
+                self.assertEqual(x.fft(1), expected, 0)
+            self.assertEqual(torch.backends.mkl.fft_plan_cache.size, 1)
+            # normalization is part of the key
+            self.assertEqual(x.fft(1, normalized=True), expected / 4, 1e-12)
+            self.assertEqual(torch.backends.mkl.fft_plan_cache.size, 2)
+            self._test_fft_ifft_rfft_irfft(self)
+
+        with self.assertRaisesRegex(RuntimeError, r"must be non-negative"):
+            torch.backends.mkl.fft_plan_cache.max_size = -1
+
+        with self.assertRaisesRegex(RuntimeError, r"read-only property"):
+            torch.backends.mkl.fft_plan_cache.size = -1
+
     @staticmethod
     def _test_stft(self, device='cpu'):
         if not TEST_LIBROSA:
@@ -6294,6 +6510,27 @@ class TestTorch(TestCase):
     def test_gather(self):
         self._test_gather(self, lambda t: t)
 
+    def test_gather_scatter_add_index_select_large(self):
+        # large enough for the parallel paths, along an inner dim and with
+        # non-contiguous operands
+        src = torch.randn(300, 200)
+        index = torch.randint(0, 200, (300, 150), dtype=torch.long)
+        rows = torch.arange(300).unsqueeze(1).expand_as(index)
+        self.assertEqual(src.gather(1, index), src[rows, index])
+        self.assertEqual(src.t().gather(0, index.t()), src[rows, index].t())
+
+        out = torch.zeros(300, 200).scatter_add_(1, index, src[:, :150])
+        expected = torch.zeros(300, 200)
+        for r in range(300):
+            expected[r].index_add_(0, index[r], src[r, :150])
+        self.assertEqual(out, expected)
+        self.assertRaises(RuntimeError, lambda: torch.zeros(300, 100).scatter_add_(1, index, src[:, :150]))
+
+        x = torch.randn(4, 5000, 7)
+        idx = torch.randint(0, 5000, (3000,), dtype=torch.long)
+        self.assertEqual(x.index_select(1, idx), x[:, idx])
+        self.assertRaises(RuntimeError, lambda: x.index_select(1, torch.tensor([5000])))
+
     @staticmethod
     def _test_scatter_base(self, cast, method, is_scalar=False, test_bounds=True):
         m, n, o = random.randint(10, 20), random.randint(10, 20), random.randint(10, 20)
@@ -6460,6 +6697,24 @@ class TestTorch(TestCase):
         self.assertEqual(tensor.var(dim=0), 0.03125)
         self.assertEqual(tensor.var(), 0.03125)
 
+    @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
+    def test_var_std_dims(self):
+        for dtype in [torch.float, torch.double]:
+            x = torch.randn(5, 300, 7, dtype=dtype)
+            for dim in range(x.dim()):
+                for unbiased in [False, True]:
+                    ddof = 1 if unbiased else 0
+                    expected_var = np.var(x.numpy(), axis=dim, ddof=ddof)
+                    expected_std = np.std(x.numpy(), axis=dim, ddof=ddof)
+                    self.assertEqual(x.var(dim, unbiased=unbiased), torch.from_numpy(expected_var))
+                    self.assertEqual(x.std(dim, unbiased=unbiased, keepdim=True),
+                                     torch.from_numpy(expected_std).unsqueeze(dim))
+            # non-contiguous input and full reduction
+            xt = x.transpose(0, 2)
+            self.assertEqual(xt.var(1), torch.from_numpy(np.var(xt.numpy(), axis=1, ddof=1)))
+            self.assertEqual(x.var(), np.var(x.numpy(), ddof=1))
+            self.assertEqual(x.std(unbiased=False), np.std(x.numpy()))
+
     @staticmethod
     def _test_view(self, cast):
         tensor = cast(torch.rand(15))
@@ -7542,6 +7797,24 @@ class TestTorch(TestCase):
         self.assertEqual(r[:, :50].std(), 4, 0.3)
         self.assertEqual(r[:, 50:].std(), 1, 0.2)
 
+    def test_random_thread_count_invariant(self):
+        def sample(num_threads):
+            torch.set_num_threads(num_threads)
+            torch.manual_seed(123)
+            return [torch.empty(100001).uniform_(),
+                    torch.empty(100001, dtype=torch.float).normal_(),
+                    torch.empty(100001).bernoulli_(0.3),
+                    torch.empty(100001).bernoulli_(torch.rand(100001))]
+
+        num_threads = torch.get_num_threads()
+        try:
+            serial = sample(1)
+            parallel = sample(4)
+        finally:
+            torch.set_num_threads(num_threads)
+        for s, p in zip(serial, parallel):
+            self.assertEqual(s, p, 0)
+
     def test_parsing_int64(self):
         # accepts integer arguments
         x = torch.cumsum(torch.ones(5, 5), 0)
@@ -7649,6 +7922,15 @@ class TestTorch(TestCase):
                 c = torch.load(handle)
             self._test_serialization_assert(b, c)
 
+    @unittest.skipIf(sys.platform == "win32", "the file is mapped from its name")
+    def test_serialization_mmap(self):
+        b = self._test_serialization_data()
+        with tempfile.NamedTemporaryFile() as f:
+            torch.save(b, f)
+            f.seek(0)
+            c = torch.load(f, mmap=True)
+        self._test_serialization_assert(b, c)
+
     def test_serialization_filelike(self):
         # Test serialization (load and save) with a filelike object
         b = self._test_serialization_data()
@@ -7734,6 +8016,24 @@ class TestTorch(TestCase):
             xh2 = torch.load(f)
             self.assertEqual(xh.float(), xh2.float())
 
+    def test_half_tensor_copy_large(self):
+        # contiguous half <-> float copies are converted in bulk, compare them
+        # against the element-wise conversion used for strided tensors
+        for n in [1, 15, 17, 100003]:
+            x = torch.randn(n) * 1000
+            specials = torch.tensor([0., -0., 1e-6, -1e-7, 65504., 65520., 1e6, -1e6,
+                                     float('inf'), float('-inf'), 1 + 2 ** -11, 1 + 3 * 2 ** -11])
+            x[:min(n, specials.numel())] = specials[:n]
+            strided = torch.zeros(n, 2).half()[:, 0]
+            strided.copy_(x)
+            xh = x.half()
+            self.assertTrue(xh.is_contiguous())
+            self.assertEqual(xh.float(), strided.float())
+            back = torch.zeros(n, 2)[:, 0]
+            back.copy_(xh)
+            self.assertEqual(xh.float(), back)
+            self.assertTrue(torch.isnan(torch.full((n,), float('nan')).half().float()).all())
+
     def test_serialize_device(self):
         device_str = ['cpu', 'cpu:0', 'cuda', 'cuda:0']
         device_obj = [torch.device(d) for d in device_str]
@@ -8372,6 +8672,18 @@ class TestTorch(TestCase):
         z = from_dlpack(to_dlpack(x))
         self.assertEqual(z, x)
 
+    @unittest.skipIf(not torch.cuda.is_available(), "No CUDA")
+    def test_dlpack_cuda_stream(self):
+        stream = torch.cuda.Stream()
+        x = torch.randn(4, 5).cuda()
+        dlpack = to_dlpack(x * 2, stream=stream)
+        with torch.cuda.stream(stream):
+            y = from_dlpack(dlpack) + 1
+        z = from_dlpack(to_dlpack(y), stream=stream)
+        self.assertEqual(z, x * 2 + 1)
+        z = from_dlpack(to_dlpack(x.t(), stream.cuda_stream))
+        self.assertEqual(z, x.t())
+
     @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
     def test_from_numpy(self):
         dtypes = [
@@ -8436,6 +8748,11 @@ class TestTorch(TestCase):
         incorrect_byteorder = '>' if sys.byteorder == 'little' else '<'
         incorrect_dtypes = map(lambda t: incorrect_byteorder + t, ['d', 'f'])
 
+        for dtype in incorrect_dtypes:
+            array = np.array([1, 2, 3, 4], dtype=dtype)
+            self.assertEqual(torch.tensor(array, dtype=torch.double), torch.tensor([1, 2, 3, 4], dtype=torch.double))
+            self.assertEqual(torch.tensor(array[::-1], dtype=torch.double), torch.tensor([4, 3, 2, 1], dtype=torch.double))
+
         for dtype in correct_dtypes:
             array = np.array([1, 2, 3, 4], dtype=dtype)
 
@@ -8857,6 +9174,63 @@ class TestTorch(TestCase):
         self.assertEqual(torch.ByteTensor([7, 42, 128, 133]), byte_unique)
         self.assertEqual(torch.LongTensor([3, 0, 0, 0, 1, 2]), byte_inverse)
 
+    @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
+    def test_unique_large(self):
+        # large enough to sort in parallel, with negative and repeated values
+        for dtype in [torch.int8, torch.int32, torch.int64, torch.float, torch.double]:
+            if dtype.is_floating_point:
+                x = torch.randn(100000, dtype=dtype).mul_(100).round_()
+                x[:10] = -0.0
+                x[10:20] = 0.0
+            else:
+                x = torch.randint(-100, 100, (100000,), dtype=dtype)
+                x[0] = torch.iinfo(dtype).min
+            expected, expected_inverse = np.unique(x.numpy(), return_inverse=True)
+            x_unique, x_inverse = torch.unique(x, sorted=True, return_inverse=True)
+            self.assertEqual(x_unique, torch.from_numpy(expected))
+            self.assertEqual(x_inverse, torch.from_numpy(expected_inverse).long())
+            self.assertEqual(x_unique[x_inverse], x)
+
+    def test_unique_counts(self):
+        devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
+        for device in devices:
+            x = torch.tensor([[1, 2, 3, 2], [8, 5, 2, 3]], device=device)
+            x_unique, x_inverse, x_counts = x.unique(
+                sorted=True, return_inverse=True, return_counts=True)
+            self.assertEqual(x_unique.tolist(), [1, 2, 3, 5, 8])
+            self.assertEqual(x_inverse.tolist(), [[0, 1, 2, 1], [4, 3, 1, 2]])
+            self.assertEqual(x_counts.tolist(), [1, 3, 2, 1, 1])
+            x_unique, x_counts = torch.unique(x, sorted=True, return_counts=True)
+            self.assertEqual(x_counts.tolist(), [1, 3, 2, 1, 1])
+
+            x = torch.randint(-50, 50, (10000,), device=device)
+            x_unique, x_inverse, x_counts = torch.unique(
+                x, sorted=True, return_inverse=True, return_counts=True)
+            self.assertEqual(x_unique[x_inverse], x)
+            self.assertEqual(x_counts, (x.unsqueeze(1) == x_unique).sum(0))
+
+    def test_unique_consecutive(self):
+        devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
+        for device in devices:
+            x = torch.tensor([1, 1, 2, 2, 3, 1, 1, 2], device=device)
+            self.assertEqual(torch.unique_consecutive(x).tolist(), [1, 2, 3, 1, 2])
+            output, inverse, counts = x.unique_consecutive(
+                return_inverse=True, return_counts=True)
+            self.assertEqual(output.tolist(), [1, 2, 3, 1, 2])
+            self.assertEqual(inverse.tolist(), [0, 0, 1, 1, 2, 3, 3, 4])
+            self.assertEqual(counts.tolist(), [2, 2, 1, 2, 1])
+
+            y = x.view(2, 4).t()
+            output, inverse = torch.unique_consecutive(y, return_inverse=True)
+            self.assertEqual(output, torch.unique_consecutive(y.contiguous()))
+            self.assertEqual(inverse.shape, y.shape)
+            self.assertEqual(output[inverse], y)
+
+            output, counts = torch.unique_consecutive(
+                torch.tensor([], device=device), return_counts=True)
+            self.assertEqual(output.numel(), 0)
+            self.assertEqual(counts.numel(), 0)
+
     def test_unique_dim(self):
         def run_test(dtype=torch.float):
             x = torch.tensor([[[1., 1.],
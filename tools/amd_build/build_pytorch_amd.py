@@ -41,6 +41,7 @@ for root, _, files in os.walk(os.path.join(proj_dir, "aten/src/ATen")):
 
 # Make various replacements inside AMD_BUILD/torch directory
 ignore_files = ["csrc/autograd/profiler.h", "csrc/autograd/profiler.cpp",
+                "csrc/autograd/profiler_cupti.h", "csrc/autograd/profiler_cupti.cpp",
                 "csrc/cuda/cuda_check.h"]
 for root, _directories, files in os.walk(os.path.join(proj_dir, "torch")):
     for filename in files:
@@ -107,7 +107,7 @@ if (compute_requires_grad( ${args_with_derivatives} )) {
 """)
 
 ASSIGN_GRAD_FN = CodeTemplate("""\
-grad_fn = std::shared_ptr<${op}>(new ${op}(${op_ctor}), deleteFunction);
+grad_fn = std::shared_ptr<${op}>(new ${op}(${op_ctor}), deleteFunction, FunctionAllocator<${op}>());
 grad_fn->set_next_edges(collect_next_edges( ${args_with_derivatives} ));
 """)
 
@@ -499,9 +499,12 @@ def emit_body(declaration):
     def emit_history():
         fn = 'rebase' if modifies_arguments and not is_view else 'set'
         output_names = [r['name'] for r in differentiable_outputs]
-        # TODO: flatten allocates a std::vector, which could be expensive
+        # flatten allocates a std::vector, so it is skipped when there is no
+        # history to record, e.g. under NoGradGuard
         outs = CodeTemplate("flatten_tensor_args( ${outs} )").substitute(outs=output_names)
-        return SET_HISTORY.substitute(fn=fn, differentiable_outputs=outs)
+        return CONDITIONAL.substitute(
+            cond='grad_fn',
+            statements=[SET_HISTORY.substitute(fn=fn, differentiable_outputs=outs)])
 
     def emit_save_outputs():
         if is_out_fn:
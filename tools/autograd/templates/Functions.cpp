@@ -6,6 +6,7 @@
 #endif
 
 #include "Functions.h"
+#include "torch/csrc/autograd/grad_mode.h"
 #include <ATen/Utils.h>
 #include <ATen/core/TensorOptions.h>
 #include <ATen/WrapDimUtils.h>
@@ -835,11 +836,11 @@ Tensor diagonal_backward(const Tensor & grad, IntList input_sizes, int64_t offse
 }
 
 Tensor mse_loss_double_backward(const Tensor & grad, const Tensor & input, int64_t reduction) {
-  auto grad_input = 2 * grad;
+  double scale = 2;
   if (reduction == Reduction::ElementwiseMean) {
-    grad_input /= input.numel();
+    scale /= input.numel();
   }
-  return grad_input;
+  return grad * scale;
 }
 
 Tensor mse_loss_double_backward_grad_output(const Tensor & grad, const Tensor & grad_output, const Tensor & input, const Tensor & target, int64_t reduction) {
@@ -868,11 +869,37 @@ Tensor soft_margin_loss_double_backward_grad_output(const Tensor & grad, const T
   return (r * grad).sum();
 }
 
+// The second derivative formulas below are usually evaluated by the last
+// backward pass of a higher order gradient (e.g. the gradient penalty in
+// WGAN-GP), which runs without grad mode. There, the temporaries are reused
+// in place instead of allocating one per op; with grad mode on they are
+// recorded as before.
+
 Tensor softplus_double_backward(const Tensor & grad, const Tensor & input, Scalar beta, Scalar threshold) {
   auto x = (input * beta);
+  if (!GradMode::is_enabled()) {
+    auto mask = (x < threshold).toType(grad.type());
+    return _sigmoid_backward(grad, x.sigmoid_()).mul_(mask).mul_(beta);
+  }
   return _sigmoid_backward(grad, x.sigmoid()) * (x < threshold).toType(grad.type()) * beta;
 }
 
+// d/d(output) of _sigmoid_backward(grad_output, output)
+Tensor sigmoid_double_backward(const Tensor & grad, const Tensor & grad_output, const Tensor & output) {
+  if (!GradMode::is_enabled()) {
+    return (grad * grad_output).mul_(output.mul(-2).add_(1));
+  }
+  return grad * grad_output * (-2 * output + 1);
+}
+
+// d/d(output) of _tanh_backward(grad_output, output)
+Tensor tanh_double_backward(const Tensor & grad, const Tensor & grad_output, const Tensor & output) {
+  if (!GradMode::is_enabled()) {
+    return (grad * grad_output).mul_(output).mul_(-2);
+  }
+  return -2 * output * grad * grad_output;
+}
+
 
 // NOTE [ as_strided Backward ]
 //
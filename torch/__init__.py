@@ -11,6 +11,25 @@ on an NVIDIA GPU with compute capability >= 3.0.
 import os
 import sys
 import platform
+import time as _time
+
+# Durations of the phases of the startup of torch, e.g. of this import and of
+# the initialization of CUDA, as (phase, seconds). They are printed to stderr
+# as they end when TORCH_SHOW_STARTUP_TIMES=1.
+_startup_times = []
+_import_begin = _startup_phase_begin = _time.time()
+
+
+def _startup_phase(name, begin=None):
+    global _startup_phase_begin
+    now = _time.time()
+    if begin is None:
+        begin, _startup_phase_begin = _startup_phase_begin, now
+    _startup_times.append((name, now - begin))
+    if os.environ.get('TORCH_SHOW_STARTUP_TIMES', '0') != '0':
+        sys.stderr.write('{:9.1f} ms  {}\n'.format((now - begin) * 1e3, name))
+
+
 from ._utils import _import_dotted_name
 from ._utils_internal import get_file_path, prepare_multiprocessing_environment
 from .version import __version__
@@ -91,6 +110,8 @@ if platform.system() != 'Windows':
     sys.setdlopenflags(old_flags)
     del old_flags
 
+_startup_phase('load torch._C')
+
 ################################################################################
 # Define basic utilities
 ################################################################################
@@ -255,6 +276,8 @@ for name in dir(_C._VariableFunctions):
         continue
     globals()[name] = getattr(_C._VariableFunctions, name)
 
+_startup_phase('initialize torch._C')
+
 ################################################################################
 # Import interface functions defined in Python
 ################################################################################
@@ -295,12 +318,16 @@ import torch.testing
 import torch.backends.cuda
 import torch.backends.mkl
 
+_startup_phase('import subpackages')
+
 _C._init_names(list(torch._storage_classes))
 
 # attach docstrings to torch and tensor functions
 from . import _torch_docs, _tensor_docs, _storage_docs
 del _torch_docs, _tensor_docs, _storage_docs
 
+_startup_phase('attach docstrings')
+
 
 def compiled_with_cxx11_abi():
     r"""Returns whether PyTorch was built with _GLIBCXX_USE_CXX11_ABI=1"""
@@ -309,3 +336,5 @@ def compiled_with_cxx11_abi():
 
 # Import the ops "namespace"
 from torch._ops import ops
+
+_startup_phase('import torch', _import_begin)
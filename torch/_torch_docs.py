@@ -5464,6 +5464,10 @@ The inverse of this function is :func:`~torch.ifft`.
     plans currently in cache, and
     ``torch.backends.cuda.cufft_plan_cache.clear()`` to clear the cache.
 
+    For CPU tensors, committed MKL FFT descriptors are cached the same way in
+    ``torch.backends.mkl.fft_plan_cache``, which has the same properties
+    (default capacity is 256).
+
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
     :func:`torch.backends.mkl.is_available` to check if MKL is installed.
@@ -5565,6 +5569,10 @@ The inverse of this function is :func:`~torch.fft`.
     plans currently in cache, and
     ``torch.backends.cuda.cufft_plan_cache.clear()`` to clear the cache.
 
+    For CPU tensors, committed MKL FFT descriptors are cached the same way in
+    ``torch.backends.mkl.fft_plan_cache``, which has the same properties
+    (default capacity is 256).
+
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
     :func:`torch.backends.mkl.is_available` to check if MKL is installed.
@@ -5655,6 +5663,10 @@ The inverse of this function is :func:`~torch.irfft`.
     plans currently in cache, and
     ``torch.backends.cuda.cufft_plan_cache.clear()`` to clear the cache.
 
+    For CPU tensors, committed MKL FFT descriptors are cached the same way in
+    ``torch.backends.mkl.fft_plan_cache``, which has the same properties
+    (default capacity is 256).
+
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
     :func:`torch.backends.mkl.is_available` to check if MKL is installed.
@@ -5737,6 +5749,10 @@ The inverse of this function is :func:`~torch.rfft`.
     plans currently in cache, and
     ``torch.backends.cuda.cufft_plan_cache.clear()`` to clear the cache.
 
+    For CPU tensors, committed MKL FFT descriptors are cached the same way in
+    ``torch.backends.mkl.fft_plan_cache``, which has the same properties
+    (default capacity is 256).
+
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
     :func:`torch.backends.mkl.is_available` to check if MKL is installed.
@@ -12,6 +12,7 @@ from .function import Function, NestedIOFunction
 from .gradcheck import gradcheck, gradgradcheck
 from .grad_mode import no_grad, enable_grad, set_grad_enabled
 from .anomaly_mode import detect_anomaly, set_detect_anomaly
+from .offload import offload_saved_tensors
 from . import profiler
 
 __all__ = ['Variable', 'Function', 'backward', 'grad_mode']
@@ -163,6 +164,26 @@ def _is_checkpoint_valid():
     return Variable._execution_engine.is_checkpoint_valid()
 
 
+def set_num_cpu_threads(num_threads):
+    r"""Sets the number of threads that run the CPU parts of backward passes.
+
+    The threads share one queue of ready functions, so independent branches
+    of a backward graph (e.g. separate towers of a model) are computed in
+    parallel. The default is 1. With more threads, gradients flowing into the
+    same tensor may be summed in a different order from run to run. The number
+    can't be reduced after the first backward pass.
+
+    Each thread still uses the intra-op threads (see :func:`torch.set_num_threads`)
+    for its own kernels, so the two should be balanced.
+    """
+    Variable._execution_engine.set_num_cpu_threads(num_threads)
+
+
+def get_num_cpu_threads():
+    r"""Returns the number of threads that run the CPU parts of backward passes."""
+    return Variable._execution_engine.num_cpu_threads()
+
+
 def variable(*args, **kwargs):
     warnings.warn("torch.autograd.variable(...) is deprecated, use torch.tensor(...) instead")
     return torch.tensor(*args, **kwargs)
@@ -59,16 +59,29 @@ class detect_anomaly(object):
               File "<stdin>", line 8, in backward
             RuntimeError: Some error in backward
 
+    Arguments:
+        lightweight (bool, optional): if ``True``, the forward pass only
+            records the line that created each backward function instead of
+            the whole traceback, and the outputs of the backward functions are
+            checked for "nan" and "inf" values without synchronizing with the
+            device. The error is then raised at the end of the backward pass,
+            naming the first function that generated such values. This is
+            cheap enough to be left on in long runs. Default: ``False``.
+
     """
 
-    def __init__(self):
+    def __init__(self, lightweight=False):
         self.prev = torch.is_anomaly_enabled()
+        self.prev_lightweight = torch._C._is_anomaly_lightweight()
+        self.lightweight = lightweight
 
     def __enter__(self):
         torch.set_anomaly_enabled(True)
+        torch._C._set_anomaly_lightweight(self.lightweight)
 
     def __exit__(self, *args):
         torch.set_anomaly_enabled(self.prev)
+        torch._C._set_anomaly_lightweight(self.prev_lightweight)
         return False
 
 
@@ -84,16 +97,22 @@ class set_detect_anomaly(object):
     Arguments:
         mode (bool): Flag whether to enable anomaly detection (``True``),
                      or disable (``False``).
+        lightweight (bool, optional): Flag whether anomaly detection runs in
+                     the lightweight mode of ``detect_anomaly``.
+                     Default: ``False``.
 
     """
 
-    def __init__(self, mode):
+    def __init__(self, mode, lightweight=False):
         self.prev = torch.is_anomaly_enabled()
+        self.prev_lightweight = torch._C._is_anomaly_lightweight()
         torch.set_anomaly_enabled(mode)
+        torch._C._set_anomaly_lightweight(lightweight)
 
     def __enter__(self):
         pass
 
     def __exit__(self, *args):
         torch.set_anomaly_enabled(self.prev)
+        torch._C._set_anomaly_lightweight(self.prev_lightweight)
         return False
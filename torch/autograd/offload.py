@@ -0,0 +1,39 @@
+import torch
+
+
+class offload_saved_tensors(object):
+    r"""Context-manager that moves the CUDA tensors that autograd saves for the
+    backward pass to pinned host memory.
+
+    Tensors saved by operations run in this context are copied to the host on a
+    side stream, so their device memory can be reused before the backward pass.
+    The backward pass copies each tensor back when it's needed, together with
+    the ``prefetch`` tensors saved right before it, so that the copies overlap
+    with the computation. This trades host-device transfers for device memory,
+    e.g. to fit a larger batch.
+
+    Only the operations run on the current thread are affected.
+
+    Arguments:
+        min_bytes (int): tensors smaller than this stay on the device
+            (default: 1MB)
+        prefetch (int): the number of tensors copied back ahead of the one the
+            backward pass needs (default: 2)
+
+    Example::
+
+        >>> with torch.autograd.offload_saved_tensors():
+        ...     loss = model(input).sum()
+        >>> loss.backward()
+    """
+
+    def __init__(self, min_bytes=1 << 20, prefetch=2):
+        self.min_bytes = min_bytes
+        self.prefetch = prefetch
+
+    def __enter__(self):
+        torch.autograd._enable_saved_tensor_offload(self.min_bytes, self.prefetch)
+
+    def __exit__(self, *args):
+        torch.autograd._disable_saved_tensor_offload()
+        return False
@@ -82,7 +82,7 @@ class EventList(list):
                         name=k.name,
                         ph='f',
                         ts=k.interval.start,
-                        tid=k.device,
+                        tid=k.tid,
                         pid='CUDA functions',
                         id=next_id,
                         cat='cpu_to_cuda',
@@ -93,7 +93,7 @@ class EventList(list):
                         ph='X',
                         ts=k.interval.start,
                         dur=k.interval.elapsed_us(),
-                        tid=k.device,
+                        tid=k.tid,
                         pid='CUDA functions',
                         args={},
                     ))
@@ -137,6 +137,20 @@ class profile(object):
             Adds approximately 4us of overhead to each tensor operation.
             Default: ``False``
 
+        profile_memory (bool, optional): Records the memory allocated and freed on the CPU
+            and by the CUDA caching allocator. Every function event then has the net bytes
+            its function allocated itself (``cpu_memory_usage``, ``cuda_memory_usage``) and
+            the most it had allocated at once, including the functions it called
+            (``cpu_memory_peak``, ``cuda_memory_peak``). Default: ``False``
+
+        use_cupti (bool, optional): Records every CUDA kernel, memcpy and memset with CUPTI,
+            and attributes it to the innermost function that launched it, instead of timing
+            whole functions with CUDA events. This adds no work to the CUDA streams and
+            doesn't synchronize, so it is cheaper than ``use_cuda``, and the kernels show
+            up on their own device and stream in the Chrome trace. The ``cuda_time`` of a
+            function is then the time of its own kernels only. Requires PyTorch to be
+            built with CUPTI, and can't be combined with ``use_cuda``. Default: ``False``
+
     .. warning:
         This context managers should not be called recursively, i.e. at most one
         instance should be enabled at any given time.
@@ -161,12 +175,16 @@ class profile(object):
         N5torch8autograd5CloneE                        4.088us          0.000us
     """
 
-    def __init__(self, enabled=True, use_cuda=False):
+    def __init__(self, enabled=True, use_cuda=False, profile_memory=False, use_cupti=False):
         self.enabled = enabled
         self.use_cuda = use_cuda
+        self.profile_memory = profile_memory
+        self.use_cupti = use_cupti
         self.function_events = None
         if not self.enabled:
             return
+        if self.use_cuda and self.use_cupti:
+            raise ValueError("use_cuda and use_cupti can't be combined")
         self.entered = False
 
     def __enter__(self):
@@ -175,16 +193,21 @@ class profile(object):
         if self.entered:
             raise RuntimeError("autograd profiler traces are not reentrant")
         self.entered = True
-        profiler_kind = torch.autograd.ProfilerState.CUDA if self.use_cuda \
-            else torch.autograd.ProfilerState.CPU
-        torch.autograd._enable_profiler(profiler_kind)
+        if self.use_cupti:
+            profiler_kind = torch.autograd.ProfilerState.CUPTI
+        elif self.use_cuda:
+            profiler_kind = torch.autograd.ProfilerState.CUDA
+        else:
+            profiler_kind = torch.autograd.ProfilerState.CPU
+        torch.autograd._enable_profiler(profiler_kind, self.profile_memory)
         return self
 
     def __exit__(self, exc_type, exc_val, exc_tb):
         if not self.enabled:
             return
         records = torch.autograd._disable_profiler()
-        self.function_events = EventList(parse_cpu_trace(records))
+        kernel_records = torch.autograd._consume_kernel_records() if self.use_cupti else []
+        self.function_events = EventList(parse_cpu_trace(records, kernel_records))
         return False
 
     def __repr__(self):
@@ -317,6 +340,42 @@ class emit_nvtx(object):
         return False
 
 
+def enable_sampling(every_n_ranges=100, interval_us=0):
+    r"""Starts a sampling profiler that is cheap enough to be left on.
+
+    Instead of recording every operation like :class:`profile`, each thread
+    times one operation in ``every_n_ranges`` (or, if ``interval_us`` is
+    positive, the first one that starts ``interval_us`` microseconds after its
+    previous sample) and adds its duration to statistics per operation name,
+    which :func:`sampled_stats` returns. Stop it with :func:`disable_sampling`.
+
+    Arguments:
+        every_n_ranges (int): how often operations are sampled (default: 100)
+        interval_us (float): if positive, sample by time instead (default: 0)
+    """
+    torch.autograd._enable_sampling(every_n_ranges, int(interval_us * 1000))
+
+
+def disable_sampling():
+    r"""Stops the profiler started by :func:`enable_sampling`. The statistics
+    gathered so far are kept."""
+    torch.autograd._disable_profiler()
+
+
+def sampled_stats(reset=False):
+    r"""Returns the statistics gathered by :func:`enable_sampling` on all
+    threads, as a list with one element per operation name, sorted by name.
+
+    Every element has the attributes ``name``, ``count``, ``total_ns``,
+    ``max_ns`` and ``histogram``, where ``histogram[i]`` counts the samples that
+    took between ``2 ** i`` and ``2 ** (i + 1)`` nanoseconds.
+
+    Arguments:
+        reset (bool): clear the statistics after returning them (default: False)
+    """
+    return torch.autograd._get_sampled_stats(reset)
+
+
 def load_nvprof(path):
     """Opens an nvprof trace file and parses autograd annotations.
 
@@ -329,6 +388,21 @@ def load_nvprof(path):
 ################################################################################
 # FunctionEvent
 
+def format_memory(nbytes):
+    """Returns a formatted memory size string"""
+    KB = 1024.
+    MB = 1024. * KB
+    GB = 1024. * MB
+    if abs(nbytes) >= GB:
+        return '{:.2f}Gb'.format(nbytes / GB)
+    elif abs(nbytes) >= MB:
+        return '{:.2f}Mb'.format(nbytes / MB)
+    elif abs(nbytes) >= KB:
+        return '{:.2f}Kb'.format(nbytes / KB)
+    else:
+        return '{}b'.format(nbytes)
+
+
 def format_time(time_us):
     """Defines how to format time in FunctionEvent"""
     return '{:.3f}us'.format(time_us)
@@ -367,10 +441,18 @@ class Interval(object):
 
 
 class Kernel(object):
-    def __init__(self, name, device, interval):
+    def __init__(self, name, device, interval, stream=None):
         self.name = name
         self.device = device
         self.interval = interval
+        self.stream = stream
+
+    @property
+    def tid(self):
+        # the row of the kernel in the Chrome trace
+        if self.stream is None:
+            return self.device
+        return 'device {} stream {}'.format(self.device, self.stream)
 
 
 # TODO: record TID too
@@ -383,9 +465,13 @@ class FunctionEvent(FormattedTimesMixin):
         self.thread = thread
         self.kernels = []
         self.count = 1
+        self.cpu_memory_usage = 0
+        self.cuda_memory_usage = 0
+        self.cpu_memory_peak = 0
+        self.cuda_memory_peak = 0
 
-    def append_kernel(self, name, device, start, end):
-        self.kernels.append(Kernel(name, device, Interval(start, end)))
+    def append_kernel(self, name, device, start, end, stream=None):
+        self.kernels.append(Kernel(name, device, Interval(start, end), stream))
 
     @property
     def cuda_time_total(self):
@@ -409,6 +495,8 @@ class FunctionEventAvg(FormattedTimesMixin):
     def __init__(self):
         self.key = None
         self.count = self.cpu_time_total = self.cuda_time_total = 0
+        self.cpu_memory_usage = self.cuda_memory_usage = 0
+        self.cpu_memory_peak = self.cuda_memory_peak = 0
 
     def __iadd__(self, other):
         if self.key is None:
@@ -417,6 +505,10 @@ class FunctionEventAvg(FormattedTimesMixin):
         assert other.key == self.key
         self.cpu_time_total += other.cpu_time
         self.cuda_time_total += other.cuda_time
+        self.cpu_memory_usage += other.cpu_memory_usage
+        self.cuda_memory_usage += other.cuda_memory_usage
+        self.cpu_memory_peak = max(self.cpu_memory_peak, other.cpu_memory_peak)
+        self.cuda_memory_peak = max(self.cuda_memory_peak, other.cuda_memory_peak)
         self.count += 1
         return self
 
@@ -437,12 +529,17 @@ class StringTable(defaultdict):
 ################################################################################
 # CPU checkpoints
 
-def parse_cpu_trace(thread_records):
+def parse_cpu_trace(thread_records, kernel_records=()):
     next_id = 0
     start_record = None
     cuda_records = {}
     functions = []
     record_stack = []
+    # the functions of the ranges recorded in the CUPTI mode, by correlation id
+    functions_by_range = {}
+    # [cpu usage, cuda usage, cpu current, cpu peak, cuda current, cuda peak]
+    # of the ranges in record_stack
+    memory_stack = []
     string_table = StringTable()
 
     # cuda start events and the overall profiler start event don't happen
@@ -467,17 +564,34 @@ def parse_cpu_trace(thread_records):
     for record in itertools.chain(*thread_records):
         if record.kind() == 'mark':
             continue
+        elif record.kind() == 'memory_alloc':
+            # allocations made outside of any range aren't attributed
+            if not memory_stack:
+                continue
+            cpu_bytes = record.cpu_memory_usage()
+            cuda_bytes = record.cuda_memory_usage()
+            memory_stack[-1][0] += cpu_bytes
+            memory_stack[-1][1] += cuda_bytes
+            for memory in memory_stack:
+                memory[2] += cpu_bytes
+                memory[3] = max(memory[3], memory[2])
+                memory[4] += cuda_bytes
+                memory[5] = max(memory[5], memory[4])
         elif record.kind() == 'push':
             record_stack.append((next_id, record))
+            memory_stack.append([0] * 6)
             next_id += 1
         elif record.kind() == 'pop':
             function_id, start = record_stack.pop()
+            memory = memory_stack.pop()
             fe = FunctionEvent(
                 id=function_id,
                 name=string_table[start.name()],
                 thread=start.thread_id(),
                 cpu_start=start_record.cpu_elapsed_us(start),
                 cpu_end=start_record.cpu_elapsed_us(record))
+            fe.cpu_memory_usage, fe.cuda_memory_usage = memory[0], memory[1]
+            fe.cpu_memory_peak, fe.cuda_memory_peak = memory[3], memory[5]
             if start.has_cuda():
                 cuda_start = adjusted_time(start)
                 cuda_end = adjusted_time(record)
@@ -485,8 +599,21 @@ def parse_cpu_trace(thread_records):
                                  start.device(),
                                  cuda_start,
                                  cuda_end)
+            if start.correlation_id():
+                functions_by_range[start.correlation_id()] = fe
             functions.append(fe)
 
+    # kernels launched outside of any range aren't attributed
+    for k in kernel_records:
+        fe = functions_by_range.get(k.range_id)
+        if fe is None:
+            continue
+        fe.append_kernel(string_table[k.name],
+                         k.device,
+                         (k.start_ns - start_record.cpu_ns()) / 1000.0,
+                         (k.end_ns - start_record.cpu_ns()) / 1000.0,
+                         k.stream)
+
     functions.sort(key=lambda evt: evt.cpu_interval.start)
     return functions
 
@@ -582,8 +709,14 @@ def build_table(events, sort_by=None, header=None):
     max_name_length += 4  # Add some nice padding
     col_width = 15
     col_format = '  {: >' + str(col_width) + '}'
-    row_format = '{: <' + str(max_name_length) + '}' + col_format * 5
-    header_sep = '-' * max_name_length + ('  ' + '-' * col_width) * 5
+    headers = ['Name', 'CPU time', 'CUDA time', 'Calls', 'CPU total', 'CUDA total']
+    # the memory columns are only shown for traces recorded with profile_memory
+    profile_memory = any(evt.cpu_memory_peak or evt.cuda_memory_peak for evt in events)
+    if profile_memory:
+        headers += ['CPU Mem', 'CUDA Mem', 'CPU Mem peak', 'CUDA Mem peak']
+    num_columns = len(headers) - 1
+    row_format = '{: <' + str(max_name_length) + '}' + col_format * num_columns
+    header_sep = '-' * max_name_length + ('  ' + '-' * col_width) * num_columns
 
     # Have to use a list because nonlocal is Py3 only...
     result = []
@@ -594,14 +727,18 @@ def build_table(events, sort_by=None, header=None):
 
     # Actual printing
     if header is not None:
-        line_length = max_name_length + (col_width + 2) * 5
+        line_length = max_name_length + (col_width + 2) * num_columns
         append('=' * line_length)
         append(header)
     append(header_sep)
-    append(row_format.format('Name', 'CPU time', 'CUDA time', 'Calls', 'CPU total', 'CUDA total'))
+    append(row_format.format(*headers))
     append(header_sep)
     for evt in events:
-        append(row_format.format(evt.key, evt.cpu_time_str, evt.cuda_time_str,
-                                 evt.count, evt.cpu_time_total_str, evt.cuda_time_total_str))
+        row = [evt.key, evt.cpu_time_str, evt.cuda_time_str,
+               evt.count, evt.cpu_time_total_str, evt.cuda_time_total_str]
+        if profile_memory:
+            row += [format_memory(evt.cpu_memory_usage), format_memory(evt.cuda_memory_usage),
+                    format_memory(evt.cpu_memory_peak), format_memory(evt.cuda_memory_peak)]
+        append(row_format.format(*row))
 
     return ''.join(result)
@@ -465,6 +465,11 @@ class CudnnModule(object):
     enabled = ContextProp(torch._C._get_cudnn_enabled, torch._C._set_cudnn_enabled)
     deterministic = ContextProp(torch._C._get_cudnn_deterministic, torch._C._set_cudnn_deterministic)
     benchmark = ContextProp(torch._C._get_cudnn_benchmark, torch._C._set_cudnn_benchmark)
+    # File in which the algorithms found by benchmark mode are persisted, or
+    # None. It does not change results, so unlike the flags above it can be
+    # set after disable_global_flags().
+    benchmark_cache = property(lambda self: torch._C._get_cudnn_benchmark_cache(),
+                               lambda self, path: torch._C._set_cudnn_benchmark_cache(path))
 
 # This is the sys.modules replacement trick, see
 # https://stackoverflow.com/questions/2447353/getattr-on-a-module/7668273#7668273
@@ -378,6 +378,29 @@ PyObject *THPModule_benchmarkCuDNN(PyObject *_unused)
   else Py_RETURN_FALSE;
 }
 
+PyObject *THPModule_setBenchmarkCacheCuDNN(PyObject *_unused, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  if (arg == Py_None) {
+    at::globalContext().setBenchmarkCacheFileCuDNN("");
+    Py_RETURN_NONE;
+  }
+  THPUtils_assert(THPUtils_checkString(arg), "set_benchmark_cache_cudnn expects a str "
+          "or None, but got %s", THPUtils_typename(arg));
+  at::globalContext().setBenchmarkCacheFileCuDNN(THPUtils_unpackString(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject *THPModule_benchmarkCacheCuDNN(PyObject *_unused)
+{
+  HANDLE_TH_ERRORS
+  auto path = at::globalContext().benchmarkCacheFileCuDNN();
+  if (path.empty()) Py_RETURN_NONE;
+  return THPUtils_packString(path);
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject *THPModule_setFlushDenormal(PyObject *_unused, PyObject *arg) {
   THPUtils_assert(PyBool_Check(arg), "flush_denormal expects a bool, "
           "but got %s", THPUtils_typename(arg));
@@ -428,6 +451,8 @@ static PyMethodDef TorchMethods[] = {
   {"_set_cudnn_enabled", (PyCFunction)THPModule_setUserEnabledCuDNN, METH_O,  nullptr},
   {"_get_cudnn_benchmark", (PyCFunction)THPModule_benchmarkCuDNN, METH_NOARGS,     nullptr},
   {"_set_cudnn_benchmark", (PyCFunction)THPModule_setBenchmarkCuDNN, METH_O,  nullptr},
+  {"_get_cudnn_benchmark_cache", (PyCFunction)THPModule_benchmarkCacheCuDNN, METH_NOARGS,     nullptr},
+  {"_set_cudnn_benchmark_cache", (PyCFunction)THPModule_setBenchmarkCacheCuDNN, METH_O,  nullptr},
   {"_get_cudnn_deterministic", (PyCFunction)THPModule_deterministicCuDNN, METH_NOARGS,     nullptr},
   {"_set_cudnn_deterministic", (PyCFunction)THPModule_setDeterministicCuDNN, METH_O,  nullptr},
   {"_to_dlpack",      (PyCFunction)THPModule_toDLPack,          METH_O,       nullptr},
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <torch/data/collate.h>
+#include <torch/data/dataloader.h>
+#include <torch/data/datasets.h>
+#include <torch/data/example.h>
+#include <torch/data/samplers.h>
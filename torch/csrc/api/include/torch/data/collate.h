@@ -0,0 +1,32 @@
+#pragma once
+
+#include <torch/data/example.h>
+#include <torch/tensor.h>
+
+#include <ATen/core/ArrayRef.h>
+
+#include <vector>
+
+namespace torch {
+namespace data {
+
+/// Stacks tensors of the same size and type along a new first dimension.
+///
+/// The batch is allocated once at its final size and every tensor is copied
+/// straight into its slice. If `pin_memory` is true, CPU batches are
+/// allocated in page-locked memory, from which they can be copied to CUDA
+/// devices asynchronously. This requires PyTorch to be built with CUDA.
+Tensor stack(at::ArrayRef<Tensor> tensors, bool pin_memory = false);
+
+/// Collates a batch of examples into a single example, whose data and target
+/// are the stacked data and targets of the batch. This is the default
+/// collation of the `DataLoader`.
+struct Stack {
+  explicit Stack(bool pin_memory = false) : pin_memory(pin_memory) {}
+
+  Example<> operator()(std::vector<Example<>> examples) const;
+
+  bool pin_memory;
+};
+} // namespace data
+} // namespace torch
@@ -0,0 +1,439 @@
+#pragma once
+
+#include <torch/arg.h>
+#include <torch/data/collate.h>
+#include <torch/data/datasets/stream.h>
+#include <torch/data/detail/queue.h>
+#include <torch/data/samplers/base.h>
+#include <torch/data/samplers/random.h>
+
+#include <torch/csrc/utils/memory.h>
+
+#include <c10/util/Exception.h>
+#include <c10/util/Optional.h>
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+
+/// Options to configure a `DataLoader`.
+struct DataLoaderOptions {
+  /* implicit */ DataLoaderOptions(size_t batch_size = 1)
+      : batch_size_(batch_size) {}
+
+  /// The number of examples per batch.
+  TORCH_ARG(size_t, batch_size);
+
+  /// The number of worker threads that load batches ahead of time. With no
+  /// workers, batches are loaded by the thread that asks for them.
+  TORCH_ARG(size_t, workers) = 0;
+
+  /// The maximum number of batches that are loaded ahead of time. Defaults
+  /// to twice the number of workers.
+  TORCH_ARG(c10::optional<size_t>, max_jobs);
+
+  /// Whether to drop the last batch of an epoch if it has fewer than
+  /// `batch_size` examples.
+  TORCH_ARG(bool, drop_last) = false;
+
+  /// Whether batches are returned in the order of the sampler, rather than
+  /// in the order in which the workers finish loading them.
+  TORCH_ARG(bool, enforce_ordering) = true;
+
+  /// Whether the default collation allocates batches in page-locked memory,
+  /// for asynchronous copies to CUDA devices.
+  TORCH_ARG(bool, pin_memory) = false;
+};
+
+/// Loads batches of examples from a dataset, in the order given by a sampler,
+/// optionally on a pool of worker threads.
+///
+/// The indices of every batch are drawn from the sampler by the thread that
+/// iterates over the `DataLoader`, and turned into a batch with the dataset's
+/// `get_batch()` and the collation function, either right away or by a
+/// worker thread. Workers load up to `max_jobs` batches ahead of the one that
+/// is being returned, which bounds the memory spent on prefetching.
+///
+/// A `StreamDataset` is not sampled: the `DataLoader` asks it for the next
+/// `batch_size` examples until it runs out of them. Stream datasets load
+/// examples ahead of time on their own, so the `DataLoader` has no workers
+/// for them.
+///
+/// Iterating with `begin()` and `end()` starts a new epoch:
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   auto loader = torch::data::make_data_loader(
+///       dataset, torch::data::DataLoaderOptions(64).workers(4));
+///   for (auto& batch : *loader) {
+///     auto output = model->forward(batch.data);
+///     ...
+///   }
+/// \endrst
+template <typename Dataset, typename Batch = typename Dataset::ExampleType>
+class DataLoader {
+ public:
+  using ExampleType = typename Dataset::ExampleType;
+  using CollateFunction = std::function<Batch(std::vector<ExampleType>)>;
+
+  /// An input iterator over the batches of an epoch.
+  class Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Batch;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Batch*;
+    using reference = Batch&;
+
+    Batch& operator*() {
+      AT_CHECK(batch_.has_value(), "Cannot dereference the end iterator");
+      return *batch_;
+    }
+
+    Batch* operator->() {
+      return &**this;
+    }
+
+    Iterator& operator++() {
+      AT_CHECK(batch_.has_value(), "Cannot increment the end iterator");
+      batch_ = loader_->next();
+      return *this;
+    }
+
+    /// Iterators compare equal if they are both at the end of the epoch, or
+    /// both not.
+    bool operator==(const Iterator& other) const {
+      return batch_.has_value() == other.batch_.has_value();
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class DataLoader;
+
+    explicit Iterator(DataLoader* loader = nullptr) : loader_(loader) {
+      if (loader_ != nullptr) {
+        batch_ = loader_->next();
+      }
+    }
+
+    DataLoader* loader_;
+    c10::optional<Batch> batch_;
+  };
+
+  /// Constructs a `DataLoader` and starts its worker threads. The dataset is
+  /// shared by all workers. The sampler is unused, and may be null, for a
+  /// `StreamDataset`.
+  DataLoader(
+      std::shared_ptr<Dataset> dataset,
+      DataLoaderOptions options,
+      std::unique_ptr<samplers::Sampler> sampler,
+      CollateFunction collate)
+      : dataset_(std::move(dataset)),
+        options_(std::move(options)),
+        sampler_(std::move(sampler)),
+        collate_(std::move(collate)) {
+    AT_CHECK(options_.batch_size() > 0, "batch_size must be positive");
+    if (!options_.max_jobs().has_value()) {
+      options_.max_jobs(2 * options_.workers());
+    }
+    AT_CHECK(
+        options_.workers() == 0 || *options_.max_jobs() > 0,
+        "max_jobs must be positive when there are workers");
+    start_workers(IsStream());
+  }
+
+  DataLoader(const DataLoader&) = delete;
+  DataLoader& operator=(const DataLoader&) = delete;
+
+  /// Waits for the batches that are being loaded and joins the workers.
+  ~DataLoader() {
+    for (size_t w = 0; w < workers_.size(); ++w) {
+      jobs_.push(Job());
+    }
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /// Starts a new epoch, and returns an iterator to its first batch.
+  Iterator begin() {
+    reset();
+    return Iterator(this);
+  }
+
+  /// Returns the iterator past the last batch of an epoch.
+  Iterator end() {
+    return Iterator();
+  }
+
+  /// Resets the sampler, or the stream dataset, to start a new epoch.
+  /// Batches of the previous epoch that were loaded ahead of time are
+  /// discarded.
+  void reset() {
+    reset(IsStream());
+  }
+
+  /// Returns the next batch of the epoch, or `nullopt` at its end. Rethrows
+  /// any exception that was thrown while loading the batch.
+  c10::optional<Batch> next() {
+    return next(IsStream());
+  }
+
+  const DataLoaderOptions& options() const noexcept {
+    return options_;
+  }
+
+ private:
+  /// `std::true_type` for a `StreamDataset`, `std::false_type` for a
+  /// `Dataset` that is sampled by index. Methods that only apply to either
+  /// kind are overloaded on it, so that only one of them is instantiated.
+  using IsStream = typename datasets::is_stream_dataset<Dataset>::type;
+
+  struct Job {
+    /// A job without indices stops the worker that takes it.
+    c10::optional<std::vector<size_t>> indices;
+    size_t sequence = 0;
+  };
+
+  struct Result {
+    size_t sequence = 0;
+    c10::optional<Batch> batch;
+    std::exception_ptr exception;
+  };
+
+  void start_workers(std::false_type) {
+    for (size_t w = 0; w < options_.workers(); ++w) {
+      workers_.emplace_back([this] { this->worker_thread(); });
+    }
+  }
+
+  void start_workers(std::true_type) {
+    AT_CHECK(
+        options_.workers() == 0,
+        "A DataLoader over a StreamDataset can't have workers");
+  }
+
+  void reset(std::false_type) {
+    while (in_flight_ > 0) {
+      results_.pop();
+      --in_flight_;
+    }
+    reordered_.clear();
+    next_sequence_ = 0;
+    expected_sequence_ = 0;
+    sampler_->reset();
+    prefetch();
+  }
+
+  void reset(std::true_type) {
+    dataset_->reset();
+  }
+
+  c10::optional<Batch> next(std::true_type) {
+    auto examples = dataset_->get_batch(options_.batch_size());
+    if (!examples.has_value() ||
+        (options_.drop_last() && examples->size() < options_.batch_size())) {
+      return c10::nullopt;
+    }
+    return collate_(std::move(*examples));
+  }
+
+  c10::optional<Batch> next(std::false_type) {
+    if (workers_.empty()) {
+      auto indices = next_indices();
+      if (!indices.has_value()) {
+        return c10::nullopt;
+      }
+      return load(std::move(*indices));
+    }
+
+    prefetch();
+    if (in_flight_ == 0 && reordered_.empty()) {
+      return c10::nullopt;
+    }
+
+    Result result;
+    if (options_.enforce_ordering()) {
+      while (reordered_.count(expected_sequence_) == 0) {
+        auto popped = results_.pop();
+        --in_flight_;
+        const auto sequence = popped.sequence;
+        reordered_.emplace(sequence, std::move(popped));
+      }
+      auto it = reordered_.find(expected_sequence_);
+      result = std::move(it->second);
+      reordered_.erase(it);
+      ++expected_sequence_;
+    } else {
+      result = results_.pop();
+      --in_flight_;
+    }
+
+    prefetch();
+    if (result.exception) {
+      std::rethrow_exception(result.exception);
+    }
+    return std::move(result.batch);
+  }
+
+  /// Returns the indices of the next batch, honoring `drop_last`.
+  c10::optional<std::vector<size_t>> next_indices() {
+    auto indices = sampler_->next(options_.batch_size());
+    if (indices.has_value() && options_.drop_last() &&
+        indices->size() < options_.batch_size()) {
+      return c10::nullopt;
+    }
+    return indices;
+  }
+
+  Batch load(std::vector<size_t> indices) {
+    return collate_(dataset_->get_batch(indices));
+  }
+
+  /// Hands out jobs to the workers until `max_jobs` batches are loaded or
+  /// being loaded, or the sampler is exhausted.
+  void prefetch() {
+    if (workers_.empty()) {
+      return;
+    }
+    while (in_flight_ + reordered_.size() < *options_.max_jobs()) {
+      auto indices = next_indices();
+      if (!indices.has_value()) {
+        break;
+      }
+      Job job;
+      job.indices = std::move(indices);
+      job.sequence = next_sequence_++;
+      jobs_.push(std::move(job));
+      ++in_flight_;
+    }
+  }
+
+  void worker_thread() {
+    while (true) {
+      auto job = jobs_.pop();
+      if (!job.indices.has_value()) {
+        break;
+      }
+      Result result;
+      result.sequence = job.sequence;
+      try {
+        result.batch = load(std::move(*job.indices));
+      } catch (...) {
+        result.exception = std::current_exception();
+      }
+      results_.push(std::move(result));
+    }
+  }
+
+  std::shared_ptr<Dataset> dataset_;
+  DataLoaderOptions options_;
+  std::unique_ptr<samplers::Sampler> sampler_;
+  CollateFunction collate_;
+
+  detail::Queue<Job> jobs_;
+  detail::Queue<Result> results_;
+  std::vector<std::thread> workers_;
+
+  /// Number of jobs handed to the workers whose result wasn't popped yet.
+  size_t in_flight_{0};
+  /// Results popped ahead of their turn when enforcing the order.
+  std::map<size_t, Result> reordered_;
+  size_t next_sequence_{0};
+  size_t expected_sequence_{0};
+};
+
+namespace detail {
+template <typename Dataset>
+std::unique_ptr<samplers::Sampler> default_sampler(
+    const Dataset& dataset,
+    std::false_type) {
+  return torch::make_unique<samplers::RandomSampler>(dataset.size());
+}
+
+/// Stream datasets aren't sampled.
+template <typename Dataset>
+std::unique_ptr<samplers::Sampler> default_sampler(
+    const Dataset&,
+    std::true_type) {
+  return nullptr;
+}
+} // namespace detail
+
+/// Creates a `DataLoader` for a dataset of `Example<>`s, whose batches are
+/// stacked with `Stack`. The examples are visited in a random order, unless
+/// another sampler is given.
+template <typename Dataset>
+typename std::enable_if<
+    !datasets::is_stream_dataset<Dataset>::value,
+    std::unique_ptr<DataLoader<Dataset>>>::type
+make_data_loader(
+    std::shared_ptr<Dataset> dataset,
+    DataLoaderOptions options = DataLoaderOptions(),
+    std::unique_ptr<samplers::Sampler> sampler = nullptr) {
+  if (!sampler) {
+    sampler = torch::make_unique<samplers::RandomSampler>(dataset->size());
+  }
+  const auto pin_memory = options.pin_memory();
+  return torch::make_unique<DataLoader<Dataset>>(
+      std::move(dataset),
+      std::move(options),
+      std::move(sampler),
+      Stack(pin_memory));
+}
+
+/// Creates a `DataLoader` for a `StreamDataset` of `Example<>`s, whose
+/// batches are stacked with `Stack`.
+template <typename Dataset>
+typename std::enable_if<
+    datasets::is_stream_dataset<Dataset>::value,
+    std::unique_ptr<DataLoader<Dataset>>>::type
+make_data_loader(
+    std::shared_ptr<Dataset> dataset,
+    DataLoaderOptions options = DataLoaderOptions()) {
+  const auto pin_memory = options.pin_memory();
+  return torch::make_unique<DataLoader<Dataset>>(
+      std::move(dataset), std::move(options), nullptr, Stack(pin_memory));
+}
+
+/// Creates a `DataLoader` that collates batches with `collate`, which is
+/// called concurrently by the workers. The sampler is ignored for a
+/// `StreamDataset`.
+template <typename Dataset, typename Collate>
+auto make_data_loader(
+    std::shared_ptr<Dataset> dataset,
+    DataLoaderOptions options,
+    std::unique_ptr<samplers::Sampler> sampler,
+    Collate collate)
+    -> std::unique_ptr<DataLoader<
+        Dataset,
+        decltype(collate(
+            std::declval<std::vector<typename Dataset::ExampleType>>()))>> {
+  using Batch = decltype(
+      collate(std::declval<std::vector<typename Dataset::ExampleType>>()));
+  if (!sampler) {
+    sampler = detail::default_sampler(
+        *dataset, typename datasets::is_stream_dataset<Dataset>::type());
+  }
+  return torch::make_unique<DataLoader<Dataset, Batch>>(
+      std::move(dataset),
+      std::move(options),
+      std::move(sampler),
+      std::move(collate));
+}
+} // namespace data
+} // namespace torch
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <torch/data/datasets/base.h>
+#include <torch/data/datasets/chunk.h>
+#include <torch/data/datasets/stream.h>
+#include <torch/data/datasets/tensor.h>
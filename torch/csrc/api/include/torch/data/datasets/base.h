@@ -0,0 +1,47 @@
+#pragma once
+
+#include <torch/data/example.h>
+
+#include <ATen/core/ArrayRef.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// A dataset that can be indexed by the `DataLoader`.
+///
+/// A `Dataset` returns the example at a given index with `get()`, and the
+/// batch of examples at a list of indices with `get_batch()`, which datasets
+/// that can read many examples at once (e.g. from a single file) should
+/// override. When the `DataLoader` uses worker threads, `get()` and
+/// `get_batch()` are called concurrently from all of them, so they must be
+/// thread safe.
+template <typename ExampleType_ = Example<>>
+class Dataset {
+ public:
+  using ExampleType = ExampleType_;
+
+  virtual ~Dataset() = default;
+
+  /// Returns the example at the given index.
+  virtual ExampleType get(size_t index) = 0;
+
+  /// Returns the number of examples in the dataset.
+  virtual size_t size() const = 0;
+
+  /// Returns the examples at the given indices, in order.
+  virtual std::vector<ExampleType> get_batch(at::ArrayRef<size_t> indices) {
+    std::vector<ExampleType> batch;
+    batch.reserve(indices.size());
+    for (const auto index : indices) {
+      batch.push_back(get(index));
+    }
+    return batch;
+  }
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <torch/arg.h>
+#include <torch/data/datasets/stream.h>
+
+#include <c10/util/Exception.h>
+#include <c10/util/Optional.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// Reads a dataset that is split into chunks, such as files or ranges of keys
+/// of a database, one whole chunk at a time.
+///
+/// `read_chunk()` is called concurrently by the preloader threads of a
+/// `ChunkDataset`, for different chunks. A reader for a `caffe2::db`
+/// (LMDB, LevelDB, ...) can open a cursor per call and seek to the first key
+/// of the chunk.
+template <typename ExampleType_ = Example<>>
+class ChunkDataReader {
+ public:
+  using ExampleType = ExampleType_;
+  using ChunkType = std::vector<ExampleType>;
+
+  virtual ~ChunkDataReader() = default;
+
+  /// Returns the examples of the chunk at `chunk_index`.
+  virtual ChunkType read_chunk(size_t chunk_index) = 0;
+
+  /// Returns the number of chunks in the dataset.
+  virtual size_t chunk_count() = 0;
+};
+
+/// Options to configure a `ChunkDataset`.
+struct ChunkDatasetOptions {
+  /* implicit */ ChunkDatasetOptions(size_t preloader_count = 1)
+      : preloader_count_(preloader_count) {}
+
+  /// The number of threads that read chunks in parallel.
+  TORCH_ARG(size_t, preloader_count);
+
+  /// The number of examples buffered ahead of the batches being returned.
+  /// Preloaders stop adding chunks to the buffer once it holds this many, so
+  /// it holds at most one more chunk per preloader. Examples are shuffled
+  /// within the buffer, which should hold examples of several chunks.
+  TORCH_ARG(size_t, cache_size) = 2048;
+
+  /// Whether chunks are read in a random order, and examples are drawn from
+  /// the buffer at random, rather than in order.
+  TORCH_ARG(bool, shuffle) = true;
+
+  /// The seed of the order of chunks, which must be the same for all ranks.
+  /// It changes with every epoch.
+  TORCH_ARG(uint64_t, seed) = 0;
+
+  /// The rank of this process, and the number of processes, among which the
+  /// chunks of every epoch are split.
+  TORCH_ARG(size_t, rank) = 0;
+  TORCH_ARG(size_t, world_size) = 1;
+};
+
+/// A `StreamDataset` for datasets that are larger than memory, read one chunk
+/// at a time by a `ChunkDataReader`.
+///
+/// Every epoch, the chunks are shuffled and split among ranks, so that every
+/// rank reads a different subset of them: chunk `chunks[i]` goes to rank
+/// `i % world_size`. Ranks receive the same number of chunks only if the
+/// number of chunks is a multiple of `world_size`. Preloader threads read the
+/// chunks of this rank in parallel into a bounded buffer, from which
+/// `get_batch()` draws examples at random, mixing examples of the chunks that
+/// are in the buffer.
+///
+/// `reset()` must be called to start the first epoch, which `DataLoader`
+/// does:
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   auto dataset = std::make_shared<ChunkDataset<MyReader>>(
+///       std::make_shared<MyReader>(files),
+///       ChunkDatasetOptions(4).rank(rank).world_size(world_size));
+///   auto loader = torch::data::make_data_loader(dataset, 64);
+/// \endrst
+template <typename ChunkReader>
+class ChunkDataset : public StreamDataset<typename ChunkReader::ExampleType> {
+ public:
+  using ExampleType = typename ChunkReader::ExampleType;
+
+  ChunkDataset(
+      std::shared_ptr<ChunkReader> reader,
+      ChunkDatasetOptions options = ChunkDatasetOptions())
+      : reader_(std::move(reader)), options_(std::move(options)) {
+    AT_CHECK(
+        options_.preloader_count() > 0, "preloader_count must be positive");
+    AT_CHECK(options_.cache_size() > 0, "cache_size must be positive");
+    AT_CHECK(
+        options_.rank() < options_.world_size(),
+        "rank must be smaller than world_size");
+  }
+
+  ChunkDataset(const ChunkDataset&) = delete;
+  ChunkDataset& operator=(const ChunkDataset&) = delete;
+
+  ~ChunkDataset() override {
+    stop();
+  }
+
+  /// Discards the chunks of the current epoch, and starts reading the chunks
+  /// of the next one.
+  void reset() override {
+    stop();
+
+    std::vector<size_t> order(reader_->chunk_count());
+    std::iota(order.begin(), order.end(), 0);
+    if (options_.shuffle()) {
+      std::mt19937_64 generator(options_.seed() + epoch_);
+      std::shuffle(order.begin(), order.end(), generator);
+    }
+    chunks_.clear();
+    for (size_t i = options_.rank(); i < order.size();
+         i += options_.world_size()) {
+      chunks_.push_back(order[i]);
+    }
+    // The order of examples only needs to differ between ranks, not to agree.
+    generator_.seed(
+        (options_.seed() + epoch_) * options_.world_size() + options_.rank());
+    ++epoch_;
+
+    next_chunk_ = 0;
+    chunks_left_ = chunks_.size();
+    examples_.clear();
+    exception_ = nullptr;
+    stop_ = false;
+    for (size_t p = 0; p < options_.preloader_count(); ++p) {
+      preloaders_.emplace_back([this] { this->preloader_thread(); });
+    }
+  }
+
+  /// Returns `batch_size` examples drawn from the buffer, once it holds that
+  /// many, or the remaining examples of the epoch. Rethrows any exception
+  /// thrown by the reader.
+  c10::optional<std::vector<ExampleType>> get_batch(
+      size_t batch_size) override {
+    AT_CHECK(epoch_ > 0, "reset() must be called before get_batch()");
+    AT_CHECK(
+        batch_size <= options_.cache_size(),
+        "batch_size must not be larger than cache_size");
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] {
+      return examples_.size() >= batch_size || chunks_left_ == 0 ||
+          exception_;
+    });
+    if (exception_) {
+      auto exception = exception_;
+      exception_ = nullptr;
+      std::rethrow_exception(exception);
+    }
+    if (examples_.empty()) {
+      return c10::nullopt;
+    }
+
+    const auto size = std::min(batch_size, examples_.size());
+    std::vector<ExampleType> batch;
+    batch.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+      if (options_.shuffle()) {
+        std::uniform_int_distribution<size_t> index(0, examples_.size() - 1);
+        std::swap(examples_[index(generator_)], examples_.back());
+        batch.push_back(std::move(examples_.back()));
+        examples_.pop_back();
+      } else {
+        batch.push_back(std::move(examples_.front()));
+        examples_.pop_front();
+      }
+    }
+    lock.unlock();
+    cv_.notify_all();
+    return batch;
+  }
+
+  const ChunkDatasetOptions& options() const noexcept {
+    return options_;
+  }
+
+ private:
+  void preloader_thread() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_ && next_chunk_ < chunks_.size()) {
+      const auto chunk_index = chunks_[next_chunk_++];
+      lock.unlock();
+      typename ChunkReader::ChunkType chunk;
+      std::exception_ptr exception;
+      try {
+        chunk = reader_->read_chunk(chunk_index);
+      } catch (...) {
+        exception = std::current_exception();
+      }
+      lock.lock();
+
+      cv_.wait(lock, [&] {
+        return stop_ || examples_.size() < options_.cache_size();
+      });
+      if (stop_) {
+        break;
+      }
+      if (exception) {
+        exception_ = exception;
+      } else {
+        for (auto& example : chunk) {
+          examples_.push_back(std::move(example));
+        }
+      }
+      --chunks_left_;
+      cv_.notify_all();
+    }
+  }
+
+  /// Stops and joins the preloaders of the current epoch.
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& preloader : preloaders_) {
+      preloader.join();
+    }
+    preloaders_.clear();
+  }
+
+  std::shared_ptr<ChunkReader> reader_;
+  ChunkDatasetOptions options_;
+  size_t epoch_{0};
+
+  std::vector<std::thread> preloaders_;
+  std::mt19937_64 generator_;
+
+  /// Guards the members below, which are shared with the preloaders.
+  std::mutex mutex_;
+  /// Signaled when examples are added to or removed from the buffer.
+  std::condition_variable cv_;
+  bool stop_{false};
+  /// The chunks of this rank for the current epoch, in the order they are
+  /// read, and the position of the next one to read.
+  std::vector<size_t> chunks_;
+  size_t next_chunk_{0};
+  /// The number of chunks that were not added to the buffer yet.
+  size_t chunks_left_{0};
+  std::deque<ExampleType> examples_;
+  std::exception_ptr exception_;
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <torch/data/example.h>
+
+#include <c10/util/Optional.h>
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// A dataset whose examples can't be indexed, but are read in sequence, such
+/// as a dataset that is too large to fit in memory and is streamed from
+/// files. The `DataLoader` asks it for batches of a given size, instead of
+/// sampling indices.
+template <typename ExampleType_ = Example<>>
+class StreamDataset {
+ public:
+  using ExampleType = ExampleType_;
+
+  virtual ~StreamDataset() = default;
+
+  /// Starts a new epoch.
+  virtual void reset() = 0;
+
+  /// Returns the next `batch_size` examples of the epoch, or fewer at its
+  /// end, or `nullopt` once all examples of the epoch have been returned.
+  virtual c10::optional<std::vector<ExampleType>> get_batch(
+      size_t batch_size) = 0;
+};
+
+/// Whether `Dataset` is a `StreamDataset`, rather than an indexed `Dataset`.
+template <typename Dataset>
+struct is_stream_dataset
+    : std::is_base_of<StreamDataset<typename Dataset::ExampleType>, Dataset> {
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
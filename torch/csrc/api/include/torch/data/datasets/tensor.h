@@ -0,0 +1,50 @@
+#pragma once
+
+#include <torch/data/datasets/base.h>
+#include <torch/data/example.h>
+#include <torch/tensor.h>
+
+#include <c10/util/Exception.h>
+
+#include <cstddef>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// A dataset of examples held in two tensors, whose first dimension indexes
+/// the examples: `data[i]` and `target[i]` form the `i`-th example.
+class TensorDataset : public Dataset<Example<>> {
+ public:
+  TensorDataset(Tensor data, Tensor target)
+      : data_(std::move(data)), target_(std::move(target)) {
+    AT_CHECK(
+        data_.dim() > 0 && target_.dim() > 0 &&
+            data_.size(0) == target_.size(0),
+        "TensorDataset requires data and target with the same size in the "
+        "first dimension");
+  }
+
+  Example<> get(size_t index) override {
+    return {data_[index], target_[index]};
+  }
+
+  size_t size() const override {
+    return data_.size(0);
+  }
+
+  const Tensor& data() const noexcept {
+    return data_;
+  }
+
+  const Tensor& target() const noexcept {
+    return target_;
+  }
+
+ private:
+  Tensor data_;
+  Tensor target_;
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
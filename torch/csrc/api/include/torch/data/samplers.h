@@ -0,0 +1,5 @@
+#pragma once
+
+#include <torch/data/samplers/base.h>
+#include <torch/data/samplers/random.h>
+#include <torch/data/samplers/sequential.h>
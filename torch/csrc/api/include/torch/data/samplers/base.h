@@ -0,0 +1,27 @@
+#pragma once
+
+#include <c10/util/Optional.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace samplers {
+
+/// A `Sampler` decides in which order the `DataLoader` visits the indices of
+/// a dataset.
+class Sampler {
+ public:
+  virtual ~Sampler() = default;
+
+  /// Resets the sampler to the start of a new epoch.
+  virtual void reset() = 0;
+
+  /// Returns the next `batch_size` indices, or fewer at the end of the epoch,
+  /// or `nullopt` once all indices of the epoch have been returned.
+  virtual c10::optional<std::vector<size_t>> next(size_t batch_size) = 0;
+};
+} // namespace samplers
+} // namespace data
+} // namespace torch
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <torch/data/samplers/base.h>
+#include <torch/tensor.h>
+
+#include <c10/util/Optional.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace samplers {
+
+/// Returns the indices `[0, size)` in a random order, which is drawn anew
+/// with `torch::randperm` on every `reset()`, so it follows
+/// `torch::manual_seed()`.
+class RandomSampler : public Sampler {
+ public:
+  explicit RandomSampler(int64_t size);
+
+  void reset() override;
+
+  c10::optional<std::vector<size_t>> next(size_t batch_size) override;
+
+  /// Returns how many indices have been returned in this epoch.
+  size_t index() const noexcept;
+
+ private:
+  int64_t size_;
+  Tensor indices_;
+  int64_t index_{0};
+};
+} // namespace samplers
+} // namespace data
+} // namespace torch
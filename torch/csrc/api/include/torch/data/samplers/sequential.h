@@ -0,0 +1,32 @@
+#pragma once
+
+#include <torch/data/samplers/base.h>
+
+#include <c10/util/Optional.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace samplers {
+
+/// Returns the indices `[0, size)` in order.
+class SequentialSampler : public Sampler {
+ public:
+  explicit SequentialSampler(size_t size);
+
+  void reset() override;
+
+  c10::optional<std::vector<size_t>> next(size_t batch_size) override;
+
+  /// Returns how many indices have been returned in this epoch.
+  size_t index() const noexcept;
+
+ private:
+  size_t size_;
+  size_t index_{0};
+};
+} // namespace samplers
+} // namespace data
+} // namespace torch
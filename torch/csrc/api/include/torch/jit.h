@@ -1,10 +1,17 @@
 #pragma once
+#include <torch/nn/module.h>
+#include <torch/nn/pimpl.h>
+#include <torch/tensor.h>
+
 #include <torch/csrc/jit/script/compiler.h>
 #include <torch/csrc/jit/script/module.h>
 #include <torch/csrc/jit/stack.h>
+#include <torch/csrc/utils/variadic.h>
 
+#include <functional>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace torch {
 namespace jit {
@@ -31,5 +38,61 @@ namespace jit {
 /// \endrst
 std::shared_ptr<script::Module> compile(const std::string& source);
 
+/// Traces `function`, which computes the output of `module` from its inputs,
+/// into the `forward` method of a `script::Module`.
+///
+/// The parameters and buffers of `module`, and of its submodules, become the
+/// parameters and buffers of the returned module, under the same names. They
+/// are shared rather than copied, so the traced module always computes with
+/// the current values of `module`, e.g. while an optimizer updates them.
+/// Calls of the traced `forward` run through a `GraphExecutor`, which
+/// optimizes the graph, fuses elementwise operations on CUDA tensors into
+/// single kernels, and differentiates the graph as a whole.
+///
+/// Like all traces, the graph only records the operations that ran on the
+/// `example_inputs`: control flow that depends on the inputs is fixed, and
+/// the trace records whether `module` was in training mode.
+std::shared_ptr<script::Module> trace(
+    nn::Module& module,
+    std::vector<Tensor> example_inputs,
+    const std::function<IValue(const std::vector<Tensor>&)>& function);
+
+namespace detail {
+template <typename ModuleType, size_t... Is>
+IValue call_forward(
+    ModuleType& module,
+    const std::vector<Tensor>& inputs,
+    torch::Indices<Is...>) {
+  return module.forward(inputs[Is]...);
+}
+} // namespace detail
+
+/// Traces the `forward()` method of `module`, called with `example_inputs`,
+/// into a `script::Module` that shares the parameters of `module`.
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   torch::nn::Sequential model(
+///       torch::nn::Linear(784, 256),
+///       torch::nn::Functional(torch::relu),
+///       torch::nn::Linear(256, 10));
+///   auto traced = torch::jit::trace(model, torch::randn({64, 784}));
+///   auto output = traced->forward({batch}).toTensor();
+/// \endrst
+template <typename ModuleType, typename... Tensors>
+std::shared_ptr<script::Module> trace(
+    const nn::ModuleHolder<ModuleType>& module,
+    const Tensors&... example_inputs) {
+  auto impl = module.ptr();
+  return trace(
+      *impl, {example_inputs...}, [impl](const std::vector<Tensor>& inputs) {
+        return detail::call_forward(
+            *impl,
+            inputs,
+            typename torch::MakeIndices<sizeof...(Tensors)>::indices{});
+      });
+}
+
 } // namespace jit
 } // namespace torch
@@ -54,9 +54,22 @@ namespace nn {
 ///
 /// Note that `Functional` overloads the call operator (`operator()`) such that
 /// you can invoke it with `my_func(...)`.
+///
+/// An in-place version of the function can be supplied with `inplace()`, which
+/// a `CompiledSequential` uses to apply the function without allocating its
+/// output:
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   Sequential sequential(
+///     Linear(3, 4),
+///     Functional(torch::relu)->inplace(torch::relu_));
+/// \endrst
 class FunctionalImpl : public torch::nn::Cloneable<FunctionalImpl> {
  public:
   using Function = std::function<Tensor(Tensor)>;
+  using InplaceFunction = std::function<void(Tensor&)>;
 
   /// Constructs a `Functional` from a function object.
   explicit FunctionalImpl(Function function);
@@ -84,8 +97,17 @@ class FunctionalImpl : public torch::nn::Cloneable<FunctionalImpl> {
   /// Calls forward(input).
   Tensor operator()(Tensor input);
 
+  /// Sets a function that computes the same as the wrapped function, but in
+  /// place of its input, such as `torch::relu_` for `torch::relu`.
+  FunctionalImpl& inplace(InplaceFunction function);
+
+  /// The in-place version of the function, which is empty unless set with
+  /// `inplace()`.
+  const InplaceFunction& inplace_function() const noexcept;
+
  private:
   Function function_;
+  InplaceFunction inplace_function_;
 };
 
 /// A `ModuleHolder` subclass for `FunctionalImpl`.
@@ -12,6 +12,7 @@
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 namespace torch {
@@ -27,6 +28,48 @@ struct RNNOutput {
   Tensor state;
 };
 
+/// A batch of variable length sequences, packed so that RNN modules only
+/// compute the valid steps of every sequence rather than its padding.
+/// See https://pytorch.org/docs/master/nn.html#torch.nn.utils.rnn.PackedSequence
+/// to learn about the layout of the data.
+struct PackedSequence {
+  /// The steps of all sequences, ordered by time step and then by sequence,
+  /// with shape `(sum of lengths, features)`.
+  Tensor data;
+  /// A 1D CPU int64 tensor holding the number of sequences at every time
+  /// step.
+  Tensor batch_sizes;
+};
+
+/// Packs a padded batch of variable length sequences. `lengths` is a 1D CPU
+/// int64 tensor holding the length of every sequence, which must be sorted in
+/// decreasing order. The `input` should follow a `(sequence, batch, *)` layout
+/// unless `batch_first` is true, in which case the layout should be `(batch,
+/// sequence, *)`.
+PackedSequence pack_padded_sequence(
+    Tensor input,
+    Tensor lengths,
+    bool batch_first = false);
+
+/// Pads a packed batch of variable length sequences, the inverse of
+/// `pack_padded_sequence`. Returns the padded batch and the lengths of the
+/// sequences. The padded batch is `total_length` steps long if it is
+/// positive, otherwise as long as the longest sequence.
+std::tuple<Tensor, Tensor> pad_packed_sequence(
+    PackedSequence sequence,
+    bool batch_first = false,
+    double padding_value = 0.0,
+    int64_t total_length = -1);
+
+/// The output of a single invocation of an RNN module's `packed_forward()`
+/// method.
+struct PackedRNNOutput {
+  /// The outputs of all valid steps, packed like the input sequence.
+  PackedSequence output;
+  /// The state after the last valid step of every sequence.
+  Tensor state;
+};
+
 namespace detail {
 
 /// Common options for LSTM and GRU modules.
@@ -73,6 +116,13 @@ class RNNImplBase : public torch::nn::Cloneable<Derived> {
   void to(torch::Device device, torch::Dtype dtype, bool non_blocking = false)
       override;
   void to(torch::Dtype dtype, bool non_blocking = false) override;
+
+  /// Overrides `nn::Module::to()` to move the buffer the parameters were
+  /// flattened into by `flatten_parameters()` as a whole, if they are still
+  /// views of it, and to make the parameters views of the moved buffer. This
+  /// takes a single copy and keeps the cuDNN layout of the weights, so that
+  /// moving the module back and forth between devices never reflattens them.
+  /// Otherwise calls `flatten_parameters()` after the original operation.
   void to(torch::Device device, bool non_blocking = false) override;
 
   /// Modifies the internal storage of weights for optimization purposes.
@@ -83,6 +133,9 @@ class RNNImplBase : public torch::nn::Cloneable<Derived> {
   /// time a parameter is assigned a new value. This allows using the fast path
   /// in cuDNN implementations of respective RNN `forward()` methods. It is
   /// called once upon construction, inside `reset()`.
+  ///
+  /// With cuDNN, the parameters become views of a single buffer, which
+  /// persists across moves between devices (see `to()`).
   void flatten_parameters();
 
   /// The RNN's options.
@@ -110,6 +163,19 @@ class RNNImplBase : public torch::nn::Cloneable<Derived> {
       /*bidirectional=*/bool,
       /*batch_first=*/bool);
 
+  /// The function signature of the packed overloads of `at::rnn_relu`,
+  /// `at::rnn_tanh` and `at::gru`.
+  using PackedRNNFunctionSignature = std::tuple<Tensor, Tensor>(
+      /*data=*/const Tensor&,
+      /*batch_sizes=*/const Tensor&,
+      /*state=*/const Tensor&,
+      /*params=*/TensorList,
+      /*has_biases=*/bool,
+      /*layers=*/int64_t,
+      /*dropout=*/double,
+      /*train=*/bool,
+      /*bidirectional=*/bool);
+
   /// A generic `forward()` used for RNN and GRU (but not LSTM!). Takes the ATen
   /// RNN function as first argument.
   RNNOutput generic_forward(
@@ -117,6 +183,13 @@ class RNNImplBase : public torch::nn::Cloneable<Derived> {
       Tensor input,
       Tensor state);
 
+  /// A generic `packed_forward()` used for RNN and GRU (but not LSTM!). Takes
+  /// the packed overload of the ATen RNN function as first argument.
+  PackedRNNOutput generic_packed_forward(
+      std::function<PackedRNNFunctionSignature> function,
+      PackedSequence input,
+      Tensor state);
+
   /// Returns a flat vector of all weights, with layer weights following each
   /// other sequentially in (w_ih, w_hh, b_ih, b_hh) order.
   std::vector<Tensor> flat_weights() const;
@@ -124,6 +197,9 @@ class RNNImplBase : public torch::nn::Cloneable<Derived> {
   /// Very simple check if any of the parameters (weights, biases) are the same.
   bool any_parameters_alias() const;
 
+  /// Whether all parameters are still views of `flat_weights_buffer_`.
+  bool parameters_are_flattened() const;
+
   /// The number of gate weights/biases required by the RNN subclass.
   int64_t number_of_gates_;
 
@@ -132,6 +208,9 @@ class RNNImplBase : public torch::nn::Cloneable<Derived> {
 
   /// The cached result of the latest `flat_weights()` call.
   std::vector<Tensor> flat_weights_;
+
+  /// The buffer cuDNN flattened the parameters into, if any.
+  Tensor flat_weights_buffer_;
 };
 } // namespace detail
 
@@ -184,6 +263,10 @@ class RNNImpl : public detail::RNNImplBase<RNNImpl> {
   /// sequence, features)`.
   RNNOutput forward(Tensor input, Tensor state = {});
 
+  /// Applies the `RNN` module to a packed batch of variable length sequences
+  /// and input state, computing only the valid steps of every sequence.
+  PackedRNNOutput packed_forward(PackedSequence input, Tensor state = {});
+
   RNNOptions options;
 };
 
@@ -211,6 +294,10 @@ class LSTMImpl : public detail::RNNImplBase<LSTMImpl> {
   /// `batch_first` is true, in which case the layout should be `(batch,
   /// sequence, features)`.
   RNNOutput forward(Tensor input, Tensor state = {});
+
+  /// Applies the `LSTM` module to a packed batch of variable length sequences
+  /// and input state, computing only the valid steps of every sequence.
+  PackedRNNOutput packed_forward(PackedSequence input, Tensor state = {});
 };
 
 /// A `ModuleHolder` subclass for `LSTMImpl`.
@@ -237,6 +324,10 @@ class GRUImpl : public detail::RNNImplBase<GRUImpl> {
   /// `batch_first` is true, in which case the layout should be `(batch,
   /// sequence, features)`.
   RNNOutput forward(Tensor input, Tensor state = {});
+
+  /// Applies the `GRU` module to a packed batch of variable length sequences
+  /// and input state, computing only the valid steps of every sequence.
+  PackedRNNOutput packed_forward(PackedSequence input, Tensor state = {});
 };
 
 /// A `ModuleHolder` subclass for `GRUImpl`.
@@ -4,12 +4,16 @@
 #include <torch/nn/cloneable.h>
 #include <torch/nn/module.h>
 #include <torch/nn/modules/any.h>
+#include <torch/nn/modules/functional.h>
 #include <torch/nn/pimpl.h>
 #include <torch/tensor.h>
 
 #include <c10/util/Exception.h>
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -325,5 +329,75 @@ class SequentialImpl : public Cloneable<SequentialImpl> {
 /// provides, or the documentation for `ModuleHolder` to learn about PyTorch's
 /// module storage semantics.
 TORCH_MODULE(Sequential);
+
+/// Runs a `Sequential` for inference on inputs of a fixed shape, without the
+/// per module overhead of `Sequential::forward()`.
+///
+/// The `Sequential` is run once on an example input when compiled, which
+/// records the shapes of all activations. Afterwards, `forward()` only checks
+/// that its input has the same shape, type and device as the example input:
+///
+/// - `Linear` modules write their outputs into two preallocated buffers, which
+///   they take turns at, instead of allocating every activation,
+/// - `Functional` modules with an in-place function (see
+///   `FunctionalImpl::inplace()`) apply it to these buffers,
+/// - `Dropout` and `FeatureDropout` modules are skipped,
+/// - all other modules are run through `AnyModule` as usual.
+///
+/// All of it runs on the data of the tensors, so nothing is recorded for
+/// autograd. The `Sequential` must be in evaluation mode.
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   torch::nn::Sequential mlp(
+///     torch::nn::Linear(784, 512),
+///     torch::nn::Functional(torch::relu)->inplace(torch::relu_),
+///     torch::nn::Linear(512, 10));
+///   mlp->eval();
+///   torch::nn::CompiledSequential compiled(mlp, torch::zeros({64, 784}));
+///   auto output = compiled.forward(batch);
+/// \endrst
+///
+/// \rst
+/// .. attention::
+///   The output of `forward()` may be one of the preallocated buffers, which
+///   the next call to `forward()` overwrites. The `Sequential` must be compiled
+///   again after it is changed, or moved to another device or dtype.
+/// \endrst
+class CompiledSequential {
+ public:
+  CompiledSequential(Sequential sequential, const Tensor& example_input);
+
+  /// Applies the compiled `Sequential` to `input`, which must have the same
+  /// shape, type and device as the example input.
+  Tensor forward(const Tensor& input);
+
+  /// The compiled `Sequential`.
+  const Sequential& sequential() const noexcept;
+
+ private:
+  struct Step {
+    enum class Kind { Linear, Inplace, Module };
+    Kind kind;
+    /// For `Linear`: the transposed weight and the bias, if any.
+    Tensor weight;
+    Tensor bias;
+    /// For `Linear`: the preallocated output, a view of one of the buffers.
+    Tensor output;
+    /// For `Inplace`.
+    FunctionalImpl::InplaceFunction inplace;
+    /// For `Module`: the module, and the shape of its output.
+    AnyModule module;
+    std::vector<int64_t> output_sizes;
+  };
+
+  Sequential sequential_;
+  std::vector<int64_t> input_sizes_;
+  const at::Type* input_type_;
+  Device input_device_;
+  std::vector<Step> steps_;
+  std::array<Tensor, 2> buffers_;
+};
 } // namespace nn
 } // namespace torch
@@ -6,18 +6,19 @@
 #include <torch/tensor.h>
 
 #include <torch/csrc/autograd/functions/comm.h>
+#include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/cuda/comm.h>
 #include <torch/csrc/utils/functional.h>
 
 #include <ATen/Device.h>
 #include <ATen/OptionsGuard.h>
-#include <ATen/Parallel.h>
 #include <ATen/core/TensorOptions.h>
 #include <c10/util/Exception.h>
 #include "c10/util/Optional.h"
 
 #include <cstddef>
 #include <exception>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -25,6 +26,43 @@
 namespace torch {
 namespace nn {
 namespace parallel {
+namespace detail {
+/// Runs `function(index)` for every `index` in `[0, count)`, on the calling
+/// thread and on a pool of worker threads that persists across calls, and
+/// returns once all calls have returned. `function` must not throw.
+void run_in_parallel(size_t count, const std::function<void(size_t)>& function);
+
+#ifdef USE_CUDA
+/// Returns replicas of `module` on the given CUDA devices. The replicas are
+/// cloned on the first call for a module and a list of devices, and cached.
+/// Later calls copy the current parameters and buffers of the module into the
+/// cached replicas with one coalesced broadcast, and clear their gradients.
+/// The replicas are cloned again if the parameters or buffers of the module
+/// changed in number, shape or type.
+std::vector<std::shared_ptr<Module>> cached_module_replicas(
+    const std::shared_ptr<Module>& module,
+    const std::vector<Device>& devices);
+
+template <typename ModuleType>
+std::vector<std::shared_ptr<ModuleType>> cached_replicas(
+    const std::shared_ptr<ModuleType>& module,
+    const std::vector<Device>& devices) {
+  return fmap(
+      cached_module_replicas(module, devices),
+      [](const std::shared_ptr<Module>& replica) {
+        return std::dynamic_pointer_cast<ModuleType>(replica);
+      });
+}
+
+template <typename ModuleType>
+std::vector<ModuleHolder<ModuleType>> cached_replicas(
+    const ModuleHolder<ModuleType>& module,
+    const std::vector<Device>& devices) {
+  auto ptrs = cached_replicas(module.ptr(), devices);
+  return std::vector<ModuleHolder<ModuleType>>(ptrs.begin(), ptrs.end());
+}
+#endif
+} // namespace detail
 
 /// Replicates a module on the given list of devices.
 /// A replica is created by calling `clone()` on the module. For this, the
@@ -55,9 +93,10 @@ std::vector<ModuleHolder<ModuleType>> replicate(
 }
 
 /// Applies the given inputs to the given modules in a parallel fashion.
-/// Conceptually, a thread is spawned for each `(module, input)` pair, in which
-/// `forward()` is called on the module with its corresponding input. The
-/// outputs of the individual calls are stored in a vector and returned.
+/// `forward()` is called on every module with its corresponding input, on the
+/// calling thread or on a pool of threads that persists across calls, with the
+/// grad mode of the calling thread. The outputs of the individual calls are
+/// stored in a vector and returned.
 ///
 /// The first exception caught by any thread is stashed and rethrown after all
 /// threads have completed their operation.
@@ -90,24 +129,22 @@ std::vector<Tensor> parallel_apply(
   // https://en.cppreference.com/w/cpp/error/exception_ptr
   std::exception_ptr exception;
 
-  at::parallel_for(
-      /*begin=*/0,
-      /*end=*/modules.size(),
-      /*grain_size=*/1,
-      [&modules, &inputs, &devices, &outputs, &mutex, &exception](
-          int64_t index, int64_t stop) {
-        for (; index < stop; ++index) {
-          try {
-            torch::OptionsGuard options_guard(
-                devices ? (*devices)[index] : inputs[index].device());
-            auto output = modules[index]->forward(inputs[index]);
-            std::lock_guard<std::mutex> lock(mutex);
-            outputs[index] = output;
-          } catch (...) {
-            std::lock_guard<std::mutex> lock(mutex);
-            if (!exception) {
-              exception = std::current_exception();
-            }
+  const bool grad_mode = autograd::GradMode::is_enabled();
+  detail::run_in_parallel(
+      modules.size(),
+      [&modules, &inputs, &devices, &outputs, &mutex, &exception, grad_mode](
+          size_t index) {
+        try {
+          autograd::AutoGradMode grad_mode_guard(grad_mode);
+          torch::OptionsGuard options_guard(
+              devices ? (*devices)[index] : inputs[index].device());
+          auto output = modules[index]->forward(inputs[index]);
+          std::lock_guard<std::mutex> lock(mutex);
+          outputs[index] = output;
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!exception) {
+            exception = std::current_exception();
           }
         }
       });
@@ -127,7 +164,10 @@ std::vector<Tensor> parallel_apply(
 ///
 /// In detail, this method performs the following four distinct steps:
 /// 1. *Scatter* the input to the given devices,
-/// 2. *Replicate* (deep clone) the model on each device,
+/// 2. *Replicate* the model on each device. The replicas are deep clones,
+/// which are cached across calls for the same module and devices, and whose
+/// parameters and buffers are refreshed with one coalesced broadcast per call
+/// (see `detail::cached_replicas()`),
 /// 3. *Evaluate* each module with its input on its device,
 /// 4. *Gather* the outputs of each replica into a single output tensor, located
 /// on the `output_device`.
@@ -160,7 +200,7 @@ Tensor data_parallel(
   autograd::Scatter scatter(*devices, /*chunk_sizes=*/c10::nullopt, dim);
   auto scattered_inputs = fmap<Tensor>(scatter.apply({std::move(input)}));
 
-  auto replicas = replicate(module, *devices);
+  auto replicas = detail::cached_replicas(module, *devices);
   auto outputs = parallel_apply(replicas, scattered_inputs, *devices);
   return autograd::Gather(*output_device, dim)
       .apply(fmap<autograd::Variable>(std::move(outputs)))
@@ -47,6 +47,10 @@ class Adagrad : public Optimizer {
  private:
   Adagrad() : options(0) {}
 
+  /// The sums of the flat buffers, after `flatten_parameters()`, of which
+  /// `sum_buffers` are views.
+  std::vector<Tensor> flat_sum_buffers_;
+
   template <typename Self, typename Archive>
   static void serialize(Self& self, Archive& archive) {
     TORCH_OPTIM_SERIALIZE(sum_buffers);
@@ -50,6 +50,12 @@ class Adam : public Optimizer {
  private:
   Adam() : options(0) {}
 
+  /// The state of the flat buffers, after `flatten_parameters()`, of which
+  /// the buffers above are views.
+  std::vector<Tensor> flat_exp_average_buffers_;
+  std::vector<Tensor> flat_exp_average_sq_buffers_;
+  std::vector<Tensor> flat_max_exp_average_sq_buffers_;
+
   template <typename Self, typename Archive>
   static void serialize(Self& self, Archive& archive) {
     TORCH_OPTIM_SERIALIZE(step_buffers);
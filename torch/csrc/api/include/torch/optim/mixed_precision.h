@@ -0,0 +1,192 @@
+#pragma once
+
+#include <torch/arg.h>
+#include <torch/nn/cursor.h>
+#include <torch/optim/optimizer.h>
+#include <torch/tensor.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace optim {
+
+/// Options to configure a `LossScaler`.
+struct LossScalerOptions {
+  /* implicit */ LossScalerOptions(double init_scale = 65536);
+
+  /// The scale of the first step.
+  TORCH_ARG(double, init_scale);
+
+  /// The factor by which the scale grows after `growth_interval` consecutive
+  /// steps without inf or NaN gradients.
+  TORCH_ARG(double, growth_factor) = 2;
+
+  /// The factor by which the scale shrinks after a step with inf or NaN
+  /// gradients.
+  TORCH_ARG(double, backoff_factor) = 0.5;
+  TORCH_ARG(int64_t, growth_interval) = 2000;
+
+  /// Whether the scale changes at all. Steps with inf or NaN gradients are
+  /// skipped either way.
+  TORCH_ARG(bool, dynamic) = true;
+};
+
+/// Scales the loss of a model trained in half precision, so that small
+/// gradients don't underflow in the backward pass, and scales the gradients
+/// back before the optimizer step.
+///
+/// With dynamic loss scaling, the scale is as large as possible without
+/// overflowing: it shrinks whenever the gradients contain inf or NaN, in which
+/// case the step must be skipped, and grows again after a number of steps
+/// without them.
+class LossScaler {
+ public:
+  explicit LossScaler(LossScalerOptions options = LossScalerOptions());
+
+  /// Returns the loss multiplied by the scale, in single precision.
+  Tensor scale(const Tensor& loss) const;
+
+  /// Divides the gradients by the scale in place, and returns whether they
+  /// are all finite. Gradients of the same type on the same device are
+  /// checked with a single fused kernel (`at::_multi_tensor_unscale_`), and
+  /// only a single flag per device is copied back to the CPU.
+  bool unscale(const std::vector<Tensor>& gradients) const;
+
+  /// Updates the scale after a step, given whether the gradients of the step
+  /// contained inf or NaN.
+  void update(bool found_non_finite);
+
+  /// The current scale.
+  double loss_scale() const noexcept;
+
+  /// The number of steps whose gradients contained inf or NaN.
+  int64_t skipped_steps() const noexcept;
+
+  const LossScalerOptions& options() const noexcept;
+
+ private:
+  LossScalerOptions options_;
+  double scale_;
+  int64_t steps_since_growth_{0};
+  int64_t skipped_steps_{0};
+};
+
+namespace detail {
+/// Single precision copies of the parameters of a model, which the optimizer
+/// of a `MixedPrecisionOptimizer` updates.
+class MasterParameters {
+ public:
+  explicit MasterParameters(std::vector<Tensor> model_parameters);
+  explicit MasterParameters(const torch::detail::CursorBase<Tensor>& cursor);
+
+  /// Copies the gradients of the model into the gradients of the master
+  /// parameters, and unscales them. Returns whether they are all finite.
+  /// Parameters without a gradient get a zero gradient.
+  bool copy_gradients(const LossScaler& scaler);
+
+  /// Copies the master parameters into the parameters of the model.
+  void copy_parameters();
+
+  /// Zeros out the gradients of the model.
+  void zero_grad();
+
+  const std::vector<Tensor>& master() const noexcept;
+  const std::vector<Tensor>& model() const noexcept;
+
+ private:
+  std::vector<Tensor> model_;
+  std::vector<Tensor> master_;
+};
+} // namespace detail
+
+/// Trains a model in half precision with an `Optimizer` that keeps single
+/// precision master copies of its parameters, and dynamic loss scaling.
+///
+/// The model computes in half precision, which is what tensor cores run at
+/// full throughput, while the optimizer accumulates the updates in single
+/// precision, where they don't vanish against the magnitude of the weights.
+/// The loss is scaled up before the backward pass; `step()` copies the
+/// gradients into the master parameters, scales them back, and skips the
+/// update if any of them overflowed:
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   model->to(torch::kHalf);
+///   MixedPrecisionOptimizer<Adam> optimizer(
+///       model->parameters(), AdamOptions(1e-3));
+///   for (auto& batch : *loader) {
+///     optimizer.zero_grad();
+///     auto output = model->forward(batch.data.to(torch::kHalf));
+///     auto loss = torch::nll_loss(output, batch.target);
+///     optimizer.backward(loss);
+///     optimizer.step();
+///   }
+/// \endrst
+///
+/// `optimizer()` is the wrapped optimizer over the master parameters, on which
+/// e.g. `flatten_parameters()` can be called.
+template <typename OptimizerClass>
+class MixedPrecisionOptimizer {
+ public:
+  template <typename ParameterContainer, typename OptimizerOptions>
+  MixedPrecisionOptimizer(
+      ParameterContainer&& parameters,
+      const OptimizerOptions& options,
+      LossScalerOptions scaler_options = LossScalerOptions())
+      : parameters_(std::forward<ParameterContainer>(parameters)),
+        optimizer_(parameters_.master(), options),
+        scaler_(std::move(scaler_options)) {}
+
+  /// Zeros out the gradients of the model.
+  void zero_grad() {
+    parameters_.zero_grad();
+  }
+
+  /// Computes the gradients of the scaled `loss`.
+  void backward(const Tensor& loss) {
+    scaler_.scale(loss).backward();
+  }
+
+  /// Updates the parameters of the model with the gradients of the last
+  /// `backward()`, unless they contain inf or NaN. Returns whether the
+  /// parameters were updated.
+  bool step() {
+    const bool finite = parameters_.copy_gradients(scaler_);
+    scaler_.update(!finite);
+    if (!finite) {
+      return false;
+    }
+    optimizer_.step();
+    parameters_.copy_parameters();
+    return true;
+  }
+
+  /// The parameters of the model.
+  const std::vector<Tensor>& parameters() const noexcept {
+    return parameters_.model();
+  }
+
+  /// The single precision copies of the parameters of the model.
+  const std::vector<Tensor>& master_parameters() const noexcept {
+    return parameters_.master();
+  }
+
+  OptimizerClass& optimizer() noexcept {
+    return optimizer_;
+  }
+
+  LossScaler& loss_scaler() noexcept {
+    return scaler_;
+  }
+
+ private:
+  detail::MasterParameters parameters_;
+  OptimizerClass optimizer_;
+  LossScaler scaler_;
+};
+} // namespace optim
+} // namespace torch
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -44,6 +45,7 @@ class OptimizerBase {
   virtual ~OptimizerBase() = default;
 
   /// Adds the given vector of parameters to the optimizer's parameter list.
+  /// Undoes `flatten_parameters()`.
   void add_parameters(const std::vector<Tensor>& parameters);
 
   /// Adds the `ParameterCursor`'s parameters to the optimizer's parameter list.
@@ -52,6 +54,29 @@ class OptimizerBase {
   /// Zeros out the gradients of all parameters.
   virtual void zero_grad();
 
+  /// Moves the parameters and their gradients into contiguous buffers, one
+  /// per type and device, of which they become views. `step()` then updates
+  /// every buffer at once, with a single fused kernel for `Adam` and
+  /// `Adagrad`, instead of issuing several operations per parameter. The
+  /// gradients of all parameters can be zeroed or allreduced at once through
+  /// `flat_gradients()`. The optimizer state is flattened the same way.
+  ///
+  /// Parameters without a gradient are updated as if their gradient was zero,
+  /// and the parameters in a buffer share their step count. Parameters and
+  /// gradients that are replaced, e.g. by loading a module or by a backward
+  /// pass that creates a graph, are copied back into the buffers by the next
+  /// `step()` or `zero_grad()`. All parameters and gradients must be dense.
+  void flatten_parameters();
+
+  /// Whether `flatten_parameters()` was called since parameters were added.
+  bool is_flat() const noexcept;
+
+  /// The buffers holding the parameters after `flatten_parameters()`.
+  const std::vector<Tensor>& flat_parameters() const noexcept;
+
+  /// The buffers holding the gradients after `flatten_parameters()`.
+  const std::vector<Tensor>& flat_gradients() const noexcept;
+
   /// Provides a const reference to the parameters this optimizer holds.
   const std::vector<Tensor>& parameters() const noexcept;
 
@@ -84,10 +109,53 @@ class OptimizerBase {
   /// Additionally, zeros out the buffers when this is called on the index
   Tensor& buffer_at(std::vector<Tensor>& buffers, size_t index);
 
+  /// Makes the parameters of the flat buffer `group`, and their gradients,
+  /// views of the buffers again, copying them back into the buffers if they
+  /// were replaced.
+  void sync_flat_group(size_t group);
+
+  /// Accesses the flat state buffer of `group` in `flat_buffers`, of which
+  /// the buffers of its parameters in `buffers` are views. Buffers that were
+  /// replaced, e.g. by `load()`, are copied back into it, and buffers that
+  /// don't exist yet are zero.
+  Tensor& flat_buffer_at(
+      std::vector<Tensor>& flat_buffers,
+      std::vector<Tensor>& buffers,
+      size_t group);
+
+  /// Increments the step count of the parameters of the flat buffer `group`,
+  /// which is the one of its first parameter, and returns it.
+  int64_t flat_step_at(std::vector<int64_t>& steps, size_t group);
+
   /// The parameters this optimizer optimizes.
   std::vector<Tensor> parameters_;
+
+  /// The flat buffers of the parameters and their gradients, one per type and
+  /// device, and the indices of the parameters in every buffer. Empty unless
+  /// `flatten_parameters()` was called.
+  std::vector<Tensor> flat_parameters_;
+  std::vector<Tensor> flat_gradients_;
+  std::vector<std::vector<size_t>> flat_indices_;
+  /// The offset and the number of elements of every parameter in its buffer.
+  std::vector<int64_t> flat_offsets_;
+  std::vector<int64_t> flat_numels_;
+
+ private:
+  /// Returns the view of `flat` that holds the parameter at `index`, or its
+  /// state in a state buffer.
+  Tensor flat_slot(const Tensor& flat, size_t index) const;
+
+  /// Whether `tensor` is the view of `flat` that belongs to the parameter at
+  /// `index`.
+  bool is_flat_slot(const Tensor& tensor, const Tensor& flat, size_t index)
+      const;
 };
 
+/// Whether the fused optimizer steps (`at::_fused_adam_` and friends) can
+/// update these tensors: they have to be dense, contiguous CUDA tensors, or
+/// float or double CPU tensors, of the same type on the same device.
+bool can_fuse(const std::vector<Tensor>& tensors);
+
 /// Serializes an `OptimizerBase` into an `OutputArchive`.
 serialize::OutputArchive& operator<<(
     serialize::OutputArchive& archive,
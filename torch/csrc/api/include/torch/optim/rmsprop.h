@@ -54,6 +54,12 @@ class RMSprop : public Optimizer {
  private:
   RMSprop() : options(0) {}
 
+  /// The state of the flat buffers, after `flatten_parameters()`, of which
+  /// the buffers above are views.
+  std::vector<Tensor> flat_square_average_buffers_;
+  std::vector<Tensor> flat_momentum_buffers_;
+  std::vector<Tensor> flat_grad_average_buffers_;
+
   template <typename Self, typename Archive>
   static void serialize(Self& self, Archive& archive) {
     TORCH_OPTIM_SERIALIZE(square_average_buffers);
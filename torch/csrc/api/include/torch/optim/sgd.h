@@ -49,6 +49,10 @@ class SGD : public Optimizer {
 
   /// Counts how often `step()` is called, for dampening.
   size_t iteration_{0};
+
+  /// The momentum of the flat buffers, after `flatten_parameters()`, of which
+  /// `momentum_buffers` are views.
+  std::vector<Tensor> flat_momentum_buffers_;
 };
 } // namespace optim
 } // namespace torch
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <torch/serialize/archive.h>
+#include <torch/serialize/checkpointer.h>
 #include <torch/serialize/tensor.h>
 
+#include <future>
+#include <memory>
+#include <string>
 #include <utility>
 
 namespace torch {
@@ -40,6 +44,38 @@ void save(const Value& value, SaveToArgs&&... args) {
   archive.save_to(std::forward<SaveToArgs>(args)...);
 }
 
+/// Serializes the given `value` into the file at `filename` in a background
+/// thread, and returns a future that becomes ready once the file is written,
+/// or holds the exception that writing it threw.
+///
+/// The tensors of `value` are snapshotted before this function returns (see
+/// `serialize::OutputArchive::snapshot`), so `value` can be modified, e.g. by
+/// further training steps, while the file is written. The snapshot takes as
+/// much CPU memory as the tensors of `value`. `serialize::Checkpointer` writes
+/// a series of checkpoints with bounded memory.
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   std::future<void> checkpoint;
+///   for (size_t epoch = 0; epoch < 10; ++epoch) {
+///     train(model, optimizer);
+///     if (checkpoint.valid()) {
+///       checkpoint.get();
+///     }
+///     checkpoint = torch::save_async(model, "checkpoint.pt");
+///   }
+/// \endrst
+template <typename Value>
+std::future<void> save_async(const Value& value, std::string filename) {
+  auto archive = std::make_shared<serialize::OutputArchive>();
+  *archive << value;
+  archive->snapshot();
+  return std::async(std::launch::async, [archive, filename] {
+    archive->save_to(filename);
+  });
+}
+
 /// Deserializes the given `value`.
 /// There must be an overload of `operator>>` between `serialize::InputArchive`
 /// and `Value` for this method to be well-formed. Currently, such an overload
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <torch/arg.h>
+#include <torch/serialize/output-archive.h>
+#include <torch/serialize/tensor.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace torch {
+namespace serialize {
+
+/// Options to configure a `Checkpointer`.
+struct CheckpointerOptions {
+  /* implicit */ CheckpointerOptions(size_t max_pending = 1)
+      : max_pending_(max_pending) {}
+
+  /// The number of snapshots that can wait to be written, or be written, at
+  /// the same time. `save()` blocks while this many are pending, which bounds
+  /// the memory taken by snapshots to this many copies of the saved values.
+  TORCH_ARG(size_t, max_pending);
+};
+
+/// Writes checkpoints of modules and optimizers in a background thread, while
+/// training continues.
+///
+/// `save()` snapshots the tensors of a value into CPU memory (see
+/// `OutputArchive::snapshot`), which for CUDA tensors takes a single
+/// synchronization after asynchronous copies into pinned memory, and returns.
+/// Snapshots are serialized and written by a single background thread, in the
+/// order they were saved. Every file is written under a temporary name and
+/// then renamed, so that a crash never leaves a partially written checkpoint
+/// behind.
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   torch::serialize::Checkpointer checkpointer;
+///   for (size_t epoch = 0; epoch < 10; ++epoch) {
+///     train(model, optimizer);
+///     checkpointer.save(model, "model.pt");
+///     checkpointer.save(optimizer, "optimizer.pt");
+///   }
+///   checkpointer.wait();
+/// \endrst
+class Checkpointer {
+ public:
+  explicit Checkpointer(CheckpointerOptions options = CheckpointerOptions());
+
+  Checkpointer(const Checkpointer&) = delete;
+  Checkpointer& operator=(const Checkpointer&) = delete;
+
+  /// Waits for all pending checkpoints to be written.
+  ~Checkpointer();
+
+  /// Snapshots `value` and writes it to the file at `filename` in the
+  /// background. Returns a future that becomes ready once the file is
+  /// written, or holds the exception that writing it threw.
+  template <typename Value>
+  std::shared_future<void> save(const Value& value, std::string filename) {
+    OutputArchive archive;
+    archive << value;
+    return save(std::move(archive), std::move(filename));
+  }
+
+  /// Snapshots `archive` and writes it to the file at `filename` in the
+  /// background.
+  std::shared_future<void> save(OutputArchive archive, std::string filename);
+
+  /// Waits for all pending checkpoints to be written. Does not throw, the
+  /// errors of checkpoints are reported through their futures.
+  void wait();
+
+  /// The number of checkpoints that were saved but not written yet.
+  size_t pending() const;
+
+  const CheckpointerOptions& options() const noexcept;
+
+ private:
+  struct Checkpoint {
+    OutputArchive archive;
+    std::string filename;
+    std::promise<void> written;
+  };
+
+  void writer_thread();
+
+  CheckpointerOptions options_;
+
+  mutable std::mutex mutex_;
+  /// Signaled when a checkpoint is saved or written, or on destruction.
+  std::condition_variable cv_;
+  /// Checkpoints waiting to be written, in order.
+  std::deque<std::unique_ptr<Checkpoint>> queue_;
+  /// The number of checkpoints in `queue_` and being written.
+  size_t pending_{0};
+  bool stop_{false};
+  std::thread writer_;
+};
+} // namespace serialize
+} // namespace torch
@@ -42,6 +42,8 @@ class InputArchive final {
   /// Reads a `tensor` associated with a given `key`.
   /// If the tensor is expected to be a buffer (not differentiable), `is_buffer`
   /// must be `true`.
+  /// A defined `tensor` of the same type as the serialized one is set to its
+  /// storage, without a copy; one of another type or device is copied into.
   void read(const std::string& key, Tensor& tensor, bool is_buffer = false);
 
   /// Reads an `InputArchive` associated with a given `key`.
@@ -50,7 +52,9 @@ class InputArchive final {
   void read(const std::string& key, InputArchive& archive);
 
   /// Loads the `InputArchive` from a serialized representation stored in the
-  /// file at `filename`.
+  /// file at `filename`. The file is memory mapped rather than read (see
+  /// `torch::jit::load`), so loaded CPU tensors use the mapping as their
+  /// storage, and the file must not be overwritten while they are alive.
   void load_from(const std::string& filename);
 
   /// Loads the `InputArchive` from a serialized representation stored in the
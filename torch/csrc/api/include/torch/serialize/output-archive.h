@@ -44,8 +44,17 @@ class OutputArchive final {
   /// `OutputArchive`.
   void write(const std::string& key, OutputArchive& nested_archive);
 
+  /// Replaces the tensors written to this `OutputArchive`, and to its nested
+  /// archives, with copies in CPU memory, so that it can be saved while the
+  /// original tensors keep changing, e.g. by a background thread while
+  /// training continues (see `torch::save_async`). Tensors that view the same
+  /// storage keep sharing the copy of the storage. CUDA storages are copied
+  /// into pinned memory asynchronously, and waited for once at the end.
+  void snapshot();
+
   /// Saves the `OutputArchive` into a serialized representation in a file at
-  /// `filename`.
+  /// `filename`. The data of CPU tensors is written straight from their
+  /// storages, once per storage.
   void save_to(const std::string& filename);
 
   /// Saves the `OutputArchive` into a serialized representation into the given
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <torch/csrc/autograd/functions/checkpoint.h>
 #include <torch/csrc/autograd/grad_mode.h>
 
 #include <cstdint>
@@ -13,6 +14,10 @@ struct NoGradGuard : public AutoGradMode {
   NoGradGuard() : AutoGradMode(/*enabled=*/false) {}
 };
 
+/// Runs `fn(inputs)` without keeping its intermediate results and recomputes
+/// them during the backward pass. See `torch::autograd::checkpoint`.
+using autograd::checkpoint;
+
 /// Sets the global random seed for all newly created CPU and CUDA tensors.
 void manual_seed(uint64_t seed);
 } // namespace torch
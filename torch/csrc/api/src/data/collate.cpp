@@ -0,0 +1,58 @@
+#include <torch/data/collate.h>
+
+#include <torch/csrc/autograd/variable.h>
+#include <torch/data/example.h>
+#include <torch/tensor.h>
+#include <torch/utils.h>
+
+#include <ATen/ATen.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace torch {
+namespace data {
+Tensor stack(at::ArrayRef<Tensor> tensors, bool pin_memory) {
+  AT_CHECK(!tensors.empty(), "Cannot stack an empty list of tensors");
+  const auto& first = autograd::Variable(tensors.front()).data();
+
+  std::vector<int64_t> sizes = {static_cast<int64_t>(tensors.size())};
+  sizes.insert(sizes.end(), first.sizes().begin(), first.sizes().end());
+
+  at::Tensor batch;
+  if (pin_memory && first.type().backend() == at::Backend::CPU) {
+    batch = at::getNonVariableType(at::Backend::CPU, first.scalar_type())
+                .tensorWithAllocator(
+                    sizes, at::detail::getCUDAHooks().getPinnedMemoryAllocator());
+  } else {
+    batch = at::empty(sizes, first.options());
+  }
+
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const auto& tensor = autograd::Variable(tensors[i]).data();
+    AT_CHECK(
+        tensor.type() == first.type() && tensor.sizes().equals(first.sizes()),
+        "Cannot stack tensors of different sizes or types: ",
+        first.type().toString(),
+        first.sizes(),
+        " and ",
+        tensor.type().toString(),
+        tensor.sizes());
+    batch[i].copy_(tensor);
+  }
+  return autograd::make_variable(batch);
+}
+
+Example<> Stack::operator()(std::vector<Example<>> examples) const {
+  std::vector<Tensor> data, targets;
+  data.reserve(examples.size());
+  targets.reserve(examples.size());
+  for (auto& example : examples) {
+    data.push_back(std::move(example.data));
+    targets.push_back(std::move(example.target));
+  }
+  return {stack(data, pin_memory), stack(targets, pin_memory)};
+}
+} // namespace data
+} // namespace torch
@@ -0,0 +1,40 @@
+#include <torch/data/samplers/random.h>
+#include <torch/tensor.h>
+
+#include <c10/util/Optional.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace samplers {
+RandomSampler::RandomSampler(int64_t size) : size_(size) {
+  reset();
+}
+
+void RandomSampler::reset() {
+  indices_ = torch::randperm(size_, torch::kInt64);
+  index_ = 0;
+}
+
+c10::optional<std::vector<size_t>> RandomSampler::next(size_t batch_size) {
+  const auto remaining = size_ - index_;
+  if (remaining == 0) {
+    return c10::nullopt;
+  }
+  std::vector<size_t> indices(
+      std::min(static_cast<int64_t>(batch_size), remaining));
+  const auto data = indices_.data<int64_t>() + index_;
+  std::copy(data, data + indices.size(), indices.begin());
+  index_ += indices.size();
+  return indices;
+}
+
+size_t RandomSampler::index() const noexcept {
+  return index_;
+}
+} // namespace samplers
+} // namespace data
+} // namespace torch
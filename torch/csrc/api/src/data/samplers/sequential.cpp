@@ -0,0 +1,35 @@
+#include <torch/data/samplers/sequential.h>
+
+#include <c10/util/Optional.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace samplers {
+SequentialSampler::SequentialSampler(size_t size) : size_(size) {}
+
+void SequentialSampler::reset() {
+  index_ = 0;
+}
+
+c10::optional<std::vector<size_t>> SequentialSampler::next(size_t batch_size) {
+  const auto remaining = size_ - index_;
+  if (remaining == 0) {
+    return c10::nullopt;
+  }
+  std::vector<size_t> indices(std::min(batch_size, remaining));
+  for (auto& index : indices) {
+    index = index_++;
+  }
+  return indices;
+}
+
+size_t SequentialSampler::index() const noexcept {
+  return index_;
+}
+} // namespace samplers
+} // namespace data
+} // namespace torch
@@ -1,13 +1,50 @@
 #include <torch/jit.h>
 
+#include <torch/nn/module.h>
+#include <torch/tensor.h>
+
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
 #include <torch/csrc/jit/script/compiler.h>
+#include <torch/csrc/jit/script/module.h>
 #include <torch/csrc/jit/stack.h>
+#include <torch/csrc/jit/tracer.h>
+
+#include <c10/util/Exception.h>
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace torch {
 namespace jit {
+namespace {
+/// Registers `tensor` in the submodule of `module` given by the prefix of
+/// the hierarchical `name` (e.g. "0.weight"), creating the submodules on the
+/// way, and returns the slot of the registered tensor.
+at::Tensor* register_tensor(
+    script::Module& module,
+    const std::string& name,
+    const Tensor& tensor,
+    bool is_buffer) {
+  const auto dot = name.find('.');
+  if (dot == std::string::npos) {
+    module.register_parameter(name, tensor, is_buffer);
+    return module.parameter_slot(name);
+  }
+  const auto child_name = name.substr(0, dot);
+  if (module.find_module(child_name) == nullptr) {
+    module.register_module(child_name, std::make_shared<script::Module>());
+  }
+  return register_tensor(
+      *module.get_module(child_name),
+      name.substr(dot + 1),
+      tensor,
+      is_buffer);
+}
+} // namespace
 
 std::shared_ptr<script::Module> compile(const std::string& source) {
   auto module = std::make_shared<script::Module>();
@@ -15,5 +52,49 @@ std::shared_ptr<script::Module> compile(const std::string& source) {
   return module;
 }
 
+std::shared_ptr<script::Module> trace(
+    nn::Module& module,
+    std::vector<Tensor> example_inputs,
+    const std::function<IValue(const std::vector<Tensor>&)>& function) {
+  auto script_module = std::make_shared<script::Module>();
+  // The slots hold the same variables as `module`, which makes the traced
+  // module share them.
+  std::vector<at::Tensor*> member_inputs;
+  for (auto& parameter : module.parameters()) {
+    member_inputs.push_back(register_tensor(
+        *script_module, parameter.key, parameter.value, /*is_buffer=*/false));
+  }
+  for (auto& buffer : module.buffers()) {
+    member_inputs.push_back(register_tensor(
+        *script_module, buffer.key, buffer.value, /*is_buffer=*/true));
+  }
+
+  const auto input_count = example_inputs.size();
+  Stack trace_inputs(example_inputs.begin(), example_inputs.end());
+  for (auto* member : member_inputs) {
+    trace_inputs.emplace_back(*member);
+  }
+
+  auto state = tracer::enter(std::move(trace_inputs));
+  std::shared_ptr<Graph> graph;
+  try {
+    // The tracer maps the values it returns to the inputs of the graph.
+    // Parameters are used through `module`, which holds the same variables.
+    std::vector<Tensor> inputs;
+    inputs.reserve(input_count);
+    for (size_t i = 0; i < input_count; ++i) {
+      inputs.push_back(state.second[i].toTensor());
+    }
+    auto output = function(inputs);
+    tracer::exit({std::move(output)});
+    graph = state.first->graph;
+  } catch (...) {
+    tracer::abandon();
+    throw;
+  }
+  EliminateDeadCode(graph);
+  script_module->create_method("forward", graph, std::move(member_inputs));
+  return script_module;
+}
 } // namespace jit
 } // namespace torch
@@ -19,5 +19,15 @@ Tensor FunctionalImpl::forward(Tensor input) {
 Tensor FunctionalImpl::operator()(Tensor input) {
   return forward(std::move(input));
 }
+
+FunctionalImpl& FunctionalImpl::inplace(InplaceFunction function) {
+  inplace_function_ = std::move(function);
+  return *this;
+}
+
+const FunctionalImpl::InplaceFunction& FunctionalImpl::inplace_function() const
+    noexcept {
+  return inplace_function_;
+}
 } // namespace nn
 } // namespace torch
@@ -20,6 +20,31 @@
 
 namespace torch {
 namespace nn {
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ PackedSequence ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+PackedSequence pack_padded_sequence(
+    Tensor input,
+    Tensor lengths,
+    bool batch_first) {
+  Tensor data, batch_sizes;
+  std::tie(data, batch_sizes) =
+      torch::_pack_padded_sequence(input, lengths, batch_first);
+  return {data, batch_sizes};
+}
+
+std::tuple<Tensor, Tensor> pad_packed_sequence(
+    PackedSequence sequence,
+    bool batch_first,
+    double padding_value,
+    int64_t total_length) {
+  return torch::_pad_packed_sequence(
+      sequence.data,
+      sequence.batch_sizes,
+      batch_first,
+      padding_value,
+      total_length);
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ RNNOptionsBase ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 namespace detail {
@@ -94,8 +119,23 @@ void RNNImplBase<Derived>::to(torch::Dtype dtype, bool non_blocking) {
 
 template <typename Derived>
 void RNNImplBase<Derived>::to(torch::Device device, bool non_blocking) {
-  nn::Module::to(device, non_blocking);
-  flatten_parameters();
+  if (!parameters_are_flattened()) {
+    nn::Module::to(device, non_blocking);
+    flatten_parameters();
+    return;
+  }
+  // Every parameter keeps its offset into the buffer, which is where cuDNN
+  // expects it.
+  const auto moved = flat_weights_buffer_.to(device, non_blocking);
+  for (auto& parameter : flat_weights_) {
+    const auto offset =
+        parameter.storage_offset() - flat_weights_buffer_.storage_offset();
+    parameter.set_data(moved.as_strided(
+        parameter.sizes(),
+        parameter.strides(),
+        moved.storage_offset() + offset));
+  }
+  flat_weights_buffer_ = moved;
 }
 
 template <typename Derived>
@@ -103,12 +143,15 @@ void RNNImplBase<Derived>::flatten_parameters() {
   // Cache the flattened weight and bias vector.
   flat_weights_ = flat_weights();
 
+  if (!parameters_are_flattened()) {
+    flat_weights_buffer_ = Tensor();
+  }
   if (!cudnn_mode_ || !torch::cudnn_is_acceptable(w_ih.at(0))) {
     return;
   }
 
   NoGradGuard no_grad;
-  torch::_cudnn_rnn_flatten_weight(
+  const auto buffer = torch::_cudnn_rnn_flatten_weight(
       flat_weights_,
       /*weight_stride0=*/options.with_bias_ ? 4 : 2,
       options.input_size_,
@@ -117,6 +160,7 @@ void RNNImplBase<Derived>::flatten_parameters() {
       options.layers_,
       /*batch_first=*/options.batch_first_,
       /*bidirectional=*/options.bidirectional_);
+  flat_weights_buffer_ = autograd::Variable(buffer).data();
 }
 
 template <typename Derived>
@@ -144,6 +188,32 @@ RNNOutput RNNImplBase<Derived>::generic_forward(
   return {output, new_state};
 }
 
+template <typename Derived>
+PackedRNNOutput RNNImplBase<Derived>::generic_packed_forward(
+    std::function<PackedRNNFunctionSignature> function,
+    PackedSequence input,
+    Tensor state) {
+  if (!state.defined()) {
+    // #layers, batch size, state size
+    const auto batch_size = input.batch_sizes[0].item<int64_t>();
+    state = torch::zeros(
+        {options.layers_, batch_size, options.hidden_size_},
+        input.data.options());
+  }
+  Tensor output, new_state;
+  std::tie(output, new_state) = function(
+      input.data,
+      input.batch_sizes,
+      std::move(state),
+      flat_weights_,
+      options.with_bias_,
+      options.layers_,
+      options.dropout_,
+      this->is_training(),
+      options.bidirectional_);
+  return {{output, input.batch_sizes}, new_state};
+}
+
 template <typename Derived>
 std::vector<Tensor> RNNImplBase<Derived>::flat_weights() const {
   // Organize all weights in a flat vector in the order
@@ -175,6 +245,20 @@ bool RNNImplBase<Derived>::any_parameters_alias() const {
   return unique_data_ptrs.size() != params.size();
 }
 
+template <typename Derived>
+bool RNNImplBase<Derived>::parameters_are_flattened() const {
+  if (!flat_weights_buffer_.defined()) {
+    return false;
+  }
+  const auto* storage = flat_weights_buffer_.storage().unsafeGetStorageImpl();
+  for (const auto& parameter : flat_weights_) {
+    if (parameter.storage().unsafeGetStorageImpl() != storage) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template class RNNImplBase<LSTMImpl>;
 template class RNNImplBase<GRUImpl>;
 template class RNNImplBase<RNNImpl>;
@@ -217,6 +301,23 @@ RNNOutput RNNImpl::forward(Tensor input, Tensor state) {
   }
 }
 
+PackedRNNOutput RNNImpl::packed_forward(PackedSequence input, Tensor state) {
+  switch (options.activation_) {
+    case RNNActivation::ReLU:
+      return generic_packed_forward(
+          static_cast<PackedRNNFunctionSignature*>(&torch::rnn_relu),
+          std::move(input),
+          std::move(state));
+    case RNNActivation::Tanh:
+      return generic_packed_forward(
+          static_cast<PackedRNNFunctionSignature*>(&torch::rnn_tanh),
+          std::move(input),
+          std::move(state));
+    default:
+      AT_ERROR("Unhandled RNN activation function!");
+  }
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ LSTM ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 LSTMImpl::LSTMImpl(LSTMOptions options)
@@ -253,6 +354,29 @@ RNNOutput LSTMImpl::forward(Tensor input, Tensor state) {
   return {output, torch::stack({hidden_state, cell_state})};
 }
 
+PackedRNNOutput LSTMImpl::packed_forward(PackedSequence input, Tensor state) {
+  if (!state.defined()) {
+    // 2 for hidden state and cell state, then #layers, batch size, state size
+    const auto batch_size = input.batch_sizes[0].item<int64_t>();
+    state = torch::zeros(
+        {2, options.layers_, batch_size, options.hidden_size_},
+        input.data.options());
+  }
+  Tensor output, hidden_state, cell_state;
+  std::tie(output, hidden_state, cell_state) = torch::lstm(
+      input.data,
+      input.batch_sizes,
+      {state[0], state[1]},
+      flat_weights_,
+      options.with_bias_,
+      options.layers_,
+      options.dropout_,
+      this->is_training(),
+      options.bidirectional_);
+  return {{output, input.batch_sizes},
+          torch::stack({hidden_state, cell_state})};
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ GRU ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 GRUImpl::GRUImpl(GRUOptions options)
@@ -265,5 +389,12 @@ RNNOutput GRUImpl::forward(Tensor input, Tensor state) {
   return generic_forward(
       static_cast<RNNFunctionSignature*>(&torch::gru), input, state);
 }
+
+PackedRNNOutput GRUImpl::packed_forward(PackedSequence input, Tensor state) {
+  return generic_packed_forward(
+      static_cast<PackedRNNFunctionSignature*>(&torch::gru),
+      std::move(input),
+      std::move(state));
+}
 } // namespace nn
 } // namespace torch
@@ -0,0 +1,167 @@
+#include <torch/nn/modules/sequential.h>
+
+#include <torch/nn/modules/any.h>
+#include <torch/nn/modules/dropout.h>
+#include <torch/nn/modules/functional.h>
+#include <torch/nn/modules/linear.h>
+#include <torch/tensor.h>
+#include <torch/utils.h>
+
+#include <ATen/ATen.h>
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace nn {
+namespace {
+Tensor data_of(const Tensor& tensor) {
+  return tensor.is_variable() ? autograd::Variable(tensor).data() : tensor;
+}
+
+bool is_dropout(Module& module) {
+  return module.as<DropoutImpl>() || module.as<FeatureDropoutImpl>();
+}
+
+/// Runs a module on the data of `input`, and returns the data of its output.
+Tensor forward_data(AnyModule& module, const Tensor& input) {
+  // The argument must have the static type `Tensor` for `AnyModule`.
+  Tensor variable = autograd::make_variable(input);
+  return data_of(module.any_forward(std::move(variable)).get<Tensor>());
+}
+} // namespace
+
+CompiledSequential::CompiledSequential(
+    Sequential sequential,
+    const Tensor& example_input)
+    : sequential_(std::move(sequential)),
+      input_sizes_(example_input.sizes().vec()),
+      input_type_(&data_of(example_input).type()),
+      input_device_(example_input.device()) {
+  AT_CHECK(!sequential_->is_empty(), "Cannot compile an empty Sequential");
+  AT_CHECK(
+      !sequential_->is_training(),
+      "Only a Sequential in evaluation mode can be compiled, call eval()");
+  NoGradGuard no_grad;
+
+  // Runs the modules on the example input, to find the shapes of the
+  // activations, and which buffer every `Linear` writes to.
+  struct Output {
+    size_t buffer;
+    int64_t numel;
+    std::vector<int64_t> sizes;
+  };
+  std::vector<Output> outputs;
+  std::array<int64_t, 2> buffer_numels = {{0, 0}};
+  const auto input = data_of(example_input);
+  auto x = input;
+  // Whether `x` is one of the buffers, which in-place functions may modify.
+  bool owned = false;
+  size_t linear_count = 0;
+  for (const auto& any_module : *sequential_) {
+    auto& module = *any_module.ptr();
+    Step step;
+    if (auto* linear = module.as<LinearImpl>()) {
+      if (x.dim() == 2 && &x.type() == input_type_) {
+        step.kind = Step::Kind::Linear;
+        step.weight = data_of(linear->weight).t();
+        if (linear->bias.defined()) {
+          step.bias = data_of(linear->bias);
+        }
+        x = step.bias.defined() ? at::addmm(step.bias, x, step.weight)
+                                : at::mm(x, step.weight);
+        const auto buffer = linear_count++ % 2;
+        buffer_numels[buffer] = std::max(buffer_numels[buffer], x.numel());
+        outputs.push_back({buffer, x.numel(), x.sizes().vec()});
+        steps_.push_back(std::move(step));
+        owned = true;
+        continue;
+      }
+    } else if (auto* functional = module.as<FunctionalImpl>()) {
+      if (owned && functional->inplace_function()) {
+        step.kind = Step::Kind::Inplace;
+        step.inplace = functional->inplace_function();
+        step.inplace(x);
+        steps_.push_back(std::move(step));
+        continue;
+      }
+    } else if (is_dropout(module)) {
+      continue;
+    }
+    step.kind = Step::Kind::Module;
+    step.module = any_module;
+    x = forward_data(step.module, x);
+    step.output_sizes = x.sizes().vec();
+    steps_.push_back(std::move(step));
+    owned = false;
+  }
+
+  // Linear outputs have the type of the input, so both buffers do too.
+  for (size_t buffer = 0; buffer < buffers_.size(); ++buffer) {
+    if (buffer_numels[buffer] > 0) {
+      buffers_[buffer] = at::empty({buffer_numels[buffer]}, input.options());
+    }
+  }
+  auto output = outputs.begin();
+  for (auto& step : steps_) {
+    if (step.kind == Step::Kind::Linear) {
+      step.output = buffers_[output->buffer]
+                        .narrow(0, 0, output->numel)
+                        .view(output->sizes);
+      ++output;
+    }
+  }
+}
+
+Tensor CompiledSequential::forward(const Tensor& input) {
+  auto x = data_of(input);
+  AT_CHECK(
+      x.sizes() == input_sizes_ && &x.type() == input_type_ &&
+          x.device() == input_device_,
+      "The Sequential was compiled for inputs of shape ",
+      at::IntList(input_sizes_),
+      " and type ",
+      input_type_->toString(),
+      ", but got an input of shape ",
+      x.sizes(),
+      " and type ",
+      x.type().toString());
+  NoGradGuard no_grad;
+  for (auto& step : steps_) {
+    switch (step.kind) {
+      case Step::Kind::Linear:
+        if (step.bias.defined()) {
+          at::addmm_out(step.output, step.bias, x, step.weight);
+        } else {
+          at::mm_out(step.output, x, step.weight);
+        }
+        x = step.output;
+        break;
+      case Step::Kind::Inplace:
+        step.inplace(x);
+        break;
+      case Step::Kind::Module:
+        x = forward_data(step.module, x);
+        AT_CHECK(
+            x.sizes() == step.output_sizes,
+            "The output of a module changed its shape from ",
+            at::IntList(step.output_sizes),
+            " to ",
+            x.sizes(),
+            " since the Sequential was compiled");
+        break;
+    }
+  }
+  return autograd::make_variable(x, /*requires_grad=*/false);
+}
+
+const Sequential& CompiledSequential::sequential() const noexcept {
+  return sequential_;
+}
+} // namespace nn
+} // namespace torch
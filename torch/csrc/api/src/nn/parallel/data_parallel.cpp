@@ -0,0 +1,233 @@
+#include <torch/nn/parallel/data_parallel.h>
+
+#include <torch/nn/module.h>
+#include <torch/tensor.h>
+#include <torch/utils.h>
+
+#include <torch/csrc/autograd/variable.h>
+#include <torch/csrc/utils/functional.h>
+
+#include <ATen/Device.h>
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace torch {
+namespace nn {
+namespace parallel {
+namespace detail {
+namespace {
+/// The calls of one `run_in_parallel()`. Every thread that takes part claims
+/// indices until none is left, so the calling thread never waits for a call
+/// that no thread has started.
+struct Batch {
+  Batch(size_t count, const std::function<void(size_t)>& function)
+      : count(count), function(function) {}
+
+  /// Runs the calls that are left to claim.
+  void run() {
+    size_t index;
+    while ((index = next++) < count) {
+      function(index);
+      std::lock_guard<std::mutex> lock(mutex);
+      if (++done == count) {
+        cv.notify_all();
+      }
+    }
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return done == count; });
+  }
+
+  const size_t count;
+  /// Only called for claimed indices, so it outlives its uses.
+  const std::function<void(size_t)>& function;
+  std::atomic<size_t> next{0};
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t done = 0;
+};
+
+class ThreadPool {
+ public:
+  void run(size_t count, const std::function<void(size_t)>& function) {
+    auto batch = std::make_shared<Batch>(count, function);
+    if (count > 1) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (threads_.size() < count - 1) {
+        threads_.emplace_back([this] { this->worker_thread(); });
+      }
+      for (size_t i = 0; i < count - 1; ++i) {
+        batches_.push_back(batch);
+      }
+      cv_.notify_all();
+    }
+    batch->run();
+    batch->wait();
+  }
+
+ private:
+  void worker_thread() {
+    while (true) {
+      std::shared_ptr<Batch> batch;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !batches_.empty(); });
+        batch = std::move(batches_.front());
+        batches_.pop_front();
+      }
+      batch->run();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  /// One entry per worker that may help with a batch.
+  std::deque<std::shared_ptr<Batch>> batches_;
+  std::vector<std::thread> threads_;
+};
+} // namespace
+
+void run_in_parallel(
+    size_t count,
+    const std::function<void(size_t)>& function) {
+  // Never destroyed, so that exiting doesn't wait for the workers.
+  static auto* pool = new ThreadPool();
+  pool->run(count, function);
+}
+
+#ifdef USE_CUDA
+namespace {
+/// Buffer size of the coalesced broadcast, as in Python's `replicate()`.
+constexpr size_t kBroadcastBufferSize = 10 * 1024 * 1024;
+
+struct CacheEntry {
+  std::weak_ptr<Module> module;
+  std::vector<Device> devices;
+  std::vector<std::shared_ptr<Module>> replicas;
+};
+
+/// The parameters and buffers of a module, in a fixed order.
+std::vector<Tensor> state_of(Module& module) {
+  std::vector<Tensor> state;
+  for (auto& parameter : module.parameters()) {
+    state.push_back(*parameter);
+  }
+  for (auto& buffer : module.buffers()) {
+    state.push_back(*buffer);
+  }
+  return state;
+}
+
+/// Whether a replica still has the structure of the module, which `reset()`
+/// or `register_parameter()` may have changed since it was cloned.
+bool has_same_state(
+    const std::vector<Tensor>& module_state,
+    const std::vector<Tensor>& replica_state) {
+  if (module_state.size() != replica_state.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < module_state.size(); ++i) {
+    if (module_state[i].scalar_type() != replica_state[i].scalar_type() ||
+        module_state[i].is_sparse() != replica_state[i].is_sparse() ||
+        !module_state[i].sizes().equals(replica_state[i].sizes())) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+std::vector<std::shared_ptr<Module>> cached_module_replicas(
+    const std::shared_ptr<Module>& module,
+    const std::vector<Device>& devices) {
+  // The coalesced broadcast only copies between CUDA devices.
+  if (!std::all_of(devices.begin(), devices.end(), [](const Device& device) {
+        return device.is_cuda() && device.has_index();
+      })) {
+    return fmap(devices, [&](const Device& device) {
+      return module->clone(device);
+    });
+  }
+
+  static std::mutex mutex;
+  static std::vector<CacheEntry> cache;
+  std::lock_guard<std::mutex> lock(mutex);
+
+  cache.erase(
+      std::remove_if(
+          cache.begin(),
+          cache.end(),
+          [](const CacheEntry& entry) { return entry.module.expired(); }),
+      cache.end());
+  auto entry = std::find_if(
+      cache.begin(), cache.end(), [&](const CacheEntry& entry) {
+        return entry.module.lock() == module && entry.devices == devices;
+      });
+
+  auto module_state = state_of(*module);
+  if (entry != cache.end()) {
+    for (auto& replica : entry->replicas) {
+      if (!has_same_state(module_state, state_of(*replica))) {
+        cache.erase(entry);
+        entry = cache.end();
+        break;
+      }
+    }
+  }
+
+  if (entry == cache.end()) {
+    CacheEntry new_entry;
+    new_entry.module = module;
+    new_entry.devices = devices;
+    for (const auto& device : devices) {
+      new_entry.replicas.push_back(module->clone(device));
+    }
+    cache.push_back(std::move(new_entry));
+    return cache.back().replicas;
+  }
+
+  NoGradGuard no_grad;
+  std::vector<Tensor> sources;
+  sources.reserve(module_state.size());
+  for (const auto& tensor : module_state) {
+    auto data = autograd::Variable(tensor).data();
+    if (data.device() != devices.front()) {
+      data = data.to(devices.front(), /*non_blocking=*/true);
+    }
+    sources.push_back(std::move(data));
+  }
+  auto indices = fmap(devices, [](const Device& device) {
+    return static_cast<int64_t>(device.index());
+  });
+  auto broadcasted =
+      torch::cuda::broadcast_coalesced(sources, indices, kBroadcastBufferSize);
+
+  for (size_t i = 0; i < entry->replicas.size(); ++i) {
+    auto replica_state = state_of(*entry->replicas[i]);
+    for (size_t t = 0; t < replica_state.size(); ++t) {
+      replica_state[t].set_data(broadcasted[i][t]);
+      // Gradients of the previous step belong to the previous parameters.
+      replica_state[t].grad() = Tensor();
+    }
+  }
+  return entry->replicas;
+}
+#endif
+} // namespace detail
+} // namespace parallel
+} // namespace nn
+} // namespace torch
@@ -6,7 +6,11 @@
 
 #include <ATen/ATen.h>
 
+#include <array>
 #include <functional>
+#include <map>
+#include <tuple>
+#include <vector>
 
 namespace torch {
 namespace optim {
@@ -17,26 +21,65 @@ AdagradOptions::AdagradOptions(double learning_rate)
 /// Adapted from
 /// https://github.com/pytorch/pytorch/blob/master/torch/optim/adagrad.py
 void Adagrad::step() {
-  for (size_t i = 0; i < parameters_.size(); ++i) {
-    Tensor p = parameters_.at(i);
-    if (!p.grad().defined()) {
-      continue;
+  // Dense CUDA parameters, and float and double CPU parameters, are updated
+  // with at::_fused_adagrad_, in batches of parameters with the same type,
+  // device and step. Flat buffers are updated as a whole.
+  using FusedKey = std::tuple<int64_t, at::ScalarType, int64_t>;
+  std::map<FusedKey, std::array<std::vector<Tensor>, 3>> fused;
+
+  NoGradGuard guard;
+  const auto update_parameter = [&](Tensor p,
+                                    Tensor grad,
+                                    Tensor& sum,
+                                    int64_t step) {
+    if (detail::can_fuse({p, grad, sum})) {
+      auto& lists =
+          fused[std::make_tuple(p.get_device(), p.type().scalarType(), step)];
+      lists[0].push_back(p);
+      lists[1].push_back(grad);
+      lists[2].push_back(sum);
+      return;
     }
 
     if (options.weight_decay_ > 0) {
-      p.grad() = p.grad() + options.weight_decay_ * p;
+      grad = grad + options.weight_decay_ * p;
     }
 
-    buffer_at(step_buffers, i) += 1.0;
-    const auto clr = options.learning_rate_ /
-        (1.0 + (buffer_at(step_buffers, i) - 1.0) * options.lr_decay_);
+    const auto clr =
+        options.learning_rate_ / (1.0 + (step - 1.0) * options.lr_decay_);
+
+    sum.addcmul_(grad, grad, 1.0);
+    const auto std = sum.sqrt().add_(1e-10);
+
+    p.addcdiv_(grad, std, -clr);
+  };
 
-    auto& sum = buffer_at(sum_buffers, i);
-    sum.addcmul_(p.grad(), p.grad(), 1.0);
-    const auto std = buffer_at(sum_buffers, i).sqrt().add_(1e-10);
+  if (is_flat()) {
+    for (size_t group = 0; group < flat_parameters_.size(); ++group) {
+      sync_flat_group(group);
+      update_parameter(
+          flat_parameters_[group],
+          flat_gradients_[group],
+          flat_buffer_at(flat_sum_buffers_, sum_buffers, group),
+          flat_step_at(step_buffers, group));
+    }
+  } else {
+    for (size_t i = 0; i < parameters_.size(); ++i) {
+      Tensor p = parameters_.at(i);
+      if (!p.grad().defined()) {
+        continue;
+      }
+      buffer_at(step_buffers, i) += 1.0;
+      update_parameter(p, p.grad(), buffer_at(sum_buffers, i), step_buffers[i]);
+    }
+  }
 
-    NoGradGuard guard;
-    p.addcdiv_(p.grad(), std, -clr);
+  for (auto& entry : fused) {
+    const auto clr = options.learning_rate_ /
+        (1.0 + (std::get<2>(entry.first) - 1.0) * options.lr_decay_);
+    auto& lists = entry.second;
+    at::_fused_adagrad_(
+        lists[0], lists[1], lists[2], clr, options.weight_decay_);
   }
 }
 
@@ -7,8 +7,12 @@
 
 #include <ATen/ATen.h>
 
+#include <array>
 #include <cmath>
 #include <functional>
+#include <map>
+#include <tuple>
+#include <vector>
 
 namespace torch {
 namespace optim {
@@ -16,41 +20,104 @@ AdamOptions::AdamOptions(double learning_rate)
     : learning_rate_(learning_rate) {}
 
 void Adam::step() {
-  for (size_t i = 0; i < parameters_.size(); ++i) {
-    Tensor p = parameters_.at(i);
-    if (!p.grad().defined()) {
-      continue;
+  // Dense CUDA parameters, and float and double CPU parameters, are updated
+  // with at::_fused_adam_, in batches of parameters with the same type, device
+  // and step. Flat buffers are updated as a whole.
+  using FusedKey = std::tuple<int64_t, at::ScalarType, int64_t>;
+  std::map<FusedKey, std::array<std::vector<Tensor>, 4>> fused;
+
+  NoGradGuard guard;
+  const auto update_parameter = [&](Tensor p,
+                                    Tensor grad,
+                                    Tensor& exp_average,
+                                    Tensor& exp_average_sq,
+                                    Tensor* max_exp_average_sq,
+                                    int64_t step) {
+    if (!options.amsgrad_ &&
+        detail::can_fuse({p, grad, exp_average, exp_average_sq})) {
+      auto& lists =
+          fused[std::make_tuple(p.get_device(), p.type().scalarType(), step)];
+      lists[0].push_back(p);
+      lists[1].push_back(grad);
+      lists[2].push_back(exp_average);
+      lists[3].push_back(exp_average_sq);
+      return;
     }
 
     if (options.weight_decay_ > 0) {
-      p.grad() = p.grad() + options.weight_decay_ * p;
+      grad.add_(p, options.weight_decay_);
     }
 
-    auto& exp_average = buffer_at(exp_average_buffers, i);
-    auto& exp_average_sq = buffer_at(exp_average_sq_buffers, i);
-
-    buffer_at(step_buffers, i) += 1;
-
-    exp_average.mul_(options.beta1_).add_(p.grad(), 1 - options.beta1_);
+    exp_average.mul_(options.beta1_).add_(grad, 1 - options.beta1_);
     exp_average_sq.mul_(options.beta2_)
-        .addcmul_(p.grad(), p.grad(), 1 - options.beta2_);
+        .addcmul_(grad, grad, 1 - options.beta2_);
 
     Tensor denom = exp_average_sq;
-    if (options.amsgrad_) {
-      auto& max_exp_average_sq = buffer_at(max_exp_average_sq_buffers, i);
-      max_exp_average_sq = torch::max(max_exp_average_sq, exp_average_sq);
-      denom = max_exp_average_sq;
+    if (max_exp_average_sq != nullptr) {
+      max_exp_average_sq->copy_(
+          torch::max(*max_exp_average_sq, exp_average_sq));
+      denom = *max_exp_average_sq;
     }
 
-    const auto bias_correction1 =
-        1 - std::pow(options.beta1_, buffer_at(step_buffers, i));
-    const auto bias_correction2 =
-        1 - std::pow(options.beta2_, buffer_at(step_buffers, i));
+    const auto bias_correction1 = 1 - std::pow(options.beta1_, step);
+    const auto bias_correction2 = 1 - std::pow(options.beta2_, step);
     const auto step_size =
         options.learning_rate_ * std::sqrt(bias_correction2) / bias_correction1;
 
-    NoGradGuard guard;
     p.addcdiv_(exp_average, denom.sqrt() + options.eps_, -step_size);
+  };
+
+  if (is_flat()) {
+    for (size_t group = 0; group < flat_parameters_.size(); ++group) {
+      sync_flat_group(group);
+      update_parameter(
+          flat_parameters_[group],
+          flat_gradients_[group],
+          flat_buffer_at(flat_exp_average_buffers_, exp_average_buffers, group),
+          flat_buffer_at(
+              flat_exp_average_sq_buffers_, exp_average_sq_buffers, group),
+          options.amsgrad_ ? &flat_buffer_at(
+                                 flat_max_exp_average_sq_buffers_,
+                                 max_exp_average_sq_buffers,
+                                 group)
+                           : nullptr,
+          flat_step_at(step_buffers, group));
+    }
+  } else {
+    for (size_t i = 0; i < parameters_.size(); ++i) {
+      Tensor p = parameters_.at(i);
+      if (!p.grad().defined()) {
+        continue;
+      }
+      buffer_at(step_buffers, i) += 1;
+      update_parameter(
+          p,
+          p.grad(),
+          buffer_at(exp_average_buffers, i),
+          buffer_at(exp_average_sq_buffers, i),
+          options.amsgrad_ ? &buffer_at(max_exp_average_sq_buffers, i)
+                           : nullptr,
+          step_buffers[i]);
+    }
+  }
+
+  for (auto& entry : fused) {
+    const auto step = std::get<2>(entry.first);
+    const auto bias_correction1 = 1 - std::pow(options.beta1_, step);
+    const auto bias_correction2 = 1 - std::pow(options.beta2_, step);
+    const auto step_size =
+        options.learning_rate_ * std::sqrt(bias_correction2) / bias_correction1;
+    auto& lists = entry.second;
+    at::_fused_adam_(
+        lists[0],
+        lists[1],
+        lists[2],
+        lists[3],
+        options.beta1_,
+        options.beta2_,
+        step_size,
+        options.eps_,
+        options.weight_decay_);
   }
 }
 
@@ -0,0 +1,170 @@
+#include <torch/optim/mixed_precision.h>
+
+#include <torch/csrc/autograd/generated/variable_factories.h>
+#include <torch/csrc/autograd/variable.h>
+#include <torch/nn/cursor.h>
+#include <torch/optim/optimizer.h>
+#include <torch/tensor.h>
+#include <torch/utils.h>
+
+#include <ATen/ATen.h>
+#include <c10/util/Exception.h>
+
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace optim {
+namespace {
+std::vector<Tensor> tensors_of(
+    const torch::detail::CursorBase<Tensor>& cursor) {
+  std::vector<Tensor> tensors(cursor.size());
+  cursor.map(tensors.begin(), [](const Tensor& tensor) { return tensor; });
+  return tensors;
+}
+} // namespace
+
+LossScalerOptions::LossScalerOptions(double init_scale)
+    : init_scale_(init_scale) {}
+
+LossScaler::LossScaler(LossScalerOptions options)
+    : options_(std::move(options)), scale_(options_.init_scale_) {
+  AT_CHECK(scale_ > 0, "init_scale must be positive");
+  AT_CHECK(options_.growth_factor_ >= 1, "growth_factor must be at least 1");
+  AT_CHECK(
+      options_.backoff_factor_ > 0 && options_.backoff_factor_ <= 1,
+      "backoff_factor must be in (0, 1]");
+  AT_CHECK(options_.growth_interval_ > 0, "growth_interval must be positive");
+}
+
+Tensor LossScaler::scale(const Tensor& loss) const {
+  return loss.to(torch::kFloat) * scale_;
+}
+
+bool LossScaler::unscale(const std::vector<Tensor>& gradients) const {
+  NoGradGuard guard;
+  const double inverse_scale = 1 / scale_;
+  bool finite = true;
+  std::map<std::tuple<int64_t, at::ScalarType>, std::vector<Tensor>> fused;
+  for (const auto& gradient : gradients) {
+    if (!gradient.defined()) {
+      continue;
+    }
+    if (detail::can_fuse({gradient})) {
+      fused[std::make_tuple(
+                gradient.get_device(), gradient.type().scalarType())]
+          .push_back(gradient);
+    } else {
+      gradient.mul_(inverse_scale);
+      finite = finite && std::isfinite(gradient.sum().item<double>());
+    }
+  }
+  for (auto& entry : fused) {
+    auto& tensors = entry.second;
+    auto found_non_finite = torch::zeros(
+        {1}, torch::dtype(torch::kFloat).device(tensors[0].device()));
+    at::_multi_tensor_unscale_(tensors, found_non_finite, inverse_scale);
+    finite = finite && found_non_finite.item<float>() == 0;
+  }
+  return finite;
+}
+
+void LossScaler::update(bool found_non_finite) {
+  if (found_non_finite) {
+    ++skipped_steps_;
+  }
+  if (!options_.dynamic_) {
+    return;
+  }
+  if (found_non_finite) {
+    scale_ *= options_.backoff_factor_;
+    steps_since_growth_ = 0;
+  } else if (++steps_since_growth_ == options_.growth_interval_) {
+    scale_ *= options_.growth_factor_;
+    steps_since_growth_ = 0;
+  }
+}
+
+double LossScaler::loss_scale() const noexcept {
+  return scale_;
+}
+
+int64_t LossScaler::skipped_steps() const noexcept {
+  return skipped_steps_;
+}
+
+const LossScalerOptions& LossScaler::options() const noexcept {
+  return options_;
+}
+
+namespace detail {
+MasterParameters::MasterParameters(std::vector<Tensor> model_parameters)
+    : model_(std::move(model_parameters)) {
+  master_.reserve(model_.size());
+  for (const auto& parameter : model_) {
+    AT_CHECK(
+        parameter.is_floating_point(),
+        "Only floating point parameters can be trained in mixed precision");
+    master_.push_back(autograd::make_variable(
+        autograd::Variable(parameter).data().to(
+            torch::kFloat, /*non_blocking=*/false, /*copy=*/true),
+        /*requires_grad=*/true));
+  }
+}
+
+MasterParameters::MasterParameters(
+    const torch::detail::CursorBase<Tensor>& cursor)
+    : MasterParameters(tensors_of(cursor)) {}
+
+bool MasterParameters::copy_gradients(const LossScaler& scaler) {
+  NoGradGuard guard;
+  std::vector<Tensor> gradients;
+  gradients.reserve(master_.size());
+  for (size_t i = 0; i < master_.size(); ++i) {
+    auto& master_gradient = master_[i].grad();
+    if (!master_gradient.defined()) {
+      master_gradient = torch::zeros_like(master_[i]);
+    }
+    // Copied into the existing gradient, which is a view of a flat buffer
+    // when the optimizer flattened the master parameters.
+    const auto& model_gradient = model_[i].grad();
+    if (model_gradient.defined()) {
+      master_gradient.copy_(model_gradient);
+    } else {
+      master_gradient.zero_();
+    }
+    gradients.push_back(master_gradient);
+  }
+  return scaler.unscale(gradients);
+}
+
+void MasterParameters::copy_parameters() {
+  NoGradGuard guard;
+  for (size_t i = 0; i < model_.size(); ++i) {
+    model_[i].copy_(master_[i]);
+  }
+}
+
+void MasterParameters::zero_grad() {
+  for (auto& parameter : model_) {
+    if (parameter.grad().defined()) {
+      parameter.grad().detach_();
+      parameter.grad().zero_();
+    }
+  }
+}
+
+const std::vector<Tensor>& MasterParameters::master() const noexcept {
+  return master_;
+}
+
+const std::vector<Tensor>& MasterParameters::model() const noexcept {
+  return model_;
+}
+} // namespace detail
+} // namespace optim
+} // namespace torch
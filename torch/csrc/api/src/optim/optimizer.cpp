@@ -1,10 +1,16 @@
 #include <torch/optim/optimizer.h>
 
 #include <torch/csrc/autograd/generated/variable_factories.h>
+#include <torch/csrc/autograd/variable.h>
 #include <torch/nn/cursor.h>
 #include <torch/serialize/archive.h>
 #include <torch/tensor.h>
+#include <torch/utils.h>
 
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
@@ -21,6 +27,9 @@ OptimizerBase::OptimizerBase(const ParameterCursor& cursor) {
 
 void OptimizerBase::add_parameters(const std::vector<Tensor>& parameters) {
   parameters_.insert(parameters_.end(), parameters.begin(), parameters.end());
+  flat_parameters_.clear();
+  flat_gradients_.clear();
+  flat_indices_.clear();
 }
 
 void OptimizerBase::add_parameters(const ParameterCursor& cursor) {
@@ -30,6 +39,14 @@ void OptimizerBase::add_parameters(const ParameterCursor& cursor) {
 }
 
 void OptimizerBase::zero_grad() {
+  if (is_flat()) {
+    NoGradGuard guard;
+    for (size_t group = 0; group < flat_gradients_.size(); ++group) {
+      sync_flat_group(group);
+      flat_gradients_[group].zero_();
+    }
+    return;
+  }
   for (auto& parameter : parameters_) {
     if (parameter.grad().defined()) {
       parameter.grad().detach_();
@@ -38,6 +55,61 @@ void OptimizerBase::zero_grad() {
   }
 }
 
+void OptimizerBase::flatten_parameters() {
+  flat_parameters_.clear();
+  flat_gradients_.clear();
+  flat_indices_.clear();
+  flat_offsets_.assign(parameters_.size(), 0);
+  flat_numels_.assign(parameters_.size(), 0);
+
+  std::vector<int64_t> sizes;
+  for (size_t i = 0; i < parameters_.size(); ++i) {
+    const auto& parameter = parameters_[i];
+    AT_CHECK(!parameter.is_sparse(), "Only dense parameters can be flattened");
+    size_t group = 0;
+    while (group < flat_indices_.size()) {
+      const auto& first = parameters_[flat_indices_[group].front()];
+      if (first.type() == parameter.type() &&
+          first.device() == parameter.device()) {
+        break;
+      }
+      ++group;
+    }
+    if (group == flat_indices_.size()) {
+      flat_indices_.emplace_back();
+      sizes.push_back(0);
+    }
+    flat_indices_[group].push_back(i);
+    flat_offsets_[i] = sizes[group];
+    flat_numels_[i] = parameter.numel();
+    sizes[group] += parameter.numel();
+  }
+
+  for (size_t group = 0; group < flat_indices_.size(); ++group) {
+    const auto options =
+        autograd::Variable(parameters_[flat_indices_[group].front()])
+            .data()
+            .options();
+    flat_parameters_.push_back(
+        autograd::make_variable(at::empty({sizes[group]}, options)));
+    flat_gradients_.push_back(
+        autograd::make_variable(at::zeros({sizes[group]}, options)));
+    sync_flat_group(group);
+  }
+}
+
+bool OptimizerBase::is_flat() const noexcept {
+  return !flat_parameters_.empty();
+}
+
+const std::vector<Tensor>& OptimizerBase::flat_parameters() const noexcept {
+  return flat_parameters_;
+}
+
+const std::vector<Tensor>& OptimizerBase::flat_gradients() const noexcept {
+  return flat_gradients_;
+}
+
 const std::vector<Tensor>& OptimizerBase::parameters() const noexcept {
   return parameters_;
 }
@@ -67,6 +139,111 @@ Tensor& OptimizerBase::buffer_at(std::vector<Tensor>& buffers, size_t index) {
   return buffers[index];
 }
 
+Tensor OptimizerBase::flat_slot(const Tensor& flat, size_t index) const {
+  return flat.narrow(0, flat_offsets_[index], flat_numels_[index])
+      .view(parameters_[index].sizes());
+}
+
+bool OptimizerBase::is_flat_slot(
+    const Tensor& tensor,
+    const Tensor& flat,
+    size_t index) const {
+  if (!tensor.defined() || tensor.numel() != flat_numels_[index]) {
+    return false;
+  }
+  const auto flat_data = autograd::Variable(flat).data();
+  return autograd::Variable(tensor).data().data_ptr() ==
+      static_cast<char*>(flat_data.data_ptr()) +
+      flat_offsets_[index] * flat_data.type().elementSizeInBytes();
+}
+
+void OptimizerBase::sync_flat_group(size_t group) {
+  NoGradGuard guard;
+  const auto& flat_parameter = flat_parameters_[group];
+  const auto& flat_gradient = flat_gradients_[group];
+  for (const auto index : flat_indices_[group]) {
+    auto& parameter = parameters_[index];
+    AT_CHECK(
+        parameter.numel() == flat_numels_[index],
+        "A parameter changed size since flatten_parameters() was called");
+    if (!is_flat_slot(parameter, flat_parameter, index)) {
+      auto slot = flat_slot(autograd::Variable(flat_parameter).data(), index);
+      slot.copy_(autograd::Variable(parameter).data());
+      parameter.set_data(slot);
+    }
+    auto& gradient = parameter.grad();
+    if (!is_flat_slot(gradient, flat_gradient, index)) {
+      auto slot = flat_slot(autograd::Variable(flat_gradient).data(), index);
+      if (gradient.defined()) {
+        AT_CHECK(
+            !gradient.is_sparse(), "Only dense gradients can be flattened");
+        slot.copy_(autograd::Variable(gradient).data());
+      } else {
+        slot.zero_();
+      }
+      gradient = autograd::make_variable(slot);
+    }
+  }
+}
+
+Tensor& OptimizerBase::flat_buffer_at(
+    std::vector<Tensor>& flat_buffers,
+    std::vector<Tensor>& buffers,
+    size_t group) {
+  if (flat_buffers.size() != flat_parameters_.size()) {
+    flat_buffers.assign(flat_parameters_.size(), Tensor());
+  }
+  auto& flat = flat_buffers[group];
+  if (!flat.defined()) {
+    flat = torch::zeros_like(flat_parameters_[group]);
+  }
+  if (buffers.size() < parameters_.size()) {
+    buffers.resize(parameters_.size());
+  }
+  NoGradGuard guard;
+  for (const auto index : flat_indices_[group]) {
+    auto& buffer = buffers[index];
+    if (is_flat_slot(buffer, flat, index)) {
+      continue;
+    }
+    auto slot = flat_slot(flat, index);
+    if (buffer.defined()) {
+      slot.copy_(buffer);
+    } else {
+      slot.zero_();
+    }
+    buffer = slot;
+  }
+  return flat;
+}
+
+int64_t OptimizerBase::flat_step_at(
+    std::vector<int64_t>& steps,
+    size_t group) {
+  const auto& indices = flat_indices_[group];
+  buffer_at(steps, *std::max_element(indices.begin(), indices.end()));
+  const auto step = steps[indices.front()] + 1;
+  for (const auto index : indices) {
+    steps[index] = step;
+  }
+  return step;
+}
+
+bool can_fuse(const std::vector<Tensor>& tensors) {
+  const auto& first = tensors.front();
+  if (!first.is_cuda() &&
+      !(first.device().is_cpu() &&
+        (first.scalar_type() == at::kFloat ||
+         first.scalar_type() == at::kDouble))) {
+    return false;
+  }
+  return std::all_of(tensors.begin(), tensors.end(), [&](const Tensor& tensor) {
+    return !tensor.is_sparse() && tensor.is_contiguous() &&
+        tensor.type() == first.type() &&
+        tensor.get_device() == first.get_device();
+  });
+}
+
 void OptimizerBase::save(serialize::OutputArchive& archive) const {}
 void OptimizerBase::load(serialize::InputArchive& archive) {}
 
@@ -17,38 +17,66 @@ RMSpropOptions::RMSpropOptions(double learning_rate)
 /// Adapted from
 /// https://github.com/pytorch/pytorch/blob/master/torch/optim/rmsprop.py
 void RMSprop::step() {
-  for (size_t i = 0; i < parameters_.size(); ++i) {
-    Tensor p = parameters_.at(i);
-    if (!p.grad().defined()) {
-      continue;
-    }
-
+  NoGradGuard guard;
+  const auto update_parameter = [&](Tensor p,
+                                    Tensor grad,
+                                    Tensor& square_average,
+                                    Tensor* grad_average,
+                                    Tensor* momentum) {
     if (options.weight_decay_ > 0) {
-      p.grad() = p.grad() + options.weight_decay_ * p;
+      grad.add_(p, options.weight_decay_);
     }
 
-    auto square_average = buffer_at(square_average_buffers, i);
     square_average.mul_(options.alpha_)
-        .addcmul_(p.grad(), p.grad(), 1.0 - options.alpha_);
+        .addcmul_(grad, grad, 1.0 - options.alpha_);
 
     Tensor average;
-    if (options.centered_ > 0) {
-      auto& grad_average = buffer_at(grad_average_buffers, i);
-      grad_average.mul_(options.alpha_).add_(p.grad(), 1.0 - options.alpha_);
-      average = square_average.addcmul(grad_average, grad_average, -1.0)
+    if (grad_average != nullptr) {
+      grad_average->mul_(options.alpha_).add_(grad, 1.0 - options.alpha_);
+      average = square_average.addcmul(*grad_average, *grad_average, -1.0)
                     .sqrt()
                     .add_(options.eps_);
     } else {
       average = square_average.sqrt().add_(options.eps_);
     }
 
-    NoGradGuard guard;
-    if (options.momentum_ > 0) {
-      auto& momentum = buffer_at(momentum_buffers, i);
-      momentum.mul_(options.momentum_).addcdiv_(p.grad(), average);
-      p.add_(momentum, -options.learning_rate_);
+    if (momentum != nullptr) {
+      momentum->mul_(options.momentum_).addcdiv_(grad, average);
+      p.add_(*momentum, -options.learning_rate_);
     } else {
-      p.addcdiv_(p.grad(), average, -options.learning_rate_);
+      p.addcdiv_(grad, average, -options.learning_rate_);
+    }
+  };
+
+  if (is_flat()) {
+    for (size_t group = 0; group < flat_parameters_.size(); ++group) {
+      sync_flat_group(group);
+      update_parameter(
+          flat_parameters_[group],
+          flat_gradients_[group],
+          flat_buffer_at(
+              flat_square_average_buffers_, square_average_buffers, group),
+          options.centered_ ? &flat_buffer_at(
+                                  flat_grad_average_buffers_,
+                                  grad_average_buffers,
+                                  group)
+                            : nullptr,
+          options.momentum_ > 0
+              ? &flat_buffer_at(flat_momentum_buffers_, momentum_buffers, group)
+              : nullptr);
+    }
+  } else {
+    for (size_t i = 0; i < parameters_.size(); ++i) {
+      Tensor p = parameters_.at(i);
+      if (!p.grad().defined()) {
+        continue;
+      }
+      update_parameter(
+          p,
+          p.grad(),
+          buffer_at(square_average_buffers, i),
+          options.centered_ ? &buffer_at(grad_average_buffers, i) : nullptr,
+          options.momentum_ > 0 ? &buffer_at(momentum_buffers, i) : nullptr);
     }
   }
 }
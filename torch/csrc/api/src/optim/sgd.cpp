@@ -16,24 +16,18 @@ namespace optim {
 SGDOptions::SGDOptions(double learning_rate) : learning_rate_(learning_rate) {}
 
 void SGD::step() {
-  for (size_t i = 0; i < parameters_.size(); ++i) {
-    Tensor p = parameters_.at(i);
-
-    if (!p.grad().defined()) {
-      continue;
-    }
-
-    auto update = options.learning_rate_ * p.grad();
-    if (options.momentum_ != 0) {
+  NoGradGuard guard;
+  const auto update_parameter = [&](Tensor p, Tensor grad, Tensor* momentum) {
+    auto update = options.learning_rate_ * grad;
+    if (momentum != nullptr) {
       const auto dampening = iteration_ == 0 ? 1 : 1 - options.dampening_;
-      auto& momentum = buffer_at(momentum_buffers, i);
-      momentum = (options.momentum_ * momentum) + (dampening * update);
+      momentum->mul_(options.momentum_).add_(update, dampening);
       if (options.nesterov_) {
         // See github.com/lisa-lab/pylearn2/pull/136#issuecomment-10381617
         // for notes on this implementation of nesterov momentum.
-        update += options.momentum_ * momentum;
+        update += options.momentum_ * *momentum;
       } else {
-        update = momentum;
+        update = *momentum;
       }
     }
 
@@ -41,8 +35,30 @@ void SGD::step() {
       update += options.learning_rate_ * options.weight_decay_ * p;
     }
 
-    NoGradGuard guard;
     p.add_(-update);
+  };
+
+  if (is_flat()) {
+    for (size_t group = 0; group < flat_parameters_.size(); ++group) {
+      sync_flat_group(group);
+      update_parameter(
+          flat_parameters_[group],
+          flat_gradients_[group],
+          options.momentum_ != 0
+              ? &flat_buffer_at(flat_momentum_buffers_, momentum_buffers, group)
+              : nullptr);
+    }
+  } else {
+    for (size_t i = 0; i < parameters_.size(); ++i) {
+      Tensor p = parameters_.at(i);
+      if (!p.grad().defined()) {
+        continue;
+      }
+      update_parameter(
+          p,
+          p.grad(),
+          options.momentum_ != 0 ? &buffer_at(momentum_buffers, i) : nullptr);
+    }
   }
   iteration_ += 1;
 }
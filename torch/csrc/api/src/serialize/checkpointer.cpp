@@ -0,0 +1,110 @@
+#include <torch/serialize/checkpointer.h>
+
+#include <torch/serialize/output-archive.h>
+
+#include <c10/util/Exception.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace torch {
+namespace serialize {
+Checkpointer::Checkpointer(CheckpointerOptions options)
+    : options_(std::move(options)) {
+  AT_CHECK(options_.max_pending() > 0, "max_pending must be positive");
+  writer_ = std::thread([this] { this->writer_thread(); });
+}
+
+Checkpointer::~Checkpointer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  writer_.join();
+}
+
+std::shared_future<void> Checkpointer::save(
+    OutputArchive archive,
+    std::string filename) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return pending_ < options_.max_pending(); });
+  ++pending_;
+  lock.unlock();
+
+  std::unique_ptr<Checkpoint> checkpoint(new Checkpoint{
+      std::move(archive), std::move(filename), std::promise<void>()});
+  auto written = checkpoint->written.get_future().share();
+  try {
+    checkpoint->archive.snapshot();
+  } catch (...) {
+    lock.lock();
+    --pending_;
+    lock.unlock();
+    cv_.notify_all();
+    throw;
+  }
+
+  lock.lock();
+  queue_.push_back(std::move(checkpoint));
+  lock.unlock();
+  cv_.notify_all();
+  return written;
+}
+
+void Checkpointer::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return pending_ == 0; });
+}
+
+size_t Checkpointer::pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_;
+}
+
+const CheckpointerOptions& Checkpointer::options() const noexcept {
+  return options_;
+}
+
+void Checkpointer::writer_thread() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    // Pending checkpoints are written before stopping.
+    cv_.wait(lock, [this] { return !queue_.empty() || stop_; });
+    if (queue_.empty()) {
+      return;
+    }
+    auto checkpoint = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+
+    const auto temporary = checkpoint->filename + ".tmp";
+    try {
+      checkpoint->archive.save_to(temporary);
+      AT_CHECK(
+          std::rename(temporary.c_str(), checkpoint->filename.c_str()) == 0,
+          "Unable to rename ",
+          temporary,
+          " to ",
+          checkpoint->filename);
+      checkpoint->written.set_value();
+    } catch (...) {
+      std::remove(temporary.c_str());
+      checkpoint->written.set_exception(std::current_exception());
+    }
+    // The snapshot is freed before the next checkpoint can be saved.
+    checkpoint.reset();
+
+    lock.lock();
+    --pending_;
+    cv_.notify_all();
+  }
+}
+} // namespace serialize
+} // namespace torch
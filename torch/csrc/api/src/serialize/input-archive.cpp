@@ -33,7 +33,17 @@ void InputArchive::read(
   // clang-format on
   if (tensor.defined()) {
     torch::NoGradGuard guard;
-    tensor.set_(*read_tensor->slot());
+    const auto& read = *read_tensor->slot();
+    if (tensor.type() == read.type()) {
+      tensor.set_(read);
+    } else {
+      // E.g. a CUDA parameter, which is copied to straight from the file.
+      AT_CHECK(
+          tensor.sizes() == read.sizes(),
+          "Expected deserialized tensor for key '", key, "' to have size ",
+          tensor.sizes(), ", but it has size ", read.sizes());
+      tensor.copy_(read);
+    }
   } else {
     tensor = std::move(*read_tensor->slot());
   }
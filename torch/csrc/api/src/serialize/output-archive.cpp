@@ -3,17 +3,86 @@
 #include <torch/tensor.h>
 #include <torch/utils.h>
 
+#include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/jit/export.h>
 #include <torch/csrc/jit/script/module.h>
 
+#include <ATen/ATen.h>
+#include <ATen/detail/CUDAHooksInterface.h>
 #include <c10/util/Exception.h>
 
+#ifdef USE_CUDA
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/Exceptions.h>
+#endif
+
+#include <cstdint>
 #include <memory>
 #include <ostream>
+#include <set>
 #include <string>
+#include <unordered_map>
 
 namespace torch {
 namespace serialize {
+namespace {
+/// The copies of the storages of a snapshot, by the storage they copy, and
+/// the CUDA devices they were copied from.
+struct Snapshot {
+  std::unordered_map<const void*, Tensor> storages;
+  std::set<int64_t> devices;
+};
+
+/// Returns a tensor with the same metadata as `tensor`, whose storage is a
+/// CPU copy of the storage of `tensor`, shared with the other tensors of
+/// `snapshot` that view the same storage.
+Tensor snapshot_tensor(const Tensor& tensor, Snapshot& snapshot) {
+  const bool is_variable = tensor.is_variable();
+  Tensor data = is_variable ? autograd::Variable(tensor).data() : tensor;
+  AT_CHECK(!data.is_sparse(), "Sparse tensors cannot be snapshotted");
+
+  auto* storage = data.storage().unsafeGetStorageImpl();
+  auto copy = snapshot.storages.find(storage);
+  if (copy == snapshot.storages.end()) {
+    const auto size = static_cast<int64_t>(data.storage().size());
+    auto whole = data.type().tensor(data.storage(), 0, {size}, {1});
+    Tensor storage_copy;
+    if (whole.is_cuda()) {
+      // Copies into pinned memory are asynchronous with respect to the host.
+      storage_copy = whole.type().cpu().tensorWithAllocator(
+          {size}, at::detail::getCUDAHooks().getPinnedMemoryAllocator());
+      storage_copy.copy_(whole, /*non_blocking=*/true);
+      snapshot.devices.insert(whole.get_device());
+    } else {
+      storage_copy = whole.clone();
+    }
+    copy = snapshot.storages.emplace(storage, std::move(storage_copy)).first;
+  }
+
+  auto result = copy->second.type().tensor(
+      copy->second.storage(),
+      data.storage_offset(),
+      data.sizes(),
+      data.strides());
+  if (is_variable) {
+    return autograd::make_variable(result, tensor.requires_grad());
+  }
+  return result;
+}
+
+void snapshot_module(jit::script::Module& module, Snapshot& snapshot) {
+  for (const auto& parameter : module.get_parameters()) {
+    auto* slot = parameter.value.slot();
+    if (slot->defined()) {
+      *slot = snapshot_tensor(*slot, snapshot);
+    }
+  }
+  for (const auto& submodule : module.get_modules()) {
+    snapshot_module(*submodule.value.module, snapshot);
+  }
+}
+} // namespace
+
 OutputArchive::OutputArchive()
     : module_(std::make_shared<jit::script::Module>()) {}
 
@@ -30,6 +99,19 @@ void OutputArchive::write(
   module_->register_module(key, nested_archive.module_);
 }
 
+void OutputArchive::snapshot() {
+  AT_ASSERT(module_ != nullptr);
+  Snapshot snapshot;
+  snapshot_module(*module_, snapshot);
+#ifdef USE_CUDA
+  // The copies were enqueued on the current stream of every device.
+  for (const auto device : snapshot.devices) {
+    AT_CUDA_CHECK(
+        cudaStreamSynchronize(at::cuda::getCurrentCUDAStream(device)));
+  }
+#endif
+}
+
 void OutputArchive::save_to(const std::string& filename) {
   AT_ASSERT(module_ != nullptr);
   jit::ExportModule(*module_, filename);
@@ -44,7 +44,9 @@ extern std::vector<std::unique_ptr<Type>> type_to_variable_type;
 
 inline void check_inplace(const Tensor& tensor) {
   auto& var = static_cast<const Variable&>(tensor);
-  if (var.requires_grad() && var.is_leaf() && GradMode::is_enabled()) {
+  // GradMode first, it is the cheapest check and skips the others under
+  // NoGradGuard
+  if (GradMode::is_enabled() && var.requires_grad() && var.is_leaf()) {
     AT_ERROR(
       "a leaf Variable that requires grad has been used in an in-place operation.");
   }
@@ -142,10 +144,11 @@ inline Tensor as_variable(Tensor tensor) {
   return make_variable(std::move(tensor), /*requires_grad=*/false);
 }
 
-inline std::vector<Tensor> as_variable(TensorList tl) {
-  return fmap(tl, [](const Tensor& t) -> Tensor {
-      return make_variable(std::move(t), /*requires_grad=*/false);
-  });
+inline std::vector<Tensor> as_variable(std::vector<Tensor> tensors) {
+  for (Tensor& tensor : tensors) {
+    tensor = make_variable(std::move(tensor), /*requires_grad=*/false);
+  }
+  return tensors;
 }
 
 template <typename... Tensors, size_t... Is>
@@ -156,7 +159,7 @@ std::tuple<Tensors...> as_variable_impl(
   // constructions. This turns into (boolean omitted):
   // Variable(std::get<0>(tensors)), Variable(std::get<1>(tensors)), ...
   return std::tuple<Tensors...>(
-      as_variable(std::get<Is>(tensors))...);
+      as_variable(std::get<Is>(std::move(tensors)))...);
 }
 
 // NB: Because this was not forward declared, recursive std::tuple won't work.
@@ -168,7 +171,7 @@ std::tuple<Tensors...> as_variable(std::tuple<Tensors...> tensors) {
   // expand into an Indices object containing the numbers 0 to
   // sizeof...(Tensors) - 1.
   return as_variable_impl(
-      tensors, typename MakeIndices<sizeof...(Tensors)>::indices());
+      std::move(tensors), typename MakeIndices<sizeof...(Tensors)>::indices());
 }
 
 inline std::vector<std::vector<int64_t>> to_args_sizes(TensorList tensors) {
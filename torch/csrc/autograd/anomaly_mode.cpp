@@ -3,5 +3,6 @@
 namespace torch { namespace autograd {
 
 bool AnomalyMode::_enabled = false;
+bool AnomalyMode::_lightweight = false;
 
 }}
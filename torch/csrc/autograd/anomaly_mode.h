@@ -2,6 +2,8 @@
 
 #include "torch/csrc/WindowsTorchApiMacro.h"
 
+#include <string>
+
 namespace torch { namespace autograd {
 
 struct AnomalyMode {
@@ -11,9 +13,19 @@ struct AnomalyMode {
   static void set_enabled(bool enabled) {
     _enabled = enabled;
   }
+  // In lightweight mode functions only record where they were created, and
+  // the outputs of the backward functions are checked for nan and inf values
+  // by device reductions that are read once, at the end of the backward pass.
+  static bool is_lightweight() {
+    return _lightweight;
+  }
+  static void set_lightweight(bool lightweight) {
+    _lightweight = lightweight;
+  }
 
 private:
  TORCH_API static bool _enabled;
+ TORCH_API static bool _lightweight;
 };
 
 
@@ -21,6 +33,12 @@ struct AnomalyMetadata {
   virtual ~AnomalyMetadata() = default;
   virtual void store_stack() = 0;
   virtual void print_stack() = 0;
+  // Records only the innermost frame of the stack (lightweight mode)
+  virtual void store_callsite() {}
+  // The frame recorded by store_callsite, or an empty string
+  virtual std::string callsite() {
+    return "";
+  }
 };
 
 }}
@@ -15,6 +15,7 @@
 #include <cstdint>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -47,12 +48,17 @@ static thread_local int worker_device = NO_DEVICE;
 // gradient checkpointing feature only.
 static thread_local bool checkpoint_valid = true;
 
+// The GraphTask of the function that is running on this thread, if any. Used
+// by is_edge_needed_by_current_task.
+static thread_local GraphTask* current_graph_task = nullptr;
+
 // XXX: Changes to the way multithreading works in execute should be done with
-// great care. Right now the implementation guarantees that a single function's
-// apply will never be entered concurrently (even if multiple graphs are
-// executed at the same time). Adding multiple threads per-device or removing
-// engine thread affinity to the device can break this invariant, and we depend
-// on it in a few places (e.g. AccumulateGrad function).
+// great care. Within one execution of a graph, a function's apply is entered
+// only once. With a single CPU worker (the default) and one worker per GPU, a
+// function's apply is also never entered concurrently if multiple graphs are
+// executed at the same time. With more CPU workers (see set_num_cpu_threads),
+// functions shared by concurrently executed graphs may run concurrently, so
+// AccumulateGrad locks around updating the gradient.
 
 struct FunctionTask {
   GraphTask* base;
@@ -81,7 +87,12 @@ struct ReadyQueue {
   std::mutex mutex;
 
   void push(FunctionTask item);
-  FunctionTask pop();
+  // Returns the next task. If graph_task is given, returns a task without a
+  // base once graph_task has no outstanding tasks, instead of waiting for
+  // more work. See Note [Reentrant backwards]
+  FunctionTask pop(GraphTask* graph_task);
+  // Wakes up the threads waiting in pop, so that they check their graph_task.
+  void notify_waiters();
 };
 
 // Note [Reentrant backwards]
@@ -93,9 +104,9 @@ struct ReadyQueue {
 //  differentiation finishes so that you can get the final result variables
 //  of the backwards pass.
 //
-//  2. The engine operates by having a single worker thread per work queue,
-//  and every work queue is pinned to a specific device where the
-//  operation is executed.
+//  2. The engine operates by having a single worker thread per work queue
+//  (or a fixed set of them for the CPU queue), and every work queue is
+//  pinned to a specific device where the operation is executed.
 //
 // The problem is, suppose that you call backward() inside of a worker
 // thread.  By property (1), we're supposed to block until the nested task
@@ -118,7 +129,9 @@ struct ReadyQueue {
 //  - When we finish a GraphTask, we have to make sure we wake up the worker
 //    thread so that it actually has a chance to exit the thread_main()
 //    loop.  Thus the faffing about in thread_main() after
-//    evaluate_function() completes.
+//    evaluate_function() completes.  Several CPU workers share a queue, so
+//    the last task may finish on any of them; the owner waits in
+//    ReadyQueue::pop for either more work or its task to finish.
 
 
 // GraphTask holds metadata needed for a single execution of backward()
@@ -160,12 +173,26 @@ struct GraphTask {
   std::unordered_map<Function*, ExecInfo> exec_info;
   std::vector<Variable> captured_vars;
 
+  // In lightweight anomaly mode, a scalar per output of the functions that is
+  // zero if all the values of the output are finite and nan otherwise. They
+  // are only read by check_anomaly_flags, once the task is done.
+  struct AnomalyFlag {
+    std::shared_ptr<Function> fn;
+    int output_nr;
+    at::Tensor flag;
+  };
+  std::vector<AnomalyFlag> anomaly_flags;
+
   void init_to_execute(Function& graph_root, const edge_list& outputs);
 
   // The value of worker_device in the thread that created this task.
   // See Note [Reentrant backwards]
   int owner;
 
+  // Set when the task is run by execute_inline. All of its functions are
+  // queued here, whatever their device, and run by the thread that owns it.
+  std::unique_ptr<ReadyQueue> local_ready_queue;
+
   bool can_checkpoint() {
     return exec_info.empty();
   }
@@ -187,14 +214,26 @@ auto ReadyQueue::push(FunctionTask item) -> void {
   not_empty.notify_one();
 }
 
-auto ReadyQueue::pop() -> FunctionTask {
+auto ReadyQueue::pop(GraphTask* graph_task) -> FunctionTask {
   std::unique_lock<std::mutex> lock(mutex);
-  not_empty.wait(lock, [this]{ return !heap.empty(); });
+  not_empty.wait(lock, [this, graph_task]{
+    return !heap.empty() || (graph_task && graph_task->outstanding_tasks.load() == 0);
+  });
+  if (heap.empty()) {
+    return FunctionTask(nullptr, nullptr, InputBuffer(0));
+  }
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
   auto task = std::move(const_cast<FunctionTask&>(heap.top())); heap.pop();
   return task;
 }
 
+auto ReadyQueue::notify_waiters() -> void {
+  // Taking the mutex orders this with the check in pop, so that a thread
+  // that is about to wait doesn't miss the notification.
+  { std::lock_guard<std::mutex> lock(mutex); }
+  not_empty.notify_all();
+}
+
 Engine::Engine() = default;
 
 // This Engine's ReadyQueues and their corresponding threads are leaked here
@@ -226,7 +265,11 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
   // Why the test on graph_task->outstanding_tasks?  See
   // Note [Reentrant backwards]
   while (!graph_task || graph_task->outstanding_tasks > 0) {
-    FunctionTask task = queue->pop();
+    FunctionTask task = queue->pop(graph_task);
+    if (!task.base) {
+      // graph_task was finished by another thread
+      continue;
+    }
     if (task.fn && !task.base->has_error.load()) {
       GradMode::set_enabled(task.base->grad_mode);
       try {
@@ -246,20 +289,13 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
         task.base->not_done.notify_all();
       }
     } else {
-      // If it's a task initiated from this thread, decrease the counter, but
-      // don't do anything - loop condition will do all checks for us next.
-      if (base_owner == worker_device) {
-        --task.base->outstanding_tasks;
-      // Otherwise send a dummy function task to the owning thread just to
-      // ensure that it's not sleeping. If it has work, it might see that
-      // graph_task->outstanding_tasks == 0 before it gets to the task, but
-      // it's a no-op anyway.
-      } else if (base_owner != worker_device) {
-        if (--task.base->outstanding_tasks == 0) {
-          // Synchronize outstanding_tasks with queue mutex
-          std::atomic_thread_fence(std::memory_order_release);
-          ready_queue(base_owner).push(FunctionTask(task.base, nullptr, InputBuffer(0)));
-        }
+      // The owning thread may be waiting in pop, on another device's queue or
+      // on this one if it is another CPU worker. If it is this thread, the
+      // loop condition will do all checks for us next, and the notification
+      // only wakes up idle workers. task.base may be gone once the counter
+      // drops to zero.
+      if (--task.base->outstanding_tasks == 0) {
+        ready_queue(base_owner).notify_waiters();
       }
     }
   }
@@ -344,9 +380,22 @@ static void validate_outputs(const edge_list& edges, variable_list& grads, const
   }
 }
 
+struct CurrentGraphTaskGuard {
+  explicit CurrentGraphTaskGuard(GraphTask* graph_task)
+    : prev_graph_task(current_graph_task) {
+    current_graph_task = graph_task;
+  }
+  ~CurrentGraphTaskGuard() {
+    current_graph_task = prev_graph_task;
+  }
+
+  GraphTask* prev_graph_task;
+};
+
 static variable_list call_function(FunctionTask& task) {
   bool prev_checkpoint_valid_state = checkpoint_valid;
   checkpoint_valid = task.base->can_checkpoint() && prev_checkpoint_valid_state;
+  CurrentGraphTaskGuard graph_task_guard(task.base);
   auto& fn = *task.fn;
   auto inputs = call_pre_hooks(fn, InputBuffer::variables(std::move(task.inputs)));
 
@@ -378,6 +427,15 @@ static variable_list call_function(FunctionTask& task) {
   return outputs;
 }
 
+bool is_edge_needed_by_current_task(const Edge& edge) {
+  if (!current_graph_task || current_graph_task->exec_info.empty()) {
+    return true;
+  }
+  auto& exec_info = current_graph_task->exec_info;
+  auto it = exec_info.find(edge.function.get());
+  return it != exec_info.end() && it->second.should_execute();
+}
+
 auto Engine::evaluate_function(FunctionTask& task) -> void {
   // If exec_info is not empty, we have to instrument the execution
   auto & exec_info = task.base->exec_info;
@@ -402,12 +460,21 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
   int num_outputs = outputs.size();
   if (num_outputs == 0) return; // Don't even acquire the mutex
 
+  std::vector<GraphTask::AnomalyFlag> anomaly_flags;
   if (AnomalyMode::is_enabled()) {
     AutoGradMode grad_mode(false);
     for (int i = 0; i < num_outputs; ++i) {
       auto& output = outputs[i];
+      if (!output.defined()) continue;
       at::DeviceGuard guard(output);
-      if (output.defined() && output.ne(output).any().item<uint8_t>()) {
+      if (AnomalyMode::is_lightweight()) {
+        // x * 0 is 0 for finite values and nan for nan and inf, so the sum is
+        // an exact flag, and computing it doesn't wait for the device
+        if (!output.is_sparse() && at::isFloatingType(output.type().scalarType())) {
+          anomaly_flags.push_back(
+              {task.fn, i, output.mul(0).sum(at::kFloat)});
+        }
+      } else if (output.ne(output).any().item<uint8_t>()) {
         std::stringstream ss;
         ss << "Function '" << fn.name() << "' returned nan values in its " << i << "th output.";
         throw std::runtime_error(ss.str());
@@ -416,6 +483,9 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
   }
 
   std::lock_guard<std::mutex> lock(task.base->mutex);
+  for (auto& flag : anomaly_flags) {
+    task.base->anomaly_flags.push_back(std::move(flag));
+  }
   for (int i = 0; i < num_outputs; ++i) {
     auto& output = outputs[i];
     const auto& next = fn.next_edge(i);
@@ -448,7 +518,7 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
       InputBuffer input_buffer(next.function->num_inputs());
       input_buffer.add(next.input_nr, std::move(output));
       if (is_ready) {
-        auto& queue = ready_queue(input_buffer.device());
+        auto& queue = ready_queue(*task.base, input_buffer.device());
         queue.push(FunctionTask(task.base, next.function, std::move(input_buffer)));
       } else {
         not_ready.emplace(next.function.get(), std::move(input_buffer));
@@ -458,7 +528,7 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
       auto &input_buffer = not_ready_it->second;
       input_buffer.add(next.input_nr, std::move(output));
       if (is_ready) {
-        auto& queue = ready_queue(input_buffer.device());
+        auto& queue = ready_queue(*task.base, input_buffer.device());
         queue.push(FunctionTask(task.base, next.function, std::move(input_buffer)));
         not_ready.erase(not_ready_it);
       }
@@ -487,6 +557,49 @@ auto Engine::compute_dependencies(Function* root, GraphTask& task) -> void {
   }
 }
 
+// Reads the flags recorded by the functions of the task in lightweight anomaly
+// mode, with one copy to the host per device, and reports the first function
+// that returned nan or inf values.
+static void check_anomaly_flags(GraphTask& graph_task) {
+  auto& flags = graph_task.anomaly_flags;
+  if (flags.empty()) return;
+  AutoGradMode grad_mode(false);
+  std::map<int, std::vector<size_t>> flags_by_device;
+  for (size_t i = 0; i < flags.size(); ++i) {
+    flags_by_device[flags[i].flag.is_cuda() ? flags[i].flag.get_device() : -1]
+        .push_back(i);
+  }
+  size_t first_bad = flags.size();
+  for (const auto& device_flags : flags_by_device) {
+    std::vector<at::Tensor> values;
+    for (auto i : device_flags.second) {
+      values.push_back(flags[i].flag);
+    }
+    auto stacked = at::stack(values).cpu();
+    auto host_values = as_variable_ref(stacked).data();
+    const float* data = host_values.data<float>();
+    for (size_t j = 0; j < device_flags.second.size(); ++j) {
+      if (data[j] != 0) {
+        first_bad = std::min(first_bad, device_flags.second[j]);
+        break;
+      }
+    }
+  }
+  if (first_bad < flags.size()) {
+    const auto& bad = flags[first_bad];
+    std::stringstream ss;
+    ss << "Function '" << bad.fn->name() << "' returned nan or inf values in its "
+       << bad.output_nr << "th output.";
+    auto callsite = bad.fn->metadata()->callsite();
+    if (!callsite.empty()) {
+      ss << " It was created by:\n  " << callsite;
+    }
+    flags.clear();
+    throw std::runtime_error(ss.str());
+  }
+  flags.clear();
+}
+
 struct ClearCallbacks {
   ClearCallbacks(std::vector<std::function<void()>>& callbacks,
                  std::mutex &callbacks_lock)
@@ -548,6 +661,7 @@ auto Engine::execute(const edge_list& roots,
   if (graph_task.has_error.load()) {
     std::rethrow_exception(graph_task.exception);
   }
+  check_anomaly_flags(graph_task);
 
   if (!graph_task.not_ready.empty()) {
     throw std::runtime_error("could not compute gradients for some functions");
@@ -569,6 +683,52 @@ auto Engine::execute(const edge_list& roots,
   return graph_task.captured_vars;
 }
 
+auto Engine::execute_inline(const edge_list& roots,
+                            const variable_list& inputs,
+                            bool keep_graph,
+                            bool create_graph) -> void {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  validate_outputs(roots, const_cast<variable_list&>(inputs), [](const std::string& msg) {
+    return msg;
+  });
+
+  GraphTask graph_task(keep_graph, create_graph);
+  graph_task.owner = worker_device;
+  graph_task.local_ready_queue.reset(new ReadyQueue());
+  auto& queue = *graph_task.local_ready_queue;
+
+  auto graph_root = std::make_shared<GraphRoot>(roots, inputs);
+  compute_dependencies(graph_root.get(), graph_task);
+  queue.push(FunctionTask(&graph_task, std::move(graph_root), InputBuffer(0)));
+
+  // Only this thread runs the task, so the queue can't be empty while there
+  // are outstanding tasks.
+  bool prev_grad_mode = GradMode::is_enabled();
+  while (graph_task.outstanding_tasks > 0) {
+    FunctionTask task = queue.pop(nullptr);
+    if (!graph_task.has_error.load()) {
+      GradMode::set_enabled(graph_task.grad_mode);
+      at::DeviceGuard guard(task.inputs.device());
+      try {
+        evaluate_function(task);
+      } catch (std::exception& e) {
+        thread_on_exception(task, e);
+      }
+    }
+    --graph_task.outstanding_tasks;
+  }
+  GradMode::set_enabled(prev_grad_mode);
+
+  if (graph_task.has_error.load()) {
+    std::rethrow_exception(graph_task.exception);
+  }
+  check_anomaly_flags(graph_task);
+
+  if (!graph_task.not_ready.empty()) {
+    throw std::runtime_error("could not compute gradients for some functions");
+  }
+}
+
 // note that when python is present, this base engine will be overriden
 // with a PythonEngine. Because this typically happens before get_default_engine
 // is called, this base engine will never be created.
@@ -601,6 +761,13 @@ auto Engine::ready_queue(int device) -> ReadyQueue& {
   return *ready_queues.at(device + 1);
 }
 
+auto Engine::ready_queue(GraphTask& graph_task, int device) -> ReadyQueue& {
+  if (graph_task.local_ready_queue) {
+    return *graph_task.local_ready_queue;
+  }
+  return ready_queue(device);
+}
+
 auto Engine::start_threads() -> void {
   int num_devices = 0;
 #ifdef USE_CUDA
@@ -610,15 +777,44 @@ auto Engine::start_threads() -> void {
     num_devices = 0;
   }
 #endif
-  // One for CPU, plus one for every GPU device
-  int num_threads = num_devices + 1;
-  ready_queues = std::vector<std::shared_ptr<ReadyQueue>>(num_threads);
+  // One queue for CPU, plus one for every GPU device
+  int num_queues = num_devices + 1;
+  ready_queues = std::vector<std::shared_ptr<ReadyQueue>>(num_queues);
   for (auto& queue : ready_queues)
     queue.reset(new ReadyQueue());
-  for (int i = 0; i < num_threads; ++i) {
+  for (int i = 1; i < num_queues; ++i) {
     std::thread t(&Engine::thread_init, this, i - 1);
     t.detach();
   }
+  std::lock_guard<std::mutex> lock(cpu_threads_mutex);
+  threads_started = true;
+  start_cpu_threads(num_cpu_threads_);
+}
+
+auto Engine::start_cpu_threads(int num_threads) -> void {
+  // all of them serve the CPU queue
+  for (; num_started_cpu_threads < num_threads; ++num_started_cpu_threads) {
+    std::thread t(&Engine::thread_init, this, -1);
+    t.detach();
+  }
+}
+
+void Engine::set_num_cpu_threads(int num_threads) {
+  AT_CHECK(num_threads > 0, "the number of autograd CPU threads has to be positive, got ", num_threads);
+  std::lock_guard<std::mutex> lock(cpu_threads_mutex);
+  if (threads_started) {
+    // the workers never exit, so their number can only grow
+    AT_CHECK(num_threads >= num_started_cpu_threads,
+             "the number of autograd CPU threads can't be reduced once a backward pass has been run (",
+             num_started_cpu_threads, " threads are running)");
+    start_cpu_threads(num_threads);
+  }
+  num_cpu_threads_ = num_threads;
+}
+
+int Engine::num_cpu_threads() {
+  std::lock_guard<std::mutex> lock(cpu_threads_mutex);
+  return num_cpu_threads_;
 }
 
 void GraphTask::init_to_execute(Function& graph_root, const edge_list& outputs) {
@@ -43,6 +43,16 @@ struct TORCH_API Engine {
       bool keep_graph,
       bool create_graph,
       const edge_list& outputs = {});
+  // Like execute with no outputs (i.e. backward()), but runs every function
+  // on the calling thread instead of handing it to the worker of its device,
+  // and doesn't run the callbacks registered with queue_callback. Functions
+  // that run a backward pass of their own from within apply, like
+  // CheckpointFunction, use it to avoid a reentrant execute.
+  void execute_inline(
+      const edge_list& roots,
+      const variable_list& inputs,
+      bool keep_graph,
+      bool create_graph);
   virtual std::unique_ptr<AnomalyMetadata> make_anomaly_metadata() {
     return nullptr;
   }
@@ -51,11 +61,23 @@ struct TORCH_API Engine {
 
   bool is_checkpoint_valid();
 
+  // Sets the number of worker threads that run functions on the CPU. They
+  // share one ready queue, so independent parts of a backward graph run in
+  // parallel. The default is 1. With more threads, the order in which
+  // gradients flowing into the same function are summed is no longer fixed.
+  // The number can't be reduced after the first backward pass.
+  void set_num_cpu_threads(int num_threads);
+  int num_cpu_threads();
+
 protected:
   void compute_dependencies(Function* root, GraphTask& task);
   void evaluate_function(FunctionTask& task);
   ReadyQueue& ready_queue(int device);
+  ReadyQueue& ready_queue(GraphTask& graph_task, int device);
   void start_threads();
+  // Starts CPU workers until there are num_threads of them. Requires
+  // cpu_threads_mutex to be held.
+  void start_cpu_threads(int num_threads);
   virtual void thread_init(int device);
   virtual void thread_main(GraphTask *graph_task);
   virtual void thread_on_exception(FunctionTask& task, std::exception& e);
@@ -64,6 +86,10 @@ protected:
   std::vector<std::shared_ptr<ReadyQueue>> ready_queues;
   std::vector<std::function<void()>> final_callbacks;
   std::mutex post_callbacks_lock;
+  std::mutex cpu_threads_mutex;
+  int num_cpu_threads_ = 1;
+  int num_started_cpu_threads = 0;
+  bool threads_started = false;
 };
 
 // allow python_engine to override the default engine when it loads
@@ -7,6 +7,7 @@
 #include <ATen/ATen.h>
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <stdexcept>
@@ -29,6 +30,78 @@ uint64_t& Function::get_next_sequence_nr() {
   return Function_next_sequence_nr_;
 }
 
+namespace {
+
+// Blocks are binned into size classes of kFunctionPoolGranularity bytes. Larger
+// requests go straight to operator new, and each thread keeps at most
+// kFunctionPoolMaxCached free blocks per class.
+constexpr size_t kFunctionPoolGranularity = 16;
+constexpr size_t kFunctionPoolMaxSize = 512;
+constexpr size_t kFunctionPoolMaxCached = 4096;
+
+struct FunctionPool {
+  ~FunctionPool();
+  std::array<std::vector<void*>, kFunctionPoolMaxSize / kFunctionPoolGranularity> free_lists;
+};
+
+thread_local FunctionPool function_pool;
+// Functions can still be freed while thread locals are destroyed at thread
+// exit, after function_pool is gone.
+thread_local bool function_pool_destroyed = false;
+
+FunctionPool::~FunctionPool() {
+  function_pool_destroyed = true;
+  for (auto& free_list : free_lists) {
+    for (void* ptr : free_list) {
+      ::operator delete(ptr);
+    }
+  }
+}
+
+// The size class of `size`, or -1 if it isn't pooled
+int64_t function_pool_bin(size_t size) {
+  if (size == 0 || size > kFunctionPoolMaxSize) {
+    return -1;
+  }
+  return (size - 1) / kFunctionPoolGranularity;
+}
+
+} // anonymous namespace
+
+void* allocate_function_memory(size_t size) {
+  auto bin = function_pool_bin(size);
+  if (bin < 0) {
+    return ::operator new(size);
+  }
+  // Always the full size of the class, because the block may be cached by
+  // another thread when it's freed
+  if (function_pool_destroyed || function_pool.free_lists[bin].empty()) {
+    return ::operator new((bin + 1) * kFunctionPoolGranularity);
+  }
+  auto& free_list = function_pool.free_lists[bin];
+  void* ptr = free_list.back();
+  free_list.pop_back();
+  return ptr;
+}
+
+void free_function_memory(void* ptr, size_t size) noexcept {
+  auto bin = function_pool_bin(size);
+  if (bin < 0 || function_pool_destroyed) {
+    ::operator delete(ptr);
+    return;
+  }
+  auto& free_list = function_pool.free_lists[bin];
+  if (free_list.size() >= kFunctionPoolMaxCached) {
+    ::operator delete(ptr);
+    return;
+  }
+  try {
+    free_list.push_back(ptr);
+  } catch (const std::bad_alloc&) {
+    ::operator delete(ptr);
+  }
+}
+
 auto Function::name() const -> std::string {
   return c10::demangle(typeid(*this).name());
 }
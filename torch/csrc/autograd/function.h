@@ -36,6 +36,47 @@ using IndexRange = std::pair<size_t, size_t>;
 // Custom deleter to prevent stack overflows.
 void deleteFunction(Function* function);
 
+// Memory for `Function`s, and for the control blocks of the shared_ptrs that
+// own them (see `FunctionAllocator`), comes from small thread local free
+// lists. Building a graph allocates a node per differentiable op, and nodes
+// are only a few distinct sizes, so from the second iteration of a training
+// loop on the nodes reuse the blocks freed by the previous iteration's graph.
+// Blocks may be freed on a different thread than the one that allocated them.
+TORCH_API void* allocate_function_memory(size_t size);
+TORCH_API void free_function_memory(void* ptr, size_t size) noexcept;
+
+/// An allocator for the control blocks of `std::shared_ptr<Function>`s, e.g.
+/// `std::shared_ptr<T>(new T(), deleteFunction, FunctionAllocator<T>())`.
+template <typename T>
+struct FunctionAllocator {
+  using value_type = T;
+  FunctionAllocator() = default;
+  template <typename U>
+  FunctionAllocator(const FunctionAllocator<U>&) {}
+  T* allocate(size_t n) {
+    return static_cast<T*>(allocate_function_memory(n * sizeof(T)));
+  }
+  void deallocate(T* ptr, size_t n) noexcept {
+    free_function_memory(ptr, n * sizeof(T));
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const FunctionAllocator<T>&, const FunctionAllocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const FunctionAllocator<T>&, const FunctionAllocator<U>&) {
+  return false;
+}
+
+// Whether the backward pass that is running a function on this thread needs
+// the gradient that flows along `edge`. It doesn't for edges that lead to
+// parts of the graph that torch.autograd.grad() doesn't execute. Defined in
+// engine.cpp.
+TORCH_API bool is_edge_needed_by_current_task(const Edge& edge);
+
 ///~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 ///                               Function
 ///~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -96,7 +137,11 @@ struct TORCH_API Function : std::enable_shared_from_this<Function> {
       : sequence_nr_(sequence_nr),
       next_edges_(std::move(next_edges)) {
     if (AnomalyMode::is_enabled()) {
-      metadata()->store_stack();
+      if (AnomalyMode::is_lightweight()) {
+        metadata()->store_callsite();
+      } else {
+        metadata()->store_stack();
+      }
     }
   }
 
@@ -110,6 +155,18 @@ struct TORCH_API Function : std::enable_shared_from_this<Function> {
   Function& operator=(Function&& other) = delete;
   virtual ~Function() = default;
 
+  /// See `allocate_function_memory`.
+  static void* operator new(size_t size) {
+    return allocate_function_memory(size);
+  }
+  static void* operator new(size_t size, void* ptr) noexcept {
+    return ptr;
+  }
+  static void operator delete(void* ptr, size_t size) noexcept {
+    free_function_memory(ptr, size);
+  }
+  static void operator delete(void* ptr, void* place) noexcept {}
+
   /// Evaluates the function on the given inputs and returns the result of the
   /// function call.
   variable_list operator()(variable_list&& inputs) {
@@ -211,10 +268,12 @@ struct TORCH_API Function : std::enable_shared_from_this<Function> {
   virtual std::string name() const;
 
   /// Returns true if the particular output edge is active, and that particular
-  /// output of this function should be computed.
+  /// output of this function should be computed, i.e. the backward pass that
+  /// runs this function uses it.
   bool should_compute_output(size_t output_edge_index) const {
     AT_CHECK(output_edge_index < num_outputs(), "Index out of range");
-    return next_edges_[output_edge_index].is_valid();
+    const auto& edge = next_edges_[output_edge_index];
+    return edge.is_valid() && is_edge_needed_by_current_task(edge);
   }
 
   /// Returns true if any of the output edges in any of the ranges are active.
@@ -386,6 +445,8 @@ edge_list collect_next_edges(Variables&&... variables) {
   if (!GradMode::is_enabled())
     return {};
   detail::MakeNextFunctionList make;
+  // Exact unless some of the arguments are lists of variables
+  make.next_edges.reserve(sizeof...(Variables));
   make.apply(std::forward<Variables>(variables)...);
   return std::move(make.next_edges);
 }
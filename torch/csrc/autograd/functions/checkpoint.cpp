@@ -0,0 +1,93 @@
+#include "torch/csrc/autograd/functions/checkpoint.h"
+
+#include "torch/csrc/autograd/engine.h"
+#include "torch/csrc/autograd/functions/utils.h"
+#include "torch/csrc/autograd/grad_mode.h"
+
+#include <c10/util/Exception.h>
+
+#include <memory>
+#include <utility>
+
+namespace torch { namespace autograd {
+
+variable_list checkpoint(checkpoint_function_type fn, const variable_list& inputs) {
+  if (!compute_requires_grad(inputs)) {
+    return fn(inputs);
+  }
+  auto grad_fn = std::make_shared<CheckpointFunction>(fn, inputs);
+  variable_list outputs;
+  {
+    AutoGradMode no_grad(false);
+    outputs = fn(inputs);
+    // fn may return one of its inputs, whose history must be kept
+    for (auto& output : outputs) {
+      if (output.defined()) {
+        output = output.detach();
+      }
+    }
+  }
+  set_history(outputs, grad_fn);
+  return outputs;
+}
+
+CheckpointFunction::CheckpointFunction(checkpoint_function_type fn, const variable_list& inputs)
+  : Function(collect_next_edges(inputs))
+  , fn_(std::move(fn)) {
+  saved_inputs_.reserve(inputs.size());
+  for (const auto& input : inputs) {
+    saved_inputs_.emplace_back(input, /*is_output=*/false);
+  }
+}
+
+variable_list CheckpointFunction::apply(variable_list&& grads) {
+  AT_CHECK(Engine::get_default_engine().is_checkpoint_valid(),
+           "checkpoint() is not compatible with torch.autograd.grad(), use backward() instead");
+
+  // Recompute with leaves in place of the inputs, so that the backward pass
+  // of the new graph stops at them.
+  variable_list inputs;
+  inputs.reserve(saved_inputs_.size());
+  for (const auto& saved : saved_inputs_) {
+    Variable input = saved.unpack();
+    inputs.push_back(input.defined() ? make_variable(input.data(), input.requires_grad()) : input);
+  }
+  variable_list outputs;
+  {
+    AutoGradMode enable_grad(true);
+    outputs = fn_(inputs);
+  }
+  AT_CHECK(outputs.size() == grads.size(), "checkpointed function returned ", outputs.size(),
+           " outputs when it was recomputed, but ", grads.size(), " the first time");
+
+  edge_list roots;
+  variable_list root_grads;
+  for (size_t i = 0; i < outputs.size(); i++) {
+    if (outputs[i].defined() && outputs[i].requires_grad() && grads[i].defined()) {
+      roots.push_back(outputs[i].gradient_edge());
+      root_grads.push_back(std::move(grads[i]));
+    }
+  }
+  // Gradients of the new graph are accumulated into the leaves made above and
+  // into the leaves fn uses, like parameters. grad mode is enabled here if
+  // the enclosing pass creates a graph.
+  if (!roots.empty()) {
+    Engine::get_default_engine().execute_inline(
+        roots, root_grads, /*keep_graph=*/false, /*create_graph=*/GradMode::is_enabled());
+  }
+
+  variable_list grad_inputs;
+  grad_inputs.reserve(inputs.size());
+  for (const auto& input : inputs) {
+    grad_inputs.push_back(input.defined() && input.requires_grad() ? input.grad() : Variable());
+  }
+  return grad_inputs;
+}
+
+void CheckpointFunction::release_variables() {
+  for (auto& saved : saved_inputs_) {
+    saved.reset_data();
+  }
+}
+
+}} // namespace torch::autograd
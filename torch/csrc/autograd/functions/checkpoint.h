@@ -0,0 +1,42 @@
+#pragma once
+
+#include "torch/csrc/WindowsTorchApiMacro.h"
+#include "torch/csrc/autograd/function.h"
+#include "torch/csrc/autograd/saved_variable.h"
+#include "torch/csrc/autograd/variable.h"
+
+#include <functional>
+#include <vector>
+
+namespace torch { namespace autograd {
+
+using checkpoint_function_type = std::function<variable_list(const variable_list&)>;
+
+// Runs fn(inputs) without recording a graph and returns its outputs. When
+// they are differentiated, fn is run again with grad mode enabled and the
+// gradients are computed through the graph that records, which trades the
+// memory held by the intermediate results of fn for an extra forward pass.
+//
+// Every tensor that fn uses and that requires grad has to either be a leaf
+// (e.g. a parameter, whose gradient is accumulated as usual) or be passed in
+// inputs. Gradients can only be computed with backward(), not with
+// torch.autograd.grad(). fn is run again as is, so ops that use random
+// numbers give different values the second time.
+TORCH_API variable_list checkpoint(checkpoint_function_type fn, const variable_list& inputs);
+
+// The grad_fn of the outputs of checkpoint(). The recomputed graph is
+// differentiated by Engine::execute_inline, on the thread that runs this
+// function, as part of the enclosing backward pass.
+struct TORCH_API CheckpointFunction : public Function {
+  CheckpointFunction(checkpoint_function_type fn, const variable_list& inputs);
+
+  variable_list apply(variable_list&& grads) override;
+
+  void release_variables() override;
+
+private:
+  checkpoint_function_type fn_;
+  std::vector<SavedVariable> saved_inputs_;
+};
+
+}} // namespace torch::autograd
@@ -3,6 +3,7 @@
 #include "torch/csrc/Exceptions.h"
 #include "torch/csrc/utils/pybind.h"
 #include "torch/csrc/autograd/grad_mode.h"
+#include "torch/csrc/autograd/offload_hooks.h"
 #include "torch/csrc/autograd/profiler.h"
 #include "torch/csrc/autograd/python_function.h"
 #include "torch/csrc/autograd/function.h"
@@ -35,21 +36,56 @@ PyObject * THPAutograd_initExtension(PyObject *_unused)
       .def("cpu_elapsed_us", &torch::autograd::profiler::Event::cpu_elapsed_us)
       .def(
           "cuda_elapsed_us", &torch::autograd::profiler::Event::cuda_elapsed_us)
-      .def("has_cuda", &torch::autograd::profiler::Event::has_cuda);
+      .def("has_cuda", &torch::autograd::profiler::Event::has_cuda)
+      .def("cpu_memory_usage", &torch::autograd::profiler::Event::cpu_memory_usage)
+      .def("cuda_memory_usage", &torch::autograd::profiler::Event::cuda_memory_usage)
+      .def("cpu_ns", &torch::autograd::profiler::Event::cpu_ns)
+      .def("correlation_id", &torch::autograd::profiler::Event::correlation_id);
   py::enum_<torch::autograd::profiler::ProfilerState>(m,"ProfilerState")
   .value("Disabled", torch::autograd::profiler::ProfilerState::Disabled)
   .value("CPU", torch::autograd::profiler::ProfilerState::CPU)
   .value("CUDA", torch::autograd::profiler::ProfilerState::CUDA)
-  .value("NVTX", torch::autograd::profiler::ProfilerState::NVTX);
-
-  m.def("_enable_profiler", torch::autograd::profiler::enableProfiler);
+  .value("NVTX", torch::autograd::profiler::ProfilerState::NVTX)
+  .value("Sampled", torch::autograd::profiler::ProfilerState::Sampled)
+  .value("CUPTI", torch::autograd::profiler::ProfilerState::CUPTI);
+  py::class_<torch::autograd::profiler::KernelRecord>(m, "KernelRecord")
+      .def_readonly("name", &torch::autograd::profiler::KernelRecord::name)
+      .def_readonly("device", &torch::autograd::profiler::KernelRecord::device)
+      .def_readonly("stream", &torch::autograd::profiler::KernelRecord::stream)
+      .def_readonly("range_id", &torch::autograd::profiler::KernelRecord::range_id)
+      .def_readonly("start_ns", &torch::autograd::profiler::KernelRecord::start_ns)
+      .def_readonly("end_ns", &torch::autograd::profiler::KernelRecord::end_ns);
+  py::class_<torch::autograd::profiler::SampledStats>(m, "SampledStats")
+      .def_readonly("name", &torch::autograd::profiler::SampledStats::name)
+      .def_readonly("count", &torch::autograd::profiler::SampledStats::count)
+      .def_readonly("total_ns", &torch::autograd::profiler::SampledStats::total_ns)
+      .def_readonly("max_ns", &torch::autograd::profiler::SampledStats::max_ns)
+      .def_readonly("histogram", &torch::autograd::profiler::SampledStats::histogram);
+
+  m.def(
+      "_enable_profiler",
+      torch::autograd::profiler::enableProfiler,
+      py::arg("new_state"),
+      py::arg("profile_memory") = false);
   m.def("_disable_profiler", torch::autograd::profiler::disableProfiler);
+  m.def("_enable_sampling", torch::autograd::profiler::enableSampling);
+  m.def("_get_sampled_stats", torch::autograd::profiler::getSampledStats);
+  m.def("_cupti_available", torch::autograd::profiler::cuptiAvailable);
+  m.def("_consume_kernel_records", torch::autograd::profiler::consumeKernelRecords);
 
   m.def("_push_range", [](std::string name) {
     torch::autograd::profiler::pushRange(std::move(name));
   });
   m.def("_pop_range", []() { torch::autograd::profiler::popRange(); });
 
+  m.def("_enable_saved_tensor_offload", [](size_t min_bytes, size_t prefetch) {
+    torch::autograd::set_saved_variable_hooks(
+        std::make_shared<torch::autograd::CUDAOffloadHooks>(min_bytes, prefetch));
+  });
+  m.def("_disable_saved_tensor_offload", []() {
+    torch::autograd::set_saved_variable_hooks(nullptr);
+  });
+
   Py_RETURN_TRUE;
 }
 
@@ -95,12 +131,34 @@ static PyObject * is_anomaly_mode_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * set_anomaly_mode_lightweight(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("lightweight must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  AnomalyMode::set_lightweight(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_anomaly_mode_lightweight(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (AnomalyMode::is_lightweight()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
 // autograd methods on torch._C
 static PyMethodDef methods[] = {
   {"set_grad_enabled", (PyCFunction)set_grad_enabled, METH_O, nullptr},
   {"is_grad_enabled", (PyCFunction)is_grad_enabled, METH_NOARGS, nullptr},
   {"set_anomaly_enabled", (PyCFunction)set_anomaly_mode_enabled, METH_O, nullptr},
   {"is_anomaly_enabled", (PyCFunction)is_anomaly_mode_enabled, METH_NOARGS, nullptr},
+  {"_set_anomaly_lightweight", (PyCFunction)set_anomaly_mode_lightweight, METH_O, nullptr},
+  {"_is_anomaly_lightweight", (PyCFunction)is_anomaly_mode_lightweight, METH_NOARGS, nullptr},
   {nullptr, nullptr, 0, nullptr}
 };
 
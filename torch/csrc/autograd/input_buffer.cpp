@@ -1,6 +1,7 @@
 #include "torch/csrc/autograd/input_buffer.h"
 
 #include "torch/csrc/autograd/functions/basic_ops.h"
+#include "torch/csrc/autograd/grad_mode.h"
 
 #include <ATen/DeviceGuard.h>
 
@@ -10,6 +11,17 @@
 
 namespace torch { namespace autograd {
 
+// Whether the sum can be written into var: nothing else refers to it or to
+// its memory, and its elements don't overlap (as in expanded tensors). In
+// grad mode, var may be needed by the graph of a higher order derivative.
+static bool can_accumulate_into(const Variable& var) {
+  return !GradMode::is_enabled()
+      && !var.type().is_sparse()
+      && !var.requires_grad()
+      && var.is_contiguous()
+      && var.use_count() == 1
+      && var.storage().use_count() == 1;
+}
 
 void InputBuffer::add(size_t pos, Variable var) {
   AT_ASSERT(pos < buffer.size());
@@ -21,8 +33,15 @@ void InputBuffer::add(size_t pos, Variable var) {
     buffer[pos] = std::move(var);
   } else {
     at::DeviceGuard device_guard(var);
+    // Most gradients are temporaries, so the sum usually doesn't need a new
+    // buffer.
+    if (can_accumulate_into(old_var)) {
+      old_var.add_(var);
+    } else if (can_accumulate_into(var)) {
+      var.add_(old_var);
+      buffer[pos] = std::move(var);
     // ATen doesn't route sparse additions correctly...
-    if (old_var.type().is_sparse()) {
+    } else if (old_var.type().is_sparse()) {
       buffer[pos] = var + old_var;
     } else {
       buffer[pos] = old_var + var;
@@ -0,0 +1,178 @@
+#include "torch/csrc/autograd/offload_hooks.h"
+
+#include <ATen/DeviceGuard.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+#include <c10/util/Exception.h>
+
+#ifdef USE_CUDA
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAEvent.h>
+#include <ATen/cuda/CUDAGuard.h>
+#include <THC/THC.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+
+namespace torch { namespace autograd {
+
+#ifdef USE_CUDA
+
+namespace {
+
+// Makes `stream` wait for the work queued so far on the current stream of its
+// device.
+void wait_current(const at::cuda::CUDAStream& stream) {
+  at::cuda::CUDAEvent event;
+  event.record(at::cuda::getCurrentCUDAStream(stream.device()));
+  event.block(stream);
+}
+
+// Keeps the memory of `tensor` from being handed out again before the work
+// queued on `stream` is done.
+void record_use(const at::Tensor& tensor, const at::cuda::CUDAStream& stream) {
+  THCCachingAllocator_recordStream(tensor.storage().data(), stream.internals());
+}
+
+} // anonymous namespace
+
+struct CUDAOffloadHooks::State {
+  struct Entry {
+    Entry(const at::Tensor& packed, int64_t device)
+      : packed(packed), device(device) {}
+
+    at::WeakTensor packed;
+    int64_t device;
+    // The copy back to the device, while it is in flight
+    at::Tensor prefetched;
+    at::cuda::CUDAEvent ready;
+  };
+
+  bool alive(const Entry& entry) const {
+    return entry.packed.use_count() > 0;
+  }
+
+  at::cuda::CUDAStream& side_stream(int64_t device) {
+    auto it = side_streams.find(device);
+    if (it == side_streams.end()) {
+      it = side_streams.emplace(device, at::cuda::createCUDAStream(/*isHighPriority=*/false, device)).first;
+    }
+    return it->second;
+  }
+
+  void copy_back(Entry& entry) {
+    if (entry.prefetched.defined()) {
+      return;
+    }
+    auto packed = entry.packed.lock();
+    if (!packed.defined()) {
+      return;
+    }
+    at::DeviceGuard device_guard(entry.device);
+    auto& stream = side_stream(entry.device);
+    entry.prefetched = at::empty(packed.sizes(), packed.options().device(at::Device(at::kCUDA, entry.device)));
+    // the memory may still be in use by work queued on the current stream
+    wait_current(stream);
+    {
+      at::cuda::CUDAGuard stream_guard(stream);
+      entry.prefetched.copy_(packed, /*non_blocking=*/true);
+    }
+    record_use(entry.prefetched, stream);
+    entry.ready.record(stream);
+  }
+
+  // In the order the tensors were saved. Entries die with the SavedVariables
+  // that hold their tensor, which mostly happens in the order of the deque.
+  std::deque<Entry> entries;
+  std::unordered_map<int64_t, at::cuda::CUDAStream> side_streams;
+};
+
+CUDAOffloadHooks::CUDAOffloadHooks(size_t min_bytes, size_t prefetch)
+  : min_bytes_(min_bytes)
+  , prefetch_(prefetch)
+  , state_(new State()) {}
+
+CUDAOffloadHooks::~CUDAOffloadHooks() = default;
+
+at::Tensor CUDAOffloadHooks::pack(const at::Tensor& data) {
+  if (!data.is_cuda() || data.numel() * data.type().elementSizeInBytes() < min_bytes_) {
+    return data;
+  }
+  const int64_t device = data.get_device();
+  at::DeviceGuard device_guard(device);
+  auto src = data.contiguous();
+  auto* allocator = at::detail::getCUDAHooks().getPinnedMemoryAllocator();
+  auto packed = src.type().toBackend(at::Backend::CPU).tensorWithAllocator(src.sizes(), src.strides(), allocator);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& stream = state_->side_stream(device);
+  wait_current(stream);
+  {
+    at::cuda::CUDAGuard stream_guard(stream);
+    packed.copy_(src, /*non_blocking=*/true);
+  }
+  record_use(src, stream);
+
+  auto& entries = state_->entries;
+  while (!entries.empty() && !state_->alive(entries.front())) {
+    entries.pop_front();
+  }
+  entries.emplace_back(packed, device);
+  return packed;
+}
+
+at::Tensor CUDAOffloadHooks::unpack(const at::Tensor& packed) {
+  if (packed.is_cuda()) {
+    return packed;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& entries = state_->entries;
+  while (!entries.empty() && !state_->alive(entries.back())) {
+    entries.pop_back();
+  }
+  auto it = std::find_if(entries.rbegin(), entries.rend(), [&](const State::Entry& entry) {
+    return entry.packed.is_same(packed);
+  });
+  // a CPU tensor that was never offloaded
+  if (it == entries.rend()) {
+    return packed;
+  }
+
+  state_->copy_back(*it);
+  for (auto next = it + 1; next != entries.rend() && next - it <= static_cast<ptrdiff_t>(prefetch_); ++next) {
+    state_->copy_back(*next);
+  }
+
+  at::DeviceGuard device_guard(it->device);
+  it->ready.block(at::cuda::getCurrentCUDAStream(it->device));
+  at::Tensor result = std::move(it->prefetched);
+  it->prefetched.reset();
+  return result;
+}
+
+#else
+
+struct CUDAOffloadHooks::State {};
+
+CUDAOffloadHooks::CUDAOffloadHooks(size_t min_bytes, size_t prefetch)
+  : min_bytes_(min_bytes)
+  , prefetch_(prefetch) {
+  AT_ERROR("offloading saved tensors is only supported in CUDA environments");
+}
+
+CUDAOffloadHooks::~CUDAOffloadHooks() = default;
+
+at::Tensor CUDAOffloadHooks::pack(const at::Tensor& data) {
+  return data;
+}
+
+at::Tensor CUDAOffloadHooks::unpack(const at::Tensor& packed) {
+  return packed;
+}
+
+#endif
+
+}} // namespace torch::autograd
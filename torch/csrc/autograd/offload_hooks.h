@@ -0,0 +1,36 @@
+#pragma once
+
+#include "torch/csrc/WindowsTorchApiMacro.h"
+#include "torch/csrc/autograd/saved_variable.h"
+
+#include <ATen/ATen.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace torch { namespace autograd {
+
+/// `SavedVariableHooks` that move saved CUDA tensors to pinned host memory.
+/// The copies to the host run on a side stream per device, so the forward pass
+/// doesn't wait for them. When the backward pass unpacks a tensor, it is copied
+/// back, and so are the `prefetch` tensors saved right before it, which the
+/// backward pass usually needs next, so that their copies overlap with the
+/// computation in between. Tensors smaller than `min_bytes` stay on the device.
+struct TORCH_API CUDAOffloadHooks : public SavedVariableHooks {
+  explicit CUDAOffloadHooks(size_t min_bytes = 1 << 20, size_t prefetch = 2);
+  ~CUDAOffloadHooks() override;
+
+  at::Tensor pack(const at::Tensor& data) override;
+  at::Tensor unpack(const at::Tensor& packed) override;
+
+ private:
+  struct State;
+
+  size_t min_bytes_;
+  size_t prefetch_;
+  std::mutex mutex_;
+  std::unique_ptr<State> state_;
+};
+
+}} // namespace torch::autograd
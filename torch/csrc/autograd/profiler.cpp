@@ -1,7 +1,16 @@
 #include "torch/csrc/autograd/profiler.h"
+#include "torch/csrc/autograd/profiler_cupti.h"
 #include "torch/csrc/autograd/function.h"
 
+#include <c10/util/Exception.h>
+#include <c10/util/Type.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace torch { namespace autograd { namespace profiler {
 
@@ -11,6 +20,8 @@ std::mutex all_event_lists_mutex;
 std::list<std::shared_ptr<RangeEventList>> all_event_lists;
 thread_local std::shared_ptr<RangeEventList> event_list;
 thread_local uint16_t thread_id;
+// The correlation ids of the ranges recorded in the CUPTI mode
+std::atomic<uint64_t> next_correlation_id{1};
 
 RangeEventList& getEventList() {
   if (!event_list) {
@@ -22,8 +33,131 @@ RangeEventList& getEventList() {
   return *event_list;
 }
 
+bool profilerEnabled() {
+  return state != ProfilerState::Disabled;
+}
+
+namespace {
+
+struct SampledRange {
+  // nullptr if the range isn't timed
+  const char* name;
+  int64_t start_ns;
+};
+
+struct ThreadSamples {
+  // Taken by this thread only to add a sample, so it is contended only while
+  // getSampledStats runs.
+  std::mutex mutex;
+  std::unordered_map<const char*, SampledStats> stats;
+
+  // The rest is only used by the thread itself.
+  std::vector<SampledRange> open_ranges;
+  uint64_t generation = 0;
+  int64_t until_next_sample = 0;
+  int64_t last_sample_ns = 0;
+};
+
+int64_t sampling_period = 1;
+int64_t sampling_interval_ns = 0;
+// Incremented by enableSampling, so that ranges left open by an earlier
+// sampling run are dropped.
+uint64_t sampling_generation = 0;
+std::mutex all_thread_samples_mutex;
+std::list<std::shared_ptr<ThreadSamples>> all_thread_samples;
+thread_local std::shared_ptr<ThreadSamples> thread_samples;
+std::mutex interned_names_mutex;
+std::unordered_set<std::string> interned_names;
+
+ThreadSamples& getThreadSamples() {
+  if (!thread_samples) {
+    std::lock_guard<std::mutex> guard(all_thread_samples_mutex);
+    thread_samples = std::make_shared<ThreadSamples>();
+    all_thread_samples.emplace_front(thread_samples);
+  }
+  auto& samples = *thread_samples;
+  if (samples.generation != sampling_generation) {
+    samples.open_ranges.clear();
+    samples.generation = sampling_generation;
+    samples.until_next_sample = 0;
+    samples.last_sample_ns = 0;
+  }
+  return samples;
+}
+
+const char* internName(const char* name) { return name; }
+// NB: non-const to disallow temporaries (lifetime issues)
+const char* internName(std::string& name) {
+  std::lock_guard<std::mutex> guard(interned_names_mutex);
+  return interned_names.insert(name).first->c_str();
+}
+
+bool shouldSample(ThreadSamples& samples) {
+  if (sampling_interval_ns > 0) {
+    auto now = getTime();
+    if (now - samples.last_sample_ns < sampling_interval_ns) {
+      return false;
+    }
+    samples.last_sample_ns = now;
+    return true;
+  }
+  if (--samples.until_next_sample > 0) {
+    return false;
+  }
+  samples.until_next_sample = sampling_period;
+  return true;
+}
+
+template<typename T>
+void pushSampledRange(T& name) {
+  auto& samples = getThreadSamples();
+  if (shouldSample(samples)) {
+    samples.open_ranges.push_back({internName(name), getTime()});
+  } else {
+    samples.open_ranges.push_back({nullptr, 0});
+  }
+}
+
+void popSampledRange() {
+  auto& samples = getThreadSamples();
+  // the range was pushed before sampling was enabled
+  if (samples.open_ranges.empty()) {
+    return;
+  }
+  auto range = samples.open_ranges.back();
+  samples.open_ranges.pop_back();
+  if (!range.name) {
+    return;
+  }
+  int64_t duration_ns = getTime() - range.start_ns;
+  std::lock_guard<std::mutex> guard(samples.mutex);
+  samples.stats[range.name].add(duration_ns);
+}
+
+} // anonymous namespace
+
+void SampledStats::add(int64_t duration_ns) {
+  count++;
+  total_ns += duration_ns;
+  max_ns = std::max(max_ns, duration_ns);
+  size_t bucket = 0;
+  for (int64_t d = duration_ns; d > 1 && bucket + 1 < num_buckets; d >>= 1) {
+    bucket++;
+  }
+  histogram[bucket]++;
+}
+
+void SampledStats::merge(const SampledStats& other) {
+  count += other.count;
+  total_ns += other.total_ns;
+  max_ns = std::max(max_ns, other.max_ns);
+  for (size_t i = 0; i < num_buckets; i++) {
+    histogram[i] += other.histogram[i];
+  }
+}
+
 void mark(std::string name, bool include_cuda /* = true */) {
-  if (state == ProfilerState::Disabled) {
+  if (state == ProfilerState::Disabled || state == ProfilerState::Sampled) {
     return;
   }
   if (state == ProfilerState::NVTX) {
@@ -51,7 +185,9 @@ void pushRangeImpl(T name, const char* msg="", int64_t sequence_nr=-1) {
   if (state == ProfilerState::Disabled) {
     return;
   }
-  if (state == ProfilerState::NVTX) {
+  if (state == ProfilerState::Sampled) {
+    pushSampledRange(name);
+  } else if (state == ProfilerState::NVTX) {
 #ifdef USE_CUDA
     if(sequence_nr >= 0) {
       std::stringstream s;
@@ -65,11 +201,15 @@ void pushRangeImpl(T name, const char* msg="", int64_t sequence_nr=-1) {
         "pushRange called with NVTX tracing, but compiled without CUDA");
 #endif
   } else {
-    getEventList().record(
+    auto& event = getEventList().record(
         EventKind::PushRange,
         std::move(name),
         thread_id,
         state == ProfilerState::CUDA);
+    if (state == ProfilerState::CUPTI) {
+      event.setCorrelationId(next_correlation_id++);
+      pushCuptiCorrelationId(event.correlation_id());
+    }
   }
 }
 
@@ -81,7 +221,9 @@ void popRange() {
   if (state == ProfilerState::Disabled) {
     return;
   }
-  if (state == ProfilerState::NVTX) {
+  if (state == ProfilerState::Sampled) {
+    popSampledRange();
+  } else if (state == ProfilerState::NVTX) {
 #ifdef USE_CUDA
     nvtxRangePop();
 #else
@@ -89,6 +231,9 @@ void popRange() {
         "popRange called with NVTX tracing, but compiled without CUDA");
 #endif
   } else {
+    if (state == ProfilerState::CUPTI) {
+      popCuptiCorrelationId();
+    }
     getEventList().record(
         EventKind::PopRange,
         "",
@@ -117,6 +262,16 @@ RecordFunction::RecordFunction(const char* name, int64_t current_sequence_nr)
   pushRangeImpl<const char*>(name, ", seq=", current_sequence_nr);
 }
 
+static void recordMemoryUsage(int64_t nbytes, at::Device device) {
+  if (state == ProfilerState::Disabled || state == ProfilerState::NVTX ||
+      state == ProfilerState::Sampled) {
+    return;
+  }
+  getEventList()
+      .record(EventKind::MemoryAlloc, "[memory]", thread_id, /*record_cuda=*/false)
+      .setMemoryUsage(nbytes, device);
+}
+
 #ifdef USE_CUDA
 static void onEachDevice(std::function<void(int)> op) {
   at::DeviceGuard device_guard;
@@ -129,15 +284,23 @@ static void onEachDevice(std::function<void(int)> op) {
 }
 #endif
 
-void enableProfiler(ProfilerState new_state) {
+void enableProfiler(ProfilerState new_state, bool profile_memory) {
   AT_ASSERT(new_state != ProfilerState::Disabled);
+  AT_CHECK(new_state != ProfilerState::Sampled, "use enableSampling to start sampling");
 #ifndef USE_CUDA
   if (new_state == ProfilerState::NVTX)
     throw std::runtime_error("Can't use NVTX profiler - PyTorch was compiled without CUDA");
 #endif
+  if (new_state == ProfilerState::CUPTI && !cuptiAvailable())
+    throw std::runtime_error("Can't use CUPTI profiler - PyTorch was compiled without CUPTI");
   if (state != ProfilerState::Disabled && new_state != state) {
       throw std::runtime_error("can't change kind of profiling (e.g. NVTX to CPU) while profiler is running");
   }
+  if (new_state == ProfilerState::CUPTI && state != ProfilerState::CUPTI) {
+    // Unlike the CUDA mode, this doesn't record events around every range,
+    // so it adds no work to the streams and no synchronization.
+    enableCuptiTracing();
+  }
   state = new_state;
 
 #ifdef USE_CUDA
@@ -160,6 +323,9 @@ void enableProfiler(ProfilerState new_state) {
   }
 #endif
   mark("__start_profile", false);
+  if (profile_memory && state != ProfilerState::NVTX) {
+    at::setReportMemoryUsageHook(&recordMemoryUsage);
+  }
 }
 
 thread_event_lists disableProfiler() {
@@ -168,8 +334,17 @@ thread_event_lists disableProfiler() {
   }
   ProfilerState old_state = state;
   mark("__stop_profile");
+  at::setReportMemoryUsageHook(nullptr);
   state = ProfilerState::Disabled;
-  if (old_state == ProfilerState::NVTX) {
+#ifdef USE_CUDA
+  if (old_state == ProfilerState::CUPTI) {
+    onEachDevice([](int d) {
+        TORCH_CUDA_CHECK(cudaDeviceSynchronize());
+    });
+    disableCuptiTracing();
+  }
+#endif
+  if (old_state == ProfilerState::NVTX || old_state == ProfilerState::Sampled) {
     return thread_event_lists();
   } else {
     thread_event_lists result;
@@ -190,4 +365,47 @@ thread_event_lists disableProfiler() {
   }
 }
 
+void enableSampling(int64_t every_n_ranges, int64_t interval_ns) {
+  AT_CHECK(every_n_ranges > 0, "expected a positive sampling period, got ", every_n_ranges);
+  AT_CHECK(interval_ns >= 0, "expected a non-negative sampling interval, got ", interval_ns);
+  if (state != ProfilerState::Disabled) {
+    throw std::runtime_error("can't change kind of profiling (e.g. NVTX to CPU) while profiler is running");
+  }
+  sampling_period = every_n_ranges;
+  sampling_interval_ns = interval_ns;
+  sampling_generation++;
+  state = ProfilerState::Sampled;
+}
+
+std::vector<SampledStats> getSampledStats(bool reset) {
+  // Names that are the same string but different pointers are merged
+  std::map<std::string, SampledStats> by_name;
+  std::lock_guard<std::mutex> guard(all_thread_samples_mutex);
+  for (auto it = all_thread_samples.begin(); it != all_thread_samples.end();) {
+    auto& samples = **it;
+    {
+      std::lock_guard<std::mutex> samples_guard(samples.mutex);
+      for (auto& entry : samples.stats) {
+        by_name[c10::demangle(entry.first)].merge(entry.second);
+      }
+      if (reset) {
+        samples.stats.clear();
+      }
+    }
+    // GC the samples of threads that exited, once they have been reported
+    if (reset && it->use_count() == 1) {
+      it = all_thread_samples.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  std::vector<SampledStats> result;
+  result.reserve(by_name.size());
+  for (auto& entry : by_name) {
+    entry.second.name = entry.first;
+    result.push_back(std::move(entry.second));
+  }
+  return result;
+}
+
 }}}
@@ -51,7 +51,8 @@ inline int64_t getTime() {
 enum class EventKind : uint16_t {
   Mark,
   PushRange,
-  PopRange
+  PopRange,
+  MemoryAlloc, // bytes allocated (or freed, if negative) by the current range
 };
 
 struct Event final {
@@ -83,6 +84,7 @@ struct Event final {
       case EventKind::Mark: return "mark";
       case EventKind::PushRange: return "push";
       case EventKind::PopRange: return "pop";
+      case EventKind::MemoryAlloc: return "memory_alloc";
     }
     throw std::runtime_error("unknown EventKind");
   }
@@ -122,6 +124,30 @@ struct Event final {
   int device() const {
     return device_;
   }
+  void setMemoryUsage(int64_t nbytes, at::Device device) {
+    if (device.is_cuda()) {
+      cuda_memory_usage_ = nbytes;
+      device_ = device.index();
+    } else {
+      cpu_memory_usage_ = nbytes;
+    }
+  }
+  int64_t cpu_memory_usage() const {
+    return cpu_memory_usage_;
+  }
+  int64_t cuda_memory_usage() const {
+    return cuda_memory_usage_;
+  }
+  int64_t cpu_ns() const {
+    return cpu_ns_;
+  }
+  // Nonzero for the PushRange events of the CUPTI mode, see KernelRecord
+  uint64_t correlation_id() const {
+    return correlation_id_;
+  }
+  void setCorrelationId(uint64_t correlation_id) {
+    correlation_id_ = correlation_id;
+  }
 private:
   int64_t cpu_ns_; // signed to allow for negative intervals
   // std::string is a very large object (usually around 32B),
@@ -132,6 +158,9 @@ private:
   EventKind kind_;
   uint16_t thread_id_;
   int device_ = -1;
+  int64_t cpu_memory_usage_ = 0;
+  int64_t cuda_memory_usage_ = 0;
+  uint64_t correlation_id_ = 0;
 #ifdef USE_CUDA
   cudaEvent_t event = nullptr;
 #endif
@@ -162,11 +191,12 @@ struct RangeEventList {
   }
 
   template<typename... Args>
-  void record(Args&&... args) {
+  Event& record(Args&&... args) {
     if (blocks.empty() || blocks.front().size() == num_block_elements) {
       allocBlock();
     }
     blocks.front().emplace_back(std::forward<Args>(args)...);
+    return blocks.front().back();
   }
 
   std::vector<Event> consolidate() {
@@ -188,9 +218,13 @@ enum class ProfilerState {
     CPU, // CPU-only profiling
     CUDA, // CPU + CUDA events
     NVTX,  // only emit NVTX markers
+    Sampled, // time some of the ranges and aggregate them, see enableSampling
+    CUPTI, // CPU + the kernels, memcpys and memsets traced by CUPTI
 };
 
 TORCH_API RangeEventList& getEventList();
+// Cheap check for callers that have to do some work to name their ranges.
+TORCH_API bool profilerEnabled();
 TORCH_API void mark(std::string name, bool include_cuda = true);
 TORCH_API void pushRange(std::string name);
 TORCH_API void popRange();
@@ -212,8 +246,59 @@ struct TORCH_API RecordFunction {
 using thread_event_lists = std::vector<std::vector<Event>>;
 // NOTE: changing profiler modes is **NOT THREAD SAFE**. You should ensure that
 // there no autograd functions are being executed when these function are used.
-TORCH_API void enableProfiler(ProfilerState new_state);
+// With profile_memory, the CPU and CUDA allocations are recorded as
+// MemoryAlloc events of the thread that makes them, which belong to the
+// innermost range that is open on that thread.
+TORCH_API void enableProfiler(ProfilerState new_state, bool profile_memory = false);
 TORCH_API thread_event_lists disableProfiler();
 
+// A kernel, memcpy or memset that ran while the profiler was in the CUPTI
+// mode. Its times are on the clock of getTime(), and range_id is the
+// correlation_id of the innermost range that was open on the thread that
+// launched it, or 0 if there was none.
+struct TORCH_API KernelRecord {
+  std::string name;
+  int device;
+  uint32_t stream;
+  uint64_t range_id;
+  int64_t start_ns;
+  int64_t end_ns;
+};
+
+// Whether PyTorch was compiled with CUPTI, which the CUPTI mode needs.
+TORCH_API bool cuptiAvailable();
+// The records of the last run of the profiler in the CUPTI mode. They are
+// gathered by disableProfiler, and cleared by this call.
+TORCH_API std::vector<KernelRecord> consumeKernelRecords();
+
+// Aggregated durations of the sampled ranges with one name.
+struct TORCH_API SampledStats {
+  // histogram[i] counts the durations in [2^i, 2^(i+1)) ns
+  static constexpr size_t num_buckets = 40;
+
+  SampledStats() : histogram(num_buckets) {}
+  void add(int64_t duration_ns);
+  void merge(const SampledStats& other);
+
+  std::string name;
+  uint64_t count = 0;
+  int64_t total_ns = 0;
+  int64_t max_ns = 0;
+  std::vector<uint64_t> histogram;
+};
+
+// Starts profiling in the Sampled mode, which is cheap enough to be left on.
+// Instead of recording every range, each thread times one range in
+// every_n_ranges, or, if interval_ns is positive, the first range that starts
+// interval_ns after the previous sample, and adds its duration to per-thread
+// statistics. Names are kept as pointers, so ranges named with a std::string
+// are interned when they are sampled; others have to stay valid, like string
+// literals and Symbol names do. Stop it with disableProfiler, which returns no
+// events.
+TORCH_API void enableSampling(int64_t every_n_ranges, int64_t interval_ns = 0);
+// The statistics gathered by all threads since sampling was enabled or the
+// last reset, summed over the threads. May be called while sampling.
+TORCH_API std::vector<SampledStats> getSampledStats(bool reset = false);
+
 } // namespace profiler
 }} // namespace torch::autograd
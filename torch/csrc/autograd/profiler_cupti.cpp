@@ -0,0 +1,214 @@
+#include "torch/csrc/autograd/profiler_cupti.h"
+#include "torch/csrc/autograd/profiler.h"
+
+#include <c10/util/Exception.h>
+
+#ifdef USE_CUPTI
+#include <cupti.h>
+
+#include <cstdlib>
+#include <unordered_map>
+#include <utility>
+#endif
+
+namespace torch { namespace autograd { namespace profiler {
+
+namespace {
+
+std::mutex records_mutex;
+std::vector<KernelRecord> kernel_records;
+
+#ifdef USE_CUPTI
+
+#define TORCH_CUPTI_CHECK(call)                                  \
+  do {                                                           \
+    CUptiResult status = (call);                                 \
+    if (status != CUPTI_SUCCESS) {                               \
+      const char* message;                                       \
+      cuptiGetResultString(status, &message);                    \
+      AT_ERROR("CUPTI error: ", message, " (", #call, ")");      \
+    }                                                            \
+  } while (0)
+
+// CUPTI hands the activities back in these buffers, from its own thread
+constexpr size_t kBufferSize = 8 * 1024 * 1024;
+
+const CUpti_ActivityKind kTracedKinds[] = {
+    CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL,
+    CUPTI_ACTIVITY_KIND_MEMCPY,
+    CUPTI_ACTIVITY_KIND_MEMSET,
+    CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION,
+};
+
+// The activities are matched to the ranges only once tracing stops, because
+// the external correlation of an activity may be delivered after it.
+// Both are guarded by records_mutex.
+std::vector<std::pair<uint32_t, KernelRecord>> pending_records;
+std::unordered_map<uint32_t, uint64_t> range_ids;
+// getTime() - cuptiGetTimestamp(), measured when tracing starts
+int64_t clock_offset_ns = 0;
+
+const char* memcpyName(uint8_t copy_kind) {
+  switch (copy_kind) {
+    case CUPTI_ACTIVITY_MEMCPY_KIND_HTOD: return "Memcpy HtoD";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_DTOH: return "Memcpy DtoH";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_DTOD: return "Memcpy DtoD";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_PTOP: return "Memcpy PtoP";
+    default: return "Memcpy";
+  }
+}
+
+void addRecord(
+    std::string name,
+    uint32_t device,
+    uint32_t stream,
+    uint32_t correlation_id,
+    uint64_t start_ns,
+    uint64_t end_ns) {
+  pending_records.emplace_back(
+      correlation_id,
+      KernelRecord{std::move(name),
+                   static_cast<int>(device),
+                   stream,
+                   0,
+                   static_cast<int64_t>(start_ns),
+                   static_cast<int64_t>(end_ns)});
+}
+
+void CUPTIAPI bufferRequested(uint8_t** buffer, size_t* size, size_t* max_num_records) {
+  // malloc is aligned enough for the records
+  *buffer = static_cast<uint8_t*>(malloc(kBufferSize));
+  *size = *buffer ? kBufferSize : 0;
+  *max_num_records = 0;
+}
+
+void CUPTIAPI bufferCompleted(
+    CUcontext context,
+    uint32_t stream_id,
+    uint8_t* buffer,
+    size_t size,
+    size_t valid_size) {
+  std::lock_guard<std::mutex> guard(records_mutex);
+  CUpti_Activity* record = nullptr;
+  while (cuptiActivityGetNextRecord(buffer, valid_size, &record) == CUPTI_SUCCESS) {
+    switch (record->kind) {
+      case CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL: {
+        auto kernel = reinterpret_cast<CUpti_ActivityKernel4*>(record);
+        addRecord(kernel->name, kernel->deviceId, kernel->streamId,
+                  kernel->correlationId, kernel->start, kernel->end);
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_MEMCPY: {
+        auto memcpy = reinterpret_cast<CUpti_ActivityMemcpy*>(record);
+        addRecord(memcpyName(memcpy->copyKind), memcpy->deviceId, memcpy->streamId,
+                  memcpy->correlationId, memcpy->start, memcpy->end);
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_MEMSET: {
+        auto memset = reinterpret_cast<CUpti_ActivityMemset*>(record);
+        addRecord("Memset", memset->deviceId, memset->streamId,
+                  memset->correlationId, memset->start, memset->end);
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION: {
+        auto correlation = reinterpret_cast<CUpti_ActivityExternalCorrelation*>(record);
+        range_ids[correlation->correlationId] = correlation->externalId;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  free(buffer);
+}
+
+#endif // USE_CUPTI
+
+} // anonymous namespace
+
+#ifdef USE_CUPTI
+
+bool cuptiAvailable() {
+  return true;
+}
+
+void enableCuptiTracing() {
+  {
+    std::lock_guard<std::mutex> guard(records_mutex);
+    kernel_records.clear();
+    pending_records.clear();
+    range_ids.clear();
+  }
+  TORCH_CUPTI_CHECK(cuptiActivityRegisterCallbacks(bufferRequested, bufferCompleted));
+  for (auto kind : kTracedKinds) {
+    TORCH_CUPTI_CHECK(cuptiActivityEnable(kind));
+  }
+  uint64_t gpu_ns;
+  TORCH_CUPTI_CHECK(cuptiGetTimestamp(&gpu_ns));
+  clock_offset_ns = getTime() - static_cast<int64_t>(gpu_ns);
+}
+
+void disableCuptiTracing() {
+  // The caller has synchronized the devices, so every activity is complete
+  TORCH_CUPTI_CHECK(cuptiActivityFlushAll(0));
+  for (auto kind : kTracedKinds) {
+    TORCH_CUPTI_CHECK(cuptiActivityDisable(kind));
+  }
+  std::lock_guard<std::mutex> guard(records_mutex);
+  kernel_records.reserve(pending_records.size());
+  for (auto& pending : pending_records) {
+    auto& record = pending.second;
+    auto it = range_ids.find(pending.first);
+    record.range_id = it == range_ids.end() ? 0 : it->second;
+    record.start_ns += clock_offset_ns;
+    record.end_ns += clock_offset_ns;
+    kernel_records.push_back(std::move(record));
+  }
+  pending_records.clear();
+  range_ids.clear();
+}
+
+void pushCuptiCorrelationId(uint64_t correlation_id) {
+  cuptiActivityPushExternalCorrelationId(
+      CUPTI_EXTERNAL_CORRELATION_KIND_UNKNOWN, correlation_id);
+}
+
+void popCuptiCorrelationId() {
+  // Fails harmlessly for the ranges pushed before tracing started
+  uint64_t correlation_id;
+  cuptiActivityPopExternalCorrelationId(
+      CUPTI_EXTERNAL_CORRELATION_KIND_UNKNOWN, &correlation_id);
+}
+
+#else
+
+bool cuptiAvailable() {
+  return false;
+}
+
+void enableCuptiTracing() {
+  AT_ERROR("Can't use the CUPTI profiler - PyTorch was compiled without CUPTI");
+}
+
+void disableCuptiTracing() {
+  AT_ERROR("Can't use the CUPTI profiler - PyTorch was compiled without CUPTI");
+}
+
+void pushCuptiCorrelationId(uint64_t correlation_id) {
+  AT_ERROR("Can't use the CUPTI profiler - PyTorch was compiled without CUPTI");
+}
+
+void popCuptiCorrelationId() {
+  AT_ERROR("Can't use the CUPTI profiler - PyTorch was compiled without CUPTI");
+}
+
+#endif // USE_CUPTI
+
+std::vector<KernelRecord> consumeKernelRecords() {
+  std::lock_guard<std::mutex> guard(records_mutex);
+  std::vector<KernelRecord> result;
+  std::swap(result, kernel_records);
+  return result;
+}
+
+}}} // namespace torch::autograd::profiler
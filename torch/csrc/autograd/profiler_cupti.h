@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+// Internal to the profiler: the CUPTI activity tracing behind
+// ProfilerState::CUPTI. All of these throw when compiled without CUPTI.
+
+namespace torch { namespace autograd { namespace profiler {
+
+// Starts recording the kernels, memcpys and memsets of all the devices.
+void enableCuptiTracing();
+// Waits for the recorded activities, stops recording and keeps the records
+// for consumeKernelRecords.
+void disableCuptiTracing();
+// The activities launched by this thread until the matching pop are
+// attributed to the range with this correlation id.
+void pushCuptiCorrelationId(uint64_t correlation_id);
+void popCuptiCorrelationId();
+
+}}} // namespace torch::autograd::profiler
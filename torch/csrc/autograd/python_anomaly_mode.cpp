@@ -5,10 +5,73 @@
 #include "torch/csrc/utils/object_ptr.h"
 #include "torch/csrc/Exceptions.h"
 
+#include <frameobject.h>
+
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
 
 namespace torch { namespace autograd {
 
+namespace {
+
+// The frames recorded by store_callsite, interned by code object and line.
+// The code objects are kept alive so that their addresses are never reused.
+struct CallsiteTable {
+  struct KeyHash {
+    size_t operator()(const std::pair<PyObject*, int>& key) const {
+      return std::hash<PyObject*>()(key.first) * 31 + key.second;
+    }
+  };
+
+  std::mutex mutex;
+  std::unordered_map<std::pair<PyObject*, int>, int, KeyHash> ids;
+  std::vector<std::string> callsites;
+};
+
+CallsiteTable& callsite_table() {
+  static CallsiteTable* table = new CallsiteTable();
+  return *table;
+}
+
+} // namespace
+
+void PyAnomalyMetadata::store_callsite() {
+  AutoGIL gil;
+  PyFrameObject* frame = PyEval_GetFrame();
+  if (!frame) {
+    return;
+  }
+  PyObject* code = reinterpret_cast<PyObject*>(frame->f_code);
+  int line = PyCode_Addr2Line(frame->f_code, frame->f_lasti);
+  auto& table = callsite_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto it = table.ids.find(std::make_pair(code, line));
+  if (it != table.ids.end()) {
+    callsite_ = it->second;
+    return;
+  }
+  std::ostringstream ss;
+  ss << "File \"" << THPUtils_unpackString(frame->f_code->co_filename)
+     << "\", line " << line << ", in "
+     << THPUtils_unpackString(frame->f_code->co_name);
+  Py_INCREF(code);
+  callsite_ = table.callsites.size();
+  table.callsites.push_back(ss.str());
+  table.ids.emplace(std::make_pair(code, line), callsite_);
+}
+
+std::string PyAnomalyMetadata::callsite() {
+  if (callsite_ < 0) {
+    return "";
+  }
+  auto& table = callsite_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.callsites[callsite_];
+}
+
 void PyAnomalyMetadata::store_stack() {
   AutoGIL gil;
   THPObjectPtr mod(PyImport_ImportModule("traceback"));
@@ -33,6 +96,10 @@ void PyAnomalyMetadata::print_stack() {
   }
 
   THPObjectPtr stack(PyDict_GetItemString(dict(), ANOMALY_TRACE_KEY));
+  if (!stack && callsite_ >= 0) {
+    AT_WARN("Forward call that caused the error:\n  ", callsite());
+    return;
+  }
   if (!stack) {
     AT_WARN("No forward pass information available. Enable detect anomaly "
             "during forward pass for more information.");
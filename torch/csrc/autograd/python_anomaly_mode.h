@@ -1,6 +1,7 @@
 #pragma once
 
 #include "torch/csrc/autograd/anomaly_mode.h"
+#include "torch/csrc/Exceptions.h"
 #include "torch/csrc/python_headers.h"
 #include "torch/csrc/utils/auto_gil.h"
 
@@ -9,23 +10,34 @@ namespace torch { namespace autograd {
 struct PyAnomalyMetadata : public AnomalyMetadata {
   static constexpr char* ANOMALY_TRACE_KEY = "traceback_";
 
-  PyAnomalyMetadata() {
-    AutoGIL gil;
-    dict_ = PyDict_New();
-  }
+  PyAnomalyMetadata() = default;
   ~PyAnomalyMetadata() {
-    AutoGIL gil;
-    Py_DECREF(dict_);
+    if (dict_) {
+      AutoGIL gil;
+      Py_DECREF(dict_);
+    }
   }
   virtual void store_stack() override;
   virtual void print_stack() override;
+  virtual void store_callsite() override;
+  virtual std::string callsite() override;
 
+  // Created on first use, so that lightweight mode doesn't allocate it.
+  // Requires the GIL.
   PyObject* dict() {
+    if (!dict_) {
+      dict_ = PyDict_New();
+      if (!dict_) {
+        throw python_error();
+      }
+    }
     return dict_;
   }
 
 private:
-  PyObject* dict_;
+  PyObject* dict_ = nullptr;
+  // Index of the interned frame recorded by store_callsite
+  int callsite_ = -1;
 };
 
 }}
@@ -8,6 +8,7 @@
 #include "torch/csrc/autograd/edge.h"
 #include "torch/csrc/autograd/python_function.h"
 #include "torch/csrc/utils/auto_gil.h"
+#include "torch/csrc/utils/python_numbers.h"
 
 #ifndef _WIN32
 #include <pthread.h>
@@ -211,6 +212,23 @@ PyObject* THPEngine_is_checkpoint_valid(PyObject *self) {
   END_HANDLE_TH_ERRORS
 }
 
+PyObject* THPEngine_set_num_cpu_threads(PyObject *self, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "set_num_cpu_threads expects an int, "
+          "but got %s", THPUtils_typename(arg));
+  _maybe_reinitialize_engine_after_fork();
+  engine.set_num_cpu_threads(THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject* THPEngine_num_cpu_threads(PyObject *self) {
+  HANDLE_TH_ERRORS
+  _maybe_reinitialize_engine_after_fork();
+  return THPUtils_packInt64(engine.num_cpu_threads());
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject *THPEngine_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
 {
   return type->tp_alloc(type, 0);
@@ -220,6 +238,8 @@ static struct PyMethodDef THPEngine_methods[] = {
   {(char*)"run_backward", (PyCFunction)THPEngine_run_backward, METH_VARARGS | METH_KEYWORDS, nullptr},
   {(char*)"queue_callback", (PyCFunction)THPEngine_queue_callback, METH_O, nullptr},
   {(char*)"is_checkpoint_valid", (PyCFunction)THPEngine_is_checkpoint_valid, METH_NOARGS, nullptr},
+  {(char*)"set_num_cpu_threads", (PyCFunction)THPEngine_set_num_cpu_threads, METH_O, nullptr},
+  {(char*)"num_cpu_threads", (PyCFunction)THPEngine_num_cpu_threads, METH_NOARGS, nullptr},
   {nullptr}
 };
 
@@ -24,7 +24,10 @@ THP_API PyObject * THPVariable_Wrap(torch::autograd::Variable var);
 
 inline bool THPVariable_Check(PyObject *obj)
 {
-  return THPVariableClass && PyObject_IsInstance(obj, THPVariableClass);
+  // Exact torch.Tensor instances, the common case, skip isinstance()
+  return THPVariableClass &&
+      (Py_TYPE(obj) == (PyTypeObject*)THPVariableClass ||
+       PyObject_IsInstance(obj, THPVariableClass));
 }
 
 inline torch::autograd::Variable& THPVariable_Unpack(PyObject* obj) {
@@ -9,9 +9,22 @@
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <utility>
 
 namespace torch { namespace autograd {
 
+namespace {
+thread_local std::shared_ptr<SavedVariableHooks> saved_variable_hooks;
+} // anonymous namespace
+
+void set_saved_variable_hooks(std::shared_ptr<SavedVariableHooks> hooks) {
+  saved_variable_hooks = std::move(hooks);
+}
+
+const std::shared_ptr<SavedVariableHooks>& get_saved_variable_hooks() {
+  return saved_variable_hooks;
+}
+
 SavedVariable::SavedVariable(const Variable& variable, bool is_output) {
   if (variable.defined()) {
     was_default_constructed_ = false;
@@ -21,6 +34,10 @@ SavedVariable::SavedVariable(const Variable& variable, bool is_output) {
     // These copies are all shared_ptr copies, so slightly more expensive.
     // Do them here instead of in the init list in case data is undefined.
     data_ = variable.data();
+    if (saved_variable_hooks) {
+      hooks_ = saved_variable_hooks;
+      data_ = hooks_->pack(data_);
+    }
     if (variable.is_leaf()) {
       grad_accumulator_ = variable.grad_accumulator();
     } else if (!is_output) {
@@ -55,14 +72,16 @@ Variable SavedVariable::unpack(std::shared_ptr<Function> saved_for) const {
     grad_fn = std::move(saved_for);
   }
 
+  at::Tensor data = hooks_ ? hooks_->unpack(data_) : data_;
+
   // NB: saved views are unpacked as normal Variables (not views) even though
   // they still share the same storage. This works only because we never call
   // in-place functions on unpacked variables.
   Variable var;
   if (grad_fn) {
-    var = make_variable(data_, Edge(std::move(grad_fn), output_nr_));
+    var = make_variable(data, Edge(std::move(grad_fn), output_nr_));
   } else {
-    var = make_variable(data_, requires_grad_);
+    var = make_variable(data, requires_grad_);
   }
   var.set_version_counter(saved_version_);
 
@@ -16,6 +16,22 @@ struct Function;
 
 TORCH_API extern const char* ERR_BACKWARD_TWICE;
 
+/// Decides how `SavedVariable`s keep their data until the backward pass, e.g.
+/// to move it out of device memory. `pack` is called with the data of every
+/// variable saved on a thread while the hooks are set for it, and `unpack`
+/// with what `pack` returned, from the thread that runs the backward pass.
+/// `unpack` has to return a tensor equal to the one `pack` got.
+struct TORCH_API SavedVariableHooks {
+  virtual ~SavedVariableHooks() = default;
+  virtual at::Tensor pack(const at::Tensor& data) = 0;
+  virtual at::Tensor unpack(const at::Tensor& packed) = 0;
+};
+
+/// Sets the hooks used by the `SavedVariable`s created on this thread from now
+/// on. The default, nullptr, keeps the data as it is.
+TORCH_API void set_saved_variable_hooks(std::shared_ptr<SavedVariableHooks> hooks);
+TORCH_API const std::shared_ptr<SavedVariableHooks>& get_saved_variable_hooks();
+
 /// A snapshot of a variable at a certain version. A `SavedVariable` stores
 /// enough information to reconstruct a variable from a certain point in time.
 class TORCH_API SavedVariable {
@@ -31,6 +47,7 @@ class TORCH_API SavedVariable {
   Variable unpack(std::shared_ptr<Function> saved_for = nullptr) const;
 
   void reset_data() {
+    hooks_.reset();
     return data_.reset();
   }
 
@@ -39,7 +56,9 @@ class TORCH_API SavedVariable {
   }
 
  private:
+  // What hooks_->pack returned, if there are hooks.
   at::Tensor data_;
+  std::shared_ptr<SavedVariableHooks> hooks_;
 
   // The gradient function associated with this node. If has_grad_fn
   // is false, then this is a leaf node. Note that the grad_fn is not saved if
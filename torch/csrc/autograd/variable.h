@@ -430,7 +430,7 @@ inline Variable make_variable(at::Tensor data, bool requires_grad = false) {
       !data.is_variable(),
       "Must not create a new variable from a variable, use its .data()");
   if (data.defined()) {
-    return Variable(c10::make_intrusive<Variable::Impl>(data, requires_grad));
+    return Variable(c10::make_intrusive<Variable::Impl>(std::move(data), requires_grad));
   }
   return Variable();
 }
@@ -440,7 +440,8 @@ inline Variable make_variable(at::Tensor data, Edge gradient_edge) {
       !data.is_variable(),
       "Must not create a new variable from a variable, use its .data()");
   if (data.defined()) {
-    return Variable(c10::make_intrusive<Variable::Impl>(data, false, std::move(gradient_edge)));
+    return Variable(c10::make_intrusive<Variable::Impl>(
+        std::move(data), false, std::move(gradient_edge)));
   }
   return Variable();
 }
@@ -1,7 +1,9 @@
 #include "torch/csrc/python_headers.h"
 
 #include <stdbool.h>
+#include <limits>
 #include <unordered_map>
+#include <vector>
 #include <thread>
 #include <chrono>
 #include <sstream>
@@ -288,6 +290,95 @@ PyObject * THCPModule_maxMemoryCached(PyObject *_unused, PyObject *arg)
   END_HANDLE_TH_ERRORS
 }
 
+PyObject * THCPModule_setMaxSplitSize(PyObject *_unused, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  if (arg == Py_None) {
+    THCCachingAllocator_setMaxSplitSize(std::numeric_limits<size_t>::max());
+    Py_RETURN_NONE;
+  }
+  THPUtils_assert(THPUtils_checkLong(arg), "invalid argument to set_max_split_size");
+  int64_t size = THPUtils_unpackLong(arg);
+  THPUtils_assert(size > 0, "max split size must be positive, but got %lld", (long long) size);
+  THCCachingAllocator_setMaxSplitSize((size_t) size);
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
+PyObject * THCPModule_maxSplitSize(PyObject *_unused)
+{
+  HANDLE_TH_ERRORS
+  size_t size = THCCachingAllocator_maxSplitSize();
+  if (size == std::numeric_limits<size_t>::max()) {
+    Py_RETURN_NONE;
+  }
+  return PyLong_FromSize_t(size);
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject * THCPModule_memorySnapshot(PyObject *_unused)
+{
+  HANDLE_TH_ERRORS
+  std::vector<THCCachingAllocatorSegmentInfo> segments;
+  THCCachingAllocator_snapshot(&segments);
+  py::list result;
+  for (const auto& segment : segments) {
+    py::list blocks;
+    for (const auto& block : segment.blocks) {
+      py::dict block_dict;
+      block_dict["size"] = block.size;
+      block_dict["state"] = block.allocated ? "allocated" : "free";
+      block_dict["backtrace"] = block.backtrace;
+      blocks.append(block_dict);
+    }
+    py::dict segment_dict;
+    segment_dict["device"] = segment.device;
+    segment_dict["address"] = segment.address;
+    segment_dict["total_size"] = segment.total_size;
+    segment_dict["allocated_size"] = segment.allocated_size;
+    segment_dict["stream"] = (uintptr_t) segment.stream;
+    segment_dict["segment_type"] = segment.is_large ? "large" : "small";
+    segment_dict["blocks"] = blocks;
+    result.append(segment_dict);
+  }
+  return result.release().ptr();
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject * THCPModule_recordMemoryHistory(PyObject *_unused, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "invalid argument to record_memory_history");
+  int64_t max_entries = THPUtils_unpackLong(arg);
+  THPUtils_assert(max_entries >= 0, "max_entries must be non-negative, but got %lld",
+                  (long long) max_entries);
+  // 0 stops recording
+  THCCachingAllocator_recordHistory(max_entries > 0, (size_t) max_entries);
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
+PyObject * THCPModule_memoryTrace(PyObject *_unused)
+{
+  HANDLE_TH_ERRORS
+  static const char* action_names[] = {"alloc", "free", "segment_alloc", "segment_free", "oom"};
+  std::vector<THCCachingAllocatorTraceEntry> entries;
+  THCCachingAllocator_trace(&entries);
+  py::list result;
+  for (const auto& entry : entries) {
+    py::dict entry_dict;
+    entry_dict["action"] = action_names[entry.action];
+    entry_dict["device"] = entry.device;
+    entry_dict["address"] = entry.address;
+    entry_dict["size"] = entry.size;
+    entry_dict["stream"] = (uintptr_t) entry.stream;
+    entry_dict["backtrace"] = entry.backtrace;
+    result.append(entry_dict);
+  }
+  return result.release().ptr();
+  END_HANDLE_TH_ERRORS
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Cuda module initialization
 ////////////////////////////////////////////////////////////////////////////////
@@ -398,6 +489,11 @@ static struct PyMethodDef _THCPModule_methods[] = {
   {"_cuda_maxMemoryAllocated", (PyCFunction) THCPModule_maxMemoryAllocated, METH_O,  nullptr},
   {"_cuda_memoryCached", (PyCFunction) THCPModule_memoryCached, METH_O,  nullptr},
   {"_cuda_maxMemoryCached", (PyCFunction) THCPModule_maxMemoryCached, METH_O,  nullptr},
+  {"_cuda_setMaxSplitSize", (PyCFunction) THCPModule_setMaxSplitSize, METH_O,  nullptr},
+  {"_cuda_maxSplitSize", (PyCFunction) THCPModule_maxSplitSize, METH_NOARGS,  nullptr},
+  {"_cuda_memorySnapshot", (PyCFunction) THCPModule_memorySnapshot, METH_NOARGS,  nullptr},
+  {"_cuda_recordMemoryHistory", (PyCFunction) THCPModule_recordMemoryHistory, METH_O,  nullptr},
+  {"_cuda_memoryTrace", (PyCFunction) THCPModule_memoryTrace, METH_NOARGS,  nullptr},
   {"_cuda_manualSeed",  (PyCFunction)THCPModule_manualSeed,       METH_O,       nullptr},
   {"_cuda_manualSeedAll", (PyCFunction)THCPModule_manualSeedAll,  METH_O,       nullptr},
   {"_cuda_seed",        (PyCFunction)THCPModule_seed,             METH_NOARGS,  nullptr},
@@ -3,6 +3,7 @@
 #ifdef USE_CUDA
 
 #include <torch/csrc/cuda/device_set.h>
+#include <torch/csrc/utils/functional.h>
 #include <torch/csrc/utils/tensor_flatten.h>
 
 #ifdef USE_NCCL
@@ -11,9 +12,12 @@
 
 #include <ATen/ATen.h>
 #include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAEvent.h>
 #include <ATen/cuda/CUDAGuard.h>
 #include "c10/util/Optional.h"
 
+#include <THC/THCCachingAllocator.h>
+
 #include <cstddef>
 #include <vector>
 
@@ -67,6 +71,89 @@ std::vector<Tensor> broadcast(const Tensor& tensor, IntList devices) {
   return tensors;
 }
 
+// NOTE [ Overlapped broadcast ]
+// broadcast_coalesced and reduce_add_coalesced move every bucket on a side
+// stream per device instead of the current streams. The bucket is flattened on
+// the current stream, the side streams wait for an event recorded after the
+// flatten, and the transfer is queued on them. This lets the transfer of
+// bucket i run while bucket i+1 is flattened, and the current streams wait for
+// the side streams only once, when all buckets have been queued.
+//
+// Two more synchronizations keep this correct. The side streams first wait
+// for all the work already queued on the current streams, because the outputs
+// can reuse memory freed on them. And every buffer that is read on a side
+// stream is recorded with the caching allocator, so it is not handed out
+// again before the transfer is done.
+//
+// With NCCL, the side stream of device i runs the collective for device i.
+// Without it, the copies run on side streams of the source device (one per
+// destination), because a cross-device copy is issued on the source device.
+namespace {
+
+struct SideStreams {
+  SideStreams(IntList devices, bool on_source) {
+    streams.reserve(devices.size());
+    for (auto device : devices) {
+      streams.push_back(at::cuda::createCUDAStream(
+          /*isHighPriority=*/false, on_source ? devices[0] : device));
+    }
+    // The side streams must not start before the outputs are safe to write.
+    for (size_t i = 0; i < devices.size(); ++i) {
+      at::DeviceGuard device_guard(devices[i]);
+      at::cuda::CUDAEvent ready;
+      ready.record(at::cuda::getCurrentCUDAStream(devices[i]));
+      ready.block(streams[i]);
+    }
+  }
+
+  // Makes the side streams wait for the work queued on the current stream of
+  // `device` (the flatten of a bucket).
+  void wait_current(int64_t device) {
+    at::DeviceGuard device_guard(device);
+    at::cuda::CUDAEvent flattened;
+    flattened.record(at::cuda::getCurrentCUDAStream(device));
+    for (auto& stream : streams) {
+      flattened.block(stream);
+    }
+  }
+
+  // Makes side stream i wait for the current stream of devices[i].
+  void wait_current_each(IntList devices) {
+    for (size_t i = 0; i < devices.size(); ++i) {
+      at::DeviceGuard device_guard(devices[i]);
+      at::cuda::CUDAEvent flattened;
+      flattened.record(at::cuda::getCurrentCUDAStream(devices[i]));
+      flattened.block(streams[i]);
+    }
+  }
+
+  std::vector<THCStream*> internals() const {
+    return fmap(streams, [](const at::cuda::CUDAStream& stream) {
+      return stream.internals();
+    });
+  }
+
+  // Keeps `tensor` alive until the work queued on `stream` is done.
+  static void record_use(const at::Tensor& tensor, const at::cuda::CUDAStream& stream) {
+    THCCachingAllocator_recordStream(tensor.storage().data(), stream.internals());
+  }
+
+  // Makes the current stream of every device in `devices` (one per stream)
+  // wait for its side stream.
+  void join(IntList devices) {
+    for (size_t i = 0; i < devices.size(); ++i) {
+      at::DeviceGuard device_guard(streams[i].device());
+      at::cuda::CUDAEvent done;
+      done.record(streams[i]);
+      done.block(at::cuda::getCurrentCUDAStream(devices[i]));
+    }
+  }
+
+  std::vector<at::cuda::CUDAStream> streams;
+};
+
+} // anonymous namespace
+
 tensor_list2d broadcast_coalesced(TensorList tensors, IntList devices, size_t buffer_size) {
   if (!std::all_of(tensors.begin(), tensors.end(),
                    [&](const at::Tensor& t) { return t.get_device() == devices[0]; })) {
@@ -81,6 +168,10 @@ tensor_list2d broadcast_coalesced(TensorList tensors, IntList devices, size_t bu
   for (auto & o : outputs)
     o.reserve(tensors.size());
 
+  // See NOTE [ Overlapped broadcast ]
+  c10::optional<SideStreams> side;
+  bool use_nccl = false;
+
   unique_type_checker type_checker;
   for (auto & chunk : utils::take_tensors(tensors, buffer_size)) {
     auto & type = chunk.type();
@@ -101,8 +192,34 @@ tensor_list2d broadcast_coalesced(TensorList tensors, IntList devices, size_t bu
       }
     } else {
       at::DeviceGuard device_guard(devices[0]);
-      std::vector<Tensor> results = broadcast(utils::flatten_dense_tensors(chunk.tensors),
-                                              devices);
+      auto flat = utils::flatten_dense_tensors(chunk.tensors);
+      if (!side) {
+#ifdef USE_NCCL
+        use_nccl = nccl::is_available({flat});
+#endif
+        side.emplace(devices, /*on_source=*/!use_nccl);
+      }
+      results.reserve(devices.size());
+      results.push_back(flat);
+      for (size_t i = 1, num_devices = devices.size(); i < num_devices; ++i) {
+        device_guard.set_index(devices[i]);
+        results.push_back(at::empty(flat.sizes(), flat.options()));
+      }
+      side->wait_current(devices[0]);
+#ifdef USE_NCCL
+      if (use_nccl) {
+        nccl::broadcast(results, side->internals());
+        SideStreams::record_use(flat, side->streams[0]);
+      }
+#endif
+      if (!use_nccl) {
+        at::cuda::CUDAGuard cuda_guard;
+        for (size_t i = 1, num_devices = devices.size(); i < num_devices; ++i) {
+          cuda_guard.set_stream(side->streams[i]);
+          results[i].copy_(flat, /*non_blocking=*/true);
+          SideStreams::record_use(flat, side->streams[i]);
+        }
+      }
       for (size_t i = 1, num_devices = devices.size(); i < num_devices; ++i) {
         device_guard.set_index(devices[i]);
         auto & device_outputs = outputs[i];
@@ -111,6 +228,9 @@ tensor_list2d broadcast_coalesced(TensorList tensors, IntList devices, size_t bu
       }
     }
   }
+  if (side) {
+    side->join(devices);
+  }
 
   // If we only saw a single tensor type, then we can skip expensive reordering
   if (!type_checker.unique) {
@@ -120,6 +240,105 @@ tensor_list2d broadcast_coalesced(TensorList tensors, IntList devices, size_t bu
   return outputs;
 }
 
+std::vector<at::Tensor> reduce_add_coalesced(const tensor_list2d& inputs,
+                                             int64_t destination,
+                                             size_t buffer_size) {
+  AT_CHECK(!inputs.empty(), "Expected at least one list of tensors to reduce");
+  const auto num_devices = inputs.size();
+  std::vector<int64_t> devices;
+  devices.reserve(num_devices);
+  int64_t root = -1;
+  for (size_t i = 0; i < num_devices; ++i) {
+    AT_CHECK(!inputs[i].empty() && inputs[i].size() == inputs[0].size(),
+             "reduce_add_coalesced expects the same number of tensors on every device");
+    const auto device = inputs[i][0].get_device();
+    for (auto& t : inputs[i]) {
+      AT_CHECK(t.type().is_cuda() && !t.type().is_sparse(),
+               "reduce_add_coalesced expects dense CUDA tensors");
+      AT_CHECK(t.get_device() == device,
+               "reduce_add_coalesced expects each list of tensors to be on a single device");
+    }
+    if (device == destination) {
+      root = i;
+    }
+    devices.push_back(device);
+  }
+  AT_CHECK(root != -1, "reduce_add_coalesced expects destination to be on the "
+           "same GPU with one of the tensors");
+#ifdef USE_NCCL
+  buffer_size = std::min(torch::cuda::nccl::get_max_count(), buffer_size);
+#endif
+
+  // All the lists have the same sizes and types, so they are split into the
+  // same buckets.
+  std::vector<std::vector<utils::TensorGroup>> chunks;
+  chunks.reserve(num_devices);
+  for (auto& device_inputs : inputs) {
+    chunks.push_back(utils::take_tensors(device_inputs, buffer_size));
+  }
+
+  // See NOTE [ Overlapped broadcast ]
+  c10::optional<SideStreams> side;
+  bool use_nccl = false;
+
+  std::vector<at::Tensor> outputs;
+  outputs.reserve(inputs[0].size());
+  unique_type_checker type_checker;
+  at::DeviceGuard device_guard;
+  for (size_t c = 0, num_chunks = chunks[root].size(); c < num_chunks; ++c) {
+    auto& ref_chunk = chunks[root][c];
+    type_checker.show(ref_chunk.type());
+    std::vector<at::Tensor> flats;
+    flats.reserve(num_devices);
+    for (size_t i = 0; i < num_devices; ++i) {
+      device_guard.set_index(devices[i]);
+      flats.push_back(utils::flatten_dense_tensors(chunks[i][c].tensors));
+    }
+    if (!side) {
+#ifdef USE_NCCL
+      use_nccl = nccl::is_available(flats);
+#endif
+      if (use_nccl) {
+        side.emplace(devices, /*on_source=*/false);
+      }
+    }
+
+    device_guard.set_index(destination);
+    at::Tensor result;
+#ifdef USE_NCCL
+    if (use_nccl) {
+      result = at::empty(flats[root].sizes(), flats[root].options());
+      // Only the root receives the sum, so the other ranks reduce in place.
+      std::vector<at::Tensor> nccl_outputs = flats;
+      nccl_outputs[root] = result;
+      side->wait_current_each(devices);
+      nccl::reduce(flats, nccl_outputs, root, ncclSum, side->internals());
+      for (size_t i = 0; i < num_devices; ++i) {
+        SideStreams::record_use(flats[i], side->streams[i]);
+      }
+    }
+#endif
+    if (!use_nccl) {
+      result = flats[root].clone();
+      for (size_t i = 0; i < num_devices; ++i) {
+        if (i != static_cast<size_t>(root)) {
+          result.add_(flats[i].to(result.device(), /*non_blocking=*/true));
+        }
+      }
+    }
+    for (auto& t : utils::unflatten_dense_tensors(result, ref_chunk.tensors))
+      outputs.push_back(std::move(t));
+  }
+  if (side) {
+    side->join(devices);
+  }
+
+  if (!type_checker.unique) {
+    utils::reorder_tensors_like(outputs, inputs[root]);
+  }
+  return outputs;
+}
+
 std::vector<at::Tensor> scatter(
     const at::Tensor& tensor,
     at::IntList devices,
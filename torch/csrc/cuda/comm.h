@@ -16,6 +16,9 @@ using tensor_list2d = std::vector<std::vector<at::Tensor>>;
 std::vector<at::Tensor> broadcast(const at::Tensor& tensor, at::IntList devices);
 tensor_list2d broadcast_coalesced(at::TensorList tensors, at::IntList devices,
                                   size_t buffer_size);
+std::vector<at::Tensor> reduce_add_coalesced(const tensor_list2d& inputs,
+                                             int64_t destination,
+                                             size_t buffer_size);
 
 std::vector<at::Tensor> scatter(
     const at::Tensor& tensor,
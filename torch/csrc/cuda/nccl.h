@@ -47,6 +47,15 @@ void broadcast(at::TensorList tensors,
                const stream_list& streams = {},
                const comm_list& user_comms = {});
 
+// Sums (or applies `op` to) `inputs` into `outputs[root]`. The outputs of the
+// other ranks are not written to, so they can alias the inputs.
+void reduce(at::TensorList inputs,
+            at::TensorList outputs,
+            int32_t root = 0,
+            int32_t op = ncclSum,
+            const stream_list& streams = {},
+            const comm_list& user_comms = {});
+
 size_t get_max_count();
 
 }}}
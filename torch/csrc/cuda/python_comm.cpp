@@ -26,6 +26,17 @@ void initCommMethods(PyObject *module) {
        py::arg("devices"),
        py::arg("buffer_size"),
        py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_reduce_add_coalesced",
+          [](const std::vector<std::vector<at::Tensor>>& inputs,
+             int64_t destination,
+             size_t buffer_size) {
+            return reduce_add_coalesced(inputs, destination, buffer_size);
+          },
+          py::arg("inputs"),
+          py::arg("destination"),
+          py::arg("buffer_size"),
+          py::call_guard<py::gil_scoped_release>())
       .def(
           "_broadcast",
           [](at::Tensor& tensor, std::vector<int64_t> devices) {
@@ -0,0 +1,116 @@
+#include <torch/csrc/distributed/c10d/comm_hook.h>
+
+#include <ATen/ATen.h>
+#include <ATen/DeviceGuard.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace c10d {
+
+CommHook::~CommHook() {}
+
+void CommHook::finalize(
+    size_t /* unused */,
+    std::vector<at::Tensor>& /* unused */) {}
+
+std::shared_ptr<ProcessGroup::Work> AllreduceCommHook::runHook(
+    ProcessGroup& processGroup,
+    size_t /* unused */,
+    std::vector<at::Tensor>& tensors) {
+  return processGroup.allreduce(tensors);
+}
+
+std::shared_ptr<ProcessGroup::Work> FP16CompressCommHook::runHook(
+    ProcessGroup& processGroup,
+    size_t bucketIndex,
+    std::vector<at::Tensor>& tensors) {
+  auto& compressed = compressed_[bucketIndex];
+  compressed.clear();
+  for (auto& tensor : tensors) {
+    at::DeviceGuard deviceGuard(tensor);
+    compressed.push_back(tensor.toType(at::kHalf));
+  }
+  return processGroup.allreduce(compressed);
+}
+
+void FP16CompressCommHook::finalize(
+    size_t bucketIndex,
+    std::vector<at::Tensor>& tensors) {
+  auto it = compressed_.find(bucketIndex);
+  AT_ASSERT(it != compressed_.end());
+  at::DeviceGuard deviceGuard(tensors[0]);
+  tensors[0].copy_(it->second[0]);
+  compressed_.erase(it);
+}
+
+TopKCompressCommHook::TopKCompressCommHook(double ratio) : ratio_(ratio) {
+  AT_CHECK(
+      ratio > 0 && ratio <= 1,
+      "Expected the ratio of gradients to communicate to be in (0, 1], got ",
+      ratio);
+}
+
+std::shared_ptr<ProcessGroup::Work> TopKCompressCommHook::runHook(
+    ProcessGroup& processGroup,
+    size_t bucketIndex,
+    std::vector<at::Tensor>& tensors) {
+  AT_CHECK(
+      tensors.size() == 1,
+      "Top-k gradient compression only supports a single model replica.");
+  auto& state = buckets_[bucketIndex];
+  auto& tensor = tensors[0];
+  at::DeviceGuard deviceGuard(tensor);
+
+  if (!state.residual.defined()) {
+    state.residual = at::zeros_like(tensor);
+  }
+  // Add what was left out last time, and leave out the rest this time
+  state.residual.add_(tensor);
+  const auto numel = tensor.numel();
+  const auto k = std::max<int64_t>(1, static_cast<int64_t>(ratio_ * numel));
+  auto indices = std::get<1>(state.residual.abs().topk(k, 0, true, false));
+  auto values = state.residual.index_select(0, indices);
+  state.residual.index_fill_(0, indices, 0);
+
+  const auto size = static_cast<size_t>(processGroup.getSize());
+  state.indices = {indices};
+  state.values = {values};
+  state.gatheredIndices = {std::vector<at::Tensor>(size)};
+  state.gatheredValues = {std::vector<at::Tensor>(size)};
+  for (size_t i = 0; i < size; i++) {
+    state.gatheredIndices[0][i] = at::empty_like(indices);
+    state.gatheredValues[0][i] = at::empty_like(values);
+  }
+  state.indicesWork =
+      processGroup.allgather(state.gatheredIndices, state.indices);
+  return processGroup.allgather(state.gatheredValues, state.values);
+}
+
+void TopKCompressCommHook::finalize(
+    size_t bucketIndex,
+    std::vector<at::Tensor>& tensors) {
+  auto& state = buckets_.at(bucketIndex);
+  AT_CHECK(
+      state.indicesWork->wait(),
+      "Top-k gradient compression allgather failed: ",
+      state.indicesWork->exception().what());
+
+  auto& tensor = tensors[0];
+  at::DeviceGuard deviceGuard(tensor);
+  tensor.zero_();
+  for (size_t i = 0; i < state.gatheredValues[0].size(); i++) {
+    tensor.index_add_(
+        0, state.gatheredIndices[0][i], state.gatheredValues[0][i]);
+  }
+
+  state.indices.clear();
+  state.values.clear();
+  state.gatheredIndices.clear();
+  state.gatheredValues.clear();
+  state.indicesWork.reset();
+}
+
+} // namespace c10d
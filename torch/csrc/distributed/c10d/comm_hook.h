@@ -0,0 +1,93 @@
+#pragma once
+
+#include <c10d/ProcessGroup.hpp>
+
+#include <ATen/ATen.h>
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace c10d {
+
+/// Communicates the gradients of a bucket of the Reducer, e.g. compressing
+/// them to save bandwidth.
+///
+/// `tensors` holds the flat gradients of the bucket on every replica in this
+/// process, already divided by the world size. `runHook` launches their
+/// reduction over all processes, and once the work it returns completed,
+/// `finalize` leaves the sum over all replicas and processes in `tensors[0]`.
+/// Both are called with the Reducer's lock held, in the same order of
+/// buckets on every process.
+class CommHook {
+ public:
+  virtual ~CommHook();
+
+  virtual std::shared_ptr<ProcessGroup::Work> runHook(
+      ProcessGroup& processGroup,
+      size_t bucketIndex,
+      std::vector<at::Tensor>& tensors) = 0;
+
+  virtual void finalize(size_t bucketIndex, std::vector<at::Tensor>& tensors);
+};
+
+/// Allreduces the gradients as they are. The default of the Reducer.
+class AllreduceCommHook : public CommHook {
+ public:
+  std::shared_ptr<ProcessGroup::Work> runHook(
+      ProcessGroup& processGroup,
+      size_t bucketIndex,
+      std::vector<at::Tensor>& tensors) override;
+};
+
+/// Allreduces the gradients cast to half precision, which halves the traffic
+/// of float gradients.
+class FP16CompressCommHook : public CommHook {
+ public:
+  std::shared_ptr<ProcessGroup::Work> runHook(
+      ProcessGroup& processGroup,
+      size_t bucketIndex,
+      std::vector<at::Tensor>& tensors) override;
+
+  void finalize(size_t bucketIndex, std::vector<at::Tensor>& tensors) override;
+
+ private:
+  // The compressed gradients of every bucket in flight
+  std::unordered_map<size_t, std::vector<at::Tensor>> compressed_;
+};
+
+/// Only communicates the `ratio` of the gradients with the largest
+/// magnitudes, as (index, value) pairs gathered from every process. The
+/// gradients that were left out are remembered per bucket and added to the
+/// gradients of the next iteration (error feedback), so every gradient is
+/// eventually applied.
+///
+/// Requires a process group that supports allgather, and a single replica.
+class TopKCompressCommHook : public CommHook {
+ public:
+  explicit TopKCompressCommHook(double ratio);
+
+  std::shared_ptr<ProcessGroup::Work> runHook(
+      ProcessGroup& processGroup,
+      size_t bucketIndex,
+      std::vector<at::Tensor>& tensors) override;
+
+  void finalize(size_t bucketIndex, std::vector<at::Tensor>& tensors) override;
+
+ private:
+  struct BucketState {
+    at::Tensor residual;
+    // Inputs and outputs of the allgathers, alive until they complete
+    std::vector<at::Tensor> indices;
+    std::vector<at::Tensor> values;
+    std::vector<std::vector<at::Tensor>> gatheredIndices;
+    std::vector<std::vector<at::Tensor>> gatheredValues;
+    std::shared_ptr<ProcessGroup::Work> indicesWork;
+  };
+
+  double ratio_;
+  std::unordered_map<size_t, BucketState> buckets_;
+};
+
+} // namespace c10d
@@ -2,8 +2,11 @@
 
 #include <c10d/Def.hpp>
 #include <c10d/FileStore.hpp>
+#include <c10d/ParameterServer.hpp>
 #include <c10d/ProcessGroup.hpp>
 #include <c10d/ProcessGroupGloo.hpp>
+#include <c10d/ProcessGroupHierarchical.hpp>
+#include <c10d/ProcessGroupTracing.hpp>
 
 #ifdef USE_C10D_NCCL
 #include <c10d/ProcessGroupNCCL.hpp>
@@ -19,7 +22,9 @@
 #include <pybind11/chrono.h>
 
 #include <torch/csrc/Exceptions.h>
+#include <torch/csrc/distributed/c10d/comm_hook.h>
 #include <torch/csrc/distributed/c10d/ddp.h>
+#include <torch/csrc/distributed/c10d/reducer.h>
 #include <torch/csrc/utils/object_ptr.h>
 #include <torch/csrc/utils/pybind.h>
 
@@ -66,6 +71,10 @@ PyObject* c10d_init(PyObject* _unused) {
       .def(py::init<>())
       .def_readwrite("rootRank", &::c10d::ScatterOptions::rootRank);
 
+  py::class_<::c10d::ReduceScatterOptions>(module, "ReduceScatterOptions")
+      .def(py::init<>())
+      .def_readwrite("reduceOp", &::c10d::ReduceScatterOptions::reduceOp);
+
   py::class_<::c10d::GatherOptions>(module, "GatherOptions")
       .def(py::init<>())
       .def_readwrite("rootRank", &::c10d::GatherOptions::rootRank);
@@ -113,6 +122,51 @@ PyObject* c10d_init(PyObject* _unused) {
                  const std::chrono::milliseconds& timeout) {
                 store.wait(keys, timeout);
               },
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "multi_set",
+              [](::c10d::Store& store,
+                 const std::vector<std::string>& keys,
+                 const std::vector<std::string>& values) {
+                std::vector<std::vector<uint8_t>> values_;
+                values_.reserve(values.size());
+                for (const auto& value : values) {
+                  values_.emplace_back(value.begin(), value.end());
+                }
+                store.multiSet(keys, values_);
+              },
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "multi_get",
+              [](::c10d::Store& store, const std::vector<std::string>& keys) {
+                std::vector<std::vector<uint8_t>> values;
+                {
+                  py::gil_scoped_release release;
+                  values = store.multiGet(keys);
+                }
+                py::list result;
+                for (const auto& value : values) {
+                  result.append(py::bytes(
+                      reinterpret_cast<const char*>(value.data()),
+                      value.size()));
+                }
+                return result;
+              })
+          .def(
+              "compare_set",
+              [](::c10d::Store& store,
+                 const std::string& key,
+                 const std::string& expected_value,
+                 const std::string& desired_value) -> py::bytes {
+                std::vector<uint8_t> expected_value_(
+                    expected_value.begin(), expected_value.end());
+                std::vector<uint8_t> desired_value_(
+                    desired_value.begin(), desired_value.end());
+                auto value =
+                    store.compareSet(key, expected_value_, desired_value_);
+                return py::bytes(
+                    reinterpret_cast<char*>(value.data()), value.size());
+              },
               py::call_guard<py::gil_scoped_release>());
 
   shared_ptr_class_<::c10d::FileStore>(module, "FileStore", store)
@@ -160,6 +214,13 @@ PyObject* c10d_init(PyObject* _unused) {
               py::arg("op") = ::c10d::ReduceOp::SUM,
               py::call_guard<py::gil_scoped_release>())
 
+          .def(
+              "allreduce_coalesced",
+              &::c10d::ProcessGroup::allreduceCoalesced,
+              py::arg("tensors"),
+              py::arg("opts") = ::c10d::AllreduceOptions(),
+              py::call_guard<py::gil_scoped_release>())
+
           .def(
               "reduce",
               &::c10d::ProcessGroup::reduce,
@@ -244,6 +305,38 @@ PyObject* c10d_init(PyObject* _unused) {
               py::arg("root"),
               py::call_guard<py::gil_scoped_release>())
 
+          .def(
+              "reduce_scatter",
+              &::c10d::ProcessGroup::reduceScatter,
+              py::arg("output_tensors"),
+              py::arg("input_tensors"),
+              py::arg("opts") = ::c10d::ReduceScatterOptions(),
+              py::call_guard<py::gil_scoped_release>())
+
+          .def(
+              "reduce_scatter",
+              [](::c10d::ProcessGroup& pg,
+                 at::Tensor& output,
+                 std::vector<at::Tensor>& input,
+                 ::c10d::ReduceOp op) {
+                ::c10d::ReduceScatterOptions opts;
+                opts.reduceOp = op;
+                std::vector<at::Tensor> outputs = {output};
+                std::vector<std::vector<at::Tensor>> inputs = {input};
+                return pg.reduceScatter(outputs, inputs, opts);
+              },
+              py::arg("output_tensor"),
+              py::arg("tensors"),
+              py::arg("op") = ::c10d::ReduceOp::SUM,
+              py::call_guard<py::gil_scoped_release>())
+
+          .def(
+              "alltoall",
+              &::c10d::ProcessGroup::alltoall,
+              py::arg("output_tensors"),
+              py::arg("input_tensors"),
+              py::call_guard<py::gil_scoped_release>())
+
           .def(
               "send",
               &::c10d::ProcessGroup::send,
@@ -306,7 +399,10 @@ PyObject* c10d_init(PyObject* _unused) {
       .def_readwrite("threads", &::c10d::ProcessGroupGloo::Options::threads)
       .def_readwrite(
           "cacheNumAlgorithmEntries",
-          &::c10d::ProcessGroupGloo::Options::cacheNumAlgorithmEntries);
+          &::c10d::ProcessGroupGloo::Options::cacheNumAlgorithmEntries)
+      .def_readwrite(
+          "cacheMaxAlgorithmKeys",
+          &::c10d::ProcessGroupGloo::Options::cacheMaxAlgorithmKeys);
 
   processGroupGloo.def_static(
       "create_tcp_device",
@@ -353,9 +449,218 @@ PyObject* c10d_init(PyObject* _unused) {
                 store, rank, size, options);
           }));
 
+  shared_ptr_class_<::c10d::ProcessGroupHierarchical>(
+      module, "ProcessGroupHierarchical", processGroup)
+      .def(
+          py::init<
+              int,
+              int,
+              std::shared_ptr<::c10d::ProcessGroup>,
+              std::shared_ptr<::c10d::ProcessGroup>>(),
+          py::arg("rank"),
+          py::arg("size"),
+          py::arg("intra_node_group"),
+          py::arg("inter_node_group"))
+      .def("is_node_leader", &::c10d::ProcessGroupHierarchical::isNodeLeader)
+      .def(
+          "stage_times",
+          [](::c10d::ProcessGroupHierarchical& pg) {
+            using Stage = ::c10d::ProcessGroupHierarchical::Stage;
+            const auto times = pg.getStageTimes();
+            const std::vector<std::pair<const char*, Stage>> stages = {
+                {"intra_node_reduce", Stage::INTRA_NODE_REDUCE},
+                {"inter_node_allreduce", Stage::INTER_NODE_ALLREDUCE},
+                {"intra_node_broadcast", Stage::INTRA_NODE_BROADCAST},
+            };
+            // Maps every stage to (count, total seconds)
+            py::dict result;
+            for (const auto& stage : stages) {
+              const auto& time = times[static_cast<size_t>(stage.second)];
+              result[stage.first] = py::make_tuple(
+                  time.count,
+                  std::chrono::duration<double>(time.total).count());
+            }
+            return result;
+          })
+      .def(
+          "reset_stage_times",
+          &::c10d::ProcessGroupHierarchical::resetStageTimes);
+
+  auto processGroupTracing = shared_ptr_class_<::c10d::ProcessGroupTracing>(
+      module, "ProcessGroupTracing", processGroup);
+
+  shared_ptr_class_<::c10d::ProcessGroupTracing::Options>(
+      processGroupTracing, "Options")
+      .def(py::init<>())
+      .def_readwrite(
+          "maxRecords", &::c10d::ProcessGroupTracing::Options::maxRecords)
+      .def_readwrite(
+          "pollInterval", &::c10d::ProcessGroupTracing::Options::pollInterval);
+
+  // Maps every operation that ran to a dict of its totals, seconds and
+  // bandwidths (in bytes per second)
+  auto statsToDict = [](const ::c10d::ProcessGroupTracing::Stats& stats,
+                        int size) {
+    using OpType = ::c10d::ProcessGroupTracing::OpType;
+    py::dict result;
+    for (size_t i = 0; i < stats.size(); i++) {
+      const auto& opStats = stats[i];
+      if (opStats.count == 0) {
+        continue;
+      }
+      const auto opType = static_cast<OpType>(i);
+      const auto algbw = opStats.algorithmBandwidth();
+      py::dict entry;
+      entry["count"] = opStats.count;
+      entry["bytes"] = opStats.bytes;
+      entry["busy"] = std::chrono::duration<double>(opStats.busy).count();
+      entry["queued"] = std::chrono::duration<double>(opStats.queued).count();
+      entry["algbw"] = algbw;
+      entry["busbw"] =
+          algbw * ::c10d::ProcessGroupTracing::busBandwidthFactor(opType, size);
+      result[::c10d::ProcessGroupTracing::opTypeName(opType)] = entry;
+    }
+    return result;
+  };
+
+  processGroupTracing
+      .def(
+          py::init<
+              const std::shared_ptr<::c10d::Store>&,
+              std::shared_ptr<::c10d::ProcessGroup>,
+              ::c10d::ProcessGroupTracing::Options>(),
+          py::arg("store"),
+          py::arg("pg"),
+          py::arg("options") = ::c10d::ProcessGroupTracing::Options())
+      .def(
+          "records",
+          [](::c10d::ProcessGroupTracing& pg) {
+            using Clock = ::c10d::ProcessGroupTracing::Clock;
+            auto seconds = [](Clock::time_point time) {
+              return std::chrono::duration<double>(time.time_since_epoch())
+                  .count();
+            };
+            py::list result;
+            for (const auto& record : pg.getRecords()) {
+              py::dict entry;
+              entry["seq"] = record.seq;
+              entry["op"] =
+                  ::c10d::ProcessGroupTracing::opTypeName(record.opType);
+              entry["peer"] = record.peer;
+              entry["bytes"] = record.bytes;
+              entry["cuda"] = record.cuda;
+              entry["completed"] = record.completed;
+              entry["success"] = record.success;
+              entry["enqueued"] = seconds(record.enqueued);
+              if (record.completed) {
+                entry["started"] = seconds(record.started);
+                entry["finished"] = seconds(record.finished);
+              }
+              result.append(entry);
+            }
+            return result;
+          })
+      .def(
+          "stats",
+          [statsToDict](::c10d::ProcessGroupTracing& pg) {
+            return statsToDict(pg.getStats(), pg.getSize());
+          })
+      .def(
+          "gather_stats",
+          [statsToDict](::c10d::ProcessGroupTracing& pg) {
+            std::vector<::c10d::ProcessGroupTracing::Stats> stats;
+            {
+              py::gil_scoped_release release;
+              stats = pg.gatherStats();
+            }
+            py::list ranks;
+            for (const auto& rankStats : stats) {
+              ranks.append(statsToDict(rankStats, pg.getSize()));
+            }
+            py::dict result;
+            result["ranks"] = ranks;
+            result["straggler"] =
+                ::c10d::ProcessGroupTracing::findStraggler(stats);
+            return result;
+          })
+      .def("reset", &::c10d::ProcessGroupTracing::reset);
+
+  auto parameterServer = shared_ptr_class_<::c10d::ParameterServer>(
+      module, "ParameterServer");
+
+  py::enum_<::c10d::ParameterServer::Optimizer>(parameterServer, "Optimizer")
+      .value("SGD", ::c10d::ParameterServer::Optimizer::SGD)
+      .value("ADAGRAD", ::c10d::ParameterServer::Optimizer::ADAGRAD);
+
+  py::class_<::c10d::ParameterServer::TableOptions>(
+      parameterServer, "TableOptions")
+      .def(py::init<>())
+      .def_readwrite(
+          "optimizer", &::c10d::ParameterServer::TableOptions::optimizer)
+      .def_readwrite(
+          "learningRate", &::c10d::ParameterServer::TableOptions::learningRate)
+      .def_readwrite("epsilon", &::c10d::ParameterServer::TableOptions::epsilon)
+      .def_readwrite(
+          "initRange", &::c10d::ParameterServer::TableOptions::initRange);
+
+  py::class_<::c10d::ParameterServer::Options>(parameterServer, "Options")
+      .def(py::init<>())
+      .def_readwrite("hostname", &::c10d::ParameterServer::Options::hostname);
+
+  parameterServer
+      .def(
+          py::init<
+              const std::shared_ptr<::c10d::Store>&,
+              int,
+              int,
+              ::c10d::ParameterServer::Options>(),
+          py::arg("store"),
+          py::arg("rank"),
+          py::arg("size"),
+          py::arg("options") = ::c10d::ParameterServer::Options())
+      .def("rank", &::c10d::ParameterServer::getRank)
+      .def("size", &::c10d::ParameterServer::getSize)
+      .def(
+          "create_table",
+          &::c10d::ParameterServer::createTable,
+          py::arg("name"),
+          py::arg("num_rows"),
+          py::arg("dim"),
+          py::arg("options") = ::c10d::ParameterServer::TableOptions(),
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "push",
+          &::c10d::ParameterServer::push,
+          py::arg("name"),
+          py::arg("indices"),
+          py::arg("grads"),
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "pull",
+          &::c10d::ParameterServer::pull,
+          py::arg("name"),
+          py::arg("indices"),
+          py::arg("output"),
+          py::call_guard<py::gil_scoped_release>());
+
 #ifdef USE_C10D_NCCL
-  shared_ptr_class_<::c10d::ProcessGroupNCCL>(
-      module, "ProcessGroupNCCL", processGroup)
+  auto processGroupNCCL = shared_ptr_class_<::c10d::ProcessGroupNCCL>(
+      module, "ProcessGroupNCCL", processGroup);
+
+  py::class_<::c10d::ProcessGroupNCCL::Options>(processGroupNCCL, "Options")
+      .def(py::init<>())
+      .def_readwrite(
+          "deviceSets", &::c10d::ProcessGroupNCCL::Options::deviceSets)
+      .def_readwrite(
+          "highPriorityStreams",
+          &::c10d::ProcessGroupNCCL::Options::highPriorityStreams);
+
+  processGroupNCCL
+      .def(py::init<
+           const std::shared_ptr<::c10d::Store>&,
+           int,
+           int,
+           ::c10d::ProcessGroupNCCL::Options>())
       .def(py::init<const std::shared_ptr<::c10d::Store>&, int, int>());
 #endif
 
@@ -375,7 +680,64 @@ PyObject* c10d_init(PyObject* _unused) {
       .def(
           "wait",
           &::c10d::ProcessGroup::Work::wait,
-          py::call_guard<py::gil_scoped_release>());
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "add_callback",
+          [](::c10d::ProcessGroup::Work& work, py::function fn) {
+            // The callback may run, and be destroyed, on a thread that
+            // doesn't hold the GIL.
+            auto callback = std::shared_ptr<py::function>(
+                new py::function(std::move(fn)), [](py::function* fn) {
+                  py::gil_scoped_acquire gil;
+                  delete fn;
+                });
+            py::gil_scoped_release release;
+            work.addCallback([callback]() {
+              py::gil_scoped_acquire gil;
+              try {
+                (*callback)();
+              } catch (py::error_already_set& e) {
+                // Callbacks must not throw into the thread completing the work
+                e.restore();
+                PyErr_WriteUnraisable(callback->ptr());
+              }
+            });
+          });
+
+  shared_ptr_class_<::c10d::Reducer>(module, "Reducer")
+      .def(
+          py::init<
+              std::vector<std::vector<torch::autograd::Variable>>,
+              std::vector<std::vector<size_t>>,
+              std::shared_ptr<::c10d::ProcessGroup>>(),
+          py::arg("replicas"),
+          py::arg("bucket_indices"),
+          py::arg("process_group"))
+      .def(
+          "register_comm_hook",
+          &::c10d::Reducer::registerCommHook,
+          py::arg("comm_hook"));
+
+  auto commHook =
+      shared_ptr_class_<::c10d::CommHook>(module, "CommHook");
+
+  shared_ptr_class_<::c10d::AllreduceCommHook>(
+      module, "AllreduceCommHook", commHook)
+      .def(py::init<>());
+
+  shared_ptr_class_<::c10d::FP16CompressCommHook>(
+      module, "FP16CompressCommHook", commHook)
+      .def(py::init<>());
+
+  shared_ptr_class_<::c10d::TopKCompressCommHook>(
+      module, "TopKCompressCommHook", commHook)
+      .def(py::init<double>(), py::arg("ratio"));
+
+  module.def(
+      "_compute_bucket_assignment_by_size",
+      &::c10d::computeBucketAssignmentBySize,
+      py::arg("tensors"),
+      py::arg("bucket_size"));
 
 #ifdef USE_CUDA
   module.def(
@@ -0,0 +1,275 @@
+#include <torch/csrc/distributed/c10d/reducer.h>
+
+#include <torch/csrc/autograd/function_hook.h>
+
+#include <ATen/ATen.h>
+#include <ATen/DeviceGuard.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace c10d {
+namespace {
+
+class ReducerHook : public torch::autograd::FunctionPostHook {
+ public:
+  ReducerHook(Reducer* reducer, size_t replicaIndex, size_t variableIndex)
+      : reducer_(reducer),
+        replicaIndex_(replicaIndex),
+        variableIndex_(variableIndex) {}
+
+  torch::autograd::variable_list operator()(
+      const torch::autograd::variable_list& outputs,
+      const torch::autograd::variable_list& /* unused */) override {
+    reducer_->markVariableReady(replicaIndex_, variableIndex_);
+    return outputs;
+  }
+
+ private:
+  Reducer* reducer_;
+  size_t replicaIndex_;
+  size_t variableIndex_;
+};
+
+} // namespace
+
+Reducer::Reducer(
+    std::vector<std::vector<torch::autograd::Variable>> replicas,
+    std::vector<std::vector<size_t>> bucketIndices,
+    std::shared_ptr<ProcessGroup> processGroup)
+    : replicas_(std::move(replicas)),
+      processGroup_(std::move(processGroup)),
+      commHook_(std::make_shared<AllreduceCommHook>()),
+      nextBucket_(0) {
+  AT_CHECK(!replicas_.empty(), "Expected at least one model replica.");
+  const auto numVariables = replicas_[0].size();
+  for (const auto& replica : replicas_) {
+    AT_CHECK(
+        replica.size() == numVariables,
+        "Expected the same number of parameters in every model replica.");
+  }
+
+  variableLocators_.resize(numVariables);
+  std::vector<bool> assigned(numVariables, false);
+  buckets_.reserve(bucketIndices.size());
+  for (size_t bucketIndex = 0; bucketIndex < bucketIndices.size();
+       bucketIndex++) {
+    const auto& indices = bucketIndices[bucketIndex];
+    AT_CHECK(!indices.empty(), "Expected buckets to be non-empty.");
+    Bucket bucket;
+    for (const auto& replica : replicas_) {
+      BucketReplica bucketReplica;
+      size_t offset = 0;
+      for (size_t variableIndex : indices) {
+        AT_CHECK(
+            variableIndex < numVariables,
+            "Bucket can't contain parameter ", variableIndex, ", there are only ",
+            numVariables, " parameters.");
+        const auto& variable = replica[variableIndex];
+        AT_CHECK(
+            bucketReplica.variables.empty() ||
+                variable.type() == bucketReplica.variables[0].type(),
+            "Expected the parameters of a bucket to have the same type.");
+        const size_t length = variable.numel();
+        bucketReplica.variables.push_back(variable);
+        bucketReplica.offsets.push_back(offset);
+        bucketReplica.lengths.push_back(length);
+        offset += length;
+      }
+      // Plain tensors, so the copies into the buckets aren't recorded
+      bucketReplica.contents =
+          at::empty({static_cast<int64_t>(offset)}, replica[indices[0]].data().options());
+      bucket.replicas.push_back(std::move(bucketReplica));
+    }
+    for (size_t intraBucketIndex = 0; intraBucketIndex < indices.size();
+         intraBucketIndex++) {
+      const auto variableIndex = indices[intraBucketIndex];
+      AT_CHECK(
+          !assigned[variableIndex],
+          "Parameter ", variableIndex, " is in more than one bucket.");
+      assigned[variableIndex] = true;
+      variableLocators_[variableIndex] =
+          VariableLocator{bucketIndex, intraBucketIndex};
+    }
+    buckets_.push_back(std::move(bucket));
+  }
+  AT_CHECK(
+      std::all_of(assigned.begin(), assigned.end(), [](bool a) { return a; }),
+      "Expected every parameter to be in a bucket.");
+  resetBuckets();
+
+  for (size_t replicaIndex = 0; replicaIndex < replicas_.size();
+       replicaIndex++) {
+    for (size_t variableIndex = 0; variableIndex < numVariables;
+         variableIndex++) {
+      auto& variable = replicas_[replicaIndex][variableIndex];
+      AT_CHECK(
+          variable.requires_grad(),
+          "Expected every bucketed parameter to require grad.");
+      auto gradAccumulator = variable.grad_accumulator();
+      auto hook = std::unique_ptr<torch::autograd::FunctionPostHook>(
+          new ReducerHook(this, replicaIndex, variableIndex));
+      hooks_.push_back(hook.get());
+      gradAccumulator->add_post_hook(std::move(hook));
+      // The variables only hold weak references to their accumulators
+      gradAccumulators_.push_back(std::move(gradAccumulator));
+    }
+  }
+}
+
+Reducer::~Reducer() {
+  for (size_t i = 0; i < gradAccumulators_.size(); i++) {
+    auto& postHooks = gradAccumulators_[i]->post_hooks();
+    auto hook = hooks_[i];
+    postHooks.erase(
+        std::remove_if(
+            postHooks.begin(),
+            postHooks.end(),
+            [hook](const std::unique_ptr<torch::autograd::FunctionPostHook>&
+                       postHook) { return postHook.get() == hook; }),
+        postHooks.end());
+  }
+}
+
+void Reducer::markVariableReady(size_t replicaIndex, size_t variableIndex) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto& locator = variableLocators_[variableIndex];
+  auto& bucket = buckets_[locator.bucketIndex];
+  auto& bucketReplica = bucket.replicas[replicaIndex];
+  auto& variable = bucketReplica.variables[locator.intraBucketIndex];
+  auto& grad = variable.grad();
+  AT_CHECK(
+      !grad.defined() || !grad.requires_grad(),
+      "DistributedDataParallel only works with gradients that don't require grad");
+
+  at::DeviceGuard deviceGuard(bucketReplica.contents);
+  auto view = bucketReplica.contents.narrow(
+      0,
+      bucketReplica.offsets[locator.intraBucketIndex],
+      bucketReplica.lengths[locator.intraBucketIndex]);
+  if (grad.defined()) {
+    view.copy_(torch::autograd::as_variable_ref(grad).data().reshape({-1}));
+  } else {
+    view.zero_();
+  }
+  // Only the gradients of the first replica are handed to the optimizer, the
+  // other replicas are synchronized with it before every forward pass
+  if (replicaIndex > 0) {
+    grad.reset();
+    variable.data().set_();
+  }
+
+  AT_ASSERT(bucket.pending > 0);
+  if (--bucket.pending > 0) {
+    return;
+  }
+  while (nextBucket_ < buckets_.size() && buckets_[nextBucket_].pending == 0) {
+    launchBucket(nextBucket_++);
+  }
+  if (nextBucket_ == buckets_.size()) {
+    finalizeBackward();
+  }
+}
+
+void Reducer::registerCommHook(std::shared_ptr<CommHook> commHook) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  AT_CHECK(commHook, "Expected a communication hook.");
+  for (const auto& bucket : buckets_) {
+    AT_CHECK(
+        bucket.pending ==
+            bucket.replicas.size() * bucket.replicas[0].variables.size(),
+        "Can't register a communication hook during a backward pass.");
+  }
+  commHook_ = std::move(commHook);
+}
+
+void Reducer::launchBucket(size_t bucketIndex) {
+  auto& bucket = buckets_[bucketIndex];
+  auto& tensors = bucket.allreduceTensors;
+  tensors.clear();
+  for (auto& replica : bucket.replicas) {
+    tensors.push_back(replica.contents);
+  }
+  // The allreduce sums over the replicas of all processes. The replicas of a
+  // process add up to its gradient, which is averaged over the processes;
+  // dividing before the sum reduces the chances of overflow.
+  for (auto& tensor : tensors) {
+    at::DeviceGuard deviceGuard(tensor);
+    tensor.div_(processGroup_->getSize());
+  }
+  bucket.work = commHook_->runHook(*processGroup_, bucketIndex, tensors);
+}
+
+void Reducer::finalizeBackward() {
+  for (size_t bucketIndex = 0; bucketIndex < buckets_.size(); bucketIndex++) {
+    auto& bucket = buckets_[bucketIndex];
+    AT_ASSERT(bucket.work);
+    AT_CHECK(
+        bucket.work->wait(),
+        "DistributedDataParallel gradient allreduce failed: ",
+        bucket.work->exception().what());
+    commHook_->finalize(bucketIndex, bucket.allreduceTensors);
+    auto& replica = bucket.replicas[0];
+    at::DeviceGuard deviceGuard(replica.contents);
+    for (size_t i = 0; i < replica.variables.size(); i++) {
+      auto& grad = replica.variables[i].grad();
+      auto reduced =
+          replica.contents.narrow(0, replica.offsets[i], replica.lengths[i]);
+      if (grad.defined()) {
+        torch::autograd::as_variable_ref(grad).data().copy_(
+            reduced.view(grad.sizes()));
+      }
+    }
+  }
+  resetBuckets();
+}
+
+void Reducer::resetBuckets() {
+  for (auto& bucket : buckets_) {
+    bucket.pending = bucket.replicas.size() * bucket.replicas[0].variables.size();
+    bucket.work.reset();
+  }
+  nextBucket_ = 0;
+}
+
+std::vector<std::vector<size_t>> computeBucketAssignmentBySize(
+    const std::vector<at::Tensor>& tensors,
+    int64_t bucketSize) {
+  struct OpenBucket {
+    std::vector<size_t> indices;
+    int64_t size = 0;
+  };
+  std::vector<std::vector<size_t>> result;
+  std::unordered_map<const at::Type*, OpenBucket> openBuckets;
+  for (size_t i = tensors.size(); i-- > 0;) {
+    const auto& tensor = tensors[i];
+    auto& bucket = openBuckets[&tensor.type()];
+    bucket.indices.push_back(i);
+    bucket.size += tensor.numel() * tensor.type().elementSizeInBytes();
+    if (bucket.size >= bucketSize) {
+      result.push_back(std::move(bucket.indices));
+      openBuckets.erase(&tensor.type());
+    }
+  }
+  // The last buckets of every type, in the order of their first parameter
+  std::vector<std::vector<size_t>> remaining;
+  for (auto& entry : openBuckets) {
+    remaining.push_back(std::move(entry.second.indices));
+  }
+  std::sort(
+      remaining.begin(),
+      remaining.end(),
+      [](const std::vector<size_t>& a, const std::vector<size_t>& b) {
+        return a[0] > b[0];
+      });
+  for (auto& indices : remaining) {
+    result.push_back(std::move(indices));
+  }
+  return result;
+}
+
+} // namespace c10d
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <c10d/ProcessGroup.hpp>
+#include <torch/csrc/distributed/c10d/comm_hook.h>
+
+#include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/variable.h>
+
+#include <ATen/ATen.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace c10d {
+
+/// Averages the gradients of the parameters of a DistributedDataParallel
+/// module across processes while the backward pass is still running.
+///
+/// The parameters are split into buckets. A hook on the gradient accumulator
+/// of every parameter copies its gradient into the flat buffer of its bucket
+/// as soon as it has been accumulated, and once all the gradients of a bucket
+/// are in, on every replica, the bucket is allreduced asynchronously. Buckets
+/// are reduced in the order they are given, which should be the reverse order
+/// of the parameters, i.e. roughly the order in which the backward pass
+/// computes their gradients. When the last bucket has been launched, the hook
+/// waits for the reductions and copies the averaged gradients back into the
+/// gradients of the first replica, so they are ready for the optimizer when
+/// backward() returns.
+class Reducer {
+ public:
+  /// `replicas` holds the parameters of every replica of the module in this
+  /// process (one per device), in the same order, and `bucketIndices`
+  /// partitions the indices of the parameters into buckets, e.g. as computed
+  /// by `computeBucketAssignmentBySize`.
+  explicit Reducer(
+      std::vector<std::vector<torch::autograd::Variable>> replicas,
+      std::vector<std::vector<size_t>> bucketIndices,
+      std::shared_ptr<ProcessGroup> processGroup);
+
+  ~Reducer();
+
+  /// Called by the hook on the gradient accumulator of a parameter.
+  void markVariableReady(size_t replicaIndex, size_t variableIndex);
+
+  /// Replaces the plain allreduce of the buckets, e.g. to compress the
+  /// gradients. Must not be called during a backward pass.
+  void registerCommHook(std::shared_ptr<CommHook> commHook);
+
+ protected:
+  struct BucketReplica {
+    // The flat gradients of the variables of the bucket on one replica
+    at::Tensor contents;
+    std::vector<torch::autograd::Variable> variables;
+    std::vector<size_t> offsets;
+    std::vector<size_t> lengths;
+  };
+
+  struct Bucket {
+    std::vector<BucketReplica> replicas;
+    // Gradients of the bucket, over all replicas, that aren't in yet
+    size_t pending;
+    // The contents of the replicas, alive until `work` completes
+    std::vector<at::Tensor> allreduceTensors;
+    std::shared_ptr<ProcessGroup::Work> work;
+  };
+
+  struct VariableLocator {
+    size_t bucketIndex;
+    size_t intraBucketIndex;
+  };
+
+  void launchBucket(size_t bucketIndex);
+
+  void finalizeBackward();
+
+  void resetBuckets();
+
+  std::mutex mutex_;
+  std::vector<std::vector<torch::autograd::Variable>> replicas_;
+  std::shared_ptr<ProcessGroup> processGroup_;
+  std::shared_ptr<CommHook> commHook_;
+  std::vector<Bucket> buckets_;
+  std::vector<VariableLocator> variableLocators_;
+  // The next bucket to launch; buckets that are ready before it wait
+  size_t nextBucket_;
+
+  // The gradient accumulators the hooks are installed on, and the hooks, so
+  // they can be removed again
+  std::vector<std::shared_ptr<torch::autograd::Function>> gradAccumulators_;
+  std::vector<torch::autograd::FunctionPostHook*> hooks_;
+};
+
+/// Splits `tensors` into buckets of at most `bucketSize` bytes (a tensor that
+/// is larger gets a bucket to itself) and of a single type. The buckets, and
+/// the tensors within them, are in the reverse order of `tensors`.
+std::vector<std::vector<size_t>> computeBucketAssignmentBySize(
+    const std::vector<at::Tensor>& tensors,
+    int64_t bucketSize);
+
+} // namespace c10d
@@ -1,3 +1,5 @@
+#include "torch/csrc/utils/auto_gil.h"
+
 #ifdef USE_CUDA
 #include <cuda_runtime.h>
 #endif
@@ -203,8 +205,12 @@ PyObject * THPStorage_(writeFile)(THPStorage *self, PyObject *args)
   HANDLE_TH_ERRORS
   PyObject *file = PyTuple_GET_ITEM(args, 0);
   bool is_real_file = PyTuple_GET_ITEM(args, 1) == Py_True;
+  // Writes at the offset, if any, without moving the position of the file
+  PyObject *offset = PyTuple_GET_SIZE(args) > 2 ? PyTuple_GET_ITEM(args, 2) : Py_None;
 
   if (!is_real_file) {
+    THPUtils_assert(offset == Py_None,
+                    "_write_file: offset is NYI for filelike objects");
     THPStorage_(writeFileRaw<PyObject*>)(self->cdata, file);
     Py_RETURN_NONE;
   }
@@ -212,7 +218,14 @@ PyObject * THPStorage_(writeFile)(THPStorage *self, PyObject *args)
   int fd = PyObject_AsFileDescriptor(file);
   THPUtils_assert(fd != -1, "_write_file couldn't retrieve a file descriptor "
       "from given object");
-  THPStorage_(writeFileRaw)(self->cdata, fd);
+  if (offset != Py_None) {
+    THPFileAt file_at{fd, THPUtils_unpackLong(offset)};
+    AutoNoGIL no_gil;
+    THPStorage_(writeFileRaw)(self->cdata, &file_at);
+  } else {
+    AutoNoGIL no_gil;
+    THPStorage_(writeFileRaw)(self->cdata, fd);
+  }
   Py_RETURN_NONE;
   END_HANDLE_TH_ERRORS
 }
@@ -253,12 +266,18 @@ static PyObject *THPStorage_(setFromFile)(THPStorage *self, PyObject *args)
 
   // file is backed by a fd
   int fd = PyObject_AsFileDescriptor(file);
-  if (offset != Py_None) {
-    lseek(fd, THPUtils_unpackLong(offset), SEEK_SET);
-  }
   THPUtils_assert(fd != -1, "_set_from_file couldn't retrieve a file "
       "descriptor from given object");
-  THWStorage *storage = THPStorage_(readFileRaw<int>)(fd, self->cdata);
+  THWStorage *storage;
+  if (offset != Py_None) {
+    // Reads at the offset without moving the position of the file
+    THPFileAt file_at{fd, THPUtils_unpackLong(offset)};
+    AutoNoGIL no_gil;
+    storage = THPStorage_(readFileRaw<THPFileAt*>)(&file_at, self->cdata);
+  } else {
+    AutoNoGIL no_gil;
+    storage = THPStorage_(readFileRaw<int>)(fd, self->cdata);
+  }
   if (storage == nullptr)
     return nullptr;
   Py_INCREF(self);
@@ -266,6 +285,52 @@ static PyObject *THPStorage_(setFromFile)(THPStorage *self, PyObject *args)
   return (PyObject *) self;
   END_HANDLE_TH_ERRORS
 }
+
+#ifndef THC_GENERIC_FILE
+static void THPStorage_(freeMapping)(void *mapping)
+{
+  THByteStorage_free((THByteStorage*)mapping);
+}
+
+// Points the storage to its data in a ByteStorage mapping a file saved by
+// torch.save, at the offset of the size that precedes the data. The mapping
+// stays alive as long as the storage does, and the data is only read from
+// the file when accessed.
+static PyObject *THPStorage_(setFromMapping)(THPStorage *self, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(PyTuple_GET_SIZE(args) == 2, "tuple of 2 items expected");
+  PyObject *_mapping = PyTuple_GET_ITEM(args, 0);
+  PyObject *_offset = PyTuple_GET_ITEM(args, 1);
+  if (!THPByteStorage_Check(_mapping) || !THPUtils_checkLong(_offset)) {
+    THPUtils_invalidArguments(args, nullptr, "_set_from_mapping", 1,
+        "(torch.ByteStorage mapping, int offset)");
+    return nullptr;
+  }
+  THByteStorage *mapping = ((THPByteStorage*)_mapping)->cdata;
+  int64_t offset = THPUtils_unpackLong(_offset);
+  int64_t size = THWStorage_(size)(LIBRARY_STATE self->cdata);
+  THPUtils_assert(offset >= 0 &&
+      offset + (int64_t)sizeof(int64_t) + size * (int64_t)sizeof(scalar_t) <=
+          THByteStorage_size(mapping),
+      "_set_from_mapping: the storage data exceeds the mapping");
+  uint8_t *data = THByteStorage_data(mapping) + offset;
+  int64_t saved_size;
+  memcpy(&saved_size, data, sizeof(int64_t));
+  THPUtils_assert(saved_size == size,
+      "storage has wrong size: expected %ld got %ld", size, saved_size);
+
+  THByteStorage_retain(mapping);
+  at::DataPtr data_ptr(data + sizeof(int64_t), mapping,
+      &THPStorage_(freeMapping), at::DeviceType::CPU);
+  THWStoragePtr view(THWStorage_(newWithDataAndAllocator)(
+      std::move(data_ptr), size, /* allocator */ nullptr));
+  THWStorage_(swap)(self->cdata, view);
+  Py_INCREF(self);
+  return (PyObject *) self;
+  END_HANDLE_TH_ERRORS
+}
+#endif
 #endif // !defined(THD_GENERIC_FILE)
 
 #ifdef THC_GENERIC_FILE
@@ -305,6 +370,9 @@ static PyMethodDef THPStorage_(methods)[] = {
   {"_write_file", (PyCFunction)THPStorage_(writeFile), METH_VARARGS, nullptr},
   {"_new_with_file", (PyCFunction)THPStorage_(newWithFile), METH_O | METH_STATIC, nullptr},
   {"_set_from_file", (PyCFunction)THPStorage_(setFromFile), METH_VARARGS, nullptr},
+#ifndef THC_GENERIC_FILE
+  {"_set_from_mapping", (PyCFunction)THPStorage_(setFromMapping), METH_VARARGS, nullptr},
+#endif
 #endif // !defined(THD_GENERIC_FILE)
 #if !defined(THC_GENERIC_FILE) && !defined(THD_GENERIC_FILE)
   {"from_buffer", (PyCFunction)THPStorage_(fromBuffer), METH_VARARGS | METH_KEYWORDS | METH_STATIC, nullptr},
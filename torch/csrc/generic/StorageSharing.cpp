@@ -14,6 +14,10 @@ static PyObject * THPStorage_(sharedDecref)(THPStorage *self)
   if (ctx) {
     ctx->decref();
   }
+  THPooledMapAllocator *pooled_ctx = THPooledMapAllocator::fromDataPtr(storage->data_ptr());
+  if (pooled_ctx) {
+    pooled_ctx->decref();
+  }
 #endif
   Py_INCREF(self);
   return (PyObject *)self;
@@ -29,6 +33,10 @@ static PyObject * THPStorage_(sharedIncref)(THPStorage *self)
   if (ctx) {
     ctx->incref();
   }
+  THPooledMapAllocator *pooled_ctx = THPooledMapAllocator::fromDataPtr(storage->data_ptr());
+  if (pooled_ctx) {
+    pooled_ctx->incref();
+  }
 #endif
   Py_RETURN_NONE;
   END_HANDLE_TH_ERRORS
@@ -127,14 +135,11 @@ static PyObject * THPStorage_(newSharedFilename)(PyObject *_unused, PyObject *ar
   END_HANDLE_TH_ERRORS
 }
 
+// Storages shared through file descriptors live in segments recycled by the
+// process that created them, e.g. for the batches of DataLoader workers
 static THWStorage* THPStorage_(newFdStorage)(ptrdiff_t size)
 {
-  int flags = TH_ALLOCATOR_MAPPED_SHAREDMEM |
-              TH_ALLOCATOR_MAPPED_EXCLUSIVE |
-              TH_ALLOCATOR_MAPPED_KEEPFD |
-              TH_ALLOCATOR_MAPPED_UNLINK;
-  std::string handle = THPStorage_(__newHandle)();
-  auto sptr = THMapAllocator::makeDataPtr(handle.c_str(), flags, size * sizeof(scalar_t), nullptr);
+  auto sptr = THPooledMapAllocator::makeDataPtr(size * sizeof(scalar_t), nullptr);
   return THWStorage_(newWithDataAndAllocator)(std::move(sptr), size, /* allocator */ nullptr);
 }
 
@@ -155,13 +160,15 @@ static PyObject * THPStorage_(shareFd)(THPStorage *self)
   THWStorage *storage = self->cdata;
   THMapAllocator *ctx;
   // Storage is already in shared memory, just return a handle
-  if ((ctx = THMapAllocator::fromDataPtr(storage->data_ptr()))) {
+  if ((ctx = THPooledMapAllocator::fromDataPtr(storage->data_ptr()))) {
+    // done
+  } else if ((ctx = THMapAllocator::fromDataPtr(storage->data_ptr()))) {
     // done
   } else {
     THWStoragePtr new_storage(THPStorage_(newFdStorage)(storage->numel()));
     THWStorage_(copy)(new_storage, storage);
     THWStorage_(swap)(storage, new_storage);
-    ctx = THMapAllocator::fromDataPtr(storage->data_ptr());
+    ctx = THPooledMapAllocator::fromDataPtr(storage->data_ptr());
     AT_ASSERT(ctx);
   }
 
@@ -197,14 +204,10 @@ static PyObject * THPStorage_(newSharedFd)(PyObject *_unused, PyObject *args)
     return nullptr;
   }
 
-  int flags = TH_ALLOCATOR_MAPPED_SHAREDMEM |
-              TH_ALLOCATOR_MAPPED_NOCREATE |
-              TH_ALLOCATOR_MAPPED_KEEPFD |
-              TH_ALLOCATOR_MAPPED_FROMFD;
   return THPStorage_(New)(
           THWStorage_(newWithDataAndAllocator)(
             // TODO: Maybe we should read out the scalar_t size and use it for size
-            THMapAllocator::makeDataPtr(WITH_FD, nullptr, fd, flags, size * sizeof(scalar_t), nullptr),
+            THPooledMapAllocator::makeDataPtr(WITH_FD, fd, size * sizeof(scalar_t), nullptr),
             size, /* allocator */ nullptr));
   END_HANDLE_TH_ERRORS
 }
@@ -341,7 +344,10 @@ PyObject * THPStorage_(sharedFd)(THPStorage *self)
   THMapAllocator *ctx = nullptr;
 #ifndef THC_GENERIC_FILE
   THWStorage *storage = self->cdata;
-  ctx = THMapAllocator::fromDataPtr(storage->data_ptr());
+  ctx = THPooledMapAllocator::fromDataPtr(storage->data_ptr());
+  if (!ctx) {
+    ctx = THMapAllocator::fromDataPtr(storage->data_ptr());
+  }
 #endif
 
   THPUtils_assert(ctx, "couldn't retrieve a shared file descriptor");
@@ -355,6 +361,7 @@ PyObject * THPStorage_(isShared)(THPStorage *self)
   Py_RETURN_TRUE;
 #else
   if (THMapAllocator::fromDataPtr(self->cdata->data_ptr()) ||
+      THPooledMapAllocator::fromDataPtr(self->cdata->data_ptr()) ||
       THManagedMapAllocator::fromDataPtr(self->cdata->data_ptr())) {
     Py_RETURN_TRUE;
   } else {
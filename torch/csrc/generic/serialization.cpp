@@ -45,6 +45,7 @@ void THPStorage_(writeFileRaw)(THWStorage *self, io fd)
 }
 
 template void THPStorage_(writeFileRaw<int>)(THWStorage *self, int fd);
+template void THPStorage_(writeFileRaw<THPFileAt*>)(THWStorage *self, THPFileAt* fd);
 template void THPStorage_(writeFileRaw<PyObject*>)(THWStorage *self, PyObject* fd);
 
 template <class io>
@@ -57,9 +58,10 @@ THWStorage * THPStorage_(readFileRaw)(io file, THWStorage *_storage)
   if (_storage == nullptr) {
     storage = THWStorage_(newWithSize)(LIBRARY_STATE size);
   } else {
-    THPUtils_assert(THWStorage_(size)(LIBRARY_STATE _storage) == size,
-        "storage has wrong size: expected %ld got %ld",
-        size, THWStorage_(size)(LIBRARY_STATE _storage));
+    // Not THPUtils_assert, the GIL may be released
+    AT_CHECK(THWStorage_(size)(LIBRARY_STATE _storage) == size,
+        "storage has wrong size: expected ", size, " got ",
+        THWStorage_(size)(LIBRARY_STATE _storage));
     storage = _storage;
   }
 
@@ -108,6 +110,7 @@ THWStorage * THPStorage_(readFileRaw)(io file, THWStorage *_storage)
 }
 
 template THWStorage* THPStorage_(readFileRaw<int>)(int fd, THWStorage* storage);
+template THWStorage* THPStorage_(readFileRaw<THPFileAt*>)(THPFileAt* fd, THWStorage* storage);
 template THWStorage* THPStorage_(readFileRaw<PyObject*>)(PyObject* fd, THWStorage* storage);
 
 #endif
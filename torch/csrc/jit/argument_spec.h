@@ -70,34 +70,49 @@ struct ArgumentSpec {
   }
 
   void addInput(const IValue& input, size_t& offset, bool with_grad) {
+    if (input.isTuple()) {
+      for (const IValue & elem : input.toTuple()->elements()) {
+        addInput(elem, offset, with_grad);
+      }
+      return;
+    }
+    JIT_ASSERT(offset < args.size());
     auto & arg = args[offset];
+    fillInfo(arg, input, with_grad);
+    combineHash(arg);
+    offset++;
+  }
+
+  static void fillInfo(ArgumentInfo& arg, const IValue& input, bool with_grad) {
     // Initialize all fields to 0. This is convenient, because e.g.
     // requires_grad() can be checked even on tensors AND will make
     // padding bits all 0s.
     std::memset(&arg, 0, sizeof(ArgumentInfo));
     if (input.isTensor()) {
-      JIT_ASSERT(offset < args.size());
       at::Tensor t = input.toTensor();
       if ((arg.defined_ = t.defined())) {
-        arg.requires_grad_ = with_grad && autograd::Variable(t).requires_grad();
+        arg.requires_grad_ = with_grad && autograd::as_variable_ref(t).requires_grad();
         arg.dim_ = t.dim();
         arg.device_ = t.type().is_cuda() ? t.get_device() : -1;
         arg.type_ = static_cast<unsigned>(t.type().scalarType());
       }
-
       arg.is_tensor_ = true;
-      combineHash(arg);
-      offset++;
-    } else if (input.isTuple()) {
-      for (const IValue & elem : input.toTuple()->elements()) {
-        addInput(elem, offset, with_grad);
+    }
+    // NB: no need to set is_tensor to false for other values, because we memset
+    // the struct to 0 above
+  }
+
+  // Returns true if an ArgumentSpec of inputs would be equal to this one,
+  // without allocating or hashing one. GraphExecutor uses it to check if the
+  // plan it ran last time can run this time too, which is the common case.
+  bool matches(bool with_grad, at::ArrayRef<IValue> inputs) const {
+    size_t offset = 0;
+    for (const IValue & input : inputs) {
+      if (!matchesInput(input, offset, with_grad)) {
+        return false;
       }
-    } else {
-      JIT_ASSERT(offset < args.size());
-      // NB: no need to set is_tensor to false, because we memset the struct to 0 above
-      combineHash(arg);
-      offset++;
     }
+    return offset == args.size();
   }
 
   void combineHash(const ArgumentInfo &arg) {
@@ -133,6 +148,23 @@ struct ArgumentSpec {
   }
 
 private:
+  bool matchesInput(const IValue& input, size_t& offset, bool with_grad) const {
+    if (input.isTuple()) {
+      for (const IValue & elem : input.toTuple()->elements()) {
+        if (!matchesInput(elem, offset, with_grad)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    if (offset >= args.size()) {
+      return false;
+    }
+    ArgumentInfo arg;
+    fillInfo(arg, input, with_grad);
+    return std::memcmp(&arg, &args[offset++], sizeof(ArgumentInfo)) == 0;
+  }
+
   TypePtr fillType(TypePtr original, size_t& offset) const {
     if (original->isSubtypeOf(DynamicType::get())) {
       auto & arg = args.at(offset++);
@@ -0,0 +1,141 @@
+#include "DynamicBatcher.h"
+
+#include "torch/csrc/autograd/grad_mode.h"
+#include "torch/csrc/jit/batched/BatchTensor.h"
+#include "torch/csrc/jit/pybind_utils.h"
+#include "torch/csrc/utils/auto_gil.h"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace torch { namespace jit {
+
+DynamicBatcher::DynamicBatcher(
+    std::shared_ptr<Graph> batched_graph,
+    std::vector<at::Tensor> input_dims,
+    size_t max_batch_size,
+    std::chrono::microseconds max_delay,
+    bool optimize)
+  : executor(std::move(batched_graph), optimize)
+  , input_dims(std::move(input_dims))
+  , max_batch_size(max_batch_size)
+  , max_delay(max_delay) {
+  AT_CHECK(max_batch_size > 0, "max_batch_size has to be positive");
+  AT_CHECK(executor.graph()->inputs().size() == 3 * this->input_dims.size(),
+      "expected a graph that takes a (data, mask, dims) triple for each of the ",
+      this->input_dims.size(), " inputs");
+  worker = std::thread(&DynamicBatcher::workerMain, this);
+}
+
+DynamicBatcher::~DynamicBatcher() {
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    stopping = true;
+  }
+  cv.notify_one();
+  worker.join();
+}
+
+std::future<std::vector<at::Tensor>> DynamicBatcher::submit(std::vector<at::Tensor> inputs) {
+  AT_CHECK(inputs.size() == input_dims.size(),
+      "expected ", input_dims.size(), " inputs, but got ", inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    AT_CHECK(inputs[i].dim() == input_dims[i].size(0),
+        "expected input ", i, " to have ", input_dims[i].size(0), " dims, but it has ",
+        inputs[i].dim());
+  }
+  Request request;
+  request.inputs = std::move(inputs);
+  request.arrival = std::chrono::steady_clock::now();
+  auto result = request.result.get_future();
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    queue.push_back(std::move(request));
+    if (queue.size() < max_batch_size && queue.size() > 1) {
+      // the worker is already waiting for this batch to fill up or time out
+      return result;
+    }
+  }
+  cv.notify_one();
+  return result;
+}
+
+void DynamicBatcher::workerMain() {
+  autograd::AutoGradMode no_grad(false);
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    cv.wait(lock, [this] { return stopping || !queue.empty(); });
+    if (queue.empty()) {
+      return;
+    }
+    auto deadline = queue.front().arrival + max_delay;
+    cv.wait_until(lock, deadline, [this] {
+      return stopping || queue.size() >= max_batch_size;
+    });
+    std::vector<Request> batch;
+    size_t batch_size = std::min(queue.size(), max_batch_size);
+    for (size_t i = 0; i < batch_size; ++i) {
+      batch.push_back(std::move(queue.front()));
+      queue.pop_front();
+    }
+    lock.unlock();
+    runBatch(batch);
+    lock.lock();
+  }
+}
+
+void DynamicBatcher::runBatch(std::vector<Request>& batch) {
+  try {
+    Stack stack;
+    for (size_t i = 0; i < input_dims.size(); ++i) {
+      std::vector<at::Tensor> examples;
+      for (auto& request : batch) {
+        examples.push_back(request.inputs[i].unsqueeze(0));
+      }
+      BatchTensor input(examples, input_dims[i]);
+      stack.emplace_back(input.get_data());
+      stack.emplace_back(input.get_mask());
+      stack.emplace_back(input.get_dims());
+    }
+    executor.run(stack);
+    AT_CHECK(stack.size() % 3 == 0, "outputs of batched graphs have to be BatchTensors");
+
+    std::vector<std::vector<at::Tensor>> results(batch.size());
+    for (size_t i = 0; i < stack.size(); i += 3) {
+      BatchTensor output(stack[i].toTensor(), stack[i + 1].toTensor(), stack[i + 2].toTensor());
+      auto examples = output.examples();
+      JIT_ASSERT(examples.size() == batch.size());
+      for (size_t j = 0; j < batch.size(); ++j) {
+        results[j].push_back(examples[j].squeeze(0));
+      }
+    }
+    for (size_t j = 0; j < batch.size(); ++j) {
+      batch[j].result.set_value(std::move(results[j]));
+    }
+  } catch (...) {
+    for (auto& request : batch) {
+      request.result.set_exception(std::current_exception());
+    }
+  }
+}
+
+void initDynamicBatcherBindings(PyObject* module) {
+  auto m = py::handle(module).cast<py::module>();
+  auto jit = m.def_submodule("_jit");
+  py::class_<DynamicBatcher, std::shared_ptr<DynamicBatcher>>(jit, "DynamicBatcher")
+      .def(py::init([](std::shared_ptr<Graph> graph, std::vector<at::Tensor> dims,
+                       size_t max_batch_size, int64_t max_delay_us, bool optimize) {
+        return std::make_shared<DynamicBatcher>(
+            std::move(graph), std::move(dims), max_batch_size,
+            std::chrono::microseconds(max_delay_us), optimize);
+      }))
+      .def("__call__", [](DynamicBatcher& self, std::vector<at::Tensor> inputs) {
+        auto result = self.submit(std::move(inputs));
+        // other requests have to be able to come in while this one waits
+        AutoNoGIL no_gil;
+        return result.get();
+      });
+}
+
+}} // namespace torch::jit
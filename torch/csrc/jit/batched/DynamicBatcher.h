@@ -0,0 +1,64 @@
+#pragma once
+#include "ATen/ATen.h"
+#include "torch/csrc/jit/graph_executor.h"
+#include "torch/csrc/jit/ir.h"
+#include "torch/csrc/jit/pybind.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace torch { namespace jit {
+
+// Serves concurrent requests for a graph transformed by to_batch_graph.
+// Requests that arrive close enough to each other are padded into BatchTensors,
+// run through the batched graph together on a background thread, and the
+// examples of the results are handed back to each request.
+//
+// A batch is run as soon as it has max_batch_size requests, or max_delay after
+// its first request arrived, whichever comes first. Batches run without grad.
+struct DynamicBatcher {
+  // input_dims has one entry per input of the unbatched function, which says
+  // which of the dims of that input are dynamic, as BatchTensor::dims does.
+  DynamicBatcher(
+      std::shared_ptr<Graph> batched_graph,
+      std::vector<at::Tensor> input_dims,
+      size_t max_batch_size,
+      std::chrono::microseconds max_delay,
+      bool optimize = true);
+  // Runs the requests that are still queued before returning.
+  ~DynamicBatcher();
+
+  // inputs are the inputs of one example, without a batch dim. The future
+  // holds the outputs of the example, also without one.
+  std::future<std::vector<at::Tensor>> submit(std::vector<at::Tensor> inputs);
+
+private:
+  struct Request {
+    std::vector<at::Tensor> inputs;
+    std::promise<std::vector<at::Tensor>> result;
+    std::chrono::steady_clock::time_point arrival;
+  };
+
+  void workerMain();
+  void runBatch(std::vector<Request>& batch);
+
+  GraphExecutor executor;
+  const std::vector<at::Tensor> input_dims;
+  const size_t max_batch_size;
+  const std::chrono::microseconds max_delay;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Request> queue;
+  bool stopping = false;
+  std::thread worker;
+};
+
+void initDynamicBatcherBindings(PyObject* module);
+}} // namespace torch::jit
@@ -12,11 +12,16 @@
 #include <ATen/ATen.h>
 #include "c10/util/Optional.h"
 
+#include <atomic>
+#include <cctype>
+#include <exception>
 #include <memory>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <thread>
+#include <unordered_set>
 
 namespace torch { namespace jit {
 
@@ -357,6 +362,82 @@ void EncoderBase::AddAttribute(onnx::NodeProto *node_proto, const jit::Node *nod
   }
 }
 
+// Writes tensors to files of a directory, by up to num_threads threads. The
+// tensors are only made contiguous and copied to the CPU by the thread that
+// writes them, so at most num_threads such copies are alive at a time.
+class ExternalDataWriter {
+ public:
+  ExternalDataWriter(std::string directory, size_t num_threads)
+      : directory_(std::move(directory)),
+        num_threads_(std::max<size_t>(num_threads, 1)) {}
+
+  // Returns the file name, relative to the directory, that tensor will be
+  // written to
+  std::string add(const std::string& name, const at::Tensor& tensor) {
+    std::string location = name;
+    for (char& c : location) {
+      if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_' && c != '-') {
+        c = '_';
+      }
+    }
+    if (location.empty() || location[0] == '.') {
+      location = "_" + location;
+    }
+    const std::string base = location;
+    for (size_t i = 1; !locations_.insert(location).second; ++i) {
+      location = base + "_" + std::to_string(i);
+    }
+    files_.emplace_back(location, tensor);
+    return location;
+  }
+
+  void write() {
+    std::atomic<size_t> next{0};
+    std::vector<std::exception_ptr> errors(num_threads_);
+    auto work = [&](size_t thread) {
+      try {
+        for (size_t i = next++; i < files_.size(); i = next++) {
+          writeFile(files_[i].first, files_[i].second);
+          // release the tensor as soon as it has been written
+          files_[i].second = at::Tensor();
+        }
+      } catch (...) {
+        errors[thread] = std::current_exception();
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t thread = 1; thread < std::min(num_threads_, files_.size()); ++thread) {
+      threads.emplace_back(work, thread);
+    }
+    work(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (const auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+ private:
+  void writeFile(const std::string& location, const at::Tensor& tensor) {
+    auto t = tensor.contiguous().cpu();
+    const std::string path = directory_ + "/" + location;
+    std::ofstream out(path, std::ios_base::binary);
+    out.write(
+        static_cast<const char*>(t.data_ptr()),
+        t.type().elementSizeInBytes() * t.numel());
+    out.close();
+    AT_CHECK(out, "Failed to write external tensor data to ", path);
+  }
+
+  std::string directory_;
+  size_t num_threads_;
+  std::unordered_set<std::string> locations_;
+  std::vector<std::pair<std::string, at::Tensor>> files_;
+};
+
 class GraphEncoder: public EncoderBase {
  public:
   GraphEncoder(const std::shared_ptr<Graph> &graph,
@@ -364,7 +445,8 @@ class GraphEncoder: public EncoderBase {
                onnx_torch::OperatorExportTypes operator_export_type,
                const std::vector<at::Tensor> &initializers,
                bool defer_weight_export,
-               bool strip_doc);
+               bool strip_doc,
+               ExternalDataWriter* external_data_writer = nullptr);
 
   RawDataExportMap get_raw_data_export_map() {
     return raw_data_export_map_;
@@ -378,6 +460,7 @@ class GraphEncoder: public EncoderBase {
 
   RawDataExportMap raw_data_export_map_;
   bool defer_weight_export_;
+  ExternalDataWriter* external_data_writer_;
 };
 
 GraphEncoder::GraphEncoder(
@@ -386,9 +469,11 @@ GraphEncoder::GraphEncoder(
     onnx_torch::OperatorExportTypes operator_export_type,
     const std::vector<at::Tensor> &initializers,
     bool defer_weight_export,
-    bool strip_doc)
+    bool strip_doc,
+    ExternalDataWriter* external_data_writer)
     : EncoderBase(operator_export_type, strip_doc),
-      defer_weight_export_(defer_weight_export) {
+      defer_weight_export_(defer_weight_export),
+      external_data_writer_(external_data_writer) {
   if (operator_export_type != onnx_torch::OperatorExportTypes::RAW) {
     validateGraph(graph, operator_export_type);
   }
@@ -408,6 +493,16 @@ void GraphEncoder::EncodeTensor(
     tensor_proto->add_dims(d);
   }
   tensor_proto->set_data_type(ATenTypeToOnnxType(tensor.type().scalarType()));
+  // ONNX external data: the proto only references the file that the writer
+  // stores the data in, relative to the directory of the model
+  if (external_data_writer_ && external_ref) {
+    auto location = external_data_writer_->add(external_ref.value(), tensor);
+    tensor_proto->set_data_location(onnx::TensorProto_DataLocation_EXTERNAL);
+    auto* entry = tensor_proto->add_external_data();
+    entry->set_key("location");
+    entry->set_value(location);
+    return;
+  }
   // CPU's HalfTensor doesn't have contiguous(), so first calling contiguous()
   auto t = tensor.contiguous().cpu();
   // Add a buffer to the raw_data_export_map for the caller to dump into an
@@ -429,7 +524,8 @@ void GraphEncoder::EncodeTensor(
 class ModuleEncoder: public EncoderBase {
  public:
   ModuleEncoder(const script::Module &module,
-                std::ostream& out);
+                std::ostream& out,
+                const Stack* inference_inputs = nullptr);
 
  private:
   void EncodeModule(onnx::GraphProto *graph_proto, const script::Module &module);
@@ -476,13 +572,18 @@ class ModuleEncoder: public EncoderBase {
 
   // Used to create sequential dummy names for node types
   size_t type_counter_ = 0;
+
+  // If set, forward is exported optimized for these inputs
+  const Stack* inference_inputs_;
 };
 
 ModuleEncoder::ModuleEncoder(
     const script::Module &module,
-    std::ostream& out)
+    std::ostream& out,
+    const Stack* inference_inputs)
     : EncoderBase(onnx_torch::OperatorExportTypes::RAW, false),
-      stream_writer_(out) {
+      stream_writer_(out),
+      inference_inputs_(inference_inputs) {
   model_proto_.set_doc_string("THIS PROTO IS NOT STANDARD ONNX");
   EncodeModule(model_proto_.mutable_graph(), module);
 }
@@ -635,6 +736,8 @@ void ModuleEncoder::EncodeMethods(
     const std::string prefix) {
   // Encode each parameter as a initializer in the proto
   for (auto &method : module.get_methods()) {
+    // methods that are compiled lazily have to be compiled to be saved
+    method.value->ensure_defined();
     auto node_proto = graph_proto->add_node();
     EncodeMethod(node_proto, *method.value, prefix);
   }
@@ -649,7 +752,12 @@ void ModuleEncoder::EncodeMethod(
     script::Method &method,
     const std::string prefix) {
   node_proto->set_name(prefix + method.name());
-  if (method.is_optimized()) {
+  // Methods exported optimized already aren't marked, so that the importer
+  // creates them without optimizations.
+  std::shared_ptr<Graph> graph = method.graph();
+  if (inference_inputs_ && prefix.empty() && method.name() == "forward") {
+    graph = method.graph_for_inference(*inference_inputs_);
+  } else if (method.is_optimized()) {
     // mark that this method was optimized
     node_proto->set_domain("optimized");
   }
@@ -667,7 +775,7 @@ void ModuleEncoder::EncodeMethod(
   auto attr_proto = node_proto->add_attribute();
   attr_proto->set_type(onnx::AttributeProto_AttributeType_GRAPH);
 
-  for (auto node : method.graph()->nodes()) {
+  for (auto node : graph->nodes()) {
     if (node->kind() == prim::PythonOp) {
       auto py_node = static_cast<torch::jit::PythonOp*>(node);
       throw std::runtime_error(
@@ -675,7 +783,7 @@ void ModuleEncoder::EncodeMethod(
           "\n\nDefined at:\n" + getNodeStackTraceString(node));
     }
   }
-  EncodeBlock(attr_proto->mutable_g(), method.graph()->block(), {});
+  EncodeBlock(attr_proto->mutable_g(), graph->block(), {});
 }
 
 void ModuleEncoder::EncodeTensor(
@@ -926,6 +1034,25 @@ std::tuple<std::string, RawDataExportMap> ExportGraph(
                          graph_encoder.get_raw_data_export_map());
 }
 
+std::string ExportGraphWithExternalData(
+    const std::shared_ptr<Graph>& graph,
+    const std::vector<at::Tensor>& initializers,
+    int64_t onnx_opset_version,
+    const std::string& directory,
+    size_t num_threads,
+    ::torch::onnx::OperatorExportTypes operator_export_type) {
+  ExternalDataWriter writer(directory, num_threads);
+  std::string model_proto;
+  {
+    auto graph_encoder = GraphEncoder(
+      graph, onnx_opset_version, operator_export_type, initializers,
+      /*defer_weight_export=*/false, false, &writer);
+    model_proto = graph_encoder.get_model_proto().SerializeAsString();
+  }
+  writer.write();
+  return model_proto;
+}
+
 void ExportModule(const script::Module& module, std::ostream& out) {
   ModuleEncoder(module, out);
 }
@@ -936,4 +1063,21 @@ void ExportModule(const script::Module& module, const std::string &filename) {
   ExportModule(module, out);
 }
 
+void ExportModuleForInference(
+    const script::Module& module,
+    std::ostream& out,
+    const Stack& example_inputs) {
+  AT_CHECK(module.get_methods().find("forward"), "Attempted to export a Module without a forward() for inference");
+  ModuleEncoder(module, out, &example_inputs);
+}
+
+void ExportModuleForInference(
+    const script::Module& module,
+    const std::string& filename,
+    const Stack& example_inputs) {
+  std::ofstream out(filename, std::ios_base::binary);
+
+  ExportModuleForInference(module, out, example_inputs);
+}
+
 }}
@@ -26,6 +26,22 @@ TORCH_API std::tuple<std::string, RawDataExportMap> ExportGraph(
     ::torch::onnx::OperatorExportTypes operator_export_type
       = ::torch::onnx::OperatorExportTypes::ONNX);
 
+// Exports like ExportGraph, except that the data of every initializer is
+// written to its own file in directory instead of the proto, referenced through
+// ONNX external data (data_location EXTERNAL, with the file name relative to
+// directory as "location"). The proto then stays small, so models over the 2GB
+// limit of protobuf can be exported, and the tensors are written by
+// num_threads threads without collecting copies of them in memory. Returns the
+// serialized model, which should be saved in directory too.
+TORCH_API std::string ExportGraphWithExternalData(
+    const std::shared_ptr<Graph>& graph,
+    const std::vector<at::Tensor>& initializers,
+    int64_t onnx_opset_version,
+    const std::string& directory,
+    size_t num_threads = 4,
+    ::torch::onnx::OperatorExportTypes operator_export_type
+      = ::torch::onnx::OperatorExportTypes::ONNX);
+
 // For testing purposes
 TORCH_API std::string PrettyPrintExportedGraph(
     const std::shared_ptr<Graph>& graph,
@@ -44,4 +60,20 @@ TORCH_API void ExportModule(
     const script::Module& module,
     const std::string& filename);
 
+// Exports the module like ExportModule, except that its forward method is
+// stored with the graph the GraphExecutor optimized for inputs like
+// example_inputs with gradients disabled (constants propagated, fusion groups
+// formed, ...), and marked so that it isn't optimized again when loaded.
+// Fused kernels themselves aren't part of the export; point
+// PYTORCH_FUSION_CACHE_DIR at a shared directory to reuse them across processes.
+TORCH_API void ExportModuleForInference(
+    const script::Module& module,
+    std::ostream& out,
+    const Stack& example_inputs);
+
+TORCH_API void ExportModuleForInference(
+    const script::Module& module,
+    const std::string& filename,
+    const Stack& example_inputs);
+
 }}
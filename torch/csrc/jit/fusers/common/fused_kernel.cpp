@@ -178,7 +178,10 @@ void FusedKernel::launch_with_tensors(
   for (size_t i = 0; i < output_desc.size(); ++i) {
     auto & c = concat_desc[i];
     at::Tensor o = outputs[i];
-    if (c.isNoop()) {
+    if (!reduction_desc.empty() && !reduction_desc[i].isNoop()) {
+      o.resize_(reduction_desc[i].outputSizes(map_size));
+      addTensorInfo(output_desc[i], outputs[i]);
+    } else if (c.isNoop()) {
       o.resize_(map_size);
       addTensorInfo(output_desc[i], outputs[i]);
     } else {
@@ -198,6 +201,19 @@ void FusedKernel::launch_with_tensors(
     }
   }
 
+  // Kernels with reductions run once per reduced element, each reducing the
+  // reduce_size elements of the innermost dims of the map that it covers.
+  uint32_t reduce_size = 1;
+  if (hasReduction()) {
+    auto reduction = std::find_if(reduction_desc.begin(), reduction_desc.end(),
+                                  [](const ReductionDesc& r) { return !r.isNoop(); });
+    JIT_ASSERT(map_size.size() >= reduction->nDims);
+    size_t outer_dims = map_size.size() - reduction->nDims;
+    numel = computeNumel(map_size.slice(0, outer_dims));
+    reduce_size = computeNumel(map_size.slice(outer_dims));
+    arguments.push_back(&reduce_size);
+  }
+
   // If the kernel call contains a random op, we need to pass in random seeds as
   // well.
   #if USE_CUDA_FUSER
@@ -324,6 +340,7 @@ static std::string encodeRHS(Node* n) {
     {aten::le, "(${0} <= ${1})"},
     {aten::lt, "${0} < ${1}"},
     {aten::type_as, "(${0})"}, //everything is implicitly convertible to float
+    {aten::expand, "${0}"}, // inputs are expanded to the map size before the kernel runs
     {aten::mul, "${0} * ${1}"},
     {aten::ne, "${0} != ${1}"},
     {aten::remainder, "remainderf(${0}, ${1})"},
@@ -380,11 +397,13 @@ static void emitIndexingFor(
   std::ostream& out
 , const std::string& tensor
 , int ndim
-, bool last_is_cont) {
+, bool last_is_cont
+, const std::string& index) {
   TemplateEnv env;
   env.s("tensor",tensor);
+  env.s("index",index);
   out << format("IndexType ${tensor}_offset = 0;\n",env);
-  out << format("IndexType ${tensor}_linearIndex = linearIndex;\n",env);
+  out << format("IndexType ${tensor}_linearIndex = ${index};\n",env);
   for (int d = ndim - 1; d >= 0; --d) {
     env.d("d",d);
     env.s("mod_sizes", d > 0 ? format("% ${tensor}.sizes[${d}]",env) : "");
@@ -397,10 +416,20 @@ static void emitIndexingFor(
   }
 }
 
-// Returns: (input chunk metadata, output concat metadata, is_random)
+// Other constants (the dims of a reduction, the size of an expand) only
+// parametrize a node, and don't become values in the kernel
+static bool isScalarConstant(Node* n) {
+  JIT_ASSERT(n->kind() == prim::Constant);
+  auto val = toIValue(n->output()).value();
+  return val.isDouble() || val.isInt();
+}
+
+// Returns: (input chunk metadata, output concat metadata,
+//           output reduction metadata, is_random)
 std::tuple<
     std::vector<PartitionDesc>
   , std::vector<PartitionDesc>
+  , std::vector<ReductionDesc>
   , bool> 
   emitCompilationUnit(
     std::ostream& out
@@ -416,12 +445,23 @@ std::tuple<
 
   std::stringstream body;
   std::stringstream tensorOffsets;
+  // only used by kernels with reductions
+  std::stringstream reduceOffsets;
+  std::stringstream reduceShared;
+  std::stringstream reduceInit;
+  std::stringstream reduceCombine;
+  std::stringstream reduceEpilogue;
   std::vector<std::string> formals;
   std::vector<std::string> argument_loads;
-  auto emitFormal = [&](Value * n, const TensorDesc & desc) {
+  // reduced outputs are indexed by the element they reduce into
+  auto emitFormal = [&](Value * n, const TensorDesc & desc, bool reduced) {
     std::string tensor = "t" + std::to_string(formals.size()); //can't be unique() because Param may be an output
     size_t nDim = desc.nDim();
-    emitIndexingFor(tensorOffsets, tensor, nDim,  desc.lastIsContiguous());
+    if (reduced) {
+      emitIndexingFor(reduceOffsets, tensor, nDim, desc.lastIsContiguous(), "reduceIndex");
+    } else {
+      emitIndexingFor(tensorOffsets, tensor, nDim, desc.lastIsContiguous(), "linearIndex");
+    }
     env.s("tensor",tensor);
     env.d("formal_index", formals.size() + 1); // + 1 because the first argument is the linearIndex
     env.d("nDim",nDim);
@@ -448,31 +488,58 @@ std::tuple<
       }
     }
     for (auto & input : flat_inputs) {
-      emitFormal(input.first, input.second);
+      emitFormal(input.first, input.second, /*reduced=*/false);
     }
   }
 
   std::vector<PartitionDesc> concat_desc;
+  std::vector<ReductionDesc> reduction_desc;
   std::vector<std::pair<Value*,TensorDesc>> flat_output_nodes;
   {
     size_t i = 0;
     for(auto o : subgraph.outputs()) {
       auto & desc = agraph.output_desc[i++];
-      if(o->node()->kind() != prim::FusedConcat) {
-        emitFormal(o, desc);
-        concat_desc.emplace_back();
-        flat_output_nodes.emplace_back(o, desc);
-      } else {
+      if(o->node()->kind() == prim::FusedConcat) {
         auto cat = o->node();
         concat_desc.emplace_back(desc, cat->inputs().size(), cat->i(attr::dim));
+        reduction_desc.emplace_back();
         for(auto c : cat->inputs()) {
-          emitFormal(c, *concat_desc.back().subtensorDesc);
+          emitFormal(c, *concat_desc.back().subtensorDesc, /*reduced=*/false);
           flat_output_nodes.emplace_back(c, desc);
         }
+      } else if (ReductionDesc::isReduction(o->node())) {
+        emitFormal(o, desc, /*reduced=*/true);
+        concat_desc.emplace_back();
+        reduction_desc.emplace_back(o->node());
+        flat_output_nodes.emplace_back(o, desc);
+      } else {
+        emitFormal(o, desc, /*reduced=*/false);
+        concat_desc.emplace_back();
+        reduction_desc.emplace_back();
+        flat_output_nodes.emplace_back(o, desc);
       }
     }
   }
 
+  // All reductions of a kernel share its loop over the innermost dims, which
+  // the graph fuser guarantees by only fusing reductions of the same dims.
+  bool has_reduction = false;
+  for (auto & r : reduction_desc) {
+    if (r.isNoop())
+      continue;
+    for (auto & other : reduction_desc) {
+      JIT_ASSERT(other.isNoop() || other.nDims == r.nDims);
+    }
+    has_reduction = true;
+  }
+  if (has_reduction) {
+    env.d("formal_index", formals.size() + 1);
+    formals.push_back("IndexType reduceSize");
+    argument_loads.push_back(format("*static_cast<IndexType*>(args[${formal_index}])", env));
+  } else {
+    reduction_desc.clear();
+  }
+
   #if USE_CUDA_FUSER
     bool has_half_tensor = false;
   #endif // USE_CUDA_FUSER
@@ -506,6 +573,11 @@ std::tuple<
       continue;
     if (n->kind() == prim::ConstantChunk)
       continue;
+    if (n->kind() == prim::Constant && !isScalarConstant(n))
+      continue;
+    // Reduced values only exist in their accumulators, see below
+    if (ReductionDesc::isReduction(n))
+      continue;
     if (n->kind() == aten::rand_like) {
       has_random = true;
       if (!use_cuda)
@@ -522,19 +594,56 @@ std::tuple<
     env.s("access",format("t${formal}.data[t${formal}_offset]",env));
     env.s("node",valueName(o));
 
+    // Reductions accumulate every element of the map, and write their
+    // result once all elements of a reduced element have been seen
+    bool is_reduction = ReductionDesc::isReduction(o->node());
+    std::ostream& write = is_reduction ? reduceEpilogue : body;
+    if (is_reduction) {
+      Node* reduction = o->node();
+      env.s("acc", "acc" + std::to_string(formal_count - 1));
+      env.s("input", valueName(reduction->input(0)));
+      env.s("acc_scalar", output.second.scalar_type == at::kDouble ? "double" : "float");
+      if (reduction->kind() == aten::sum || reduction->kind() == aten::mean) {
+        env.s("acc_type", format("${acc_scalar}", env));
+        env.s("combine", "reduceAdd");
+        reduceInit << format("${acc_type} ${acc} = 0;\n", env);
+        body << format("${acc} += ${input};\n", env);
+        env.s("node", format(reduction->kind() == aten::sum ? "${acc}" : "${acc} / reduceSize", env));
+      } else {
+        env.s("acc_type", format("Welford<${acc_scalar}>", env));
+        env.s("combine", "welfordCombine");
+        env.s("unbiased", reduction->get<bool>(attr::unbiased).value() ? "true" : "false");
+        reduceInit << format("${acc_type} ${acc} = {0, 0, 0};\n", env);
+        body << format("welfordUpdate(${acc}, ${input});\n", env);
+        env.s("node", format(reduction->kind() == aten::var
+                               ? "welfordVar(${acc}, ${unbiased})"
+                               : "sqrt(welfordVar(${acc}, ${unbiased}))", env));
+      }
+      if (use_cuda) {
+        #if USE_CUDA_FUSER
+          reduceShared << format("__shared__ ${acc_type} ${acc}_buffer[REDUCE_BLOCK_SIZE];\n", env);
+          reduceCombine << cudafuser::cuda_block_reduce_template.format(env);
+        #endif // USE_CUDA_FUSER
+      }
+    }
+
     // Acquires and converts (if needed) outputs
     bool is_half = output.second.scalar_type == at::ScalarType::Half;
     if (is_half) {
       AT_ASSERT(use_cuda);
       #if USE_CUDA_FUSER
-        body << format("${access} = __float2half(${node});\n",env);
+        write << format("${access} = __float2half(${node});\n",env);
         has_half_tensor = true;
       #endif // USE_CUDA_FUSER
     } else {
-      body << format("${access} = ${node};\n",env);
+      write << format("${access} = ${node};\n",env);
     }
   }
 
+  if (has_random && has_reduction) {
+    throw std::runtime_error("Fusion doesn't support rand in reductions");
+  }
+
   // Includes half support if any half tensors are involved
   #if USE_CUDA_FUSER
     if (has_half_tensor) {
@@ -556,21 +665,37 @@ std::tuple<
 
   env.s("tensorOffsets", tensorOffsets.str());
   env.s("kernelBody", body.str());
+  env.s("reduceOffsets", reduceOffsets.str());
+  env.s("reduceShared", reduceShared.str());
+  env.s("reduceInit", reduceInit.str());
+  env.s("reduceCombine", reduceCombine.str());
+  env.s("reduceEpilogue", reduceEpilogue.str());
   env.v("formals", formals);
   env.v("argument_loads", argument_loads);
   if (use_cuda) {
     #if USE_CUDA_FUSER
       env.s("type_declarations", cudafuser::type_declarations_template.format(env));
-      out << cudafuser::cuda_compilation_unit_template.format(env);
+      if (has_reduction) {
+        env.s("ReduceHeader", cudafuser::reduction_support_literal);
+        out << cudafuser::cuda_reduction_compilation_unit_template.format(env);
+      } else {
+        out << cudafuser::cuda_compilation_unit_template.format(env);
+      }
     #else
       throw std::runtime_error("CUDA Fusion requested but not supported.");
     #endif // USE_CUDA_FUSER
   } else {
     env.s("type_declarations", cpufuser::type_declarations_template.format(env));
-    out << cpufuser::cpu_compilation_unit_template.format(env);
+    if (has_reduction) {
+      env.s("ReduceHeader", cpufuser::reduction_support_literal);
+      out << cpufuser::cpu_reduction_compilation_unit_template.format(env);
+    } else {
+      out << cpufuser::cpu_compilation_unit_template.format(env);
+    }
   }
 
-  return std::make_tuple(std::move(chunk_desc), std::move(concat_desc), has_random);
+  return std::make_tuple(
+    std::move(chunk_desc), std::move(concat_desc), std::move(reduction_desc), has_random);
 }
 
 } // namespace jit
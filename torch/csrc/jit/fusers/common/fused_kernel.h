@@ -5,18 +5,24 @@
 #include "torch/csrc/jit/fusers/common/annotated_graph.h"
 #include "torch/csrc/jit/fusers/common/tensor_desc.h"
 #include "torch/csrc/jit/fusers/common/partition_desc.h"
+#include "torch/csrc/jit/fusers/common/reduction_desc.h"
 
 #include "torch/csrc/utils/disallow_copy.h"
 
 #include "ATen/ATen.h"
 
+#include <algorithm>
 #include <string>
 #include <cstdint>
 #include <vector>
 
 namespace torch { namespace jit {
 
-std::tuple<std::vector<PartitionDesc>, std::vector<PartitionDesc>, bool> emitCompilationUnit(
+std::tuple<
+    std::vector<PartitionDesc>
+  , std::vector<PartitionDesc>
+  , std::vector<ReductionDesc>
+  , bool> emitCompilationUnit(
   std::ostream& out
 , const std::string& name
 , AnnotatedGraph& agraph
@@ -59,6 +65,9 @@ protected:
   // Currently the first argument is a pointer to numel (for passing to
   // CUDA code), and the remainder are pointers to the TensorInfo<T> structs
   // that compiled code uses to load Tensor data.
+  // Kernels with reductions are passed the number of reduced elements as
+  // numel, and the number of map elements reduced into each of them as an
+  // additional argument after the TensorInfos.
   // launch_with_tensors handles packing at::Tensors into this arguments array.
   // CPU code uses the same convension so that launch_with_tensors can be shared.
   virtual void launch_raw(uint32_t numel, void** arguments) = 0;
@@ -80,6 +89,16 @@ protected:
   // input should be broken into subtensors (chunks)
   // to be consumed by the fusion group
   std::vector<PartitionDesc> chunk_desc;
+
+  // same size as output_desc (or empty if there are no
+  // reductions), describes whether an output is a
+  // reduction over the innermost dims of the map
+  std::vector<ReductionDesc> reduction_desc;
+
+  bool hasReduction() const {
+    return std::any_of(reduction_desc.begin(), reduction_desc.end(),
+                       [](const ReductionDesc& r) { return !r.isNoop(); });
+  }
 };
 
 } // namespace jit 
@@ -35,7 +35,19 @@ struct FusionArgSpec {
     return descs_;
   }
 
+  // The spec of a kernel that assumes nothing about the strides of its
+  // inputs, and so can run any inputs of the same ranks and types.
+  FusionArgSpec strided() const {
+    return FusionArgSpec(fmap(descs_, [](const TensorDesc& d) {
+      return TensorDesc(d.scalar_type, std::vector<bool>(d.contiguity.size(), false));
+    }));
+  }
+
 private:
+  FusionArgSpec(std::vector<TensorDesc> descs)
+  : descs_(std::move(descs))
+  , hash_code_(torch::get_hash(descs_.size(), descs_)) {}
+
   std::vector<TensorDesc> descs_;
   size_t hash_code_;
 };
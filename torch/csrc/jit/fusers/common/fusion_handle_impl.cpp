@@ -4,10 +4,13 @@
 #include "torch/csrc/jit/fusers/common/fusion_arg_spec.h"
 #include "torch/csrc/jit/fusers/common/annotated_graph.h"
 #include "torch/csrc/jit/fusers/common/tensor_desc.h"
+#include "torch/csrc/jit/fusers/common/reduction_desc.h"
 #include "torch/csrc/jit/fusers/cpu/fused_kernel.h"
 #include "torch/csrc/jit/fusers/cpu/fusion_compiler.h"
+#include "torch/csrc/jit/fusers/cpu/interpreted_kernel.h"
 #include "torch/csrc/jit/fusers/cuda/fused_kernel.h"
 
+#include "torch/csrc/autograd/profiler.h"
 #include "torch/csrc/jit/interpreter.h"
 #include "torch/csrc/jit/ir.h"
 #include "torch/csrc/jit/custom_operator.h"
@@ -142,6 +145,12 @@ namespace torch { namespace jit {
 //
 //          This shows the part until post-chunk-inputs. Extending it to pre-chunk-inputs
 //          is straightforward (needs a simple lemma for moving expands through chunks).
+//
+// The graph fuser also absorbs aten::expand nodes of group inputs to constant sizes.
+// By Lemma 4. they are equivalent to passing the input as is and including the
+// expanded size in its broadcasting group, as long as the input can actually be
+// expanded to that size, which we check at run time as well. Reductions over the
+// innermost dims don't change the map size either; only their outputs are smaller.
 
 // Register implementations of fused operators, so that we can reuse the fused graph
 // to generate fallback code.
@@ -171,9 +180,11 @@ FusionHandleImpl::FusionHandleImpl(
 , graph(std::move(_graph))
 , input_broadcast_groups(getInputBroadcastGroups())
 , input_chunks(getInputChunkDescriptors())
+, input_expands(getInputExpands())
 , kernels() { }
 
 std::atomic<size_t> FusionHandleImpl::next_kernel_id {0};
+constexpr size_t FusionHandleImpl::max_specialized_kernels;
 
 static Node* usedInFusedChunk(Value* input) {
   auto uses = input->uses();
@@ -199,12 +210,26 @@ auto FusionHandleImpl::getInputChunkDescriptors() -> std::vector<PartitionInfo>
   return descs;
 }
 
-// NB: this vector is really a set, but we want to keep it contiguous in memory for faster access
-static std::vector<int64_t> getInputDependencies(Value* output) {
-  // Run a DFS traversal to find all inputs that affect a given output value
+auto FusionHandleImpl::getInputExpands() -> std::vector<ExpandInfo> {
+  std::vector<ExpandInfo> expands;
+  for (Node* n : graph->nodes()) {
+    if (n->kind() == aten::expand) {
+      JIT_ASSERT(n->input(0)->node()->kind() == prim::Param);
+      expands.push_back({
+        static_cast<int64_t>(n->input(0)->offset()),
+        n->get<std::vector<int64_t>>(attr::size).value()});
+    }
+  }
+  return expands;
+}
+
+// NB: the vectors are really sets, but we want to keep them contiguous in memory for faster access
+static FusionHandleImpl::BroadcastGroup getInputDependencies(Value* output) {
+  // Run a DFS traversal to find all inputs (and sizes of expands) that affect a given output value
   std::vector<Value*> queue { output };
   std::unordered_set<Value*> inputs;
   std::unordered_set<Value*> seen;
+  std::vector<std::vector<int64_t>> expand_sizes;
   while (!queue.empty()) {
     Value* val = queue.back(); queue.pop_back();
     Node* producer = val->node();
@@ -212,6 +237,12 @@ static std::vector<int64_t> getInputDependencies(Value* output) {
       inputs.insert(val);
       continue;
     }
+    if (producer->kind() == aten::expand) {
+      auto size = producer->get<std::vector<int64_t>>(attr::size).value();
+      if (std::find(expand_sizes.begin(), expand_sizes.end(), size) == expand_sizes.end()) {
+        expand_sizes.push_back(std::move(size));
+      }
+    }
     for (Value* input : producer->inputs()) {
       if (/*bool inserted = */seen.insert(input).second) {
         queue.push_back(input);
@@ -227,7 +258,8 @@ static std::vector<int64_t> getInputDependencies(Value* output) {
   }
 
   std::sort(offsets.begin(), offsets.end());
-  return offsets;
+  std::sort(expand_sizes.begin(), expand_sizes.end());
+  return {std::move(offsets), std::move(expand_sizes)};
 }
 
 // See Note [Run-time shape checking code] for more explanation on the algorithm.
@@ -236,6 +268,12 @@ c10::optional<std::vector<int64_t>> FusionHandleImpl::canRunKernel(
   AT_CHECK(args.size() == input_chunks.size(),
            "Expected ", input_chunks.size(), " arguments, but got ", args.size());
 
+  for (const auto & expand : input_expands) {
+    if (!at::is_expandable_to(args[expand.input].sizes(), expand.size)) {
+      return c10::nullopt;
+    }
+  }
+
   c10::optional<std::vector<int64_t>> map_size;
   for (const auto & broadcast_group : input_broadcast_groups) {
     if (!map_size) {
@@ -257,6 +295,7 @@ c10::optional<std::vector<int64_t>> FusionHandleImpl::canRunKernel(
 std::unique_ptr<FusedKernel> FusionHandleImpl::compileSpec(
   const FusionArgSpec& spec
 , const std::vector<int64_t>& map_size) {
+  autograd::profiler::RecordFunction record("FusionGroup::compile");
   AnnotatedGraph agraph{*graph, device};
 
   agraph.input_desc = spec.descs();
@@ -274,6 +313,8 @@ std::unique_ptr<FusedKernel> FusionHandleImpl::compileSpec(
     std::vector<int64_t> sizes = map_size;
     if (output->node()->kind() == prim::FusedConcat) {
       sizes.at(output->node()->i(attr::dim)) *= output->node()->inputs().size();
+    } else if (ReductionDesc::isReduction(output->node())) {
+      sizes = ReductionDesc(output->node()).outputSizes(map_size);
     }
     auto type = CompleteTensorType::create(*scalar_type, device, sizes);
     agraph.output_desc.emplace_back(std::move(type));
@@ -288,10 +329,12 @@ std::unique_ptr<FusedKernel> FusionHandleImpl::compileSpec(
       throw std::runtime_error("CUDA Fusion is not supported on this build.");
     #endif // USE_CUDA_FUSER
   } else {
-    raw_func = new cpufuser::CPUFusedKernel(
-      name
-    , agraph
-    , cpufuser::getFusionCompiler().getConfig());
+    auto& config = cpufuser::getFusionCompiler().getConfig();
+    if (config.interpret && cpufuser::CPUInterpretedKernel::supports(agraph)) {
+      raw_func = new cpufuser::CPUInterpretedKernel(name, agraph);
+    } else {
+      raw_func = new cpufuser::CPUFusedKernel(name, agraph, config);
+    }
   }
   return std::unique_ptr<FusedKernel>(raw_func);
 }
@@ -315,12 +358,15 @@ void FusionHandleImpl::expandArgs(std::vector<at::Tensor>& args, std::vector<int
   }
 }
 
-std::vector<std::vector<int64_t>> FusionHandleImpl::getInputBroadcastGroups() {
-  std::unordered_set<std::vector<int64_t>, torch::hash<std::vector<int64_t>>> broadcast_groups;
+auto FusionHandleImpl::getInputBroadcastGroups() -> std::vector<BroadcastGroup> {
+  std::vector<BroadcastGroup> broadcast_groups;
   for (Value* output : graph->outputs()) {
-    broadcast_groups.insert(getInputDependencies(output));
+    auto group = getInputDependencies(output);
+    if (std::find(broadcast_groups.begin(), broadcast_groups.end(), group) == broadcast_groups.end()) {
+      broadcast_groups.push_back(std::move(group));
+    }
   }
-  return std::vector<std::vector<int64_t>>{broadcast_groups.begin(), broadcast_groups.end()};
+  return broadcast_groups;
 }
 
 void FusionHandleImpl::run(Stack& stack) {
@@ -336,11 +382,24 @@ void FusionHandleImpl::run(Stack& stack) {
   expandArgs(args, *maybe_map_size);
 
   FusionArgSpec spec{args};
-  auto it = kernels.find(spec);
-  if (it == kernels.end()) {
-    std::tie(it, std::ignore) = kernels.emplace(spec, compileSpec(spec, *maybe_map_size));
+  FusedKernel* fn;
+  {
+    std::lock_guard<std::mutex> lock(kernels_mutex);
+    auto it = kernels.find(spec);
+    if (it == kernels.end()) {
+      // Inputs whose layouts keep changing would otherwise compile a kernel
+      // for every combination of contiguities. Past a handful of them, fall
+      // back to a single kernel indexing every dim with its own stride.
+      if (kernels.size() >= max_specialized_kernels) {
+        spec = spec.strided();
+        it = kernels.find(spec);
+      }
+      if (it == kernels.end()) {
+        std::tie(it, std::ignore) = kernels.emplace(spec, compileSpec(spec, *maybe_map_size));
+      }
+    }
+    fn = it->second.get();
   }
-  auto& fn = it->second;
 
   std::vector<at::Tensor> outputs;
   fn->launch(args, outputs);
@@ -353,7 +412,8 @@ void FusionHandleImpl::run(Stack& stack) {
 
 c10::optional<std::vector<int64_t>> FusionHandleImpl::getMapSize(
     at::TensorList args,
-    at::IntList arg_subset) {
+    const BroadcastGroup& broadcast_group) {
+  at::IntList arg_subset = broadcast_group.inputs;
   int64_t dim_after_broadcast = 0;
   for (int64_t arg_idx : arg_subset) {
     dim_after_broadcast = std::max(dim_after_broadcast, args[arg_idx].dim());
@@ -389,6 +449,13 @@ c10::optional<std::vector<int64_t>> FusionHandleImpl::getMapSize(
       }
     }
   }
+  for (const auto& size : broadcast_group.expand_sizes) {
+    try {
+      map_size = at::infer_size(map_size, size);
+    } catch (std::exception& e) {
+      return c10::nullopt;
+    }
+  }
 
   return {map_size};
 }
@@ -13,6 +13,7 @@
 #include "ATen/ATen.h"
 
 #include <memory>
+#include <mutex>
 #include <cstdint>
 #include <vector>
 #include <unordered_map>
@@ -35,6 +36,17 @@ struct FusionHandleImpl : public FusionHandle {
 
   void run(Stack& inputs);
 
+  // Inputs (offsets into the graph's input list) and sizes of the
+  // aten::expands in the graph that a graph output depends on.
+  struct BroadcastGroup {
+    std::vector<int64_t> inputs;
+    std::vector<std::vector<int64_t>> expand_sizes;
+
+    bool operator==(const BroadcastGroup& other) const {
+      return inputs == other.inputs && expand_sizes == other.expand_sizes;
+    }
+  };
+
 private:
   struct PartitionInfo {
     PartitionInfo(int64_t nsub, int64_t dim)
@@ -44,28 +56,40 @@ private:
     int64_t dim;
   };
 
+  struct ExpandInfo {
+    int64_t input;
+    std::vector<int64_t> size;
+  };
+
   void runFallback(Stack& stack);
   void expandArgs(std::vector<at::Tensor>& args, std::vector<int64_t>& map_size);
   c10::optional<std::vector<int64_t>> canRunKernel(at::TensorList args);
   c10::optional<std::vector<int64_t>> getMapSize(
       at::TensorList args,
-      at::IntList arg_subset);
-  std::vector<std::vector<int64_t>> getInputBroadcastGroups();
+      const BroadcastGroup& broadcast_group);
+  std::vector<BroadcastGroup> getInputBroadcastGroups();
   std::vector<PartitionInfo> getInputChunkDescriptors();
+  std::vector<ExpandInfo> getInputExpands();
   std::unique_ptr<FusedKernel> compileSpec(
         const FusionArgSpec& spec, const std::vector<int64_t>& map_size);
 
   static std::atomic<size_t> next_kernel_id;
+  // Number of kernels specialized to the contiguity of their inputs a handle
+  // compiles before it starts using a fully strided one.
+  static constexpr size_t max_specialized_kernels = 8;
 
   int device;
   Code fallback_code;
   std::shared_ptr<Graph> graph;
-  std::vector<std::vector<int64_t>> input_broadcast_groups;
+  std::vector<BroadcastGroup> input_broadcast_groups;
   std::vector<PartitionInfo> input_chunks;
+  std::vector<ExpandInfo> input_expands;
   std::unordered_map<
     FusionArgSpec
   , std::unique_ptr<FusedKernel>
   , torch::hash<FusionArgSpec>> kernels;
+  // Fused nodes can be run from multiple threads.
+  std::mutex kernels_mutex;
 };
 
 } // namespace jit 
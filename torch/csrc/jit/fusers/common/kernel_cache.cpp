@@ -0,0 +1,121 @@
+#include "torch/csrc/jit/fusers/common/kernel_cache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "unistd.h"
+
+namespace torch { namespace jit {
+
+namespace {
+
+const char* cacheDir() {
+  static const char* dir = [] {
+    const char* env = getenv("PYTORCH_FUSION_CACHE_DIR");
+    return env && *env ? env : nullptr;
+  }();
+  return dir;
+}
+
+// FNV-1a. std::hash isn't guaranteed to be stable between builds, and the
+// cache outlives any single one of them.
+std::string hashOf(const std::string& key) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  std::ostringstream out;
+  out << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return out.str();
+}
+
+std::string pathOf(const std::string& hash, const std::string& extension) {
+  return std::string(cacheDir()) + "/" + hash + "." + extension;
+}
+
+bool readFile(const std::string& path, std::string& contents) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    return false;
+  std::ostringstream buffer;
+  buffer << in.rdbuf();
+  contents = buffer.str();
+  return true;
+}
+
+bool writeFileAtomic(const std::string& path, const std::string& contents) {
+  std::string tmp = path + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out)
+      return false;
+    out.write(contents.data(), contents.size());
+    if (!out) {
+      std::remove(tmp.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+    std::remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+bool KernelCache::enabled() {
+  return cacheDir() != nullptr;
+}
+
+std::string KernelCache::normalizeKey(std::string key, const std::string& kernel_name) {
+  static const std::string placeholder = "${kernel_name}";
+  size_t pos = 0;
+  while ((pos = key.find(kernel_name, pos)) != std::string::npos) {
+    key.replace(pos, kernel_name.size(), placeholder);
+    pos += placeholder.size();
+  }
+  return key;
+}
+
+c10::optional<KernelCache::Entry> KernelCache::lookup(
+  const std::string& key
+, const std::string& extension) {
+  if (!enabled())
+    return c10::nullopt;
+  auto hash = hashOf(key);
+  std::string stored;
+  if (!readFile(pathOf(hash, "key"), stored))
+    return c10::nullopt;
+  // The key file is the kernel name on the first line, then the full key.
+  auto newline = stored.find('\n');
+  if (newline == std::string::npos || stored.compare(newline + 1, std::string::npos, key) != 0)
+    return c10::nullopt;
+  Entry entry;
+  entry.path = pathOf(hash, extension);
+  entry.kernel_name = stored.substr(0, newline);
+  if (access(entry.path.c_str(), R_OK) != 0)
+    return c10::nullopt;
+  return entry;
+}
+
+void KernelCache::store(
+  const std::string& key
+, const std::string& extension
+, const std::string& kernel_name
+, const std::string& contents) {
+  if (!enabled())
+    return;
+  auto hash = hashOf(key);
+  if (writeFileAtomic(pathOf(hash, extension), contents)) {
+    writeFileAtomic(pathOf(hash, "key"), kernel_name + "\n" + key);
+  }
+}
+
+} // namespace jit
+} // namespace torch
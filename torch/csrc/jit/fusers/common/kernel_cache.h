@@ -0,0 +1,52 @@
+#include "torch/csrc/jit/fusers/Config.h"
+#if USE_CPU_FUSER || USE_CUDA_FUSER
+#pragma once
+
+#include "c10/util/Optional.h"
+
+#include <string>
+
+namespace torch { namespace jit {
+
+// On-disk cache of compiled fused kernels (CPU shared objects and CUDA PTX),
+// shared by all processes that point PYTORCH_FUSION_CACHE_DIR at the same
+// directory. Without that variable the cache is disabled.
+//
+// Entries are content addressed: the key is everything that determines the
+// compiled artifact (generated source, compiler and its version, target
+// architecture, flags), with the kernel's name taken out so that the same
+// fusion group hits the cache no matter in which order a process compiles
+// its kernels. The name the artifact was compiled with is stored next to it.
+//
+// Each entry is two files, <hash>.<extension> with the artifact and
+// <hash>.key with the kernel name and the full key, which is compared on
+// lookup to rule out hash collisions. Both are written to a temporary file
+// and renamed into place, the key last, so concurrent readers and writers
+// never see a partial entry.
+struct KernelCache {
+  struct Entry {
+    std::string path; // of the artifact
+    std::string kernel_name; // the artifact was compiled with
+  };
+
+  static bool enabled();
+
+  // Returns key with every occurrence of kernel_name replaced, so that it
+  // only depends on the contents of the kernel.
+  static std::string normalizeKey(std::string key, const std::string& kernel_name);
+
+  static c10::optional<Entry> lookup(const std::string& key, const std::string& extension);
+
+  // Stores contents as the artifact for key. Failures to write are not
+  // errors, the kernel simply isn't cached.
+  static void store(
+    const std::string& key
+  , const std::string& extension
+  , const std::string& kernel_name
+  , const std::string& contents);
+};
+
+} // namespace jit
+} // namespace torch
+
+#endif // USE_CPU_FUSER || USE_CUDA_FUSER
@@ -0,0 +1,62 @@
+#include "torch/csrc/jit/fusers/Config.h"
+#if USE_CPU_FUSER || USE_CUDA_FUSER
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+#include "torch/csrc/jit/assertions.h"
+
+#include "ATen/ATen.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace torch { namespace jit {
+
+// Descriptor for an output that is a reduction (sum, mean, var or std) over
+// the innermost nDims dims of the map, rather than a pointwise result.
+// The graph fuser only lets reductions over trailing dims terminate a fusion
+// group, so that each reduced element is a contiguous run of the map.
+struct ReductionDesc {
+
+  ReductionDesc()
+  : nDims(0), keepdim(false) {}
+
+  explicit ReductionDesc(Node* n)
+  : keepdim(n->get<bool>(attr::keepdim).value()) {
+    JIT_ASSERT(isReduction(n));
+    if (n->kind() == aten::sum) {
+      nDims = n->get<std::vector<int64_t>>(attr::dim).value().size();
+    } else {
+      nDims = 1;
+    }
+  }
+
+  static bool isReduction(Node* n) {
+    return n->matches("aten::sum(Tensor self, int[] dim, bool keepdim) -> Tensor") ||
+           n->matches("aten::mean(Tensor self, int dim, bool keepdim) -> Tensor") ||
+           n->matches("aten::var(Tensor self, int dim, bool unbiased, bool keepdim) -> Tensor") ||
+           n->matches("aten::std(Tensor self, int dim, bool unbiased, bool keepdim) -> Tensor");
+  }
+
+  bool isNoop() const {
+    return nDims == 0;
+  }
+
+  // sizes of the reduced output for a given map size
+  std::vector<int64_t> outputSizes(at::IntList map_size) const {
+    JIT_ASSERT(map_size.size() >= nDims);
+    std::vector<int64_t> sizes(map_size.begin(), map_size.end() - nDims);
+    if (keepdim) {
+      sizes.resize(map_size.size(), 1);
+    }
+    return sizes;
+  }
+
+  size_t nDims; // == 0 for outputs that are not reductions
+  bool keepdim;
+};
+
+} // namespace jit
+} // namespace torch
+
+#endif // USE_CPU_FUSER || USE_CUDA_FUSER
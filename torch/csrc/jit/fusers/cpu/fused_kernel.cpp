@@ -4,13 +4,16 @@
 #include "torch/csrc/jit/fusers/cpu/temp_file.h"
 #include "torch/csrc/jit/fusers/cpu/dynamic_library.h"
 #include "torch/csrc/jit/fusers/common/annotated_graph.h"
+#include "torch/csrc/jit/fusers/common/kernel_cache.h"
 
 #include "torch/csrc/jit/assertions.h"
 #include "torch/csrc/jit/code_template.h"
 
 #include <sstream>
 #include <tuple>
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <string>
 
@@ -37,8 +40,8 @@ static const std::string compile_string =
 #endif
   "-std=c++11 -fPIC ${fopenmp} -shared \"${cpp_file}\" -o \"${so_file}\" -lm";
 
-static void runCompiler(
-  CPUFusionCompilerConfig& config
+static std::string compileCommand(
+  const CPUFusionCompilerConfig& config
 , const std::string& cpp_file
 , const std::string& so_file) {
   TemplateEnv env;
@@ -46,7 +49,14 @@ static void runCompiler(
   env.s("fopenmp", config.openmp ? "-fopenmp" : "");
   env.s("cpp_file",cpp_file);
   env.s("so_file",so_file);
-  std::string result = format(compile_string, env);
+  return format(compile_string, env);
+}
+
+static void runCompiler(
+  CPUFusionCompilerConfig& config
+, const std::string& cpp_file
+, const std::string& so_file) {
+  std::string result = compileCommand(config, cpp_file, so_file);
   int r = system(result.c_str());
   if (config.openmp && r != 0) {
     std::cerr << "warning: pytorch jit fuser failed to compile with openmp, trying without it...\n";
@@ -66,27 +76,80 @@ static void disas(const std::string& so_file) {
   JIT_ASSERT(r == 0);
 }
 
+// The output of `cxx --version`, so that upgrading the compiler invalidates
+// the kernels cached by the old one.
+static const std::string& compilerVersion(const CPUFusionCompilerConfig& config) {
+  static const std::string version = [&] {
+    std::string cmd = "\"" + config.cxx + "\" --version 2>&1";
+    std::string out;
+    FILE* pipe = popen(cmd.c_str(), "r");
+    if (!pipe)
+      return out;
+    char buffer[256];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+      out.append(buffer, n);
+    pclose(pipe);
+    return out;
+  }();
+  return version;
+}
+
+// Everything the shared object depends on. File names in the compile command
+// are placeholders, since the temporaries are different every time.
+static std::string cacheKey(
+  const CPUFusionCompilerConfig& config
+, const std::string& name
+, const std::string& compilation_unit) {
+  std::stringstream key;
+  key << compileCommand(config, "${cpp_file}", "${so_file}") << "\n"
+      << compilerVersion(config) << "\n"
+      << compilation_unit;
+  return KernelCache::normalizeKey(key.str(), name);
+}
+
+static std::string readFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
 CPUFusedKernel::CPUFusedKernel(
   const std::string& name
 , AnnotatedGraph& agraph
 , CPUFusionCompilerConfig& config)
 : FusedKernel(name, agraph) {
-  TempFile so_file(so_template, 3);
-  TempFile cpp_file(cpp_template, 4);
-
   std::stringstream cu;
-  std::tie(chunk_desc, concat_desc, has_random) = emitCompilationUnit(cu, name, agraph, false);
+  std::tie(chunk_desc, concat_desc, reduction_desc, has_random) = emitCompilationUnit(cu, name, agraph, false);
   JIT_ASSERT(!has_random);
   compilation_unit = cu.str();
-  cpp_file.write(compilation_unit);
-  cpp_file.sync();
-  runCompiler(config, cpp_file.name(), so_file.name());
-  if (config.debug) {
-    disas(so_file.name());
+
+  std::string symbol = name;
+  c10::optional<KernelCache::Entry> entry;
+  if (KernelCache::enabled())
+    entry = KernelCache::lookup(cacheKey(config, name, compilation_unit), "so");
+  if (entry) {
+    so_lib.reset(new DynamicLibrary(entry->path.c_str()));
+    symbol = entry->kernel_name;
+  } else {
+    TempFile so_file(so_template, 3);
+    TempFile cpp_file(cpp_template, 4);
+    cpp_file.write(compilation_unit);
+    cpp_file.sync();
+    runCompiler(config, cpp_file.name(), so_file.name());
+    if (config.debug) {
+      disas(so_file.name());
+    }
+    so_lib.reset(new DynamicLibrary(so_file.name().c_str()));
+    if (KernelCache::enabled()) {
+      // Keyed after compiling, as runCompiler may have turned off OpenMP.
+      KernelCache::store(
+        cacheKey(config, name, compilation_unit), "so", name, readFile(so_file.name()));
+    }
   }
-  so_lib.reset(new DynamicLibrary(so_file.name().c_str()));
   #pragma GCC diagnostic ignored "-Wpedantic"
-    kernel = reinterpret_cast<void(*)(uint32_t, void**)>(so_lib->sym(name.c_str()));
+    kernel = reinterpret_cast<void(*)(uint32_t, void**)>(so_lib->sym(symbol.c_str()));
   #pragma GCC diagnostic pop
 }
 
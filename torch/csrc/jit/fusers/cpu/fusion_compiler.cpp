@@ -41,6 +41,9 @@ CPUFusionCompiler::CPUFusionCompiler() {
   
   const char* debug_env = getenv("PYTORCH_FUSION_DEBUG");
   config_.debug = debug_env && atoi(debug_env) != 0;
+
+  const char* compile_env = getenv("PYTORCH_FUSION_CPU_COMPILE");
+  config_.interpret = !(compile_env && atoi(compile_env) != 0);
 }
 
 std::shared_ptr<FusionHandle> CPUFusionCompiler::getFusionHandle(Node* fusion_group) {
@@ -21,6 +21,8 @@ struct CPUFusionCompilerConfig {
   std::string cxx = "g++"; // compiler location
   bool debug = false; // emit debugging information about fusions
   bool openmp = true;
+  // run fusion groups the interpreter supports without compiling them
+  bool interpret = true;
 };
 
 struct CPUFusionCompiler {
@@ -0,0 +1,423 @@
+#include "torch/csrc/jit/fusers/cpu/interpreted_kernel.h"
+
+#include "torch/csrc/jit/fusers/common/partition_desc.h"
+#include "torch/csrc/jit/fusers/common/tensor_info.h"
+
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/constants.h"
+
+#include "ATen/ATen.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace torch { namespace jit { namespace cpufuser {
+
+namespace {
+
+using namespace at::vec256;
+
+// Number of elements every instruction is applied to at a time. Small enough
+// for the registers of a typical fusion group to stay in L1/L2, large enough
+// to amortize the dispatch of each instruction.
+constexpr int64_t kBlockSize = 256;
+
+// The ops the interpreter implements, with the semantics of the expressions
+// encodeRHS in common/fused_kernel.cpp emits for them.
+const std::unordered_set<NodeKind>& supportedOps() {
+  static const std::unordered_set<NodeKind> ops = {
+    aten::abs, aten::sigmoid, aten::relu, aten::log, aten::log10,
+    aten::log1p, aten::log2, aten::lgamma, aten::exp, aten::expm1,
+    aten::cos, aten::acos, aten::cosh, aten::sin, aten::asin, aten::sinh,
+    aten::tan, aten::atan, aten::tanh, aten::sqrt, aten::rsqrt, aten::ceil,
+    aten::floor, aten::round, aten::trunc, aten::frac, aten::reciprocal,
+    aten::neg, aten::atan2, aten::min, aten::max, aten::div, aten::eq,
+    aten::ge, aten::gt, aten::le, aten::lt, aten::ne, aten::type_as,
+    aten::mul, aten::pow, aten::add, aten::sub, aten::clamp,
+    aten::_sigmoid_backward, aten::_tanh_backward,
+  };
+  return ops;
+}
+
+Node* usedInFusedChunk(Value* input) {
+  auto uses = input->uses();
+  if (uses.size() == 1) {
+    Node *user = uses[0].user;
+    if (user->kind() == prim::ConstantChunk) {
+      return user;
+    }
+  }
+  return nullptr;
+}
+
+bool onlyParametrizesExpands(Value* v) {
+  for (const Use& u : v->uses()) {
+    if (u.user->kind() != aten::expand || u.offset == 0)
+      return false;
+  }
+  return true;
+}
+
+bool isContiguous(const TensorDesc& desc) {
+  return desc.nDim() == 1 && desc.lastIsContiguous();
+}
+
+// Same index computation as emitIndexingFor generates.
+uint32_t offsetOf(TensorInfo* info, const TensorDesc& desc, uint32_t linear_index) {
+  size_t ndim = desc.nDim();
+  uint32_t* sizes = info->sizes(ndim);
+  uint32_t* strides = info->strides(ndim);
+  uint32_t offset = 0;
+  for (int d = ndim - 1; d >= 0; --d) {
+    uint32_t index = d > 0 ? linear_index % sizes[d] : linear_index;
+    if (d < static_cast<int>(ndim) - 1 || !desc.lastIsContiguous()) {
+      index *= strides[d];
+    }
+    offset += index;
+    if (d > 0) {
+      linear_index /= sizes[d];
+    }
+  }
+  return offset;
+}
+
+template <typename scalar_t, typename Op>
+void vecMap(int64_t n, scalar_t* out, const scalar_t* a, const Op& op) {
+  using Vec = Vec256<scalar_t>;
+  int64_t i = 0;
+  for (; i + Vec::size <= n; i += Vec::size) {
+    op(Vec::loadu(a + i)).store(out + i);
+  }
+  if (i < n) {
+    op(Vec::loadu(a + i, n - i)).store(out + i, n - i);
+  }
+}
+
+template <typename scalar_t, typename Op>
+void vecMap2(int64_t n, scalar_t* out, const scalar_t* a, const scalar_t* b, const Op& op) {
+  using Vec = Vec256<scalar_t>;
+  int64_t i = 0;
+  for (; i + Vec::size <= n; i += Vec::size) {
+    op(Vec::loadu(a + i), Vec::loadu(b + i)).store(out + i);
+  }
+  if (i < n) {
+    op(Vec::loadu(a + i, n - i), Vec::loadu(b + i, n - i)).store(out + i, n - i);
+  }
+}
+
+template <typename scalar_t, typename Op>
+void vecMap3(int64_t n, scalar_t* out, const scalar_t* a, const scalar_t* b, const scalar_t* c, const Op& op) {
+  using Vec = Vec256<scalar_t>;
+  int64_t i = 0;
+  for (; i + Vec::size <= n; i += Vec::size) {
+    op(Vec::loadu(a + i), Vec::loadu(b + i), Vec::loadu(c + i)).store(out + i);
+  }
+  if (i < n) {
+    op(Vec::loadu(a + i, n - i), Vec::loadu(b + i, n - i), Vec::loadu(c + i, n - i))
+        .store(out + i, n - i);
+  }
+}
+
+// For ops whose scalar semantics (NaN handling of comparisons, fmin/fmax)
+// don't map onto a Vec256 method. These are simple enough loops for the
+// compiler to vectorize.
+template <typename scalar_t, typename Op>
+void pointwise(int64_t n, scalar_t* out, const scalar_t* a, const Op& op) {
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = op(a[i]);
+  }
+}
+
+template <typename scalar_t, typename Op>
+void pointwise2(int64_t n, scalar_t* out, const scalar_t* a, const scalar_t* b, const Op& op) {
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = op(a[i], b[i]);
+  }
+}
+
+template <typename scalar_t, typename Op>
+void pointwise3(int64_t n, scalar_t* out, const scalar_t* a, const scalar_t* b, const scalar_t* c, const Op& op) {
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = op(a[i], b[i], c[i]);
+  }
+}
+
+template <typename scalar_t>
+void evaluate(NodeKind kind, int64_t n, scalar_t* out, const std::vector<const scalar_t*>& in) {
+  using Vec = Vec256<scalar_t>;
+  const Vec one(1);
+  switch (kind) {
+#define UNARY_VEC(op, expr)                                         \
+    case aten::op:                                                  \
+      vecMap(n, out, in[0], [&](const Vec& x) { return expr; });    \
+      break;
+    UNARY_VEC(abs, x.abs())
+    UNARY_VEC(sigmoid, one / (one + x.neg().exp()))
+    UNARY_VEC(log, x.log())
+    UNARY_VEC(log10, x.log10())
+    UNARY_VEC(log1p, x.log1p())
+    UNARY_VEC(log2, x.log2())
+    UNARY_VEC(exp, x.exp())
+    UNARY_VEC(expm1, x.expm1())
+    UNARY_VEC(cos, x.cos())
+    UNARY_VEC(acos, x.acos())
+    UNARY_VEC(cosh, x.cosh())
+    UNARY_VEC(sin, x.sin())
+    UNARY_VEC(asin, x.asin())
+    UNARY_VEC(sinh, x.sinh())
+    UNARY_VEC(tan, x.tan())
+    UNARY_VEC(atan, x.atan())
+    UNARY_VEC(tanh, x.tanh())
+    UNARY_VEC(sqrt, x.sqrt())
+    UNARY_VEC(rsqrt, x.rsqrt())
+    UNARY_VEC(ceil, x.ceil())
+    UNARY_VEC(floor, x.floor())
+    UNARY_VEC(round, x.round())
+    UNARY_VEC(trunc, x.trunc())
+    UNARY_VEC(frac, x - x.trunc())
+    UNARY_VEC(reciprocal, x.reciprocal())
+    UNARY_VEC(neg, x.neg())
+#undef UNARY_VEC
+    case aten::relu:
+      pointwise(n, out, in[0], [](scalar_t x) { return x < 0 ? scalar_t(0) : x; });
+      break;
+    case aten::lgamma:
+      pointwise(n, out, in[0], [](scalar_t x) { return std::lgamma(x); });
+      break;
+    case aten::type_as:
+      std::memcpy(out, in[0], n * sizeof(scalar_t));
+      break;
+#define BINARY_VEC(op, expr)                                                          \
+    case aten::op:                                                                    \
+      vecMap2(n, out, in[0], in[1], [&](const Vec& x, const Vec& y) { return expr; }); \
+      break;
+    BINARY_VEC(mul, x * y)
+    BINARY_VEC(div, x / y)
+    BINARY_VEC(pow, x.pow(y))
+    BINARY_VEC(_sigmoid_backward, x * y * (one - y))
+    BINARY_VEC(_tanh_backward, x * (one - y * y))
+#undef BINARY_VEC
+#define BINARY(op, expr)                                                        \
+    case aten::op:                                                              \
+      pointwise2(n, out, in[0], in[1], [](scalar_t x, scalar_t y) -> scalar_t { \
+        return expr;                                                            \
+      });                                                                       \
+      break;
+    BINARY(atan2, std::atan2(x, y))
+    BINARY(min, std::fmin(x, y))
+    BINARY(max, std::fmax(x, y))
+    BINARY(eq, x == y)
+    BINARY(ne, x != y)
+    BINARY(ge, x >= y)
+    BINARY(gt, x > y)
+    BINARY(le, x <= y)
+    BINARY(lt, x < y)
+#undef BINARY
+    case aten::add:
+      vecMap3(n, out, in[0], in[1], in[2], [](const Vec& x, const Vec& y, const Vec& alpha) {
+        return x + alpha * y;
+      });
+      break;
+    case aten::sub:
+      vecMap3(n, out, in[0], in[1], in[2], [](const Vec& x, const Vec& y, const Vec& alpha) {
+        return x - alpha * y;
+      });
+      break;
+    case aten::clamp:
+      pointwise3(n, out, in[0], in[1], in[2], [](scalar_t x, scalar_t lo, scalar_t hi) {
+        return x < lo ? lo : (x > hi ? hi : x);
+      });
+      break;
+    default:
+      JIT_ASSERTM(false, "unsupported op in interpreted fusion group: ", kind.toQualString());
+  }
+}
+
+} // anonymous namespace
+
+bool CPUInterpretedKernel::supports(const AnnotatedGraph& agraph) {
+  // All values are computed in the scalar type of the kernel, so only
+  // homogeneous floating point groups are handled.
+  auto scalar_type = agraph.input_desc.at(0).scalar_type;
+  if (scalar_type != at::kFloat && scalar_type != at::kDouble)
+    return false;
+  for (const auto& desc : agraph.input_desc) {
+    if (desc.scalar_type != scalar_type)
+      return false;
+  }
+  for (const auto& desc : agraph.output_desc) {
+    if (desc.scalar_type != scalar_type)
+      return false;
+  }
+  for (Node* n : agraph.graph->nodes()) {
+    if (n->kind() == prim::Constant) {
+      auto value = toIValue(n->output());
+      if (!value)
+        return false;
+      // the size of an expand is the only non-scalar constant we ignore
+      if (!(value->isDouble() || value->isInt()) && !onlyParametrizesExpands(n->output()))
+        return false;
+    } else if (n->kind() != prim::ConstantChunk &&
+               n->kind() != prim::FusedConcat &&
+               n->kind() != aten::expand &&
+               supportedOps().count(n->kind()) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+CPUInterpretedKernel::CPUInterpretedKernel(
+  const std::string& name
+, AnnotatedGraph& agraph)
+: FusedKernel(name, agraph)
+, scalar_type(agraph.input_desc.at(0).scalar_type) {
+  has_random = false;
+  Graph& subgraph = *agraph.graph;
+  std::unordered_map<Value*, int> registers;
+  auto assign = [&](Value* v) {
+    registers[v] = num_registers;
+    return num_registers++;
+  };
+
+  // Inputs and outputs are flattened the same way emitCompilationUnit does,
+  // so that launch_with_tensors packs the arguments we expect.
+  size_t input_index = 0;
+  for (Value* p : subgraph.inputs()) {
+    const auto& desc = agraph.input_desc[input_index++];
+    if (Node* chunk = usedInFusedChunk(p)) {
+      chunk_desc.emplace_back(desc, chunk->i(attr::chunks), chunk->i(attr::dim));
+      for (Value* o : chunk->outputs()) {
+        assign(o);
+        flat_descs.push_back(*chunk_desc.back().subtensorDesc);
+      }
+    } else {
+      chunk_desc.emplace_back();
+      assign(p);
+      flat_descs.push_back(desc);
+    }
+  }
+  flat_inputs = flat_descs.size();
+
+  for (Node* n : subgraph.nodes()) {
+    if (n->kind() == prim::FusedConcat || n->kind() == prim::ConstantChunk)
+      continue;
+    // inputs are already expanded to the map size by launch_with_tensors
+    if (n->kind() == aten::expand) {
+      registers[n->output()] = registers.at(n->input(0));
+      continue;
+    }
+    if (n->kind() == prim::Constant) {
+      auto value = toIValue(n->output()).value();
+      if (!value.isDouble() && !value.isInt())
+        continue;
+      constants.emplace_back(
+          assign(n->output()),
+          value.isDouble() ? value.toDouble() : static_cast<double>(value.toInt()));
+      continue;
+    }
+    Instruction inst;
+    inst.kind = n->kind();
+    for (Value* input : n->inputs()) {
+      inst.inputs.push_back(registers.at(input));
+    }
+    inst.output = assign(n->output());
+    instructions.push_back(std::move(inst));
+  }
+
+  size_t output_index = 0;
+  for (Value* o : subgraph.outputs()) {
+    const auto& desc = agraph.output_desc[output_index++];
+    if (o->node()->kind() != prim::FusedConcat) {
+      concat_desc.emplace_back();
+      output_registers.push_back(registers.at(o));
+      flat_descs.push_back(desc);
+    } else {
+      Node* cat = o->node();
+      concat_desc.emplace_back(desc, cat->inputs().size(), cat->i(attr::dim));
+      for (Value* c : cat->inputs()) {
+        output_registers.push_back(registers.at(c));
+        flat_descs.push_back(*concat_desc.back().subtensorDesc);
+      }
+    }
+  }
+}
+
+void CPUInterpretedKernel::launch_raw(uint32_t numel, void** arguments) {
+  if (scalar_type == at::kDouble) {
+    run<double>(numel, arguments);
+  } else {
+    run<float>(numel, arguments);
+  }
+}
+
+template <typename scalar_t>
+void CPUInterpretedKernel::run(uint32_t numel, void** arguments) const {
+  // arguments[0] points to numel, the TensorInfos follow.
+  auto info = [&](size_t i) {
+    return static_cast<TensorInfo*>(arguments[i + 1]);
+  };
+  int64_t grain_size = at::internal::grain_size_for_cost(
+      std::max<int64_t>(1, instructions.size()));
+  at::parallel_for(0, numel, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<scalar_t> buffer(num_registers * kBlockSize);
+    auto block = [&](int reg) {
+      return buffer.data() + reg * kBlockSize;
+    };
+    for (const auto& constant : constants) {
+      std::fill_n(block(constant.first), kBlockSize, static_cast<scalar_t>(constant.second));
+    }
+    // Contiguous inputs are read in place, everything else from its block.
+    std::vector<const scalar_t*> values(num_registers);
+    for (int reg = 0; reg < num_registers; ++reg) {
+      values[reg] = block(reg);
+    }
+    std::vector<const scalar_t*> operands;
+
+    for (int64_t start = begin; start < end; start += kBlockSize) {
+      int64_t n = std::min(kBlockSize, end - start);
+      for (size_t i = 0; i < flat_inputs; ++i) {
+        auto data = static_cast<scalar_t*>(info(i)->data);
+        if (isContiguous(flat_descs[i])) {
+          values[i] = data + start;
+        } else {
+          scalar_t* dst = block(i);
+          for (int64_t k = 0; k < n; ++k) {
+            dst[k] = data[offsetOf(info(i), flat_descs[i], start + k)];
+          }
+          values[i] = dst;
+        }
+      }
+
+      for (const auto& inst : instructions) {
+        operands.clear();
+        for (int reg : inst.inputs) {
+          operands.push_back(values[reg]);
+        }
+        evaluate(inst.kind, n, block(inst.output), operands);
+      }
+
+      for (size_t j = 0; j < output_registers.size(); ++j) {
+        size_t i = flat_inputs + j;
+        auto data = static_cast<scalar_t*>(info(i)->data);
+        const scalar_t* src = values[output_registers[j]];
+        if (isContiguous(flat_descs[i])) {
+          std::memcpy(data + start, src, n * sizeof(scalar_t));
+        } else {
+          for (int64_t k = 0; k < n; ++k) {
+            data[offsetOf(info(i), flat_descs[i], start + k)] = src[k];
+          }
+        }
+      }
+    }
+  });
+}
+
+} // namespace cpufuser
+} // namespace jit
+} // namespace torch
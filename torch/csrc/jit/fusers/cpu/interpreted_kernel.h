@@ -0,0 +1,74 @@
+#include "torch/csrc/jit/fusers/Config.h"
+#if USE_CPU_FUSER
+#pragma once
+
+#include "torch/csrc/jit/fusers/common/fused_kernel.h"
+#include "torch/csrc/jit/fusers/common/annotated_graph.h"
+#include "torch/csrc/jit/fusers/common/tensor_desc.h"
+
+#include "torch/csrc/jit/ir.h"
+
+#include "ATen/ATen.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace torch { namespace jit { namespace cpufuser {
+
+// Runs a CPU fusion group in-process, without generating and compiling C++
+// for it. The fusion group's nodes become a list of vectorized pointwise
+// operations that are evaluated one after another over blocks of elements,
+// so the cost of dispatching an op is paid once per block rather than once
+// per element, and intermediates stay in cache. Blocks are split across
+// threads with at::parallel_for.
+//
+// Compared to CPUFusedKernel there is no first-call compilation latency and
+// no need for a compiler at runtime, at the cost of each intermediate making
+// a round trip through a block-sized buffer.
+struct CPUInterpretedKernel : public ::torch::jit::FusedKernel {
+  CPUInterpretedKernel(const std::string& name, AnnotatedGraph& agraph);
+
+  // True if every node of the fusion group, and the scalar types of its
+  // inputs and outputs, can be handled without generating code.
+  static bool supports(const AnnotatedGraph& agraph);
+
+protected:
+  virtual at::Backend backend() const override {
+    return at::Backend::CPU;
+  }
+
+  virtual uint64_t get_rand_offset(uint32_t numel) override {
+    return numel;
+  }
+
+  virtual void launch_raw(uint32_t numel, void** arguments) override;
+
+private:
+  struct Instruction {
+    NodeKind kind;
+    int output;
+    std::vector<int> inputs;
+  };
+
+  template <typename scalar_t>
+  void run(uint32_t numel, void** arguments) const;
+
+  at::ScalarType scalar_type;
+  // Registers [0, flat_inputs) hold the (chunked) inputs, in argument order.
+  int num_registers = 0;
+  size_t flat_inputs = 0;
+  // Descriptors of the flat inputs followed by the flat outputs, matching the
+  // TensorInfo arguments launch_with_tensors passes to launch_raw.
+  std::vector<TensorDesc> flat_descs;
+  std::vector<int> output_registers;
+  std::vector<std::pair<int, double>> constants;
+  std::vector<Instruction> instructions;
+};
+
+} // namespace cpufuser
+} // namespace jit
+} // namespace torch
+
+#endif // USE_CPU_FUSER
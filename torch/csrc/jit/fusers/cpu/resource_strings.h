@@ -53,6 +53,67 @@ void ${kernelName}(IndexType totalElements, void ** args) {
 }
 )");
 
+// Accumulators of reductions. Welford's algorithm keeps var and std
+// numerically stable in a single pass over the reduced elements.
+constexpr auto reduction_support_literal = R"(
+template<typename T>
+struct Welford {
+  T mean;
+  T m2;
+  T count;
+};
+
+template<typename T, typename U>
+inline void welfordUpdate(Welford<T>& a, U x) {
+  a.count += 1;
+  T delta = x - a.mean;
+  a.mean += delta / a.count;
+  a.m2 += delta * (x - a.mean);
+}
+
+template<typename T>
+inline T welfordVar(const Welford<T>& a, bool unbiased) {
+  return a.m2 / (a.count - (unbiased ? 1 : 0));
+}
+)";
+
+// One iteration of the outer loop produces one element of each reduced
+// output, from reduceSize consecutive elements of the map.
+auto cpu_reduction_compilation_unit_template = CodeTemplate(R"(
+#include <cstddef>
+#include <cstdint>
+#include <math.h>
+${type_declarations}
+${ReduceHeader}
+
+#define OMP_THRESHOLD 100000
+static void ${kernelName}_kernel(IndexType totalElements, ${formals}) {
+  #pragma omp parallel for if(totalElements * reduceSize > OMP_THRESHOLD)
+  for (IndexType reduceIndex = 0;
+        reduceIndex < totalElements;
+        reduceIndex += 1) {
+    ${reduceInit}
+    for (IndexType innerIndex = 0;
+          innerIndex < reduceSize;
+          innerIndex += 1) {
+      IndexType linearIndex = reduceIndex * reduceSize + innerIndex;
+      // Convert `linearIndex` into an offset of tensor:
+      ${tensorOffsets}
+      // calculate the results
+      ${kernelBody}
+    }
+    // Convert `reduceIndex` into an offset of the reduced tensors:
+    ${reduceOffsets}
+    ${reduceEpilogue}
+  }
+}
+
+extern "C"
+void ${kernelName}(IndexType totalElements, void ** args) {
+  ${kernelName}_kernel(totalElements ${,argument_loads});
+}
+)");
+
 } // namespace cpufuser
 } // namespace jit 
 } // namespace torch
@@ -1,5 +1,6 @@
 #include "torch/csrc/jit/fusers/cuda/fused_kernel.h"
 
+#include "torch/csrc/jit/fusers/common/kernel_cache.h"
 #include "torch/csrc/jit/resource_guard.h"
 
 #include "ATen/cuda/CUDAContext.h"
@@ -12,6 +13,8 @@
 #include "cuda_runtime.h"
 
 #include <stdexcept>
+#include <fstream>
+#include <iterator>
 #include <sstream>
 #include <tuple>
 #include <vector>
@@ -30,22 +33,29 @@ void checkCUDAVersion(const cudaDeviceProp& prop) {
   }
 }
 
-CUDAFusedKernel::CUDAFusedKernel(
+// Everything the PTX depends on. nvrtc only emits PTX here; the driver keeps
+// its own cache of the machine code it JIT compiles that from.
+static std::string cacheKey(
   const std::string& name
-, AnnotatedGraph& agraph)
-: FusedKernel(name, agraph) {
-  at::DeviceGuard device_guard(agraph.device);
-
-  TORCH_CUDA_CHECK(cudaGetDeviceProperties(&prop, agraph.device));
-  checkCUDAVersion(prop);
+, const std::string& compute
+, const std::string& compilation_unit) {
+  int major, minor;
+  TORCH_NVRTC_CHECK(nvrtcVersion(&major, &minor));
+  std::stringstream key;
+  key << "nvrtc " << major << "." << minor << " cuda " << CUDA_VERSION << "\n"
+      << compute << "\n"
+      << compilation_unit;
+  return KernelCache::normalizeKey(key.str(), name);
+}
 
-  std::stringstream cu;
-  std::tie(chunk_desc, concat_desc, has_random) = emitCompilationUnit(cu, name, agraph, true);
-  compilation_unit = cu.str();
+// Compiles compilation_unit to PTX, null terminated as cuModuleLoadData
+// expects it.
+static std::vector<char> compileToPTX(
+  const std::string& compilation_unit
+, const std::string& compute) {
   nvrtcProgram program;
   TORCH_NVRTC_CHECK(nvrtcCreateProgram(&program, compilation_unit.c_str(), nullptr, 0, nullptr, nullptr));
 
-  std::string compute = "--gpu-architecture=compute_" + std::to_string(prop.major) + std::to_string(prop.minor);
   std::vector<const char *> args = {"--std=c++11", compute.c_str(), "-default-device"};
   nvrtcResult result = nvrtcCompileProgram(program, args.size(), args.data());
   if (result == NVRTC_ERROR_COMPILATION) {
@@ -53,8 +63,7 @@ CUDAFusedKernel::CUDAFusedKernel(
     nvrtcGetProgramLogSize(program, &logsize);
     std::vector<char> log(logsize);
     nvrtcGetProgramLog(program, log.data());
-    cu << log.data();
-    throw std::runtime_error(cu.str());
+    throw std::runtime_error(compilation_unit + log.data());
   }
   ResourceGuard holdProgram([&] {
     TORCH_NVRTC_CHECK(nvrtcDestroyProgram(&program));
@@ -63,8 +72,38 @@ CUDAFusedKernel::CUDAFusedKernel(
 
   size_t ptx_size;
   TORCH_NVRTC_CHECK(nvrtcGetPTXSize(program, &ptx_size));
-  ptx.resize(ptx_size);
+  std::vector<char> ptx(ptx_size);
   TORCH_NVRTC_CHECK(nvrtcGetPTX(program, ptx.data()));
+  return ptx;
+}
+
+CUDAFusedKernel::CUDAFusedKernel(
+  const std::string& name
+, AnnotatedGraph& agraph)
+: FusedKernel(name, agraph) {
+  at::DeviceGuard device_guard(agraph.device);
+
+  TORCH_CUDA_CHECK(cudaGetDeviceProperties(&prop, agraph.device));
+  checkCUDAVersion(prop);
+
+  std::stringstream cu;
+  std::tie(chunk_desc, concat_desc, reduction_desc, has_random) = emitCompilationUnit(cu, name, agraph, true);
+  compilation_unit = cu.str();
+
+  std::string compute = "--gpu-architecture=compute_" + std::to_string(prop.major) + std::to_string(prop.minor);
+  std::string symbol = name;
+  std::string key = KernelCache::enabled() ? cacheKey(name, compute, compilation_unit) : "";
+  auto entry = KernelCache::lookup(key, "ptx");
+  if (entry) {
+    std::ifstream in(entry->path, std::ios::binary);
+    ptx.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    ptx.push_back('\0');
+    symbol = entry->kernel_name;
+  } else {
+    ptx = compileToPTX(compilation_unit, compute);
+    // Stored without the terminating null.
+    KernelCache::store(key, "ptx", name, std::string(ptx.data(), ptx.size() - 1));
+  }
   CUcontext pctx = 0;
   TORCH_CU_CHECK(cuCtxGetCurrent(&pctx));
   if (!pctx) {
@@ -73,7 +112,7 @@ CUDAFusedKernel::CUDAFusedKernel(
      cudaFree(0);
   }
   TORCH_CU_CHECK(cuModuleLoadData(&module, ptx.data()));
-  TORCH_CU_CHECK(cuModuleGetFunction(&function, module, name.c_str()));
+  TORCH_CU_CHECK(cuModuleGetFunction(&function, module, symbol.c_str()));
 
   TORCH_CU_CHECK(cuOccupancyMaxActiveBlocksPerMultiprocessor(
     &maxBlocks, function, 128, 0));
@@ -81,7 +120,13 @@ CUDAFusedKernel::CUDAFusedKernel(
 }
 
 void CUDAFusedKernel::launch_raw(uint32_t numel, void** arguments) {
-  int numBlocks = std::min(maxBlocks, ceilDiv(numel, blockSize));
+  // Kernels with reductions use a block for each of the numel reduced
+  // elements, the rest a thread for each of the numel elements.
+  int numBlocks = hasReduction()
+    ? std::min<int>(maxBlocks, numel)
+    : std::min(maxBlocks, ceilDiv(numel, blockSize));
+  if (numBlocks == 0)
+    return;
 
      //std::cout << "maxBlocks = " << maxBlocks << " needed blocks: " << ceilDiv(numel,blockSize)
      //          << " numblocks =  " << numBlocks;
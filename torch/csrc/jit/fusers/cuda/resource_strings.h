@@ -155,6 +155,98 @@ void ${kernelName}(IndexType totalElements, ${formals} ${RandParam}) {
 }
 )");
 
+// Accumulators of reductions. Welford's algorithm keeps var and std
+// numerically stable in a single pass over the reduced elements, and lets
+// the partial results of different threads be combined.
+constexpr auto reduction_support_literal = R"(
+template<typename T>
+struct Welford {
+  T mean;
+  T m2;
+  T count;
+};
+
+template<typename T, typename U>
+__device__ inline void welfordUpdate(Welford<T>& a, U x) {
+  a.count += 1;
+  T delta = x - a.mean;
+  a.mean += delta / a.count;
+  a.m2 += delta * (x - a.mean);
+}
+
+template<typename T>
+__device__ inline Welford<T> welfordCombine(const Welford<T>& a, const Welford<T>& b) {
+  if (b.count == 0) return a;
+  if (a.count == 0) return b;
+  Welford<T> r;
+  T delta = b.mean - a.mean;
+  r.count = a.count + b.count;
+  r.mean = a.mean + delta * b.count / r.count;
+  r.m2 = a.m2 + b.m2 + delta * delta * a.count * b.count / r.count;
+  return r;
+}
+
+template<typename T>
+__device__ inline T reduceAdd(T a, T b) {
+  return a + b;
+}
+
+template<typename T>
+__device__ inline T welfordVar(const Welford<T>& a, bool unbiased) {
+  return a.m2 / (a.count - (unbiased ? 1 : 0));
+}
+)";
+
+// Tree reduction of one accumulator across the threads of a block. Needs
+// blockDim.x to be a power of two, no larger than REDUCE_BLOCK_SIZE.
+auto cuda_block_reduce_template = CodeTemplate(R"(
+${acc}_buffer[threadIdx.x] = ${acc};
+__syncthreads();
+for (unsigned int s = blockDim.x / 2; s > 0; s >>= 1) {
+  if (threadIdx.x < s)
+    ${acc}_buffer[threadIdx.x] = ${combine}(${acc}_buffer[threadIdx.x], ${acc}_buffer[threadIdx.x + s]);
+  __syncthreads();
+}
+${acc} = ${acc}_buffer[0];
+)");
+
+// Each block produces one element of each reduced output at a time, from
+// reduceSize consecutive elements of the map. REDUCE_BLOCK_SIZE matches
+// CUDAFusedKernel::blockSize.
+auto cuda_reduction_compilation_unit_template = CodeTemplate(R"(
+${type_declarations}
+${ReduceHeader}
+
+#define REDUCE_BLOCK_SIZE 128
+
+extern "C" __global__
+void ${kernelName}(IndexType totalElements, ${formals}) {
+  ${reduceShared}
+  for (IndexType reduceIndex = blockIdx.x;
+        reduceIndex < totalElements;
+        reduceIndex += gridDim.x) {
+    ${reduceInit}
+    for (IndexType innerIndex = threadIdx.x;
+          innerIndex < reduceSize;
+          innerIndex += blockDim.x) {
+      IndexType linearIndex = reduceIndex * reduceSize + innerIndex;
+      // Convert `linearIndex` into an offset of tensor:
+      ${tensorOffsets}
+      // calculate the results
+      ${kernelBody}
+    }
+    // combine the partial results of all threads
+    ${reduceCombine}
+    if (threadIdx.x == 0) {
+      // Convert `reduceIndex` into an offset of the reduced tensors:
+      ${reduceOffsets}
+      ${reduceEpilogue}
+    }
+    // the buffers are reused for the next reduced element
+    __syncthreads();
+  }
+}
+)");
 
 // This snippet enables half support in the jit. Following the pattern for
 // reductions, fp16 input data is immediately upconverted to float
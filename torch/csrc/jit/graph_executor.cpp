@@ -21,9 +21,13 @@
 #include "torch/csrc/jit/passes/remove_expands.h"
 #include "torch/csrc/jit/passes/canonicalize_ops.h"
 #include "torch/csrc/jit/passes/specialize_undef.h"
+#include "torch/csrc/jit/passes/loop_optimization.h"
 #include "torch/csrc/jit/passes/loop_unrolling.h"
 #include "torch/csrc/jit/passes/lower_grad_of.h"
+#include "torch/csrc/jit/passes/memory_planning.h"
+#include "torch/csrc/jit/passes/parallelize_branches.h"
 #include "torch/csrc/jit/passes/constant_propagation.h"
+#include "torch/csrc/jit/passes/convert_to_inplace.h"
 #include "torch/csrc/jit/passes/inline_autodiff_subgraphs.h"
 #include "torch/csrc/jit/passes/requires_grad_analysis.h"
 #include "torch/csrc/jit/symbolic_variable.h"
@@ -32,9 +36,13 @@
 
 #include "torch/csrc/autograd/edge.h"
 #include "torch/csrc/autograd/function.h"
+#include "torch/csrc/autograd/profiler.h"
 #include "torch/csrc/jit/script/compiler.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -46,6 +54,72 @@ namespace torch { namespace jit {
 
 namespace {
 
+std::atomic<size_t> plan_cache_capacity {64};
+
+std::atomic<bool> pass_report_enabled {false};
+std::mutex pass_report_mutex;
+std::unordered_map<std::string, PassStats> pass_report;
+
+size_t countNodes(Block* block) {
+  size_t count = 0;
+  for (Node* node : block->nodes()) {
+    ++count;
+    for (Block* sub : node->blocks()) {
+      count += countNodes(sub);
+    }
+  }
+  return count;
+}
+
+// Adds the time and the node counts of the graph before and after a pass to
+// the pass report, if it is enabled. The graph is the first argument of the
+// pass.
+struct PassRecord {
+  template <typename... Args>
+  PassRecord(const char* name, const std::shared_ptr<Graph>& graph, const Args&...)
+    : PassRecord(name, graph.get()) {}
+  template <typename... Args>
+  PassRecord(const char* name, Graph& graph, const Args&...)
+    : PassRecord(name, &graph) {}
+
+  ~PassRecord() {
+    if (!graph) return;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    size_t nodes_after = countNodes(graph->block());
+    std::lock_guard<std::mutex> guard(pass_report_mutex);
+    auto& stats = pass_report[name];
+    ++stats.calls;
+    stats.seconds += elapsed.count();
+    stats.nodes_before += nodes_before;
+    stats.nodes_after += nodes_after;
+  }
+
+private:
+  PassRecord(const char* name, Graph* graph)
+    : name(name)
+    , graph(pass_report_enabled.load() ? graph : nullptr) {
+    if (this->graph) {
+      nodes_before = countNodes(graph->block());
+      start = std::chrono::steady_clock::now();
+    }
+  }
+
+  const char* name;
+  Graph* graph;
+  size_t nodes_before = 0;
+  std::chrono::steady_clock::time_point start;
+};
+
+// Runs a pass inside an autograd profiler range named after it, so that the
+// time spent compiling execution plans shows up in profiles, and adds it to
+// the pass report.
+#define RUN_PASS(pass, ...)                                       \
+  do {                                                            \
+    autograd::profiler::RecordFunction pass_record("jit::" #pass); \
+    PassRecord pass_report_record(#pass, __VA_ARGS__);            \
+    pass(__VA_ARGS__);                                            \
+  } while (0)
+
 using tensor_list = std::vector<at::Tensor>;
 using Variable = autograd::Variable;
 using autograd::variable_list;
@@ -333,8 +407,13 @@ struct GraphExecutorImpl {
       return runTraced(stack);
     }
 
-    auto & execution_plan = optimize ? getOrCompile(stack) : getOrCompileFallback();
-    return execution_plan.run(stack);
+    if (!optimize) {
+      return getOrCompileFallback().run(stack);
+    }
+    // Hold on to the plan while it runs, it might get evicted from plan_cache
+    // by another thread in the meantime.
+    auto execution_plan = getOrCompile(stack);
+    return execution_plan->run(stack);
   }
 
   std::shared_ptr<Graph> graphFor(const Stack& stack) const {
@@ -346,20 +425,33 @@ struct GraphExecutorImpl {
       return fallback.graph;
     }
 
+    std::lock_guard<std::mutex> lock(compile_mutex);
     auto it = plan_cache.find(spec);
     AT_CHECK(it != plan_cache.end(), "No graph found for given inputs");
-    return it->second.graph;
+    return it->second.plan->graph;
+  }
+
+  std::shared_ptr<Graph> optimizedGraphFor(const Stack& stack) {
+    AT_CHECK(stack.size() >= num_inputs, "expected ", num_inputs, " inputs, but got only ", stack.size());
+    if (!optimize) {
+      return getOrCompileFallback().graph;
+    }
+    return getOrCompile(stack)->graph;
   }
 
   GraphExecutorState getDebugState() {
+    std::lock_guard<std::mutex> lock(compile_mutex);
     GraphExecutorState state;
     state.graph = graph.get();
     if (fallback) {
       state.fallback = fallback.getDebugState();
     }
     for (auto & entry : plan_cache) {
-      state.execution_plans.emplace(entry.first, entry.second.getDebugState());
+      state.execution_plans.emplace(entry.first, entry.second.plan->getDebugState());
     }
+    state.plan_cache_hits = plan_cache_hits;
+    state.plan_cache_misses = plan_cache_misses;
+    state.plan_cache_evictions = plan_cache_evictions;
     return state;
   }
 
@@ -384,38 +476,79 @@ private:
     return fallback;
   }
 
-  const ExecutionPlan & getOrCompile(const Stack& stack) {
+  std::shared_ptr<const ExecutionPlan> getOrCompile(const Stack& stack) {
+    bool with_grad = autograd::GradMode::is_enabled();
+    auto inputs = last(stack, num_inputs);
+    // Fast path: the inputs are of the same kinds as last time, which can be
+    // checked without building and hashing an ArgumentSpec or taking the lock.
+    if (auto last_used = std::atomic_load(&last_used_plan)) {
+      if (last_used->spec.matches(with_grad, inputs)) {
+        plan_cache_hits++;
+        return last_used->plan;
+      }
+    }
     // outside lock guard, to minimize the time holding the lock on the fast path
     // ArgumentSpec even computes its hashCode here.
-    ArgumentSpec spec(autograd::GradMode::is_enabled(), last(stack, num_inputs), num_flat_inputs);
+    ArgumentSpec spec(with_grad, inputs, num_flat_inputs);
     {
       std::lock_guard<std::mutex> lock(compile_mutex);
       auto it = plan_cache.find(spec);
-      if (it != plan_cache.end())
-        return it->second;
-      auto plan = compileSpec(spec);
-      auto r = plan_cache.emplace(std::move(spec), std::move(plan));
-      return r.first->second;
+      if (it != plan_cache.end()) {
+        plan_cache_hits++;
+        lru.splice(lru.begin(), lru, it->second.lru_pos);
+        setLastUsedPlan(it->first, it->second.plan);
+        return it->second.plan;
+      }
+      plan_cache_misses++;
+      auto plan = std::make_shared<const ExecutionPlan>(compileSpec(spec));
+      // Make room for the new plan.
+      size_t capacity = plan_cache_capacity.load();
+      if (capacity > 0)
+        evictPlans(capacity - 1);
+      auto r = plan_cache.emplace(std::move(spec), PlanCacheEntry());
+      lru.push_front(&r.first->first);
+      r.first->second.plan = plan;
+      r.first->second.lru_pos = lru.begin();
+      setLastUsedPlan(r.first->first, plan);
+      return plan;
+    }
+  }
+
+  void setLastUsedPlan(const ArgumentSpec& spec, std::shared_ptr<const ExecutionPlan> plan) {
+    std::atomic_store(
+        &last_used_plan,
+        std::make_shared<const LastUsedPlan>(LastUsedPlan{spec, std::move(plan)}));
+  }
+
+  // Drops the least recently used plans until at most max_plans are left.
+  // Must be called with compile_mutex held.
+  void evictPlans(size_t max_plans) {
+    while (plan_cache.size() > max_plans) {
+      const ArgumentSpec* spec = lru.back();
+      lru.pop_back();
+      plan_cache.erase(*spec);
+      plan_cache_evictions++;
     }
   }
 
   ExecutionPlan compileSpec(const ArgumentSpec & spec) {
+    autograd::profiler::RecordFunction compile_record("GraphExecutor::compile");
     auto opt_graph = graph->copy();
     setInputTypes(*opt_graph, spec);
 
     // Phase 1. Specialize to input definedness (this is very important for
     //          gradient graphs), and run required passes to bring the graph
     //          to an executable form.
-    runRequiredPasses(opt_graph);
+    RUN_PASS(runRequiredPasses, opt_graph);
 
     // Phase 2. Propagate detailed information about the spec through the
     //          graph (enabled more specializations in later passes).
     //          Shape propagation sometimes depends on certain arguments being
     //          constants, and constant propagation doesn't need shape information
     //          anyway, so it's better to run it first.
-    ConstantPropagation(opt_graph);
-    PropagateInputShapes(*opt_graph);
-    PropagateRequiresGrad(opt_graph);
+    RUN_PASS(ConstantPropagation, opt_graph);
+    RUN_PASS(PropagateInputShapes, *opt_graph);
+    RUN_PASS(PropagateRequiresGrad, opt_graph);
 
     // Phase 3. Run differentiable optimizations (i.e. simple graph rewrites that
     //          we can still execute using autograd).
@@ -426,34 +559,53 @@ private:
     // Phase 5. Apply non-differentiable optimizations to the graphs we've found
     //          (or the whole grpah if we know we won't need its derivative).
     if (needsGradient(opt_graph)) {
-      auto diff_nodes = CreateAutodiffSubgraphs(*opt_graph, autodiffSubgraphNodeThreshold);
+      std::vector<Node*> diff_nodes;
+      {
+        autograd::profiler::RecordFunction pass_record("jit::CreateAutodiffSubgraphs");
+        diff_nodes = CreateAutodiffSubgraphs(*opt_graph, autodiffSubgraphNodeThreshold);
+      }
       for (Node * dnode : diff_nodes) {
         auto diff_graph = std::move(dnode->g(attr::Subgraph));
-        Gradient gradient = differentiate(diff_graph);
+        Gradient gradient;
+        {
+          autograd::profiler::RecordFunction pass_record("jit::differentiate");
+          gradient = differentiate(diff_graph);
+        }
         runNondiffOptimization(gradient.f);
         packGradient(gradient, dnode);
       }
-      InlineAutodiffSubgraphs(opt_graph, autodiffSubgraphInlineThreshold);
+      RUN_PASS(InlineAutodiffSubgraphs, opt_graph, autodiffSubgraphInlineThreshold);
     } else {
       runNondiffOptimization(opt_graph);
+      // Memory planning only looks at the top level block, so after this none
+      // of the values computed on other threads share the arena.
+      if (getInterOpThreads() > 1) {
+        RUN_PASS(ParallelizeBranches, opt_graph);
+      }
+      if (memoryPlanningEnabled()) {
+        RUN_PASS(PlanMemory, opt_graph);
+        RUN_PASS(ConvertToInplaceOps, opt_graph);
+      }
     }
     // Make sure there are no leftovers from any passes.
-    EliminateDeadCode(opt_graph);
+    RUN_PASS(EliminateDeadCode, opt_graph);
     return ExecutionPlan(opt_graph);
   }
 
   void runOptimization(std::shared_ptr<Graph>& graph, const ArgumentSpec& spec) {
-    EliminateDeadCode(graph);
-    EliminateCommonSubexpression(graph);
-    ConstantPooling(graph);
-    UnrollLoops(graph);
-    PeepholeOptimize(graph);
-    CheckInplace(graph);
-    BatchMM(graph);
+    RUN_PASS(EliminateDeadCode, graph);
+    RUN_PASS(EliminateCommonSubexpression, graph);
+    RUN_PASS(ConstantPooling, graph);
+    RUN_PASS(FuseLoops, graph);
+    RUN_PASS(HoistLoopInvariants, graph);
+    RUN_PASS(UnrollLoops, graph);
+    RUN_PASS(PeepholeOptimize, graph);
+    RUN_PASS(CheckInplace, graph);
+    RUN_PASS(BatchMM, graph);
   }
 
   void runNondiffOptimization(std::shared_ptr<Graph>& graph) {
-    FuseGraph(graph);
+    RUN_PASS(FuseGraph, graph);
   }
 
   static bool needsGradient(const std::shared_ptr<const Graph>& graph) {
@@ -528,8 +680,29 @@ private:
   ExecutionPlan fallback;
 
   // Mapping from argument configurations to optimized versions of the graph that are
-  // specialized to the spec.
-  std::unordered_map<ArgumentSpec, ExecutionPlan> plan_cache;
+  // specialized to the spec. Specs only capture the rank, type, device and
+  // requires_grad of inputs, not their sizes, but a long running process can still
+  // see an unbounded number of them, so the cache holds at most
+  // getPlanCacheCapacity() plans and evicts the least recently used ones.
+  struct PlanCacheEntry {
+    std::shared_ptr<const ExecutionPlan> plan;
+    std::list<const ArgumentSpec*>::iterator lru_pos;
+  };
+  std::unordered_map<ArgumentSpec, PlanCacheEntry> plan_cache;
+  // Keys of plan_cache, most recently used first. References to keys of an
+  // unordered_map stay valid until the element is erased.
+  std::list<const ArgumentSpec*> lru;
+  // The plan getOrCompile returned last, which is also the front of lru. The
+  // next call checks its spec first, and only looks in plan_cache if the inputs
+  // don't match it. Accessed with atomic_load and atomic_store, without the lock.
+  struct LastUsedPlan {
+    ArgumentSpec spec;
+    std::shared_ptr<const ExecutionPlan> plan;
+  };
+  std::shared_ptr<const LastUsedPlan> last_used_plan;
+  std::atomic<size_t> plan_cache_hits {0};
+  size_t plan_cache_misses = 0;
+  size_t plan_cache_evictions = 0;
 
   // GraphExecutors can be accessed from multiple threads, so this thread needs to be
   // held every time we access the fallback or plan_cache.
@@ -555,6 +728,10 @@ std::shared_ptr<Graph> GraphExecutor::graphFor(const Stack& inputs) const {
   return pImpl->graphFor(inputs);
 }
 
+std::shared_ptr<Graph> GraphExecutor::optimizedGraphFor(const Stack& inputs) {
+  return pImpl->optimizedGraphFor(inputs);
+}
+
 GraphExecutorState GraphExecutor::getDebugState() {
   return pImpl->getDebugState();
 }
@@ -564,6 +741,28 @@ void GraphExecutor::debugDisableAutodiffSubgraphInlining() {
 }
 
 
+size_t getPlanCacheCapacity() {
+  return plan_cache_capacity.load();
+}
+
+void setPlanCacheCapacity(size_t capacity) {
+  plan_cache_capacity.store(capacity);
+}
+
+void setPassReportEnabled(bool enabled) {
+  pass_report_enabled.store(enabled);
+}
+
+std::unordered_map<std::string, PassStats> getPassReport() {
+  std::lock_guard<std::mutex> guard(pass_report_mutex);
+  return pass_report;
+}
+
+void clearPassReport() {
+  std::lock_guard<std::mutex> guard(pass_report_mutex);
+  pass_report.clear();
+}
+
 void runRequiredPasses(const std::shared_ptr<Graph>& g)  {
   specializeUndef(*g);
   LowerGradOf(*g);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include "torch/csrc/jit/ir.h"
 #include "torch/csrc/jit/variable_tensor_list.h"
 #include "torch/csrc/jit/interpreter.h"
@@ -23,6 +25,9 @@ struct GraphExecutorState {
   const Graph* graph;
   ExecutionPlanState fallback; // XXX: members of this field are optional
   std::unordered_map<ArgumentSpec, ExecutionPlanState> execution_plans;
+  size_t plan_cache_hits = 0;
+  size_t plan_cache_misses = 0; // == number of specializations compiled
+  size_t plan_cache_evictions = 0;
 };
 
 struct GraphExecutorImpl;
@@ -35,6 +40,8 @@ struct TORCH_API GraphExecutor {
   }
   std::shared_ptr<Graph> graph() const;
   std::shared_ptr<Graph> graphFor(const Stack& inputs) const;
+  // Like graphFor, but compiles the graph if these inputs haven't been seen yet.
+  std::shared_ptr<Graph> optimizedGraphFor(const Stack& inputs);
   GraphExecutorState getDebugState();
   void debugDisableAutodiffSubgraphInlining();
 private:
@@ -45,6 +52,27 @@ private:
 // regardless of whether sizes have been specialized or not.
 TORCH_API void runRequiredPasses(const std::shared_ptr<Graph>& g);
 
+// Maximum number of specializations every GraphExecutor keeps around, the least
+// recently used ones are dropped once it is reached. 0 means unbounded.
+// Lowering it doesn't shrink existing caches until they compile a new plan.
+TORCH_API size_t getPlanCacheCapacity();
+TORCH_API void setPlanCacheCapacity(size_t capacity);
+
+// Cumulative cost of one pass over all the execution plans compiled while the
+// pass report is enabled. Counting nodes walks the whole graph, so nothing is
+// collected by default.
+struct PassStats {
+  size_t calls = 0;
+  double seconds = 0;
+  size_t nodes_before = 0;
+  size_t nodes_after = 0;
+};
+
+TORCH_API void setPassReportEnabled(bool enabled);
+// Keyed by pass name, e.g. "EliminateCommonSubexpression"
+TORCH_API std::unordered_map<std::string, PassStats> getPassReport();
+TORCH_API void clearPassReport();
+
 namespace detail {
 
 GraphExecutor* getGradExecutor(Operation& op);
@@ -8,11 +8,12 @@
 #include "onnx/onnx_pb.h"
 
 #include <ATen/ATen.h>
+#include <TH/THAllocator.h>
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 #include <string>
-#include <fstream>
 
 namespace torch { namespace jit {
 
@@ -27,7 +28,18 @@ class ModuleDecoder {
   ModuleDecoder(ModuleLookup module_lookup,
                 std::istream& in);
 
+  // Maps the file into memory instead of reading it. Tensors are created
+  // directly on top of the mapping, which is private and copy-on-write, so
+  // processes loading the same file share the physical pages of any weights
+  // they don't modify.
+  ModuleDecoder(ModuleLookup module_lookup,
+                const std::string& filename);
+
  private:
+  void decode(ModuleLookup module_lookup);
+
+  std::tuple<at::DataPtr, size_t> getRecordWithKey(uint64_t key);
+
   std::shared_ptr<Graph> buildGraph(const onnx::GraphProto& graph_proto);
 
   void buildBlock(const onnx::GraphProto& graph_proto, Block* block,
@@ -57,7 +69,12 @@ class ModuleDecoder {
       ModuleLookup module_lookup,
       const std::string fullname);
 
-  PyTorchStreamReader stream_reader_;
+  // Exactly one of these is set
+  std::unique_ptr<PyTorchStreamReader> stream_reader_;
+  std::unique_ptr<PyTorchBufferReader> buffer_reader_;
+  // Every record read from buffer_reader_ holds a reference to the mapping.
+  std::shared_ptr<at::DataPtr> mapped_file_;
+
   std::unordered_map<uint64_t, std::shared_ptr<at::Storage>> storage_map_;
   std::unordered_map<std::string, const onnx::TypeProto*> value_type_map_;
 };
@@ -294,7 +311,7 @@ at::Tensor ModuleDecoder::buildTensorCommon(
   if (storage_it == storage_map_.end()) {
     at::DataPtr storage_ptr;
     int64_t size;
-    std::tie(storage_ptr, size) = stream_reader_.getRecordWithKey(record_number);
+    std::tie(storage_ptr, size) = getRecordWithKey(record_number);
     auto storage = std::make_shared<at::Storage>(
       at::CPU(type).typeMeta(),
       std::move(storage_ptr),
@@ -326,12 +343,43 @@ std::pair<std::shared_ptr<script::Module>, std::string> ModuleDecoder::parseFull
   return std::make_pair(module_lookup(vec), std::move(last));
 }
 
+std::tuple<at::DataPtr, size_t> ModuleDecoder::getRecordWithKey(uint64_t key) {
+  if (stream_reader_) {
+    return stream_reader_->getRecordWithKey(key);
+  }
+  size_t offset, size;
+  std::tie(offset, size) = buffer_reader_->getRecordWithKey(key);
+  auto data = static_cast<char*>(mapped_file_->get()) + offset;
+  return std::tuple<at::DataPtr, size_t>(
+    at::DataPtr(data, new std::shared_ptr<at::DataPtr>(mapped_file_), [](void* ctx) {
+      delete static_cast<std::shared_ptr<at::DataPtr>*>(ctx);
+    }, at::kCPU),
+    size);
+}
+
 ModuleDecoder::ModuleDecoder(
     ModuleLookup module_lookup,
     std::istream& in) :
-    stream_reader_(in) {
+    stream_reader_(new PyTorchStreamReader(in)) {
+  decode(std::move(module_lookup));
+}
+
+ModuleDecoder::ModuleDecoder(
+    ModuleLookup module_lookup,
+    const std::string& filename) {
+  size_t size;
+  mapped_file_ = std::make_shared<at::DataPtr>(
+    THMapAllocator::makeDataPtr(filename.c_str(), /*flags=*/0, /*size=*/0, &size));
+  AT_CHECK(mapped_file_->get(), "unable to mmap ", filename);
+  buffer_reader_.reset(new PyTorchBufferReader(static_cast<const char*>(mapped_file_->get()), size));
+  decode(std::move(module_lookup));
+}
+
+void ModuleDecoder::decode(ModuleLookup module_lookup) {
   auto model_proto = onnx::ModelProto();
-  auto record = stream_reader_.getLastRecord();
+  auto record = stream_reader_
+    ? stream_reader_->getLastRecord()
+    : getRecordWithKey(buffer_reader_->getLastRecordKey());
   model_proto.ParsePartialFromArray(std::get<0>(record).get(), std::get<1>(record));
   auto graph_proto = model_proto.graph();
 
@@ -380,13 +428,13 @@ void import_ir_module(
 void import_ir_module(
     ModuleLookup module_lookup,
     const std::string& filename) {
-  std::ifstream in(filename, std::ios_base::binary);
-
-  ModuleDecoder decoder(module_lookup, in);
+  ModuleDecoder decoder(module_lookup, filename);
   (void)decoder;
 }
 
-std::shared_ptr<script::Module> load(std::istream& in) {
+// source is either an istream or a filename
+template <typename Source>
+static std::shared_ptr<script::Module> loadFrom(Source& source) {
   auto module = std::make_shared<script::Module>();
 
   auto module_lookup = [&](const std::vector<std::string>& qualified_name) {
@@ -400,18 +448,18 @@ std::shared_ptr<script::Module> load(std::istream& in) {
     return curr;
   };
 
-  ModuleDecoder decoder(module_lookup, in);
+  ModuleDecoder decoder(module_lookup, source);
   (void)decoder;
 
   return module;
 }
 
-std::shared_ptr<script::Module> load(const std::string& filename) {
-  std::ifstream in(filename, std::ios_base::binary);
-
-  auto module = load(in);
+std::shared_ptr<script::Module> load(std::istream& in) {
+  return loadFrom(in);
+}
 
-  return module;
+std::shared_ptr<script::Module> load(const std::string& filename) {
+  return loadFrom(filename);
 }
 
 }}
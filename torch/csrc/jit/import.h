@@ -28,6 +28,12 @@ TORCH_API std::shared_ptr<script::Module> load(std::istream& in);
 /// The file stored at the location given in `filename` must contain a
 /// serialized `script::Module`, exported either via `ScriptModule.save()` in
 /// Python or `torch::jit::ExportModule` in C++.
+///
+/// The file is memory mapped rather than read, and the module's tensors use
+/// the mapping as their storage. The mapping is copy-on-write, so modifying
+/// them never changes the file, while processes loading the same file share
+/// the memory of the weights they only read. The file must not be truncated
+/// or overwritten in place while the module is alive.
 TORCH_API std::shared_ptr<script::Module> load(const std::string& filename);
 
 } // namespace jit
@@ -18,12 +18,19 @@
 #include "torch/csrc/jit/passes/constant_pooling.h"
 #include "torch/csrc/jit/passes/create_autodiff_subgraphs.h"
 #include "torch/csrc/jit/passes/peephole.h"
+#include "torch/csrc/jit/passes/prepack_linear.h"
+#include "torch/csrc/jit/passes/quantization.h"
+#include "torch/csrc/jit/passes/freeze.h"
+#include "torch/csrc/jit/passes/memory_planning.h"
+#include "torch/csrc/jit/passes/convert_to_inplace.h"
+#include "torch/csrc/jit/passes/parallelize_branches.h"
 #include "torch/csrc/jit/passes/canonicalize.h"
 #include "torch/csrc/jit/passes/onnx/peephole.h"
 #include "torch/csrc/jit/passes/onnx/fixup_onnx_loop.h"
 #include "torch/csrc/jit/passes/shape_analysis.h"
 #include "torch/csrc/jit/passes/canonicalize_ops.h"
 #include "torch/csrc/jit/passes/constant_propagation.h"
+#include "torch/csrc/jit/passes/loop_optimization.h"
 #include "torch/csrc/jit/passes/loop_unrolling.h"
 #include "torch/csrc/jit/passes/to_batch.h"
 #include "torch/csrc/jit/passes/lower_tuples.h"
@@ -32,6 +39,7 @@
 #include "torch/csrc/jit/script/init.h"
 #include "torch/csrc/jit/script/python_tree_views.h"
 #include "torch/csrc/jit/batched/BatchTensor.h"
+#include "torch/csrc/jit/batched/DynamicBatcher.h"
 #include "torch/csrc/jit/pybind_utils.h"
 #include "torch/csrc/jit/function_schema.h"
 #include "torch/csrc/jit/operator.h"
@@ -92,6 +100,18 @@ void initJITBindings(PyObject *module) {
    })
    .def("_jit_pass_constant_pooling", ConstantPooling)
    .def("_jit_pass_peephole", PeepholeOptimize, py::arg("graph"), py::arg("addmm_fusion_enabled") = false)
+   .def("_jit_pass_prepack_linear", PrepackLinearWeights)
+   .def("_jit_pass_fuse_quantized_ops", FuseQuantizedOps)
+   .def("_jit_pass_freeze_parameters", [](const std::shared_ptr<Graph>& g, std::vector<at::Tensor> params) {
+     return FreezeParameters(g, params);
+   })
+   .def("_jit_pass_fold_batch_norm", FoldBatchNorm)
+   .def("_jit_pass_pretranspose_linear_weights", PretransposeLinearWeights)
+   .def("_jit_pass_fold_shape_queries", FoldShapeQueries)
+   .def("_jit_pass_optimize_frozen_graph", OptimizeFrozenGraph)
+   .def("_jit_pass_plan_memory", PlanMemory)
+   .def("_jit_pass_convert_to_inplace", ConvertToInplaceOps)
+   .def("_jit_pass_parallelize_branches", ParallelizeBranches)
    .def("_jit_pass_canonicalize", [](const std::shared_ptr<Graph>& g) {
      return Canonicalize(g);
    })
@@ -113,6 +133,8 @@ void initJITBindings(PyObject *module) {
    .def("_jit_pass_erase_number_types", EraseNumberTypes)
    .def("_jit_pass_prepare_division_for_onnx", PrepareDivisionForONNX)
    .def("_jit_pass_loop_unrolling", UnrollLoops)
+   .def("_jit_pass_hoist_loop_invariants", HoistLoopInvariants)
+   .def("_jit_pass_fuse_loops", FuseLoops)
    .def("_jit_pass_constant_propagation", [](std::shared_ptr<Graph>& g) {
      return ConstantPropagation(g);
    })
@@ -139,6 +161,23 @@ void initJITBindings(PyObject *module) {
    .def("_jit_pass_canonicalize_ops", CanonicalizeOps)
    .def("_jit_pass_specialize_undef", specializeUndef)
    .def("_jit_override_can_fuse_on_cpu", &overrideCanFuseOnCPU)
+   .def("_jit_set_memory_planning_enabled", &setMemoryPlanningEnabled)
+   .def("_jit_get_inter_op_threads", &getInterOpThreads)
+   .def("_jit_set_inter_op_threads", &setInterOpThreads)
+   .def("_jit_get_plan_cache_capacity", &getPlanCacheCapacity)
+   .def("_jit_set_plan_cache_capacity", &setPlanCacheCapacity)
+   .def("_jit_set_pass_report_enabled", &setPassReportEnabled)
+   .def("_jit_clear_pass_report", &clearPassReport)
+   .def("_jit_get_pass_report", []() {
+     // {pass name: (calls, seconds, nodes before, nodes after)}
+     py::dict report;
+     for (const auto& entry : getPassReport()) {
+       const PassStats& stats = entry.second;
+       report[py::str(entry.first)] = py::make_tuple(
+           stats.calls, stats.seconds, stats.nodes_before, stats.nodes_after);
+     }
+     return report;
+   })
    .def("_jit_differentiate", [](Graph &g) {
        // the python binding slightly differs in semantics
        // it makes a copy of the input Graph, and works on that
@@ -199,6 +238,15 @@ void initJITBindings(PyObject *module) {
     })
     .def_property_readonly("fallback", [](GraphExecutorState& s) {
       return s.fallback;
+    })
+    .def_property_readonly("plan_cache_hits", [](GraphExecutorState& s) {
+      return s.plan_cache_hits;
+    })
+    .def_property_readonly("plan_cache_misses", [](GraphExecutorState& s) {
+      return s.plan_cache_misses;
+    })
+    .def_property_readonly("plan_cache_evictions", [](GraphExecutorState& s) {
+      return s.plan_cache_evictions;
     });
 
   py::class_<GraphExecutor>(m, "GraphExecutor", py::dynamic_attr())
@@ -310,6 +358,7 @@ void initJITBindings(PyObject *module) {
   script::initTreeViewBindings(module);
   script::initJitScriptBindings(module);
   initBatchTensorBindings(module);
+  initDynamicBatcherBindings(module);
   initRegisterBatchOpsBindings(module);
 }
 
@@ -11,6 +11,7 @@
 #include "torch/csrc/jit/ivalue.h"
 #include "torch/csrc/jit/constants.h"
 #include "torch/csrc/jit/operator.h"
+#include "torch/csrc/jit/source_range.h"
 #include "torch/csrc/variable_tensor_functions.h"
 
 #include <exception>
@@ -18,7 +19,9 @@
 #include <memory>
 #include <mutex>
 #include <ostream>
+#include <sstream>
 #include <stdexcept>
+#include <string>
 #include <typeinfo>
 #include <unordered_map>
 #include <unordered_set>
@@ -346,8 +349,61 @@ struct UseList {
   ListHandle<bool> free_flags;
 };
 
+// Binary scalar ops the interpreter evaluates itself, reading and writing
+// registers directly instead of boxing through the stack and calling an
+// Operation. These show up all over control flow in script (loop counters,
+// comparisons, index arithmetic), where the call overhead dominates.
+// Their semantics must match the int and float overloads in
+// register_prim_ops.cpp.
+#define FORALL_UNBOXED_BINARY_OPS(_) \
+  _(add, ADD, a + b)                 \
+  _(sub, SUB, a - b)                 \
+  _(mul, MUL, a * b)                 \
+  _(eq, EQ, a == b)                  \
+  _(ne, NE, a != b)                  \
+  _(lt, LT, a < b)                   \
+  _(gt, GT, a > b)                   \
+  _(le, LE, a <= b)                  \
+  _(ge, GE, a >= b)
+
+// How the interpreter executes an instruction. Anything that isn't handled
+// inline by the interpreter loop is a CALL of the instruction's callback.
+enum class OpCode : uint8_t {
+  CALL,
+  ASSIGN,
+  JUMP,
+  JUMP_TRUE,
+  JUMP_FALSE,
+#define DEFINE_OPCODES(aten_op, name, expr) INT_##name, FLOAT_##name,
+  FORALL_UNBOXED_BINARY_OPS(DEFINE_OPCODES)
+#undef DEFINE_OPCODES
+};
+
+OpCode unboxedOpCode(Node* n) {
+  if (n->inputs().size() != 2 || n->outputs().size() != 1)
+    return OpCode::CALL;
+  auto a = n->input(0)->type()->kind();
+  auto b = n->input(1)->type()->kind();
+  if (a != b || (a != TypeKind::IntType && a != TypeKind::FloatType))
+    return OpCode::CALL;
+  bool is_int = a == TypeKind::IntType;
+  switch (n->kind()) {
+#define DEFINE_CASE(aten_op, name, expr) \
+    case aten::aten_op:                  \
+      return is_int ? OpCode::INT_##name : OpCode::FLOAT_##name;
+    FORALL_UNBOXED_BINARY_OPS(DEFINE_CASE)
+#undef DEFINE_CASE
+    default:
+      return OpCode::CALL;
+  }
+}
+
 // one instruction plus meta-data
 struct Instruction {
+  OpCode opcode = OpCode::CALL;
+  int jump_offset = 0; // only used by jumps
+  // Always set, even for instructions the interpreter handles inline, so that
+  // e.g. grad_executors() can inspect every operation of a Code.
   Operation callback;
   UseList inputs;
   ListHandle<int> outputs;
@@ -360,6 +416,30 @@ int relativeJump(int from_inst, int to_inst) {
   return to_inst - (from_inst + 1);
 }
 
+// A one line description of where a node comes from: the line of code for
+// script, and the innermost frame for traces.
+std::string summarize(const SourceLocation& location) {
+  constexpr size_t max_length = 60;
+  std::string line;
+  if (auto range = dynamic_cast<const SourceRange*>(&location)) {
+    const std::string& str = range->file();
+    size_t begin = range->start() > 0 ? str.rfind('\n', range->start() - 1) : std::string::npos;
+    begin = begin == std::string::npos ? 0 : begin + 1;
+    size_t end = str.find('\n', range->start());
+    line = str.substr(begin, end == std::string::npos ? end : end - begin);
+  } else {
+    std::stringstream highlighted;
+    location.highlight(highlighted);
+    std::getline(highlighted, line);
+  }
+  auto begin = line.find_first_not_of(" \t");
+  line = begin == std::string::npos ? "" : line.substr(begin);
+  if (line.size() > max_length) {
+    line = line.substr(0, max_length - 3) + "...";
+  }
+  return line;
+}
+
 struct CodeImpl {
   CodeImpl(std::shared_ptr<Graph>& graph_)
       : preprocess(*graph_) {
@@ -377,6 +457,8 @@ struct CodeImpl {
       return t ? 0 : offset;
     };
     inst.debug_name = prim::JumpZ;
+    inst.opcode = OpCode::JUMP_FALSE;
+    inst.jump_offset = offset;
   }
 
   // jump when input is true
@@ -389,6 +471,8 @@ struct CodeImpl {
       return t ? offset : 0;
     };
     inst.debug_name = prim::JumpNZ;
+    inst.opcode = OpCode::JUMP_TRUE;
+    inst.jump_offset = offset;
   }
 
   void createJump(int from_inst, int to_inst) {
@@ -399,6 +483,8 @@ struct CodeImpl {
       return offset;
     };
     inst.debug_name = prim::Jump;
+    inst.opcode = OpCode::JUMP;
+    inst.jump_offset = offset;
   }
 
   void insertNodesFromBlock(Block* block) {
@@ -483,6 +569,7 @@ struct CodeImpl {
   size_t insertInstruction(Node * n) {
     auto inst = insertInstruction(n->kind(), n->getSourceLocation(), n->inputs(), moveFlags(n) , n->outputs());
     instructions[inst].callback = getOperation(n);
+    instructions[inst].opcode = unboxedOpCode(n);
     return inst;
   }
   size_t insertInstruction(Symbol sym,
@@ -521,6 +608,7 @@ struct CodeImpl {
     // We don't need to manipulate the stack in any way, because all inputs are also outputs,
     // and the interpreter will take care of putting them in correct places.
     instructions[inst].callback = [](Stack& stack) { return 0; };
+    instructions[inst].opcode = OpCode::ASSIGN;
     return inst;
   }
 
@@ -570,6 +658,29 @@ struct CodeImpl {
     return r;
   }
 
+  // Names of the profiler ranges of the instructions, like
+  // "aten::mm (y = torch.mm(x, w))", so that time can be attributed to nodes.
+  // Empty for instructions that aren't worth a range.
+  const std::vector<std::string>& profileNames() {
+    std::call_once(profile_names_once_, [this] {
+      for (Instruction & instr : instructions) {
+        std::string name;
+        if (instr.opcode == OpCode::CALL && instr.debug_name != prim::Constant &&
+            instr.debug_name != prim::Drop) {
+          name = instr.debug_name.toQualString();
+          if (instr.debug_location) {
+            auto summary = summarize(*instr.debug_location);
+            if (!summary.empty()) {
+              name += " (" + summary + ")";
+            }
+          }
+        }
+        profile_names_.push_back(std::move(name));
+      }
+    });
+    return profile_names_;
+  }
+
   const std::vector<GraphExecutor*>& grad_executors() {
     if (!grad_executors_) {
       grad_executors_.emplace();
@@ -621,6 +732,8 @@ struct CodeImpl {
   // keep this around.
   std::shared_ptr<Graph> graph;
   c10::optional<std::vector<GraphExecutor*>> grad_executors_;
+  std::once_flag profile_names_once_;
+  std::vector<std::string> profile_names_;
   PreprocessGraph preprocess;
 
   std::unordered_map<size_t, int> unique_to_reg; // map from unique of nodes to register in register table
@@ -649,20 +762,64 @@ struct InterpreterStateImpl {
     size_t pc = current_pc;
     auto & instructions = function->instructions;
     size_t last = instructions.size();
+    const std::vector<std::string>* profile_names = nullptr;
+    if (autograd::profiler::profilerEnabled()) {
+      profile_names = &function->profileNames();
+    }
     while(pc < last) {
         // std::cout << "executing " << pc << ": ";
         // function->dumpInstruction(std::cout, pc);
         // std::cout << "\n";
         try {
           auto & inst = instructions[pc];
-          loadTensorsFromRegisters(inst.inputs, stack);
-          size_t new_pc = pc + 1 + inst.callback(stack);
-          for(int i = inst.outputs.size - 1; i >= 0; i--) {
-            int reg = get(inst.outputs,i);
-            registers[reg] = pop(stack);
-            // std::cout << "pop reg[" << reg << "];\n" << registers[reg] << "\n";
+          switch (inst.opcode) {
+            case OpCode::CALL:
+            case OpCode::ASSIGN: {
+              loadTensorsFromRegisters(inst.inputs, stack);
+              size_t new_pc = pc + 1;
+              if (inst.opcode == OpCode::CALL) {
+                if (profile_names && !(*profile_names)[pc].empty()) {
+                  autograd::profiler::RecordFunction record((*profile_names)[pc]);
+                  new_pc += inst.callback(stack);
+                } else {
+                  new_pc += inst.callback(stack);
+                }
+              }
+              // Assigns only forward their inputs into different registers.
+              for(int i = inst.outputs.size - 1; i >= 0; i--) {
+                int reg = get(inst.outputs,i);
+                registers[reg] = pop(stack);
+                // std::cout << "pop reg[" << reg << "];\n" << registers[reg] << "\n";
+              }
+              pc = new_pc;
+            } break;
+            case OpCode::JUMP: {
+              pc += 1 + inst.jump_offset;
+            } break;
+            case OpCode::JUMP_TRUE:
+            case OpCode::JUMP_FALSE: {
+              // Loop conditions are left on the stack by the preceding assign,
+              // while If conditions are read from their register.
+              loadTensorsFromRegisters(inst.inputs, stack);
+              bool taken = pop(stack).toBool() == (inst.opcode == OpCode::JUMP_TRUE);
+              pc += 1 + (taken ? inst.jump_offset : 0);
+            } break;
+#define DEFINE_CASES(aten_op, name, expr)                            \
+            case OpCode::INT_##name: {                               \
+              int64_t a = input(inst, 0).toInt();                    \
+              int64_t b = input(inst, 1).toInt();                    \
+              registers[get(inst.outputs, 0)] = IValue(expr);        \
+              ++pc;                                                  \
+            } break;                                                 \
+            case OpCode::FLOAT_##name: {                             \
+              double a = input(inst, 0).toDouble();                  \
+              double b = input(inst, 1).toDouble();                  \
+              registers[get(inst.outputs, 0)] = IValue(expr);        \
+              ++pc;                                                  \
+            } break;
+            FORALL_UNBOXED_BINARY_OPS(DEFINE_CASES)
+#undef DEFINE_CASES
           }
-          pc = new_pc;
         } catch(std::exception & e) {
           if(!instructions[pc].debug_location)
             throw; // rethrow original exception
@@ -678,6 +835,11 @@ struct InterpreterStateImpl {
   bool get(const ListHandle<bool> & list, int i) {
     return bool_data[list.start + i];
   }
+  // Scalars are cheap to keep around, so unlike loadTensorsFromRegisters this
+  // ignores the free flags.
+  const IValue& input(const Instruction & inst, int i) {
+    return registers[get(inst.inputs.values, i)];
+  }
   void loadTensorsFromRegisters(const UseList & uses, Stack & stack) {
     for(int i = 0; i < uses.values.size; i++) {
       int reg = get(uses.values,i);
@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <unordered_map>
 
+#include "ATen/Dispatch.h"
+#include "torch/csrc/autograd/variable.h"
 #include "torch/csrc/jit/assertions.h"
 #include "torch/csrc/jit/interned_strings.h"
 #include "torch/csrc/jit/passes/common_subexpression_elimination.h"
@@ -74,6 +76,71 @@ bool attributesEqualCSE(const Node* lhs, const Node* rhs) {
   return true;
 }
 
+// Hashes the type and sizes of a tensor, and for CPU tensors the values of at
+// most kTensorHashSamples evenly spaced elements. Hashing every element would
+// make hashing large constants as slow as comparing them, but without the
+// values all constants of one shape would share a bucket, and the tables of
+// CSE and constant pooling would degrade to pairwise tensor comparisons.
+// Values are hashed as doubles so that tensors that compare equal, e.g. with
+// 0 and -0, hash equal too.
+size_t tensorHash(const at::Tensor& t) {
+  constexpr int64_t kTensorHashSamples = 16;
+  if (!t.defined()) return 0;
+  size_t seed = get_hash(t.type().backend(), t.type().scalarType(), t.sizes().vec());
+  const at::Tensor& data = t.is_variable() ? autograd::as_variable_ref(t).data() : t;
+  if (data.type().backend() != at::Backend::CPU || !data.is_contiguous()) {
+    return seed;
+  }
+  const int64_t numel = data.numel();
+  const int64_t step = std::max<int64_t>(numel / kTensorHashSamples, 1);
+  AT_DISPATCH_ALL_TYPES_AND_HALF(data.type(), "tensorHash", [&] {
+    const scalar_t* ptr = data.data<scalar_t>();
+    for (int64_t i = 0; i < numel; i += step) {
+      seed = hash_combine(seed, std::hash<double>()(static_cast<double>(ptr[i])));
+    }
+  });
+  return seed;
+}
+
+// Consistent with attributesEqualCSE: nodes with equal attributes hash equal.
+size_t attributesHash(const Node* k) {
+  if (!k->hasAttributes()) return 0;
+  auto names = k->attributeNames();
+  std::sort(names.begin(), names.end());
+  size_t seed = 0;
+  for (auto name : names) {
+    seed = hash_combine(seed, get_hash(name, k->kindOf(name)));
+
+    #define HASH_ATTRIBUTEVALUE(type) \
+      case AttributeKind::type: \
+        seed = hash_combine(seed, get_hash(k->type(name))); break;
+
+    switch(k->kindOf(name)) {
+      HASH_ATTRIBUTEVALUE(f)
+      HASH_ATTRIBUTEVALUE(fs)
+      HASH_ATTRIBUTEVALUE(i)
+      HASH_ATTRIBUTEVALUE(is)
+      HASH_ATTRIBUTEVALUE(s)
+      HASH_ATTRIBUTEVALUE(ss)
+      case AttributeKind::t:
+        seed = hash_combine(seed, tensorHash(k->t(name)));
+        break;
+      case AttributeKind::ts:
+        for (const auto& t : k->ts(name)) {
+          seed = hash_combine(seed, tensorHash(t));
+        }
+        break;
+      case AttributeKind::g:
+      case AttributeKind::gs:
+        // never equal in CSE
+        break;
+    }
+
+    #undef HASH_ATTRIBUTEVALUE
+  }
+  return seed;
+}
+
 } // anonymous namespace
 
 
@@ -81,7 +148,8 @@ size_t HashNode::operator()(const Node* k) const {
   JIT_ASSERT(k != nullptr);
   return get_hash(k->kind(),
                   fmap(k->outputs(), [](const Value *v) { return v->type()->kind(); }),
-                  fmap(k->inputs(), [](const Value *v) { return v->unique(); }));
+                  fmap(k->inputs(), [](const Value *v) { return v->unique(); }),
+                  attributesHash(k));
 };
 
 bool EqualNode::operator()(const Node* lhs, const Node* rhs) const {
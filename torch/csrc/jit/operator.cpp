@@ -5,6 +5,9 @@
 
 #include "torch/csrc/jit/script/error_report.h"
 
+#include <algorithm>
+#include <cctype>
+
 namespace torch { namespace jit {
 
 namespace script {
@@ -309,14 +312,26 @@ std::string canonicalSchemaString(const FunctionSchema& schema) {
   return out.str();
 }
 
+// The qualified name at the start of a schema, e.g. aten::add
+std::string schemaName(const std::string& schema) {
+  std::string name = schema.substr(0, schema.find('('));
+  name.erase(
+      std::remove_if(name.begin(), name.end(), [](char c) {
+        return std::isspace(static_cast<unsigned char>(c));
+      }),
+      name.end());
+  return name;
+}
+
 using OperatorMap = std::unordered_map<Symbol, std::vector<std::shared_ptr<Operator>>>;
 struct OperatorRegistry  {
 private:
   std::mutex lock;
   OperatorMap operators;
-  // list of operators whose schema have not yet been parsed, and must
-  // be registered before any call to lookup an opeator
-  std::vector<std::shared_ptr<Operator>> to_register;
+  // operators whose schema have not yet been parsed, by name. They are
+  // registered the first time an operator of their name is looked up, so
+  // that startup doesn't parse the thousands of schemas
+  OperatorMap to_register;
   // Those two maps are used to implement lookupByLiteral, which is needed for the n->match(...) calls.
   // Basically, every function schema is assigned a unique string you can use to match it. However,
   // parsing those strings or comparing and hashing them character by character would be very slow, so
@@ -329,26 +344,31 @@ private:
   std::unordered_map<const char *, std::shared_ptr<Operator>> operators_by_sig_literal;
 
   // XXX - caller must be holding lock
-  void registerPendingOperators() {
-    for(auto op : to_register) {
-      Symbol sym = Symbol::fromQualString(op->schema().name);
-      operators[sym].push_back(op);
+  void registerPendingOperators(Symbol name) {
+    auto it = to_register.find(name);
+    if (it == to_register.end()) {
+      return;
+    }
+    for(auto& op : it->second) {
+      operators[name].push_back(op);
       operators_by_sig[canonicalSchemaString(op->schema())] = op;
     }
-    to_register.clear();
+    to_register.erase(it);
   }
 
 public:
   void registerOperator(Operator&& op) {
+    auto op_ptr = std::make_shared<Operator>(std::move(op));
+    Symbol name = op_ptr->name();
     std::lock_guard<std::mutex> guard(lock);
-    to_register.push_back(std::make_shared<Operator>(std::move(op)));
+    to_register[name].push_back(std::move(op_ptr));
   }
 
   const std::shared_ptr<Operator>& lookupByLiteral(const char * name) {
     std::lock_guard<std::mutex> guard(lock);
-    registerPendingOperators();
     auto it = operators_by_sig_literal.find(name);
     if (it == operators_by_sig_literal.end()) {
+      registerPendingOperators(Symbol::fromQualString(schemaName(name)));
       auto op_ptr_it = operators_by_sig.find(name);
       // Handy debugging code that dumps all operators we know about on mismatch
 #if 0
@@ -367,7 +387,7 @@ public:
 
   const std::vector<std::shared_ptr<Operator>>& getOperators(Symbol name) {
     std::lock_guard<std::mutex> guard(lock);
-    registerPendingOperators();
+    registerPendingOperators(name);
     static std::vector<std::shared_ptr<Operator>> empty;
     auto it = operators.find(name);
     if(it != operators.end())
@@ -399,6 +419,13 @@ FunctionSchema parseSchema(const std::string& schema) {
   return script::SchemaParser(schema).parseDeclarations().at(0);
 }
 
+Symbol Operator::name() const {
+  if (schema_) {
+    return Symbol::fromQualString(schema_->name);
+  }
+  return Symbol::fromQualString(schemaName(schema_string_.value()));
+}
+
 bool Operator::matches(const Node* node) const {
   // wrong name
   if (node->kind().toQualString() != schema().name) {
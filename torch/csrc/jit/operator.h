@@ -50,6 +50,11 @@ struct TORCH_API Operator {
 
   bool matches(const Node* node) const;
 
+  // The qualified name of the operator. Unlike schema(), this doesn't parse
+  // a schema given as a string, so registries can defer parsing it until the
+  // operator is looked up.
+  Symbol name() const;
+
   Operation getOperation(Node* node = nullptr) const {
     if (op_) {
       return *op_;
@@ -0,0 +1,295 @@
+#include "torch/csrc/jit/passes/alias_analysis.h"
+
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/operator.h"
+
+namespace torch { namespace jit {
+
+namespace {
+
+bool mayContainTensors(const TypePtr& type) {
+  if (type->isSubtypeOf(DynamicType::get())) {
+    return true;
+  }
+  if (auto list = type->cast<ListType>()) {
+    return mayContainTensors(list->getElementType());
+  }
+  if (auto tuple = type->cast<TupleType>()) {
+    for (const TypePtr& element : tuple->elements()) {
+      if (mayContainTensors(element)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool mayContainTensors(const Value* v) {
+  return mayContainTensors(v->type());
+}
+
+// Ops that always return tensors with memory of their own. Anything that may
+// return one of its inputs (e.g. contiguous, or dropout in eval mode) or a
+// view of it must not be here.
+const OperatorSet& freshOutputOps() {
+  static const OperatorSet ops = {
+    "aten::add(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+    "aten::add(Tensor self, Scalar other, Scalar alpha) -> Tensor",
+    "aten::sub(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+    "aten::sub(Tensor self, Scalar other, Scalar alpha) -> Tensor",
+    "aten::mul(Tensor self, Tensor other) -> Tensor",
+    "aten::mul(Tensor self, Scalar other) -> Tensor",
+    "aten::div(Tensor self, Tensor other) -> Tensor",
+    "aten::div(Tensor self, Scalar other) -> Tensor",
+    "aten::pow(Tensor self, Tensor exponent) -> Tensor",
+    "aten::pow(Tensor self, Scalar exponent) -> Tensor",
+    "aten::neg(Tensor self) -> Tensor",
+    "aten::abs(Tensor self) -> Tensor",
+    "aten::reciprocal(Tensor self) -> Tensor",
+    "aten::exp(Tensor self) -> Tensor",
+    "aten::log(Tensor self) -> Tensor",
+    "aten::sqrt(Tensor self) -> Tensor",
+    "aten::rsqrt(Tensor self) -> Tensor",
+    "aten::sin(Tensor self) -> Tensor",
+    "aten::cos(Tensor self) -> Tensor",
+    "aten::floor(Tensor self) -> Tensor",
+    "aten::ceil(Tensor self) -> Tensor",
+    "aten::round(Tensor self) -> Tensor",
+    "aten::trunc(Tensor self) -> Tensor",
+    "aten::sign(Tensor self) -> Tensor",
+    "aten::relu(Tensor self) -> Tensor",
+    "aten::sigmoid(Tensor self) -> Tensor",
+    "aten::tanh(Tensor self) -> Tensor",
+    "aten::threshold(Tensor self, Scalar threshold, Scalar value) -> Tensor",
+    "aten::clamp(Tensor self, Scalar min, Scalar max) -> Tensor",
+    "aten::leaky_relu(Tensor self, Scalar negative_slope) -> Tensor",
+    "aten::hardtanh(Tensor self, Scalar min_val, Scalar max_val) -> Tensor",
+    "aten::elu(Tensor self, Scalar alpha, Scalar scale, Scalar input_scale) -> Tensor",
+    "aten::softmax(Tensor self, int dim) -> Tensor",
+    "aten::log_softmax(Tensor self, int dim) -> Tensor",
+    "aten::mm(Tensor self, Tensor mat2) -> Tensor",
+    "aten::bmm(Tensor self, Tensor mat2) -> Tensor",
+    "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor",
+    "aten::matmul(Tensor self, Tensor other) -> Tensor",
+    "aten::cat(Tensor[] tensors, int dim) -> Tensor",
+    "aten::clone(Tensor self) -> Tensor",
+    "aten::sum(Tensor self) -> Tensor",
+    "aten::sum(Tensor self, int[] dim, bool keepdim) -> Tensor",
+    "aten::mean(Tensor self) -> Tensor",
+    "aten::mean(Tensor self, int dim, bool keepdim) -> Tensor",
+    "aten::conv2d(Tensor input, Tensor weight, Tensor bias, int[] stride, int[] padding, int[] dilation, int groups) -> Tensor",
+    "aten::batch_norm(Tensor input, Tensor weight, Tensor bias, Tensor running_mean, Tensor running_var, bool training, float momentum, float eps, bool cudnn_enabled) -> Tensor",
+    "aten::max_pool2d(Tensor self, int[] kernel_size, int[] stride, int[] padding, int[] dilation, bool ceil_mode) -> Tensor",
+    "aten::avg_pool2d(Tensor self, int[] kernel_size, int[] stride, int[] padding, bool ceil_mode, bool count_include_pad) -> Tensor",
+    "aten::adaptive_avg_pool2d(Tensor self, int[] output_size) -> Tensor",
+  };
+  return ops;
+}
+
+bool hasFreshOutputs(Node* n) {
+  switch (n->kind()) {
+    // fusion kernels and the memory planner allocate their outputs
+    case prim::FusionGroup:
+    case prim::AllocateArena:
+      return true;
+    default:
+      return freshOutputOps().find(n) != nullptr;
+  }
+}
+
+// Our in-place ops are named like add_ and __iand__ (but not __and__).
+bool isInplace(Node* n) {
+  if (!n->kind().is_aten()) {
+    return false;
+  }
+  std::string name = n->kind().toUnqualString();
+  if (name.size() > 4 && name.compare(0, 2, "__") == 0 &&
+      name.compare(name.size() - 2, 2, "__") == 0) {
+    return name[2] == 'i';
+  }
+  return !name.empty() && name.back() == '_';
+}
+
+// Nodes rewritten by the memory planner write their result to their out
+// argument.
+bool hasOutArgument(Node* n) {
+  if (!n->kind().is_aten()) {
+    return false;
+  }
+  auto op = findOperatorFor(n);
+  if (!op) {
+    return false;
+  }
+  for (const Argument& arg : op->schema().arguments) {
+    if (arg.name == "out") {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // anonymous namespace
+
+AliasDb::AliasDb(const std::shared_ptr<Graph>& graph) {
+  for (Value* input : graph->inputs()) {
+    if (mayContainTensors(input)) {
+      parent[input] = input;
+      wildcards.push_back(input);
+    }
+  }
+  analyze(graph->block());
+
+  for (auto& entry : parent) {
+    Value* root = find(entry.first);
+    root_of[entry.first] = root;
+    sets[root].values.push_back(entry.first);
+  }
+  for (Value* v : wildcards) {
+    sets[find(v)].is_wildcard = true;
+  }
+  for (Value* v : written) {
+    sets[find(v)].has_writers = true;
+  }
+  parent.clear();
+  wildcards.clear();
+  written.clear();
+}
+
+void AliasDb::analyze(Block* block) {
+  for (Node* n : block->nodes()) {
+    analyze(n);
+  }
+}
+
+void AliasDb::analyze(Node* node) {
+  std::vector<Value*> inputs, outputs;
+  for (Value* input : node->inputs()) {
+    if (mayContainTensors(input)) {
+      inputs.push_back(input);
+    }
+  }
+  for (Value* output : node->outputs()) {
+    if (mayContainTensors(output)) {
+      parent[output] = output;
+      outputs.push_back(output);
+    }
+  }
+
+  for (Block* block : node->blocks()) {
+    for (Value* input : block->inputs()) {
+      if (mayContainTensors(input)) {
+        parent[input] = input;
+      }
+    }
+    analyze(block);
+    // Loop bodies take the carried values as inputs and return their next
+    // values, and both branches of an If return its outputs. Lumping all of
+    // them together with the node is coarse, but never wrong.
+    for (Value* v : block->inputs()) {
+      if (mayContainTensors(v)) {
+        outputs.push_back(v);
+      }
+    }
+    for (Value* v : block->outputs()) {
+      if (mayContainTensors(v)) {
+        outputs.push_back(v);
+      }
+    }
+  }
+
+  if (node->kind() == prim::Constant || node->kind() == prim::PythonOp) {
+    for (Value* v : inputs) {
+      wildcards.push_back(v);
+      written.push_back(v);
+    }
+    for (Value* v : outputs) {
+      wildcards.push_back(v);
+    }
+    return;
+  }
+
+  auto markWritten = [&](Value* v) {
+    if (mayContainTensors(v)) {
+      written.push_back(v);
+    }
+  };
+  if (isInplace(node) || node->kind() == aten::append) {
+    markWritten(node->inputs().at(0));
+  } else if (hasOutArgument(node)) {
+    markWritten(node->inputs().back());
+  } else if (!node->kind().is_aten() && !node->kind().is_prim()) {
+    // we know nothing about ops in other namespaces
+    for (Value* v : inputs) {
+      written.push_back(v);
+    }
+  }
+
+  if (node->blocks().empty() && hasFreshOutputs(node)) {
+    return;
+  }
+  Value* first = nullptr;
+  for (Value* v : inputs) {
+    if (first) {
+      unite(first, v);
+    } else {
+      first = v;
+    }
+  }
+  for (Value* v : outputs) {
+    if (first) {
+      unite(first, v);
+    } else {
+      first = v;
+    }
+  }
+}
+
+Value* AliasDb::find(Value* v) {
+  auto it = parent.find(v);
+  JIT_ASSERT(it != parent.end());
+  if (it->second == v) {
+    return v;
+  }
+  Value* root = find(it->second);
+  it->second = root;
+  return root;
+}
+
+void AliasDb::unite(Value* a, Value* b) {
+  a = find(a);
+  b = find(b);
+  if (a != b) {
+    parent[b] = a;
+  }
+}
+
+const AliasDb::AliasSet* AliasDb::setOf(const Value* v) const {
+  auto it = root_of.find(v);
+  if (it == root_of.end()) {
+    return nullptr;
+  }
+  return &sets.at(it->second);
+}
+
+bool AliasDb::mayAlias(const Value* a, const Value* b) const {
+  auto set_a = setOf(a);
+  return set_a && set_a == setOf(b);
+}
+
+bool AliasDb::isWildcard(const Value* v) const {
+  auto set = setOf(v);
+  return set && set->is_wildcard;
+}
+
+const std::vector<Value*>& AliasDb::getAliases(const Value* v) const {
+  static const std::vector<Value*> none;
+  auto set = setOf(v);
+  return set ? set->values : none;
+}
+
+bool AliasDb::hasWriters(const Value* v) const {
+  auto set = setOf(v);
+  return set && set->has_writers;
+}
+
+}}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace torch { namespace jit {
+
+// A conservative alias analysis of a graph, including its nested blocks.
+//
+// Every value that may hold tensors (tensors, and lists and tuples of them)
+// belongs to exactly one alias set, and values in different sets never share
+// memory. Ops that are known to return new tensors put their outputs in new
+// sets. Every other node is assumed to return views of its inputs, or to hold
+// on to them in its outputs, so all of its inputs and outputs end up in the
+// same set. The values of a block are in the same sets as the corresponding
+// inputs and outputs of the node that owns it.
+//
+// Memory outside of the graph may refer to the inputs of the graph, constants
+// (which live as long as the graph does) and anything passed to a PythonOp,
+// so their sets are marked as wildcards.
+struct TORCH_API AliasDb {
+  explicit AliasDb(const std::shared_ptr<Graph>& graph);
+
+  // whether a and b may share memory. Values that can't hold tensors don't
+  // alias anything.
+  bool mayAlias(const Value* a, const Value* b) const;
+
+  // whether memory outside of the graph may refer to v
+  bool isWildcard(const Value* v) const;
+
+  // all values that may share memory with v, including v itself if it may
+  // hold tensors
+  const std::vector<Value*>& getAliases(const Value* v) const;
+
+  // whether any node in the graph may write to memory that v may share
+  bool hasWriters(const Value* v) const;
+
+private:
+  struct AliasSet {
+    std::vector<Value*> values;
+    bool is_wildcard = false;
+    bool has_writers = false;
+  };
+
+  void analyze(Block* block);
+  void analyze(Node* node);
+  Value* find(Value* v);
+  void unite(Value* a, Value* b);
+  const AliasSet* setOf(const Value* v) const;
+
+  // union-find forest over the values that may hold tensors, only used while
+  // the graph is analyzed
+  std::unordered_map<Value*, Value*> parent;
+  std::vector<Value*> wildcards;
+  std::vector<Value*> written;
+
+  std::unordered_map<const Value*, Value*> root_of;
+  std::unordered_map<const Value*, AliasSet> sets; // keyed by root
+};
+
+}}
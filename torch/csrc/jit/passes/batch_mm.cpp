@@ -9,7 +9,10 @@
 
 #include <ATen/ATen.h>
 #include <algorithm>
+#include <map>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 namespace torch { namespace jit {
 
@@ -210,8 +213,368 @@ void BatchMMBlock(Block* block) {
   EliminateDeadCode(block);
 }
 
+// Note [Horizontal batching]
+// GEMMs that don't depend on each other but share an operand show up all over
+// the place, e.g. in the per-gate projections of RNN cells or the query, key
+// and value projections of attention. They can be done as a single, wider GEMM
+// by concatenating the other operands and splitting the result:
+//
+//   mm(X, W1), mm(X, W2)          ->  mm(X, cat([W1, W2], 1)).split(dim=1)
+//   mm(A1, W), mm(A2, W)          ->  mm(cat([A1, A2], 0), W).split(dim=0)
+//   linear(X, W1, b1), linear(X, W2, b2)
+//                                 ->  linear(X, cat([W1, W2]), cat([b1, b2])).split(dim=-1)
+//   addmm(b1, X, W1), addmm(b2, X, W2)
+//                                 ->  addmm(cat([b1, b2]), X, cat([W1, W2], 1)).split(dim=1)
+//
+// Independent GEMMs that share nothing, but have the same shapes, can still be
+// done by a single bmm over the stacked operands. On the CPU bmm is a loop of
+// GEMMs, so that only gets done for CUDA tensors, where it saves the launches.
+//
+// Either way, the concatenated operands are copied on every run. That only
+// pays off for GEMMs small enough for the launches and the reloading of the
+// shared operand to matter, and only if the copies are cheap compared to the
+// multiplications, which is what the parameters below check. All sizes need to
+// be known, so this only does anything after shape specialization.
+
+// Tunable parameters of Note [Horizontal batching].
+// GEMMs larger than this (in multiply-adds) keep the device busy on their own.
+static constexpr int64_t max_batched_gemm_size = 1 << 22;
+// This many multiply-adds have to be saved for every element copied.
+static constexpr int64_t min_flops_per_copied_element = 16;
+
+static CompleteTensorTypePtr completeType(Value* v, size_t dim) {
+  auto type = v->type()->cast<CompleteTensorType>();
+  return type && type->sizes().size() == dim ? type : nullptr;
+}
+
+static int64_t numel(const CompleteTensorTypePtr& type) {
+  int64_t n = 1;
+  for (int64_t s : type->sizes()) {
+    n *= s;
+  }
+  return n;
+}
+
+static bool isBatchableMM(Node* n) {
+  return n->matches("aten::mm(Tensor self, Tensor mat2) -> Tensor") &&
+         completeType(n->input(0), 2) && completeType(n->input(1), 2) &&
+         completeType(n->output(), 2);
+}
+
+static bool isBatchableLinear(Node* n) {
+  if (!n->matches("aten::linear(Tensor input, Tensor weight, Tensor bias) -> Tensor")) {
+    return false;
+  }
+  auto input = n->input(0)->type()->cast<CompleteTensorType>();
+  Value* bias = n->input(2);
+  return input && input->sizes().size() >= 1 && completeType(n->input(1), 2) &&
+         n->output()->type()->cast<CompleteTensorType>() &&
+         (bias->node()->kind() == prim::Undefined || completeType(bias, 1));
+}
+
+static bool isOne(Value* v) {
+  auto value = toIValue(v);
+  return value && ((value->isInt() && value->toInt() == 1) ||
+                   (value->isDouble() && value->toDouble() == 1));
+}
+
+// addmm with a bias per column, which is what linear turns into when traced
+static bool isBatchableAddmm(Node* n) {
+  if (!n->matches("aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor") ||
+      !isOne(n->namedInput(attr::beta)) || !isOne(n->namedInput(attr::alpha))) {
+    return false;
+  }
+  auto bias = completeType(n->input(0), 1);
+  auto weight = completeType(n->input(2), 2);
+  return bias && completeType(n->input(1), 2) && weight && completeType(n->output(), 2) &&
+         bias->sizes()[0] == weight->sizes()[1];
+}
+
+static bool hasBias(Node* linear) {
+  return linear->input(2)->node()->kind() != prim::Undefined;
+}
+
+// Multiply-adds of a GEMM node, and the number of elements batching it would
+// copy (its tensor operands other than shared).
+static std::pair<int64_t, int64_t> gemmCost(Node* n, Value* shared) {
+  Value* lhs = n->kind() == aten::addmm ? n->input(1) : n->input(0);
+  int64_t flops = numel(n->output()->type()->expect<CompleteTensorType>()) *
+                  lhs->type()->expect<CompleteTensorType>()->sizes().back();
+  int64_t copied = 0;
+  for (Value* operand : n->inputs()) {
+    auto type = operand->type()->cast<CompleteTensorType>();
+    if (operand != shared && type) {
+      copied += numel(type);
+    }
+  }
+  return {flops, copied};
+}
+
+static bool isProfitable(ArrayRef<Node*> group, Value* shared) {
+  if (group.size() < min_fusion_size) {
+    return false;
+  }
+  int64_t total_flops = 0, total_copied = 0;
+  for (Node* n : group) {
+    auto cost = gemmCost(n, shared);
+    if (cost.first > max_batched_gemm_size) {
+      return false;
+    }
+    total_flops += cost.first;
+    total_copied += cost.second;
+  }
+  return total_copied * min_flops_per_copied_element <= total_flops;
+}
+
+// Greedily picks the candidates (given in topological order) whose inputs are
+// all computed before the first of them. None of those can depend on another,
+// and their batched version can be inserted in front of the first one.
+static std::vector<Node*> independentNodes(
+    ArrayRef<Node*> candidates,
+    const std::unordered_map<Node*, size_t>& position) {
+  std::vector<Node*> group;
+  for (Node* n : candidates) {
+    size_t first = group.empty() ? position.at(n) : position.at(group[0]);
+    bool ready = std::all_of(n->inputs().begin(), n->inputs().end(), [&](Value* v) {
+      auto it = position.find(v->node());
+      // values from enclosing blocks are always ready
+      return it == position.end() || it->second < first;
+    });
+    if (ready) {
+      group.push_back(n);
+    }
+  }
+  return group;
+}
+
+static Value* catValues(ArrayRef<Value*> values, int dim) {
+  auto type = values[0]->type()->expect<CompleteTensorType>();
+  auto sizes = type->sizes();
+  sizes[dim] = 0;
+  for (Value* v : values) {
+    sizes[dim] += v->type()->expect<CompleteTensorType>()->sizes()[dim];
+  }
+  auto inputs = fmap<SymbolicVariable>(values);
+  Value* result = SymbolicVariable::cat(inputs, dim).value();
+  result->setType(type->withSizes(sizes));
+  return result;
+}
+
+// Replaces outputs by consecutive slices of value along dim.
+static void replaceWithSlices(Value* value, int dim, ArrayRef<Value*> outputs) {
+  auto type = value->type()->expect<CompleteTensorType>();
+  std::vector<int64_t> sizes = fmap(outputs, [&](Value* v) {
+    return v->type()->expect<CompleteTensorType>()->sizes()[dim];
+  });
+  std::vector<SymbolicVariable> slices;
+  if (std::all_of(sizes.begin(), sizes.end(), [&](int64_t s) { return s == sizes[0]; })) {
+    // the graph fuser knows how to fuse these
+    slices = SymbolicVariable(value).chunk(sizes.size(), dim);
+  } else {
+    int64_t start = 0;
+    for (int64_t size : sizes) {
+      slices.push_back(SymbolicVariable(value).narrow(dim, start, size));
+      start += size;
+    }
+  }
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    auto slice_sizes = type->sizes();
+    slice_sizes[dim] = sizes[i];
+    slices[i].value()->setType(type->withSizesStrides(slice_sizes, type->strides()));
+    outputs[i]->replaceAllUsesWith(slices[i]);
+  }
+}
+
+static std::vector<Value*> outputsOf(ArrayRef<Node*> nodes) {
+  return fmap(nodes, [](Node* n) { return n->output(); });
+}
+
+static std::vector<Value*> inputsOf(ArrayRef<Node*> nodes, size_t i) {
+  return fmap(nodes, [=](Node* n) { return n->input(i); });
+}
+
+static void batchSharedMM(ArrayRef<Node*> group, size_t shared_input) {
+  Graph* graph = group[0]->owningGraph();
+  WithInsertPoint guard(group[0]);
+  // the lhs operands are stacked vertically, the rhs ones horizontally
+  int dim = shared_input == 0 ? 1 : 0;
+  Value* batched = catValues(inputsOf(group, 1 - shared_input), dim);
+  Value* shared = group[0]->input(shared_input);
+  std::vector<Value*> inputs = {shared, batched};
+  if (shared_input == 1) {
+    std::swap(inputs[0], inputs[1]);
+  }
+  Node* mm = graph->insertNode(graph->create(aten::mm, inputs));
+  auto type = group[0]->output()->type()->expect<CompleteTensorType>();
+  auto sizes = type->sizes();
+  sizes[dim] = batched->type()->expect<CompleteTensorType>()->sizes()[dim];
+  mm->output()->setType(type->withSizes(sizes));
+  replaceWithSlices(mm->output(), dim, outputsOf(group));
+}
+
+static void batchSharedLinear(ArrayRef<Node*> group) {
+  Graph* graph = group[0]->owningGraph();
+  WithInsertPoint guard(group[0]);
+  Value* weight = catValues(inputsOf(group, 1), 0);
+  Value* bias = group[0]->input(2);
+  if (hasBias(group[0])) {
+    bias = catValues(inputsOf(group, 2), 0);
+  }
+  Node* linear = graph->insertNode(graph->create(aten::linear, {group[0]->input(0), weight, bias}));
+  auto type = group[0]->output()->type()->expect<CompleteTensorType>();
+  auto sizes = type->sizes();
+  sizes.back() = weight->type()->expect<CompleteTensorType>()->sizes()[0];
+  linear->output()->setType(type->withSizes(sizes));
+  replaceWithSlices(linear->output(), sizes.size() - 1, outputsOf(group));
+}
+
+static void batchSharedAddmm(ArrayRef<Node*> group) {
+  Graph* graph = group[0]->owningGraph();
+  WithInsertPoint guard(group[0]);
+  Value* bias = catValues(inputsOf(group, 0), 0);
+  Value* weight = catValues(inputsOf(group, 2), 1);
+  Node* addmm = graph->insertNode(graph->create(aten::addmm,
+      {bias, group[0]->input(1), weight, group[0]->input(3), group[0]->input(4)}));
+  auto type = group[0]->output()->type()->expect<CompleteTensorType>();
+  addmm->output()->setType(type->withSizes({type->sizes()[0], weight->type()->expect<CompleteTensorType>()->sizes()[1]}));
+  replaceWithSlices(addmm->output(), 1, outputsOf(group));
+}
+
+static void batchIndependentMM(ArrayRef<Node*> group) {
+  Graph* graph = group[0]->owningGraph();
+  WithInsertPoint guard(group[0]);
+  auto stack = [&](size_t i) {
+    auto type = group[0]->input(i)->type()->expect<CompleteTensorType>();
+    auto sizes = type->sizes();
+    sizes.insert(sizes.begin(), group.size());
+    Value* stacked = SymbolicVariable::stack(fmap<SymbolicVariable>(inputsOf(group, i)), 0).value();
+    stacked->setType(type->withSizes(sizes));
+    return stacked;
+  };
+  Value* lhs = stack(0);
+  Value* rhs = stack(1);
+  Node* bmm = graph->insertNode(graph->create(aten::bmm, {lhs, rhs}));
+  auto type = group[0]->output()->type()->expect<CompleteTensorType>();
+  auto sizes = type->sizes();
+  sizes.insert(sizes.begin(), group.size());
+  bmm->output()->setType(type->withSizes(sizes));
+  for (size_t i = 0; i < group.size(); ++i) {
+    Value* result = graph->insert(aten::select, {bmm->output(), 0, static_cast<int64_t>(i)});
+    result->setType(type->withSizes(type->sizes()));
+    group[i]->output()->replaceAllUsesWith(result);
+  }
+}
+
+void BatchMMSideBlock(Block* block) {
+  std::unordered_map<Node*, size_t> position;
+  for (Node* node : block->nodes()) {
+    for (Block* sub : node->blocks()) {
+      BatchMMSideBlock(sub);
+    }
+    position.emplace(node, position.size());
+  }
+
+  // Groups are collected first and rewritten after. Batching a group replaces
+  // the outputs of its GEMMs with values computed earlier, so the groups found
+  // later stay valid.
+  std::unordered_set<Node*> batched;
+  std::vector<std::pair<std::vector<Node*>, size_t>> shared_mm_groups;
+  std::vector<std::vector<Node*>> shared_linear_groups;
+  std::vector<std::vector<Node*>> shared_addmm_groups;
+  std::unordered_set<Value*> visited;
+  auto usersOf = [&](Value* v, size_t offset, bool(*accept)(Node*)) {
+    std::vector<Node*> users;
+    for (const Use& use : v->uses()) {
+      if (use.offset == offset && position.count(use.user) > 0 &&
+          batched.count(use.user) == 0 && accept(use.user)) {
+        users.push_back(use.user);
+      }
+    }
+    std::sort(users.begin(), users.end(), [&](Node* a, Node* b) {
+      return position[a] < position[b];
+    });
+    return independentNodes(users, position);
+  };
+  auto record = [&](std::vector<Node*> group, Value* shared) {
+    if (!isProfitable(group, shared)) {
+      return false;
+    }
+    batched.insert(group.begin(), group.end());
+    return true;
+  };
+  for (Node* node : block->nodes()) {
+    for (Value* v : node->inputs()) {
+      if (!visited.insert(v).second) {
+        continue;
+      }
+      for (size_t shared_input : {0, 1}) {
+        auto group = usersOf(v, shared_input, isBatchableMM);
+        if (record(group, v)) {
+          shared_mm_groups.emplace_back(std::move(group), shared_input);
+        }
+      }
+      auto linear_group = usersOf(v, 0, isBatchableLinear);
+      // biases are concatenated, so either all or none of them have one
+      bool with_bias = !linear_group.empty() && hasBias(linear_group[0]);
+      linear_group.erase(
+          std::remove_if(linear_group.begin(), linear_group.end(), [&](Node* n) {
+            return hasBias(n) != with_bias;
+          }),
+          linear_group.end());
+      if (record(linear_group, v)) {
+        shared_linear_groups.push_back(std::move(linear_group));
+      }
+      auto addmm_group = usersOf(v, 1, isBatchableAddmm);
+      if (record(addmm_group, v)) {
+        shared_addmm_groups.push_back(std::move(addmm_group));
+      }
+    }
+  }
+
+  // Whatever is left of same-shape CUDA GEMMs is batched with bmm.
+  std::map<std::vector<int64_t>, std::vector<Node*>> same_shape_mms;
+  for (Node* node : block->nodes()) {
+    if (batched.count(node) > 0 || !isBatchableMM(node)) {
+      continue;
+    }
+    auto lhs = node->input(0)->type()->expect<CompleteTensorType>();
+    auto rhs = node->input(1)->type()->expect<CompleteTensorType>();
+    if (lhs->device() < 0 || rhs->device() != lhs->device() ||
+        rhs->scalarType() != lhs->scalarType()) {
+      continue;
+    }
+    std::vector<int64_t> key = {lhs->device(), static_cast<int64_t>(lhs->scalarType())};
+    key.insert(key.end(), lhs->sizes().begin(), lhs->sizes().end());
+    key.insert(key.end(), rhs->sizes().begin(), rhs->sizes().end());
+    same_shape_mms[key].push_back(node);
+  }
+  std::vector<std::vector<Node*>> independent_mm_groups;
+  for (auto& item : same_shape_mms) {
+    auto group = independentNodes(item.second, position);
+    if (record(group, nullptr)) {
+      independent_mm_groups.push_back(std::move(group));
+    }
+  }
+
+  for (auto& group : shared_mm_groups) {
+    batchSharedMM(group.first, group.second);
+  }
+  for (auto& group : shared_linear_groups) {
+    batchSharedLinear(group);
+  }
+  for (auto& group : shared_addmm_groups) {
+    batchSharedAddmm(group);
+  }
+  for (auto& group : independent_mm_groups) {
+    batchIndependentMM(group);
+  }
+}
+
 void BatchMM(std::shared_ptr<Graph>& graph) {
   BatchMMBlock(graph->block());
+  BatchMMSideBlock(graph->block());
+  // NB: like above, the batched GEMMs are left for DCE
+  EliminateDeadCode(graph);
 }
 
 }}
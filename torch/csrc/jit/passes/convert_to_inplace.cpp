@@ -0,0 +1,159 @@
+#include "torch/csrc/jit/passes/convert_to_inplace.h"
+
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/operator.h"
+#include "torch/csrc/jit/passes/alias_analysis.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace torch { namespace jit {
+
+namespace {
+
+// Ops whose in-place variant is named like them with a trailing underscore,
+// takes the same arguments, and returns self.
+const OperatorSet& opsWithInplaceVariant() {
+  static const OperatorSet ops = {
+    "aten::add(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+    "aten::add(Tensor self, Scalar other, Scalar alpha) -> Tensor",
+    "aten::sub(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+    "aten::sub(Tensor self, Scalar other, Scalar alpha) -> Tensor",
+    "aten::mul(Tensor self, Tensor other) -> Tensor",
+    "aten::mul(Tensor self, Scalar other) -> Tensor",
+    "aten::div(Tensor self, Tensor other) -> Tensor",
+    "aten::div(Tensor self, Scalar other) -> Tensor",
+    "aten::pow(Tensor self, Tensor exponent) -> Tensor",
+    "aten::pow(Tensor self, Scalar exponent) -> Tensor",
+    "aten::neg(Tensor self) -> Tensor",
+    "aten::abs(Tensor self) -> Tensor",
+    "aten::reciprocal(Tensor self) -> Tensor",
+    "aten::exp(Tensor self) -> Tensor",
+    "aten::log(Tensor self) -> Tensor",
+    "aten::sqrt(Tensor self) -> Tensor",
+    "aten::rsqrt(Tensor self) -> Tensor",
+    "aten::sin(Tensor self) -> Tensor",
+    "aten::cos(Tensor self) -> Tensor",
+    "aten::floor(Tensor self) -> Tensor",
+    "aten::ceil(Tensor self) -> Tensor",
+    "aten::round(Tensor self) -> Tensor",
+    "aten::trunc(Tensor self) -> Tensor",
+    "aten::relu(Tensor self) -> Tensor",
+    "aten::sigmoid(Tensor self) -> Tensor",
+    "aten::tanh(Tensor self) -> Tensor",
+    "aten::threshold(Tensor self, Scalar threshold, Scalar value) -> Tensor",
+    "aten::clamp(Tensor self, Scalar min, Scalar max) -> Tensor",
+  };
+  return ops;
+}
+
+struct InplaceConverter {
+  InplaceConverter(std::shared_ptr<Graph> graph)
+  : graph(std::move(graph))
+  , aliases(this->graph) {
+    numberNodes(this->graph->block());
+  }
+
+  void run() {
+    // Decide on all the nodes first, while every value is still known to
+    // aliases. Rewriting a node makes its result share memory with self, whose
+    // aliases are dead by then, so that doesn't change any later decision.
+    std::vector<Node*> to_convert;
+    collect(graph->block(), to_convert);
+    for (Node* n : to_convert) {
+      convert(n);
+    }
+  }
+
+private:
+  void numberNodes(Block* block) {
+    size_t i = 0;
+    for (Node* n : block->nodes()) {
+      position[n] = i++;
+      for (Block* b : n->blocks()) {
+        numberNodes(b);
+      }
+    }
+  }
+
+  void collect(Block* block, std::vector<Node*>& to_convert) {
+    for (Node* n : block->nodes()) {
+      for (Block* b : n->blocks()) {
+        collect(b, to_convert);
+      }
+      if (canConvert(n)) {
+        to_convert.push_back(n);
+      }
+    }
+  }
+
+  bool canConvert(Node* n) {
+    if (!opsWithInplaceVariant().find(n)) {
+      return false;
+    }
+    Value* self = n->input(0);
+    auto self_type = self->type()->cast<CompleteTensorType>();
+    auto result_type = n->output()->type()->cast<CompleteTensorType>();
+    if (!self_type || !result_type || *self_type != *result_type ||
+        self_type->strides() != CompleteTensorType::contiguousStridesOf(self_type->sizes())) {
+      return false;
+    }
+    if (aliases.isWildcard(self)) {
+      return false;
+    }
+    for (size_t i = 1; i < n->inputs().size(); ++i) {
+      if (aliases.mayAlias(self, n->input(i))) {
+        return false;
+      }
+    }
+    for (Value* alias : aliases.getAliases(self)) {
+      for (const Use& use : alias->uses()) {
+        if (use.user != n && !usedBefore(use.user, n)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // whether user runs before n, and only then. Uses inside a nested block of an
+  // earlier node count, uses in the block n belongs to (or in enclosing ones)
+  // after n don't, and neither do uses by a block's return, which may feed the
+  // next iteration of a loop.
+  bool usedBefore(Node* user, Node* n) {
+    Block* block = n->owningBlock();
+    while (user->owningBlock() != block) {
+      Node* owner = user->owningBlock()->owningNode();
+      if (!owner) {
+        return false;
+      }
+      user = owner;
+    }
+    auto it = position.find(user);
+    return it != position.end() && it->second < position.at(n);
+  }
+
+  void convert(Node* n) {
+    WithInsertPoint guard(n);
+    Symbol inplace_kind = Symbol::fromQualString(n->kind().toQualString() + std::string("_"));
+    Node* inplace = graph->insertNode(graph->create(inplace_kind, n->inputs()));
+    inplace->setScope(n->scope());
+    inplace->setSourceLocation(n->getSourceLocation());
+    inplace->output()->copyMetadata(n->output());
+    n->output()->replaceAllUsesWith(inplace->output());
+    n->destroy();
+  }
+
+  std::shared_ptr<Graph> graph;
+  AliasDb aliases;
+  // position of each node in its block
+  std::unordered_map<Node*, size_t> position;
+};
+
+} // anonymous namespace
+
+void ConvertToInplaceOps(std::shared_ptr<Graph>& graph) {
+  InplaceConverter(graph).run();
+}
+
+}}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Rewrites elementwise ops like add, relu and sigmoid into their in-place
+// variants when nothing reads their self input (or anything that may alias
+// it, see AliasDb) afterwards, so that the result reuses its memory instead of
+// allocating a new tensor. self must have a complete, contiguous type with the
+// same sizes and scalar type as the result, and must not alias memory from
+// outside the graph.
+//
+// Autograd may need the inputs of the rewritten ops, so only run this on
+// graphs that will not be differentiated.
+TORCH_API void ConvertToInplaceOps(std::shared_ptr<Graph>& graph);
+
+}}
@@ -0,0 +1,229 @@
+#include "torch/csrc/jit/passes/freeze.h"
+
+#include "torch/csrc/autograd/grad_mode.h"
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/constants.h"
+#include "torch/csrc/jit/passes/constant_pooling.h"
+#include "torch/csrc/jit/passes/constant_propagation.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+
+#include <ATen/ATen.h>
+
+#include <vector>
+
+namespace torch { namespace jit {
+
+namespace {
+
+// Returns the value of an optional tensor argument if it is known: the tensor
+// of a constant, or an undefined tensor.
+c10::optional<at::Tensor> optionalConstantTensor(Value* v) {
+  if (v->node()->kind() == prim::Undefined) {
+    return at::Tensor();
+  }
+  if (auto ivalue = toIValue(v)) {
+    if (ivalue->isTensor()) {
+      return ivalue->toTensor();
+    }
+  }
+  return c10::nullopt;
+}
+
+c10::optional<at::Tensor> definedConstantTensor(Value* v) {
+  auto tensor = optionalConstantTensor(v);
+  if (!tensor || !tensor->defined()) {
+    return c10::nullopt;
+  }
+  return tensor;
+}
+
+// Layers batch_norm can be folded into: their weight has one row per output
+// channel, and they add a bias per channel.
+bool isFoldableLayer(Node* node) {
+  if (node->matches("aten::conv1d(Tensor input, Tensor weight, Tensor bias, int[] stride, int[] padding, int[] dilation, int groups) -> Tensor") ||
+      node->matches("aten::conv2d(Tensor input, Tensor weight, Tensor bias, int[] stride, int[] padding, int[] dilation, int groups) -> Tensor") ||
+      node->matches("aten::conv3d(Tensor input, Tensor weight, Tensor bias, int[] stride, int[] padding, int[] dilation, int groups) -> Tensor")) {
+    return true;
+  }
+  if (node->matches(
+          "aten::_convolution(Tensor input, Tensor weight, Tensor bias, int[] stride, int[] padding, int[] dilation, bool transposed, int[] output_padding, int groups, bool benchmark, bool deterministic, bool cudnn_enabled) -> Tensor",
+          /*const_inputs=*/attr::transposed)) {
+    // transposed convolutions have their output channels in dim 1 of weight
+    return !node->get<bool>(attr::transposed).value();
+  }
+  if (node->matches("aten::linear(Tensor input, Tensor weight, Tensor bias) -> Tensor")) {
+    // batch_norm normalizes dim 1, which is only the feature dim of linear for
+    // 2D inputs
+    auto type = node->output()->type()->cast<TensorType>();
+    return type && type->dim() == 2;
+  }
+  return false;
+}
+
+void FoldBatchNorm(Block* block) {
+  for (auto it = block->nodes().begin(), end = block->nodes().end(); it != end; ++it) {
+    for (auto sub : it->blocks()) {
+      FoldBatchNorm(sub);
+    }
+    Node* bn = *it;
+    if (!bn->matches(
+            "aten::batch_norm(Tensor input, Tensor weight, Tensor bias, Tensor running_mean, Tensor running_var, bool training, float momentum, float eps, bool cudnn_enabled) -> Tensor",
+            /*const_inputs=*/{attr::training, attr::eps}) ||
+        bn->get<bool>(attr::training).value()) {
+      continue;
+    }
+    Node* layer = bn->input(0)->node();
+    if (!isFoldableLayer(layer) || layer->output()->uses().size() != 1) {
+      continue;
+    }
+    auto gamma = optionalConstantTensor(bn->namedInput(attr::weight));
+    auto beta = optionalConstantTensor(bn->namedInput(attr::bias));
+    auto mean = definedConstantTensor(bn->namedInput(attr::running_mean));
+    auto var = definedConstantTensor(bn->namedInput(attr::running_var));
+    auto weight = definedConstantTensor(layer->namedInput(attr::weight));
+    auto bias = optionalConstantTensor(layer->namedInput(attr::bias));
+    if (!gamma || !beta || !mean || !var || !weight || !bias ||
+        &mean->type() != &weight->type()) {
+      continue;
+    }
+    double eps = bn->get<double>(attr::eps).value();
+
+    at::Tensor folded_weight, folded_bias;
+    {
+      autograd::AutoGradMode no_grad(false);
+      auto scale = at::rsqrt(*var + eps);
+      if (gamma->defined()) {
+        scale = scale * *gamma;
+      }
+      std::vector<int64_t> scale_shape(weight->dim(), 1);
+      scale_shape[0] = -1;
+      folded_weight = *weight * scale.reshape(scale_shape);
+      folded_bias = ((bias->defined() ? *bias : at::zeros_like(*mean)) - *mean) * scale;
+      if (beta->defined()) {
+        folded_bias = folded_bias + *beta;
+      }
+    }
+
+    Graph* graph = layer->owningGraph();
+    WithInsertPoint guard(layer);
+    layer->replaceInputWith(layer->namedInput(attr::weight), graph->insertConstant(folded_weight));
+    layer->replaceInputWith(layer->namedInput(attr::bias), graph->insertConstant(folded_bias));
+    bn->output()->replaceAllUsesWith(layer->output());
+  }
+}
+
+void PretransposeLinearWeights(Block* block) {
+  for (auto it = block->nodes().begin(), end = block->nodes().end(); it != end; ++it) {
+    for (auto sub : it->blocks()) {
+      PretransposeLinearWeights(sub);
+    }
+    Node* node = *it;
+    if (!node->matches("aten::linear(Tensor input, Tensor weight, Tensor bias) -> Tensor")) {
+      continue;
+    }
+    auto weight = definedConstantTensor(node->namedInput(attr::weight));
+    auto bias = optionalConstantTensor(node->namedInput(attr::bias));
+    if (!weight || weight->dim() != 2) {
+      continue;
+    }
+    Value* input = node->namedInput(attr::input);
+    at::Tensor transposed;
+    {
+      autograd::AutoGradMode no_grad(false);
+      transposed = weight->t().contiguous();
+    }
+
+    // This is how linear itself is implemented.
+    Graph* graph = node->owningGraph();
+    WithInsertPoint guard(node);
+    Value* weight_t = graph->insertConstant(transposed);
+    Value* result;
+    auto input_type = input->type()->cast<TensorType>();
+    bool has_bias = !bias || bias->defined();
+    if (has_bias && input_type && input_type->dim() == 2) {
+      result = graph->insert(aten::addmm, {node->namedInput(attr::bias), input, weight_t});
+    } else {
+      result = graph->insert(aten::matmul, {input, weight_t});
+      if (has_bias) {
+        result = graph->insert(aten::add, {result, node->namedInput(attr::bias)});
+      }
+    }
+    result->setType(node->output()->type());
+    node->output()->replaceAllUsesWith(result);
+  }
+}
+
+void FoldShapeQueries(Block* block) {
+  for (auto it = block->nodes().begin(), end = block->nodes().end(); it != end; ++it) {
+    for (auto sub : it->blocks()) {
+      FoldShapeQueries(sub);
+    }
+    Node* node = *it;
+    c10::optional<int64_t> value;
+    if (node->matches("aten::dim(Tensor self) -> int")) {
+      if (auto type = node->input()->type()->cast<TensorType>()) {
+        value = type->dim();
+      }
+    } else if (node->matches("aten::size(Tensor self, int dim) -> int", /*const_inputs=*/attr::dim)) {
+      if (auto type = node->input(0)->type()->cast<CompleteTensorType>()) {
+        int64_t dim = node->get<int64_t>(attr::dim).value();
+        int64_t ndim = type->sizes().size();
+        if (dim < 0) {
+          dim += ndim;
+        }
+        if (dim >= 0 && dim < ndim) {
+          value = type->sizes()[dim];
+        }
+      }
+    }
+    if (value) {
+      WithInsertPoint guard(node);
+      node->output()->replaceAllUsesWith(node->owningGraph()->insertConstant(*value));
+    }
+  }
+}
+
+} // anonymous namespace
+
+void FreezeParameters(
+    const std::shared_ptr<Graph>& graph,
+    at::ArrayRef<at::Tensor> params) {
+  JIT_ASSERT(graph->inputs().size() >= params.size());
+  size_t first_param = graph->inputs().size() - params.size();
+  WithInsertPoint guard(graph->block()->param_node()->next());
+  for (size_t i = 0; i < params.size(); ++i) {
+    graph->inputs()[first_param + i]->replaceAllUsesWith(graph->insertConstant(params[i]));
+  }
+  for (size_t i = graph->inputs().size(); i > first_param; --i) {
+    graph->eraseInput(i - 1);
+  }
+}
+
+void FoldBatchNorm(const std::shared_ptr<Graph>& graph) {
+  FoldBatchNorm(graph->block());
+  EliminateDeadCode(graph);
+}
+
+void PretransposeLinearWeights(const std::shared_ptr<Graph>& graph) {
+  PretransposeLinearWeights(graph->block());
+  EliminateDeadCode(graph);
+}
+
+void FoldShapeQueries(const std::shared_ptr<Graph>& graph) {
+  FoldShapeQueries(graph->block());
+  EliminateDeadCode(graph);
+}
+
+void OptimizeFrozenGraph(const std::shared_ptr<Graph>& graph) {
+  auto g = graph;
+  // Folds aten::t and friends applied to parameters first, which exposes
+  // more of the patterns below.
+  ConstantPropagation(g);
+  FoldBatchNorm(graph);
+  PretransposeLinearWeights(graph);
+  FoldShapeQueries(graph);
+  ConstantPropagation(g);
+  ConstantPooling(graph);
+}
+
+}}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Optimizations for graphs that are only ever used for inference, with the
+// parameters of the model fixed.
+
+// Replaces the last params.size() inputs of graph, which is where script
+// Methods take their members, with constants holding params and removes them
+// from the graph. The constants share memory with params.
+TORCH_API void FreezeParameters(
+    const std::shared_ptr<Graph>& graph,
+    at::ArrayRef<at::Tensor> params);
+
+// Folds aten::batch_norm in eval mode into the convolution or linear layer
+// that produces its input, when the parameters of both are constants.
+TORCH_API void FoldBatchNorm(const std::shared_ptr<Graph>& graph);
+
+// Replaces aten::linear with a constant weight by a product with a
+// contiguous copy of the transposed weight.
+TORCH_API void PretransposeLinearWeights(const std::shared_ptr<Graph>& graph);
+
+// Replaces aten::dim of tensors of known rank and aten::size of tensors of
+// known sizes with constants.
+TORCH_API void FoldShapeQueries(const std::shared_ptr<Graph>& graph);
+
+// Runs all of the above (but FreezeParameters) along with constant
+// propagation, which can now see the parameters, and pooling.
+TORCH_API void OptimizeFrozenGraph(const std::shared_ptr<Graph>& graph);
+
+}}
@@ -5,6 +5,7 @@
 #include "torch/csrc/jit/autodiff.h"
 #include "torch/csrc/jit/assertions.h"
 #include "ATen/ExpandUtils.h"
+#include <algorithm>
 #include <unordered_map>
 
 #ifdef USE_CUDA
@@ -90,6 +91,28 @@ bool isSimpleMap(Node *node) {
   return true;
 }
 
+// Reductions the fusion compiler can generate code for. They can only be exit
+// nodes of a fusion group, and have to reduce over the innermost dims.
+// Keep in sync with ReductionDesc in fusers/common/reduction_desc.h.
+bool isReduction(Node *node) {
+  return node->matches("aten::sum(Tensor self, int[] dim, bool keepdim) -> Tensor") ||
+         node->matches("aten::mean(Tensor self, int dim, bool keepdim) -> Tensor") ||
+         node->matches("aten::var(Tensor self, int dim, bool unbiased, bool keepdim) -> Tensor") ||
+         node->matches("aten::std(Tensor self, int dim, bool unbiased, bool keepdim) -> Tensor");
+}
+
+// Returns the dims a reduction reduces over, if they are constant
+c10::optional<std::vector<int64_t>> reductionDims(Node *node) {
+  if (!isReduction(node) || !node->is_constant(attr::dim) ||
+      !node->is_constant(attr::keepdim) ||
+      ((node->kind() == aten::var || node->kind() == aten::std) &&
+       !node->is_constant(attr::unbiased)))
+    return c10::nullopt;
+  if (node->kind() == aten::sum)
+    return node->get<std::vector<int64_t>>(attr::dim).value();
+  return std::vector<int64_t>{node->get<int64_t>(attr::dim).value()};
+}
+
 enum class DeviceType { Unknown, AnyDevice, CPU, CUDA };
 
 struct Device {
@@ -242,6 +265,101 @@ struct GraphFuser {
     }
   }
 
+  // Checks if the node is a reduction that can terminate a FusionGroup. It has
+  // to have constant arguments and compatible types, and reduce over the
+  // innermost dims of its input, so that each reduced element is a contiguous
+  // run of elements of the map.
+  bool isFusableReduction(Node * node) {
+    if (node->owningBlock() != block) return false;
+    auto dims = reductionDims(node);
+    if (!dims || dims->empty()) return false;
+    if (!hasSupportedType(node->input(0)) || !haveSupportedType(node->outputs())) return false;
+    int64_t ndim = node->input(0)->type()->expect<TensorType>()->dim();
+    std::vector<bool> reduced(ndim, false);
+    for (int64_t d : *dims) {
+      if (d < 0) d += ndim;
+      if (d < 0 || d >= ndim || reduced[d]) return false;
+      reduced[d] = true;
+    }
+    return std::all_of(reduced.end() - dims->size(), reduced.end(), [](bool r) { return r; });
+  }
+
+  // Number of innermost dims the reductions in a FusionGroup (or a fusable
+  // reduction itself) reduce over, if there are any.
+  c10::optional<size_t> reducedDims(Node * node) {
+    if (node->kind() == prim::FusionGroup) {
+      for (Value * output : getSubgraph(node).outputs()) {
+        if (isReduction(output->node()))
+          return reductionDims(output->node())->size();
+      }
+      return c10::nullopt;
+    }
+    if (isFusableReduction(node))
+      return reductionDims(node)->size();
+    return c10::nullopt;
+  }
+
+  bool usesRandom(Node * node) {
+    if (node->kind() == prim::FusionGroup) {
+      auto nodes = getSubgraph(node).nodes();
+      return std::any_of(nodes.begin(), nodes.end(), [](Node * n) {
+        return n->kind() == aten::rand_like;
+      });
+    }
+    return node->kind() == aten::rand_like;
+  }
+
+  // All reductions of a FusionGroup share the kernel's loop over the innermost
+  // dims, so they have to reduce over the same number of them. Random number
+  // generation needs a thread per element, which kernels with reductions don't
+  // have.
+  bool compatibleReductions(Node * consumer, Node * producer) {
+    auto consumer_dims = reducedDims(consumer);
+    auto producer_dims = reducedDims(producer);
+    if (consumer_dims && producer_dims && *consumer_dims != *producer_dims)
+      return false;
+    if ((consumer_dims || producer_dims) && (usesRandom(consumer) || usesRandom(producer)))
+      return false;
+    return true;
+  }
+
+  // Merging producer into consumer would leave reductions of producer
+  // whose outputs consumer reads inside the group, no longer as exit nodes.
+  bool readsReductionOf(Node * consumer, Node * producer) {
+    if (producer->kind() != prim::FusionGroup) return false;
+    auto subgraph_outputs = getSubgraph(producer).outputs();
+    for (size_t i = 0; i < subgraph_outputs.size(); ++i) {
+      if (!isReduction(subgraph_outputs[i]->node())) continue;
+      for (auto u : producer->outputs()[i]->uses()) {
+        if (u.user == consumer) return true;
+      }
+    }
+    return false;
+  }
+
+  // An aten::expand of a FusionGroup input to a constant size doesn't have to be
+  // materialized: the fusion compiler takes the size into account when it
+  // computes the map size, and expands (without copying) the input itself.
+  bool isFusableExpand(Node * node) {
+    return node->owningBlock() == block &&
+      node->matches("aten::expand(Tensor self, int[] size, *, bool implicit) -> Tensor",
+                    /*const_inputs=*/{attr::size, attr::implicit}) &&
+      hasSupportedType(node->input(0)) &&
+      haveSupportedType(node->outputs());
+  }
+
+  // The input of an absorbed expand has to remain an input of the group.
+  bool isExpandedInGroup(Node * group, Value * producer) {
+    if (group->kind() != prim::FusionGroup) return false;
+    auto inputs = group->inputs();
+    auto it = std::find(inputs.begin(), inputs.end(), producer);
+    if (it == inputs.end()) return false;
+    for (auto u : getSubgraph(group).inputs().at(it - inputs.begin())->uses()) {
+      if (u.user->kind() == aten::expand) return true;
+    }
+    return false;
+  }
+
   bool isFusableCatNode(Node * node) {
     if (node->kind() != aten::cat)
       return false;
@@ -259,15 +377,16 @@ struct GraphFuser {
   }
 
   // Can this node produce an _output_ of a fusion group?
-  // all Fusable nodes can do this, but additionally Concat, which normally cannot be fused
-  // because it is not a simple map, can be put in a fusion group
-  // as long as no items in the group read the output of concat
+  // all Fusable nodes can do this, but additionally Concat and reductions, which
+  // normally cannot be fused because they are not simple maps, can be put in a
+  // fusion group as long as no items in the group read their outputs
   bool isFusableAsExitNode(Node * node) {
     return isFusable(node) || isFusableOnlyAsExitNode(node);
   }
 
   bool isFusableOnlyAsExitNode(Node * node) {
-    return isFusableCatNode(node) || node->kind() == prim::FusedConcat;
+    return isFusableCatNode(node) || node->kind() == prim::FusedConcat ||
+      isFusableReduction(node);
   }
 
   // necessary condition for fusion. If all of the uses of producer are consumer
@@ -302,7 +421,7 @@ struct GraphFuser {
     }
     auto subgraph = producer->node()->g(attr::Subgraph);
     auto * node = subgraph->outputs().at(producer->offset())->node();
-    return isFusableOnlyAsExitNode(node);
+    return isFusableOnlyAsExitNode(node) || isReduction(node);
   }
 
   // unknown (u) any (a) cpu (c) cuda (g) compatibility:
@@ -349,7 +468,15 @@ struct GraphFuser {
     // we can move the consumer up into the producer.
     // but this requires better handling of merging fusion groups so it is not done now
     Node *real_consumer = consumer->kind() == aten::cat ? consumer->namedInput(attr::tensors)->node() : consumer;
+    // an expand that other nodes use would have to be materialized as an output
+    if (isFusableExpand(producer->node())) {
+      return allUsersAreThisConsumer(real_consumer, producer) &&
+        compatibleDevices(consumer, producer);
+    }
     return isFusable(producer->node()) &&
+      !isExpandedInGroup(consumer, producer) &&
+      compatibleReductions(consumer, producer->node()) &&
+      !readsReductionOf(real_consumer, producer->node()) &&
       allUsersAreThisConsumerOrOccurAfterIt(real_consumer, producer) &&
       compatibleDevices(consumer, producer);
   }
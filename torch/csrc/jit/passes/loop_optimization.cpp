@@ -0,0 +1,269 @@
+#include "torch/csrc/jit/passes/loop_optimization.h"
+
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/constants.h"
+#include "torch/csrc/jit/interned_strings.h"
+#include "torch/csrc/jit/passes/alias_analysis.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace torch { namespace jit {
+
+namespace {
+
+bool hasSideEffects(Node* n) {
+  switch (n->kind()) {
+    case prim::PythonOp:
+    case prim::Print:
+    case prim::LoadWorld:
+    case prim::StoreWorld:
+    case prim::MemoryFence:
+    case prim::AllocateArena:
+    case prim::ArenaSlot:
+    case aten::append:
+      return true;
+    default:
+      return n->isNondeterministic();
+  }
+}
+
+// whether n, or anything n (or any of its blocks) reads or produces, may be
+// written to by some node of the graph
+bool touchesWrittenMemory(Node* n, const AliasDb& aliases) {
+  for (Value* v : n->inputs()) {
+    if (aliases.hasWriters(v)) {
+      return true;
+    }
+  }
+  for (Value* v : n->outputs()) {
+    if (aliases.hasWriters(v)) {
+      return true;
+    }
+  }
+  for (Block* b : n->blocks()) {
+    for (Value* v : b->inputs()) {
+      if (aliases.hasWriters(v)) {
+        return true;
+      }
+    }
+    for (Node* inner : b->nodes()) {
+      if (touchesWrittenMemory(inner, aliases)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool hasSideEffectsInBlocks(Node* n) {
+  if (hasSideEffects(n)) {
+    return true;
+  }
+  for (Block* b : n->blocks()) {
+    for (Node* inner : b->nodes()) {
+      if (hasSideEffectsInBlocks(inner)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool isDefinedIn(Value* v, Block* block) {
+  for (Block* b = v->node()->owningBlock(); b; b = b->owningNode() ? b->owningNode()->owningBlock() : nullptr) {
+    if (b == block) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// whether n or any node in its blocks uses one of values
+bool usesAny(Node* n, const std::unordered_set<Value*>& values) {
+  for (Value* v : n->inputs()) {
+    if (values.count(v)) {
+      return true;
+    }
+  }
+  for (Block* b : n->blocks()) {
+    for (Node* inner : b->nodes()) {
+      if (usesAny(inner, values)) {
+        return true;
+      }
+    }
+    if (usesAny(b->return_node(), values)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isTrueConstant(Value* v) {
+  c10::optional<bool> value = constant_as<bool>(v);
+  return value && *value;
+}
+
+bool isForLoop(Node* n) {
+  return n->kind() == prim::Loop && isTrueConstant(n->inputs().at(1)) &&
+      isTrueConstant(n->blocks().at(0)->outputs().at(0));
+}
+
+bool sameTripCount(Node* a, Node* b) {
+  Value* a_trips = a->inputs().at(0);
+  Value* b_trips = b->inputs().at(0);
+  if (a_trips == b_trips) {
+    return true;
+  }
+  c10::optional<int64_t> a_value = constant_as<int64_t>(a_trips);
+  c10::optional<int64_t> b_value = constant_as<int64_t>(b_trips);
+  return a_value && b_value && *a_value == *b_value;
+}
+
+struct LoopInvariantHoister {
+  LoopInvariantHoister(const std::shared_ptr<Graph>& graph)
+  : aliases(graph) {}
+
+  void run(Block* block) {
+    for (Node* n : block->nodes()) {
+      // inner loops first, so that what they hoist can move further out
+      for (Block* b : n->blocks()) {
+        run(b);
+      }
+      if (n->kind() == prim::Loop) {
+        hoistFrom(n);
+      }
+    }
+  }
+
+private:
+  void hoistFrom(Node* loop) {
+    Block* body = loop->blocks().at(0);
+    for (auto it = body->nodes().begin(); it != body->nodes().end();) {
+      Node* n = *it++;
+      if (isInvariant(n, body)) {
+        n->moveBefore(loop);
+      }
+    }
+  }
+
+  bool isInvariant(Node* n, Block* body) {
+    if (!n->blocks().empty() || hasSideEffects(n) || touchesWrittenMemory(n, aliases)) {
+      return false;
+    }
+    for (Value* v : n->inputs()) {
+      if (isDefinedIn(v, body)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  AliasDb aliases;
+};
+
+struct LoopFuser {
+  LoopFuser(const std::shared_ptr<Graph>& graph)
+  : graph(graph)
+  , aliases(graph) {}
+
+  void run(Block* block) {
+    for (Node* n : block->nodes()) {
+      for (Block* b : n->blocks()) {
+        run(b);
+      }
+      if (!canFuse(n)) {
+        continue;
+      }
+      while (Node* next = nextLoopToFuse(n)) {
+        fuse(n, next);
+      }
+    }
+  }
+
+private:
+  bool canFuse(Node* loop) {
+    return isForLoop(loop) && !hasSideEffectsInBlocks(loop) &&
+        !touchesWrittenMemory(loop, aliases);
+  }
+
+  // Finds the loop after first that can be fused into it, and moves the
+  // nodes between them in front of first.
+  Node* nextLoopToFuse(Node* first) {
+    std::unordered_set<Value*> results(first->outputs().begin(), first->outputs().end());
+    std::vector<Node*> between;
+    Node* second = first->next();
+    for (; second->kind() != prim::Loop; second = second->next()) {
+      if (second == first->owningBlock()->return_node() ||
+          !second->blocks().empty() || hasSideEffects(second) ||
+          touchesWrittenMemory(second, aliases) || usesAny(second, results)) {
+        return nullptr;
+      }
+      between.push_back(second);
+    }
+    if (!sameTripCount(first, second) || !canFuse(second) || usesAny(second, results)) {
+      return nullptr;
+    }
+    for (Node* n : between) {
+      n->moveBefore(first);
+    }
+    return second;
+  }
+
+  // Appends the body of second to the body of first, carrying the values of
+  // both loops, and replaces second with first.
+  void fuse(Node* first, Node* second) {
+    Block* body = first->blocks().at(0);
+    Block* other = second->blocks().at(0);
+    std::unordered_map<Value*, Value*> value_map;
+    auto get_value = [&](Value* v) {
+      auto it = value_map.find(v);
+      if (it != value_map.end())
+        return it->second;
+      return v;
+    };
+
+    // Loop nodes have extra (max_trip_count, initial_cond) inputs, and their
+    // bodies an extra (loop_counter) input and (continue_cond) output.
+    value_map[other->inputs().at(0)] = body->inputs().at(0);
+    for (size_t i = 2; i < second->inputs().size(); ++i) {
+      first->addInput(second->inputs()[i]);
+      Value* carried = body->addInput();
+      carried->copyMetadata(other->inputs()[i - 1]);
+      value_map[other->inputs()[i - 1]] = carried;
+    }
+
+    WithInsertPoint guard(body);
+    for (Node* orig : other->nodes()) {
+      Node* clone = graph->insertNode(graph->createClone(orig, get_value));
+      for (size_t i = 0; i < orig->outputs().size(); ++i) {
+        value_map[orig->outputs()[i]] = clone->outputs()[i];
+      }
+    }
+    for (size_t i = 1; i < other->outputs().size(); ++i) {
+      body->registerOutput(get_value(other->outputs()[i]));
+      Value* result = first->addOutput();
+      result->copyMetadata(second->outputs()[i - 1]);
+      second->outputs()[i - 1]->replaceAllUsesWith(result);
+    }
+    second->destroy();
+  }
+
+  std::shared_ptr<Graph> graph;
+  // Values cloned from fused loops aren't known to aliases, but the loops
+  // they come from were already checked.
+  AliasDb aliases;
+};
+
+} // anonymous namespace
+
+void HoistLoopInvariants(std::shared_ptr<Graph>& graph) {
+  LoopInvariantHoister(graph).run(graph->block());
+}
+
+void FuseLoops(std::shared_ptr<Graph>& graph) {
+  LoopFuser(graph).run(graph->block());
+}
+
+}}
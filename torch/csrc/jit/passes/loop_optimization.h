@@ -0,0 +1,22 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Moves nodes of loop bodies that only depend on values from outside of the
+// loop, like transposes of weights or masks built from constants, in front of
+// the loop, innermost loops first. Only ops without side effects whose inputs
+// and outputs are never written to (see AliasDb) are moved.
+//
+// The moved ops run even if the loop doesn't, so an error one of them raises
+// is raised then too.
+TORCH_API void HoistLoopInvariants(std::shared_ptr<Graph>& graph);
+
+// Fuses consecutive for loops with the same trip count into one, when the
+// second loop doesn't use the results of the first and neither of them has
+// side effects or writes to tensors. Nodes between the loops that don't
+// depend on the first one are moved in front of it.
+TORCH_API void FuseLoops(std::shared_ptr<Graph>& graph);
+
+}}
@@ -0,0 +1,198 @@
+#include "torch/csrc/jit/passes/memory_planning.h"
+
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/interned_strings.h"
+#include "torch/csrc/jit/operator.h"
+
+#include <ATen/ATen.h>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace torch { namespace jit {
+
+namespace detail {
+
+bool memory_planning_enabled = false;
+
+} // namespace detail
+
+namespace {
+
+// Slots are aligned like fresh allocations would be, so that kernels taking
+// vectorized paths on aligned pointers keep doing so.
+constexpr int64_t kSlotAlignment = 64;
+
+// Ops with an out= overload registered in register_special_ops.cpp. None of
+// them alias or mutate their inputs.
+const OperatorSet& opsWithOutVariant() {
+  static const OperatorSet ops = {
+    "aten::add(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+    "aten::sub(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+    "aten::mul(Tensor self, Tensor other) -> Tensor",
+    "aten::div(Tensor self, Tensor other) -> Tensor",
+    "aten::mm(Tensor self, Tensor mat2) -> Tensor",
+    "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor",
+    "aten::sigmoid(Tensor self) -> Tensor",
+    "aten::tanh(Tensor self) -> Tensor",
+    "aten::exp(Tensor self) -> Tensor",
+  };
+  return ops;
+}
+
+// A slot may only be reused once everything reading it has run, so its
+// readers must not return views of it or keep it alive in any other way.
+bool onlyReadsInputs(Node* n) {
+  return n->kind() == prim::FusionGroup || opsWithOutVariant().find(n) != nullptr;
+}
+
+struct Slot {
+  Value* value;
+  int64_t size; // in elements, rounded up to kSlotAlignment
+  size_t first; // position of the node producing value
+  size_t last;  // position of the last node reading value
+  int64_t offset;
+};
+
+bool lifetimesOverlap(const Slot& a, const Slot& b) {
+  return a.first <= b.last && b.first <= a.last;
+}
+
+// Places the slots largest first, each at the lowest offset that doesn't
+// collide with an already placed slot whose lifetime overlaps its own.
+// Returns the size of the arena needed to hold all of them.
+int64_t assignOffsets(std::vector<Slot>& slots) {
+  std::vector<Slot*> order;
+  for (auto& slot : slots) {
+    order.push_back(&slot);
+  }
+  std::stable_sort(order.begin(), order.end(), [](Slot* a, Slot* b) {
+    return a->size > b->size;
+  });
+
+  std::vector<Slot*> placed;
+  int64_t arena_size = 0;
+  for (Slot* slot : order) {
+    std::vector<Slot*> live;
+    for (Slot* other : placed) {
+      if (lifetimesOverlap(*slot, *other)) {
+        live.push_back(other);
+      }
+    }
+    std::sort(live.begin(), live.end(), [](Slot* a, Slot* b) {
+      return a->offset < b->offset;
+    });
+    int64_t offset = 0;
+    for (Slot* other : live) {
+      if (offset + slot->size <= other->offset) {
+        break;
+      }
+      offset = std::max(offset, other->offset + other->size);
+    }
+    slot->offset = offset;
+    arena_size = std::max(arena_size, offset + slot->size);
+    placed.push_back(slot);
+  }
+  return arena_size;
+}
+
+// Rewrites the producer of slot.value to write into its slot of arena.
+void assignToSlot(Graph& graph, Value* arena, const Slot& slot) {
+  Node* producer = slot.value->node();
+  auto type = slot.value->type()->expect<CompleteTensorType>();
+  WithInsertPoint guard(producer);
+
+  Node* view = graph.insertNode(graph.create(prim::ArenaSlot, {arena}));
+  view->is_(attr::sizes, type->sizes())
+      ->is_(attr::stride, type->strides())
+      ->i_(attr::offset, slot.offset);
+  view->output()->setType(type);
+
+  auto inputs = producer->inputs().vec();
+  inputs.push_back(view->output());
+  Node* planned = graph.insertNode(graph.create(producer->kind(), inputs));
+  planned->setScope(producer->scope());
+  planned->setSourceLocation(producer->getSourceLocation());
+  planned->output()->copyMetadata(slot.value);
+  slot.value->replaceAllUsesWith(planned->output());
+  producer->destroy();
+}
+
+} // anonymous namespace
+
+bool memoryPlanningEnabled() {
+  return detail::memory_planning_enabled;
+}
+
+void setMemoryPlanningEnabled(bool value) {
+  detail::memory_planning_enabled = value;
+}
+
+void PlanMemory(std::shared_ptr<Graph>& graph) {
+  Block* block = graph->block();
+  std::unordered_map<Node*, size_t> position;
+  for (Node* n : block->nodes()) {
+    position.emplace(n, position.size());
+  }
+
+  // Only nodes in the top-level block are planned, and only when all of their
+  // uses are there too, so positions in the block order lifetimes correctly.
+  std::map<std::pair<at::ScalarType, int>, std::vector<Slot>> arenas;
+  for (Node* n : block->nodes()) {
+    if (n->outputs().size() != 1 || !opsWithOutVariant().find(n))
+      continue;
+    Value* v = n->output();
+    auto type = v->type()->cast<CompleteTensorType>();
+    if (!type || type->strides() != type->contiguous()->strides())
+      continue;
+    int64_t numel = 1;
+    for (int64_t size : type->sizes()) {
+      numel *= size;
+    }
+    if (numel == 0 || v->uses().empty())
+      continue;
+
+    bool plannable = true;
+    size_t last = position.at(n);
+    for (const Use& use : v->uses()) {
+      // Graph outputs are handed to the caller and must own their memory.
+      if (use.user->owningBlock() != block || !onlyReadsInputs(use.user)) {
+        plannable = false;
+        break;
+      }
+      last = std::max(last, position.at(use.user));
+    }
+    if (!plannable)
+      continue;
+
+    int64_t alignment = std::max<int64_t>(1, kSlotAlignment / at::elementSize(type->scalarType()));
+    int64_t size = (numel + alignment - 1) / alignment * alignment;
+    arenas[{type->scalarType(), type->device()}].push_back(
+        Slot{v, size, position.at(n), last, 0});
+  }
+
+  for (auto& entry : arenas) {
+    auto& slots = entry.second;
+    // A single slot is no cheaper than allocating the tensor directly.
+    if (slots.size() < 2)
+      continue;
+    at::ScalarType scalar_type = entry.first.first;
+    int device = entry.first.second;
+    int64_t arena_size = assignOffsets(slots);
+
+    Node* arena = graph->create(prim::AllocateArena);
+    arena->i_(attr::size, arena_size)
+        ->i_(attr::dtype, static_cast<int64_t>(scalar_type))
+        ->i_(attr::device, device);
+    arena->output()->setType(CompleteTensorType::create(scalar_type, device, {arena_size}));
+    graph->prependNode(arena);
+
+    for (const auto& slot : slots) {
+      assignToSlot(*graph, arena->output(), slot);
+    }
+  }
+}
+
+}}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Statically plans the memory of intermediate tensors in a shape-specialized
+// graph. Every intermediate with a complete, contiguous type that is produced
+// by an op with an out= variant, and is only read by ops known not to alias
+// their inputs, gets a slot in a single arena per (device, scalar type). Slots
+// are assigned offsets from liveness intervals, so values that are never live
+// at the same time share memory.
+//
+// The arena is allocated once per run by a prim::AllocateArena node, each slot
+// is carved out of it by prim::ArenaSlot, and the producing op is rewritten to
+// write into the slot through its out= overload.
+//
+// Values saved for backward would be overwritten when their slot is reused,
+// so only run this on graphs that will not be differentiated.
+TORCH_API void PlanMemory(std::shared_ptr<Graph>& graph);
+
+// The graph executor plans graphs that won't be differentiated only when
+// memory planning is enabled, and then also runs ConvertToInplaceOps on them.
+// It is disabled by default.
+TORCH_API bool memoryPlanningEnabled();
+TORCH_API void setMemoryPlanningEnabled(bool value);
+
+}}
@@ -0,0 +1,468 @@
+#include "torch/csrc/jit/passes/parallelize_branches.h"
+
+#include "torch/csrc/autograd/grad_mode.h"
+#include "torch/csrc/autograd/profiler.h"
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/constants.h"
+#include "torch/csrc/jit/interpreter.h"
+#include "torch/csrc/jit/operator.h"
+
+#include <ATen/ATen.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace torch { namespace jit {
+
+namespace detail {
+
+std::atomic<size_t> inter_op_threads {1};
+
+} // namespace detail
+
+namespace {
+
+// A branch has to cost at least this much (see nodeCost) to be worth the
+// hand-off to another thread.
+constexpr size_t kMinBranchCost = 20;
+
+bool isInplace(Node* n) {
+  if (!n->kind().is_aten()) {
+    return false;
+  }
+  std::string name = n->kind().toUnqualString();
+  if (name.empty() || name.back() != '_') {
+    return false;
+  }
+  // __and__ and friends are not in-place, __iand__ and friends are
+  return name.compare(0, 2, "__") != 0 || name.compare(0, 3, "__i") == 0;
+}
+
+bool hasSideEffects(Node* n) {
+  switch (n->kind()) {
+    case prim::PythonOp:
+    case prim::Print:
+    case prim::LoadWorld:
+    case prim::StoreWorld:
+    case prim::AllocateArena:
+    case prim::ArenaSlot:
+    case aten::append:
+      return true;
+    default:
+      break;
+  }
+  // Ops drawing from the global generator would see it in a different state
+  // if their order changed.
+  return isInplace(n) || n->isNondeterministic();
+}
+
+bool hasSideEffects(Block* block) {
+  for (Node* n : block->nodes()) {
+    if (hasSideEffects(n)) {
+      return true;
+    }
+    for (Block* sub : n->blocks()) {
+      if (hasSideEffects(sub)) {
+        return true;
+      }
+    }
+    if (n->hasAttribute(attr::Subgraph) && n->kindOf(attr::Subgraph) == AttributeKind::g &&
+        hasSideEffects(n->g(attr::Subgraph)->block())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Nodes that can be moved into a branch. Control flow stays where it is, and
+// so do constants, which are cloned into the branches that use them.
+bool isMovable(Node* n) {
+  return n->blocks().empty() && n->kind() != prim::Constant;
+}
+
+// A rough estimate of the time a node takes, in units of a cheap pointwise op
+// over a small tensor.
+size_t nodeCost(Node* n) {
+  if (n->outputs().empty() || !n->output(0)->type()->isSubtypeOf(DynamicType::get())) {
+    return 0;
+  }
+  size_t weight = 1;
+  switch (n->kind()) {
+    case aten::mm:
+    case aten::addmm:
+    case aten::matmul:
+    case aten::bmm:
+    case aten::linear:
+    case aten::conv1d:
+    case aten::conv2d:
+    case aten::conv3d:
+    case aten::conv_transpose1d:
+    case aten::conv_transpose2d:
+    case aten::conv_transpose3d:
+    case aten::_convolution:
+    case aten::lstm:
+    case aten::gru:
+    case aten::rnn_tanh:
+    case aten::rnn_relu:
+      weight = 10;
+      break;
+    case prim::FusionGroup:
+      weight = 3;
+      break;
+    default:
+      break;
+  }
+  if (auto type = n->output(0)->type()->cast<CompleteTensorType>()) {
+    size_t numel = 1;
+    for (int64_t s : type->sizes()) {
+      numel *= s;
+    }
+    weight *= std::max<size_t>(1, numel / 1024);
+  }
+  return weight;
+}
+
+bool usesAnyOf(Node* n, const std::unordered_set<Node*>& nodes) {
+  for (Value* input : n->inputs()) {
+    if (nodes.count(input->node()) > 0) {
+      return true;
+    }
+  }
+  for (Block* sub : n->blocks()) {
+    for (Node* inner : sub->nodes()) {
+      if (usesAnyOf(inner, nodes)) {
+        return true;
+      }
+    }
+    if (usesAnyOf(sub->return_node(), nodes)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The movable nodes seen since the last branching point, split into
+// components that share no values.
+struct Stage {
+  explicit Stage(Graph& graph)
+  : graph(graph) {}
+
+  Node* find(Node* n) {
+    while (parent[n] != n) {
+      parent[n] = parent[parent[n]];
+      n = parent[n];
+    }
+    return n;
+  }
+
+  // The components n would join.
+  std::vector<Node*> producers(Node* n) {
+    std::vector<Node*> roots;
+    for (Value* input : n->inputs()) {
+      if (members.count(input->node()) == 0) {
+        continue;
+      }
+      Node* root = find(input->node());
+      if (std::find(roots.begin(), roots.end(), root) == roots.end()) {
+        roots.push_back(root);
+      }
+    }
+    return roots;
+  }
+
+  bool isHeavy(Node* root) {
+    return cost[root] >= kMinBranchCost;
+  }
+
+  void add(Node* n) {
+    auto roots = producers(n);
+    nodes.push_back(n);
+    members.insert(n);
+    parent[n] = n;
+    cost[n] = nodeCost(n);
+    for (Node* root : roots) {
+      parent[root] = n;
+      cost[n] += cost[root];
+    }
+  }
+
+  // Moves the heavy components into a prim::ParallelBranches node in front of
+  // insert_point, if there are at least two of them, and starts a new stage.
+  void flush(Node* insert_point) {
+    std::vector<Node*> roots;
+    std::unordered_map<Node*, std::vector<Node*>> components;
+    for (Node* n : nodes) {
+      Node* root = find(n);
+      if (!isHeavy(root)) {
+        continue;
+      }
+      if (components.count(root) == 0) {
+        roots.push_back(root);
+      }
+      components[root].push_back(n);
+    }
+    if (roots.size() >= 2) {
+      createBranches(roots, components, insert_point);
+    }
+    nodes.clear();
+    members.clear();
+    parent.clear();
+    cost.clear();
+  }
+
+  void createBranches(
+      const std::vector<Node*>& roots,
+      std::unordered_map<Node*, std::vector<Node*>>& components,
+      Node* insert_point) {
+    Node* branches = graph.create(prim::ParallelBranches, 0);
+
+    // Every branch takes all inputs of the node, which keeps the calling
+    // convention simple; the interpreter drops the unused ones right away.
+    std::unordered_set<Node*> moved;
+    std::unordered_set<Value*> inputs;
+    for (Node* root : roots) {
+      for (Node* n : components[root]) {
+        moved.insert(n);
+      }
+    }
+    for (Node* root : roots) {
+      for (Node* n : components[root]) {
+        for (Value* input : n->inputs()) {
+          if (moved.count(input->node()) > 0 || toIValue(input) ||
+              !inputs.insert(input).second) {
+            continue;
+          }
+          branches->addInput(input);
+        }
+      }
+    }
+
+    std::vector<std::shared_ptr<Graph>> subgraphs;
+    std::vector<std::pair<Value*, Value*>> to_replace;
+    for (Node* root : roots) {
+      auto subgraph = std::make_shared<Graph>();
+      std::unordered_map<Value*, Value*> value_map;
+      for (Value* input : branches->inputs()) {
+        value_map[input] = subgraph->addInput()->setType(input->type());
+      }
+      auto getInput = [&](Value* v) {
+        auto it = value_map.find(v);
+        if (it != value_map.end()) {
+          return it->second;
+        }
+        Value* constant = subgraph->insertConstant(*toIValue(v));
+        value_map[v] = constant;
+        return constant;
+      };
+      for (Node* n : components[root]) {
+        Node* clone = subgraph->appendNode(subgraph->createClone(n, getInput));
+        for (size_t i = 0; i < n->outputs().size(); ++i) {
+          Value* output = n->outputs()[i];
+          value_map[output] = clone->outputs()[i];
+          bool used_outside = std::any_of(
+              output->uses().begin(), output->uses().end(),
+              [&](const Use& u) { return moved.count(u.user) == 0; });
+          if (used_outside) {
+            subgraph->registerOutput(clone->outputs()[i]);
+            Value* external = branches->addOutput()->setType(output->type());
+            to_replace.emplace_back(output, external);
+          }
+        }
+      }
+      subgraphs.push_back(std::move(subgraph));
+    }
+    branches->gs_(attr::Subgraphs, std::move(subgraphs));
+    branches->insertBefore(insert_point);
+    for (auto& replacement : to_replace) {
+      replacement.first->replaceAllUsesWith(replacement.second);
+    }
+    // delete backward, so that nodes are use-free before deletion
+    for (size_t i = nodes.size(); i > 0; --i) {
+      if (moved.count(nodes[i - 1]) > 0) {
+        nodes[i - 1]->destroy();
+      }
+    }
+  }
+
+  Graph& graph;
+  std::vector<Node*> nodes; // in topological order
+  std::unordered_set<Node*> members;
+  std::unordered_map<Node*, Node*> parent;
+  std::unordered_map<Node*, size_t> cost; // of the component, valid for roots
+};
+
+// Runs the non-first branches of prim::ParallelBranches nodes. Workers never
+// wait for other tasks, so a fixed number of them can't deadlock.
+struct InterOpPool {
+  // Returns false if there are no workers to run task on.
+  bool run(std::function<void()> task) {
+    std::lock_guard<std::mutex> guard(mutex);
+    size_t wanted = detail::inter_op_threads.load() - 1;
+    while (threads.size() < wanted) {
+      threads.emplace_back(&InterOpPool::workerMain, this);
+    }
+    if (threads.empty()) {
+      return false;
+    }
+    tasks.push_back(std::move(task));
+    cv.notify_one();
+    return true;
+  }
+
+  static bool inWorker() {
+    return in_worker;
+  }
+
+private:
+  void workerMain() {
+    in_worker = true;
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return !tasks.empty(); });
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+  static thread_local bool in_worker;
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<std::function<void()>> tasks;
+  std::vector<std::thread> threads;
+};
+
+thread_local bool InterOpPool::in_worker = false;
+
+InterOpPool& interOpPool() {
+  // Leaked, so that the workers are never joined at exit.
+  static InterOpPool* pool = new InterOpPool();
+  return *pool;
+}
+
+void runBranches(const std::vector<Code>& codes, size_t num_inputs, Stack& stack) {
+  std::vector<Stack> branch_stacks(codes.size(), Stack(stack.end() - num_inputs, stack.end()));
+  drop(stack, num_inputs);
+
+  std::vector<std::exception_ptr> errors(codes.size());
+  auto runBranch = [&](size_t i) {
+    try {
+      InterpreterState(codes[i]).run(branch_stacks[i]);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  };
+
+  std::mutex mutex;
+  std::condition_variable done;
+  size_t pending = 0;
+  const bool grad_mode = autograd::GradMode::is_enabled();
+  for (size_t i = 1; i < codes.size(); ++i) {
+    // Nested parallel regions run sequentially on the worker.
+    if (InterOpPool::inWorker()) {
+      runBranch(i);
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      ++pending;
+    }
+    bool scheduled = interOpPool().run([&, i] {
+      {
+        autograd::AutoGradMode grad_guard(grad_mode);
+        runBranch(i);
+      }
+      std::lock_guard<std::mutex> guard(mutex);
+      if (--pending == 0) {
+        done.notify_one();
+      }
+    });
+    if (!scheduled) {
+      std::lock_guard<std::mutex> guard(mutex);
+      --pending;
+      runBranch(i);
+    }
+  }
+  runBranch(0);
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return pending == 0; });
+  }
+
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  for (auto& branch_stack : branch_stacks) {
+    stack.insert(
+        stack.end(),
+        std::make_move_iterator(branch_stack.begin()),
+        std::make_move_iterator(branch_stack.end()));
+  }
+}
+
+RegisterOperators reg({
+    Operator(
+        prim::ParallelBranches,
+        [](Node* node) -> Operation {
+          std::vector<Code> codes;
+          for (auto subgraph : node->gs(attr::Subgraphs)) {
+            codes.emplace_back(subgraph);
+          }
+          size_t num_inputs = node->inputs().size();
+          return [=](Stack& stack) {
+            autograd::profiler::RecordFunction record("ParallelBranches");
+            runBranches(codes, num_inputs, stack);
+            return 0;
+          };
+        }),
+});
+
+} // anonymous namespace
+
+void ParallelizeBranches(std::shared_ptr<Graph>& graph) {
+  if (hasSideEffects(graph->block())) {
+    return;
+  }
+  Stage stage(*graph);
+  for (auto it = graph->nodes().begin(); it != graph->nodes().end();) {
+    Node* n = *it++;
+    if (isMovable(n)) {
+      auto roots = stage.producers(n);
+      size_t heavy = std::count_if(
+          roots.begin(), roots.end(), [&](Node* root) { return stage.isHeavy(root); });
+      if (heavy >= 2) {
+        stage.flush(n);
+      }
+      stage.add(n);
+    } else if (usesAnyOf(n, stage.members)) {
+      stage.flush(n);
+    }
+  }
+  stage.flush(graph->return_node());
+}
+
+size_t getInterOpThreads() {
+  return detail::inter_op_threads.load();
+}
+
+void setInterOpThreads(size_t num_threads) {
+  AT_CHECK(num_threads > 0, "the number of inter-op threads has to be positive");
+  detail::inter_op_threads.store(num_threads);
+}
+
+}}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Finds independent branches of the top level block of graph (chains of nodes
+// that don't share any intermediate values, like the towers of a multi-tower
+// model) that are expensive enough to be worth running on another thread, and
+// moves each set of such branches into a prim::ParallelBranches node.
+//
+// prim::ParallelBranches has one subgraph per branch in its Subgraphs
+// attribute. Every subgraph takes all inputs of the node, and the outputs of
+// the node are the outputs of the subgraphs, in order. It runs the first
+// branch on the calling thread and the others on the inter-op thread pool.
+//
+// The branching points are found greedily in topological order: once a node
+// uses the results of two expensive branches, the branches seen so far are
+// moved into a prim::ParallelBranches node in front of it. Graphs that
+// contain ops with side effects or in-place ops are left alone, since without
+// alias information reordering them is not safe.
+TORCH_API void ParallelizeBranches(std::shared_ptr<Graph>& graph);
+
+// Size of the inter-op thread pool, counting the thread that runs a graph.
+// The graph executor only parallelizes graphs that won't be differentiated,
+// and only when this is more than 1 (the default is 1). The pool is created
+// the first time a prim::ParallelBranches node runs; increasing the number of
+// threads later adds threads to it, decreasing it doesn't remove any.
+TORCH_API size_t getInterOpThreads();
+TORCH_API void setInterOpThreads(size_t num_threads);
+
+}}
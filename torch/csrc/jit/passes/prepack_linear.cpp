@@ -0,0 +1,118 @@
+#include "torch/csrc/jit/passes/prepack_linear.h"
+
+#include "torch/csrc/autograd/grad_mode.h"
+#include "torch/csrc/jit/constants.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+
+#include <ATen/ATen.h>
+
+#include <vector>
+
+namespace torch { namespace jit {
+
+namespace {
+
+bool isPackableWeight(const at::Tensor& weight) {
+  return weight.defined() && weight.dim() == 2 &&
+      weight.type().backend() == at::Backend::CPU &&
+      weight.type().scalarType() == at::kFloat;
+}
+
+// If mat2 is a constant, returns the weight w such that mat2 == w.t(), which
+// is what linear multiplies with. Sees through one aten::t, which is how
+// linear shows up in traces when constant propagation has not run.
+c10::optional<at::Tensor> transposedConstant(Value* mat2) {
+  if (mat2->node()->matches("aten::t(Tensor self) -> Tensor")) {
+    return constant_as<at::Tensor>(mat2->node()->input());
+  }
+  if (auto mat = constant_as<at::Tensor>(mat2)) {
+    if (mat->dim() == 2) {
+      return mat->t();
+    }
+  }
+  return c10::nullopt;
+}
+
+bool isBiasFor(const at::Tensor& bias, const at::Tensor& weight) {
+  return bias.dim() == 1 && bias.size(0) == weight.size(0);
+}
+
+// Inserts _mkl_linear_packed(input, weight, prepacked weight, bias) before
+// node and makes it replace node's output. bias may be nullptr.
+void replaceWithPackedLinear(Node* node, Value* input, at::Tensor weight, Value* bias) {
+  Graph* graph = node->owningGraph();
+  WithInsertPoint guard(node);
+  at::Tensor packed;
+  {
+    autograd::AutoGradMode no_grad(false);
+    weight = weight.detach().contiguous();
+    packed = at::_mkl_linear_prepack(weight);
+  }
+  std::vector<NamedValue> args = {input, graph->insertConstant(weight), graph->insertConstant(packed)};
+  if (bias) {
+    args.emplace_back(bias);
+  }
+  Value* result = graph->insert(Symbol::aten("_mkl_linear_packed"), args);
+  result->setType(node->output()->type());
+  node->output()->replaceAllUsesWith(result);
+}
+
+void PrepackLinearWeights(Block* block) {
+  for (auto it = block->nodes().begin(), end = block->nodes().end(); it != end; ++it) {
+    for (auto sub : it->blocks()) {
+      PrepackLinearWeights(sub);
+    }
+    Node* node = *it;
+    if (node->matches("aten::linear(Tensor input, Tensor weight, Tensor bias) -> Tensor")) {
+      auto weight = constant_as<at::Tensor>(node->inputs()[1]);
+      if (!weight || !isPackableWeight(*weight)) {
+        continue;
+      }
+      Value* bias = node->inputs()[2];
+      if (auto bias_value = toIValue(bias)) {
+        if (!bias_value->isTensor() || !bias_value->toTensor().defined()) {
+          bias = nullptr;
+        }
+      }
+      replaceWithPackedLinear(node, node->inputs()[0], *weight, bias);
+    } else if (node->matches(
+                   "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor",
+                   /*const_inputs=*/{attr::beta, attr::alpha})) {
+      if (node->get<at::Scalar>(attr::alpha)->toDouble() != 1.0 ||
+          node->get<at::Scalar>(attr::beta)->toDouble() != 1.0) {
+        continue;
+      }
+      auto weight = transposedConstant(node->inputs()[2]);
+      if (!weight || !isPackableWeight(*weight)) {
+        continue;
+      }
+      // addmm broadcasts self; linear only takes a bias per output feature
+      auto bias_type = node->inputs()[0]->type()->cast<CompleteTensorType>();
+      auto bias = constant_as<at::Tensor>(node->inputs()[0]);
+      bool is_bias = bias ? isBiasFor(*bias, *weight)
+                          : bias_type && bias_type->sizes() == std::vector<int64_t>{weight->size(0)};
+      if (!is_bias) {
+        continue;
+      }
+      replaceWithPackedLinear(node, node->inputs()[1], *weight, node->inputs()[0]);
+    } else if (node->matches("aten::matmul(Tensor self, Tensor other) -> Tensor")) {
+      auto weight = transposedConstant(node->inputs()[1]);
+      if (!weight || !isPackableWeight(*weight)) {
+        continue;
+      }
+      replaceWithPackedLinear(node, node->inputs()[0], *weight, nullptr);
+    }
+  }
+}
+
+} // anonymous namespace
+
+void PrepackLinearWeights(const std::shared_ptr<Graph>& graph) {
+  if (!at::hasMKL()) {
+    return;
+  }
+  PrepackLinearWeights(graph->block());
+  EliminateDeadCode(graph);
+}
+
+}}
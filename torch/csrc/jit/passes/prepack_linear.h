@@ -0,0 +1,16 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Replaces linear layers whose weight is a constant CPU float matrix
+// (aten::linear, aten::addmm(bias, x, w.t()) and aten::matmul(x, w.t())) with
+// aten::_mkl_linear_packed, packing the weight once at pass time instead of
+// inside every GEMM call. This is a no-op in builds without MKL.
+//
+// The packed weights are only valid on the machine that ran the pass, so run
+// it after loading a model rather than before saving it.
+TORCH_API void PrepackLinearWeights(const std::shared_ptr<Graph>& graph);
+
+}}
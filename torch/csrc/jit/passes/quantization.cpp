@@ -0,0 +1,232 @@
+#include "torch/csrc/jit/passes/quantization.h"
+
+#include "torch/csrc/autograd/grad_mode.h"
+#include "torch/csrc/jit/constants.h"
+#include "torch/csrc/jit/operator.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+
+#include <ATen/ATen.h>
+
+#include <utility>
+#include <vector>
+
+namespace torch { namespace jit {
+
+namespace {
+
+const char* kQuantizeSchema =
+    "aten::quantize_linear(Tensor self, float scale, int zero_point) -> Tensor";
+const char* kDequantizeSchema =
+    "aten::dequantize_linear(Tensor self, float scale, int zero_point) -> Tensor";
+
+// Ops that give the same result whether they run before or after
+// dequantize_linear, because they only move elements around.
+const OperatorSet& dataMovementOps() {
+  static const OperatorSet ops = {
+    "aten::view(Tensor self, int[] size) -> Tensor",
+    "aten::reshape(Tensor self, int[] shape) -> Tensor",
+    "aten::flatten(Tensor self, int start_dim, int end_dim) -> Tensor",
+    "aten::t(Tensor self) -> Tensor",
+    "aten::transpose(Tensor self, int dim0, int dim1) -> Tensor",
+    "aten::permute(Tensor self, int[] dims) -> Tensor",
+    "aten::contiguous(Tensor self) -> Tensor",
+    "aten::squeeze(Tensor self) -> Tensor",
+    "aten::squeeze(Tensor self, int dim) -> Tensor",
+    "aten::unsqueeze(Tensor self, int dim) -> Tensor",
+  };
+  return ops;
+}
+
+Node* producedBy(Value* v, const char* schema) {
+  Node* n = v->node();
+  return n->matches(schema) ? n : nullptr;
+}
+
+// whether a and b are the same value, or constants that are equal
+bool sameParameter(Value* a, Value* b) {
+  if (a == b) {
+    return true;
+  }
+  auto a_value = toIValue(a);
+  auto b_value = toIValue(b);
+  if (!a_value || !b_value) {
+    return false;
+  }
+  if (a_value->isDouble() && b_value->isDouble()) {
+    return a_value->toDouble() == b_value->toDouble();
+  }
+  if (a_value->isInt() && b_value->isInt()) {
+    return a_value->toInt() == b_value->toInt();
+  }
+  return false;
+}
+
+TypePtr withScalarType(const TypePtr& type, at::ScalarType scalar_type) {
+  if (auto complete = type->cast<CompleteTensorType>()) {
+    return complete->toScalarType(scalar_type);
+  }
+  if (auto tensor = type->cast<TensorType>()) {
+    return tensor->toScalarType(scalar_type);
+  }
+  return type;
+}
+
+// op(dequantize_linear(q, s, z)) => dequantize_linear(op(q), s, z)
+void sinkDequantize(Block* block) {
+  for (auto it = block->nodes().begin(); it != block->nodes().end(); ++it) {
+    for (Block* b : it->blocks()) {
+      sinkDequantize(b);
+    }
+    Node* node = *it;
+    if (!dataMovementOps().find(node)) {
+      continue;
+    }
+    Node* dequantize = producedBy(node->inputs()[0], kDequantizeSchema);
+    if (!dequantize) {
+      continue;
+    }
+    Graph* graph = node->owningGraph();
+    WithInsertPoint guard(node);
+    Node* moved = graph->insertNode(graph->createClone(node, [&](Value* v) {
+      return v == node->inputs()[0] ? dequantize->inputs()[0] : v;
+    }));
+    moved->output()->setType(withScalarType(node->output()->type(), at::kByte));
+    Value* result = graph->insert(
+        Symbol::aten("dequantize_linear"),
+        {moved->output(), dequantize->inputs()[1], dequantize->inputs()[2]});
+    result->setType(node->output()->type());
+    node->output()->replaceAllUsesWith(result);
+  }
+}
+
+// If mat2 is a constant, returns the weight w such that mat2 == w.t(). Sees
+// through one aten::t, like PrepackLinearWeights.
+c10::optional<at::Tensor> transposedConstant(Value* mat2) {
+  if (mat2->node()->matches("aten::t(Tensor self) -> Tensor")) {
+    return constant_as<at::Tensor>(mat2->node()->input());
+  }
+  if (auto mat = constant_as<at::Tensor>(mat2)) {
+    if (mat->dim() == 2) {
+      return mat->t();
+    }
+  }
+  return c10::nullopt;
+}
+
+struct LinearMatch {
+  Value* input;
+  at::Tensor weight;
+  // nullptr when there is none
+  Value* bias;
+};
+
+// Matches the forms linear takes in script and traces (see
+// PrepackLinearWeights), with a constant float weight.
+c10::optional<LinearMatch> matchLinear(Node* node) {
+  c10::optional<LinearMatch> match;
+  if (node->matches("aten::linear(Tensor input, Tensor weight, Tensor bias) -> Tensor")) {
+    if (auto weight = constant_as<at::Tensor>(node->inputs()[1])) {
+      match = LinearMatch{node->inputs()[0], *weight, node->inputs()[2]};
+    }
+  } else if (node->matches(
+                 "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor",
+                 /*const_inputs=*/{attr::beta, attr::alpha})) {
+    if (node->get<at::Scalar>(attr::alpha)->toDouble() != 1.0 ||
+        node->get<at::Scalar>(attr::beta)->toDouble() != 1.0) {
+      return c10::nullopt;
+    }
+    auto weight = transposedConstant(node->inputs()[2]);
+    // addmm broadcasts self; quantized_linear only takes a bias per output
+    // feature
+    auto bias = constant_as<at::Tensor>(node->inputs()[0]);
+    if (weight && bias && bias->dim() == 1 && weight->dim() == 2 &&
+        bias->size(0) == weight->size(0)) {
+      match = LinearMatch{node->inputs()[1], *weight, node->inputs()[0]};
+    }
+  } else if (node->matches("aten::matmul(Tensor self, Tensor other) -> Tensor")) {
+    if (auto weight = transposedConstant(node->inputs()[1])) {
+      match = LinearMatch{node->inputs()[0], *weight, nullptr};
+    }
+  }
+  if (!match || !match->weight.defined() || match->weight.dim() != 2 ||
+      match->weight.type().backend() != at::Backend::CPU ||
+      match->weight.type().scalarType() != at::kFloat) {
+    return c10::nullopt;
+  }
+  return match;
+}
+
+// Symmetric per-tensor int8 quantization: weight ~= scale * result.
+std::pair<at::Tensor, double> quantizeWeight(const at::Tensor& weight) {
+  autograd::AutoGradMode no_grad(false);
+  double max_abs = weight.detach().abs().max().item<double>();
+  double scale = max_abs > 0 ? max_abs / 127 : 1.0;
+  at::Tensor quantized = (weight.detach() / scale).round_().clamp_(-127, 127).toType(at::kChar).contiguous();
+  return {quantized, scale};
+}
+
+// quantize_linear([relu](linear(dequantize_linear(x, s, z), w, b)), s', z')
+//   => quantized_linear(x, s, z, quantize(w), b, s', z', relu)
+bool fuseQuantizedLinear(Node* quantize) {
+  Node* node = quantize->inputs()[0]->node();
+  bool relu = false;
+  if (node->matches("aten::relu(Tensor self) -> Tensor")) {
+    relu = true;
+    node = node->input()->node();
+  }
+  auto linear = matchLinear(node);
+  if (!linear) {
+    return false;
+  }
+  Node* dequantize = producedBy(linear->input, kDequantizeSchema);
+  if (!dequantize) {
+    return false;
+  }
+  Graph* graph = quantize->owningGraph();
+  WithInsertPoint guard(quantize);
+  auto weight = quantizeWeight(linear->weight);
+  std::vector<NamedValue> args = {
+    dequantize->inputs()[0],
+    dequantize->inputs()[1],
+    dequantize->inputs()[2],
+    graph->insertConstant(weight.first),
+    graph->insertConstant(weight.second),
+    linear->bias ? linear->bias : graph->insertNode(graph->createUndefined())->output(),
+    quantize->inputs()[1],
+    quantize->inputs()[2],
+    graph->insertConstant(relu),
+  };
+  Value* result = graph->insert(Symbol::aten("quantized_linear"), args);
+  result->setType(quantize->output()->type());
+  quantize->output()->replaceAllUsesWith(result);
+  return true;
+}
+
+void fuseQuantizedOps(Block* block) {
+  for (auto it = block->nodes().begin(); it != block->nodes().end(); ++it) {
+    for (Block* b : it->blocks()) {
+      fuseQuantizedOps(b);
+    }
+    Node* quantize = *it;
+    if (!quantize->matches(kQuantizeSchema)) {
+      continue;
+    }
+    Node* dequantize = producedBy(quantize->inputs()[0], kDequantizeSchema);
+    if (dequantize && sameParameter(dequantize->inputs()[1], quantize->inputs()[1]) &&
+        sameParameter(dequantize->inputs()[2], quantize->inputs()[2])) {
+      quantize->output()->replaceAllUsesWith(dequantize->inputs()[0]);
+      continue;
+    }
+    fuseQuantizedLinear(quantize);
+  }
+}
+
+} // anonymous namespace
+
+void FuseQuantizedOps(const std::shared_ptr<Graph>& graph) {
+  sinkDequantize(graph->block());
+  fuseQuantizedOps(graph->block());
+  EliminateDeadCode(graph);
+}
+
+}}
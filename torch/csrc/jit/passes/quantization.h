@@ -0,0 +1,24 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Turns graphs annotated with aten::quantize_linear and
+// aten::dequantize_linear (see NOTE [ affine quantization ] in
+// native_functions.yaml), e.g. by calibration, into graphs that compute on
+// uint8 tensors:
+//
+// - dequantize_linear is moved past ops that only move values around (view,
+//   reshape, flatten, transpose, ...), so that they run on the quantized
+//   tensor and its quantization parameters reach the ops that consume it.
+// - quantize_linear(dequantize_linear(q, s, z), s, z) is replaced by q.
+// - quantize_linear(y, s_out, z_out) where y is linear (or linear followed by
+//   relu) of dequantize_linear(x, s, z) with a constant float weight is
+//   replaced by aten::quantized_linear. The weight is quantized to int8 when
+//   the pass runs.
+//
+// The results differ from the float graph by the rounding of the weights.
+TORCH_API void FuseQuantizedOps(const std::shared_ptr<Graph>& graph);
+
+}}
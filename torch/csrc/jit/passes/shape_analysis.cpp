@@ -93,12 +93,29 @@ c10::optional<std::vector<std::shared_ptr<T>>> gatherTensorTypes(Node* node) {
   return tensor_types;
 }
 
+// unifyTypes gives up on tensors of different sizes, but if they agree on
+// their rank, scalar type and device, the result still has them. This keeps
+// that much across ifs and loop iterations that change the sizes of tensors.
+c10::optional<TypePtr> unifyShapes(const TypePtr& t1, const TypePtr& t2) {
+  auto tensor1 = t1->cast<TensorType>();
+  auto tensor2 = t2->cast<TensorType>();
+  if (tensor1 && tensor2 && !t1->isSubtypeOf(t2) && !t2->isSubtypeOf(t1) &&
+      tensor1->scalarType() == tensor2->scalarType() &&
+      tensor1->device() == tensor2->device() &&
+      tensor1->dim() == tensor2->dim()) {
+    return static_cast<TypePtr>(TensorType::create(
+        tensor1->scalarType(), tensor1->device(), tensor1->dim(),
+        tensor1->requires_grad() || tensor2->requires_grad()));
+  }
+  return unifyTypes(t1, t2);
+}
+
 bool mergeTypes(ArrayRef<Value*> lhs, ArrayRef<Value*> rhs, ArrayRef<Value*> outputs) {
   JIT_ASSERT(lhs.size() == rhs.size() && rhs.size() == outputs.size());
   bool changed = false;
   for(size_t i = 0; i < lhs.size(); ++i) {
     auto old_output_type = outputs[i]->type();
-    auto new_type = unifyTypes(lhs[i]->type(), rhs[i]->type());
+    auto new_type = unifyShapes(lhs[i]->type(), rhs[i]->type());
     JIT_ASSERT(new_type);
     outputs[i]->setType(*new_type);
     if(*old_output_type != *outputs[i]->type())
@@ -273,6 +290,14 @@ void PropagateShapeOnNode(Node * node, bool insert_expands) {
       auto else_block = node->blocks().at(1);
       PropagateShapeOnBlock(then_block);
       PropagateShapeOnBlock(else_block);
+      // only one of the branches can run if the condition is a constant
+      if (auto cond = constant_as<bool>(node->input())) {
+        auto taken = *cond ? then_block : else_block;
+        for (size_t i = 0; i < node->outputs().size(); ++i) {
+          node->outputs()[i]->setType(taken->outputs()[i]->type());
+        }
+        return;
+      }
       mergeTypes(then_block->outputs(), else_block->outputs(), node->outputs());
       return;
     }
@@ -684,6 +709,44 @@ bool PropagateTensorShapeOnNode(Node * node, bool insert_expands) {
     return {};
   }};
 
+  // The formulas below only give the rank of their outputs. When all tensor
+  // inputs have complete types, they fail so that the node is run instead,
+  // which gives its sizes too.
+  static const auto unless_complete = [](formula_t formula) -> formula_t {
+    return [formula](Node * node) -> type_vec_t {
+      if (gatherTensorTypes<CompleteTensorType>(node)) {
+        return {};
+      }
+      return formula(node);
+    };
+  };
+
+  // Requirements: as for nn_ops_first_input_preserving
+  static const register_formula_for nn_ops_first_input_preserving_unless_complete {{
+    "aten::linear(Tensor input, Tensor weight, Tensor bias) -> Tensor",
+    "aten::_mkl_linear_packed(Tensor input, Tensor weight, Tensor packed_weight, Tensor bias) -> Tensor",
+    "aten::quantized_linear(Tensor input, float input_scale, int input_zero_point, Tensor weight, float weight_scale, Tensor bias, float output_scale, int output_zero_point, bool relu) -> Tensor",
+    "aten::layer_norm(Tensor input, int[] normalized_shape, Tensor weight, Tensor bias, float eps, bool cudnn_enable) -> Tensor",
+    "aten::group_norm(Tensor input, int num_groups, Tensor weight, Tensor bias, float eps, bool cudnn_enabled) -> Tensor",
+    "aten::instance_norm(Tensor input, Tensor weight, Tensor bias, Tensor running_mean, Tensor running_var, bool use_input_stats, float momentum, float eps, bool cudnn_enabled) -> Tensor",
+    "aten::pixel_shuffle(Tensor self, int upscale_factor) -> Tensor",
+  }, unless_complete([](Node * node) -> type_vec_t {
+    if (auto type = node->input(0)->type()->cast<TensorType>()) {
+      return {type};
+    }
+    return {};
+  })};
+
+  // Requirements: as for broadcasting_ops
+  static const register_formula_for broadcasting_ops_unless_complete {{
+    "aten::_add_relu(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+  }, unless_complete([](Node * node) -> type_vec_t {
+    if (auto maybe_tensor_types = gatherTensorTypes<TensorType>(node)) {
+      return {broadcast(*maybe_tensor_types)};
+    }
+    return {};
+  })};
+
   // Requirements:
   //   dims           : 0
   //   scalar type    : preserved
@@ -1026,6 +1089,17 @@ bool PropagateTensorShapeOnNode(Node * node, bool insert_expands) {
       node->output()->setType(type->withDim(0));
       return true;
     }
+  } else if (node->matches("aten::quantize_linear(Tensor self, float scale, int zero_point) -> Tensor") ||
+             node->matches("aten::dequantize_linear(Tensor self, float scale, int zero_point) -> Tensor")) {
+    auto scalar_type = node->kind() == Symbol::aten("quantize_linear") ? at::kByte : at::kFloat;
+    if (auto type = node->input(0)->type()->cast<CompleteTensorType>()) {
+      node->output()->setType(type->toScalarType(scalar_type)->contiguous());
+      return true;
+    }
+    if (auto type = input_type(0)) {
+      node->output()->setType(type->toScalarType(scalar_type));
+      return true;
+    }
   }
 
   // The code below implements formulas that need type information for all their
@@ -1057,6 +1131,22 @@ bool PropagateTensorShapeOnNode(Node * node, bool insert_expands) {
     } else if (node->matches("aten::unsqueeze(Tensor self, int dim) -> Tensor")) {
       auto & t = tensor_types.at(0);
       return t->withDim(t->dim() + 1);
+    } else if (node->matches("aten::flatten(Tensor self, int start_dim, int end_dim) -> Tensor",
+                             /*const_inputs=*/{attr::start_dim, attr::end_dim}) &&
+               !node->input(0)->type()->cast<CompleteTensorType>()) {
+      // if the sizes are known, running it below gives them too
+      auto & t = tensor_types.at(0);
+      if (t->dim() == 0) {
+        return t->withDim(1);
+      }
+      int64_t start_dim = node->get<int64_t>(attr::start_dim).value();
+      int64_t end_dim = node->get<int64_t>(attr::end_dim).value();
+      start_dim = start_dim < 0 ? start_dim + t->dim() : start_dim;
+      end_dim = end_dim < 0 ? end_dim + t->dim() : end_dim;
+      if (start_dim < 0 || end_dim >= t->dim() || start_dim > end_dim) {
+        return nullptr;
+      }
+      return t->withDim(t->dim() - (end_dim - start_dim));
     } else if (node->matches("aten::select(Tensor self, int dim, int index) -> Tensor") ||
                node->matches("aten::diagonal(Tensor self, int offset, int dim1, int dim2) -> Tensor")) {
       auto & t = tensor_types.at(0);
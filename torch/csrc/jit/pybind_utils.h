@@ -111,7 +111,12 @@ inline IValue toIValue(py::handle obj, const TypePtr& type) {
       case TypeKind::TensorType:
       case TypeKind::UndefinedTensorType:
       case TypeKind::CompleteTensorType: {
-        auto var = py::cast<autograd::Variable>(obj);
+        // This is the common case for every argument of a model, so unpack
+        // the Variable directly instead of going through a pybind caster.
+        if (!THPVariable_Check(obj.ptr())) {
+          throw py::cast_error();
+        }
+        const auto& var = THPVariable_Unpack(obj.ptr());
         if (var.is_sparse()) {
           AT_ERROR("sparse tensors not supported");
         }
@@ -129,16 +134,16 @@ inline IValue toIValue(py::handle obj, const TypePtr& type) {
         if(!PyTuple_Check(obj.ptr()))
           throw py::cast_error(); // note: the py::cast does not throw cast_error
                                   // because it attempts to iterate a non-tuple
-        py::tuple tuple = py::cast<py::tuple>(obj);
-        size_t tuple_size = tuple.size();
-        const auto & elem_types = type->cast<TupleType>()->elements();
+        size_t tuple_size = PyTuple_GET_SIZE(obj.ptr());
+        const auto & elem_types = type->expect<TupleType>()->elements();
         if (elem_types.size() != tuple_size) {
           throw py::cast_error();
         }
         std::vector<IValue> values;
         values.reserve(tuple_size);
         for (size_t i = 0; i < tuple_size; ++i) {
-          values.push_back(toIValue(tuple[i], elem_types[i]));
+          // borrowed, so this doesn't create a tuple accessor per element
+          values.push_back(toIValue(PyTuple_GET_ITEM(obj.ptr(), i), elem_types[i]));
         }
         return Tuple::create(std::move(values));
       }
@@ -219,7 +224,8 @@ inline py::object toPyObject(IValue&& ivalue) {
     if (tensor.is_sparse()) {
       AT_ERROR("sparse tensors not supported");
     }
-    return py::cast(autograd::Variable(std::move(tensor)));
+    return py::reinterpret_steal<py::object>(
+        THPVariable_Wrap(autograd::Variable(std::move(tensor))));
   } else if (ivalue.isDouble()) {
     return py::cast(ivalue.toDouble());
   } else if (ivalue.isInt()) {
@@ -239,7 +245,7 @@ inline py::object toPyObject(IValue&& ivalue) {
     const auto & elements = list->elements();
     py::list t { elements.size() };
     for (size_t i = 0; i < elements.size(); ++i) {
-      t[i] = toPyObject(IValue{elements[i]});
+      PyList_SET_ITEM(t.ptr(), i, toPyObject(IValue{elements[i]}).release().ptr());
     }
     return t;
   } else if (ivalue.isTuple()) {
@@ -247,7 +253,7 @@ inline py::object toPyObject(IValue&& ivalue) {
     const auto & elements = tuple->elements();
     py::tuple t { elements.size() };
     for (size_t i = 0; i < elements.size(); ++i) {
-      t[i] = toPyObject(IValue{elements[i]});
+      PyTuple_SET_ITEM(t.ptr(), i, toPyObject(IValue{elements[i]}).release().ptr());
     }
     return t;
   } else {
@@ -301,11 +307,12 @@ inline Stack createStackForSchema(
 
   // Now for every remaining non-positional argument in the schema, look for it
   // in the kwargs dict and push it if found, or use its default value if it
-  // has one.
+  // has one. Most calls pass no kwargs, so don't look them up then.
   size_t consumed_kwargs = 0;
+  const bool has_kwargs = kwargs.size() > 0;
   for (size_t i = args.size(); i < schema.arguments.size(); ++i) {
     const auto& arg = schema.arguments[i];
-    if (kwargs.contains(arg.name.c_str())) {
+    if (has_kwargs && kwargs.contains(arg.name.c_str())) {
       push(stack, argumentToIValue(schema, i, kwargs[arg.name.c_str()]));
       consumed_kwargs += 1;
     } else if (arg.default_value) {
@@ -340,8 +347,8 @@ inline py::object createPyObjectForStack(Stack&& stack) {
 
   // If there is more than one return value, pop them into a py::tuple.
   py::tuple return_values(stack.size());
-  for (size_t ret = 0; ret < return_values.size(); ++ret) {
-    return_values[ret] = toPyObject(std::move(stack[ret]));
+  for (size_t ret = 0; ret < stack.size(); ++ret) {
+    PyTuple_SET_ITEM(return_values.ptr(), ret, toPyObject(std::move(stack[ret])).release().ptr());
   }
 
   return return_values;
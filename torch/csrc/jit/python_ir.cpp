@@ -168,6 +168,17 @@ void initPythonIRBindings(PyObject * module_) {
        py::arg("onnx_opset_version")=0,
        py::arg("defer_weight_export")=false,
        py::arg("operator_export_type")=::torch::onnx::OperatorExportTypes::ONNX)
+    .def("export_external_data", [](const std::shared_ptr<Graph> g,
+          const std::vector<at::Tensor>& initializers,
+          int64_t onnx_opset_version, const std::string& directory,
+          size_t num_threads, ::torch::onnx::OperatorExportTypes operator_export_type) {
+      return py::bytes(ExportGraphWithExternalData(
+        g, initializers, onnx_opset_version, directory, num_threads, operator_export_type));
+    }, py::arg("initializers"),
+       py::arg("onnx_opset_version"),
+       py::arg("directory"),
+       py::arg("num_threads")=4,
+       py::arg("operator_export_type")=::torch::onnx::OperatorExportTypes::ONNX)
     .def("prettyPrintExport", [](const std::shared_ptr<Graph> g,
           const std::vector<at::Tensor>& initializers,
           int64_t onnx_opset_version, bool defer_weight_export,
@@ -468,6 +479,9 @@ void initPythonIRBindings(PyObject * module_) {
     .def("contiguous",[](Type& t) {
       return std::static_pointer_cast<Type>(t.expect<CompleteTensorType>()->contiguous());
     })
+    .def("dim",[](Type& t) {
+      return t.expect<TensorType>()->dim();
+    })
     .def("scalarType",[](Type& t) {
       return at::toString(t.expect<TensorType>()->scalarType());
     })
@@ -291,6 +291,38 @@ RegisterOperators reg({
             return 0;
           };
         }),
+    Operator(
+        prim::AllocateArena,
+        [](Node* node) {
+          int64_t size = node->i(attr::size);
+          auto options = at::TensorOptions().dtype(
+              static_cast<at::ScalarType>(node->i(attr::dtype)));
+          int64_t device = node->i(attr::device);
+          if (device >= 0) {
+            options = options.device({at::kCUDA, static_cast<int32_t>(device)});
+          }
+          return [=](Stack& stack) {
+            autograd::profiler::RecordFunction record("AllocateArena");
+            push(stack, autograd::make_variable(at::empty({size}, options)));
+            return 0;
+          };
+        }),
+    Operator(
+        prim::ArenaSlot,
+        [](Node* node) {
+          auto sizes = node->is(attr::sizes);
+          auto strides = node->is(attr::stride);
+          int64_t offset = node->i(attr::offset);
+          return [=](Stack& stack) {
+            at::Tensor arena;
+            pop(stack, arena);
+            // The slot is not a view of the arena as far as autograd is
+            // concerned; nothing in a planned graph requires grad.
+            auto data = autograd::as_variable_ref(arena).data();
+            push(stack, autograd::make_variable(data.as_strided(sizes, strides, offset)));
+            return 0;
+          };
+        }),
     Operator(
         onnx::Reshape,
         [](Node* node) {
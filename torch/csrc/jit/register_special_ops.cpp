@@ -6,6 +6,21 @@ namespace torch {
 namespace jit {
 
 namespace {
+
+// The out= overloads below exist for the memory planning pass, which hands each
+// of them a slot of a shared arena that already has the output's shape.
+// Resizing such a slot would reallocate the storage of every other slot, so
+// unlike their eager counterparts these refuse to resize out.
+template <typename F>
+void runIntoSlot(const at::Tensor& out, F&& op) {
+  auto data = out.data_ptr();
+  op();
+  AT_CHECK(
+      out.data_ptr() == data,
+      "an out= argument was resized; the memory plan does not match the "
+      "shapes this graph was run with");
+}
+
 RegisterOperators reg({
     Operator(
         "aten::split(Tensor self, int[] split_sizes, int dim=0) -> Tensor[]",
@@ -24,6 +39,114 @@ RegisterOperators reg({
         [](Stack& stack) {
           return 0;
         }),
+    Operator(
+        "aten::add(Tensor self, Tensor other, *, Scalar alpha, Tensor out) -> Tensor",
+        [](Stack& stack) {
+          autograd::profiler::RecordFunction record("add_out");
+          auto out = peek(stack, 3, 4).toTensor();
+          runIntoSlot(out, [&] {
+            at::add_out(out, peek(stack, 0, 4).toTensor(), peek(stack, 1, 4).toTensor(), peek(stack, 2, 4).toScalar());
+          });
+          drop(stack, 4);
+          pack(stack, std::move(out));
+          return 0;
+        }),
+    Operator(
+        "aten::sub(Tensor self, Tensor other, *, Scalar alpha, Tensor out) -> Tensor",
+        [](Stack& stack) {
+          autograd::profiler::RecordFunction record("sub_out");
+          auto out = peek(stack, 3, 4).toTensor();
+          runIntoSlot(out, [&] {
+            at::sub_out(out, peek(stack, 0, 4).toTensor(), peek(stack, 1, 4).toTensor(), peek(stack, 2, 4).toScalar());
+          });
+          drop(stack, 4);
+          pack(stack, std::move(out));
+          return 0;
+        }),
+    Operator(
+        "aten::mul(Tensor self, Tensor other, *, Tensor out) -> Tensor",
+        [](Stack& stack) {
+          autograd::profiler::RecordFunction record("mul_out");
+          auto out = peek(stack, 2, 3).toTensor();
+          runIntoSlot(out, [&] {
+            at::mul_out(out, peek(stack, 0, 3).toTensor(), peek(stack, 1, 3).toTensor());
+          });
+          drop(stack, 3);
+          pack(stack, std::move(out));
+          return 0;
+        }),
+    Operator(
+        "aten::div(Tensor self, Tensor other, *, Tensor out) -> Tensor",
+        [](Stack& stack) {
+          autograd::profiler::RecordFunction record("div_out");
+          auto out = peek(stack, 2, 3).toTensor();
+          runIntoSlot(out, [&] {
+            at::div_out(out, peek(stack, 0, 3).toTensor(), peek(stack, 1, 3).toTensor());
+          });
+          drop(stack, 3);
+          pack(stack, std::move(out));
+          return 0;
+        }),
+    Operator(
+        "aten::mm(Tensor self, Tensor mat2, *, Tensor out) -> Tensor",
+        [](Stack& stack) {
+          autograd::profiler::RecordFunction record("mm_out");
+          auto out = peek(stack, 2, 3).toTensor();
+          runIntoSlot(out, [&] {
+            at::mm_out(out, peek(stack, 0, 3).toTensor(), peek(stack, 1, 3).toTensor());
+          });
+          drop(stack, 3);
+          pack(stack, std::move(out));
+          return 0;
+        }),
+    Operator(
+        "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha, Tensor out) -> Tensor",
+        [](Stack& stack) {
+          autograd::profiler::RecordFunction record("addmm_out");
+          auto out = peek(stack, 5, 6).toTensor();
+          runIntoSlot(out, [&] {
+            at::addmm_out(out, peek(stack, 0, 6).toTensor(), peek(stack, 1, 6).toTensor(), peek(stack, 2, 6).toTensor(), peek(stack, 3, 6).toScalar(), peek(stack, 4, 6).toScalar());
+          });
+          drop(stack, 6);
+          pack(stack, std::move(out));
+          return 0;
+        }),
+    Operator(
+        "aten::sigmoid(Tensor self, *, Tensor out) -> Tensor",
+        [](Stack& stack) {
+          autograd::profiler::RecordFunction record("sigmoid_out");
+          auto out = peek(stack, 1, 2).toTensor();
+          runIntoSlot(out, [&] {
+            at::sigmoid_out(out, peek(stack, 0, 2).toTensor());
+          });
+          drop(stack, 2);
+          pack(stack, std::move(out));
+          return 0;
+        }),
+    Operator(
+        "aten::tanh(Tensor self, *, Tensor out) -> Tensor",
+        [](Stack& stack) {
+          autograd::profiler::RecordFunction record("tanh_out");
+          auto out = peek(stack, 1, 2).toTensor();
+          runIntoSlot(out, [&] {
+            at::tanh_out(out, peek(stack, 0, 2).toTensor());
+          });
+          drop(stack, 2);
+          pack(stack, std::move(out));
+          return 0;
+        }),
+    Operator(
+        "aten::exp(Tensor self, *, Tensor out) -> Tensor",
+        [](Stack& stack) {
+          autograd::profiler::RecordFunction record("exp_out");
+          auto out = peek(stack, 1, 2).toTensor();
+          runIntoSlot(out, [&] {
+            at::exp_out(out, peek(stack, 0, 2).toTensor());
+          });
+          drop(stack, 2);
+          pack(stack, std::move(out));
+          return 0;
+        }),
 });
 }
 } // namespace jit
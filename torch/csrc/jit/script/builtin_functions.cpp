@@ -32,33 +32,41 @@ struct BuiltinFunctionRegistry {
 
   const std::vector<Method*>& getAllBuiltinFunctionsFor(Symbol name) {
     const static std::vector<Method*> empty;
-    // when initializing the builtin function library, we will re-enter
-    // getAllBuiltinFunctionsFor since it is called in the compiler to
-    // lookup builtins and initializing the builtin functions calls the compiler.
-    // To avoid deadlocking, we use a recursive mutex (same thread can re-lock,
-    // the mutex without waiting), and report no loaded builtins during init.
+    // The builtin function library is parsed the first time any builtin is
+    // looked up, but each builtin is only compiled the first time it is looked
+    // up itself. Compiling a builtin calls the compiler, which looks up the
+    // builtins for the ops it uses, including the op the builtin is named
+    // after (e.g. mul is defined with *). To avoid deadlocking, we use a
+    // recursive mutex (same thread can re-lock, the mutex without waiting),
+    // and report no builtins for a name while those are being compiled.
     std::lock_guard<std::recursive_mutex> guard(mutex);
-    if(state == INTIIALIZING) {
-      return empty;
-    } else if (state == UNINITIALIZED) {
-      state = INTIIALIZING;
+    if (!loaded) {
       loadBuiltinFunctions();
-      state = INITIALIZED;
+      loaded = true;
     }
-    JIT_ASSERT(state == INITIALIZED);
     auto it = builtins_by_name.find(name);
     if(it == builtins_by_name.end())
       return empty;
-    return it->second;
+    Builtins& builtins = it->second;
+    if (builtins.state == DEFINING) {
+      return empty;
+    } else if (builtins.state == UNDEFINED) {
+      builtins.state = DEFINING;
+      for (Method* method : builtins.methods) {
+        method->ensure_defined();
+      }
+      builtins.state = DEFINED;
+    }
+    return builtins.methods;
   }
 private:
   void loadSource(const std::string& source) {
     auto module = std::make_shared<script::Module>();
     defineMethodsInModule(
-        *module, source, script::nativeResolver, /*self=*/nullptr);
+        *module, source, script::nativeResolver, /*self=*/nullptr, /*lazy=*/true);
     modules.push_back(module);
     for (auto& method : module->get_methods()) {
-      builtins_by_name[Symbol::fromQualString("aten::" + method.key)].push_back(
+      builtins_by_name[Symbol::fromQualString("aten::" + method.key)].methods.push_back(
           method.value.get());
     }
   }
@@ -69,10 +77,15 @@ private:
       loadSource(scalar_operators_source.format(env));
     }
   }
-  enum {UNINITIALIZED, INTIIALIZING, INITIALIZED} state = UNINITIALIZED;
+  enum State {UNDEFINED, DEFINING, DEFINED};
+  struct Builtins {
+    std::vector<Method*> methods;
+    State state = UNDEFINED;
+  };
+  bool loaded = false;
   std::recursive_mutex mutex;
   std::vector<std::shared_ptr<Module>> modules;
-  std::unordered_map<Symbol, std::vector<Method*>> builtins_by_name;
+  std::unordered_map<Symbol, Builtins> builtins_by_name;
 };
 
 TORCH_API const std::vector<Method*>& getAllBuiltinFunctionsFor(Symbol name) {
@@ -15,6 +15,7 @@
 
 #include "c10/util/Optional.h"
 
+#include <atomic>
 #include <climits>
 #include <set>
 
@@ -737,7 +738,6 @@ Value* emitBuiltinCall(
 
 
   const auto& variants = getAllOperatorsFor(name);
-  const auto& builtin_functions = getAllBuiltinFunctionsFor(name);
 
   std::stringstream failure_messages;
   //first we try to match the schema without any conversion
@@ -760,7 +760,8 @@ Value* emitBuiltinCall(
         return emitBuiltinNode(*matched_schema, loc, graph, name);
       }
     }
-    for (Method* method : builtin_functions) {
+    // looked up only when no operator matches, because that compiles them
+    for (Method* method : getAllBuiltinFunctionsFor(name)) {
       if (auto result = try_emit_call_to(
               graph,
               loc,
@@ -1901,11 +1902,12 @@ std::vector<Value*> inlineCallTo(Graph& g, Graph& callee, ArrayRef<Value*> input
   return outputs;
 }
 
-void defineMethodsInModule(Module & m, const std::vector<Def>& definitions, const std::vector<Resolver>& resolvers, SugaredValuePtr self) {
+void defineMethodsInModule(Module & m, const std::vector<Def>& definitions, const std::vector<Resolver>& resolvers, SugaredValuePtr self, bool lazy) {
   JIT_ASSERT(definitions.size() == resolvers.size());
   auto resolver_it = resolvers.begin();
   std::vector<Method*> methods;
-  std::unordered_map<std::string, Method*> function_table;
+  // shared with the resolvers, which outlive this call if lazy is set
+  auto function_table = std::make_shared<std::unordered_map<std::string, Method*>>();
   for(Def def : definitions) {
     const std::string& name = def.name().name();
     auto resolver = *resolver_it++;
@@ -1914,12 +1916,12 @@ void defineMethodsInModule(Module & m, const std::vector<Def>& definitions, cons
       // if self is defined, then these are methods and do not go into the global namespace
       // otherwise, they get defined together so we add them to the function table
       // so the methods can see each other
-      resolver = [resolver, &function_table](
+      resolver = [resolver, function_table](
                      const std::string& name,
                      Method& m,
                      const SourceRange& loc) -> std::shared_ptr<SugaredValue> {
-        auto it = function_table.find(name);
-        if (it != function_table.end()) {
+        auto it = function_table->find(name);
+        if (it != function_table->end()) {
           return std::make_shared<MethodValue>(nullptr, *it->second);
         }
         return resolver(name, m, loc);
@@ -1930,9 +1932,12 @@ void defineMethodsInModule(Module & m, const std::vector<Def>& definitions, cons
       to_ir(def, resolver, self,  method);
     };
     Method& method = m.create_method(name, creator);
-    function_table[name] = &method;
+    (*function_table)[name] = &method;
     methods.push_back(&method);
   }
+  if(lazy) {
+    return;
+  }
   for(Method* method : methods) {
     method->ensure_defined();
   }
@@ -2054,7 +2059,7 @@ FunctionSchema extractSchemaFromDef(const Def &def, bool is_method) {
     return FunctionSchema(name, args, returns, false, is_varret);
 }
 
-void defineMethodsInModule(Module & m, const std::string& source, Resolver resolver, SugaredValuePtr self) {
+void defineMethodsInModule(Module & m, const std::string& source, Resolver resolver, SugaredValuePtr self, bool lazy) {
   Parser p(source);
   std::vector<Def> definitions;
   std::vector<Resolver> resolvers;
@@ -2063,7 +2068,21 @@ void defineMethodsInModule(Module & m, const std::string& source, Resolver resol
     definitions.push_back(def);
     resolvers.push_back(resolver);
   }
-  defineMethodsInModule(m, definitions, resolvers, self);
+  defineMethodsInModule(m, definitions, resolvers, self, lazy);
+}
+
+namespace detail {
+
+std::atomic<bool> lazy_method_compilation {false};
+
+} // namespace detail
+
+bool getLazyMethodCompilation() {
+  return detail::lazy_method_compilation.load();
+}
+
+void setLazyMethodCompilation(bool lazy) {
+  detail::lazy_method_compilation.store(lazy);
 }
 
 std::shared_ptr<Graph> compileFunction(Def def, Resolver resolver) {
@@ -155,11 +155,18 @@ TORCH_API void defineMethodsInModule(
   Module & m,
   const std::vector<Def>& definitions,
   const std::vector<Resolver>& resolvers, /* determines how we handle free variables in each definition*/
-  std::shared_ptr<SugaredValue> self /* if non-null, the first argument to each def, is bound to this value */
+  std::shared_ptr<SugaredValue> self, /* if non-null, the first argument to each def, is bound to this value */
+  bool lazy = false /* if true, each method is only compiled when it is first used (see Module::get_method),
+                       so compilation errors are reported then, and methods that are never used cost nothing */
 );
 
 // same as above but parse the definitions from source
-TORCH_API void defineMethodsInModule(Module & m, const std::string& source, Resolver resolver, std::shared_ptr<SugaredValue> self);
+TORCH_API void defineMethodsInModule(Module & m, const std::string& source, Resolver resolver, std::shared_ptr<SugaredValue> self, bool lazy = false);
+
+// Whether the methods of ScriptModules defined from Python are compiled
+// lazily. Off by default, because it delays compilation errors.
+TORCH_API bool getLazyMethodCompilation();
+TORCH_API void setLazyMethodCompilation(bool lazy);
 TORCH_API std::shared_ptr<Graph> compileFunction(Def def, Resolver resolver);
 
 // pack outputs of a function following python rules. If there is a single value return
@@ -247,6 +247,45 @@ struct ModuleValue : public SugaredValue {
   std::shared_ptr<Module> module;
 };
 
+// self for methods that are compiled lazily. Those methods are owned by the
+// module, so holding on to it here would keep it alive until they are compiled.
+struct WeakModuleValue : public SugaredValue {
+  WeakModuleValue(std::weak_ptr<Module> module)
+  : module(std::move(module)) {}
+
+  virtual std::string kind() const override {
+    return "module";
+  }
+  virtual std::shared_ptr<SugaredValue> attr(SourceRange loc, Method & m, const std::string& field) override {
+    return strong()->attr(loc, m, field);
+  }
+  virtual std::shared_ptr<SugaredValue> call(SourceRange loc, Method & caller, at::ArrayRef<NamedValue> inputs, at::ArrayRef<NamedValue> attributes, size_t n_binders) override {
+    return strong()->call(loc, caller, inputs, attributes, n_binders);
+  }
+  virtual std::vector<std::shared_ptr<SugaredValue>> asTuple(
+      SourceRange loc,
+      Method& m,
+      c10::optional<size_t> size_hint = {}) override {
+    return strong()->asTuple(loc, m, size_hint);
+  }
+
+ private:
+  std::shared_ptr<ModuleValue> strong() const {
+    auto m = module.lock();
+    // the method being compiled belongs to the module
+    JIT_ASSERT(m);
+    return std::make_shared<ModuleValue>(std::move(m));
+  }
+  std::weak_ptr<Module> module;
+};
+
+static std::shared_ptr<SugaredValue> selfValue(const std::shared_ptr<Module>& m, bool lazy) {
+  if (lazy) {
+    return std::make_shared<WeakModuleValue>(m);
+  }
+  return std::make_shared<ModuleValue>(m);
+}
+
 std::shared_ptr<SugaredValue> toSugaredValue(
     py::object obj,
     Method& m,
@@ -404,14 +443,25 @@ void initJitScriptBindings(PyObject* module) {
           m->save(buf);
           return py::bytes(buf.str());
       })
+      .def("save_for_inference", [](std::shared_ptr<Module> m, const std::string& filename, py::tuple example_inputs) {
+          auto& forward = m->get_method("forward");
+          m->save_for_inference(filename, createStackForSchema(forward.getSchema(), std::move(example_inputs)));
+      })
+      .def("save_for_inference_to_buffer", [](std::shared_ptr<Module> m, py::tuple example_inputs) {
+          auto& forward = m->get_method("forward");
+          std::ostringstream buf;
+          m->save_for_inference(buf, createStackForSchema(forward.getSchema(), std::move(example_inputs)));
+          return py::bytes(buf.str());
+      })
       .def("_set_optimized", &Module::set_optimized)
       .def(
           "_define",
           [](std::shared_ptr<Module> m,
              const std::string& script,
              ResolutionCallback rcb, bool has_self) {
-            auto self = has_self ? std::make_shared<ModuleValue>(m) : nullptr;
-            return defineMethodsInModule(*m, script, pythonResolver(rcb), self);
+            bool lazy = getLazyMethodCompilation();
+            auto self = has_self ? selfValue(m, lazy) : nullptr;
+            return defineMethodsInModule(*m, script, pythonResolver(rcb), self, lazy);
           })
       .def("_create_methods", [](std::shared_ptr<Module> m,
           const std::vector<Def>& defs,
@@ -421,19 +471,24 @@ void initJitScriptBindings(PyObject* module) {
         for(auto & callback : rcbs) {
           resolvers.push_back(pythonResolver(callback));
         }
+        bool lazy = getLazyMethodCompilation();
         defineMethodsInModule(
           *m,
           defs,
           resolvers,
-          std::make_shared<ModuleValue>(m));
+          selfValue(m, lazy),
+          lazy);
 
-        // Stitch in default arguments for each Def if provided
+        // Stitch in default arguments for each Def if provided. This needs
+        // the compiled schema, so methods with defaults are never lazy.
         auto defaults_it = defaults.begin();
         auto defs_it = defs.begin();
         while (defs_it != defs.end()) {
-          auto& method = m->get_method((*defs_it).name().name());
-          method.setSchema(getSchemaWithDefaults(
-              *defaults_it, method.getSchema(), *defs_it));
+          if (!defaults_it->empty()) {
+            auto& method = m->get_method((*defs_it).name().name());
+            method.setSchema(getSchemaWithDefaults(
+                *defaults_it, method.getSchema(), *defs_it));
+          }
           ++defs_it;
           ++defaults_it;
         }
@@ -584,6 +639,9 @@ void initJitScriptBindings(PyObject* module) {
     .def("debug_disable_autodiff_subgraph_inlining", &Method::debugDisableAutodiffSubgraphInlining)
     .def("pretty_print_schema", &Method::pretty_print_schema);
 
+  m.def("_jit_get_lazy_method_compilation", &getLazyMethodCompilation);
+  m.def("_jit_set_lazy_method_compilation", &setLazyMethodCompilation);
+
   m.def("_jit_script_compile", [](const Def &def, ResolutionCallback rcb) {
     return compileFunction(def, pythonResolver(rcb));
   });
@@ -94,7 +94,23 @@ void Method::ensure_defined() {
   if(method_creator) {
     auto creator = method_creator;
     method_creator = placeholderCreator;
-    creator(*this);
+    try {
+      creator(*this);
+    } catch (RecursiveMethodCallError&) {
+      // creator was placeholderCreator, this method is being defined
+      // further up the stack
+      method_creator = creator;
+      throw;
+    } catch (...) {
+      // start over the next time this method is used, so that a method that
+      // is defined lazily reports the same error instead of a recursive call
+      graph_ = std::make_shared<Graph>();
+      member_inputs.clear();
+      member_input_index.clear();
+      schema.reset();
+      method_creator = creator;
+      throw;
+    }
     method_creator = nullptr;
   }
 }
@@ -119,6 +135,14 @@ void Module::save(const std::string& filename) {
   ExportModule(*this, filename);
 }
 
+void Module::save_for_inference(std::ostream& out, const Stack& example_inputs) {
+  ExportModuleForInference(*this, out, example_inputs);
+}
+
+void Module::save_for_inference(const std::string& filename, const Stack& example_inputs) {
+  ExportModuleForInference(*this, filename, example_inputs);
+}
+
 void Module::to_impl(
     c10::optional<at::Device> device,
     c10::optional<at::ScalarType> dtype,
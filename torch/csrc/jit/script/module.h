@@ -2,6 +2,7 @@
 #include "torch/csrc/jit/ir.h"
 #include "torch/csrc/jit/graph_executor.h"
 #include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/jit/passes/shape_analysis.h"
 #include "torch/csrc/jit/argument_spec.h"
 #include "torch/csrc/jit/function_schema.h"
@@ -74,6 +75,17 @@ struct Method {
   std::shared_ptr<Graph> graph_for(const Stack& inputs) {
     return get_executor().graphFor(inputs);
   }
+
+  // The fully optimized graph this method runs for inputs like these when
+  // gradients are disabled, compiling it if necessary. Like graph(), its
+  // trailing inputs are the members of this method.
+  std::shared_ptr<Graph> graph_for_inference(Stack inputs) {
+    autograd::AutoGradMode no_grad(false);
+    for(at::Tensor* tp : member_inputs) {
+      inputs.push_back(*tp);
+    }
+    return get_executor().optimizedGraphFor(inputs);
+  }
   std::shared_ptr<Graph> graph() const {
     return graph_;
   }
@@ -330,9 +342,15 @@ struct Module {
   }
 
   // each module owns its method. The reference returned here
-  // is guarenteed to stay valid until this module has been destroyed
+  // is guarenteed to stay valid until this module has been destroyed.
+  // Methods that were defined lazily are compiled here (which, like defining
+  // methods, must not race with other uses of the module); find_method
+  // doesn't do that, because the compiler uses it while methods are being
+  // defined.
   Method& get_method(const std::string& name) const {
-    return *methods.get(name);
+    Method& method = *methods.get(name);
+    method.ensure_defined();
+    return method;
   }
 
   std::shared_ptr<Module> get_module(const std::string& name) const {
@@ -411,6 +429,14 @@ struct Module {
 
   void save(const std::string& filename);
 
+  /// Saves the module with `forward` already optimized for running
+  /// `example_inputs`, or inputs of the same ranks, types and devices, without
+  /// gradients. When loaded, `forward` runs that graph as is instead of going
+  /// through the optimization pipeline on its first call(s).
+  void save_for_inference(std::ostream& out, const Stack& example_inputs);
+
+  void save_for_inference(const std::string& filename, const Stack& example_inputs);
+
  private:
    void to_impl(
        at::optional<at::Device> device,
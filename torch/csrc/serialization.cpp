@@ -31,11 +31,43 @@ ssize_t doPartialRead<PyObject*>(PyObject* fildes, void* buf, size_t nbytes) {
   return doPartialPythonReadBuffered(fildes, buf, nbytes);
 }
 
+template <>
+ssize_t doPartialRead<THPFileAt*>(THPFileAt* file, void* buf, size_t nbytes) {
+#ifdef _WIN32
+  if (lseek(file->fd, file->offset, SEEK_SET) == -1) {
+    return -1;
+  }
+  ssize_t r = read(file->fd, buf, nbytes);
+#else
+  ssize_t r = pread(file->fd, buf, nbytes, file->offset);
+#endif
+  if (r > 0) {
+    file->offset += r;
+  }
+  return r;
+}
+
 template <>
 ssize_t doPartialWrite<int>(int fildes, void* buf, size_t nbytes) {
   return write(fildes, buf, nbytes);
 }
 
+template <>
+ssize_t doPartialWrite<THPFileAt*>(THPFileAt* file, void* buf, size_t nbytes) {
+#ifdef _WIN32
+  if (lseek(file->fd, file->offset, SEEK_SET) == -1) {
+    return -1;
+  }
+  ssize_t r = write(file->fd, buf, nbytes);
+#else
+  ssize_t r = pwrite(file->fd, buf, nbytes, file->offset);
+#endif
+  if (r > 0) {
+    file->offset += r;
+  }
+  return r;
+}
+
 template <>
 ssize_t doPartialWrite<PyObject*>(PyObject* fildes, void* buf, size_t nbytes) {
   return doPartialPythonWrite(fildes, buf, nbytes);
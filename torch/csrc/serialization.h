@@ -1,6 +1,22 @@
 #ifndef THP_SERIALIZATION_INC
 #define THP_SERIALIZATION_INC
 
+#include <cstdint>
+#include <ostream>
+
+// A file descriptor read or written from an offset, which advances with the
+// data. Unlike read and write on the descriptor, this leaves the position of
+// the file alone, so that several threads can read or write the storages of
+// a checkpoint at once.
+struct THPFileAt {
+  int fd;
+  int64_t offset;
+};
+
+inline std::ostream& operator<<(std::ostream& out, const THPFileAt* file) {
+  return out << file->fd;
+}
+
 #include "generic/serialization.h"
 #include <TH/THGenerateAllTypes.h>
 
@@ -273,6 +273,7 @@ FunctionSignature::FunctionSignature(const std::string& fmt)
   , max_pos_args(0)
   , hidden(false)
   , deprecated(false)
+  , allow_varargs_intlist(false)
 {
   auto open_paren = fmt.find('(');
   if (open_paren == std::string::npos) {
@@ -331,6 +332,12 @@ FunctionSignature::FunctionSignature(const std::string& fmt)
       max_pos_args++;
     }
   }
+
+  // if there is a single positional IntList argument, i.e. expand(..), view(...),
+  // allow a var-args style IntList, so expand(5,3) behaves as expand((5,3))
+  if (max_pos_args == 1 && params[0].type_ == ParameterType::INT_LIST) {
+    allow_varargs_intlist = true;
+  }
 }
 
 std::string FunctionSignature::toString() const {
@@ -430,13 +437,6 @@ bool FunctionSignature::parse(PyObject* args, PyObject* kwargs, PyObject* dst[],
   auto nargs = PyTuple_GET_SIZE(args);
   ssize_t remaining_kwargs = kwargs ? PyDict_Size(kwargs) : 0;
   ssize_t arg_pos = 0;
-  bool allow_varargs_intlist = false;
-
-  // if there is a single positional IntList argument, i.e. expand(..), view(...),
-  // allow a var-args style IntList, so expand(5,3) behaves as expand((5,3))
-  if (max_pos_args == 1 && params[0].type_ == ParameterType::INT_LIST) {
-    allow_varargs_intlist = true;
-  }
 
   if (nargs > max_pos_args && !allow_varargs_intlist) {
     if (raise_exception) {
@@ -446,6 +446,15 @@ bool FunctionSignature::parse(PyObject* args, PyObject* kwargs, PyObject* dst[],
     return false;
   }
 
+  // Every argument binds to a distinct parameter, so overloads that take
+  // fewer or more arguments than given are rejected before any type check.
+  // The error messages come from the full parse below.
+  if (!raise_exception &&
+      (nargs + remaining_kwargs < min_args ||
+       (nargs + remaining_kwargs > max_args && !allow_varargs_intlist))) {
+    return false;
+  }
+
   int i = 0;
   for (auto& param : params) {
     PyObject* obj = nullptr;
@@ -460,7 +469,11 @@ bool FunctionSignature::parse(PyObject* args, PyObject* kwargs, PyObject* dst[],
       }
       obj = PyTuple_GET_ITEM(args, arg_pos);
     } else if (kwargs) {
-      obj = PyDict_GetItem(kwargs, param.python_name);
+      // No lookup once every keyword argument is bound. python_name is
+      // interned, so the lookup only compares pointers when it hits.
+      if (remaining_kwargs > 0) {
+        obj = PyDict_GetItem(kwargs, param.python_name);
+      }
       is_kwd = true;
     }
 
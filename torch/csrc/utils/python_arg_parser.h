@@ -154,6 +154,7 @@ struct FunctionSignature {
   ssize_t max_pos_args;
   bool hidden;
   bool deprecated;
+  bool allow_varargs_intlist;
 };
 
 struct FunctionParameter {
@@ -12,53 +12,96 @@ using namespace at;
 namespace torch { namespace utils {
 
 struct StridedData {
-  StridedData(const Tensor & tensor)
+  StridedData() = default;
+  StridedData(const Tensor & tensor, IntList strides)
     : data(tensor.data_ptr())
-    , strides(tensor.strides())
+    , strides(strides)
     , elementSize(tensor.type().elementSizeInBytes()) {}
 
-  void* data;
+  void* data = nullptr;
   IntList strides;
-  int64_t elementSize;
+  int64_t elementSize = 0;
 
   void step(int dim) {
     data = (char*)data + (strides[dim] * elementSize);
   }
 };
 
+template<size_t N>
+static void apply_fn(ScalarType scalarType, PyObject* fn, THPObjectPtr& args,
+                     const std::array<StridedData, N>& strided_data) {
+  // The arguments tuple is reused unless fn kept a reference to it
+  if (!args || Py_REFCNT(args.get()) != 1) {
+    args = PyTuple_New(N);
+    if (!args) throw python_error();
+  }
+  for (size_t i = 0; i < N; i++) {
+    PyObject* arg = load_scalar(strided_data[i].data, scalarType);
+    if (!arg) throw python_error();
+    PyObject* old_arg = PyTuple_GET_ITEM(args.get(), i);
+    PyTuple_SET_ITEM(args.get(), i, arg);
+    Py_XDECREF(old_arg);
+  }
+  auto ret = THPObjectPtr(PyObject_CallObject(fn, args.get()));
+  if (!ret) throw python_error();
+  store_scalar(strided_data[0].data, scalarType, ret.get());
+}
+
 template<size_t N>
 static void recursive_apply(IntList sizes, ScalarType scalarType, int64_t dim,
-                            PyObject* fn, std::array<StridedData, N> strided_data) {
+                            PyObject* fn, THPObjectPtr& args,
+                            std::array<StridedData, N> strided_data) {
   int64_t ndim = sizes.size();
   if (dim == ndim) {
-    auto args = THPObjectPtr(PyTuple_New(N));
-    if (!args) throw python_error();
-    for (size_t i = 0; i < N; i++) {
-      PyObject* arg = load_scalar(strided_data[i].data, scalarType);
-      if (!arg) throw python_error();
-      PyTuple_SET_ITEM(args.get(), i, arg);
-    }
-    auto ret = THPObjectPtr(PyObject_CallObject(fn, args.get()));
-    if (!ret) throw python_error();
-    store_scalar(strided_data[0].data, scalarType, ret.get());
+    apply_fn(scalarType, fn, args, strided_data);
     return;
   }
 
   auto n = sizes[dim];
+  if (dim == ndim - 1) {
+    for (int64_t i = 0; i < n; i++) {
+      apply_fn(scalarType, fn, args, strided_data);
+      for (auto& td : strided_data) {
+        td.step(dim);
+      }
+    }
+    return;
+  }
   for (int64_t i = 0; i < n; i++) {
-    recursive_apply(sizes, scalarType, dim + 1, fn, strided_data);
+    recursive_apply(sizes, scalarType, dim + 1, fn, args, strided_data);
     for (auto& td : strided_data) {
       td.step(dim);
     }
   }
 }
 
+// Applies fn to the elements of the tensors, which have the same sizes. The
+// contiguous tensors are walked as one dimension.
+template<size_t N>
+static void apply(ScalarType scalarType, PyObject* fn,
+                  const std::array<Tensor, N>& tensors) {
+  THPObjectPtr args;
+  bool contiguous = true;
+  for (const auto& tensor : tensors) {
+    contiguous = contiguous && tensor.is_contiguous();
+  }
+  const int64_t numel = tensors[0].numel();
+  const int64_t unit_stride = 1;
+  std::array<StridedData, N> strided_data;
+  for (size_t i = 0; i < N; i++) {
+    strided_data[i] = StridedData(
+        tensors[i], contiguous ? IntList(unit_stride) : tensors[i].strides());
+  }
+  recursive_apply<N>(contiguous ? IntList(numel) : tensors[0].sizes(),
+                     scalarType, 0, fn, args, strided_data);
+}
+
 Tensor & apply_(Tensor & self, PyObject* fn) {
   if (self.type().backend() != Backend::CPU) {
     throw TypeError("apply_ is only implemented on CPU tensors");
   }
   auto scalarType = self.type().scalarType();
-  recursive_apply<1>(self.sizes(), scalarType, 0, fn, {{ self }});
+  apply<1>(scalarType, fn, {{ self }});
   return self;
 }
 
@@ -73,7 +116,7 @@ Tensor & map_(Tensor & self, const Tensor & other_, PyObject* fn) {
   Tensor other;
   std::tie(other) = expand_inplace(self, other_, "map_");
   auto scalarType = self.type().scalarType();
-  recursive_apply<2>(self.sizes(), scalarType, 0, fn, {{ self, other }});
+  apply<2>(scalarType, fn, {{ self, other }});
   return self;
 }
 
@@ -92,7 +135,7 @@ Tensor & map2_(Tensor & self, const Tensor & x_, const Tensor & y_, PyObject* fn
   Tensor other1, other2;
   std::tie(other1, other2) = expand_inplace(self, x_, y_, "map2_");
   auto scalarType = self.type().scalarType();
-  recursive_apply<3>(self.sizes(), scalarType, 0, fn, {{ self, other1, other2 }});
+  apply<3>(scalarType, fn, {{ self, other1, other2 }});
   return self;
 }
 
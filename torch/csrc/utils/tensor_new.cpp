@@ -21,7 +21,10 @@
 #include <c10/util/Exception.h>
 #include "c10/util/Optional.h"
 
+#include <cstring>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 using at::Backend;
@@ -150,14 +153,14 @@ ScalarType infer_scalar_type(PyObject *obj) {
   }
   if (PySequence_Check(obj)) {
     c10::optional<ScalarType> scalarType;
-    auto length = PySequence_Length(obj);
-    if (length < 0) throw python_error();
+    auto seq = THPObjectPtr(PySequence_Fast(obj, "not a sequence"));
+    if (!seq) throw python_error();
+    auto length = PySequence_Fast_GET_SIZE(seq.get());
     // match NumPy semantics, except use default tensor type instead of double.
     if (length == 0) return torch::tensors::get_default_tensor_type().scalarType();
-    for (int i = 0; i < length; ++i) {
-      THPObjectPtr handle(PySequence_GetItem(obj, i));
-      if (!handle) throw python_error();
-      auto cur_item = handle.get();
+    PyObject** items = PySequence_Fast_ITEMS(seq.get());
+    for (int64_t i = 0; i < length; ++i) {
+      auto cur_item = items[i];
       if (cur_item == obj) throw TypeError("new(): self-referential lists are incompatible");
       ScalarType item_scalarType = infer_scalar_type(cur_item);
       scalarType = (scalarType) ?
@@ -172,6 +175,47 @@ ScalarType infer_scalar_type(PyObject *obj) {
   AT_ERROR("Could not infer dtype of ", Py_TYPE(obj)->tp_name);
 }
 
+// Stores the innermost dimension of a nested sequence with a loop per dtype,
+// which converts the Python floats and ints directly
+template <typename T>
+void store_row(char* data, int64_t stride, ScalarType scalarType,
+               PyObject** items, int64_t n) {
+  for (int64_t i = 0; i < n; i++, data += stride) {
+    PyObject* item = items[i];
+    if (std::is_floating_point<T>::value && PyFloat_CheckExact(item)) {
+      *(T*)data = static_cast<T>(PyFloat_AS_DOUBLE(item));
+    } else if (std::is_integral<T>::value && PyLong_CheckExact(item)) {
+      *(T*)data = static_cast<T>(THPUtils_unpackLong(item));
+    } else {
+      torch::utils::store_scalar(data, scalarType, item);
+    }
+  }
+}
+
+void store_row(char* data, int64_t stride, ScalarType scalarType,
+               PyObject** items, int64_t n) {
+  switch (scalarType) {
+    case at::kByte:
+      return store_row<uint8_t>(data, stride, scalarType, items, n);
+    case at::kChar:
+      return store_row<int8_t>(data, stride, scalarType, items, n);
+    case at::kShort:
+      return store_row<int16_t>(data, stride, scalarType, items, n);
+    case at::kInt:
+      return store_row<int32_t>(data, stride, scalarType, items, n);
+    case at::kLong:
+      return store_row<int64_t>(data, stride, scalarType, items, n);
+    case at::kFloat:
+      return store_row<float>(data, stride, scalarType, items, n);
+    case at::kDouble:
+      return store_row<double>(data, stride, scalarType, items, n);
+    default:
+      for (int64_t i = 0; i < n; i++, data += stride) {
+        torch::utils::store_scalar(data, scalarType, items[i]);
+      }
+  }
+}
+
 void recursive_store(char* data, IntList sizes, IntList strides, int64_t dim,
                             ScalarType scalarType, int elementSize, PyObject* obj) {
   int64_t ndim = sizes.size();
@@ -190,12 +234,105 @@ void recursive_store(char* data, IntList sizes, IntList strides, int64_t dim,
   }
 
   PyObject** items = PySequence_Fast_ITEMS(seq.get());
+  if (dim == ndim - 1) {
+    store_row(data, strides[dim] * elementSize, scalarType, items, n);
+    return;
+  }
   for (int64_t i = 0; i < n; i++) {
     recursive_store(data, sizes, strides, dim + 1, scalarType, elementSize, items[i]);
     data += strides[dim] * elementSize;
   }
 }
 
+// Scalar type of the items of a buffer with a native struct format, e.g. of
+// an array.array or a memoryview
+c10::optional<ScalarType> buffer_scalar_type(const Py_buffer& view) {
+  const char* format = view.format ? view.format : "B";
+  if (format[0] == '@') {
+    format++;
+  }
+  if (format[0] == '\0' || format[1] != '\0') {
+    return c10::nullopt;
+  }
+  switch (format[0]) {
+    case '?':
+    case 'B': return ScalarType::Byte;
+    case 'b': return ScalarType::Char;
+    case 'h': return ScalarType::Short;
+    case 'i': return ScalarType::Int;
+    case 'l': return sizeof(long) == 8 ? ScalarType::Long : ScalarType::Int;
+    case 'q': return ScalarType::Long;
+    case 'e': return ScalarType::Half;
+    case 'f': return ScalarType::Float;
+    case 'd': return ScalarType::Double;
+  }
+  return c10::nullopt;
+}
+
+// Converts an object exporting a buffer of numbers with a single copy, rather
+// than item by item. Returns an undefined tensor for the other objects.
+Tensor new_from_buffer(
+    PyObject* data, ScalarType scalarType, bool type_inference) {
+  if (!PyObject_CheckBuffer(data)) {
+    return Tensor();
+  }
+#ifdef USE_NUMPY
+  // NumPy scalars infer their own dtype
+  if (PyArray_CheckScalar(data)) {
+    return Tensor();
+  }
+#endif
+  Py_buffer view;
+  if (PyObject_GetBuffer(data, &view, PyBUF_RECORDS_RO) == -1) {
+    PyErr_Clear();
+    return Tensor();
+  }
+  auto release = std::unique_ptr<Py_buffer, decltype(&PyBuffer_Release)>(
+      &view, &PyBuffer_Release);
+  auto buffer_type = buffer_scalar_type(view);
+  if (!buffer_type ||
+      view.itemsize != at::elementSize(*buffer_type) ||
+      view.ndim > MAX_DIMS) {
+    return Tensor();
+  }
+  std::vector<int64_t> sizes(view.shape, view.shape + view.ndim);
+  std::vector<int64_t> strides(view.ndim);
+  for (int i = 0; i < view.ndim; i++) {
+    if (view.strides[i] % view.itemsize != 0) {
+      return Tensor();
+    }
+    strides[i] = view.strides[i] / view.itemsize;
+  }
+  if (type_inference) {
+    // The items read as Python floats, ints or bools would infer
+    if (at::isFloatingType(*buffer_type)) {
+      scalarType = torch::tensors::get_default_tensor_type().scalarType();
+    } else if (view.format && strchr(view.format, '?')) {
+      scalarType = ScalarType::Byte;
+    } else {
+      scalarType = ScalarType::Long;
+    }
+  }
+  auto source = at::CPU(*buffer_type).tensorFromBlob(view.buf, sizes, strides);
+  auto tensor = at::empty(sizes, at::initialTensorOptions().dtype(scalarType));
+  {
+    AutoNoGIL no_gil;
+    tensor.copy_(source);
+  }
+  return tensor;
+}
+
+#ifdef USE_NUMPY
+bool has_negative_strides(PyArrayObject* array) {
+  for (int i = 0; i < PyArray_NDIM(array); i++) {
+    if (PyArray_STRIDES(array)[i] < 0) {
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
 Tensor internal_new_from_data(
     const Type& type,
     c10::optional<Device> device_opt,
@@ -227,6 +364,18 @@ Tensor internal_new_from_data(
 
 #ifdef USE_NUMPY
   if (PyArray_Check(data)) {
+    THPObjectPtr native_array;
+    auto array = (PyArrayObject*)data;
+    if (!PyArray_ISNOTSWAPPED(array) || !PyArray_ISALIGNED(array) ||
+        has_negative_strides(array)) {
+      // tensor_from_numpy only shares native arrays, but the data is copied
+      // anyway. NumPy converts the byte order and strides in bulk.
+      native_array = PyArray_FromAny(
+          data, PyArray_DescrFromType(PyArray_TYPE(array)), 0, 0,
+          NPY_ARRAY_CARRAY, nullptr);
+      if (!native_array) throw python_error();
+      data = native_array.get();
+    }
     auto tensor = autograd::make_variable(tensor_from_numpy(data), /*requires_grad=*/false);
     const auto& type_to_use = type_inference ? type.toScalarType(tensor.type().scalarType()) : type;
     return copy_numpy ? new_with_tensor_copy(type_to_use, tensor, device_index) :
@@ -234,14 +383,24 @@ Tensor internal_new_from_data(
   }
 #endif
 
-  auto sizes = compute_sizes(data);
-  ScalarType scalarType = type_inference ? infer_scalar_type(data) : type.scalarType();
-  auto tensor = autograd::make_variable(at::empty(sizes, at::initialTensorOptions().dtype(scalarType)), /*requires_grad=*/false);
-  recursive_store(
-      (char*)tensor.data_ptr(), tensor.sizes(), tensor.strides(), 0,
-      scalarType, tensor.type().elementSizeInBytes(), data);
+  ScalarType scalarType = type.scalarType();
+  auto tensor = new_from_buffer(data, scalarType, type_inference);
+  if (tensor.defined()) {
+    scalarType = tensor.type().scalarType();
+  } else {
+    auto sizes = compute_sizes(data);
+    if (type_inference) {
+      scalarType = infer_scalar_type(data);
+    }
+    tensor = at::empty(sizes, at::initialTensorOptions().dtype(scalarType));
+    recursive_store(
+        (char*)tensor.data_ptr(), tensor.sizes(), tensor.strides(), 0,
+        scalarType, tensor.type().elementSizeInBytes(), data);
+  }
   const auto& type_to_use = type_inference ? type.toScalarType(scalarType) : type;
-  return new_with_type_conversion(type_to_use, tensor, device_index);
+  return new_with_type_conversion(
+      type_to_use, autograd::make_variable(tensor, /*requires_grad=*/false),
+      device_index);
 }
 
 Tensor new_from_data_copy(
@@ -13,9 +13,10 @@ import platform
 import ctypes
 import os
 import torch
+import time
 import traceback
 import warnings
-from torch._six import raise_from
+from torch._six import raise_from, string_classes
 from subprocess import Popen, PIPE
 from multiprocessing.util import register_after_fork as _register_after_fork
 from ._utils import _get_device_index
@@ -159,12 +160,14 @@ def _lazy_init():
         raise RuntimeError(
             "Cannot re-initialize CUDA in forked subprocess. " + msg)
     _check_driver()
+    begin = time.time()
     torch._C._cuda_init()
     _cudart = _load_cudart()
     _cudart.cudaGetErrorName.restype = ctypes.c_char_p
     _cudart.cudaGetErrorString.restype = ctypes.c_char_p
     _original_pid = os.getpid()
     _initialized = True
+    torch._startup_phase('initialize CUDA', begin)
     # Important to do this after _initialized, since some queued calls
     # may themselves call _lazy_init()
     for queued_call, orig_traceback in _queued_calls:
@@ -444,6 +447,104 @@ def max_memory_cached(device=None):
     return torch._C._cuda_maxMemoryCached(device)
 
 
+def memory_snapshot():
+    r"""Returns a snapshot of the segments held by the caching allocator on
+    all devices.
+
+    Each segment is a block of memory obtained with ``cudaMalloc``, described
+    by a dict with its ``'device'``, ``'address'``, ``'total_size'`` and
+    ``'allocated_size'`` in bytes, the ``'stream'`` it is cached for, its
+    ``'segment_type'`` (``'small'`` for the 1 MB buffers small allocations are
+    carved from, ``'large'`` otherwise) and the list of ``'blocks'`` it is
+    split into, each a dict with a ``'size'``, a ``'state'`` of either
+    ``'allocated'`` or ``'free'`` and the C++ ``'backtrace'`` of allocated
+    blocks if :meth:`~torch.cuda.record_memory_history` was on when they were
+    allocated (an empty string otherwise). Segments are sorted by device and
+    address.
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    if not _initialized:
+        return []
+    return torch._C._cuda_memorySnapshot()
+
+
+def record_memory_history(enabled=True, max_entries=100000):
+    r"""Starts or stops recording the history of the caching allocator.
+
+    While enabled, every allocation and free, every ``cudaMalloc`` and
+    ``cudaFree`` of a segment and every out-of-memory error is recorded with
+    a C++ backtrace, keeping the last :attr:`max_entries` events, and the
+    backtrace of each allocation is shown in :meth:`~torch.cuda.memory_snapshot`.
+    Recording slows allocations down considerably. Enabling it clears the
+    previous history.
+
+    Arguments:
+        enabled (bool, optional): whether to record. Default: ``True``.
+        max_entries (int, optional): number of most recent events kept.
+            Default: 100000.
+    """
+    _lazy_init()
+    torch._C._cuda_recordMemoryHistory(max_entries if enabled else 0)
+
+
+def memory_trace():
+    r"""Returns the events recorded since :meth:`~torch.cuda.record_memory_history`
+    was enabled, oldest first.
+
+    Each event is a dict with an ``'action'`` (``'alloc'``, ``'free'``,
+    ``'segment_alloc'``, ``'segment_free'`` or ``'oom'``), the ``'device'``,
+    ``'address'``, ``'size'`` in bytes and ``'stream'`` involved, and the C++
+    ``'backtrace'`` where it happened.
+    """
+    if not _initialized:
+        return []
+    return torch._C._cuda_memoryTrace()
+
+
+def dump_memory_snapshot(f):
+    r"""Writes :meth:`~torch.cuda.memory_snapshot` and :meth:`~torch.cuda.memory_trace`
+    as a JSON object with ``'segments'`` and ``'trace'`` keys.
+
+    Arguments:
+        f: a file-like object or a string containing a file name
+    """
+    import json
+    snapshot = {'segments': memory_snapshot(), 'trace': memory_trace()}
+    if isinstance(f, string_classes):
+        with open(f, 'w') as fd:
+            json.dump(snapshot, fd)
+    else:
+        json.dump(snapshot, f)
+
+
+def set_max_split_size(size):
+    r"""Sets the size in bytes from which cached blocks are no longer split.
+
+    Blocks of at least this size are only reused for allocations of about
+    the same size, which keeps variable-sized large allocations from
+    fragmenting the cache. ``None`` removes the limit (the default, unless
+    the ``THC_CACHING_ALLOCATOR_MAX_SPLIT_SIZE_MB`` environment variable is
+    set). Sizes below 1 MB are rounded up to just above it.
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    _lazy_init()
+    torch._C._cuda_setMaxSplitSize(size)
+
+
+def max_split_size():
+    r"""Returns the size in bytes from which cached blocks are no longer split,
+    or ``None`` if there is no limit. See :meth:`~torch.cuda.set_max_split_size`.
+    """
+    _lazy_init()
+    return torch._C._cuda_maxSplitSize()
+
+
 def _host_allocator():
     _lazy_init()
     return torch._C._cuda_cudaHostAllocator()
@@ -73,8 +73,11 @@ def reduce_add(inputs, destination=None):
         raise RuntimeError("reduce_add expects destination to be on the same GPU with one of the tensors")
     result = inp.new(device=destination).resize_as_(inp).zero_()
 
-    if nccl.is_available(inputs) and inputs[0].get_device() == destination:
-        outputs = [result] + [t.new(t.size()) for t in inputs[1:]]
+    if nccl.is_available(inputs):
+        # Only the root receives the sum, so the other inputs are passed as
+        # their own outputs instead of allocating new buffers.
+        outputs = list(inputs)
+        outputs[nccl_root] = result
         nccl.reduce(inputs, outputs, root=nccl_root)
         return result
     for inp in inputs:
@@ -100,6 +103,8 @@ def reduce_add_coalesced(inputs, destination=None, buffer_size=10485760):
         A tuple of tensors containing an elementwise sum of each group of
         inputs, placed on the ``destination`` device.
     """
+    if destination is None:
+        destination = torch.cuda.current_device()
     dense_tensors = [[] for _ in inputs]  # shape (num_gpus, num_tensors)
     output = []
     ref_order = []
@@ -113,12 +118,9 @@ def reduce_add_coalesced(inputs, destination=None, buffer_size=10485760):
             for coll, t in zip(dense_tensors, tensor_at_gpus):
                 coll.append(t.to_dense() if t.is_sparse else t)
             ref_order.append(dense_tensors[0][-1])
-    itrs = [_take_tensors(tensors, buffer_size) for tensors in dense_tensors]
     # now the dense ones, which have consistent sizes
-    for chunks in zip(*itrs):
-        flat_tensors = [_flatten_dense_tensors(chunk) for chunk in chunks]
-        flat_result = reduce_add(flat_tensors, destination)
-        output.extend(_unflatten_dense_tensors(flat_result, chunks[0]))
+    if dense_tensors[0]:
+        output.extend(torch._C._reduce_add_coalesced(dense_tensors, destination, buffer_size))
     return tuple(_reorder_tensors_as(output, ref_order))
 
 
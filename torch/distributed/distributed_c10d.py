@@ -3,10 +3,11 @@ from torch._six import string_classes
 
 from .rendezvous import rendezvous, register_rendezvous_handler
 from . import BroadcastOptions, AllreduceOptions, ReduceOptions, \
-    ScatterOptions, GatherOptions
+    ScatterOptions, GatherOptions, ReduceScatterOptions
 from . import ReduceOp as reduce_op
 from . import PrefixStore
 from . import ProcessGroupGloo
+from . import ProcessGroupHierarchical
 
 
 _MPI_AVAILABLE = True
@@ -345,6 +346,91 @@ def _new_process_group_helper(world_size,
     return pg
 
 
+def _new_store_process_group(backend, store, rank, world_size):
+    if backend == DistBackend.GLOO:
+        return ProcessGroupGloo(store, rank, world_size)
+    elif backend == DistBackend.NCCL:
+        if not is_nccl_available():
+            raise RuntimeError("Distributed package doesn't have NCCL "
+                               "built in")
+        return ProcessGroupNCCL(store, rank, world_size)
+    else:
+        raise RuntimeError("Unsupported distributed backend by group")
+
+
+def new_hierarchical_group(local_size,
+                           intra_node_backend=DistBackend.NCCL,
+                           inter_node_backend=DistBackend.GLOO):
+    """
+    Creates a group over all processes whose allreduce is hierarchical: the
+    tensors are reduced within each node, allreduced across nodes by the
+    first process of every node, and broadcast back within each node. On
+    clusters whose nodes have a much faster interconnect than the network
+    (e.g. NVLink), only ``1 / local_size`` of the data crosses the network.
+
+    Processes are assumed to be numbered node by node, i.e. the processes of
+    node ``n`` have ranks ``n * local_size`` to ``(n + 1) * local_size - 1``.
+    The sub-groups rendezvous over the store of the default group, under a
+    :class:`PrefixStore` per group.
+
+    All processes of the default group must enter this function. Only
+    :func:`all_reduce` and :func:`barrier` are supported on the group, and
+    barrier only if neither backend is ``nccl``. ``group.stage_times()``
+    returns the number of runs and total seconds of every stage on this
+    process.
+
+    Arguments:
+        local_size (int): Number of processes per node.
+        intra_node_backend (str or DistBackend, optional): Backend of the
+            groups within nodes, it has to support reduce and broadcast.
+        inter_node_backend (str or DistBackend, optional): Backend of the
+            group between node leaders.
+
+    Returns:
+        A handle of distributed group that can be given to collective calls.
+    """
+    _check_default_pg()
+
+    global _group_count
+
+    default_backend, default_store = _pg_map[_default_pg]
+    if default_backend == DistBackend.MPI:
+        raise RuntimeError("Hierarchical groups need a default group with "
+                           "a store, which MPI doesn't have")
+    intra_node_backend = DistBackend(intra_node_backend)
+    inter_node_backend = DistBackend(inter_node_backend)
+
+    rank = _default_pg.rank()
+    world_size = _default_pg.size()
+    if local_size <= 0 or world_size % local_size != 0:
+        raise RuntimeError("The world size should be a multiple of the "
+                           "number of processes per node")
+
+    group_name = str(_group_count)
+    _group_count += 1
+    store = PrefixStore(group_name, default_store)
+
+    node = rank // local_size
+    intra_node_store = PrefixStore("intra_node/{}".format(node), store)
+    intra_node_pg = _new_store_process_group(intra_node_backend,
+                                             intra_node_store,
+                                             rank % local_size,
+                                             local_size)
+    inter_node_pg = None
+    if rank % local_size == 0:
+        inter_node_store = PrefixStore("inter_node", store)
+        inter_node_pg = _new_store_process_group(inter_node_backend,
+                                                 inter_node_store,
+                                                 node,
+                                                 world_size // local_size)
+
+    pg = ProcessGroupHierarchical(rank, world_size, intra_node_pg,
+                                  inter_node_pg)
+    _pg_map[pg] = (default_backend, store)
+    _pg_names[pg] = group_name
+    _pg_group_ranks[pg] = {r: r for r in range(world_size)}
+    return pg
+
 def destroy_process_group(group=group.WORLD):
     """
     Destroy a given process group, and deinitialize the distributed package
@@ -1046,6 +1132,89 @@ def scatter(tensor,
         work.wait()
 
 
+def reduce_scatter(output,
+                   input_list,
+                   op=reduce_op.SUM,
+                   group=group.WORLD,
+                   async_op=False):
+    """
+    Reduces, then scatters a list of tensors to all processes in a group.
+
+    Process ``i`` receives the reduction of the ``i``-th tensor of
+    ``input_list`` over all processes. This is equivalent to, and moves less
+    data than, ``all_reduce`` followed by each process keeping its own chunk.
+
+    Arguments:
+        output (Tensor): Output tensor.
+        input_list (list[Tensor]): List of tensors to reduce and scatter, one
+            per process in the group, each of the same size as ``output``.
+        op (optional): One of the values from
+            ``torch.distributed.ReduceOp``
+            enum.  Specifies an operation used for element-wise reductions.
+        group (ProcessGroup, optional): The process group to work on
+        async_op (bool, optional): Whether this op should be an async op
+
+    Returns:
+        Async work handle, if async_op is set to True.
+        None, if not async_op or if not part of the group.
+
+    """
+    if _rank_not_in_group(group):
+        return
+
+    opts = ReduceScatterOptions()
+    opts.reduceOp = op
+
+    if group == GroupMember.WORLD:
+        _check_default_pg()
+        work = _default_pg.reduce_scatter([output], [input_list], opts)
+    else:
+        work = group.reduce_scatter([output], [input_list], opts)
+
+    if async_op:
+        return work
+    else:
+        work.wait()
+
+
+def all_to_all(output_tensor_list,
+               input_tensor_list,
+               group=group.WORLD,
+               async_op=False):
+    """
+    Each process sends the ``i``-th tensor of ``input_tensor_list`` to process
+    ``i``, and receives the tensor process ``j`` sent it in the ``j``-th tensor
+    of ``output_tensor_list``.
+
+    Arguments:
+        output_tensor_list (list[Tensor]): List of tensors to receive into,
+            one per process in the group.
+        input_tensor_list (list[Tensor]): List of tensors to send, one per
+            process in the group.
+        group (ProcessGroup, optional): The process group to work on
+        async_op (bool, optional): Whether this op should be an async op
+
+    Returns:
+        Async work handle, if async_op is set to True.
+        None, if not async_op or if not part of the group.
+
+    .. note:: Not supported by the NCCL backend.
+
+    """
+    if _rank_not_in_group(group):
+        return
+
+    if group == GroupMember.WORLD:
+        _check_default_pg()
+        work = _default_pg.alltoall(output_tensor_list, input_tensor_list)
+    else:
+        work = group.alltoall(output_tensor_list, input_tensor_list)
+
+    if async_op:
+        return work
+    else:
+        work.wait()
+
 def barrier(group=group.WORLD,
             async_op=False):
     """
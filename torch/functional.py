@@ -11,6 +11,7 @@ __all__ = [
     'argsort',
     'btrifact',
     'btriunpack',
+    'cdist',
     'chain_matmul',
     'einsum',
     'broadcast_tensors',
@@ -23,6 +24,7 @@ __all__ = [
     'stft',
     'tensordot',
     'unique',
+    'unique_consecutive',
 ]
 
 
@@ -437,7 +439,7 @@ def isnan(tensor):
     return tensor != tensor
 
 
-def unique(input, sorted=False, return_inverse=False, dim=None):
+def unique(input, sorted=False, return_inverse=False, dim=None, return_counts=False):
     r"""Returns the unique scalar elements of the input tensor as a 1-D tensor.
 
     Arguments:
@@ -448,16 +450,22 @@ def unique(input, sorted=False, return_inverse=False, dim=None):
             elements in the original input ended up in the returned unique list.
         dim (int): the dimension to apply unique. If ``None``, the unique of the
             flattened input is returned. default: ``None``
+        return_counts (bool): Whether to also return the number of occurrences
+            of each unique element. Not supported with :attr:`dim`.
 
     Returns:
-        (Tensor, Tensor (optional)): A tensor or a tuple of tensors containing
+        (Tensor, Tensor (optional), Tensor (optional)): A tensor or a tuple of tensors containing
 
             - **output** (*Tensor*): the output list of unique scalar elements.
             - **inverse_indices** (*Tensor*): (optional) if
-              :attr:`return_inverse` is True, there will be a
-              2nd returned tensor (same shape as input) representing the indices
+              :attr:`return_inverse` is True, there will be an additional
+              returned tensor (same shape as input) representing the indices
               for where elements in the original input map to in the output;
               otherwise, this function will only return a single tensor.
+            - **counts** (*Tensor*): (optional) if :attr:`return_counts` is
+              True, there will be an additional returned tensor (same shape
+              as output) representing the number of occurrences of each
+              unique element.
 
     Example::
 
@@ -481,23 +489,86 @@ def unique(input, sorted=False, return_inverse=False, dim=None):
                 [ 1,  2]])
 
     """
+    counts = None
     if dim is not None:
+        if return_counts:
+            raise NotImplementedError("unique: return_counts is not supported with dim")
         output, inverse_indices = torch._unique_dim(
             input,
             dim,
             sorted=sorted,
             return_inverse=return_inverse
         )
+    elif return_counts:
+        output, inverse_indices, counts = torch._unique2(
+            input,
+            sorted=sorted,
+            return_inverse=return_inverse,
+            return_counts=return_counts,
+        )
     else:
         output, inverse_indices = torch._unique(
             input,
             sorted=sorted,
             return_inverse=return_inverse,
         )
-    if return_inverse:
-        return output, inverse_indices
-    else:
+    return _unique_outputs(output, inverse_indices, counts, return_inverse, return_counts)
+
+
+def unique_consecutive(input, return_inverse=False, return_counts=False):
+    r"""Eliminates all but the first element from every consecutive group of
+    equal elements of the flattened input tensor, without sorting it.
+
+    Arguments:
+        input (Tensor): the input tensor
+        return_inverse (bool): Whether to also return the indices for where
+            elements in the original input ended up in the returned list.
+        return_counts (bool): Whether to also return the number of elements
+            of each consecutive group.
+
+    Returns:
+        (Tensor, Tensor (optional), Tensor (optional)): A tensor or a tuple of tensors containing
+
+            - **output** (*Tensor*): the output list of elements.
+            - **inverse_indices** (*Tensor*): (optional) if
+              :attr:`return_inverse` is True, the indices (same shape as
+              input) for where elements in the original input map to in the
+              output.
+            - **counts** (*Tensor*): (optional) if :attr:`return_counts` is
+              True, the number of elements of each consecutive group.
+
+    Example::
+
+        >>> x = torch.tensor([1, 1, 2, 2, 3, 1, 1, 2])
+        >>> output = torch.unique_consecutive(x)
+        >>> output
+        tensor([1, 2, 3, 1, 2])
+
+        >>> output, inverse_indices, counts = torch.unique_consecutive(
+                x, return_inverse=True, return_counts=True)
+        >>> inverse_indices
+        tensor([0, 0, 1, 1, 2, 3, 3, 4])
+        >>> counts
+        tensor([2, 2, 1, 2, 1])
+
+    """
+    output, inverse_indices, counts = torch._unique_consecutive(
+        input,
+        return_inverse=return_inverse,
+        return_counts=return_counts,
+    )
+    return _unique_outputs(output, inverse_indices, counts, return_inverse, return_counts)
+
+
+def _unique_outputs(output, inverse_indices, counts, return_inverse, return_counts):
+    if not return_inverse and not return_counts:
         return output
+    outputs = (output,)
+    if return_inverse:
+        outputs += (inverse_indices,)
+    if return_counts:
+        outputs += (counts,)
+    return outputs
 
 
 def argmax(input, dim=None, keepdim=False):
@@ -731,6 +802,48 @@ def norm(input, p="fro", dim=None, keepdim=False, out=None):
     return torch._C._VariableFunctions.norm(input, p, dim, keepdim=keepdim, out=out)
 
 
+def cdist(x1, x2, p=2, compute_mode='use_mm_for_euclid_dist_if_necessary'):
+    r"""Computes the p-norm distances between every row of :attr:`x1` and every
+    row of :attr:`x2`, batched over the leading dimensions.
+
+    For ``p = 2``, the distances can be computed from
+    :math:`\|x\|^2 - 2 x y^T + \|y\|^2`, with one matrix product for all
+    the pairs. This is much faster for many rows, but less accurate for points
+    that are close to each other.
+
+    Args:
+        x1 (Tensor): input tensor of shape :math:`B \times P \times M`.
+        x2 (Tensor): input tensor of shape :math:`B \times R \times M`.
+        p (float): p value for the p-norm distance, :math:`\in [0, \infty]`.
+        compute_mode (str):
+            ``'use_mm_for_euclid_dist_if_necessary'`` uses the matrix product
+            for ``p = 2`` when P or R is greater than 25,
+            ``'use_mm_for_euclid_dist'`` always uses it and
+            ``'donot_use_mm_for_euclid_dist'`` never does. Default:
+            ``'use_mm_for_euclid_dist_if_necessary'``.
+
+    Returns:
+        Tensor: the distances, of shape :math:`B \times P \times R`.
+
+    Example::
+
+        >>> a = torch.tensor([[0.9041,  0.0196], [-0.3108, -2.4423], [-0.4821,  1.059]])
+        >>> b = torch.tensor([[-2.1763, -0.4713], [-0.6986,  1.3702]])
+        >>> torch.cdist(a, b, p=2)
+        tensor([[3.1193, 2.0959],
+                [2.7138, 3.8322],
+                [2.2830, 0.3791]])
+    """
+    modes = {
+        'use_mm_for_euclid_dist_if_necessary': 0,
+        'use_mm_for_euclid_dist': 1,
+        'donot_use_mm_for_euclid_dist': 2,
+    }
+    if compute_mode not in modes:
+        raise ValueError("{} is not a valid value for compute_mode".format(compute_mode))
+    return torch._C._VariableFunctions.cdist(x1, x2, p, modes[compute_mode])
+
+
 def chain_matmul(*matrices):
     r"""Returns the matrix product of the :math:`N` 2-D tensors. This product is efficiently computed
     using the matrix chain order algorithm which selects the order in which incurs the lowest cost in terms
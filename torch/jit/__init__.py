@@ -50,6 +50,7 @@ _flatten = torch._C._jit_flatten
 _unflatten = torch._C._jit_unflatten
 _jit_script_compile = torch._C._jit_script_compile
 BatchTensor = torch._C._jit.BatchTensor
+DynamicBatcher = torch._C._jit.DynamicBatcher
 compiled_weak_fns = weakref.WeakKeyDictionary()
 COMPILATION_PENDING = object()
 COMPILED = object()
@@ -108,7 +109,7 @@ def load(f):
     return m
 
 
-def save(m, f):
+def save(m, f, example_inputs=None):
     """
         Saves a ScriptModule to a file.
 
@@ -116,6 +117,11 @@ def save(m, f):
             m: a ScriptModule to save
             f: a file-like object (has to implement write and flush) or a string
                containing a file name
+            example_inputs (tuple, optional): if given, ``m.forward`` is saved
+               already optimized for running inputs of the same ranks, types and
+               devices as these with gradients disabled, and is not optimized
+               again when loaded. This makes the first calls of the loaded module
+               as fast as the following ones, but it can't be used for training.
 
         .. warning::
             If you are using Python 2, torch.save does NOT support StringIO.StringIO
@@ -131,13 +137,21 @@ def save(m, f):
             >>> # Save to io.BytesIO buffer
             >>> buffer = io.BytesIO()
             >>> torch.jit.save(m, buffer)
+            >>> # Save with forward optimized for inference
+            >>> torch.jit.save(m, 'scriptmodule.pt', example_inputs=(torch.randn(4, 8),))
     """
     if isinstance(f, str) or \
             (sys.version_info[0] == 2 and isinstance(f, unicode)) or \
             (sys.version_info[0] == 3 and isinstance(f, pathlib.Path)):
-        m.save(f)
+        if example_inputs is None:
+            m.save(f)
+        else:
+            m.save_for_inference(f, tuple(example_inputs))
     else:
-        ret = m.save_to_buffer()
+        if example_inputs is None:
+            ret = m.save_to_buffer()
+        else:
+            ret = m.save_for_inference_to_buffer(tuple(example_inputs))
         f.write(ret)
 
 
@@ -739,6 +753,37 @@ def batch(batch_size=1, optimize=True, _frames_up=0):
     return decorator
 
 
+def dynamic_batch(dynamic_dims, max_batch_size=32, max_delay_ms=1., optimize=True, _frames_up=0):
+    r"""
+    Like :func:`batch`, but the decorated function takes and returns single
+    examples, and is meant to be called concurrently from many threads (e.g.
+    by a server). Calls that arrive within ``max_delay_ms`` of each other are
+    padded into BatchTensors and run together, up to ``max_batch_size`` of
+    them at a time, on a background thread. The batched function runs
+    without grad.
+
+    ``dynamic_dims`` has a list of bools for each argument that says which of
+    its dims can differ between calls.
+    """
+    def decorator(fn):
+        if not _enabled:
+            return fn
+        import torch.jit.batchop
+        mod = script(fn, optimize, _frames_up)
+        res_graph = torch.to_batch_graph(mod.graph)
+        dims = [torch.tensor(d, dtype=torch.uint8) for d in dynamic_dims]
+        batcher = DynamicBatcher(res_graph, dims, max_batch_size, int(max_delay_ms * 1000), optimize)
+
+        def wrapper(*args):
+            res = batcher(list(args))
+            if len(res) == 1:
+                return res[0]
+            return res
+        wrapper.__doc__ = fn.__doc__
+        return wrapper
+    return decorator
+
+
 # These OrderedDictWrapper classes replace the actual OrderedDicts in
 # module with versions that get/set properties inside of script::Module.
 # This allows us to reuse most of nn.Module while still storing the
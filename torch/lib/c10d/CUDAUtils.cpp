@@ -1,5 +1,7 @@
 #include "CUDAUtils.hpp"
 
+#include <ATen/cuda/CUDAStream.h>
+
 #include <c10d/private/CUDAUtils.hpp>
 
 namespace c10d {
@@ -23,9 +25,9 @@ CUDAEvent::~CUDAEvent() noexcept (false) {
   }
 }
 
-CUDAStream CUDAStream::create() {
+CUDAStream CUDAStream::create(bool highPriority) {
   CUDAStream stream;
-  stream.stream_ = THCStream_new();
+  stream.stream_ = at::cuda::detail::CUDAStream_createStream(highPriority);
   return stream;
 }
 
@@ -64,7 +64,9 @@ class CUDAStream {
 
   ~CUDAStream();
 
-  static CUDAStream create();
+  // High priority streams run their kernels ahead of the ones of default
+  // priority streams whenever both are ready.
+  static CUDAStream create(bool highPriority = false);
 
   // Must not be copyable.
   CUDAStream& operator=(const CUDAStream&) = delete;
@@ -0,0 +1,528 @@
+#include "ParameterServer.hpp"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace c10d {
+
+namespace {
+
+std::string addressKey(int rank) {
+  return "ps/addr/" + std::to_string(rank);
+}
+
+std::string tableKey(const std::string& name, int rank) {
+  return "ps/table/" + name + "/" + std::to_string(rank);
+}
+
+// Number of rows of a table of numRows rows that live on rank
+int64_t numLocalRows(int64_t numRows, int rank, int size) {
+  if (numRows <= rank) {
+    return 0;
+  }
+  return (numRows - rank - 1) / size + 1;
+}
+
+void checkRows(
+    const std::vector<int64_t>& rows,
+    int64_t numLocalRows,
+    const std::string& name) {
+  for (auto row : rows) {
+    if (row < 0 || row >= numLocalRows) {
+      throw std::runtime_error("row out of range for table " + name);
+    }
+  }
+}
+
+} // namespace
+
+// ParameterServer::WorkParameterServer
+ParameterServer::WorkParameterServer::WorkParameterServer()
+    : completed_(false) {}
+
+ParameterServer::WorkParameterServer::~WorkParameterServer() {}
+
+bool ParameterServer::WorkParameterServer::isCompleted() {
+  return completed_;
+}
+
+bool ParameterServer::WorkParameterServer::isSuccess() const {
+  return !exception_;
+}
+
+void ParameterServer::WorkParameterServer::synchronize() {}
+
+bool ParameterServer::WorkParameterServer::wait() {
+  std::unique_lock<std::mutex> lock(workMutex_);
+  while (!completed_) {
+    workCV_.wait(lock);
+  }
+  return isSuccess();
+}
+
+void ParameterServer::WorkParameterServer::finish() {
+  {
+    std::unique_lock<std::mutex> lock(workMutex_);
+    completed_ = true;
+  }
+  workCV_.notify_all();
+  runCallbacks();
+}
+
+void ParameterServer::WorkParameterServer::finishWithException(
+    std::exception_ptr caughtWorkException) {
+  {
+    std::unique_lock<std::mutex> lock(workMutex_);
+    completed_ = true;
+    exception_ = caughtWorkException;
+  }
+  workCV_.notify_all();
+  runCallbacks();
+}
+
+const std::exception& ParameterServer::WorkParameterServer::exception() const {
+  try {
+    std::rethrow_exception(exception_);
+  } catch (const std::exception& e) {
+    return e;
+  }
+}
+
+ParameterServer::TableOptions::TableOptions()
+    : optimizer(Optimizer::SGD),
+      learningRate(0.01),
+      epsilon(1e-5),
+      initRange(0) {}
+
+// ParameterServer
+ParameterServer::ParameterServer(
+    const std::shared_ptr<Store>& store,
+    int rank,
+    int size,
+    Options options)
+    : store_(store),
+      rank_(rank),
+      size_(size),
+      sockets_(size, -1),
+      stop_(false),
+      listenSocket_(-1) {
+  if (options.hostname.empty()) {
+    std::array<char, HOST_NAME_MAX> hostname;
+    SYSCHECK(::gethostname(hostname.data(), hostname.size()));
+    options.hostname = hostname.data();
+  }
+
+  // Create the control pipe, whose write end is closed to stop the server
+  SYSCHECK(::pipe(controlPipeFd_.data()));
+
+  PortType port;
+  std::tie(listenSocket_, port) = tcputil::listen(0);
+
+  // Start the server before publishing its address
+  serverThread_ = std::thread(&ParameterServer::serverLoop, this);
+  workerThread_ = std::thread(&ParameterServer::runLoop, this);
+
+  auto address = options.hostname + ":" + std::to_string(port);
+  store_->set(
+      addressKey(rank_), std::vector<uint8_t>(address.begin(), address.end()));
+}
+
+ParameterServer::~ParameterServer() {
+  std::unique_lock<std::mutex> lock(queueMutex_);
+
+  while (!queue_.empty()) {
+    queueConsumeCV_.wait(lock);
+  }
+  // Queue is empty, signal stop
+  stop_ = true;
+
+  // Release lock to allow threads to terminate
+  queueProduceCV_.notify_all();
+
+  lock.unlock();
+
+  workerThread_.join();
+
+  stopServer();
+  serverThread_.join();
+
+  for (auto socket : sockets_) {
+    if (socket != -1) {
+      ::close(socket);
+    }
+  }
+  ::close(listenSocket_);
+  ::close(controlPipeFd_[0]);
+}
+
+void ParameterServer::stopServer() {
+  if (controlPipeFd_[1] != -1) {
+    // close the write end of the pipe
+    ::close(controlPipeFd_[1]);
+    controlPipeFd_[1] = -1;
+  }
+}
+
+void ParameterServer::createTable(
+    const std::string& name,
+    int64_t numRows,
+    int64_t dim,
+    const TableOptions& options) {
+  if (numRows < 0 || dim <= 0) {
+    throw std::runtime_error("invalid size for table " + name);
+  }
+
+  auto table = std::unique_ptr<Table>(new Table());
+  table->numRows = numRows;
+  table->dim = dim;
+  table->options = options;
+  table->weights =
+      at::zeros({numLocalRows(numRows, rank_, size_), dim}, at::kFloat);
+  if (options.initRange > 0) {
+    table->weights.uniform_(-options.initRange, options.initRange);
+  }
+  if (options.optimizer == Optimizer::ADAGRAD) {
+    table->state = at::zeros_like(table->weights);
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(tablesMutex_);
+    if (tables_.count(name) > 0) {
+      throw std::runtime_error("table " + name + " already exists");
+    }
+    tables_.emplace(name, std::move(table));
+  }
+
+  // Wait for every process to create its shard, so that no request for
+  // this table reaches a process before it can serve it
+  store_->set(tableKey(name, rank_), {1});
+  std::vector<std::string> keys;
+  for (int i = 0; i < size_; i++) {
+    keys.push_back(tableKey(name, i));
+  }
+  store_->wait(keys);
+}
+
+ParameterServer::Table& ParameterServer::getTable(const std::string& name) {
+  std::unique_lock<std::mutex> lock(tablesMutex_);
+  auto it = tables_.find(name);
+  if (it == tables_.end()) {
+    throw std::runtime_error("table " + name + " does not exist");
+  }
+  return *it->second;
+}
+
+std::shared_ptr<ProcessGroup::Work> ParameterServer::push(
+    const std::string& name,
+    at::Tensor indices,
+    at::Tensor grads) {
+  const auto& table = getTable(name);
+  if (indices.type() != at::CPU(at::kLong) || indices.dim() != 1) {
+    throw std::runtime_error(
+        "ParameterServer::push requires 1D CPU LongTensor indices");
+  }
+  if (grads.type() != at::CPU(at::kFloat) || grads.dim() != 2 ||
+      grads.size(0) != indices.numel() || grads.size(1) != table.dim) {
+    throw std::runtime_error(
+        "ParameterServer::push requires CPU FloatTensor gradients of size "
+        "[indices.numel(), dim]");
+  }
+
+  Request request;
+  request.type = RequestType::PUSH;
+  request.name = name;
+  request.indices = indices.contiguous();
+  request.tensor = grads.contiguous();
+  return enqueue(std::move(request));
+}
+
+std::shared_ptr<ProcessGroup::Work> ParameterServer::pull(
+    const std::string& name,
+    at::Tensor indices,
+    at::Tensor output) {
+  const auto& table = getTable(name);
+  if (indices.type() != at::CPU(at::kLong) || indices.dim() != 1) {
+    throw std::runtime_error(
+        "ParameterServer::pull requires 1D CPU LongTensor indices");
+  }
+  if (output.type() != at::CPU(at::kFloat) || !output.is_contiguous() ||
+      output.dim() != 2 || output.size(0) != indices.numel() ||
+      output.size(1) != table.dim) {
+    throw std::runtime_error(
+        "ParameterServer::pull requires a contiguous CPU FloatTensor output "
+        "of size [indices.numel(), dim]");
+  }
+
+  Request request;
+  request.type = RequestType::PULL;
+  request.name = name;
+  request.indices = indices.contiguous();
+  request.tensor = output;
+  return enqueue(std::move(request));
+}
+
+std::shared_ptr<ProcessGroup::Work> ParameterServer::enqueue(Request request) {
+  auto work = std::make_shared<WorkParameterServer>();
+  request.work = work;
+  std::unique_lock<std::mutex> lock(queueMutex_);
+  queue_.push_back(std::move(request));
+  queueProduceCV_.notify_one();
+  return work;
+}
+
+void ParameterServer::runLoop() {
+  std::unique_lock<std::mutex> lock(queueMutex_);
+
+  while (!stop_) {
+    if (queue_.empty()) {
+      queueProduceCV_.wait(lock);
+      continue;
+    }
+
+    auto request = std::move(queue_.front());
+
+    queue_.pop_front();
+    queueConsumeCV_.notify_one();
+
+    lock.unlock();
+
+    try {
+      runRequest(request);
+      request.work->finish();
+    } catch (...) {
+      request.work->finishWithException(std::current_exception());
+    }
+
+    lock.lock();
+  }
+}
+
+void ParameterServer::runRequest(const Request& request) {
+  auto& table = getTable(request.name);
+  const auto dim = table.dim;
+  const auto numel = request.indices.numel();
+  const auto indices = request.indices.data<int64_t>();
+  auto data = request.tensor.data<float>();
+
+  // Split the rows by shard, remembering where every row came from
+  std::vector<std::vector<int64_t>> rows(size_);
+  std::vector<std::vector<int64_t>> positions(size_);
+  for (int64_t i = 0; i < numel; i++) {
+    if (indices[i] < 0 || indices[i] >= table.numRows) {
+      throw std::runtime_error("row out of range for table " + request.name);
+    }
+    const auto shard = indices[i] % size_;
+    rows[shard].push_back(indices[i] / size_);
+    positions[shard].push_back(i);
+  }
+
+  std::vector<float> buffer;
+  for (int shard = 0; shard < size_; shard++) {
+    if (rows[shard].empty()) {
+      continue;
+    }
+
+    const auto& shardPositions = positions[shard];
+    if (request.type == RequestType::PUSH) {
+      buffer.resize(shardPositions.size() * dim);
+      for (size_t i = 0; i < shardPositions.size(); i++) {
+        std::copy(
+            data + shardPositions[i] * dim,
+            data + (shardPositions[i] + 1) * dim,
+            buffer.data() + i * dim);
+      }
+    } else {
+      buffer.resize(shardPositions.size() * dim);
+    }
+
+    if (shard == rank_) {
+      if (request.type == RequestType::PUSH) {
+        applyPush(table, rows[shard], buffer.data());
+      } else {
+        applyPull(table, rows[shard], buffer.data());
+      }
+    } else {
+      // Every request is answered before the next one is sent, so that a
+      // server never blocks sending a response to a client that is itself
+      // blocked sending a request to another server
+      int socket = getSocket(shard);
+      tcputil::sendValue<RequestType>(socket, request.type, true);
+      tcputil::sendString(socket, request.name, true);
+      tcputil::sendVector<int64_t>(
+          socket, rows[shard], request.type == RequestType::PUSH);
+      if (request.type == RequestType::PUSH) {
+        tcputil::sendVector<float>(socket, buffer);
+      }
+
+      auto status = tcputil::recvValue<ResponseStatus>(socket);
+      if (status != ResponseStatus::OK) {
+        throw std::runtime_error(
+            "ParameterServer request to rank " + std::to_string(shard) +
+            " failed: " + tcputil::recvString(socket));
+      }
+      if (request.type == RequestType::PULL) {
+        tcputil::recvBytes<float>(socket, buffer.data(), buffer.size());
+      }
+    }
+
+    if (request.type == RequestType::PULL) {
+      for (size_t i = 0; i < shardPositions.size(); i++) {
+        std::copy(
+            buffer.data() + i * dim,
+            buffer.data() + (i + 1) * dim,
+            data + shardPositions[i] * dim);
+      }
+    }
+  }
+}
+
+void ParameterServer::applyPush(
+    Table& table,
+    const std::vector<int64_t>& rows,
+    const float* grads) {
+  const auto dim = table.dim;
+  const auto lr = table.options.learningRate;
+  const auto epsilon = table.options.epsilon;
+
+  std::unique_lock<std::mutex> lock(table.mutex);
+  auto weights = table.weights.data<float>();
+  for (size_t i = 0; i < rows.size(); i++) {
+    auto w = weights + rows[i] * dim;
+    auto g = grads + i * dim;
+    switch (table.options.optimizer) {
+      case Optimizer::SGD:
+        for (int64_t j = 0; j < dim; j++) {
+          w[j] -= lr * g[j];
+        }
+        break;
+      case Optimizer::ADAGRAD: {
+        // Same update as caffe2's adagrad_update, without decay
+        auto h = table.state.data<float>() + rows[i] * dim;
+        for (int64_t j = 0; j < dim; j++) {
+          h[j] += g[j] * g[j];
+          w[j] -= lr * g[j] / (std::sqrt(h[j]) + epsilon);
+        }
+        break;
+      }
+    }
+  }
+}
+
+void ParameterServer::applyPull(
+    Table& table,
+    const std::vector<int64_t>& rows,
+    float* output) {
+  const auto dim = table.dim;
+
+  std::unique_lock<std::mutex> lock(table.mutex);
+  auto weights = table.weights.data<float>();
+  for (size_t i = 0; i < rows.size(); i++) {
+    std::copy(
+        weights + rows[i] * dim,
+        weights + (rows[i] + 1) * dim,
+        output + i * dim);
+  }
+}
+
+int ParameterServer::getSocket(int rank) {
+  if (sockets_[rank] != -1) {
+    return sockets_[rank];
+  }
+
+  auto value = store_->get(addressKey(rank));
+  std::string address(value.begin(), value.end());
+  auto pos = address.rfind(':');
+  auto hostname = address.substr(0, pos);
+  auto port = static_cast<PortType>(std::stoi(address.substr(pos + 1)));
+  sockets_[rank] = tcputil::connect(hostname, port);
+  return sockets_[rank];
+}
+
+void ParameterServer::handleRequest(int socket) {
+  auto type = tcputil::recvValue<RequestType>(socket);
+  auto name = tcputil::recvString(socket);
+  auto rows = tcputil::recvVector<int64_t>(socket);
+  std::vector<float> buffer;
+  if (type == RequestType::PUSH) {
+    buffer = tcputil::recvVector<float>(socket);
+  }
+
+  // Errors in the request are sent back to the client. The connection is
+  // only dropped on socket errors.
+  try {
+    auto& table = getTable(name);
+    checkRows(rows, table.weights.size(0), name);
+    if (type == RequestType::PUSH) {
+      if (buffer.size() != rows.size() * table.dim) {
+        throw std::runtime_error("invalid gradients for table " + name);
+      }
+      applyPush(table, rows, buffer.data());
+    } else {
+      buffer.resize(rows.size() * table.dim);
+      applyPull(table, rows, buffer.data());
+    }
+  } catch (const std::runtime_error& e) {
+    tcputil::sendValue<ResponseStatus>(socket, ResponseStatus::ERROR, true);
+    tcputil::sendString(socket, e.what());
+    return;
+  }
+
+  if (type == RequestType::PUSH) {
+    tcputil::sendValue<ResponseStatus>(socket, ResponseStatus::OK);
+  } else {
+    tcputil::sendValue<ResponseStatus>(socket, ResponseStatus::OK, true);
+    tcputil::sendBytes<float>(socket, buffer.data(), buffer.size());
+  }
+}
+
+void ParameterServer::serverLoop() {
+  std::vector<struct pollfd> fds;
+  fds.push_back({.fd = controlPipeFd_[0], .events = POLLIN});
+  fds.push_back({.fd = listenSocket_, .events = POLLIN});
+
+  while (true) {
+    SYSCHECK(::poll(fds.data(), fds.size(), -1));
+
+    // The pipe receives an event (EOF or hang up when the write end is
+    // closed) which tells us to shutdown the server
+    if (fds[0].revents != 0) {
+      break;
+    }
+
+    for (size_t i = 2; i < fds.size(); i++) {
+      if (fds[i].revents == 0) {
+        continue;
+      }
+      try {
+        handleRequest(fds[i].fd);
+      } catch (...) {
+        // The client closed its connection, or the connection broke. Either
+        // way, the client will notice on its side.
+        ::close(fds[i].fd);
+        fds[i].fd = -1;
+      }
+    }
+
+    fds.erase(
+        std::remove_if(
+            fds.begin() + 2,
+            fds.end(),
+            [](const struct pollfd& pfd) { return pfd.fd == -1; }),
+        fds.end());
+
+    if (fds[1].revents != 0) {
+      int socket = std::get<0>(tcputil::accept(listenSocket_));
+      fds.push_back({.fd = socket, .events = POLLIN});
+    }
+  }
+
+  for (size_t i = 2; i < fds.size(); i++) {
+    ::close(fds[i].fd);
+  }
+}
+
+} // namespace c10d
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <ATen/ATen.h>
+
+#include <c10d/ProcessGroup.hpp>
+#include <c10d/Store.hpp>
+#include <c10d/Utils.hpp>
+
+namespace c10d {
+
+// ParameterServer is a sharded key-value service for tables of rows that are
+// too large to be replicated on every process, such as embedding tables.
+//
+// Every process in the group serves one shard of every table: row `r` lives
+// on rank `r % size`. Processes push gradients for arbitrary rows and pull
+// the current value of arbitrary rows, without any collective across the
+// group. The optimizer of the table is applied by the process that owns the
+// row, when the gradient is received, so the optimizer state is sharded
+// along with the rows.
+//
+// Push and pull are asynchronous. They are executed by a worker thread owned
+// by the parameter server, in the order they were called, and return a work
+// object that can be waited on, or given a callback. An operation sends one
+// request per shard that it touches, carrying all the rows it needs from that
+// shard. Since a shard serves requests from a process in order, a pull
+// observes the pushes issued before it by the same process.
+//
+// Requests are served by a thread listening on a TCP socket, whose address is
+// published to the store when the parameter server is constructed. The store
+// is also used to synchronize table creation, so passing a PrefixStore allows
+// for several parameter servers over the same store.
+//
+// Tables hold CPU float rows. Pushes of duplicate rows are applied in order.
+//
+// The parameter server must be constructed by every process in the group,
+// and destructed only once no process is going to send it requests anymore
+// (e.g. after a barrier).
+class ParameterServer {
+ public:
+  enum class Optimizer : uint8_t {
+    // w -= lr * g
+    SGD = 0,
+    // h += g * g
+    // w -= lr * g / (sqrt(h) + epsilon)
+    ADAGRAD,
+  };
+
+  struct TableOptions {
+    explicit TableOptions();
+
+    Optimizer optimizer;
+    float learningRate;
+    float epsilon;
+
+    // Rows are initialized uniformly in [-initRange, initRange]
+    float initRange;
+  };
+
+  struct Options {
+    // Address that other processes use to reach this process.
+    // Defaults to the hostname.
+    std::string hostname;
+  };
+
+  class WorkParameterServer : public ProcessGroup::Work {
+   public:
+    WorkParameterServer();
+    virtual ~WorkParameterServer();
+
+    bool isCompleted() override;
+
+    bool isSuccess() const override;
+
+    void synchronize() override;
+
+    bool wait() override;
+
+    const std::exception& exception() const override;
+
+   protected:
+    void finish();
+    void finishWithException(std::exception_ptr caughtWorkException);
+
+    std::mutex workMutex_;
+    std::condition_variable workCV_;
+    std::atomic<bool> completed_;
+    std::exception_ptr exception_;
+
+    friend class ParameterServer;
+  };
+
+  // The server thread and the worker thread are spawned by the constructor.
+  explicit ParameterServer(
+      const std::shared_ptr<Store>& store,
+      int rank,
+      int size,
+      Options options = Options());
+
+  virtual ~ParameterServer();
+
+  int getRank() const {
+    return rank_;
+  }
+
+  int getSize() const {
+    return size_;
+  }
+
+  // Creates the local shard of a table of numRows rows of dim floats.
+  // Must be called by every process, with the same arguments. Returns once
+  // every process has created its shard.
+  void createTable(
+      const std::string& name,
+      int64_t numRows,
+      int64_t dim,
+      const TableOptions& options = TableOptions());
+
+  // Applies the optimizer of the table to the rows in indices (a 1D
+  // LongTensor), with gradients grads (a FloatTensor of size
+  // [indices.numel(), dim]). The tensors must not be modified until the work
+  // has completed.
+  std::shared_ptr<ProcessGroup::Work> push(
+      const std::string& name,
+      at::Tensor indices,
+      at::Tensor grads);
+
+  // Copies the rows in indices (a 1D LongTensor) into output (a contiguous
+  // FloatTensor of size [indices.numel(), dim]).
+  std::shared_ptr<ProcessGroup::Work> pull(
+      const std::string& name,
+      at::Tensor indices,
+      at::Tensor output);
+
+ protected:
+  enum class RequestType : uint8_t { PUSH = 0, PULL };
+
+  enum class ResponseStatus : uint8_t { OK = 0, ERROR };
+
+  struct Table {
+    int64_t numRows;
+    int64_t dim;
+    TableOptions options;
+
+    // Serializes the server thread and the worker thread
+    std::mutex mutex;
+    // Local rows, [numLocalRows, dim]
+    at::Tensor weights;
+    // Optimizer state, same size as weights (Adagrad only)
+    at::Tensor state;
+  };
+
+  struct Request {
+    RequestType type;
+    std::string name;
+    at::Tensor indices;
+    // Gradients for PUSH, output for PULL
+    at::Tensor tensor;
+    std::shared_ptr<WorkParameterServer> work;
+  };
+
+  std::shared_ptr<ProcessGroup::Work> enqueue(Request request);
+
+  Table& getTable(const std::string& name);
+
+  // Runs request on every shard that owns one of its rows
+  void runRequest(const Request& request);
+
+  // Applies grads ([rows.size(), dim]) to the local rows
+  void applyPush(
+      Table& table,
+      const std::vector<int64_t>& rows,
+      const float* grads);
+
+  // Copies the local rows into output ([rows.size(), dim])
+  void applyPull(Table& table, const std::vector<int64_t>& rows, float* output);
+
+  // Returns the socket connected to the server of rank, connecting lazily
+  int getSocket(int rank);
+
+  // Reads a request from socket, runs it, and sends back the response
+  void handleRequest(int socket);
+
+  void runLoop();
+
+  void serverLoop();
+
+  void stopServer();
+
+  std::shared_ptr<Store> store_;
+  const int rank_;
+  const int size_;
+
+  // Guards tables_, which the server thread reads concurrently
+  std::mutex tablesMutex_;
+  std::unordered_map<std::string, std::unique_ptr<Table>> tables_;
+
+  // Client sockets to the server of every rank, -1 if not connected
+  std::vector<int> sockets_;
+
+  bool stop_;
+
+  std::mutex queueMutex_;
+  std::condition_variable queueProduceCV_;
+  std::condition_variable queueConsumeCV_;
+  std::deque<Request> queue_;
+  std::thread workerThread_;
+
+  int listenSocket_;
+  std::array<int, 2> controlPipeFd_{{-1, -1}};
+  std::thread serverThread_;
+};
+
+} // namespace c10d
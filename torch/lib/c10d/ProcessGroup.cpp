@@ -4,6 +4,30 @@ namespace c10d {
 
 ProcessGroup::Work::~Work() {}
 
+void ProcessGroup::Work::addCallback(std::function<void()> callback) {
+  {
+    std::unique_lock<std::mutex> lock(callbackMutex_);
+    if (!callbacksRun_) {
+      callbacks_.push_back(std::move(callback));
+      return;
+    }
+  }
+  callback();
+}
+
+void ProcessGroup::Work::runCallbacks() {
+  std::vector<std::function<void()>> callbacks;
+  {
+    std::unique_lock<std::mutex> lock(callbackMutex_);
+    callbacksRun_ = true;
+    callbacks.swap(callbacks_);
+  }
+  // Callbacks may add more callbacks, so they run without holding the lock
+  for (auto& callback : callbacks) {
+    callback();
+  }
+}
+
 ProcessGroup::ProcessGroup(int rank, int size) : rank_(rank), size_(size) {}
 
 ProcessGroup::~ProcessGroup() {}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <unordered_map>
 #include <vector>
@@ -74,6 +76,29 @@ class ProcessGroup {
 
     // Returns exception if wait() returned false.
     virtual const std::exception& exception() const = 0;
+
+    // Runs callback once the work has completed, successfully or not, so
+    // that callers can chain the next step without dedicating a thread to
+    // wait(). If the work has already completed, callback runs right away on
+    // the calling thread. Otherwise it runs on the thread that completes the
+    // work (typically the process group's worker thread), which it should
+    // not block for long. Callbacks must not throw.
+    //
+    // For CUDA tensors, the callback must still call synchronize() before
+    // using the output tensors.
+    //
+    // Implementations that support callbacks call runCallbacks() once they
+    // have completed.
+    virtual void addCallback(std::function<void()> callback);
+
+   protected:
+    // Runs the callbacks added so far, and any added later right away.
+    void runCallbacks();
+
+   private:
+    std::mutex callbackMutex_;
+    bool callbacksRun_ = false;
+    std::vector<std::function<void()>> callbacks_;
   };
 
   explicit ProcessGroup(int rank, int size);
@@ -95,6 +120,13 @@ class ProcessGroup {
       std::vector<at::Tensor>& data,
       const AllreduceOptions& opts = AllreduceOptions()) = 0;
 
+  // Allreduces tensors of the same type, but of any shapes, in a single
+  // collective. Every process passes tensors of the same shapes, in the same
+  // order.
+  virtual std::shared_ptr<ProcessGroup::Work> allreduceCoalesced(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions()) = 0;
+
   virtual std::shared_ptr<ProcessGroup::Work> reduce(
       std::vector<at::Tensor>& tensors,
       const ReduceOptions& opts = ReduceOptions()) = 0;
@@ -113,6 +145,20 @@ class ProcessGroup {
       std::vector<std::vector<at::Tensor>>& inputTensors,
       const ScatterOptions& opts = ScatterOptions()) = 0;
 
+  // Reduces inputTensors[i][r] element-wise over all processes and stores
+  // the result in outputTensors[i] of the process with rank r. Every process
+  // passes one input per rank, of the same size as its output.
+  virtual std::shared_ptr<ProcessGroup::Work> reduceScatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) = 0;
+
+  // Sends inputTensors[r] to the process with rank r, and receives into
+  // outputTensors[r] what the process with rank r sends to this one.
+  virtual std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<at::Tensor>& inputTensors) = 0;
+
   virtual std::shared_ptr<ProcessGroup::Work> send(
       std::vector<at::Tensor>& tensors,
       int dstRank,
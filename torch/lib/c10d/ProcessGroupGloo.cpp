@@ -4,6 +4,7 @@
 #include <gloo/allreduce_ring_chunked.h>
 #include <gloo/barrier_all_to_one.h>
 #include <gloo/broadcast_one_to_all.h>
+#include <gloo/reduce_scatter.h>
 
 #ifdef USE_CUDA
 #include <gloo/cuda_allreduce_halving_doubling.h>
@@ -209,6 +210,7 @@ void ProcessGroupGloo::WorkGloo::finish(const AlgorithmEntry& entry) {
     }
   }
   cv_.notify_all();
+  runCallbacks();
 }
 
 void ProcessGroupGloo::WorkGloo::finishWithException(
@@ -219,6 +221,7 @@ void ProcessGroupGloo::WorkGloo::finishWithException(
     ex_ = std::unique_ptr<::gloo::Exception>(new ::gloo::Exception(ex));
   }
   cv_.notify_all();
+  runCallbacks();
 }
 
 ProcessGroupGloo::SendWork::SendWork(
@@ -250,6 +253,11 @@ const std::exception& ProcessGroupGloo::SendWork::exception() const {
   throw std::runtime_error("no exception");
 }
 
+void ProcessGroupGloo::SendWork::addCallback(std::function<void()> /* unused */) {
+  // Completion is only observable by waiting on the unbound buffer
+  throw std::runtime_error("addCallback is not supported for send work");
+}
+
 ProcessGroupGloo::RecvWork::RecvWork(
     at::Tensor& tensor,
     std::unique_ptr<::gloo::transport::UnboundBuffer> buffer,
@@ -280,10 +288,16 @@ const std::exception& ProcessGroupGloo::RecvWork::exception() const {
   throw std::runtime_error("no exception");
 }
 
+void ProcessGroupGloo::RecvWork::addCallback(std::function<void()> /* unused */) {
+  // Completion is only observable by waiting on the unbound buffer
+  throw std::runtime_error("addCallback is not supported for recv work");
+}
+
 ProcessGroupGloo::Options::Options()
     : timeout(std::chrono::milliseconds(10 * 1000)),
       threads(2),
-      cacheNumAlgorithmEntries(1) {}
+      cacheNumAlgorithmEntries(1),
+      cacheMaxAlgorithmKeys(256) {}
 
 ProcessGroupGloo::ProcessGroupGloo(
     const std::shared_ptr<Store>& store,
@@ -293,7 +307,9 @@ ProcessGroupGloo::ProcessGroupGloo(
     : ProcessGroup(rank, size),
       store_(new GlooStore(store)),
       stop_(false),
-      cacheNumAlgorithmEntries_(options.cacheNumAlgorithmEntries) {
+      sparseAllreduceCount_(0),
+      cacheNumAlgorithmEntries_(options.cacheNumAlgorithmEntries),
+      cacheMaxAlgorithmKeys_(options.cacheMaxAlgorithmKeys) {
   auto& devices = options.devices;
   if (devices.empty()) {
     throw std::runtime_error("No device(s) specified");
@@ -379,6 +395,8 @@ void ProcessGroupGloo::createAlgorithm(AlgorithmEntry& entry) {
   const auto& key = entry.key;
   switch (key.collectiveType) {
     case CollectiveType::ALLREDUCE:
+    case CollectiveType::ALLREDUCE_COALESCED:
+    case CollectiveType::ALLREDUCE_SPARSE:
       GENERATE_ALL_TYPES(key.type->scalarType(), createAllreduce, entry);
       return;
     case CollectiveType::BROADCAST:
@@ -388,6 +406,12 @@ void ProcessGroupGloo::createAlgorithm(AlgorithmEntry& entry) {
       entry.algorithm = std::unique_ptr<::gloo::Algorithm>(
           new ::gloo::BarrierAllToOne(contexts_[0]));
       return;
+    case CollectiveType::REDUCE_SCATTER:
+      GENERATE_ALL_TYPES(key.type->scalarType(), createReduceScatter, entry);
+      return;
+    case CollectiveType::ALLTOALL:
+      // Runs on unbound buffers, see alltoall()
+      return;
     case CollectiveType::UNUSED:
       break;
   }
@@ -486,6 +510,32 @@ void ProcessGroupGloo::createBroadcast(AlgorithmEntry& entry) {
       "Unhandled backend: " + std::string(at::toString(backend)));
 }
 
+template <typename T>
+void ProcessGroupGloo::createReduceScatter(AlgorithmEntry& entry) {
+  const auto& key = entry.key;
+  const auto& backend = key.type->backend();
+
+  // Create algorithm against first context
+  auto& context = contexts_[0];
+
+  if (backend == at::Backend::CPU) {
+    // The flat input holds one equally sized chunk per rank, the reduction
+    // of chunk r is left in place on rank r
+    std::vector<int> recvCounts(getSize(), entry.src[0].numel() / getSize());
+    entry.algorithm = std::unique_ptr<::gloo::Algorithm>(
+        new ::gloo::ReduceScatterHalvingDoubling<T>(
+            context,
+            getDataPointers<T>(entry.src),
+            entry.src[0].numel(),
+            recvCounts,
+            reductionFunction<T>(key.reduceOp)));
+    return;
+  }
+
+  throw std::runtime_error(
+      "Unhandled backend: " + std::string(at::toString(backend)));
+}
+
 // Constructs an AlgorithmEntry instance, except for the algorithm
 // itself. It allocates the temporary input/output tensors necessary
 // to have a fixed address to pass to the Gloo algorithms. The
@@ -521,6 +571,13 @@ EntryType ProcessGroupGloo::construct(const AlgorithmKey& key) {
     entry->src[i] = at::empty(srcSizes[i], key.type->options());
   }
 
+  // And destination tensors, for collectives that don't work in place
+  auto& dstSizes = key.dstSizes;
+  entry->dst.resize(dstSizes.size());
+  for (size_t i = 0; i < dstSizes.size(); i++) {
+    entry->dst[i] = at::empty(dstSizes[i], key.type->options());
+  }
+
 #ifdef USE_CUDA
   // If these are CUDA tensors, create streams and events
   if (key.type->is_cuda()) {
@@ -537,7 +594,40 @@ EntryType ProcessGroupGloo::construct(const AlgorithmKey& key) {
   return entry;
 }
 
+void ProcessGroupGloo::touch(const AlgorithmKey& key) {
+  auto it = cacheKeyPositions_.find(key);
+  if (it != cacheKeyPositions_.end()) {
+    cacheKeys_.splice(cacheKeys_.begin(), cacheKeys_, it->second);
+    return;
+  }
+
+  cacheKeys_.push_front(key);
+  cacheKeyPositions_[key] = cacheKeys_.begin();
+  if (cacheMaxAlgorithmKeys_ <= 0 ||
+      cacheKeys_.size() <= static_cast<size_t>(cacheMaxAlgorithmKeys_)) {
+    return;
+  }
+
+  // Evict the least recently used key, once its entries are no longer in use
+  const auto& victim = cacheKeys_.back();
+  for (auto& entry : cache_[victim]) {
+    if (!entry) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(entry->m);
+    while (entry->busy) {
+      entry->cv.wait(lock);
+    }
+  }
+  cache_.erase(victim);
+  cacheCurrentEntry_.erase(victim);
+  cacheKeyPositions_.erase(victim);
+  cacheKeys_.pop_back();
+}
+
 AlgorithmEntry* ProcessGroupGloo::checkout(const AlgorithmKey& key) {
+  touch(key);
+
   auto& vec = cache_[key];
   const auto i = cacheCurrentEntry_[key];
 
@@ -631,6 +721,9 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::broadcast(
 std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
     std::vector<at::Tensor>& tensors,
     const AllreduceOptions& opts) {
+  if (tensors.size() == 1 && tensors[0].is_sparse()) {
+    return allreduceSparse(tensors[0], opts);
+  }
   assertSameSizeAndType(tensors);
 
   AlgorithmKey key;
@@ -678,6 +771,314 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
   return enqueue(entry);
 }
 
+namespace {
+
+// Tags of user sends and receives are non-negative ints. Internal tags have
+// the top bit set, and sparse allreduces also the next one.
+constexpr uint32_t kAlltoallTag = 1u << 31;
+constexpr uint32_t kSparseAllreduceTag = (1u << 31) | (1u << 30);
+constexpr uint32_t kSparseAllreduceCountMask = (1u << 30) - 1;
+
+// Sends buffers[rank] to every other process, and receives buffers[peer]
+// from every peer. Empty buffers are skipped on both ends.
+void allgatherUnbound(
+    const std::shared_ptr<::gloo::Context>& context,
+    uint32_t tag,
+    std::vector<at::Tensor>& buffers) {
+  const auto rank = context->rank;
+  auto bytes = [](const at::Tensor& t) {
+    return t.numel() * t.type().elementSizeInBytes();
+  };
+  std::vector<std::unique_ptr<::gloo::transport::UnboundBuffer>> sends;
+  std::vector<std::unique_ptr<::gloo::transport::UnboundBuffer>> recvs;
+  for (int peer = 0; peer < context->size; peer++) {
+    if (peer == rank) {
+      continue;
+    }
+    if (bytes(buffers[rank]) > 0) {
+      sends.push_back(context->createUnboundBuffer(
+          buffers[rank].data_ptr(), bytes(buffers[rank])));
+      sends.back()->send(peer, tag);
+    }
+    if (bytes(buffers[peer]) > 0) {
+      recvs.push_back(context->createUnboundBuffer(
+          buffers[peer].data_ptr(), bytes(buffers[peer])));
+      recvs.back()->recv(peer, tag);
+    }
+  }
+  for (auto& buffer : recvs) {
+    buffer->waitRecv(nullptr);
+  }
+  for (auto& buffer : sends) {
+    buffer->waitSend();
+  }
+}
+
+} // namespace
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduceSparse(
+    at::Tensor& tensor,
+    const AllreduceOptions& opts) {
+  if (tensor.is_cuda()) {
+    throw std::runtime_error(
+        "ProcessGroupGloo::allreduce only supports sparse CPU tensors");
+  }
+  if (opts.reduceOp != ReduceOp::SUM) {
+    throw std::runtime_error(
+        "ProcessGroupGloo::allreduce only supports sums of sparse tensors");
+  }
+
+  // The key holds the dense shape, for the dense fallback
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::ALLREDUCE_SPARSE;
+  key.type = &tensor.type().toDense();
+  key.srcSizes = {tensor.sizes().vec()};
+  key.devices = {-1};
+  key.reduceOp = opts.reduceOp;
+
+  // Retrieve (create or wait for) cache entry
+  auto entry = checkout(key);
+
+  auto input = tensor.coalesce();
+  const auto tag =
+      kSparseAllreduceTag | (sparseAllreduceCount_++ & kSparseAllreduceCountMask);
+  entry->run = [=]() mutable {
+    auto& context = contexts_[0];
+    const auto rank = getRank();
+    const auto size = getSize();
+
+    // Exchange the number of nonzeros first, so that every process knows
+    // how much it receives and makes the same choice of dense or sparse.
+    auto countsTensor = at::zeros({size}, at::kLong);
+    countsTensor[rank].fill_(input._nnz());
+    std::vector<at::Tensor> countBuffers;
+    for (int i = 0; i < size; i++) {
+      countBuffers.push_back(countsTensor.narrow(0, i, 1));
+    }
+    allgatherUnbound(context, tag, countBuffers);
+    std::vector<int64_t> counts(
+        countsTensor.data<int64_t>(), countsTensor.data<int64_t>() + size);
+
+    at::Tensor output;
+    if (sparseAllreduceShouldDensify(input, counts)) {
+      entry->src[0].copy_(input.to_dense());
+      entry->algorithm->run();
+      output = denseToSparse(entry->src[0], input._sparseDims());
+    } else {
+      std::vector<at::Tensor> indices(size);
+      std::vector<at::Tensor> values(size);
+      const auto localValues = input._values();
+      for (int i = 0; i < size; i++) {
+        if (i == rank) {
+          indices[i] = input._indices().contiguous();
+          values[i] = localValues.contiguous();
+          continue;
+        }
+        indices[i] = at::empty({input._sparseDims(), counts[i]}, at::kLong);
+        auto valueSizes = localValues.sizes().vec();
+        valueSizes[0] = counts[i];
+        values[i] = at::empty(valueSizes, localValues.options());
+      }
+      allgatherUnbound(context, tag, indices);
+      allgatherUnbound(context, tag, values);
+      output = sumSparse(input, indices, values);
+    }
+    at::copy_sparse_to_sparse_(tensor, output);
+  };
+  return enqueue(entry);
+}
+
+// Coalesced allreduces with a similar number of elements share a staging
+// buffer. Its capacity is rounded up to one of eight steps per power of two,
+// so at most an eighth of it is padding.
+int64_t coalescedCapacity(int64_t numel) {
+  constexpr int64_t kMinCapacity = 1024;
+  if (numel <= kMinCapacity) {
+    return kMinCapacity;
+  }
+  int64_t step = 1;
+  while (step * 2 <= numel) {
+    step *= 2;
+  }
+  step /= 8;
+  return (numel + step - 1) / step * step;
+}
+
+} // namespace
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduceCoalesced(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  if (tensors.empty()) {
+    throw std::runtime_error(
+        "ProcessGroupGloo::allreduceCoalesced takes at least one tensor");
+  }
+  int64_t numel = 0;
+  for (const auto& tensor : tensors) {
+    if (tensor.type() != tensors[0].type()) {
+      throw std::runtime_error(
+          "ProcessGroupGloo::allreduceCoalesced expects tensors of the same "
+          "type");
+    }
+    numel += tensor.numel();
+  }
+  if (tensors[0].is_cuda() || tensors[0].is_sparse()) {
+    throw std::runtime_error(
+        "ProcessGroupGloo::allreduceCoalesced only supports dense CPU "
+        "tensors");
+  }
+
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::ALLREDUCE_COALESCED;
+  key.type = &tensors[0].type();
+  key.srcSizes = {{coalescedCapacity(numel)}};
+  key.devices = getDevices({tensors[0]});
+  key.reduceOp = opts.reduceOp;
+
+  // Retrieve (create or wait for) cache entry
+  auto entry = checkout(key);
+
+  // Pack the input tensors into the staging buffer. The padding at its end
+  // is reduced along, but never read.
+  int64_t offset = 0;
+  for (const auto& tensor : tensors) {
+    entry->src[0].narrow(0, offset, tensor.numel()).view_as(tensor).copy_(
+        tensor);
+    offset += tensor.numel();
+  }
+
+  entry->run = [=]() mutable {
+    entry->algorithm->run();
+    int64_t offset = 0;
+    for (auto& tensor : tensors) {
+      tensor.copy_(
+          entry->src[0].narrow(0, offset, tensor.numel()).view_as(tensor));
+      offset += tensor.numel();
+    }
+  };
+  return enqueue(entry);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::reduceScatter(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const ReduceScatterOptions& opts) {
+  if (outputTensors.size() != 1 || inputTensors.size() != 1) {
+    throw std::runtime_error(
+        "ProcessGroupGloo::reduceScatter takes a single output tensor and "
+        "a single list of input tensors");
+  }
+  auto& output = outputTensors[0];
+  auto& inputs = inputTensors[0];
+  if (inputs.size() != static_cast<size_t>(getSize())) {
+    throw std::runtime_error(
+        "ProcessGroupGloo::reduceScatter takes one input tensor per rank");
+  }
+  assertSameSizeAndType(inputs);
+  if (output.type() != inputs[0].type() ||
+      output.numel() != inputs[0].numel()) {
+    throw std::runtime_error(
+        "ProcessGroupGloo::reduceScatter expects the output tensor to have "
+        "the type and size of the input tensors");
+  }
+  if (output.is_cuda()) {
+    throw std::runtime_error(
+        "ProcessGroupGloo::reduceScatter only supports CPU tensors");
+  }
+
+  const auto numel = inputs[0].numel();
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::REDUCE_SCATTER;
+  key.type = &output.type();
+  key.srcSizes = {{getSize() * numel}};
+  key.devices = getDevices({output});
+  key.reduceOp = opts.reduceOp;
+
+  // Retrieve (create or wait for) cache entry
+  auto entry = checkout(key);
+
+  // Copy input tensors into the flat source
+  for (size_t i = 0; i < inputs.size(); i++) {
+    entry->src[0].narrow(0, i * numel, numel).copy_(inputs[i].reshape({-1}));
+  }
+
+  const auto rank = getRank();
+  entry->run = [=]() mutable {
+    entry->algorithm->run();
+    outputTensors[0].copy_(
+        entry->src[0].narrow(0, rank * numel, numel).view_as(outputTensors[0]));
+  };
+  return enqueue(entry);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::alltoall(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<at::Tensor>& inputTensors) {
+  if (inputTensors.size() != static_cast<size_t>(getSize()) ||
+      outputTensors.size() != inputTensors.size()) {
+    throw std::runtime_error(
+        "ProcessGroupGloo::alltoall takes one input and one output tensor "
+        "per rank");
+  }
+  for (size_t i = 0; i < inputTensors.size(); i++) {
+    if (inputTensors[i].type() != inputTensors[0].type() ||
+        outputTensors[i].type() != inputTensors[0].type()) {
+      throw std::runtime_error(
+          "ProcessGroupGloo::alltoall expects tensors of the same type");
+    }
+  }
+  if (inputTensors[0].is_cuda()) {
+    throw std::runtime_error(
+        "ProcessGroupGloo::alltoall only supports CPU tensors");
+  }
+
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::ALLTOALL;
+  key.type = &inputTensors[0].type();
+  key.srcSizes = getSizes(inputTensors);
+  key.dstSizes = getSizes(outputTensors);
+  key.devices = getDevices(inputTensors);
+
+  // Retrieve (create or wait for) cache entry. Calls with the same signature
+  // share an entry, so they run one at a time and can share a tag.
+  auto entry = checkout(key);
+
+  for (size_t i = 0; i < inputTensors.size(); i++) {
+    entry->src[i].copy_(inputTensors[i]);
+  }
+
+  entry->run = [=]() mutable {
+    auto& context = contexts_[0];
+    const auto rank = getRank();
+    std::vector<std::unique_ptr<::gloo::transport::UnboundBuffer>> sends;
+    std::vector<std::unique_ptr<::gloo::transport::UnboundBuffer>> recvs;
+    for (int peer = 0; peer < getSize(); peer++) {
+      if (peer == rank) {
+        entry->dst[peer].copy_(entry->src[peer]);
+        continue;
+      }
+      auto& src = entry->src[peer];
+      auto& dst = entry->dst[peer];
+      sends.push_back(context->createUnboundBuffer(
+          src.data_ptr(), src.numel() * src.type().elementSizeInBytes()));
+      sends.back()->send(peer, kAlltoallTag);
+      recvs.push_back(context->createUnboundBuffer(
+          dst.data_ptr(), dst.numel() * dst.type().elementSizeInBytes()));
+      recvs.back()->recv(peer, kAlltoallTag);
+    }
+    for (auto& buffer : recvs) {
+      buffer->waitRecv(nullptr);
+    }
+    for (auto& buffer : sends) {
+      buffer->waitSend();
+    }
+    for (size_t i = 0; i < outputTensors.size(); i++) {
+      outputTensors[i].copy_(entry->dst[i]);
+    }
+  };
+  return enqueue(entry);
+}
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::reduce(
     std::vector<at::Tensor>& /* unused */,
     const ReduceOptions& /* unused */) {
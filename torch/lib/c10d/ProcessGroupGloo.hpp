@@ -2,6 +2,7 @@
 
 #include <condition_variable>
 #include <deque>
+#include <list>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
@@ -159,6 +160,11 @@ namespace c10d {
 // before, but is still in use, the call will block and wait until the
 // entry is returned to the cache.
 //
+// The number of keys in the cache is bounded (see Options). Since every
+// process makes the same calls in the same order, they all evict the same
+// least recently used key, and Gloo algorithms are destroyed and created in
+// the same order everywhere.
+//
 // In the future, we hope to extend this to allow multiple entries per
 // key, to enable parallelism for a single key. The number of entries
 // per key must always be identical for all processes. This maximum
@@ -240,6 +246,9 @@ class ProcessGroupGloo : public ProcessGroup {
 
     const std::exception& exception() const override;
 
+    // Not supported, throws
+    void addCallback(std::function<void()> callback) override;
+
    protected:
     at::Tensor tensor_;
     std::unique_ptr<::gloo::transport::UnboundBuffer> buffer_;
@@ -264,6 +273,9 @@ class ProcessGroupGloo : public ProcessGroup {
 
     const std::exception& exception() const override;
 
+    // Not supported, throws
+    void addCallback(std::function<void()> callback) override;
+
    protected:
     at::Tensor tensor_;
     std::unique_ptr<::gloo::transport::UnboundBuffer> buffer_;
@@ -283,6 +295,12 @@ class ProcessGroupGloo : public ProcessGroup {
     // be greater than 1. More cache entries means more memory usage.
     // The default value is 1.
     int cacheNumAlgorithmEntries;
+
+    // This bounds the number of distinct keys in the algorithm cache. When
+    // it is exceeded, the entries of the least recently used key are
+    // destroyed once they are no longer in use. Zero means no bound.
+    // The default value is 256.
+    int cacheMaxAlgorithmKeys;
   };
 
   explicit ProcessGroupGloo(
@@ -297,10 +315,30 @@ class ProcessGroupGloo : public ProcessGroup {
       std::vector<at::Tensor>& data,
       const BroadcastOptions& opts = BroadcastOptions()) override;
 
+  // Sparse CPU tensors are supported for sums of a single tensor, see
+  // allreduceSparse below.
   std::shared_ptr<Work> allreduce(
       std::vector<at::Tensor>& tensors,
       const AllreduceOptions& opts = AllreduceOptions()) override;
 
+  // CPU tensors only. The tensors are packed into a staging buffer that is
+  // reused by calls with a similar total number of elements, so calls with
+  // different shapes don't each create a Gloo algorithm.
+  std::shared_ptr<ProcessGroup::Work> allreduceCoalesced(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions()) override;
+
+  // CPU tensors only
+  std::shared_ptr<ProcessGroup::Work> reduceScatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  // CPU tensors only
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<at::Tensor>& inputTensors) override;
+
   // Unsupported Ops
   std::shared_ptr<ProcessGroup::Work> reduce(
       std::vector<at::Tensor>& tensors,
@@ -362,15 +400,42 @@ class ProcessGroupGloo : public ProcessGroup {
   template <typename T>
   void createBroadcast(AlgorithmEntry& entry);
 
+  template <typename T>
+  void createReduceScatter(AlgorithmEntry& entry);
+
+  // Allgathers the indices and values of a sparse tensor and replaces it by
+  // their coalesced sum. If the gathered nonzeros would take more bytes than
+  // the dense tensor, every process switches to a dense allreduce instead.
+  // The dense staging buffer that takes is cached per shape like any other.
+  std::shared_ptr<Work> allreduceSparse(
+      at::Tensor& tensor,
+      const AllreduceOptions& opts);
+
+  // Tags the unbound buffers of the next sparse allreduce. Calls are made in
+  // the same order everywhere, so every process uses the same tag for them.
+  uint32_t sparseAllreduceCount_;
+
   // Construct creates AlgorithmEntry for specified key.
   EntryType construct(const KeyType& key);
 
   // Checkout constructs new AlgorithmEntry or returns existing one.
   AlgorithmEntry* checkout(const KeyType& key);
 
+  // Marks key as the most recently used one, evicting the least recently
+  // used key if the cache holds too many.
+  void touch(const KeyType& key);
+
   // The maximum number of cached algorithms for a single key.
   const int cacheNumAlgorithmEntries_;
 
+  // The maximum number of keys in the cache, or zero.
+  const int cacheMaxAlgorithmKeys_;
+
+  // The keys in the cache, most recently used first, and their positions.
+  std::list<KeyType> cacheKeys_;
+  std::unordered_map<KeyType, std::list<KeyType>::iterator, HashType>
+      cacheKeyPositions_;
+
   // Index of the next algorithm to use for a particular key.
   // Note that this index must be the same for all particating processes.
   std::unordered_map<KeyType, int, HashType> cacheCurrentEntry_;
@@ -0,0 +1,325 @@
+#include "ProcessGroupHierarchical.hpp"
+
+namespace c10d {
+
+namespace {
+
+// Waits for the work of a stage on the worker thread. The work has to be
+// completed, not just sequenced on CUDA streams, before the next stage is
+// launched by another process group, and for its time to be meaningful.
+void waitForStage(const std::shared_ptr<ProcessGroup::Work>& work) {
+  while (!work->isCompleted()) {
+    std::this_thread::yield();
+  }
+  if (!work->wait()) {
+    throw std::runtime_error(work->exception().what());
+  }
+}
+
+} // namespace
+
+// ProcessGroupHierarchical::WorkHierarchical
+ProcessGroupHierarchical::WorkHierarchical::WorkHierarchical()
+    : completed_(false) {}
+
+ProcessGroupHierarchical::WorkHierarchical::~WorkHierarchical() {}
+
+bool ProcessGroupHierarchical::WorkHierarchical::isCompleted() {
+  return completed_;
+}
+
+bool ProcessGroupHierarchical::WorkHierarchical::isSuccess() const {
+  return !exception_;
+}
+
+void ProcessGroupHierarchical::WorkHierarchical::synchronize() {
+  if (lastStage_) {
+    lastStage_->synchronize();
+  }
+}
+
+bool ProcessGroupHierarchical::WorkHierarchical::wait() {
+  std::unique_lock<std::mutex> lock(workMutex_);
+  while (!completed_) {
+    workCV_.wait(lock);
+  }
+  if (!isSuccess()) {
+    return false;
+  }
+  lock.unlock();
+  synchronize();
+  return true;
+}
+
+void ProcessGroupHierarchical::WorkHierarchical::finish(
+    std::shared_ptr<ProcessGroup::Work> lastStage) {
+  {
+    std::unique_lock<std::mutex> lock(workMutex_);
+    lastStage_ = std::move(lastStage);
+    completed_ = true;
+  }
+  workCV_.notify_all();
+  runCallbacks();
+}
+
+void ProcessGroupHierarchical::WorkHierarchical::finishWithException(
+    std::exception_ptr caughtWorkException) {
+  {
+    std::unique_lock<std::mutex> lock(workMutex_);
+    completed_ = true;
+    exception_ = caughtWorkException;
+  }
+  workCV_.notify_all();
+  runCallbacks();
+}
+
+const std::exception& ProcessGroupHierarchical::WorkHierarchical::exception()
+    const {
+  try {
+    std::rethrow_exception(exception_);
+  } catch (const std::exception& e) {
+    return e;
+  }
+}
+
+// ProcessGroupHierarchical
+ProcessGroupHierarchical::ProcessGroupHierarchical(
+    int rank,
+    int size,
+    std::shared_ptr<ProcessGroup> intraNodeGroup,
+    std::shared_ptr<ProcessGroup> interNodeGroup)
+    : ProcessGroup(rank, size),
+      intraNodeGroup_(std::move(intraNodeGroup)),
+      interNodeGroup_(std::move(interNodeGroup)),
+      stop_(false) {
+  if (!intraNodeGroup_) {
+    throw std::runtime_error(
+        "ProcessGroupHierarchical requires an intra-node process group");
+  }
+  if (isNodeLeader() != static_cast<bool>(interNodeGroup_)) {
+    throw std::runtime_error(
+        "ProcessGroupHierarchical requires an inter-node process group on "
+        "node leaders, and only on node leaders");
+  }
+
+  // Start the worker thread running the stages after the first
+  workerThread_ = std::thread(&ProcessGroupHierarchical::runLoop, this);
+}
+
+ProcessGroupHierarchical::~ProcessGroupHierarchical() {
+  std::unique_lock<std::mutex> lock(pgMutex_);
+
+  while (!queue_.empty()) {
+    queueConsumeCV_.wait(lock);
+  }
+  // Queue is empty, signal stop
+  stop_ = true;
+
+  // Release lock to allow threads to terminate
+  queueProduceCV_.notify_all();
+
+  lock.unlock();
+
+  // Join the single worker thread
+  workerThread_.join();
+}
+
+void ProcessGroupHierarchical::runLoop() {
+  std::unique_lock<std::mutex> lock(pgMutex_);
+
+  while (!stop_) {
+    if (queue_.empty()) {
+      queueProduceCV_.wait(lock);
+      continue;
+    }
+
+    auto workPair = std::move(queue_.front());
+
+    queue_.pop_front();
+    queueConsumeCV_.notify_one();
+
+    auto& fn = workPair.first;
+    auto& work = workPair.second;
+
+    lock.unlock();
+
+    try {
+      work->finish(fn());
+    } catch (...) {
+      work->finishWithException(std::current_exception());
+    }
+
+    lock.lock();
+  }
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::enqueue(
+    WorkFunc fn) {
+  auto work = std::make_shared<WorkHierarchical>();
+  std::unique_lock<std::mutex> lock(pgMutex_);
+  queue_.push_back(std::make_pair(std::move(fn), work));
+  queueProduceCV_.notify_one();
+  return work;
+}
+
+void ProcessGroupHierarchical::finishStage(
+    Stage stage,
+    const std::shared_ptr<ProcessGroup::Work>& work,
+    Clock::time_point start) {
+  waitForStage(work);
+  const auto elapsed = Clock::now() - start;
+
+  std::unique_lock<std::mutex> lock(stageTimesMutex_);
+  auto& stageTime = stageTimes_[static_cast<size_t>(stage)];
+  stageTime.count++;
+  stageTime.total +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+}
+
+ProcessGroupHierarchical::StageTimes ProcessGroupHierarchical::getStageTimes() {
+  std::unique_lock<std::mutex> lock(stageTimesMutex_);
+  return stageTimes_;
+}
+
+void ProcessGroupHierarchical::resetStageTimes() {
+  std::unique_lock<std::mutex> lock(stageTimesMutex_);
+  stageTimes_ = StageTimes();
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allreduce(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  if (tensors.empty()) {
+    throw std::runtime_error(
+        "ProcessGroupHierarchical::allreduce requires at least one tensor");
+  }
+
+  ReduceOptions reduceOpts;
+  reduceOpts.reduceOp = opts.reduceOp;
+  reduceOpts.rootRank = 0;
+  reduceOpts.rootTensor = 0;
+
+  const auto reduceStart = Clock::now();
+  auto reduceWork = intraNodeGroup_->reduce(tensors, reduceOpts);
+
+  return enqueue([this, tensors, opts, reduceWork, reduceStart]() mutable {
+    finishStage(Stage::INTRA_NODE_REDUCE, reduceWork, reduceStart);
+
+    if (isNodeLeader()) {
+      // The reduction of the node is in the first tensor
+      std::vector<at::Tensor> nodeTensors = {tensors[0]};
+      const auto allreduceStart = Clock::now();
+      auto allreduceWork = interNodeGroup_->allreduce(nodeTensors, opts);
+      finishStage(Stage::INTER_NODE_ALLREDUCE, allreduceWork, allreduceStart);
+    }
+
+    BroadcastOptions broadcastOpts;
+    broadcastOpts.rootRank = 0;
+    broadcastOpts.rootTensor = 0;
+    const auto broadcastStart = Clock::now();
+    auto broadcastWork = intraNodeGroup_->broadcast(tensors, broadcastOpts);
+    finishStage(Stage::INTRA_NODE_BROADCAST, broadcastWork, broadcastStart);
+    return broadcastWork;
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::barrier() {
+  auto intraNodeWork = intraNodeGroup_->barrier();
+
+  return enqueue([this, intraNodeWork]() {
+    waitForStage(intraNodeWork);
+    if (isNodeLeader()) {
+      waitForStage(interNodeGroup_->barrier());
+    }
+    // Processes may only leave once all node leaders entered
+    auto work = intraNodeGroup_->barrier();
+    waitForStage(work);
+    return work;
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::broadcast(
+    std::vector<at::Tensor>& /* unused */,
+    const BroadcastOptions& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupHierarchical does not support broadcast");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::reduce(
+    std::vector<at::Tensor>& /* unused */,
+    const ReduceOptions& /* unused */) {
+  throw std::runtime_error("ProcessGroupHierarchical does not support reduce");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allgather(
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    std::vector<at::Tensor>& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupHierarchical does not support allgather");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::gather(
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    std::vector<at::Tensor>& /* unused */,
+    const GatherOptions& /* unused */) {
+  throw std::runtime_error("ProcessGroupHierarchical does not support gather");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::scatter(
+    std::vector<at::Tensor>& /* unused */,
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    const ScatterOptions& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupHierarchical does not support scatter");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::reduceScatter(
+    std::vector<at::Tensor>& /* unused */,
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    const ReduceScatterOptions& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupHierarchical does not support reduceScatter");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allreduceCoalesced(
+    std::vector<at::Tensor>& /* unused */,
+    const AllreduceOptions& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupHierarchical does not support allreduceCoalesced");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::alltoall(
+    std::vector<at::Tensor>& /* unused */,
+    std::vector<at::Tensor>& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupHierarchical does not support alltoall");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::send(
+    std::vector<at::Tensor>& /* unused */,
+    int /* unused */,
+    int /* unused */) {
+  throw std::runtime_error("ProcessGroupHierarchical does not support send");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::recv(
+    std::vector<at::Tensor>& /* unused */,
+    int /* unused */,
+    int /* unused */) {
+  throw std::runtime_error("ProcessGroupHierarchical does not support recv");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::recvAnysource(
+    std::vector<at::Tensor>& /* unused */,
+    int* /* unused */,
+    int /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupHierarchical does not support recvAnysource");
+}
+
+std::unordered_map<int, int> ProcessGroupHierarchical::getGroupRank() {
+  throw std::runtime_error(
+      "ProcessGroupHierarchical does not support getGroupRank");
+}
+
+} // namespace c10d
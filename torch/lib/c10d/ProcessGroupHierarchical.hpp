@@ -0,0 +1,208 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <c10d/ProcessGroup.hpp>
+#include <c10d/Types.hpp>
+
+namespace c10d {
+
+// ProcessGroupHierarchical implements allreduce on top of two process groups
+// that follow the topology of the cluster: one between the processes of a
+// node (e.g. ProcessGroupNCCL over NVLink), and one between the first
+// process of every node, the node leaders (e.g. ProcessGroupGloo or
+// ProcessGroupNCCL over the network).
+//
+// An allreduce is executed in three stages:
+//
+//   1) reduce the tensors to the node leader over the intra-node group,
+//   2) allreduce the result across node leaders over the inter-node group,
+//   3) broadcast the result from the node leader over the intra-node group.
+//
+// Only 1/local_size of the data crosses the network, compared to a flat ring
+// over all processes, whose bandwidth is bounded by the slowest link.
+//
+// The node leader is rank 0 of the intra-node group. The inter-node group
+// must be given on node leaders, and only on node leaders. The intra-node
+// group has to support reduce and broadcast, and the inter-node group
+// allreduce, for the tensors passed to allreduce.
+//
+// The first stage is launched by the calling thread, so it is sequenced
+// after prior work on the caller's CUDA streams. The other stages are run by
+// a worker thread owned by the process group, in the order the collectives
+// were called. The wall time of every stage, from its launch until it
+// completes, is accumulated and can be read with getStageTimes().
+//
+// All functions on this class are expected to be called in the same order
+// across processes in the group.
+class ProcessGroupHierarchical : public ProcessGroup {
+ public:
+  enum class Stage : uint8_t {
+    INTRA_NODE_REDUCE = 0,
+    INTER_NODE_ALLREDUCE,
+    INTRA_NODE_BROADCAST,
+    NUM_STAGES,
+  };
+
+  struct StageTime {
+    // Number of times the stage ran
+    uint64_t count = 0;
+    std::chrono::nanoseconds total{0};
+  };
+
+  using StageTimes =
+      std::array<StageTime, static_cast<size_t>(Stage::NUM_STAGES)>;
+
+  class WorkHierarchical : public ProcessGroup::Work {
+   public:
+    WorkHierarchical();
+    virtual ~WorkHierarchical();
+
+    bool isCompleted() override;
+
+    bool isSuccess() const override;
+
+    // Sequences the caller's CUDA streams after the last stage
+    void synchronize() override;
+
+    bool wait() override;
+
+    const std::exception& exception() const override;
+
+   protected:
+    void finish(std::shared_ptr<ProcessGroup::Work> lastStage);
+    void finishWithException(std::exception_ptr caughtWorkException);
+
+    std::mutex workMutex_;
+    std::condition_variable workCV_;
+    std::atomic<bool> completed_;
+    std::exception_ptr exception_;
+    std::shared_ptr<ProcessGroup::Work> lastStage_;
+
+    friend class ProcessGroupHierarchical;
+  };
+
+  // Rank and size are the rank of this process and the number of processes
+  // over all nodes. The worker thread is spawned by the constructor.
+  explicit ProcessGroupHierarchical(
+      int rank,
+      int size,
+      std::shared_ptr<ProcessGroup> intraNodeGroup,
+      std::shared_ptr<ProcessGroup> interNodeGroup);
+
+  virtual ~ProcessGroupHierarchical();
+
+  bool isNodeLeader() const {
+    return intraNodeGroup_->getRank() == 0;
+  }
+
+  // Accumulated wall time of every stage on this process, indexed by Stage.
+  // The inter-node stage only runs on node leaders.
+  StageTimes getStageTimes();
+
+  void resetStageTimes();
+
+  std::shared_ptr<ProcessGroup::Work> allreduce(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions()) override;
+
+  // Requires both groups to support barrier
+  std::shared_ptr<ProcessGroup::Work> barrier() override;
+
+  // Unsupported Ops
+  std::shared_ptr<ProcessGroup::Work> broadcast(
+      std::vector<at::Tensor>& tensors,
+      const BroadcastOptions& opts = BroadcastOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> reduce(
+      std::vector<at::Tensor>& tensors,
+      const ReduceOptions& opts = ReduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allgather(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<at::Tensor>& inputTensors) override;
+
+  std::shared_ptr<ProcessGroup::Work> gather(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<at::Tensor>& inputTensors,
+      const GatherOptions& opts = GatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> scatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ScatterOptions& opts = ScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> reduceScatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allreduceCoalesced(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<at::Tensor>& inputTensors) override;
+
+  std::shared_ptr<ProcessGroup::Work> send(
+      std::vector<at::Tensor>& tensors,
+      int dstRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recv(
+      std::vector<at::Tensor>& tensors,
+      int srcRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recvAnysource(
+      std::vector<at::Tensor>& tensors,
+      int* srcRank,
+      int tag) override;
+
+  std::unordered_map<int, int> getGroupRank() override;
+
+ protected:
+  using Clock = std::chrono::steady_clock;
+  // Runs the remaining stages of a collective, returns the work of the last
+  using WorkFunc = std::function<std::shared_ptr<ProcessGroup::Work>()>;
+  using WorkType = std::pair<WorkFunc, std::shared_ptr<WorkHierarchical>>;
+
+  void runLoop();
+
+  std::shared_ptr<ProcessGroup::Work> enqueue(WorkFunc fn);
+
+  // Waits for the work of a stage launched at `start` and accounts for its
+  // time. Throws if the stage failed.
+  void finishStage(
+      Stage stage,
+      const std::shared_ptr<ProcessGroup::Work>& work,
+      Clock::time_point start);
+
+  std::shared_ptr<ProcessGroup> intraNodeGroup_;
+  std::shared_ptr<ProcessGroup> interNodeGroup_;
+
+  bool stop_;
+
+  std::mutex pgMutex_;
+  std::thread workerThread_;
+
+  std::deque<WorkType> queue_;
+  std::condition_variable queueProduceCV_;
+  std::condition_variable queueConsumeCV_;
+
+  std::mutex stageTimesMutex_;
+  StageTimes stageTimes_;
+};
+
+} // namespace c10d
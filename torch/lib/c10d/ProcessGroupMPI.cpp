@@ -117,6 +117,7 @@ void ProcessGroupMPI::WorkMPI::finish() {
     completed_ = true;
   }
   workCV_.notify_all();
+  runCallbacks();
 }
 
 void ProcessGroupMPI::WorkMPI::finishWithException(
@@ -127,6 +128,7 @@ void ProcessGroupMPI::WorkMPI::finishWithException(
     exception_ = caughtWorkException;
   }
   workCV_.notify_all();
+  runCallbacks();
 }
 
 const std::exception& ProcessGroupMPI::WorkMPI::exception() const {
@@ -217,6 +219,12 @@ const std::exception& ProcessGroupMPI::AsyncWork::exception() const {
   }
 }
 
+void ProcessGroupMPI::AsyncWork::addCallback(
+    std::function<void()> /* unused */) {
+  // Completion is only observable by testing or waiting on the request
+  throw std::runtime_error("addCallback is not supported for send/recv work");
+}
+
 void ProcessGroupMPI::AsyncWork::populateException() {
   std::array<char, MPI_MAX_ERROR_STRING> buf;
   int len = buf.size();
@@ -660,6 +668,100 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::scatter(
   }
 }
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::reduceScatter(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const ReduceScatterOptions& opts) {
+  if (pgComm_ == MPI_COMM_NULL) {
+    return nullptr;
+  }
+  checkSingleTensor(outputTensors);
+  if (inputTensors.size() != 1) {
+    throw std::runtime_error(
+        "Reduce scatter: multi-GPU collective is not supported");
+  }
+  if (static_cast<size_t>(groupSize_) != inputTensors[0].size()) {
+    throw std::runtime_error(
+        "Reduce scatter: number of input tensors should equal "
+        "to the world size");
+  }
+  checkSameSizeAndType(outputTensors[0], inputTensors[0]);
+
+  std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
+      [opts, this](std::unique_ptr<WorkEntry>& entry) {
+        auto data = (entry->dst)[0];
+        auto flatInputTensor = newLikeFlat(entry->src);
+        for (size_t i = 0; i < entry->src.size(); ++i) {
+          flatInputTensor[i].copy_(entry->src[i]);
+        }
+
+        std::unique_lock<std::mutex> globalLock(pgGlobalMutex_);
+        MPI_CHECK(MPI_Reduce_scatter_block(
+            flatInputTensor.data_ptr(),
+            data.data_ptr(),
+            data.numel(),
+            mpiDatatype.at(data.type().scalarType()),
+            mpiOp.at(opts.reduceOp),
+            pgComm_));
+      };
+  auto entry = std::unique_ptr<WorkEntry>(
+      new WorkEntry(&inputTensors[0], &outputTensors, std::move(runFunc)));
+  return enqueue(std::move(entry));
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::allreduceCoalesced(
+    std::vector<at::Tensor>& /* unused */,
+    const AllreduceOptions& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupMPI does not support allreduceCoalesced");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::alltoall(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<at::Tensor>& inputTensors) {
+  if (pgComm_ == MPI_COMM_NULL) {
+    return nullptr;
+  }
+  if (static_cast<size_t>(groupSize_) != inputTensors.size() ||
+      static_cast<size_t>(groupSize_) != outputTensors.size()) {
+    throw std::runtime_error(
+        "All to all: number of input and output tensors should equal "
+        "to the world size");
+  }
+  checkSameSizeAndType(inputTensors[0], inputTensors);
+  checkSameSizeAndType(inputTensors[0], outputTensors);
+
+  std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
+      [this](std::unique_ptr<WorkEntry>& entry) {
+        auto flatInputTensor = newLikeFlat(entry->src);
+        for (size_t i = 0; i < entry->src.size(); ++i) {
+          flatInputTensor[i].copy_(entry->src[i]);
+        }
+        auto flatOutputTensor = newLikeFlat(entry->dst);
+        auto count = entry->src[0].numel();
+        auto datatype = mpiDatatype.at(entry->src[0].type().scalarType());
+
+        {
+          std::unique_lock<std::mutex> globalLock(pgGlobalMutex_);
+          MPI_CHECK(MPI_Alltoall(
+              flatInputTensor.data_ptr(),
+              count,
+              datatype,
+              flatOutputTensor.data_ptr(),
+              count,
+              datatype,
+              pgComm_));
+        }
+
+        for (size_t i = 0; i < entry->dst.size(); ++i) {
+          entry->dst[i].copy_(flatOutputTensor[i]);
+        }
+      };
+  auto entry = std::unique_ptr<WorkEntry>(
+      new WorkEntry(&inputTensors, &outputTensors, std::move(runFunc)));
+  return enqueue(std::move(entry));
+}
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::send(
     std::vector<at::Tensor>& tensors,
     int dstRank,
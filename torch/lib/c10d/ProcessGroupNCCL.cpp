@@ -1,5 +1,6 @@
 #include "ProcessGroupNCCL.hpp"
 
+#include <algorithm>
 #include <map>
 #include <unordered_set>
 
@@ -153,15 +154,25 @@ const std::exception& ProcessGroupNCCL::WorkNCCL::exception() const {
       "isCompleted() and wait() will either succeed or throw");
 }
 
+void ProcessGroupNCCL::WorkNCCL::addCallback(std::function<void()> callback) {
+  synchronize();
+  callback();
+}
+
 std::unordered_map<ssize_t, ssize_t> ProcessGroupNCCL::pgUniqueNCCLIDCnt_;
 ssize_t ProcessGroupNCCL::processGroupCounter_ = -1;
 std::mutex ProcessGroupNCCL::pgTrackingLock_;
 
+ProcessGroupNCCL::Options::Options() : highPriorityStreams(true) {}
+
 ProcessGroupNCCL::ProcessGroupNCCL(
     const std::shared_ptr<Store>& store,
     int rank,
-    int size)
-    : ProcessGroup(rank, size), store_(store) {
+    int size,
+    Options options)
+    : ProcessGroup(rank, size),
+      store_(store),
+      highPriorityStreams_(options.highPriorityStreams) {
   thcState_ = ::at::globalContext().lazyInitCUDA();
   // Generate the Process Group ID for current PG, this needs to be identical
   // for all processes
@@ -169,6 +180,16 @@ ProcessGroupNCCL::ProcessGroupNCCL(
   ++processGroupCounter_;
   pgUniqueNCCLIDCnt_[processGroupCounter_] = -1;
   processGroupID_ = std::to_string(processGroupCounter_);
+  lock.unlock();
+
+  for (const auto& deviceSet : options.deviceSets) {
+    std::vector<at::Device> devices;
+    devices.reserve(deviceSet.size());
+    for (auto index : deviceSet) {
+      devices.emplace_back(at::kCUDA, index);
+    }
+    getNCCLComm(getKeyFromDevices(devices), devices);
+  }
 }
 
 ProcessGroupNCCL::~ProcessGroupNCCL() {
@@ -258,7 +279,7 @@ std::vector<std::shared_ptr<NCCLComm>>& ProcessGroupNCCL::getNCCLComm(
     ncclComms[i] = NCCLComm::create(numRanks, rank, ncclID);
 
     // Also create the NCCL streams and events
-    streamVal[i] = CUDAStream::create();
+    streamVal[i] = CUDAStream::create(highPriorityStreams_);
     // Event created using cudaEventDisableTiming flag and not
     // cudaEventBlockingSync flag will provide the best performance when used
     // with cudaStreamWaitEvent() and cudaEventQuery(). Since we here don't
@@ -356,6 +377,9 @@ void ProcessGroupNCCL::tensorCheckHelper(
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
     std::vector<at::Tensor>& tensors,
     const AllreduceOptions& opts) {
+  if (tensors.size() == 1 && tensors[0].is_sparse()) {
+    return allreduceSparse(tensors[0], opts);
+  }
   tensorCheckHelper(tensors, tensors);
 
   auto devices = getDeviceList(tensors);
@@ -403,6 +427,74 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
   return work;
 }
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduceSparse(
+    at::Tensor& tensor,
+    const AllreduceOptions& opts) {
+  if (opts.reduceOp != ReduceOp::SUM) {
+    throw std::runtime_error(
+        "ProcessGroupNCCL::allreduce only supports sums of sparse tensors");
+  }
+  at::DeviceGuard gpuGuard(tensor.get_device());
+  auto input = tensor.coalesce();
+  const auto sparseDims = input._sparseDims();
+  const auto indexOptions = input._indices().options();
+
+  // Gather the number of nonzeros of every process
+  std::vector<at::Tensor> countInputs = {
+      at::empty({1}, indexOptions).fill_(input._nnz())};
+  std::vector<std::vector<at::Tensor>> countOutputs(1);
+  for (int i = 0; i < size_; i++) {
+    countOutputs[0].push_back(at::empty({1}, indexOptions));
+  }
+  auto work = allgather(countOutputs, countInputs);
+  work->wait();
+  auto countsTensor = at::cat(countOutputs[0]).cpu();
+  std::vector<int64_t> counts(
+      countsTensor.data<int64_t>(), countsTensor.data<int64_t>() + size_);
+
+  if (sparseAllreduceShouldDensify(input, counts)) {
+    std::vector<at::Tensor> dense = {input.to_dense()};
+    work = allreduce(dense, opts);
+    work->wait();
+    at::copy_sparse_to_sparse_(tensor, denseToSparse(dense[0], sparseDims));
+    return work;
+  }
+
+  // NCCL gathers tensors of equal sizes, so pad to the largest count
+  const auto maxCount = *std::max_element(counts.begin(), counts.end());
+  if (maxCount == 0) {
+    return work;
+  }
+  const auto localValues = input._values();
+  auto valueSizes = localValues.sizes().vec();
+  valueSizes[0] = maxCount;
+  std::vector<at::Tensor> indexInputs = {
+      at::zeros({sparseDims, maxCount}, indexOptions)};
+  std::vector<at::Tensor> valueInputs = {
+      at::zeros(valueSizes, localValues.options())};
+  indexInputs[0].narrow(1, 0, input._nnz()).copy_(input._indices());
+  valueInputs[0].narrow(0, 0, input._nnz()).copy_(localValues);
+
+  std::vector<std::vector<at::Tensor>> indexOutputs(1);
+  std::vector<std::vector<at::Tensor>> valueOutputs(1);
+  for (int i = 0; i < size_; i++) {
+    indexOutputs[0].push_back(at::empty_like(indexInputs[0]));
+    valueOutputs[0].push_back(at::empty_like(valueInputs[0]));
+  }
+  allgather(indexOutputs, indexInputs)->wait();
+  work = allgather(valueOutputs, valueInputs);
+  work->wait();
+
+  std::vector<at::Tensor> indices;
+  std::vector<at::Tensor> values;
+  for (int i = 0; i < size_; i++) {
+    indices.push_back(indexOutputs[0][i].narrow(1, 0, counts[i]));
+    values.push_back(valueOutputs[0][i].narrow(0, 0, counts[i]));
+  }
+  at::copy_sparse_to_sparse_(tensor, sumSparse(input, indices, values));
+  return work;
+}
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::broadcast(
     std::vector<at::Tensor>& tensors,
     const BroadcastOptions& opts) {
@@ -583,6 +675,97 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather(
   return work;
 }
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduceScatter(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const ReduceScatterOptions& opts) {
+  if (outputTensors.size() != inputTensors.size()) {
+    throw std::runtime_error("reduce_scatter: input and output size mismatch");
+  }
+  std::vector<at::Tensor> flattenInputTensors;
+  flattenInputTensors.resize(inputTensors.size());
+
+  for (size_t i = 0; i < inputTensors.size(); ++i) {
+    tensorCheckHelper(
+        std::vector<at::Tensor>{outputTensors[i]},
+        inputTensors[i],
+        size_ * outputTensors.size());
+    // Flatten the input tensors (for all ranks) to a single big tensor
+    flattenInputTensors[i] = newLikeFlat(inputTensors, i);
+
+    if (static_cast<size_t>(flattenInputTensors[i].numel()) !=
+        outputTensors[i].numel() * size_ * outputTensors.size()) {
+      throw std::runtime_error("Unexpected size for flatten tensor");
+    }
+  }
+
+  auto devices = getDeviceList(outputTensors);
+  auto key = getKeyFromDevices(devices);
+  auto& ncclComms = getNCCLComm(key, devices);
+
+  at::DeviceGuard gpuGuard;
+
+  // Copy the inputs to the flattened input tensors on the THC stream, so
+  // that the NCCL streams wait for the copies below
+  for (size_t i = 0; i < inputTensors.size(); ++i) {
+    gpuGuard.set_index(devices[i].index());
+    for (size_t j = 0; j < inputTensors[0].size(); ++j) {
+      flattenInputTensors[i][j].copy_(inputTensors[i][j], true);
+    }
+  }
+
+  // First let NCCL streams wait for THC stream
+  syncStreams(thcState_, devices, ncclEvents_[key], ncclStreams_[key]);
+
+  // Work itself will create the CUDA events on all GPUs of tensors
+  auto work = std::make_shared<ProcessGroupNCCL::WorkNCCL>(devices);
+
+  std::unique_lock<std::mutex> cudaFreeMutexLock(
+      *(THCCachingAllocator_getCudaFreeMutex()));
+
+  C10D_NCCL_CHECK(ncclGroupStart());
+
+  for (size_t i = 0; i < outputTensors.size(); ++i) {
+    gpuGuard.set_index(devices[i].index());
+
+    CUDAStream& ncclStream = ncclStreams_[key][i];
+
+    C10D_NCCL_CHECK(ncclReduceScatter(
+        flattenInputTensors[i].data_ptr(),
+        outputTensors[i].data_ptr(),
+        outputTensors[i].numel(),
+        getNcclDataType(outputTensors[i].type().scalarType()),
+        ncclOp[opts.reduceOp],
+        ncclComms[i]->getNcclComm(),
+        ncclStream.getStream()));
+  }
+
+  C10D_NCCL_CHECK(ncclGroupEnd());
+
+  // Event should only be recorded after the ncclGroupEnd()
+  for (size_t i = 0; i < outputTensors.size(); ++i) {
+    CUDAStream& ncclStream = ncclStreams_[key][i];
+    CUDAEvent& cudaEvent = work->cudaEvents_[i];
+
+    C10D_CUDA_CHECK(
+        cudaEventRecord(cudaEvent.getEvent(), ncclStream.getStream()));
+  }
+  return work;
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduceCoalesced(
+    std::vector<at::Tensor>& /* unused */,
+    const AllreduceOptions& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupNCCL does not support allreduceCoalesced");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall(
+    std::vector<at::Tensor>& /* unused */,
+    std::vector<at::Tensor>& /* unused */) {
+  throw std::runtime_error("ProcessGroupNCCL does not support alltoall");
+}
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::gather(
     std::vector<std::vector<at::Tensor>>& /* unused */,
     std::vector<at::Tensor>& /* unused */,
@@ -55,6 +55,9 @@ namespace c10d {
 //   work->wait()
 //
 //   // Now continue on other work in the THC stream.
+//
+// The NCCL kernels run on high priority streams by default, so that they
+// keep overlapping with compute kernels instead of waiting behind them.
 class ProcessGroupNCCL : public ProcessGroup {
  public:
   class WorkNCCL : public ProcessGroup::Work {
@@ -82,6 +85,11 @@ class ProcessGroupNCCL : public ProcessGroup {
     // Not supported by WorkNCCL
     const std::exception& exception() const override;
 
+    // Runs callback right away, after synchronize(). Since the NCCL kernels
+    // are already queued, CUDA work issued by the callback on the current
+    // streams is ordered after them without blocking the host.
+    void addCallback(std::function<void()> callback) override;
+
     // Helper function that checks if the NCCL kernels have finished
     // execution on the GPUs
     bool finishedGPUExecution() const;
@@ -96,8 +104,26 @@ class ProcessGroupNCCL : public ProcessGroup {
     friend class ProcessGroupNCCL;
   };
 
+  struct Options {
+    explicit Options();
+
+    // The device sets to create the NCCL communicators for at construction,
+    // in the order of the tensors of the collectives that will use them
+    // (see devNCCLCommMap_). Otherwise the communicators are created by the
+    // first collective on every device set, which stalls it. Every process
+    // must pass the same number of device sets.
+    std::vector<std::vector<int>> deviceSets;
+
+    // Run the NCCL kernels on high priority streams. The default is true.
+    bool highPriorityStreams;
+  };
+
   // Constructor will also check the number of available GPUs in the system
-  ProcessGroupNCCL(const std::shared_ptr<Store>& store, int rank, int size);
+  ProcessGroupNCCL(
+      const std::shared_ptr<Store>& store,
+      int rank,
+      int size,
+      Options options = Options());
 
   virtual ~ProcessGroupNCCL();
 
@@ -105,6 +131,8 @@ class ProcessGroupNCCL : public ProcessGroup {
       std::vector<at::Tensor>& tensors,
       const BroadcastOptions& opts = BroadcastOptions()) override;
 
+  // Sparse tensors are supported for sums of a single tensor, see
+  // allreduceSparse below.
   std::shared_ptr<ProcessGroup::Work> allreduce(
       std::vector<at::Tensor>& tensors,
       const AllreduceOptions& opts = AllreduceOptions()) override;
@@ -117,7 +145,20 @@ class ProcessGroupNCCL : public ProcessGroup {
       std::vector<std::vector<at::Tensor>>& outputTensors,
       std::vector<at::Tensor>& inputTensors) override;
 
+  std::shared_ptr<ProcessGroup::Work> reduceScatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
   // Unsupported Ops
+  std::shared_ptr<ProcessGroup::Work> allreduceCoalesced(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<at::Tensor>& inputTensors) override;
+
   std::shared_ptr<ProcessGroup::Work> gather(
       std::vector<std::vector<at::Tensor>>& outputTensors,
       std::vector<at::Tensor>& inputTensors,
@@ -157,6 +198,14 @@ class ProcessGroupNCCL : public ProcessGroup {
       const std::string& devicesKey,
       const std::vector<at::Device>& devices);
 
+  // Allgathers the indices and values of a sparse tensor and replaces it by
+  // their coalesced sum, or allreduces it densely if the gathered nonzeros
+  // would take more bytes. The host synchronizes once, to read the number
+  // of nonzeros of every process.
+  std::shared_ptr<ProcessGroup::Work> allreduceSparse(
+      at::Tensor& tensor,
+      const AllreduceOptions& opts);
+
   // Tensor checker helper
   void tensorCheckHelper(
       const std::vector<at::Tensor>& input,
@@ -197,6 +246,9 @@ class ProcessGroupNCCL : public ProcessGroup {
   // Store copy of pointer to THCState retrieved from ::at::globalContext().
   THCState* thcState_;
 
+  // Whether ncclStreams_ are high priority streams
+  const bool highPriorityStreams_;
+
   // ID of this process group
   std::string processGroupID_;
 
@@ -0,0 +1,430 @@
+#include "ProcessGroupTracing.hpp"
+
+#include <algorithm>
+
+namespace c10d {
+
+namespace {
+
+uint64_t tensorBytes(const at::Tensor& tensor) {
+  if (tensor.is_sparse()) {
+    return tensorBytes(tensor._indices()) + tensorBytes(tensor._values());
+  }
+  return tensor.numel() * tensor.type().elementSizeInBytes();
+}
+
+std::vector<at::Tensor> flatten(
+    const std::vector<std::vector<at::Tensor>>& tensors) {
+  std::vector<at::Tensor> result;
+  for (const auto& list : tensors) {
+    result.insert(result.end(), list.begin(), list.end());
+  }
+  return result;
+}
+
+// Number of uint64_t fields per OpStats in gatherStats()
+constexpr size_t kOpStatsFields = 4;
+
+} // namespace
+
+double ProcessGroupTracing::OpStats::algorithmBandwidth() const {
+  if (busy.count() == 0) {
+    return 0;
+  }
+  return bytes / std::chrono::duration<double>(busy).count();
+}
+
+ProcessGroupTracing::Options::Options()
+    : maxRecords(1024), pollInterval(std::chrono::microseconds(50)) {}
+
+const char* ProcessGroupTracing::opTypeName(OpType opType) {
+  switch (opType) {
+    case OpType::BROADCAST:
+      return "broadcast";
+    case OpType::ALLREDUCE:
+      return "allreduce";
+    case OpType::ALLREDUCE_COALESCED:
+      return "allreduce_coalesced";
+    case OpType::REDUCE:
+      return "reduce";
+    case OpType::ALLGATHER:
+      return "allgather";
+    case OpType::GATHER:
+      return "gather";
+    case OpType::SCATTER:
+      return "scatter";
+    case OpType::REDUCE_SCATTER:
+      return "reduce_scatter";
+    case OpType::ALLTOALL:
+      return "alltoall";
+    case OpType::SEND:
+      return "send";
+    case OpType::RECV:
+      return "recv";
+    case OpType::RECVANYSOURCE:
+      return "recv_anysource";
+    case OpType::BARRIER:
+      return "barrier";
+    default:
+      throw std::runtime_error("Invalid OpType");
+  }
+}
+
+double ProcessGroupTracing::busBandwidthFactor(OpType opType, int size) {
+  switch (opType) {
+    case OpType::ALLREDUCE:
+    case OpType::ALLREDUCE_COALESCED:
+      // Every process sends and receives its data reduced by all others
+      return 2.0 * (size - 1) / size;
+    case OpType::ALLGATHER:
+    case OpType::REDUCE_SCATTER:
+    case OpType::ALLTOALL:
+      // Every process exchanges all but its own share of the data
+      return static_cast<double>(size - 1) / size;
+    default:
+      return 1.0;
+  }
+}
+
+ProcessGroupTracing::ProcessGroupTracing(
+    const std::shared_ptr<Store>& store,
+    std::shared_ptr<ProcessGroup> pg,
+    Options options)
+    : ProcessGroup(pg->getRank(), pg->getSize()),
+      store_(store),
+      pg_(std::move(pg)),
+      options_(options),
+      nextSeq_(0),
+      gatherCount_(0),
+      stop_(false) {
+  pollThread_ = std::thread(&ProcessGroupTracing::pollLoop, this);
+}
+
+ProcessGroupTracing::~ProcessGroupTracing() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  // Callbacks of pending operations refer to this process group
+  while (!pending_.empty()) {
+    cv_.wait(lock);
+  }
+  stop_ = true;
+  cv_.notify_all();
+
+  lock.unlock();
+
+  pollThread_.join();
+}
+
+std::vector<ProcessGroupTracing::Record> ProcessGroupTracing::getRecords() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::vector<Record> records(records_.begin(), records_.end());
+  for (const auto& pending : pending_) {
+    records.push_back(pending.second);
+  }
+  return records;
+}
+
+ProcessGroupTracing::Stats ProcessGroupTracing::getStats() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void ProcessGroupTracing::reset() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  records_.clear();
+  stats_ = Stats();
+}
+
+std::vector<ProcessGroupTracing::Stats> ProcessGroupTracing::gatherStats() {
+  const auto stats = getStats();
+  const auto prefix = "trace/" + std::to_string(gatherCount_++) + "/";
+
+  std::vector<uint64_t> fields;
+  for (const auto& opStats : stats) {
+    fields.push_back(opStats.count);
+    fields.push_back(opStats.bytes);
+    fields.push_back(opStats.busy.count());
+    fields.push_back(opStats.queued.count());
+  }
+  auto bytes = reinterpret_cast<const uint8_t*>(fields.data());
+  store_->set(
+      prefix + std::to_string(rank_),
+      std::vector<uint8_t>(bytes, bytes + fields.size() * sizeof(uint64_t)));
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < size_; i++) {
+    keys.push_back(prefix + std::to_string(i));
+  }
+  const auto values = store_->multiGet(keys);
+
+  std::vector<Stats> result(size_);
+  for (int i = 0; i < size_; i++) {
+    if (values[i].size() != fields.size() * sizeof(uint64_t)) {
+      throw std::runtime_error(
+          "ProcessGroupTracing::gatherStats received invalid stats from rank " +
+          std::to_string(i));
+    }
+    auto data = reinterpret_cast<const uint64_t*>(values[i].data());
+    for (auto& opStats : result[i]) {
+      opStats.count = data[0];
+      opStats.bytes = data[1];
+      opStats.busy = std::chrono::nanoseconds(data[2]);
+      opStats.queued = std::chrono::nanoseconds(data[3]);
+      data += kOpStatsFields;
+    }
+  }
+  return result;
+}
+
+int ProcessGroupTracing::findStraggler(const std::vector<Stats>& stats) {
+  int straggler = -1;
+  std::chrono::nanoseconds minBusy = std::chrono::nanoseconds::max();
+  for (size_t rank = 0; rank < stats.size(); rank++) {
+    std::chrono::nanoseconds busy{0};
+    for (size_t i = 0; i < stats[rank].size(); i++) {
+      const auto opType = static_cast<OpType>(i);
+      if (opType == OpType::SEND || opType == OpType::RECV ||
+          opType == OpType::RECVANYSOURCE) {
+        continue;
+      }
+      busy += stats[rank][i].busy;
+    }
+    if (busy < minBusy) {
+      straggler = rank;
+      minBusy = busy;
+    }
+  }
+  return straggler;
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::trace(
+    OpType opType,
+    int peer,
+    const std::vector<at::Tensor>& tensors,
+    WorkFunc fn) {
+  Record record;
+  record.opType = opType;
+  record.peer = peer;
+  for (const auto& tensor : tensors) {
+    record.bytes += tensorBytes(tensor);
+    record.cuda = record.cuda || tensor.is_cuda();
+  }
+  record.enqueued = Clock::now();
+
+  uint64_t seq;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    seq = record.seq = nextSeq_++;
+    pending_.emplace(seq, record);
+  }
+
+  std::shared_ptr<ProcessGroup::Work> work;
+  try {
+    work = fn();
+  } catch (...) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    pending_.erase(seq);
+    cv_.notify_all();
+    throw;
+  }
+
+  // Callbacks run on the thread that completes the work, as soon as it
+  // completes. Point-to-point work doesn't support them in all process
+  // groups, and CUDA work only completes once its CUDA events have been
+  // reached, so both are polled.
+  const bool pointToPoint = opType == OpType::SEND || opType == OpType::RECV ||
+      opType == OpType::RECVANYSOURCE;
+  if (record.cuda || pointToPoint) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    polled_.emplace_back(seq, work);
+    cv_.notify_all();
+  } else {
+    std::weak_ptr<ProcessGroup::Work> weakWork = work;
+    work->addCallback([this, seq, weakWork]() {
+      auto work = weakWork.lock();
+      finish(seq, !work || work->isSuccess());
+    });
+  }
+  return work;
+}
+
+void ProcessGroupTracing::finish(uint64_t seq, bool success) {
+  const auto now = Clock::now();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = pending_.find(seq);
+  if (it == pending_.end()) {
+    return;
+  }
+  auto record = std::move(it->second);
+  pending_.erase(it);
+
+  record.completed = true;
+  record.success = success;
+  record.finished = now;
+  record.started = std::max(record.enqueued, lastFinished_);
+  lastFinished_ = std::max(lastFinished_, now);
+
+  if (success) {
+    auto& opStats = stats_[static_cast<size_t>(record.opType)];
+    opStats.count++;
+    opStats.bytes += record.bytes;
+    opStats.busy += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        record.finished - record.started);
+    opStats.queued += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        record.started - record.enqueued);
+  }
+
+  records_.push_back(std::move(record));
+  while (records_.size() > options_.maxRecords) {
+    records_.pop_front();
+  }
+  cv_.notify_all();
+}
+
+void ProcessGroupTracing::pollLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (!stop_) {
+    if (polled_.empty()) {
+      cv_.wait(lock);
+      continue;
+    }
+
+    auto polled = polled_;
+    lock.unlock();
+
+    for (const auto& entry : polled) {
+      if (entry.second->isCompleted()) {
+        finish(entry.first, entry.second->isSuccess());
+      }
+    }
+
+    lock.lock();
+    polled_.erase(
+        std::remove_if(
+            polled_.begin(),
+            polled_.end(),
+            [this](const std::pair<uint64_t, std::shared_ptr<Work>>& entry) {
+              return pending_.count(entry.first) == 0;
+            }),
+        polled_.end());
+
+    if (!polled_.empty()) {
+      cv_.wait_for(lock, options_.pollInterval);
+    }
+  }
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::broadcast(
+    std::vector<at::Tensor>& tensors,
+    const BroadcastOptions& opts) {
+  return trace(OpType::BROADCAST, opts.rootRank, tensors, [&] {
+    return pg_->broadcast(tensors, opts);
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::allreduce(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  return trace(OpType::ALLREDUCE, -1, tensors, [&] {
+    return pg_->allreduce(tensors, opts);
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::allreduceCoalesced(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  return trace(OpType::ALLREDUCE_COALESCED, -1, tensors, [&] {
+    return pg_->allreduceCoalesced(tensors, opts);
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::reduce(
+    std::vector<at::Tensor>& tensors,
+    const ReduceOptions& opts) {
+  return trace(OpType::REDUCE, opts.rootRank, tensors, [&] {
+    return pg_->reduce(tensors, opts);
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::allgather(
+    std::vector<std::vector<at::Tensor>>& outputTensors,
+    std::vector<at::Tensor>& inputTensors) {
+  return trace(OpType::ALLGATHER, -1, inputTensors, [&] {
+    return pg_->allgather(outputTensors, inputTensors);
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::gather(
+    std::vector<std::vector<at::Tensor>>& outputTensors,
+    std::vector<at::Tensor>& inputTensors,
+    const GatherOptions& opts) {
+  return trace(OpType::GATHER, opts.rootRank, inputTensors, [&] {
+    return pg_->gather(outputTensors, inputTensors, opts);
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::scatter(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const ScatterOptions& opts) {
+  // Only the root has inputs, every process receives its output
+  return trace(OpType::SCATTER, opts.rootRank, outputTensors, [&] {
+    return pg_->scatter(outputTensors, inputTensors, opts);
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::reduceScatter(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const ReduceScatterOptions& opts) {
+  return trace(OpType::REDUCE_SCATTER, -1, flatten(inputTensors), [&] {
+    return pg_->reduceScatter(outputTensors, inputTensors, opts);
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::alltoall(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<at::Tensor>& inputTensors) {
+  return trace(OpType::ALLTOALL, -1, inputTensors, [&] {
+    return pg_->alltoall(outputTensors, inputTensors);
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::send(
+    std::vector<at::Tensor>& tensors,
+    int dstRank,
+    int tag) {
+  return trace(OpType::SEND, dstRank, tensors, [&] {
+    return pg_->send(tensors, dstRank, tag);
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::recv(
+    std::vector<at::Tensor>& tensors,
+    int srcRank,
+    int tag) {
+  return trace(OpType::RECV, srcRank, tensors, [&] {
+    return pg_->recv(tensors, srcRank, tag);
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::recvAnysource(
+    std::vector<at::Tensor>& tensors,
+    int* srcRank,
+    int tag) {
+  return trace(OpType::RECVANYSOURCE, -1, tensors, [&] {
+    return pg_->recvAnysource(tensors, srcRank, tag);
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupTracing::barrier() {
+  return trace(OpType::BARRIER, -1, {}, [&] { return pg_->barrier(); });
+}
+
+std::unordered_map<int, int> ProcessGroupTracing::getGroupRank() {
+  return pg_->getGroupRank();
+}
+
+} // namespace c10d
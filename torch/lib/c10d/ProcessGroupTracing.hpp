@@ -0,0 +1,239 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <c10d/ProcessGroup.hpp>
+#include <c10d/Store.hpp>
+#include <c10d/Types.hpp>
+
+namespace c10d {
+
+// ProcessGroupTracing wraps a process group and records the timing of every
+// operation that goes through it. Operations are forwarded to the wrapped
+// process group unchanged, and return its work.
+//
+// For every operation it records when it was enqueued, when it started and
+// when it completed, how many bytes it carried, and its peer (root, source
+// or destination rank). Completion of CPU collectives is observed with a
+// work callback. Completion of CUDA operations and point-to-point operations
+// is observed by a thread that polls isCompleted(), which for
+// ProcessGroupNCCL queries the CUDA events recorded after the operation on
+// its streams.
+//
+// Process groups don't report when an operation starts running, so the
+// start time is estimated as the later of its enqueue time and the
+// completion of the previous operation. This is exact for process groups
+// that run operations one at a time, in order, such as ProcessGroupNCCL on a
+// single device, and ProcessGroupGloo with a single thread.
+//
+// The most recent records are kept, and per-operation totals are
+// accumulated, from which the algorithm bandwidth (bytes over time) and the
+// bus bandwidth (algorithm bandwidth scaled by the fraction of the data
+// every process has to send, as in nccl-tests) are derived.
+//
+// Processes in the group wait in collectives for the slowest one to join,
+// so the straggler is the process that spends the least time in them.
+// gatherStats() exchanges the totals of all processes through the store to
+// find it, without relying on their clocks being synchronized.
+class ProcessGroupTracing : public ProcessGroup {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class OpType : uint8_t {
+    BROADCAST = 0,
+    ALLREDUCE,
+    ALLREDUCE_COALESCED,
+    REDUCE,
+    ALLGATHER,
+    GATHER,
+    SCATTER,
+    REDUCE_SCATTER,
+    ALLTOALL,
+    SEND,
+    RECV,
+    RECVANYSOURCE,
+    BARRIER,
+    NUM_OP_TYPES,
+  };
+
+  struct Record {
+    // Index of the operation, in the order it was called
+    uint64_t seq = 0;
+    OpType opType = OpType::BARRIER;
+    // Root, source or destination rank, -1 if the operation has none
+    int peer = -1;
+    // Bytes of the input tensors of this process
+    uint64_t bytes = 0;
+    bool cuda = false;
+    bool completed = false;
+    bool success = false;
+    Clock::time_point enqueued;
+    Clock::time_point started;
+    Clock::time_point finished;
+  };
+
+  struct OpStats {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+    // Time from start to completion
+    std::chrono::nanoseconds busy{0};
+    // Time from enqueue to start
+    std::chrono::nanoseconds queued{0};
+
+    // Bytes per second of busy time
+    double algorithmBandwidth() const;
+  };
+
+  using Stats =
+      std::array<OpStats, static_cast<size_t>(OpType::NUM_OP_TYPES)>;
+
+  struct Options {
+    explicit Options();
+
+    // Number of most recent records that are kept
+    size_t maxRecords;
+
+    // Interval at which the completion of polled operations is checked
+    std::chrono::microseconds pollInterval;
+  };
+
+  static const char* opTypeName(OpType opType);
+
+  // Fraction of the data that every process of a group of size processes
+  // sends over the bus for an operation, so that bus bandwidth is comparable
+  // across operations and group sizes
+  static double busBandwidthFactor(OpType opType, int size);
+
+  // The store is only used by gatherStats(). The polling thread is spawned by
+  // the constructor.
+  explicit ProcessGroupTracing(
+      const std::shared_ptr<Store>& store,
+      std::shared_ptr<ProcessGroup> pg,
+      Options options = Options());
+
+  virtual ~ProcessGroupTracing();
+
+  // Most recent records, oldest first. Records of operations that haven't
+  // completed yet are included with completed set to false.
+  std::vector<Record> getRecords();
+
+  Stats getStats();
+
+  void reset();
+
+  // Returns the stats of every process in the group, indexed by rank.
+  // Must be called by every process in the group, in the same order.
+  std::vector<Stats> gatherStats();
+
+  // Returns the rank that spent the least time in collectives, given the
+  // stats of every process in the group. Point-to-point operations, which
+  // don't wait for the whole group, are not taken into account.
+  static int findStraggler(const std::vector<Stats>& stats);
+
+  std::shared_ptr<ProcessGroup::Work> broadcast(
+      std::vector<at::Tensor>& tensors,
+      const BroadcastOptions& opts = BroadcastOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allreduce(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allreduceCoalesced(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> reduce(
+      std::vector<at::Tensor>& tensors,
+      const ReduceOptions& opts = ReduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allgather(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<at::Tensor>& inputTensors) override;
+
+  std::shared_ptr<ProcessGroup::Work> gather(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<at::Tensor>& inputTensors,
+      const GatherOptions& opts = GatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> scatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ScatterOptions& opts = ScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> reduceScatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<at::Tensor>& inputTensors) override;
+
+  std::shared_ptr<ProcessGroup::Work> send(
+      std::vector<at::Tensor>& tensors,
+      int dstRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recv(
+      std::vector<at::Tensor>& tensors,
+      int srcRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recvAnysource(
+      std::vector<at::Tensor>& tensors,
+      int* srcRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> barrier() override;
+
+  std::unordered_map<int, int> getGroupRank() override;
+
+ protected:
+  using WorkFunc = std::function<std::shared_ptr<ProcessGroup::Work>()>;
+
+  // Runs fn, which launches the operation on the wrapped process group, and
+  // traces the work it returns
+  std::shared_ptr<ProcessGroup::Work> trace(
+      OpType opType,
+      int peer,
+      const std::vector<at::Tensor>& tensors,
+      WorkFunc fn);
+
+  void finish(uint64_t seq, bool success);
+
+  void pollLoop();
+
+  std::shared_ptr<Store> store_;
+  std::shared_ptr<ProcessGroup> pg_;
+  const Options options_;
+
+  std::mutex mutex_;
+  uint64_t nextSeq_;
+  // Operations that haven't completed yet, by seq
+  std::map<uint64_t, Record> pending_;
+  // Most recent completed operations, in order of completion
+  std::deque<Record> records_;
+  Stats stats_;
+  // Completion time of the last completed operation
+  Clock::time_point lastFinished_;
+  // Number of times gatherStats() was called, to key the store
+  uint64_t gatherCount_;
+
+  bool stop_;
+  // Signaled when an operation completes or is added to polled_
+  std::condition_variable cv_;
+  std::vector<std::pair<uint64_t, std::shared_ptr<ProcessGroup::Work>>>
+      polled_;
+  std::thread pollThread_;
+};
+
+} // namespace c10d
@@ -35,6 +35,24 @@ class Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) = 0;
 
+  // Waits for all keys and returns their values in order. The default
+  // implementation issues one get per key.
+  virtual std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys);
+
+  // The default implementation issues one set per key.
+  virtual void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values);
+
+  // Atomically sets key to desiredValue if its current value is
+  // expectedValue, or if it doesn't exist and expectedValue is empty.
+  // Returns the value of key after the operation, empty if it doesn't exist.
+  virtual std::vector<uint8_t> compareSet(
+      const std::string& key,
+      const std::vector<uint8_t>& expectedValue,
+      const std::vector<uint8_t>& desiredValue);
+
   void setTimeout(const std::chrono::seconds& timeoutSec);
 
  protected:
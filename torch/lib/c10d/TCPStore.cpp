@@ -1,6 +1,9 @@
 #include "TCPStore.hpp"
 
 #include <poll.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 
 #include <unistd.h>
 #include <algorithm>
@@ -10,18 +13,172 @@ namespace c10d {
 
 namespace {
 
-enum class QueryType : uint8_t { SET, GET, ADD, CHECK, WAIT };
+enum class QueryType : uint8_t {
+  SET,
+  GET,
+  ADD,
+  CHECK,
+  WAIT,
+  MULTI_GET,
+  MULTI_SET,
+  COMPARE_SET
+};
 
 enum class CheckResponseType : uint8_t { READY, NOT_READY };
 
 enum class WaitResponseType : uint8_t { STOP_WAITING };
 
+// Serialize responses in the same format as tcputil::sendValue/sendVector
+template <typename T>
+void appendValue(std::vector<uint8_t>& buffer, const T& value) {
+  auto bytes = reinterpret_cast<const uint8_t*>(&value);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void appendVector(std::vector<uint8_t>& buffer, const std::vector<uint8_t>& vec) {
+  appendValue<SizeType>(buffer, vec.size());
+  buffer.insert(buffer.end(), vec.begin(), vec.end());
+}
+
+struct PollEvent {
+  int fd;
+  bool readable;
+  bool writable;
+  bool error;
+};
+
 } // anonymous namespace
 
+// Level-triggered readiness notification for the daemon's sockets
+class TCPStorePoller {
+ public:
+  TCPStorePoller();
+  ~TCPStorePoller();
+
+  // Starts watching fd for reads
+  void add(int fd);
+  void update(int fd, bool read, bool write);
+  void remove(int fd);
+
+  std::vector<PollEvent> wait();
+
+ private:
+#ifdef __linux__
+  static constexpr int kMaxEvents = 256;
+  int epollFd_;
+#else
+  std::vector<struct pollfd> fds_;
+#endif
+};
+
+#ifdef __linux__
+
+TCPStorePoller::TCPStorePoller() {
+  epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+  if (epollFd_ == -1) {
+    throw std::system_error(errno, std::system_category());
+  }
+}
+
+TCPStorePoller::~TCPStorePoller() {
+  ::close(epollFd_);
+}
+
+void TCPStorePoller::add(int fd) {
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  SYSCHECK(::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event));
+}
+
+void TCPStorePoller::update(int fd, bool read, bool write) {
+  struct epoll_event event = {};
+  event.events = (read ? EPOLLIN : 0) | (write ? EPOLLOUT : 0);
+  event.data.fd = fd;
+  SYSCHECK(::epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &event));
+}
+
+void TCPStorePoller::remove(int fd) {
+  struct epoll_event event = {};
+  SYSCHECK(::epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, &event));
+}
+
+std::vector<PollEvent> TCPStorePoller::wait() {
+  struct epoll_event events[kMaxEvents];
+  int n = ::epoll_wait(epollFd_, events, kMaxEvents, -1);
+  if (n == -1) {
+    if (errno == EINTR) {
+      return {};
+    }
+    throw std::system_error(errno, std::system_category());
+  }
+  std::vector<PollEvent> result;
+  result.reserve(n);
+  for (int i = 0; i < n; i++) {
+    result.push_back({.fd = events[i].data.fd,
+                      .readable = (events[i].events & EPOLLIN) != 0,
+                      .writable = (events[i].events & EPOLLOUT) != 0,
+                      .error = (events[i].events & (EPOLLERR | EPOLLHUP)) != 0});
+  }
+  return result;
+}
+
+#else
+
+TCPStorePoller::TCPStorePoller() {}
+
+TCPStorePoller::~TCPStorePoller() {}
+
+void TCPStorePoller::add(int fd) {
+  fds_.push_back({.fd = fd, .events = POLLIN});
+}
+
+void TCPStorePoller::update(int fd, bool read, bool write) {
+  for (auto& pfd : fds_) {
+    if (pfd.fd == fd) {
+      pfd.events = (read ? POLLIN : 0) | (write ? POLLOUT : 0);
+    }
+  }
+}
+
+void TCPStorePoller::remove(int fd) {
+  fds_.erase(
+      std::remove_if(
+          fds_.begin(),
+          fds_.end(),
+          [fd](const struct pollfd& pfd) { return pfd.fd == fd; }),
+      fds_.end());
+}
+
+std::vector<PollEvent> TCPStorePoller::wait() {
+  for (auto& pfd : fds_) {
+    pfd.revents = 0;
+  }
+  if (::poll(fds_.data(), fds_.size(), -1) == -1) {
+    if (errno == EINTR) {
+      return {};
+    }
+    throw std::system_error(errno, std::system_category());
+  }
+  std::vector<PollEvent> result;
+  for (const auto& pfd : fds_) {
+    if (pfd.revents == 0) {
+      continue;
+    }
+    result.push_back({.fd = pfd.fd,
+                      .readable = (pfd.revents & POLLIN) != 0,
+                      .writable = (pfd.revents & POLLOUT) != 0,
+                      .error = (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0});
+  }
+  return result;
+}
+
+#endif
+
 // TCPStoreDaemon class methods
 // Simply start the daemon thread
 TCPStoreDaemon::TCPStoreDaemon(int storeListenSocket)
-    : storeListenSocket_(storeListenSocket) {
+    : poller_(new TCPStorePoller()), storeListenSocket_(storeListenSocket) {
   daemonThread_ = std::thread(&TCPStoreDaemon::run, this);
 }
 
@@ -32,9 +189,7 @@ TCPStoreDaemon::~TCPStoreDaemon() {
   join();
   // Close unclosed sockets
   for (auto socket : sockets_) {
-    if (socket != -1) {
-      ::close(socket);
-    }
+    ::close(socket);
   }
   // Now close the rest control pipe
   for (auto fd : controlPipeFd_) {
@@ -56,103 +211,64 @@ void TCPStoreDaemon::run() {
         "TCPStoreDaemon run");
   }
 
-  std::vector<struct pollfd> fds;
-  fds.push_back({.fd = storeListenSocket_, .events = POLLIN});
-  // Push the read end of the pipe to signal the stopping of the daemon run
-  fds.push_back({.fd = controlPipeFd_[0], .events = POLLHUP});
+  poller_->add(storeListenSocket_);
+  // Watch the read end of the pipe to signal the stopping of the daemon run
+  poller_->add(controlPipeFd_[0]);
 
   // receive the queries
   bool finished = false;
   while (!finished) {
-    for (size_t i = 0; i < sockets_.size(); i++) {
-      fds[i].revents = 0;
-    }
-
-    SYSCHECK(::poll(fds.data(), fds.size(), -1));
-
-    // TCPStore's listening socket has an event and it should now be able to
-    // accept new connections.
-    if (fds[0].revents != 0) {
-      if (fds[0].revents ^ POLLIN) {
-        throw std::system_error(
-            ECONNABORTED,
-            std::system_category(),
-            "Unexpected poll revent on the master's listening socket: " +
-                std::to_string(fds[0].revents));
+    for (const auto& event : poller_->wait()) {
+      // TCPStore's listening socket has an event and it should now be able to
+      // accept new connections.
+      if (event.fd == storeListenSocket_) {
+        if (event.error) {
+          throw std::system_error(
+              ECONNABORTED,
+              std::system_category(),
+              "Unexpected poll event on the master's listening socket");
+        }
+        accept();
+        continue;
       }
-      int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
-      sockets_.push_back(sockFd);
-      fds.push_back({.fd = sockFd, .events = POLLIN});
-    }
-    // The pipe receives an event which tells us to shutdown the daemon
-    if (fds[1].revents != 0) {
-      // Will be POLLUP when the pipe is closed
-      if (fds[1].revents ^ POLLHUP) {
-        throw std::system_error(
-            ECONNABORTED,
-            std::system_category(),
-            "Unexpected poll revent on the control pipe's reading fd: " +
-                std::to_string(fds[1].revents));
+      // The pipe receives an event (EOF or hang up when the write end is
+      // closed) which tells us to shutdown the daemon
+      if (event.fd == controlPipeFd_[0]) {
+        finished = true;
+        break;
       }
-      finished = true;
-      break;
-    }
-    // Skipping the fds[0] and fds[1],
-    // fds[0] is master's listening socket
-    // fds[1] is control pipe's reading fd
-    for (size_t fdIdx = 2; fdIdx < fds.size(); ++fdIdx) {
-      if (fds[fdIdx].revents == 0) {
+      if (socketsToClose_.count(event.fd) > 0) {
         continue;
       }
-
-      if (fds[fdIdx].revents ^ POLLIN) {
-        throw std::system_error(
-            ECONNABORTED,
-            std::system_category(),
-            "Unexpected poll revent: " + std::to_string(fds[fdIdx].revents) +
-                " on socket: " + std::to_string(fds[fdIdx].fd));
+      if (event.writable) {
+        flush(event.fd);
       }
-      // Now query the socket that has the event
-      try {
-        query(fds[fdIdx].fd);
-      } catch (...) {
-        // There was an error when processing query. Probably an exception
-        // occurred in recv/send what would indicate that socket on the other
-        // side has been closed. If the closing was due to normal exit, then
-        // the store should continue executing. Otherwise, if it was different
-        // exception, other connections will get an exception once they try to
-        // use the store. We will go ahead and close this connection whenever
-        // we hit an exception here.
-        ::close(fds[fdIdx].fd);
-
-        // Remove all the tracking state of the close FD
-        for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
-          for (auto vecIt = it->second.begin(); vecIt != it->second.end();) {
-            if (*vecIt == fds[fdIdx].fd) {
-              vecIt = it->second.erase(vecIt);
-            } else {
-              ++vecIt;
-            }
-          }
-          if (it->second.size() == 0) {
-            it = waitingSockets_.erase(it);
-          } else {
-            ++it;
-          }
-        }
-        for (auto it = keysAwaited_.begin(); it != keysAwaited_.end();) {
-          if (it->first == fds[fdIdx].fd) {
-            it = keysAwaited_.erase(it);
-          } else {
-            ++it;
-          }
+      if (event.readable) {
+        // Only one query is handled per event so that no client can starve
+        // the others. Pipelined queries leave the socket readable and are
+        // picked up on the next iteration.
+        try {
+          query(event.fd);
+        } catch (...) {
+          // There was an error when processing query. Probably an exception
+          // occurred in recv/send what would indicate that socket on the
+          // other side has been closed. If the closing was due to normal
+          // exit, then the store should continue executing. Otherwise, if it
+          // was different exception, other connections will get an exception
+          // once they try to use the store. We will go ahead and close this
+          // connection whenever we hit an exception here.
+          socketsToClose_.insert(event.fd);
         }
-        fds.erase(fds.begin() + fdIdx);
-        sockets_.erase(sockets_.begin() + fdIdx - 2);
-        --fdIdx;
-        continue;
+      } else if (event.error) {
+        socketsToClose_.insert(event.fd);
       }
     }
+    // Sockets are only closed once the whole batch of events is handled, so
+    // that their descriptors can't be reused by a socket accepted meanwhile.
+    for (int socket : socketsToClose_) {
+      closeSocket(socket);
+    }
+    socketsToClose_.clear();
   }
 }
 
@@ -164,11 +280,69 @@ void TCPStoreDaemon::stop() {
   }
 }
 
+void TCPStoreDaemon::accept() {
+  int socket = std::get<0>(tcputil::accept(storeListenSocket_));
+  sockets_.insert(socket);
+  poller_->add(socket);
+}
+
+// Writes as much of the socket's pending responses as the kernel takes
+// without blocking. Whatever is left is written when the socket becomes
+// writable again. While the socket waits for keys, its queries are not read
+// so that pipelined queries run only after the wait has completed.
+void TCPStoreDaemon::flush(int socket) {
+  auto& buffer = sendBuffers_[socket];
+  int flags = MSG_DONTWAIT;
+#ifdef MSG_NOSIGNAL
+  flags |= MSG_NOSIGNAL;
+#endif
+  size_t bytesSent = 0;
+  while (bytesSent < buffer.size()) {
+    ssize_t n = ::send(
+        socket, buffer.data() + bytesSent, buffer.size() - bytesSent, flags);
+    if (n == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      buffer.clear();
+      socketsToClose_.insert(socket);
+      return;
+    }
+    bytesSent += n;
+  }
+  buffer.erase(buffer.begin(), buffer.begin() + bytesSent);
+  poller_->update(socket, keysAwaited_.count(socket) == 0, !buffer.empty());
+}
+
+void TCPStoreDaemon::closeSocket(int socket) {
+  // Remove all the tracking state of the closed socket
+  for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
+    auto& sockets = it->second;
+    sockets.erase(
+        std::remove(sockets.begin(), sockets.end(), socket), sockets.end());
+    if (sockets.empty()) {
+      it = waitingSockets_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  keysAwaited_.erase(socket);
+  sendBuffers_.erase(socket);
+  sockets_.erase(socket);
+  poller_->remove(socket);
+  ::close(socket);
+}
+
 // query communicates with the worker. The format
 // of the query is as follows:
 // type of query | size of arg1 | arg1 | size of arg2 | arg2 | ...
-// or, in the case of wait
+// or, in the case of wait, check and multi get
 // type of query | number of args | size of arg1 | arg1 | ...
+// or, in the case of multi set
+// type of query | number of pairs | size of key1 | key1 | size of value1 | ...
 void TCPStoreDaemon::query(int socket) {
   QueryType qt;
   tcputil::recvBytes<QueryType>(socket, &qt, 1);
@@ -188,6 +362,15 @@ void TCPStoreDaemon::query(int socket) {
   } else if (qt == QueryType::WAIT) {
     waitHandler(socket);
 
+  } else if (qt == QueryType::MULTI_GET) {
+    multiGetHandler(socket);
+
+  } else if (qt == QueryType::MULTI_SET) {
+    multiSetHandler(socket);
+
+  } else if (qt == QueryType::COMPARE_SET) {
+    compareSetHandler(socket);
+
   } else {
     throw std::runtime_error("Unexpected query type");
   }
@@ -198,8 +381,10 @@ void TCPStoreDaemon::wakeupWaitingClients(const std::string& key) {
   if (socketsToWait != waitingSockets_.end()) {
     for (int socket : socketsToWait->second) {
       if (--keysAwaited_[socket] == 0) {
-        tcputil::sendValue<WaitResponseType>(
-            socket, WaitResponseType::STOP_WAITING);
+        keysAwaited_.erase(socket);
+        appendValue<WaitResponseType>(
+            sendBuffers_[socket], WaitResponseType::STOP_WAITING);
+        flush(socket);
       }
     }
     waitingSockets_.erase(socketsToWait);
@@ -225,18 +410,19 @@ void TCPStoreDaemon::addHandler(int socket) {
   auto addValStr = std::to_string(addVal);
   tcpStore_[key] = std::vector<uint8_t>(addValStr.begin(), addValStr.end());
   // Now send the new value
-  tcputil::sendValue<int64_t>(socket, addVal);
+  appendValue<int64_t>(sendBuffers_[socket], addVal);
+  flush(socket);
   // On "add", wake up all clients that have been waiting
   wakeupWaitingClients(key);
 }
 
-void TCPStoreDaemon::getHandler(int socket) const {
+void TCPStoreDaemon::getHandler(int socket) {
   std::string key = tcputil::recvString(socket);
-  auto data = tcpStore_.at(key);
-  tcputil::sendVector<uint8_t>(socket, data);
+  appendVector(sendBuffers_[socket], tcpStore_.at(key));
+  flush(socket);
 }
 
-void TCPStoreDaemon::checkHandler(int socket) const {
+void TCPStoreDaemon::checkHandler(int socket) {
   SizeType nargs;
   tcputil::recvBytes<SizeType>(socket, &nargs, 1);
   std::vector<std::string> keys(nargs);
@@ -244,11 +430,11 @@ void TCPStoreDaemon::checkHandler(int socket) const {
     keys[i] = tcputil::recvString(socket);
   }
   // Now we have received all the keys
-  if (checkKeys(keys)) {
-    tcputil::sendValue<CheckResponseType>(socket, CheckResponseType::READY);
-  } else {
-    tcputil::sendValue<CheckResponseType>(socket, CheckResponseType::NOT_READY);
-  }
+  appendValue<CheckResponseType>(
+      sendBuffers_[socket],
+      checkKeys(keys) ? CheckResponseType::READY
+                      : CheckResponseType::NOT_READY);
+  flush(socket);
 }
 
 void TCPStoreDaemon::waitHandler(int socket) {
@@ -259,13 +445,59 @@ void TCPStoreDaemon::waitHandler(int socket) {
     keys[i] = tcputil::recvString(socket);
   }
   if (checkKeys(keys)) {
-    tcputil::sendValue<WaitResponseType>(
-        socket, WaitResponseType::STOP_WAITING);
+    appendValue<WaitResponseType>(
+        sendBuffers_[socket], WaitResponseType::STOP_WAITING);
   } else {
     for (auto& key : keys) {
-      waitingSockets_[key].push_back(socket);
+      if (tcpStore_.count(key) == 0) {
+        waitingSockets_[key].push_back(socket);
+        keysAwaited_[socket]++;
+      }
     }
-    keysAwaited_[socket] = keys.size();
+  }
+  // Stops reading from the socket if it is now waiting
+  flush(socket);
+}
+
+void TCPStoreDaemon::multiGetHandler(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  auto& buffer = sendBuffers_[socket];
+  for (size_t i = 0; i < nargs; i++) {
+    appendVector(buffer, tcpStore_.at(tcputil::recvString(socket)));
+  }
+  flush(socket);
+}
+
+void TCPStoreDaemon::multiSetHandler(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  for (size_t i = 0; i < nargs; i++) {
+    std::string key = tcputil::recvString(socket);
+    tcpStore_[key] = tcputil::recvVector<uint8_t>(socket);
+    wakeupWaitingClients(key);
+  }
+}
+
+void TCPStoreDaemon::compareSetHandler(int socket) {
+  std::string key = tcputil::recvString(socket);
+  auto expectedValue = tcputil::recvVector<uint8_t>(socket);
+  auto desiredValue = tcputil::recvVector<uint8_t>(socket);
+
+  auto pos = tcpStore_.find(key);
+  bool matches = (pos == tcpStore_.end()) ? expectedValue.empty()
+                                          : pos->second == expectedValue;
+  if (matches) {
+    tcpStore_[key] = desiredValue;
+    appendVector(sendBuffers_[socket], desiredValue);
+  } else if (pos != tcpStore_.end()) {
+    appendVector(sendBuffers_[socket], pos->second);
+  } else {
+    appendVector(sendBuffers_[socket], {});
+  }
+  flush(socket);
+  if (matches) {
+    wakeupWaitingClients(key);
   }
 }
 
@@ -310,10 +542,13 @@ void TCPStore::set(const std::string& key, const std::vector<uint8_t>& data) {
   tcputil::sendVector<uint8_t>(storeSocket_, data);
 }
 
+// The wait is pipelined with the get, the daemon only reads the get once the
+// key exists.
 std::vector<uint8_t> TCPStore::get(const std::string& key) {
-  wait({key});
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::GET);
+  sendWait({key}, timeout_, true);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::GET, true);
   tcputil::sendString(storeSocket_, key);
+  recvWait();
   return tcputil::recvVector<uint8_t>(storeSocket_);
 }
 
@@ -348,6 +583,58 @@ void TCPStore::wait(const std::vector<std::string>& keys) {
 void TCPStore::wait(
     const std::vector<std::string>& keys,
     const std::chrono::milliseconds& timeout) {
+  sendWait(keys, timeout);
+  recvWait();
+}
+
+std::vector<std::vector<uint8_t>> TCPStore::multiGet(
+    const std::vector<std::string>& keys) {
+  sendWait(keys, timeout_, true);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_GET, true);
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
+  }
+  recvWait();
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(nkeys);
+  for (size_t i = 0; i < nkeys; i++) {
+    values.push_back(tcputil::recvVector<uint8_t>(storeSocket_));
+  }
+  return values;
+}
+
+void TCPStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument("multiSet: keys and values differ in length");
+  }
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_SET, true);
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, keys[i], true);
+    tcputil::sendVector<uint8_t>(storeSocket_, values[i], (i != (nkeys - 1)));
+  }
+}
+
+std::vector<uint8_t> TCPStore::compareSet(
+    const std::string& key,
+    const std::vector<uint8_t>& expectedValue,
+    const std::vector<uint8_t>& desiredValue) {
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::COMPARE_SET, true);
+  tcputil::sendString(storeSocket_, key, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, expectedValue, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, desiredValue);
+  return tcputil::recvVector<uint8_t>(storeSocket_);
+}
+
+void TCPStore::sendWait(
+    const std::vector<std::string>& keys,
+    const std::chrono::milliseconds& timeout,
+    bool moreData) {
   // Set the socket timeout if there is a wait timeout
   if (timeout != kNoTimeout) {
     struct timeval timeoutTV = {.tv_sec = timeout.count() / 1000,
@@ -361,10 +648,14 @@ void TCPStore::wait(
   }
   tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT);
   SizeType nkeys = keys.size();
-  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
+  tcputil::sendBytes<SizeType>(
+      storeSocket_, &nkeys, 1, (nkeys > 0) || moreData);
   for (size_t i = 0; i < nkeys; i++) {
-    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
+    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)) || moreData);
   }
+}
+
+void TCPStore::recvWait() {
   auto waitResponse = tcputil::recvValue<WaitResponseType>(storeSocket_);
   if (waitResponse != WaitResponseType::STOP_WAITING) {
     throw std::runtime_error("Stop_waiting response is expected");
@@ -3,12 +3,15 @@
 #include <memory>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <c10d/Store.hpp>
 #include <c10d/Utils.hpp>
 
 namespace c10d {
 
+class TCPStorePoller;
+
 class TCPStoreDaemon {
  public:
   explicit TCPStoreDaemon(int storeListenSocket);
@@ -20,25 +23,38 @@ class TCPStoreDaemon {
   void run();
   void stop();
 
+  void accept();
   void query(int socket);
+  void flush(int socket);
+  void closeSocket(int socket);
 
   void setHandler(int socket);
   void addHandler(int socket);
-  void getHandler(int socket) const;
-  void checkHandler(int socket) const;
+  void getHandler(int socket);
+  void checkHandler(int socket);
   void waitHandler(int socket);
+  void multiGetHandler(int socket);
+  void multiSetHandler(int socket);
+  void compareSetHandler(int socket);
 
   bool checkKeys(const std::vector<std::string>& keys) const;
   void wakeupWaitingClients(const std::string& key);
 
   std::thread daemonThread_;
+  // epoll on Linux, poll elsewhere
+  std::unique_ptr<TCPStorePoller> poller_;
   std::unordered_map<std::string, std::vector<uint8_t>> tcpStore_;
   // From key -> the list of sockets waiting on it
   std::unordered_map<std::string, std::vector<int>> waitingSockets_;
   // From socket -> number of keys awaited
   std::unordered_map<int, size_t> keysAwaited_;
+  // From socket -> responses not yet accepted by the kernel. Responses are
+  // written without blocking, the rest is flushed once the socket is writable.
+  std::unordered_map<int, std::vector<uint8_t>> sendBuffers_;
+  // Sockets that failed while handling the current batch of events
+  std::unordered_set<int> socketsToClose_;
 
-  std::vector<int> sockets_;
+  std::unordered_set<int> sockets_;
   int storeListenSocket_;
   std::vector<int> controlPipeFd_{-1, -1};
 };
@@ -66,7 +82,26 @@ class TCPStore : public Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) override;
 
+  std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys) override;
+
+  void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values) override;
+
+  std::vector<uint8_t> compareSet(
+      const std::string& key,
+      const std::vector<uint8_t>& expectedValue,
+      const std::vector<uint8_t>& desiredValue) override;
+
  protected:
+  // Sends a wait query, moreData tells that another query follows it
+  void sendWait(
+      const std::vector<std::string>& keys,
+      const std::chrono::milliseconds& timeout,
+      bool moreData = false);
+  void recvWait();
+
   bool isServer_;
   int storeSocket_ = -1;
   int masterListenSocket_ = -1;
@@ -8,6 +8,10 @@ enum class CollectiveType : std::uint8_t {
   BROADCAST,
   ALLREDUCE,
   BARRIER,
+  REDUCE_SCATTER,
+  ALLTOALL,
+  ALLREDUCE_COALESCED,
+  ALLREDUCE_SPARSE,
   UNUSED,
 };
 
@@ -34,6 +38,10 @@ struct ReduceOptions {
   int rootTensor = 0;
 };
 
+struct ReduceScatterOptions {
+  ReduceOp reduceOp = ReduceOp::SUM;
+};
+
 struct ScatterOptions {
   int rootRank = 0;
 };
@@ -112,6 +112,52 @@ inline std::vector<int> getDevices(const std::vector<at::Tensor>& tensors) {
   return devices;
 }
 
+// Sparse allreduce allgathers the indices and values of every process and
+// sums them. Once the gathered nonzeros take more bytes than the dense
+// tensor, a dense allreduce is cheaper: a ring allreduce sends and receives
+// every element about twice.
+inline bool sparseAllreduceShouldDensify(
+    const at::Tensor& sparse,
+    const std::vector<int64_t>& counts) {
+  int64_t nnz = 0;
+  for (auto count : counts) {
+    nnz += count;
+  }
+  const auto sparseDims = sparse._sparseDims();
+  const auto elementSize = sparse.type().elementSizeInBytes();
+  int64_t rowNumel = 1;
+  for (int64_t i = sparseDims; i < sparse.dim(); i++) {
+    rowNumel *= sparse.size(i);
+  }
+  const auto sparseBytes =
+      nnz * (sparseDims * sizeof(int64_t) + rowNumel * elementSize);
+  const auto denseBytes = sparse.numel() * elementSize;
+  return sparseBytes > 2 * denseBytes;
+}
+
+// Sums the gathered indices and values of sparse tensors like sparse.
+inline at::Tensor sumSparse(
+    const at::Tensor& sparse,
+    const std::vector<at::Tensor>& indices,
+    const std::vector<at::Tensor>& values) {
+  return at::sparse_coo_tensor(
+             at::cat(indices, 1), at::cat(values, 0), sparse.sizes())
+      .coalesce();
+}
+
+// Returns a coalesced sparse tensor holding every row of dense.
+inline at::Tensor denseToSparse(const at::Tensor& dense, int64_t sparseDims) {
+  auto sparseSizes = dense.sizes().slice(0, sparseDims);
+  auto indices =
+      at::ones(sparseSizes, dense.options().dtype(at::kLong)).nonzero().t();
+  std::vector<int64_t> valueSizes{indices.size(1)};
+  valueSizes.insert(
+      valueSizes.end(), dense.sizes().begin() + sparseDims, dense.sizes().end());
+  return at::sparse_coo_tensor(
+             indices, dense.reshape(valueSizes).clone(), dense.sizes())
+      .coalesce();
+}
+
 template <typename T>
 std::vector<T*> getDataPointers(const std::vector<at::Tensor>& tensors) {
   std::vector<T*> ptrs(tensors.size());
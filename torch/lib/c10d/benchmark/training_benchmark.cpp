@@ -0,0 +1,995 @@
+// End-to-end training throughput benchmark.
+//
+// Trains a reference model with the C++ frontend, on synthetic examples or
+// on examples read from an archive, and reports where the time of a training
+// step goes:
+//
+//   data_wait      waiting for the next batch from the DataLoader
+//   copy           copying the batch to the device
+//   forward        forward pass and loss
+//   backward       backward pass
+//   reduce_update  allreduce of the gradients, in buckets, overlapped with the
+//                  optimizer step of the buckets that are already reduced
+//   step           the whole step
+//
+// The device is synchronized at the end of every stage, so that its work is
+// attributed to the stage that issued it. The time each stage would take on
+// its own is measured too, to tell how much of it is hidden by the others:
+//
+//   data_load      loading and collating a batch in a DataLoader worker
+//   allreduce      the bucketed allreduce, without the optimizer
+//   optimizer      the optimizer step, without the allreduce
+//
+// The step entries also report the samples per second of all ranks, the
+// fraction of the data loading and communication hidden behind other work
+// (overlap_efficiency), the step time without its exposed communication over
+// the step time (scaling_efficiency, an estimate of the weak scaling
+// efficiency over a single rank), and the speedup over the first of the
+// thread counts that are swept.
+//
+// Distributed runs start one process per GPU, configured through the same
+// environment variables as torch.distributed.launch: RANK, WORLD_SIZE,
+// LOCAL_RANK, MASTER_ADDR and MASTER_PORT. The stage times are the maximum
+// over the ranks, and only rank 0 writes the results.
+//
+// The results are written in the JSON format of Google Benchmark, with one
+// benchmark per configuration and stage, so that two builds can be compared
+// with binaries/compare_benchmarks.py:
+//
+//   training_benchmark --model=resnet50 --threads=1,2,4 --output=new.json
+//   binaries/compare_benchmarks.py old.json new.json
+//
+// Real examples are read from an archive of stacked tensors, which
+// --save_data writes in the shapes of the model from synthetic examples.
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gloo/transport/tcp/device.h>
+#include <torch/torch.h>
+
+#ifdef USE_CUDA
+#include <cuda_runtime.h>
+#endif
+
+#include <c10d/Def.hpp>
+#include <c10d/ProcessGroupGloo.hpp>
+#include <c10d/TCPStore.hpp>
+
+#ifdef USE_C10D_NCCL
+#include <c10d/ProcessGroupNCCL.hpp>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Inputs = std::vector<torch::Tensor>;
+using Sample = torch::data::Example<Inputs, torch::Tensor>;
+
+const char* kUsage =
+    "Usage: training_benchmark [--name=value ...]\n"
+    "  --model=resnet50|lstm|recommendation  (resnet50)\n"
+    "  --batch_size=N                        (32)\n"
+    "  --warmup_steps=N                      (5)\n"
+    "  --steps=N                             (20)\n"
+    "  --calibration_steps=N                 (5)\n"
+    "  --threads=N[,N...]                    (the default thread count)\n"
+    "  --workers=N                           (4)\n"
+    "  --device=cpu|cuda                     (cpu)\n"
+    "  --backend=gloo|nccl                   (gloo)\n"
+    "  --bucket_mb=MB                        (25)\n"
+    "  --data=PATH      read the examples from an archive\n"
+    "  --save_data=PATH write --examples synthetic examples and exit\n"
+    "  --examples=N                          (1024)\n"
+    "  --output=PATH                         (stdout)\n"
+    "  --image_size=N --sequence_length=N --vocabulary=N\n"
+    "  --tables=N --table_rows=N             (model sizes)\n";
+
+struct Options {
+  std::string model = "resnet50";
+  int64_t batchSize = 32;
+  int64_t warmupSteps = 5;
+  int64_t steps = 20;
+  int64_t calibrationSteps = 5;
+  std::vector<int> threads;
+  int64_t workers = 4;
+  std::string device = "cpu";
+  std::string backend = "gloo";
+  double bucketMB = 25;
+  std::string data;
+  std::string saveData;
+  int64_t examples = 1024;
+  std::string output;
+  int64_t imageSize = 224;
+  int64_t sequenceLength = 35;
+  int64_t vocabulary = 10000;
+  int64_t tables = 8;
+  int64_t tableRows = 100000;
+};
+
+Options parseOptions(int argc, char** argv) {
+  Options options;
+  const auto int64Option = [](int64_t* value) {
+    return [value](const std::string& arg) { *value = std::stoll(arg); };
+  };
+  const auto stringOption = [](std::string* value) {
+    return [value](const std::string& arg) { *value = arg; };
+  };
+  std::map<std::string, std::function<void(const std::string&)>> setters = {
+      {"model", stringOption(&options.model)},
+      {"batch_size", int64Option(&options.batchSize)},
+      {"warmup_steps", int64Option(&options.warmupSteps)},
+      {"steps", int64Option(&options.steps)},
+      {"calibration_steps", int64Option(&options.calibrationSteps)},
+      {"threads",
+       [&](const std::string& arg) {
+         std::stringstream stream(arg);
+         std::string count;
+         while (std::getline(stream, count, ',')) {
+           options.threads.push_back(std::stoi(count));
+         }
+       }},
+      {"workers", int64Option(&options.workers)},
+      {"device", stringOption(&options.device)},
+      {"backend", stringOption(&options.backend)},
+      {"bucket_mb",
+       [&](const std::string& arg) { options.bucketMB = std::stod(arg); }},
+      {"data", stringOption(&options.data)},
+      {"save_data", stringOption(&options.saveData)},
+      {"examples", int64Option(&options.examples)},
+      {"output", stringOption(&options.output)},
+      {"image_size", int64Option(&options.imageSize)},
+      {"sequence_length", int64Option(&options.sequenceLength)},
+      {"vocabulary", int64Option(&options.vocabulary)},
+      {"tables", int64Option(&options.tables)},
+      {"table_rows", int64Option(&options.tableRows)},
+  };
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const auto equals = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || equals == std::string::npos ||
+        setters.count(arg.substr(2, equals - 2)) == 0) {
+      throw std::invalid_argument("Unknown argument " + arg + "\n" + kUsage);
+    }
+    setters[arg.substr(2, equals - 2)](arg.substr(equals + 1));
+  }
+  if (options.batchSize <= 0 || options.steps <= 0 || options.workers < 0) {
+    throw std::invalid_argument(
+        "batch_size and steps must be positive, workers non-negative");
+  }
+  return options;
+}
+
+// The rank of this process, from the torch.distributed.launch variables
+struct Environment {
+  int rank = 0;
+  int worldSize = 1;
+  int localRank = 0;
+  std::string masterAddr = "localhost";
+  int masterPort = 29500;
+  std::string hostname;
+};
+
+int intFromEnv(const char* name, int fallback) {
+  const char* value = std::getenv(name);
+  return value ? std::atoi(value) : fallback;
+}
+
+Environment readEnvironment() {
+  Environment env;
+  env.rank = intFromEnv("RANK", 0);
+  env.worldSize = intFromEnv("WORLD_SIZE", 1);
+  env.localRank = intFromEnv("LOCAL_RANK", env.rank);
+  if (const char* addr = std::getenv("MASTER_ADDR")) {
+    env.masterAddr = addr;
+  }
+  env.masterPort = intFromEnv("MASTER_PORT", env.masterPort);
+  char hostname[HOST_NAME_MAX + 1] = {};
+  gethostname(hostname, HOST_NAME_MAX);
+  env.hostname = hostname;
+  return env;
+}
+
+void synchronize(const torch::Device& device) {
+#ifdef USE_CUDA
+  if (device.is_cuda()) {
+    const auto error = cudaDeviceSynchronize();
+    if (error != cudaSuccess) {
+      throw std::runtime_error(cudaGetErrorString(error));
+    }
+  }
+#endif
+}
+
+double millisecondsBetween(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Reference models
+
+// A model trained by the benchmark, which also generates its examples
+struct Model : torch::nn::Module {
+  // A random example. Called concurrently by the DataLoader workers.
+  virtual Sample example() const = 0;
+
+  // The loss of a batch of examples
+  virtual torch::Tensor loss(
+      const Inputs& inputs,
+      const torch::Tensor& target) = 0;
+};
+
+torch::nn::Conv2d conv(int64_t in, int64_t out, int64_t kernel, int64_t stride) {
+  return torch::nn::Conv2d(torch::nn::Conv2dOptions(in, out, kernel)
+                               .stride(stride)
+                               .padding(kernel / 2)
+                               .with_bias(false));
+}
+
+struct Bottleneck : torch::nn::Module {
+  Bottleneck(int64_t in, int64_t width, int64_t stride) {
+    conv1 = register_module("conv1", conv(in, width, 1, 1));
+    bn1 = register_module("bn1", torch::nn::BatchNorm(width));
+    conv2 = register_module("conv2", conv(width, width, 3, stride));
+    bn2 = register_module("bn2", torch::nn::BatchNorm(width));
+    conv3 = register_module("conv3", conv(width, 4 * width, 1, 1));
+    bn3 = register_module("bn3", torch::nn::BatchNorm(4 * width));
+    if (stride != 1 || in != 4 * width) {
+      downsample = register_module("downsample", conv(in, 4 * width, 1, stride));
+      downsampleBn =
+          register_module("downsample_bn", torch::nn::BatchNorm(4 * width));
+    }
+  }
+
+  torch::Tensor forward(torch::Tensor x) {
+    auto y = torch::relu(bn1->forward(conv1->forward(x)));
+    y = torch::relu(bn2->forward(conv2->forward(y)));
+    y = bn3->forward(conv3->forward(y));
+    if (!downsample.is_empty()) {
+      x = downsampleBn->forward(downsample->forward(x));
+    }
+    return torch::relu(y + x);
+  }
+
+  torch::nn::Conv2d conv1{nullptr}, conv2{nullptr}, conv3{nullptr};
+  torch::nn::BatchNorm bn1{nullptr}, bn2{nullptr}, bn3{nullptr};
+  torch::nn::Conv2d downsample{nullptr};
+  torch::nn::BatchNorm downsampleBn{nullptr};
+};
+
+// ResNet-50 on ImageNet-sized images
+struct ResNet50 : Model {
+  explicit ResNet50(int64_t imageSize) : imageSize(imageSize) {
+    stem = register_module("stem", conv(3, 64, 7, 2));
+    stemBn = register_module("stem_bn", torch::nn::BatchNorm(64));
+    const int64_t blocks[] = {3, 4, 6, 3};
+    int64_t in = 64;
+    for (int64_t stage = 0; stage < 4; ++stage) {
+      const int64_t width = 64 << stage;
+      for (int64_t block = 0; block < blocks[stage]; ++block) {
+        const int64_t stride = stage > 0 && block == 0 ? 2 : 1;
+        layers.push_back(register_module(
+            "layer" + std::to_string(stage + 1) + "_" + std::to_string(block),
+            std::make_shared<Bottleneck>(in, width, stride)));
+        in = 4 * width;
+      }
+    }
+    fc = register_module("fc", torch::nn::Linear(in, kClasses));
+  }
+
+  Sample example() const override {
+    return {{torch::randn({3, imageSize, imageSize})},
+            torch::randint(kClasses, {}, torch::kLong)};
+  }
+
+  torch::Tensor loss(const Inputs& inputs, const torch::Tensor& target)
+      override {
+    auto x = torch::relu(stemBn->forward(stem->forward(inputs[0])));
+    x = torch::max_pool2d(x, {3, 3}, {2, 2}, {1, 1});
+    for (auto& layer : layers) {
+      x = layer->forward(x);
+    }
+    x = torch::adaptive_avg_pool2d(x, {1, 1}).view({x.size(0), -1});
+    return torch::nll_loss(torch::log_softmax(fc->forward(x), 1), target);
+  }
+
+  static constexpr int64_t kClasses = 1000;
+  int64_t imageSize;
+  torch::nn::Conv2d stem{nullptr};
+  torch::nn::BatchNorm stemBn{nullptr};
+  std::vector<std::shared_ptr<Bottleneck>> layers;
+  torch::nn::Linear fc{nullptr};
+};
+
+constexpr int64_t ResNet50::kClasses;
+
+// Word language model with a 2 layer LSTM, predicting the next token
+struct LSTMLanguageModel : Model {
+  LSTMLanguageModel(int64_t vocabulary, int64_t sequenceLength)
+      : vocabulary(vocabulary), sequenceLength(sequenceLength) {
+    embedding = register_module(
+        "embedding", torch::nn::Embedding(vocabulary, kHiddenSize));
+    lstm = register_module(
+        "lstm",
+        torch::nn::LSTM(
+            torch::nn::LSTMOptions(kHiddenSize, kHiddenSize).layers(2)));
+    decoder =
+        register_module("decoder", torch::nn::Linear(kHiddenSize, vocabulary));
+  }
+
+  Sample example() const override {
+    auto tokens = torch::randint(vocabulary, {sequenceLength + 1}, torch::kLong);
+    return {{tokens.slice(0, 0, sequenceLength)},
+            tokens.slice(0, 1, sequenceLength + 1)};
+  }
+
+  torch::Tensor loss(const Inputs& inputs, const torch::Tensor& target)
+      override {
+    // The batches are batch major, the LSTM is time major
+    auto x = embedding->forward(inputs[0].t());
+    x = lstm->forward(x).output;
+    x = decoder->forward(x).view({-1, vocabulary});
+    return torch::nll_loss(
+        torch::log_softmax(x, 1), target.t().contiguous().view({-1}));
+  }
+
+  static constexpr int64_t kHiddenSize = 512;
+  int64_t vocabulary;
+  int64_t sequenceLength;
+  torch::nn::Embedding embedding{nullptr};
+  torch::nn::LSTM lstm{nullptr};
+  torch::nn::Linear decoder{nullptr};
+};
+
+constexpr int64_t LSTMLanguageModel::kHiddenSize;
+
+// Click-through model on dense features and one sparse id per embedding
+// table, whose embeddings interact by dot products (like DLRM)
+struct RecommendationModel : Model {
+  RecommendationModel(int64_t tables, int64_t tableRows)
+      : tableRows(tableRows) {
+    bottom = register_module(
+        "bottom",
+        torch::nn::Sequential(
+            torch::nn::Linear(kDenseFeatures, 512),
+            torch::nn::Functional(torch::relu),
+            torch::nn::Linear(512, 256),
+            torch::nn::Functional(torch::relu),
+            torch::nn::Linear(256, kEmbeddingSize),
+            torch::nn::Functional(torch::relu)));
+    for (int64_t i = 0; i < tables; ++i) {
+      embeddings.push_back(register_module(
+          "embedding" + std::to_string(i),
+          torch::nn::Embedding(tableRows, kEmbeddingSize)));
+    }
+    const int64_t features = tables + 1;
+    top = register_module(
+        "top",
+        torch::nn::Sequential(
+            torch::nn::Linear(features * features + kEmbeddingSize, 512),
+            torch::nn::Functional(torch::relu),
+            torch::nn::Linear(512, 256),
+            torch::nn::Functional(torch::relu),
+            torch::nn::Linear(256, 1)));
+  }
+
+  Sample example() const override {
+    return {{torch::randn({kDenseFeatures}),
+             torch::randint(
+                 tableRows,
+                 {static_cast<int64_t>(embeddings.size())},
+                 torch::kLong)},
+            torch::randint(2, {1}, torch::kFloat)};
+  }
+
+  torch::Tensor loss(const Inputs& inputs, const torch::Tensor& target)
+      override {
+    auto dense = bottom->forward(inputs[0]);
+    std::vector<torch::Tensor> features = {dense};
+    for (size_t i = 0; i < embeddings.size(); ++i) {
+      features.push_back(embeddings[i]->forward(inputs[1].select(1, i)));
+    }
+    auto stacked = torch::stack(features, 1);
+    auto interactions = torch::bmm(stacked, stacked.transpose(1, 2));
+    auto x = torch::cat({dense, interactions.view({dense.size(0), -1})}, 1);
+    return torch::binary_cross_entropy_with_logits(
+        top->forward(x), target, {}, {}, Reduction::ElementwiseMean);
+  }
+
+  static constexpr int64_t kDenseFeatures = 13;
+  static constexpr int64_t kEmbeddingSize = 64;
+  int64_t tableRows;
+  torch::nn::Sequential bottom{nullptr};
+  std::vector<torch::nn::Embedding> embeddings;
+  torch::nn::Sequential top{nullptr};
+};
+
+constexpr int64_t RecommendationModel::kDenseFeatures;
+constexpr int64_t RecommendationModel::kEmbeddingSize;
+
+std::shared_ptr<Model> createModel(const Options& options) {
+  if (options.model == "resnet50") {
+    return std::make_shared<ResNet50>(options.imageSize);
+  } else if (options.model == "lstm") {
+    return std::make_shared<LSTMLanguageModel>(
+        options.vocabulary, options.sequenceLength);
+  } else if (options.model == "recommendation") {
+    return std::make_shared<RecommendationModel>(
+        options.tables, options.tableRows);
+  }
+  throw std::invalid_argument("Unknown model " + options.model);
+}
+
+// Input pipeline
+
+// Time spent loading batches, summed over the DataLoader workers
+struct LoadStats {
+  void add(Clock::time_point start) {
+    nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       Clock::now() - start)
+                       .count();
+  }
+
+  std::atomic<int64_t> nanoseconds{0};
+  std::atomic<int64_t> batches{0};
+};
+
+class TimedDataset : public torch::data::datasets::Dataset<Sample> {
+ public:
+  explicit TimedDataset(std::shared_ptr<LoadStats> stats)
+      : stats_(std::move(stats)) {}
+
+  std::vector<Sample> get_batch(at::ArrayRef<size_t> indices) override {
+    const auto start = Clock::now();
+    auto batch = Dataset::get_batch(indices);
+    stats_->add(start);
+    return batch;
+  }
+
+ private:
+  std::shared_ptr<LoadStats> stats_;
+};
+
+// Random examples, generated as they are loaded
+class SyntheticDataset : public TimedDataset {
+ public:
+  SyntheticDataset(
+      std::shared_ptr<Model> model,
+      size_t size,
+      std::shared_ptr<LoadStats> stats)
+      : TimedDataset(std::move(stats)), model_(std::move(model)), size_(size) {}
+
+  Sample get(size_t index) override {
+    return model_->example();
+  }
+
+  size_t size() const override {
+    return size_;
+  }
+
+ private:
+  std::shared_ptr<Model> model_;
+  size_t size_;
+};
+
+// Examples read from an archive holding the stacked inputs, as "input0",
+// "input1", ..., and the stacked targets, as "target"
+class ArchiveDataset : public TimedDataset {
+ public:
+  ArchiveDataset(
+      const std::string& path,
+      size_t numInputs,
+      std::shared_ptr<LoadStats> stats)
+      : TimedDataset(std::move(stats)) {
+    torch::serialize::InputArchive archive;
+    archive.load_from(path);
+    for (size_t i = 0; i < numInputs; ++i) {
+      inputs_.emplace_back();
+      archive.read("input" + std::to_string(i), inputs_.back());
+    }
+    archive.read("target", target_);
+  }
+
+  Sample get(size_t index) override {
+    Inputs inputs;
+    for (const auto& input : inputs_) {
+      inputs.push_back(input[index]);
+    }
+    return {std::move(inputs), target_[index]};
+  }
+
+  size_t size() const override {
+    return target_.size(0);
+  }
+
+ private:
+  Inputs inputs_;
+  torch::Tensor target_;
+};
+
+void saveExamples(const Model& model, int64_t count, const std::string& path) {
+  std::vector<Inputs> inputs;
+  std::vector<torch::Tensor> targets;
+  for (int64_t i = 0; i < count; ++i) {
+    auto example = model.example();
+    inputs.resize(example.data.size());
+    for (size_t k = 0; k < example.data.size(); ++k) {
+      inputs[k].push_back(example.data[k]);
+    }
+    targets.push_back(example.target);
+  }
+  torch::serialize::OutputArchive archive;
+  for (size_t k = 0; k < inputs.size(); ++k) {
+    archive.write("input" + std::to_string(k), torch::stack(inputs[k]));
+  }
+  archive.write("target", torch::stack(targets));
+  archive.save_to(path);
+}
+
+// Communication and optimization
+
+// Gradients allreduced together, as one flat tensor, and the optimizer of
+// their parameters
+struct Bucket {
+  std::vector<torch::Tensor> parameters;
+  std::unique_ptr<torch::optim::SGD> optimizer;
+  std::vector<torch::Tensor> flat;
+};
+
+// Splits the parameters into buckets of about bucketBytes, in the reverse of
+// the order of the layers, which is the order their gradients are computed in
+std::vector<Bucket> createBuckets(Model& model, double bucketBytes) {
+  std::vector<torch::Tensor> parameters;
+  auto cursor = model.parameters();
+  for (auto& parameter : cursor) {
+    parameters.push_back(parameter.value);
+  }
+  std::reverse(parameters.begin(), parameters.end());
+
+  std::vector<Bucket> buckets;
+  double bytes = bucketBytes;
+  for (const auto& parameter : parameters) {
+    if (bytes >= bucketBytes) {
+      buckets.emplace_back();
+      bytes = 0;
+    }
+    buckets.back().parameters.push_back(parameter);
+    bytes += parameter.numel() * parameter.type().elementSizeInBytes();
+  }
+  for (auto& bucket : buckets) {
+    bucket.optimizer = torch::make_unique<torch::optim::SGD>(
+        bucket.parameters, torch::optim::SGDOptions(0.01).momentum(0.9));
+  }
+  return buckets;
+}
+
+// Averages the gradients over the ranks, if there are several, and updates
+// every bucket as soon as its gradients are reduced, while the later buckets
+// are still being reduced
+void reduceAndUpdate(
+    std::vector<Bucket>& buckets,
+    c10d::ProcessGroup* processGroup,
+    bool update) {
+  torch::NoGradGuard guard;
+  std::vector<std::shared_ptr<c10d::ProcessGroup::Work>> work;
+  if (processGroup != nullptr) {
+    for (auto& bucket : buckets) {
+      std::vector<torch::Tensor> gradients;
+      for (auto& parameter : bucket.parameters) {
+        gradients.push_back(parameter.grad().view({-1}));
+      }
+      bucket.flat = {torch::cat(gradients)};
+      work.push_back(processGroup->allreduce(bucket.flat));
+    }
+  }
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    auto& bucket = buckets[i];
+    if (processGroup != nullptr) {
+      work[i]->wait();
+      auto& flat = bucket.flat[0];
+      flat.div_(processGroup->getSize());
+      int64_t offset = 0;
+      for (auto& parameter : bucket.parameters) {
+        auto grad = parameter.grad();
+        grad.copy_(flat.narrow(0, offset, grad.numel()).view_as(grad));
+        offset += grad.numel();
+      }
+    }
+    if (update) {
+      bucket.optimizer->step();
+    }
+  }
+}
+
+std::shared_ptr<c10d::ProcessGroup> createProcessGroup(
+    const Options& options,
+    const Environment& env,
+    const std::shared_ptr<c10d::Store>& store) {
+  if (options.backend == "gloo") {
+    c10d::ProcessGroupGloo::Options glooOptions;
+    ::gloo::transport::tcp::attr attr;
+    attr.hostname = env.hostname;
+    glooOptions.devices.push_back(::gloo::transport::tcp::CreateDevice(attr));
+    return std::make_shared<c10d::ProcessGroupGloo>(
+        store, env.rank, env.worldSize, glooOptions);
+  }
+#ifdef USE_C10D_NCCL
+  if (options.backend == "nccl") {
+    return std::make_shared<c10d::ProcessGroupNCCL>(
+        store, env.rank, env.worldSize);
+  }
+#endif
+  throw std::invalid_argument("Unsupported backend " + options.backend);
+}
+
+// The number of hosts the ranks run on
+int countNodes(const Environment& env, c10d::Store& store) {
+  const std::string prefix = "training_benchmark/hostname/";
+  store.set(
+      prefix + std::to_string(env.rank),
+      std::vector<uint8_t>(env.hostname.begin(), env.hostname.end()));
+  std::set<std::string> hostnames;
+  for (int rank = 0; rank < env.worldSize; ++rank) {
+    const auto hostname = store.get(prefix + std::to_string(rank));
+    hostnames.emplace(hostname.begin(), hostname.end());
+  }
+  return hostnames.size();
+}
+
+// Measurement
+
+// Accumulates the time of every stage of the steps, in milliseconds
+class StageTimer {
+ public:
+  explicit StageTimer(torch::Device device)
+      : device_(device), last_(Clock::now()) {}
+
+  void start() {
+    synchronize(device_);
+    last_ = Clock::now();
+  }
+
+  // Ends the current stage, once the device has finished its work
+  void end(const std::string& stage) {
+    synchronize(device_);
+    const auto now = Clock::now();
+    totals_[stage] += millisecondsBetween(last_, now);
+    last_ = now;
+  }
+
+  void add(const std::string& stage, double milliseconds) {
+    totals_[stage] += milliseconds;
+  }
+
+  const std::map<std::string, double>& totals() const {
+    return totals_;
+  }
+
+ private:
+  torch::Device device_;
+  Clock::time_point last_;
+  std::map<std::string, double> totals_;
+};
+
+// The mean time of every stage, in milliseconds
+using StageTimes = std::map<std::string, double>;
+
+StageTimes runConfiguration(
+    const Options& options,
+    const std::shared_ptr<Model>& model,
+    std::vector<Bucket>& buckets,
+    c10d::ProcessGroup* processGroup,
+    torch::Device device) {
+  auto stats = std::make_shared<LoadStats>();
+  std::shared_ptr<TimedDataset> dataset;
+  if (options.data.empty()) {
+    dataset =
+        std::make_shared<SyntheticDataset>(model, options.examples, stats);
+  } else {
+    dataset = std::make_shared<ArchiveDataset>(
+        options.data, model->example().data.size(), stats);
+  }
+  const bool pinMemory = device.is_cuda();
+  auto collate = [stats, pinMemory](std::vector<Sample> examples) {
+    const auto start = Clock::now();
+    Sample batch;
+    for (size_t k = 0; k < examples[0].data.size(); ++k) {
+      std::vector<torch::Tensor> input;
+      for (const auto& example : examples) {
+        input.push_back(example.data[k]);
+      }
+      batch.data.push_back(torch::data::stack(input, pinMemory));
+    }
+    std::vector<torch::Tensor> target;
+    for (const auto& example : examples) {
+      target.push_back(example.target);
+    }
+    batch.target = torch::data::stack(target, pinMemory);
+    stats->add(start);
+    ++stats->batches;
+    return batch;
+  };
+  auto loader = torch::data::make_data_loader(
+      dataset,
+      torch::data::DataLoaderOptions(options.batchSize)
+          .workers(options.workers)
+          .drop_last(true),
+      torch::make_unique<torch::data::samplers::RandomSampler>(
+          dataset->size()),
+      collate);
+  loader->reset();
+  const auto nextBatch = [&] {
+    auto batch = loader->next();
+    if (!batch.has_value()) {
+      loader->reset();
+      batch = loader->next();
+      if (!batch.has_value()) {
+        throw std::runtime_error("The dataset has less than a batch");
+      }
+    }
+    return std::move(*batch);
+  };
+
+  StageTimer timer(device);
+  model->train();
+  for (int64_t step = 0; step < options.warmupSteps + options.steps; ++step) {
+    if (step == options.warmupSteps) {
+      timer = StageTimer(device);
+    }
+    timer.start();
+    const auto stepStart = Clock::now();
+    auto batch = nextBatch();
+    timer.end("data_wait");
+
+    Inputs inputs;
+    for (const auto& input : batch.data) {
+      inputs.push_back(input.to(device, /*non_blocking=*/true));
+    }
+    auto target = batch.target.to(device, /*non_blocking=*/true);
+    timer.end("copy");
+
+    auto loss = model->loss(inputs, target);
+    timer.end("forward");
+
+    model->zero_grad();
+    loss.backward();
+    timer.end("backward");
+
+    reduceAndUpdate(buckets, processGroup, /*update=*/true);
+    timer.end("reduce_update");
+    timer.add("step", millisecondsBetween(stepStart, Clock::now()));
+  }
+
+  // The stages that overlap, each on its own
+  for (int64_t step = 0; step < options.calibrationSteps; ++step) {
+    timer.start();
+    if (processGroup != nullptr) {
+      reduceAndUpdate(buckets, processGroup, /*update=*/false);
+      timer.end("allreduce");
+    }
+    for (auto& bucket : buckets) {
+      bucket.optimizer->step();
+    }
+    timer.end("optimizer");
+  }
+
+  StageTimes times;
+  for (const auto& total : timer.totals()) {
+    const bool calibration =
+        total.first == "allreduce" || total.first == "optimizer";
+    times[total.first] = total.second /
+        (calibration ? std::max<int64_t>(options.calibrationSteps, 1)
+                     : options.steps);
+  }
+  times["data_load"] = stats->batches > 0
+      ? stats->nanoseconds / 1e6 / stats->batches
+      : 0;
+  return times;
+}
+
+// The maximum of every stage time over the ranks
+void reduceMax(
+    StageTimes& times,
+    c10d::ProcessGroup& processGroup,
+    torch::Device device) {
+  std::vector<double> values;
+  for (const auto& time : times) {
+    values.push_back(time.second);
+  }
+  std::vector<torch::Tensor> tensors = {
+      torch::tensor(at::ArrayRef<double>(values)).to(device)};
+  c10d::AllreduceOptions allreduceOptions;
+  allreduceOptions.reduceOp = c10d::ReduceOp::MAX;
+  processGroup.allreduce(tensors, allreduceOptions)->wait();
+  synchronize(device);
+  auto reduced = tensors[0].cpu();
+  size_t i = 0;
+  for (auto& time : times) {
+    time.second = reduced[i++].item<double>();
+  }
+}
+
+// Output
+
+struct Result {
+  int threads;
+  StageTimes times;
+  std::map<std::string, double> metrics;
+};
+
+std::string formatDouble(double value) {
+  std::ostringstream stream;
+  stream.precision(6);
+  stream << value;
+  return stream.str();
+}
+
+void writeResults(
+    std::ostream& out,
+    const Options& options,
+    const Environment& env,
+    int nodes,
+    const std::vector<Result>& results) {
+  out << "{\n  \"context\": {\n"
+      << "    \"executable\": \"training_benchmark\",\n"
+      << "    \"model\": \"" << options.model << "\",\n"
+      << "    \"data\": \"" << (options.data.empty() ? "synthetic" : "archive")
+      << "\",\n"
+      << "    \"device\": \"" << options.device << "\",\n"
+      << "    \"backend\": \"" << options.backend << "\",\n"
+      << "    \"batch_size\": " << options.batchSize << ",\n"
+      << "    \"workers\": " << options.workers << ",\n"
+      << "    \"world_size\": " << env.worldSize << ",\n"
+      << "    \"nodes\": " << nodes << "\n"
+      << "  },\n  \"benchmarks\": [";
+  bool first = true;
+  for (const auto& result : results) {
+    const auto prefix = options.model + "/threads:" +
+        std::to_string(result.threads) +
+        "/world_size:" + std::to_string(env.worldSize) + "/";
+    for (const auto& time : result.times) {
+      out << (first ? "\n" : ",\n") << "    {\"name\": \"" << prefix
+          << time.first << "\", \"iterations\": " << options.steps
+          << ", \"real_time\": " << formatDouble(time.second)
+          << ", \"cpu_time\": " << formatDouble(time.second)
+          << ", \"time_unit\": \"ms\"";
+      if (time.first == "step") {
+        for (const auto& metric : result.metrics) {
+          out << ", \"" << metric.first
+              << "\": " << formatDouble(metric.second);
+        }
+      }
+      out << "}";
+      first = false;
+    }
+  }
+  out << "\n  ]\n}\n";
+}
+
+int run(int argc, char** argv) {
+  const auto options = parseOptions(argc, argv);
+  const auto env = readEnvironment();
+  auto model = createModel(options);
+
+  if (!options.saveData.empty()) {
+    saveExamples(*model, options.examples, options.saveData);
+    return 0;
+  }
+
+  torch::Device device(torch::kCPU);
+  if (options.device == "cuda") {
+#ifdef USE_CUDA
+    device = torch::Device(torch::kCUDA, env.localRank);
+    cudaSetDevice(env.localRank);
+#else
+    throw std::invalid_argument("training_benchmark was built without CUDA");
+#endif
+  } else if (options.device != "cpu") {
+    throw std::invalid_argument("Unknown device " + options.device);
+  }
+  model->to(device);
+
+  std::shared_ptr<c10d::Store> store;
+  std::shared_ptr<c10d::ProcessGroup> processGroup;
+  int nodes = 1;
+  if (env.worldSize > 1) {
+    store = std::make_shared<c10d::TCPStore>(
+        env.masterAddr, env.masterPort, env.rank == 0);
+    processGroup = createProcessGroup(options, env, store);
+    nodes = countNodes(env, *store);
+  }
+
+  auto buckets = createBuckets(*model, options.bucketMB * 1024 * 1024);
+  auto threads = options.threads;
+  if (threads.empty()) {
+    threads.push_back(at::get_num_threads());
+  }
+
+  std::vector<Result> results;
+  for (const auto count : threads) {
+    at::set_num_threads(count);
+    Result result;
+    result.threads = count;
+    result.times = runConfiguration(
+        options, model, buckets, processGroup.get(), device);
+    if (processGroup) {
+      reduceMax(result.times, *processGroup, device);
+    }
+
+    auto& times = result.times;
+    const double step = times["step"];
+    const double allreduce = processGroup ? times["allreduce"] : 0;
+    const double hiddenData =
+        std::max(0.0, times["data_load"] - times["data_wait"]);
+    const double hiddenComm = std::min(
+        allreduce,
+        std::max(0.0, allreduce + times["optimizer"] - times["reduce_update"]));
+    const double overlappable = times["data_load"] + allreduce;
+    const double exposedComm = allreduce - hiddenComm;
+    auto& metrics = result.metrics;
+    metrics["samples_per_second"] =
+        options.batchSize * env.worldSize * 1000 / step;
+    metrics["overlap_efficiency"] = overlappable > 0
+        ? std::min(1.0, (hiddenData + hiddenComm) / overlappable)
+        : 1;
+    metrics["scaling_efficiency"] =
+        std::max(0.0, std::min(1.0, (step - exposedComm) / step));
+    metrics["thread_speedup"] = results.empty()
+        ? 1
+        : metrics["samples_per_second"] /
+            results[0].metrics["samples_per_second"];
+
+    if (env.rank == 0) {
+      std::cerr << options.model << " threads:" << count
+                << " world_size:" << env.worldSize << " "
+                << formatDouble(metrics["samples_per_second"])
+                << " samples/s, step " << formatDouble(step) << " ms";
+      for (const auto& time : times) {
+        if (time.first != "step") {
+          std::cerr << ", " << time.first << " " << formatDouble(time.second);
+        }
+      }
+      std::cerr << std::endl;
+    }
+    results.push_back(std::move(result));
+  }
+
+  if (env.rank == 0) {
+    if (options.output.empty()) {
+      writeResults(std::cout, options, env, nodes, results);
+    } else {
+      std::ofstream out(options.output);
+      writeResults(out, options, env, nodes, results);
+      if (!out) {
+        throw std::runtime_error("Can't write " + options.output);
+      }
+    }
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  try {
+    return run(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -20,6 +20,27 @@ void testHelper(const std::string& prefix = "") {
   c10d::test::check(serverStore, "key1", "value1");
   c10d::test::check(serverStore, "key2", "value2");
 
+  // Batched set/get and compare-and-set on the server store
+  auto toVector = [](const std::string& str) {
+    return std::vector<uint8_t>(str.begin(), str.end());
+  };
+  serverStore.multiSet(
+      {"mkey0", "mkey1"}, {toVector("mvalue0"), toVector("mvalue1")});
+  auto values = serverStore.multiGet({"mkey1", "key0", "mkey0"});
+  if (values != std::vector<std::vector<uint8_t>>{toVector("mvalue1"),
+                                                 toVector("value0"),
+                                                 toVector("mvalue0")}) {
+    throw std::runtime_error("Unexpected multiGet result");
+  }
+  if (serverStore.compareSet("cas", {}, toVector("first")) !=
+          toVector("first") ||
+      serverStore.compareSet("cas", toVector("other"), toVector("second")) !=
+          toVector("first") ||
+      serverStore.compareSet("cas", toVector("first"), toVector("second")) !=
+          toVector("second")) {
+    throw std::runtime_error("Unexpected compareSet result");
+  }
+
   // Hammer on TCPStore
   std::vector<std::thread> threads;
   const auto numThreads = 16;
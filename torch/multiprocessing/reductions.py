@@ -205,7 +205,9 @@ def rebuild_storage_fd(cls, df, size):
     try:
         storage = storage_from_cache(cls, fd_id(fd))
         if storage is not None:
-            return storage
+            # The sender counted one more user of the segment, see
+            # reduce_storage
+            return storage._shared_decref()
         storage = cls._new_shared_fd(fd, size)
         shared_cache[fd_id(fd)] = StorageWeakRef(storage)
         return storage
@@ -241,6 +243,9 @@ def reduce_storage(storage):
         return (rebuild_storage_empty, (type(storage),))
     else:
         fd, size = storage._share_fd_()
+        # The segment is only recycled by its creator once the storage that
+        # the receiver maps from it is freed
+        storage._shared_incref()
         if sys.version_info[0] == 2:
             df = multiprocessing.reduction.reduce_handle(fd)
         else:
@@ -158,10 +158,11 @@ class RNNBase(Module):
     def forward(self, input, hx=None):
         is_packed = isinstance(input, PackedSequence)
         if is_packed:
-            input, batch_sizes = input
+            input, batch_sizes, sorted_indices, unsorted_indices = input
             max_batch_size = int(batch_sizes[0])
         else:
             batch_sizes = None
+            sorted_indices = unsorted_indices = None
             max_batch_size = input.size(0) if self.batch_first else input.size(1)
 
         if hx is None:
@@ -171,6 +172,10 @@ class RNNBase(Module):
                                  requires_grad=False)
             if self.mode == 'LSTM':
                 hx = (hx, hx)
+        else:
+            # hx is in the order of the original batch, the packed sequences
+            # are sorted by length
+            hx = self.permute_hidden(hx, sorted_indices)
 
         self.check_forward_args(input, hx, batch_sizes)
         _impl = _rnn_impls[self.mode]
@@ -184,8 +189,16 @@ class RNNBase(Module):
         hidden = result[1:] if self.mode == 'LSTM' else result[1]
 
         if is_packed:
-            output = PackedSequence(output, batch_sizes)
-        return output, hidden
+            output = PackedSequence(output, batch_sizes, sorted_indices, unsorted_indices)
+        return output, self.permute_hidden(hidden, unsorted_indices)
+
+    def permute_hidden(self, hx, permutation):
+        if permutation is None:
+            return hx
+        if self.mode == 'LSTM':
+            permutation = permutation.to(hx[0].device)
+            return tuple(h.index_select(1, permutation) for h in hx)
+        return hx.index_select(1, permutation.to(hx.device))
 
     def extra_repr(self):
         s = '{input_size}, {hidden_size}'
@@ -1,6 +1,7 @@
 import warnings
 import torch
 from torch._six import inf
+from torch.optim.optimizer import _can_fuse
 
 
 def clip_grad_norm_(parameters, max_norm, norm_type=2):
@@ -34,8 +35,16 @@ def clip_grad_norm_(parameters, max_norm, norm_type=2):
         total_norm = total_norm ** (1. / norm_type)
     clip_coef = max_norm / (total_norm + 1e-6)
     if clip_coef < 1:
+        # dense CUDA gradients are scaled by torch._multi_tensor_scale_, in
+        # batches of gradients with the same type and device
+        fused = {}
         for p in parameters:
-            p.grad.data.mul_(clip_coef)
+            if _can_fuse(p.grad):
+                fused.setdefault((p.grad.get_device(), p.grad.type()), []).append(p.grad.data)
+            else:
+                p.grad.data.mul_(clip_coef)
+        for grads in fused.values():
+            torch._multi_tensor_scale_(grads, float(clip_coef))
     return total_norm
 
 
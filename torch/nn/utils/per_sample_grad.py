@@ -0,0 +1,132 @@
+r"""
+Per-sample gradients, e.g. for differentially private training
+"""
+import torch
+import torch.nn.functional as F
+from torch.nn.modules.conv import Conv2d
+from torch.nn.modules.linear import Linear
+from torch.nn.modules.sparse import Embedding
+
+
+def _accumulate_grad_sample(param, grad_sample):
+    if param is None or not param.requires_grad:
+        return
+    if getattr(param, 'grad_sample', None) is None:
+        param.grad_sample = grad_sample
+    else:
+        param.grad_sample = param.grad_sample + grad_sample
+
+
+def _linear_grad_sample(module, input, grad_output):
+    n = input.size(0)
+    input = input.reshape(n, -1, input.size(-1))
+    grad_output = grad_output.reshape(n, -1, grad_output.size(-1))
+    _accumulate_grad_sample(module.weight, torch.bmm(grad_output.transpose(1, 2), input))
+    _accumulate_grad_sample(module.bias, grad_output.sum(1))
+
+
+def _conv2d_grad_sample(module, input, grad_output):
+    n = input.size(0)
+    columns = F.unfold(input, module.kernel_size, module.dilation, module.padding, module.stride)
+    grad_output = grad_output.reshape(n, grad_output.size(1), -1)
+    grad_sample = torch.bmm(grad_output, columns.transpose(1, 2))
+    _accumulate_grad_sample(module.weight, grad_sample.view((n,) + module.weight.shape))
+    _accumulate_grad_sample(module.bias, grad_output.sum(2))
+
+
+def _embedding_grad_sample(module, input, grad_output):
+    n = input.size(0)
+    dim = module.embedding_dim
+    index = input.reshape(n, -1, 1).expand(-1, -1, dim)
+    grad_sample = grad_output.new_zeros((n,) + module.weight.shape)
+    grad_sample.scatter_add_(1, index, grad_output.reshape(n, -1, dim))
+    if module.padding_idx is not None:
+        grad_sample[:, module.padding_idx] = 0
+    _accumulate_grad_sample(module.weight, grad_sample)
+
+
+def _grad_sample_fn(module):
+    if isinstance(module, Linear):
+        return _linear_grad_sample
+    if isinstance(module, Conv2d):
+        if module.groups != 1:
+            raise ValueError("per_sample_grads: grouped convolutions are not supported")
+        return _conv2d_grad_sample
+    if isinstance(module, Embedding):
+        if module.scale_grad_by_freq:
+            raise ValueError("per_sample_grads: embeddings with scale_grad_by_freq are not supported")
+        return _embedding_grad_sample
+    return None
+
+
+class PerSampleGrad(object):
+    def __init__(self, fn):
+        self.fn = fn
+
+    def __call__(self, module, inputs, output):
+        if not torch.is_grad_enabled() or not output.requires_grad:
+            return
+        input = inputs[0].detach()
+        output.register_hook(lambda grad: self.fn(module, input, grad))
+
+
+def per_sample_grads(module):
+    r"""Makes the backward pass compute the gradient of every sample in the
+    batch for the parameters of :class:`~torch.nn.Linear`,
+    :class:`~torch.nn.Conv2d` and :class:`~torch.nn.Embedding` layers in
+    `module` (including `module` itself).
+
+    The gradients are stored in the ``grad_sample`` attribute of each
+    parameter, next to ``grad``, with the samples along dimension 0, so that
+    ``param.grad_sample.sum(0)`` is the contribution of the layer to
+    ``param.grad``. Like ``grad``, ``grad_sample`` accumulates over backward
+    calls, and should be reset to ``None`` between batches.
+
+    The per-sample gradients are computed from the layer's input and output
+    gradient with one batched matrix multiply (or scatter for embeddings) per
+    layer. Inputs must have the batch as their first dimension. When the loss
+    averages over the batch, the per-sample gradients are scaled by
+    ``1 / batch_size``, like ``grad``.
+
+    Args:
+        module (nn.Module): containing module
+
+    Returns:
+        The original module with the per-sample gradient hooks
+
+    Example::
+
+        >>> model = per_sample_grads(nn.Sequential(nn.Linear(20, 10), nn.ReLU(), nn.Linear(10, 2)))
+        >>> model(torch.randn(8, 20)).sum().backward()
+        >>> model[0].weight.grad_sample.size()
+        torch.Size([8, 10, 20])
+    """
+    for m in module.modules():
+        fn = _grad_sample_fn(m)
+        if fn is None or hasattr(m, '_per_sample_grad_handle'):
+            continue
+        m._per_sample_grad_handle = m.register_forward_hook(PerSampleGrad(fn))
+    return module
+
+
+def remove_per_sample_grads(module):
+    r"""Removes the per-sample gradient hooks from `module` and its submodules,
+    along with the ``grad_sample`` attributes of their parameters.
+
+    Args:
+        module (nn.Module): containing module
+
+    Example:
+        >>> m = per_sample_grads(nn.Linear(20, 40))
+        >>> remove_per_sample_grads(m)
+    """
+    for m in module.modules():
+        handle = getattr(m, '_per_sample_grad_handle', None)
+        if handle is None:
+            continue
+        handle.remove()
+        del m._per_sample_grad_handle
+        for param in m.parameters(recurse=False):
+            if hasattr(param, 'grad_sample'):
+                del param.grad_sample
+    return module
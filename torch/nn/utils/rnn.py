@@ -4,7 +4,8 @@ import warnings
 import torch
 
 
-PackedSequence_ = namedtuple('PackedSequence', ['data', 'batch_sizes'])
+PackedSequence_ = namedtuple('PackedSequence',
+                             ['data', 'batch_sizes', 'sorted_indices', 'unsorted_indices'])
 
 
 class PackedSequence(PackedSequence_):
@@ -26,9 +27,15 @@ class PackedSequence(PackedSequence_):
         data (Tensor): Tensor containing packed sequence
         batch_sizes (Tensor): Tensor of integers holding
             information about the batch size at each sequence step
+        sorted_indices (Tensor, optional): CPU tensor of integers holding how
+            the sequences were sorted by length: the i-th longest one is
+            ``sorted_indices[i]`` in the original batch. ``None`` if they
+            were already sorted.
+        unsorted_indices (Tensor, optional): CPU tensor of integers holding
+            the inverse permutation of ``sorted_indices``.
 
     """
-    def __new__(cls, data, batch_sizes=None):
+    def __new__(cls, data, batch_sizes=None, sorted_indices=None, unsorted_indices=None):
         # PackedSequence used to only have __init__(self, data, batch_sizes)
         # without a __new__ like this. So to preserve BC for calling in keyword
         # arg style (e.g., `PackedSequence(data=..., batch_sizes=...)`), we have
@@ -36,10 +43,11 @@ class PackedSequence(PackedSequence_):
         #
         # support being called as `PackedSequence(data, batch_sizes)`
         if batch_sizes is not None:
-            return super(PackedSequence, cls).__new__(cls, data, batch_sizes)
+            return super(PackedSequence, cls).__new__(
+                cls, data, batch_sizes, sorted_indices, unsorted_indices)
         # support being called as `PackedSequence((data, batch_sizes))`
         else:
-            assert isinstance(data, (list, tuple)) and len(data) == 2
+            assert isinstance(data, (list, tuple)) and len(data) in (2, 4)
             return super(PackedSequence, cls).__new__(cls, *data)
 
     def cuda(self, *args, **kwargs):
@@ -47,46 +55,46 @@ class PackedSequence(PackedSequence_):
         if self.is_cuda:
             return self
         else:
-            return type(self)(self.data.cuda(*args, **kwargs), self.batch_sizes)
+            return self._replace(data=self.data.cuda(*args, **kwargs))
 
     def cpu(self):
         """Returns a CPU copy if `self.data` not already on the CPU"""
         if self.is_cuda:
-            return type(self)(self.data.cpu(), self.batch_sizes)
+            return self._replace(data=self.data.cpu())
         else:
             return self
 
     def double(self):
         r"""Returns copy with `self.data` cast to double type"""
-        return type(self)(self.data.double(), self.batch_sizes)
+        return self._replace(data=self.data.double())
 
     def float(self):
         r"""Returns copy with `self.data` cast to float type"""
-        return type(self)(self.data.float(), self.batch_sizes)
+        return self._replace(data=self.data.float())
 
     def half(self):
         r"""Returns copy with `self.data` cast to half type"""
-        return type(self)(self.data.half(), self.batch_sizes)
+        return self._replace(data=self.data.half())
 
     def long(self):
         r"""Returns copy with `self.data` cast to long type"""
-        return type(self)(self.data.long(), self.batch_sizes)
+        return self._replace(data=self.data.long())
 
     def int(self):
         r"""Returns copy with `self.data` cast to int type"""
-        return type(self)(self.data.int(), self.batch_sizes)
+        return self._replace(data=self.data.int())
 
     def short(self):
         r"""Returns copy with `self.data` cast to short type"""
-        return type(self)(self.data.short(), self.batch_sizes)
+        return self._replace(data=self.data.short())
 
     def char(self):
         r"""Returns copy with `self.data` cast to char type"""
-        return type(self)(self.data.char(), self.batch_sizes)
+        return self._replace(data=self.data.char())
 
     def byte(self):
         r"""Returns copy with `self.data` cast to byte type"""
-        return type(self)(self.data.byte(), self.batch_sizes)
+        return self._replace(data=self.data.byte())
 
     def to(self, *args, **kwargs):
         r"""Performs dtype and/or device conversion on `self.data`.
@@ -103,7 +111,7 @@ class PackedSequence(PackedSequence_):
         if data is self.data:
             return self
         else:
-            return type(self)(data, self.batch_sizes)
+            return self._replace(data=data)
 
     @property
     def is_cuda(self):
@@ -111,7 +119,7 @@ class PackedSequence(PackedSequence_):
         return self.data.is_cuda
 
 
-def pack_padded_sequence(input, lengths, batch_first=False):
+def pack_padded_sequence(input, lengths, batch_first=False, enforce_sorted=True):
     r"""Packs a Tensor containing padded sequences of variable length.
 
     Input can be of size ``T x B x *`` where `T` is the length of the longest sequence
@@ -119,9 +127,12 @@ def pack_padded_sequence(input, lengths, batch_first=False):
     dimensions (including 0). If ``batch_first`` is True ``B x T x *`` inputs are
     expected.
 
-    The sequences should be sorted by length in a decreasing order, i.e.
-    ``input[:,0]`` should be the longest sequence, and ``input[:,B-1]`` the
-    shortest one.
+    If ``enforce_sorted`` is True, the sequences should be sorted by length in
+    a decreasing order, i.e. ``input[:,0]`` should be the longest sequence, and
+    ``input[:,B-1]`` the shortest one. Otherwise they are sorted as they are
+    packed, and the permutation is kept in the :class:`PackedSequence`, so that
+    the RNN modules and :func:`pad_packed_sequence` work in the original order.
+    ``enforce_sorted = True`` is only necessary for ONNX export.
 
     Note:
         This function accepts any input that has at least two dimensions. You
@@ -134,6 +145,9 @@ def pack_padded_sequence(input, lengths, batch_first=False):
         lengths (Tensor): list of sequences lengths of each batch element.
         batch_first (bool, optional): if ``True``, the input is expected in ``B x T x *``
             format.
+        enforce_sorted (bool, optional): if ``True``, the input is expected to
+            contain sequences sorted by length in a decreasing order. If
+            ``False``, this condition is not checked. Default: ``True``.
 
     Returns:
         a :class:`PackedSequence` object
@@ -145,7 +159,21 @@ def pack_padded_sequence(input, lengths, batch_first=False):
                       'the trace incorrect for any other combination of lengths.',
                       category=torch.jit.TracerWarning, stacklevel=2)
     lengths = torch.as_tensor(lengths, dtype=torch.int64)
-    return PackedSequence(torch._C._VariableFunctions._pack_padded_sequence(input, lengths, batch_first))
+    if enforce_sorted:
+        return PackedSequence(torch._C._VariableFunctions._pack_padded_sequence(input, lengths, batch_first))
+
+    # The permutation is folded into the gather that packs the input, so the
+    # input itself is never reordered
+    lengths, sorted_indices = torch.sort(lengths, descending=True)
+    data, batch_sizes = torch._C._VariableFunctions._pack_padded_sequence_permuted(
+        input, lengths, sorted_indices, batch_first)
+    return PackedSequence(data, batch_sizes, sorted_indices, _invert_permutation(sorted_indices))
+
+
+def _invert_permutation(permutation):
+    output = torch.empty_like(permutation)
+    output.scatter_(0, permutation, torch.arange(0, permutation.numel(), dtype=torch.int64))
+    return output
 
 
 def pad_packed_sequence(sequence, batch_first=False, padding_value=0.0, total_length=None):
@@ -157,7 +185,9 @@ def pad_packed_sequence(sequence, batch_first=False, padding_value=0.0, total_le
     of the longest sequence and `B` is the batch size. If ``batch_first`` is True,
     the data will be transposed into ``B x T x *`` format.
 
-    Batch elements will be ordered decreasingly by their length.
+    Batch elements will be ordered decreasingly by their length, unless the
+    sequence was packed with ``enforce_sorted = False``, in which case they
+    are in their original order.
 
     .. note::
         :attr:`total_length` is useful to implement the
@@ -189,6 +219,10 @@ def pad_packed_sequence(sequence, batch_first=False, padding_value=0.0, total_le
                              "total_length={} and max sequence length being {}"
                              .format(total_length, max_seq_length))
         max_seq_length = total_length
+    if sequence.sorted_indices is not None:
+        return torch._C._VariableFunctions._pad_packed_sequence_permuted(
+            sequence.data, sequence.batch_sizes, sequence.sorted_indices,
+            batch_first, padding_value, max_seq_length)
     return torch._C._VariableFunctions._pad_packed_sequence(
         sequence.data, sequence.batch_sizes, batch_first, padding_value, max_seq_length)
 
@@ -252,12 +286,13 @@ def pad_sequence(sequences, batch_first=False, padding_value=0):
     return out_tensor
 
 
-def pack_sequence(sequences):
+def pack_sequence(sequences, enforce_sorted=True):
     r"""Packs a list of variable length Tensors
 
     ``sequences`` should be a list of Tensors of size ``L x *``, where `L` is
     the length of a sequence and `*` is any number of trailing dimensions,
-    including zero. They should be sorted in the order of decreasing length.
+    including zero. If ``enforce_sorted`` is True, they should be sorted in
+    the order of decreasing length.
 
     Example:
         >>> from torch.nn.utils.rnn import pack_sequence
@@ -265,13 +300,18 @@ def pack_sequence(sequences):
         >>> b = torch.tensor([4,5])
         >>> c = torch.tensor([6])
         >>> pack_sequence([a, b, c])
-        PackedSequence(data=tensor([ 1,  4,  6,  2,  5,  3]), batch_sizes=tensor([ 3,  2,  1]))
+        PackedSequence(data=tensor([ 1,  4,  6,  2,  5,  3]), batch_sizes=tensor([ 3,  2,  1]),
+                       sorted_indices=None, unsorted_indices=None)
 
 
     Arguments:
         sequences (list[Tensor]): A list of sequences of decreasing length.
+        enforce_sorted (bool, optional): if ``True``, checks that the input
+            contains sequences sorted by length in a decreasing order. If
+            ``False``, this condition is not checked. Default: ``True``.
 
     Returns:
         a :class:`PackedSequence` object
     """
-    return pack_padded_sequence(pad_sequence(sequences), [v.size(0) for v in sequences])
+    lengths = [v.size(0) for v in sequences]
+    return pack_padded_sequence(pad_sequence(sequences), lengths, enforce_sorted=enforce_sorted)
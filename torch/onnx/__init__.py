@@ -15,6 +15,7 @@ class ExportTypes:
     ZIP_ARCHIVE = 2
     COMPRESSED_ZIP_ARCHIVE = 3
     DIRECTORY = 4
+    EXTERNAL_DATA = 5
 
 
 def _export(*args, **kwargs):
@@ -282,6 +282,15 @@ def _export(model, args, f, export_params=True, verbose=False, training=False,
     # TODO: Don't allocate a in-memory string for the protobuf
     from torch.onnx.symbolic import _onnx_opset_version
     defer_weight_export = export_type is not ExportTypes.PROTOBUF_FILE
+    if export_type == ExportTypes.EXTERNAL_DATA:
+        # f is the path of the model, the parameters are written next to it as
+        # ONNX external data
+        import os
+        directory = os.path.dirname(os.path.abspath(f))
+        proto = graph.export_external_data(params if export_params else [], _onnx_opset_version,
+                                           directory, operator_export_type=operator_export_type)
+        torch.serialization._with_file_like(f, "wb", lambda f: f.write(proto))
+        return torch_out
     if export_params:
         proto, export_map = graph.export(params, _onnx_opset_version, defer_weight_export, operator_export_type)
     else:
@@ -1,5 +1,5 @@
 import torch
-from .optimizer import Optimizer
+from .optimizer import Optimizer, _can_fuse
 
 
 class Adagrad(Optimizer):
@@ -57,6 +57,9 @@ class Adagrad(Optimizer):
             loss = closure()
 
         for group in self.param_groups:
+            # dense CUDA parameters are updated by torch._fused_adagrad_, in
+            # batches of parameters with the same type, device and step
+            fused = {}
             for p in group['params']:
                 if p.grad is None:
                     continue
@@ -66,6 +69,12 @@ class Adagrad(Optimizer):
 
                 state['step'] += 1
 
+                if _can_fuse(p.data, grad, state['sum']):
+                    lists = fused.setdefault((p.get_device(), p.type(), state['step']), ([], [], []))
+                    for tensor_list, t in zip(lists, (p.data, grad, state['sum'])):
+                        tensor_list.append(t)
+                    continue
+
                 if group['weight_decay'] != 0:
                     if p.grad.data.is_sparse:
                         raise RuntimeError("weight_decay option is not compatible with sparse gradients")
@@ -93,4 +102,8 @@ class Adagrad(Optimizer):
                     std = state['sum'].sqrt().add_(1e-10)
                     p.data.addcdiv_(-clr, grad, std)
 
+            for (_, _, step), lists in fused.items():
+                clr = group['lr'] / (1 + (step - 1) * group['lr_decay'])
+                torch._fused_adagrad_(*lists, clr=clr, weight_decay=group['weight_decay'])
+
         return loss
@@ -1,6 +1,6 @@
 import math
 import torch
-from .optimizer import Optimizer
+from .optimizer import Optimizer, _can_fuse
 
 
 class Adam(Optimizer):
@@ -58,6 +58,9 @@ class Adam(Optimizer):
             loss = closure()
 
         for group in self.param_groups:
+            # dense CUDA parameters are updated by torch._fused_adam_, in
+            # batches of parameters with the same type, device and step
+            fused = {}
             for p in group['params']:
                 if p.grad is None:
                     continue
@@ -86,6 +89,13 @@ class Adam(Optimizer):
 
                 state['step'] += 1
 
+                if not amsgrad and _can_fuse(p.data, grad, exp_avg, exp_avg_sq):
+                    key = (p.get_device(), p.type(), state['step'])
+                    lists = fused.setdefault(key, ([], [], [], []))
+                    for tensor_list, t in zip(lists, (p.data, grad, exp_avg, exp_avg_sq)):
+                        tensor_list.append(t)
+                    continue
+
                 if group['weight_decay'] != 0:
                     grad.add_(group['weight_decay'], p.data)
 
@@ -106,4 +116,12 @@ class Adam(Optimizer):
 
                 p.data.addcdiv_(-step_size, exp_avg, denom)
 
+            beta1, beta2 = group['betas']
+            for (_, _, step), lists in fused.items():
+                bias_correction1 = 1 - beta1 ** step
+                bias_correction2 = 1 - beta2 ** step
+                step_size = group['lr'] * math.sqrt(bias_correction2) / bias_correction1
+                torch._fused_adam_(*lists, beta1=beta1, beta2=beta2, step_size=step_size,
+                                   eps=group['eps'], weight_decay=group['weight_decay'])
+
         return loss
@@ -8,6 +8,18 @@ from itertools import chain
 required = object()
 
 
+def _can_fuse(*tensors):
+    r"""Whether the fused CUDA optimizer steps (``torch._fused_adam_`` and
+    friends) can update these tensors: they have to be dense, contiguous CUDA
+    tensors of the same type on the same device."""
+    first = tensors[0]
+    if not first.is_cuda:
+        return False
+    device = first.get_device()
+    return all(not t.is_sparse and t.is_contiguous() and t.type() == first.type() and
+               t.get_device() == device for t in tensors)
+
+
 class Optimizer(object):
     r"""Base class for all optimizers.
 
@@ -150,11 +162,19 @@ class Optimizer(object):
 
     def zero_grad(self):
         r"""Clears the gradients of all optimized :class:`torch.Tensor` s."""
+        # dense CUDA gradients are zeroed by torch._multi_tensor_zero_, in
+        # batches of gradients with the same type and device
+        fused = {}
         for group in self.param_groups:
             for p in group['params']:
                 if p.grad is not None:
                     p.grad.detach_()
-                    p.grad.zero_()
+                    if _can_fuse(p.grad):
+                        fused.setdefault((p.grad.get_device(), p.grad.type()), []).append(p.grad.data)
+                    else:
+                        p.grad.zero_()
+        for grads in fused.values():
+            torch._multi_tensor_zero_(grads)
 
     def step(self, closure):
         r"""Performs a single optimization step (parameter update).
@@ -1,5 +1,5 @@
 import torch
-from .optimizer import Optimizer, required
+from .optimizer import Optimizer, required, _can_fuse
 
 
 class SGD(Optimizer):
@@ -84,20 +84,36 @@ class SGD(Optimizer):
             momentum = group['momentum']
             dampening = group['dampening']
             nesterov = group['nesterov']
+            # dense CUDA parameters are updated by torch._fused_sgd_, in
+            # batches of parameters with the same type and device
+            fused = {}
 
             for p in group['params']:
                 if p.grad is None:
                     continue
                 d_p = p.grad.data
+                if momentum != 0:
+                    param_state = self.state[p]
+                    first_run = 'momentum_buffer' not in param_state
+                    if first_run:
+                        param_state['momentum_buffer'] = torch.zeros_like(p.data)
+                    tensors = (p.data, d_p, param_state['momentum_buffer'])
+                else:
+                    first_run = False
+                    tensors = (p.data, d_p)
+                if _can_fuse(*tensors):
+                    lists = fused.setdefault((p.get_device(), p.type(), first_run), ([], [], []))
+                    for tensor_list, t in zip(lists, tensors):
+                        tensor_list.append(t)
+                    continue
+
                 if weight_decay != 0:
                     d_p.add_(weight_decay, p.data)
                 if momentum != 0:
-                    param_state = self.state[p]
-                    if 'momentum_buffer' not in param_state:
-                        buf = param_state['momentum_buffer'] = torch.zeros_like(p.data)
+                    buf = param_state['momentum_buffer']
+                    if first_run:
                         buf.mul_(momentum).add_(d_p)
                     else:
-                        buf = param_state['momentum_buffer']
                         buf.mul_(momentum).add_(1 - dampening, d_p)
                     if nesterov:
                         d_p = d_p.add(momentum, buf)
@@ -106,4 +122,8 @@ class SGD(Optimizer):
 
                 p.data.add_(-group['lr'], d_p)
 
+            for (_, _, first_run), lists in fused.items():
+                torch._fused_sgd_(*lists, lr=group['lr'], momentum=momentum, dampening=dampening,
+                                  weight_decay=weight_decay, nesterov=nesterov, first_run=first_run)
+
         return loss
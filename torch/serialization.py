@@ -10,6 +10,7 @@ import tarfile
 import tempfile
 import warnings
 from contextlib import closing, contextmanager
+from multiprocessing.pool import ThreadPool
 from ._utils import _import_dotted_name
 from ._six import string_classes as _string_classes
 if sys.version_info[0] == 2:
@@ -27,6 +28,8 @@ SHORT_SIZE = struct.Struct('=h').size
 MAGIC_NUMBER = 0x1950a86a20f9469cfc6c
 PROTOCOL_VERSION = 1001
 STORAGE_KEY_SEPARATOR = ','
+# Number of threads that read or write the storages of a file at once
+IO_THREADS = 8
 
 
 class SourceChangeWarning(Warning):
@@ -161,6 +164,52 @@ def _should_read_directly(f):
         return False
 
 
+def _is_positionable(f):
+    """
+    Checks if the storages can be read or written at their offsets in f,
+    i.e. if f is a real file that can seek and does not append every write
+    """
+    if 'a' in str(getattr(f, 'mode', '')):
+        return False
+    try:
+        f.tell()
+        return True
+    except (IOError, OSError, io.UnsupportedOperation):
+        return False
+
+
+def _storage_offsets(storages, offset):
+    """
+    Returns the offsets of the records of the storages, which follow each
+    other from offset, and the offset past the last record. A record is the
+    int64 number of elements of the storage followed by its data.
+    """
+    offsets = []
+    for storage in storages:
+        offsets.append(offset)
+        offset += 8 + storage.size() * storage.element_size()
+    return offsets, offset
+
+
+def _for_each_storage(fn, storages, offsets):
+    """
+    Calls fn(storage, offset) for the storages, from several threads since
+    the reads and writes at an offset release the GIL
+    """
+    if len(storages) < 2 or sys.platform == 'win32':
+        for storage, offset in zip(storages, offsets):
+            fn(storage, offset)
+        return
+    # The largest storages first, so that they do not end up last on a thread
+    order = sorted(range(len(storages)), key=lambda i: -storages[i].size())
+    pool = ThreadPool(min(IO_THREADS, len(storages)))
+    try:
+        pool.map(lambda i: fn(storages[i], offsets[i]), order, chunksize=1)
+    finally:
+        pool.close()
+        pool.join()
+
+
 def _check_seekable(f):
 
     def raise_err_msg(patterns, e):
@@ -284,11 +333,19 @@ def _save(obj, f, pickle_module, pickle_protocol):
     serialized_storage_keys = sorted(serialized_storages.keys())
     pickle_module.dump(serialized_storage_keys, f, protocol=pickle_protocol)
     f.flush()
-    for key in serialized_storage_keys:
-        serialized_storages[key]._write_file(f, _should_read_directly(f))
+    storages = [serialized_storages[key] for key in serialized_storage_keys]
+    if _should_read_directly(f) and _is_positionable(f):
+        offsets, end = _storage_offsets(storages, f.tell())
+        _for_each_storage(
+            lambda storage, offset: storage._write_file(f, True, offset),
+            storages, offsets)
+        f.seek(end)
+    else:
+        for storage in storages:
+            storage._write_file(f, _should_read_directly(f))
 
 
-def load(f, map_location=None, pickle_module=pickle):
+def load(f, map_location=None, pickle_module=pickle, mmap=False):
     """Loads an object saved with :func:`torch.save` from a file.
 
     :meth:`torch.load` uses Python's unpickling facilities but treats storages,
@@ -327,6 +384,11 @@ def load(f, map_location=None, pickle_module=pickle):
             locations
         pickle_module: module used for unpickling metadata and objects (has to
             match the pickle_module used to serialize file)
+        mmap: if ``True`` and `f` is a file name or a real file, the storages
+            that stay on the CPU map their data from the file, which is only
+            read when accessed. The mapping is private: writes to the tensors
+            do not change the file, but the file must not be truncated while
+            they are alive. Ignored on big-endian hosts.
 
     .. note::
         When you call :meth:`torch.load()` on a file which contains GPU tensors, those tensors
@@ -355,13 +417,13 @@ def load(f, map_location=None, pickle_module=pickle):
         new_fd = True
         f = open(f, 'rb')
     try:
-        return _load(f, map_location, pickle_module)
+        return _load(f, map_location, pickle_module, mmap)
     finally:
         if new_fd:
             f.close()
 
 
-def _load(f, map_location, pickle_module):
+def _load(f, map_location, pickle_module, mmap=False):
     deserialized_objects = {}
 
     if map_location is None:
@@ -530,10 +592,30 @@ def _load(f, map_location, pickle_module):
 
     deserialized_storage_keys = pickle_module.load(f)
 
-    offset = f.tell() if f_should_read_directly else None
     for key in deserialized_storage_keys:
         assert key in deserialized_objects
-        deserialized_objects[key]._set_from_file(f, offset, f_should_read_directly)
-        offset = None
+    storages = [deserialized_objects[key] for key in deserialized_storage_keys]
+    if not f_should_read_directly:
+        for storage in storages:
+            storage._set_from_file(f, None, False)
+        return result
+
+    offsets, end = _storage_offsets(storages, f.tell())
+    mapping = None
+    if mmap and sys.byteorder == 'little' and \
+            isinstance(getattr(f, 'name', None), _string_classes):
+        mapping = torch.ByteStorage.from_file(f.name, False, 0)
+    unmapped_storages = []
+    unmapped_offsets = []
+    for storage, offset in zip(storages, offsets):
+        if mapping is not None and not storage.is_cuda:
+            storage._set_from_mapping(mapping, offset)
+        else:
+            unmapped_storages.append(storage)
+            unmapped_offsets.append(offset)
+    _for_each_storage(
+        lambda storage, offset: storage._set_from_file(f, offset, True),
+        unmapped_storages, unmapped_offsets)
+    f.seek(end)
 
     return result
@@ -2,4 +2,4 @@
 from .sampler import Sampler, SequentialSampler, RandomSampler, SubsetRandomSampler, WeightedRandomSampler, BatchSampler
 from .distributed import DistributedSampler
 from .dataset import Dataset, TensorDataset, ConcatDataset, Subset, random_split
-from .dataloader import DataLoader
+from .dataloader import DataLoader, CUDAPrefetcher
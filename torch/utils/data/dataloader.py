@@ -820,3 +820,99 @@ class DataLoader(object):
 
     def __len__(self):
         return len(self.batch_sampler)
+
+
+def _pin_batch_in_place(batch):
+    # Batches from workers are already in shared memory; page-locking that
+    # memory where it is avoids copying it into a new pinned buffer.
+    if isinstance(batch, torch.Tensor):
+        if batch.is_shared() and not batch.is_pinned():
+            batch._pin_memory_in_place()
+    elif isinstance(batch, container_abcs.Mapping):
+        for sample in batch.values():
+            _pin_batch_in_place(sample)
+    elif isinstance(batch, container_abcs.Sequence) and not isinstance(batch, string_classes):
+        for sample in batch:
+            _pin_batch_in_place(sample)
+
+
+def _copy_batch_to_device(batch, device, stream):
+    if isinstance(batch, torch.Tensor):
+        # The destination is allocated on the current stream, which consumes
+        # it, so the caching allocator only reuses it once that stream is done.
+        dst = batch.new_empty(batch.size(), device=device)
+        with torch.cuda.stream(stream):
+            dst.copy_(batch, non_blocking=True)
+        return dst
+    elif isinstance(batch, string_classes):
+        return batch
+    elif isinstance(batch, container_abcs.Mapping):
+        return {k: _copy_batch_to_device(sample, device, stream) for k, sample in batch.items()}
+    elif isinstance(batch, container_abcs.Sequence):
+        return [_copy_batch_to_device(sample, device, stream) for sample in batch]
+    else:
+        return batch
+
+
+class CUDAPrefetcher(object):
+    r"""
+    Wraps an iterable of CPU batches, e.g. a :class:`DataLoader`, and copies
+    each batch to a CUDA device on a side stream one batch ahead, so that the
+    host-to-device transfer of batch ``N + 1`` overlaps with the computation
+    on batch ``N``. Yields batches with the same structure whose tensors are
+    on the device, ready to be used on the current stream.
+
+    Tensors that are in shared memory, as the batches of a :class:`DataLoader`
+    with ``num_workers > 0`` are, get pinned in place, so a loader used with a
+    prefetcher needs no ``pin_memory=True`` and no copy into pinned memory.
+    Other CPU tensors are copied from where they are, so loaders with
+    ``num_workers=0`` should still use ``pin_memory=True``.
+
+    Arguments:
+        loader (iterable): iterable of batches.
+        device (torch.device or int, optional): destination device. Default:
+            the current device.
+    """
+
+    def __init__(self, loader, device=None):
+        self.loader = loader
+        if device is None:
+            device = torch.cuda.current_device()
+        self.device = torch.device('cuda', device) if isinstance(device, int_classes) \
+            else torch.device(device)
+
+    def __len__(self):
+        return len(self.loader)
+
+    def __iter__(self):
+        with torch.cuda.device(self.device):
+            stream = torch.cuda.Stream()
+            current_stream = torch.cuda.current_stream()
+        # CPU batches with copies that may still be in flight
+        in_flight = []
+
+        def preload(it):
+            try:
+                cpu_batch = next(it)
+            except StopIteration:
+                return None
+            _pin_batch_in_place(cpu_batch)
+            with torch.cuda.device(self.device):
+                # the destinations may reuse memory the current stream just freed
+                stream.wait_stream(current_stream)
+                batch = _copy_batch_to_device(cpu_batch, self.device, stream)
+                event = torch.cuda.Event()
+                event.record(stream)
+            in_flight.append((event, cpu_batch))
+            return batch, event
+
+        it = iter(self.loader)
+        loaded = preload(it)
+        while loaded is not None:
+            batch, event = loaded
+            current_stream.wait_event(event)
+            loaded = preload(it)
+            in_flight[:] = [(e, b) for e, b in in_flight if not e.query()]
+            yield batch
+        for event, _ in in_flight:
+            event.synchronize()
@@ -1,27 +1,71 @@
+import ctypes
+
 import torch
 
-from torch._C import _from_dlpack as from_dlpack
-from torch._C import _to_dlpack as to_dlpack
+from torch._C import _from_dlpack
+from torch._C import _to_dlpack
+
+
+def _stream_handle(stream):
+    if isinstance(stream, torch.cuda.Stream):
+        return stream.cuda_stream
+    return int(stream)
+
+
+def _wait_stream(device, waiting=None, waited=None):
+    # Orders the streams on the device without blocking the host. A missing
+    # stream is the current stream of the device.
+    with torch.cuda.device(device):
+        current = torch.cuda.current_stream().cuda_stream
+        waiting = current if waiting is None else waiting
+        waited = current if waited is None else waited
+        if waiting == waited:
+            return
+        event = torch.cuda.Event()
+        cudart = torch.cuda.cudart()
+        torch.cuda.check_error(cudart.cudaEventRecord(
+            event, ctypes.c_void_p(waited)))
+        torch.cuda.check_error(cudart.cudaStreamWaitEvent(
+            ctypes.c_void_p(waiting), event, ctypes.c_int(0)))
+
+
+def from_dlpack(dlpack, stream=None):
+    r"""from_dlpack(dlpack, stream=None) -> Tensor
 
-torch._C._add_docstr(from_dlpack, r"""from_dlpack(dlpack) -> Tensor
+    Decodes a DLPack to a tensor.
 
-Decodes a DLPack to a tensor.
+    Args:
+        dlpack: a PyCapsule object with the dltensor
+        stream (torch.cuda.Stream or int, optional): the CUDA stream, or the
+            raw ``cudaStream_t`` handle, on which the producer of a CUDA
+            dlpack wrote it. The current stream waits for the work queued on
+            it before using the tensor, without blocking the host.
 
-Args:
-    dlpack: a PyCapsule object with the dltensor
+    The tensor will share the memory with the object represented
+    in the dlpack, which includes page-locked host memory.
+    Note that each dlpack can only be consumed once.
+    """
+    tensor = _from_dlpack(dlpack)
+    if stream is not None and tensor.is_cuda:
+        _wait_stream(tensor.device, waited=_stream_handle(stream))
+    return tensor
 
-The tensor will share the memory with the object represented
-in the dlpack.
-Note that each dlpack can only be consumed once.
-""")
 
-torch._C._add_docstr(to_dlpack, r"""to_dlpack(tensor) -> PyCapsule
+def to_dlpack(tensor, stream=None):
+    r"""to_dlpack(tensor, stream=None) -> PyCapsule
 
-Returns a DLPack representing the tensor.
+    Returns a DLPack representing the tensor.
 
-Args:
-    tensor: a tensor to be exported
+    Args:
+        tensor: a tensor to be exported
+        stream (torch.cuda.Stream or int, optional): the CUDA stream, or the
+            raw ``cudaStream_t`` handle, on which the consumer of a CUDA
+            tensor reads it. That stream waits for the work queued on the
+            current stream, without blocking the host.
 
-The dlpack shares the tensors memory.
-Note that each dlpack can only be consumed once.
-""")
+    The dlpack shares the tensors memory.
+    Note that each dlpack can only be consumed once.
+    """
+    if stream is not None and tensor.is_cuda:
+        _wait_stream(tensor.device, waiting=_stream_handle(stream))
+    return _to_dlpack(tensor)